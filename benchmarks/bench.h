@@ -0,0 +1,186 @@
+/*!
+ * \file
+ *
+ * A minimal benchmark harness for the mathplot benchmark programs. Each benchmark is a function
+ * that is run repeatedly (in batches of doubling size) until it has run for at least the minimum
+ * time. The mean time per run is printed and, with --json=file, written out as JSON in the layout
+ * of Google Benchmark's --benchmark_format=json, so that the results of two releases can be
+ * compared with the tools that read that format (such as Google Benchmark's compare.py).
+ *
+ * Command line options:
+ *   --json=file      Write the results to file
+ *   --min-time=s     Run each benchmark for at least s seconds (default 0.5)
+ *   --filter=text    Run only the benchmarks whose names contain text
+ *   --key=value      Other options, for the program to read with runner::option
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <ctime>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include <mplot/version.h>
+
+namespace bench {
+
+    //! Add to sink anything that the compiler must not optimise away
+    inline volatile std::size_t sink = 0;
+
+    //! The p-th percentile (p in [0,100]) of the values v, by the nearest rank
+    inline double percentile (std::vector<double> v, const double p)
+    {
+        if (v.empty()) { return 0.0; }
+        std::sort (v.begin(), v.end());
+        const double rank = std::clamp (p / 100.0, 0.0, 1.0) * static_cast<double>(v.size() - 1);
+        return v[static_cast<std::size_t>(rank + 0.5)];
+    }
+
+    struct result
+    {
+        //! The benchmark's name and parameter, as "name/param"
+        std::string name;
+        std::uint64_t iterations = 0;
+        //! The mean wall time of one run in ns
+        double ns_per_iter = 0.0;
+        //! The mean CPU time of one run in ns (of all threads, from std::clock)
+        double cpu_ns_per_iter = 0.0;
+        //! Items (vertices, data, colours) processed per second, if the benchmark counts items
+        double items_per_second = 0.0;
+        //! Any other measures, written to the JSON as extra fields (Google Benchmark's user counters)
+        std::vector<std::pair<std::string, double>> counters;
+    };
+
+    class runner
+    {
+    public:
+        runner (int argc, char** argv)
+        {
+            for (int i = 1; i < argc; ++i) {
+                const std::string a (argv[i]);
+                if (a.rfind ("--json=", 0) == 0) {
+                    this->json_path = a.substr (7);
+                } else if (a.rfind ("--min-time=", 0) == 0) {
+                    this->min_time = std::stod (a.substr (11));
+                } else if (a.rfind ("--filter=", 0) == 0) {
+                    this->filter = a.substr (9);
+                } else if (a.rfind ("--", 0) == 0 && a.find ('=') != std::string::npos) {
+                    this->options[a.substr (2, a.find ('=') - 2)] = a.substr (a.find ('=') + 1);
+                } else {
+                    throw std::runtime_error ("Unknown option " + a + " (use --json=file, --min-time=s, --filter=text or --key=value)");
+                }
+            }
+        }
+
+        //! The value of the option --key=value, or dflt if it was not given
+        double option (const std::string& key, const double dflt) const
+        {
+            auto it = this->options.find (key);
+            return it == this->options.end() ? dflt : std::stod (it->second);
+        }
+
+        //! Should the benchmark called full_name be run, given any --filter?
+        bool selected (const std::string& full_name) const
+        {
+            return this->filter.empty() || full_name.find (this->filter) != std::string::npos;
+        }
+
+        /*!
+         * Run the benchmark f (a callable taking no arguments) called name, with parameter
+         * param (a grid size, say). If items is non-zero, each run of f processes that many
+         * items and the rate is reported in items per second.
+         */
+        template <typename F>
+        void run (const std::string& name, const std::size_t param, const std::size_t items, F f)
+        {
+            const std::string full_name = name + "/" + std::to_string (param);
+            if (!this->selected (full_name)) { return; }
+
+            using sc = std::chrono::steady_clock;
+            f(); // warm up caches and any allocations
+            std::uint64_t n = 1;
+            double elapsed = 0.0;
+            double cpu_elapsed = 0.0;
+            for (;;) {
+                const std::clock_t c0 = std::clock();
+                const sc::time_point t0 = sc::now();
+                for (std::uint64_t i = 0; i < n; ++i) { f(); }
+                elapsed = std::chrono::duration<double>(sc::now() - t0).count();
+                cpu_elapsed = static_cast<double>(std::clock() - c0) / CLOCKS_PER_SEC;
+                if (elapsed >= this->min_time || n >= (std::uint64_t{1} << 40)) { break; }
+                // Aim a little beyond the minimum time with the next batch
+                n = elapsed > 0.0 ? std::max (2 * n, static_cast<std::uint64_t>(1.2 * this->min_time / elapsed * n)) : 2 * n;
+            }
+
+            result r;
+            r.name = full_name;
+            r.iterations = n;
+            r.ns_per_iter = elapsed * 1e9 / static_cast<double>(n);
+            r.cpu_ns_per_iter = cpu_elapsed * 1e9 / static_cast<double>(n);
+            if (items > 0) { r.items_per_second = static_cast<double>(items) * static_cast<double>(n) / elapsed; }
+            this->add (r);
+        }
+
+        //! Add a result that was measured by the program itself (such as a run of rendered frames)
+        void add (const result& r)
+        {
+            this->results.push_back (r);
+            std::cout << std::left << std::setw (48) << r.name << std::right << std::setw (14) << std::fixed
+                      << std::setprecision (0) << r.ns_per_iter << " ns" << std::setw (12) << r.iterations;
+            if (r.items_per_second > 0.0) { std::cout << std::setw (14) << std::setprecision (3) << r.items_per_second / 1e6 << " M items/s"; }
+            for (auto [k, c] : r.counters) { std::cout << "  " << k << "=" << std::setprecision (3) << c; }
+            std::cout << std::endl;
+        }
+
+        //! Write the JSON file, if one was requested. Returns the program's exit code.
+        int finish() const
+        {
+            if (this->json_path.empty()) { return 0; }
+            std::ofstream fout (this->json_path, std::ios::out | std::ios::trunc);
+            if (!fout.is_open()) {
+                std::cerr << "Failed to open " << this->json_path << " for writing\n";
+                return -1;
+            }
+            const std::time_t now = std::time (nullptr);
+            char date[32] = {};
+            std::strftime (date, sizeof (date), "%Y-%m-%dT%H:%M:%S", std::localtime (&now));
+            fout << "{\n  \"context\": {\n    \"date\": \"" << date << "\",\n"
+                 << "    \"library_version\": \"mathplot " << mplot::version_string() << "\",\n"
+                 << "    \"min_time\": " << this->min_time << "\n  },\n  \"benchmarks\": [\n";
+            fout << std::setprecision (6);
+            for (std::size_t i = 0; i < this->results.size(); ++i) {
+                const result& r = this->results[i];
+                fout << "    {\"name\": \"" << r.name << "\", \"run_type\": \"iteration\", \"iterations\": " << r.iterations
+                     << ", \"real_time\": " << r.ns_per_iter << ", \"cpu_time\": " << r.cpu_ns_per_iter
+                     << ", \"time_unit\": \"ns\"";
+                if (r.items_per_second > 0.0) { fout << ", \"items_per_second\": " << r.items_per_second; }
+                for (auto [k, c] : r.counters) { fout << ", \"" << k << "\": " << c; }
+                fout << "}" << (i + 1 < this->results.size() ? ",\n" : "\n");
+            }
+            fout << "  ]\n}\n";
+            std::cout << "Wrote " << this->results.size() << " results to " << this->json_path << std::endl;
+            return 0;
+        }
+
+    private:
+        std::string json_path;
+        std::string filter;
+        std::map<std::string, std::string> options;
+        double min_time = 0.5;
+        std::vector<result> results;
+    };
+
+} // namespace bench
@@ -0,0 +1,62 @@
+/*
+ * Benchmarks of HexGridVisual::computeHexes (the default HexVisMode::HexInterp) and of
+ * HexVisMode::Triangles at several grid sizes. The vertices are computed without any OpenGL
+ * context, so no display (or GPU) is needed.
+ *
+ * Run with --json=results.json to save the results (see bench.h).
+ */
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstddef>
+
+#include <sm/vec>
+#include <sm/hexgrid>
+
+#include <mplot/VisualHeadless.h> // for the GL headers; no Visual is created
+#include <mplot/HexGridVisual.h>
+
+#include "bench.h"
+
+// Gives a HexGridVisual a rebuild() that recomputes its vertices without uploading them
+struct rebuildable_hgv : public mplot::HexGridVisual<float>
+{
+    using mplot::HexGridVisual<float>::HexGridVisual;
+
+    void rebuild()
+    {
+        this->vertexPositions.clear();
+        this->vertexNormals.clear();
+        this->vertexColors.clear();
+        this->indices.clear();
+        this->idx = 0u;
+        this->compute_vertices();
+        bench::sink = bench::sink + this->vertexPositions.size();
+    }
+};
+
+int main (int argc, char** argv)
+{
+    try {
+        bench::runner b (argc, argv);
+        // Hex to hex distances giving grids of about 3600, 36000 and 360000 hexes
+        for (float d : { 0.02f, 0.0064f, 0.002f }) {
+            sm::hexgrid hg (d, 3.0f, 0.0f);
+            hg.setEllipticalBoundary (1.0f, 1.0f);
+            std::vector<float> data (hg.num(), 0.0f);
+            for (unsigned int hi = 0; hi < hg.num(); ++hi) { data[hi] = 0.5f + 0.5f * std::sin (10.0f * hg.d_x[hi]); }
+
+            for (auto [mode, name] : { std::pair{ mplot::HexVisMode::HexInterp, "HexGridVisual::computeHexes" },
+                                       std::pair{ mplot::HexVisMode::Triangles, "HexGridVisual::initializeVerticesTris" } }) {
+                rebuildable_hgv hgv (&hg, sm::vec<float>{});
+                hgv.hexVisMode = mode;
+                hgv.setScalarData (&data);
+                b.run (name, hg.num(), hg.num(), [&hgv]() { hgv.rebuild(); });
+            }
+        }
+        return b.finish();
+    } catch (const std::exception& e) {
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        return -1;
+    }
+}
@@ -0,0 +1,261 @@
+/*
+ * End-to-end render benchmarks. Canonical scenes (a million element hex grid, a ten million point
+ * graph, a 100k point scatter plot, 5000 small models and a graph with many text labels) are
+ * built in a headless Visual and rendered off-screen, frame after frame, with their vertex
+ * buffers in each buffer mode (the default static buffers, streaming buffers and compact
+ * vertices). For each, the frames per second and frame time percentiles are measured with the
+ * scene unchanged, then again with the scene's models re-uploaded every frame, which also gives
+ * the upload bandwidth.
+ *
+ * Options (as well as those in bench.h):
+ *   --frames=n   Render n frames for each measurement (default 200)
+ *   --scale=f    Scale the sizes of the scenes by f (0.01, say, on a small GPU such as the Pi's)
+ *   --width=w --height=h   The size of the framebuffer (default 1920 by 1080)
+ *
+ * bench_render is built for OpenGL 4.5, so that streaming buffers are persistently mapped, and
+ * bench_render_es for OpenGL ES 3.1 (for the Raspberry Pi).
+ */
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+
+#include <sm/vec>
+#include <sm/vvec>
+#ifdef BENCH_HEXGRID
+# include <sm/hexgrid>
+#endif
+
+#include <mplot/VisualHeadless.h>
+#include <mplot/VisualModel.h>
+#include <mplot/GraphVisual.h>
+#include <mplot/ScatterVisual.h>
+#ifdef BENCH_HEXGRID
+# include <mplot/HexGridVisual.h>
+#endif
+
+#include "bench.h"
+
+#ifdef BENCH_GLES
+constexpr int glver = mplot::gl::version_3_1_es;
+#else
+constexpr int glver = mplot::gl::version_4_5;
+#endif
+
+enum class buffer_mode { standard, streaming, compact };
+
+const char* mode_name (const buffer_mode m)
+{
+    switch (m) {
+    case buffer_mode::streaming: return "streaming";
+    case buffer_mode::compact: return "compact";
+    case buffer_mode::standard:
+    default: return "static";
+    }
+}
+
+void set_mode (mplot::VisualModel<glver>* m, const buffer_mode mode)
+{
+    if (mode == buffer_mode::streaming) { m->setStreaming(); }
+    if (mode == buffer_mode::compact) { m->setCompactVertices(); }
+}
+
+// A small model: one sphere
+struct sphere_model : public mplot::VisualModel<glver>
+{
+    sphere_model (const sm::vec<float> _p) : p(_p) {}
+    void initializeVertices() { this->computeSphere (this->p, mplot::colour::crimson, 0.004f, 8, 10); }
+    sm::vec<float> p = {};
+};
+
+// A scene: the models in the Visual, the number of elements (hexes, points, models) and the data that they refer to
+struct scene
+{
+    std::vector<mplot::VisualModel<glver>*> models;
+    std::size_t n = 0;
+#ifdef BENCH_HEXGRID
+    std::unique_ptr<sm::hexgrid> hg;
+#endif
+    std::vector<float> data;
+    std::vector<sm::vec<float>> coords;
+};
+
+template <typename T>
+void add (scene& s, mplot::VisualHeadless<glver>& v, std::unique_ptr<T>& m, const buffer_mode mode)
+{
+    set_mode (m.get(), mode);
+    m->finalize();
+    s.models.push_back (v.addVisualModel (m));
+}
+
+#ifdef BENCH_HEXGRID
+void hexgrid_scene (scene& s, mplot::VisualHeadless<glver>& v, const buffer_mode mode, const double scale)
+{
+    // A circle of radius 1 holds about 1M hexes with a hex to hex distance of 0.0019
+    s.hg = std::make_unique<sm::hexgrid> (static_cast<float>(0.0019 / std::sqrt (scale)), 2.2f, 0.0f);
+    s.hg->setEllipticalBoundary (1.0f, 1.0f);
+    s.n = s.hg->num();
+    s.data.resize (s.n);
+    for (std::size_t i = 0; i < s.n; ++i) { s.data[i] = 0.5f + 0.5f * std::sin (10.0f * s.hg->d_x[i]) * std::cos (7.0f * s.hg->d_y[i]); }
+    auto hgv = std::make_unique<mplot::HexGridVisual<float, glver>> (s.hg.get(), sm::vec<float>{});
+    v.bindmodel (hgv);
+    hgv->hexVisMode = mplot::HexVisMode::Triangles;
+    hgv->setScalarData (&s.data);
+    add (s, v, hgv, mode);
+}
+#endif
+
+void graph_scene (scene& s, mplot::VisualHeadless<glver>& v, const buffer_mode mode, const double scale)
+{
+    s.n = static_cast<std::size_t>(1e7 * scale);
+    sm::vvec<float> x;
+    x.linspace (0.0f, 1.0f, s.n);
+    sm::vvec<float> y = x;
+    for (auto& yi : y) { yi = std::sin (200.0f * yi); }
+    auto gv = std::make_unique<mplot::GraphVisual<float, glver>> (sm::vec<float>{ -0.5f, -0.5f, 0.0f });
+    v.bindmodel (gv);
+    mplot::DatasetStyle ds (mplot::stylepolicy::lines);
+    gv->setdata (x, y, ds);
+    add (s, v, gv, mode);
+}
+
+void scatter_scene (scene& s, mplot::VisualHeadless<glver>& v, const buffer_mode mode, const double scale)
+{
+    s.n = static_cast<std::size_t>(1e5 * scale);
+    s.coords.resize (s.n);
+    s.data.resize (s.n);
+    for (std::size_t i = 0; i < s.n; ++i) {
+        const float t = static_cast<float>(i) / static_cast<float>(s.n);
+        s.coords[i] = { std::cos (97.0f * t), std::sin (97.0f * t), std::sin (13.0f * t) };
+        s.data[i] = t;
+    }
+    auto sv = std::make_unique<mplot::ScatterVisual<float, glver>> (sm::vec<float>{});
+    v.bindmodel (sv);
+    sv->setDataCoords (&s.coords);
+    sv->setScalarData (&s.data);
+    sv->radiusFixed = 0.005f;
+    add (s, v, sv, mode);
+}
+
+void models_scene (scene& s, mplot::VisualHeadless<glver>& v, const buffer_mode mode, const double scale)
+{
+    s.n = std::max (std::size_t{1}, static_cast<std::size_t>(5000 * scale));
+    const std::size_t side = static_cast<std::size_t>(std::ceil (std::sqrt (static_cast<double>(s.n))));
+    for (std::size_t i = 0; i < s.n; ++i) {
+        auto m = std::make_unique<sphere_model> (sm::vec<float>{ 0.01f * (i % side), 0.01f * (i / side), 0.0f });
+        v.bindmodel (m);
+        add (s, v, m, mode);
+    }
+}
+
+void text_graph_scene (scene& s, mplot::VisualHeadless<glver>& v, const buffer_mode mode, const double scale)
+{
+    // A graph of a thousand points, each labelled
+    s.n = std::max (std::size_t{1}, static_cast<std::size_t>(1000 * scale));
+    sm::vvec<float> x;
+    x.linspace (0.0f, 1.0f, s.n);
+    sm::vvec<float> y = x;
+    for (auto& yi : y) { yi = 0.5f + 0.5f * std::sin (20.0f * yi); }
+    auto gv = std::make_unique<mplot::GraphVisual<float, glver>> (sm::vec<float>{ -0.5f, -0.5f, 0.0f });
+    v.bindmodel (gv);
+    gv->setdata (x, y);
+    for (std::size_t i = 0; i < s.n; ++i) {
+        gv->addLabel ("p" + std::to_string (i), sm::vec<float>{ x[i], y[i], 0.0f }, mplot::TextFeatures (0.01f));
+    }
+    add (s, v, gv, mode);
+}
+
+struct frame_run
+{
+    std::vector<double> frame_ms;
+    mplot::upload_stats uploads;
+};
+
+// Render frames, re-uploading every model before each frame if update is true
+frame_run render_frames (mplot::VisualHeadless<glver>& v, const scene& s, const unsigned int frames, const bool update)
+{
+    using sc = std::chrono::steady_clock;
+    frame_run r;
+    v.renderFrame (true); // Any uploads left from finalize
+    v.resetUploadStats();
+    for (unsigned int f = 0; f < frames; ++f) {
+        const sc::time_point t0 = sc::now();
+        if (update) { for (auto m : s.models) { m->reinit_buffers(); } }
+        v.renderFrame (true);
+        r.frame_ms.push_back (std::chrono::duration<double, std::milli>(sc::now() - t0).count());
+    }
+    r.uploads = v.getUploadStats();
+    return r;
+}
+
+bench::result frame_result (const std::string& name, const std::size_t n, const frame_run& r, const double build_ms)
+{
+    double total_ms = 0.0;
+    for (auto t : r.frame_ms) { total_ms += t; }
+    bench::result res;
+    res.name = name + "/" + std::to_string (n);
+    res.iterations = r.frame_ms.size();
+    res.ns_per_iter = total_ms * 1e6 / static_cast<double>(r.frame_ms.size());
+    res.cpu_ns_per_iter = res.ns_per_iter;
+    res.counters.push_back ({ "fps", 1e3 * static_cast<double>(r.frame_ms.size()) / total_ms });
+    res.counters.push_back ({ "p50_ms", bench::percentile (r.frame_ms, 50.0) });
+    res.counters.push_back ({ "p90_ms", bench::percentile (r.frame_ms, 90.0) });
+    res.counters.push_back ({ "p99_ms", bench::percentile (r.frame_ms, 99.0) });
+    res.counters.push_back ({ "build_ms", build_ms });
+    const double bytes = static_cast<double>(r.uploads.total_bytes());
+    if (bytes > 0.0) {
+        res.counters.push_back ({ "upload_bytes_per_frame", bytes / static_cast<double>(r.frame_ms.size()) });
+        if (r.uploads.upload_ms > 0.0) { res.counters.push_back ({ "upload_MB_per_s", bytes / (r.uploads.upload_ms * 1e3) }); }
+    }
+    return res;
+}
+
+int main (int argc, char** argv)
+{
+    try {
+        bench::runner b (argc, argv);
+        const unsigned int frames = static_cast<unsigned int>(b.option ("frames", 200));
+        const double scale = b.option ("scale", 1.0);
+        const int w = static_cast<int>(b.option ("width", 1920));
+        const int h = static_cast<int>(b.option ("height", 1080));
+
+        mplot::VisualHeadless<glver> v (w, h, "bench_render");
+        v.showCoordArrows (false);
+
+        using scene_fn = void(*)(scene&, mplot::VisualHeadless<glver>&, const buffer_mode, const double);
+        const std::vector<std::pair<std::string, scene_fn>> scenes = {
+#ifdef BENCH_HEXGRID
+            { "hexgrid", hexgrid_scene },
+#endif
+            { "graph", graph_scene },
+            { "scatter", scatter_scene },
+            { "models", models_scene },
+            { "text_graph", text_graph_scene }
+        };
+
+        for (auto [scene_name, make_scene] : scenes) {
+            for (buffer_mode mode : { buffer_mode::standard, buffer_mode::streaming, buffer_mode::compact }) {
+                const std::string name = "render/" + scene_name + "/" + mode_name (mode);
+                if (!b.selected (name)) { continue; }
+
+                scene s;
+                const auto t0 = std::chrono::steady_clock::now();
+                make_scene (s, v, mode, scale);
+                v.renderFrame (true); // the first upload
+                const double build_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+                b.add (frame_result (name + "/static", s.n, render_frames (v, s, frames, false), build_ms));
+                b.add (frame_result (name + "/reupload", s.n, render_frames (v, s, frames, true), build_ms));
+
+                for (auto m : s.models) { v.removeVisualModel (m); }
+            }
+        }
+        return b.finish();
+    } catch (const std::exception& e) {
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        return -1;
+    }
+}
@@ -0,0 +1,195 @@
+/*
+ * Time-to-first-frame benchmarks. For each scene (the helloworld, graph1 and hexgrid examples,
+ * and a showcase-like scene of several models with labels, coordinate arrows and a title), a new
+ * headless Visual is constructed, the scene is built and one frame is rendered, and the phases
+ * of the startup are read from Visual::getStartupProfile (see mplot/startup_profile.h). This is
+ * repeated; the first run of each scene (the cold start, which also pays the process's one-time
+ * costs) is reported apart from the median of the others (the warm starts).
+ *
+ * Each result's time is the time to the first frame, and its counters are the milliseconds of
+ * each phase. Options (as well as those in bench.h):
+ *   --runs=n   Start each scene n times (default 10)
+ *   --width=w --height=h   The size of the framebuffer (default 1024 by 768)
+ */
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <cmath>
+#include <algorithm>
+#include <cstddef>
+
+#include <sm/vec>
+#include <sm/vvec>
+#ifdef BENCH_HEXGRID
+# include <sm/hexgrid>
+#endif
+
+#include <mplot/VisualHeadless.h>
+#include <mplot/VisualModel.h>
+#include <mplot/GraphVisual.h>
+#include <mplot/ScatterVisual.h>
+#ifdef BENCH_HEXGRID
+# include <mplot/HexGridVisual.h>
+#endif
+
+#include "bench.h"
+
+constexpr int glver = mplot::gl::version_4_5;
+using visual = mplot::VisualHeadless<glver>;
+
+// The data that a scene's models refer to, which must outlive the first frame
+struct scene_data
+{
+#ifdef BENCH_HEXGRID
+    std::unique_ptr<sm::hexgrid> hg;
+#endif
+    std::vector<float> data;
+    std::vector<sm::vec<float>> coords;
+};
+
+// examples/helloworld.cpp: one label
+void helloworld_scene (visual& v, scene_data&)
+{
+    v.addLabel ("Hello World!", { 0.0f, 0.0f, 0.0f });
+}
+
+// examples/graph1.cpp: a graph of 14 points
+void graph1_scene (visual& v, scene_data&)
+{
+    auto gv = std::make_unique<mplot::GraphVisual<double, glver>> (sm::vec<float>{ 0.0f, 0.0f, 0.0f });
+    v.bindmodel (gv);
+    sm::vvec<double> x;
+    x.linspace (-0.5, 0.8, 14);
+    gv->setdata (x, x.pow (3));
+    gv->finalize();
+    v.addVisualModel (gv);
+}
+
+#ifdef BENCH_HEXGRID
+// examples/hexgrid.cpp: a hex grid of about 50,000 hexes with a label and the coordinate arrows
+void hexgrid_scene (visual& v, scene_data& d)
+{
+    v.showCoordArrows (true);
+    v.addLabel ("This is a\nmplot::HexGridVisual\nobject", { 0.26f, -0.16f, 0.0f });
+    d.hg = std::make_unique<sm::hexgrid> (0.01f, 3.0f, 0.0f);
+    d.hg->setCircularBoundary (0.6f);
+    d.data.assign (d.hg->num(), 0.0f);
+    for (unsigned int i = 0; i < d.hg->num(); ++i) {
+        d.data[i] = 0.05f + 0.05f * std::sin (20.0f * d.hg->d_x[i]) * std::sin (10.0f * d.hg->d_y[i]);
+    }
+    auto hgv = std::make_unique<mplot::HexGridVisual<float, glver>> (d.hg.get(), sm::vec<float>{ 0.0f, -0.05f, 0.0f });
+    v.bindmodel (hgv);
+    hgv->setScalarData (&d.data);
+    hgv->hexVisMode = mplot::HexVisMode::HexInterp;
+    hgv->finalize();
+    v.addVisualModel (hgv);
+}
+#endif
+
+// Like examples/showcase.cpp: graphs and a scatter plot, each labelled, with the arrows and title
+void showcase_scene (visual& v, scene_data& d)
+{
+    v.showCoordArrows (true);
+    v.showTitle (true);
+    for (int g = 0; g < 3; ++g) {
+        auto gv = std::make_unique<mplot::GraphVisual<float, glver>> (sm::vec<float>{ 1.2f * g, 0.0f, 0.0f });
+        v.bindmodel (gv);
+        sm::vvec<float> x;
+        x.linspace (0.0f, 1.0f, 50);
+        gv->setdata (x, x.pow (g + 1));
+        gv->addLabel ("mplot::GraphVisual " + std::to_string (g), sm::vec<float>{ 0.0f, -0.25f, 0.0f }, mplot::TextFeatures (0.05f));
+        gv->finalize();
+        v.addVisualModel (gv);
+    }
+    const std::size_t n = 2000;
+    d.coords.resize (n);
+    d.data.resize (n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const float t = static_cast<float>(i) / static_cast<float>(n);
+        d.coords[i] = { std::cos (97.0f * t), std::sin (97.0f * t), std::sin (13.0f * t) };
+        d.data[i] = t;
+    }
+    auto sv = std::make_unique<mplot::ScatterVisual<float, glver>> (sm::vec<float>{ 0.0f, 1.5f, 0.0f });
+    v.bindmodel (sv);
+    sv->setDataCoords (&d.coords);
+    sv->setScalarData (&d.data);
+    sv->radiusFixed = 0.02f;
+    sv->addLabel ("mplot::ScatterVisual", sm::vec<float>{ 0.0f, -1.2f, 0.0f }, mplot::TextFeatures (0.05f));
+    sv->finalize();
+    v.addVisualModel (sv);
+}
+
+// Start a Visual, build the scene and draw one frame; return the startup profile
+mplot::startup_profile start (void (*make_scene)(visual&, scene_data&), const int w, const int h)
+{
+    scene_data d;
+    visual v (w, h, "bench_startup", false);
+    make_scene (v, d);
+    v.renderFrame (true);
+    return v.getStartupProfile();
+}
+
+// A result for the profiles ps: the median time to the first frame and of each phase
+bench::result startup_result (const std::string& name, const std::vector<mplot::startup_profile>& ps)
+{
+    bench::result r;
+    r.name = name;
+    r.iterations = ps.size();
+    std::vector<double> ttff;
+    std::map<std::string, std::vector<double>> phase_ms;
+    std::vector<std::string> order;
+    std::vector<double> glyph_ms;
+    std::vector<double> finalize_ms;
+    for (const auto& p : ps) {
+        ttff.push_back (p.first_frame_ms);
+        glyph_ms.push_back (p.glyph_ms);
+        finalize_ms.push_back (p.finalize_ms);
+        for (const auto& ph : p.phases) {
+            if (phase_ms.count (ph.name) == 0) { order.push_back (ph.name); }
+            phase_ms[ph.name].push_back (ph.ms);
+        }
+    }
+    r.ns_per_iter = bench::percentile (ttff, 50.0) * 1e6;
+    r.cpu_ns_per_iter = r.ns_per_iter;
+    for (const auto& n : order) { r.counters.push_back ({ n + "_ms", bench::percentile (phase_ms[n], 50.0) }); }
+    r.counters.push_back ({ "glyphs_ms", bench::percentile (glyph_ms, 50.0) });
+    r.counters.push_back ({ "finalize_ms", bench::percentile (finalize_ms, 50.0) });
+    return r;
+}
+
+int main (int argc, char** argv)
+{
+    try {
+        bench::runner b (argc, argv);
+        const unsigned int runs = std::max (2u, static_cast<unsigned int>(b.option ("runs", 10)));
+        const int w = static_cast<int>(b.option ("width", 1024));
+        const int h = static_cast<int>(b.option ("height", 768));
+
+        using scene_fn = void(*)(visual&, scene_data&);
+        const std::vector<std::pair<std::string, scene_fn>> scenes = {
+            { "helloworld", helloworld_scene },
+            { "graph1", graph1_scene },
+#ifdef BENCH_HEXGRID
+            { "hexgrid", hexgrid_scene },
+#endif
+            { "showcase", showcase_scene }
+        };
+
+        for (auto [scene_name, make_scene] : scenes) {
+            const std::string name = "startup/" + scene_name;
+            if (!b.selected (name)) { continue; }
+            std::vector<mplot::startup_profile> cold = { start (make_scene, w, h) };
+            std::vector<mplot::startup_profile> warm;
+            for (unsigned int i = 1; i < runs; ++i) { warm.push_back (start (make_scene, w, h)); }
+            b.add (startup_result (name + "/cold", cold));
+            b.add (startup_result (name + "/warm", warm));
+            std::cout << warm.back().summary() << std::endl;
+        }
+        return b.finish();
+    } catch (const std::exception& e) {
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        return -1;
+    }
+}
@@ -0,0 +1,260 @@
+/*
+ * Benchmarks of the CPU work of building mathplot models: the VisualModel primitives,
+ * GridVisual's pixels, ColourMap::convert for every ColourMapType, GraphVisual::setdata and
+ * append and Visual::savegltf.
+ *
+ * The vertices are computed without any OpenGL context. The GraphVisual and savegltf benchmarks
+ * need a Visual, for which a headless one is used (so no display is needed, but a GPU render
+ * node is); if it can't be created, those benchmarks are skipped.
+ *
+ * Run with --json=results.json to save the results (see bench.h).
+ */
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <array>
+#include <span>
+
+#include <sm/vec>
+#include <sm/vvec>
+#include <sm/grid>
+
+#include <mplot/VisualHeadless.h>
+#include <mplot/VisualModel.h>
+#include <mplot/GridVisual.h>
+#include <mplot/GraphVisual.h>
+#include <mplot/ColourMap.h>
+#include <mplot/graphing.h>
+
+#include "bench.h"
+
+// Gives a model a rebuild() that recomputes its vertices without uploading them, so no GL is needed
+template <typename M>
+struct rebuildable : public M
+{
+    using M::M;
+
+    void rebuild()
+    {
+        this->vertexPositions.clear();
+        this->vertexNormals.clear();
+        this->vertexColors.clear();
+        this->indices.clear();
+        this->idx = 0u;
+        this->compute_vertices();
+        bench::sink = bench::sink + this->vertexPositions.size();
+    }
+
+    std::size_t n_vertices() const { return this->vertexPositions.size() / 3u; }
+};
+
+enum class primitive { sphere, tube, flat_line };
+
+// A model made of n copies of one primitive
+struct primitives_model : public mplot::VisualModel<>
+{
+    primitives_model (const primitive _what, const unsigned int _n) : what(_what), n(_n) {}
+
+    void initializeVertices()
+    {
+        for (unsigned int i = 0; i < this->n; ++i) {
+            const sm::vec<float> p = { 0.01f * i, 0.0f, 0.0f };
+            switch (this->what) {
+            case primitive::sphere:
+                this->computeSphere (p, mplot::colour::crimson, 0.005f, 10, 12);
+                break;
+            case primitive::tube:
+                this->computeTube (p, p + sm::vec<float>{ 0.0f, 0.1f, 0.0f },
+                                   mplot::colour::crimson, mplot::colour::dodgerblue2, 0.005f, 12);
+                break;
+            case primitive::flat_line:
+            default:
+                this->computeFlatLine (p, p + sm::vec<float>{ 0.0f, 0.1f, 0.0f }, this->uz, mplot::colour::black, 0.002f);
+                break;
+            }
+        }
+    }
+
+    primitive what = primitive::sphere;
+    unsigned int n = 0;
+};
+
+void bench_primitives (bench::runner& b)
+{
+    const std::vector<std::pair<primitive, std::string>> prims = {
+        { primitive::sphere, "VisualModel::computeSphere" },
+        { primitive::tube, "VisualModel::computeTube" },
+        { primitive::flat_line, "VisualModel::computeFlatLine" }
+    };
+    for (auto [what, name] : prims) {
+        for (unsigned int n : { 10u, 1000u }) {
+            rebuildable<primitives_model> m (what, n);
+            m.rebuild();
+            b.run (name, n, m.n_vertices(), [&m]() { m.rebuild(); });
+        }
+    }
+}
+
+void bench_grid_pixels (bench::runner& b)
+{
+    for (unsigned int side : { 100u, 500u, 1000u }) {
+        sm::grid g (side, side, sm::vec<float, 2>{ 1.0f / side, 1.0f / side });
+        std::vector<float> data (g.n(), 0.0f);
+        for (unsigned int i = 0; i < g.n(); ++i) {
+            auto c = g[i];
+            data[i] = 0.5f + 0.5f * std::sin (20.0f * c[0]) * std::sin (10.0f * c[1]);
+        }
+        rebuildable<mplot::GridVisual<float>> gv (&g, sm::vec<float>{});
+        gv.gridVisMode = mplot::GridVisMode::Pixels;
+        gv.setScalarData (&data);
+        b.run ("GridVisual::initializeVerticesPixels", side * side, g.n(), [&gv]() { gv.rebuild(); });
+    }
+}
+
+void bench_colourmaps (bench::runner& b)
+{
+    constexpr std::size_t n = 100000;
+    std::vector<float> data (n);
+    for (std::size_t i = 0; i < n; ++i) { data[i] = static_cast<float>(i) / static_cast<float>(n - 1); }
+    std::vector<float> rgb;
+    for (mplot::ColourMapType t = mplot::ColourMapType::Magma;; ) {
+        mplot::ColourMap<float> cm (t);
+        const std::string name = "ColourMap::convert<" + mplot::ColourMap<float>::colourMapTypeToStr (t) + ">";
+        b.run (name, n, n, [&cm, &data, &rgb]() {
+            cm.convert (data, rgb);
+            bench::sink = bench::sink + rgb.size();
+        });
+        if (++t == mplot::ColourMapType::Magma) { break; }
+    }
+}
+
+void bench_ticks (bench::runner& b)
+{
+    constexpr std::size_t n = 10000;
+    const sm::range<float> nticks = {3.0f, 10.0f};
+    b.run ("graphing::maketicks<deque>", n, n, [nticks]() {
+        for (std::size_t i = 0; i < n; ++i) {
+            const float mx = 1.0f + static_cast<float>(i);
+            bench::sink = bench::sink + mplot::graphing::maketicks (-mx, mx, -mx, mx, nticks).size();
+        }
+    });
+    b.run ("graphing::maketicks<span>", n, n, [nticks]() {
+        std::array<float, 100> buf;
+        for (std::size_t i = 0; i < n; ++i) {
+            const float mx = 1.0f + static_cast<float>(i);
+            bench::sink = bench::sink + mplot::graphing::maketicks (-mx, mx, -mx, mx, nticks, std::span<float>(buf));
+        }
+    });
+    b.run ("graphing::number_format<string>", n, n, []() {
+        for (std::size_t i = 0; i < n; ++i) {
+            const float x = 0.05f * static_cast<float>(i);
+            bench::sink = bench::sink + mplot::graphing::number_format (x, x + 0.05f).size();
+        }
+    });
+    b.run ("graphing::number_format<span>", n, n, []() {
+        std::array<char, 32> buf;
+        for (std::size_t i = 0; i < n; ++i) {
+            const float x = 0.05f * static_cast<float>(i);
+            bench::sink = bench::sink + mplot::graphing::number_format (std::span<char>(buf), x, x + 0.05f);
+        }
+    });
+}
+
+void bench_graph (bench::runner& b, mplot::VisualHeadless<>& v)
+{
+    for (unsigned int n : { 100u, 10000u }) {
+        sm::vvec<float> x;
+        x.linspace (-1.0f, 1.0f, n);
+        const sm::vvec<float> y = x.pow (3);
+        b.run ("GraphVisual::setdata+finalize", n, n, [&v, &x, &y]() {
+            auto gv = std::make_unique<mplot::GraphVisual<float>> (sm::vec<float>{});
+            v.bindmodel (gv);
+            gv->setdata (x, y);
+            gv->finalize();
+            bench::sink = bench::sink + gv->get_upload_stats().finalizes;
+        });
+    }
+
+    // Every point of large line and marker datasets (with no decimation)
+    for (auto policy : { mplot::stylepolicy::lines, mplot::stylepolicy::markers }) {
+        const unsigned int n = 1000000u;
+        sm::vvec<float> x;
+        x.linspace (-1.0f, 1.0f, n);
+        const sm::vvec<float> y = x.pow (3);
+        const std::string name = policy == mplot::stylepolicy::lines ? "GraphVisual::setdata+finalize/lines" : "GraphVisual::setdata+finalize/markers";
+        b.run (name, n, n, [&v, &x, &y, policy]() {
+            auto gv = std::make_unique<mplot::GraphVisual<float>> (sm::vec<float>{});
+            v.bindmodel (gv);
+            gv->lod_columns = 0;
+            mplot::DatasetStyle ds (policy);
+            gv->setdata (x, y, ds);
+            gv->finalize();
+            bench::sink = bench::sink + gv->get_upload_stats().finalizes;
+        });
+    }
+
+    // Append data to a graph with fixed axes, rendering after each batch (which computes and
+    // uploads only the appended vertices)
+    for (unsigned int batch : { 1u, 100u }) {
+        auto gv = std::make_unique<mplot::GraphVisual<float>> (sm::vec<float>{});
+        v.bindmodel (gv);
+        gv->setlimits (0.0f, 1.0f, -1.0f, 1.0f);
+        mplot::DatasetStyle ds;
+        gv->prepdata (ds);
+        gv->finalize();
+        auto gp = v.addVisualModel (gv);
+        float x = 0.0f;
+        b.run ("GraphVisual::append+render", batch, batch, [&v, gp, batch, &x]() {
+            for (unsigned int i = 0; i < batch; ++i) {
+                x = x >= 1.0f ? 0.0f : x + 1e-6f;
+                gp->append (x, std::sin (20.0f * x), 0);
+            }
+            v.render();
+        });
+        v.removeVisualModel (gp);
+    }
+}
+
+void bench_gltf (bench::runner& b, mplot::VisualHeadless<>& v)
+{
+    for (unsigned int n : { 10u, 1000u }) {
+        auto m = std::make_unique<primitives_model> (primitive::sphere, n);
+        v.bindmodel (m);
+        m->finalize();
+        auto mp = v.addVisualModel (m);
+        const std::string path = "bench_visual.gltf";
+        b.run ("Visual::savegltf<spheres>", n, 0, [&v, &path]() { v.savegltf (path); });
+        v.removeVisualModel (mp);
+        std::remove (path.c_str());
+    }
+}
+
+int main (int argc, char** argv)
+{
+    try {
+        bench::runner b (argc, argv);
+        bench_primitives (b);
+        bench_grid_pixels (b);
+        bench_colourmaps (b);
+        bench_ticks (b);
+
+        std::unique_ptr<mplot::VisualHeadless<>> v;
+        try {
+            v = std::make_unique<mplot::VisualHeadless<>> (640, 480, "bench_visual", false);
+        } catch (const std::exception& e) {
+            std::cerr << "No headless Visual (" << e.what() << "), so skipping the GraphVisual and savegltf benchmarks\n";
+        }
+        if (v) {
+            bench_graph (b, *v);
+            bench_gltf (b, *v);
+        }
+        return b.finish();
+    } catch (const std::exception& e) {
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        return -1;
+    }
+}
@@ -0,0 +1,11 @@
+/*
+ * The explicit instantiations of mplot::ColourMap in the mplot_core library. This holds the
+ * code of the colour map tables (from colourmaps_cet.h, colourmaps_crameri.h and friends) for
+ * float and double datums.
+ */
+#include <mplot/ColourMap.h>
+
+namespace mplot {
+    template class ColourMap<float>;
+    template class ColourMap<double>;
+} // namespace mplot
@@ -0,0 +1,7 @@
+/*
+ * The fonts of the mplot_core library. This is the only translation unit that embeds the TTF
+ * files (with .incbin, or from verafonts.h with Visual Studio), and it holds the one definition
+ * of mplot::visgl::embedded_font, which the headers declare when MPLOT_CORE is defined.
+ */
+#define MPLOT_CORE_FONTS
+#include <mplot/Visual.h>
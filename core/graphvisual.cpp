@@ -0,0 +1,13 @@
+/*
+ * The explicit instantiations of mplot::GraphVisual in the mplot_core library, for float and
+ * double data and OpenGL 4.1 and 4.5.
+ */
+#include <mplot/Visual.h>
+#include <mplot/GraphVisual.h>
+
+namespace mplot {
+    template class GraphVisual<float, mplot::gl::version_4_1>;
+    template class GraphVisual<float, mplot::gl::version_4_5>;
+    template class GraphVisual<double, mplot::gl::version_4_1>;
+    template class GraphVisual<double, mplot::gl::version_4_5>;
+} // namespace mplot
@@ -0,0 +1,6 @@
+/*
+ * The lodepng implementation of the mplot_core library. This is the only translation unit that
+ * compiles it; with MPLOT_CORE defined, mplot/lodepng.h otherwise declares its functions only.
+ */
+#define MPLOT_CORE_LODEPNG
+#include <mplot/lodepng.h>
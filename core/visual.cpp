@@ -0,0 +1,34 @@
+/*
+ * The explicit instantiations of mplot::Visual and its models in the mplot_core library, for
+ * OpenGL 4.1 and 4.5 (with the multi-context GLAD functions, as mplot::Visual uses).
+ */
+#include <mplot/Visual.h>
+#include <mplot/CoordArrows.h>
+
+namespace mplot {
+    template struct VisualModelBase<mplot::gl::version_4_1>;
+    template struct VisualModelBase<mplot::gl::version_4_5>;
+    template struct VisualModelImpl<mplot::gl::version_4_1, 1>;
+    template struct VisualModelImpl<mplot::gl::version_4_5, 1>;
+    template struct VisualModel<mplot::gl::version_4_1>;
+    template struct VisualModel<mplot::gl::version_4_5>;
+
+    template struct VisualTextModelBase<mplot::gl::version_4_1>;
+    template struct VisualTextModelBase<mplot::gl::version_4_5>;
+    template class VisualTextModelImpl<mplot::gl::version_4_1, 1>;
+    template class VisualTextModelImpl<mplot::gl::version_4_5, 1>;
+    template struct VisualTextModel<mplot::gl::version_4_1>;
+    template struct VisualTextModel<mplot::gl::version_4_5>;
+
+    template class CoordArrows<mplot::gl::version_4_1>;
+    template class CoordArrows<mplot::gl::version_4_5>;
+
+    template class VisualBase<mplot::gl::version_4_1>;
+    template class VisualBase<mplot::gl::version_4_5>;
+    template class VisualOwnableMX<mplot::gl::version_4_1>;
+    template class VisualOwnableMX<mplot::gl::version_4_5>;
+    template class VisualMX<mplot::gl::version_4_1>;
+    template class VisualMX<mplot::gl::version_4_5>;
+    template struct Visual<mplot::gl::version_4_1>;
+    template struct Visual<mplot::gl::version_4_5>;
+} // namespace mplot
@@ -0,0 +1,47 @@
+/*
+ * Four windows, each showing a moving sine wave, driven from one loop by mplot::VisualManager.
+ * Only the first window waits for the display's vertical refresh, so all four update at the
+ * refresh rate (rather than at a quarter of it).
+ */
+#include <string>
+#include <vector>
+
+#include <sm/vec>
+#include <sm/vvec>
+#include <sm/mathconst>
+
+#include <mplot/Visual.h>
+#include <mplot/VisualManager.h>
+#include <mplot/GraphVisual.h>
+
+int main()
+{
+    mplot::VisualManager<> mgr;
+    std::vector<mplot::GraphVisual<double>*> graphs;
+
+    sm::vvec<double> x;
+    x.linspace (-sm::mathconst<double>::pi, sm::mathconst<double>::pi, 100);
+
+    for (int i = 0; i < 4; ++i) {
+        // The second and later windows share the first one's context (and its fonts)
+        mplot::Visual<>& v = i == 0 ? mgr.emplace (640, 480, "Window 1")
+                                    : mgr.emplace (640, 480, "Window " + std::to_string (i + 1), mgr[0]);
+        auto gv = std::make_unique<mplot::GraphVisual<double>> (sm::vec<float>({0,0,0}));
+        v.bindmodel (gv);
+        gv->setdata (x, (x * static_cast<double>(i + 1)).sin());
+        gv->setStreaming(); // The model is re-uploaded on every frame
+        gv->finalize();
+        graphs.push_back (v.addVisualModel (gv));
+    }
+
+    double dx = 0.0;
+    while (!mgr.finished()) {
+        dx += 0.01;
+        for (std::size_t i = 0; i < graphs.size(); ++i) {
+            graphs[i]->update (x, ((x + dx) * static_cast<double>(i + 1)).sin(), 0);
+        }
+        mgr.step();
+    }
+
+    return 0;
+}
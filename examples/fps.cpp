@@ -54,6 +54,10 @@ int main()
     hgv->finalize();
     auto hgvp = v.addVisualModel (hgv);
 
+    // Profile each frame and show the CPU and GPU times, the draw calls and the bytes uploaded
+    v.startProfiling();
+    v.options.set (mplot::visual_options::showProfile);
+
     using namespace std::chrono;
     using sc = std::chrono::steady_clock;
 
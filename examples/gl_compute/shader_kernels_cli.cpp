@@ -0,0 +1,83 @@
+/*
+ * Display-free GL compute example of the kernels in mplot/gl/compute_kernels.h: scan, reduce,
+ * histogram and sort a million values on the GPU, and check the results against the CPU.
+ */
+
+// You have to include the GL headers manually so that you will be sure you have the
+// right ones (see shader_naive_scan_cli.cpp)
+#include <GLES3/gl31.h>
+
+#include <iostream>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <mplot/gl/compute_manager_cli.h>
+#include <mplot/gl/compute_kernels.h>
+#include <mplot/gl/ssbo.h>
+
+namespace my {
+
+    struct compute_manager : public mplot::gl::compute_manager_cli<mplot::gl::version_3_1_es>
+    {
+        static constexpr std::size_t n = 1000000;
+
+        compute_manager()
+        {
+            this->init();
+            this->kernels.init();
+            std::mt19937 rng (42);
+            std::uniform_real_distribution<float> uf (0.0f, 1.0f);
+            this->values.data.resize (n);
+            for (auto& v : this->values.data) { v = uf (rng); }
+            this->values.init (1);
+            this->keys.data.resize (n);
+            for (auto& k : this->keys.data) { k = static_cast<unsigned int>(rng()); }
+            this->keys.init (2);
+            this->bins.init (3, 10, 0u);
+        }
+
+        void load_shaders() final {} // The kernels build their own programs
+
+        void compute() final
+        {
+            // Reduce (the range could be used on the GPU, from kernels.reduction_buffer())
+            const sm::range<float> r = this->kernels.get_range (this->values.name, n);
+            std::cout << "Range of the values: " << r.min << " to " << r.max << std::endl;
+
+            // Histogram across the range found on the GPU
+            this->kernels.histogram (this->values.name, n, this->bins.name, 10);
+            this->bins.copy_from_gpu();
+            std::cout << "Histogram of the values: " << this->bins.data << std::endl;
+
+            // Exclusive scan, checked against std::exclusive_scan (in double, as the GPU sums in float)
+            sm::vvec<double> cpu_scan (n);
+            std::exclusive_scan (this->values.data.begin(), this->values.data.end(), cpu_scan.begin(), 0.0);
+            this->kernels.scan_floats (this->values.name, n);
+            {
+                auto gpu_scan = this->values.map();
+                std::cout << "Last of the scan: GPU " << gpu_scan[n - 1] << ", CPU " << cpu_scan[n - 1] << std::endl;
+            }
+
+            // Sort, checked against std::sort
+            sm::vvec<unsigned int> cpu_sort = this->keys.data;
+            std::sort (cpu_sort.begin(), cpu_sort.end());
+            this->kernels.sort_uints (this->keys.name, n);
+            this->keys.copy_from_gpu();
+            std::cout << "The GPU sort " << (std::equal (cpu_sort.begin(), cpu_sort.end(), this->keys.data.begin()) ? "matches" : "DOES NOT match")
+                      << " the CPU sort" << std::endl;
+        }
+
+    private:
+        mplot::gl::compute_kernels<mplot::gl::version_3_1_es> kernels;
+        mplot::gl::vvec_ssbo<float> values;
+        mplot::gl::vvec_ssbo<unsigned int> keys;
+        mplot::gl::vvec_ssbo<unsigned int> bins;
+    };
+} // namespace my
+
+int main()
+{
+    my::compute_manager c;
+    c.compute();
+    return 0;
+}
@@ -88,6 +88,10 @@ namespace my {
             // Set that data into the SSBO object (where it is stored in a vec<>)
             std::copy (inputvv.begin(), inputvv.end(), this->input_ssbo.data.begin());
             this->input_ssbo.init();
+
+            // Time the dispatches on the GPU, and write the timings out every 1000 frames
+            this->compute_program.profiler = &this->profiler;
+            this->profile_every = 1000;
         }
 
         ~compute_manager()
@@ -132,7 +136,9 @@ namespace my {
             // To copy updated data:
             this->input_ssbo.data[0] = std::abs (std::sin (compstep)); // Make a pixel pulse
             compstep += 0.0001;
+            this->profiler.begin ("upload");
             this->input_ssbo.copy_to_gpu();
+            this->profiler.end();
 
             this->measure_compute(); // optional
             this->compute_program.use();
@@ -140,8 +146,12 @@ namespace my {
 
             // To retreive data from the SSBO:
             // sm::range<float> ssbo_range = this->input_ssbo.get_range();
+            // or, reading the data in place, without a copy:
+            // { auto view = this->input_ssbo.map(); float f = view[0]; } // unmapped at the brace
             // or
+            this->profiler.begin ("readback");
             this->input_ssbo.copy_from_gpu();
+            this->profiler.end();
             // and access input_ssbo.data.
         }
 
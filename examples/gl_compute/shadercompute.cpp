@@ -79,6 +79,8 @@ namespace my {
                 {GL_COMPUTE_SHADER, "../examples/gl_compute/shadercompute.glsl", mplot::gl::nonCompilingComputeShader, 0 }
             };
             this->compute_program.load_shaders (shaders);
+            // Rebuild the program when shadercompute.glsl is edited (see compute())
+            this->compute_program.watch_shaders();
 
             std::vector<mplot::gl::ShaderInfo> vtxshaders = {
                 {GL_VERTEX_SHADER, "../examples/gl_compute/shadercompute.vert.glsl", mplot::defaultVtxShader, 0 },
@@ -91,6 +93,8 @@ namespace my {
         void compute() final
         {
             this->measure_compute(); // optional
+            // Swap in the edited shader, if shadercompute.glsl has been saved (and it compiles)
+            this->compute_program.reload_if_changed();
             this->compute_program.use();
             // Set time into a uniform in the compute program
             this->compute_program.set_uniform<float> ("t", this->frame_count);
@@ -0,0 +1,51 @@
+/*
+ * Save a geodesic sphere to a .glb file, then show it again with a MeshFileVisual, which maps
+ * the file and uploads the mesh straight from it into the GPU's vertex buffers.
+ */
+#include <iostream>
+#include <string>
+#include <stdexcept>
+
+#include <sm/vec>
+
+#include <mplot/Visual.h>
+#include <mplot/ColourMap.h>
+#include <mplot/GeodesicVisual.h>
+#include <mplot/MeshFileVisual.h>
+
+int main (int argc, char** argv)
+{
+    int rtn = -1;
+    // Optionally, show mesh 0 of a glb file given on the command line instead
+    std::string glb_path = argc > 1 ? std::string(argv[1]) : std::string("./geodesic.glb");
+
+    try {
+        if (argc < 2) {
+            // Make the file: one colourful geodesic sphere, saved with Visual::saveglb
+            mplot::Visual vs(512, 512, "Saving geodesic.glb");
+            auto gv = std::make_unique<mplot::GeodesicVisual<float>> (sm::vec<float>{ 0.0f, 0.0f, 0.0f }, 1.0f);
+            vs.bindmodel (gv);
+            gv->iterations = 5;
+            gv->cm.setType (mplot::ColourMapType::Rainbow);
+            gv->finalize();
+            auto gvp = vs.addVisualModel (gv);
+            gvp->data.linspace (0.0f, 1.0f, gvp->data.size());
+            gvp->reinitColours();
+            vs.saveglb (glb_path);
+        }
+
+        mplot::Visual v(1024, 768, "A mesh mapped from a .glb file");
+        auto mfv = std::make_unique<mplot::MeshFileVisual<>> (glb_path);
+        v.bindmodel (mfv);
+        mfv->finalize();
+        v.addVisualModel (mfv);
+        v.keepOpen();
+        rtn = 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Caught exception: " << e.what() << std::endl;
+        rtn = -1;
+    }
+
+    return rtn;
+}
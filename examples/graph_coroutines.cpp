@@ -0,0 +1,73 @@
+/*
+ * Two simulations that share one window and one render thread. Each is a coroutine (see
+ * mplot/frame_tasks.h): the first redraws a sine wave on every frame, as in graph_dynamic_sine,
+ * and the second appends a point to another graph every 300 ms, as in graph_incoming_data.
+ * Neither has to guess when to call render() or for how long to wait for events;
+ * Visual::runTasks() resumes each one when its frame or its time comes.
+ */
+#include <iostream>
+#include <memory>
+
+#include <sm/vec>
+#include <sm/vvec>
+#include <sm/mathconst>
+
+#include <mplot/Visual.h>
+#include <mplot/GraphVisual.h>
+
+// Move the sine wave along on every frame
+mplot::frame_task moving_sine (mplot::Visual<>& v, mplot::GraphVisual<double>* gvp)
+{
+    sm::vvec<double> x;
+    x.linspace (-sm::mathconst<double>::pi, sm::mathconst<double>::pi, 100);
+    double dx = 0.0;
+    while (!v.readyToFinish()) {
+        dx += 0.01;
+        gvp->update (x, (x + dx).sin(), 0);
+        co_await v.next_frame();
+    }
+}
+
+// Add a point of the third power curve every 300 ms, then stop
+mplot::frame_task incoming_data (mplot::Visual<>& v, mplot::GraphVisual<float>* gvp)
+{
+    sm::vvec<float> absc;
+    absc.linspace (-1.0f, 1.0f, 21);
+    for (unsigned int i = 0; i < absc.size() && !v.readyToFinish(); ++i) {
+        gvp->append (absc[i], absc[i] * absc[i] * absc[i], 0);
+        co_await v.idle_for (300.0);
+    }
+}
+
+int main()
+{
+    mplot::Visual v(1280, 640, "Two simulations as coroutines");
+
+    auto gv1 = std::make_unique<mplot::GraphVisual<double>> (sm::vec<float>({ -1.5f, -0.5f, 0.0f }));
+    v.bindmodel (gv1);
+    sm::vvec<double> x;
+    x.linspace (-sm::mathconst<double>::pi, sm::mathconst<double>::pi, 100);
+    gv1->setdata (x, x.sin());
+    gv1->setStreaming(); // The model is re-uploaded on every frame
+    gv1->finalize();
+    auto gv1p = v.addVisualModel (gv1);
+
+    auto gv2 = std::make_unique<mplot::GraphVisual<float>> (sm::vec<float>({ 0.2f, -0.5f, 0.0f }));
+    v.bindmodel (gv2);
+    gv2->setlimits (-1, 1, -1, 1);
+    gv2->policy = mplot::stylepolicy::lines;
+    gv2->prepdata ("Third power");
+    gv2->finalize();
+    auto gv2p = v.addVisualModel (gv2);
+
+    v.spawn (moving_sine (v, gv1p));
+    v.spawn (incoming_data (v, gv2p));
+    try {
+        v.runTasks(); // until both have returned, or the window is closed
+    } catch (const std::exception& e) {
+        std::cerr << "A simulation threw: " << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
@@ -19,6 +19,7 @@ int main()
     double dx = 0.0;
 
     gv->setdata (x, (x+dx).sin());
+    gv->setStreaming(); // The model is re-uploaded on every frame
     gv->finalize();
 
     auto gvp = v.addVisualModel (gv);
@@ -0,0 +1,24 @@
+// A graph of a million points, with its line drawn by the GPU (see GraphVisual::gpu_lines)
+#include <cmath>
+#include <mplot/Visual.h>
+#include <mplot/GraphVisual.h>
+#include <sm/vvec>
+
+int main()
+{
+    mplot::Visual v(1024, 768, "GraphVisual with gpu_lines");
+    auto gv = std::make_unique<mplot::GraphVisual<double>> (sm::vec<float>({0,0,0}));
+    v.bindmodel (gv);
+    sm::vvec<double> x;
+    x.linspace (0.0, 100.0, 1000000);
+    sm::vvec<double> y = x;
+    for (auto& yi : y) { yi = std::sin (yi) * std::exp (-yi / 50.0); }
+    // Draw every point, and have the GPU expand the line rather than triangulating it here
+    gv->lod_columns = 0;
+    gv->gpu_lines = true;
+    gv->setdata (x, y);
+    gv->finalize();
+    v.addVisualModel (gv);
+    v.keepOpen();
+    return 0;
+}
@@ -0,0 +1,29 @@
+// Render a graph into a PNG with no window, as a batch job on a machine without a display might
+#include <iostream>
+#include <mplot/VisualHeadless.h>
+#include <mplot/GraphVisual.h>
+#include <sm/vvec>
+
+int main()
+{
+    // A headless 'scene environment'. saveImage renders at this size.
+    mplot::VisualHeadless<> v(1024, 768, "Made with mplot::VisualHeadless");
+    v.bgcolour = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+    auto gv = std::make_unique<mplot::GraphVisual<double>> (sm::vec<float>({-0.5f, -0.5f, 0.0f}));
+    v.bindmodel (gv);
+    sm::vvec<double> x;
+    x.linspace (-0.5, 0.8, 14);
+    gv->setdata (x, x.pow(3));
+    gv->finalize();
+    v.addVisualModel (gv);
+
+    sm::vec<int, 2> d = v.saveImage ("graph_headless.png");
+    std::cout << "Wrote a " << d << " image to graph_headless.png\n";
+
+    // An 8K image of the same scene. If this exceeds the largest renderbuffer, it is drawn in tiles.
+    d = v.saveImageOffscreen ("graph_headless_8k.png", { 7680, 4320 });
+    std::cout << "Wrote a " << d << " image to graph_headless_8k.png\n";
+
+    return d[0] > 0 ? 0 : -1;
+}
@@ -0,0 +1,44 @@
+// A 4 by 4 grid of graphs drawn as one model. The panels of each column share their x axis
+// range and those of each row share their y axis range. One panel's data grows each frame, so
+// its row and column rescale, while the other panels are left alone.
+#include <sm/vec>
+#include <sm/vvec>
+#include <sm/mathconst>
+#include <mplot/Visual.h>
+#include <mplot/PanelGrid.h>
+
+int main()
+{
+    mplot::Visual v(1280, 1024, "PanelGrid: 16 linked graphs in one model");
+
+    auto pg = std::make_unique<mplot::PanelGrid<double>> (sm::vec<float>({-2.5f, -2.0f, 0.0f}), 4, 4);
+    v.bindmodel (pg);
+
+    sm::vvec<double> x;
+    x.linspace (0.0, sm::mathconst<double>::two_pi, 200);
+
+    for (std::size_t i = 0; i < pg->n_panels(); ++i) {
+        auto& p = pg->panel (i);
+        p.xlabel = "t";
+        p.ylabel = "f" + std::to_string (i);
+        mplot::DatasetStyle ds (mplot::stylepolicy::lines);
+        ds.linecolour = mplot::colour::royalblue;
+        pg->setdata (i, x, (x * static_cast<double>(1 + i % 4)).sin() * static_cast<double>(1 + i / 4), ds);
+    }
+    pg->link_columns_x();
+    pg->link_rows_y();
+    pg->finalize();
+
+    auto pgp = v.addVisualModel (pg);
+
+    double gain = 1.0;
+    while (v.readyToFinish() == false) {
+        gain += 0.01;
+        v.waitevents (0.01667);
+        // Rescales the y axes of the row of panel 5 and leaves the other rows as they are
+        pgp->update (5, x, (x * 2.0).sin() * (2.0 * gain), 0);
+        v.render();
+    }
+
+    return 0;
+}
@@ -0,0 +1,62 @@
+/*
+ * Visualize a scrolling, oscilloscope-style graph. Each frame, new points are appended and the
+ * oldest points fall off the left hand end.
+ */
+#include <iostream>
+#include <cmath>
+
+#include <sm/vec>
+#include <sm/mathconst>
+
+#include <mplot/Visual.h>
+#include <mplot/GraphVisual.h>
+
+int main()
+{
+    int rtn = -1;
+
+    mplot::Visual v(1024, 768, "Scrolling graph");
+    v.zNear = 0.001;
+    v.backgroundWhite();
+
+    try {
+        auto gv = std::make_unique<mplot::GraphVisual<float>> (sm::vec<float>({0,0,0}));
+        v.bindmodel (gv);
+
+        // The x span of the axes sets the width of the window. 2000 points, 0.005 apart, fit it.
+        constexpr unsigned int window = 2000;
+        constexpr float dx = 0.005f;
+        gv->setsize (1.33, 1);
+        gv->setlimits (0, window * dx, -1.2, 1.2);
+        gv->setwindow (window);
+
+        gv->policy = mplot::stylepolicy::lines;
+        gv->prepdata ("sin(2" + mplot::unicode::toUtf8 (mplot::unicode::pi) + "x) + noise");
+        gv->xlabel = "x";
+        gv->ylabel = "y";
+        gv->finalize();
+
+        auto gvp = v.addVisualModel (gv);
+
+        float x = 0.0f;
+        unsigned int seed = 1u;
+        while (v.readyToFinish() == false) {
+            v.waitevents (0.018);
+            // Ten new points per frame
+            for (int i = 0; i < 10; ++i) {
+                seed = seed * 1664525u + 1013904223u;
+                float noise = 0.1f * (static_cast<float>(seed >> 8) / static_cast<float>(1u << 24) - 0.5f);
+                gvp->append (x, std::sin (sm::mathconst<float>::two_pi * x) + noise, 0);
+                x += dx;
+            }
+            v.render();
+        }
+        rtn = 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Caught exception: " << e.what() << std::endl;
+        rtn = -1;
+    }
+
+    return rtn;
+}
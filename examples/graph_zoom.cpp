@@ -0,0 +1,44 @@
+/*
+ * Zoom into ten million points with the mouse wheel. The line is drawn by the GPU (see
+ * GraphVisual::gpu_lines) and the wheel changes only its transform (GraphVisual::zoomview), so
+ * the zoom follows the wheel with no rebuild. A quarter of a second after the wheel stops, the
+ * axes and tick labels are rebuilt for the new range, and the data across it is decimated again
+ * (GraphVisual::lod_follows_view).
+ */
+#include <cmath>
+#include <mplot/Visual.h>
+#include <mplot/GraphVisual.h>
+#include <sm/vvec>
+
+struct zoomvisual final : public mplot::Visual<>
+{
+    zoomvisual (int width, int height, const std::string& title) : mplot::Visual<> (width, height, title) {}
+    mplot::GraphVisual<double>* graph = nullptr;
+protected:
+    // The wheel zooms the graph about the centre of its axes, and the second wheel pans it
+    bool scroll_callback (double xoffset, double yoffset) override
+    {
+        if (this->graph == nullptr) { return false; }
+        if (yoffset != 0.0) { this->graph->zoomview (yoffset > 0.0 ? 1.25f : 0.8f); }
+        if (xoffset != 0.0) { this->graph->panview ({ static_cast<float>(xoffset) * 0.05f, 0.0f }); }
+        return true;
+    }
+};
+
+int main()
+{
+    zoomvisual v(1024, 768, "Zoom a GraphVisual with the mouse wheel");
+    auto gv = std::make_unique<mplot::GraphVisual<double>> (sm::vec<float>({0,0,0}));
+    v.bindmodel (gv);
+    sm::vvec<double> x;
+    x.linspace (0.0, 1000.0, 10000000);
+    sm::vvec<double> y = x;
+    for (auto& yi : y) { yi = std::sin (yi) * std::sin (yi / 97.0) + 0.1 * std::sin (yi * 37.0); }
+    gv->gpu_lines = true;
+    gv->lod_follows_view = true;
+    gv->setdata (x, y);
+    gv->finalize();
+    v.graph = v.addVisualModel (gv);
+    v.keepOpen();
+    return 0;
+}
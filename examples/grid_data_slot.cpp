@@ -0,0 +1,61 @@
+/*
+ * A simulation thread publishes each step of a travelling wave into a mplot::data_slot. The
+ * GridVisual takes the latest step as it renders, so the simulation never waits for the GL
+ * context and runs at its own rate, whatever the frame rate.
+ */
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+#include <sm/vec>
+#include <sm/grid>
+
+#include <mplot/Visual.h>
+#include <mplot/GridVisual.h>
+#include <mplot/data_slot.h>
+
+int main()
+{
+    mplot::Visual v(1024, 768, "Data published from a simulation thread");
+
+    constexpr unsigned int Nside = 200;
+    sm::grid grid (Nside, Nside, sm::vec<float, 2>{ 0.01f, 0.01f });
+    std::vector<float> data (grid.n(), 0.0f);
+
+    mplot::data_slot<float> slot;
+
+    auto gv = std::make_unique<mplot::GridVisual<float>> (&grid, sm::vec<float>{ -1.0f, -1.0f, 0.0f });
+    v.bindmodel (gv);
+    gv->gridVisMode = mplot::GridVisMode::Triangles;
+    gv->setScalarData (&data);
+    gv->cm.setType (mplot::ColourMapType::Cork);
+    gv->zScale.do_autoscale = false;
+    gv->zScale.compute_scaling (-1.0f, 1.0f);
+    gv->colourScale.do_autoscale = false;
+    gv->colourScale.compute_scaling (-1.0f, 1.0f);
+    gv->setDataSlot (&slot); // before the simulation starts publishing
+    gv->finalize();
+    v.addVisualModel (gv);
+
+    std::atomic<bool> finished = false;
+    std::thread sim ([&grid, &slot, &finished]() {
+        float t = 0.0f;
+        while (!finished) {
+            auto& frame = slot.write();
+            frame.scalars.resize (grid.n());
+            for (unsigned int i = 0; i < grid.n(); ++i) {
+                const sm::vec<float, 2> c = grid[i];
+                frame.scalars[i] = 0.1f * std::sin (10.0f * c.length() - t);
+            }
+            slot.publish(); // requests a redraw; no GL and no context lock here
+            t += 0.01f;
+        }
+    });
+
+    v.keepOpen();
+    finished = true;
+    sim.join();
+
+    return 0;
+}
@@ -47,6 +47,7 @@ int main()
     gv->colourScale.do_autoscale = false;
     gv->colourScale.compute_scaling (-1, 1);
     gv->addLabel (std::string("GridVisMode::Triangles, cm: ") + gv->cm.getTypeStr(), sm::vec<float>({0,-0.1,0}), mplot::TextFeatures(0.03f));
+    gv->setStreaming(); // The model is re-uploaded on every frame
     gv->finalize();
     auto gvp = v.addVisualModel (gv);
 
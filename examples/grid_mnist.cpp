@@ -14,14 +14,20 @@
 
 int main (int argc, char** argv)
 {
-    // Load MNIST data
-    mplot::Mnist mni(std::string("../standalone_examples/neuralnet/mnist/"));
+    // Map the MNIST data files (this does not read every image, as mplot::Mnist does)
+    mplot::MnistMapped mni(std::string("../standalone_examples/neuralnet/mnist/"));
 
     int index = 0;
     if (argc > 1) { index = std::stoi(std::string(argv[1])); }
+    if (index < 0 || static_cast<std::size_t>(index) >= mni.test.size()) {
+        std::cerr << "There is no test example " << index << std::endl;
+        return -1;
+    }
 
     // Get a specific example
-    auto [ id, label, data ] = mni.test_example (index);
+    int id = index;
+    int label = mni.test.label (index);
+    sm::vvec<float> data = mni.test.image_float (index);
 
     // Create a scene
     mplot::Visual v(1280, 1280, "Mnist char");
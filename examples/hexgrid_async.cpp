@@ -0,0 +1,57 @@
+/*
+ * A large HexGridVisual whose vertices are computed on a worker thread with finalize_async. The
+ * window can be moved and the scene rotated while the model builds; it appears when it's ready.
+ */
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <future>
+#include <chrono>
+
+#include <sm/vec>
+#include <sm/hexgrid>
+
+#include <mplot/Visual.h>
+#include <mplot/HexGridVisual.h>
+
+int main()
+{
+    mplot::Visual<mplot::gl::version_4_1> v(1600, 1000, "HexGridVisual built on a worker thread");
+    v.showCoordArrows (true);
+    v.backgroundWhite();
+    v.addLabel ("Built with finalize_async()", {0.3f, -0.2f, 0.0f});
+
+    // A grid of a couple of million hexes takes a few seconds to turn into vertices
+    sm::hexgrid hg(0.0005f, 3.0f, 0.0f);
+    hg.setCircularBoundary (0.6f);
+    std::cout << "Number of hexes in grid:" << hg.num() << std::endl;
+
+    std::vector<float> data(hg.num(), 0.0f);
+    for (unsigned int ri = 0; ri < hg.num(); ++ri) {
+        data[ri] = 0.05f + 0.05f * std::sin (20.0f * hg.d_x[ri]) * std::sin (10.0f * hg.d_y[ri]);
+    }
+
+    sm::vec<float, 3> offset = { 0.0f, -0.05f, 0.0f };
+    auto hgv = std::make_unique<mplot::HexGridVisual<float, mplot::gl::version_4_1>>(&hg, offset);
+    v.bindmodel (hgv);
+    hgv->cm.setType (mplot::ColourMapType::Ice);
+    hgv->setScalarData (&data);
+    hgv->hexVisMode = mplot::HexVisMode::HexInterp;
+    // Instead of finalize(). The model is added to the scene straight away and drawn (uploaded at
+    // the next render) once its vertices are ready.
+    std::shared_future<void> built = hgv->finalize_async();
+    v.addVisualModel (hgv);
+
+    bool reported = false;
+    while (!v.readyToFinish()) {
+        v.waitevents (0.018);
+        v.render();
+        if (!reported && built.wait_for (std::chrono::seconds(0)) == std::future_status::ready) {
+            std::cout << "HexGridVisual vertices are ready\n";
+            reported = true;
+        }
+    }
+
+    return 0;
+}
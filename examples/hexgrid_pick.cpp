@@ -0,0 +1,51 @@
+/*
+ * Pick hexes with the mouse. The HexGridVisual is coloured by element, so the element that
+ * Visual::pick finds under the cursor is the index of the hex in the sm::hexgrid. No search of
+ * the hexes is made on the CPU: the GPU draws the id of the hex under the cursor into a one
+ * pixel ID pass, which is read back without stalling the frame.
+ */
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+
+#include <sm/vec>
+#include <sm/hexgrid>
+
+#include <mplot/Visual.h>
+#include <mplot/HexGridVisual.h>
+
+int main()
+{
+    mplot::Visual<> v(1600, 1000, "Move the mouse over the hexes");
+    v.showCoordArrows (true);
+
+    sm::hexgrid hg(0.01f, 3.0f, 0.0f);
+    hg.setCircularBoundary (0.6f);
+
+    std::vector<float> data(hg.num(), 0.0f);
+    for (unsigned int ri = 0; ri < hg.num(); ++ri) {
+        data[ri] = 0.05f + 0.05f * std::sin (20.0f * hg.d_x[ri]) * std::sin (10.0f * hg.d_y[ri]);
+    }
+
+    auto hgv = std::make_unique<mplot::HexGridVisual<float>>(&hg, sm::vec<float>{ 0.0f, 0.0f, 0.0f });
+    v.bindmodel (hgv);
+    hgv->cm.setType (mplot::ColourMapType::Ice);
+    hgv->setScalarData (&data);
+    hgv->colour_by_element = true; // the element of a pick is then the hex
+    hgv->finalize();
+    auto hgvp = v.addVisualModel (hgv);
+
+    std::uint32_t last = mplot::Visual<>::pick_result::no_element;
+    v.setPickCallback ([&](const mplot::Visual<>::pick_result& p) {
+        const std::uint32_t hex = p.model == hgvp ? p.element : mplot::Visual<>::pick_result::no_element;
+        if (hex == last) { return; }
+        last = hex;
+        if (hex < hg.num()) {
+            std::cout << "Hex " << hex << " at (" << hg.d_x[hex] << ", " << hg.d_y[hex] << ") has datum " << data[hex] << "\n";
+        }
+    });
+
+    v.keepOpen();
+    return 0;
+}
@@ -0,0 +1,32 @@
+/*
+ * Show all 10000 MNIST test numerals with one ImageAtlasVisual: one texture upload and one draw
+ * call, where a GridVisual for each numeral would need millions of vertices.
+ */
+
+#include <iostream>
+#include <sm/vec>
+#include <mplot/Visual.h>
+#include <mplot/ImageAtlasVisual.h>
+#include <mplot/Mnist.h>
+
+int main()
+{
+    mplot::MnistMapped mni(std::string("../standalone_examples/neuralnet/mnist/"));
+
+    mplot::Visual v(1280, 1280, "10000 Mnist numerals");
+    v.setSceneTrans (sm::vec<float,3>({-5.0f, 5.0f, -14.0f}));
+
+    auto av = std::make_unique<mplot::ImageAtlasVisual<float>>(sm::vec<float>{0,0,0}, std::array<unsigned int, 2>{28u, 28u});
+    v.bindmodel (av);
+    av->bottom_row_first = true; // as mplot::mnist_set gives them
+    av->columns = 100;
+    av->image_size = { 0.1f, 0.1f };
+    av->gap = 0.005f;
+    av->setImages (mni.test.float_images());
+    av->cm.setType (mplot::ColourMapType::Berlin);
+    av->finalize();
+    v.addVisualModel (av);
+
+    v.keepOpen();
+    return 0;
+}
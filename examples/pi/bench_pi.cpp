@@ -0,0 +1,79 @@
+/*
+ * Measure the frame rate of the hexgrid_pi or the graph1_pi scene, with and without the tiled
+ * GPU profile (see mplot::VisualBase::tiledGpuProfile), which is the default for OpenGL ES.
+ *
+ * Usage: bench_pi [hexgrid|graph1] [desktop]
+ *
+ * Give 'desktop' to render in the same way as on a desktop GPU. Run with vsync off (with Mesa,
+ * vblank_mode=0 ./examples/pi/bench_pi hexgrid) to see more than the refresh rate.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <chrono>
+
+#include <sm/vec>
+#include <sm/vvec>
+#include <sm/hexgrid>
+#include <sm/quaternion>
+
+#include <mplot/Visual.h>
+#include <mplot/HexGridVisual.h>
+#include <mplot/GraphVisual.h>
+
+static constexpr int glv = mplot::gl::version_3_1_es;
+
+int main (int argc, char** argv)
+{
+    const std::string scene = argc > 1 ? argv[1] : "hexgrid";
+    const bool desktop = argc > 2 && std::string(argv[2]) == "desktop";
+
+    mplot::Visual<glv> v(1600, 1000, "mplot render path benchmark on Raspberry Pi");
+    // Switch the profile off before any model is bound, as it chooses their vertex formats
+    if (desktop) { v.tiledGpuProfile (false); }
+    v.renderOnDemand (false);
+
+    sm::hexgrid hg(0.01f, 3.0f, 0.0f);
+    std::vector<float> data;
+    if (scene == "graph1") {
+        auto gv = std::make_unique<mplot::GraphVisual<double, glv>> (sm::vec<float>{0,0,0});
+        v.bindmodel (gv);
+        sm::vvec<double> x;
+        x.linspace (-0.5, 0.8, 14);
+        gv->setdata (x, x.pow(3));
+        gv->finalize();
+        v.addVisualModel (gv);
+    } else {
+        v.fov = 15;
+        v.setSceneTrans (0.0f, 0.0f, -5.0f);
+        v.lightingEffects();
+        hg.setCircularBoundary (0.6f);
+        data.resize (hg.num(), 0.0f);
+        for (unsigned int ri = 0; ri < hg.num(); ++ri) {
+            data[ri] = 0.05f + 0.05f * std::sin (20.0f * hg.d_x[ri]) * std::sin (10.0f * hg.d_y[ri]);
+        }
+        auto hgv = std::make_unique<mplot::HexGridVisual<float, glv>>(&hg, sm::vec<float>{ 0.0f, -0.05f, 0.0f });
+        v.bindmodel (hgv);
+        hgv->setScalarData (&data);
+        hgv->hexVisMode = mplot::HexVisMode::HexInterp;
+        hgv->finalize();
+        v.addVisualModel (hgv);
+    }
+
+    // Turn the scene a little on each frame, so that each frame is drawn in full
+    using sc = std::chrono::steady_clock;
+    constexpr unsigned int frames = 600;
+    const auto t0 = sc::now();
+    unsigned int f = 0;
+    for (; f < frames && !v.readyToFinish(); ++f) {
+        v.setSceneRotation (sm::quaternion<float> (sm::vec<float>{ 0.0f, 1.0f, 0.0f }, 0.005f * f));
+        v.render();
+        v.poll();
+    }
+    const double s = std::chrono::duration<double>(sc::now() - t0).count();
+    std::cout << scene << (desktop ? " (desktop path): " : " (tiled GPU profile): ")
+              << f / s << " fps over " << f << " frames\n";
+    return 0;
+}
@@ -35,11 +35,11 @@ MainWindow::MainWindow(QWidget *parent)
                                          }
                                          this->k += 0.02f;
                                          if (this->k > 8.0f) { this->k = 1.0f; }
-                                         // Access the pointer for the viswidget and set
-                                         // needs_reinit to the index of the model that requires
+                                         // Access the pointer for the viswidget and queue
+                                         // the index of the model that requires
                                          // reinitialization. When paintGL is called (and a GL
-                                         // context is available) the mathplot OpenGL model will
-                                         // be rebuilt.
+                                         // context is available) every queued mathplot OpenGL
+                                         // model will be rebuilt.
                                          static_cast<mplot::qt::viswidget*>(this->p_vw)->set_model_needs_reinit (0);
                                          // Call the OpenGLWidget's update method. This will cause a
                                          // call to viswidget::paintGL()
@@ -1,3 +1,5 @@
+#include <vector>
+#include <memory>
 #include <sm/vec>
 #include <mplot/Visual.h>
 #include <mplot/RhomboVisual.h>
@@ -13,47 +15,22 @@ int main()
     v.lightingEffects(false);
 
     // Parameters of the model
-    sm::vec<float, 3> offset = { -1,  0,  0 };   // a within-scene offset
     sm::vec<float, 3> e1 = { 0.25,  0,  0 };
     sm::vec<float, 3> e2 = { 0.1,  0.25,  0 };
     sm::vec<float, 3> e3 = { 0,  0.0,  0.25 };
     mplot::ColourMap<float> cmap(mplot::ColourMapType::Rainbow);
 
-    offset = { -2, 0, 0.05 };
-    auto rv = std::make_unique<mplot::RhomboVisual<>> (offset, e1, e2, e3, cmap.convert(1.0f));
-    v.bindmodel (rv);
-    rv->finalize();
-    v.addVisualModel (rv);
-
-    offset = { 2, 0, -1.7 };
-    auto rv2 = std::make_unique<mplot::RhomboVisual<>> (offset, e1, e2, e3, cmap.convert(0.5f));
-    v.bindmodel (rv2);
-    rv2->finalize();
-    v.addVisualModel (rv2);
-
-    offset = { 0, 2, 0.15 };
-    auto rv3 = std::make_unique<mplot::RhomboVisual<>> (offset, e1, e2, e3, cmap.convert(0.3333f));
-    v.bindmodel (rv3);
-    rv3->finalize();
-    v.addVisualModel (rv3);
-
-    offset = { 2, 2, 0.5 };
-    auto rv4 = std::make_unique<mplot::RhomboVisual<>> (offset, e1, e2, e3, cmap.convert(0.25f));
-    v.bindmodel (rv4);
-    rv4->finalize();
-    v.addVisualModel (rv4);
-
-    offset = { 0, -2.2, 0.9 };
-    auto rv5 = std::make_unique<mplot::RhomboVisual<>> (offset, e1, e2, e3, cmap.convert(0.2f));
-    v.bindmodel (rv5);
-    rv5->finalize();
-    v.addVisualModel (rv5);
-
-    offset = { 0, -1.8, 1.7 };
-    auto rv6 = std::make_unique<mplot::RhomboVisual<>> (offset, e1, e2, e3, cmap.convert(0.1f));
-    v.bindmodel (rv6);
-    rv6->finalize();
-    v.addVisualModel (rv6);
+    // Six rhombohedra, whose vertices are computed in parallel by addVisualModels
+    const std::vector<sm::vec<float, 3>> offsets = {
+        { -2, 0, 0.05 }, { 2, 0, -1.7 }, { 0, 2, 0.15 }, { 2, 2, 0.5 }, { 0, -2.2, 0.9 }, { 0, -1.8, 1.7 }
+    };
+    const std::vector<float> colours = { 1.0f, 0.5f, 0.3333f, 0.25f, 0.2f, 0.1f };
+    std::vector<std::unique_ptr<mplot::RhomboVisual<>>> rvs;
+    for (std::size_t i = 0; i < offsets.size(); ++i) {
+        rvs.push_back (std::make_unique<mplot::RhomboVisual<>> (offsets[i], e1, e2, e3, cmap.convert (colours[i])));
+        v.bindmodel (rvs.back());
+    }
+    v.addVisualModels (rvs);
     v.render();
 
     v.keepOpen();
@@ -36,6 +36,7 @@ int main()
     sv->radiusFixed = 0.03f;
     sv->cm.setType (mplot::ColourMapType::Plasma);
     // Finalize (build the model and add to the Visual), even though there's no data or points to show yet
+    sv->setStreaming(); // The model is re-uploaded on every frame
     sv->finalize();
     auto svp = v.addVisualModel (sv); // When you add the model to the Visual, it takes
                                       // ownership of the memory and returns a pointer
@@ -0,0 +1,50 @@
+/*
+ * A scatter plot of a million points, each drawn as a sphere impostor (one GL_POINTS vertex
+ * that the fragment shader ray traces as a sphere).
+ */
+#include <random>
+#include <cmath>
+
+#include <sm/vec>
+#include <sm/vvec>
+
+#include <mplot/Visual.h>
+#include <mplot/ColourMap.h>
+#include <mplot/ScatterVisual.h>
+
+int main()
+{
+    mplot::Visual v(1024, 768, "mplot::ScatterVisual with sphere impostors");
+    v.lightingEffects();
+
+    constexpr std::size_t n = 1000000;
+    sm::vvec<sm::vec<float, 3>> points (n);
+    sm::vvec<float> data (n);
+    std::mt19937 gen (42);
+    std::normal_distribution<float> nd (0.0f, 0.3f);
+    for (std::size_t i = 0; i < n; ++i) {
+        points[i] = { nd (gen), nd (gen), nd (gen) };
+        data[i] = points[i].length();
+    }
+
+    auto sv = std::make_unique<mplot::ScatterVisual<float>> (sm::vec<float>{});
+    v.bindmodel (sv);
+    sv->markers = mplot::markerstyle::sphere_impostor;
+    sv->setDataCoords (&points);
+    sv->setScalarData (&data);
+    sv->radiusFixed = 0.004f;
+    sv->cm.setType (mplot::ColourMapType::Plasma);
+    sv->finalize();
+    auto svp = v.addVisualModel (sv);
+
+    float t = 0.0f;
+    while (!v.readyToFinish()) {
+        // Pulse the radius; only a uniform changes
+        t += 0.02f;
+        svp->setRadius (0.004f * (1.5f + std::sin (t)));
+        v.render();
+        v.wait (0.01);
+    }
+
+    return 0;
+}
@@ -0,0 +1,54 @@
+/*
+ * Draw ten thousand small cuboids with one VisualModel (and so one draw call), spinning
+ * every seventh of them by changing its placement through its handle.
+ */
+#include <vector>
+
+#include <sm/vec>
+#include <sm/quaternion>
+
+#include <mplot/Visual.h>
+#include <mplot/ColourMap.h>
+#include <mplot/SolidsBatchVisual.h>
+
+int main()
+{
+    mplot::Visual v(1024, 768, "mplot::SolidsBatchVisual");
+    v.lightingEffects();
+
+    constexpr int n_side = 100;
+    constexpr float spacing = 0.05f;
+    constexpr float w = 0.03f;
+    mplot::ColourMap<float> cmap (mplot::ColourMapType::Plasma);
+
+    auto sbv = std::make_unique<mplot::SolidsBatchVisual<>> (sm::vec<float>{ -0.5f * n_side * spacing, -0.5f * n_side * spacing, 0.0f });
+    v.bindmodel (sbv);
+    std::vector<mplot::SolidsBatchVisual<>::handle> cubes;
+    std::vector<sm::vec<float>> centres;
+    for (int i = 0; i < n_side; ++i) {
+        for (int j = 0; j < n_side; ++j) {
+            // Each cuboid is centred on the origin of its own frame
+            const float h = w * (1.0f + static_cast<float>((i * j) % 7) / 3.0f);
+            cubes.push_back (sbv->add_rect_cuboid ({ -w / 2.0f, -w / 2.0f, -h / 2.0f }, w, w, h,
+                                                   cmap.convert (static_cast<float>(i + j) / (2.0f * n_side))));
+            centres.push_back ({ i * spacing, j * spacing, 0.0f });
+            sbv->set_placement (cubes.back(), centres.back(), sm::quaternion<float>{});
+        }
+    }
+    sbv->finalize();
+    auto sbvp = v.addVisualModel (sbv);
+
+    float angle = 0.0f;
+    while (!v.readyToFinish()) {
+        // Spin every seventh cuboid about x
+        angle += 0.05f;
+        sm::quaternion<float> rotn (sm::vec<float>{ 1.0f, 0.0f, 0.0f }, angle);
+        for (std::size_t c = 0; c < cubes.size(); c += 7) { sbvp->set_placement (cubes[c], centres[c], rotn); }
+        sbvp->apply_updates();
+
+        v.render();
+        v.wait (0.01);
+    }
+
+    return 0;
+}
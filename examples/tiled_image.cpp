@@ -0,0 +1,52 @@
+/*
+ * Show an image of the Mandelbrot set that is 131072 by 131072 pixels (17 gigapixels) with a
+ * TiledImageVisual. The tiles are computed on demand, on worker threads, for the part of the
+ * image that is in view and at the resolution at which it is seen, so zoom in with the mouse
+ * wheel (and pan with the right button) as far as you like.
+ *
+ * For an image in a file, use setRawFile or setPngTiles in place of setTileLoader.
+ */
+
+#include <sm/vec>
+#include <mplot/Visual.h>
+#include <mplot/TiledImageVisual.h>
+
+int main()
+{
+    mplot::Visual v(1280, 960, "A 17 gigapixel Mandelbrot set");
+    v.setSceneTrans (sm::vec<float,3>({-0.7f, -0.36f, -1.6f}));
+
+    auto tv = std::make_unique<mplot::TiledImageVisual<float>>(sm::vec<float>{0,0,0});
+    v.bindmodel (tv);
+    constexpr unsigned int w = 131072;
+    constexpr unsigned int h = 131072 * 5 / 7;
+    const unsigned int ts = tv->tile_size;
+    tv->setTileLoader ([ts](unsigned int level, unsigned int tx, unsigned int ty, std::vector<float>& px)
+    {
+        for (unsigned int j = 0; j < ts; ++j) {
+            for (unsigned int i = 0; i < ts; ++i) {
+                // The full resolution pixel at the top left of texel (i, j)
+                const double x = static_cast<double>((std::size_t{tx} * ts + i) << level);
+                const double y = static_cast<double>((std::size_t{ty} * ts + j) << level);
+                const double cr = -2.5 + 3.5 * x / w;
+                const double ci = 1.25 - 2.5 * y / h;
+                double zr = 0.0, zi = 0.0;
+                unsigned int n = 0;
+                for (; n < 256 && zr * zr + zi * zi < 4.0; ++n) {
+                    const double t = zr * zr - zi * zi + cr;
+                    zi = 2.0 * zr * zi + ci;
+                    zr = t;
+                }
+                px[j * ts + i] = static_cast<float>(n);
+            }
+        }
+        return true;
+    }, { w, h });
+    tv->width = 1.4f;
+    tv->cm.setType (mplot::ColourMapType::Inferno);
+    tv->finalize();
+    v.addVisualModel (tv);
+
+    v.keepOpen();
+    return 0;
+}
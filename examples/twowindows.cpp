@@ -28,8 +28,9 @@ int main()
     v.lightingEffects();
 
     // If I define a second Visual here, then the OpenGL context will now be 'pointing'
-    // at this Visual v2
-    mplot::Visual v2(768, 768, "Graph on Window 2");
+    // at this Visual v2. Passing v shares its context, so that the two windows load and
+    // upload their font faces once between them.
+    mplot::Visual v2(768, 768, "Graph on Window 2", v);
     v2.showCoordArrows (true);
     v2.showTitle (true);
     v2.backgroundWhite();
@@ -63,7 +63,8 @@ int main()
         // Periodically change the colourmap
         if (fcount++% 1800 == 0) { vorvp->cm.setType (++cmap_t); }
 
-        vorvp->reinit(); // slow, but map has to be rebuilt
+        // Only the z values and data change, so the cells are rewritten without a new diagram
+        vorvp->reinit_data();
 
         v.waitevents(0.001);
         v.render();
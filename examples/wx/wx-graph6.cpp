@@ -61,7 +61,7 @@ public:
         this->graph_ptr->update (this->x, (this->x+this->dx).sin(), 0);
         // Now we mark that VisualModel 0 (the first and only VisualModel that we added in
         // setupVisualModels) nees to be reinitialized.
-        this->canvas->needs_reinit = 0;
+        this->canvas->set_model_needs_reinit (0);
     }
 
     // To set up the VisualModels in the widget, the GL context must have been initialized. So I'll
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <vector>
 #include <array>
+#include <algorithm>
 
 #include <sm/cartgrid>
 #include <sm/vec>
@@ -93,6 +94,11 @@ namespace mplot {
             }
             }
 
+            if (this->gpu_mesh) {
+                this->set_gpu_mesh_sources();
+                this->set_gpu_mesh_scalar_data();
+            }
+
             if (this->showborder == true) {
                 // Draw around the outside.
                 sm::vec<float, 4> cg_extents = this->cg->get_extents(); // {xmin, xmax, ymin, ymax}
@@ -150,6 +156,211 @@ namespace mplot {
             this->idx += nrect;
         }
 
+        /*!
+         * Return the z positions of the centre and the NE, SE, SW and NW corners of rect ri in
+         * CartVisMode::RectInterp. Each corner is the mean of the scaled data (dcopy) of the rects
+         * that meet there.
+         */
+        sm::vec<float, 5> rect_interp_z (const unsigned int ri) const
+        {
+            // Use the linear scaled copy of the data, dcopy.
+            const float datumC  = this->dcopy[ri];
+            const float datumNE =  R_HAS_NE(ri)  ? this->dcopy[R_NE(ri)] : datumC;
+            const float datumNN =  R_HAS_NN(ri)  ? this->dcopy[R_NN(ri)] : datumC;
+            const float datumNW =  R_HAS_NW(ri)  ? this->dcopy[R_NW(ri)] : datumC;
+            const float datumNS =  R_HAS_NS(ri)  ? this->dcopy[R_NS(ri)] : datumC;
+            const float datumNNE = R_HAS_NNE(ri) ? this->dcopy[R_NNE(ri)] : datumC;
+            const float datumNNW = R_HAS_NNW(ri) ? this->dcopy[R_NNW(ri)] : datumC;
+            const float datumNSW = R_HAS_NSW(ri) ? this->dcopy[R_NSW(ri)] : datumC;
+            const float datumNSE = R_HAS_NSE(ri) ? this->dcopy[R_NSE(ri)] : datumC;
+
+            sm::vec<float, 5> z = { datumC, datumC, datumC, datumC, datumC };
+
+            // NE vertex. Compute mean of this->data[ri] and N, NE and E elements
+            if (R_HAS_NN(ri) && R_HAS_NE(ri) && R_HAS_NNE(ri)) {
+                z[1] = 0.25f * (datumC + datumNN + datumNE + datumNNE);
+            } else if (R_HAS_NE(ri)) {
+                // Assume no NN and no NNE
+                z[1] = 0.5f * (datumC + datumNE);
+            } else if (R_HAS_NN(ri)) {
+                // Assume no NE and no NNE
+                z[1] = 0.5f * (datumC + datumNN);
+            }
+
+            // SE vertex
+            if (R_HAS_NS(ri) && R_HAS_NE(ri) && R_HAS_NSE(ri)) {
+                z[2] = 0.25f * (datumC + datumNS + datumNE + datumNSE);
+            } else if (R_HAS_NE(ri)) {
+                // Assume no NS and no NSE
+                z[2] = 0.5f * (datumC + datumNE);
+            } else if (R_HAS_NS(ri)) {
+                // Assume no NE and no NSE
+                z[2] = 0.5f * (datumC + datumNS);
+            }
+
+            // SW vertex
+            if (R_HAS_NS(ri) && R_HAS_NW(ri) && R_HAS_NSW(ri)) {
+                z[3] = 0.25f * (datumC + datumNS + datumNW + datumNSW);
+            } else if (R_HAS_NW(ri)) {
+                z[3] = 0.5f * (datumC + datumNW);
+            } else if (R_HAS_NS(ri)) {
+                z[3] = 0.5f * (datumC + datumNS);
+            }
+
+            // NW vertex
+            if (R_HAS_NN(ri) && R_HAS_NW(ri) && R_HAS_NNW(ri)) {
+                z[4] = 0.25f * (datumC + datumNN + datumNW + datumNNW);
+            } else if (R_HAS_NW(ri)) {
+                z[4] = 0.5f * (datumC + datumNW);
+            } else if (R_HAS_NN(ri)) {
+                z[4] = 0.5f * (datumC + datumNN);
+            }
+
+            return z;
+        }
+
+        /*!
+         * In gpu_mesh mode, set up gpu_mesh_sources for the rects. Each vertex takes its z from
+         * the data of the rects that meet there, by the rules of rect_interp_z, and in
+         * CartVisMode::RectInterp each rect's vertices take the normal of its centre, NE and SE
+         * vertices. The vertices are coloured by their rect's datum.
+         */
+        void set_gpu_mesh_sources()
+        {
+            using source = typename mplot::VisualModelBase<glver>::gpu_mesh_source;
+            const unsigned int nrect = this->cg->num();
+            if (this->cartVisMode == CartVisMode::Triangles) {
+                this->gpu_mesh_sources.assign (nrect, source{});
+                for (unsigned int ri = 0; ri < nrect; ++ri) {
+                    this->gpu_mesh_sources[ri].z_src[0] = static_cast<GLint>(ri);
+                    this->gpu_mesh_sources[ri].colour_src = static_cast<GLint>(ri);
+                }
+            } else {
+                // A corner is the mean of four rects if its vertical (v), horizontal (h) and
+                // diagonal (d) neighbours all exist, else of two, with h preferred to v
+                auto corner = [](source& ms, const int v, const int h, const int d) {
+                    if (v != -1 && h != -1 && d != -1) {
+                        ms.z_src[1] = v;
+                        ms.z_src[2] = h;
+                        ms.z_src[3] = d;
+                    } else if (h != -1) {
+                        ms.z_src[1] = h;
+                    } else if (v != -1) {
+                        ms.z_src[1] = v;
+                    }
+                };
+                this->gpu_mesh_sources.assign (5u * nrect, source{});
+                for (unsigned int ri = 0; ri < nrect; ++ri) {
+                    const GLint vi = static_cast<GLint>(5u * ri);
+                    for (unsigned int j = 0; j < 5u; ++j) {
+                        source& ms = this->gpu_mesh_sources[vi + j];
+                        ms.z_src[0] = static_cast<GLint>(ri);
+                        ms.norm_src = { vi, vi + 1, vi + 2 };
+                        ms.colour_src = static_cast<GLint>(ri);
+                    }
+                    corner (this->gpu_mesh_sources[vi + 1], R_NN(ri), R_NE(ri), R_NNE(ri));
+                    corner (this->gpu_mesh_sources[vi + 2], R_NS(ri), R_NE(ri), R_NSE(ri));
+                    corner (this->gpu_mesh_sources[vi + 3], R_NS(ri), R_NW(ri), R_NSW(ri));
+                    corner (this->gpu_mesh_sources[vi + 4], R_NN(ri), R_NW(ri), R_NNW(ri));
+                }
+            }
+            this->reinit_gpu_mesh_sources();
+        }
+
+        /*!
+         * Called by updateData() and updateCoords(). The z positions, normals and colours of the
+         * rects are rewritten where they are and uploaded with BufferSubData; the indices and the
+         * border (which does not depend on the data) are kept.
+         */
+        void reinit_data() override
+        {
+            const std::size_t nrect = this->cg->num();
+            const std::size_t vpe = this->cartVisMode == CartVisMode::Triangles ? 1u : 5u;
+            if (this->indices.empty() || this->vertexPositions.size() < 3u * vpe * nrect) {
+                this->reinit();
+                return;
+            }
+            if (this->gpu_mesh) {
+                // The rects are regenerated from the data on the GPU
+                this->set_gpu_mesh_scalar_data();
+                return;
+            }
+            if (this->setContext != nullptr) { this->setContext (this->parentVis); }
+            this->determine_datasize();
+            this->setupScaling();
+
+            for (std::size_t ri = 0; ri < nrect; ++ri) {
+                float* vp = this->vertexPositions.data() + 3u * vpe * ri;
+                if (this->cartVisMode == CartVisMode::Triangles) {
+                    vp[2] = this->dcopy[ri];
+                } else {
+                    const sm::vec<float, 5> z = this->rect_interp_z (static_cast<unsigned int>(ri));
+                    for (std::size_t j = 0; j < 5u; ++j) { vp[3u * j + 2u] = z[j]; }
+                    // The normal, from vertices 0, 1 and 2 as in initializeVerticesRectsInterpolated
+                    sm::vec<float> vtx_0 = { vp[0], vp[1], vp[2] };
+                    sm::vec<float> plane1 = sm::vec<float>{ vp[3], vp[4], vp[5] } - vtx_0;
+                    sm::vec<float> plane2 = sm::vec<float>{ vp[6], vp[7], vp[8] } - vtx_0;
+                    sm::vec<float> vnorm = plane2.cross (plane1);
+                    vnorm.renormalize();
+                    float* vn = this->vertexNormals.data() + 3u * vpe * ri;
+                    for (std::size_t j = 0; j < 5u; ++j) {
+                        vn[3u * j] = vnorm[0];
+                        vn[3u * j + 1u] = vnorm[1];
+                        vn[3u * j + 2u] = vnorm[2];
+                    }
+                }
+                std::array<float, 3> clr = this->setColour (ri);
+                for (std::size_t j = 0; j < vpe; ++j) {
+                    std::copy (clr.begin(), clr.end(), this->vertexColors.begin() + 3u * (ri * vpe + j));
+                }
+            }
+
+            this->mark_dirty (0, vpe * nrect);
+            this->reinit_buffers();
+        }
+
+        /*!
+         * Recolour only the rects in the w by h block from column x0, row y0 (counted from the
+         * bottom left rect of the cartgrid's extents), after changing just their elements of
+         * scalarData. The rects are colour scaled with the colourScale of the last full update
+         * (there is no autoscaling) and only their vertex colour spans are uploaded; the z
+         * positions are not changed. Positions in the block that are outside the cartgrid's
+         * boundary are skipped. Vector data and gpu_mesh mode fall back to a full update.
+         */
+        void updateRegion (const int x0, const int y0, const int w, const int h)
+        {
+            if (this->indices.empty() || w <= 0 || h <= 0) { return; }
+            this->make_rect_lookup();
+            if (x0 < 0 || y0 < 0 || x0 + w > this->lookup_dims[0] || y0 + h > this->lookup_dims[1]) {
+                throw std::runtime_error ("CartGridVisual::updateRegion: the region is not within the cartgrid");
+            }
+            std::vector<unsigned int> elements;
+            for (int y = y0; y < y0 + h; ++y) {
+                for (int x = x0; x < x0 + w; ++x) {
+                    const int ri = this->rect_lookup[y * this->lookup_dims[0] + x];
+                    if (ri >= 0) { elements.push_back (static_cast<unsigned int>(ri)); }
+                }
+            }
+            this->updateElements (elements);
+        }
+
+        //! Recolour only the rects with the given indices, as for updateRegion. Consecutive
+        //! indices are uploaded together, so sort the list if its order doesn't matter.
+        void updateElements (const std::vector<unsigned int>& elements)
+        {
+            if (this->indices.empty() || elements.empty()) { return; }
+            if (this->gpu_mesh || this->vectorData != nullptr) {
+                this->reinit_data();
+                return;
+            }
+            const std::size_t nrect = this->cg->num();
+            for (const unsigned int e : elements) {
+                if (e >= nrect) { throw std::runtime_error ("CartGridVisual::updateElements: element out of range"); }
+            }
+            if (this->setContext != nullptr) { this->setContext (this->parentVis); }
+            this->recolour_runs (this->element_runs (elements), this->cartVisMode == CartVisMode::Triangles ? 1u : 5u);
+        }
+
         //! Show a set of hexes at the zero?
         bool zerogrid = false;
 
@@ -163,109 +374,38 @@ namespace mplot {
             float dy = this->cg->getv();
             float vy = 0.5f * dy;
 
-            unsigned int nrect = this->cg->num();
+            const std::size_t nrect = this->cg->num();
             this->idx = 0;
 
             this->setupScaling();
 
-            float datumC = 0.0f;   // datum at the centre
-            float datumNE = 0.0f;  // datum at the hex to the east.
-            float datumNNE = 0.0f;
-            float datumNN = 0.0f;
-            float datumNNW = 0.0f;
-            float datumNW = 0.0f;
-            float datumNSW = 0.0f;
-            float datumNS = 0.0f;
-            float datumNSE = 0.0f;
-
-            float datum = 0.0f;
-
-            sm::vec<float> vtx_0, vtx_1, vtx_2;
-            for (unsigned int ri = 0; ri < nrect; ++ri) {
-
-                // Use the linear scaled copy of the data, dcopy.
-                datumC  = this->dcopy[ri];
-                datumNE =  R_HAS_NE(ri)  ? this->dcopy[R_NE(ri)] : datumC;
-                //std::cout << "NE? " << (R_HAS_NE(ri) ? "yes\n" : "no\n");
-                datumNN =  R_HAS_NN(ri)  ? this->dcopy[R_NN(ri)] : datumC;
-                datumNW =  R_HAS_NW(ri)  ? this->dcopy[R_NW(ri)] : datumC;
-                //std::cout << "NW? " << (R_HAS_NW(ri) ? "yes\n" : "no\n");
-                datumNS =  R_HAS_NS(ri)  ? this->dcopy[R_NS(ri)] : datumC;
-                datumNNE = R_HAS_NNE(ri) ? this->dcopy[R_NNE(ri)] : datumC;
-                datumNNW = R_HAS_NNW(ri) ? this->dcopy[R_NNW(ri)] : datumC;
-                datumNSW = R_HAS_NSW(ri) ? this->dcopy[R_NSW(ri)] : datumC;
-                datumNSE = R_HAS_NSE(ri) ? this->dcopy[R_NSE(ri)] : datumC;
-
-                // Use a single colour for each rect, even though rectangle's z
-                // positions are interpolated. Do the _colour_ scaling:
-                std::array<float, 3> clr = this->setColour (ri);
+            // Each rect has 5 vertices and 12 indices at fixed offsets, so the rects are written in parallel
+            const std::size_t v0 = this->grow_element_buffers (nrect, 5u, 12u);
+            const std::size_t i0 = this->indices.size() - 12u * nrect;
+            const GLuint idx0 = this->idx;
 
-                // First push the 5 positions of the triangle vertices, starting with the centre
-                this->vertex_push (this->cg->d_x[ri]+centering_offset[0], this->cg->d_y[ri]+centering_offset[1], datumC, this->vertexPositions);
+            this->for_elements (nrect, [&](const std::size_t ri) {
 
-                // Use the centre position as the first location for finding the normal vector
-                vtx_0 = {{this->cg->d_x[ri]+centering_offset[0], this->cg->d_y[ri]+centering_offset[1], datumC}};
+                // The z positions of the centre and the NE, SE, SW and NW corners
+                const sm::vec<float, 5> z = this->rect_interp_z (static_cast<unsigned int>(ri));
 
+                // The 5 positions of the triangle vertices, starting with the centre, which is
+                // the first location for finding the normal vector
+                const sm::vec<float> vtx_0 = {{this->cg->d_x[ri]+centering_offset[0], this->cg->d_y[ri]+centering_offset[1], z[0]}};
                 // NE vertex
-                // Compute mean of this->data[ri] and N, NE and E elements
-                //datum = 0.25f * (datumC + datumNN + datumNE + datumNNE);
-                if (R_HAS_NN(ri) && R_HAS_NE(ri) && R_HAS_NNE(ri)) {
-                    datum = 0.25f * (datumC + datumNN + datumNE + datumNNE);
-                } else if (R_HAS_NE(ri)) {
-                    // Assume no NN and no NNE
-                    datum = 0.5f * (datumC + datumNE);
-                } else if (R_HAS_NN(ri)) {
-                    // Assume no NE and no NNE
-                    datum = 0.5f * (datumC + datumNN);
-                } else {
-                    datum = datumC;
-                }
-                this->vertex_push (this->cg->d_x[ri]+hx+centering_offset[0], this->cg->d_y[ri]+vy+centering_offset[1], datum, this->vertexPositions);
-                vtx_1 = {{this->cg->d_x[ri]+hx+centering_offset[0], this->cg->d_y[ri]+vy+centering_offset[1], datum}};
-
-                // SE vertex
-                //datum = 0.25f * (datumC + datumNS + datumNE + datumNSE);
+                const sm::vec<float> vtx_1 = {{this->cg->d_x[ri]+hx+centering_offset[0], this->cg->d_y[ri]+vy+centering_offset[1], z[1]}};
                 // SE vertex
-                if (R_HAS_NS(ri) && R_HAS_NE(ri) && R_HAS_NSE(ri)) {
-                    datum = 0.25f * (datumC + datumNS + datumNE + datumNSE);
-                } else if (R_HAS_NE(ri)) {
-                    // Assume no NS and no NSE
-                    datum = 0.5f * (datumC + datumNE);
-                } else if (R_HAS_NS(ri)) {
-                    // Assume no NE and no NSE
-                    datum = 0.5f * (datumC + datumNS);
-                } else {
-                    datum = datumC;
-                }
-                this->vertex_push (this->cg->d_x[ri]+hx+centering_offset[0], this->cg->d_y[ri]-vy+centering_offset[1], datum, this->vertexPositions);
-                vtx_2 = {{this->cg->d_x[ri]+hx+centering_offset[0], this->cg->d_y[ri]-vy+centering_offset[1], datum}};
-
-
+                const sm::vec<float> vtx_2 = {{this->cg->d_x[ri]+hx+centering_offset[0], this->cg->d_y[ri]-vy+centering_offset[1], z[2]}};
                 // SW vertex
-                //datum = 0.25f * (datumC + datumNS + datumNW + datumNSW);
-                if (R_HAS_NS(ri) && R_HAS_NW(ri) && R_HAS_NSW(ri)) {
-                    datum = 0.25f * (datumC + datumNS + datumNW + datumNSW);
-                } else if (R_HAS_NW(ri)) {
-                    datum = 0.5f * (datumC + datumNW);
-                } else if (R_HAS_NS(ri)) {
-                    datum = 0.5f * (datumC + datumNS);
-                } else {
-                    datum = datumC;
-                }
-                this->vertex_push (this->cg->d_x[ri]-hx+centering_offset[0], this->cg->d_y[ri]-vy+centering_offset[1], datum, this->vertexPositions);
-
+                const sm::vec<float> vtx_3 = {{this->cg->d_x[ri]-hx+centering_offset[0], this->cg->d_y[ri]-vy+centering_offset[1], z[3]}};
                 // NW vertex
-                //datum = 0.25f * (datumC + datumNN + datumNW + datumNNW);
-                if (R_HAS_NN(ri) && R_HAS_NW(ri) && R_HAS_NNW(ri)) {
-                    datum = 0.25f * (datumC + datumNN + datumNW + datumNNW);
-                } else if (R_HAS_NW(ri)) {
-                    datum = 0.5f * (datumC + datumNW);
-                } else if (R_HAS_NN(ri)) {
-                    datum = 0.5f * (datumC + datumNN);
-                } else {
-                    datum = datumC;
+                const sm::vec<float> vtx_4 = {{this->cg->d_x[ri]-hx+centering_offset[0], this->cg->d_y[ri]+vy+centering_offset[1], z[4]}};
+                const std::size_t vi = v0 + 5u * ri;
+                float* p = this->vertexPositions.data() + 3u * vi;
+                for (const sm::vec<float>* v : { &vtx_0, &vtx_1, &vtx_2, &vtx_3, &vtx_4 }) {
+                    std::copy (v->begin(), v->end(), p);
+                    p += 3;
                 }
-                this->vertex_push (this->cg->d_x[ri]-hx+centering_offset[0], this->cg->d_y[ri]+vy+centering_offset[1], datum, this->vertexPositions);
 
                 // From vtx_0,1,2 compute normal. This sets the correct normal, but note
                 // that there is only one 'layer' of vertices; the back of the
@@ -276,38 +416,20 @@ namespace mplot {
                 sm::vec<float> plane2 = vtx_2 - vtx_0;
                 sm::vec<float> vnorm = plane2.cross (plane1);
                 vnorm.renormalize();
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
+                float* nm = this->vertexNormals.data() + 3u * vi;
+                for (std::size_t j = 0; j < 5u; ++j) { std::copy (vnorm.begin(), vnorm.end(), nm + 3u * j); }
 
-                // Five vertices with the same colour
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
+                // Five vertices with the same colour. Use a single colour for each rect, even
+                // though rectangle's z positions are interpolated.
+                this->write_colour (ri, vi, 5u);
 
-                // Define indices now to produce the 4 triangles in the hex
-                this->indices.push_back (this->idx+1);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+2);
+                // The 4 triangles in the rect
+                const GLuint k = idx0 + static_cast<GLuint>(5u * ri);
+                const std::array<GLuint, 12> tri = { k + 1, k, k + 2,  k + 2, k, k + 3,  k + 3, k, k + 4,  k + 4, k, k + 1 };
+                std::copy (tri.begin(), tri.end(), this->indices.data() + i0 + 12u * ri);
+            });
 
-                this->indices.push_back (this->idx+2);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+3);
-
-                this->indices.push_back (this->idx+3);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+4);
-
-                this->indices.push_back (this->idx+4);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+1);
-
-                this->idx += 5; // 5 vertices (each of 3 floats for x/y/z), 15 indices.
-            }
+            this->idx += static_cast<GLuint>(5u * nrect); // 5 vertices (each of 3 floats for x/y/z), 12 indices per rect.
 
 #if 0
             // Show a Flat surface for the zero plane? This is expensively plotting out all the hexes...
@@ -424,6 +546,29 @@ namespace mplot {
         // computed x/y/z position for a rectangle, and this means that the rectangle
         // will be centered around mv_offset.
         sm::vec<float, 3> centering_offset = { 0.0f, 0.0f, 0.0f };
+
+        //! Make rect_lookup, once, from the rect centres
+        void make_rect_lookup()
+        {
+            if (!this->rect_lookup.empty()) { return; }
+            const sm::vec<float, 4> ext = this->cg->get_extents(); // {xmin, xmax, ymin, ymax}
+            const float d = this->cg->getd();
+            const float v = this->cg->getv();
+            this->lookup_dims[0] = static_cast<int>(std::round ((ext[1] - ext[0]) / d)) + 1;
+            this->lookup_dims[1] = static_cast<int>(std::round ((ext[3] - ext[2]) / v)) + 1;
+            this->rect_lookup.assign (static_cast<std::size_t>(this->lookup_dims[0] * this->lookup_dims[1]), -1);
+            const std::size_t nrect = this->cg->num();
+            for (std::size_t ri = 0; ri < nrect; ++ri) {
+                const int x = static_cast<int>(std::round ((this->cg->d_x[ri] - ext[0]) / d));
+                const int y = static_cast<int>(std::round ((this->cg->d_y[ri] - ext[2]) / v));
+                this->rect_lookup[y * this->lookup_dims[0] + x] = static_cast<int>(ri);
+            }
+        }
+
+        //! The index of the rect at each (column, row) of the cartgrid's extents, or -1 where
+        //! there is none, for updateRegion
+        std::vector<int> rect_lookup;
+        sm::vec<int, 2> lookup_dims = { 0, 0 };
     };
 
 } // namespace mplot
@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <array>
+#include <algorithm>
+#include <vector>
 #include <sm/range>
 #include <sm/scale>
 #include <sm/vec>
@@ -54,6 +57,8 @@ namespace mplot {
             this->tf.colour = this->framecolour;
             // Like graphs, colourbars don't rotate by default. If you want yours to, set this false in your client code.
             this->twodimensional = true;
+            // The bar samples the colour map from a lookup texture (see fillFrameWithColour)
+            this->colour_by_datum = true;
         }
 
         //! Set the colour of the frame, ticks and text
@@ -61,8 +66,20 @@ namespace mplot {
         {
             this->tf.colour = c;
             this->framecolour = c;
+            this->bake_bar_lut();
         }
 
+        //! Show the colour map _cm. This changes only the bar's lookup texture; the vertices are
+        //! left alone.
+        void setColourMap (const mplot::ColourMap<F>& _cm)
+        {
+            this->cm = _cm;
+            this->bake_bar_lut();
+        }
+
+        //! After changing cm (its type or hue, say), update the bar's lookup texture to match
+        void updateColourMap() { this->bake_bar_lut(); }
+
         void initializeVertices()
         {
             // If client code provided no scale, then show colour bar from 0->1
@@ -168,7 +185,8 @@ namespace mplot {
             }
         }
 
-        //! Draw the tick labels (the numbers)
+        //! Draw the tick labels (the numbers). When the colour bar is rebuilt with
+        //! reinit_with_clearTexts(), labels that are unchanged are reused (see pooledTextModel).
         void drawTickLabels()
         {
             // Reset these members
@@ -180,7 +198,7 @@ namespace mplot {
                     // Labels above
                     for (unsigned int i = 0; i < this->tick_posns.size(); ++i) {
                         std::string s = mplot::graphing::number_format (this->ticks[i], this->ticks[i==0 ? 1 : i-1]);
-                        auto lbl = this->makeVisualTextModel (this->tf);
+                        auto lbl = this->pooledTextModel (s, this->tf);
                         mplot::TextGeometry geom = lbl->getTextGeometry (s);
                         this->ticklabelheight = geom.height() > this->ticklabelheight ? geom.height() : this->ticklabelheight;
                         this->ticklabelwidth = geom.width() > this->ticklabelwidth ? geom.width() : this->ticklabelwidth;
@@ -189,14 +207,14 @@ namespace mplot {
                             this->width + this->ticklabelgap,
                             this->z
                         };
-                        lbl->setupText (s, lblpos+this->mv_offset, this->framecolour);
+                        this->setupPooledText (*lbl, s, lblpos+this->mv_offset, this->framecolour);
                         this->texts.push_back (std::move(lbl));
                     }
                 } else {
                     // Labels left
                     for (unsigned int i = 0; i < this->tick_posns.size(); ++i) {
                         std::string s = mplot::graphing::number_format (this->ticks[i], this->ticks[i==0 ? 1 : i-1]);
-                        auto lbl = this->makeVisualTextModel (this->tf);
+                        auto lbl = this->pooledTextModel (s, this->tf);
                         mplot::TextGeometry geom = lbl->getTextGeometry (s);
                         this->ticklabelheight = geom.height() > this->ticklabelheight ? geom.height() : this->ticklabelheight;
                         this->ticklabelwidth = geom.width() > this->ticklabelwidth ? geom.width() : this->ticklabelwidth;
@@ -205,7 +223,7 @@ namespace mplot {
                             static_cast<float>(this->tick_posns[i])-geom.half_height(),
                             this->z
                         };
-                        lbl->setupText (s, lblpos+this->mv_offset, this->framecolour);
+                        this->setupPooledText (*lbl, s, lblpos+this->mv_offset, this->framecolour);
                         this->texts.push_back (std::move(lbl));
                     }
                 }
@@ -215,7 +233,7 @@ namespace mplot {
                     // Labels below
                     for (unsigned int i = 0; i < this->tick_posns.size(); ++i) {
                         std::string s = mplot::graphing::number_format (this->ticks[i], this->ticks[i==0 ? 1 : i-1]);
-                        auto lbl = this->makeVisualTextModel (this->tf);
+                        auto lbl = this->pooledTextModel (s, this->tf);
                         mplot::TextGeometry geom = lbl->getTextGeometry (s);
                         this->ticklabelheight = geom.height() > this->ticklabelheight ? geom.height() : this->ticklabelheight;
                         this->ticklabelwidth = geom.width() > this->ticklabelwidth ? geom.width() : this->ticklabelwidth;
@@ -224,14 +242,14 @@ namespace mplot {
                             -(this->ticklabelgap + geom.height()),
                             this->z
                         };
-                        lbl->setupText (s, lblpos+this->mv_offset, this->framecolour);
+                        this->setupPooledText (*lbl, s, lblpos+this->mv_offset, this->framecolour);
                         this->texts.push_back (std::move(lbl));
                     }
                 } else {
                     // Labels right
                     for (unsigned int i = 0; i < this->tick_posns.size(); ++i) {
                         std::string s = mplot::graphing::number_format (this->ticks[i], this->ticks[i==0 ? 1 : i-1]);
-                        auto lbl = this->makeVisualTextModel (this->tf);
+                        auto lbl = this->pooledTextModel (s, this->tf);
                         mplot::TextGeometry geom = lbl->getTextGeometry (s);
                         this->ticklabelheight = geom.height() > this->ticklabelheight ? geom.height() : this->ticklabelheight;
                         this->ticklabelwidth = geom.width() > this->ticklabelwidth ? geom.width() : this->ticklabelwidth;
@@ -240,7 +258,7 @@ namespace mplot {
                             static_cast<float>(this->tick_posns[i])-geom.half_height(),
                             this->z
                         };
-                        lbl->setupText (s, lblpos+this->mv_offset, this->framecolour);
+                        this->setupPooledText (*lbl, s, lblpos+this->mv_offset, this->framecolour);
                         this->texts.push_back (std::move(lbl));
                     }
                 }
@@ -298,43 +316,40 @@ namespace mplot {
             this->texts.push_back (std::move(lbl));
         }
 
+        /*!
+         * Fill the frame with the colour map. The bar is a single quad, coloured by datum: the
+         * datum runs along the bar through the numsegs colours of the colour map at the start of
+         * the lookup texture. The frame, ticks and everything else drawn before it are given the
+         * datum 1, the last texel, which holds framecolour. A change of colour map is then a
+         * change of the lookup texture alone. Call last in initializeVertices.
+         */
         void fillFrameWithColour()
         {
-            sm::vec<float, 2> extents = { width, length };
-            if (this->orientation == colourbar_orientation::horizontal) { extents = { length, width }; }
+            this->bake_bar_lut();
+            const std::size_t n_frame = this->vertexPositions.size() / 3u;
 
-            float segstart = 0.0f;
-            float segend = 0.0f;
-            float seglen = this->length / this->numsegs;
-            float colourval = 0.5f/this->numsegs;
-            // Used for quad corners
-            sm::vec<float> c1;
-            sm::vec<float> c2;
-            sm::vec<float> c3;
-            sm::vec<float> c4;
+            // The datum of the last colour of the colour map, at the far end of the bar
+            const float d_end = static_cast<float>(this->bar_lut_size() - 2u) / static_cast<float>(this->bar_lut_size() - 1u);
+            std::array<float, 4> corner_datums = { 0.0f, 0.0f, d_end, d_end };
+            sm::vec<float> c1, c2, c3, c4;
             if (this->orientation == colourbar_orientation::horizontal) {
-                for (unsigned int seg = 0; seg < this->numsegs; ++seg) {
-                    segstart = seg * seglen;
-                    segend = segstart + seglen;
-                    c1 = { segstart,           0, this->z };
-                    c2 = { segstart, this->width, this->z };
-                    c3 = { segend,   this->width, this->z };
-                    c4 = { segend,             0, this->z };
-                    this->computeFlatQuad (c1, c2, c3, c4, this->cm.convert(colourval));
-                    colourval += 1.0f/this->numsegs;
-                }
+                c1 = { 0.0f,         0.0f,        this->z };
+                c2 = { 0.0f,         this->width, this->z };
+                c3 = { this->length, this->width, this->z };
+                c4 = { this->length, 0.0f,        this->z };
             } else { // vertical
-                for (unsigned int seg = 0; seg < this->numsegs; ++seg) {
-                    segstart = seg * seglen;
-                    segend = segstart + seglen;
-                    c1 = { 0,           segstart, this->z };
-                    c2 = { 0,           segend,   this->z };
-                    c3 = { this->width, segend,   this->z };
-                    c4 = { this->width, segstart, this->z };
-                    this->computeFlatQuad (c1, c2, c3, c4, this->cm.convert(colourval));
-                    colourval += 1.0f/this->numsegs;
-                }
+                c1 = { 0.0f,        0.0f,         this->z };
+                c2 = { 0.0f,        this->length, this->z };
+                c3 = { this->width, this->length, this->z };
+                c4 = { this->width, 0.0f,         this->z };
+                corner_datums = { 0.0f, d_end, d_end, 0.0f };
             }
+            this->computeFlatQuad (c1, c2, c3, c4, this->framecolour);
+
+            // The colours go to the shader as datums, so vertexColors is not needed
+            this->vertexColors.clear();
+            this->vertexDatums.assign (n_frame, 1.0f);
+            this->vertexDatums.insert (this->vertexDatums.end(), corner_datums.begin(), corner_datums.end());
         }
 
         //! The ColourMap to show (copy in)
@@ -380,9 +395,26 @@ namespace mplot {
         float axislabelgap = 0.05f;
         //! The axis label
         std::string label = "";
-        //! The number of segments to make in the colourmap
+        //! The number of colours of the colour map in the bar's lookup texture (the bar is
+        //! smoothly interpolated between them)
         unsigned int numsegs = 256;
     protected:
+        //! The number of texels of the bar's lookup texture: numsegs colours and framecolour
+        std::size_t bar_lut_size() const { return std::max (this->numsegs, 2u) + 1u; }
+
+        //! Make the lookup texture: numsegs samples of cm from 0 to 1, then framecolour
+        void bake_bar_lut()
+        {
+            const std::size_t n = this->bar_lut_size() - 1u;
+            std::vector<float> rgb (3u * (n + 1u));
+            for (std::size_t i = 0; i < n; ++i) {
+                const std::array<float, 3> c = this->cm.convert (static_cast<float>(i) / static_cast<float>(n - 1u));
+                std::copy (c.begin(), c.end(), rgb.begin() + 3u * i);
+            }
+            std::copy (this->framecolour.begin(), this->framecolour.end(), rgb.begin() + 3u * n);
+            this->set_colour_lut (rgb);
+        }
+
         //! tick label height
         float ticklabelheight = 0.0f;
         //! tick label width
@@ -6,6 +6,11 @@
 #include <mplot/colourmaps_cet.h>     // Colour map tables from CET
 
 #include <string_view>
+#include <span>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <type_traits>
 #include <stdexcept>
 #include <cmath>
 #include <cstdint>
@@ -184,12 +189,12 @@ namespace mplot {
         N_entries
     };
     // Define prefix increment and decrement operators for the ColourMapType enum class.
-    mplot::ColourMapType& operator++(mplot::ColourMapType& t)
+    inline mplot::ColourMapType& operator++(mplot::ColourMapType& t)
     {
         t = static_cast<mplot::ColourMapType>((static_cast<uint32_t>(t) + 1u) % static_cast<uint32_t>(mplot::ColourMapType::N_entries));
         return t;
     }
-    mplot::ColourMapType& operator--(mplot::ColourMapType& t)
+    inline mplot::ColourMapType& operator--(mplot::ColourMapType& t)
     {
         uint32_t ti = static_cast<uint32_t>(t);
         ti = (ti == 0u ? static_cast<uint32_t>(mplot::ColourMapType::N_entries) - 1u : ti - 1u);
@@ -223,7 +228,7 @@ namespace mplot {
     };
 
     // Return a set of ColourMapFlags suitable for ColourMapType t
-    sm::flags<mplot::ColourMapFlags> makeColourMapFlags (const mplot::ColourMapType t)
+    inline sm::flags<mplot::ColourMapFlags> makeColourMapFlags (const mplot::ColourMapType t)
     {
         // Logic to create default flags
         sm::flags<mplot::ColourMapFlags> f(uint32_t{0});
@@ -502,6 +507,465 @@ namespace mplot {
         return f;
     }
 
+    /*!
+     * The lookup table of ColourMapType ct, or an empty span if ct is computed rather than
+     * tabulated. This is the table that ColourMap::convert indexes for ct.
+     */
+    template <ColourMapType ct>
+    constexpr std::span<const std::array<float, 3>> colourmap_table()
+    {
+        if constexpr (ct == ColourMapType::Jet) {
+            return mplot::cet::cm_CET_R4;
+        } else if constexpr (ct == ColourMapType::Rainbow) {
+            return mplot::cet::cm_CET_C6;
+        } else if constexpr (ct == ColourMapType::Magma) {
+            return mplot::cm_magma;
+        } else if constexpr (ct == ColourMapType::Inferno) {
+            return mplot::cm_inferno;
+        } else if constexpr (ct == ColourMapType::Plasma) {
+            return mplot::cm_plasma;
+        } else if constexpr (ct == ColourMapType::Viridis) {
+            return mplot::cm_viridis;
+        } else if constexpr (ct == ColourMapType::Cividis) {
+            return mplot::cm_cividis;
+        } else if constexpr (ct == ColourMapType::Twilight) {
+            return mplot::cm_twilight;
+        } else if constexpr (ct == ColourMapType::Petrov) {
+            return mplot::cm_petrov;
+        } else if constexpr (ct == ColourMapType::Devon) {
+            return mplot::crameri::cm_devon;
+        } else if constexpr (ct == ColourMapType::NaviaW) {
+            return mplot::crameri::cm_naviaW;
+        } else if constexpr (ct == ColourMapType::BrocO) {
+            return mplot::crameri::cm_brocO;
+        } else if constexpr (ct == ColourMapType::Acton) {
+            return mplot::crameri::cm_acton;
+        } else if constexpr (ct == ColourMapType::Batlow) {
+            return mplot::crameri::cm_batlow;
+        } else if constexpr (ct == ColourMapType::Berlin) {
+            return mplot::crameri::cm_berlin;
+        } else if constexpr (ct == ColourMapType::Tofino) {
+            return mplot::crameri::cm_tofino;
+        } else if constexpr (ct == ColourMapType::Broc) {
+            return mplot::crameri::cm_broc;
+        } else if constexpr (ct == ColourMapType::CorkO) {
+            return mplot::crameri::cm_corkO;
+        } else if constexpr (ct == ColourMapType::Lapaz) {
+            return mplot::crameri::cm_lapaz;
+        } else if constexpr (ct == ColourMapType::BamO) {
+            return mplot::crameri::cm_bamO;
+        } else if constexpr (ct == ColourMapType::Vanimo) {
+            return mplot::crameri::cm_vanimo;
+        } else if constexpr (ct == ColourMapType::Lajolla) {
+            return mplot::crameri::cm_lajolla;
+        } else if constexpr (ct == ColourMapType::Lisbon) {
+            return mplot::crameri::cm_lisbon;
+        } else if constexpr (ct == ColourMapType::GrayC) {
+            return mplot::crameri::cm_grayC;
+        } else if constexpr (ct == ColourMapType::Roma) {
+            return mplot::crameri::cm_roma;
+        } else if constexpr (ct == ColourMapType::Vik) {
+            return mplot::crameri::cm_vik;
+        } else if constexpr (ct == ColourMapType::Navia) {
+            return mplot::crameri::cm_navia;
+        } else if constexpr (ct == ColourMapType::Bilbao) {
+            return mplot::crameri::cm_bilbao;
+        } else if constexpr (ct == ColourMapType::Turku) {
+            return mplot::crameri::cm_turku;
+        } else if constexpr (ct == ColourMapType::Lipari) {
+            return mplot::crameri::cm_lipari;
+        } else if constexpr (ct == ColourMapType::VikO) {
+            return mplot::crameri::cm_vikO;
+        } else if constexpr (ct == ColourMapType::BatlowK) {
+            return mplot::crameri::cm_batlowK;
+        } else if constexpr (ct == ColourMapType::Oslo) {
+            return mplot::crameri::cm_oslo;
+        } else if constexpr (ct == ColourMapType::Oleron) {
+            return mplot::crameri::cm_oleron;
+        } else if constexpr (ct == ColourMapType::Davos) {
+            return mplot::crameri::cm_davos;
+        } else if constexpr (ct == ColourMapType::Fes) {
+            return mplot::crameri::cm_fes;
+        } else if constexpr (ct == ColourMapType::Managua) {
+            return mplot::crameri::cm_managua;
+        } else if constexpr (ct == ColourMapType::Glasgow) {
+            return mplot::crameri::cm_glasgow;
+        } else if constexpr (ct == ColourMapType::Tokyo) {
+            return mplot::crameri::cm_tokyo;
+        } else if constexpr (ct == ColourMapType::Bukavu) {
+            return mplot::crameri::cm_bukavu;
+        } else if constexpr (ct == ColourMapType::Bamako) {
+            return mplot::crameri::cm_bamako;
+        } else if constexpr (ct == ColourMapType::BatlowW) {
+            return mplot::crameri::cm_batlowW;
+        } else if constexpr (ct == ColourMapType::Nuuk) {
+            return mplot::crameri::cm_nuuk;
+        } else if constexpr (ct == ColourMapType::Cork) {
+            return mplot::crameri::cm_cork;
+        } else if constexpr (ct == ColourMapType::Hawaii) {
+            return mplot::crameri::cm_hawaii;
+        } else if constexpr (ct == ColourMapType::Bam) {
+            return mplot::crameri::cm_bam;
+        } else if constexpr (ct == ColourMapType::Imola) {
+            return mplot::crameri::cm_imola;
+        } else if constexpr (ct == ColourMapType::RomaO) {
+            return mplot::crameri::cm_romaO;
+        } else if constexpr (ct == ColourMapType::Buda) {
+            return mplot::crameri::cm_buda;
+        } else if constexpr (ct == ColourMapType::CET_L02) {
+            return mplot::cet::cm_CET_L02;
+        } else if constexpr (ct == ColourMapType::CET_L13) {
+            return mplot::cet::cm_CET_L13;
+        } else if constexpr (ct == ColourMapType::CET_C4) {
+            return mplot::cet::cm_CET_C4;
+        } else if constexpr (ct == ColourMapType::CET_D04) {
+            return mplot::cet::cm_CET_D04;
+        } else if constexpr (ct == ColourMapType::CET_L12) {
+            return mplot::cet::cm_CET_L12;
+        } else if constexpr (ct == ColourMapType::CET_C1s) {
+            return mplot::cet::cm_CET_C1s;
+        } else if constexpr (ct == ColourMapType::CET_L01) {
+            return mplot::cet::cm_CET_L01;
+        } else if constexpr (ct == ColourMapType::CET_C5) {
+            return mplot::cet::cm_CET_C5;
+        } else if constexpr (ct == ColourMapType::CET_D11) {
+            return mplot::cet::cm_CET_D11;
+        } else if constexpr (ct == ColourMapType::CET_L04) {
+            return mplot::cet::cm_CET_L04;
+        } else if constexpr (ct == ColourMapType::CET_CBL2) {
+            return mplot::cet::cm_CET_CBL2;
+        } else if constexpr (ct == ColourMapType::CET_C4s) {
+            return mplot::cet::cm_CET_C4s;
+        } else if constexpr (ct == ColourMapType::CET_L15) {
+            return mplot::cet::cm_CET_L15;
+        } else if constexpr (ct == ColourMapType::CET_L20) {
+            return mplot::cet::cm_CET_L20;
+        } else if constexpr (ct == ColourMapType::CET_CBD1) {
+            return mplot::cet::cm_CET_CBD1;
+        } else if constexpr (ct == ColourMapType::CET_D06) {
+            return mplot::cet::cm_CET_D06;
+        } else if constexpr (ct == ColourMapType::CET_I3) {
+            return mplot::cet::cm_CET_I3;
+        } else if constexpr (ct == ColourMapType::CET_D01A) {
+            return mplot::cet::cm_CET_D01A;
+        } else if constexpr (ct == ColourMapType::CET_L16) {
+            return mplot::cet::cm_CET_L16;
+        } else if constexpr (ct == ColourMapType::CET_L06) {
+            return mplot::cet::cm_CET_L06;
+        } else if constexpr (ct == ColourMapType::CET_C2s) {
+            return mplot::cet::cm_CET_C2s;
+        } else if constexpr (ct == ColourMapType::CET_I1) {
+            return mplot::cet::cm_CET_I1;
+        } else if constexpr (ct == ColourMapType::CET_C7s) {
+            return mplot::cet::cm_CET_C7s;
+        } else if constexpr (ct == ColourMapType::CET_I2) {
+            return mplot::cet::cm_CET_I2;
+        } else if constexpr (ct == ColourMapType::CET_C6s) {
+            return mplot::cet::cm_CET_C6s;
+        } else if constexpr (ct == ColourMapType::CET_C6) {
+            return mplot::cet::cm_CET_C6;
+        } else if constexpr (ct == ColourMapType::CET_L05) {
+            return mplot::cet::cm_CET_L05;
+        } else if constexpr (ct == ColourMapType::CET_D08) {
+            return mplot::cet::cm_CET_D08;
+        } else if constexpr (ct == ColourMapType::CET_L03) {
+            return mplot::cet::cm_CET_L03;
+        } else if constexpr (ct == ColourMapType::CET_L14) {
+            return mplot::cet::cm_CET_L14;
+        } else if constexpr (ct == ColourMapType::CET_C2) {
+            return mplot::cet::cm_CET_C2;
+        } else if constexpr (ct == ColourMapType::CET_R3) {
+            return mplot::cet::cm_CET_R3;
+        } else if constexpr (ct == ColourMapType::CET_D01) {
+            return mplot::cet::cm_CET_D01;
+        } else if constexpr (ct == ColourMapType::CET_C1) {
+            return mplot::cet::cm_CET_C1;
+        } else if constexpr (ct == ColourMapType::CET_D02) {
+            return mplot::cet::cm_CET_D02;
+        } else if constexpr (ct == ColourMapType::CET_CBC1) {
+            return mplot::cet::cm_CET_CBC1;
+        } else if constexpr (ct == ColourMapType::CET_D09) {
+            return mplot::cet::cm_CET_D09;
+        } else if constexpr (ct == ColourMapType::CET_L10) {
+            return mplot::cet::cm_CET_L10;
+        } else if constexpr (ct == ColourMapType::CET_R1) {
+            return mplot::cet::cm_CET_R1;
+        } else if constexpr (ct == ColourMapType::CET_C3) {
+            return mplot::cet::cm_CET_C3;
+        } else if constexpr (ct == ColourMapType::CET_CBL1) {
+            return mplot::cet::cm_CET_CBL1;
+        } else if constexpr (ct == ColourMapType::CET_C3s) {
+            return mplot::cet::cm_CET_C3s;
+        } else if constexpr (ct == ColourMapType::CET_C5s) {
+            return mplot::cet::cm_CET_C5s;
+        } else if constexpr (ct == ColourMapType::CET_L08) {
+            return mplot::cet::cm_CET_L08;
+        } else if constexpr (ct == ColourMapType::CET_R4) {
+            return mplot::cet::cm_CET_R4;
+        } else if constexpr (ct == ColourMapType::CET_R2) {
+            return mplot::cet::cm_CET_R2;
+        } else if constexpr (ct == ColourMapType::CET_L11) {
+            return mplot::cet::cm_CET_L11;
+        } else if constexpr (ct == ColourMapType::CET_D10) {
+            return mplot::cet::cm_CET_D10;
+        } else if constexpr (ct == ColourMapType::CET_D07) {
+            return mplot::cet::cm_CET_D07;
+        } else if constexpr (ct == ColourMapType::CET_L17) {
+            return mplot::cet::cm_CET_L17;
+        } else if constexpr (ct == ColourMapType::CET_D12) {
+            return mplot::cet::cm_CET_D12;
+        } else if constexpr (ct == ColourMapType::CET_CBC2) {
+            return mplot::cet::cm_CET_CBC2;
+        } else if constexpr (ct == ColourMapType::CET_D13) {
+            return mplot::cet::cm_CET_D13;
+        } else if constexpr (ct == ColourMapType::CET_D03) {
+            return mplot::cet::cm_CET_D03;
+        } else if constexpr (ct == ColourMapType::CET_C7) {
+            return mplot::cet::cm_CET_C7;
+        } else if constexpr (ct == ColourMapType::CET_L07) {
+            return mplot::cet::cm_CET_L07;
+        } else if constexpr (ct == ColourMapType::CET_L09) {
+            return mplot::cet::cm_CET_L09;
+        } else if constexpr (ct == ColourMapType::CET_L18) {
+            return mplot::cet::cm_CET_L18;
+        } else if constexpr (ct == ColourMapType::CET_L19) {
+            return mplot::cet::cm_CET_L19;
+        } else {
+            return {};
+        }
+    }
+
+    //! A list of ColourMapTypes, with a visitor that passes the runtime type t as a template argument
+    template <ColourMapType... cts>
+    struct colourmap_type_list
+    {
+        //! Call f.template operator()<t>(). Returns false (and does not call f) if t is not in the list.
+        template <typename F>
+        static bool visit (const ColourMapType t, F&& f)
+        {
+            return ((t == cts ? (f.template operator()<cts>(), true) : false) || ...);
+        }
+    };
+
+    /*!
+     * The ColourMapTypes that a StaticColourMap can be: the tabulated maps and the analytic 1D
+     * maps that need none of ColourMap's runtime state (hue, sat and val).
+     */
+    using static_colourmap_types = colourmap_type_list<
+        ColourMapType::Jet,
+        ColourMapType::Rainbow,
+        ColourMapType::Magma,
+        ColourMapType::Inferno,
+        ColourMapType::Plasma,
+        ColourMapType::Viridis,
+        ColourMapType::Cividis,
+        ColourMapType::Twilight,
+        ColourMapType::Petrov,
+        ColourMapType::Devon,
+        ColourMapType::NaviaW,
+        ColourMapType::BrocO,
+        ColourMapType::Acton,
+        ColourMapType::Batlow,
+        ColourMapType::Berlin,
+        ColourMapType::Tofino,
+        ColourMapType::Broc,
+        ColourMapType::CorkO,
+        ColourMapType::Lapaz,
+        ColourMapType::BamO,
+        ColourMapType::Vanimo,
+        ColourMapType::Lajolla,
+        ColourMapType::Lisbon,
+        ColourMapType::GrayC,
+        ColourMapType::Roma,
+        ColourMapType::Vik,
+        ColourMapType::Navia,
+        ColourMapType::Bilbao,
+        ColourMapType::Turku,
+        ColourMapType::Lipari,
+        ColourMapType::VikO,
+        ColourMapType::BatlowK,
+        ColourMapType::Oslo,
+        ColourMapType::Oleron,
+        ColourMapType::Davos,
+        ColourMapType::Fes,
+        ColourMapType::Managua,
+        ColourMapType::Glasgow,
+        ColourMapType::Tokyo,
+        ColourMapType::Bukavu,
+        ColourMapType::Bamako,
+        ColourMapType::BatlowW,
+        ColourMapType::Nuuk,
+        ColourMapType::Cork,
+        ColourMapType::Hawaii,
+        ColourMapType::Bam,
+        ColourMapType::Imola,
+        ColourMapType::RomaO,
+        ColourMapType::Buda,
+        ColourMapType::CET_L02,
+        ColourMapType::CET_L13,
+        ColourMapType::CET_C4,
+        ColourMapType::CET_D04,
+        ColourMapType::CET_L12,
+        ColourMapType::CET_C1s,
+        ColourMapType::CET_L01,
+        ColourMapType::CET_C5,
+        ColourMapType::CET_D11,
+        ColourMapType::CET_L04,
+        ColourMapType::CET_CBL2,
+        ColourMapType::CET_C4s,
+        ColourMapType::CET_L15,
+        ColourMapType::CET_L20,
+        ColourMapType::CET_CBD1,
+        ColourMapType::CET_D06,
+        ColourMapType::CET_I3,
+        ColourMapType::CET_D01A,
+        ColourMapType::CET_L16,
+        ColourMapType::CET_L06,
+        ColourMapType::CET_C2s,
+        ColourMapType::CET_I1,
+        ColourMapType::CET_C7s,
+        ColourMapType::CET_I2,
+        ColourMapType::CET_C6s,
+        ColourMapType::CET_C6,
+        ColourMapType::CET_L05,
+        ColourMapType::CET_D08,
+        ColourMapType::CET_L03,
+        ColourMapType::CET_L14,
+        ColourMapType::CET_C2,
+        ColourMapType::CET_R3,
+        ColourMapType::CET_D01,
+        ColourMapType::CET_C1,
+        ColourMapType::CET_D02,
+        ColourMapType::CET_CBC1,
+        ColourMapType::CET_D09,
+        ColourMapType::CET_L10,
+        ColourMapType::CET_R1,
+        ColourMapType::CET_C3,
+        ColourMapType::CET_CBL1,
+        ColourMapType::CET_C3s,
+        ColourMapType::CET_C5s,
+        ColourMapType::CET_L08,
+        ColourMapType::CET_R4,
+        ColourMapType::CET_R2,
+        ColourMapType::CET_L11,
+        ColourMapType::CET_D10,
+        ColourMapType::CET_D07,
+        ColourMapType::CET_L17,
+        ColourMapType::CET_D12,
+        ColourMapType::CET_CBC2,
+        ColourMapType::CET_D13,
+        ColourMapType::CET_D03,
+        ColourMapType::CET_C7,
+        ColourMapType::CET_L07,
+        ColourMapType::CET_L09,
+        ColourMapType::CET_L18,
+        ColourMapType::CET_L19,
+        ColourMapType::Fire,
+        ColourMapType::Ocean,
+        ColourMapType::Ice,
+        ColourMapType::DivBlueRed,
+        ColourMapType::CyclicGrey,
+        ColourMapType::CyclicFour,
+        ColourMapType::CyclicSix,
+        ColourMapType::CyclicDivBlueRed,
+        ColourMapType::Greyscale,
+        ColourMapType::GreyscaleInv,
+        ColourMapType::MonovalRed,
+        ColourMapType::MonovalGreen,
+        ColourMapType::MonovalBlue>;
+
+    template <typename T> class ColourMap;
+
+    /*!
+     * A ColourMap with its ColourMapType fixed at compile time. Where ColourMap::convert
+     * switches on the type for each datum, StaticColourMap::convert is the table lookup (or
+     * analytic function) of ct alone, inlined, so that a batch conversion is a loop the
+     * compiler can vectorize. The colours are those of ColourMap<T> (ct). Use it when the map
+     * is known when the code is written:
+     *
+     * using cmap = mplot::StaticColourMap<float, mplot::ColourMapType::Plasma>;
+     * std::array<float, 3> clr = cmap::convert (0.2f);
+     * cmap::convert (data, rgb); // all of data, as interleaved RGB
+     *
+     * ColourMap<T>::convert (data, rgb_out) uses a StaticColourMap for the types in
+     * static_colourmap_types, dispatching once per batch rather than once per datum.
+     */
+    template <typename T, ColourMapType ct>
+    struct StaticColourMap
+    {
+        static_assert (std::is_floating_point_v<T>, "StaticColourMap converts float or double data in [0,1]");
+
+        //! The ColourMapType of this map
+        static constexpr ColourMapType type = ct;
+
+        //! Convert datum, clamped to [0,1], into an RGB colour. NaN gives the map's nan colour.
+        static std::array<float, 3> convert (const T _datum)
+        {
+            const float datum = static_cast<float>(_datum);
+            if (std::isnan (datum)) { return ColourMap<T>::nanColour (ct); }
+            return StaticColourMap<T, ct>::map (std::clamp (datum, 0.0f, 1.0f));
+        }
+
+        //! Convert every datum in data into interleaved RGB in rgb_out, as ColourMap::convert does
+        template <typename Td>
+        static void convert (const std::vector<Td>& data, std::vector<float>& rgb_out, const std::size_t n_per_datum = 1)
+        {
+            const std::size_t n = data.size();
+            if (rgb_out.size() < 3 * n * n_per_datum) { rgb_out.resize (3 * n * n_per_datum); }
+            float* out = rgb_out.data();
+            const std::array<float, 3> nan_c = ColourMap<T>::nanColour (ct);
+            for (std::size_t i = 0; i < n; ++i) {
+                const float d = static_cast<float>(static_cast<T>(data[i]));
+                const std::array<float, 3> c = std::isnan (d) ? nan_c : StaticColourMap<T, ct>::map (std::clamp (d, 0.0f, 1.0f));
+                for (std::size_t j = 0; j < n_per_datum; ++j, out += 3) {
+                    out[0] = c[0];
+                    out[1] = c[1];
+                    out[2] = c[2];
+                }
+            }
+        }
+
+    private:
+        //! The colour of datum, which is in [0,1]
+        static std::array<float, 3> map (const float datum)
+        {
+            constexpr std::span<const std::array<float, 3>> table = colourmap_table<ct>();
+            std::array<float, 3> c = {0.0f, 0.0f, 0.0f};
+            if constexpr (!table.empty()) {
+                c = table[static_cast<std::size_t>(datum * static_cast<float>(table.size() - 1) + 0.5f)];
+            } else if constexpr (ct == ColourMapType::Fire) {
+                lenthe::colormap::ramp::fire<float> (datum, c.data());
+            } else if constexpr (ct == ColourMapType::Ocean) {
+                lenthe::colormap::ramp::ocean<float> (datum, c.data());
+            } else if constexpr (ct == ColourMapType::Ice) {
+                lenthe::colormap::ramp::ice<float> (datum, c.data());
+            } else if constexpr (ct == ColourMapType::DivBlueRed) {
+                lenthe::colormap::ramp::div<float> (datum, c.data());
+            } else if constexpr (ct == ColourMapType::CyclicGrey) {
+                lenthe::colormap::cyclic::gray<float> (datum, c.data());
+            } else if constexpr (ct == ColourMapType::CyclicFour) {
+                lenthe::colormap::cyclic::four<float> (datum, c.data());
+            } else if constexpr (ct == ColourMapType::CyclicSix) {
+                lenthe::colormap::cyclic::six<float> (datum, c.data());
+            } else if constexpr (ct == ColourMapType::CyclicDivBlueRed) {
+                lenthe::colormap::cyclic::div<float> (datum, c.data());
+            } else if constexpr (ct == ColourMapType::Greyscale) {
+                lenthe::colormap::ramp::gray<float> (1.0f - datum, c.data()); // white for minimum signal
+            } else if constexpr (ct == ColourMapType::GreyscaleInv) {
+                lenthe::colormap::ramp::gray<float> (datum, c.data());
+            } else if constexpr (ct == ColourMapType::MonovalRed) {
+                c[0] = datum;
+            } else if constexpr (ct == ColourMapType::MonovalGreen) {
+                c[1] = datum;
+            } else if constexpr (ct == ColourMapType::MonovalBlue) {
+                c[2] = datum;
+            } else {
+                static_assert (ct == ColourMapType::Fire, "This ColourMapType needs a runtime ColourMap (it has hue, sat or val state)");
+            }
+            return c;
+        }
+    };
+
     /*!
      * Colour mapping
      *
@@ -563,6 +1027,14 @@ namespace mplot {
         //! colour retrieved from the map.
         bool act_2d = false;
 
+        //! The number of entries per datum in the lookup tables. 0 for no lookup tables.
+        unsigned int lut_resolution = 0;
+        //! Lookup table for convert (T) (lut_resolution entries, if lut_resolution > 0)
+        std::vector<std::array<float, 3>> lut;
+        //! Lookup table for convert (T, T) (lut_resolution squared entries, row-major in the
+        //! second datum, if lut_resolution > 0 and this is a two datum map)
+        std::vector<std::array<float, 3>> lut2;
+
     public:
         //! Default constructor is required, but need not do anything.
         ColourMap() {}
@@ -1743,6 +2215,14 @@ namespace mplot {
          */
         std::array<float, 3> convert (T _datum1, T _datum2) const
         {
+            if constexpr (std::is_floating_point<std::decay_t<T>>::value == true) {
+                if (!this->lut2.empty() && !std::isnan (_datum1) && !std::isnan (_datum2)) {
+                    const float nm1 = static_cast<float>(this->lut_resolution - 1);
+                    const auto i1 = static_cast<std::size_t>(std::clamp (static_cast<float>(_datum1), 0.0f, 1.0f) * nm1 + 0.5f);
+                    const auto i2 = static_cast<std::size_t>(std::clamp (static_cast<float>(_datum2), 0.0f, 1.0f) * nm1 + 0.5f);
+                    return this->lut2[i1 * this->lut_resolution + i2];
+                }
+            }
             std::array<float, 3> c = {0.0f, 0.0f, 0.0f};
             if (this->type == ColourMapType::Duochrome) {
                 c = this->duochrome (_datum1, _datum2);
@@ -1848,6 +2328,62 @@ namespace mplot {
             return clr;
         }
 
+        /*!
+         * Convert every datum in data into a colour, writing interleaved RGB triplets into
+         * rgb_out (resized if it is too small), in the layout of VisualModel::vertexColors. Each
+         * colour is written n_per_datum times, for models that have several vertices per datum.
+         * With a lookup table (see setLUTResolution) the loop is a clamp, multiply and index per
+         * datum with no per-datum call; without one, the common types are converted by a
+         * StaticColourMap, choosing the type once for the batch (see convert_static).
+         */
+        template <typename Td>
+        void convert (const std::vector<Td>& data, std::vector<float>& rgb_out, const std::size_t n_per_datum = 1) const
+        {
+            if (this->lut.empty() && this->convert_static (data, rgb_out, n_per_datum)) { return; }
+            const std::size_t n = data.size();
+            if (rgb_out.size() < 3 * n * n_per_datum) { rgb_out.resize (3 * n * n_per_datum); }
+            float* out = rgb_out.data();
+            if (!this->lut.empty()) {
+                const float scl = static_cast<float>(this->lut.size() - 1);
+                const std::array<float, 3> nan_c = ColourMap<T>::nanColour (this->type);
+                for (std::size_t i = 0; i < n; ++i) {
+                    const float d = static_cast<float>(data[i]);
+                    const std::array<float, 3>& c = std::isnan (d) ? nan_c : this->lut[static_cast<std::size_t>(std::clamp (d, 0.0f, 1.0f) * scl + 0.5f)];
+                    for (std::size_t j = 0; j < n_per_datum; ++j, out += 3) {
+                        out[0] = c[0];
+                        out[1] = c[1];
+                        out[2] = c[2];
+                    }
+                }
+            } else {
+                for (std::size_t i = 0; i < n; ++i) {
+                    const std::array<float, 3> c = this->convert (static_cast<T>(data[i]));
+                    for (std::size_t j = 0; j < n_per_datum; ++j, out += 3) {
+                        out[0] = c[0];
+                        out[1] = c[1];
+                        out[2] = c[2];
+                    }
+                }
+            }
+        }
+
+        /*!
+         * If this ColourMap's type is in static_colourmap_types, convert data with the
+         * StaticColourMap of that type and return true. Returns false (doing nothing)
+         * otherwise, or if T is integral (integral data are scaled by range_max).
+         */
+        template <typename Td>
+        bool convert_static (const std::vector<Td>& data, std::vector<float>& rgb_out, const std::size_t n_per_datum) const
+        {
+            if constexpr (std::is_floating_point_v<T>) {
+                return static_colourmap_types::visit (this->type, [&]<ColourMapType ct>() {
+                    StaticColourMap<T, ct>::convert (data, rgb_out, n_per_datum);
+                });
+            } else {
+                return false;
+            }
+        }
+
         //! A 2D convert() which adjusts the saturation of the retrieved colour using the second dimension.
         std::array<float, 3> convertWithSaturation (const T _datum, const T _saturation) const
         {
@@ -1895,6 +2431,10 @@ namespace mplot {
                 if (std::isnan(datum) == true) { c = ColourMap<T>::nanColour(this->type); return c; }
             }
 
+            if (!this->lut.empty()) {
+                return this->lut[static_cast<std::size_t>(datum * static_cast<float>(this->lut.size() - 1) + 0.5f)];
+            }
+
             switch (this->type) {
             case ColourMapType::Jet:
             {
@@ -2726,6 +3266,7 @@ namespace mplot {
                 break;
             }
             }
+            this->rebuild_lut();
         }
 
         //! Setter that takes a string representation of the colour map type
@@ -2739,6 +3280,7 @@ namespace mplot {
             }
             this->hue = 0.0f;
             this->hue2 = 0.6667f;
+            this->rebuild_lut();
         }
         //! Set Duochrome to be Blue-red
         void setHueBR()
@@ -2748,6 +3290,7 @@ namespace mplot {
             }
             this->hue = 0.6667f;
             this->hue2 = 0.0f;
+            this->rebuild_lut();
         }
 
         //! Set Duochrome to be Green-Blue
@@ -2758,6 +3301,7 @@ namespace mplot {
             }
             this->hue = 0.3333f;
             this->hue2 = 0.6667f;
+            this->rebuild_lut();
         }
         //! Set Duochrome to be Blue-Green
         void setHueBG()
@@ -2767,6 +3311,7 @@ namespace mplot {
             }
             this->hue = 0.66667f;
             this->hue2 = 0.3333f;
+            this->rebuild_lut();
         }
 
         //! Set Duochrome to be Red-Green
@@ -2777,6 +3322,7 @@ namespace mplot {
             }
             this->hue = 0.0f;
             this->hue2 = 0.3333f;
+            this->rebuild_lut();
         }
         //! Set Duochrome to be Green-Red
         void setHueGR()
@@ -2786,6 +3332,7 @@ namespace mplot {
             }
             this->hue = 0.33333f;
             this->hue2 = 0.0f;
+            this->rebuild_lut();
         }
 
         //! Set up a Cyan-Magenta Duochrome colour scheme
@@ -2796,6 +3343,7 @@ namespace mplot {
             }
             this->hue = 0.5f;
             this->hue2 = 0.8333f;
+            this->rebuild_lut();
         }
         //! Set up a Magenta-Cyan Duochrome colour scheme
         void setHueMC()
@@ -2805,6 +3353,7 @@ namespace mplot {
             }
             this->hue = 0.83333f;
             this->hue2 = 0.5f;
+            this->rebuild_lut();
         }
 
         //! Set a ColourMapType::Duochrome map using h as the first hue and h+0.3333 as the second hue
@@ -2816,6 +3365,7 @@ namespace mplot {
             this->hue = h;
             this->hue2 = h+0.3333f;
             if (hue2 > 1.0f) { hue2 -= 1.0f; }
+            this->rebuild_lut();
         }
         //! Set a ColourMapType::DuoChrome map using h as the first hue and h-0.3333 as the second hue
         void setDualAntiHue(const float& h)
@@ -2826,6 +3376,7 @@ namespace mplot {
             this->hue = h;
             this->hue2 = h-0.3333f;
             if (hue2 < 0.0f) { hue2 += 1.0f; }
+            this->rebuild_lut();
         }
 
         //! Set the hue... unless you can't/shouldn't
@@ -2872,6 +3423,7 @@ namespace mplot {
                 break;
             }
             }
+            this->rebuild_lut();
         }
 
         //! Set the saturation. For many colour maps, this will make little difference,
@@ -2882,6 +3434,7 @@ namespace mplot {
                 throw std::runtime_error ("Only ColourMapType::Fixed ::Monochrome and ::Monoval allow setting of saturation");
             }
             this->sat = _s;
+            this->rebuild_lut();
         }
 
         //! Set just the colour's value (ColourMapType::Fixed/HSV only)
@@ -2892,6 +3445,7 @@ namespace mplot {
                 throw std::runtime_error ("Only ColourMapType::Fixed ::HSV ::Monochrome and ::Monoval allow setting of value");
             }
             this->val = _v;
+            this->rebuild_lut();
         }
 
         float getHue() const { return this->hue; }
@@ -2907,6 +3461,7 @@ namespace mplot {
             this->hue = h;
             this->sat = s;
             this->val = v;
+            this->rebuild_lut();
         }
 
         //! Set the colour by hue, saturation and value (defined in an array) (ColourMapType::Fixed only)
@@ -2919,6 +3474,7 @@ namespace mplot {
             this->hue = hsv[0];
             this->sat = hsv[1];
             this->val = hsv[2];
+            this->rebuild_lut();
         }
 
         //! Get the hue, in its most saturated form
@@ -2932,6 +3488,7 @@ namespace mplot {
                 throw std::runtime_error ("Only ColourMapType::HSV and Disc* allow setting of hue rotation");
             }
             this->hue_rotation = rotation_rads;
+            this->rebuild_lut();
         }
 
         void setHueReverse (const bool rev)
@@ -2942,9 +3499,27 @@ namespace mplot {
                 throw std::runtime_error ("It's only relevant to reverse hue direction for ColourMapType::HSV and Disc*");
             }
             this->hue_reverse_direction = rev;
+            this->rebuild_lut();
         }
 
-        void set_act_2d (const bool _2d) { this->act_2d = _2d; }
+        void set_act_2d (const bool _2d)
+        {
+            this->act_2d = _2d;
+            this->rebuild_lut();
+        }
+
+        /*!
+         * Make convert (T) and convert (T, T) look colours up in tables of n (for convert (T, T), n
+         * by n) entries, rather than computing each colour. The tables are rebuilt whenever the
+         * type, hue or any other parameter of the map changes. Colours are quantized to n levels
+         * per datum. 0 (the default) turns the tables off. Only floating point T can use tables.
+         */
+        void setLUTResolution (const unsigned int n)
+        {
+            this->lut_resolution = n;
+            this->rebuild_lut();
+        }
+        unsigned int getLUTResolution() const { return this->lut_resolution; }
 
         /*!
          * @param datum gray value from 0.0 to 1.0
@@ -3054,6 +3629,34 @@ namespace mplot {
         }
 
     private:
+        //! Recompute the lookup tables (if lut_resolution > 0) after a change to the map
+        void rebuild_lut()
+        {
+            // Clear first, so that convert() computes the colours that go into the new tables
+            this->lut.clear();
+            this->lut2.clear();
+            if constexpr (std::is_floating_point<std::decay_t<T>>::value == true) {
+                const unsigned int n = this->lut_resolution;
+                if (n < 2) { return; }
+                const T nm1 = static_cast<T>(n - 1);
+                // The 2D table first, as an act_2d map's convert (T, T) calls convert (T)
+                if (this->numDatums() == 2) {
+                    std::vector<std::array<float, 3>> l (n * n);
+                    for (unsigned int i = 0; i < n; ++i) {
+                        for (unsigned int j = 0; j < n; ++j) {
+                            l[i * n + j] = this->convert (static_cast<T>(i) / nm1, static_cast<T>(j) / nm1);
+                        }
+                    }
+                    this->lut2.swap (l);
+                }
+                if (ColourMap::numDatums (this->type) == 1) {
+                    std::vector<std::array<float, 3>> l (n);
+                    for (unsigned int i = 0; i < n; ++i) { l[i] = this->convert (static_cast<T>(i) / nm1); }
+                    this->lut.swap (l);
+                }
+            }
+        }
+
         /*!
          * @param datum gray value from 0.0 to 1.0
          *
@@ -3264,3 +3867,11 @@ namespace mplot {
     };
 
 } // namespace mplot
+
+#if defined MPLOT_CORE
+// Instantiated once, in the compiled mplot_core library (see core/colourmap.cpp)
+namespace mplot {
+    extern template class ColourMap<float>;
+    extern template class ColourMap<double>;
+} // namespace mplot
+#endif
@@ -0,0 +1,175 @@
+/*!
+ * \file
+ *
+ * A VisualModel that overlays contour lines (isolines) on the data of a GridVisual or a
+ * HexGridVisual. The contours are traced by mplot::contours::trace, across the quads between
+ * neighbouring elements of an sm::grid (marching squares) or the triangles between neighbouring
+ * hexes of an sm::hexgrid (from its neighbour tables), with the levels traced in parallel. Each
+ * contour is one GPU polyline, and the points of all of them are in the model's one polyline
+ * buffer. When the data change, updateData (or reinit_data) retraces the contours and rewrites the points in
+ * place, without rebuilding the model.
+ *
+ * \author Seb James
+ * \date 2026
+ */
+#pragma once
+
+#include <array>
+#include <vector>
+#include <span>
+#include <stdexcept>
+#include <sm/vec>
+#include <sm/grid>
+#include <sm/hexgrid>
+#include <mplot/colour.h>
+#include <mplot/contours.h>
+#include <mplot/VisualDataModel.h>
+
+namespace mplot {
+
+    //! The template argument T is the type of the data whose contours this ContourVisual shows
+    template <typename T, int glver = mplot::gl::version_4_1>
+    struct ContourVisual : public VisualDataModel<T, glver>
+    {
+        ContourVisual (const sm::vec<float> _offset)
+        {
+            this->mv_offset = _offset;
+            this->viewmatrix.translate (this->mv_offset);
+        }
+
+        //! Trace the contours on the quads between the elements of the rectangular grid g
+        template <typename I, typename C>
+        void setGrid (const sm::grid<I, C>* g)
+        {
+            this->positions.resize (g->n());
+            for (I i = 0; i < g->n(); ++i) {
+                this->positions[i] = { static_cast<float>((*g)[i][0]), static_cast<float>((*g)[i][1]), 0.0f };
+            }
+            this->tris.clear();
+            this->quads.clear();
+            for (I i = 0; i < g->n(); ++i) {
+                if (g->has_ne (i) && g->has_nn (i) && g->has_nne (i)) {
+                    this->quads.push_back ({ static_cast<unsigned int>(i), static_cast<unsigned int>(g->index_ne (i)),
+                                             static_cast<unsigned int>(g->index_nne (i)), static_cast<unsigned int>(g->index_nn (i)) });
+                }
+            }
+            mplot::contours::make_anticlockwise<4> (this->positions, this->quads);
+        }
+
+        //! Trace the contours on the triangles between the hexes of hg, as HexGridVisual's
+        //! HexVisMode::Triangles draws them
+        void setHexGrid (const sm::hexgrid* hg)
+        {
+            const unsigned int nhex = hg->num();
+            this->positions.resize (nhex);
+            for (unsigned int hi = 0; hi < nhex; ++hi) { this->positions[hi] = { hg->d_x[hi], hg->d_y[hi], 0.0f }; }
+            this->tris.clear();
+            this->quads.clear();
+            for (unsigned int hi = 0; hi < nhex; ++hi) {
+                if (hg->d_nne[hi] != -1 && hg->d_ne[hi] != -1) {
+                    this->tris.push_back ({ hi, static_cast<unsigned int>(hg->d_ne[hi]), static_cast<unsigned int>(hg->d_nne[hi]) });
+                }
+                if (hg->d_nw[hi] != -1 && hg->d_nsw[hi] != -1) {
+                    this->tris.push_back ({ hi, static_cast<unsigned int>(hg->d_nw[hi]), static_cast<unsigned int>(hg->d_nsw[hi]) });
+                }
+            }
+            mplot::contours::make_anticlockwise<3> (this->positions, this->tris);
+        }
+
+        //! Set n levels evenly spaced from lo to hi (inclusive)
+        void setLevels (const float lo, const float hi, const unsigned int n)
+        {
+            this->levels.resize (n);
+            for (unsigned int i = 0; i < n; ++i) {
+                this->levels[i] = n > 1u ? lo + (hi - lo) * static_cast<float>(i) / static_cast<float>(n - 1u) : lo;
+            }
+        }
+
+        //! The levels at which to draw contours, in the units of the data
+        std::vector<float> levels;
+
+        //! If true, colour each level from the colour map (from its first level to its last);
+        //! otherwise draw all the contours in colour
+        bool colour_by_level = false;
+        std::array<float, 3> colour = mplot::colour::black;
+
+        //! The width of the lines, in pixels
+        float line_width = 2.0f;
+
+        //! The z of the lines in model coordinates (lift them a little above a flat grid)
+        float z = 0.001f;
+
+        //! The threads on which to trace the levels (0 for one per hardware thread)
+        unsigned int n_threads = 0;
+
+        //! The contours last traced
+        const mplot::contours::lines& get_lines() const { return this->contour_lines; }
+
+        /*!
+         * Retrace the contours after the data have changed. Where the contours have the same
+         * shape as before (the same strips, with the same numbers of points), their points are
+         * rewritten in place; otherwise only the polylines are rebuilt. Either way the model itself
+         * is not rebuilt.
+         */
+        void reinit_data() override
+        {
+            const std::vector<mplot::contours::strip> before = this->contour_lines.strips;
+            this->trace_lines();
+            bool same = before.size() == this->contour_lines.strips.size() && before.size() == this->get_polylines().size();
+            for (std::size_t i = 0; same && i < before.size(); ++i) { same = before[i].count == this->contour_lines.strips[i].count; }
+            if (same) {
+                for (std::size_t i = 0; i < this->contour_lines.strips.size(); ++i) {
+                    this->set_polyline_points (i, this->contour_lines.strip_points (i));
+                }
+            } else {
+                this->clear_polylines();
+                this->add_lines();
+            }
+        }
+
+        void initializeVertices()
+        {
+            if (this->scalarData == nullptr) { return; }
+            this->trace_lines();
+            this->add_lines();
+        }
+
+    protected:
+        //! The positions of the elements of the grid, and the cells between them
+        std::vector<sm::vec<float>> positions;
+        std::vector<std::array<unsigned int, 4>> quads;
+        std::vector<std::array<unsigned int, 3>> tris;
+        mplot::contours::lines contour_lines;
+
+        void trace_lines()
+        {
+            if (this->scalarData == nullptr) { this->contour_lines.clear(); return; }
+            if (this->scalarData->size() < this->positions.size()) {
+                throw std::runtime_error ("ContourVisual: there are fewer data than elements in the grid");
+            }
+            std::span<const T> d (this->scalarData->data(), this->positions.size());
+            if (!this->quads.empty()) {
+                mplot::contours::trace<T, 4> (this->positions, d, this->quads, this->levels, this->contour_lines, this->n_threads);
+            } else {
+                mplot::contours::trace<T, 3> (this->positions, d, this->tris, this->levels, this->contour_lines, this->n_threads);
+            }
+            for (auto& p : this->contour_lines.points) { p[2] = this->z; }
+        }
+
+        void add_lines()
+        {
+            const float lo = this->levels.empty() ? 0.0f : this->levels.front();
+            const float hi = this->levels.empty() ? 0.0f : this->levels.back();
+            for (std::size_t i = 0; i < this->contour_lines.strips.size(); ++i) {
+                const mplot::contours::strip& s = this->contour_lines.strips[i];
+                std::array<float, 3> clr = this->colour;
+                if (this->colour_by_level) {
+                    clr = this->cm.convert (hi > lo ? (this->levels[s.level] - lo) / (hi - lo) : 0.0f);
+                }
+                const std::size_t pi = this->add_polyline (this->contour_lines.strip_points (i), clr);
+                this->set_polyline_width (pi, this->line_width, true);
+            }
+        }
+    };
+
+} // namespace mplot
@@ -152,3 +152,11 @@ namespace mplot {
     };
 
 } // namespace mplot
+
+#if defined MPLOT_CORE && defined GLAD_OPTION_GL_MX
+// Instantiated once, in the compiled mplot_core library (see core/visual.cpp)
+namespace mplot {
+    extern template class CoordArrows<mplot::gl::version_4_1>;
+    extern template class CoordArrows<mplot::gl::version_4_5>;
+} // namespace mplot
+#endif
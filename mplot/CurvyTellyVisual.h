@@ -1,6 +1,8 @@
 #pragma once
 
 #include <array>
+#include <cmath>
+#include <vector>
 #include <sm/mathconst>
 #include <sm/vec>
 #include <sm/grid>
@@ -40,19 +42,23 @@ namespace mplot
         // model. Don't confuse with the option gridvisual_flags::centralize.
         bool centroidize = false;
 
+        /*!
+         * If true, the grid is drawn as a flat mesh, uploaded once, which the vertex shaders bend
+         * onto the cylinder (see VisualModelBase::vertex_curvature). setCurvature then changes
+         * radius, angle_to_subtend and rotoff without touching the vertices, and updateData
+         * rewrites only the colours. The elements are flat quads on the cylinder (without the
+         * centre vertex that drawcurvygrid sets in from it) and the frames are made of one quad
+         * per element, so that they curve too. Set before finalize().
+         */
+        bool shader_curvature = false;
+
         // Note constructor forces GridVisual::centralize to be true, which is important when drawing a curvy CartGrid
         CurvyTellyVisual(const sm::grid<I, C>* _cg, const sm::vec<float> _offset)
             : mplot::GridVisual<T, I, C, glver>(_cg, _offset) { this->centralize (true); }
 
-        void drawcurvygrid()
+        //! Scale the data into dcolour (and, for vectorData, dcolour2 and dcolour3) for setColour
+        void scale_telly_data()
         {
-            sm::vec<float, 2> dx = this->grid->get_dx();
-            float hx = 0.5f * dx[0];
-            float vy = 0.5f * dx[1];
-
-            unsigned int nrect = this->grid->n();
-            this->idx = 0;
-
             if (this->scalarData != nullptr) {
                 this->dcopy.resize (this->scalarData->size());
                 this->zScale.transform (*(this->scalarData), this->dcopy);
@@ -76,6 +82,18 @@ namespace mplot
             } else {
                 std::cout << "No data to set up dcolours\n";
             }
+        }
+
+        void drawcurvygrid()
+        {
+            sm::vec<float, 2> dx = this->grid->get_dx();
+            float hx = 0.5f * dx[0];
+            float vy = 0.5f * dx[1];
+
+            unsigned int nrect = this->grid->n();
+            this->idx = 0;
+
+            this->scale_telly_data();
 
             float _x = 0.0f;
             sm::vec<float> vtx_0; // centre of a Grid element
@@ -285,6 +303,124 @@ namespace mplot
             }
         }
 
+        /*!
+         * For shader_curvature, draw the grid flat: x is the distance around the telly (the
+         * negated grid x, as in drawcurvygrid) and y is the height. Each element is one quad,
+         * whose colour is recorded for recolour_cached_topology, and the frames are quads of
+         * frame_width at the edges. The bend is set by update_curvature.
+         */
+        void drawflatgrid()
+        {
+            sm::vec<float, 2> dx = this->grid->get_dx();
+            float hx = 0.5f * dx[0];
+            float vy = 0.5f * dx[1];
+            const float fw = this->frame_width;
+
+            unsigned int nrect = this->grid->n();
+            this->idx = 0;
+            this->colour_vertex_datum.clear();
+            this->colour_datum_count = nrect;
+            this->curve_columns.clear();
+
+            this->scale_telly_data();
+
+            double zsum = 0.0;
+            unsigned long long int z_count = 0;
+            for (unsigned int ri = 0; ri < nrect; ++ri) {
+                const float _x = -((*this->grid)[ri][0] + this->centering_offset[0]);
+                if (std::abs(_x) > this->max_abs_x) { continue; }
+                const float _y = (*this->grid)[ri][1] + this->centering_offset[1];
+                if (this->grid->row(ri) == 0) { this->curve_columns.push_back (_x); }
+                zsum += _y;
+                ++z_count;
+
+                const float l = _x - hx;
+                const float r = _x + hx;
+                const float b = _y - vy;
+                const float t = _y + vy;
+                this->computeFlatQuad (sm::vec<float>{ r, t, 0.0f }, sm::vec<float>{ r, b, 0.0f },
+                                       sm::vec<float>{ l, b, 0.0f }, sm::vec<float>{ l, t, 0.0f }, this->setColour (ri));
+                this->note_colour_datum (ri);
+
+                const bool T_border = this->tb_frames && this->grid->row(ri) == (this->grid->get_h()-1);
+                const bool B_border = this->tb_frames && this->grid->row(ri) == 0;
+                const bool R_border = this->lr_frames && this->grid->col(ri) == (this->grid->get_w()-1);
+                const bool L_border = this->lr_frames && this->grid->col(ri) == 0;
+                // The edge frames reach over the corners of the top and bottom frames
+                const float eb = B_border ? b - fw : b;
+                const float et = T_border ? t + fw : t;
+                if (T_border) { this->flat_frame (l, r, t, t + fw); }
+                if (B_border) { this->flat_frame (l, r, b - fw, b); }
+                // col 0 is at the largest x, as x is the negated grid x
+                if (R_border) { this->flat_frame (l - fw, l, eb, et); }
+                if (L_border) { this->flat_frame (r, r + fw, eb, et); }
+                this->note_fixed_colour();
+            }
+            this->curve_centroid_z = z_count > 0 ? static_cast<float>(zsum / z_count) : 0.0f;
+            this->update_curvature();
+        }
+
+        //! A quad of the frame, from x0 to x1 and from y0 to y1, in the plane of drawflatgrid
+        void flat_frame (const float x0, const float x1, const float y0, const float y1)
+        {
+            this->computeFlatQuad (sm::vec<float>{ x1, y1, 0.0f }, sm::vec<float>{ x1, y0, 0.0f },
+                                   sm::vec<float>{ x0, y0, 0.0f }, sm::vec<float>{ x0, y1, 0.0f }, this->frame_clr);
+        }
+
+        /*!
+         * With shader_curvature, set the bend of the flat grid from radius, angle_to_subtend and
+         * rotoff. As in drawcurvygrid, the telly is shifted so that the centroid of its element
+         * vertices is at the origin. That centroid is found from the columns of the grid, so this
+         * costs O(width) and the vertices are not touched.
+         */
+        void update_curvature()
+        {
+            if (!this->shader_curvature) { return; }
+            sm::vec<float, 2> dx = this->grid->get_dx();
+            const float angle_per_distance = this->angle_to_subtend / (dx[0] + this->grid->width());
+            this->vertex_curvature = { static_cast<float>(this->radius), angle_per_distance, this->rotoff, 0.0f };
+            // The mean of an element's corners lies in from the surface by the cosine of its half angle
+            const float rc = static_cast<float>(this->radius) * std::cos (0.5f * dx[0] * angle_per_distance);
+            sm::vec<float, 3> centroid = { 0.0f, 0.0f, this->curve_centroid_z };
+            if (!this->curve_columns.empty()) {
+                for (auto _x : this->curve_columns) {
+                    centroid[0] += std::cos (this->rotoff + _x * angle_per_distance);
+                    centroid[1] += std::sin (this->rotoff + _x * angle_per_distance);
+                }
+                centroid[0] *= rc / this->curve_columns.size();
+                centroid[1] *= rc / this->curve_columns.size();
+            }
+            this->vertex_curvature_offset = centroid;
+        }
+
+        /*!
+         * Set the radius, the angle to subtend and the rotational offset. With shader_curvature,
+         * this only changes the uniforms of the next frame, so it can animate the telly; otherwise
+         * a built model is rebuilt.
+         */
+        void setCurvature (const T _radius, const T _angle_to_subtend, const float _rotoff)
+        {
+            this->radius = _radius;
+            this->angle_to_subtend = _angle_to_subtend;
+            this->rotoff = _rotoff;
+            if (this->shader_curvature) {
+                this->update_curvature();
+            } else if (!this->indices.empty()) {
+                this->reinit();
+            }
+        }
+
+        /*!
+         * The curved vertices of drawcurvygrid don't have the layout that GridVisual::reinit_data
+         * rewrites, so new data rebuild the model. With shader_curvature, only the colours are
+         * rewritten.
+         */
+        void reinit_data() override
+        {
+            if (this->shader_curvature && this->recolour_cached_topology()) { return; }
+            this->reinit();
+        }
+
         void initializeVertices()
         {
             // Compute an offset (in Grid frame of ref) to ensure that the curved representation of
@@ -293,7 +429,17 @@ namespace mplot
             if (this->options.test (mplot::gridvisual_flags::centralize) == true) {
                 this->centering_offset = -this->grid->centre().plus_one_dim();
             }
-            this->drawcurvygrid();
+            if (this->shader_curvature) {
+                this->cached_topology = true;
+                this->drawflatgrid();
+            } else {
+                this->vertex_curvature = { 0.0f, 0.0f, 0.0f, 0.0f };
+                this->drawcurvygrid();
+            }
         }
+
+        //! For shader_curvature, the x of each column of drawflatgrid, and the mean y of its elements
+        std::vector<float> curve_columns;
+        float curve_centroid_z = 0.0f;
     };
 } // namespace
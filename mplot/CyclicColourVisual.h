@@ -4,7 +4,11 @@
 
 #pragma once
 
+#include <array>
+#include <algorithm>
+#include <cmath>
 #include <deque>
+#include <vector>
 
 #include <sm/mathconst>
 #include <sm/vec>
@@ -109,6 +113,15 @@ namespace mplot {
         {
             sm::vec<float> centre = {0,0,this->z};
 
+            this->colour_by_polar = this->analytic_fill;
+            if (this->analytic_fill) {
+                // One quad, coloured per fragment from a lookup of the ring's colours
+                this->polar_inner = this->inner_radius / this->outer_radius;
+                this->updateColourMap();
+                this->computePolarDisc (centre, this->outer_radius);
+                return;
+            }
+
             for (int ring = this->numrings; ring > 0; ring--) {
 
                 float r_d = this->outer_radius - this->inner_radius;
@@ -158,6 +171,31 @@ namespace mplot {
             }
         }
 
+        /*!
+         * If analytic_fill, update the ring's colour lookup after a change to cm (or to
+         * show_perception_sine). The lookup has numrings + 1 rows of numsegs colours, from the
+         * inner to the outer radius, and the change needs no change to the vertices.
+         */
+        void updateColourMap()
+        {
+            if (!this->analytic_fill) { return; }
+            const unsigned int rows = this->numrings + 1u;
+            std::vector<float> rgb (3u * rows * this->numsegs);
+            for (unsigned int k = 0; k < rows; ++k) {
+                const float norm_r = static_cast<float>(k) / static_cast<float>(this->numrings);
+                for (unsigned int j = 0; j < this->numsegs; ++j) {
+                    const float colour_angle = (static_cast<float>(j) / this->numsegs) * sm::mathconst<float>::two_pi;
+                    float decaying_sine = 0.0f;
+                    if (this->show_perception_sine) {
+                        decaying_sine = 0.1f * norm_r * norm_r * std::sin (20.0f * mc::pi * colour_angle);
+                    }
+                    const std::array<float, 3> c = this->cm.convert (colour_angle / mc::two_pi + decaying_sine);
+                    std::copy (c.begin(), c.end(), rgb.begin() + 3u * (k * this->numsegs + j));
+                }
+            }
+            this->set_polar_colour_lut (rgb, rows);
+        }
+
         //! The ColourMap to show (copy in). Should be a cyclic ColourMap
         mplot::ColourMap<F> cm;
         // Show a perceptual test sine?
@@ -182,6 +220,13 @@ namespace mplot {
         bool draw_ticks = true;
         //! Gap to x axis tick labels. Gets auto-set
         float ticklabelgap = 0.05f;
+        /*!
+         * If true, the ring is a single quad coloured per fragment (see
+         * VisualModel::colour_by_polar), and numsegs and numrings set the resolution of its colour
+         * lookup, between whose colours the ring is smoothly interpolated. If false, the ring is
+         * tessellated into numrings rings of numsegs segments.
+         */
+        bool analytic_fill = true;
         //! The number of segments to make in each ring of the colourmap fill
         unsigned int numsegs = 128;
         //! How many rings of colour?
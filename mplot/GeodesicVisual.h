@@ -1,12 +1,22 @@
 #pragma once
 
 #include <array>
+#include <vector>
+#include <span>
+#include <stdexcept>
+#include <limits>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <sm/mathconst>
 #include <sm/vec>
 #include <sm/vvec>
 #include <sm/scale>
 #include <sm/geometry>
 #include <mplot/VisualModel.h>
 #include <mplot/ColourMap.h>
+#include <mplot/lod.h>
 
 namespace mplot {
 
@@ -76,43 +86,84 @@ namespace mplot {
                 // Resize our data.
                 this->data.resize (n_verts, T{0});
             }
+
+            this->lod_table.clear();
+            if (this->lod_levels > 0) { this->build_lod(); }
+        }
+
+        /*!
+         * Hold up to lod_levels coarser geodesics (of iterations - 1, iterations - 2 and so on)
+         * after the sphere, each element (face or vertex) of which takes the mean (or max) of the
+         * data of the elements of the sphere that are nearest to it. In update_lod, the
+         * coarsest geodesic whose elements are no more than lod_pixel_size pixels across on the
+         * screen is drawn. Set before finalize(); 0 turns this off.
+         */
+        void set_lod_levels (const int n_levels)
+        {
+            this->lod_levels = n_levels > 0 ? n_levels : 0;
+            this->lod_enabled = this->lod_levels > 0;
+            if (!this->lod_enabled) { this->draw_spans.clear(); }
         }
+        int get_lod_levels() const { return this->lod_levels; }
+
+        //! How the data are aggregated into the elements of the coarser geodesics
+        lod::aggregation lod_aggregation = lod::aggregation::mean;
+        //! The largest on-screen size (in pixels) of an element of the geodesic that is drawn
+        float lod_pixel_size = 1.0f;
 
+        //! The centres of the faces in Cartesian and in spherical coordinates (r, theta, phi), as
+        //! computed by vertexPositionsToFaces
         sm::vvec<sm::vec<float>> cart_centres;
         sm::vvec<sm::vec<float>> sph_centres;
+
+        /*!
+         * Compute the centres (the centroids) of the faces of the sphere in cart_centres and
+         * sph_centres. There is one for each element of data (or cdata) when
+         * colourFaces is true. The centres depend only on iterations, radius and colourFaces, so
+         * they are computed (in parallel) only on the first call after these change.
+         */
         void vertexPositionsToFaces()
         {
             if (!this->n_faces) { throw std::runtime_error ("Call this after finalize()"); }
-            // Iterate through this->vertexPositions and indices, to compute the centres of each
-            // facet of the sphere, then project this onto the sphere. This gives an array of
-            // coordinates the same size as this->data/this->cdata. From these compute coordinates
-            // (r, theta, phi).
-            this->cart_centres.resize (this->n_faces);
-            this->sph_centres.resize (this->n_faces);
-            for (size_t i = 0; i < this->indices.size(); i+=3) {
-                int _vtx1 = this->indices[i];
-                int _vtx2 = this->indices[i+1];
-                int _vtx3 = this->indices[i+2];
-                sm::vec<float> v1 = {
-                    this->vertexPositions[3 * _vtx1],
-                    this->vertexPositions[3 * _vtx1 + 1],
-                    this->vertexPositions[3 * _vtx1+ 2]
-                };
-                sm::vec<float> v2 = {
-                    this->vertexPositions[3 * _vtx2],
-                    this->vertexPositions[3 * _vtx2 + 1],
-                    this->vertexPositions[3 * _vtx2+ 2]
-                };
-                sm::vec<float> v3 = {
-                    this->vertexPositions[3 * _vtx3],
-                    this->vertexPositions[3 * _vtx3 + 1],
-                    this->vertexPositions[3 * _vtx3+ 2]
-                };
-                this->cart_centres[i/3] = (v1 + v2 + v3) / 3.0f;
-                this->sph_centres[i/3] = this->cart_centres[i/3].cartesian_to_spherical();
+            const std::size_t nf = static_cast<std::size_t>(this->n_faces);
+            if (this->centres_iterations == this->iterations && this->centres_radius == this->radius
+                && this->centres_colourFaces == this->colourFaces && this->cart_centres.size() == nf) {
+                return;
             }
+            if (this->indices.size() < 3u * nf) { throw std::runtime_error ("Call this after finalize()"); }
+            this->cart_centres.resize (nf);
+            this->sph_centres.resize (nf);
+            const std::int64_t n_f = static_cast<std::int64_t>(nf);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (std::int64_t f = 0; f < n_f; ++f) {
+                const float* v1 = this->vertexPositions.data() + 3u * this->indices[3 * f];
+                const float* v2 = this->vertexPositions.data() + 3u * this->indices[3 * f + 1];
+                const float* v3 = this->vertexPositions.data() + 3u * this->indices[3 * f + 2];
+                sm::vec<float> c;
+                for (std::size_t j = 0; j < 3u; ++j) { c[j] = (v1[j] + v2[j] + v3[j]) / 3.0f; }
+                this->cart_centres[f] = c;
+                this->sph_centres[f] = c.cartesian_to_spherical();
+            }
+            this->centres_iterations = this->iterations;
+            this->centres_radius = this->radius;
+            this->centres_colourFaces = this->colourFaces;
         }
 
+        //! The Cartesian centres of the faces (computing them with vertexPositionsToFaces if necessary)
+        std::span<const sm::vec<float>> face_centres()
+        {
+            this->vertexPositionsToFaces();
+            return { this->cart_centres.data(), this->cart_centres.size() };
+        }
+
+        //! The centres of the faces in spherical coordinates (r, theta, phi)
+        std::span<const sm::vec<float>> face_centres_spherical()
+        {
+            this->vertexPositionsToFaces();
+            return { this->sph_centres.data(), this->sph_centres.size() };
+        }
 
         //! reinit just the colours based on vvec<T> data
         void reinitColours()
@@ -121,6 +172,8 @@ namespace mplot {
 
             size_t n_cvals = this->vertexColors.size();
             if (n_cvals == 0u) { return; } // model doesn't exist yet
+            // The colours of the sphere itself, without those of any coarser geodesics
+            if (this->lod_table.size() > 1u) { n_cvals = 3u * this->lod_table[1].first_vertex; }
 
             if (!this->cdata.empty()) {
 
@@ -169,10 +222,153 @@ namespace mplot {
                     }
                 }
             }
+            this->push_lod_colours();
             // Lastly, this call copies vertexColors (etc) into the OpenGL memory space
             this->reinit_colour_buffer();
         }
 
+    protected:
+        //! Add the coarser geodesics and find the nearest of their elements to each element of the sphere
+        void build_lod()
+        {
+            const int n_el0 = this->colourFaces ? this->n_faces : this->n_verts;
+            lod_level base;
+            base.iterations = this->iterations;
+            base.index_count = this->indices.size();
+            base.n_elements = static_cast<std::size_t>(n_el0);
+            const std::vector<sm::vec<float>> dirs0 = this->element_directions (0, base.n_elements);
+            this->lod_table.push_back (std::move (base));
+
+            const int it_min = std::max (0, this->iterations - this->lod_levels);
+            for (int it = this->iterations - 1; it >= it_min; --it) {
+                lod_level lv;
+                lv.iterations = it;
+                lv.first_index = this->indices.size();
+                lv.first_vertex = this->vertexPositions.size() / 3u;
+                const sm::vec<float, 3> so = { 0.0f, 0.0f, 0.0f };
+                const std::array<float, 3> sc = this->cm.convert (0.0f);
+                int n_el = 0;
+                if (this->colourFaces == true) {
+                    n_el = it > 5 ? this->template computeSphereGeoFaces<double> (so, sc, this->radius, it)
+                    : this->computeSphereGeoFaces (so, sc, this->radius, it);
+                } else {
+                    n_el = it > 5 ? this->template computeSphereGeo<double> (so, sc, this->radius, it)
+                    : this->computeSphereGeo (so, sc, this->radius, it);
+                }
+                lv.n_elements = static_cast<std::size_t>(n_el);
+                lv.index_count = this->indices.size() - lv.first_index;
+                lv.parent = lod::nearest (dirs0, this->element_directions (lv.first_vertex, lv.n_elements));
+                this->lod_table.push_back (std::move (lv));
+            }
+        }
+
+        //! The unit vectors to the n_el face centres (or vertices) of the geodesic whose first vertex is v0
+        std::vector<sm::vec<float>> element_directions (const std::size_t v0, const std::size_t n_el) const
+        {
+            std::vector<sm::vec<float>> d (n_el);
+            const std::size_t vpe = this->colourFaces ? 3u : 1u;
+            for (std::size_t e = 0; e < n_el; ++e) {
+                sm::vec<float> c = { 0.0f, 0.0f, 0.0f };
+                for (std::size_t j = 0; j < vpe; ++j) {
+                    const float* vp = this->vertexPositions.data() + 3u * (v0 + vpe * e + j);
+                    c += sm::vec<float>{ vp[0], vp[1], vp[2] };
+                }
+                c.renormalize();
+                d[e] = c;
+            }
+            return d;
+        }
+
+        //! Push the colours of the coarser geodesics onto vertexColors, after those of the sphere
+        void push_lod_colours()
+        {
+            const std::size_t vpe = this->colourFaces ? 3u : 1u;
+            for (std::size_t l = 1; l < this->lod_table.size(); ++l) {
+                const lod_level& lv = this->lod_table[l];
+                std::vector<std::array<float, 3>> clr (lv.n_elements, this->cm.convert (0.0f));
+                if (!this->cdata.empty()) {
+                    // The mean of the colours
+                    std::vector<std::array<float, 4>> sum (lv.n_elements, { 0.0f, 0.0f, 0.0f, 0.0f });
+                    for (std::size_t e = 0; e < lv.parent.size() && e < this->cdata.size(); ++e) {
+                        std::array<float, 4>& s = sum[lv.parent[e]];
+                        for (std::size_t j = 0; j < 3u; ++j) { s[j] += this->cdata[e][j]; }
+                        s[3] += 1.0f;
+                    }
+                    for (std::size_t g = 0; g < lv.n_elements; ++g) {
+                        if (sum[g][3] > 0.0f) { for (std::size_t j = 0; j < 3u; ++j) { clr[g][j] = sum[g][j] / sum[g][3]; } }
+                    }
+                } else if (!this->data.empty()) {
+                    std::vector<double> agg (lv.n_elements, 0.0);
+                    std::vector<std::size_t> count (lv.n_elements, 0u);
+                    for (std::size_t e = 0; e < lv.parent.size() && e < this->data.size(); ++e) {
+                        const std::uint32_t g = lv.parent[e];
+                        const double v = static_cast<double>(this->data[e]);
+                        if (this->lod_aggregation == lod::aggregation::max) {
+                            agg[g] = count[g] == 0u ? v : std::max (agg[g], v);
+                        } else if (this->lod_aggregation == lod::aggregation::min) {
+                            agg[g] = count[g] == 0u ? v : std::min (agg[g], v);
+                        } else {
+                            agg[g] += v;
+                        }
+                        ++count[g];
+                    }
+                    for (std::size_t g = 0; g < lv.n_elements; ++g) {
+                        if (count[g] == 0u) { continue; }
+                        const double v = this->lod_aggregation == lod::aggregation::mean ? agg[g] / count[g] : agg[g];
+                        clr[g] = this->cm.convert (this->colourScale.transform_one (static_cast<T>(v)));
+                    }
+                }
+                for (std::size_t g = 0; g < lv.n_elements; ++g) {
+                    for (std::size_t j = 0; j < vpe; ++j) { this->vertex_push (clr[g], this->vertexColors); }
+                }
+            }
+        }
+
+        //! Draw the coarsest geodesic whose elements are no more than lod_pixel_size pixels across
+        void update_lod() override
+        {
+            // While a build runs, lod_table is being rewritten; keep the spans for the current buffers
+            if (this->async_build.valid() || this->lod_viewport_h <= 0) { return; }
+            this->draw_spans.clear();
+            if (this->lod_table.size() < 2u) { return; }
+
+            const sm::mat44<float> mv = this->scenematrix * this->model_matrix();
+            const sm::vec<float, 4> ux = mv * sm::vec<float, 4>{ 1.0f, 0.0f, 0.0f, 0.0f };
+            const float r_eye = this->radius * std::sqrt (ux[0] * ux[0] + ux[1] * ux[1] + ux[2] * ux[2]);
+            // The point of the sphere nearest the camera (which looks along -z in eye coordinates)
+            sm::vec<float, 4> near = mv * sm::vec<float, 4>{ 0.0f, 0.0f, 0.0f, 1.0f };
+            near[2] = std::min (near[2] + r_eye, -std::numeric_limits<float>::epsilon());
+
+            std::size_t l = this->lod_table.size() - 1u;
+            while (l > 0) {
+                const float len = r_eye * std::sqrt (4.0f * sm::mathconst<float>::pi / static_cast<float>(this->lod_table[l].n_elements));
+                if (lod::screen_size (this->lod_projection, near, len, this->lod_viewport_h) <= this->lod_pixel_size) { break; }
+                --l;
+            }
+            lod::append_span (this->draw_spans, this->lod_table[l].first_index, this->lod_table[l].index_count);
+        }
+
+        //! One of the geodesics held for the levels of detail
+        struct lod_level
+        {
+            int iterations = 0;
+            std::size_t first_index = 0;
+            std::size_t index_count = 0;
+            std::size_t first_vertex = 0;
+            //! The number of faces (or vertices, if the vertices are coloured)
+            std::size_t n_elements = 0;
+            //! For each element of the sphere, the nearest element of this geodesic
+            std::vector<std::uint32_t> parent;
+        };
+        //! The sphere and then the coarser geodesics
+        std::vector<lod_level> lod_table;
+        int lod_levels = 0;
+        //! The iterations, radius and colourFaces for which cart_centres and sph_centres were computed
+        int centres_iterations = -1;
+        float centres_radius = 0.0f;
+        bool centres_colourFaces = false;
+
+    public:
         //! The radius of the geodesic
         float radius = 1.0f;
         //! The colour of the object. Can be resized to n_faces to colour each face
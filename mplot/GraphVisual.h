@@ -10,10 +10,15 @@
 #include <array>
 #include <vector>
 #include <deque>
+#include <limits>
+#include <algorithm>
 #include <cmath>
 #include <sstream>
 #include <memory>
 #include <cstdint>
+#include <cstddef>
+#include <span>
+#include <chrono>
 
 #include <sm/mathconst>
 #include <sm/scale>
@@ -58,13 +63,25 @@ namespace mplot {
         //! Set true for any optional debugging
         static constexpr bool gv_debug = false;
 
-        //! Append a single datum onto the relevant graph. Build on existing data in
-        //! graphDataCoords. Finish up with a call to completeAppend(). didx is the data
-        //! index and counts up from 0. Have to save _abscissa and _ordinate in a local
-        //! copy of the data to be able to rescale.
+        /*!
+         * Append a single datum onto the relevant graph. Build on existing data in
+         * graphDataCoords. didx is the data index and counts up from 0. Have to save _abscissa
+         * and _ordinate in a local copy of the data to be able to rescale.
+         *
+         * Unless the datum changes the axis ranges (with auto_rescale_x/y) or starts a new
+         * dataset, the graph is not rebuilt. Instead, at the next render, only the new markers and
+         * lines are computed and only their vertices are uploaded to the GPU, into space that
+         * VisualModel reserves for growth (see VisualModel::reserve_buffers).
+         */
         void append (const Flt& _abscissa, const Flt& _ordinate, const unsigned int didx)
         {
+            if (this->window_size > 0) {
+                this->append_windowed (_abscissa, _ordinate, didx);
+                return;
+            }
             this->pendingAppended = true;
+            // The new datum is in model coordinates, so the dataset's must be too
+            if (didx < this->graphDataCoords.size()) { this->settle_coords (didx); }
             // Transfor the data into temporary containers sd and ad
             Flt o = Flt{0};
             if (this->datastyles[didx].axisside == mplot::axisside::left) {
@@ -97,7 +114,10 @@ namespace mplot {
 
             // Now sd and ad can be used to construct dataCoords x/y. They are used to
             // set the position of each datum into dataCoords
+            bool rebuild = false;
             if (graphDataCoords.size() < didx + 1) {
+                // A new dataset needs a legend entry, so the whole graph is rebuilt
+                rebuild = true;
                 // Need to add an additional graphDataCoords to receive data. This can occur after
                 // appending the first data point of a first dataset and then appending the first
                 // data point of a second dataset to an otherwise empty graph.
@@ -131,10 +151,13 @@ namespace mplot {
 
             // update graph if necessary
             if (redraw_plot > 0) {
+                rebuild = true;
                 this->clear_graph_data();
 
                 // setdata or this function will re-add these
                 this->graphDataCoords.clear();
+                this->coord_maps.clear();
+                this->lod_sources.clear();
                 this->datastyles.clear();
 
                 this->pendingAppended = true; // as the graph will be re-drawn
@@ -155,19 +178,43 @@ namespace mplot {
                 }
             }
 
-            VisualModel<glver>::clear(); // Get rid of the vertices.
-            this->initializeVertices(); // Re-build
+            if (rebuild) {
+                this->poolTexts(); // initializeVertices reuses the tick labels that are unchanged
+                VisualModel<glver>::clear(); // Get rid of the vertices.
+                this->initializeVertices(); // Re-build
+                this->pendingRebuilt = true;
+            }
         }
 
         //! Before calling the base class's render method, check if we have any pending data
         void render()
         {
-            if (this->pendingAppended == true) {
+            if (this->view_pending && this->view_settle_ms > 0) {
+                // Rebuild the axes for a view that has been left alone for view_settle_ms
+                if (std::chrono::steady_clock::now() - this->view_changed >= std::chrono::milliseconds (this->view_settle_ms)) {
+                    this->settle_view();
+                } else {
+                    this->scene_changed(); // so that there is a render in which to settle
+                }
+            }
+            if (this->pendingAppended == true && this->window_size > 0) {
+                this->window_update();
+                this->pendingAppended = false;
+            } else if (this->pendingAppended == true) {
                 // After adding to graphDataCoords, we have to create the new OpenGL
                 // vertices (CPU side) and update the OpenGL buffers.
+                const std::size_t nv0 = this->vertexPositions.size() / 3u;
+                const std::size_t ni0 = this->indices.size();
                 this->drawAppendedData();
+                if (this->pendingRebuilt == false) {
+                    // Only the appended vertices need to go to the GPU. The axes and earlier
+                    // data are unchanged.
+                    this->mark_dirty (nv0, this->vertexPositions.size() / 3u);
+                    this->mark_dirty_indices (ni0, this->indices.size());
+                }
                 this->reinit_buffers();
                 this->pendingAppended = false;
+                this->pendingRebuilt = false;
             }
             // Now do the usual drawing stuff from VisualModel:
             VisualModel<glver>::render();
@@ -183,6 +230,30 @@ namespace mplot {
             this->reinit();
         }
 
+        /*!
+         * Remove all the datasets, but keep the graph's settings, so that the axis limits can be
+         * set again (with setlimits_x and friends) before new setdata calls. Call reinit() (with
+         * poolTexts() first, to reuse the unchanged tick labels) after the setdata calls to
+         * rebuild the graph.
+         */
+        void clear_datasets()
+        {
+            this->graphDataCoords.clear();
+            this->coord_maps.clear();
+            this->lod_sources.clear();
+            this->datastyles.clear();
+            this->quivers.clear();
+            this->absc1.clear();
+            this->absc2.clear();
+            this->ord1.clear();
+            this->ord2.clear();
+            this->data_spans.clear();
+            this->dataset_bars.clear();
+            this->abscissa_scale.reset();
+            this->ord1_scale.reset();
+            this->ord2_scale.reset();
+        }
+
         //! Update the data for the graph, recomputing the vertices when done.
         template <typename Ctnr1, typename Ctnr2>
         std::enable_if_t<sm::is_copyable_container<Ctnr1>::value
@@ -196,6 +267,9 @@ namespace mplot {
                 throw std::runtime_error ("GraphVisual::update: size mismatch");
             }
 
+            // The axis ranges before the update. If they don't change, the axes can stay as they are.
+            const std::array<sm::range<Flt>, 3> ranges0 = { this->datarange_x, this->datarange_y, this->datarange_y2 };
+
             if (data_idx >= this->graphDataCoords.size()) {
                 std::cout << "Can't add data at graphDataCoords index " << data_idx << std::endl;
                 return;
@@ -203,6 +277,10 @@ namespace mplot {
 
             // Ensure the vector at data_idx has enough capacity for the updated data
             this->graphDataCoords[data_idx]->resize (dsize);
+            // which is about to be rewritten in model coordinates
+            this->coord_map (data_idx) = identity_map;
+            if (data_idx < this->dataset_polylines_current.size()) { this->dataset_polylines_current[data_idx] = false; }
+            const std::array<std::array<float, 2>, 3> p0 = this->axis_params();
 
             // Are we auto-rescaling the x axis?
             if (this->auto_rescale_x) {
@@ -264,9 +342,23 @@ namespace mplot {
             for (unsigned int i = 0; i < dsize; ++i) {
                 this->graphDataCoords[data_idx].get()->at(i) = sm::vec<float>{ static_cast<float>(ad[i]), static_cast<float>(sd[i]), float{0} };
             }
+            this->decimate_dataset (data_idx);
 
-            this->clearTexts(); // VisualModel::clearTexts()
-            this->reinit();
+            const std::array<sm::range<Flt>, 3> ranges1 = { this->datarange_x, this->datarange_y, this->datarange_y2 };
+            bool axes_unchanged = true;
+            for (unsigned int i = 0; i < 3; ++i) {
+                axes_unchanged = axes_unchanged && ranges0[i].min == ranges1[i].min && ranges0[i].max == ranges1[i].max;
+            }
+            if (axes_unchanged && this->update_gpu_bars (data_idx)) { return; }
+            if (axes_unchanged && this->redraw_dataset (data_idx)) {
+                // Only the vertices of dataset data_idx were marked, so only they are uploaded
+                this->reinit_buffers();
+                return;
+            }
+
+            // The other datasets were placed on the old axes
+            if (!axes_unchanged) { this->remap_datasets (p0, data_idx); }
+            this->rebuild_keeping_lines();
         }
 
         //! update() overload that accepts vvec of coords
@@ -292,6 +384,8 @@ namespace mplot {
                 std::cout << "Can't add change data label at graphDataCoords index " << data_idx << std::endl;
                 return;
             }
+            // A new label changes the legend, so the whole graph is rebuilt
+            if (this->datastyles[data_idx].datalabel != datalabel) { this->data_spans.clear(); }
             this->datastyles[data_idx].datalabel = datalabel;
             this->update (_abscissae, _data, data_idx);
         }
@@ -501,6 +595,7 @@ namespace mplot {
                 for (uint64_t i = 0; i < dsize; ++i) {
                     this->graphDataCoords[didx].get()->at(i) = sm::vec<float>{ static_cast<float>(ad[i]), static_cast<float>(sd[i]), float{0} };
                 }
+                this->decimate_dataset (didx);
             }
         }
 
@@ -581,6 +676,14 @@ namespace mplot {
             this->setdata (h.bins, h.proportions, ds);
         }
 
+        //! Update dataset data_idx, which was set from a histogram, from h. With gpu_bars, and
+        //! a y axis that need not change, this only rewrites the tops of the bars.
+        template<typename H>
+        void update (const sm::histo<H, Flt>& h, const unsigned int data_idx)
+        {
+            this->update (h.bins, h.proportions, data_idx);
+        }
+
         /*!
          * Add vertical lines representing the x locations at which the function has the value
          * y_value on the graph. Note that the same abscissae and data must be passed to this
@@ -1000,6 +1103,135 @@ namespace mplot {
             this->resetsize (this->width, this->height);
         }
 
+        /*!
+         * Make this a scrolling graph that shows at most n points of each dataset. Once a dataset
+         * holds n points, each append() drops its oldest point, and the x axis scrolls so that the
+         * newest point is at its right hand end. The width of the x axis, in data units, is set
+         * with setlimits_x, so choose n to match it. Call before setdata/prepdata. Works with
+         * lines and regular markers (not bars or quivers).
+         *
+         * Each render after an append costs O(new points): only the new markers and lines are
+         * computed and uploaded, along with the axes and tick labels if the x axis moved. The
+         * data geometry is drawn with a translation that lines it up with the scrolled axis (see
+         * VisualModel::draw_spans). The whole graph is rebuilt only when the geometry of dropped
+         * points outweighs that of the points in the window, or when the y axis range changes.
+         */
+        void setwindow (const unsigned int n)
+        {
+            if (!this->graphDataCoords.empty()) {
+                throw std::runtime_error ("GraphVisual::setwindow: Call this function *before* using setdata/prepdata");
+            }
+            this->window_size = n;
+        }
+
+        /*!
+         * Change the axis limits of a finalized graph, to pan or zoom it. The axes, tick labels
+         * and legend are rebuilt, but the data are not transformed again. Datasets of lines only,
+         * drawn as GPU polylines (see gpu_lines), are given a new transform, a change of
+         * uniforms with no upload, and are clipped to the axes by the GPU. The others are moved
+         * onto the new axes from their model coordinates. Not for scrolling graphs.
+         */
+        void relimit (const sm::range<Flt>& range_x, const sm::range<Flt>& range_y)
+        {
+            this->relimit (range_x, range_y, this->datarange_y2);
+        }
+
+        //! relimit() for graphs with left and right y axes
+        void relimit (const sm::range<Flt>& range_x, const sm::range<Flt>& range_y, const sm::range<Flt>& range_y2)
+        {
+            if (this->window_size > 0) {
+                throw std::runtime_error ("GraphVisual::relimit: A scrolling graph sets its own x axis limits");
+            }
+            const std::array<std::array<float, 2>, 3> p0 = this->axis_params();
+            this->setlimits_x (range_x, true);
+            this->abscissa_scale.reset();
+            this->abscissa_scale.compute_scaling (this->datarange_x);
+            this->setlimits_y (range_y, true);
+            this->ord1_scale.reset();
+            this->ord1_scale.compute_scaling (this->datarange_y);
+            if (this->ord2_scale.ready()) {
+                this->setlimits_y2 (range_y2, true);
+                this->ord2_scale.reset();
+                this->ord2_scale.compute_scaling (this->datarange_y2);
+            }
+            this->view_map = identity_map;
+            this->view_pending = false;
+            this->remap_datasets (p0, npos);
+            this->refine_lod();
+            this->rebuild_keeping_lines();
+        }
+
+        /*!
+         * Show the data in range_x and range_y (of the left y axis) at once, by changing only the
+         * transforms of the datasets drawn as GPU polylines (see gpu_lines), which the GPU clips
+         * to the axes. Nothing is recomputed or uploaded, so this can follow the mouse. The
+         * axes, tick labels and any datasets drawn on the CPU keep the old limits until the view
+         * settles: view_settle_ms after its last change, or at settle_view().
+         */
+        void setview (const sm::range<Flt>& range_x, const sm::range<Flt>& range_y)
+        {
+            const std::array<std::array<float, 2>, 3> p = this->axis_params();
+            const std::array<sm::range<Flt>, 2> rr = { range_x, range_y };
+            const std::array<const sm::scale<Flt>*, 2> scales = { &this->abscissa_scale, &this->ord1_scale };
+            for (unsigned int j = 0; j < 2u; ++j) {
+                // The ends of the range on the axes as they are drawn, to go to the ends of the axes
+                const float u0 = p[j][0] * static_cast<float>(rr[j].min) + p[j][1];
+                const float u1 = p[j][0] * static_cast<float>(rr[j].max) + p[j][1];
+                if (u1 == u0) { return; }
+                const float o0 = static_cast<float>(scales[j]->output_range.min);
+                const float o1 = static_cast<float>(scales[j]->output_range.max);
+                this->view_map[2u * j] = (o1 - o0) / (u1 - u0);
+                this->view_map[2u * j + 1u] = o0 - this->view_map[2u * j] * u0;
+            }
+            this->apply_view();
+        }
+
+        //! Zoom the view by factor (more than 1 to zoom in) about the point about, in the model
+        //! coordinates of the graph as it is drawn. See setview.
+        void zoomview (const float factor, const sm::vec<float, 2>& about)
+        {
+            if (!(factor > 0.0f)) { return; }
+            for (unsigned int j = 0; j < 2u; ++j) {
+                this->view_map[2u * j] *= factor;
+                this->view_map[2u * j + 1u] = factor * (this->view_map[2u * j + 1u] - about[j]) + about[j];
+            }
+            this->apply_view();
+        }
+
+        //! Zoom the view by factor about the centre of the axes
+        void zoomview (const float factor) { this->zoomview (factor, { 0.5f * this->width, 0.5f * this->height }); }
+
+        //! Move the view by d, in model units. See setview.
+        void panview (const sm::vec<float, 2>& d)
+        {
+            this->view_map[1] += d[0];
+            this->view_map[3] += d[1];
+            this->apply_view();
+        }
+
+        //! Rebuild the axes, tick labels and datasets for the view now (see setview), with relimit()
+        void settle_view()
+        {
+            if (!this->view_pending) { return; }
+            // The data ranges seen through the view at the ends of each axis
+            const std::array<std::array<float, 2>, 3> p = this->axis_params();
+            const std::array<const sm::scale<Flt>*, 3> scales = { &this->abscissa_scale, &this->ord1_scale, &this->ord2_scale };
+            std::array<sm::range<Flt>, 3> rr = { this->datarange_x, this->datarange_y, this->datarange_y2 };
+            for (unsigned int i = 0; i < 3u; ++i) {
+                if (!scales[i]->ready() || p[i][0] == 0.0f) { continue; }
+                const unsigned int j = i == 0u ? 0u : 1u;
+                auto to_data = [this, &p, i, j](const Flt o)
+                {
+                    const float u = (static_cast<float>(o) - this->view_map[2u * j + 1u]) / this->view_map[2u * j];
+                    return static_cast<Flt>((u - p[i][1]) / p[i][0]);
+                };
+                rr[i] = sm::range<Flt>(to_data (scales[i]->output_range.min), to_data (scales[i]->output_range.max));
+            }
+            this->view_map = identity_map;
+            this->view_pending = false;
+            this->relimit (rr[0], rr[1], rr[2]);
+        }
+
         //! Set the 'object thickness' attribute (maybe used just for 'object spacing')
         void setthickness (float th) { this->relative_thickness = th; }
 
@@ -1016,12 +1248,334 @@ namespace mplot {
         //! points are in each graph curve
         std::vector<unsigned int> coords_lengths;
 
+        //! The vertices [v0, v1) and elements of indices [i0, i1) that hold one dataset's geometry
+        struct data_span
+        {
+            std::size_t v0 = 0;
+            std::size_t v1 = 0;
+            std::size_t i0 = 0;
+            std::size_t i1 = 0;
+        };
+        /*!
+         * Where the geometry of each dataset lies in the buffers, between the axes and the
+         * legend. With these, update() can re-draw one dataset without re-drawing (or
+         * re-uploading) the axes, tick labels, legend or other datasets. Empty if unknown (after
+         * append(), or in a scrolling graph), in which case update() rebuilds the whole graph.
+         */
+        std::vector<data_span> data_spans;
+        /*!
+         * The bar set (see VisualModel::add_bars) in which each dataset's bars are drawn, if
+         * gpu_bars is set, or npos. Empty once bars have been appended on the CPU.
+         */
+        std::vector<std::size_t> dataset_bars;
+        static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+        /*!
+         * For each dataset, the map { x scale, x offset, y scale, y offset } from its
+         * graphDataCoords to model coordinates. It is the identity until a change of axes
+         * (relimit(), or an update() that rescales them), which changes the map rather than the
+         * coordinates. A dataset drawn as a GPU polyline then needs only a new transform; for the
+         * others, the map is applied to the coordinates before they are drawn (settle_coords).
+         */
+        std::vector<std::array<float, 4>> coord_maps;
+        static constexpr std::array<float, 4> identity_map = { 1.0f, 0.0f, 1.0f, 0.0f };
+        //! The GPU polyline of each dataset (if gpu_lines is set), or npos
+        std::vector<std::size_t> dataset_polylines;
+        //! Are the points of each dataset's polyline those of its graphDataCoords?
+        std::vector<bool> dataset_polylines_current;
+        //! The polylines set aside from reinit() by rebuild_keeping_lines()
+        std::vector<typename VisualModel<glver>::polyline> kept_polylines;
+        std::vector<float> kept_polyline_points;
+        bool kept_polylines_changed = false;
+        bool keeping_lines = false;
+        /*!
+         * The view (see setview): the map { x scale, x offset, y scale, y offset } in model
+         * coordinates from the graph on its axes to the graph as it is shown, applied to the
+         * polylines of the datasets until the view settles and the axes are rebuilt for it.
+         */
+        std::array<float, 4> view_map = identity_map;
+        bool view_pending = false;
+        std::chrono::steady_clock::time_point view_changed;
+        //! The full resolution graphDataCoords of each dataset decimated with lod_follows_view
+        std::vector<std::vector<sm::vec<float>>> lod_sources;
+
         //! Is there pending appended data that needs to be converted into OpenGL shapes?
         bool pendingAppended = false;
+        //! Was the whole graph rebuilt by append() since the last render?
+        bool pendingRebuilt = false;
+
+        //! If non-zero, this is a scrolling graph holding at most window_size points per dataset
+        unsigned int window_size = 0;
+        //! A datum in the window of a scrolling graph and the element of indices at which its
+        //! geometry starts
+        struct window_datum
+        {
+            static constexpr std::size_t undrawn = std::numeric_limits<std::size_t>::max();
+            sm::vec<Flt, 2> xy = {};
+            std::size_t idx_start = undrawn;
+        };
+        //! The data in the window of each dataset of a scrolling graph
+        std::vector<std::deque<window_datum>> window_data;
+        //! The abscissa scaling with which the data geometry of a scrolling graph was computed
+        sm::scale<Flt> window_scale;
+        //! The model space x translation that lines the data geometry up with abscissa_scale
+        float window_shift = 0.0f;
+        //! The numbers of vertices and indices reserved for the axes, ticks and legend at the
+        //! start of the buffers of a scrolling graph. The data geometry follows.
+        std::array<std::size_t, 2> window_static = { 0u, 0u };
+        //! The first element of indices that is drawn for the data of a scrolling graph
+        std::size_t window_first = 0;
+        //! Has the x axis scrolled since the scrolling graph was last drawn?
+        bool window_axes_moved = false;
+        //! Must the whole scrolling graph be rebuilt (because the y axis range changed)?
+        bool window_rebuild = false;
+
+        //! append() for a scrolling graph (see setwindow)
+        void append_windowed (const Flt& _abscissa, const Flt& _ordinate, const unsigned int didx)
+        {
+            if (didx >= this->graphDataCoords.size()) {
+                throw std::runtime_error ("GraphVisual::append: In a scrolling graph, prepdata() each dataset before appending to it");
+            }
+            this->pendingAppended = true;
+            if (this->window_data.size() < this->graphDataCoords.size()) { this->window_data.resize (this->graphDataCoords.size()); }
+            if (!this->window_scale.ready()) { this->window_scale = this->abscissa_scale; }
+
+            // Scroll the x axis so that the newest datum is at its right hand end
+            if (_abscissa > this->datarange_x.max) {
+                const Flt span = this->datarange_x.max - this->datarange_x.min;
+                this->datarange_x.max = _abscissa;
+                this->datarange_x.min = _abscissa - span;
+                this->abscissa_scale.reset();
+                this->abscissa_scale.compute_scaling (this->datarange_x);
+                this->window_axes_moved = true;
+            }
+
+            // A change of y axis range changes all the data geometry, so needs a rebuild
+            const bool left = this->datastyles[didx].axisside == mplot::axisside::left;
+            sm::scale<Flt>& ord_scale = left ? this->ord1_scale : this->ord2_scale;
+            if (this->auto_rescale_y) {
+                sm::range<Flt>& yrange = left ? this->datarange_y : this->datarange_y2;
+                if (yrange.update (_ordinate)) {
+                    ord_scale.reset();
+                    ord_scale.compute_scaling (yrange);
+                    this->window_rebuild = true;
+                }
+            }
+
+            const Flt a = this->window_scale.transform_one (_abscissa);
+            const Flt o = ord_scale.transform_one (_ordinate);
+            this->graphDataCoords[didx]->push_back (sm::vec<float>{ static_cast<float>(a), static_cast<float>(o), 0.0f });
+
+            std::deque<window_datum>& wd = this->window_data[didx];
+            wd.push_back (window_datum{ sm::vec<Flt, 2>{ _abscissa, _ordinate }, window_datum::undrawn });
+            while (wd.size() > this->window_size) { wd.pop_front(); }
+        }
+
+        //! Draw the axes, legend, tick labels and axis labels (everything but the data)
+        void window_draw_axes()
+        {
+            this->drawAxes();
+            if (this->legend == true) { this->drawLegend(); }
+            this->drawTickLabels();
+            this->drawAxisLabels();
+            this->dropTextPool();
+        }
+
+        //! Pad the axes geometry with degenerate triangles to fill the space reserved for it
+        void window_pad_axes()
+        {
+            this->vertexPositions.resize (3u * this->window_static[0], 0.0f);
+            this->vertexNormals.resize (3u * this->window_static[0], 0.0f);
+            this->vertexColors.resize (3u * this->window_static[0], 0.0f);
+            this->indices.resize (this->window_static[1], 0u);
+        }
+
+        /*!
+         * Re-draw the axes of a scrolling graph in the space reserved for them at the start of
+         * the buffers, leaving the data geometry in place. Returns false if the new axes
+         * geometry does not fit, in which case the graph must be rebuilt.
+         */
+        bool window_redraw_axes()
+        {
+            // Move the data aside so that the axes can be drawn from vertex 0
+            std::vector<float> posns;
+            std::vector<float> norms;
+            std::vector<float> clrs;
+            std::vector<GLuint> inds;
+            std::swap (posns, this->vertexPositions);
+            std::swap (norms, this->vertexNormals);
+            std::swap (clrs, this->vertexColors);
+            std::swap (inds, this->indices);
+            const GLuint data_idx = this->idx;
+
+            this->idx = 0u;
+            this->poolTexts();
+            this->window_draw_axes();
+            const bool fits = (this->vertexPositions.size() <= 3u * this->window_static[0]
+                               && this->indices.size() <= this->window_static[1]);
+            if (fits) {
+                this->window_pad_axes();
+                std::copy (this->vertexPositions.begin(), this->vertexPositions.end(), posns.begin());
+                std::copy (this->vertexNormals.begin(), this->vertexNormals.end(), norms.begin());
+                std::copy (this->vertexColors.begin(), this->vertexColors.end(), clrs.begin());
+                std::copy (this->indices.begin(), this->indices.end(), inds.begin());
+            }
+
+            std::swap (posns, this->vertexPositions);
+            std::swap (norms, this->vertexNormals);
+            std::swap (clrs, this->vertexColors);
+            std::swap (inds, this->indices);
+            this->idx = data_idx;
+            return fits;
+        }
+
+        //! Draw the markers and lines of each datum appended to a scrolling graph since it was
+        //! last drawn, recording where each datum's geometry starts
+        void window_draw_data()
+        {
+            if (this->coords_lengths.size() < this->graphDataCoords.size()) {
+                this->coords_lengths.resize (this->graphDataCoords.size(), 0u);
+            }
+            for (unsigned int dsi = 0; dsi < this->graphDataCoords.size(); ++dsi) {
+                const unsigned int n = static_cast<unsigned int>(this->graphDataCoords[dsi]->size());
+                std::deque<window_datum>& wd = this->window_data[dsi];
+                // graphDataCoords[dsi] also holds points that have left the window since the last rebuild
+                const std::size_t first_in_window = n - wd.size();
+                for (unsigned int i = this->coords_lengths[dsi]; i < n; ++i) {
+                    if (i < first_in_window) { continue; } // dropped before it was ever drawn
+                    wd[i - first_in_window].idx_start = this->indices.size();
+                    this->drawDataCommon (dsi, i, i + 1, appending_data);
+                }
+                this->coords_lengths[dsi] = n;
+            }
+        }
+
+        //! Set the draw_spans of a scrolling graph: the axes, then the data still in the window
+        void window_set_spans()
+        {
+            std::size_t first = this->indices.size();
+            for (const auto& wd : this->window_data) {
+                if (!wd.empty() && wd.front().idx_start != window_datum::undrawn) {
+                    first = std::min (first, wd.front().idx_start);
+                }
+            }
+            this->window_first = first;
+            this->draw_spans = {
+                { 0u, this->window_static[1], sm::vec<float>{ 0.0f, 0.0f, 0.0f } },
+                { first, this->indices.size() - first, sm::vec<float>{ this->window_shift, 0.0f, 0.0f } }
+            };
+        }
+
+        //! Lay out a scrolling graph: the axes (with room to spare) followed by the data
+        void window_build()
+        {
+            this->data_spans.clear();
+            if (this->window_data.size() < this->graphDataCoords.size()) { this->window_data.resize (this->graphDataCoords.size()); }
+
+            // The data geometry is computed with the current abscissa scaling, and translated to
+            // follow the x axis as it scrolls
+            this->window_scale = this->abscissa_scale;
+            this->window_shift = 0.0f;
+
+            for (unsigned int dsi = 0; dsi < this->graphDataCoords.size(); ++dsi) {
+                std::vector<sm::vec<float>>& gdc = *this->graphDataCoords[dsi];
+                std::deque<window_datum>& wd = this->window_data[dsi];
+                const bool left = this->datastyles[dsi].axisside == mplot::axisside::left;
+                const sm::scale<Flt>& ord_scale = left ? this->ord1_scale : this->ord2_scale;
+                if (wd.empty()) {
+                    // Data from setdata, rather than append
+                    const std::size_t n0 = gdc.size() > this->window_size ? gdc.size() - this->window_size : 0u;
+                    for (std::size_t i = n0; i < gdc.size(); ++i) {
+                        wd.push_back (window_datum{ sm::vec<Flt, 2>{ this->abscissa_scale.inverse_one (gdc[i][0]),
+                                                                     ord_scale.inverse_one (gdc[i][1]) },
+                                                    window_datum::undrawn });
+                    }
+                }
+                // Rebuild the coordinates of the points in the window, dropping the rest
+                gdc.clear();
+                for (auto& d : wd) {
+                    gdc.push_back (sm::vec<float>{ static_cast<float>(this->window_scale.transform_one (d.xy[0])),
+                                                   static_cast<float>(ord_scale.transform_one (d.xy[1])), 0.0f });
+                    d.idx_start = window_datum::undrawn;
+                }
+            }
+            this->coords_lengths.assign (this->graphDataCoords.size(), 0u);
+
+            this->idx = 0u;
+            this->window_draw_axes();
+            // Leave room for the axes geometry to change as they scroll (the number of ticks
+            // varies). The index count is kept a multiple of 3, so it is whole triangles.
+            const std::size_t nv = this->vertexPositions.size() / 3u;
+            const std::size_t ni = this->indices.size();
+            this->window_static = { nv + nv / 2u, 3u * ((ni + ni / 2u + 2u) / 3u) };
+            this->window_pad_axes();
+            this->idx = static_cast<GLuint>(this->window_static[0]);
+
+            this->window_draw_data();
+            this->window_set_spans();
+            // Leave room for the data to grow before the next rebuild
+            this->reserve_buffers (2u * this->vertexPositions.size() / 3u, 2u * this->indices.size());
+        }
+
+        //! Rebuild a scrolling graph from the data in its windows
+        void window_rebuild_all()
+        {
+            this->vertexPositions.clear();
+            this->vertexNormals.clear();
+            this->vertexColors.clear();
+            this->indices.clear();
+            this->poolTexts();
+            this->initializeVertices();
+            this->window_rebuild = false;
+            this->window_axes_moved = false;
+            this->reinit_buffers();
+        }
+
+        //! Bring the geometry of a scrolling graph up to date with the data appended to it
+        void window_update()
+        {
+            // Once the dropped points' geometry outweighs the points in the window, compact
+            const std::size_t dead = this->window_first > this->window_static[1] ? this->window_first - this->window_static[1] : 0u;
+            const std::size_t live = this->indices.size() - this->window_first;
+            if (this->window_rebuild || dead > live) {
+                this->window_rebuild_all();
+                return;
+            }
+
+            const std::size_t nv0 = this->vertexPositions.size() / 3u;
+            const std::size_t ni0 = this->indices.size();
+            this->window_shift = static_cast<float>(this->abscissa_scale.transform_one (Flt{0})
+                                                    - this->window_scale.transform_one (Flt{0}));
+            if (this->window_axes_moved) {
+                if (!this->window_redraw_axes()) {
+                    this->window_rebuild_all();
+                    return;
+                }
+                this->mark_dirty (0u, this->window_static[0]);
+                this->mark_dirty_indices (0u, this->window_static[1]);
+                this->window_axes_moved = false;
+            }
+            this->window_draw_data();
+            this->mark_dirty (nv0, this->vertexPositions.size() / 3u);
+            this->mark_dirty_indices (ni0, this->indices.size());
+            this->window_set_spans();
+            this->reinit_buffers();
+        }
 
         //! Compute stuff for a graph
         void initializeVertices()
         {
+            if (this->window_size > 0) {
+                this->window_build();
+                return;
+            }
+            if (this->keeping_lines) {
+                // Back come the polylines that rebuild_keeping_lines() set aside from reinit()
+                std::swap (this->polylines, this->kept_polylines);
+                std::swap (this->polyline_points, this->kept_polyline_points);
+                this->polylines_changed = this->kept_polylines_changed;
+            } else {
+                this->dataset_polylines.clear();
+            }
             // The indices index
             this->idx = 0;
             this->drawAxes();
@@ -1029,13 +1583,14 @@ namespace mplot {
             if (this->legend == true) { this->drawLegend(); }
             this->drawTickLabels(); // from which we can store the tick label widths
             this->drawAxisLabels();
+            this->dropTextPool();
         }
 
         //! Is the passed in coordinate within the graph axes (in the x/y sense, ignoring z)?
         bool within_axes (sm::vec<float>& datapoint)
         {
             bool within = false;
-            if (datapoint[0] >= 0 && datapoint[0] <= this->width
+            if (datapoint[0] + this->window_shift >= 0 && datapoint[0] + this->window_shift <= this->width
                 && datapoint[1] >= 0 && datapoint[1] <= this->height) {
                 within = true;
             }
@@ -1043,19 +1598,31 @@ namespace mplot {
         }
 
         //! Is the passed in coordinate within the graph axes (in the x sense, ignoring z)?
-        bool within_axes_x (sm::vec<float>& dpt) { return (dpt[0] >= 0 && dpt[0] <= this->width); }
+        bool within_axes_x (sm::vec<float>& dpt) { return (dpt[0] + this->window_shift >= 0 && dpt[0] + this->window_shift <= this->width); }
         bool within_axes_y (sm::vec<float>& dpt) { return (dpt[1] >= 0 && dpt[1] <= this->height); }
 
         //! dsi: data set iterator
         void drawDataCommon (unsigned int dsi, unsigned int coords_start, unsigned int coords_end, bool appending = false)
         {
+            // Lines alone, drawn by the GPU, can leave the coordinates to its transform.
+            // Everything else is computed from model coordinates.
+            const mplot::DatasetStyle& dst = this->datastyles[dsi];
+            const bool gpu_line = this->gpu_lines && !appending && this->window_size == 0 && dst.markergap <= 0.0f
+            && dst.showlines && dst.markerstyle != markerstyle::bar;
+            if (!gpu_line || dst.markerstyle != markerstyle::none) { this->settle_coords (dsi); }
+            if (!gpu_line && !appending) { this->drop_gpu_line (dsi); }
+
             // Draw data markers
             if (this->datastyles[dsi].markerstyle != markerstyle::none) {
 
                 if (this->datastyles[dsi].markerstyle == markerstyle::bar) { // Data markers are bars
 
-                    for (unsigned int i = coords_start; i < coords_end; ++i) {
-                        this->bar ((*this->graphDataCoords[dsi])[i], this->datastyles[dsi]);
+                    if (this->gpu_bars && !appending && this->window_size == 0 && dsi < this->dataset_bars.size()) {
+                        this->dataset_bars[dsi] = this->add_gpu_bars (dsi, coords_start, coords_end);
+                    } else {
+                        for (unsigned int i = coords_start; i < coords_end; ++i) {
+                            this->bar ((*this->graphDataCoords[dsi])[i], this->datastyles[dsi]);
+                        }
                     }
 
                 } else if (this->datastyles[dsi].markerstyle == markerstyle::quiver) { // Markers are quivers
@@ -1116,12 +1683,7 @@ namespace mplot {
                     }
 
                 } else { // Regular data markers
-
-                    for (unsigned int i = coords_start; i < coords_end; ++i) {
-                        if (this->within_axes ((*this->graphDataCoords[dsi])[i])) {
-                            this->marker ((*this->graphDataCoords[dsi])[i], this->datastyles[dsi]);
-                        } // else marker is outside graph axes so don't draw it
-                    }
+                    this->stamp_markers (dsi, coords_start, coords_end);
                 }
             }
             if (this->datastyles[dsi].markerstyle == markerstyle::bar && this->datastyles[dsi].showlines == true) {
@@ -1131,81 +1693,228 @@ namespace mplot {
                 // If appending markers to a dataset, need to add the line preceding the first marker
                 if (appending == true) { if (coords_start != 0) { coords_start -= 1; } }
 
-                for (unsigned int i = coords_start+1; i < coords_end; ++i) {
-                    // Draw tube from location -1 to location 0.
-                    if (this->draw_beyond_axes == true
-                        || (this->within_axes ((*this->graphDataCoords[dsi])[i-1])
-                            && this->within_axes ((*this->graphDataCoords[dsi])[i]))) {
-
-                        if (this->datastyles[dsi].markergap > 0.0f) {
-                            auto point_to_point = (*this->graphDataCoords[dsi])[i] - (*this->graphDataCoords[dsi])[i-1];
-                            if (point_to_point.length() > this->datastyles[dsi].markergap * 2.0f) {
-                                // Draw solid lines between marker points with gaps between line and marker
-                                this->computeFlatLine ((*this->graphDataCoords[dsi])[i-1], (*this->graphDataCoords[dsi])[i], this->uz,
-                                                       this->datastyles[dsi].linecolour,
-                                                       this->datastyles[dsi].linewidth, this->datastyles[dsi].markergap);
-                            }
-                        } else if (appending == true) {
-                            // We are appending a line to an existing graph, so compute a single line with rounded ends
-                            this->computeFlatLineRnd ((*this->graphDataCoords[dsi])[i-1], // start
-                                                      (*this->graphDataCoords[dsi])[i],   // end
-                                                      this->uz,
-                                                      this->datastyles[dsi].linecolour,
-                                                      this->datastyles[dsi].linewidth, 0.0f, true, false);
-                        } else {
-                            // No gaps, so draw a perfect set of joined up lines.
-
-                            // To make this draw dotted or dashed lines, we have to
-                            // track the length of the lines we've added to the graph
-                            // and draw the alt colour (which may be bg colour) between the dashes.
-                            if (i == 1+coords_start && (coords_end-coords_start)==2) {
-                                // First and only line
-                                this->computeFlatLine ((*this->graphDataCoords[dsi])[i-1], // start
-                                                       (*this->graphDataCoords[dsi])[i],   // end
-                                                       this->uz,
-                                                       this->datastyles[dsi].linecolour,
-                                                       this->datastyles[dsi].linewidth);
-                            } else if (i == 1+coords_start) {
-                                // First line
-                                this->computeFlatLineN ((*this->graphDataCoords[dsi])[i-1], // start
-                                                        (*this->graphDataCoords[dsi])[i],   // end
-                                                        (*this->graphDataCoords[dsi])[i+1], // next
-                                                        this->uz,
-                                                        this->datastyles[dsi].linecolour,
-                                                        this->datastyles[dsi].linewidth);
-                            } else if (i == (coords_end-1)) {
-                                // last line
-                                this->computeFlatLineP ((*this->graphDataCoords[dsi])[i-1], (*this->graphDataCoords[dsi])[i],
-                                                        (*this->graphDataCoords[dsi])[i-2],
-                                                        this->uz,
-                                                        this->datastyles[dsi].linecolour,
-                                                        this->datastyles[dsi].linewidth);
-                            } else {
-                                // An intermediate line
-                                this->computeFlatLine ((*this->graphDataCoords[dsi])[i-1], (*this->graphDataCoords[dsi])[i],
-                                                       (*this->graphDataCoords[dsi])[i-2], (*this->graphDataCoords[dsi])[i+1],
-                                                       this->uz,
-                                                       this->datastyles[dsi].linecolour,
-                                                       this->datastyles[dsi].linewidth);
-                            }
-                        }
+                if (gpu_line) {
+                    this->draw_gpu_line (dsi);
+                    return;
+                }
+
+                // Reserve for one flat line per pair of points (rounded, appended lines add a little more)
+                if (coords_end > coords_start + 1) {
+                    const std::size_t n_lines = coords_end - coords_start - 1;
+                    this->reserve_geometry (n_lines * this->flat_line_vertex_count(), n_lines * this->flat_line_index_count());
+                }
+
+                // Choose the loop once for the dataset, so that the per-segment loop has no
+                // branches on its style. A segment outside the axes is not drawn (unless
+                // draw_beyond_axes). IDEALLY I'd interpolate to draw the line UP to the axis.
+                const bool clip = !this->draw_beyond_axes;
+                if (this->datastyles[dsi].markergap > 0.0f) {
+                    if (clip) { this->draw_lines<line_kind::gapped, true> (dsi, coords_start, coords_end); }
+                    else { this->draw_lines<line_kind::gapped, false> (dsi, coords_start, coords_end); }
+                } else if (appending == true) {
+                    if (clip) { this->draw_lines<line_kind::rounded, true> (dsi, coords_start, coords_end); }
+                    else { this->draw_lines<line_kind::rounded, false> (dsi, coords_start, coords_end); }
+                } else {
+                    if (clip) { this->draw_lines<line_kind::joined, true> (dsi, coords_start, coords_end); }
+                    else { this->draw_lines<line_kind::joined, false> (dsi, coords_start, coords_end); }
+                }
+            }
+        }
+
+        //! The ways in which the segments of a data line are drawn (see draw_lines)
+        enum class line_kind
+        {
+            //! Separate lines, shortened to leave a gap (markergap) around each marker
+            gapped,
+            //! Separate lines with rounded ends, as appended to an existing line
+            rounded,
+            //! A line of segments joined at their ends
+            joined
+        };
+
+        /*!
+         * Draw the line segments of dataset dsi between the points [coords_start, coords_end).
+         * kind and clip (if true, draw only segments that lie within the axes) are template
+         * parameters, chosen once per dataset by drawDataCommon, so the loops over the segments
+         * do not branch on the dataset's style.
+         */
+        template <line_kind kind, bool clip>
+        void draw_lines (const unsigned int dsi, const unsigned int coords_start, const unsigned int coords_end)
+        {
+            if (coords_end < coords_start + 2u) { return; }
+            std::vector<sm::vec<float>>& dc = *this->graphDataCoords[dsi];
+            const std::array<float, 3> lc = this->datastyles[dsi].linecolour;
+            const float lw = this->datastyles[dsi].linewidth;
+            // Is segment i (from point i-1 to point i) drawn?
+            auto drawn = [this, &dc](const unsigned int i)
+            {
+                if constexpr (clip) { return this->within_axes (dc[i-1]) && this->within_axes (dc[i]); }
+                else { return true; }
+            };
+
+            if constexpr (kind == line_kind::gapped) {
+                const float gap = this->datastyles[dsi].markergap;
+                for (unsigned int i = coords_start + 1u; i < coords_end; ++i) {
+                    // Draw solid lines between marker points with gaps between line and marker
+                    if (drawn (i) && (dc[i] - dc[i-1]).length() > gap * 2.0f) {
+                        this->computeFlatLine (dc[i-1], dc[i], this->uz, lc, lw, gap);
+                    }
+                }
+
+            } else if constexpr (kind == line_kind::rounded) {
+                for (unsigned int i = coords_start + 1u; i < coords_end; ++i) {
+                    if (drawn (i)) { this->computeFlatLineRnd (dc[i-1], dc[i], this->uz, lc, lw, 0.0f, true, false); }
+                }
 
-                    } // else line segment is outside axes and we're not to draw it. IDEALLY I'd interpolate to draw the line UP to the axis.
+            } else {
+                // No gaps, so draw a perfect set of joined up lines. To make this draw dotted or
+                // dashed lines, we have to track the length of the lines we've added to the graph
+                // and draw the alt colour (which may be bg colour) between the dashes.
+                const unsigned int first = coords_start + 1u;
+                const unsigned int last = coords_end - 1u;
+                if (first == last) {
+                    // The first and only line
+                    if (drawn (first)) { this->computeFlatLine (dc[first-1], dc[first], this->uz, lc, lw); }
+                    return;
+                }
+                if (drawn (first)) { this->computeFlatLineN (dc[first-1], dc[first], dc[first+1], this->uz, lc, lw); }
+                for (unsigned int i = first + 1u; i < last; ++i) {
+                    // An intermediate line, mitred to its neighbours
+                    if (drawn (i)) { this->computeFlatLine (dc[i-1], dc[i], dc[i-2], dc[i+1], this->uz, lc, lw); }
+                }
+                if (drawn (last)) { this->computeFlatLineP (dc[last-1], dc[last], dc[last-2], this->uz, lc, lw); }
+            }
+        }
+
+        /*!
+         * Draw the markers of dataset dsi at the points [coords_start, coords_end) that lie within
+         * the axes. One marker is made (by marker()) and its geometry is then copied to each
+         * point, into buffers that are sized once for all of the markers, so the per-marker work
+         * is a translation.
+         */
+        void stamp_markers (const unsigned int dsi, const unsigned int coords_start, const unsigned int coords_end)
+        {
+            std::vector<sm::vec<float>>& dc = *this->graphDataCoords[dsi];
+            std::size_t n_within = 0;
+            for (unsigned int i = coords_start; i < coords_end; ++i) { if (this->within_axes (dc[i])) { ++n_within; } }
+            if (n_within == 0u) { return; }
+
+            // Make one marker, at the origin, in empty containers
+            std::vector<float> mpos;
+            std::vector<float> mnorm;
+            std::vector<float> mcol;
+            std::vector<GLuint> mind;
+            std::swap (mpos, this->vertexPositions);
+            std::swap (mnorm, this->vertexNormals);
+            std::swap (mcol, this->vertexColors);
+            std::swap (mind, this->indices);
+            const GLuint idx0 = this->idx;
+            this->idx = 0u;
+            sm::vec<float> origin = { 0.0f, 0.0f, 0.0f };
+            this->marker (origin, this->datastyles[dsi]);
+            this->idx = idx0;
+            std::swap (mpos, this->vertexPositions);
+            std::swap (mnorm, this->vertexNormals);
+            std::swap (mcol, this->vertexColors);
+            std::swap (mind, this->indices);
+
+            const std::size_t nf = mpos.size(); // floats per marker
+            const std::size_t ni = mind.size();
+            const GLuint nv = static_cast<GLuint>(nf / 3u);
+            const std::size_t v0 = this->vertexPositions.size();
+            const std::size_t i0 = this->indices.size();
+            this->vertexPositions.resize (v0 + nf * n_within);
+            this->vertexNormals.resize (v0 + nf * n_within);
+            this->vertexColors.resize (v0 + nf * n_within);
+            this->indices.resize (i0 + ni * n_within);
+
+            float* p = this->vertexPositions.data() + v0;
+            float* nm = this->vertexNormals.data() + v0;
+            float* cl = this->vertexColors.data() + v0;
+            GLuint* ip = this->indices.data() + i0;
+            for (unsigned int i = coords_start; i < coords_end; ++i) {
+                if (!this->within_axes (dc[i])) { continue; } // marker is outside graph axes so don't draw it
+                for (std::size_t k = 0; k < nf; k += 3u) {
+                    p[k] = mpos[k] + dc[i][0];
+                    p[k + 1u] = mpos[k + 1u] + dc[i][1];
+                    p[k + 2u] = mpos[k + 2u] + dc[i][2];
                 }
+                std::copy (mnorm.begin(), mnorm.end(), nm);
+                std::copy (mcol.begin(), mcol.end(), cl);
+                for (std::size_t k = 0; k < ni; ++k) { ip[k] = mind[k] + this->idx; }
+                p += nf;
+                nm += nf;
+                cl += nf;
+                ip += ni;
+                this->idx += nv;
             }
         }
 
+        //! Apply M4 decimation (see lod_columns) to the data coordinates, coords, of a dataset
+        //! with style ds
+        void decimate (std::vector<sm::vec<float>>& coords, const mplot::DatasetStyle& ds) const
+        {
+            const std::size_t n = coords.size();
+            if (this->lod_columns == 0u || n <= 4u * static_cast<std::size_t>(this->lod_columns)) { return; }
+            if (ds.markerstyle == markerstyle::bar || ds.markerstyle == markerstyle::quiver
+                || ds.markerstyle == markerstyle::quiver_fromcoord || ds.markerstyle == markerstyle::quiver_tocoord) {
+                return;
+            }
+            for (std::size_t i = 1; i < n; ++i) {
+                if (coords[i][0] < coords[i - 1][0]) { return; } // Not a function of x; leave it be
+            }
+            const float x0 = coords.front()[0];
+            const float span = coords.back()[0] - x0;
+            if (!(span > 0.0f)) { return; }
+
+            const float cols = static_cast<float>(this->lod_columns);
+            auto column = [x0, span, cols, this](const sm::vec<float>& c)
+            {
+                return std::min (this->lod_columns - 1u, static_cast<unsigned int>((c[0] - x0) / span * cols));
+            };
+
+            std::vector<sm::vec<float>> out;
+            out.reserve (4u * static_cast<std::size_t>(this->lod_columns));
+            std::size_t i = 0;
+            while (i < n) {
+                const unsigned int col = column (coords[i]);
+                std::size_t j = i;
+                std::size_t imin = i;
+                std::size_t imax = i;
+                while (j < n && column (coords[j]) == col) {
+                    if (coords[j][1] < coords[imin][1]) { imin = j; }
+                    if (coords[j][1] > coords[imax][1]) { imax = j; }
+                    ++j;
+                }
+                // Keep the chosen points in their original order
+                const std::array<std::size_t, 4> keep = { i, std::min (imin, imax), std::max (imin, imax), j - 1u };
+                std::size_t prev = n;
+                for (std::size_t k : keep) {
+                    if (k != prev) { out.push_back (coords[k]); }
+                    prev = k;
+                }
+                i = j;
+            }
+            coords.swap (out);
+        }
+
         // Defines a boolean 'true' that can be provided as arg to drawDataCommon()
         static constexpr bool appending_data = true;
 
         //! Draw markers and lines for data points that are being appended to a graph
         void drawAppendedData()
         {
+            // Any dataset not yet drawn is drawn from its start
+            if (this->coords_lengths.size() < this->graphDataCoords.size()) {
+                this->coords_lengths.resize (this->graphDataCoords.size(), 0u);
+            }
             for (unsigned int dsi = 0; dsi < this->graphDataCoords.size(); ++dsi) {
                 // Start is old end:
                 unsigned int coords_start = this->coords_lengths[dsi];
                 unsigned int coords_end = static_cast<unsigned int>(this->graphDataCoords[dsi]->size());
                 this->coords_lengths[dsi] = coords_end;
+                // Appended geometry follows the legend, so the datasets are no longer contiguous
+                if (coords_end > coords_start) { this->data_spans.clear(); this->dataset_bars.clear(); }
                 this->drawDataCommon (dsi, coords_start, coords_end, appending_data);
             }
         }
@@ -1215,12 +1924,91 @@ namespace mplot {
         {
             unsigned int coords_start = 0;
             this->coords_lengths.resize (this->graphDataCoords.size());
+            this->data_spans.resize (this->graphDataCoords.size());
+            this->dataset_bars.assign (this->graphDataCoords.size(), npos);
             for (unsigned int dsi = 0; dsi < static_cast<unsigned int>(this->graphDataCoords.size()); ++dsi) {
                 unsigned int coords_end = this->graphDataCoords[dsi]->size();
                 // Record coords length for future appending:
                 this->coords_lengths[dsi] = coords_end;
+                this->data_spans[dsi].v0 = this->vertexPositions.size() / 3u;
+                this->data_spans[dsi].i0 = this->indices.size();
                 this->drawDataCommon (dsi, coords_start, coords_end);
+                this->data_spans[dsi].v1 = this->vertexPositions.size() / 3u;
+                this->data_spans[dsi].i1 = this->indices.size();
+            }
+        }
+
+        /*!
+         * Re-draw dataset dsi in place of its old geometry, leaving the axes, tick labels, legend
+         * and other datasets as they are, and mark the changed vertices and indices for upload.
+         * If the dataset's geometry keeps its size, only its own span of the buffers is
+         * uploaded. Otherwise the geometry that follows it is moved up or down and uploaded too.
+         * Returns false if the graph has to be rebuilt instead.
+         */
+        bool redraw_dataset (const unsigned int dsi)
+        {
+            if (this->window_size > 0 || this->gpu_lines || this->gpu_bars || this->pendingAppended || this->indices.empty()
+                || this->data_spans.size() != this->graphDataCoords.size() || dsi >= this->data_spans.size()) {
+                return false;
+            }
+            const data_span old = this->data_spans[dsi];
+
+            // Draw the dataset into empty containers, numbering its vertices from old.v0
+            std::vector<float> posns;
+            std::vector<float> norms;
+            std::vector<float> clrs;
+            std::vector<GLuint> inds;
+            std::swap (posns, this->vertexPositions);
+            std::swap (norms, this->vertexNormals);
+            std::swap (clrs, this->vertexColors);
+            std::swap (inds, this->indices);
+            const GLuint idx_end = this->idx;
+            this->idx = static_cast<GLuint>(old.v0);
+            const unsigned int n = static_cast<unsigned int>(this->graphDataCoords[dsi]->size());
+            this->coords_lengths[dsi] = n;
+            this->drawDataCommon (dsi, 0u, n);
+            std::swap (posns, this->vertexPositions);
+            std::swap (norms, this->vertexNormals);
+            std::swap (clrs, this->vertexColors);
+            std::swap (inds, this->indices);
+            this->idx = idx_end;
+
+            const std::size_t nv = posns.size() / 3u;
+            const std::size_t ni = inds.size();
+            if (nv == old.v1 - old.v0 && ni == old.i1 - old.i0) {
+                std::copy (posns.begin(), posns.end(), this->vertexPositions.begin() + 3u * old.v0);
+                std::copy (norms.begin(), norms.end(), this->vertexNormals.begin() + 3u * old.v0);
+                std::copy (clrs.begin(), clrs.end(), this->vertexColors.begin() + 3u * old.v0);
+                std::copy (inds.begin(), inds.end(), this->indices.begin() + old.i0);
+                this->mark_dirty (old.v0, old.v1);
+                this->mark_dirty_indices (old.i0, old.i1);
+            } else {
+                // The geometry after this dataset's (that of later datasets and the legend) moves
+                const std::ptrdiff_t dv = static_cast<std::ptrdiff_t>(nv) - static_cast<std::ptrdiff_t>(old.v1 - old.v0);
+                const std::ptrdiff_t di = static_cast<std::ptrdiff_t>(ni) - static_cast<std::ptrdiff_t>(old.i1 - old.i0);
+                for (std::size_t i = old.i1; i < this->indices.size(); ++i) {
+                    this->indices[i] = static_cast<GLuint>(static_cast<std::ptrdiff_t>(this->indices[i]) + dv);
+                }
+                auto splice = [](auto& dst, const std::size_t b, const std::size_t e, const auto& src)
+                {
+                    dst.erase (dst.begin() + b, dst.begin() + e);
+                    dst.insert (dst.begin() + b, src.begin(), src.end());
+                };
+                splice (this->vertexPositions, 3u * old.v0, 3u * old.v1, posns);
+                splice (this->vertexNormals, 3u * old.v0, 3u * old.v1, norms);
+                splice (this->vertexColors, 3u * old.v0, 3u * old.v1, clrs);
+                splice (this->indices, old.i0, old.i1, inds);
+                this->idx = static_cast<GLuint>(static_cast<std::ptrdiff_t>(this->idx) + dv);
+                for (std::size_t j = dsi + 1u; j < this->data_spans.size(); ++j) {
+                    data_span& sp = this->data_spans[j];
+                    sp = { sp.v0 + dv, sp.v1 + dv, sp.i0 + di, sp.i1 + di };
+                }
+                // If the geometry shrank, this falls back to uploading everything
+                this->mark_dirty (old.v0, this->vertexPositions.size() / 3u);
+                this->mark_dirty_indices (old.i0, this->indices.size());
             }
+            this->data_spans[dsi] = { old.v0, old.v0 + nv, old.i0, old.i0 + ni };
+            return true;
         }
 
         //! Draw the graph legend, above the graph, rather than inside it (so much simpler!)
@@ -1420,14 +2208,17 @@ namespace mplot {
                 float x_font_factor = 1.0f;
                 float max_label_length = 0.0f;
                 float xtick_spacing = this->width;
+                // The label strings are formatted once, here, and re-used below
+                std::vector<std::string> xlabels (this->xtick_posns.size());
+                for (unsigned int i = 0; i < this->xtick_posns.size(); ++i) {
+                    xlabels[i] = mplot::graphing::number_format (this->xticks[i], this->xticks[i==0 ? 1 : i-1]);
+                }
                 {
                     if (this->xtick_posns.size() >= 2) { xtick_spacing = this->xtick_posns[1] - this->xtick_posns[0]; }
                     // Create a temporary VisualTextModel to find the length of all the tick text
                     auto lbl = this->makeVisualTextModel (tf);
                     // Find longest string (more or less)
-                    for (unsigned int i = 0; i < this->xtick_posns.size(); ++i) {
-                        std::string s = mplot::graphing::number_format (this->xticks[i], this->xticks[i==0 ? 1 : i-1]);
-                        mplot::TextGeometry geom = lbl->getTextGeometry (s);
+                    for (auto geom : lbl->getTextGeometries (xlabels)) {
                         max_label_length = geom.width() > max_label_length ? geom.width() : max_label_length;
                     }
                 }
@@ -1442,16 +2233,16 @@ namespace mplot {
                     // Omit the 0 for 'cross' axes (or maybe shift its position)
                     if (this->axisstyle == axisstyle::cross && this->xticks[i] == 0) { continue; }
 
-                    std::string s = mplot::graphing::number_format (this->xticks[i], this->xticks[i==0 ? 1 : i-1]);
+                    const std::string& s = xlabels[i];
                     // Issue: I need the width of the text ss.str() before I can create the
                     // VisualTextModel, so need a static method like this:
                     tf.fontsize = x_font_factor * this->fontsize;
-                    auto lbl = this->makeVisualTextModel (tf);
+                    auto lbl = this->pooledTextModel (s, tf);
                     tf.fontsize = this->fontsize; // reset
                     mplot::TextGeometry geom = lbl->getTextGeometry (s);
                     this->xtick_label_height = geom.height() > this->xtick_label_height ? geom.height() : this->xtick_label_height;
                     sm::vec<float> lblpos = {(float)this->xtick_posns[i]-geom.half_width(), y_for_xticks-(this->ticklabelgap+geom.height()), 0};
-                    lbl->setupText (s, lblpos+this->mv_offset, this->axiscolour);
+                    this->setupPooledText (*lbl, s, lblpos+this->mv_offset, this->axiscolour);
                     this->texts.push_back (std::move(lbl));
                 }
             }
@@ -1462,7 +2253,7 @@ namespace mplot {
                     if (this->axisstyle == axisstyle::cross && this->yticks[i] == 0) { continue; }
 
                     std::string s = mplot::graphing::number_format (this->yticks[i], this->yticks[i==0 ? 1 : i-1]);
-                    auto lbl = this->makeVisualTextModel (tf);
+                    auto lbl = this->pooledTextModel (s, tf);
                     mplot::TextGeometry geom = lbl->getTextGeometry (s);
                     this->ytick_label_width = geom.width() > this->ytick_label_width ? geom.width() : this->ytick_label_width;
                     sm::vec<float> lblpos = {x_for_yticks-this->ticklabelgap-geom.width(), (float)this->ytick_posns[i]-geom.half_height(), 0};
@@ -1470,7 +2261,7 @@ namespace mplot {
                     if (this->axisstyle == axisstyle::twinax && this->datastyles.size() > 0) {
                         clr = this->datastyles[0].policy == stylepolicy::lines ? this->datastyles[0].linecolour : this->datastyles[0].markercolour;
                     }
-                    lbl->setupText (s, lblpos+this->mv_offset, clr);
+                    this->setupPooledText (*lbl, s, lblpos+this->mv_offset, clr);
                     this->texts.push_back (std::move(lbl));
                 }
             }
@@ -1479,7 +2270,7 @@ namespace mplot {
                 this->ytick_label_width2 = 0.0f;
                 for (unsigned int i = 0; i < this->ytick_posns2.size(); ++i) {
                     std::string s = mplot::graphing::number_format (this->yticks2[i], this->yticks2[i==0 ? 1 : i-1]);
-                    auto lbl = this->makeVisualTextModel (tf);
+                    auto lbl = this->pooledTextModel (s, tf);
                     mplot::TextGeometry geom = lbl->getTextGeometry (s);
                     this->ytick_label_width2 = geom.width() > this->ytick_label_width2 ? geom.width() : this->ytick_label_width2;
                     sm::vec<float> lblpos = {x_for_yticks+this->ticklabelgap, (float)this->ytick_posns2[i]-geom.half_height(), 0};
@@ -1488,7 +2279,7 @@ namespace mplot {
                         clr = this->datastyles[1].policy == stylepolicy::lines ? this->datastyles[1].linecolour : this->datastyles[1].markercolour;
 
                     }
-                    lbl->setupText (s, lblpos+this->mv_offset, clr);
+                    this->setupPooledText (*lbl, s, lblpos+this->mv_offset, clr);
                     this->texts.push_back (std::move(lbl));
                 }
             }
@@ -1688,6 +2479,235 @@ namespace mplot {
             }
         }
 
+        //! Draw the bars of dataset dsi as a GPU bar set, as bar() would draw them. Returns the
+        //! index of the bar set.
+        std::size_t add_gpu_bars (const unsigned int dsi, const unsigned int coords_start, const unsigned int coords_end)
+        {
+            const mplot::DatasetStyle& style = this->datastyles[dsi];
+            const std::vector<sm::vec<float>>& dc = *this->graphDataCoords[dsi];
+            std::vector<sm::vec<float, 2>> xtops (coords_end - coords_start);
+            for (unsigned int i = coords_start; i < coords_end; ++i) { xtops[i - coords_start] = { dc[i][0], dc[i][1] }; }
+            typename VisualModel<glver>::bar_set bs;
+            bs.width = style.markersize;
+            bs.base = this->height * this->dataaxisdist;
+            bs.z = this->thickness;
+            bs.colour = style.markercolour;
+            if (style.showlines == true) {
+                bs.line_colour = style.linecolour;
+                bs.line_width = style.linewidth;
+            }
+            return this->add_bars (xtops, bs);
+        }
+
+        /*!
+         * If dataset dsi is drawn as GPU bars (and has as many as before), move the tops of its
+         * bars to its updated coordinates. The bars are then uploaded at the next render, and
+         * nothing else is. Returns false if the graph has to be rebuilt instead.
+         */
+        //! The { scale, offset } of the abscissa, left and right ordinate scales ({ 1, 0 } for
+        //! one that is not ready)
+        std::array<std::array<float, 2>, 3> axis_params() const
+        {
+            std::array<std::array<float, 2>, 3> p = { { { 1.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 0.0f } } };
+            const std::array<const sm::scale<Flt>*, 3> scales = { &this->abscissa_scale, &this->ord1_scale, &this->ord2_scale };
+            for (unsigned int i = 0; i < 3u; ++i) {
+                if (scales[i]->ready()) {
+                    p[i] = { static_cast<float>(scales[i]->getParams(0)), static_cast<float>(scales[i]->getParams(1)) };
+                }
+            }
+            return p;
+        }
+
+        //! The map from the graphDataCoords of dataset dsi to model coordinates
+        std::array<float, 4>& coord_map (const unsigned int dsi)
+        {
+            if (this->coord_maps.size() < this->graphDataCoords.size()) {
+                this->coord_maps.resize (this->graphDataCoords.size(), identity_map);
+            }
+            return this->coord_maps[dsi];
+        }
+
+        /*!
+         * Compose with the maps of all the datasets but except the move from the axes whose
+         * scales had the parameters p0 (see axis_params) to the present axes. Both are affine in
+         * model coordinates, so the move is too.
+         */
+        void remap_datasets (const std::array<std::array<float, 2>, 3>& p0, const std::size_t except)
+        {
+            const std::array<std::array<float, 2>, 3> p1 = this->axis_params();
+            if (p0 == p1) { return; }
+            // The scale s and offset o of a map, followed by the move from q0 to q1
+            auto compose = [](float& s, float& o, const std::array<float, 2>& q0, const std::array<float, 2>& q1)
+            {
+                if (q0 == q1 || q0[0] == 0.0f) { return; }
+                const float k = q1[0] / q0[0];
+                s *= k;
+                o = k * (o - q0[1]) + q1[1];
+            };
+            for (unsigned int dsi = 0; dsi < this->graphDataCoords.size(); ++dsi) {
+                if (dsi == except) { continue; }
+                const unsigned int yi = this->datastyles[dsi].axisside == mplot::axisside::left ? 1u : 2u;
+                std::array<float, 4>& m = this->coord_map (dsi);
+                compose (m[0], m[1], p0[0], p1[0]);
+                compose (m[2], m[3], p0[yi], p1[yi]);
+            }
+        }
+
+        //! Apply the map of dataset dsi to its graphDataCoords, which are then model coordinates
+        void settle_coords (const unsigned int dsi)
+        {
+            std::array<float, 4>& m = this->coord_map (dsi);
+            if (m == identity_map) { return; }
+            for (sm::vec<float>& c : *this->graphDataCoords[dsi]) {
+                c[0] = m[0] * c[0] + m[1];
+                c[1] = m[2] * c[1] + m[3];
+            }
+            if (dsi < this->lod_sources.size()) {
+                for (sm::vec<float>& c : this->lod_sources[dsi]) {
+                    c[0] = m[0] * c[0] + m[1];
+                    c[1] = m[2] * c[1] + m[3];
+                }
+            }
+            m = identity_map;
+            if (dsi < this->dataset_polylines_current.size()) { this->dataset_polylines_current[dsi] = false; }
+        }
+
+        /*!
+         * Draw dataset dsi as one GPU polyline, with the dataset's map as its transform and, unless
+         * draw_beyond_axes, clipped to the axes. A polyline kept from before the rebuild (see
+         * rebuild_keeping_lines) is rewritten only if its points are out of date.
+         */
+        void draw_gpu_line (const unsigned int dsi)
+        {
+            if (this->dataset_polylines.size() < this->graphDataCoords.size()) {
+                this->dataset_polylines.resize (this->graphDataCoords.size(), npos);
+                this->dataset_polylines_current.resize (this->graphDataCoords.size(), false);
+            }
+            const std::vector<sm::vec<float>>& dc = *this->graphDataCoords[dsi];
+            const mplot::DatasetStyle& dst = this->datastyles[dsi];
+            std::size_t& pi = this->dataset_polylines[dsi];
+            if (pi == npos) {
+                if (dc.size() < 2u) { return; }
+                pi = this->add_polyline (dc, dst.linecolour, dst.linewidth, this->uz);
+            } else {
+                if (!this->dataset_polylines_current[dsi]) { this->set_polyline_points (pi, dc); }
+                this->set_polyline_colour (pi, dst.linecolour);
+                this->set_polyline_width (pi, dst.linewidth);
+            }
+            this->dataset_polylines_current[dsi] = true;
+
+            this->set_polyline_transform (pi, this->line_transform (dsi));
+            if (this->draw_beyond_axes) {
+                this->set_polyline_clip (pi, { 1.0f, 0.0f, 1.0f, 0.0f });
+            } else {
+                this->set_polyline_clip (pi, { 0.0f, this->width, 0.0f, this->height });
+            }
+        }
+
+        //! The transform of the polyline of dataset dsi: its map, followed by the view
+        typename VisualModel<glver>::polyline_transform line_transform (const unsigned int dsi)
+        {
+            const std::array<float, 4>& m = this->coord_map (dsi);
+            const std::array<float, 4>& v = this->view_map;
+            typename VisualModel<glver>::polyline_transform t;
+            t.scale = { v[0] * m[0], v[2] * m[2] };
+            t.offset = { v[0] * m[1] + v[1], v[2] * m[3] + v[3] };
+            return t;
+        }
+
+        //! Give the polylines of the datasets the view's transforms
+        void apply_view()
+        {
+            for (unsigned int dsi = 0; dsi < this->dataset_polylines.size(); ++dsi) {
+                if (this->dataset_polylines[dsi] != npos) {
+                    this->set_polyline_transform (this->dataset_polylines[dsi], this->line_transform (dsi));
+                }
+            }
+            this->view_pending = true;
+            this->view_changed = std::chrono::steady_clock::now();
+        }
+
+        /*!
+         * Decimate dataset dsi for its level of detail (see decimate). With lod_follows_view, a
+         * dataset that is reduced keeps its full resolution coordinates in lod_sources.
+         */
+        void decimate_dataset (const unsigned int dsi)
+        {
+            if (this->lod_sources.size() < this->graphDataCoords.size()) { this->lod_sources.resize (this->graphDataCoords.size()); }
+            std::vector<sm::vec<float>>& dc = *this->graphDataCoords[dsi];
+            if (!this->lod_follows_view) {
+                this->lod_sources[dsi].clear();
+                this->decimate (dc, this->datastyles[dsi]);
+                return;
+            }
+            std::vector<sm::vec<float>> full = dc;
+            this->decimate (dc, this->datastyles[dsi]);
+            if (dc.size() < full.size()) { this->lod_sources[dsi].swap (full); } else { this->lod_sources[dsi].clear(); }
+        }
+
+        /*!
+         * Decimate again the part of each dataset with a full resolution source (see
+         * lod_follows_view) that lies across the x axis, so that the level of detail follows a
+         * zoom. The points either side of the axis are kept so that the lines reach its ends.
+         */
+        void refine_lod()
+        {
+            for (unsigned int dsi = 0; dsi < this->lod_sources.size() && dsi < this->graphDataCoords.size(); ++dsi) {
+                const std::vector<sm::vec<float>>& src = this->lod_sources[dsi];
+                const std::array<float, 4>& m = this->coord_map (dsi);
+                if (src.empty() || !(m[0] > 0.0f)) { continue; }
+                // The x axis in the coordinates of src
+                const float x0 = -m[1] / m[0];
+                const float x1 = (this->width - m[1]) / m[0];
+                auto by_x = [](const sm::vec<float>& c, const float x) { return c[0] < x; };
+                auto b = std::lower_bound (src.begin(), src.end(), x0, by_x);
+                auto e = std::lower_bound (b, src.end(), x1, by_x);
+                if (b != src.begin()) { --b; }
+                if (e != src.end()) { ++e; }
+                std::vector<sm::vec<float>>& dc = *this->graphDataCoords[dsi];
+                dc.assign (b, e);
+                this->decimate (dc, this->datastyles[dsi]);
+                if (dsi < this->dataset_polylines_current.size()) { this->dataset_polylines_current[dsi] = false; }
+            }
+        }
+
+        //! Empty the GPU polyline of dataset dsi, if it has one, as it is to be drawn on the CPU
+        void drop_gpu_line (const unsigned int dsi)
+        {
+            if (dsi >= this->dataset_polylines.size() || this->dataset_polylines[dsi] == npos) { return; }
+            this->set_polyline_points (this->dataset_polylines[dsi], std::span<const sm::vec<float>>{});
+            this->dataset_polylines[dsi] = npos;
+        }
+
+        /*!
+         * reinit(), with the tick labels pooled for reuse, keeping the GPU polylines of the
+         * datasets. Those whose points are unchanged are then not uploaded again.
+         */
+        void rebuild_keeping_lines()
+        {
+            this->poolTexts(); // initializeVertices reuses the tick labels that are unchanged
+            if (this->gpu_lines && this->window_size == 0 && !this->dataset_polylines.empty()) {
+                std::swap (this->kept_polylines, this->polylines);
+                std::swap (this->kept_polyline_points, this->polyline_points);
+                this->kept_polylines_changed = this->polylines_changed;
+                this->keeping_lines = true;
+            }
+            this->reinit();
+            this->keeping_lines = false;
+        }
+
+        bool update_gpu_bars (const unsigned int dsi)
+        {
+            if (dsi >= this->dataset_bars.size() || this->dataset_bars[dsi] == npos || this->pendingAppended) { return false; }
+            const std::size_t bi = this->dataset_bars[dsi];
+            const std::vector<sm::vec<float>>& dc = *this->graphDataCoords[dsi];
+            if (bi >= this->get_bar_sets().size() || this->get_bar_sets()[bi].count != dc.size()) { return false; }
+            std::vector<float> tops (dc.size());
+            for (std::size_t i = 0; i < dc.size(); ++i) { tops[i] = dc[i][1]; }
+            this->set_bar_tops (bi, tops);
+            return true;
+        }
+
         //! Special code to draw a marker representing a bargraph bar for the legend
         void bar_symbol (sm::vec<float>& p, const mplot::DatasetStyle& style)
         {
@@ -1999,6 +3019,43 @@ namespace mplot {
         // might need tickfontsize and axisfontsize
         //! If this is true, then draw data lines even where they extend beyond the axes.
         bool draw_beyond_axes = false;
+        /*!
+         * Level of detail for large datasets. A dataset (of lines or regular markers, with
+         * increasing abscissae) with more than 4 points for each of lod_columns columns across
+         * the x axis is reduced to the first, minimum, maximum and last point in each column (M4
+         * decimation). This keeps the envelope of the data, and its geometry, no finer than the
+         * pixels there are to show it. Set 0 to draw every point.
+         */
+        unsigned int lod_columns = 4096;
+        /*!
+         * If true, the data lines of a graph are drawn as GPU polylines (see
+         * VisualModel::add_polyline) rather than triangulated on the CPU with computeFlatLine, so
+         * that very long datasets are quick to build. This applies to lines without marker gaps,
+         * in graphs that do not scroll; lines added by append() are still triangulated. The GPU
+         * clips the lines to the axes, and relimit() moves them with a change of transform.
+         */
+        bool gpu_lines = false;
+        /*!
+         * If true, the bars of bar graphs and histograms are drawn by the GPU (see
+         * VisualModel::add_bars), from the x and the top of each bar. Then update() with data
+         * that leaves the axes unchanged only rewrites the tops of the bars: there is no vertex
+         * regeneration, and the upload is 8 bytes per bar. Bars added by append() are drawn as
+         * usual.
+         */
+        bool gpu_bars = false;
+        /*!
+         * How long (in milliseconds) a view (see setview, zoomview and panview) must be left
+         * alone before a render() rebuilds the axes and tick labels for it. 0 to leave that to
+         * settle_view().
+         */
+        unsigned int view_settle_ms = 250;
+        /*!
+         * If true, a dataset that is decimated for its level of detail (see lod_columns) keeps
+         * its full resolution coordinates, so that when the axes are zoomed in (by relimit or a
+         * settled view) the part across the x axis is decimated again, at lod_columns across
+         * the new range. This doubles the memory used by such datasets. Set before setdata.
+         */
+        bool lod_follows_view = false;
         //! EITHER Gap from the y axis to the right hand of the y axis tick label text
         //! quads OR from the x axis to the top of the x axis tick label text quads
         float ticklabelgap = 0.05f;
@@ -2038,3 +3095,13 @@ namespace mplot {
     };
 
 } // namespace mplot
+
+#if defined MPLOT_CORE && defined GLAD_OPTION_GL_MX
+// Instantiated once, in the compiled mplot_core library (see core/graphvisual.cpp)
+namespace mplot {
+    extern template class GraphVisual<float, mplot::gl::version_4_1>;
+    extern template class GraphVisual<float, mplot::gl::version_4_5>;
+    extern template class GraphVisual<double, mplot::gl::version_4_1>;
+    extern template class GraphVisual<double, mplot::gl::version_4_5>;
+} // namespace mplot
+#endif
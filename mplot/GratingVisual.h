@@ -11,6 +11,7 @@
 #include <array>
 #include <bitset>
 #include <map>
+#include <cmath>
 
 #include <sm/mathconst>
 #include <sm/vec>
@@ -29,7 +30,7 @@ namespace mplot {
         unknown
     };
 
-    std::string border_id_str (const border_id& id)
+    inline std::string border_id_str (const border_id& id)
     {
         std::string rtn("unknown");
         if (id == border_id::top) {
@@ -91,6 +92,69 @@ namespace mplot {
             _p1_id = tmp_id;
         }
 
+        //! Set the time t. With shader_bands, this changes one uniform; otherwise the bands are rebuilt.
+        void setTime (const unsigned long long int _t)
+        {
+            this->t = _t;
+            if (this->shader_bands) {
+                this->set_band_offset();
+                this->scene_changed();
+            } else {
+                this->reinit();
+            }
+        }
+
+        //! The unit vector perpendicular to the fronts
+        sm::vec<float, 2> front_normal() const
+        {
+            sm::vec<float, 2> u_alpha = { 1.0f, 0.0f };
+            u_alpha.set_angle (sm::mathconst<float>::deg2rad * this->alpha);
+            return u_alpha;
+        }
+
+        /*
+         * Draw the grating as one rectangle in colour_by_datum_texture mode. The datum texture
+         * holds two texels, 0 and 1, which the colour lookup maps to colour1 and colour2, and it
+         * repeats. Each corner's texture coordinate is its distance along the front normal in
+         * wavelengths, so each texel covers one band. Moving the fronts by v_front * t moves the
+         * texture coordinates by the same distance, and that is datum_texture_offset.
+         */
+        void initializeBandQuad()
+        {
+            const sm::vec<float, 2> u_alpha = this->front_normal();
+            const std::array<sm::vec<float, 2>, 4> corners = {
+                sm::vec<float, 2>{ this->mv_offset[0],                 this->mv_offset[1]                 },
+                sm::vec<float, 2>{ this->mv_offset[0] + this->dims[0], this->mv_offset[1]                 },
+                sm::vec<float, 2>{ this->mv_offset[0],                 this->mv_offset[1] + this->dims[1] },
+                sm::vec<float, 2>{ this->mv_offset[0] + this->dims[0], this->mv_offset[1] + this->dims[1] }
+            };
+            for (const sm::vec<float, 2>& c : corners) {
+                this->vertex_push (c.plus_one_dim(), this->vertexPositions);
+                this->vertex_push (std::array<float, 3>{ c.dot (u_alpha) / this->lambda, 0.5f, 0.0f }, this->vertexColors);
+                this->vertex_push (this->uz, this->vertexNormals);
+            }
+            this->indices.insert (this->indices.end(), { this->idx, this->idx + 1, this->idx + 2, this->idx + 2, this->idx + 1, this->idx + 3 });
+            this->idx += 4;
+
+            this->colour_by_datum_texture = true;
+            this->datum_texture = { 0.0f, 1.0f };
+            this->datum_texture_dims = { 2u, 1u };
+            this->datum_texture_repeat = true;
+            this->reinit_datum_texture();
+            this->set_colour_lut ({ this->colour1[0], this->colour1[1], this->colour1[2],
+                                    this->colour2[0], this->colour2[1], this->colour2[2] });
+            this->set_band_offset();
+        }
+
+        //! Set datum_texture_offset for the time t (in wavelengths, reduced to [0,1) in double
+        //! precision so that long runs don't lose the phase)
+        void set_band_offset()
+        {
+            const double s = static_cast<double>(this->v_front.dot (this->front_normal())) * static_cast<double>(this->t)
+                             / static_cast<double>(this->lambda);
+            this->datum_texture_offset = { -static_cast<float>(s - std::floor (s)), 0.0f };
+        }
+
         void initializeVertices()
         {
             this->vertexPositions.clear();
@@ -98,6 +162,11 @@ namespace mplot {
             this->vertexColors.clear();
             this->indices.clear();
 
+            if (this->shader_bands) {
+                this->initializeBandQuad();
+                return;
+            }
+
             // The velocity offset for each location of each front
             sm::vec<float, 2> v_offset = this->v_front * this->t;
 
@@ -721,6 +790,14 @@ namespace mplot {
         //! Current time
         unsigned long long int t = 0;
         bool do_loop2 = true;
+        /*!
+         * If true, the grating is one rectangle whose bands are found for each fragment, from
+         * alpha, lambda, v_front, t and the two colours, rather than a set of band polygons
+         * built on the CPU. setTime() then moves the grating by changing one uniform, with no
+         * rebuild and no upload, so the grating keeps time with the display at any frame rate.
+         * Set before finalize(). Changing alpha, lambda, dims or the colours still needs reinit().
+         */
+        bool shader_bands = false;
         //! Draw in colours that are helpful for debugging?
         static constexpr bool debug_geometry = false;
         static constexpr bool debug_text = false;
@@ -3,7 +3,10 @@
 #include <iostream>
 #include <vector>
 #include <array>
-#include <unordered_map>
+#include <algorithm>
+#include <memory>
+#include <cmath>
+#include <limits>
 
 #include <sm/grid>
 #include <sm/vec>
@@ -11,20 +14,24 @@
 
 #include <mplot/ColourMap.h>
 #include <mplot/VisualDataModel.h>
+#include <mplot/lod.h>
+#include <mplot/pixel_selection.h>
 
 namespace mplot {
 
     /*!
      * How to visualize a grid. You could draw a triangle map with vertices at the centres of the
      * elements or you could draw a rectangular pixel for each element. Triangles is
-     * faster. RectInterp gives a nice pixellated rendering.
+     * faster. RectInterp gives a nice pixellated rendering. Texture is fastest of all for large,
+     * flat, image-like grids.
      */
     enum class GridVisMode
     {
         Triangles,  // Render triangles with a triangle vertex at the centre of each Rect.
         RectInterp, // Render each rect as an actual rectangle made of 4 triangles, interpolating heights with neighbours
         Pixels,     // Render each rect as a rectangular pixel, with all z values the same
-        Columns     // Render each rect as a rectangular column, with sides
+        Columns,    // Render each rect as a rectangular column, with sides
+        Texture     // Render one flat rectangle, colour mapping a texture of the data in the shader
     };
 
     /*!
@@ -45,6 +52,8 @@ namespace mplot {
         showselectedpixborder_enclosing,
         selected_pix_thickness_fixed,
         interpolate_colour_sides,
+        grid_in_shader,
+        grid_thickness_pixels,
     };
 
     /*!
@@ -74,6 +83,7 @@ namespace mplot {
             this->colourScale2.do_autoscale = true;
             this->colourScale3.do_autoscale = true;
             this->grid = _grid;
+            this->base_grid = _grid;
             // Note: VisualModel::finalize() should be called before rendering
         }
 
@@ -85,7 +95,31 @@ namespace mplot {
                 throw std::runtime_error ("grid is nullptr in reinitColours()");
             }
 
-            std::size_t n_data = static_cast<std::size_t>(this->grid->n());
+            if (this->gridVisMode == GridVisMode::Texture) {
+                this->reinitColoursTexture();
+                return;
+            }
+
+            if (this->instanced) {
+                // Only the instances are rewritten and uploaded
+                this->reinit();
+                return;
+            }
+
+            // Vertices freed after upload (see setGpuResident) are rebuilt along with their colours
+            if (this->host_vertices_released()) {
+                this->reinit();
+                return;
+            }
+
+            if (this->lod_enabled) {
+                // A coarser level is autoscaled from the full data, in lod_take
+                if (this->lod_shown > 0 && this->colourScale.do_autoscale == true) { this->colourScale.reset(); }
+                this->lod_take (true);
+            }
+
+            // The kept elements, if there is a mask
+            std::size_t n_data = this->mask.count (static_cast<std::size_t>(this->grid->n()));
             std::size_t n_cvertices_per_datum = 0;
             // Different gridVisModes will have generated different numbers of OpenGL colour vertices
             switch (this->gridVisMode) {
@@ -107,7 +141,11 @@ namespace mplot {
                 break;
             }
             }
-            if (this->vertexColors.size() < n_data * n_cvertices_per_datum * 3) {
+            if (this->colour_by_datum || this->colour_by_element) {
+                if (this->vertexDatums.size() < n_data * n_cvertices_per_datum) {
+                    throw std::runtime_error ("vertexDatums is not big enough to reinitColours()");
+                }
+            } else if (this->vertexColors.size() < n_data * n_cvertices_per_datum * 3) {
                 throw std::runtime_error ("vertexColors is not big enough to reinitColours()");
             }
 
@@ -121,6 +159,222 @@ namespace mplot {
             }
         }
 
+        /*!
+         * Called by updateData() and updateCoords(). When the vertices were made in
+         * GridVisMode::Triangles, Pixels or RectInterp, the z positions, normals and colours are
+         * rewritten where they are and uploaded with BufferSubData; the indices, and any borders
+         * or grid lines (which do not depend on the data), are kept. Texture mode updates only the
+         * datum texture and Columns mode is rebuilt with reinit().
+         */
+        void reinit_data() override
+        {
+            if (this->grid == nullptr) {
+                throw std::runtime_error ("grid is nullptr in reinit_data()");
+            }
+            if (this->gridVisMode == GridVisMode::Texture) {
+                this->reinitColoursTexture();
+                return;
+            }
+            if (this->lod_enabled) { this->lod_take (true); }
+            // With a mask, vertex block k is that of element mask.element (k)
+            const std::size_t n_data = this->mask.count (static_cast<std::size_t>(this->grid->n()));
+            const std::size_t vpe = this->gridVisMode == GridVisMode::Triangles ? 1u : 5u;
+            if (this->gridVisMode == GridVisMode::Columns || this->indices.empty()
+                || this->vertexPositions.size() < 3u * vpe * n_data) {
+                this->reinit();
+                return;
+            }
+            if (this->setContext != nullptr) { this->setContext (this->parentVis); }
+            this->determine_datasize();
+            this->setupScaling();
+
+            for (std::size_t k = 0; k < n_data; ++k) {
+                const std::size_t ri = this->mask.element (k);
+                float* vp = this->vertexPositions.data() + 3u * vpe * k;
+                if (this->gridVisMode == GridVisMode::Triangles) {
+                    vp[2] = this->dcopy[ri];
+                    continue;
+                }
+                sm::vec<float, 5> z;
+                if (this->gridVisMode == GridVisMode::Pixels) {
+                    z.set_from (this->dcopy[ri]);
+                } else {
+                    z = this->rect_interp_z (static_cast<I>(ri));
+                }
+                for (std::size_t j = 0; j < 5u; ++j) { vp[3u * j + 2u] = z[j]; }
+                // The normal, from vertices 0, 1 and 2 as in initializeVerticesRectsInterpolated
+                sm::vec<float> vtx_0 = { vp[0], vp[1], vp[2] };
+                sm::vec<float> plane1 = sm::vec<float>{ vp[3], vp[4], vp[5] } - vtx_0;
+                sm::vec<float> plane2 = sm::vec<float>{ vp[6], vp[7], vp[8] } - vtx_0;
+                sm::vec<float> vnorm = plane2.cross (plane1);
+                vnorm.renormalize();
+                float* vn = this->vertexNormals.data() + 3u * vpe * k;
+                for (std::size_t j = 0; j < 5u; ++j) {
+                    vn[3u * j] = vnorm[0];
+                    vn[3u * j + 1u] = vnorm[1];
+                    vn[3u * j + 2u] = vnorm[2];
+                }
+            }
+
+            // The colours, from the dcolour computed by setupScaling
+            if (this->colour_by_element) {
+                this->set_element_datums (this->dcolour);
+            } else if (this->colour_by_datum) {
+                for (std::size_t i = 0u; i < n_data; ++i) {
+                    std::fill_n (this->vertexDatums.begin() + i * vpe, vpe, this->dcolour[this->mask.element (i)]);
+                }
+            } else if (this->scalarData != nullptr) {
+                this->convert_kept (vpe);
+            } else {
+                for (std::size_t i = 0u; i < n_data; ++i) {
+                    std::array<float, 3> c = this->setColour (this->mask.element (i));
+                    for (std::size_t j = 0; j < vpe; ++j) {
+                        std::copy (c.begin(), c.end(), this->vertexColors.begin() + 3u * (i * vpe + j));
+                    }
+                }
+            }
+
+            this->mark_dirty (0, vpe * n_data);
+            this->reinit_buffers();
+        }
+
+        /*!
+         * In GridVisMode::Texture, colour the grid from tex, a single channel (or first channel)
+         * float texture of the grid's dims, written by the client on the GPU (the latest state of
+         * an mplot::gl::texture_pingpong, say), rather than from scalarData. The texels are
+         * colour scaled in the shader with colourScale, which must be linear. The first build
+         * still needs scalarData, from which an autoscaled colourScale is found. The grid must be
+         * row major. After each write to tex (and its memory barrier), pass the texture again if
+         * it has changed and call requestRedraw(); no data pass through the CPU. Pass 0 to go back
+         * to scalarData.
+         */
+        void setDataTexture (const GLuint tex)
+        {
+            if (this->gridVisMode != GridVisMode::Texture) {
+                throw std::runtime_error ("GridVisual::setDataTexture: gridVisMode must be GridVisMode::Texture");
+            }
+            if (tex != 0 && (this->grid->get_order() == sm::gridorder::bottomleft_to_topright_colmaj
+                             || this->grid->get_order() == sm::gridorder::topleft_to_bottomright_colmaj)) {
+                throw std::runtime_error ("GridVisual::setDataTexture: the grid must be row major");
+            }
+            const bool was_external = this->external_datum_texture != 0;
+            this->setDatumTexture (tex);
+            this->set_data_texture_scale();
+            // Going back to scalarData, refill datum_texture
+            if (was_external && tex == 0 && !this->indices.empty()) { this->reinitColoursTexture(); }
+        }
+
+        /*!
+         * Recolour only the w by h block of elements from column x0, row y0 (counted in the
+         * grid's own order, so that a row major element is at index y * width + x), after
+         * changing just those elements of scalarData. The elements are colour scaled with the
+         * colourScale of the last full update (there is no autoscaling), and only their vertex
+         * colour spans (or texture rows, in Texture mode or colour_by_element) are uploaded. The
+         * z positions are not changed; use updateData() when the data also set the heights.
+         * Columns mode and vector data fall back to reinitColours().
+         */
+        void updateRegion (const I x0, const I y0, const I w, const I h)
+        {
+            if (this->indices.empty() || w <= I{0} || h <= I{0}) { return; }
+            const auto dims = this->base_grid->get_dims();
+            const I width = static_cast<I>(dims[0]);
+            const I height = static_cast<I>(dims[1]);
+            if (x0 < I{0} || y0 < I{0} || x0 + w > width || y0 + h > height) {
+                throw std::runtime_error ("GridVisual::updateRegion: the region is not within the grid");
+            }
+            std::vector<std::array<std::size_t, 2>> runs;
+            if (this->base_grid->get_order() == sm::gridorder::bottomleft_to_topright_colmaj
+                || this->base_grid->get_order() == sm::gridorder::topleft_to_bottomright_colmaj) {
+                // A run per column
+                for (I x = x0; x < x0 + w; ++x) {
+                    const std::size_t i0 = static_cast<std::size_t>(x * height + y0);
+                    runs.push_back ({ i0, i0 + static_cast<std::size_t>(h) });
+                }
+            } else {
+                // A run per row
+                for (I y = y0; y < y0 + h; ++y) {
+                    const std::size_t i0 = static_cast<std::size_t>(y * width + x0);
+                    runs.push_back ({ i0, i0 + static_cast<std::size_t>(w) });
+                }
+            }
+            this->update_runs (runs);
+        }
+
+        //! Recolour only the elements with the given indices, as for updateRegion. Consecutive
+        //! indices are uploaded together, so sort the list if its order doesn't matter.
+        void updateElements (const std::vector<I>& elements)
+        {
+            if (this->indices.empty() || elements.empty()) { return; }
+            const I n = this->base_grid->n();
+            for (const I e : elements) {
+                if (e < I{0} || e >= n) { throw std::runtime_error ("GridVisual::updateElements: element out of range"); }
+            }
+            this->update_runs (this->element_runs (elements));
+        }
+
+        /*!
+         * Draw only the elements i for which keep[i] is true (one flag for each element of the
+         * grid). A masked element emits no vertices or indices, and is skipped by reinitColours,
+         * updateData, updateRegion and updateElements. For GridVisMode::Triangles (in which only
+         * the triangles of three kept elements are drawn), RectInterp (in which masked
+         * neighbours are treated as the edge of the grid) and Pixels, without levels of detail.
+         * Set before finalize(), or call reinit() after.
+         */
+        void setMask (const std::vector<bool>& keep) { this->mask = mplot::element_mask (keep); }
+
+        //! Mask out the elements whose scalarData are NaN now (the mask does not follow later data)
+        void setMaskFromNaN()
+        {
+            if (this->scalarData == nullptr) { throw std::runtime_error ("GridVisual::setMaskFromNaN: no scalar data"); }
+            this->mask = mplot::element_mask::from_nan (*this->scalarData);
+        }
+
+        //! Draw only the elements whose centres lie inside the closed polygon boundary (in the grid's coordinates)
+        void setMaskFromBoundary (const std::vector<sm::vec<float, 2>>& boundary)
+        {
+            auto centre_of = [this](const std::size_t i) {
+                return sm::vec<float, 2>{ static_cast<float>((*this->base_grid)[i][0]), static_cast<float>((*this->base_grid)[i][1]) };
+            };
+            this->mask = mplot::element_mask::from_boundary (static_cast<std::size_t>(this->base_grid->n()), centre_of, boundary);
+        }
+
+        //! Draw every element again
+        void clearMask() { this->mask = mplot::element_mask(); }
+
+        /*!
+         * Hold up to n_levels coarser versions of the grid (each element of level L aggregates
+         * a 2^L by 2^L block of the grid's elements, see lod_aggregation) and, as each frame is
+         * drawn, show the coarsest level whose elements are no more than lod_pixel_size pixels
+         * across on the screen. Only the level shown is in the vertex buffers, so the vertex
+         * count and the cost of an update follow the size of the grid on the screen, rather
+         * than the size of the grid. A level's data are aggregated when it is first shown after
+         * a change of the data. A change of level rebuilds the model. For GridVisMode::Triangles,
+         * Pixels and RectInterp, with scalar data. Set before finalize(). 0 turns this off.
+         */
+        void set_lod_levels (const int n_levels)
+        {
+            int n = n_levels > 0 ? n_levels : 0;
+            // Keep at least two elements across the coarsest level
+            const auto dims = this->base_grid->get_dims();
+            while (n > 0 && ((static_cast<std::size_t>(dims[0]) >> n) < 2u || (static_cast<std::size_t>(dims[1]) >> n) < 2u)) { --n; }
+            this->lod_levels = n;
+            this->lod_enabled = n > 0;
+            this->lod_shown = 0;
+            this->lod_grids.clear();
+            this->lod_grids.resize (static_cast<std::size_t>(n));
+            this->lod_data.clear();
+            this->lod_data.resize (static_cast<std::size_t>(n));
+            this->lod_fresh.assign (static_cast<std::size_t>(n), false);
+        }
+        int get_lod_levels() const { return this->lod_levels; }
+        //! The level of detail now shown (0 is the full grid)
+        int get_lod_shown() const { return this->lod_shown; }
+
+        //! How the data of a block of elements are combined into an element of a coarser level
+        lod::aggregation lod_aggregation = lod::aggregation::mean;
+        //! The largest on-screen size (in pixels) of an element of the level shown
+        float lod_pixel_size = 1.0f;
+
     public:
         // function that draws a border around the whole image
         void drawBorder()
@@ -260,6 +514,53 @@ namespace mplot {
             this->computeOpenTube (rb, lb,  -(rtrb + rblb), (rblb + lblt),  clr, clr, rad, 20);
         }
 
+        /*
+         * The selected pixel borders are GPU polylines (see VisualModelBase::add_polyline), added
+         * after any other polylines that initializeVertices() makes. They are an overlay on the
+         * pixels, which are drawn the same whether or not they are selected, so updateSelection()
+         * can replace them without touching the vertices of the grid.
+         */
+
+        //! The thickness of the selected pixel borders in x and y
+        sm::vec<float, 2> selected_pix_th() const
+        {
+            sm::vec<float, 2> selth = this->grid->get_dx() * this->selected_pix_thickness;
+            if (this->options.test (gridvisual_flags::selected_pix_thickness_fixed)) {
+                selth.set_from (this->selected_pix_thickness);
+            }
+            return selth;
+        }
+
+        //! Add a closed, rectangular polyline of width w just inside r_extents (xmin, xmax, ymin, ymax)
+        void selectionRect (const sm::vec<float, 4>& r_extents, const float bz, const sm::vec<float, 2> linethickness,
+                            const std::array<float, 3>& clr)
+        {
+            // The line is centred half its thickness in from the edges. The first side is drawn
+            // twice, so that the corner at which the line is closed is mitred like the others.
+            const float l = r_extents[0] + 0.5f * linethickness[0];
+            const float r = r_extents[1] - 0.5f * linethickness[0];
+            const float b = r_extents[2] + 0.5f * linethickness[1];
+            const float t = r_extents[3] - 0.5f * linethickness[1];
+            const std::array<sm::vec<float>, 6> pts = {
+                sm::vec<float>{ l, b, bz }, sm::vec<float>{ l, t, bz }, sm::vec<float>{ r, t, bz },
+                sm::vec<float>{ r, b, bz }, sm::vec<float>{ l, b, bz }, sm::vec<float>{ l, t, bz }
+            };
+            this->add_polyline (pts, clr, std::min (linethickness[0], linethickness[1]), this->uz);
+        }
+
+        //! Draw the selected pixel borders, as polylines after any others
+        void drawSelection()
+        {
+            this->selection_polylines_first = this->get_polylines().size();
+            if (this->options.test (gridvisual_flags::showselectedpixborder) == true) {
+                this->drawSelectedPixBorder();
+            }
+            if (this->options.test (gridvisual_flags::showselectedpixborder_enclosing) == true) {
+                this->drawSelectedPixBorderEnclosing();
+            }
+            this->selection_polylines_count = this->get_polylines().size() - this->selection_polylines_first;
+        }
+
         //! function to draw the border around selected pixels
         void drawSelectedPixBorder()
         {
@@ -273,11 +574,8 @@ namespace mplot {
             // The grid width in pixels
             I gw = this->grid->get_w();
 
-            // Thickness of spacing for selected pixels
-            sm::vec<float, 2> selth = dx * this->selected_pix_thickness;
-            if (this->options.test (gridvisual_flags::selected_pix_thickness_fixed)) {
-                selth.set_from (this->selected_pix_thickness);
-            }
+            // Thickness of the border for selected pixels
+            const sm::vec<float, 2> selth = this->selected_pix_th();
 
             float grid_left  = cg_extents[0] - (dx[0]/2.0f) + this->centering_offset[0];
             float grid_bot   = cg_extents[2] - (dx[1]/2.0f) + this->centering_offset[1];
@@ -295,16 +593,16 @@ namespace mplot {
                     (grid_bot  + c     * dx[1] + gridline_ht[1]),
                     (grid_bot  + (c+1) * dx[1] - gridline_ht[1])
                 };
-                this->rectangularInnerBorder (r_extents, this->grid_z_offset, selth, sp.second);
+                this->selectionRect (r_extents, this->grid_z_offset, selth, sp.second);
             }
         }
 
-        //! Draw a border around the selected pixels, using the first selected pix colour
+        //! Draw a border around the selected pixels, using enclosing_border_colour
         void drawSelectedPixBorderEnclosing()
         {
             if (this->selected_pix.empty()) { return; }
 
-            // Draw around all pixels using a tubular frame
+            // Draw around all pixels
             sm::vec<float, 4> cg_extents = this->grid->extents(); // {xmin, xmax, ymin, ymax}
 
             // Take into account any inter-pixel gridlines
@@ -313,12 +611,9 @@ namespace mplot {
             // The grid width in pixels
             I gw = this->grid->get_w();
 
-            // Thickness of spacing for selected pixels
+            // Thickness of the border for selected pixels
             sm::vec<float, 2> dx = this->grid->get_dx();
-            sm::vec<float, 2> selth = dx * this->selected_pix_thickness;
-            if (this->options.test (gridvisual_flags::selected_pix_thickness_fixed)) {
-                selth.set_from (this->selected_pix_thickness);
-            }
+            const sm::vec<float, 2> selth = this->selected_pix_th();
             float grid_left  = cg_extents[0] - (dx[0]/2.0f) + this->centering_offset[0];
             float grid_bot   = cg_extents[2] - (dx[1]/2.0f) + this->centering_offset[1];
 
@@ -349,7 +644,7 @@ namespace mplot {
 
             // xmin xmax ymin ymax
             sm::vec<float, 4> r_extents = { l_r.min, r_r.max, b_r.min, t_r.max };
-            this->tubularBorder (r_extents, this->grid_z_offset, selth[0], this->enclosing_border_colour);
+            this->selectionRect (r_extents, this->grid_z_offset, selth, this->enclosing_border_colour);
         }
 
         // Common function to setup scaling. Called by all initializeVertices subroutines. Also
@@ -379,12 +674,72 @@ namespace mplot {
         //! Do the computations to initialize the vertices that will represent the Grid.
         void initializeVertices()
         {
+            if (this->lod_enabled) {
+                if (this->gridVisMode == GridVisMode::Texture || this->gridVisMode == GridVisMode::Columns
+                    || this->vectorData != nullptr
+                    || this->options.test (gridvisual_flags::showgrid) == true
+                    || this->options.test (gridvisual_flags::showselectedpixborder) == true
+                    || this->options.test (gridvisual_flags::showselectedpixborder_enclosing) == true) {
+                    throw std::runtime_error ("GridVisual: levels of detail need scalar data, gridVisMode Triangles, Pixels or RectInterp and no grid or selected pixel borders");
+                }
+                // A change of level (from update_lod) keeps the aggregates of unchanged data
+                this->lod_take (!this->lod_switching);
+            }
+
+            if (!this->mask.empty()) {
+                if (this->mask.size() != static_cast<std::size_t>(this->grid->n())) {
+                    throw std::runtime_error ("GridVisual: the mask is not of the size of the grid");
+                }
+                if ((this->gridVisMode != GridVisMode::Triangles && this->gridVisMode != GridVisMode::RectInterp
+                     && this->gridVisMode != GridVisMode::Pixels) || this->lod_enabled) {
+                    throw std::runtime_error ("GridVisual: a mask needs gridVisMode Triangles, RectInterp or Pixels and no levels of detail");
+                }
+            }
+
             this->determine_datasize();
             if (this->datasize == 0) { return; }
 
             // Optionally compute an offset to ensure that the cartgrid is centred about the mv_offset.
+            // The offset is that of the full grid, so that the levels of detail line up.
             if (this->options.test(gridvisual_flags::centralize) == true) {
-                this->centering_offset = -this->grid->centre().plus_one_dim();
+                this->centering_offset = -this->base_grid->centre().plus_one_dim();
+            }
+
+            this->colour_by_datum_texture = (this->gridVisMode == GridVisMode::Texture);
+            if (this->instanced) {
+                // Every part of an instanced model is drawn once per instance
+                if (this->gridVisMode != GridVisMode::Columns
+                    || this->options.test (gridvisual_flags::showborder) == true
+                    || this->options.test (gridvisual_flags::showgrid) == true
+                    || this->options.test (gridvisual_flags::showselectedpixborder) == true
+                    || this->options.test (gridvisual_flags::showselectedpixborder_enclosing) == true
+                    || this->options.test (gridvisual_flags::showorigin) == true) {
+                    throw std::runtime_error ("GridVisual: instanced needs gridVisMode == Columns and no borders/grid/origin");
+                }
+            }
+            const bool shader_grid = this->options.test (gridvisual_flags::grid_in_shader) == true;
+            if (shader_grid && (this->gridVisMode != GridVisMode::Texture
+                                || (this->options.test (gridvisual_flags::showborder) == true
+                                    && this->options.test (gridvisual_flags::border_tubular) == true))) {
+                throw std::runtime_error ("GridVisual: grid_in_shader needs gridVisMode == Texture and a flat border (border_tubular (false))");
+            }
+            if (this->datum_colour_mode() != 0) {
+                // Every vertex of a colour_by_datum (or colour_by_element) model is coloured through
+                // the lookup table, so there can be no separately coloured borders, grids or
+                // columns. In Texture mode, draw these with a second GridVisual of the same grid,
+                // or have the fragment shader draw the grid and a flat border (grid_in_shader).
+                if (this->gridVisMode == GridVisMode::Columns || this->vectorData != nullptr
+                    || (this->options.test (gridvisual_flags::showborder) == true && !shader_grid)
+                    || (this->options.test (gridvisual_flags::showgrid) == true && !shader_grid)
+                    || this->options.test (gridvisual_flags::showselectedpixborder) == true
+                    || this->options.test (gridvisual_flags::showselectedpixborder_enclosing) == true
+                    || this->options.test (gridvisual_flags::showorigin) == true) {
+                    throw std::runtime_error ("GridVisual: colour_by_datum, colour_by_element and gridVisMode == Texture need scalar data, no borders/grid/origin, and gridVisMode != Columns");
+                }
+                if (int{this->colour_by_datum} + int{this->colour_by_datum_texture} + int{this->colour_by_element} > 1) {
+                    throw std::runtime_error ("GridVisual: choose one of colour_by_datum, colour_by_element and gridVisMode == Texture");
+                }
+                if (this->colour_lut.empty()) { this->bake_colour_lut(); }
             }
 
             switch (this->gridVisMode) {
@@ -403,7 +758,11 @@ namespace mplot {
                     || this->options.test (gridvisual_flags::implygrid) == true) {
                     throw std::runtime_error ("GridVisual: Can't (currently) draw an inter-pixel grid in gridVisMode == Columns");
                 }
-                this->initializeVerticesCols();
+                if (this->instanced) {
+                    this->initializeVerticesColsInstanced();
+                } else {
+                    this->initializeVerticesCols();
+                }
                 break;
             }
             case GridVisMode::Pixels:
@@ -411,6 +770,11 @@ namespace mplot {
                 this->initializeVerticesPixels();
                 break;
             }
+            case GridVisMode::Texture:
+            {
+                this->initializeVerticesTexture();
+                break;
+            }
             case GridVisMode::RectInterp:
             default:
             {
@@ -419,23 +783,22 @@ namespace mplot {
             }
             }
 
+            // In colour_by_element mode, the vertices hold element indices and the data go into the texture
+            if (this->colour_by_element) { this->set_element_datums (this->dcolour); }
+
             // Note: For reinitColours to work, it's important to do all border/grid drawing AFTER
             // the initializeVerticesTris/Cols/Pixels etc
-            if (this->options.test (gridvisual_flags::showborder) == true) {
+            // With grid_in_shader, the fragment shader draws these (see set_cell_grid)
+            if (this->options.test (gridvisual_flags::showborder) == true && !shader_grid) {
                 this->drawBorder();
             }
-            if (this->options.test (gridvisual_flags::showgrid) == true) {
+            if (this->options.test (gridvisual_flags::showgrid) == true && !shader_grid) {
                 this->drawGrid();
             }
-            if (this->options.test (gridvisual_flags::showselectedpixborder) == true) {
-                this->drawSelectedPixBorder();
-            }
-            if (this->options.test (gridvisual_flags::showselectedpixborder_enclosing) == true) {
-                this->drawSelectedPixBorderEnclosing();
-            }
             if (this->options.test (gridvisual_flags::showorigin) == true) {
                 this->computeSphere (sm::vec<float>{0, 0, 0}, mplot::colour::crimson, 0.25f * this->grid->get_dx()[0]);
             }
+            this->drawSelection();
         }
 
         //! Initialize as a minimal, triangled surface
@@ -445,31 +808,26 @@ namespace mplot {
             this->setupScaling();
 
             I vpsz = static_cast<I>(this->vertexPositions.size());
-            I vcsz = static_cast<I>(this->vertexColors.size());
             I vnsz = static_cast<I>(this->vertexNormals.size());
-            // How many additional vertices?
-            I add_v = this->grid->n() * I{3};
+            // How many additional vertices? One for each kept element.
+            const I n_kept = static_cast<I>(this->mask.count (static_cast<std::size_t>(this->grid->n())));
+            I add_v = n_kept * I{3};
 
-            // Additional space in vertexPositions/Colors/Normals
+            // Additional space in vertexPositions/Normals (the colours are pushed)
             this->vertexPositions.resize (vpsz + add_v);
-            this->vertexColors.resize (vcsz + add_v);
             this->vertexNormals.resize (vnsz + add_v);
 
             I vidx = 0;
-            for (I ri = 0; ri < this->grid->n(); ++ri) {
-                std::array<float, 3> clr = this->setColour (ri);
-
-                vidx = vpsz + ri * 3;
+            for (I k = 0; k < n_kept; ++k) {
+                const I ri = static_cast<I>(this->mask.element (k));
+                vidx = vpsz + k * 3;
                 this->vertexPositions[vidx++] = (*this->grid)[ri][0] + centering_offset[0];
                 this->vertexPositions[vidx++] = (*this->grid)[ri][1] + centering_offset[1];
                 this->vertexPositions[vidx++] = this->dcopy[ri];
 
-                vidx = vcsz + ri * 3;
-                this->vertexColors[vidx++] = clr[0];
-                this->vertexColors[vidx++] = clr[1];
-                this->vertexColors[vidx++] = clr[2];
+                this->push_colour (ri, 1);
 
-                vidx = vnsz + ri * 3;
+                vidx = vnsz + k * 3;
                 this->vertexNormals[vidx++] = 0.0f;
                 this->vertexNormals[vidx++] = 0.0f;
                 this->vertexNormals[vidx++] = 1.0f;
@@ -552,7 +910,39 @@ namespace mplot {
                 throw std::runtime_error ("mplot::GridVisual: Unhandled sm::gridorder");
             }
 
-            this->idx += this->grid->n();
+            if (!this->mask.empty()) { this->mask_triangles (sz_start); }
+
+            this->idx += n_kept;
+        }
+
+        /*!
+         * Keep, of the triangles from index i0 (whose indices are element indices), those whose
+         * three elements are all kept by the mask, renumbered to the elements' vertex blocks.
+         */
+        void mask_triangles (const std::size_t i0)
+        {
+            std::size_t o = i0;
+            for (std::size_t t = i0; t + 2u < this->indices.size(); t += 3u) {
+                const std::uint32_t a = this->mask.slot (this->indices[t]);
+                const std::uint32_t b = this->mask.slot (this->indices[t + 1u]);
+                const std::uint32_t c = this->mask.slot (this->indices[t + 2u]);
+                if (a == mplot::element_mask::none || b == mplot::element_mask::none || c == mplot::element_mask::none) { continue; }
+                this->indices[o++] = a;
+                this->indices[o++] = b;
+                this->indices[o++] = c;
+            }
+            this->indices.resize (o);
+        }
+
+        //! Colour the n vertices of each element's block from dcolour (only the kept elements', if there is a mask)
+        void convert_kept (const std::size_t n)
+        {
+            if (this->mask.empty()) {
+                this->cm.convert (this->dcolour, this->vertexColors, n);
+            } else {
+                this->mask.gather (this->dcolour, this->dcolour_kept);
+                this->cm.convert (this->dcolour_kept, this->vertexColors, n);
+            }
         }
 
         //! Initialize as a rectangle made of 4 triangles for each rect, with z position
@@ -569,116 +959,36 @@ namespace mplot {
             this->idx = 0;
             this->setupScaling();
 
-            float datumC = 0.0f;   // datum at the centre
-            float datumNE = 0.0f;  // datum at the hex to the east.
-            float datumNNE = 0.0f;
-            float datumNN = 0.0f;
-            float datumNNW = 0.0f;
-            float datumNW = 0.0f;
-            float datumNSW = 0.0f;
-            float datumNS = 0.0f;
-            float datumNSE = 0.0f;
-
-            float datum = 0.0f;
+            // Each rect has 5 vertices and 12 indices at fixed offsets, so the rects are written in
+            // parallel. With a mask, only the kept rects are written, rect e being mask.element (e).
+            const std::size_t n = this->mask.count (static_cast<std::size_t>(this->grid->n()));
+            const std::size_t v0 = this->grow_element_buffers (n, 5u, 12u);
+            const std::size_t i0 = this->indices.size() - 12u * n;
+            const GLuint idx0 = this->idx;
 
-            sm::vec<float> vtx_0, vtx_1, vtx_2;
-
-            // Thickness of spacing for selected pixels
-            const float selth_x = this->options.test (gridvisual_flags::selected_pix_thickness_fixed) ? this->selected_pix_thickness : dx[0] * this->selected_pix_thickness;
-            const float selth_y = this->options.test (gridvisual_flags::selected_pix_thickness_fixed) ? this->selected_pix_thickness : dx[1] * this->selected_pix_thickness;
-            float sx = 0.0f;
-            float sy = 0.0f;
-
-            for (I ri = 0; ri < this->grid->n(); ++ri) {
-
-                if (this->options.test (gridvisual_flags::showselectedpixborder) == true) {
-                    if (this->selected_pix.contains(ri)) {
-                        sx = selth_x;
-                        sy = selth_y;
-                    } else { // ri is not in selected_pix
-                        sx = 0.0f;
-                        sy = 0.0f;
-                    }
-                } // else sx = sy = 0
-
-                // Use the linear scaled copy of the data, dcopy.
-                datumC  = this->dcopy[ri];
-                datumNE =  this->grid->has_ne(ri)  ? this->dcopy[this->grid->index_ne(ri)] : datumC;
-                datumNN =  this->grid->has_nn(ri)  ? this->dcopy[this->grid->index_nn(ri)] : datumC;
-                datumNW =  this->grid->has_nw(ri)  ? this->dcopy[this->grid->index_nw(ri)] : datumC;
-                datumNS =  this->grid->has_ns(ri)  ? this->dcopy[this->grid->index_ns(ri)] : datumC;
-                datumNNE = this->grid->has_nne(ri) ? this->dcopy[this->grid->index_nne(ri)] : datumC;
-                datumNNW = this->grid->has_nnw(ri) ? this->dcopy[this->grid->index_nnw(ri)] : datumC;
-                datumNSW = this->grid->has_nsw(ri) ? this->dcopy[this->grid->index_nsw(ri)] : datumC;
-                datumNSE = this->grid->has_nse(ri) ? this->dcopy[this->grid->index_nse(ri)] : datumC;
-
-                // Use a single colour for each rect, even though rectangle's z positions are
-                // interpolated. Do the _colour_ scaling:
-                std::array<float, 3> clr = this->setColour (ri);
-
-                // First push the 5 positions of the triangle vertices, starting with the centre
-                // Use the centre position as the first location for finding the normal vector
-                vtx_0 = { (*this->grid)[ri][0] + centering_offset[0], (*this->grid)[ri][1] + centering_offset[1], datumC };
-                this->vertex_push (vtx_0, this->vertexPositions);
+            this->for_elements (n, [&](const std::size_t e) {
+                const I ri = static_cast<I>(this->mask.element (e));
 
+                // The z positions of the centre and the NE, SE, SW and NW corners
+                const sm::vec<float, 5> z = this->rect_interp_z (ri);
 
+                // The 5 positions of the triangle vertices, starting with the centre, which is
+                // the first location for finding the normal vector
+                const sm::vec<float> vtx_0 = { (*this->grid)[ri][0] + centering_offset[0], (*this->grid)[ri][1] + centering_offset[1], z[0] };
                 // NE vertex
-                // Compute mean of this->data[ri] and N, NE and E elements
-                if (this->grid->has_nn(ri) && this->grid->has_ne(ri) && this->grid->has_nne(ri)) {
-                    datum = 0.25f * (datumC + datumNN + datumNE + datumNNE);
-                } else if (this->grid->has_ne(ri)) {
-                    // Assume no NN and no NNE
-                    datum = 0.5f * (datumC + datumNE);
-                } else if (this->grid->has_nn(ri)) {
-                    // Assume no NE and no NNE
-                    datum = 0.5f * (datumC + datumNN);
-                } else {
-                    datum = datumC;
-                }
-                vtx_1 = { (*this->grid)[ri][0] + hx + centering_offset[0] - gridline_ht[0] - sx, (*this->grid)[ri][1] + vy + centering_offset[1] - gridline_ht[1] - sy, datum };
-                this->vertex_push (vtx_1, this->vertexPositions);
-
+                const sm::vec<float> vtx_1 = { (*this->grid)[ri][0] + hx + centering_offset[0] - gridline_ht[0], (*this->grid)[ri][1] + vy + centering_offset[1] - gridline_ht[1], z[1] };
                 // SE vertex
-                if (this->grid->has_ns(ri) && this->grid->has_ne(ri) && this->grid->has_nse(ri)) {
-                    datum = 0.25f * (datumC + datumNS + datumNE + datumNSE);
-                } else if (this->grid->has_ne(ri)) {
-                    // Assume no NS and no NSE
-                    datum = 0.5f * (datumC + datumNE);
-                } else if (this->grid->has_ns(ri)) {
-                    // Assume no NE and no NSE
-                    datum = 0.5f * (datumC + datumNS);
-                } else {
-                    datum = datumC;
-                }
-                vtx_2 = {{(*this->grid)[ri][0] + hx + centering_offset[0] - gridline_ht[0] - sx, (*this->grid)[ri][1] - vy + centering_offset[1] + gridline_ht[1] + sy, datum}};
-                this->vertex_push (vtx_2, this->vertexPositions);
-
-
+                const sm::vec<float> vtx_2 = { (*this->grid)[ri][0] + hx + centering_offset[0] - gridline_ht[0], (*this->grid)[ri][1] - vy + centering_offset[1] + gridline_ht[1], z[2] };
                 // SW vertex
-                if (this->grid->has_ns(ri) && this->grid->has_nw(ri) && this->grid->has_nsw(ri)) {
-                    datum = 0.25f * (datumC + datumNS + datumNW + datumNSW);
-                } else if (this->grid->has_nw(ri)) {
-                    datum = 0.5f * (datumC + datumNW);
-                } else if (this->grid->has_ns(ri)) {
-                    datum = 0.5f * (datumC + datumNS);
-                } else {
-                    datum = datumC;
-                }
-                // vtx_3
-                this->vertex_push ((*this->grid)[ri][0] - hx + centering_offset[0] + gridline_ht[0] + sx, (*this->grid)[ri][1] - vy + centering_offset[1] + gridline_ht[1] + sy, datum, this->vertexPositions);
-
+                const sm::vec<float> vtx_3 = { (*this->grid)[ri][0] - hx + centering_offset[0] + gridline_ht[0], (*this->grid)[ri][1] - vy + centering_offset[1] + gridline_ht[1], z[3] };
                 // NW vertex
-                if (this->grid->has_nn(ri) && this->grid->has_nw(ri) && this->grid->has_nnw(ri)) {
-                    datum = 0.25f * (datumC + datumNN + datumNW + datumNNW);
-                } else if (this->grid->has_nw(ri)) {
-                    datum = 0.5f * (datumC + datumNW);
-                } else if (this->grid->has_nn(ri)) {
-                    datum = 0.5f * (datumC + datumNN);
-                } else {
-                    datum = datumC;
+                const sm::vec<float> vtx_4 = { (*this->grid)[ri][0] - hx + centering_offset[0] + gridline_ht[0], (*this->grid)[ri][1] + vy + centering_offset[1] - gridline_ht[1], z[4] };
+                const std::size_t vi = v0 + 5u * e;
+                float* p = this->vertexPositions.data() + 3u * vi;
+                for (const sm::vec<float>* v : { &vtx_0, &vtx_1, &vtx_2, &vtx_3, &vtx_4 }) {
+                    std::copy (v->begin(), v->end(), p);
+                    p += 3;
                 }
-                // vtx_4
-                this->vertex_push ((*this->grid)[ri][0] - hx + centering_offset[0] + gridline_ht[0] + sx, (*this->grid)[ri][1] + vy + centering_offset[1] - gridline_ht[1] - sy, datum, this->vertexPositions);
 
                 // From vtx_0,1,2 compute normal. This sets the correct normal, but note that there
                 // is only one 'layer' of vertices; the back of the GridVisual will be coloured the
@@ -688,38 +998,94 @@ namespace mplot {
                 sm::vec<float> plane2 = vtx_2 - vtx_0;
                 sm::vec<float> vnorm = plane2.cross (plane1);
                 vnorm.renormalize();
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
+                float* nm = this->vertexNormals.data() + 3u * vi;
+                for (std::size_t j = 0; j < 5u; ++j) { std::copy (vnorm.begin(), vnorm.end(), nm + 3u * j); }
 
-                // Five vertices with the same colour
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
+                // Five vertices with the same colour. Use a single colour for each rect, even
+                // though rectangle's z positions are interpolated.
+                this->write_colour (ri, vi, 5u);
 
-                // Define indices now to produce the 4 triangles in the pixel
-                this->indices.push_back (this->idx+1);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+2);
+                // The 4 triangles in the pixel
+                const GLuint k = idx0 + static_cast<GLuint>(5u * e);
+                GLuint* ind = this->indices.data() + i0 + 12u * e;
+                const std::array<GLuint, 12> tri = { k + 1, k, k + 2,  k + 2, k, k + 3,  k + 3, k, k + 4,  k + 4, k, k + 1 };
+                std::copy (tri.begin(), tri.end(), ind);
+            });
 
-                this->indices.push_back (this->idx+2);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+3);
+            this->idx += static_cast<GLuint>(5u * n); // 5 vertices (each of 3 floats for x/y/z), 12 indices per rect.
+        }
 
-                this->indices.push_back (this->idx+3);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+4);
+        /*!
+         * Return the z positions of the centre and the NE, SE, SW and NW corners of rectangle ri
+         * in GridVisMode::RectInterp. Each corner is the mean of the scaled data (dcopy) of the
+         * rectangles that meet there.
+         */
+        sm::vec<float, 5> rect_interp_z (const I ri) const
+        {
+            // The neighbours that are drawn. A neighbour that is masked out is treated as the edge of the grid.
+            const bool ne = this->grid->has_ne(ri) && this->mask.keeps (this->grid->index_ne(ri));
+            const bool nn = this->grid->has_nn(ri) && this->mask.keeps (this->grid->index_nn(ri));
+            const bool nw = this->grid->has_nw(ri) && this->mask.keeps (this->grid->index_nw(ri));
+            const bool ns = this->grid->has_ns(ri) && this->mask.keeps (this->grid->index_ns(ri));
+            const bool nne = this->grid->has_nne(ri) && this->mask.keeps (this->grid->index_nne(ri));
+            const bool nnw = this->grid->has_nnw(ri) && this->mask.keeps (this->grid->index_nnw(ri));
+            const bool nsw = this->grid->has_nsw(ri) && this->mask.keeps (this->grid->index_nsw(ri));
+            const bool nse = this->grid->has_nse(ri) && this->mask.keeps (this->grid->index_nse(ri));
+
+            // Use the linear scaled copy of the data, dcopy.
+            const float datumC  = this->dcopy[ri];
+            const float datumNE =  ne  ? this->dcopy[this->grid->index_ne(ri)] : datumC;
+            const float datumNN =  nn  ? this->dcopy[this->grid->index_nn(ri)] : datumC;
+            const float datumNW =  nw  ? this->dcopy[this->grid->index_nw(ri)] : datumC;
+            const float datumNS =  ns  ? this->dcopy[this->grid->index_ns(ri)] : datumC;
+            const float datumNNE = nne ? this->dcopy[this->grid->index_nne(ri)] : datumC;
+            const float datumNNW = nnw ? this->dcopy[this->grid->index_nnw(ri)] : datumC;
+            const float datumNSW = nsw ? this->dcopy[this->grid->index_nsw(ri)] : datumC;
+            const float datumNSE = nse ? this->dcopy[this->grid->index_nse(ri)] : datumC;
+
+            sm::vec<float, 5> z = { datumC, datumC, datumC, datumC, datumC };
+
+            // NE vertex. Compute mean of this->data[ri] and N, NE and E elements
+            if (nn && ne && nne) {
+                z[1] = 0.25f * (datumC + datumNN + datumNE + datumNNE);
+            } else if (ne) {
+                // Assume no NN and no NNE
+                z[1] = 0.5f * (datumC + datumNE);
+            } else if (nn) {
+                // Assume no NE and no NNE
+                z[1] = 0.5f * (datumC + datumNN);
+            }
 
-                this->indices.push_back (this->idx+4);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+1);
+            // SE vertex
+            if (ns && ne && nse) {
+                z[2] = 0.25f * (datumC + datumNS + datumNE + datumNSE);
+            } else if (ne) {
+                // Assume no NS and no NSE
+                z[2] = 0.5f * (datumC + datumNE);
+            } else if (ns) {
+                // Assume no NE and no NSE
+                z[2] = 0.5f * (datumC + datumNS);
+            }
 
-                this->idx += 5; // 5 vertices (each of 3 floats for x/y/z), 15 indices.
+            // SW vertex
+            if (ns && nw && nsw) {
+                z[3] = 0.25f * (datumC + datumNS + datumNW + datumNSW);
+            } else if (nw) {
+                z[3] = 0.5f * (datumC + datumNW);
+            } else if (ns) {
+                z[3] = 0.5f * (datumC + datumNS);
+            }
+
+            // NW vertex
+            if (nn && nw && nnw) {
+                z[4] = 0.25f * (datumC + datumNN + datumNW + datumNNW);
+            } else if (nw) {
+                z[4] = 0.5f * (datumC + datumNW);
+            } else if (nn) {
+                z[4] = 0.5f * (datumC + datumNN);
             }
+
+            return z;
         }
 
         void initializeVerticesCols()
@@ -735,70 +1101,59 @@ namespace mplot {
             this->idx = 0;
             this->setupScaling();
 
-            float datumC = 0.0f;   // datum at the centre
-            float datumNE = 0.0f;  // datum at the hex to the east.
-            float datumNN = 0.0f;
+            const bool interp_sides = this->options.test (gridvisual_flags::interpolate_colour_sides);
 
-            sm::vec<float> vtx_0, vtx_1, vtx_2, vtx_3, vtx_4;
+            // Each column has 13 vertices and 18 indices at fixed offsets, so the columns are
+            // written in parallel
+            const std::size_t n = static_cast<std::size_t>(this->grid->n());
+            const std::size_t v0 = this->grow_element_buffers (n, 13u, 18u);
+            const std::size_t i0 = this->indices.size() - 18u * n;
+            const GLuint idx0 = this->idx;
 
-            for (I ri = 0; ri < this->grid->n(); ++ri) {
+            this->for_elements (n, [&](const std::size_t e) {
+                const I ri = static_cast<I>(e);
 
                 // Use the linear scaled copy of the data, dcopy.
-                datumC  = this->dcopy[ri];
-                datumNE =  this->grid->has_ne(ri)  ? this->dcopy[this->grid->index_ne(ri)] : datumC;
-                datumNN =  this->grid->has_nn(ri)  ? this->dcopy[this->grid->index_nn(ri)] : datumC;
+                const float datumC  = this->dcopy[ri];
+                const float datumNE =  this->grid->has_ne(ri)  ? this->dcopy[this->grid->index_ne(ri)] : datumC;
+                const float datumNN =  this->grid->has_nn(ri)  ? this->dcopy[this->grid->index_nn(ri)] : datumC;
 
                 // Use a single colour for each rect, even though rectangle's z positions are
                 // interpolated. Do the _colour_ scaling:
                 std::array<float, 3> clr = this->setColour (ri);
-                std::array<float, 3> clr_e;
-                std::array<float, 3> clr_n;
-                if (this->options.test (gridvisual_flags::interpolate_colour_sides) == true) {
+                std::array<float, 3> clr_e = this->clr_east_column;
+                std::array<float, 3> clr_n = this->clr_north_column;
+                std::array<float, 3> clr_es = this->clr_east_column;
+                std::array<float, 3> clr_ns = this->clr_north_column;
+                if (interp_sides) {
                     clr_e = this->setColour (this->grid->has_ne(ri) ? this->grid->index_ne(ri) : ri);
                     clr_n = this->setColour (this->grid->has_nn(ri) ? this->grid->index_nn(ri) : ri);
+                    clr_es = clr;
+                    clr_ns = clr;
                 }
 
-                // First push the 5 positions of the pixel top face, starting with the centre
-                // Use the centre position as the first location for finding the normal vector
-                vtx_0 = { (*this->grid)[ri][0] + centering_offset[0], (*this->grid)[ri][1] + centering_offset[1], datumC };
-                this->vertex_push (vtx_0, this->vertexPositions);
-
-                // NE vertex
-                vtx_1 = { (*this->grid)[ri][0] + hx + centering_offset[0], (*this->grid)[ri][1] + vy + centering_offset[1], datumC };
-                this->vertex_push (vtx_1, this->vertexPositions);
-
-                // SE vertex
-                vtx_2 = { (*this->grid)[ri][0] + hx + centering_offset[0], (*this->grid)[ri][1] - vy + centering_offset[1], datumC };
-                this->vertex_push (vtx_2, this->vertexPositions);
-
-                // SW vertex
-                this->vertex_push ((*this->grid)[ri][0] - hx + centering_offset[0], (*this->grid)[ri][1] - vy + centering_offset[1], datumC, this->vertexPositions);
-
-                // NW vertex
-                this->vertex_push ((*this->grid)[ri][0] - hx + centering_offset[0], (*this->grid)[ri][1] + vy + centering_offset[1], datumC, this->vertexPositions);
-
-                // 4 Neighbour East vertices
-                // NE
-                this->vertex_push ((*this->grid)[ri][0] + hx + centering_offset[0], (*this->grid)[ri][1] + vy + centering_offset[1], datumC, this->vertexPositions);
-                // SE
-                this->vertex_push ((*this->grid)[ri][0] + hx + centering_offset[0], (*this->grid)[ri][1] - vy + centering_offset[1], datumC, this->vertexPositions);
-
-                // NE
-                vtx_3 = { (*this->grid)[ri][0] + hx + centering_offset[0], (*this->grid)[ri][1] + vy + centering_offset[1], datumNE };
-                this->vertex_push (vtx_3, this->vertexPositions);
-                // SE
-                this->vertex_push ((*this->grid)[ri][0] + hx + centering_offset[0], (*this->grid)[ri][1] - vy + centering_offset[1], datumNE, this->vertexPositions);
-
-                // 4 Neighbour North vertices
-                // NW high
-                this->vertex_push ((*this->grid)[ri][0] - hx + centering_offset[0], (*this->grid)[ri][1] + vy + centering_offset[1], datumC, this->vertexPositions);
-                // NE high
-                this->vertex_push ((*this->grid)[ri][0] + hx + centering_offset[0], (*this->grid)[ri][1] + vy + centering_offset[1], datumC, this->vertexPositions);
-                // NW low
-                vtx_4 = { (*this->grid)[ri][0] - hx + centering_offset[0], (*this->grid)[ri][1] + vy + centering_offset[1], datumNN };
-                this->vertex_push (vtx_4, this->vertexPositions);
-                // NE low
-                this->vertex_push ((*this->grid)[ri][0] + hx + centering_offset[0], (*this->grid)[ri][1] + vy + centering_offset[1], datumNN, this->vertexPositions);
+                const float x = (*this->grid)[ri][0];
+                const float y = (*this->grid)[ri][1];
+                // The 5 positions of the pixel top face, starting with the centre, which is the
+                // first location for finding the normal vector
+                const sm::vec<float> vtx_0 = { x + centering_offset[0], y + centering_offset[1], datumC };
+                const sm::vec<float> vtx_1 = { x + hx + centering_offset[0], y + vy + centering_offset[1], datumC }; // NE
+                const sm::vec<float> vtx_2 = { x + hx + centering_offset[0], y - vy + centering_offset[1], datumC }; // SE
+                const sm::vec<float> sw = { x - hx + centering_offset[0], y - vy + centering_offset[1], datumC };
+                const sm::vec<float> nw = { x - hx + centering_offset[0], y + vy + centering_offset[1], datumC };
+                // The east face: NE and SE high, then NE and SE low
+                const sm::vec<float> vtx_3 = { x + hx + centering_offset[0], y + vy + centering_offset[1], datumNE };
+                const sm::vec<float> se_low = { x + hx + centering_offset[0], y - vy + centering_offset[1], datumNE };
+                // The north face: NW and NE high, then NW and NE low
+                const sm::vec<float> vtx_4 = { x - hx + centering_offset[0], y + vy + centering_offset[1], datumNN };
+                const sm::vec<float> ne_low = { x + hx + centering_offset[0], y + vy + centering_offset[1], datumNN };
+
+                const std::size_t vi = v0 + 13u * e;
+                float* p = this->vertexPositions.data() + 3u * vi;
+                for (const sm::vec<float>* v : { &vtx_0, &vtx_1, &vtx_2, &sw, &nw, &vtx_1, &vtx_2, &vtx_3, &se_low, &nw, &vtx_1, &vtx_4, &ne_low }) {
+                    std::copy (v->begin(), v->end(), p);
+                    p += 3;
+                }
 
                 // From vtx_0,1,2 compute normal. This sets the correct normal, but note that there
                 // is only one 'layer' of vertices; the back of the GridVisual will be coloured the
@@ -819,86 +1174,93 @@ namespace mplot {
                 if (datumNN > datumC) { vnorm_n = -vnorm_n; }
 
                 vnorm.renormalize();
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm_e, this->vertexNormals);
-                this->vertex_push (vnorm_e, this->vertexNormals);
-                this->vertex_push (vnorm_e, this->vertexNormals);
-                this->vertex_push (vnorm_e, this->vertexNormals);
-                this->vertex_push (vnorm_n, this->vertexNormals);
-                this->vertex_push (vnorm_n, this->vertexNormals);
-                this->vertex_push (vnorm_n, this->vertexNormals);
-                this->vertex_push (vnorm_n, this->vertexNormals);
-
-                // Five vertices with the same colour
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-
-                if (this->options.test (gridvisual_flags::interpolate_colour_sides) == true) {
-                    this->vertex_push (clr, this->vertexColors);
-                    this->vertex_push (clr, this->vertexColors);
-                    this->vertex_push (clr_e, this->vertexColors);
-                    this->vertex_push (clr_e, this->vertexColors);
-
-                    this->vertex_push (clr, this->vertexColors);
-                    this->vertex_push (clr, this->vertexColors);
-                    this->vertex_push (clr_n, this->vertexColors);
-                    this->vertex_push (clr_n, this->vertexColors);
-                } else {
-                    this->vertex_push (this->clr_east_column, this->vertexColors);
-                    this->vertex_push (this->clr_east_column, this->vertexColors);
-                    this->vertex_push (this->clr_east_column, this->vertexColors);
-                    this->vertex_push (this->clr_east_column, this->vertexColors);
-
-                    this->vertex_push (this->clr_north_column, this->vertexColors);
-                    this->vertex_push (this->clr_north_column, this->vertexColors);
-                    this->vertex_push (this->clr_north_column, this->vertexColors);
-                    this->vertex_push (this->clr_north_column, this->vertexColors);
+                float* nm = this->vertexNormals.data() + 3u * vi;
+                for (std::size_t j = 0; j < 13u; ++j) {
+                    const sm::vec<float>& vn = j < 5u ? vnorm : (j < 9u ? vnorm_e : vnorm_n);
+                    std::copy (vn.begin(), vn.end(), nm + 3u * j);
                 }
 
-                // Define indices now to produce the 4 triangles in the pixel
-                this->indices.push_back (this->idx+1);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+2);
-
-                this->indices.push_back (this->idx+2);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+3);
-
-                this->indices.push_back (this->idx+3);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+4);
-
-                this->indices.push_back (this->idx+4);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+1);
-
-                // East face
-                this->indices.push_back (this->idx + 5);
-                this->indices.push_back (this->idx + 6);
-                this->indices.push_back (this->idx + 7);
+                // Five top vertices with the same colour, then the east and north faces
+                float* c = this->vertexColors.data() + 3u * vi;
+                for (const std::array<float, 3>* cl : { &clr, &clr, &clr, &clr, &clr, &clr_es, &clr_es, &clr_e, &clr_e, &clr_ns, &clr_ns, &clr_n, &clr_n }) {
+                    std::copy (cl->begin(), cl->end(), c);
+                    c += 3;
+                }
 
-                this->indices.push_back (this->idx + 6);
-                this->indices.push_back (this->idx + 8);
-                this->indices.push_back (this->idx + 7);
+                // The 4 triangles of the top face, then the east and north faces
+                const GLuint k = idx0 + static_cast<GLuint>(13u * e);
+                const std::array<GLuint, 18> tri = { k + 1, k, k + 2,  k + 2, k, k + 3,  k + 3, k, k + 4,  k + 4, k, k + 1,
+                                                     k + 5, k + 6, k + 7,  k + 6, k + 8, k + 7,
+                                                     k + 9, k + 10, k + 11,  k + 10, k + 12, k + 11 };
+                std::copy (tri.begin(), tri.end(), this->indices.data() + i0 + 18u * e);
+            });
 
-                // North face
-                this->indices.push_back (this->idx + 9);
-                this->indices.push_back (this->idx + 10);
-                this->indices.push_back (this->idx + 11);
+            this->idx += static_cast<GLuint>(13u * n);
+        }
 
-                this->indices.push_back (this->idx + 10);
-                this->indices.push_back (this->idx + 12);
-                this->indices.push_back (this->idx + 11);
+        /*!
+         * GridVisMode::Columns for an instanced GridVisual. One column mesh, a box of the size of
+         * an element and of unit height (without a base), is drawn for each element, scaled to
+         * the element's height and coloured by the element. A data update then rewrites and
+         * uploads only instance_data (instance_stride floats per element), and the mesh stays
+         * on the GPU. The sides of each column are drawn, rather than the steps in the surface
+         * between neighbours.
+         */
+        void initializeVerticesColsInstanced()
+        {
+            this->setupScaling();
+            if (this->indices.empty()) { this->column_mesh(); }
+
+            const std::size_t n = static_cast<std::size_t>(this->grid->n());
+            this->instance_data.resize (n * this->instance_stride);
+            this->for_elements (n, [this](const std::size_t e) {
+                const I ri = static_cast<I>(e);
+                // A column below zero hangs from zero. The radial scale is the inverse of the
+                // scale, so a flat column is given a small height rather than none.
+                const float h = this->dcopy[ri];
+                const float s = std::max (std::abs (h), std::numeric_limits<float>::epsilon());
+                const std::array<float, 3> clr = this->setColour (ri);
+                // The mesh's z axis is 'rotated' onto z, so that the radial scale (1/s) undoes the
+                // scaling of x and y. column_mesh allows for the quarter turn that this gives.
+                const float inst[] = { (*this->grid)[ri][0] + this->centering_offset[0],
+                                      (*this->grid)[ri][1] + this->centering_offset[1],
+                                      std::min (h, 0.0f), s, clr[0], clr[1], clr[2], 0.0f,
+                                      0.0f, 0.0f, 1.0f, 1.0f / s };
+                std::copy (std::begin (inst), std::end (inst), this->instance_data.begin() + e * this->instance_stride);
+            });
+        }
 
-                this->idx += 13;
-            }
+        /*!
+         * The mesh of initializeVerticesColsInstanced: the top and four sides of a box that spans
+         * an element in x and y and is from 0 to 1 in z. An instance that is rotated onto +z is
+         * turned a quarter turn about z (x goes to -y and y to x; see the instanced vertex
+         * shader), so each vertex (x, y, z) is stored as (-y, x, z) to come out where it should.
+         */
+        void column_mesh()
+        {
+            const sm::vec<float, 2> dx = this->grid->get_dx();
+            const float hx = 0.5f * dx[0];
+            const float vy = 0.5f * dx[1];
+            auto turned = [](const sm::vec<float>& v) { return sm::vec<float>{ -v[1], v[0], v[2] }; };
+            // Add a quad with corners a, b, c, d (anticlockwise, seen from outside) and normal nrm
+            auto quad = [&](const sm::vec<float>& a, const sm::vec<float>& b, const sm::vec<float>& c,
+                            const sm::vec<float>& d, const sm::vec<float>& nrm) {
+                for (const sm::vec<float>* v : { &a, &b, &c, &d }) {
+                    this->vertex_push (turned (*v), this->vertexPositions);
+                    this->vertex_push (turned (nrm), this->vertexNormals);
+                    this->vertex_push (mplot::colour::white, this->vertexColors);
+                }
+                this->indices.insert (this->indices.end(), { this->idx, this->idx + 1, this->idx + 2, this->idx, this->idx + 2, this->idx + 3 });
+                this->idx += 4;
+            };
+            this->idx = 0;
+            // Top
+            quad ({ -hx, -vy, 1.0f }, { hx, -vy, 1.0f }, { hx, vy, 1.0f }, { -hx, vy, 1.0f }, { 0.0f, 0.0f, 1.0f });
+            // East, west, north and south sides
+            quad ({ hx, -vy, 0.0f }, { hx, vy, 0.0f }, { hx, vy, 1.0f }, { hx, -vy, 1.0f }, { 1.0f, 0.0f, 0.0f });
+            quad ({ -hx, vy, 0.0f }, { -hx, -vy, 0.0f }, { -hx, -vy, 1.0f }, { -hx, vy, 1.0f }, { -1.0f, 0.0f, 0.0f });
+            quad ({ hx, vy, 0.0f }, { -hx, vy, 0.0f }, { -hx, vy, 1.0f }, { hx, vy, 1.0f }, { 0.0f, 1.0f, 0.0f });
+            quad ({ -hx, -vy, 0.0f }, { hx, -vy, 0.0f }, { hx, -vy, 1.0f }, { -hx, -vy, 1.0f }, { 0.0f, -1.0f, 0.0f });
         }
 
         //! Floating pixels
@@ -913,35 +1275,17 @@ namespace mplot {
 
             sm::vec<float, 2> gridline_ht = this->get_gridline_ht();
 
-            // Thickness of spacing for selected pixels
-            const float selth_x = this->options.test (gridvisual_flags::selected_pix_thickness_fixed) ? this->selected_pix_thickness : dx[0] * this->selected_pix_thickness;
-            const float selth_y = this->options.test (gridvisual_flags::selected_pix_thickness_fixed) ? this->selected_pix_thickness : dx[1] * this->selected_pix_thickness;
-            float sx = 0.0f;
-            float sy = 0.0f;
-
             float datumC = 0.0f;   // datum at the centre
 
             sm::vec<float> vtx_0, vtx_1, vtx_2;
 
-            for (I ri = 0; ri < this->grid->n(); ++ri) {
-
-                if (this->options.test (gridvisual_flags::showselectedpixborder) == true) {
-                    if (this->selected_pix.contains (ri)) {
-                        sx = selth_x;
-                        sy = selth_y;
-                    } else { // ri is not in selected_pix
-                        sx = 0.0f;
-                        sy = 0.0f;
-                    }
-                }
+            const std::size_t n_kept = this->mask.count (static_cast<std::size_t>(this->grid->n()));
+            for (std::size_t k = 0; k < n_kept; ++k) {
+                const I ri = static_cast<I>(this->mask.element (k));
 
                 // Use the linear scaled copy of the data, dcopy.
                 datumC  = this->dcopy[ri];
 
-                // Use a single colour for each rect, even though rectangle's z positions are
-                // interpolated. Do the _colour_ scaling:
-                std::array<float, 3> clr = this->setColour (ri);
-
                 // First push the 5 positions of the triangle vertices, starting with the centre
                 // Use the centre position as the first location for finding the normal vector
                 vtx_0 = { (*this->grid)[ri][0] + centering_offset[0], (*this->grid)[ri][1] + centering_offset[1], datumC };
@@ -949,18 +1293,18 @@ namespace mplot {
 
 
                 // NE vertex
-                vtx_1 = { (*this->grid)[ri][0] + hx + centering_offset[0] - gridline_ht[0] - sx, (*this->grid)[ri][1] + vy + centering_offset[1] - gridline_ht[1] - sy, datumC };
+                vtx_1 = { (*this->grid)[ri][0] + hx + centering_offset[0] - gridline_ht[0], (*this->grid)[ri][1] + vy + centering_offset[1] - gridline_ht[1], datumC };
                 this->vertex_push (vtx_1, this->vertexPositions);
 
                 // SE vertex
-                vtx_2 = { (*this->grid)[ri][0] + hx + centering_offset[0] - gridline_ht[0] - sx, (*this->grid)[ri][1] - vy + centering_offset[1] + gridline_ht[1] + sy, datumC };
+                vtx_2 = { (*this->grid)[ri][0] + hx + centering_offset[0] - gridline_ht[0], (*this->grid)[ri][1] - vy + centering_offset[1] + gridline_ht[1], datumC };
                 this->vertex_push (vtx_2, this->vertexPositions);
 
                 // SW vertex
-                this->vertex_push ((*this->grid)[ri][0] - hx + centering_offset[0] + gridline_ht[0] + sx, (*this->grid)[ri][1] - vy + centering_offset[1] + gridline_ht[1] + sy, datumC, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0] - hx + centering_offset[0] + gridline_ht[0], (*this->grid)[ri][1] - vy + centering_offset[1] + gridline_ht[1], datumC, this->vertexPositions);
 
                 // NW vertex
-                this->vertex_push ((*this->grid)[ri][0] - hx + centering_offset[0] + gridline_ht[0] + sx, (*this->grid)[ri][1] + vy + centering_offset[1] - gridline_ht[1] - sy, datumC, this->vertexPositions);
+                this->vertex_push ((*this->grid)[ri][0] - hx + centering_offset[0] + gridline_ht[0], (*this->grid)[ri][1] + vy + centering_offset[1] - gridline_ht[1], datumC, this->vertexPositions);
 
                 // From vtx_0,1,2 compute normal. This sets the correct normal, but note that there
                 // is only one 'layer' of vertices; the back of the GridVisual will be coloured the
@@ -976,12 +1320,9 @@ namespace mplot {
                 this->vertex_push (vnorm, this->vertexNormals);
                 this->vertex_push (vnorm, this->vertexNormals);
 
-                // Five vertices with the same colour
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
-                this->vertex_push (clr, this->vertexColors);
+                // Five vertices with the same colour. Use a single colour for each rect, even
+                // though rectangle's z positions are interpolated.
+                this->push_colour (ri, 5);
 
                 // Define indices now to produce the 4 triangles in the pixel
                 this->indices.push_back (this->idx+1);
@@ -1004,6 +1345,108 @@ namespace mplot {
             }
         }
 
+        /*!
+         * Initialize as a single flat rectangle covering the whole grid. The data are not in the
+         * vertices; they are copied into datum_texture, one float per element, and the rectangle's
+         * vertex colours hold the texture coordinates of its corners. The fragment shader samples
+         * the datum for each fragment and colour maps it through the colour lookup texture.
+         */
+        void initializeVerticesTexture()
+        {
+            this->idx = 0;
+            this->setupScaling();
+
+            sm::vec<float, 2> dx = this->grid->get_dx();
+            sm::vec<float, 4> cg_extents = this->grid->extents(); // {xmin, xmax, ymin, ymax}
+            const float left  = cg_extents[0] - (dx[0] / 2.0f) + this->centering_offset[0];
+            const float right = cg_extents[1] + (dx[0] / 2.0f) + this->centering_offset[0];
+            const float bot   = cg_extents[2] - (dx[1] / 2.0f) + this->centering_offset[1];
+            const float top   = cg_extents[3] + (dx[1] / 2.0f) + this->centering_offset[1];
+
+            // A border drawn by the fragment shader lies in a margin of the rectangle, where the
+            // texture coordinates are outside [0,1] (see set_cell_grid)
+            float bthick = 0.0f;
+            if (this->options.test (gridvisual_flags::grid_in_shader) == true
+                && this->options.test (gridvisual_flags::showborder) == true) {
+                bthick = this->options.test (gridvisual_flags::border_thickness_fixed) ? this->border_thickness : dx[0] * this->border_thickness;
+            }
+            const float bx = bthick / (right - left);
+            const float by = bthick / (top - bot);
+
+            // Texture rows follow the grid's fastest-varying index, from element 0. fy is the
+            // fraction of the way from the row of element 0 to the last row.
+            const bool colmaj = this->grid->get_order() == sm::gridorder::bottomleft_to_topright_colmaj
+            || this->grid->get_order() == sm::gridorder::topleft_to_bottomright_colmaj;
+            const bool topleft = this->grid->get_order() == sm::gridorder::topleft_to_bottomright
+            || this->grid->get_order() == sm::gridorder::topleft_to_bottomright_colmaj;
+            auto corner = [this, colmaj, topleft](const float x, const float y, const float fx, const float fy_bl)
+            {
+                const float fy = topleft ? 1.0f - fy_bl : fy_bl;
+                this->vertex_push (x, y, 0.0f, this->vertexPositions);
+                this->vertex_push (0.0f, 0.0f, 1.0f, this->vertexNormals);
+                this->vertex_push (colmaj ? fy : fx, colmaj ? fx : fy, 0.0f, this->vertexColors);
+            };
+            corner (left - bthick, bot - bthick, -bx, -by);
+            corner (right + bthick, bot - bthick, 1.0f + bx, -by);
+            corner (right + bthick, top + bthick, 1.0f + bx, 1.0f + by);
+            corner (left - bthick, top + bthick, -bx, 1.0f + by);
+            this->indices.insert (this->indices.end(), { this->idx, this->idx + 1, this->idx + 2,
+                                                          this->idx, this->idx + 2, this->idx + 3 });
+            this->idx += 4;
+
+            auto dims = this->grid->get_dims();
+            this->datum_texture_dims = colmaj ? std::array<unsigned int, 2>{ static_cast<unsigned int>(dims[1]), static_cast<unsigned int>(dims[0]) }
+                                              : std::array<unsigned int, 2>{ static_cast<unsigned int>(dims[0]), static_cast<unsigned int>(dims[1]) };
+            this->set_data_texture_scale();
+            this->set_cell_grid();
+            if (this->external_datum_texture != 0) { return; } // Sampled from the client's texture
+            this->datum_texture.assign (this->dcolour.begin(), this->dcolour.end());
+            this->reinit_datum_texture();
+        }
+
+        /*!
+         * Set cell_grid, from which the fragment shader draws the grid and the flat border of a
+         * Texture mode GridVisual with grid_in_shader. The widths of the grid lines follow those
+         * of drawGrid: grid_thickness times the size of an element, or grid_thickness in model
+         * units with grid_thickness_fixed, or grid_thickness pixels with grid_thickness_pixels.
+         */
+        void set_cell_grid()
+        {
+            typename mplot::VisualModelBase<glver>::cell_grid_lines& cg = this->cell_grid;
+            cg = {};
+            if (this->options.test (gridvisual_flags::grid_in_shader) == false) { return; }
+            cg.colour = this->grid_colour;
+            cg.border = this->options.test (gridvisual_flags::showborder);
+            cg.border_colour = this->border_colour;
+            if (this->options.test (gridvisual_flags::showgrid) == false) { return; }
+            using units = typename mplot::VisualModelBase<glver>::cell_grid_units;
+            sm::vec<float, 2> dx = this->grid->get_dx();
+            // Widths across x and y, in texels (or pixels)
+            std::array<float, 2> w = { this->grid_thickness, this->grid_thickness };
+            cg.units = units::texels;
+            if (this->options.test (gridvisual_flags::grid_thickness_pixels)) {
+                cg.units = units::pixels;
+            } else if (this->options.test (gridvisual_flags::grid_thickness_fixed)) {
+                w = { this->grid_thickness / dx[0], this->grid_thickness / dx[1] };
+            }
+            // The texture's first axis runs along y for a column major grid
+            const bool colmaj = this->grid->get_order() == sm::gridorder::bottomleft_to_topright_colmaj
+            || this->grid->get_order() == sm::gridorder::topleft_to_bottomright_colmaj;
+            cg.width = colmaj ? std::array<float, 2>{ w[1], w[0] } : w;
+        }
+
+        //! The datum_scale with which to colour the texels: colourScale, for a client's texture
+        //! of data, or the identity for datum_texture, which holds colour scaled data
+        void set_data_texture_scale()
+        {
+            if (this->external_datum_texture == 0) {
+                this->datum_scale = { 1.0f, 0.0f };
+            } else {
+                this->datum_scale = { static_cast<float>(this->colourScale.getParams (0)),
+                                      static_cast<float>(this->colourScale.getParams (1)) };
+            }
+        }
+
         /*!
          * Choice of method for rendering the elements. Triangles are fastest, this
          * places an OpenGL vertex at each grid centre and renders the surface with the
@@ -1052,6 +1495,31 @@ namespace mplot {
         void grid_thickness_fixed (bool flag_value = true)
         { this->options.set (gridvisual_flags::grid_thickness_fixed, flag_value); }
 
+        /*!
+         * In gridVisMode Texture, have the fragment shader draw the grid (and a flat border)
+         * from the coordinates of the cells, rather than building them from vertices. The grid
+         * then costs no vertices, whatever the number of elements, it stays crisp at any zoom,
+         * and a change to its colours or thickness needs only updateGridLines().
+         */
+        void grid_in_shader (bool flag_value = true)
+        { this->options.set (gridvisual_flags::grid_in_shader, flag_value); }
+
+        //! With grid_in_shader, make grid_thickness a width in pixels of the screen, so the grid
+        //! lines keep their width as the grid is zoomed
+        void grid_thickness_pixels (bool flag_value = true)
+        { this->options.set (gridvisual_flags::grid_thickness_pixels, flag_value); }
+
+        /*!
+         * With grid_in_shader, show a change to grid_colour, grid_thickness, border_colour or to
+         * the showgrid, grid_thickness_fixed or grid_thickness_pixels options. Nothing is rebuilt.
+         * A border that is newly shown (or hidden) needs reinit(), as it changes the rectangle.
+         */
+        void updateGridLines()
+        {
+            this->set_cell_grid();
+            this->scene_changed();
+        }
+
         //! How far in z to locate the grid lines?
         float grid_z_offset = 0.0f;
 
@@ -1079,18 +1547,40 @@ namespace mplot {
         /*!
          * If true, draw a border around selected pixels (with a full border around each selected
          * pixel). The selected pixels are chosen by the client code, which should populate
-         * selected_pix_indexes.
+         * selected_pix.
          */
         void showselectedpixborder (bool flag_value = true)
         { this->options.set (gridvisual_flags::showselectedpixborder, flag_value); }
 
         /*!
-         * A list of those pixel indices that should be drawn with an individual
-         * border. The key is the pixel index within the grid. The value is the colour
-         * for the border. This container may also be filled (with arbitrary colours) if
-         * the 'enclosing' border is to be drawn.
+         * The pixels that should be drawn with an individual border. Select pixel i with
+         * selected_pix[i] = colour, where i is the pixel index within the grid and colour is the
+         * colour for its border. This container may also be filled (with arbitrary colours) if
+         * the 'enclosing' border is to be drawn. After finalize(), call updateSelection() to
+         * show a change.
+         */
+        mplot::pixel_selection<I> selected_pix;
+
+        /*!
+         * Redraw the selected pixel borders after a change to selected_pix (or to
+         * selected_pix_thickness or enclosing_border_colour). Only the borders, which are GPU
+         * polylines drawn over the pixels, are replaced and uploaded; the vertices of the grid
+         * are not recomputed. If other polylines have been added to the model since it was
+         * built, it is rebuilt with reinit() instead.
          */
-        std::unordered_map<I, std::array<float, 3>> selected_pix;
+        void updateSelection()
+        {
+            this->wait_for_build();
+            // Until the model is built, finalize() draws the borders
+            if (this->indices.empty()) { return; }
+            if (this->selection_polylines_first + this->selection_polylines_count != this->get_polylines().size()) {
+                this->reinit();
+                return;
+            }
+            this->truncate_polylines (this->selection_polylines_first);
+            this->drawSelection();
+            this->scene_changed();
+        }
 
         //! Thickness of the inner border for each selected pixel
         float selected_pix_thickness = 0.1f;
@@ -1119,6 +1609,10 @@ namespace mplot {
         std::array<float, 3> clr_north_column = mplot::colour::black;
 
     protected:
+        //! The index of the first selected pixel border polyline (see drawSelection)
+        std::size_t selection_polylines_first = 0;
+        //! The number of selected pixel border polylines
+        std::size_t selection_polylines_count = 0;
 
         //! GridVisual specific getter for grid-line half thickness, which is non-zero
         //! only if showgrid or implygrid are true.
@@ -1136,28 +1630,191 @@ namespace mplot {
             return gridline_ht;
         }
 
+        /*!
+         * Choose the level of detail for the frame. The grid is drawn at one level, chosen for
+         * the point of the grid (a corner or the centre) at which its elements are largest on
+         * the screen.
+         */
+        void update_lod() override
+        {
+            if (this->async_build.valid() || this->lod_viewport_h <= 0 || this->indices.empty()) { return; }
+            const sm::mat44<float> mv = this->scenematrix * this->model_matrix();
+            const sm::vec<float, 4> ux = mv * sm::vec<float, 4>{ 1.0f, 0.0f, 0.0f, 0.0f };
+            const float eye_scale = std::sqrt (ux[0] * ux[0] + ux[1] * ux[1] + ux[2] * ux[2]);
+            const sm::vec<float, 2> dx = this->base_grid->get_dx().as_float();
+            const float len_0 = eye_scale * std::max (dx[0], dx[1]);
+            const sm::vec<float, 4> ext = this->base_grid->extents(); // {xmin, xmax, ymin, ymax}
+            const sm::vec<float, 2> c = this->base_grid->centre().as_float();
+            const std::array<sm::vec<float, 2>, 5> pts = { sm::vec<float, 2>{ ext[0], ext[2] }, sm::vec<float, 2>{ ext[1], ext[2] },
+                                                           sm::vec<float, 2>{ ext[0], ext[3] }, sm::vec<float, 2>{ ext[1], ext[3] }, c };
+            float px_0 = 0.0f; // The largest on-screen size of an element of the full grid
+            for (const sm::vec<float, 2>& pt : pts) {
+                const sm::vec<float, 4> eye = mv * sm::vec<float, 4>{ pt[0] + this->centering_offset[0], pt[1] + this->centering_offset[1], 0.0f, 1.0f };
+                px_0 = std::max (px_0, lod::screen_size (this->lod_projection, eye, len_0, this->lod_viewport_h));
+            }
+            int l = this->lod_levels;
+            while (l > 0 && px_0 * static_cast<float>(1 << l) > this->lod_pixel_size) { --l; }
+            if (l == this->lod_shown) { return; }
+            this->lod_shown = l;
+            this->lod_switching = true;
+            this->reinit();
+            this->lod_switching = false;
+        }
+
+        //! The data have changed; aggregate each level again when it is next shown
+        void lod_stale() { std::fill (this->lod_fresh.begin(), this->lod_fresh.end(), false); }
+
+        /*!
+         * Point grid and scalarData at the level to be shown, aggregating the data for it if
+         * they have changed (data_changed) since it was last shown. A scaling that is to be
+         * autoscaled, and has not been, is autoscaled from the full data, so that the colours
+         * are the same at every level.
+         */
+        void lod_take (const bool data_changed)
+        {
+            // A scalarData that isn't one of the levels' is the client's (full) data
+            bool ours = false;
+            for (const sm::vvec<T>& d : this->lod_data) { ours = ours || this->scalarData == &d; }
+            if (!ours) { this->full_data = this->scalarData; }
+            if (data_changed) { this->lod_stale(); }
+
+            this->grid = this->base_grid;
+            this->scalarData = this->full_data;
+            if (this->lod_shown == 0 || this->full_data == nullptr) { return; }
+
+            const bool autoscale_z = this->zScale.do_autoscale && !this->zScale.ready();
+            const bool autoscale_c = this->colourScale.do_autoscale && !this->colourScale.ready();
+            if (autoscale_z || autoscale_c) {
+                sm::range<T> r;
+                r.search_init();
+                for (const T& d : *this->full_data) { if (!std::isnan (d)) { r.update (d); } }
+                if (autoscale_z) { this->zScale.compute_scaling (r.min, r.max); }
+                if (autoscale_c) { this->colourScale.compute_scaling (r.min, r.max); }
+            }
+
+            const std::size_t li = static_cast<std::size_t>(this->lod_shown - 1);
+            if (!this->lod_fresh[li]) { this->lod_aggregate (this->lod_shown); }
+            this->grid = this->lod_grids[li].get();
+            this->scalarData = &this->lod_data[li];
+        }
+
+        /*!
+         * Make the grid of level l (if it has not been made) and aggregate full_data into its
+         * elements. The element of level l that holds block (col, row) of the full grid (counted
+         * from the bottom left) is element row * width + col of a bottom left to top right grid.
+         * A block at the right or top edge may be part empty. NaNs are left out of the aggregates.
+         */
+        void lod_aggregate (const int l)
+        {
+            const std::size_t li = static_cast<std::size_t>(l - 1);
+            const std::size_t f = std::size_t{1} << l;
+            const auto dims = this->base_grid->get_dims();
+            const std::size_t w = (static_cast<std::size_t>(dims[0]) + f - 1u) / f;
+            const std::size_t h = (static_cast<std::size_t>(dims[1]) + f - 1u) / f;
+            const sm::vec<C, 2> dx = this->base_grid->get_dx();
+            const sm::vec<float, 4> ext = this->base_grid->extents();
+            if (this->lod_grids[li] == nullptr) {
+                // Centre each coarse element on the block of elements that it aggregates
+                const C half = static_cast<C>(f - 1u) / C{2};
+                const sm::vec<C, 2> o = { static_cast<C>(ext[0]) + dx[0] * half, static_cast<C>(ext[2]) + dx[1] * half };
+                this->lod_grids[li] = std::make_unique<sm::grid<I, C>> (static_cast<I>(w), static_cast<I>(h), dx * static_cast<C>(f), o,
+                                                                        sm::griddomainwrap::none, sm::gridorder::bottomleft_to_topright);
+            }
+
+            sm::vvec<T>& agg = this->lod_data[li];
+            const bool mean = this->lod_aggregation == lod::aggregation::mean;
+            agg.assign (w * h, mean ? T{0} : std::numeric_limits<T>::quiet_NaN());
+            std::vector<unsigned int> count (w * h, 0u);
+            const std::size_t n = std::min (static_cast<std::size_t>(this->base_grid->n()), this->full_data->size());
+            for (std::size_t i = 0; i < n; ++i) {
+                const T v = (*this->full_data)[i];
+                if (std::isnan (v)) { continue; }
+                const sm::vec<C, 2> p = (*this->base_grid)[static_cast<I>(i)];
+                const std::size_t col = static_cast<std::size_t>(std::lround ((p[0] - static_cast<C>(ext[0])) / dx[0])) / f;
+                const std::size_t row = static_cast<std::size_t>(std::lround ((p[1] - static_cast<C>(ext[2])) / dx[1])) / f;
+                const std::size_t ci = row * w + col;
+                if (mean) {
+                    agg[ci] += v;
+                } else if (count[ci] == 0u) {
+                    agg[ci] = v;
+                } else {
+                    agg[ci] = this->lod_aggregation == lod::aggregation::max ? std::max (agg[ci], v) : std::min (agg[ci], v);
+                }
+                ++count[ci];
+            }
+            if (mean) {
+                for (std::size_t ci = 0; ci < agg.size(); ++ci) {
+                    agg[ci] = count[ci] > 0u ? agg[ci] / static_cast<T>(count[ci]) : std::numeric_limits<T>::quiet_NaN();
+                }
+            }
+            this->lod_fresh[li] = true;
+        }
+
+        //! Recolour the element runs of updateRegion and updateElements
+        void update_runs (const std::vector<std::array<std::size_t, 2>>& runs)
+        {
+            if (this->gridVisMode == GridVisMode::Texture && this->external_datum_texture != 0) {
+                throw std::runtime_error ("GridVisual: the data are in a client texture; write to that instead");
+            }
+            // The runs are of the full grid's elements; a coarser level is aggregated again
+            if (this->gridVisMode == GridVisMode::Columns || this->vectorData != nullptr || this->lod_shown > 0) {
+                this->reinitColours();
+                return;
+            }
+            if (this->lod_enabled) { this->lod_stale(); }
+            if (this->setContext != nullptr) { this->setContext (this->parentVis); }
+            this->recolour_runs (runs, this->gridVisMode == GridVisMode::Triangles ? 1u : 5u);
+        }
+
         //! Called by reinitColours when scalarData is not null
         void reinitColoursScalar (const std::size_t n_data, const std::size_t n_cvertices_per_datum)
         {
-            if (this->colourScale.do_autoscale == true) { this->colourScale.reset(); }
+            // At a coarser level of detail, reinitColours has autoscaled from the full data
+            if (this->colourScale.do_autoscale == true && this->lod_shown == 0) { this->colourScale.reset(); }
             this->dcolour.resize (this->scalarData->size());
             this->colourScale.transform (*(this->scalarData), this->dcolour);
 
-            // Replace elements of vertexColors
-            for (std::size_t i = 0u; i < n_data; ++i) {
-                auto c = this->cm.convert (this->dcolour[i]);
-                std::size_t d_idx = 3 * i * n_cvertices_per_datum;
-                for (std::size_t j = 0; j < n_cvertices_per_datum; ++j) {
-                    this->vertexColors[d_idx + 3 * j] = c[0];
-                    this->vertexColors[d_idx + 3 * j + 1] = c[1];
-                    this->vertexColors[d_idx + 3 * j + 2] = c[2];
+            if (this->colour_by_element) {
+                // Only the per-element datums change; the vertex buffers are left alone
+                this->set_element_datums (this->dcolour);
+                return;
+            }
+
+            if (this->colour_by_datum) {
+                // Replace elements of vertexDatums; the colour map is applied by the shader
+                for (std::size_t i = 0u; i < n_data; ++i) {
+                    std::fill_n (this->vertexDatums.begin() + i * n_cvertices_per_datum, n_cvertices_per_datum,
+                                 this->dcolour[this->mask.element (i)]);
                 }
+                this->reinit_colour_buffer();
+                return;
             }
 
+            // Replace the first n_data * n_cvertices_per_datum elements of vertexColors
+            if (this->mask.empty()) { this->dcolour.resize (n_data); }
+            this->convert_kept (n_cvertices_per_datum);
+
             // Lastly, this call copies vertexColors (etc) into the OpenGL memory space
             this->reinit_colour_buffer();
         }
 
+        //! Called by reinitColours in Texture mode. Only the datum texture changes.
+        void reinitColoursTexture()
+        {
+            if (this->external_datum_texture != 0) {
+                // Only the scaling changes; the client's texture holds the data
+                this->set_data_texture_scale();
+                this->scene_changed();
+                return;
+            }
+            if (this->scalarData == nullptr) { throw std::runtime_error ("No scalar data to reinitColours()"); }
+            if (this->colourScale.do_autoscale == true) { this->colourScale.reset(); }
+            this->dcolour.resize (this->scalarData->size());
+            this->colourScale.transform (*(this->scalarData), this->dcolour);
+            this->datum_texture.assign (this->dcolour.begin(), this->dcolour.end());
+            this->reinit_datum_texture();
+        }
+
         //! Called by reinitColours when vectorData is not null (vectors are probably RGB colour)
         void reinitColoursVector (const std::size_t n_data, const std::size_t n_cvertices_per_datum)
         {
@@ -1178,7 +1835,7 @@ namespace mplot {
 
             // Replace elements of vertexColors
             for (std::size_t i = 0u; i < n_data; ++i) {
-                std::array<float, 3> c = this->setColour (i);
+                std::array<float, 3> c = this->setColour (this->mask.element (i));
                 std::size_t d_idx = 3 * i * n_cvertices_per_datum;
                 for (std::size_t j = 0; j < n_cvertices_per_datum; ++j) {
                     this->vertexColors[d_idx + 3 * j] = c[0];
@@ -1191,8 +1848,20 @@ namespace mplot {
             this->reinit_colour_buffer();
         }
 
-        //! The sm::grid<> to visualize
+        //! The sm::grid<> to visualize (the grid of the level of detail shown, if there are levels)
         const sm::grid<I, C>* grid;
+        //! The sm::grid<> passed to the constructor
+        const sm::grid<I, C>* base_grid = nullptr;
+
+        // The levels of detail: the grid and the aggregated data of levels 1 to lod_levels, and
+        // whether each level's data are up to date with full_data (the client's data)
+        std::vector<std::unique_ptr<sm::grid<I, C>>> lod_grids;
+        std::vector<sm::vvec<T>> lod_data;
+        std::vector<bool> lod_fresh;
+        const std::vector<T>* full_data = nullptr;
+        int lod_levels = 0;
+        int lod_shown = 0;
+        bool lod_switching = false;
 
         // A centering offset to make sure that the grid is centred on
         // this->mv_offset. This is computed so that you *add* centering_offset to each
@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <array>
+#include <algorithm>
+#include <vector>
 #include <sm/mathconst>
 #include <sm/vec>
 
@@ -110,6 +113,15 @@ namespace mplot {
         {
             sm::vec<float> centre = {0,0,this->z};
 
+            this->colour_by_polar = this->analytic_fill;
+            if (this->analytic_fill) {
+                // One quad, coloured per fragment from a lookup of the wheel's colours
+                this->polar_inner = 0.0f;
+                this->updateColourMap();
+                this->computePolarDisc (centre, this->radius);
+                return;
+            }
+
             for (int ring = this->numrings; ring > 0; ring--) {
 
                 float r_out = this->radius * static_cast<float>(ring)/this->numrings;
@@ -149,6 +161,27 @@ namespace mplot {
             }
         }
 
+        /*!
+         * If analytic_fill, update the wheel's colour lookup after a change to cm. The lookup
+         * has numrings + 1 rows of numsegs colours, from the centre to the rim, and the change
+         * needs no change to the vertices.
+         */
+        void updateColourMap()
+        {
+            if (!this->analytic_fill) { return; }
+            const unsigned int rows = this->numrings + 1u;
+            std::vector<float> rgb (3u * rows * this->numsegs);
+            for (unsigned int k = 0; k < rows; ++k) {
+                const float norm_r = static_cast<float>(k) / static_cast<float>(this->numrings);
+                for (unsigned int j = 0; j < this->numsegs; ++j) {
+                    const float colour_angle = (static_cast<float>(j) / this->numsegs) * sm::mathconst<float>::two_pi;
+                    const std::array<float, 3> c = this->cm.convert_angular (colour_angle, norm_r);
+                    std::copy (c.begin(), c.end(), rgb.begin() + 3u * (k * this->numsegs + j));
+                }
+            }
+            this->set_polar_colour_lut (rgb, rows);
+        }
+
         //! The ColourMap to show (copy in). Should be type ColourMapType::HSV
         mplot::ColourMap<F> cm;
         //! The radius of the HSVwheel
@@ -167,6 +200,13 @@ namespace mplot {
         mplot::TextFeatures tf;
         //! Gap to x axis tick labels. Gets auto-set
         float ticklabelgap = 0.05f;
+        /*!
+         * If true, the wheel is a single quad coloured per fragment (see
+         * VisualModel::colour_by_polar), and numsegs and numrings set the resolution of its colour
+         * lookup, between whose colours the wheel is smoothly interpolated. If false, the wheel
+         * is tessellated into numrings rings of numsegs segments.
+         */
+        bool analytic_fill = true;
         //! The number of segments to make in each ring of the colourmap fill
         unsigned int numsegs = 128;
         //! How many rings of colour?
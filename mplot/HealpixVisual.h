@@ -1,10 +1,16 @@
 #pragma once
 
 #include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <array>
+#include <algorithm>
 #include <sm/scale>
 #include <sm/vec>
 #include <sm/vvec>
+#include <sm/mathconst>
 #include <mplot/healpix/healpix_bare.hpp>
+#include <mplot/lod.h>
 #include <mplot/VisualModel.h>
 #include <mplot/ColourMap.h>
 
@@ -25,12 +31,43 @@ namespace mplot {
             this->reliefScale.do_autoscale = true;
         }
 
-        // Update the VisualModel, changing only colours if that's enough, or doing a
-        // full rebuild if we're displaying relief.
+        // Update the VisualModel, changing only colours if that's enough. If we're displaying
+        // relief (or were, at the last update), the pixel vertices are rewritten in place,
+        // keeping the triangulation, or there's a full rebuild if that's not possible.
         void reinit()
         {
-            if (this->relief == true) { mplot::VisualModel<glver>::reinit(); }
-            else { this->reinitColours(); }
+            if (this->relief == true || this->relief_drawn == true) {
+                if (this->rewrite_pixels() == false) { mplot::VisualModel<glver>::reinit(); }
+            } else {
+                this->reinitColours();
+            }
+        }
+
+        /*
+         * Rewrite the positions, normals and colours of the pixel vertices from pixeldata,
+         * keeping the indices made by the last full build. Returns false if a full rebuild is
+         * needed instead, because the order has changed since the build or because there are
+         * face spheres or labels, which would be left in their old positions.
+         */
+        bool rewrite_pixels()
+        {
+            const std::size_t n_p = static_cast<std::size_t>(this->n_pixels());
+            if (this->k == 0 || this->show_face_spheres || this->show_nest_labels
+                || this->unit_order != this->k || this->indices.empty()
+                || this->vertexPositions.size() < 3u * n_p) {
+                return false;
+            }
+            if (this->setContext != nullptr) { this->setContext (this->parentVis); }
+
+            sm::vvec<float> scaled_colours;
+            sm::vvec<float> scaled_relief;
+            this->scale_pixeldata (scaled_colours, scaled_relief);
+            this->write_pixel_vertices (0, scaled_colours, scaled_relief);
+            this->write_lod_vertices();
+
+            this->mark_dirty (0, this->lod_table.size() > 1u ? this->lod_vertex_end : n_p);
+            this->reinit_buffers();
+            return true;
         }
 
         void setColourData (std::vector<std::array<float, 3>>* cdata) { this->colourdata = cdata; }
@@ -50,12 +87,8 @@ namespace mplot {
                 this->colourScale.transform (this->pixeldata, scaled_data);
 
                 // Re-colour
-                for (size_t i = 0u; i < n_data; ++i) {
-                    auto c = this->cm.convert (scaled_data[i]);
-                    this->vertexColors[3*i] = c[0];
-                    this->vertexColors[3*i+1] = c[1];
-                    this->vertexColors[3*i+2] = c[2];
-                }
+                scaled_data.resize (n_data);
+                this->cm.convert (scaled_data, this->vertexColors);
             } else {
                 // Use colour in colourdata directly, assuming it is in correct range (0->1 for each channel)
                 for (size_t i = 0u; i < n_data; ++i) {
@@ -65,6 +98,9 @@ namespace mplot {
                 }
             }
 
+            // The coarser orders are coloured from the new data, too
+            this->write_lod_vertices();
+
             // Lastly, this call copies vertexColors (etc) into the OpenGL memory space
             this->reinit_colour_buffer();
         }
@@ -340,28 +376,44 @@ namespace mplot {
             this->fill_eight_triangles();
         }
 
-        /*
-         * This function creates OpenGL vertices from the HEALPix (exactly one for each
-         * HEALPix pixel), in NEST order. It sets the location of each pixel to the location
-         * on the 3D sphere surface, using this->r to set the radius and modulating the
-         * radius with relief generated from pixeldata if this->relief is true. It sets the
-         * vertex colours from pixeldata using a ColourMap (this->cm).
-         *
-         * After creating the vertices, it then computes the OpenGL indices that will form
-         * trangles between the vertices to make the spherical surface.
-         */
-        void healpix_triangles_by_nest()
+        // Scale pixeldata for colours and relief
+        void scale_pixeldata (sm::vvec<float>& scaled_colours, sm::vvec<float>& scaled_relief)
         {
-            // For colours and relief, we scale data
-            sm::vvec<float> scaled_colours (this->pixeldata.size());
+            scaled_colours.resize (this->pixeldata.size());
             if (this->colourScale.do_autoscale == true) { this->colourScale.reset(); }
             this->colourScale.transform (this->pixeldata, scaled_colours);
-            sm::vvec<float> scaled_relief (this->pixeldata.size());
+            scaled_relief.resize (this->pixeldata.size());
             if (this->reliefScale.do_autoscale == true) { this->reliefScale.reset(); }
             this->reliefScale.transform (this->pixeldata, scaled_relief);
+        }
 
-            // The first loop creates all the *vertices* using nest scheme.
-            int64_t n_p = this->n_pixels();
+        // Compute the unit vector to each pixel in NEST order, unless they're already held for this order
+        void compute_unit_vectors()
+        {
+            if (this->unit_order == this->k) { return; }
+            const int64_t n_p = this->n_pixels();
+            this->unit_posn.resize (3u * static_cast<std::size_t>(n_p));
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (int64_t p = 0; p < n_p; ++p) {
+                hp::t_vec pv = hp::loc2vec (hp::ang2loc (hp::nest2ang (this->nside, p)));
+                sm::vec<float> upf = sm::vec<double>({pv.x, pv.y, pv.z}).as_float();
+                std::copy (upf.begin(), upf.end(), this->unit_posn.begin() + 3u * p);
+            }
+            this->unit_order = this->k;
+        }
+
+        /*
+         * Write the position, colour and normal of the vertex of each pixel into the vertex
+         * vectors, starting from vertex v0. Each pixel writes only its own vertex, so the pixels
+         * are computed in parallel.
+         */
+        void write_pixel_vertices (const std::size_t v0, const sm::vvec<float>& scaled_colours,
+                                   const sm::vvec<float>& scaled_relief)
+        {
+            this->compute_unit_vectors();
+            const int64_t n_p = this->n_pixels();
 
             // If colourdata is set, then use those RGB values directly, rather than scaled colours
             bool use_colourdata = false;
@@ -371,16 +423,13 @@ namespace mplot {
                 if (this->colourdata->size() >= static_cast<size_t>(n_p)) { use_colourdata = true; }
             }
 
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
             for (int64_t p = 0; p < n_p; ++p) {
-                // Convert nest index p to angle for this pixel
-                hp::t_ang ang = hp::nest2ang (this->nside, p);
-
-                // Find the location of the pixel
-                hp::t_vec pv = hp::loc2vec (hp::ang2loc (ang));
-                // Convert it into a sm::vec and modify according to radius and relief
+                // Modify the unit vector according to radius and relief
                 float _r = this->r;
                 if (this->relief == true) { _r += scaled_relief[p]; }
-                sm::vec<float> vpf = (sm::vec<double>({pv.x, pv.y, pv.z}) * _r).as_float();
 
                 // Make a colour from the pixeldata
                 std::array<float, 3> sc = mplot::colour::black;
@@ -392,17 +441,89 @@ namespace mplot {
                     sc = this->cm.convert (scaled_colours[p]);
                 }
 
-                if (this->show_nest_labels) {
-                    this->addLabel (std::to_string(p), (vpf  * this->r * 1.03f),
+                this->write_vertex (v0 + static_cast<std::size_t>(p), this->unit_posn.data() + 3u * p, _r, sc);
+            }
+            this->relief_drawn = this->relief;
+        }
+
+        // Write vertex vi at radius _r along the unit vector u, with colour sc
+        void write_vertex (const std::size_t vi, const float* u, const float _r, const std::array<float, 3>& sc)
+        {
+            const std::size_t i = 3u * vi;
+            // The normal points outwards unless the relief has turned the radius negative
+            const float nsign = _r < 0.0f ? -1.0f : 1.0f;
+            for (std::size_t j = 0; j < 3u; ++j) {
+                this->vertexPositions[i + j] = u[j] * _r * this->r;
+                this->vertexColors[i + j] = sc[j];
+                this->vertexNormals[i + j] = u[j] * nsign;
+            }
+        }
+
+        /*
+         * This function creates OpenGL vertices from the HEALPix (exactly one for each
+         * HEALPix pixel), in NEST order. It sets the location of each pixel to the location
+         * on the 3D sphere surface, using this->r to set the radius and modulating the
+         * radius with relief generated from pixeldata if this->relief is true. It sets the
+         * vertex colours from pixeldata using a ColourMap (this->cm).
+         *
+         * After creating the vertices, it then computes the OpenGL indices that will form
+         * trangles between the vertices to make the spherical surface. The triangulation
+         * depends only on the order, so it is computed once per order and copied on later
+         * builds.
+         */
+        void healpix_triangles_by_nest()
+        {
+            // For colours and relief, we scale data
+            sm::vvec<float> scaled_colours;
+            sm::vvec<float> scaled_relief;
+            this->scale_pixeldata (scaled_colours, scaled_relief);
+
+            // The first step creates all the *vertices* using nest scheme.
+            int64_t n_p = this->n_pixels();
+            const std::size_t v0 = this->vertexPositions.size() / 3u;
+            for (auto* v : { &this->vertexPositions, &this->vertexColors, &this->vertexNormals }) {
+                v->resize (3u * (v0 + static_cast<std::size_t>(n_p)));
+            }
+            this->write_pixel_vertices (v0, scaled_colours, scaled_relief);
+
+            if (this->show_nest_labels) {
+                for (int64_t p = 0; p < n_p; ++p) {
+                    sm::vec<float> vpf = { this->vertexPositions[3u * (v0 + p)],
+                                           this->vertexPositions[3u * (v0 + p) + 1u],
+                                           this->vertexPositions[3u * (v0 + p) + 2u] };
+                    this->addLabel (std::to_string(p), (vpf * 1.03f),
                                     mplot::TextFeatures(0.025f, mplot::colour::black) );
                 }
-                // Add the vertex info for pixel p
-                this->vertex_push (vpf * this->r, this->vertexPositions);
-                this->vertex_push (sc, this->vertexColors);
-                vpf.renormalize();
-                this->vertex_push (vpf, this->vertexNormals);
             }
 
+            // The triangulation for this order may already have been made
+            const std::size_t i0 = this->indices.size();
+            const std::size_t v0_idx = this->idx;
+            if (this->triangulation_order == this->k) {
+                this->indices.resize (i0 + this->triangulation.size());
+                for (std::size_t i = 0; i < this->triangulation.size(); ++i) {
+                    this->indices[i0 + i] = this->idx + this->triangulation[i];
+                }
+            } else {
+                this->triangulate();
+                // Keep the triangulation, counted from the first pixel vertex
+                this->triangulation.resize (this->indices.size() - i0);
+                for (std::size_t i = 0; i < this->triangulation.size(); ++i) {
+                    this->triangulation[i] = this->indices[i0 + i] - this->idx;
+                }
+                this->triangulation_order = this->k;
+            }
+            this->idx += n_p;
+
+            if (this->lod_levels > 0) { this->build_lod (i0, v0_idx); }
+        }
+
+        /*
+         * Add the indices of the triangles between the pixel vertices of order this->k, the first
+         * of which is vertex this->idx.
+         */
+        void triangulate()
+        {
             // Now draw indices
             int64_t k_down = this->k - 1;
             int64_t nside_down = 1LL << k_down;
@@ -447,8 +568,188 @@ namespace mplot {
 
             // Last job is to fill in the channels. Maybe use xy indexing for this task.
             this->fill_channels();
+        }
 
-            this->idx += n_p;
+        /*
+         * Add the coarser orders k-1, k-2 and so on (no more than lod_levels of them, and not
+         * below order 1) after the pixels of order k, and sort the triangles of each order by
+         * patch, so that update_lod can choose the order to draw for each patch. i0 and v0 are the
+         * first index and the first vertex of the pixels of order k.
+         */
+        void build_lod (const std::size_t i0, const std::size_t v0)
+        {
+            const int64_t k_min = std::max (int64_t{1}, this->k - this->lod_levels);
+            this->lod_patch = std::min (this->lod_patch_order, k_min);
+            this->lod_index_begin = i0;
+
+            lod_level base;
+            base.order = this->k;
+            base.first_vertex = v0;
+            base.patch_first = this->sort_by_patch (i0, v0, this->k);
+            this->lod_table.push_back (std::move (base));
+
+            const int64_t k_full = this->k;
+            for (int64_t L = k_full - 1; L >= k_min; --L) {
+                lod_level lv;
+                lv.order = L;
+                lv.first_vertex = this->idx;
+                const std::size_t n_L = std::size_t{12} << (2 * L);
+                for (auto* v : { &this->vertexPositions, &this->vertexColors, &this->vertexNormals }) {
+                    v->resize (3u * (lv.first_vertex + n_L));
+                }
+                const std::size_t li0 = this->indices.size();
+                // The triangulation functions work on the order in k and nside
+                this->k = L;
+                this->nside = int64_t{1} << L;
+                this->triangulate();
+                this->k = k_full;
+                this->nside = int64_t{1} << k_full;
+                this->idx += n_L;
+                lv.patch_first = this->sort_by_patch (li0, lv.first_vertex, L);
+                this->lod_table.push_back (std::move (lv));
+            }
+            this->lod_index_end = this->indices.size();
+            this->lod_vertex_end = this->idx;
+            this->write_lod_vertices();
+
+            // The centre of each patch, on the unit sphere
+            const int64_t n_patches = int64_t{12} << (2 * this->lod_patch);
+            this->patch_centres.resize (n_patches);
+            for (int64_t pi = 0; pi < n_patches; ++pi) {
+                hp::t_vec pv = hp::loc2vec (hp::ang2loc (hp::nest2ang (int64_t{1} << this->lod_patch, pi)));
+                this->patch_centres[pi] = sm::vec<double>({pv.x, pv.y, pv.z}).as_float();
+            }
+        }
+
+        /*
+         * Sort the triangles in indices from i0 to the end, which join the pixel vertices of
+         * order 'order' (pixel 0 being vertex v0), by the patch of their first vertex. Returns the
+         * start of each patch's triangles in indices, and the end of the last patch's.
+         */
+        std::vector<std::size_t> sort_by_patch (const std::size_t i0, const std::size_t v0, const int64_t order)
+        {
+            const std::size_t n_patches = std::size_t{12} << (2 * this->lod_patch);
+            const int64_t shift = 2 * (order - this->lod_patch);
+            const std::size_t n_tri = (this->indices.size() - i0) / 3u;
+            auto patch_of = [this, i0, v0, shift](const std::size_t t) {
+                return static_cast<std::size_t>(this->indices[i0 + 3u * t] - v0) >> shift;
+            };
+            // A counting sort, keeping the triangles of each patch in order
+            std::vector<std::size_t> first (n_patches + 1u, 0u);
+            for (std::size_t t = 0; t < n_tri; ++t) { ++first[patch_of (t) + 1u]; }
+            for (std::size_t pi = 0; pi < n_patches; ++pi) { first[pi + 1u] += first[pi]; }
+            std::vector<std::size_t> next (first.begin(), first.end() - 1);
+            std::vector<GLuint> sorted (3u * n_tri);
+            for (std::size_t t = 0; t < n_tri; ++t) {
+                std::size_t s = 3u * next[patch_of (t)]++;
+                for (std::size_t j = 0; j < 3u; ++j) { sorted[s + j] = this->indices[i0 + 3u * t + j]; }
+            }
+            std::copy (sorted.begin(), sorted.end(), this->indices.begin() + i0);
+            for (auto& f : first) { f = i0 + 3u * f; }
+            return first;
+        }
+
+        /*
+         * Write the vertices of the coarser orders in lod_table. The value of each coarser pixel
+         * is the mean (or the max or min, see lod_aggregation) of the four pixels that it contains, or the
+         * mean of their colours if colourdata is in use.
+         */
+        void write_lod_vertices()
+        {
+            if (this->lod_table.size() < 2u) { return; }
+            const std::size_t n_p = static_cast<std::size_t>(this->n_pixels());
+            const bool use_colourdata = this->colourdata != nullptr && this->colourdata->size() >= n_p;
+            const bool anticipate_colourdata = this->colourdata != nullptr;
+
+            sm::vvec<T> finer;
+            finer.assign (this->pixeldata.begin(), this->pixeldata.begin() + n_p);
+            std::vector<std::array<float, 3>> finer_c;
+            if (use_colourdata) { finer_c.assign (this->colourdata->begin(), this->colourdata->begin() + n_p); }
+
+            for (std::size_t l = 1; l < this->lod_table.size(); ++l) {
+                const lod_level& lv = this->lod_table[l];
+                const int64_t n_L = int64_t{12} << (2 * lv.order);
+                sm::vvec<T> coarser (static_cast<std::size_t>(n_L));
+                std::vector<std::array<float, 3>> coarser_c (use_colourdata ? n_L : 0);
+                for (int64_t q = 0; q < n_L; ++q) {
+                    const T* f = finer.data() + 4 * q;
+                    if (this->lod_aggregation == lod::aggregation::max) {
+                        coarser[q] = std::max (std::max (f[0], f[1]), std::max (f[2], f[3]));
+                    } else if (this->lod_aggregation == lod::aggregation::min) {
+                        coarser[q] = std::min (std::min (f[0], f[1]), std::min (f[2], f[3]));
+                    } else {
+                        coarser[q] = (f[0] + f[1] + f[2] + f[3]) / T{4};
+                    }
+                    if (use_colourdata) {
+                        for (std::size_t j = 0; j < 3u; ++j) {
+                            coarser_c[q][j] = 0.25f * (finer_c[4 * q][j] + finer_c[4 * q + 1][j]
+                                                       + finer_c[4 * q + 2][j] + finer_c[4 * q + 3][j]);
+                        }
+                    }
+                }
+
+                // The scales were set from pixeldata (in scale_pixeldata or reinitColours)
+                sm::vvec<float> scaled_colours (coarser.size());
+                this->colourScale.transform (coarser, scaled_colours);
+                sm::vvec<float> scaled_relief (coarser.size());
+                if (this->relief == true) { this->reliefScale.transform (coarser, scaled_relief); }
+
+                const int64_t nside_L = int64_t{1} << lv.order;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+                for (int64_t q = 0; q < n_L; ++q) {
+                    hp::t_vec pv = hp::loc2vec (hp::ang2loc (hp::nest2ang (nside_L, q)));
+                    sm::vec<float> u = sm::vec<double>({pv.x, pv.y, pv.z}).as_float();
+                    float _r = this->r;
+                    if (this->relief == true) { _r += scaled_relief[q]; }
+                    std::array<float, 3> sc = mplot::colour::black;
+                    if (use_colourdata == true) {
+                        sc = coarser_c[q];
+                    } else if (anticipate_colourdata == false) {
+                        sc = this->cm.convert (scaled_colours[q]);
+                    }
+                    this->write_vertex (lv.first_vertex + static_cast<std::size_t>(q), u.data(), _r, sc);
+                }
+                finer.swap (coarser);
+                finer_c.swap (coarser_c);
+            }
+        }
+
+        /*
+         * Each frame, draw each patch at the coarsest order whose pixels are no more than
+         * lod_pixel_size pixels across on the screen.
+         */
+        void update_lod() override
+        {
+            // While a build runs, lod_table is being rewritten; keep the spans for the current buffers
+            if (this->async_build.valid() || this->lod_viewport_h <= 0) { return; }
+            this->draw_spans.clear();
+            if (this->lod_table.size() < 2u) { return; }
+
+            const sm::mat44<float> mv = this->scenematrix * this->model_matrix();
+            const sm::vec<float, 4> ux = mv * sm::vec<float, 4>{ 1.0f, 0.0f, 0.0f, 0.0f };
+            const float eye_scale = std::sqrt (ux[0] * ux[0] + ux[1] * ux[1] + ux[2] * ux[2]);
+            // The radius at which write_vertex places the pixels (without relief)
+            const float radius = this->r * this->r;
+            // A pixel of order L has an area of pi radius^2 / (3 nside^2)
+            const float pixel_len_0 = eye_scale * radius * std::sqrt (sm::mathconst<float>::pi / 3.0f);
+
+            lod::append_span (this->draw_spans, 0, this->lod_index_begin);
+            for (std::size_t pi = 0; pi < this->patch_centres.size(); ++pi) {
+                const sm::vec<float>& c = this->patch_centres[pi];
+                const sm::vec<float, 4> eye = mv * sm::vec<float, 4>{ c[0] * radius, c[1] * radius, c[2] * radius, 1.0f };
+                std::size_t l = this->lod_table.size() - 1u;
+                while (l > 0) {
+                    const float len = pixel_len_0 / static_cast<float>(int64_t{1} << this->lod_table[l].order);
+                    if (lod::screen_size (this->lod_projection, eye, len, this->lod_viewport_h) <= this->lod_pixel_size) { break; }
+                    --l;
+                }
+                const std::vector<std::size_t>& pf = this->lod_table[l].patch_first;
+                lod::append_span (this->draw_spans, pf[pi], pf[pi + 1u] - pf[pi]);
+            }
+            const std::size_t n_ind = this->uploaded_sizes[this->idxVBO];
+            if (n_ind > this->lod_index_end) { lod::append_span (this->draw_spans, this->lod_index_end, n_ind - this->lod_index_end); }
         }
 
         void initializeVertices()
@@ -456,14 +757,17 @@ namespace mplot {
             if (this->pixeldata.size() != static_cast<uint64_t>(this->n_pixels())) {
                 this->pixeldata.resize (this->n_pixels(), 0.0f);
             }
+            this->lod_table.clear();
             if (this->k == 0 || this->show_face_spheres) { this->face_spheres(); }
             if (this->k == 0) { return; }
             this->healpix_triangles_by_nest();
             if (this->show_spheres == true) { this->vertex_spheres(); }
             if (this->indicate_axes == true) { this->draw_coordaxes(); }
 
-            // If required, populated the angles lookup map
-            if (this->enable_angles_map && this->angles.empty()) { this->populate_angles(); }
+            // If required, populate the angles lookup table (again, if the order has changed)
+            if (this->enable_angles_map && this->angles.size() != static_cast<std::size_t>(this->n_pixels())) {
+                this->populate_angles();
+            }
         }
 
         // Draw a small set of coordinate arrows with origin at pixel 0
@@ -532,21 +836,27 @@ namespace mplot {
         // Wrapper around nest2ang. Convert nest_index to angle for this pixel
         hp::t_ang get_angles (int64_t nest_index) { return hp::nest2ang (this->nside, nest_index); }
 
-        // Get the angles for the index nest_index from the map angles.
-        hp::t_ang lookup_angles (int64_t nest_index) const { return this->angles.at(nest_index); }
+        // Get the angles for the index nest_index from the lookup table angles.
+        hp::t_ang lookup_angles (int64_t nest_index) const { return this->angles.at (static_cast<std::size_t>(nest_index)); }
 
-        // Populate the angles lookup map (at end of initialize vertices)
+        // Populate the angles lookup table (at end of initialize vertices)
         void populate_angles()
         {
-            for (int64_t i = 0; i < this->n_pixels(); ++i) {
+            const int64_t n_p = this->n_pixels();
+            this->angles.resize (static_cast<std::size_t>(n_p));
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (int64_t i = 0; i < n_p; ++i) {
                 this->angles[i] = this->get_angles (i);
             }
         }
 
-        // It's faster to have a lookup map of the angles, rather than call get_angles_slow() each time.
-        std::unordered_map<int64_t, hp::t_ang> angles;
+        // It's faster to have a lookup table of the angles, rather than call get_angles() each
+        // time. NEST indices run from 0 to n_pixels() - 1, so the table is indexed by NEST index.
+        std::vector<hp::t_ang> angles;
 
-        // Set true to make use of the angles lookup map, which is populated at the end
+        // Set true to make use of the angles lookup table, which is populated at the end
         // of initializeVertices
         bool enable_angles_map = false;
 
@@ -583,10 +893,61 @@ namespace mplot {
         // Show a little coordinate axes set indicating directions?
         bool indicate_axes = false;
 
+        /*
+         * Hold n_levels coarser orders than k (down to order 1), whose pixels aggregate the
+         * pixeldata of the pixels they contain, and draw each patch of the sphere (a pixel of
+         * order lod_patch_order) at the coarsest order whose pixels are no more than
+         * lod_pixel_size pixels across on the screen. Set before finalize(). 0 turns this off.
+         */
+        void set_lod_levels (const int64_t n_levels)
+        {
+            this->lod_levels = n_levels > 0 ? n_levels : 0;
+            this->lod_enabled = this->lod_levels > 0;
+            if (!this->lod_enabled) { this->draw_spans.clear(); }
+        }
+        int64_t get_lod_levels() const { return this->lod_levels; }
+
+        // How the pixeldata are aggregated into the pixels of the coarser orders
+        lod::aggregation lod_aggregation = lod::aggregation::mean;
+        // The largest on-screen size (in pixels) of a pixel of the order drawn for a patch
+        float lod_pixel_size = 1.0f;
+        // The order of the patches for which the order to draw is chosen
+        int64_t lod_patch_order = 3;
+
     private:
         // How many sides for the healpix? This is a choice of the user. Default to 3.
         int64_t k = 3; // k is the 'order'
         int64_t nside = 1 << k;
+
+        // The unit vector to each pixel, 3 floats per pixel in NEST order, for order unit_order
+        std::vector<float> unit_posn;
+        int64_t unit_order = -1;
+        // The triangle indices for order triangulation_order, counted from the first pixel vertex
+        std::vector<GLuint> triangulation;
+        int64_t triangulation_order = -1;
+        // Were the pixel vertices last written with relief?
+        bool relief_drawn = false;
+
+        // One order of the levels of detail: the first vertex of its pixels and the span of
+        // indices of each of its patches (patch p is from patch_first[p] to patch_first[p + 1])
+        struct lod_level
+        {
+            int64_t order = 0;
+            std::size_t first_vertex = 0;
+            std::vector<std::size_t> patch_first;
+        };
+        // The orders held for the levels of detail, from k (finest) down
+        std::vector<lod_level> lod_table;
+        int64_t lod_levels = 0;
+        // The order of the patches (lod_patch_order, unless that's coarser than the coarsest level)
+        int64_t lod_patch = 0;
+        // The unit vectors to the patch centres
+        std::vector<sm::vec<float>> patch_centres;
+        // Indices before lod_index_begin and from lod_index_end (and vertices from
+        // lod_vertex_end) are the face spheres, vertex spheres and axes
+        std::size_t lod_index_begin = 0;
+        std::size_t lod_index_end = 0;
+        std::size_t lod_vertex_end = 0;
     };
 
 } // namespace mplot
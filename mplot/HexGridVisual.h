@@ -3,6 +3,8 @@
 #include <iostream>
 #include <vector>
 #include <array>
+#include <algorithm>
+#include <stdexcept>
 #include <sm/vec>
 #include <sm/vvec>
 #include <sm/hexgrid>
@@ -100,15 +102,62 @@ namespace mplot {
         //! Set false to omit the hexes (to show just the geometry of showoverlap==true)
         bool showhexes = true;
 
+        /*!
+         * Draw only the hexes hi for which keep[hi] is true (one flag for each hex of the
+         * hexgrid). A masked hex emits no vertices or indices and is skipped by reinitColours and
+         * updateData. Its neighbours treat it as the edge of the grid (and, in
+         * HexVisMode::Triangles, only the triangles of three kept hexes are drawn). Not for
+         * gpu_mesh. Set before finalize(), or call reinit() after.
+         */
+        void setMask (const std::vector<bool>& keep) { this->mask = mplot::element_mask (keep); }
+
+        //! Mask out the hexes whose scalarData are NaN now (the mask does not follow later data)
+        void setMaskFromNaN()
+        {
+            if (this->scalarData == nullptr) { throw std::runtime_error ("HexGridVisual::setMaskFromNaN: no scalar data"); }
+            this->mask = mplot::element_mask::from_nan (*this->scalarData);
+        }
+
+        //! Draw only the hexes whose centres lie inside the closed polygon boundary (in the hexgrid's coordinates)
+        void setMaskFromBoundary (const std::vector<sm::vec<float, 2>>& boundary)
+        {
+            auto centre_of = [this](const std::size_t hi) { return sm::vec<float, 2>{ this->hg->d_x[hi], this->hg->d_y[hi] }; };
+            this->mask = mplot::element_mask::from_boundary (this->hg->num(), centre_of, boundary);
+        }
+
+        //! Draw every hex again
+        void clearMask() { this->mask = mplot::element_mask(); }
+
         void initializeVertices() { this->initializeVertices (false); }
         //! Do the computations to initialize the vertices that will represent the
         //! hexgrid.
         void initializeVertices(const bool update)
         {
-            this->idx = 0;
+            if (update == false) { this->idx = 0; }
             this->determine_datasize();
             if (this->datasize == 0) { return; }
 
+            if (this->colour_by_element) {
+                // Each hex's seven vertices share its entry in the datum texture, so there can be
+                // no separately coloured markers or extra geometry
+                if (this->hexVisMode != HexVisMode::HexInterp || this->scalarData == nullptr
+                    || this->showoverlap || this->zerogrid || this->showboundary || this->showcentre
+                    || !this->markedHexes.empty()) {
+                    throw std::runtime_error ("HexGridVisual: colour_by_element needs scalar data, HexVisMode::HexInterp and no marked hexes, overlap or zerogrid");
+                }
+                if (this->colour_lut.empty()) { this->bake_colour_lut(); }
+            }
+            if (!this->mask.empty() && this->mask.size() != this->hg->num()) {
+                throw std::runtime_error ("HexGridVisual: the mask is not of the size of the hexgrid");
+            }
+            if (this->gpu_mesh) {
+                // The compute shader generates the hexes from the data alone
+                if (this->scalarData == nullptr || this->dataCoords != nullptr || this->colour_by_element || !this->mask.empty()
+                    || this->showboundary || this->showcentre || !this->markedHexes.empty()) {
+                    throw std::runtime_error ("HexGridVisual: gpu_mesh needs scalar data, no dataCoords, no colour_by_element, no mask and no marked hexes");
+                }
+            }
+
             switch (this->hexVisMode) {
             case HexVisMode::Triangles:
             {
@@ -118,39 +167,104 @@ namespace mplot {
             case HexVisMode::HexInterp:
             default:
             {
-                this->initializeVerticesHexesInterpolated();
+                this->initializeVerticesHexesInterpolated (update);
                 break;
             }
             }
+
+            if (this->gpu_mesh && update == false) {
+                this->set_gpu_mesh_sources();
+                this->set_gpu_mesh_scalar_data (this->zoom);
+            }
         }
 
-        // This locally defined reinit function knows that we don't want to clear vertexPositions/vertexNormals
-        void reinit_on_update()
+        /*!
+         * In gpu_mesh mode, set up gpu_mesh_sources for the hexes. Each vertex takes its z from
+         * the mean of the data of the hexes that meet there, as initializeVertices does on the
+         * CPU, and in HexVisMode::HexInterp each hex's vertices take the normal of its centre, NE
+         * and SE vertices. The vertices are coloured by their hex's datum.
+         */
+        void set_gpu_mesh_sources()
         {
-            if (this->setContext != nullptr) { this->setContext (this->parentVis); }
-            // No need to set idx to 0 on an update, or clear/empty vertex/indices containers
-            this->initializeVertices (true); // true for 'update' not 'initial build'
-            this->reinit_buffers(); // could potentially be 'reinit_position_color_buffers_only()'
+            using source = typename mplot::VisualModelBase<glver>::gpu_mesh_source;
+            const unsigned int nhex = this->hg->num();
+            if (this->hexVisMode == HexVisMode::Triangles) {
+                this->gpu_mesh_sources.assign (nhex, source{});
+                for (unsigned int hi = 0; hi < nhex; ++hi) {
+                    this->gpu_mesh_sources[hi].z_src[0] = static_cast<GLint>(hi);
+                    this->gpu_mesh_sources[hi].colour_src = static_cast<GLint>(hi);
+                }
+            } else {
+                this->gpu_mesh_sources.assign (7u * nhex, source{});
+                this->build_hex_blocks();
+                for (unsigned int hi = 0; hi < nhex; ++hi) {
+                    const std::array<int, 6>& nbrs = this->hex_blocks[hi].nb;
+                    const GLint vi = static_cast<GLint>(7u * hi);
+                    for (unsigned int j = 0; j < 7u; ++j) {
+                        source& ms = this->gpu_mesh_sources[vi + j];
+                        ms.z_src[0] = static_cast<GLint>(hi);
+                        if (j > 0) {
+                            // The neighbours that meet at the NE, SE, S, SW, NW and N vertices
+                            unsigned int k = 1;
+                            for (const unsigned int n : hex_corner_nb[j - 1]) { if (nbrs[n] != -1) { ms.z_src[k++] = nbrs[n]; } }
+                        }
+                        ms.norm_src = { vi, vi + 1, vi + 2 };
+                        ms.colour_src = static_cast<GLint>(hi);
+                    }
+                }
+            }
+            this->reinit_gpu_mesh_sources();
         }
 
-        // Override the updateData method
-        void updateData (const std::vector<T>* _data)
+        /*!
+         * Update the colours after scalarData has changed. In colour_by_element mode, only the
+         * per-element datums are recomputed and uploaded, one float per hex; otherwise the
+         * vertices are updated in place with reinit_on_update().
+         */
+        void reinitColours()
         {
-            this->scalarData = _data;
-            switch (this->hexVisMode) {
-            case HexVisMode::Triangles:
-            {
-                this->reinit_on_update(); // instead of VisualDataModel<T,glver>::reinit().
-                break;
+            if (!this->colour_by_element || this->scalarData == nullptr) {
+                this->reinit_on_update();
+                return;
             }
-            default:
-            {
-                VisualDataModel<T,glver>::reinit();
-                break;
+            if (this->colourScale.do_autoscale == true) { this->colourScale.reset(); }
+            this->dcolour.resize (this->scalarData->size());
+            this->colourScale.transform (*(this->scalarData), this->dcolour);
+            this->set_element_datums (this->dcolour);
+        }
+
+        /*!
+         * This locally defined reinit function knows that we don't want to clear
+         * vertexPositions/vertexNormals. The hexes' positions, normals and colours are rewritten
+         * where they are, the indices (and any zerogrid or overlap geometry) are kept from the
+         * first build, and only the hexes' vertex data are uploaded. If the model has not been
+         * built for this hexgrid, it is built with reinit().
+         */
+        void reinit_on_update()
+        {
+            const std::size_t nhex = this->mask.count (this->hg->num()); // the hexes that are drawn
+            const std::size_t nverts = this->hexVisMode == HexVisMode::Triangles ? nhex : 7u * nhex;
+            const bool built = !this->indices.empty() && this->vertexPositions.size() >= 3u * nverts
+            && (this->hexVisMode == HexVisMode::Triangles || this->showhexes);
+            if (!built) {
+                this->reinit();
+                return;
             }
+            if (this->gpu_mesh) {
+                // The hexes are regenerated from the data on the GPU
+                this->set_gpu_mesh_scalar_data (this->zoom);
+                return;
             }
+            if (this->setContext != nullptr) { this->setContext (this->parentVis); }
+            // No need to set idx to 0 on an update, or clear/empty vertex/indices containers
+            this->initializeVertices (true); // true for 'update' not 'initial build'
+            this->mark_dirty (0, nverts);
+            this->reinit_buffers(); // uploads only the hexes' vertex data
         }
 
+        //! Data updates rewrite the vertices in place (see reinit_on_update)
+        void reinit_data() override { this->reinit_on_update(); }
+
         // Initialize vertex buffer objects and vertex array object.
 
         /*!
@@ -163,85 +277,92 @@ namespace mplot {
         void initializeVerticesTris (const bool update)
         {
             unsigned int nhex = this->hg->num();
+            // With a mask, vertex k is that of hex mask.element (k)
+            const unsigned int n_kept = static_cast<unsigned int>(this->mask.count (nhex));
 
             this->setupScaling();
 
             std::array<float, 3> blkclr = {0,0,0};
 
             if (update == false) {
-                this->vertexPositions.resize (3u * nhex);
-                this->vertexNormals.resize (3u * nhex);
-                this->vertexColors.resize (3u * nhex);
-                this->indices.reserve (6u * nhex);
+                this->vertexPositions.resize (3u * n_kept);
+                this->vertexNormals.resize (3u * n_kept);
+                this->vertexColors.resize (3u * n_kept);
+                this->indices.reserve (6u * n_kept);
             }
 
-            for (unsigned int hi = 0; hi < nhex; ++hi) {
+            // Each hex writes only its own vertex, so the hexes can be computed in parallel
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (unsigned int k = 0; k < n_kept; ++k) {
+                const unsigned int hi = static_cast<unsigned int>(this->mask.element (k));
                 std::array<float, 3> clr = this->setColour (hi);
                 // If dataCoords has been populated, use these for hex positions, allowing for
                 // mapping of the 2D hexgrid onto a 3D manifold.
                 if (this->dataCoords == nullptr) {
                     if (update == false) {
-                        this->vertexPositions[hi * 3] = this->zoom * this->hg->d_x[hi];
-                        this->vertexPositions[hi * 3 + 1] = this->zoom * this->hg->d_y[hi];
+                        this->vertexPositions[k * 3] = this->zoom * this->hg->d_x[hi];
+                        this->vertexPositions[k * 3 + 1] = this->zoom * this->hg->d_y[hi];
                     }
-                    this->vertexPositions[hi * 3 + 2] = this->zoom * this->dcopy[hi];
+                    this->vertexPositions[k * 3 + 2] = this->zoom * this->dcopy[hi];
 
-                } else { // Otherwise use the positions directly in the hexgrid:
-                    if (update == false) {
-                        this->vertexPositions[hi * 3] = (*this->dataCoords)[hi][0];
-                        this->vertexPositions[hi * 3 + 1] = (*this->dataCoords)[hi][1];
-                    }
-                    this->vertexPositions[hi * 3 + 2] = (*this->dataCoords)[hi][2];
+                } else { // Otherwise use the positions directly in the hexgrid (which may have changed)
+                    this->vertexPositions[k * 3] = (*this->dataCoords)[hi][0];
+                    this->vertexPositions[k * 3 + 1] = (*this->dataCoords)[hi][1];
+                    this->vertexPositions[k * 3 + 2] = (*this->dataCoords)[hi][2];
                 }
                 if (this->markedHexes.count(hi)) {
-                    this->vertexColors[hi * 3] = blkclr[0];
-                    this->vertexColors[hi * 3 + 1] = blkclr[1];
-                    this->vertexColors[hi * 3 + 2] = blkclr[2];
+                    this->vertexColors[k * 3] = blkclr[0];
+                    this->vertexColors[k * 3 + 1] = blkclr[1];
+                    this->vertexColors[k * 3 + 2] = blkclr[2];
                 } else {
-                    this->vertexColors[hi * 3] = clr[0];
-                    this->vertexColors[hi * 3 + 1] = clr[1];
-                    this->vertexColors[hi * 3 + 2] = clr[2];
+                    this->vertexColors[k * 3] = clr[0];
+                    this->vertexColors[k * 3 + 1] = clr[1];
+                    this->vertexColors[k * 3 + 2] = clr[2];
                 }
                 if (update == false) {
-                    this->vertexNormals[hi * 3] = 0.0f;
-                    this->vertexNormals[hi * 3 + 1] = 0.0f;
-                    this->vertexNormals[hi * 3 + 2] = 1.0f;
+                    this->vertexNormals[k * 3] = 0.0f;
+                    this->vertexNormals[k * 3 + 1] = 0.0f;
+                    this->vertexNormals[k * 3 + 2] = 1.0f;
                 }
             }
 
             // Build indices based on neighbour relations in the hexgrid
             // Only needs to happen *on init*. On update, this will not change :)
             if (update == false) {
-                std::size_t ind_sz = 0;
+                this->build_hex_blocks();
+                // The vertex of hex hi (or none if it is masked out)
+                auto vtx = [this](const int hi) { return hi == -1 ? mplot::element_mask::none : this->mask.slot (static_cast<std::size_t>(hi)); };
+                constexpr std::uint32_t none = mplot::element_mask::none;
                 for (unsigned int hi = 0; hi < nhex; ++hi) {
-                    if (HAS_NNE(hi) && HAS_NE(hi)) {
-                        //std::cout << "1st triangle " << hi << "->" << NNE(hi) << "->" << NE(hi) << std::endl;
-                        this->indices.resize (ind_sz + 3);
-                        this->indices[ind_sz++] = hi;
-                        this->indices[ind_sz++] = NNE(hi);
-                        this->indices[ind_sz++] = NE(hi);
+                    const std::uint32_t v = vtx (static_cast<int>(hi));
+                    if (v == none) { continue; }
+                    const std::array<int, 6>& nb = this->hex_blocks[hi].nb;
+                    const std::uint32_t v_nne = vtx (nb[hex_nne]);
+                    const std::uint32_t v_ne = vtx (nb[hex_ne]);
+                    const std::uint32_t v_nw = vtx (nb[hex_nw]);
+                    const std::uint32_t v_nsw = vtx (nb[hex_nsw]);
+                    if (v_nne != none && v_ne != none) {
+                        this->indices.insert (this->indices.end(), { v, v_nne, v_ne });
                     }
-
-                    if (HAS_NW(hi) && HAS_NSW(hi)) {
-                        //std::cout << "2nd triangle " << hi << "->" << NW(hi) << "->" << NSW(hi) << std::endl;
-                        this->indices.resize (ind_sz + 3);
-                        this->indices[ind_sz++] = hi;
-                        this->indices[ind_sz++] = NW(hi);
-                        this->indices[ind_sz++] = NSW(hi);
+                    if (v_nw != none && v_nsw != none) {
+                        this->indices.insert (this->indices.end(), { v, v_nw, v_nsw });
                     }
                 }
-                this->idx = nhex;
+                this->idx = n_kept;
             }
         }
 
         //! Initialize as hexes, with z position of each of the 6
         //! outer edges of the hexes interpolated, but a single colour
-        //! for each hex. Gives a smooth surface.
-        void initializeVerticesHexesInterpolated()
+        //! for each hex. Gives a smooth surface. On update, only the hexes are recomputed.
+        void initializeVerticesHexesInterpolated (const bool update = false)
         {
             if (this->showhexes == true) {
-                this->computeHexes();
+                this->computeHexes (update);
             }
+            if (update == true) { return; }
 
             // Optionally show some hexes to verify the hex overlap area computation (see hexgrid::shiftdata)
             if (this->showoverlap == true) {
@@ -255,8 +376,10 @@ namespace mplot {
             // End trial grid
         }
 
-        // Compute vertices for the patchwork quilt of hexes
-        void computeHexes()
+        //! Compute vertices for the patchwork quilt of hexes. If update is true, rewrite the
+        //! positions, normals and colours of the hexes made by an earlier call, which were the
+        //! first vertices of the model, without changing the indices.
+        void computeHexes (const bool update = false)
         {
             // Here's a complication. In a transformed grid, we can't rely on these. Should be able
             // to *compute* them though.
@@ -268,341 +391,186 @@ namespace mplot {
 
             this->setupScaling();
 
-            // x and y coords on the hexgrid. May be replaced if dataCoords has been set.
-            float _x = 0.0f;
-            float _y = 0.0f;
-            // These Ts are all floats, right?
-            float datumC = 0.0f;   // datum at the centre
-            float datumNE = 0.0f;  // datum at the hex to the east.
-            float datumNNE = 0.0f; // etc
-            float datumNNW = 0.0f;
-            float datumNW = 0.0f;
-            float datumNSW = 0.0f;
-            float datumNSE = 0.0f;
-
-            float datum = 0.0f;
-            float third = 0.3333333f;
-            float half = 0.5f;
-            sm::vec<float> vtx_0, vtx_1, vtx_2, vtx_tmp;
-
-            sm::vec<float> coordC = { 0.0f, 0.0f, 0.0f };
-            sm::vec<float> coordNE = coordC;
-            sm::vec<float> coordNNE = coordC;
-            sm::vec<float> coordNNW = coordC;
-            sm::vec<float> coordNW = coordC;
-            sm::vec<float> coordNSW = coordC;
-            sm::vec<float> coordNSE = coordC;
+            this->build_hex_blocks();
 
+            // Marking hexes changes markedHexes, so it is done before the (possibly parallel) loop
             for (unsigned int hi = 0; hi < nhex; ++hi) {
-
-                if (this->dataCoords == nullptr) {
-                    _x = this->hg->d_x[hi];
-                    _y = this->hg->d_y[hi];
-                    // Use the linear scaled copy of the data, dcopy.
-                    datumC   = this->dcopy[hi]; // '_z'
-                    datumNE  = HAS_NE(hi)  ? this->dcopy[NE(hi)]  : datumC; // datum Neighbour East
-                    datumNNE = HAS_NNE(hi) ? this->dcopy[NNE(hi)] : datumC; // datum Neighbour North East
-                    datumNNW = HAS_NNW(hi) ? this->dcopy[NNW(hi)] : datumC; // etc
-                    datumNW  = HAS_NW(hi)  ? this->dcopy[NW(hi)]  : datumC;
-                    datumNSW = HAS_NSW(hi) ? this->dcopy[NSW(hi)] : datumC;
-                    datumNSE = HAS_NSE(hi) ? this->dcopy[NSE(hi)] : datumC;
-                } else {
-                    // Get coordinates from dataCoords
-                    _x = (*this->dataCoords)[hi][0];
-                    _y = (*this->dataCoords)[hi][1];
-                    datumC = (*this->dataCoords)[hi][2];
-                    coordC = (*this->dataCoords)[hi];
-
-                    coordNE  = HAS_NE(hi)  ? (*this->dataCoords)[NE(hi)]  : (*this->dataCoords)[hi]; // datum Neighbour East
-                    coordNNE = HAS_NNE(hi) ? (*this->dataCoords)[NNE(hi)] : (*this->dataCoords)[hi]; // datum Neighbour North East
-                    coordNNW = HAS_NNW(hi) ? (*this->dataCoords)[NNW(hi)] : (*this->dataCoords)[hi]; // etc
-                    coordNW  = HAS_NW(hi)  ? (*this->dataCoords)[NW(hi)]  : (*this->dataCoords)[hi];
-                    coordNSW = HAS_NSW(hi) ? (*this->dataCoords)[NSW(hi)] : (*this->dataCoords)[hi];
-                    coordNSE = HAS_NSE(hi) ? (*this->dataCoords)[NSE(hi)] : (*this->dataCoords)[hi];
-
-                    datumNE = coordNE[2];
-                    datumNNE = coordNNE[2];
-                    datumNNW = coordNNW[2];
-                    datumNW = coordNW[2];
-                    datumNSW = coordNSW[2];
-                    datumNSE = coordNSE[2];
-                }
-
-                // Use a single colour for each hex, even though hex z positions are
-                // interpolated. Do the _colour_ scaling:
-                std::array<float, 3> clr = this->setColour (hi);
+                float _x = this->dataCoords == nullptr ? this->hex_blocks[hi].x : (*this->dataCoords)[hi][0];
+                float _y = this->dataCoords == nullptr ? this->hex_blocks[hi].y : (*this->dataCoords)[hi][1];
                 if (this->showboundary && (this->hg->vhexen[hi])->boundaryHex() == true) {
                     this->markHex (hi);
                 }
                 if (this->showcentre && _x == 0.0f && _y == 0.0f) {
                     this->markHex (hi);
                 }
-                std::array<float, 3> blkclr = {0,0,0};
-
-                // First push the 7 positions of the triangle vertices, starting with the centre
-
-                // Use the centre position as the first location for finding the normal vector
-                vtx_0 = this->dataCoords == nullptr ? sm::vec<float>{ _x, _y, datumC } : coordC;
-                this->vertex_push (this->zoom * vtx_0, this->vertexPositions);
-
-                // NE vertex
-                if (this->dataCoords == nullptr) {
-                    if (HAS_NNE(hi) && HAS_NE(hi)) {
-                        // Compute mean of this->data[hi] and NE and E hexes
-                        datum = third * (datumC + datumNNE + datumNE);
-                    } else if (HAS_NNE(hi) || HAS_NE(hi)) {
-                        if (HAS_NNE(hi)) {
-                            datum = half * (datumC + datumNNE);
-                        } else {
-                            datum = half * (datumC + datumNE);
-                        }
-                    } else {
-                        datum = datumC;
-                    }
-                    vtx_1 = { (_x+sr), (_y+vne), datum };
-                } else {
-                    // Similar logic, but for the coordinate, not just the data value
-                    if (HAS_NNE(hi) && HAS_NE(hi)) {
-                        // Compute mean of coordC and NE and E hexes
-                        vtx_1 = third * (coordC + coordNNE + coordNE);
-                    } else if (HAS_NNE(hi) || HAS_NE(hi)) {
-                        if (HAS_NNE(hi)) {
-                            vtx_1 = half * (coordC + coordNNE);
-                        } else {
-                            vtx_1 = half * (coordC + coordNE);
-                        }
-                    } else {
-                        vtx_1 = coordC;
-                    }
-                }
-                this->vertex_push (this->zoom * vtx_1, this->vertexPositions);
-
+            }
 
-                // SE vertex
-                if (this->dataCoords == nullptr) {
-                    if (HAS_NE(hi) && HAS_NSE(hi)) {
-                        datum = third * (datumC + datumNE + datumNSE);
-                    } else if (HAS_NE(hi) || HAS_NSE(hi)) {
-                        if (HAS_NE(hi)) {
-                            datum = half * (datumC + datumNE);
-                        } else {
-                            datum = half * (datumC + datumNSE);
-                        }
-                    } else {
-                        datum = datumC;
-                    }
-                    vtx_2 = { (_x+sr), (_y-vne), datum };
+            // Each hex has a block of 7 vertices and 18 indices, so the containers are sized up front
+            // and each hex writes its block at a known offset. This lets the hexes be computed in
+            // parallel (with OpenMP), giving the same result as a serial loop.
+            // With a mask, only the kept hexes have blocks, block e being that of hex mask.element (e)
+            const unsigned int n_kept = static_cast<unsigned int>(this->mask.count (nhex));
+            const std::size_t vp0 = update ? 0u : this->vertexPositions.size();
+            const std::size_t vn0 = update ? 0u : this->vertexNormals.size();
+            const std::size_t vc0 = update ? 0u : (this->colour_by_element ? this->vertexDatums.size() : this->vertexColors.size());
+            const std::size_t i0 = this->indices.size();
+            const GLuint idx0 = this->idx;
+            if (update == false) {
+                this->vertexPositions.resize (vp0 + 21u * n_kept);
+                this->vertexNormals.resize (vn0 + 21u * n_kept);
+                if (this->colour_by_element) {
+                    this->vertexDatums.resize (vc0 + 7u * n_kept);
                 } else {
-                    if (HAS_NE(hi) && HAS_NSE(hi)) {
-                        vtx_2 = third * (coordC + coordNE + coordNSE);
-                    } else if (HAS_NE(hi) || HAS_NSE(hi)) {
-                        if (HAS_NE(hi)) {
-                            vtx_2 = half * (coordC + coordNE);
-                        } else {
-                            vtx_2 = half * (coordC + coordNSE);
-                        }
-                    } else {
-                        vtx_2 = coordC;
-                    }
+                    this->vertexColors.resize (vc0 + 21u * n_kept);
                 }
-                this->vertex_push (this->zoom * vtx_2, this->vertexPositions);
+                this->indices.resize (i0 + 18u * n_kept);
+            }
 
+            // Write a 3D vertex at p and advance p
+            auto put3 = [](float*& p, const auto& v) { p[0] = v[0]; p[1] = v[1]; p[2] = v[2]; p += 3; };
 
-                // S
-                if (this->dataCoords == nullptr) {
-                    if (HAS_NSE(hi) && HAS_NSW(hi)) {
-                        datum = third * (datumC + datumNSE + datumNSW);
-                    } else if (HAS_NSE(hi) || HAS_NSW(hi)) {
-                        if (HAS_NSE(hi)) {
-                            datum = half * (datumC + datumNSE);
-                        } else {
-                            datum = half * (datumC + datumNSW);
-                        }
-                    } else {
-                        datum = datumC;
-                    }
-                    vtx_tmp = { _x, (_y-lr), datum };
-                } else {
-                    if (HAS_NSE(hi) && HAS_NSW(hi)) {
-                        vtx_tmp = third * (coordC + coordNSE + coordNSW);
-                    } else if (HAS_NSE(hi) || HAS_NSW(hi)) {
-                        if (HAS_NSE(hi)) {
-                            vtx_tmp = half * (coordC + coordNSE);
-                        } else {
-                            vtx_tmp = half * (coordC + coordNSW);
-                        }
-                    } else {
-                        vtx_tmp = coordC;
-                    }
-                }
-                this->vertex_push (this->zoom * vtx_tmp, this->vertexPositions);
+            // The corners, NE, SE, S, SW, NW and N, relative to the centre of a hex
+            const std::array<sm::vec<float, 2>, 6> corner_xy = {
+                sm::vec<float, 2>{ sr, vne }, sm::vec<float, 2>{ sr, -vne }, sm::vec<float, 2>{ 0.0f, -lr },
+                sm::vec<float, 2>{ -sr, -vne }, sm::vec<float, 2>{ -sr, vne }, sm::vec<float, 2>{ 0.0f, lr }
+            };
+            const hex_block* blocks = this->hex_blocks.data();
 
-                // SW
-                if (this->dataCoords == nullptr) {
-                    if (HAS_NW(hi) && HAS_NSW(hi)) {
-                        datum = third * (datumC + datumNW + datumNSW);
-                    } else if (HAS_NW(hi) || HAS_NSW(hi)) {
-                        if (HAS_NW(hi)) {
-                            datum = half * (datumC + datumNW);
-                        } else {
-                            datum = half * (datumC + datumNSW);
-                        }
-                    } else {
-                        datum = datumC;
-                    }
-                    vtx_tmp = { (_x-sr), (_y-vne), datum };
-                } else {
-                    if (HAS_NW(hi) && HAS_NSW(hi)) {
-                        vtx_tmp = third * (coordC + coordNW + coordNSW);
-                    } else if (HAS_NW(hi) || HAS_NSW(hi)) {
-                        if (HAS_NW(hi)) {
-                            vtx_tmp = half * (coordC + coordNW);
-                        } else {
-                            vtx_tmp = half * (coordC + coordNSW);
-                        }
-                    } else {
-                        vtx_tmp = coordC;
-                    }
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (unsigned int e = 0; e < n_kept; ++e) {
+                const unsigned int hi = static_cast<unsigned int>(this->mask.element (e));
+                // A neighbour that is masked out is treated as the edge of the grid
+                hex_block hb = blocks[hi];
+                if (!this->mask.empty()) {
+                    for (int& n : hb.nb) { if (n != -1 && !this->mask.keeps (static_cast<std::size_t>(n))) { n = -1; } }
                 }
-                this->vertex_push (this->zoom * vtx_tmp, this->vertexPositions);
-
-                // NW
+                float* vp = this->vertexPositions.data() + vp0 + 21u * e;
+                float* vn = this->vertexNormals.data() + vn0 + 21u * e;
+                GLuint* ip = update ? nullptr : this->indices.data() + i0 + 18u * e;
+                const GLuint vi = idx0 + 7u * e;
+
+                // The centre, then the 6 corners. Each corner is the mean of the hexes that meet
+                // there (see hex_corner), in z or, with dataCoords, in all three coordinates.
+                std::array<sm::vec<float>, 7> vtx;
                 if (this->dataCoords == nullptr) {
-                    if (HAS_NNW(hi) && HAS_NW(hi)) {
-                        datum = third * (datumC + datumNNW + datumNW);
-                    } else if (HAS_NNW(hi) || HAS_NW(hi)) {
-                        if (HAS_NNW(hi)) {
-                            datum = half * (datumC + datumNNW);
-                        } else {
-                            datum = half * (datumC + datumNW);
-                        }
-                    } else {
-                        datum = datumC;
+                    // Use the linear scaled copy of the data, dcopy.
+                    const float datumC = this->dcopy[hi];
+                    std::array<float, 6> datumN; // The neighbours' data, in the order of hex_block::nb
+                    for (unsigned int k = 0; k < 6u; ++k) { datumN[k] = hb.nb[k] == -1 ? datumC : this->dcopy[hb.nb[k]]; }
+                    vtx[0] = { hb.x, hb.y, datumC };
+                    for (unsigned int j = 0; j < 6u; ++j) {
+                        const unsigned int na = hex_corner_nb[j][0];
+                        const unsigned int nb = hex_corner_nb[j][1];
+                        const float datum = hex_corner (datumC, datumN[na], datumN[nb], hb.nb[na] != -1, hb.nb[nb] != -1);
+                        vtx[j + 1] = { hb.x + corner_xy[j][0], hb.y + corner_xy[j][1], datum };
                     }
-                    vtx_tmp = { (_x-sr), (_y+vne), datum };
                 } else {
-                    if (HAS_NNW(hi) && HAS_NW(hi)) {
-                        vtx_tmp = third * (coordC + coordNNW + coordNW);
-                    } else if (HAS_NNW(hi) || HAS_NW(hi)) {
-                        if (HAS_NNW(hi)) {
-                            vtx_tmp = half * (coordC + coordNNW);
-                        } else {
-                            vtx_tmp = half * (coordC + coordNW);
-                        }
-                    } else {
-                        vtx_tmp = coordC;
+                    // Get coordinates from dataCoords
+                    const sm::vec<float> coordC = (*this->dataCoords)[hi];
+                    std::array<sm::vec<float>, 6> coordN;
+                    for (unsigned int k = 0; k < 6u; ++k) { coordN[k] = hb.nb[k] == -1 ? coordC : (*this->dataCoords)[hb.nb[k]]; }
+                    vtx[0] = coordC;
+                    for (unsigned int j = 0; j < 6u; ++j) {
+                        const unsigned int na = hex_corner_nb[j][0];
+                        const unsigned int nb = hex_corner_nb[j][1];
+                        vtx[j + 1] = hex_corner (coordC, coordN[na], coordN[nb], hb.nb[na] != -1, hb.nb[nb] != -1);
                     }
                 }
-                this->vertex_push (this->zoom * vtx_tmp, this->vertexPositions);
+                for (const sm::vec<float>& v : vtx) { put3 (vp, this->zoom * v); }
 
-                // N
-                if (this->dataCoords == nullptr) {
-                    if (HAS_NNW(hi) && HAS_NNE(hi)) {
-                        datum = third * (datumC + datumNNW + datumNNE);
-                    } else if (HAS_NNW(hi) || HAS_NNE(hi)) {
-                        if (HAS_NNW(hi)) {
-                            datum = half * (datumC + datumNNW);
-                        } else {
-                            datum = half * (datumC + datumNNE);
-                        }
-                    } else {
-                        datum = datumC;
-                    }
-                    vtx_tmp = { _x, (_y+lr), datum };
-                } else {
-                    if (HAS_NNW(hi) && HAS_NNE(hi)) {
-                        vtx_tmp = third * (coordC + coordNNW + coordNNE);
-                    } else if (HAS_NNW(hi) || HAS_NNE(hi)) {
-                        if (HAS_NNW(hi)) {
-                            vtx_tmp = half * (coordC + coordNNW);
-                        } else {
-                            vtx_tmp = half * (coordC + coordNNE);
-                        }
-                    } else {
-                        vtx_tmp = coordC;
-                    }
-                }
-                this->vertex_push (this->zoom * vtx_tmp, this->vertexPositions);
+                // Use a single colour for each hex, even though hex z positions are
+                // interpolated. Do the _colour_ scaling:
+                std::array<float, 3> clr = this->setColour (hi);
+                std::array<float, 3> blkclr = {0,0,0};
 
-                // From vtx_0,1,2 compute normal. This sets the correct normal, but note
+                // From vtx[0], vtx[1] and vtx[2] compute the normal. This sets the correct normal, but note
                 // that there is only one 'layer' of vertices; the back of the
                 // HexGridVisual will be coloured the same as the front. To get lighting
                 // effects to look really good, the back of the surface could need the
                 // opposite normal.
-                sm::vec<float> plane1 = vtx_1 - vtx_0;
-                sm::vec<float> plane2 = vtx_2 - vtx_0;
+                sm::vec<float> plane1 = vtx[1] - vtx[0];
+                sm::vec<float> plane2 = vtx[2] - vtx[0];
                 sm::vec<float> vnorm = plane2.cross (plane1);
                 vnorm.renormalize();
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
+                put3 (vn, vnorm);
+                put3 (vn, vnorm);
+                put3 (vn, vnorm);
+                put3 (vn, vnorm);
+                put3 (vn, vnorm);
+                put3 (vn, vnorm);
+                put3 (vn, vnorm);
 
                 // Usually seven vertices with the same colour, but if the hex is
                 // marked, then three of the vertices are given the colour black,
                 // marking the hex out visually.
-                if (std::isnan(this->dcolour[hi])) {
-                    this->vertex_push (clr, this->vertexColors);
-                    this->vertex_push (blkclr, this->vertexColors);
-                    this->vertex_push (blkclr, this->vertexColors);
-                    this->vertex_push (blkclr, this->vertexColors);
-                    this->vertex_push (blkclr, this->vertexColors);
-                    this->vertex_push (blkclr, this->vertexColors);
-                    this->vertex_push (blkclr, this->vertexColors);
+                float* vc = this->colour_by_element ? nullptr : this->vertexColors.data() + vc0 + 21u * e;
+                if (this->colour_by_element) {
+                    std::fill_n (this->vertexDatums.begin() + vc0 + 7u * e, 7, static_cast<float>(hi));
+                } else if (std::isnan(this->dcolour[hi])) {
+                    put3 (vc, clr);
+                    put3 (vc, blkclr);
+                    put3 (vc, blkclr);
+                    put3 (vc, blkclr);
+                    put3 (vc, blkclr);
+                    put3 (vc, blkclr);
+                    put3 (vc, blkclr);
                 } else {
-                    this->vertex_push (clr, this->vertexColors);
+                    put3 (vc, clr);
                     if (this->markedHexes.count(hi)) {
-                        this->vertex_push (blkclr, this->vertexColors);
+                        put3 (vc, blkclr);
                     } else {
-                        this->vertex_push (clr, this->vertexColors);
+                        put3 (vc, clr);
                     }
 
-                    this->vertex_push (clr, this->vertexColors);
+                    put3 (vc, clr);
 
                     if (this->markedHexes.count(hi)) {
-                        this->vertex_push (blkclr, this->vertexColors);
+                        put3 (vc, blkclr);
                     } else {
-                        this->vertex_push (clr, this->vertexColors);
+                        put3 (vc, clr);
                     }
-                    this->vertex_push (clr, this->vertexColors);
+                    put3 (vc, clr);
                     if (this->markedHexes.count(hi)) {
-                        this->vertex_push (blkclr, this->vertexColors);
+                        put3 (vc, blkclr);
                     } else {
-                        this->vertex_push (clr, this->vertexColors);
+                        put3 (vc, clr);
                     }
-                    this->vertex_push (clr, this->vertexColors);
+                    put3 (vc, clr);
                 }
 
-                // Define indices now to produce the 6 triangles in the hex
-                this->indices.push_back (this->idx+1);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+2);
+                // Define indices now to produce the 6 triangles in the hex (the same on update)
+                if (update == false) {
+                    *ip++ = vi + 1;
+                    *ip++ = vi;
+                    *ip++ = vi + 2;
 
-                this->indices.push_back (this->idx+2);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+3);
+                    *ip++ = vi + 2;
+                    *ip++ = vi;
+                    *ip++ = vi + 3;
 
-                this->indices.push_back (this->idx+3);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+4);
+                    *ip++ = vi + 3;
+                    *ip++ = vi;
+                    *ip++ = vi + 4;
 
-                this->indices.push_back (this->idx+4);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+5);
+                    *ip++ = vi + 4;
+                    *ip++ = vi;
+                    *ip++ = vi + 5;
 
-                this->indices.push_back (this->idx+5);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+6);
-
-                this->indices.push_back (this->idx+6);
-                this->indices.push_back (this->idx);
-                this->indices.push_back (this->idx+1);
+                    *ip++ = vi + 5;
+                    *ip++ = vi;
+                    *ip++ = vi + 6;
 
-                this->idx += 7; // 7 vertices (each of 3 floats for x/y/z), 18 indices.
+                    *ip++ = vi + 6;
+                    *ip++ = vi;
+                    *ip++ = vi + 1;
+                }
             }
+            if (update == false) { this->idx += 7u * n_kept; } // 7 vertices (each of 3 floats for x/y/z), 18 indices per hex
+
+            // In colour_by_element mode, the vertices hold hex indices and the data go into the texture
+            if (this->colour_by_element) { this->set_element_datums (this->dcolour); }
         }
 
         // Show a Flat surface for the zero plane. Currently, this is expensively
@@ -1073,6 +1041,70 @@ namespace mplot {
         //! The hexgrid to visualize. This is not expected to change (update methods may
         //! assume the hexgrid has remained unaltered)
         const sm::hexgrid* hg;
+
+        /*!
+         * The position and the neighbours of one hex, gathered from the hexgrid's d_x, d_y and
+         * six neighbour vectors, so that the vertex loops read one block per hex, in order,
+         * rather than eight separate arrays. 32 bytes, so two hexes share a cache line.
+         */
+        struct hex_block
+        {
+            //! The indices of the neighbours (-1 for none), in the order NE, NNE, NNW, NW, NSW, NSE
+            std::array<int, 6> nb = { -1, -1, -1, -1, -1, -1 };
+            float x = 0.0f;
+            float y = 0.0f;
+        };
+        static_assert (sizeof (hex_block) == 32u, "hex_block should be 32 bytes");
+
+        //! Indices into hex_block::nb
+        static constexpr unsigned int hex_ne = 0;
+        static constexpr unsigned int hex_nne = 1;
+        static constexpr unsigned int hex_nnw = 2;
+        static constexpr unsigned int hex_nw = 3;
+        static constexpr unsigned int hex_nsw = 4;
+        static constexpr unsigned int hex_nse = 5;
+
+        //! The two neighbours (as indices into hex_block::nb) that meet at each of the NE, SE,
+        //! S, SW, NW and N corners of a hex
+        static constexpr std::array<std::array<unsigned int, 2>, 6> hex_corner_nb = {{
+            { hex_nne, hex_ne }, { hex_ne, hex_nse }, { hex_nse, hex_nsw },
+            { hex_nw, hex_nsw }, { hex_nnw, hex_nw }, { hex_nnw, hex_nne }
+        }};
+
+        //! One block per hex of hg, built once (by build_hex_blocks)
+        std::vector<hex_block> hex_blocks;
+
+        //! Build hex_blocks from hg, unless they have already been built
+        void build_hex_blocks()
+        {
+            const std::size_t nhex = this->hg->num();
+            if (this->hex_blocks.size() == nhex) { return; }
+            this->hex_blocks.resize (nhex);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (std::size_t hi = 0; hi < nhex; ++hi) {
+                hex_block& hb = this->hex_blocks[hi];
+                hb.nb = { this->hg->d_ne[hi], this->hg->d_nne[hi], this->hg->d_nnw[hi],
+                          this->hg->d_nw[hi], this->hg->d_nsw[hi], this->hg->d_nse[hi] };
+                hb.x = this->hg->d_x[hi];
+                hb.y = this->hg->d_y[hi];
+            }
+        }
+
+        /*!
+         * The value at a corner of a hex whose own value is c and whose neighbours meeting at
+         * the corner have values a and b (if has_a and has_b): the mean of c and those
+         * neighbours that exist.
+         */
+        template <typename V>
+        static V hex_corner (const V& c, const V& a, const V& b, const bool has_a, const bool has_b)
+        {
+            if (has_a && has_b) { return 0.3333333f * (c + a + b); }
+            if (has_a) { return 0.5f * (c + a); }
+            if (has_b) { return 0.5f * (c + b); }
+            return c;
+        }
     };
 
 } // namespace mplot
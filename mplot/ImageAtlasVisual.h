@@ -0,0 +1,199 @@
+/*!
+ * \file
+ *
+ * A VisualModel that shows many small single channel images of one size (the numerals of the
+ * MNIST database, say, or the thumbnails of a dataset) as a grid of flat quads.
+ *
+ * The pixels of all the images are packed into one atlas, a datum texture of about equal width
+ * and height, and each image is drawn as a quad whose corners hold the texture coordinates of
+ * its tile (see VisualModelBase::colour_by_datum_texture). The fragment shader samples the datum
+ * and colour maps it through the colour lookup texture. 10000 images of 28x28 pixels are then
+ * 40000 vertices, one draw call and one texture upload, where a GridVisual per image would need
+ * millions of vertices.
+ */
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+#include <sm/vec>
+#include <mplot/VisualDataModel.h>
+
+namespace mplot {
+
+    template <typename T, int glver = mplot::gl::version_4_1>
+    struct ImageAtlasVisual : public VisualDataModel<T, glver>
+    {
+        //! Construct with the model offset and the width and height of each image, in pixels
+        ImageAtlasVisual (const sm::vec<float> _offset, const std::array<unsigned int, 2> _image_dims)
+        {
+            this->mv_offset = _offset;
+            this->viewmatrix.translate (this->mv_offset);
+            this->image_dims = _image_dims;
+            this->colourScale.do_autoscale = true;
+            this->colour_by_datum_texture = true;
+            // Like graphs, image grids don't rotate by default
+            this->twodimensional = true;
+        }
+
+        //! The number of pixels in each image
+        std::size_t pixels_per_image() const { return std::size_t{this->image_dims[0]} * this->image_dims[1]; }
+
+        //! The number of images
+        std::size_t n_images() const
+        {
+            const std::size_t npix = this->pixels_per_image();
+            return npix == 0 ? 0 : this->image_data.size() / npix;
+        }
+
+        //! Set the pixels of all the images, one image after another, each in rows from its top
+        //! row (or bottom row; see bottom_row_first)
+        void setImages (const std::vector<T>& pixels)
+        {
+            const std::size_t npix = this->pixels_per_image();
+            if (npix == 0 || pixels.size() % npix != 0) {
+                throw std::runtime_error ("ImageAtlasVisual::setImages: the pixels must be a whole number of images");
+            }
+            this->image_data = pixels;
+        }
+
+        //! Append one image (in rows, like those of setImages)
+        void addImage (const std::vector<T>& pixels)
+        {
+            if (pixels.size() != this->pixels_per_image()) {
+                throw std::runtime_error ("ImageAtlasVisual::addImage: the image has the wrong number of pixels");
+            }
+            this->image_data.insert (this->image_data.end(), pixels.begin(), pixels.end());
+        }
+
+        /*!
+         * Replace the pixels of image i. After finalize(), only its tile of the atlas changes, and
+         * only that tile is uploaded before the next render. The image is colour scaled with the scaling found
+         * for the whole set.
+         */
+        void updateImage (const std::size_t i, const std::vector<T>& pixels)
+        {
+            const std::size_t npix = this->pixels_per_image();
+            if (i >= this->n_images() || pixels.size() != npix) {
+                throw std::runtime_error ("ImageAtlasVisual::updateImage: no such image, or the wrong number of pixels");
+            }
+            std::copy (pixels.begin(), pixels.end(), this->image_data.begin() + i * npix);
+            if (this->datum_texture.empty()) { return; } // Not built yet
+            this->write_tile (i);
+            // Upload only the image's tile
+            const unsigned int x0 = static_cast<unsigned int>(i % this->atlas_columns) * this->image_dims[0];
+            const unsigned int y0 = static_cast<unsigned int>(i / this->atlas_columns) * this->image_dims[1];
+            this->reinit_datum_texture (x0, y0, x0 + this->image_dims[0], y0 + this->image_dims[1]);
+            this->scene_changed();
+        }
+
+        //! Colour scale all the images again and replace the atlas (after a change of colourScale)
+        void reinitColours()
+        {
+            if (this->colourScale.do_autoscale == true) { this->colourScale.reset(); }
+            this->fill_atlas();
+            this->reinit_datum_texture();
+            this->scene_changed();
+        }
+
+        //! Lay out one quad for each image, columns to a row, and pack the images into the atlas
+        void initializeVertices()
+        {
+            const std::size_t n = this->n_images();
+            if (n == 0 || this->columns == 0) { return; }
+
+            // Tiles of the atlas, packed in rows of atlas_columns so that it is about square
+            const float aspect = static_cast<float>(this->image_dims[1]) / static_cast<float>(this->image_dims[0]);
+            this->atlas_columns = std::max (1u, static_cast<unsigned int>(std::ceil (std::sqrt (static_cast<float>(n) * aspect))));
+            const unsigned int atlas_rows = static_cast<unsigned int>((n + this->atlas_columns - 1) / this->atlas_columns);
+            this->datum_texture_dims = { this->atlas_columns * this->image_dims[0], atlas_rows * this->image_dims[1] };
+            if (this->colour_lut.empty()) { this->bake_colour_lut(); }
+            if (this->colourScale.do_autoscale == true) { this->colourScale.reset(); }
+            this->fill_atlas();
+            this->reinit_datum_texture();
+
+            const float aw = static_cast<float>(this->datum_texture_dims[0]);
+            const float ah = static_cast<float>(this->datum_texture_dims[1]);
+            const float ix = static_cast<float>(this->image_dims[0]);
+            const float iy = static_cast<float>(this->image_dims[1]);
+            this->idx = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                // The image's place in the grid (row 0 at the top) and its tile in the atlas
+                const float x = static_cast<float>(i % this->columns) * (this->image_size[0] + this->gap);
+                const float y = -static_cast<float>(i / this->columns) * (this->image_size[1] + this->gap);
+                const float u0 = static_cast<float>(i % this->atlas_columns) * ix / aw;
+                const float v0 = static_cast<float>(i / this->atlas_columns) * iy / ah;
+                const float u1 = u0 + ix / aw;
+                const float v1 = v0 + iy / ah;
+                // The vertex colours hold the texture coordinates (of the first texture row at
+                // the top of the quad, unless bottom_row_first)
+                const float vtop = this->bottom_row_first ? v1 : v0;
+                const float vbot = this->bottom_row_first ? v0 : v1;
+                auto corner = [this](const float px, const float py, const float u, const float v)
+                {
+                    this->vertex_push (px, py, 0.0f, this->vertexPositions);
+                    this->vertex_push (0.0f, 0.0f, 1.0f, this->vertexNormals);
+                    this->vertex_push (u, v, 0.0f, this->vertexColors);
+                };
+                corner (x, y - this->image_size[1], u0, vbot);
+                corner (x + this->image_size[0], y - this->image_size[1], u1, vbot);
+                corner (x + this->image_size[0], y, u1, vtop);
+                corner (x, y, u0, vtop);
+                this->indices.insert (this->indices.end(), { this->idx, this->idx + 1, this->idx + 2,
+                                                              this->idx, this->idx + 2, this->idx + 3 });
+                this->idx += 4;
+            }
+        }
+
+        //! The width and height of each image, in pixels
+        std::array<unsigned int, 2> image_dims = { 0u, 0u };
+        //! The width and height of each image in the scene
+        sm::vec<float, 2> image_size = { 0.1f, 0.1f };
+        //! The space between neighbouring images in the scene
+        float gap = 0.01f;
+        //! The number of images in each row of the grid
+        unsigned int columns = 100;
+        //! If true, the pixels of each image are in rows from its bottom row (as mplot::Mnist gives them)
+        bool bottom_row_first = false;
+
+    protected:
+        //! The pixels of the images, one after another
+        std::vector<T> image_data;
+        //! The number of tiles in each row of the atlas
+        unsigned int atlas_columns = 1;
+
+        //! Colour scale all the images into the atlas (autoscaling, if it is to, to the whole set)
+        void fill_atlas()
+        {
+            std::vector<float> scaled (this->image_data.size());
+            this->colourScale.transform (this->image_data, scaled);
+            this->datum_texture.assign (std::size_t{this->datum_texture_dims[0]} * this->datum_texture_dims[1], 0.0f);
+            for (std::size_t i = 0; i < this->n_images(); ++i) { this->write_tile (i, scaled.data() + i * this->pixels_per_image()); }
+        }
+
+        //! Write the colour scaled pixels s of image i into its tile of the atlas
+        void write_tile (const std::size_t i, const float* s)
+        {
+            const std::size_t aw = this->datum_texture_dims[0];
+            const std::size_t x0 = (i % this->atlas_columns) * this->image_dims[0];
+            const std::size_t y0 = (i / this->atlas_columns) * this->image_dims[1];
+            for (std::size_t r = 0; r < this->image_dims[1]; ++r) {
+                std::copy_n (s + r * this->image_dims[0], this->image_dims[0], this->datum_texture.begin() + (y0 + r) * aw + x0);
+            }
+        }
+
+        //! Colour scale image i with the current scaling and write it into its tile of the atlas
+        void write_tile (const std::size_t i)
+        {
+            const std::size_t npix = this->pixels_per_image();
+            std::vector<float> scaled (npix);
+            for (std::size_t p = 0; p < npix; ++p) { scaled[p] = this->colourScale.transform_one (this->image_data[i * npix + p]); }
+            this->write_tile (i, scaled.data());
+        }
+    };
+
+} // namespace mplot
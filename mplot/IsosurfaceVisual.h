@@ -0,0 +1,135 @@
+/*!
+ * \file
+ *
+ * A VisualModel to show the isosurface of a 3D scalar field, such as the state of a 3D
+ * simulation: the surface on which the field takes a given level, extracted on several CPU
+ * threads by mplot::isosurface::extract (for a field that lives on the GPU, see
+ * mplot/gl/isosurface_kernels.h).
+ *
+ * The triangles are written straight into the model's vertex vectors, which are kept as an arena
+ * from one level (or one frame of data) to the next. While the surface fits in the arena, only
+ * its triangles are re-uploaded, with BufferSubData into the existing buffers, and a draw span
+ * draws just those; the arena grows (with room to spare) only when the surface outgrows it.
+ *
+ * \author Seb James
+ * \date 2026
+ */
+#pragma once
+
+#include <array>
+#include <span>
+#include <numeric>
+#include <stdexcept>
+#include <sm/vec>
+#include <sm/vvec>
+#include <mplot/colour.h>
+#include <mplot/isosurface.h>
+#include <mplot/VisualDataModel.h>
+
+namespace mplot {
+
+    /*!
+     * The template argument T is the type of the data which this IsosurfaceVisual will
+     * visualize. Because initializeVertices() sets draw_spans, an IsosurfaceVisual must be
+     * finalized with finalize(), not finalize_async().
+     */
+    template <typename T, int glver = mplot::gl::version_4_1>
+    struct IsosurfaceVisual : public VisualDataModel<T, glver>
+    {
+        IsosurfaceVisual (const sm::vec<float> _offset)
+        {
+            this->mv_offset = _offset;
+            this->viewmatrix.translate (this->mv_offset);
+        }
+
+        //! Show the surface of data, a volume of dims[0] * dims[1] * dims[2] values in which x
+        //! varies fastest, then y, then z. data must outlive the model (as for setScalarData).
+        void setVolume (const sm::vvec<T>* data, const std::array<unsigned int, 3>& _dims)
+        {
+            this->setScalarData (data);
+            this->dims = _dims;
+        }
+
+        /*!
+         * Change the level of the surface and re-extract it. Unlike reinit(), this keeps the
+         * vertex arena, so if the new surface fits, nothing is allocated on the CPU or the GPU.
+         * Call update() in the same way after changing the data.
+         */
+        void setLevel (const float l)
+        {
+            this->level = l;
+            this->update();
+        }
+
+        //! Re-extract the surface into the arena and upload only its triangles
+        void update()
+        {
+            this->wait_for_build();
+            ++this->stats.reinits;
+            if (this->setContext != nullptr) { this->setContext (this->parentVis); }
+            this->initializeVertices();
+            this->reinit_buffers();
+        }
+
+        //! The size of the volume in voxels
+        std::array<unsigned int, 3> dims = { 0u, 0u, 0u };
+
+        //! The spacing of the values in model units. The volume is centred on the model's origin.
+        sm::vec<float> voxel_size = { 1.0f, 1.0f, 1.0f };
+
+        //! The level of the surface, in the units of the data
+        float level = 0.0f;
+
+        //! The colour of the surface
+        std::array<float, 3> colour = mplot::colour::royalblue;
+
+        //! The threads on which to extract the surface (0 for one per hardware thread)
+        unsigned int n_threads = 0;
+
+        //! The number of vertices the arena has room for, and the number in the current surface
+        std::size_t arena_vertices = 0;
+        std::size_t surface_vertices = 0;
+
+        void initializeVertices()
+        {
+            if (this->scalarData == nullptr) { return; }
+            const std::size_t n = std::size_t{this->dims[0]} * this->dims[1] * this->dims[2];
+            if (this->scalarData->size() != n) {
+                throw std::runtime_error ("IsosurfaceVisual: the data must hold dims[0] * dims[1] * dims[2] values");
+            }
+            mplot::isosurface::grid<T> g;
+            g.values = std::span<const T>(this->scalarData->data(), n);
+            g.dims = this->dims;
+            g.spacing = this->voxel_size;
+            for (unsigned int j = 0; j < 3u; ++j) {
+                g.origin[j] = -0.5f * static_cast<float>(this->dims[j] > 0u ? this->dims[j] - 1u : 0u) * this->voxel_size[j];
+            }
+            const std::size_t nv = 3u * mplot::isosurface::extract (g, this->level, this->vertexPositions, this->vertexNormals,
+                                                                     this->n_threads);
+            // Grow the arena with room to spare, so that a surface that grows a little from one
+            // level to the next still fits
+            if (nv > this->arena_vertices) { this->arena_vertices = nv + nv / 4u; }
+            const std::size_t na = this->arena_vertices;
+            this->vertexPositions.resize (3u * na);
+            this->vertexNormals.resize (3u * na);
+            if (this->vertexColors.size() != 3u * na) { this->vertexColors.resize (3u * na); }
+            for (std::size_t i = 0; i < nv; ++i) {
+                for (unsigned int j = 0; j < 3u; ++j) { this->vertexColors[3u * i + j] = this->colour[j]; }
+            }
+            // Each triangle has its own vertices, so the indices count through the arena
+            if (this->indices.size() != na) {
+                this->indices.resize (na);
+                std::iota (this->indices.begin(), this->indices.end(), GLuint{0});
+            }
+            this->idx = static_cast<GLuint>(na);
+            this->surface_vertices = nv;
+
+            this->draw_spans = { { 0u, nv, { 0.0f, 0.0f, 0.0f } } };
+            this->reserve_buffers (na, na);
+            // Only the surface changed. An arena that grew outgrows the buffers, which are then
+            // uploaded in full.
+            this->mark_dirty (0u, nv);
+        }
+    };
+
+} // namespace mplot
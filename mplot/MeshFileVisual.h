@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <sm/vec>
+#include <mplot/glb_file.h>
+#include <mplot/VisualModel.h>
+
+namespace mplot {
+
+    /*!
+     * A VisualModel that draws one mesh from a binary glTF (.glb) file, such as a file written
+     * by Visual::saveglb. The file is memory mapped and the mesh's indices, positions, normals
+     * and colours are uploaded straight from the mapping into the model's vertex buffers, with
+     * no intermediate copies, so even very large precomputed meshes are quick to show. The
+     * model holds the file mapped for as long as it exists; the mapped pages are backed by the
+     * file, so they cost little memory once they have been uploaded.
+     *
+     * \code
+     *   auto mfv = std::make_unique<mplot::MeshFileVisual<>> ("surface.glb");
+     *   v.bindmodel (mfv);
+     *   mfv->finalize();
+     *   v.addVisualModel (mfv);
+     * \endcode
+     */
+    template<int glver = mplot::gl::version_4_1>
+    class MeshFileVisual : public VisualModel<glver>
+    {
+    public:
+        /*!
+         * Draw mesh _mesh_index of the .glb file at _glb_path. The model is placed at the
+         * translation of the mesh's node in the file (where saveglb records each model's
+         * offset), plus _offset.
+         */
+        MeshFileVisual (const std::string& _glb_path, const std::size_t _mesh_index = 0,
+                        const sm::vec<float, 3> _offset = { 0.0f, 0.0f, 0.0f })
+        {
+            this->mesh = mplot::glb_file (_glb_path).mesh (_mesh_index);
+            this->mv_offset = _offset + this->mesh.translation;
+            this->viewmatrix.translate (this->mv_offset);
+        }
+
+        //! There are no vertices to compute; the model draws the mapped mesh
+        void initializeVertices() { this->setMappedMesh (this->mesh); }
+
+    protected:
+        mplot::mapped_mesh mesh;
+    };
+
+} // namespace mplot
@@ -37,15 +37,20 @@
 #include <sstream>
 #include <string>
 #include <map>
+#include <array>
 #include <vector>
 #include <utility>
 #include <tuple>
 #include <stdexcept>
+#include <cstddef>
+#include <cstdint>
 
 #include <sm/random>
 #include <sm/vec>
 #include <sm/vvec>
 
+#include <mplot/mapped_file.h>
+
 namespace mplot {
 
     //! Mnist images are 28x28=784 pixels
@@ -53,6 +58,129 @@ namespace mplot {
 
     enum class fixlabels { yes, no };
 
+    //! Map of MNIST example index number and a pair of numbers that are 'bad
+    //! label', 'good label'. If good label is 255, then that means ambiguous. I
+    //! don't have an equivalent list for the MNIST training data.
+    inline const std::map<int, sm::vec<unsigned char,2>>& mnist_test_relabels()
+    {
+        static const std::map<int, sm::vec<unsigned char,2>> relabels = { // This list relates to test data only.
+            {947,  {8,9}   },
+            {6651, {0,6}   },
+            {2597, {5,3}   },
+            {2462, {2,255} },   // Cleanlab guessed 0, MTurk consensus 0. I think it's fully ambiguous.
+            {3558, {5,0}   },
+            {9729, {5,6}   },
+            {3520, {6,255} },   // Cleanlab guess 4, but I think it looks like a 6 but a really bad 6, so will remove it.
+            {1901, {9,255} },   // Could be 4 or 9 in my opinion.
+            {2654, {6,255} },
+            {1621, {0,255} },   // Cleanlab and MTurk think 6. I think 0 is plausible, but let's omit this one.
+            {6783, {1,255} },   // Cleanlab guessed 6, but I think 1 is plausible.
+            {5937, {5,3}   },   // Cleanlab & MTurk think 3, I agree.
+            {9679, {6,255} } }; // Highly ambiguous
+        return relabels;
+    }
+
+    /*!
+     * One MNIST set (training or test) read from its IDX image and label files without parsing
+     * them pixel by pixel. The image file is memory mapped, and the images are a contiguous n x
+     * 784 tensor of bytes in the file's order (top row first). Rather than a multimap, there is
+     * an array of the image indices for each label.
+     */
+    struct mnist_set
+    {
+        mnist_set (const std::string& img_path, const std::string& lbl_path,
+                   const std::map<int, sm::vec<unsigned char, 2>>* relabels = nullptr)
+            : img_file (img_path)
+        {
+            mapped_file lbl_file (lbl_path);
+            if (this->img_file.size() < 16 || lbl_file.size() < 8) {
+                throw std::runtime_error ("mnist_set: MNIST data files are too short");
+            }
+            const unsigned char* ih = this->img_file.data();
+            const unsigned char* lh = lbl_file.data();
+            if (be32 (ih) != 2051) { throw std::runtime_error ("mnist_set: data, images magic number is wrong"); }
+            if (be32 (lh) != 2049) { throw std::runtime_error ("mnist_set: data, labels magic number is wrong"); }
+            this->n = be32 (ih + 4);
+            if (be32 (lh + 4) != this->n) { throw std::runtime_error ("mnist_set: num labels != num images"); }
+            if (be32 (ih + 8) * be32 (ih + 12) != static_cast<std::uint32_t>(mnlen)) {
+                throw std::runtime_error ("mnist_set: Expecting 28x28 images in Mnist!");
+            }
+            if (this->img_file.size() < 16 + std::size_t{this->n} * mnlen || lbl_file.size() < 8 + std::size_t{this->n}) {
+                throw std::runtime_error ("mnist_set: MNIST data files are truncated");
+            }
+            this->pixels = ih + 16;
+            this->labels.assign (lh + 8, lh + 8 + this->n);
+
+            // Relabel (or, with a good label of 255, omit) the listed examples
+            if (relabels != nullptr) {
+                for (const auto& [id, bad_good] : *relabels) {
+                    if (id < 0 || static_cast<std::uint32_t>(id) >= this->n || this->labels[id] != bad_good[0]) { continue; }
+                    this->labels[id] = bad_good[1];
+                }
+            }
+            for (std::uint32_t i = 0; i < this->n; ++i) {
+                if (this->labels[i] < 10) { this->by_label[this->labels[i]].push_back (i); }
+            }
+        }
+
+        //! The number of images (including any that were omitted from by_label)
+        std::size_t size() const { return this->n; }
+        //! The 784 bytes of image i, top row first
+        const unsigned char* image (const std::size_t i) const { return this->pixels + i * mnlen; }
+        //! The label of image i (255 if the example was omitted by label cleaning)
+        unsigned char label (const std::size_t i) const { return this->labels[i]; }
+
+        /*!
+         * Write image i as floats in [0, 1) into out (which must hold mnlen floats), bottom row
+         * first as mplot::Mnist stores them for display on a grid. Each row is one contiguous
+         * loop, which the compiler vectorizes.
+         */
+        void image_float (const std::size_t i, float* out) const
+        {
+            const unsigned char* in = this->image (i);
+            constexpr int w = 28;
+            constexpr int h = mnlen / w;
+            for (int r = 0; r < h; ++r) {
+                const unsigned char* ir = in + r * w;
+                float* o = out + (h - r - 1) * w;
+                for (int c = 0; c < w; ++c) { o[c] = static_cast<float>(ir[c]) * (1.0f / 256.0f); }
+            }
+        }
+
+        //! Image i as floats, as in Mnist::training_f
+        sm::vvec<float> image_float (const std::size_t i) const
+        {
+            sm::vvec<float> v (mnlen);
+            this->image_float (i, v.data());
+            return v;
+        }
+
+        //! All the images as floats (n x mnlen, in one allocation), converted on the first call
+        const std::vector<float>& float_images() const
+        {
+            if (this->floats.size() != std::size_t{this->n} * mnlen) {
+                this->floats.resize (std::size_t{this->n} * mnlen);
+                for (std::size_t i = 0; i < this->n; ++i) { this->image_float (i, this->floats.data() + i * mnlen); }
+            }
+            return this->floats;
+        }
+
+        //! The indices of the images with each label, in the order in which they appear in the file
+        std::array<std::vector<std::uint32_t>, 10> by_label;
+
+    private:
+        static std::uint32_t be32 (const unsigned char* b)
+        {
+            return std::uint32_t{b[0]} << 24 | std::uint32_t{b[1]} << 16 | std::uint32_t{b[2]} << 8 | std::uint32_t{b[3]};
+        }
+
+        mapped_file img_file;
+        const unsigned char* pixels = nullptr;
+        std::uint32_t n = 0;
+        std::vector<unsigned char> labels;
+        mutable std::vector<float> floats;
+    };
+
     //! A class to read, and then manage the data of, the Mnist database.
     struct Mnist
     {
@@ -77,69 +205,18 @@ namespace mplot {
         void load_data (const std::string& tag,
                         std::multimap<unsigned char, std::pair<int, sm::vvec<float>>>& vecFloats)
         {
-            // Ifstreams for images and labels.
-            std::ifstream img_f;
-            std::ifstream lbl_f;
-
+            // The files are read (mapped) in one go by mnist_set, rather than byte by byte
             std::string img_p = basepath + tag + "-images-idx3-ubyte";
             std::string lbl_p = basepath + tag + "-labels-idx1-ubyte";
-            img_f.open (img_p.c_str(), std::ios::in | std::ios::binary);
-            lbl_f.open (lbl_p.c_str(), std::ios::in | std::ios::binary);
-
-            if (!img_f.is_open() || !lbl_f.is_open()) {
-                std::stringstream ee;
-                ee << "Mnist: File access error opening MNIST data files: "
-                   << img_p << " (images) and " << lbl_p << " (labels)";
-                throw std::runtime_error (ee.str());
-            }
+            mplot::mnist_set ms (img_p, lbl_p);
+            this->nr = 28;
+            this->nc = 28;
 
-            // Process training data magic number, stuff
-            char buf[4];
-            img_f.read (buf, 4);
-            int magic_imgs = chars_to_int (buf);
-            img_f.read (buf, 4);
-            int n_imgs = (buf[3]&0xff) | (buf[2]&0xff)<<8 | (buf[1]&0xff)<<16 | (buf[0]&0xff)<<24;
-            img_f.read (buf, 4);
-            this->nr = (buf[3]&0xff) | (buf[2]&0xff)<<8 | (buf[1]&0xff)<<16 | (buf[0]&0xff)<<24;
-            img_f.read (buf, 4);
-            this->nc = (buf[3]&0xff) | (buf[2]&0xff)<<8 | (buf[1]&0xff)<<16 | (buf[0]&0xff)<<24;
-
-            if (nr * nc != mnlen) { throw std::runtime_error ("Mnist: Expecting 28x28 images in Mnist!"); }
-
-            // Check images magic number
-            if (magic_imgs != 2051) { throw std::runtime_error ("Mnist: data, images magic number is wrong"); }
-
-            // Process labels magic number etc
-            lbl_f.read (buf, 4);
-            int magic_lbls = (buf[3]&0xff) | (buf[2]&0xff)<<8 | (buf[1]&0xff)<<16 | (buf[0]&0xff)<<24;
-            lbl_f.read (buf, 4);
-            int n_lbls = (buf[3]&0xff) | (buf[2]&0xff)<<8 | (buf[1]&0xff)<<16 | (buf[0]&0xff)<<24;
-
-            // Check labels magic number
-            if (magic_lbls != 2049) { throw std::runtime_error ("Mnist: data, labels magic number is wrong"); }
-
-            // Check reported number of images == number of labels
-            if (n_lbls != n_imgs) {
-                throw std::runtime_error ("Mnist: Training data, num labels != num images");
-            }
-
-            // Should now be able to read through each file, pulling in the data.
-            char cbuf[1];
+            const int n_imgs = static_cast<int>(ms.size());
             for (int inum = 0; inum < n_imgs; ++inum) {
-                sm::vvec<float> ar(nr*nc, 0.0f);
-                // Read one label...
-                lbl_f.read (cbuf, 1);
-                unsigned char lbl = static_cast<unsigned char>(cbuf[0]);
-                for (int r = 0; r < this->nr; ++r) {
-                    for (int c = 0; c < this->nc; ++c) {
-                        // Read pixel and stick it in the array
-                        img_f.read (cbuf, 1);
-                        unsigned char uc = static_cast<unsigned char>(cbuf[0]);
-                        float numf = (float)uc/256.0f;
-                        // Fill array as cartgrids are displayed: bottom row first.
-                        ar[(this->nr-r-1)*28+c] = numf;
-                    }
-                }
+                unsigned char lbl = ms.label (inum);
+                // The array is filled as cartgrids are displayed: bottom row first.
+                sm::vvec<float> ar = ms.image_float (inum);
 
                 if (this->apply_label_cleaning == mplot::fixlabels::yes && this->loading_test == true) {
                     // If inum in bad set, then fix lbl here (or ignore example)
@@ -267,22 +344,8 @@ namespace mplot {
         bool loading_test = false;
 
         //! Map of MNIST example index number and a pair of numbers that are 'bad
-        //! label', 'good label'. If good label is 255, then that means ambiguous. I
-        //! don't have an equivalent list for the MNIST training data.
-        std::map<int, sm::vec<unsigned char,2>> badlabels_test = { // This list relates to test data only.
-            {947,  {8,9}   },
-            {6651, {0,6}   },
-            {2597, {5,3}   },
-            {2462, {2,255} },   // Cleanlab guessed 0, MTurk consensus 0. I think it's fully ambiguous.
-            {3558, {5,0}   },
-            {9729, {5,6}   },
-            {3520, {6,255} },   // Cleanlab guess 4, but I think it looks like a 6 but a really bad 6, so will remove it.
-            {1901, {9,255} },   // Could be 4 or 9 in my opinion.
-            {2654, {6,255} },
-            {1621, {0,255} },   // Cleanlab and MTurk think 6. I think 0 is plausible, but let's omit this one.
-            {6783, {1,255} },   // Cleanlab guessed 6, but I think 1 is plausible.
-            {5937, {5,3}   },   // Cleanlab & MTurk think 3, I agree.
-            {9679, {6,255} } }; // Highly ambiguous
+        //! label', 'good label' (see mnist_test_relabels)
+        std::map<int, sm::vec<unsigned char,2>> badlabels_test = mplot::mnist_test_relabels();
 
         //! The training data. The key to this multimap is the label, the value contains
         //! as its first element, the ID of the image (sequential order of appearance in
@@ -294,4 +357,26 @@ namespace mplot {
         std::multimap<unsigned char, std::pair<int, sm::vvec<float>> > test_f;
     };
 
+    /*!
+     * The MNIST training and test sets as mnist_sets: memory mapped, with no per-image
+     * allocations. Use this in place of Mnist when loading time matters:
+     *
+     * \code
+     *   mplot::MnistMapped mn ("mnist/");
+     *   for (auto i : mn.training.by_label[3]) { const unsigned char* img = mn.training.image (i); }
+     * \endcode
+     */
+    struct MnistMapped
+    {
+        MnistMapped (const std::string& path = "mnist/", mplot::fixlabels fl = fixlabels::no)
+            : training (path + "train-images-idx3-ubyte", path + "train-labels-idx1-ubyte")
+            , test (path + "t10k-images-idx3-ubyte", path + "t10k-labels-idx1-ubyte",
+                    fl == fixlabels::yes ? &mplot::mnist_test_relabels() : nullptr) {}
+
+        //! 60000 training examples
+        mplot::mnist_set training;
+        //! 10000 test examples
+        mplot::mnist_set test;
+    };
+
 } // namespace mplot
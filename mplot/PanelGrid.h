@@ -0,0 +1,383 @@
+/*!
+ * \file PanelGrid
+ *
+ * A grid of mplot::GraphVisual panels that is drawn as one VisualModel. The panels' meshes are
+ * merged into the PanelGrid's buffers (so they are drawn with one draw call) and their labels are
+ * gathered into a few text models, one for each font, colour and rotation. Panels can share the
+ * range of their x or y axes; a rescale caused by new data is then propagated to the linked
+ * panels, and only to them.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+#pragma once
+
+#include <array>
+#include <vector>
+#include <string>
+#include <memory>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+#include <cstddef>
+
+#include <sm/vec>
+#include <sm/vvec>
+#include <sm/range>
+#include <sm/quaternion>
+
+#include <mplot/gl/version.h>
+#include <mplot/VisualModel.h>
+#include <mplot/GraphVisual.h>
+#include <mplot/DatasetStyle.h>
+#include <mplot/TextFeatures.h>
+#include <mplot/VisualTextModel.h>
+
+namespace mplot {
+
+    /*!
+     * A VisualModel that lays out cols by rows GraphVisual panels. Configure each panel through
+     * panel() as you would a GraphVisual, but give it its data through PanelGrid::setdata and
+     * PanelGrid::update, so that the PanelGrid can apply linked axis ranges and rebuild only
+     * the panels that change.
+     *
+     * The panels are kept on the CPU (see VisualModel::setHostOnly) and merged from their
+     * triangles, so leave their gpu_lines and gpu_bars unset and don't make them scrolling
+     * graphs.
+     */
+    template <typename Flt, int glver = mplot::gl::version_4_1>
+    class PanelGrid : public VisualModel<glver>
+    {
+    public:
+        PanelGrid (const sm::vec<float> _offset, const unsigned int _cols, const unsigned int _rows)
+            : cols (_cols), rows (_rows)
+        {
+            this->mv_offset = _offset;
+            this->viewmatrix.translate (this->mv_offset);
+            this->twodimensional = true;
+            const std::size_t n = static_cast<std::size_t>(this->cols) * this->rows;
+            this->panels.resize (n);
+            this->datasets.resize (n);
+            this->stale.assign (n, true);
+            this->x_group.assign (n, npos);
+            this->y_group.assign (n, npos);
+            this->vertex_begin.assign (n + 1, 0u);
+            this->index_begin.assign (n + 1, 0u);
+        }
+
+        //! The number of panels, cols * rows
+        std::size_t n_panels() const { return this->panels.size(); }
+
+        /*!
+         * The panel in column c and row r (counting rows down from the top). The panel is
+         * made, with the size panel_width by panel_height, on the first call, so set those
+         * first. The PanelGrid must have been bound to its Visual.
+         */
+        mplot::GraphVisual<Flt, glver>& panel (const unsigned int c, const unsigned int r)
+        {
+            if (c >= this->cols || r >= this->rows) { throw std::runtime_error ("PanelGrid::panel: no such panel"); }
+            return this->panel (static_cast<std::size_t>(r) * this->cols + c);
+        }
+
+        //! The panel with index i, counting along the rows from the top left panel
+        mplot::GraphVisual<Flt, glver>& panel (const std::size_t i)
+        {
+            if (i >= this->panels.size()) { throw std::runtime_error ("PanelGrid::panel: no such panel"); }
+            if (this->panels[i] == nullptr) {
+                // The panel's labels are placed within the PanelGrid, as for its own labels
+                auto p = std::make_unique<mplot::GraphVisual<Flt, glver>> (this->mv_offset + this->panel_offset (i));
+                this->bindmodel (p);
+                p->setHostOnly();
+                p->setsize (this->panel_width, this->panel_height);
+                this->panels[i] = std::move (p);
+                this->stale[i] = true;
+            }
+            return *this->panels[i];
+        }
+
+        //! Add a dataset to panel i. Call before finalize().
+        template <typename Ctnr1, typename Ctnr2>
+        void setdata (const std::size_t i, const Ctnr1& _abscissae, const Ctnr2& _data,
+                      const mplot::DatasetStyle& ds = mplot::DatasetStyle())
+        {
+            this->panel (i);
+            dataset d;
+            d.x.set_from (_abscissae);
+            d.y.set_from (_data);
+            d.style = ds;
+            this->datasets[i].push_back (std::move (d));
+            this->stale[i] = true;
+        }
+
+        /*!
+         * Replace the data of dataset data_idx of panel i. The panel is rebuilt. If the data
+         * change the range of an axis that the panel shares with others (see link_x, link_y),
+         * then the linked panels are rebuilt, too. The other panels are left as they are.
+         */
+        template <typename Ctnr1, typename Ctnr2>
+        void update (const std::size_t i, const Ctnr1& _abscissae, const Ctnr2& _data, const std::size_t data_idx)
+        {
+            if (i >= this->datasets.size() || data_idx >= this->datasets[i].size()) {
+                throw std::runtime_error ("PanelGrid::update: no such dataset");
+            }
+            if (_abscissae.size() != _data.size()) { throw std::runtime_error ("PanelGrid::update: size mismatch"); }
+            this->datasets[i][data_idx].x.set_from (_abscissae);
+            this->datasets[i][data_idx].y.set_from (_data);
+            this->stale[i] = true;
+            this->update_links();
+
+            // Rebuild the stale panels. If their meshes are the same size as before, they are
+            // copied into place and only their part of the buffers is uploaded.
+            bool same_sizes = !this->vertexPositions.empty();
+            for (std::size_t j = 0; j < this->panels.size(); ++j) {
+                if (!this->stale[j] || this->panels[j] == nullptr) { continue; }
+                this->rebuild_panel (j);
+                this->panel_mesh (j, this->vertex_begin[j]);
+                same_sizes = same_sizes
+                && this->mesh_posn.size() / 3u == this->vertex_begin[j + 1] - this->vertex_begin[j]
+                && this->mesh_ind.size() == this->index_begin[j + 1] - this->index_begin[j];
+                if (same_sizes) {
+                    std::copy (this->mesh_posn.begin(), this->mesh_posn.end(), this->vertexPositions.begin() + 3u * this->vertex_begin[j]);
+                    std::copy (this->mesh_norm.begin(), this->mesh_norm.end(), this->vertexNormals.begin() + 3u * this->vertex_begin[j]);
+                    std::copy (this->mesh_col.begin(), this->mesh_col.end(), this->vertexColors.begin() + 3u * this->vertex_begin[j]);
+                    std::copy (this->mesh_ind.begin(), this->mesh_ind.end(), this->indices.begin() + this->index_begin[j]);
+                    this->mark_dirty (this->vertex_begin[j], this->vertex_begin[j + 1]);
+                    this->mark_dirty_indices (this->index_begin[j], this->index_begin[j + 1]);
+                }
+            }
+
+            if (same_sizes) {
+                if (this->setContext != nullptr) { this->setContext (this->parentVis); }
+                this->batch_labels();
+                this->reinit_buffers();
+            } else {
+                // The panels have been rebuilt, so reinit only re-merges them
+                this->reinit();
+            }
+        }
+
+        //! Share the range of the x axis between the panels with the indices in _panels. A
+        //! panel may be in one x group only. Call before finalize().
+        void link_x (const std::vector<std::size_t>& _panels) { this->link (true, _panels); }
+
+        //! Share the range of the y axis (the left hand y axis) between the panels in _panels
+        void link_y (const std::vector<std::size_t>& _panels) { this->link (false, _panels); }
+
+        //! Share the x axis range between the panels of each column
+        void link_columns_x()
+        {
+            for (unsigned int c = 0; c < this->cols; ++c) {
+                std::vector<std::size_t> g;
+                for (unsigned int r = 0; r < this->rows; ++r) { g.push_back (static_cast<std::size_t>(r) * this->cols + c); }
+                this->link_x (g);
+            }
+        }
+
+        //! Share the y axis range between the panels of each row
+        void link_rows_y()
+        {
+            for (unsigned int r = 0; r < this->rows; ++r) {
+                std::vector<std::size_t> g;
+                for (unsigned int c = 0; c < this->cols; ++c) { g.push_back (static_cast<std::size_t>(r) * this->cols + c); }
+                this->link_y (g);
+            }
+        }
+
+        //! Build any stale panels, then merge all the panels' meshes and labels into this model
+        void initializeVertices()
+        {
+            this->update_links();
+            for (std::size_t i = 0; i < this->panels.size(); ++i) {
+                if (this->stale[i] && this->panels[i] != nullptr) { this->rebuild_panel (i); }
+            }
+
+            std::size_t nv = 0;
+            for (std::size_t i = 0; i < this->panels.size(); ++i) {
+                this->vertex_begin[i] = nv;
+                this->index_begin[i] = this->indices.size();
+                if (this->panels[i] == nullptr) { continue; }
+                this->panel_mesh (i, nv);
+                this->vertexPositions.insert (this->vertexPositions.end(), this->mesh_posn.begin(), this->mesh_posn.end());
+                this->vertexNormals.insert (this->vertexNormals.end(), this->mesh_norm.begin(), this->mesh_norm.end());
+                this->vertexColors.insert (this->vertexColors.end(), this->mesh_col.begin(), this->mesh_col.end());
+                this->indices.insert (this->indices.end(), this->mesh_ind.begin(), this->mesh_ind.end());
+                nv = this->vertexPositions.size() / 3u;
+            }
+            this->vertex_begin.back() = nv;
+            this->index_begin.back() = this->indices.size();
+            this->idx = static_cast<GLuint>(nv);
+
+            this->batch_labels();
+        }
+
+        //! The width and height of each panel's axes, in model units. Set before calling panel().
+        float panel_width = 1.0f;
+        float panel_height = 0.8f;
+        //! The horizontal and vertical gaps between the panels' axes, which leave room for labels
+        sm::vec<float, 2> panel_gap = { 0.35f, 0.3f };
+
+    protected:
+        //! A panel's dataset, kept so that the panel can be rebuilt with new axis limits
+        struct dataset
+        {
+            sm::vvec<Flt> x;
+            sm::vvec<Flt> y;
+            mplot::DatasetStyle style;
+        };
+
+        //! The labels that share a font, colour and rotation and so are drawn together
+        struct label_batch
+        {
+            mplot::TextFeatures tf;
+            std::array<float, 3> colour = { 0.0f, 0.0f, 0.0f };
+            sm::quaternion<float> rotation = {};
+            std::vector<std::string> txts;
+            std::vector<sm::vec<float>> offsets;
+        };
+
+        static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+        //! The offset of panel i within the PanelGrid
+        sm::vec<float> panel_offset (const std::size_t i) const
+        {
+            const std::size_t c = i % this->cols;
+            const std::size_t r = i / this->cols;
+            return sm::vec<float>{ static_cast<float>(c) * (this->panel_width + this->panel_gap[0]),
+                                   static_cast<float>(this->rows - 1u - r) * (this->panel_height + this->panel_gap[1]), 0.0f };
+        }
+
+        //! Add a link group of the x (if xaxis) or y axes of _panels
+        void link (const bool xaxis, const std::vector<std::size_t>& _panels)
+        {
+            auto& groups = xaxis ? this->x_groups : this->y_groups;
+            auto& group_of = xaxis ? this->x_group : this->y_group;
+            for (auto i : _panels) {
+                if (i >= group_of.size()) { throw std::runtime_error ("PanelGrid::link: no such panel"); }
+                if (group_of[i] != npos) { throw std::runtime_error ("PanelGrid::link: panel is already linked"); }
+                group_of[i] = groups.size();
+            }
+            groups.push_back (_panels);
+            (xaxis ? this->x_ranges : this->y_ranges).resize (groups.size());
+        }
+
+        //! The range of the data of the panels in group g, in x if xaxis or else in y
+        sm::range<Flt> data_range (const std::vector<std::size_t>& g, const bool xaxis) const
+        {
+            sm::range<Flt> r;
+            r.search_init();
+            for (auto i : g) {
+                for (const auto& d : this->datasets[i]) {
+                    if (!xaxis && d.style.axisside != mplot::axisside::left) { continue; }
+                    for (auto v : (xaxis ? d.x : d.y)) { r.update (v); }
+                }
+            }
+            return r;
+        }
+
+        //! Recompute the shared range of each link group, marking the panels of any group
+        //! whose range has changed as stale
+        void update_links()
+        {
+            for (const bool xaxis : { true, false }) {
+                const auto& groups = xaxis ? this->x_groups : this->y_groups;
+                auto& ranges = xaxis ? this->x_ranges : this->y_ranges;
+                for (std::size_t g = 0; g < groups.size(); ++g) {
+                    sm::range<Flt> r = this->data_range (groups[g], xaxis);
+                    if (r.min > r.max || (r.min == ranges[g].min && r.max == ranges[g].max)) { continue; }
+                    ranges[g] = r;
+                    for (auto i : groups[g]) { this->stale[i] = true; }
+                }
+            }
+        }
+
+        //! Rebuild panel i from its datasets, with the ranges of its link groups
+        void rebuild_panel (const std::size_t i)
+        {
+            mplot::GraphVisual<Flt, glver>& p = *this->panels[i];
+            p.clear_datasets();
+            if (this->x_group[i] != npos) { p.setlimits_x (this->x_ranges[this->x_group[i]]); }
+            if (this->y_group[i] != npos) { p.setlimits_y (this->y_ranges[this->y_group[i]]); }
+            for (const auto& d : this->datasets[i]) { p.setdata (d.x, d.y, d.style); }
+            p.poolTexts(); // The panel reuses its unchanged tick labels
+            p.reinit();
+            this->stale[i] = false;
+        }
+
+        //! Copy the mesh of panel i into mesh_posn etc, placed in the grid, with its indices
+        //! counted from vertex base
+        void panel_mesh (const std::size_t i, const std::size_t base)
+        {
+            this->mesh_posn.clear();
+            this->mesh_norm.clear();
+            this->mesh_col.clear();
+            this->mesh_ind.clear();
+            this->panels[i]->append_to_batch (this->mesh_posn, this->mesh_norm, this->mesh_col, this->mesh_ind);
+            const sm::vec<float> o = this->panel_offset (i);
+            for (std::size_t k = 0; k < this->mesh_posn.size(); k += 3) {
+                this->mesh_posn[k] += o[0];
+                this->mesh_posn[k + 1] += o[1];
+                this->mesh_posn[k + 2] += o[2];
+            }
+            for (auto& ind : this->mesh_ind) { ind += static_cast<GLuint>(base); }
+        }
+
+        //! Gather the labels of all the panels into one text model per font, colour and rotation
+        void batch_labels()
+        {
+            std::vector<label_batch> batches;
+            for (const auto& p : this->panels) {
+                if (p == nullptr) { continue; }
+                for (const auto& t : p->getTexts()) {
+                    if (t->empty()) { continue; }
+                    const mplot::TextFeatures& tf = t->getFeatures();
+                    const sm::quaternion<float>& q = t->getViewRotation();
+                    auto bi = std::find_if (batches.begin(), batches.end(), [&tf, &t, &q](const label_batch& b) {
+                        return b.tf.fontsize == tf.fontsize && b.tf.face_res() == tf.face_res()
+                        && b.tf.font == tf.font && b.tf.sdf == tf.sdf && b.colour == t->clr_text
+                        && b.rotation.w == q.w && b.rotation.x == q.x && b.rotation.y == q.y && b.rotation.z == q.z;
+                    });
+                    if (bi == batches.end()) {
+                        batches.push_back (label_batch{ tf, t->clr_text, q, {}, {} });
+                        bi = batches.end() - 1;
+                    }
+                    bi->txts.push_back (t->getText());
+                    bi->offsets.push_back (t->getViewTranslation());
+                }
+            }
+
+            this->clearTexts();
+            for (const auto& b : batches) {
+                auto tm = this->makeVisualTextModel (b.tf);
+                // As for a single label set up with a rotation, the offsets lie in the rotated frame
+                tm->setViewRotation (b.rotation);
+                tm->setupTexts (b.txts, b.offsets, b.colour);
+                this->texts.push_back (std::move (tm));
+            }
+        }
+
+        unsigned int cols = 1;
+        unsigned int rows = 1;
+        //! The panels, which are made by panel()
+        std::vector<std::unique_ptr<mplot::GraphVisual<Flt, glver>>> panels;
+        //! The datasets of each panel
+        std::vector<std::vector<dataset>> datasets;
+        //! True for the panels that must be rebuilt from their datasets
+        std::vector<bool> stale;
+        //! The x and y link groups, the group of each panel (or npos) and each group's range
+        std::vector<std::vector<std::size_t>> x_groups;
+        std::vector<std::vector<std::size_t>> y_groups;
+        std::vector<std::size_t> x_group;
+        std::vector<std::size_t> y_group;
+        std::vector<sm::range<Flt>> x_ranges;
+        std::vector<sm::range<Flt>> y_ranges;
+        //! Where each panel's vertices and indices begin in the merged buffers (with the totals at the end)
+        std::vector<std::size_t> vertex_begin;
+        std::vector<std::size_t> index_begin;
+        //! Scratch space for one panel's mesh
+        std::vector<float> mesh_posn;
+        std::vector<float> mesh_norm;
+        std::vector<float> mesh_col;
+        std::vector<GLuint> mesh_ind;
+    };
+
+} // namespace mplot
@@ -0,0 +1,326 @@
+/*!
+ * \file
+ *
+ * A VisualModel that shows a point cloud that may be far larger than GPU memory (a mesh scan,
+ * or a dump of a particle simulation) from an on-disk octree (see mplot/point_octree.h).
+ *
+ * Each frame, in update_lod(), the model walks the octree from its root, in order of
+ * screen-space error, and wants each node that is in view and whose parent's points are more
+ * than max_screen_error pixels apart on the screen, up to point_budget points. The nodes are
+ * read from the memory mapped file on worker threads, colour mapped there and held in a cache
+ * of GPU node buffers (the slots of the model's point cloud cache, see
+ * VisualModelBase::set_cloud_slots), from which the least recently drawn nodes are evicted. The
+ * cache is sized by gpu_budget_bytes. The root node is always in the cache, so something is
+ * drawn while the other nodes load. Rotating and zooming choose and draw nodes that are in the
+ * cache; they never wait for the disk.
+ *
+ * \author Seb James
+ * \date 2026
+ */
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <list>
+#include <map>
+#include <queue>
+#include <unordered_map>
+#include <memory>
+#include <future>
+#include <chrono>
+#include <string>
+#include <span>
+#include <cmath>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+#include <sm/vec>
+#include <sm/mat44>
+#include <mplot/colour.h>
+#include <mplot/point_octree.h>
+#include <mplot/VisualDataModel.h>
+
+namespace mplot {
+
+    template <int glver = mplot::gl::version_4_1>
+    struct PointCloudVisual : public VisualDataModel<float, glver>
+    {
+        using cloud_point = typename VisualModelBase<glver>::cloud_point;
+        using cloud_draw = typename VisualModelBase<glver>::cloud_draw;
+
+        PointCloudVisual (const sm::vec<float> _offset)
+        {
+            this->mv_offset = _offset;
+            this->viewmatrix.translate (this->mv_offset);
+            this->colourScale.do_autoscale = true;
+            this->lod_enabled = true;
+        }
+
+        /*!
+         * Build the octree of dataCoords (coloured by scalarData, if it is set) in the file at
+         * path and draw the cloud from it. The data need not be kept after this returns.
+         */
+        void buildOctree (const std::string& path, const mplot::point_octree::build_params& bp = {})
+        {
+            if (this->dataCoords == nullptr) { throw std::runtime_error ("PointCloudVisual::buildOctree: setDataCoords first"); }
+            std::span<const float> vals;
+            if (this->scalarData != nullptr) { vals = std::span<const float>(this->scalarData->data(), this->scalarData->size()); }
+            mplot::point_octree::build (*this->dataCoords, vals, path, bp);
+            this->setOctreeFile (path);
+        }
+
+        //! Draw the cloud from the octree file at path, made by buildOctree or mplot::point_octree::build
+        void setOctreeFile (const std::string& path)
+        {
+            this->loads.clear();
+            this->octree = std::make_shared<mplot::point_octree::octree_file> (path);
+        }
+
+        //! The number of nodes in the cache, and the number that are loading
+        std::size_t resident_nodes() const { return this->resident.size(); }
+        std::size_t loading_nodes() const { return this->loads.size(); }
+
+        //! The number of points drawn in the last frame
+        std::size_t drawn_points() const
+        {
+            std::size_t n = 0;
+            for (const auto& d : this->drawn) { n += d.count; }
+            return n;
+        }
+
+        //! Size the cache, and read and draw the root node
+        void initializeVertices()
+        {
+            this->loads.clear();
+            this->resident.clear();
+            this->lru.clear();
+            this->drawn.clear();
+            this->free_slots.clear();
+            if (!this->octree) { return; }
+            const mplot::point_octree::file_header& h = this->octree->header();
+            if (h.n_nodes == 0) { return; }
+
+            const std::size_t slot_points = std::max (std::uint32_t{1}, h.max_node_points);
+            const std::size_t slot_bytes = slot_points * sizeof (cloud_point);
+            const std::size_t n_slots = std::clamp (this->gpu_budget_bytes / slot_bytes, std::size_t{1}, std::size_t{h.n_nodes});
+            this->set_cloud_slots (n_slots, slot_points);
+            for (std::size_t s = n_slots; s > 1; --s) { this->free_slots.push_back (static_cast<std::uint32_t>(s - 1)); }
+
+            if (this->colourScale.do_autoscale == true) {
+                this->colourScale.reset();
+                if (h.value_range[1] > h.value_range[0]) { this->colourScale.compute_scaling (h.value_range[0], h.value_range[1]); }
+            }
+            this->by_value = h.value_range[1] > h.value_range[0];
+
+            // The root is read now, into slot 0, and is never evicted
+            this->write_cloud_slot (0, load_node (this->octree, 0, this->node_colouring()));
+            this->resident[0] = { 0u, this->lru.end(), 0u };
+            this->drawn = { { 0u, this->octree->nodes()[0].count } };
+            this->set_cloud_draws (std::vector<cloud_draw>(this->drawn));
+        }
+
+        //! Choose the nodes for this frame, start loading those that are missing, and draw those in the cache
+        void update_lod() override
+        {
+            if (this->lod_viewport_h <= 0 || !this->octree || this->resident.empty()) { return; }
+            ++this->frame;
+            this->take_loads();
+
+            const std::vector<std::uint32_t> wanted = this->select_nodes();
+            const auto nodes = this->octree->nodes();
+            std::vector<cloud_draw> d;
+            d.reserve (wanted.size());
+            bool missing = false;
+            for (const std::uint32_t i : wanted) {
+                auto r = this->resident.find (i);
+                if (r == this->resident.end()) {
+                    missing = true;
+                    this->request (i);
+                    continue;
+                }
+                this->touch (r->second);
+                d.push_back ({ r->second.slot, nodes[i].count });
+            }
+            auto same = [](const std::vector<cloud_draw>& a, const std::vector<cloud_draw>& b) {
+                return std::equal (a.begin(), a.end(), b.begin(), b.end(),
+                                   [](const cloud_draw& x, const cloud_draw& y) { return x.slot == y.slot && x.count == y.count; });
+            };
+            if (!same (d, this->drawn)) {
+                this->drawn = d;
+                this->set_cloud_draws (std::move (d));
+            }
+            // Keep the frames coming until the nodes that are wanted have arrived
+            if (missing || !this->loads.empty()) { this->scene_changed(); }
+        }
+
+        //! The most GPU memory for the cache of nodes, in bytes. Set before finalize().
+        std::size_t gpu_budget_bytes = std::size_t{256} << 20;
+        //! The most points to draw in a frame
+        std::size_t point_budget = 20'000'000;
+        //! A node's children are wanted when its points are more than this many pixels apart on the screen
+        float max_screen_error = 2.0f;
+        //! The most nodes that may be loading at once
+        unsigned int max_loads = 4;
+        //! The colour of the points of a cloud without values (or whose values are all the same)
+        std::array<float, 3> colour = mplot::colour::grey30;
+
+    protected:
+        //! A node in the cache: its slot, its place in lru and the frame in which it was last drawn
+        struct resident_node
+        {
+            std::uint32_t slot = 0;
+            std::list<std::uint32_t>::iterator lru_it;
+            std::uint64_t frame = 0;
+        };
+
+        //! What a worker needs to colour a node's points
+        struct colouring
+        {
+            ColourMap<float> cm;
+            sm::scale<float, float> scale;
+            bool by_value = false;
+            std::array<float, 3> colour = { 0.0f, 0.0f, 0.0f };
+        };
+        colouring node_colouring() const { return { this->cm, this->colourScale, this->by_value, this->colour }; }
+
+        //! Read node i's points from the file and colour them (on a worker thread)
+        static std::vector<cloud_point> load_node (std::shared_ptr<const mplot::point_octree::octree_file> of, const std::uint32_t i,
+                                                   const colouring& c)
+        {
+            const std::span<const mplot::point_octree::file_point> src = of->points (i);
+            std::vector<cloud_point> pts (src.size());
+            const std::uint32_t flat = VisualModelBase<glver>::cloud_rgba (c.colour);
+            for (std::size_t k = 0; k < src.size(); ++k) {
+                pts[k].p = src[k].p;
+                pts[k].rgba = c.by_value ? VisualModelBase<glver>::cloud_rgba (c.cm.convert (c.scale.transform_one (src[k].value))) : flat;
+            }
+            return pts;
+        }
+
+        /*!
+         * Walk the octree from the root, each time taking the wanted node of largest screen-space
+         * error, and want its children that are in view while its points are more than
+         * max_screen_error pixels apart. Stops at point_budget points, or when the wanted nodes
+         * would fill the cache (leaving room for the nodes that are loading).
+         */
+        std::vector<std::uint32_t> select_nodes() const
+        {
+            const auto nodes = this->octree->nodes();
+            const sm::mat44<float> mvp = this->lod_projection * this->scenematrix * this->model_matrix();
+            const float* m = mvp.mat.data();
+            // Row r of mvp (column major)
+            auto row = [m](const unsigned int r) { return sm::vec<float, 4>{ m[r], m[4 + r], m[8 + r], m[12 + r] }; };
+            const sm::vec<float, 4> rx = row (0), ry = row (1), rz = row (2), rw = row (3);
+            // The six clip planes, each normalized by the length of its xyz part
+            std::array<sm::vec<float, 4>, 6> planes = { rw + rx, rw - rx, rw + ry, rw - ry, rw + rz, rw - rz };
+            for (auto& pl : planes) {
+                const float l = std::sqrt (pl[0] * pl[0] + pl[1] * pl[1] + pl[2] * pl[2]);
+                if (l > 0.0f) { pl /= l; }
+            }
+            const float sy = std::sqrt (ry[0] * ry[0] + ry[1] * ry[1] + ry[2] * ry[2]);
+            const float half_h = 0.5f * static_cast<float>(this->lod_viewport_h);
+
+            auto in_view = [&](const mplot::point_octree::file_node& nd) {
+                const float r = nd.half * 1.7320508f;
+                for (const auto& pl : planes) {
+                    if (pl[0] * nd.centre[0] + pl[1] * nd.centre[1] + pl[2] * nd.centre[2] + pl[3] < -r) { return false; }
+                }
+                return true;
+            };
+            // The spacing of the node's children's points on the screen, in pixels (which is
+            // what wanting them refines the view to)
+            auto error = [&](const mplot::point_octree::file_node& nd) {
+                const float w = rw[0] * nd.centre[0] + rw[1] * nd.centre[1] + rw[2] * nd.centre[2] + rw[3];
+                if (w <= nd.half * 1.7320508f) { return std::numeric_limits<float>::infinity(); } // The eye is (nearly) in the node
+                return nd.spacing * sy / w * half_h;
+            };
+
+            const std::size_t max_nodes = std::max (std::size_t{1}, this->cloud_slot_count() - std::min (this->cloud_slot_count() - 1u, std::size_t{this->max_loads}));
+            std::vector<std::uint32_t> sel;
+            std::size_t n_points = 0;
+            using entry = std::pair<float, std::uint32_t>;
+            std::priority_queue<entry> q;
+            if (in_view (nodes[0])) { q.push ({ error (nodes[0]), 0u }); }
+            while (!q.empty() && sel.size() < max_nodes) {
+                const std::uint32_t i = q.top().second;
+                const float e = q.top().first;
+                q.pop();
+                const mplot::point_octree::file_node& nd = nodes[i];
+                if (!sel.empty() && n_points + nd.count > this->point_budget) { break; }
+                sel.push_back (i);
+                n_points += nd.count;
+                if (!(e > this->max_screen_error)) { continue; }
+                for (unsigned int c = 0; c < nd.n_children(); ++c) {
+                    const std::uint32_t ci = nd.first_child + c;
+                    if (in_view (nodes[ci])) { q.push ({ error (nodes[ci]), ci }); }
+                }
+            }
+            return sel;
+        }
+
+        //! Start loading node i on a worker thread, if it isn't loading and there is room
+        void request (const std::uint32_t i)
+        {
+            if (this->loads.count (i) || this->loads.size() >= this->max_loads) { return; }
+            this->loads[i] = std::async (std::launch::async, [of = this->octree, i, c = this->node_colouring()]()
+            {
+                return load_node (of, i, c);
+            });
+        }
+
+        //! Put the nodes that have finished loading into the cache
+        void take_loads()
+        {
+            for (auto it = this->loads.begin(); it != this->loads.end(); ) {
+                if (it->second.wait_for (std::chrono::seconds (0)) != std::future_status::ready) { ++it; continue; }
+                const std::uint32_t i = it->first;
+                std::vector<cloud_point> pts = it->second.get();
+                it = this->loads.erase (it);
+                std::uint32_t slot = 0;
+                if (!this->free_slots.empty()) {
+                    slot = this->free_slots.back();
+                    this->free_slots.pop_back();
+                } else if (!this->lru.empty() && this->resident[this->lru.back()].frame + 1 < this->frame) {
+                    // Evict the least recently drawn node (if it wasn't drawn in the last frame)
+                    slot = this->resident[this->lru.back()].slot;
+                    this->resident.erase (this->lru.back());
+                    this->lru.pop_back();
+                } else {
+                    continue; // No room; the node will be requested again
+                }
+                this->write_cloud_slot (slot, std::move (pts));
+                this->lru.push_front (i);
+                this->resident[i] = { slot, this->lru.begin(), 0u };
+            }
+        }
+
+        //! Mark a node as drawn in this frame
+        void touch (resident_node& r)
+        {
+            r.frame = this->frame;
+            if (r.lru_it != this->lru.end()) { this->lru.splice (this->lru.begin(), this->lru, r.lru_it); }
+        }
+
+        //! The octree, shared with the loads
+        std::shared_ptr<const mplot::point_octree::octree_file> octree;
+        //! True if the points are coloured by their values
+        bool by_value = false;
+        //! The nodes in the cache, by index. The root is not in lru, so it is never evicted.
+        std::unordered_map<std::uint32_t, resident_node> resident;
+        //! The evictable nodes in the cache, the most recently drawn first
+        std::list<std::uint32_t> lru;
+        //! The slots of the cache that hold no node
+        std::vector<std::uint32_t> free_slots;
+        //! The slots drawn in the last frame
+        std::vector<cloud_draw> drawn;
+        //! Counts the calls of update_lod
+        std::uint64_t frame = 0;
+        //! The nodes that are loading. Declared last so that it is destroyed (waiting for the
+        //! loads) before the members the loads might use.
+        std::map<std::uint32_t, std::future<std::vector<cloud_point>>> loads;
+    };
+
+} // namespace mplot
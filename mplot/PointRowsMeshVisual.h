@@ -3,7 +3,8 @@
 #include <iostream>
 #include <vector>
 #include <array>
-#include <cmath>
+#include <algorithm>
+#include <cstddef>
 
 #include <sm/scale>
 #include <sm/vec>
@@ -11,6 +12,7 @@
 #include <mplot/tools.h>
 #include <mplot/VisualDataModel.h>
 #include <mplot/ColourMap.h>
+#include <mplot/point_rows.h>
 
 namespace mplot {
 
@@ -127,148 +129,77 @@ namespace mplot {
             this->colourScale.do_autoscale = true;
             this->colourScale.transform (*this->scalarData, dcopy);
 
-            // First, need to know which set of points form two, adjacent rows. An assumption we'll
-            // accept: The rows are listed in slice-order and the points in each row are listed in
-            // position-along-the-curve order.
-
-            std::size_t r1 = 0;
-            std::size_t r1_e = 0;
-            std::size_t r2 = 0;
-            std::size_t r2_e = 0;
-
-            std::size_t prlen = this->dataCoords->size();
-
-            // pa is this->pa
-            float x = (*this->dataCoords)[r1][pa];
-            while (r1_e != prlen && (*this->dataCoords)[r1_e][pa] == x) {
-                ++r1_e;
-            }
-            r2 = r1_e--;
-            r2_e = r2;
-            x = (*this->dataCoords)[r2][pa];
-            while (r2_e != prlen && (*this->dataCoords)[r2_e][pa] == x) {
-                ++r2_e;
-            }
-            r2_e--;
-            // Now r1, r1_e, r2 and r2_e all point to the right places
-            while (r2 != prlen) { // While through all 'rows' - pairs of pointrows
-
-                this->computeSphere ((*this->dataCoords)[r1], this->cm_sph.convert(dcopy[r1]), this->sradius, this->srings, this->sseg);
-                this->computeSphere ((*this->dataCoords)[r2], this->cm_sph.convert(dcopy[r2]), this->sradius, this->srings, this->sseg);
-                this->computeTube ((*this->dataCoords)[r1], (*this->dataCoords)[r2],
-                                   this->cm.convert(dcopy[r1]), this->cm.convert(dcopy[r2]), this->radius, this->tseg);
-                // Now while through the row pushing the rest of the vertices.
-                while (r2 <= r2_e && r1 <= r1_e) {
-
-                    // Now iterate r1 and r2 until we get to the end of the two rows.
-                    // vtx is r1, r2. Question is: Is other vertex ++r1 or ++r2?
-                    std::size_t r1n = r1 + 1U;
-                    std::size_t r2n = r2 + 1U;
-
-                    // Increment and make sure we didn't drop off the end
-                    if (r1n > r1_e && r2n > r2_e) {
-                        r1 = r1n;
-                        r2 = r2n;
-                        break;
-                    }
-
-                    bool completed_end_tri = false;
-                    bool must_be_r1n = false;
-                    bool must_be_r2n = false;
-                    if (r1n > r1_e) {
-                        // Can't add this one, only r2n is possible
-                        must_be_r2n = true;
-                        completed_end_tri = true;
-                    }
-                    if (r2n > r2_e) {
-                        // Can't add this one, only r1n is possible and must be at end of row
-                        must_be_r1n = true;
-                        completed_end_tri = true;
-                    }
-
-                    if (must_be_r1n) {
-                        must_be_r2n = false;
-                    } else if (must_be_r2n) {
-                        must_be_r1n = false;
-                    } else {
-                        // Compute distances to compute angles to decide
-                        float r1_to_r2_sq = ((*this->dataCoords)[r1] - (*this->dataCoords)[r2]).length_sq();
-                        float r1_to_r1n_sq = ((*this->dataCoords)[r1] - (*this->dataCoords)[r1n]).length_sq();
-                        float r1_to_r2n_sq = ((*this->dataCoords)[r1] - (*this->dataCoords)[r2n]).length_sq();
-                        float r2_to_r1n_sq = ((*this->dataCoords)[r2] - (*this->dataCoords)[r1n]).length_sq();
-                        float r2_to_r2n_sq = ((*this->dataCoords)[r2] - (*this->dataCoords)[r2n]).length_sq();
-
-                        float r1_to_r1n = std::sqrt(r1_to_r1n_sq);
-                        float r1_to_r2n = std::sqrt(r1_to_r2n_sq);
-                        float r2_to_r1n = std::sqrt(r2_to_r1n_sq);
-                        float r2_to_r2n = std::sqrt(r2_to_r2n_sq);
-
-                        float asq = r1_to_r2_sq;
-                        float bsq = r2_to_r1n_sq;
-                        float b = r2_to_r1n;
-                        float csq = r1_to_r1n_sq;
-                        float c = r1_to_r1n;
-                        float alpha1 = std::acos ((bsq + csq - asq)/(2*b*c));
-
-                        bsq = r2_to_r2n_sq;
-                        b = r2_to_r2n;
-                        csq = r1_to_r2n_sq;
-                        c = r1_to_r2n;
-                        float alpha2 = std::acos ((bsq + csq - asq)/(2*b*c));
-
-                        if (alpha2 < alpha1) {
-                            // r1
-                            must_be_r1n = true;
-                            must_be_r2n = false;
-                        } else {
-                            must_be_r1n = false;
-                            must_be_r2n = true;
-                        }
-                    }
-
-                    if (must_be_r1n) {
-                        // r1 is the next
-                        this->computeSphere ((*this->dataCoords)[r1], this->cm_sph.convert(dcopy[r1]), this->sradius, this->srings, this->sseg);
-                        this->computeSphere ((*this->dataCoords)[r1n], this->cm_sph.convert(dcopy[r1n]), this->sradius, this->srings, this->sseg);
-                        this->computeTube ((*this->dataCoords)[r1], (*this->dataCoords)[r1n],
-                                           this->cm.convert(dcopy[r1]), this->cm.convert(dcopy[r1n]), this->radius, this->tseg);
-                        r1 = r1n;
-                    } else {
-                        // r2 is next
-                        this->computeSphere ((*this->dataCoords)[r2], this->cm_sph.convert(dcopy[r2]), this->sradius, this->srings, this->sseg);
-                        this->computeSphere ((*this->dataCoords)[r2n], this->cm_sph.convert(dcopy[r2n]), this->sradius, this->srings, this->sseg);
-                        this->computeTube ((*this->dataCoords)[r2], (*this->dataCoords)[r2n],
-                                           this->cm.convert(dcopy[r2]), this->cm.convert(dcopy[r2n]), this->radius, this->tseg);
-                        r2 = r2n;
-                    }
-
-                    if (completed_end_tri == true) { break; }
-
-                    // Next tri:
-                    this->computeSphere ((*this->dataCoords)[r1], this->cm_sph.convert(dcopy[r1]), this->sradius, this->srings, this->sseg);
-                    this->computeSphere ((*this->dataCoords)[r2], this->cm_sph.convert(dcopy[r2]), this->sradius, this->srings, this->sseg);
-                    this->computeTube ((*this->dataCoords)[r1], (*this->dataCoords)[r2],
-                                       this->cm.convert(dcopy[r1]), this->cm.convert(dcopy[r2]), this->radius, this->tseg);
+            // The rows are listed in slice-order and the points in each row are listed in
+            // position-along-the-curve order. The edges of the strip between each pair of
+            // adjacent rows depend only on those two rows, so they are found in parallel and then
+            // concatenated. Each edge is drawn as a tube, with a sphere at each end.
+            const std::vector<point_rows::row> rows = point_rows::find_rows (*this->dataCoords, this->pa);
+            const std::size_t npairs = rows.size() < 2u ? 0u : rows.size() - 1u;
+            std::vector<std::vector<std::array<std::size_t, 2>>> edges (npairs);
+            this->for_elements (npairs, [&](const std::size_t k) {
+                std::vector<std::array<std::size_t, 2>>& e = edges[k];
+                auto add_edge = [&e](const std::size_t a, const std::size_t b) { e.push_back ({ a, b }); };
+                point_rows::walk_pair (*this->dataCoords, rows[k], rows[k + 1u], add_edge, add_edge, add_edge);
+            });
+
+            std::vector<std::size_t> offsets (npairs + 1u, 0u);
+            for (std::size_t k = 0; k < npairs; ++k) { offsets[k + 1u] = offsets[k] + edges[k].size(); }
+            const std::size_t ne = offsets[npairs];
+
+            // One conversion per datum for each colour map
+            std::vector<float> mesh_rgb;
+            std::vector<float> sph_rgb;
+            this->cm.convert (dcopy, mesh_rgb);
+            this->cm_sph.convert (dcopy, sph_rgb);
+            auto rgb = [](const std::vector<float>& c, const std::size_t d) {
+                return std::array<float, 3>{ c[3u * d], c[3u * d + 1u], c[3u * d + 2u] };
+            };
+
+            // The spheres (two per edge, at its start and end) and the tubes
+            std::vector<sm::vec<float>> scentres (2u * ne);
+            std::vector<std::array<float, 3>> scols (2u * ne);
+            std::vector<sm::vec<float>> tstarts (ne);
+            std::vector<sm::vec<float>> tends (ne);
+            std::vector<std::array<float, 3>> tcol_starts (ne);
+            std::vector<std::array<float, 3>> tcol_ends (ne);
+            this->for_elements (npairs, [&](const std::size_t k) {
+                for (std::size_t j = 0; j < edges[k].size(); ++j) {
+                    const std::size_t t = offsets[k] + j;
+                    const std::size_t a = edges[k][j][0];
+                    const std::size_t b = edges[k][j][1];
+                    scentres[2u * t] = (*this->dataCoords)[a];
+                    scentres[2u * t + 1u] = (*this->dataCoords)[b];
+                    scols[2u * t] = rgb (sph_rgb, a);
+                    scols[2u * t + 1u] = rgb (sph_rgb, b);
+                    tstarts[t] = (*this->dataCoords)[a];
+                    tends[t] = (*this->dataCoords)[b];
+                    tcol_starts[t] = rgb (mesh_rgb, a);
+                    tcol_ends[t] = rgb (mesh_rgb, b);
                 }
+            });
+            this->tessellation_extent_reset();
+            for (const auto& c : *this->dataCoords) { this->tessellation_extent (c, 2.0f * std::max (this->sradius, this->radius)); }
+            this->computeSpheres (scentres, scols, this->sradius, this->tessellation.rings (this->srings), this->tessellation.segments (this->sseg));
+            this->computeTubes (tstarts, tends, tcol_starts, tcol_ends, this->radius, this->tessellation.segments (this->tseg));
+            std::cout << "PointRowsMeshVisual has " << this->idx << " vertex indices\n";
+        }
 
-                // On to the next rows:
-                r1 = r1_e + 1;
-                r1_e = r1;
-                r2 = r2_e; ++r2;
-                r2_e = r2;
-
-                if (r2 == prlen) { break; }
+        /*!
+         * Choose the rings and segments of the spheres and tubes from their size on the screen
+         * (see mplot/tessellation.h), if t is adaptive. The whole mesh is rebuilt when the level
+         * changes. With a fixed tessellation, srings, sseg and tseg are used.
+         */
+        void setTessellation (const mplot::tessellation& t)
+        {
+            this->tessellation = t;
+            this->tessellation.reset();
+            this->lod_enabled = t.adaptive;
+        }
 
-                x = (*this->dataCoords)[r1][pa];
-                while (r1_e != prlen && (*this->dataCoords)[r1_e][pa] == x) { ++r1_e; }
-                r1_e--;
-                r2_e = r2;
-                x = (*this->dataCoords)[r2][pa];
-                while (r2_e != prlen && (*this->dataCoords)[r2_e][pa] == x) { ++r2_e; }
-                r2_e--;
-                // Now r1, r1_e, r2 and r2_e all point to the right places
-            }
-            std::cout << "PointRowsMeshVisual has " << this->idx << " vertex indices\n";
+        //! Rebuild the mesh if the tessellation level changes with the view
+        void update_lod() override
+        {
+            if (this->update_tessellation()) { this->reinit(); }
         }
 
     private:
@@ -4,12 +4,14 @@
 #include <vector>
 #include <array>
 #include <cstddef>
+#include <cstdint>
 
 #include <sm/scale>
 #include <sm/vec>
 
 #include <mplot/tools.h>
 #include <mplot/VisualDataModel.h>
+#include <mplot/point_rows.h>
 
 namespace mplot {
 
@@ -68,233 +70,104 @@ namespace mplot {
                 return;
             }
 
-            std::vector<Flt> dcopy = *(this->scalarData);
-            this->colourScale.do_autoscale = true;
-            this->colourScale.transform (*this->scalarData, dcopy);
-
-            // First, need to know which set of points form two, adjacent rows. An assumption we'll
-            // accept: The rows are listed in slice-order and the points in each row are listed in
-            // position-along-the-curve order.
-
-            std::size_t r1 = 0U;
-            std::size_t r1_e = 0U;
-            std::size_t r2 = 0U;
-            std::size_t r2_e = 0U;
-
-            std::size_t prlen = this->dataCoords->size();
-
-            // pa is this->pa
-            float x = (*this->dataCoords)[r1][pa];
-            while (r1_e != prlen && (*this->dataCoords)[r1_e][pa] == x) {
-                ++r1_e;
-            }
-            r2 = r1_e--;
-            r2_e = r2;
-            x = (*this->dataCoords)[r2][pa];
-            while (r2_e != prlen && (*this->dataCoords)[r2_e][pa] == x) {
-                ++r2_e;
-            }
-            r2_e--;
-            // Now r1, r1_e, r2 and r2_e all point to the right places
-            //std::cout << "r1: " << r1 << ", r1_e: " << r1_e << std::endl;
-            //std::cout << "r2: " << r2 << ", r2_e: " << r2_e << std::endl;
-            //std::cout << "prlen is " << prlen << std::endl;
-            sm::vec<float> v0, v1, v2;
-            while (r2 != prlen) { // While through all 'rows' - pairs of pointrows
-                //std::cout << "====================================" << std::endl;
-                //std::cout << "  ROW" << std::endl;
-                //std::cout << "  r1: " << r1 << ", r1_e: " << r1_e << std::endl;
-                //std::cout << "  r2: " << r2 << ", r2_e: " << r2_e << std::endl;
-                //std::cout << "====================================" << std::endl;
-
-                // Push the first two vertices in the row:
-                // Start vertex 1
-                v1 = (*this->dataCoords)[r1];
-                this->vertex_push ((*this->dataCoords)[r1], this->vertexPositions);
-                this->vertex_push (this->cm.convert(dcopy[r1]), this->vertexColors);
-                //this->vertex_push (0.0f, 0.0f, 1.0f, this->vertexNormals);
-                this->indices.push_back (this->idx);
-                this->idx++;
-                // Start vertex 2
-                v2 = (*this->dataCoords)[r2];
-                this->vertex_push ((*this->dataCoords)[r2], this->vertexPositions);
-                this->vertex_push (this->cm.convert(dcopy[r2]), this->vertexColors);
-                //this->vertex_push (0.0f, 0.0f, 1.0f, this->vertexNormals);
-                this->indices.push_back (this->idx);
-                this->idx++;
-
-                // Let v0 be:
-                sm::vec<float> vnorm = {0.0f, 0.0f, 1.0f};
-                if (r1+1 < r1_e) {
-                    v0 = (*this->dataCoords)[r1+1];
-                    // Compute normal
-                    sm::vec<float> plane1 = v1 - v0;
-                    sm::vec<float> plane2 = v2 - v0;
-                    vnorm = plane2.cross (plane1);
-                    vnorm.renormalize();
-                }
-                // Push normal twice for the two start vertices:
-                this->vertex_push (vnorm, this->vertexNormals);
-                this->vertex_push (vnorm, this->vertexNormals);
-
-                // Now while through the row pushing the rest of the vertices.
-                //std::cout << "While through the rest, with r2 < r2_e=" << r2_e << std::endl;
-                while (r2 <= r2_e && r1 <= r1_e) {
-
-                    // Now iterate r1 and r2 until we get to the end of the two rows.
-                    // vtx is r1, r2. Question is: Is other vertex ++r1 or ++r2?
-                    std::size_t r1n = r1 + 1U;
-                    std::size_t r2n = r2 + 1U;
-
-                    //std::cout << "**************************" << std::endl;
-                    //std::cout << "r1: " << r1 << ", r1_e: " << r1_e << std::endl;
-                    //std::cout << "r2: " << r2 << ", r2_e: " << r2_e << std::endl;
-
-                    // Increment and make sure we didn't drop off the end
-                    if (r1n > r1_e && r2n > r2_e) {
-                        r1 = r1n;
-                        r2 = r2n;
-                        //std::cout << "Breaking as r1n>r1_e and r2n>r2_e" << std::endl;
-                        break;
-                    }
-
-                    //std::cout << "r1: " << r1 << ", r1n: " << r1n << std::endl;
-                    //std::cout << "r2: " << r2 << ", r2n: " << r2n << std::endl;
-
-                    bool completed_end_tri = false;
-                    bool must_be_r1n = false;
-                    bool must_be_r2n = false;
-                    if (r1n > r1_e) {
-                        // Can't add this one, only r2n is possthis->idxle
-                        must_be_r2n = true;
-                        completed_end_tri = true;
+            this->colour_vertex_datum.clear();
+            this->colour_datum_count = ndata;
+            this->scale_colour_data();
+
+            // The rows are listed in slice-order and the points in each row are listed in
+            // position-along-the-curve order. Each pair of adjacent rows makes a strip of
+            // triangles that depends only on those two rows, so the strips are triangulated in
+            // parallel, each into its own buffers, which are then concatenated.
+            const std::vector<point_rows::row> rows = point_rows::find_rows (*this->dataCoords, this->pa);
+            const std::size_t npairs = rows.size() < 2u ? 0u : rows.size() - 1u;
+            std::vector<strip> strips (npairs);
+            this->for_elements (npairs, [&](const std::size_t k) { this->triangulate_pair (rows[k], rows[k + 1u], strips[k]); });
+
+            // The offset of each strip's vertices in the model
+            std::vector<std::size_t> offsets (npairs + 1u, 0u);
+            for (std::size_t k = 0; k < npairs; ++k) { offsets[k + 1u] = offsets[k] + strips[k].datum.size(); }
+            const std::size_t nv = offsets[npairs];
+
+            // One colour conversion per datum
+            this->cm.convert (this->dcolour, this->datum_colours);
+
+            const std::size_t v0 = this->vertexPositions.size() / 3u;
+            const std::size_t i0 = this->indices.size();
+            this->vertexPositions.resize (3u * (v0 + nv));
+            this->vertexColors.resize (3u * (v0 + nv));
+            this->vertexNormals.resize (3u * (v0 + nv));
+            this->indices.resize (i0 + nv);
+            if (this->cached_topology) { this->colour_vertex_datum.resize (v0 + nv, 0u); }
+            const GLuint idx0 = this->idx;
+
+            this->for_elements (npairs, [&](const std::size_t k) {
+                const strip& s = strips[k];
+                for (std::size_t j = 0; j < s.datum.size(); ++j) {
+                    const std::size_t v = v0 + offsets[k] + j;
+                    const std::size_t d = s.datum[j];
+                    const sm::vec<float>& posn = (*this->dataCoords)[d];
+                    const float* clr = this->datum_colours.data() + 3u * d;
+                    for (std::size_t i = 0; i < 3u; ++i) {
+                        this->vertexPositions[3u * v + i] = posn[i];
+                        this->vertexColors[3u * v + i] = clr[i];
+                        this->vertexNormals[3u * v + i] = s.norm[j][i];
                     }
-                    if (r2n > r2_e) {
-                        // Can't add this one, only r1n is possthis->idxle and must be at end of row
-                        must_be_r1n = true;
-                        completed_end_tri = true;
-                    }
-
-                    if (must_be_r1n) {
-                        must_be_r2n = false;
-                    } else if (must_be_r2n) {
-                        must_be_r1n = false;
-                    } else {
-                        // Compute distances to compute angles to decide
-                        float r1_to_r2_sq = ((*this->dataCoords)[r1] - (*this->dataCoords)[r2]).length_sq();
-                        float r1_to_r1n_sq = ((*this->dataCoords)[r1] - (*this->dataCoords)[r1n]).length_sq();
-                        float r1_to_r2n_sq = ((*this->dataCoords)[r1] - (*this->dataCoords)[r2n]).length_sq();
-                        float r2_to_r1n_sq = ((*this->dataCoords)[r2] - (*this->dataCoords)[r1n]).length_sq();
-                        float r2_to_r2n_sq = ((*this->dataCoords)[r2] - (*this->dataCoords)[r2n]).length_sq();
-
-                        float r1_to_r1n = std::sqrt(r1_to_r1n_sq);
-                        float r1_to_r2n = std::sqrt(r1_to_r2n_sq);
-                        float r2_to_r1n = std::sqrt(r2_to_r1n_sq);
-                        float r2_to_r2n = std::sqrt(r2_to_r2n_sq);
-
-                        float asq = r1_to_r2_sq;
-                        float bsq = r2_to_r1n_sq;
-                        float b = r2_to_r1n;
-                        float csq = r1_to_r1n_sq;
-                        float c = r1_to_r1n;
-                        float alpha1 = acos ((bsq + csq - asq)/(2*b*c));
-
-                        bsq = r2_to_r2n_sq;
-                        b = r2_to_r2n;
-                        csq = r1_to_r2n_sq;
-                        c = r1_to_r2n;
-                        float alpha2 = acos ((bsq + csq - asq)/(2*b*c));
-
-                        if (alpha2 < alpha1) {
-                            // r1
-                            must_be_r1n = true;
-                            must_be_r2n = false;
-                        } else {
-                            must_be_r1n = false;
-                            must_be_r2n = true;
-                        }
-                    }
-
-                    if (must_be_r1n) {
-                        // r1 vertex is the next
-                        r1 = r1n;
-                        v0 = (*this->dataCoords)[r1];
-                        this->vertex_push ((*this->dataCoords)[r1], this->vertexPositions);
-                        this->vertex_push (this->cm.convert(dcopy[r1]), this->vertexColors);
-                        this->indices.push_back (this->idx);
-                        this->idx++;
-
-                    } else {
-                        // r2 vertex is next
-                        r2 = r2n;
-                        v0 = (*this->dataCoords)[r2];
-                        this->vertex_push ((*this->dataCoords)[r2], this->vertexPositions);
-                        this->vertex_push (this->cm.convert(dcopy[r2]), this->vertexColors);
-                        this->indices.push_back (this->idx);
-                        this->idx++;
-                    }
-
-                    // Compute normal and push one
-                    sm::vec<float> plane1 = v1 - v0;
-                    sm::vec<float> plane2 = v2 - v0;
-                    sm::vec<float> vnorm = plane2.cross (plane1);
-                    vnorm.renormalize();
-                    this->vertex_push (vnorm, this->vertexNormals);
-
-                    if (completed_end_tri == true) {
-                        //std::cout << "Completed the end triangle";
-                        break;
-                    }
-
-                    // Next tri:
-                    v1 = (*this->dataCoords)[r1];
-                    this->vertex_push ((*this->dataCoords)[r1], this->vertexPositions);
-                    this->vertex_push (this->cm.convert(dcopy[r1]), this->vertexColors);
-                    this->vertex_push (vnorm, this->vertexNormals);
-                    this->indices.push_back (this->idx);
-                    this->idx++;
-
-                    v2 = (*this->dataCoords)[r2];
-                    this->vertex_push ((*this->dataCoords)[r2], this->vertexPositions);
-                    this->vertex_push (this->cm.convert(dcopy[r2]), this->vertexColors);
-                    this->vertex_push (vnorm, this->vertexNormals);
-                    this->indices.push_back (this->idx);
-                    this->idx++;
+                    // The vertices of the triangles are not shared, so the indices simply count up
+                    this->indices[i0 + offsets[k] + j] = idx0 + static_cast<GLuint>(offsets[k] + j);
+                    if (this->cached_topology) { this->colour_vertex_datum[v] = static_cast<std::uint32_t>(d); }
                 }
+            });
+            this->idx += static_cast<GLuint>(nv);
+        }
 
-                // On to the next rows:
-                r1 = r1_e + 1;
-                r1_e = r1;
-                r2 = r2_e; ++r2;
-                r2_e = r2;
-
-                //std::cout << "Next r1 is: " << r1 << std::endl;
-                //std::cout << "Next r2 is: " << r2 << std::endl;
-                //std::cout << "this->idx is now " << this->idx << std::endl;
-                if (r2 == prlen) {
-                    //std::cout << "No more rows, break." << std::endl;
-                    break;
-                }
+    private:
+        //! The vertices of the strip of triangles between two rows: the datum (and point) that
+        //! each vertex is at, and its normal
+        struct strip
+        {
+            std::vector<std::size_t> datum;
+            std::vector<sm::vec<float>> norm;
+        };
 
-                x = (*this->dataCoords)[r1][pa];
-                while (r1_e != prlen && (*this->dataCoords)[r1_e][pa] == x) {
-                    ++r1_e;
-                }
-                r1_e--;
-                r2_e = r2;
-                x = (*this->dataCoords)[r2][pa];
-                while (r2_e != prlen && (*this->dataCoords)[r2_e][pa] == x) {
-                    ++r2_e;
+        //! Triangulate the strip between rows a and b into s. Each triangle is made of its own
+        //! three vertices, the normal of which is that of the triangle.
+        void triangulate_pair (const point_rows::row& a, const point_rows::row& b, strip& s) const
+        {
+            const std::vector<sm::vec<float, 3>>& pts = *this->dataCoords;
+            sm::vec<float> v1, v2;
+            sm::vec<float> vnorm = { 0.0f, 0.0f, 1.0f };
+            auto push = [&s](const std::size_t d, const sm::vec<float>& n) {
+                s.datum.push_back (d);
+                s.norm.push_back (n);
+            };
+            auto start = [&](const std::size_t r1, const std::size_t r2) {
+                v1 = pts[r1];
+                v2 = pts[r2];
+                vnorm = { 0.0f, 0.0f, 1.0f };
+                if (r1 + 1u < a.last) {
+                    // Compute normal
+                    const sm::vec<float> v0 = pts[r1 + 1u];
+                    vnorm = (v2 - v0).cross (v1 - v0);
+                    vnorm.renormalize();
                 }
-                r2_e--;
-                // Now r1, r1_e, r2 and r2_e all point to the right places
-                //std::cout << "Next r1,r1, r1_e, r2_e:" << std::endl;
-                //std::cout << "r1: " << r1 << ", r1_e: " << r1_e << std::endl;
-                //std::cout << "r2: " << r2 << ", r2_e: " << r2_e << std::endl;
-            }
+                push (r1, vnorm);
+                push (r2, vnorm);
+            };
+            auto advance = [&](const std::size_t, const std::size_t to) {
+                const sm::vec<float> v0 = pts[to];
+                vnorm = (v2 - v0).cross (v1 - v0);
+                vnorm.renormalize();
+                push (to, vnorm);
+            };
+            auto next = [&](const std::size_t r1, const std::size_t r2) {
+                v1 = pts[r1];
+                v2 = pts[r2];
+                push (r1, vnorm);
+                push (r2, vnorm);
+            };
+            point_rows::walk_pair (pts, a, b, start, advance, next);
         }
 
-    private:
         //! Which axis are we perpendicular to?
         unsigned int pa = 0U;
     };
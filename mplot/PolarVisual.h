@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <array>
+#include <algorithm>
+#include <vector>
 #include <sm/mathconst>
 #include <sm/vec>
 
@@ -110,6 +113,24 @@ namespace mplot {
                 throw std::runtime_error ("Uh oh");
             }
 
+            this->colour_by_polar = this->analytic_fill;
+            if (this->analytic_fill) {
+                // A flat disc, coloured per fragment from a lookup with a row for each ring of
+                // data and a texel for each segment
+                const unsigned int rows = this->numrings - 1u;
+                std::vector<float> rgb (3u * rows * this->numsegs);
+                for (unsigned int k = 0; k < rows; ++k) {
+                    for (unsigned int j = 0; j < this->numsegs; ++j) {
+                        const std::array<float, 3> clr = this->setColour (k * this->numsegs + j);
+                        std::copy (clr.begin(), clr.end(), rgb.begin() + 3u * (k * this->numsegs + j));
+                    }
+                }
+                this->polar_inner = 0.0f;
+                this->set_polar_colour_lut (rgb, rows);
+                this->computePolarDisc ({ 0.0f, 0.0f, this->z }, this->radius);
+                return;
+            }
+
             // Note: Going from out to in, rather than in to out
             for (int ring = this->numrings - 1; ring > 0; ring--) {
 
@@ -176,6 +197,13 @@ namespace mplot {
         mplot::TextFeatures tf;
         //! Additional gap to x axis tick labels for user to set
         float ticklabelgap = 0.0f;
+        /*!
+         * If true, the plot is a flat disc (the z scaling of the data is not shown), a single
+         * quad coloured per fragment from a lookup of the data's colours (see
+         * VisualModel::colour_by_polar), which are smoothly interpolated. If false, the plot is
+         * tessellated into rings of segments, raised by the z scaled data.
+         */
+        bool analytic_fill = false;
         //! The number of segments to make in each ring of the colourmap fill. Depends on your data.
         unsigned int numsegs = 128;
         //! How many rings of colour? Depends on your data. This is really 'the number of rings
@@ -85,9 +85,9 @@ namespace mplot {
                 return;
             }
 
-            std::vector<Flt> dcopy = *(this->scalarData);
-            this->colourScale.do_autoscale = true;
-            this->colourScale.transform ((*this->scalarData), dcopy);
+            this->colour_vertex_datum.clear();
+            this->colour_datum_count = ndata;
+            this->scale_colour_data();
 
             // I'm examining a set of vecs, which means I have to specify the compare
             // operation. See:
@@ -102,7 +102,7 @@ namespace mplot {
                 sm::vec<float> q2 = {(*this->quads)[qi][6], (*this->quads)[qi][7], (*this->quads)[qi][8]};
                 sm::vec<float> q3 = {(*this->quads)[qi][9], (*this->quads)[qi][10], (*this->quads)[qi][11]};
                 // Draw a frame from the 4 coordinates
-                std::array<float, 3> clr = this->cm.convert(dcopy[qi]);
+                std::array<float, 3> clr = this->cm.convert (this->dcolour[qi]);
 
                 // Check that previous quad didn't include any of these pairs of points
                 sm::vec<float, 6> line0 = { q1[0], q1[1], q1[2], q0[0], q0[1], q0[2] };
@@ -145,6 +145,7 @@ namespace mplot {
                     this->computeTube (q2, q3, clr, clr, this->radius, this->tseg);
                     this->computeTube (q3, q0, clr, clr, this->radius, this->tseg);
                 }
+                this->note_colour_datum (qi);
                 // Record the lastQuadLines (and their inverses) for the next loop
                 lastQuadLines.insert (line0);
                 lastQuadLines.insert (line1);
@@ -80,9 +80,9 @@ namespace mplot {
                 return;
             }
 
-            std::vector<Flt> dcopy = *(this->scalarData);
-            this->colourScale.do_autoscale = true;
-            this->colourScale.transform ((*this->scalarData), dcopy);
+            this->colour_vertex_datum.clear();
+            this->colour_datum_count = ndata;
+            this->scale_colour_data();
 
             sm::vec<float> v0, v1, v2, v3;
             for (unsigned int qi = 0; qi < nquads; ++qi) {
@@ -106,7 +106,7 @@ namespace mplot {
                 vnorm.renormalize();
 
                 // All same colours
-                std::array<float, 3> clr = this->cm.convert(dcopy[qi]);
+                std::array<float, 3> clr = this->cm.convert (this->dcolour[qi]);
                 this->vertex_push (clr, this->vertexColors);
                 this->vertex_push (clr, this->vertexColors);
                 this->vertex_push (clr, this->vertexColors);
@@ -139,6 +139,7 @@ namespace mplot {
                     this->vertex_push (-vnorm, this->vertexNormals);
                     this->vertex_push (-vnorm, this->vertexNormals);
                 }
+                this->note_colour_datum (qi);
 
                 // Two triangles per quad, two quads per quad (front and back)
                 // qi * 4 + 1, 2 3 or 4
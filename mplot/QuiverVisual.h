@@ -104,6 +104,23 @@ namespace mplot {
             // normalized lengths multiplied by a user-settable quiver_length_gain.
             sm::vvec<float> lfactor = nrmlzedlengths/dlengths * this->quiver_length_gain;
 
+            if (this->instanced) {
+                // One arrow mesh; each quiver is an instance of it, scaled to its length and
+                // rotated onto its direction. Zero vectors are not shown.
+                this->arrow_mesh();
+                this->instance_data.reserve (ncoords * this->instance_stride);
+                for (unsigned int i = 0; i < ncoords; ++i) {
+                    if (std::isnan (dlengths[i]) || dlengths[i] == Flt{0}) { continue; }
+                    const float len = nrmlzedlengths[i] * this->quiver_length_gain;
+                    const sm::vec<Flt> v = (*this->vectorData)[i];
+                    const sm::vec<float> dirn = { static_cast<float>(v[0]), static_cast<float>(v[1]), static_cast<float>(v[2]) };
+                    // The mesh's thickness is proportional to its length unless fixed_quiver_thickness is set
+                    const float radial = this->fixed_quiver_thickness ? this->fixed_quiver_thickness / (len * quiver_thickness_gain) : 1.0f;
+                    this->add_instance ((*this->dataCoords)[i], len, this->cm.convert (lengthcolours[i]), dirn, radial);
+                }
+                return;
+            }
+
             sm::vec<Flt> half = { Flt{0.5}, Flt{0.5}, Flt{0.5} };
             sm::vec<Flt> vectorData_i, halfquiv;
             sm::vec<float> start, end, coords_i;
@@ -158,6 +175,34 @@ namespace mplot {
             }
         }
 
+        /*!
+         * For an instanced QuiverVisual, build the one arrow mesh (if it has not been built). This
+         * is an arrow of length 1 along the z axis, placed about the origin according to qgoes,
+         * which the shader scales to each quiver's length and rotates onto its direction.
+         */
+        void arrow_mesh()
+        {
+            if (!this->indices.empty()) { return; }
+            const std::array<float, 3> clr = this->cm.convert (Flt{0.5});
+            sm::vec<float> start = { 0.0f, 0.0f, 0.0f };
+            sm::vec<float> end = this->uz;
+            if (this->qgoes == QuiverGoes::ToCoord) {
+                start = -this->uz;
+                end = { 0.0f, 0.0f, 0.0f };
+            } else if (this->qgoes == QuiverGoes::OnCoord) {
+                start = this->uz * -0.5f;
+                end = this->uz * 0.5f;
+            }
+            const float quiv_thick = quiver_thickness_gain;
+            sm::vec<float> cone_start = (end - start).shorten (quiver_arrowhead_prop);
+            cone_start += start;
+            this->computeTube (start, cone_start, clr, clr, quiv_thick, shapesides);
+            this->computeCone (cone_start, end, 0.0f, clr, quiv_thick * 2.0f, shapesides);
+            if (this->show_coordinate_sphere == true) {
+                this->computeSphere (sm::vec<float>{ 0.0f, 0.0f, 0.0f }, clr, quiv_thick * 2.0f, shapesides / 2, shapesides);
+            }
+        }
+
         //! An enumerated type to say whether we draw quivers with coord at mid point; start point or end point
         QuiverGoes qgoes = QuiverGoes::FromCoord;
 
@@ -0,0 +1,95 @@
+/*!
+ * \file
+ *
+ * A VisualModel to show the spikes of a large neural simulation as a raster: one row per
+ * neuron, with a tick (or a point) at the time of each spike. The spikes are held in a ring
+ * on the GPU (see VisualModelBase::set_raster_capacity), so appending a step's spikes uploads
+ * only those spikes, and scrolling the window of time is a change of uniforms. However many
+ * spikes are shown, they are drawn with one instanced draw call.
+ *
+ * \author Seb James
+ * \date 2026
+ */
+#pragma once
+
+#include <array>
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include <sm/vec>
+#include <mplot/colour.h>
+#include <mplot/VisualModel.h>
+
+namespace mplot {
+
+    /*!
+     * A spike raster of n_neurons rows, width by height in model units, with neuron 0 at the
+     * bottom. Spikes are appended (from the thread that renders, as the ring is uploaded in
+     * render()) with append(), and the window of time is set with setWindow() or scrollTo().
+     */
+    template <int glver = mplot::gl::version_4_1>
+    struct RasterVisual : public VisualModel<glver>
+    {
+        using event = typename VisualModelBase<glver>::raster_event;
+        using population = typename VisualModelBase<glver>::raster_population;
+
+        RasterVisual (const sm::vec<float> _offset)
+        {
+            this->mv_offset = _offset;
+            this->viewmatrix.translate (this->mv_offset);
+        }
+
+        //! Hold up to capacity spikes; once it is full, each spike overwrites the oldest
+        void setCapacity (const std::size_t capacity) { this->set_raster_capacity (capacity); }
+
+        //! The number of neurons (rows). Set before finalize(), or call reinit() after.
+        void setNeurons (const std::uint32_t n)
+        {
+            if (n == 0u) { throw std::runtime_error ("RasterVisual: there must be at least one neuron"); }
+            this->n_neurons = n;
+        }
+
+        //! Append spikes, in any order of time
+        void append (std::span<const event> ev) { this->append_raster_events (ev); }
+        void append (const float t, const std::uint32_t neuron) { this->append_raster_event (t, neuron); }
+
+        //! Show the spikes from time t0 to t1
+        void setWindow (const float t0, const float t1) { this->set_raster_window (t0, t1); }
+
+        //! Show the window_len of time that ends at t_end, as for a raster that follows a running simulation
+        void scrollTo (const float t_end, const float window_len) { this->set_raster_window (t_end - window_len, t_end); }
+
+        //! Colour the neurons by population (up to raster_max_populations of them)
+        void setPopulations (std::span<const population> pops) { this->set_raster_populations (pops); }
+
+        //! The number of neurons
+        std::uint32_t n_neurons = 1;
+
+        //! The size of the raster in model units
+        float width = 1.0f;
+        float height = 1.0f;
+
+        //! If true, draw a frame around the raster, of frame_width pixels
+        bool show_frame = true;
+        std::array<float, 3> frame_colour = mplot::colour::grey50;
+        float frame_width = 1.0f;
+
+        void initializeVertices()
+        {
+            if (!this->has_raster()) { throw std::runtime_error ("RasterVisual: call setCapacity before finalize"); }
+            this->raster_extent = { this->width, this->height / static_cast<float>(this->n_neurons) };
+            if (this->show_frame) {
+                const std::vector<sm::vec<float>> frame = {
+                    { 0.0f, 0.0f, this->raster_z }, { this->width, 0.0f, this->raster_z },
+                    { this->width, this->height, this->raster_z }, { 0.0f, this->height, this->raster_z },
+                    { 0.0f, 0.0f, this->raster_z }
+                };
+                this->clear_polylines();
+                const std::size_t pi = this->add_polyline (frame, this->frame_colour);
+                this->set_polyline_width (pi, this->frame_width, true);
+            }
+        }
+    };
+
+} // namespace mplot
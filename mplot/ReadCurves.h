@@ -12,6 +12,7 @@
 #include <list>
 #include <vector>
 #include <map>
+#include <algorithm>
 
 // For AllocAndRead (to be replaced with modern memory allocation/file reading code)
 #include <sstream>
@@ -21,7 +22,15 @@
 #include <stdlib.h>
 #include <string.h>
 
+// For sample()
+#include <string_view>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <cstdint>
+
 #include <sm/bezcurvepath>
+#include <sm/crc32>
 #include <rapidxml/rapidxml.hpp>
 #include <mplot/tools.h> // for tools::searchReplace and tools::containsOnlyWhitespace
 
@@ -43,13 +52,8 @@ namespace mplot
             this->filepath = other.filepath;
             this->sz = other.getsize();
             this->data_ = static_cast<char*>(calloc (this->sz, sizeof(char)));
-            // Now copy contents of others' data
-            std::size_t i = 0;
-            while (i < this->sz) {
-                this->data_[i] = other.datachar(i);
-                ++i;
-            }
-            // no need to null-terminate as we used calloc.
+            // Now copy contents of others' data (which includes its trailing null)
+            if (this->sz > 0) { memcpy (this->data_, other.data_, this->sz); }
         }
         /*!
          * Obtain an indexed character from @see data_.  @param i index into @see data_.  @return
@@ -75,7 +79,7 @@ namespace mplot
         void read()
         {
             std::ifstream f;
-            f.open (this->filepath.c_str(), std::ios::in);
+            f.open (this->filepath.c_str(), std::ios::in | std::ios::binary);
             if (!f.is_open()) {
                 std::stringstream ee;
                 ee << "AllocAndRead: Failed to open file " << this->filepath << " for reading";
@@ -85,26 +89,13 @@ namespace mplot
             // Work out how much memory to allocate - seek to the end
             // of the file and find its size.
             f.seekg (0, std::ios::end);
-            this->sz = f.tellg();
+            std::size_t fsz = static_cast<std::size_t>(f.tellg());
             f.seekg (0);
-            this->data_ = static_cast<char*>(calloc (++this->sz, sizeof(char))); // ++ for trailing null
-
-            char* textpos = this->data_;
-            std::string line("");
-            std::size_t llen = 0U;   // line length (chars)
-            std::size_t curpos = 0U;
-            while (getline (f, line)) {
-                // Restore the newline
-                line += "\n";
-                // Get line length
-                llen = line.size();
-                // Restore textpos pointer in the reallocated memory:
-                textpos = this->data_ + curpos;
-                // copy line to textpos:
-                strncpy (textpos, line.c_str(), llen);
-                // Update current character position
-                curpos += llen;
-            }
+            if (this->data_) { free (this->data_); }
+            this->sz = fsz + 1;
+            this->data_ = static_cast<char*>(calloc (this->sz, sizeof(char))); // +1 for trailing null
+            // Read the whole file in one go
+            f.read (this->data_, static_cast<std::streamsize>(fsz));
             f.close();
             // Note: text is already null terminated as we used calloc.
         }
@@ -113,7 +104,7 @@ namespace mplot
         //! The character data.
         char* data_;
         //! The size in bytes of the character data @data_
-        std::size_t sz;
+        std::size_t sz = 0;
     };
 
     /*!
@@ -139,6 +130,7 @@ namespace mplot
         {
             // Read (without parsing) the svg file text into memory:
             this->modeldata.read (svgpath);
+            this->hashSvg (svgpath);
             // Parse the XML and find the root node:
             this->init();
             // Read the curves:
@@ -157,6 +149,7 @@ namespace mplot
         {
             // Read (without parsing) the svg file text into memory:
             this->modeldata.read (svgpath);
+            this->hashSvg (svgpath);
             // Parse the XML and find the root node:
             this->init();
             this->read();
@@ -206,6 +199,54 @@ namespace mplot
             }
         }
 
+        /*!
+         * Compute the points along the cortical path and along each of the enclosed regions, with
+         * the step size being approximately step in Cartesian space along each path. This is what
+         * calling computePoints (step) on each path would do, but the paths are independent, so
+         * they are sampled in parallel on n_threads threads (0 means one per hardware thread).
+         * The points are then available from getCorticalPath().getPoints() and so on.
+         *
+         * If sidecar is not empty, it names a binary file in which the points are kept. If the
+         * sidecar was written for the same SVG text (by its CRC32) and the same step, the points
+         * are read from it and no Bezier curves are sampled at all; otherwise the paths are
+         * sampled and the sidecar is (re)written. sidecarPath() gives a suitable name alongside
+         * the SVG file. Only the points are held in the sidecar; if you need tangents and
+         * normals, call computePoints on the path.
+         */
+        void sample (const float step, const std::string& sidecar = "", unsigned int n_threads = 0)
+        {
+            std::vector<sm::bezcurvepath<float>*> paths = { &this->corticalPath };
+            for (auto& er : this->enclosedRegions) { paths.push_back (&er); }
+
+            if (!sidecar.empty() && this->readSidecar (sidecar, step, paths)) { return; }
+
+            if (n_threads == 0) { n_threads = std::thread::hardware_concurrency(); }
+            n_threads = std::max (1u, std::min (n_threads, static_cast<unsigned int>(paths.size())));
+            std::atomic<std::size_t> next_path = 0;
+            std::vector<std::exception_ptr> errors (n_threads);
+            auto sampler = [&](unsigned int ti) {
+                try {
+                    for (std::size_t i = next_path++; i < paths.size(); i = next_path++) {
+                        if (!paths[i]->curves.empty()) { paths[i]->computePoints (step); }
+                    }
+                } catch (...) {
+                    errors[ti] = std::current_exception();
+                }
+            };
+            std::vector<std::thread> workers;
+            for (unsigned int ti = 1; ti < n_threads; ++ti) { workers.emplace_back (sampler, ti); }
+            sampler (0);
+            for (auto& w : workers) { w.join(); }
+            for (auto& e : errors) {
+                if (e) { std::rethrow_exception (e); }
+            }
+
+            if (!sidecar.empty()) { this->writeSidecar (sidecar, step, paths); }
+        }
+
+        //! A name for a sample() sidecar file next to the SVG file that was read
+        std::string sidecarPath() const { return this->svgpath + ".bezpts"; }
+
         /*!
          * Get the scaling in mm per SVG unit.
          */
@@ -226,6 +267,83 @@ namespace mplot
 
     private:
 
+        //! Record svgpath and the CRC32 of its text (which must be taken before rapidxml parses the text in place)
+        void hashSvg (const std::string& _svgpath)
+        {
+            this->svgpath = _svgpath;
+            std::size_t len = this->modeldata.getsize() > 0 ? this->modeldata.getsize() - 1 : 0; // without the trailing null
+            this->svg_crc = sm::crc32 (std::string_view (this->modeldata.data(), len));
+        }
+
+        /*!
+         * The sample() sidecar is: 8 magic bytes, the SVG's CRC32, the step, the number of paths
+         * and then, for each path, its number of points followed by t, x, y for each point (all
+         * 32 bit, in the machine's byte order).
+         */
+        static constexpr char sidecar_magic[8] = { 'm', 'p', 'l', 'o', 't', 'b', 'z', 'p' };
+
+        //! Fill the points of paths from sidecar, if it was written for this SVG at this step
+        bool readSidecar (const std::string& sidecar, const float step, std::vector<sm::bezcurvepath<float>*>& paths) const
+        {
+            std::ifstream f (sidecar, std::ios::in | std::ios::binary);
+            if (!f.is_open()) { return false; }
+            char magic[8];
+            std::uint32_t crc = 0;
+            float s_step = 0.0f;
+            std::uint32_t n_paths = 0;
+            f.read (magic, 8);
+            f.read (reinterpret_cast<char*>(&crc), sizeof crc);
+            f.read (reinterpret_cast<char*>(&s_step), sizeof s_step);
+            f.read (reinterpret_cast<char*>(&n_paths), sizeof n_paths);
+            if (!f.good() || memcmp (magic, sidecar_magic, 8) != 0
+                || crc != this->svg_crc || s_step != step || n_paths != paths.size()) {
+                return false;
+            }
+            std::vector<std::vector<sm::bezcoord<float>>> all_points (paths.size());
+            std::vector<float> txy;
+            for (auto& pts : all_points) {
+                std::uint32_t n_pts = 0;
+                f.read (reinterpret_cast<char*>(&n_pts), sizeof n_pts);
+                txy.resize (3u * n_pts);
+                f.read (reinterpret_cast<char*>(txy.data()), static_cast<std::streamsize>(txy.size() * sizeof (float)));
+                if (!f.good()) { return false; }
+                pts.reserve (n_pts);
+                for (std::uint32_t i = 0; i < n_pts; ++i) {
+                    pts.emplace_back (txy[3 * i], sm::vec<float, 2>{ txy[3 * i + 1], txy[3 * i + 2] });
+                }
+            }
+            // Only change the paths once the whole sidecar has been read
+            for (std::size_t i = 0; i < paths.size(); ++i) { paths[i]->points = std::move (all_points[i]); }
+            return true;
+        }
+
+        //! Write the points of paths to sidecar. Failing to write the sidecar is not an error.
+        void writeSidecar (const std::string& sidecar, const float step, const std::vector<sm::bezcurvepath<float>*>& paths) const
+        {
+            std::ofstream f (sidecar, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!f.is_open()) {
+                std::cerr << "WARNING: Could not write ReadCurves sidecar " << sidecar << "\n";
+                return;
+            }
+            const std::uint32_t n_paths = static_cast<std::uint32_t>(paths.size());
+            f.write (sidecar_magic, 8);
+            f.write (reinterpret_cast<const char*>(&this->svg_crc), sizeof this->svg_crc);
+            f.write (reinterpret_cast<const char*>(&step), sizeof step);
+            f.write (reinterpret_cast<const char*>(&n_paths), sizeof n_paths);
+            std::vector<float> txy;
+            for (const auto* p : paths) {
+                const std::uint32_t n_pts = static_cast<std::uint32_t>(p->points.size());
+                txy.resize (3u * n_pts);
+                for (std::uint32_t i = 0; i < n_pts; ++i) {
+                    txy[3 * i] = p->points[i].t();
+                    txy[3 * i + 1] = p->points[i].x();
+                    txy[3 * i + 2] = p->points[i].y();
+                }
+                f.write (reinterpret_cast<const char*>(&n_pts), sizeof n_pts);
+                f.write (reinterpret_cast<const char*>(txy.data()), static_cast<std::streamsize>(txy.size() * sizeof (float)));
+            }
+        }
+
         /*!
          * Some initialisation - parse the doc and find the root node.
          */
@@ -934,6 +1052,10 @@ namespace mplot
          */
         bool foundLine = false;
 
+        //! The path of the SVG file and the CRC32 of its text, to key the sample() sidecar
+        std::string svgpath;
+        std::uint32_t svg_crc = 0;
+
         /*!
          * An object into which to read the xml text prior to parsing.
          */
@@ -55,11 +55,14 @@ namespace mplot {
             this->vertexNormals.clear();
             this->vertexColors.clear();
             this->indices.clear();
+            this->tessellation_extent_reset();
+            this->tessellation_extent (this->start_coord, 2.0f * this->radius);
+            this->tessellation_extent (this->end_coord, 2.0f * this->radius);
 
             // Draw a tube. That's it!
             if constexpr (use_oriented_tube == false) {
                 this->computeTube (this->start_coord, this->end_coord,
-                                   this->start_col, this->end_col, this->radius, 12);
+                                   this->start_col, this->end_col, this->radius, this->tessellation.segments (12));
             } else {
                 // Can alternatively use the 'oriented' tube
                 this->computeTube (this->start_coord, this->end_coord,
@@ -68,6 +71,23 @@ namespace mplot {
             }
         }
 
+        /*!
+         * Choose the segments of the rod from its size on the screen (see mplot/tessellation.h),
+         * if t is adaptive. The rod is rebuilt when the level changes.
+         */
+        void setTessellation (const mplot::tessellation& t)
+        {
+            this->tessellation = t;
+            this->tessellation.reset();
+            this->lod_enabled = t.adaptive;
+        }
+
+        //! Rebuild the rod if the tessellation level changes with the view
+        void update_lod() override
+        {
+            if (this->update_tessellation()) { this->reinit(); }
+        }
+
         //! The position of the start of the rod, given with respect to the parent's offset
         sm::vec<float, 3> start_coord = {0.0f, 0.0f, 0.0f};
         //! The position of the end of the rod, given with respect to the parent's offset
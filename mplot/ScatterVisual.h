@@ -1,6 +1,9 @@
 /*!
  * \file
  *
+ * A scatter plot of markers at the coordinates of dataCoords, or, in density mode (see
+ * ScatterVisual::density), of the number of points in each bin of a 2D grid.
+ *
  * \author Seb James
  * \date 2019
  */
@@ -9,8 +12,12 @@
 #include <iostream>
 #include <vector>
 #include <array>
+#include <span>
+#include <algorithm>
+#include <stdexcept>
 #include <sm/vec>
 #include <mplot/tools.h>
+#include <mplot/density.h>
 #include <mplot/VisualDataModel.h>
 #include <mplot/graphstyles.h>
 
@@ -37,37 +44,175 @@ namespace mplot {
                 sm::vec<float> hr = this->markerdirn * 0.5f; // half rod
                 sm::vec<float> rs = coord + hr;
                 sm::vec<float> re = coord - hr;
-                this->computeTube (rs, re, clr, clr, size, 12);
+                this->computeTube (rs, re, clr, clr, size, this->rod_segments());
             } else {
                 if constexpr (draw_spheres_as_geodesics) {
-                    // Slower than regular computeSphere(). 2 iterations gives 320 faces
+                    // 2 iterations gives 320 faces
                     this->template computeSphereGeoFast<float, 2> (coord, clr, size);
                 } else {
-                    // (16+2) * 20 gives 360 faces
-                    this->computeSphere (coord, clr, size, 16, 20);
+                    // (16+2) * 20 gives 360 faces (at the fixed tessellation)
+                    this->computeSphere (coord, clr, size, this->sphere_rings(), this->sphere_segments());
                 }
             }
         }
 
-        //! Quick hack to add an additional point
-        void add (sm::vec<float> coord, Flt value)
+        /*!
+         * For an instanced ScatterVisual, build the one marker mesh (if it has not been built),
+         * of radius 1 at the origin. It is drawn at each coordinate, scaled by the marker size. A
+         * rod mesh is given the length that makes a rod of size radiusFixed markerdirn long.
+         */
+        void marker_mesh()
         {
-            std::array<float, 3> clr = this->cm.convert (this->colourScale.transform_one (value));
-            this->marker (coord, clr, this->radiusFixed);
-            this->reinit_buffers();
+            if (!this->indices.empty()) { return; }
+            const std::array<float, 3> clr = this->cm.getHueRGB();
+            if (this->markers == mplot::markerstyle::rod) {
+                const float rf = this->radiusFixed > Flt{0} ? static_cast<float>(this->radiusFixed) : 1.0f;
+                sm::vec<float> hr = this->markerdirn * (0.5f / rf);
+                this->computeTube (hr, -hr, clr, clr, 1.0f, this->rod_segments());
+            } else {
+                this->marker (sm::vec<float>{ 0.0f, 0.0f, 0.0f }, clr, Flt{1});
+            }
         }
 
-        //! Additional point with variable size
+        /*!
+         * Add a point of size radiusFixed. Only the new marker is written and uploaded (into
+         * spare capacity in the GPU buffers, which grow geometrically), so adding N points one at
+         * a time costs O(N) rather than O(N^2). The point is not added to the dataCoords or
+         * scalarData vectors. If colourScale.do_autoscale is set and value is outside the range
+         * of the data so far, the colour scale is recomputed and only the colours of the other
+         * markers are rewritten.
+         */
+        void add (sm::vec<float> coord, Flt value) { this->add (coord, value, this->radiusFixed); }
+
+        //! Add a point with variable size (for sphere impostors, no larger than the largest initial size)
         void add (sm::vec<float> coord, Flt value, Flt size)
         {
-            std::array<float, 3> clr = this->cm.convert (this->colourScale.transform_one (value));
-            this->marker (coord, clr, size);
-            this->reinit_buffers();
+            if (this->density) {
+                this->add_to_density (coord);
+                return;
+            }
+            const bool rescaled = this->extend_range (value);
+            const std::array<float, 3> clr = this->cm.convert (this->colourScale.transform_one (value));
+            this->tessellation_extent (coord, 2.0f * static_cast<float>(size));
+            if (this->markers == mplot::markerstyle::sphere_impostor) {
+                if (this->sprites.empty()) { this->set_sprite_radius (static_cast<float>(size)); }
+                this->add_sprite (coord, clr, this->impostor_size (size));
+            } else if (this->instanced) {
+                this->add_instance (coord, static_cast<float>(size), clr);
+                if (this->indices.empty()) {
+                    this->marker_mesh();
+                    this->reinit_buffers(); // uploads the new mesh and the instances
+                } else {
+                    this->mark_dirty_instances (this->n_markers(), this->n_markers() + 1u);
+                    this->reinit_instances();
+                }
+            } else {
+                const std::size_t v0 = this->vertexPositions.size() / 3u;
+                const std::size_t i0 = this->indices.size();
+                this->marker (coord, clr, size);
+                this->marker_vertices = this->vertexPositions.size() / 3u - v0;
+                this->marker_indices = this->indices.size() - i0;
+                this->mark_dirty (v0, v0 + this->marker_vertices);
+                this->mark_dirty_indices (i0, i0 + this->marker_indices);
+                this->reinit_buffers();
+            }
+            this->marker_values.push_back (value);
+            if (rescaled) { this->recolour(); }
+        }
+
+        /*!
+         * Move point i to coord and give it the colour for value (and, in the second overload,
+         * the given size), rewriting and uploading only that point's marker. i counts the points
+         * of dataCoords and then those from add().
+         */
+        void update (const std::size_t i, sm::vec<float> coord, Flt value) { this->update (i, coord, value, this->radiusFixed); }
+
+        //! Move and resize point i, and give it the colour for value
+        void update (const std::size_t i, sm::vec<float> coord, Flt value, Flt size)
+        {
+            if (i >= this->n_markers()) { throw std::out_of_range ("ScatterVisual::update: no such point"); }
+            if (this->density) { throw std::runtime_error ("ScatterVisual::update: points can't be moved in density mode"); }
+            const bool rescaled = this->extend_range (value);
+            const std::array<float, 3> clr = this->cm.convert (this->colourScale.transform_one (value));
+            this->tessellation_extent (coord, 2.0f * static_cast<float>(size));
+            if (this->markers == mplot::markerstyle::sphere_impostor) {
+                this->set_sprite (i, coord, clr, this->impostor_size (size));
+            } else if (this->instanced) {
+                float* inst = this->instance_data.data() + i * this->instance_stride;
+                inst[0] = coord[0];
+                inst[1] = coord[1];
+                inst[2] = coord[2];
+                inst[3] = static_cast<float>(size);
+                for (std::size_t j = 0; j < 3u; ++j) { inst[4u + j] = clr[j]; }
+                this->mark_dirty_instances (i, i + 1u);
+                this->reinit_instances();
+            } else {
+                // Build the marker at the end of the vertex vectors and then move its vertices
+                // into the place of marker i. Its indices are those of the marker it replaces.
+                const std::size_t v0 = i * this->marker_vertices;
+                const std::size_t nv = this->vertexPositions.size();
+                const std::size_t ni = this->indices.size();
+                const GLuint idx0 = this->idx;
+                this->marker (coord, clr, size);
+                for (auto* vv : { &this->vertexPositions, &this->vertexNormals, &this->vertexColors }) {
+                    std::copy (vv->begin() + nv, vv->end(), vv->begin() + 3u * v0);
+                    vv->resize (nv);
+                }
+                this->indices.resize (ni);
+                this->idx = idx0;
+                this->mark_dirty (v0, v0 + this->marker_vertices);
+                this->reinit_buffers();
+            }
+            this->marker_values[i] = value;
+            if (rescaled) { this->recolour(); }
+        }
+
+        /*!
+         * Recompute the colour of each point from its value and the current colourScale and cm,
+         * and upload only the colours (the positions are unchanged). Call this after changing
+         * the colour scale or colour map. Points coloured from vector data are left as they are.
+         */
+        void recolour()
+        {
+            if (this->density) {
+                this->bake_colour_lut();
+                return;
+            }
+            if (this->vector_coloured) { return; }
+            const std::size_t n = this->n_markers();
+            for (std::size_t i = 0; i < n; ++i) {
+                const std::array<float, 3> clr = this->cm.convert (this->colourScale.transform_one (this->marker_values[i]));
+                if (this->markers == mplot::markerstyle::sphere_impostor) {
+                    this->set_sprite_colour (i, clr);
+                } else if (this->instanced) {
+                    for (std::size_t j = 0; j < 3u; ++j) { this->instance_data[i * this->instance_stride + 4u + j] = clr[j]; }
+                } else {
+                    for (std::size_t v = i * this->marker_vertices; v < (i + 1u) * this->marker_vertices; ++v) {
+                        for (std::size_t j = 0; j < 3u; ++j) { this->vertexColors[3u * v + j] = clr[j]; }
+                    }
+                }
+            }
+            if (this->markers == mplot::markerstyle::sphere_impostor) {
+                return; // uploaded as the sprites are next drawn
+            } else if (this->instanced) {
+                this->reinit_instances();
+            } else {
+                this->mark_dirty_colours (0, n * this->marker_vertices);
+                this->reinit_colour_buffer();
+            }
         }
 
         //! Compute spheres for a scatter plot
         void initializeVertices()
         {
+            this->marker_values.clear();
+            this->range_set = false;
+            this->vector_coloured = false;
+            this->tessellation_extent_reset();
+            if (this->density) {
+                this->initializeDensity();
+                return;
+            }
             unsigned int ncoords = this->dataCoords == nullptr ? 0 : this->dataCoords->size();
             if (ncoords == 0) { return; }
             unsigned int ndata = this->scalarData == nullptr ? 0 : this->scalarData->size();
@@ -86,57 +231,87 @@ namespace mplot {
             // Find the minimum distance between points to get a radius? Or just allow
             // client code to set it?
 
-            std::vector<Flt> dcopy;
-            std::vector<Flt> vdcopy1;
-            std::vector<Flt> vdcopy2;
-            std::vector<Flt> vdcopy3;
+            // The scaled data go into the model's dcopy/dcolour buffers, which keep their capacity
+            // from one update to the next. sizeFactor multiplies dcolour (scalar data) or the
+            // unscaled first vector component in dcopy (vector data).
             if (ndata && !nvdata) {
-                dcopy = *(this->scalarData);
+                this->dcolour.resize (ndata);
                 this->colourScale.do_autoscale = true;
-                this->colourScale.transform (*this->scalarData, dcopy);
+                this->colourScale.transform (*this->scalarData, this->dcolour);
+                const auto [dmin, dmax] = std::minmax_element (this->scalarData->begin(), this->scalarData->end());
+                this->data_range = { *dmin, *dmax };
+                this->range_set = true;
             } else if (nvdata) {
-                vdcopy1.resize(this->vectorData->size());
-                vdcopy2.resize(this->vectorData->size());
-                vdcopy3.resize(this->vectorData->size());
-
-                std::vector<Flt> dcopy2, dcopy3;
-                dcopy.resize(this->vectorData->size());
-                dcopy2.resize(this->vectorData->size());
-                dcopy3.resize(this->vectorData->size());
-
-                for (unsigned int i = 0; i < this->vectorData->size(); ++i) {
-                    dcopy[i] = (*this->vectorData)[i][0];
-                    dcopy2[i] = (*this->vectorData)[i][1];
-                    dcopy3[i] = (*this->vectorData)[i][2];
+                this->dcopy.resize (nvdata);
+                this->dcolour.resize (nvdata);
+                this->dcolour2.resize (nvdata);
+                this->dcolour3.resize (nvdata);
+
+                for (unsigned int i = 0; i < nvdata; ++i) {
+                    this->dcopy[i] = (*this->vectorData)[i][0];
+                    this->dcolour2[i] = (*this->vectorData)[i][1];
+                    this->dcolour3[i] = (*this->vectorData)[i][2];
                 }
 
                 this->colourScale.do_autoscale = true;
                 this->colourScale2.do_autoscale = true;
                 this->colourScale3.do_autoscale = true;
 
-                this->colourScale.transform (dcopy, vdcopy1);
-                this->colourScale2.transform (dcopy2, vdcopy2);
-                this->colourScale3.transform (dcopy3, vdcopy3);
+                this->colourScale.transform (this->dcopy, this->dcolour);
+                this->colourScale2.transform (this->dcolour2, this->dcolour2);
+                this->colourScale3.transform (this->dcolour3, this->dcolour3);
 
             } // else no scaling required - spheres will be one colour
+            // Markers of the one hue, or coloured from vector data, can't be recoloured by value
+            this->vector_coloured = !(ndata && !nvdata);
+
+            if (this->markers == mplot::markerstyle::sphere_impostor) {
+                // The sprites share one radius, the largest marker size; each is a fraction of it
+                this->reserve_sprites (ncoords);
+                Flt sz_max = this->radiusFixed;
+                if (this->sizeFactor != Flt{0}) {
+                    sz_max = Flt{0};
+                    for (unsigned int i = 0; i < ncoords; ++i) { sz_max = std::max (sz_max, this->marker_size (i, nvdata)); }
+                }
+                this->set_sprite_radius (static_cast<float>(sz_max));
+            } else if (this->instanced) {
+                this->marker_mesh();
+                this->instance_data.reserve (ncoords * this->instance_stride);
+            } else if (this->markers == mplot::markerstyle::rod) {
+                this->reserve_geometry (ncoords * this->tube_vertex_count (this->rod_segments()),
+                                        ncoords * this->tube_index_count (this->rod_segments()));
+            } else if constexpr (draw_spheres_as_geodesics) {
+                this->reserve_geometry (ncoords * this->geodesic_vertex_count (2), ncoords * this->geodesic_index_count (2));
+            } else {
+                this->reserve_geometry (ncoords * this->sphere_vertex_count (this->sphere_rings(), this->sphere_segments()),
+                                        ncoords * this->sphere_index_count (this->sphere_rings(), this->sphere_segments()));
+            }
 
             for (unsigned int i = 0; i < ncoords; ++i) {
                 // Scale colour (or use single colour)
                 std::array<float, 3> clr = this->cm.getHueRGB();
                 if (ndata && !nvdata) {
-                    clr = this->cm.convert (dcopy[i]);
+                    clr = this->cm.convert (this->dcolour[i]);
                 } else if (nvdata) {
-                    // Combine colour from two values. vdcopy1, vdcopy2? OR just do RGB for now?
+                    // Combine colour from two values. dcolour, dcolour2? OR just do RGB for now?
                     // ColourMap in 'dual hue' (or triple hue) mode.
-                    //std::cout << "Convert colour from vdcopy1[i]: " << vdcopy1[i] << ", vdcopy2[i]: " << vdcopy2[i] << std::endl;
-                    clr = this->cm.convert (vdcopy1[i], vdcopy2[i]);
+                    clr = this->cm.convert (this->dcolour[i], this->dcolour2[i]);
                 }
 
-                if (this->sizeFactor == Flt{0}) {
-                    this->marker ((*this->dataCoords)[i], clr, this->radiusFixed);
+                const Flt sz = this->marker_size (i, nvdata);
+                this->tessellation_extent ((*this->dataCoords)[i], 2.0f * static_cast<float>(sz));
+                if (this->markers == mplot::markerstyle::sphere_impostor) {
+                    this->add_sprite ((*this->dataCoords)[i], clr, this->impostor_size (sz));
+                } else if (this->instanced) {
+                    this->add_instance ((*this->dataCoords)[i], static_cast<float>(sz), clr);
                 } else {
-                    this->marker ((*this->dataCoords)[i], clr, dcopy[i] * this->sizeFactor);
+                    const std::size_t v0 = this->vertexPositions.size() / 3u;
+                    const std::size_t i0 = this->indices.size();
+                    this->marker ((*this->dataCoords)[i], clr, sz);
+                    this->marker_vertices = this->vertexPositions.size() / 3u - v0;
+                    this->marker_indices = this->indices.size() - i0;
                 }
+                this->marker_values.push_back (ndata && !nvdata ? (*this->scalarData)[i] : Flt{0});
 
                 if (this->labelIndices == true) {
                     // Draw an index label...
@@ -145,21 +320,205 @@ namespace mplot {
             }
         }
 
+        //! The size of the marker for point i (radiusFixed, or the scaled datum times sizeFactor)
+        Flt marker_size (const unsigned int i, const unsigned int nvdata) const
+        {
+            if (this->sizeFactor == Flt{0}) { return this->radiusFixed; }
+            return static_cast<Flt>(nvdata ? this->dcopy[i] : this->dcolour[i]) * this->sizeFactor;
+        }
+
+        //! The number of points (markers) in the model
+        std::size_t n_markers() const { return this->density ? this->density_points : this->marker_values.size(); }
+
+        /*!
+         * In density mode, count the x and y of dataCoords into density_bins bins of
+         * density_grid (which is the range of the data, if density_autoextent is set) and draw one
+         * rectangle there, coloured from the counts in a datum texture through the colour map.
+         */
+        void initializeDensity()
+        {
+            std::span<const sm::vec<float>> pts;
+            if (this->dataCoords != nullptr) { pts = std::span<const sm::vec<float>>(this->dataCoords->data(), this->dataCoords->size()); }
+            if (this->density_autoextent) {
+                this->density_grid = mplot::density::extent (pts, this->density_bins, this->density_threads);
+            } else {
+                this->density_grid.dims = this->density_bins;
+            }
+            this->density_max = mplot::density::bin (pts, this->density_grid, this->density_counts, this->density_threads);
+            this->density_points = pts.size();
+            this->datum_texture.resize (this->density_counts.size());
+            for (std::size_t k = 0; k < this->density_counts.size(); ++k) {
+                this->datum_texture[k] = mplot::density::texel (this->density_counts[k], this->density_log);
+            }
+            this->datum_texture_dims = this->density_bins;
+            this->reinit_datum_texture();
+            this->set_density_scale();
+            this->colour_by_datum_texture = true;
+            this->bake_colour_lut();
+
+            // One rectangle over the bins, whose corners carry the texture coordinates in their colours
+            const mplot::density::bin_grid& g = this->density_grid;
+            const std::array<std::array<float, 2>, 4> corners = { { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 0.0f, 1.0f }, { 1.0f, 1.0f } } };
+            for (const auto& c : corners) {
+                this->vertex_push (sm::vec<float>{ g.lo[0] + c[0] * (g.hi[0] - g.lo[0]), g.lo[1] + c[1] * (g.hi[1] - g.lo[1]), this->density_z },
+                                   this->vertexPositions);
+                this->vertex_push (std::array<float, 3>{ c[0], c[1], 0.0f }, this->vertexColors);
+                this->vertex_push (this->uz, this->vertexNormals);
+            }
+            this->indices.insert (this->indices.end(), { this->idx, this->idx + 1, this->idx + 2, this->idx + 2, this->idx + 1, this->idx + 3 });
+            this->idx += 4;
+        }
+
+        //! Count one more point in its bin, uploading just that texel (the extent is not changed)
+        void add_to_density (const sm::vec<float>& coord)
+        {
+            ++this->density_points;
+            const std::int64_t k = this->density_grid.bin_of (coord);
+            if (k < 0 || this->density_counts.empty()) { return; }
+            const std::size_t kk = static_cast<std::size_t>(k);
+            const float c = ++this->density_counts[kk];
+            this->datum_texture[kk] = mplot::density::texel (c, this->density_log);
+            const unsigned int w = this->density_grid.dims[0];
+            const unsigned int x = static_cast<unsigned int>(kk % w);
+            const unsigned int y = static_cast<unsigned int>(kk / w);
+            this->reinit_datum_texture (x, y, x + 1u, y + 1u);
+            if (c > this->density_max) {
+                // The colours of the other bins change by the uniform datum_scale only
+                this->density_max = c;
+                this->set_density_scale();
+            }
+            this->scene_changed();
+        }
+
+        //! Map the texels onto [0,1] for the colour lookup, so that the fullest bin takes the top of the colour map
+        void set_density_scale()
+        {
+            const float tmax = mplot::density::texel (this->density_max, this->density_log);
+            this->datum_scale = { tmax > 0.0f ? 1.0f / tmax : 1.0f, 0.0f };
+        }
+
+        /*!
+         * Extend data_range to include value. If colourScale.do_autoscale is set, rescale
+         * colourScale to the new range. Returns true if existing markers must be recoloured.
+         */
+        bool extend_range (const Flt value)
+        {
+            if (this->vector_coloured) { return false; }
+            if (this->range_set && value >= this->data_range[0] && value <= this->data_range[1]) { return false; }
+            const bool had_range = this->range_set;
+            this->data_range = had_range ? std::array<Flt, 2>{ std::min (this->data_range[0], value), std::max (this->data_range[1], value) }
+                                         : std::array<Flt, 2>{ value, value };
+            this->range_set = true;
+            if (!this->colourScale.do_autoscale || !(this->data_range[1] > this->data_range[0])) { return false; }
+            this->colourScale.compute_scaling (this->data_range[0], this->data_range[1]);
+            return had_range && this->n_markers() > 0;
+        }
+
+        //! A marker size as the proportion of the sprite radius that add_sprite takes
+        float impostor_size (const Flt sz) const
+        {
+            return this->sprite_radius > 0.0f ? static_cast<float>(sz) / this->sprite_radius : 0.0f;
+        }
+
+        /*!
+         * Choose the rings and segments of the sphere and rod markers from their size on the
+         * screen (see mplot/tessellation.h), if t is adaptive. When the level changes, an
+         * instanced model rebuilds only its one marker mesh; any other model is rebuilt from
+         * dataCoords, so one to which points have been add()ed, or with index labels, keeps the
+         * level that it has. Sphere impostors and density mode don't use the tessellation.
+         */
+        void setTessellation (const mplot::tessellation& t)
+        {
+            this->tessellation = t;
+            this->tessellation.reset();
+            this->lod_enabled = t.adaptive;
+        }
+
+        //! The rings and segments of a sphere marker (16 and 20 unless the tessellation is adaptive)
+        int sphere_rings() const { return this->tessellation.rings (16); }
+        int sphere_segments() const { return this->tessellation.segments (20); }
+        //! The segments of a rod marker (12 unless the tessellation is adaptive)
+        int rod_segments() const { return this->tessellation.segments (12); }
+
+        //! Rebuild the markers if the tessellation level changes with the view
+        void update_lod() override
+        {
+            if (this->density || this->markers == mplot::markerstyle::sphere_impostor) { return; }
+            if (!this->instanced) {
+                const std::size_t ncoords = this->dataCoords == nullptr ? 0u : this->dataCoords->size();
+                if (this->n_markers() > ncoords || this->labelIndices) { return; }
+            }
+            if (!this->update_tessellation()) { return; }
+            if (this->instanced) {
+                // Swap the marker mesh, keeping the instances
+                this->vertexPositions.clear();
+                this->vertexNormals.clear();
+                this->vertexColors.clear();
+                this->indices.clear();
+                this->idx = 0u;
+                this->marker_mesh();
+                this->reinit_buffers();
+            } else {
+                this->reinit();
+            }
+        }
+
         // The constexpr, unordered geodesic code is no slower than the regular
-        // VisualModel::computeSphere(), but leave this off for now (if true, C++-20 is
-        // required)
+        // VisualModel::computeSphere() (both copy a cached unit mesh, and an instanced
+        // ScatterVisual builds its one marker mesh from it), but leave this off for now
         static constexpr bool draw_spheres_as_geodesics = false;
 
         //! Set this->radiusFixed, then re-compute vertices.
         void setRadius (float fr)
         {
             this->radiusFixed = fr;
+            if (this->markers == mplot::markerstyle::sphere_impostor && this->sizeFactor == Flt{0}) {
+                // All the sprites are of size 1, so only the uniform radius changes
+                this->set_sprite_radius (fr);
+                return;
+            }
+            // Rebuild the whole model (an instanced model would otherwise keep its mesh)
+            this->indices.clear();
             this->reinit();
         }
 
+        //! The value of each point, from which recolour() colours it
+        std::vector<Flt> marker_values;
+        //! The range of the values of the points so far
+        std::array<Flt, 2> data_range = { Flt{0}, Flt{0} };
+        bool range_set = false;
+        //! True if the points are coloured from vector data (or all in the one hue), not by value
+        bool vector_coloured = false;
+        //! The number of vertices and indices in each marker (if not instanced or impostors)
+        std::size_t marker_vertices = 0;
+        std::size_t marker_indices = 0;
+
         // How to show the scatter points?
         markerstyle markers = mplot::markerstyle::sphere;
 
+        /*!
+         * If true (set before finalize), show the density of the points rather than a marker for
+         * each: the x and y of each point are counted into density_bins bins in data space (on
+         * density_threads threads, 0 for one per hardware thread) and one rectangle, at z =
+         * density_z, is coloured from the counts through the colour map. The rectangle costs the
+         * same to draw however many points there are, and the counts are recomputed only when
+         * the data change, not when the view does. add() counts one more point, uploading only its
+         * bin; update() is not available. The scalar data and the marker sizes are not used.
+         */
+        bool density = false;
+        std::array<unsigned int, 2> density_bins = { 256u, 256u };
+        //! If true, colour the bins by log(1 + count), so that sparse bins are not lost against full ones
+        bool density_log = false;
+        //! If true, the bins cover the range of the x and y of the data; otherwise set density_grid's lo and hi
+        bool density_autoextent = true;
+        mplot::density::bin_grid density_grid;
+        float density_z = 0.0f;
+        unsigned int density_threads = 0;
+        //! The count in each bin (in rows of density_bins[0]), the largest count and the number of points
+        std::vector<float> density_counts;
+        float density_max = 0.0f;
+        std::size_t density_points = 0;
+
         // Marker direction, if relevant. Used for length of rod markers
         sm::vec<float, 3> markerdirn = this->uz;
 
@@ -0,0 +1,205 @@
+/*!
+ * \file
+ *
+ * A VisualModel that holds many simple solids (rhombohedra, cuboids and flat polygons) in one set
+ * of vertex buffers. A scene of thousands of solids is then one model, with one vertex array
+ * and one draw call, rather than thousands of RhomboVisuals or PolygonVisuals.
+ *
+ * Each solid that is added is given a handle with which its placement and colour can be changed
+ * after finalize(). apply_updates() then uploads just the vertices of the changed solids (see
+ * VisualModelBase::mark_dirty).
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <functional>
+#include <cstddef>
+#include <stdexcept>
+#include <sm/vec>
+#include <sm/quaternion>
+#include <mplot/VisualModel.h>
+
+namespace mplot {
+
+    template<int glver = mplot::gl::version_4_1>
+    class SolidsBatchVisual : public VisualModel<glver>
+    {
+    public:
+        SolidsBatchVisual (const sm::vec<float, 3> _offset) : VisualModel<glver>(_offset) {}
+
+        //! A handle to a solid: its index in the order in which the solids were added
+        using handle = std::size_t;
+
+        /*!
+         * Add a rhombohedron with a corner at o and edges from o to x, y and z (as
+         * VisualModel::computeRhombus). The coordinates are in the solid's own frame, which is
+         * placed at the model's origin until set_placement is called. Add solids before
+         * finalize(), or call reinit() after adding them.
+         */
+        handle add_rhombus (const sm::vec<float>& o, const sm::vec<float>& x, const sm::vec<float>& y,
+                            const sm::vec<float>& z, const std::array<float, 3>& clr)
+        {
+            return this->add_solid ([o, x, y, z](SolidsBatchVisual<glver>* m, const std::array<float, 3>& c) {
+                m->computeRhombus (o, x, y, z, c);
+            }, clr);
+        }
+
+        //! Add a rectangular cuboid with a corner at o and sides wx, hy and dz along x, y and z
+        handle add_rect_cuboid (const sm::vec<float>& o, const float wx, const float hy, const float dz,
+                                const std::array<float, 3>& clr)
+        {
+            return this->add_solid ([o, wx, hy, dz](SolidsBatchVisual<glver>* m, const std::array<float, 3>& c) {
+                m->computeRectCuboid (o, wx, hy, dz, c);
+            }, clr);
+        }
+
+        //! Add a cuboid from its 8 corners (ordered as for VisualModel::computeCuboid)
+        handle add_cuboid (const std::array<sm::vec<float>, 8>& corners, const std::array<float, 3>& clr)
+        {
+            return this->add_solid ([corners](SolidsBatchVisual<glver>* m, const std::array<float, 3>& c) {
+                m->computeCuboid (corners, c);
+            }, clr);
+        }
+
+        //! Add a flat polygon of the given number of segments (as VisualModel::computeFlatPoly)
+        handle add_flat_poly (const sm::vec<float>& centre, const sm::vec<float>& _ux, const sm::vec<float>& _uy,
+                              const std::array<float, 3>& clr, const float r = 1.0f, const int segments = 12,
+                              const float rotation = 0.0f)
+        {
+            return this->add_solid ([centre, _ux, _uy, r, segments, rotation](SolidsBatchVisual<glver>* m,
+                                                                              const std::array<float, 3>& c) {
+                m->computeFlatPoly (centre, _ux, _uy, c, r, segments, rotation);
+            }, clr);
+        }
+
+        //! The number of solids
+        std::size_t size() const { return this->solids.size(); }
+
+        /*!
+         * Place solid h with its own frame rotated by rotn and then translated to offset (in the
+         * model frame). Call apply_updates() once all the solids have been changed.
+         */
+        void set_placement (const handle h, const sm::vec<float>& offset, const sm::quaternion<float>& rotn)
+        {
+            solid& s = this->solids.at (h);
+            s.offset = offset;
+            s.rotation = rotn;
+            s.placed = true;
+            if (this->built (s)) {
+                this->place (s);
+                this->mark_dirty (s.first_vertex, s.first_vertex + s.n_vertices);
+                this->placement_changed = true;
+            }
+        }
+
+        //! Move solid h to offset, keeping its rotation
+        void set_offset (const handle h, const sm::vec<float>& offset)
+        {
+            this->set_placement (h, offset, this->solids.at (h).rotation);
+        }
+
+        //! Change the colour of solid h. Call apply_updates() once all the solids have been changed.
+        void set_colour (const handle h, const std::array<float, 3>& clr)
+        {
+            solid& s = this->solids.at (h);
+            s.colour = clr;
+            if (this->built (s)) {
+                for (std::size_t i = s.first_vertex; i < s.first_vertex + s.n_vertices; ++i) {
+                    for (std::size_t j = 0; j < 3u; ++j) { this->vertexColors[3u * i + j] = clr[j]; }
+                }
+                this->mark_dirty_colours (s.first_vertex, s.first_vertex + s.n_vertices);
+                this->colour_changed = true;
+            }
+        }
+
+        //! Upload the vertices of the solids changed by set_placement, set_offset and set_colour
+        void apply_updates()
+        {
+            if (this->placement_changed) {
+                this->reinit_buffers();
+            } else if (this->colour_changed) {
+                this->reinit_colour_buffer();
+            }
+            this->placement_changed = false;
+            this->colour_changed = false;
+        }
+
+        void initializeVertices() override
+        {
+            for (solid& s : this->solids) {
+                s.first_vertex = this->vertexPositions.size() / 3u;
+                s.build (this, s.colour);
+                s.n_vertices = this->vertexPositions.size() / 3u - s.first_vertex;
+            }
+            // Keep the vertices in each solid's own frame, from which the solids are placed
+            this->local_posn = this->vertexPositions;
+            this->local_norm = this->vertexNormals;
+            for (const solid& s : this->solids) {
+                if (s.placed) { this->place (s); }
+            }
+            this->placement_changed = false;
+            this->colour_changed = false;
+        }
+
+    protected:
+        struct solid
+        {
+            //! Pushes the solid's vertices in its own frame
+            std::function<void(SolidsBatchVisual<glver>*, const std::array<float, 3>&)> build;
+            std::array<float, 3> colour = { 0.0f, 0.0f, 0.0f };
+            sm::vec<float> offset = { 0.0f, 0.0f, 0.0f };
+            sm::quaternion<float> rotation = {};
+            //! False until set_placement is first called for the solid
+            bool placed = false;
+            //! The solid's vertices; first_vertex is meaningful once the model has been built
+            std::size_t first_vertex = 0;
+            std::size_t n_vertices = 0;
+        };
+
+        handle add_solid (std::function<void(SolidsBatchVisual<glver>*, const std::array<float, 3>&)> build,
+                          const std::array<float, 3>& clr)
+        {
+            solid s;
+            s.build = std::move (build);
+            s.colour = clr;
+            this->solids.push_back (std::move (s));
+            return this->solids.size() - 1u;
+        }
+
+        //! True if solid s is in the vertex vectors
+        bool built (const solid& s) const
+        {
+            return s.n_vertices > 0 && 3u * (s.first_vertex + s.n_vertices) <= this->local_posn.size()
+            && this->local_posn.size() == this->vertexPositions.size();
+        }
+
+        //! Write the vertices of solid s from its own frame into the model frame
+        void place (const solid& s)
+        {
+            for (std::size_t i = s.first_vertex; i < s.first_vertex + s.n_vertices; ++i) {
+                const sm::vec<float> lp = { this->local_posn[3u * i], this->local_posn[3u * i + 1u], this->local_posn[3u * i + 2u] };
+                const sm::vec<float> ln = { this->local_norm[3u * i], this->local_norm[3u * i + 1u], this->local_norm[3u * i + 2u] };
+                const sm::vec<float> p = s.rotation * lp + s.offset;
+                const sm::vec<float> n = s.rotation * ln;
+                for (std::size_t j = 0; j < 3u; ++j) {
+                    this->vertexPositions[3u * i + j] = p[j];
+                    this->vertexNormals[3u * i + j] = n[j];
+                }
+            }
+        }
+
+        std::vector<solid> solids;
+        //! The vertex positions and normals of the solids in their own frames
+        std::vector<float> local_posn;
+        std::vector<float> local_norm;
+        //! Set when there are changes for apply_updates() to upload
+        bool placement_changed = false;
+        bool colour_changed = false;
+    };
+
+} // namespace mplot
@@ -46,6 +46,37 @@ namespace mplot {
         std::array<float, 3> colour = mplot::colour::black;
         //! The supported font to use when displaying a text string
         mplot::VisualFont font = mplot::VisualFont::DVSans;
+        /*!
+         * If true, the glyphs are drawn from a signed distance field atlas that is shared by all
+         * sizes of the font, rather than from a bitmap atlas rasterized at fontres (which is
+         * then ignored). The text stays crisp at any scale. Compile with MPLOT_SDF_TEXT defined
+         * to make this the default for all text.
+         */
+#ifdef MPLOT_SDF_TEXT
+        bool sdf = true;
+#else
+        bool sdf = false;
+#endif
+
+        //! The pixel resolution at which every signed distance field face is rasterized
+        static constexpr int sdf_fontres = 64;
+
+        /*!
+         * If true, the text always faces the camera: the text shader places the text's origin in
+         * the scene and lays its glyphs out in the plane of the screen, so rotating the scene or
+         * the model that holds the text needs no per-text counter-rotation (the text's own
+         * rotation, as set by setViewRotation on the text, is not applied).
+         */
+        bool billboard = false;
+
+        /*!
+         * In a VisualModel that declutters its texts (see VisualModel::setDeclutterTexts), of two
+         * overlapping texts, the one with the higher priority is drawn.
+         */
+        float priority = 0.0f;
+
+        //! The resolution of the face from which this text's glyphs come
+        int face_res() const { return this->sdf ? sdf_fontres : this->fontres; }
 
         // Maybe also things like rotate, centre_vert, etc
     };
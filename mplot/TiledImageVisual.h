@@ -0,0 +1,489 @@
+/*!
+ * \file
+ *
+ * A VisualModel that shows a single channel image that may be far too large to fit on the GPU
+ * (a gigapixel microscope slide or a map, say) by drawing it from tiles of a mip pyramid, as a
+ * virtual texture.
+ *
+ * Level 0 of the pyramid is the image at full resolution and each level above it has half the
+ * width and height of the level below, up to a top level that fits in one tile. Each frame, in
+ * update_lod(), the model finds the tiles that are in view and chooses for each the coarsest
+ * level at which its texels are no larger than texel_pixels pixels on the screen. Tiles are read
+ * on demand (from an mmapped raw file, from a cache of PNG tiles or by a client function) on
+ * worker threads, and are kept in a cache of GPU tiles, an atlas of cache_slots by cache_slots
+ * tiles in the datum texture, from which the least recently drawn tiles are evicted. While a tile
+ * loads, its part of the image is drawn from the nearest of its ancestors that is in the cache
+ * (the top tile always is). The datums are colour mapped through the colour lookup texture (see
+ * VisualModelBase::colour_by_datum_texture).
+ */
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <future>
+#include <chrono>
+#include <string>
+#include <functional>
+#include <exception>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+#include <sm/vec>
+#include <sm/vvec>
+#include <sm/mat44>
+#include <mplot/mapped_file.h>
+#include <mplot/loadpng.h>
+#include <mplot/VisualDataModel.h>
+
+namespace mplot {
+
+    template <typename T, int glver = mplot::gl::version_4_1>
+    struct TiledImageVisual : public VisualDataModel<T, glver>
+    {
+        /*!
+         * A function that reads the tile (tx, ty) of level level of the pyramid into px, which
+         * holds tile_size by tile_size datums, in rows from the top row of the tile. Only the
+         * part of px that lies within the image need be written. It returns false if there is
+         * no such tile. It is called on a worker thread.
+         */
+        using tile_loader = std::function<bool(unsigned int level, unsigned int tx, unsigned int ty, std::vector<T>& px)>;
+
+        //! Construct with the model offset
+        TiledImageVisual (const sm::vec<float> _offset)
+        {
+            this->mv_offset = _offset;
+            this->viewmatrix.translate (this->mv_offset);
+            this->colourScale.do_autoscale = true;
+            this->colour_by_datum_texture = true;
+            this->twodimensional = true;
+            this->lod_enabled = true;
+        }
+
+        //! Read tiles with the function ld from an image of dims (width, height) pixels
+        void setTileLoader (tile_loader ld, const std::array<unsigned int, 2> dims)
+        {
+            this->loads.clear();
+            this->loader = ld;
+            this->image_dims = dims;
+        }
+
+        /*!
+         * Read tiles from a file of width * height values of type T, in rows from the top row
+         * of the image, that is memory mapped. The tiles of the coarser levels are point
+         * sampled from the full resolution image (every second, fourth... pixel), so a file
+         * that holds a pyramid made with a proper filter is better loaded with setTileLoader.
+         */
+        void setRawFile (const std::string& path, const std::array<unsigned int, 2> dims)
+        {
+            auto mf = std::make_shared<mplot::mapped_file> (path);
+            if (mf->size() < std::size_t{dims[0]} * dims[1] * sizeof (T)) {
+                throw std::runtime_error ("TiledImageVisual::setRawFile: the file is smaller than the image");
+            }
+            const unsigned int ts = this->tile_size;
+            this->setTileLoader ([mf, dims, ts](unsigned int level, unsigned int tx, unsigned int ty, std::vector<T>& px)
+            {
+                const T* img = reinterpret_cast<const T*>(mf->data());
+                for (std::size_t j = 0; j < ts; ++j) {
+                    const std::size_t y = ((std::size_t{ty} * ts + j) << level);
+                    if (y >= dims[1]) { break; }
+                    for (std::size_t i = 0; i < ts; ++i) {
+                        const std::size_t x = ((std::size_t{tx} * ts + i) << level);
+                        if (x >= dims[0]) { break; }
+                        px[j * ts + i] = img[y * dims[0] + x];
+                    }
+                }
+                return true;
+            }, dims);
+        }
+
+        /*!
+         * Read tiles from a cache of PNG images, dir/level/ty_tx.png (dir/0/0_0.png is the top
+         * left tile at full resolution), each tile_size pixels square, or smaller at the right
+         * and bottom edges of the image. The PNGs are read as grey values (see mplot::loadpng),
+         * so T should be float, double, unsigned int or unsigned char.
+         */
+        void setPngTiles (const std::string& dir, const std::array<unsigned int, 2> dims)
+        {
+            const unsigned int ts = this->tile_size;
+            this->setTileLoader ([dir, ts](unsigned int level, unsigned int tx, unsigned int ty, std::vector<T>& px)
+            {
+                sm::vvec<T> png;
+                sm::vec<unsigned int, 2> pd = {};
+                try {
+                    pd = mplot::loadpng (dir + "/" + std::to_string (level) + "/"
+                                         + std::to_string (ty) + "_" + std::to_string (tx) + ".png", png, { false, false });
+                } catch (const std::exception&) {
+                    return false; // A missing tile
+                }
+                const std::size_t w = std::min (pd[0], ts);
+                for (std::size_t j = 0; j < std::min (pd[1], ts); ++j) {
+                    std::copy_n (png.begin() + j * pd[0], w, px.begin() + j * ts);
+                }
+                return true;
+            }, dims);
+        }
+
+        //! The number of levels in the pyramid
+        unsigned int n_levels() const
+        {
+            if (this->image_dims[0] == 0 || this->image_dims[1] == 0 || this->tile_size == 0) { return 0; }
+            unsigned int l = 0;
+            while (this->level_dims (l)[0] > this->tile_size || this->level_dims (l)[1] > this->tile_size) { ++l; }
+            return l + 1;
+        }
+
+        //! The width and height, in texels, of level l of the pyramid
+        std::array<unsigned int, 2> level_dims (const unsigned int l) const
+        {
+            const std::uint64_t s = std::uint64_t{1} << l;
+            return { static_cast<unsigned int>((this->image_dims[0] + s - 1) / s),
+                     static_cast<unsigned int>((this->image_dims[1] + s - 1) / s) };
+        }
+
+        //! The number of tiles in the cache that hold a tile of the image
+        std::size_t resident_tiles() const { return this->resident.size(); }
+
+        //! The number of tiles that are loading
+        std::size_t loading_tiles() const { return this->loads.size(); }
+
+        //! Drop the cached tiles and read them again, colour scaled afresh (after a change of
+        //! the source or of the colourScale)
+        void reinitTiles()
+        {
+            this->loads.clear();
+            this->reinit();
+        }
+
+        //! Allocate the tile cache, read the top tile and draw the image from it
+        void initializeVertices()
+        {
+            this->loads.clear();
+            this->resident.clear();
+            this->lru.clear();
+            this->failed.clear();
+            this->drawn.clear();
+            const unsigned int nl = this->n_levels();
+            if (nl == 0 || !this->loader || this->cache_slots == 0) { return; }
+            this->top_level = nl - 1;
+
+            const unsigned int a = this->cache_slots * this->tile_size;
+            this->datum_texture_dims = { a, a };
+            this->datum_texture.assign (std::size_t{a} * a, 0.0f);
+            this->free_slots.clear();
+            for (unsigned int s = this->cache_slots * this->cache_slots; s > 1; --s) { this->free_slots.push_back (s - 1); }
+            if (this->colour_lut.empty()) { this->bake_colour_lut(); }
+
+            // The top tile is read now, and sets the colour scaling (if it is autoscaled)
+            std::vector<T> px (std::size_t{this->tile_size} * this->tile_size, T{0});
+            if (!this->loader (this->top_level, 0, 0, px)) {
+                throw std::runtime_error ("TiledImageVisual: the top tile of the image could not be read");
+            }
+            if (this->colourScale.do_autoscale == true) {
+                this->colourScale.reset();
+                const std::array<unsigned int, 2> e = this->tile_extent (this->top_level, 0, 0);
+                std::vector<T> valid;
+                for (unsigned int j = 0; j < e[1]; ++j) {
+                    valid.insert (valid.end(), px.begin() + j * this->tile_size, px.begin() + j * this->tile_size + e[0]);
+                }
+                std::vector<float> scaled (valid.size());
+                this->colourScale.transform (valid, scaled);
+            }
+            this->write_slot (0, px);
+            this->resident[tile_key (this->top_level, 0, 0)] = { 0u, this->lru.end(), 0u };
+            this->reinit_datum_texture();
+
+            this->drawn.push_back ({ tile_key (this->top_level, 0, 0), tile_key (this->top_level, 0, 0) });
+            this->push_quads();
+        }
+
+        //! Choose the tiles for this frame, start loading those that are missing, and draw the
+        //! image with the tiles that are in the cache
+        void update_lod() override
+        {
+            if (this->lod_viewport_h <= 0 || this->resident.empty()) { return; }
+            ++this->frame;
+            this->take_loads();
+
+            const std::vector<std::uint64_t> wanted = this->select_tiles();
+
+            // Draw each wanted tile, or the nearest ancestor of it that is in the cache
+            std::vector<std::array<std::uint64_t, 2>> d;
+            d.reserve (wanted.size());
+            bool missing = false;
+            for (const std::uint64_t k : wanted) {
+                std::uint64_t src = k;
+                while (!this->resident.count (src)) {
+                    missing = true;
+                    src = parent_key (src);
+                }
+                if (src != k) { this->request (k); }
+                this->touch (src);
+                d.push_back ({ k, src });
+            }
+            if (d != this->drawn) {
+                this->drawn = d;
+                this->vertexPositions.clear();
+                this->vertexNormals.clear();
+                this->vertexColors.clear();
+                this->indices.clear();
+                this->idx = 0u;
+                this->push_quads();
+                this->reinit_buffers();
+            }
+            // Keep the frames coming until the tiles that are wanted have arrived
+            if (missing || !this->loads.empty()) { this->scene_changed(); }
+        }
+
+        //! The width and height of the image, in pixels
+        std::array<unsigned int, 2> image_dims = { 0u, 0u };
+        //! The width of the image in the scene (its height follows from its aspect ratio)
+        float width = 1.0f;
+        //! The width and height of a tile, in texels. Set before setRawFile or setPngTiles.
+        unsigned int tile_size = 256;
+        //! The cache holds cache_slots by cache_slots tiles. Set before finalize().
+        unsigned int cache_slots = 8;
+        //! A tile is replaced by its four children when its texels are larger than this on the screen, in pixels
+        float texel_pixels = 1.0f;
+        //! The most tiles that may be loading at once
+        unsigned int max_loads = 4;
+
+    protected:
+        //! A tile in the cache: its slot, its place in lru and the frame in which it was last drawn
+        struct resident_tile
+        {
+            unsigned int slot = 0;
+            std::list<std::uint64_t>::iterator lru_it;
+            std::uint64_t frame = 0;
+        };
+
+        //! The key of tile (tx, ty) of level l
+        static constexpr std::uint64_t tile_key (const unsigned int l, const unsigned int tx, const unsigned int ty)
+        {
+            return (std::uint64_t{l} << 48) | (std::uint64_t{ty} << 24) | std::uint64_t{tx};
+        }
+        static constexpr unsigned int key_level (const std::uint64_t k) { return static_cast<unsigned int>(k >> 48); }
+        static constexpr unsigned int key_y (const std::uint64_t k) { return static_cast<unsigned int>((k >> 24) & 0xffffff); }
+        static constexpr unsigned int key_x (const std::uint64_t k) { return static_cast<unsigned int>(k & 0xffffff); }
+        static constexpr std::uint64_t parent_key (const std::uint64_t k)
+        {
+            return tile_key (key_level (k) + 1, key_x (k) / 2, key_y (k) / 2);
+        }
+
+        //! The number of texels across and down tile (tx, ty) of level l that lie within the image
+        std::array<unsigned int, 2> tile_extent (const unsigned int l, const unsigned int tx, const unsigned int ty) const
+        {
+            const std::array<unsigned int, 2> ld = this->level_dims (l);
+            return { std::min (this->tile_size, ld[0] - std::min (ld[0], tx * this->tile_size)),
+                     std::min (this->tile_size, ld[1] - std::min (ld[1], ty * this->tile_size)) };
+        }
+
+        //! The corners (left, top, right, bottom) of tile k in model coordinates. Row 0 of the
+        //! image is at the top and the bottom left corner of the image is at the origin.
+        std::array<float, 4> tile_rect (const std::uint64_t k) const
+        {
+            const float px = this->width / static_cast<float>(this->image_dims[0]);
+            const float h = px * static_cast<float>(this->image_dims[1]);
+            const std::uint64_t s = std::uint64_t{this->tile_size} << key_level (k);
+            const float x0 = static_cast<float>(key_x (k) * s);
+            const float y0 = static_cast<float>(key_y (k) * s);
+            const float x1 = static_cast<float>(std::min (std::uint64_t{this->image_dims[0]}, (key_x (k) + 1) * s));
+            const float y1 = static_cast<float>(std::min (std::uint64_t{this->image_dims[1]}, (key_y (k) + 1) * s));
+            return { x0 * px, h - y0 * px, x1 * px, h - y1 * px };
+        }
+
+        /*!
+         * Descend the pyramid from the top tile, a level at a time, replacing each tile whose
+         * texels are larger than texel_pixels on the screen by its children that are in view.
+         * No more than half of the cache is wanted, so that the ancestors that stand in for the
+         * wanted tiles while they load can stay in the cache too.
+         */
+        std::vector<std::uint64_t> select_tiles() const
+        {
+            const sm::mat44<float> mvp = this->lod_projection * this->scenematrix * this->model_matrix();
+            const float vp_h = static_cast<float>(this->lod_viewport_h);
+            // The viewport's width follows from the aspect ratio in the projection
+            const float vp_w = this->lod_projection.mat[0] != 0.0f ? vp_h * this->lod_projection.mat[5] / this->lod_projection.mat[0] : vp_h;
+            const std::size_t budget = std::max (std::size_t{1}, std::size_t{this->cache_slots} * this->cache_slots / 2);
+
+            // The extent of tile k on the screen, in pixels, or -1 for a tile out of view
+            auto screen_extent = [&](const std::uint64_t k)
+            {
+                const std::array<float, 4> r = this->tile_rect (k);
+                float nx0 = 2.0f, nx1 = -2.0f, ny0 = 2.0f, ny1 = -2.0f;
+                for (const auto& c : { sm::vec<float, 2>{ r[0], r[1] }, sm::vec<float, 2>{ r[2], r[1] },
+                                       sm::vec<float, 2>{ r[2], r[3] }, sm::vec<float, 2>{ r[0], r[3] } }) {
+                    const sm::vec<float, 4> cp = mvp * sm::vec<float, 4>{ c[0], c[1], 0.0f, 1.0f };
+                    if (cp[3] <= 0.0f) { return sm::vec<float, 2>{ vp_w, vp_h }; } // Behind the eye; assume it's in view
+                    nx0 = std::min (nx0, cp[0] / cp[3]);
+                    nx1 = std::max (nx1, cp[0] / cp[3]);
+                    ny0 = std::min (ny0, cp[1] / cp[3]);
+                    ny1 = std::max (ny1, cp[1] / cp[3]);
+                }
+                if (nx1 < -1.0f || nx0 > 1.0f || ny1 < -1.0f || ny0 > 1.0f) { return sm::vec<float, 2>{ -1.0f, -1.0f }; }
+                return sm::vec<float, 2>{ (nx1 - nx0) * 0.5f * vp_w, (ny1 - ny0) * 0.5f * vp_h };
+            };
+            auto too_coarse = [&](const std::uint64_t k)
+            {
+                if (key_level (k) == 0) { return false; }
+                const sm::vec<float, 2> e = screen_extent (k);
+                const std::array<unsigned int, 2> t = this->tile_extent (key_level (k), key_x (k), key_y (k));
+                return std::max (e[0] / static_cast<float>(t[0]), e[1] / static_cast<float>(t[1])) > this->texel_pixels;
+            };
+
+            std::vector<std::uint64_t> sel = { tile_key (this->top_level, 0, 0) };
+            for (bool refined = true; refined; ) {
+                refined = false;
+                std::vector<std::uint64_t> next;
+                for (std::size_t i = 0; i < sel.size(); ++i) {
+                    const std::uint64_t k = sel[i];
+                    if (too_coarse (k)) {
+                        std::vector<std::uint64_t> c;
+                        const unsigned int l = key_level (k) - 1;
+                        const std::array<unsigned int, 2> ld = this->level_dims (l);
+                        for (unsigned int cy = key_y (k) * 2; cy < key_y (k) * 2 + 2 && cy * this->tile_size < ld[1]; ++cy) {
+                            for (unsigned int cx = key_x (k) * 2; cx < key_x (k) * 2 + 2 && cx * this->tile_size < ld[0]; ++cx) {
+                                if (screen_extent (tile_key (l, cx, cy))[0] >= 0.0f) { c.push_back (tile_key (l, cx, cy)); }
+                            }
+                        }
+                        if (next.size() + c.size() + (sel.size() - i - 1) <= budget) {
+                            next.insert (next.end(), c.begin(), c.end());
+                            refined = true;
+                            continue;
+                        }
+                    }
+                    next.push_back (k);
+                }
+                sel.swap (next);
+            }
+            return sel;
+        }
+
+        //! Start loading tile k on a worker thread, if it isn't loading, there is room and it exists
+        void request (const std::uint64_t k)
+        {
+            if (this->loads.count (k) || this->failed.count (k) || this->loads.size() >= this->max_loads) { return; }
+            const std::size_t n = std::size_t{this->tile_size} * this->tile_size;
+            this->loads[k] = std::async (std::launch::async, [ld = this->loader, k, n]()
+            {
+                std::vector<T> px (n, T{0});
+                if (!ld (key_level (k), key_x (k), key_y (k), px)) { px.clear(); }
+                return px;
+            });
+        }
+
+        //! Put the tiles that have finished loading into the cache
+        void take_loads()
+        {
+            for (auto it = this->loads.begin(); it != this->loads.end(); ) {
+                if (it->second.wait_for (std::chrono::seconds (0)) != std::future_status::ready) { ++it; continue; }
+                const std::uint64_t k = it->first;
+                std::vector<T> px = it->second.get();
+                it = this->loads.erase (it);
+                if (px.empty()) { this->failed.insert (k); continue; }
+                unsigned int slot = 0;
+                if (!this->free_slots.empty()) {
+                    slot = this->free_slots.back();
+                    this->free_slots.pop_back();
+                } else if (!this->lru.empty() && this->resident[this->lru.back()].frame + 1 < this->frame) {
+                    // Evict the least recently drawn tile (if it wasn't drawn in the last frame)
+                    slot = this->resident[this->lru.back()].slot;
+                    this->resident.erase (this->lru.back());
+                    this->lru.pop_back();
+                } else {
+                    continue; // No room; the tile will be requested again
+                }
+                this->write_slot (slot, px);
+                this->lru.push_front (k);
+                this->resident[k] = { slot, this->lru.begin(), 0u };
+                const unsigned int sx = (slot % this->cache_slots) * this->tile_size;
+                const unsigned int sy = (slot / this->cache_slots) * this->tile_size;
+                this->reinit_datum_texture (sx, sy, sx + this->tile_size, sy + this->tile_size);
+            }
+        }
+
+        //! Mark tile k as drawn in this frame
+        void touch (const std::uint64_t k)
+        {
+            resident_tile& r = this->resident[k];
+            r.frame = this->frame;
+            if (r.lru_it != this->lru.end()) { this->lru.splice (this->lru.begin(), this->lru, r.lru_it); }
+        }
+
+        //! Colour scale the datums px of a tile into slot s of the cache
+        void write_slot (const unsigned int s, const std::vector<T>& px)
+        {
+            const std::size_t a = this->datum_texture_dims[0];
+            const std::size_t x0 = (s % this->cache_slots) * this->tile_size;
+            const std::size_t y0 = (s / this->cache_slots) * this->tile_size;
+            for (std::size_t j = 0; j < this->tile_size; ++j) {
+                for (std::size_t i = 0; i < this->tile_size; ++i) {
+                    this->datum_texture[(y0 + j) * a + x0 + i] = this->colourScale.transform_one (px[j * this->tile_size + i]);
+                }
+            }
+        }
+
+        //! Add a quad for each of the drawn tiles, textured from the part of its source tile that it covers
+        void push_quads()
+        {
+            const float a = static_cast<float>(this->datum_texture_dims[0]);
+            for (const auto& [k, src] : this->drawn) {
+                const std::array<float, 4> r = this->tile_rect (k);
+                const unsigned int slot = this->resident[src].slot;
+                // Tile k's texels within its source tile, which is d levels above it
+                const float ds = static_cast<float>(1u << (key_level (src) - key_level (k)));
+                const std::array<unsigned int, 2> e = this->tile_extent (key_level (k), key_x (k), key_y (k));
+                const float tx0 = static_cast<float>(key_x (k) * this->tile_size) / ds - static_cast<float>(key_x (src) * this->tile_size);
+                const float ty0 = static_cast<float>(key_y (k) * this->tile_size) / ds - static_cast<float>(key_y (src) * this->tile_size);
+                const float sx = static_cast<float>((slot % this->cache_slots) * this->tile_size);
+                const float sy = static_cast<float>((slot / this->cache_slots) * this->tile_size);
+                const float u0 = (sx + tx0) / a;
+                const float u1 = (sx + tx0 + static_cast<float>(e[0]) / ds) / a;
+                const float v0 = (sy + ty0) / a;
+                const float v1 = (sy + ty0 + static_cast<float>(e[1]) / ds) / a;
+                // The vertex colours hold the texture coordinates, with the tile's top row at the top
+                auto corner = [this](const float x, const float y, const float u, const float v)
+                {
+                    this->vertex_push (x, y, 0.0f, this->vertexPositions);
+                    this->vertex_push (0.0f, 0.0f, 1.0f, this->vertexNormals);
+                    this->vertex_push (u, v, 0.0f, this->vertexColors);
+                };
+                corner (r[0], r[3], u0, v1);
+                corner (r[2], r[3], u1, v1);
+                corner (r[2], r[1], u1, v0);
+                corner (r[0], r[1], u0, v0);
+                this->indices.insert (this->indices.end(), { this->idx, this->idx + 1, this->idx + 2,
+                                                              this->idx, this->idx + 2, this->idx + 3 });
+                this->idx += 4;
+            }
+        }
+
+        //! The source of the tiles
+        tile_loader loader;
+        //! The top level of the pyramid, whose one tile is always in slot 0 of the cache
+        unsigned int top_level = 0;
+        //! The tiles in the cache, by key. The top tile is not in lru, so it is never evicted.
+        std::unordered_map<std::uint64_t, resident_tile> resident;
+        //! The keys of the evictable tiles in the cache, the most recently drawn first
+        std::list<std::uint64_t> lru;
+        //! The slots of the cache that hold no tile
+        std::vector<unsigned int> free_slots;
+        //! Tiles that the loader could not read
+        std::unordered_set<std::uint64_t> failed;
+        //! The tiles drawn, each with the tile in the cache from which it is textured (itself or an ancestor)
+        std::vector<std::array<std::uint64_t, 2>> drawn;
+        //! Counts the calls of update_lod
+        std::uint64_t frame = 0;
+        //! The tiles that are loading. Declared last so that it is destroyed (waiting for the
+        //! loads) before the members the loads might use.
+        std::map<std::uint64_t, std::future<std::vector<T>>> loads;
+    };
+
+} // namespace mplot
@@ -7,6 +7,7 @@
 #include <vector>
 #include <array>
 #include <stdexcept>
+#include <cstddef>
 
 #include <sm/vec>
 
@@ -34,12 +35,56 @@ namespace mplot {
 
         void initializeVertices()
         {
+            if (this->console_capacity > 0u) {
+                this->initializeConsole();
+                return;
+            }
             // No op, but add text
             this->addLabel (this->text, sm::vec<float>({0,0,0}), this->tfeatures);
         }
 
+        //! In console mode, append a line (or lines, split at newlines) to the log
+        void appendLine (const std::string& line)
+        {
+            if (this->console == nullptr) { throw std::runtime_error ("TxtVisual::appendLine: not a console, or not finalized"); }
+            this->console->appendLine (line);
+        }
+
+        //! In console mode, show the lines that end lines_back before the newest (0 to follow the newest)
+        void scrollBack (const std::size_t lines_back)
+        {
+            if (this->console != nullptr) { this->console->scrollConsole (lines_back); }
+        }
+
         std::string text;
         mplot::TextFeatures tfeatures;
+
+        /*!
+         * If console_capacity is not 0 (set before finalize), the TxtVisual is a console: a
+         * scrolling log of up to console_capacity lines, each cut to console_columns glyphs, of
+         * which the newest console_rows are shown, going down from the model's offset. text, if
+         * not empty, is its first line. Lines are added with appendLine(), which writes only
+         * their quads into the console's fixed buffers, so thousands of lines a second cost
+         * little. See VisualTextModel::setupConsole.
+         */
+        std::size_t console_capacity = 0;
+        std::size_t console_columns = 80;
+        std::size_t console_rows = 24;
+
+    protected:
+        //! The console's text model (owned by this->texts)
+        mplot::VisualTextModel<glver>* console = nullptr;
+
+        void initializeConsole()
+        {
+            if (this->setContext != nullptr) { this->setContext (this->parentVis); }
+            auto tmup = this->makeVisualTextModel (this->tfeatures);
+            tmup->setupConsole (this->console_capacity, this->console_columns, this->console_rows, this->mv_offset, this->tfeatures.colour);
+            if (!this->text.empty()) { tmup->appendLine (this->text); }
+            this->console = tmup.get();
+            this->texts.push_back (std::move (tmup));
+            if (this->releaseContext != nullptr) { this->releaseContext (this->parentVis); }
+        }
     };
 
 } // namespace mplot
@@ -42,6 +42,25 @@ namespace mplot {
     {
         Visual (const int _width, const int _height, const std::string& _title, const bool _version_stdout = true)
             : mplot::VisualMX<glver> (_width, _height, _title, _version_stdout) {}
+
+        //! Construct a Visual whose window shares its OpenGL context with that of _share
+        Visual (const int _width, const int _height, const std::string& _title, Visual<glver>& _share,
+                const bool _version_stdout = true)
+            : mplot::VisualMX<glver> (_width, _height, _title, _share, _version_stdout) {}
     };
 
 } // namespace mplot
+
+#if defined MPLOT_CORE
+// Instantiated once, in the compiled mplot_core library (see core/visual.cpp)
+namespace mplot {
+    extern template class VisualBase<mplot::gl::version_4_1>;
+    extern template class VisualBase<mplot::gl::version_4_5>;
+    extern template class VisualOwnableMX<mplot::gl::version_4_1>;
+    extern template class VisualOwnableMX<mplot::gl::version_4_5>;
+    extern template class VisualMX<mplot::gl::version_4_1>;
+    extern template class VisualMX<mplot::gl::version_4_5>;
+    extern template struct Visual<mplot::gl::version_4_1>;
+    extern template struct Visual<mplot::gl::version_4_5>;
+} // namespace mplot
+#endif
@@ -14,12 +14,25 @@
 #include <vector>
 #include <memory>
 #include <functional>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <fstream>
+#include <sstream>
+#include <future>
+#include <thread>
+#include <exception>
+#include <algorithm>
+#include <chrono>
+#include <utility>
+#include <unordered_map>
 
 #include <sm/flags>
 #include <sm/quaternion>
 #include <sm/mat44>
 #include <sm/vec>
+#include <sm/range>
 
 #include <mplot/gl/version.h>
 #include <mplot/VisualModel.h>
@@ -33,6 +46,7 @@
 #include <nlohmann/json.hpp>
 #include <mplot/CoordArrows.h>
 #include <mplot/tools.h>
+#include <mplot/slot_map.h>
 
 
 #include <mplot/VisualDefaultShaders.h>
@@ -41,6 +55,16 @@
 #define LODEPNG_NO_COMPILE_DECODER 1
 #define LODEPNG_NO_COMPILE_ANCILLARY_CHUNKS 1
 #include <mplot/lodepng.h>
+#include <mplot/frame_recorder.h>
+#include <mplot/frame_streamer.h>
+#include <mplot/glb_animation.h>
+#include <mplot/frame_profiler.h>
+#include <mplot/frame_pacer.h>
+#include <mplot/render_scaler.h>
+#include <mplot/screen_rect.h>
+#include <mplot/memory_report.h>
+#include <mplot/startup_profile.h>
+#include <mplot/frame_tasks.h>
 
 namespace mplot {
 
@@ -76,7 +100,27 @@ namespace mplot {
         //! If true, output mplot version to stdout
         versionStdout,
         //! If true (the default), then call swapBuffers() at the end of render()
-        renderSwapsBuffers
+        renderSwapsBuffers,
+        //! If true (the default), keepOpen() and pauseOpen() render only when the scene has
+        //! changed (see requestRedraw), rather than at 60 Hz
+        renderOnDemand,
+        //! If true, and the Visual is profiling (see startProfiling), show the latest frame
+        //! profile's times and counts in the window
+        showProfile,
+        //! If true, blend translucent models order independently (see orderIndependentTransparency)
+        orderIndependentTransparency,
+        //! If true, draw the cylindrical projection by way of a cube map (see cylindricalCubeMap)
+        cylindricalCubeMap,
+        //! If true, smooth the edges in each frame with an FXAA pass (see antiAliasing)
+        fxaa,
+        //! If true, draw the models in order of their depth (see sortModels)
+        sortModels,
+        //! If true (the default on OpenGL ES), render in the way that suits tiled mobile GPUs (see tiledGpuProfile)
+        tiledGpuProfile,
+        //! If true, redraw only the part of the frame in which models changed (see partialRedraw)
+        partialRedraw,
+        //! If true, show a summary of the Visual's memory report in the window (see getMemoryReport)
+        showMemory
     };
 
     //! Whether to render with perspective or orthographic (or even a cylindrical projection)
@@ -174,6 +218,226 @@ namespace mplot {
         //! failure. Set transparent_bg to get a transparent background.
         virtual sm::vec<int, 2> saveImage (const std::string& img_filename, const bool transparent_bg = false) = 0;
 
+        /*!
+         * Start a screenshot of the window without stalling the frame. The pixels are read into
+         * a pixel pack buffer and mapped by a later render() (once the GPU has written them), and
+         * the PNG is encoded on a worker thread. The future gives the width and height of the
+         * image, or {-1, -1} on failure.
+         */
+        virtual std::future<sm::vec<int, 2>> saveImageAsync (const std::string& img_filename, const bool transparent_bg = false) = 0;
+
+        //! What pick() finds under a pixel
+        struct pick_result
+        {
+            static constexpr std::uint32_t no_element = std::numeric_limits<std::uint32_t>::max();
+            //! The model, or nullptr if the pixel shows the background (or a text, polyline or bar)
+            mplot::VisualModel<glver>* model = nullptr;
+            //! The index of the model's element (see VisualModel::render_pick), or no_element if
+            //! it is not known
+            std::uint32_t element = no_element;
+        };
+
+        /*!
+         * Find the model and element under the window coordinates (x, y), as given to
+         * cursor_position_callback, in the scene as it was last rendered. The first call
+         * compiles the ID pass programs and makes an integer framebuffer the size of the
+         * viewport. Each call draws the models into it with one pixel scissored out, and reads
+         * that pixel back through a pixel pack buffer, waiting for the GPU. Not available in the
+         * cylindrical projection. See also setPickCallback.
+         */
+        virtual pick_result pick (const double x, const double y) = 0;
+
+        /*!
+         * Pick whatever is under the cursor whenever it moves, without waiting for the GPU. Each
+         * cursor move requests a redraw; the render() after it starts the pick, and a later
+         * render() passes the result to on_pick once the GPU has written the pixel. Pass nullptr
+         * to stop picking.
+         */
+        void setPickCallback (std::function<void(const pick_result&)> on_pick)
+        {
+            this->pick_callback = std::move (on_pick);
+            this->pick_wanted = false;
+        }
+
+        /*!
+         * Start recording. From now on, every frame that render() draws is read back (as for
+         * saveImageAsync) and queued for a pool of encoder threads, which write a numbered PNG
+         * sequence or raw frames to ro.raw_stream. Frames are dropped, and counted, if the
+         * encoders fall behind; render() never waits for them.
+         */
+        void startRecording (const mplot::recording_options& ro = {})
+        {
+            if (this->recorder) { throw std::runtime_error ("VisualBase::startRecording: already recording"); }
+            this->recorder = std::make_unique<mplot::frame_recorder> (ro);
+        }
+
+        //! Stop recording, once the frames that have been captured are written. Returns the final stats.
+        virtual mplot::recording_stats stopRecording() = 0;
+
+        //! Is the Visual recording?
+        bool recording() const { return this->recorder != nullptr; }
+
+        //! How many frames have been captured, written and dropped since startRecording
+        mplot::recording_stats getRecordingStats() const
+        {
+            return this->recorder ? this->recorder->get_stats() : mplot::recording_stats{};
+        }
+
+        /*!
+         * Start streaming. From now on, the frames that render() draws are read back (as for
+         * saveImageAsync), encoded as JPEGs and served over HTTP as an MJPEG stream, with a page
+         * (at http://address:port/) that shows it and passes the keyboard and mouse events back
+         * to this Visual's callbacks (see mplot::frame_streamer). Frames are only read back while
+         * a client is watching, and are dropped to keep to so.max_fps and
+         * so.max_bytes_per_second; render() never waits for the clients. Throws if the server
+         * can't listen on so.address and so.port.
+         */
+        void startStreaming (const mplot::streaming_options& so = {})
+        {
+            if (this->streamer) { throw std::runtime_error ("VisualBase::startStreaming: already streaming"); }
+            // Input from a client wakes keepOpen() to render it
+            this->streamer = std::make_unique<mplot::frame_streamer> (so, [this]() { this->requestRedraw(); });
+        }
+
+        //! Stop streaming, closing the clients' connections. Returns the final stats.
+        mplot::streaming_stats stopStreaming()
+        {
+            if (!this->streamer) { return {}; }
+            mplot::streaming_stats ss = this->streamer->finish();
+            this->streamer.reset (nullptr);
+            return ss;
+        }
+
+        //! Is the Visual streaming?
+        bool streaming() const { return this->streamer != nullptr; }
+
+        //! The port that the stream is served on (useful if streaming_options::port was 0)
+        unsigned short streamingPort() const { return this->streamer ? this->streamer->port() : 0; }
+
+        //! How many frames have been encoded, sent and dropped since startStreaming
+        mplot::streaming_stats getStreamingStats() const
+        {
+            return this->streamer ? this->streamer->get_stats() : mplot::streaming_stats{};
+        }
+
+        /*!
+         * Start exporting an animation of model to glb_file (see mplot::glb_animation). Each
+         * call of addAnimationFrame then adds the model's current colours (and, if o.positions,
+         * its positions) as a frame, which is written to disk straight away; the mesh itself is
+         * written once, from the first frame. The file is complete once stopAnimationExport is
+         * called. Throws if an export is already under way or model is not in this Visual.
+         */
+        void startAnimationExport (const std::string& glb_file, const mplot::VisualModel<glver>* model,
+                                   const mplot::glb_animation_options& o = {})
+        {
+            if (this->animation) { throw std::runtime_error ("VisualBase::startAnimationExport: already exporting"); }
+            const model_handle h = this->getVisualModelHandle (model);
+            if (this->getVisualModel (h) == nullptr) {
+                throw std::runtime_error ("VisualBase::startAnimationExport: the model is not in this Visual");
+            }
+            this->animation = std::make_unique<mplot::glb_animation> (glb_file, o);
+            this->animation_model = h;
+        }
+
+        /*!
+         * Add the exported model's current state as a frame at time t (in seconds, and greater
+         * than that of the last frame). Call it after each update of the model's data.
+         */
+        void addAnimationFrame (const float t)
+        {
+            if (!this->animation) { throw std::runtime_error ("VisualBase::addAnimationFrame: not exporting"); }
+            mplot::VisualModel<glver>* m = this->getVisualModel (this->animation_model);
+            if (m == nullptr) { throw std::runtime_error ("VisualBase::addAnimationFrame: the exported model has been removed"); }
+            m->add_glb_animation_frame (*this->animation, t);
+        }
+
+        //! Finish the animation's glb file. Returns the number of frames that it holds.
+        std::size_t stopAnimationExport()
+        {
+            if (!this->animation) { return 0u; }
+            const std::size_t nf = this->animation->frames();
+            std::unique_ptr<mplot::glb_animation> a = std::move (this->animation);
+            this->animation_model = {};
+            a->finish();
+            return nf;
+        }
+
+        //! Is the Visual exporting an animation?
+        bool exportingAnimation() const { return this->animation != nullptr; }
+
+        /*!
+         * Start profiling. From now on, render() records the CPU time, the GPU time and the
+         * draw calls, texture binds and buffer uploads of each model that it draws, of the
+         * batched models, of the coordinate arrows and of the texts (see mplot::frame_profiler).
+         * Each frame's profile is complete a frame or two after the frame was rendered, once its
+         * GPU timestamps can be read without waiting; it is then passed to on_profile (if set)
+         * and returned by getFrameProfile. Set visual_options::showProfile to show a summary of
+         * the latest profile in the window.
+         */
+        void startProfiling (std::function<void(const mplot::frame_profile&)> on_profile = nullptr)
+        {
+            if (this->profiler) { throw std::runtime_error ("VisualBase::startProfiling: already profiling"); }
+            this->profiler = std::make_unique<mplot::frame_profiler>();
+            this->profiler->on_profile = std::move (on_profile);
+        }
+
+        //! Stop profiling, freeing the GL timer queries. Returns the latest complete profile.
+        virtual mplot::frame_profile stopProfiling() = 0;
+
+        //! Is the Visual profiling?
+        bool profiling() const { return this->profiler != nullptr; }
+
+        //! The most recent complete frame profile
+        mplot::frame_profile getFrameProfile() const
+        {
+            return this->profiler ? this->profiler->latest() : mplot::frame_profile{};
+        }
+
+        /*!
+         * The times of the phases of the Visual's startup, from its construction to the end of
+         * its first frame (see mplot/startup_profile.h): window creation, GL loading, FreeType
+         * and shader setup, the client's scene setup, the coordinate arrows and title, and the
+         * first render and swap. startup_profile::complete() is false until the first frame has
+         * been drawn.
+         */
+        const mplot::startup_profile& getStartupProfile() const { return this->startup; }
+
+        /*!
+         * The sum of the upload stats of the models in the scene (see
+         * VisualModel::get_upload_stats), the counts of rebuilds, uploads and bytes uploaded since
+         * each was added (or since resetUploadStats).
+         */
+        mplot::upload_stats getUploadStats() const
+        {
+            mplot::upload_stats total;
+            for (auto& m : this->vm) { total += m->get_upload_stats(); }
+            return total;
+        }
+
+        void resetUploadStats() { for (auto& m : this->vm) { m->reset_upload_stats(); } }
+
+        /*!
+         * The memory held by the Visual (see mplot/memory_report.h): each model's vertex vectors,
+         * buffers, textures and texts (VisualModel::get_memory_report), the Visual's own texts
+         * and, from VisualResources, the glyph atlases of its context group's faces and the
+         * buffers that its models share. GPU sizes are read back from GL, so this makes the
+         * Visual's context current. Set visual_options::showMemory (or press Ctrl-b) to show a
+         * summary in the window.
+         */
+        virtual mplot::memory_report getMemoryReport() = 0;
+
+        /*!
+         * Set a hook that is called after every upload of any model in the scene (see
+         * VisualModel::upload_hook), with the model that uploaded. It replaces the hooks of the
+         * models already in the scene and is given to models added later that have none of
+         * their own. Pass nullptr to remove it.
+         */
+        void setUploadHook (std::function<void(const mplot::VisualModelBase<glver>&)> hook)
+        {
+            this->upload_hook = std::move (hook);
+            for (auto& m : this->vm) { m->upload_hook = this->upload_hook; }
+        }
+
         /*!
          * Set up the passed-in VisualModel (or indeed, VisualTextModel) with functions that need access to Visual attributes.
          */
@@ -184,19 +448,50 @@ namespace mplot {
             model->get_shaderprogs = &mplot::VisualBase<glver>::get_shaderprogs;
             model->get_gprog = &mplot::VisualBase<glver>::get_gprog;
             model->get_tprog = &mplot::VisualBase<glver>::get_tprog;
+            model->get_gprog_uniforms = &mplot::VisualBase<glver>::get_gprog_uniforms;
+            model->get_tprog_uniforms = &mplot::VisualBase<glver>::get_tprog_uniforms;
+            model->get_render_state = &mplot::VisualBase<glver>::get_render_state;
+            // Only text models have storage to recycle
+            if constexpr (requires { model->get_text_pool; }) {
+                model->get_text_pool = &mplot::VisualBase<glver>::get_text_pool;
+            }
+            // ...and only the other models are drawn into the pick buffer
+            if constexpr (requires { model->get_pick_uniforms; }) {
+                model->get_pick_uniforms = &mplot::VisualBase<glver>::get_pick_uniforms;
+                model->get_pick_sprite_uniforms = &mplot::VisualBase<glver>::get_pick_sprite_uniforms;
+            }
+            model->requestRedraw = &mplot::VisualBase<glver>::request_redraw;
+            if (this->options.test (visual_options::tiledGpuProfile)) { model->setCompactByDefault(); }
         }
 
+        //! A handle to a model of the scene, which stays valid until that model is removed
+        using model_handle = mplot::slot_handle;
+
         /*!
          * Add a VisualModel to the scene as a unique_ptr. The Visual object takes ownership of the
-         * unique_ptr. The index into Visual::vm is returned.
+         * unique_ptr. A handle to the model is returned, with which getVisualModel and
+         * removeVisualModel find it in O(1), however many models are added or removed.
          */
         template <typename T>
-        unsigned int addVisualModelId (std::unique_ptr<T>& model)
+        model_handle addVisualModelHandle (std::unique_ptr<T>& model)
         {
             std::unique_ptr<mplot::VisualModel<glver>> vmp = std::move(model);
-            this->vm.push_back (std::move(vmp));
-            unsigned int rtn = (this->vm.size()-1);
-            return rtn;
+            this->adopt_upload_hook (vmp.get());
+            const mplot::VisualModel<glver>* p = vmp.get();
+            const model_handle h = this->vm.insert (std::move(vmp));
+            this->vm_handles[p] = h;
+            return h;
+        }
+        /*!
+         * Add a VisualModel to the scene as a unique_ptr. The Visual object takes ownership of the
+         * unique_ptr. The index of the model in the order of the scene's models is returned.
+         * The index changes when an earlier model is removed; prefer addVisualModelHandle.
+         */
+        template <typename T>
+        unsigned int addVisualModelId (std::unique_ptr<T>& model)
+        {
+            this->addVisualModelHandle (model);
+            return static_cast<unsigned int>(this->vm.size() - 1);
         }
         /*!
          * Add a VisualModel to the scene as a unique_ptr. The Visual object takes ownership of the
@@ -205,51 +500,145 @@ namespace mplot {
         template <typename T>
         T* addVisualModel (std::unique_ptr<T>& model)
         {
-            std::unique_ptr<mplot::VisualModel<glver>> vmp = std::move(model);
-            this->vm.push_back (std::move(vmp));
-            return static_cast<T*>(this->vm.back().get());
+            return static_cast<T*>(this->vm.find (this->addVisualModelHandle (model))->get());
         }
 
         /*!
-         * Test the pointer vmp. Return vmp if it is owned by a unique_ptr in
-         * Visual::vm. If it is not present, return nullptr.
+         * Finalize many models at once. Their initializeVertices are run in parallel on n_threads
+         * threads (0 means one per hardware thread), each thread taking the next unbuilt model
+         * as it finishes one, and then their buffers are uploaded in sequence on this thread.
+         * The models must already have been bound with bindmodel.
+         *
+         * As for VisualModel::finalize_async, the initializeVertices of each model must make no
+         * GL calls, so models that add labels (or other text models) must be finalized with
+         * finalize() instead. An exception thrown by any build is rethrown here, and then no
+         * buffers are uploaded.
          */
-        const mplot::VisualModel<glver>* validVisualModel (const mplot::VisualModel<glver>* vmp) const
+        void finalizeAll (const std::vector<mplot::VisualModel<glver>*>& models, unsigned int n_threads = 0)
         {
-            const mplot::VisualModel<glver>* rtn = nullptr;
-            for (unsigned int modelId = 0; modelId < this->vm.size(); ++modelId) {
-                if (this->vm[modelId].get() == vmp) {
-                    rtn = vmp;
-                    break;
+            for (auto m : models) { m->wait_for_build(); }
+
+            if (n_threads == 0) { n_threads = std::thread::hardware_concurrency(); }
+            n_threads = std::max (1u, std::min (n_threads, static_cast<unsigned int>(models.size())));
+            std::atomic<std::size_t> next_model = 0;
+            std::vector<std::exception_ptr> errors (n_threads);
+            auto builder = [&](unsigned int ti) {
+                try {
+                    for (std::size_t i = next_model++; i < models.size(); i = next_model++) {
+                        models[i]->finalize_vertices();
+                    }
+                } catch (...) {
+                    errors[ti] = std::current_exception();
+                    next_model = models.size(); // and the other threads stop at their next model
                 }
+            };
+            std::vector<std::thread> workers;
+            for (unsigned int ti = 1; ti < n_threads; ++ti) { workers.emplace_back (builder, ti); }
+            builder (0);
+            for (auto& w : workers) { w.join(); }
+            for (auto& e : errors) {
+                if (e) { std::rethrow_exception (e); }
+            }
+
+            this->setContext();
+            for (auto m : models) {
+                this->adopt_upload_hook (m);
+                m->postVertexInit();
             }
+            this->releaseContext();
+            this->requestRedraw();
+        }
+
+        /*!
+         * Finalize the models with finalizeAll and add them to the scene, which takes ownership
+         * of them. Non-owning pointers to the models are returned, in order, and models is left
+         * empty.
+         */
+        template <typename T>
+        std::vector<T*> addVisualModels (std::vector<std::unique_ptr<T>>& models, unsigned int n_threads = 0)
+        {
+            std::vector<mplot::VisualModel<glver>*> to_build;
+            for (auto& m : models) { to_build.push_back (m.get()); }
+            this->finalizeAll (to_build, n_threads);
+            std::vector<T*> rtn;
+            for (auto& m : models) { rtn.push_back (this->addVisualModel (m)); }
+            models.clear();
             return rtn;
         }
 
+        /*!
+         * Test the pointer vmp. Return vmp if it is owned by a unique_ptr in
+         * Visual::vm. If it is not present, return nullptr. vmp is not dereferenced.
+         */
+        const mplot::VisualModel<glver>* validVisualModel (const mplot::VisualModel<glver>* vmp) const
+        {
+            return this->vm_handles.count (vmp) > 0 ? vmp : nullptr;
+        }
+
+        //! The handle of the model vmp, or an invalid handle if vmp is not in the scene
+        model_handle getVisualModelHandle (const mplot::VisualModel<glver>* vmp) const
+        {
+            auto hi = this->vm_handles.find (vmp);
+            return hi == this->vm_handles.end() ? model_handle{} : hi->second;
+        }
+
+        //! The model of the handle h, or nullptr if it has been removed
+        mplot::VisualModel<glver>* getVisualModel (const model_handle& h)
+        {
+            std::unique_ptr<mplot::VisualModel<glver>>* p = this->vm.find (h);
+            return p == nullptr ? nullptr : p->get();
+        }
+
         /*!
          * VisualModel Getter
          *
-         * For the given \a modelId, return a (non-owning) pointer to the visual model.
+         * For the given \a modelId (its index in the order of the models), return a (non-owning)
+         * pointer to the visual model, or nullptr if there are not that many models. The holes
+         * left by removed models are closed first, so that the index is found in O(1).
          *
          * \return VisualModel pointer
          */
-        mplot::VisualModel<glver>* getVisualModel (unsigned int modelId) { return (this->vm[modelId].get()); }
+        mplot::VisualModel<glver>* getVisualModel (unsigned int modelId)
+        {
+            this->vm.compact();
+            return modelId < this->vm.size() ? this->vm[modelId].get() : nullptr;
+        }
 
-        //! Remove the VisualModel with ID \a modelId from the scene.
-        void removeVisualModel (unsigned int modelId) { this->vm.erase (this->vm.begin() + modelId); }
+        /*!
+         * Remove the model of the handle h from the scene, in O(1). Returns false if it has already
+         * been removed. The models after it keep their order.
+         */
+        bool removeVisualModel (const model_handle& h)
+        {
+            std::unique_ptr<mplot::VisualModel<glver>>* p = this->vm.find (h);
+            if (p == nullptr) { return false; }
+            (*p)->wait_for_build();
+            this->vm_handles.erase (p->get());
+            this->vm.erase (h);
+            this->requestRedraw();
+            return true;
+        }
+
+        //! Remove the VisualModel with ID \a modelId (its index in the order of the models) from the scene.
+        void removeVisualModel (unsigned int modelId)
+        {
+            if (modelId < this->vm.size()) { this->removeVisualModel (this->vm.handle_at (modelId)); }
+        }
 
         //! Remove the VisualModel whose pointer matches the VisualModel* vmp
         void removeVisualModel (mplot::VisualModel<glver>* vmp)
         {
-            unsigned int modelId = 0;
-            bool found_model = false;
-            for (modelId = 0; modelId < this->vm.size(); ++modelId) {
-                if (this->vm[modelId].get() == vmp) {
-                    found_model = true;
-                    break;
-                }
-            }
-            if (found_model == true) { this->vm.erase (this->vm.begin() + modelId); }
+            this->removeVisualModel (this->getVisualModelHandle (vmp));
+        }
+
+        //! Remove all of the VisualModels from the scene (the shaders and the font faces are kept)
+        void clearVisualModels()
+        {
+            // One pass, rather than a removeVisualModel for each, which would find each by index
+            for (auto& m : this->vm) { m->wait_for_build(); }
+            this->vm_handles.clear();
+            this->vm.clear();
+            this->requestRedraw();
         }
 
         void set_cursorpos (double _x, double _y) { this->cursorpos = {static_cast<float>(_x), static_cast<float>(_y)}; }
@@ -281,6 +670,208 @@ namespace mplot {
         //! one for graphical objects and a text shader program, which uses textures to draw text on
         //! quads.
         mplot::visgl::visual_shaderprogs shaders;
+        //! Uniform locations in shaders.gprog, updated whenever gprog is (re)loaded
+        mplot::visgl::shader_uniforms gprog_uniforms;
+        //! Uniform locations in shaders.tprog
+        mplot::visgl::shader_uniforms tprog_uniforms;
+        //! Uniform buffer object holding the per-frame mplot::visgl::scene_state
+        GLuint scene_ubo = 0;
+        //! The number of pixel pack buffers in the ring that saveImageAsync reads into
+        static constexpr std::size_t capture_ring_size = 3;
+        //! A screenshot that has been read into a pixel pack buffer, waiting for its fence
+        struct pending_capture
+        {
+            GLuint pbo = 0;
+            GLsizeiptr pbo_size = 0;
+            GLsync fence = nullptr;
+            bool busy = false;
+            std::string filename;
+            bool transparent_bg = false;
+            //! If true, this is a frame for the recorder, rather than a saveImageAsync capture
+            bool record = false;
+            sm::vec<int, 2> dims = { 0, 0 };
+            std::promise<sm::vec<int, 2>> result;
+        };
+        //! The ring of captures, and the slot that the next saveImageAsync call will use
+        std::array<pending_capture, capture_ring_size> captures;
+        std::size_t next_capture = 0;
+        //! The PNG encodes running on worker threads
+        std::vector<std::future<void>> capture_jobs;
+        //! The callback set with setPickCallback
+        std::function<void(const pick_result&)> pick_callback;
+        //! The ID pass framebuffer, its RGBA32UI colour and depth renderbuffers, and their size
+        GLuint pick_fbo = 0;
+        std::array<GLuint, 2> pick_rbo = { 0, 0 };
+        sm::vec<int, 2> pick_dims = { 0, 0 };
+        //! The pixel pack buffer into which the picked pixel is read
+        GLuint pick_pbo = 0;
+        //! The uniform locations in the pick and pick sprite programs, found when setup_pick links them
+        mplot::visgl::shader_uniforms pick_uniforms;
+        mplot::visgl::shader_uniforms pick_sprite_uniforms;
+        //! The fence of the pick started by render() for pick_callback, if it is still pending
+        GLsync pick_fence = nullptr;
+        //! The handles of the models of the pick in flight, the model with id i + 1 at i
+        std::vector<model_handle> pick_handles;
+        //! Set by cursor_position_callback while there is a pick_callback: render() should pick at pick_cursor
+        bool pick_wanted = false;
+        sm::vec<float, 2> pick_cursor = { 0.0f, 0.0f };
+        //! Set while recording (see startRecording)
+        std::unique_ptr<mplot::frame_recorder> recorder;
+        //! Set while streaming (see startStreaming), and the input events taken from it
+        std::unique_ptr<mplot::frame_streamer> streamer;
+        std::vector<mplot::stream_input_event> stream_events;
+        //! Set while exporting an animation (see startAnimationExport), and the model that it is of
+        std::unique_ptr<mplot::glb_animation> animation;
+        model_handle animation_model = {};
+        //! Set while profiling (see startProfiling)
+        std::unique_ptr<mplot::frame_profiler> profiler;
+        //! The times of the phases of the Visual's startup (see getStartupProfile)
+        mplot::startup_profile startup;
+
+        //! Decides when maybe_render renders
+        mplot::frame_pacer pacer;
+        //! Decides the resolution of each frame (see dynamicResolution)
+        mplot::render_scaler scaler;
+        //! Set when render() asks for a frame to follow a reduced one (see render_scaler)
+        bool scaler_catch_up = false;
+
+        //! The hook set with setUploadHook
+        std::function<void(const mplot::VisualModelBase<glver>&)> upload_hook;
+
+        /*!
+         * Pass the input events from the streamer's clients to the callbacks, as if they had
+         * come from the window. A remote client can't quit the program with Ctrl-q.
+         */
+        void dispatch_stream_input()
+        {
+            if (!this->streamer || this->streamer->take_input (this->stream_events) == 0u) { return; }
+            for (const mplot::stream_input_event& e : this->stream_events) {
+                switch (e.type) {
+                case mplot::stream_input_event::kind::key:
+                    this->template key_callback<false> (e.i[0], e.i[1], e.i[2], e.i[3]);
+                    break;
+                case mplot::stream_input_event::kind::mouse_button:
+                    this->mouse_button_callback (e.i[0], e.i[1], e.i[2]);
+                    break;
+                case mplot::stream_input_event::kind::cursor_position:
+                    // The client gives the position in the frame's pixels
+                    this->cursor_position_callback (e.d[0] / mplot::retinaScale, e.d[1] / mplot::retinaScale);
+                    break;
+                case mplot::stream_input_event::kind::scroll:
+                    this->scroll_callback (e.d[0], e.d[1]);
+                    break;
+                }
+            }
+        }
+
+        //! Give model m the Visual's upload hook, unless it has its own
+        void adopt_upload_hook (mplot::VisualModel<glver>* m)
+        {
+            if (this->upload_hook && !m->upload_hook) { m->upload_hook = this->upload_hook; }
+        }
+
+        //! Write the RGBA image, whose rows are already top-first, to a PNG file
+        static sm::vec<int, 2> encode_capture (const std::string& img_filename, std::vector<unsigned char>& rgba,
+                                               sm::vec<int, 2> dims, const bool transparent_bg)
+        {
+            MPLOT_TRACE_SCOPE ("Visual::encode_capture");
+            if (!transparent_bg) {
+                for (std::size_t i = 3; i < rgba.size(); i += 4) { rgba[i] = 255; }
+            }
+            unsigned int error = lodepng::encode (img_filename, rgba.data(), dims[0], dims[1]);
+            if (error) {
+                std::cerr << "encoder error " << error << ": " << lodepng_error_text (error) << std::endl;
+                dims.set_from (-1);
+            }
+            return dims;
+        }
+
+        //! Hand the (flipped) pixels of capture c to a worker thread, which encodes them and sets c's result
+        void start_capture_job (pending_capture& c, std::vector<unsigned char>&& rgba)
+        {
+            std::erase_if (this->capture_jobs, [](const std::future<void>& j) {
+                return j.wait_for (std::chrono::seconds (0)) == std::future_status::ready;
+            });
+            this->capture_jobs.push_back (std::async (std::launch::async,
+                                                      [fn = c.filename, dims = c.dims, tbg = c.transparent_bg,
+                                                       result = std::move (c.result), bits = std::move (rgba)]() mutable {
+                                                          result.set_value (encode_capture (fn, bits, dims, tbg));
+                                                      }));
+        }
+
+        //! Wait for all of the PNG encodes to finish
+        void finish_capture_jobs()
+        {
+            for (auto& j : this->capture_jobs) { j.wait(); }
+            this->capture_jobs.clear();
+        }
+
+        //! Set while render_offscreen draws one tile of an off-screen image
+        struct offscreen_tile
+        {
+            bool active = false;
+            //! The size of the tile's framebuffer
+            sm::vec<int, 2> dims = { 0, 0 };
+            //! Maps the whole image's clip coordinates to the tile's clip coordinates
+            sm::mat44<float> clip_transform;
+        };
+        offscreen_tile tile;
+
+        /*!
+         * The clip_transform for a tile of size tdims, whose bottom left pixel is at origin, in an
+         * image of size dims. It scales and shifts x and y in clip space (in proportion to w, so it
+         * works for the perspective projection as well as for the orthographic).
+         */
+        static sm::mat44<float> tile_clip_transform (const sm::vec<int, 2> dims, const sm::vec<int, 2> origin,
+                                                     const sm::vec<int, 2> tdims)
+        {
+            sm::mat44<float> t;
+            for (int i = 0; i < 2; ++i) {
+                const float s = static_cast<float>(dims[i]) / static_cast<float>(tdims[i]);
+                // The centre of the tile in the whole image's normalized device coordinates
+                const float c = static_cast<float>(2 * origin[i] + tdims[i]) / static_cast<float>(dims[i]) - 1.0f;
+                t.mat[5 * i] = s;
+                t.mat[12 + i] = -s * c;
+            }
+            return t;
+        }
+
+        /*!
+         * The view matrix for face i (in the order of GL_TEXTURE_CUBE_MAP_POSITIVE_X onwards) of a
+         * cube map drawn from the position eye. Each face looks along its axis, with the up vector
+         * that the GL cube map convention gives it.
+         */
+        static sm::mat44<float> cube_face_view (const unsigned int i, const sm::vec<float, 4>& eye)
+        {
+            static const std::array<sm::vec<float, 3>, 6> fwd = {
+                sm::vec<float, 3>{ 1, 0, 0 }, sm::vec<float, 3>{ -1, 0, 0 }, sm::vec<float, 3>{ 0, 1, 0 },
+                sm::vec<float, 3>{ 0, -1, 0 }, sm::vec<float, 3>{ 0, 0, 1 }, sm::vec<float, 3>{ 0, 0, -1 }
+            };
+            static const std::array<sm::vec<float, 3>, 6> up = {
+                sm::vec<float, 3>{ 0, -1, 0 }, sm::vec<float, 3>{ 0, -1, 0 }, sm::vec<float, 3>{ 0, 0, 1 },
+                sm::vec<float, 3>{ 0, 0, -1 }, sm::vec<float, 3>{ 0, -1, 0 }, sm::vec<float, 3>{ 0, -1, 0 }
+            };
+            const sm::vec<float, 3> e = eye.less_one_dim();
+            const sm::vec<float, 3>& f = fwd[i];
+            const sm::vec<float, 3> r = f.cross (up[i]);
+            const sm::vec<float, 3> u = r.cross (f);
+            // The rows of the rotation are r, u and -f (column major storage)
+            sm::mat44<float> v;
+            for (int j = 0; j < 3; ++j) {
+                v.mat[4 * j] = r[j];
+                v.mat[4 * j + 1] = u[j];
+                v.mat[4 * j + 2] = -f[j];
+            }
+            v.mat[12] = -r.dot (e);
+            v.mat[13] = -u.dot (e);
+            v.mat[14] = f.dot (e);
+            return v;
+        }
+
+        //! The program, VAO and blend state last set in this Visual's GL context
+        mplot::visgl::render_state glstate;
+        //! The GL names and vertex vectors of deleted text models, for new ones to reuse
+        mplot::visgl::text_model_pool text_pool;
         //! Which shader is active for graphics shading?
         mplot::visgl::graphics_shader_type active_gprog = mplot::visgl::graphics_shader_type::none;
         //! Stores the info required to load the 2D projection shader
@@ -290,6 +881,24 @@ namespace mplot {
 
         //! Stores the info required to load the cylindrical projection shader
         std::vector<mplot::gl::ShaderInfo> cyl_shader_progs;
+        //! Both graphics programs are linked at init, so that switching projection doesn't compile
+        //! shaders mid-frame. shaders.gprog is whichever of these is active.
+        GLuint proj2d_prog = 0;
+        GLuint cyl_prog = 0;
+        mplot::visgl::shader_uniforms proj2d_uniforms;
+        mplot::visgl::shader_uniforms cyl_uniforms;
+        //! The unlit program, which draws models without normals or lighting (see
+        //! VisualModelBase::setUnlit), and its shader info and uniform locations
+        std::vector<mplot::gl::ShaderInfo> unlit_shader_progs;
+        GLuint unlit_prog = 0;
+        mplot::visgl::shader_uniforms unlit_uniforms;
+        //! True if the lighting leaves colours unchanged (the default, with no lightingEffects), in
+        //! which case every model may be drawn with the unlit program
+        bool lighting_neutral() const
+        {
+            return this->diffuse_intensity == 0.0f && this->ambient_intensity == 1.0f
+            && this->light_colour[0] == 1.0f && this->light_colour[1] == 1.0f && this->light_colour[2] == 1.0f;
+        }
         //! Passed to the cyl_shader_progs as a uniform to define the location of the cylindrical
         //! projection camera
         sm::vec<float, 4> cyl_cam_pos = { 0.0f, 0.0f, 0.0f, 1.0f };
@@ -299,11 +908,23 @@ namespace mplot {
         float cyl_radius = 0.005f;
         //! The height of the 'cylindrical projection screen'
         float cyl_height = 0.01f;
+        //! The width and height in pixels of each face of the cube map into which the scene is
+        //! drawn for the cube map cylindrical projection. If 0, it is a quarter of the width of the
+        //! window (and no less than 64).
+        int cyl_cube_size = 0;
 
         // These static functions will be set as callbacks in each VisualModel object.
         static mplot::visgl::visual_shaderprogs get_shaderprogs (mplot::VisualBase<glver>* _v) { return _v->shaders; };
         static GLuint get_gprog (mplot::VisualBase<glver>* _v) { return _v->shaders.gprog; };
         static GLuint get_tprog (mplot::VisualBase<glver>* _v) { return _v->shaders.tprog; };
+        static const mplot::visgl::shader_uniforms& get_gprog_uniforms (mplot::VisualBase<glver>* _v) { return _v->gprog_uniforms; };
+        static const mplot::visgl::shader_uniforms& get_tprog_uniforms (mplot::VisualBase<glver>* _v) { return _v->tprog_uniforms; };
+        static const mplot::visgl::shader_uniforms& get_pick_uniforms (mplot::VisualBase<glver>* _v) { return _v->pick_uniforms; };
+        static const mplot::visgl::shader_uniforms& get_pick_sprite_uniforms (mplot::VisualBase<glver>* _v) { return _v->pick_sprite_uniforms; };
+        static mplot::visgl::render_state& get_render_state (mplot::VisualBase<glver>* _v) { return _v->glstate; };
+        static mplot::visgl::text_model_pool& get_text_pool (mplot::VisualBase<glver>* _v) { return _v->text_pool; };
+        // A callback friendly wrapper for requestRedraw
+        static void request_redraw (mplot::VisualBase<glver>* _v) { _v->requestRedraw(); };
 
         //! The colour of ambient and diffuse light sources
         sm::vec<float, 3> light_colour = { 1.0f, 1.0f, 1.0f };
@@ -341,6 +962,9 @@ namespace mplot {
         // Update the coordinate axes labels
         void updateCoordLabels (const std::string& x_lbl, const std::string& y_lbl, const std::string& z_lbl)
         {
+            this->coord_labels = { x_lbl, y_lbl, z_lbl };
+            // The coordArrows are made with coord_labels when they are first shown
+            if (this->coordArrows == nullptr) { return; }
             this->coordArrows->clear();
             this->coordArrows->x_label = x_lbl;
             this->coordArrows->y_label = y_lbl;
@@ -365,12 +989,19 @@ namespace mplot {
             sm::flags<visual_options> _options;
             // Only with ImGui do we manually swap buffers, so this is true by default:
             _options.set (visual_options::renderSwapsBuffers);
+            _options.set (visual_options::renderOnDemand);
+            // OpenGL ES (as on the Raspberry Pi) most often means a tiled mobile GPU
+            if constexpr (mplot::gl::version::gles (glver)) { _options.set (visual_options::tiledGpuProfile); }
             return _options;
         }
 
         // Option flags
         sm::flags<visual_options> options = options_defaults();
 
+        //! The samples per pixel of the off-screen framebuffer into which render() draws, or -1 to
+        //! draw into the window's own framebuffer (see antiAliasing)
+        int aa_samples = -1;
+
         //! Returns true when the program has been flagged to end
         bool readyToFinish() const { return this->state.test (visual_state::readyToFinish); }
 
@@ -387,13 +1018,13 @@ namespace mplot {
         float fov = 30.0f;
 
         //! Setter for visual_options::showCoordArrows
-        void showCoordArrows (const bool val) { this->options.set (visual_options::showCoordArrows, val); }
+        void showCoordArrows (const bool val) { this->options.set (visual_options::showCoordArrows, val); this->requestRedraw(); }
 
         //! If true, then place the coordinate arrows at the origin of the scene, rather than offset.
-        void coordArrowsInScene (const bool val) { this->options.set (visual_options::coordArrowsInScene, val); }
+        void coordArrowsInScene (const bool val) { this->options.set (visual_options::coordArrowsInScene, val); this->requestRedraw(); }
 
         //! Set to true to show the title text within the scene
-        void showTitle (const bool val) { this->options.set (visual_options::showTitle, val); }
+        void showTitle (const bool val) { this->options.set (visual_options::showTitle, val); this->requestRedraw(); }
 
         //! Set true to output some user information to stdout (e.g. user requested quit)
         void userInfoStdout (const bool val) { this->options.set (visual_options::userInfoStdout, val); }
@@ -401,6 +1032,201 @@ namespace mplot {
         //! You can call this with val==false to manage exactly when you call the swapBuffer() method (for ImGui programs)
         void renderSwapsBuffers (const bool val) {  this->options.set (visual_options::renderSwapsBuffers, val); }
 
+        //! Call with val==false to have keepOpen() and pauseOpen() render at 60 Hz, whether or not the scene has changed
+        void renderOnDemand (const bool val) { this->options.set (visual_options::renderOnDemand, val); }
+
+        /*!
+         * Call with true to blend the translucent models (those with an alpha below 1; see
+         * VisualModel::setAlpha) with weighted, blended order independent transparency, so that
+         * they look right in any order and from any view without being sorted. When there are
+         * translucent models in the scene, render() draws the depth of the opaque models into an
+         * off-screen framebuffer, accumulates the translucent models' triangles there and blends
+         * the result over the scene in one composite pass; translucent models' sprites,
+         * polylines, bars and texts are drawn after it as usual. A frame with no translucent
+         * models is drawn as though this were off. It is ignored in the cylindrical projection.
+         */
+        void orderIndependentTransparency (const bool val = true)
+        {
+            this->options.set (visual_options::orderIndependentTransparency, val);
+            this->requestRedraw();
+        }
+
+        /*!
+         * Call with true to draw the cylindrical projection by way of a cube map. The scene is
+         * drawn with the ordinary perspective shader into the six faces of a cube map around
+         * cyl_cam_pos, and one full-window pass then looks up each pixel of the cylindrical view
+         * in it. Unlike the default, vertex by vertex, cylindrical shader, this bends the edges
+         * of large triangles correctly, and depth tests between models work, at the cost of
+         * drawing the models six times. See also cyl_cube_size.
+         */
+        void cylindricalCubeMap (const bool val = true)
+        {
+            this->options.set (visual_options::cylindricalCubeMap, val);
+            this->requestRedraw();
+        }
+
+        /*!
+         * Set the anti-aliasing of this Visual. If samples is 0 or more, render() draws the scene
+         * into an off-screen framebuffer with that many samples per pixel (0 for none), rather
+         * than straight into the window's framebuffer (which has the 4 samples that are asked of
+         * GLFW, or whatever the Qt or wx widget's format gives it), and copies the resolved image
+         * into the window. With fxaa, the copy is an FXAA pass, which smooths the edges that are
+         * left at a small fraction of the cost of multisampling. saveImageOffscreen uses the same
+         * settings unless it is given its own sample count. Call antiAliasing (-1) to draw
+         * straight into the window again.
+         */
+        void antiAliasing (const int samples, const bool fxaa = false)
+        {
+            this->aa_samples = samples;
+            this->options.set (visual_options::fxaa, fxaa);
+            this->requestRedraw();
+        }
+
+        /*!
+         * Turn on dynamic resolution, for scenes whose frames are limited by fill rate (such as
+         * dense scenes in a large window on a high DPI display). While the user rotates,
+         * translates or zooms the view, render() draws the scene at scale times the window's
+         * width and height, into the off-screen framebuffer of antiAliasing, and scales it up
+         * into the window with a linear filter (or through FXAA). If budget_ms is more than 0,
+         * frames are also reduced while the scene changes, if full resolution frames take longer
+         * than budget_ms. Once the scene has been still for settle_ms, it is drawn at full
+         * resolution. Call dynamicResolution (1.0f) to turn it off (see mplot::render_scaler).
+         */
+        void dynamicResolution (const float scale, const double budget_ms = 0.0, const double settle_ms = 150.0)
+        {
+            this->scaler.scaling = { scale, budget_ms, settle_ms };
+            this->requestRedraw();
+        }
+
+        //! The render scaler of dynamicResolution, with its counts of reduced and full frames
+        const mplot::render_scaler& getRenderScaler() const { return this->scaler; }
+
+        /*!
+         * Call with true to redraw, on each frame, only the part of the window in which models
+         * have changed, for windows of many panels (such as a grid of graphs) of which few change
+         * at a time. The scene is drawn into the off-screen framebuffer of antiAliasing, which
+         * holds the last frame. render() finds the rectangle of the framebuffer that each model
+         * covers (see VisualModel::screen_bounds and VisualModel::setScreenRect) and, if the
+         * view, the lighting and the set of models are unchanged, clears and redraws (with
+         * glScissor) only the rectangle that holds the changed models, before the framebuffer is
+         * copied into the window. The whole frame is drawn if a changed model covers an unknown
+         * rectangle, or more than half of the frame, with dynamicResolution's reduced frames,
+         * with the cylindrical projection, while the profile is shown and with tiledGpuProfile
+         * (which discards the off-screen framebuffer after each frame). Changes that don't reach
+         * a model's change count, such as a new string set directly on one of the Visual's
+         * texts, need requestFullRedraw.
+         */
+        void partialRedraw (const bool val = true)
+        {
+            this->options.set (visual_options::partialRedraw, val);
+            this->partial_full = true;
+            this->requestRedraw();
+        }
+
+        //! Redraw the whole of the next frame, though partialRedraw is set
+        void requestFullRedraw()
+        {
+            this->partial_full = true;
+            this->requestRedraw();
+        }
+
+        /*!
+         * Call with true to draw the models in order of depth, rather than in the order in which
+         * they were added. The opaque models are drawn front to back, so that the depth test
+         * rejects the hidden fragments of the models behind them before they are shaded, which
+         * cuts the overdraw of dense 3D scenes on fill rate limited GPUs. The translucent models
+         * (with an alpha below 1) are drawn after them, back to front, so that they blend in
+         * order. Each model's depth is that of the centre of its bounding box. The order is
+         * computed again only when the scene view, the set of models or their translucency
+         * changes. It is not applied in the cylindrical projection, to the batched models (see
+         * VisualModel::setBatched), or to the translucent models that are blended order
+         * independently (see orderIndependentTransparency).
+         */
+        void sortModels (const bool val = true)
+        {
+            this->options.set (visual_options::sortModels, val);
+            this->requestRedraw();
+        }
+
+        /*!
+         * Call with true to render in the way that suits the tiled GPUs of mobile devices and the
+         * Raspberry Pi, which are limited by memory bandwidth and stall on queries of GL state.
+         * This is the default for OpenGL ES versions (such as mplot::gl::version_3_1_es). The
+         * models bound afterwards (see bindmodel) are made compact where they can be (see
+         * VisualModel::setCompactByDefault): 20 bytes per vertex rather than 36. The models
+         * don't call glGetError after each draw. At the end of each frame, the depth and stencil
+         * buffers of the window (and the off-screen framebuffer of antiAliasing, once it has been
+         * resolved) are invalidated, so the GPU need not write them back from its tiles to memory.
+         * Index buffers are 16 bit for models with fewer than 65536 vertices, and the OpenGL ES
+         * shaders are mediump by default, with or without this profile.
+         */
+        void tiledGpuProfile (const bool val = true)
+        {
+            this->options.set (visual_options::tiledGpuProfile, val);
+            this->requestRedraw();
+        }
+
+        //! True if glver has glInvalidateFramebuffer (OpenGL 4.3+ or OpenGL ES 3.0+)
+        static constexpr bool invalidate_supported = mplot::gl::version::invalidate_framebuffer (glver);
+
+        /*!
+         * Flag that the scene has changed and should be rendered again by keepOpen() or
+         * pauseOpen(). Input events, the scene setters of this class and VisualModel reinits,
+         * updates and view changes call this; call it yourself if you change the scene in
+         * another way (for example, by writing directly to a VisualModel's vertices). It is safe
+         * to call from another thread.
+         */
+        virtual void requestRedraw() { this->needs_render = true; }
+
+        //! True if the scene has changed since it was last rendered. See requestRedraw()
+        std::atomic<bool> needs_render = true;
+
+        /*!
+         * Set when maybe_render() renders: at a target frame rate, once every N calls or once
+         * every T ms, skipping frames that would take more than a share of the time from the
+         * simulation (see mplot::frame_pacing).
+         */
+        void setFramePacing (const mplot::frame_pacing& p) { this->pacer.pacing = p; }
+
+        /*!
+         * Call this on every step of a simulation loop in place of render(). It renders only
+         * when a frame is due under the frame pacing (see setFramePacing), and otherwise
+         * returns at once, so it costs little to call. Returns true if it rendered. With a
+         * window, poll for events (with poll(), say) as well.
+         */
+        bool maybe_render()
+        {
+            using sc = std::chrono::steady_clock;
+            const sc::time_point t0 = sc::now();
+            if (!this->pacer.due (t0)) { return false; }
+            this->render();
+            this->pacer.rendered (t0, sc::now());
+            return true;
+        }
+
+        //! The frame pacer used by maybe_render, with its measured render cost and counts of frames
+        const mplot::frame_pacer& getFramePacer() const { return this->pacer; }
+
+        /*!
+         * Add a simulation coroutine, to be run by runTasks() (see mplot/frame_tasks.h). The
+         * task co_awaits next_frame(), idle_for() or data_consumed() to give way to rendering.
+         */
+        void spawn (mplot::frame_task&& t) { this->tasks.spawn (std::move (t)); }
+
+        //! co_await this in a task to resume at the next frame tick, once the frame is drawn
+        mplot::frame_scheduler::awaiter next_frame() { return this->tasks.next_frame(); }
+
+        //! co_await this in a task to resume after ms milliseconds, rendering meanwhile as needed
+        mplot::frame_scheduler::awaiter idle_for (const double ms) { return this->tasks.idle_for (ms); }
+
+        //! co_await this in a task to resume once a render has taken up the data of x (a
+        //! mplot::data_slot, or a VisualModel)
+        template <typename M>
+        mplot::frame_scheduler::awaiter data_consumed (const M& x) { return this->tasks.data_consumed (x); }
+
+        //! The tasks given to spawn(). Set tasks.fps for the rate of next_frame()'s ticks.
+        mplot::frame_scheduler tasks;
+
         //! How big should the steps in scene translation be when scrolling?
         float scenetrans_stepsize = 0.1f;
 
@@ -417,6 +1243,9 @@ namespace mplot {
 
         //! The background colour; white by default.
         std::array<float, 4> bgcolour = { 1.0f, 1.0f, 1.0f, 0.5f };
+        //! The bgcolour for which coordArrows was last coloured (so that it is recoloured, which
+        //! costs a rebuild and a release of the context, only when bgcolour changes)
+        std::array<float, 4> coordarrows_bgcolour = { -1.0f, -1.0f, -1.0f, -1.0f };
 
         /*
          * User can directly set bgcolour for any background colour they like, but
@@ -424,9 +1253,9 @@ namespace mplot {
          */
 
         //! Set a white background colour for the Visual scene
-        void backgroundWhite() { this->bgcolour = { 1.0f, 1.0f, 1.0f, 0.5f }; }
+        void backgroundWhite() { this->bgcolour = { 1.0f, 1.0f, 1.0f, 0.5f }; this->requestRedraw(); }
         //! Set a black background colour for the Visual scene
-        void backgroundBlack() { this->bgcolour = { 0.0f, 0.0f, 0.0f, 0.0f }; }
+        void backgroundBlack() { this->bgcolour = { 0.0f, 0.0f, 0.0f, 0.0f }; this->requestRedraw(); }
 
         //! Set the scene's x and y values at the same time.
         void setSceneTransXY (const float _x, const float _y)
@@ -435,11 +1264,12 @@ namespace mplot {
             this->scenetrans[1] = _y;
             this->scenetrans_default[0] = _x;
             this->scenetrans_default[1] = _y;
+            this->requestRedraw();
         }
         //! Set the scene's y value. Use this to shift your scene objects left or right
-        void setSceneTransX (const float _x) { this->scenetrans[0] = _x; this->scenetrans_default[0] = _x; }
+        void setSceneTransX (const float _x) { this->scenetrans[0] = _x; this->scenetrans_default[0] = _x; this->requestRedraw(); }
         //! Set the scene's y value. Use this to shift your scene objects up and down
-        void setSceneTransY (const float _y) { this->scenetrans[1] = _y; this->scenetrans_default[1] = _y; }
+        void setSceneTransY (const float _y) { this->scenetrans[1] = _y; this->scenetrans_default[1] = _y; this->requestRedraw(); }
         //! Set the scene's z value. Use this to bring the 'camera' closer to your scene
         //! objects (that is, your mplot::VisualModel objects).
         void setSceneTransZ (const float _z)
@@ -449,6 +1279,7 @@ namespace mplot {
             }
             this->scenetrans[2] = _z;
             this->scenetrans_default[2] = _z;
+            this->requestRedraw();
         }
         void setSceneTrans (float _x, float _y, float _z)
         {
@@ -461,6 +1292,7 @@ namespace mplot {
             this->scenetrans_default[1] = _y;
             this->scenetrans[2] = _z;
             this->scenetrans_default[2] = _z;
+            this->requestRedraw();
         }
         void setSceneTrans (const sm::vec<float, 3>& _xyz)
         {
@@ -469,18 +1301,21 @@ namespace mplot {
             }
             this->scenetrans = _xyz;
             this->scenetrans_default = _xyz;
+            this->requestRedraw();
         }
 
         void setSceneRotation (const sm::quaternion<float>& _rotn)
         {
             this->rotation = _rotn;
             this->rotation_default = _rotn;
+            this->requestRedraw();
         }
 
         void lightingEffects (const bool effects_on = true)
         {
             this->ambient_intensity = effects_on ? 0.4f : 1.0f;
             this->diffuse_intensity = effects_on ? 0.6f : 0.0f;
+            this->requestRedraw();
         }
 
         //! Save all the VisualModels in this Visual out to a GLTF format file
@@ -489,86 +1324,66 @@ namespace mplot {
             std::ofstream fout;
             fout.open (gltf_file, std::ios::out|std::ios::trunc);
             if (!fout.is_open()) { throw std::runtime_error ("Visual::savegltf(): Failed to open file for writing"); }
-            fout << "{\n  \"scenes\" : [ { \"nodes\" : [ ";
-            for (std::size_t vmi = 0u; vmi < this->vm.size(); ++vmi) {
-                fout << vmi << (vmi < this->vm.size()-1 ? ", " : "");
-            }
-            fout << " ] } ],\n";
-
-            fout << "  \"nodes\" : [\n";
-            // for loop over VisualModels "mesh" : 0, etc
-            for (std::size_t vmi = 0u; vmi < this->vm.size(); ++vmi) {
-                fout << "    { \"mesh\" : " << vmi
-                     << ", \"translation\" : " << this->vm[vmi]->translation_str()
-                     << (vmi < this->vm.size()-1 ? " },\n" : " }\n");
-            }
-            fout << "  ],\n";
-
-            fout << "  \"meshes\" : [\n";
-            // for each VisualModel:
-            for (std::size_t vmi = 0u; vmi < this->vm.size(); ++vmi) {
-                fout << "    { \"primitives\" : [ { \"attributes\" : { \"POSITION\" : " << 1+vmi*4
-                     << ", \"COLOR_0\" : " << 2+vmi*4
-                     << ", \"NORMAL\" : " << 3+vmi*4 << " }, \"indices\" : " << vmi*4 << ", \"material\": 0 } ] }"
-                     << (vmi < this->vm.size()-1 ? ",\n" : "\n");
-            }
-            fout << "  ],\n";
+            this->restore_host_vertices();
+            this->gltf_scenes_nodes_meshes (fout);
 
             fout << "  \"buffers\" : [\n";
-            for (std::size_t vmi = 0u; vmi < this->vm.size(); ++vmi) {
+            for (std::size_t vmi = 0u; const auto& m : this->vm) {
                 // indices
-                fout << "    {\"uri\" : \"data:application/octet-stream;base64," << this->vm[vmi]->indices_base64() << "\", "
-                     << "\"byteLength\" : " << this->vm[vmi]->indices_bytes() << "},\n";
+                fout << "    {\"uri\" : \"data:application/octet-stream;base64," << m->indices_base64() << "\", "
+                     << "\"byteLength\" : " << m->indices_bytes() << "},\n";
                 // pos
-                fout << "    {\"uri\" : \"data:application/octet-stream;base64," << this->vm[vmi]->vpos_base64() << "\", "
-                     << "\"byteLength\" : " << this->vm[vmi]->vpos_bytes() << "},\n";
+                fout << "    {\"uri\" : \"data:application/octet-stream;base64," << m->vpos_base64() << "\", "
+                     << "\"byteLength\" : " << m->vpos_bytes() << "},\n";
                 // col
-                fout << "    {\"uri\" : \"data:application/octet-stream;base64," << this->vm[vmi]->vcol_base64() << "\", "
-                     << "\"byteLength\" : " << this->vm[vmi]->vcol_bytes() << "},\n";
+                fout << "    {\"uri\" : \"data:application/octet-stream;base64," << m->vcol_base64() << "\", "
+                     << "\"byteLength\" : " << m->vcol_bytes() << "},\n";
                 // norm
-                fout << "    {\"uri\" : \"data:application/octet-stream;base64," << this->vm[vmi]->vnorm_base64() << "\", "
-                     << "\"byteLength\" : " << this->vm[vmi]->vnorm_bytes() << "}";
+                fout << "    {\"uri\" : \"data:application/octet-stream;base64," << m->vnorm_base64() << "\", "
+                     << "\"byteLength\" : " << m->vnorm_bytes() << "}";
                 fout << (vmi < this->vm.size()-1 ? ",\n" : "\n");
+                ++vmi;
             }
             fout << "  ],\n";
 
             fout << "  \"bufferViews\" : [\n";
-            for (std::size_t vmi = 0u; vmi < this->vm.size(); ++vmi) {
+            for (std::size_t vmi = 0u; const auto& m : this->vm) {
                 // indices
                 fout << "    { ";
                 fout << "\"buffer\" : " << vmi*4 << ", ";
                 fout << "\"byteOffset\" : 0, ";
-                fout << "\"byteLength\" : " << this->vm[vmi]->indices_bytes() << ", ";
+                fout << "\"byteLength\" : " << m->indices_bytes() << ", ";
                 fout << "\"target\" : 34963 ";
                 fout << " },\n";
                 // vpos
                 fout << "    { ";
                 fout << "\"buffer\" : " << 1+vmi*4 << ", ";
                 fout << "\"byteOffset\" : 0, ";
-                fout << "\"byteLength\" : " << this->vm[vmi]->vpos_bytes() << ", ";
+                fout << "\"byteLength\" : " << m->vpos_bytes() << ", ";
                 fout << "\"target\" : 34962 ";
                 fout << " },\n";
                 // vcol
                 fout << "    { ";
                 fout << "\"buffer\" : " << 2+vmi*4 << ", ";
                 fout << "\"byteOffset\" : 0, ";
-                fout << "\"byteLength\" : " << this->vm[vmi]->vcol_bytes() << ", ";
+                fout << "\"byteLength\" : " << m->vcol_bytes() << ", ";
                 fout << "\"target\" : 34962 ";
                 fout << " },\n";
                 // vnorm
                 fout << "    { ";
                 fout << "\"buffer\" : " << 3+vmi*4 << ", ";
                 fout << "\"byteOffset\" : 0, ";
-                fout << "\"byteLength\" : " << this->vm[vmi]->vnorm_bytes() << ", ";
+                fout << "\"byteLength\" : " << m->vnorm_bytes() << ", ";
                 fout << "\"target\" : 34962 ";
                 fout << " }";
                 fout << (vmi < this->vm.size()-1 ? ",\n" : "\n");
+                ++vmi;
             }
             fout << "  ],\n";
 
             fout << "  \"accessors\" : [\n";
-            for (std::size_t vmi = 0u; vmi < this->vm.size(); ++vmi) {
-                this->vm[vmi]->computeVertexMaxMins();
+            for (std::size_t vmi = 0u; const auto& m : this->vm) {
+                m->computeVertexMaxMins();
                 // indices
                 fout << "    { ";
                 fout << "\"bufferView\" : " << vmi*4 << ", ";
@@ -576,7 +1391,7 @@ namespace mplot {
                 // 5123 unsigned short, 5121 unsigned byte, 5125 unsigned int, 5126 float:
                 fout << "\"componentType\" : 5125, ";
                 fout << "\"type\" : \"SCALAR\", ";
-                fout << "\"count\" : " << this->vm[vmi]->indices_size();
+                fout << "\"count\" : " << m->indices_size();
                 fout << "},\n";
                 // vpos
                 fout << "    { ";
@@ -584,10 +1399,10 @@ namespace mplot {
                 fout << "\"byteOffset\" : 0, ";
                 fout << "\"componentType\" : 5126, ";
                 fout << "\"type\" : \"VEC3\", ";
-                fout << "\"count\" : " << this->vm[vmi]->vpos_size()/3;
+                fout << "\"count\" : " << m->vpos_size()/3;
                 // vertex position requires max/min to be specified in the gltf format
-                fout << ", \"max\" : " << this->vm[vmi]->vpos_max() << ", ";
-                fout << "\"min\" : " << this->vm[vmi]->vpos_min();
+                fout << ", \"max\" : " << m->vpos_max() << ", ";
+                fout << "\"min\" : " << m->vpos_min();
                 fout << " },\n";
                 // vcol
                 fout << "    { ";
@@ -595,7 +1410,7 @@ namespace mplot {
                 fout << "\"byteOffset\" : 0, ";
                 fout << "\"componentType\" : 5126, ";
                 fout << "\"type\" : \"VEC3\", ";
-                fout << "\"count\" : " << this->vm[vmi]->vcol_size()/3;
+                fout << "\"count\" : " << m->vcol_size()/3;
                 fout << "},\n";
                 // vnorm
                 fout << "    { ";
@@ -603,27 +1418,294 @@ namespace mplot {
                 fout << "\"byteOffset\" : 0, ";
                 fout << "\"componentType\" : 5126, ";
                 fout << "\"type\" : \"VEC3\", ";
-                fout << "\"count\" : " << this->vm[vmi]->vnorm_size()/3;
+                fout << "\"count\" : " << m->vnorm_size()/3;
                 fout << "}";
                 fout << (vmi < this->vm.size()-1 ? ",\n" : "\n");
+                ++vmi;
+            }
+            fout << "  ],\n";
+
+            this->gltf_materials_asset (fout, "savegltf");
+            fout.close();
+        }
+
+        /*!
+         * Save all the VisualModels in this Visual to a binary glTF (.glb) file. The JSON is as
+         * savegltf() writes it, but all the data are in one binary chunk, written straight from
+         * each model's indices and vertex vectors (with no base64 encoding or intermediate copies).
+         * If interleaved, each model's positions, colours and normals are interleaved in one
+         * buffer view, 36 bytes per vertex. glb files are limited to 4 GB.
+         */
+        virtual void saveglb (const std::string& glb_file, const bool interleaved = false)
+        {
+            this->restore_host_vertices();
+            std::ostringstream js;
+            this->gltf_scenes_nodes_meshes (js);
+            this->glb_buffers (js, interleaved);
+            this->gltf_materials_asset (js, "saveglb");
+            this->write_glb (glb_file, js.str(), interleaved);
+        }
+
+        /*!
+         * Save the models to a .glb file as opts asks. With opts.quantize, the vertices are
+         * stored with KHR_mesh_quantization (int16 positions, int8 normals and uint8 colours, 16
+         * bytes per vertex rather than 36) and each node's scale and translation map them back.
+         * With opts.reorder, each model's triangles and vertices are reordered for the vertex
+         * cache and for vertex fetch (see mplot/gltf_pack.h). Either way the meshes are packed
+         * into copies, one model at a time, and opts.interleaved is not used. Without either,
+         * this is saveglb (glb_file, opts.interleaved). Files saved with quantize or reorder
+         * can't be shown with MeshFileVisual, which maps float data with uint32 indices.
+         */
+        void saveglb (const std::string& glb_file, const mplot::gltf_options& opts)
+        {
+            if (!opts.quantize && !opts.reorder) {
+                this->saveglb (glb_file, opts.interleaved);
+                return;
+            }
+            this->restore_host_vertices();
+            std::vector<mplot::gltf_packed_mesh> packed;
+            packed.reserve (this->vm.size());
+            for (const auto& m : this->vm) { packed.push_back (m->gltf_pack (opts)); }
+            std::ostringstream js;
+            if (opts.quantize) {
+                js << "{\n  \"extensionsUsed\" : [ \"KHR_mesh_quantization\" ],\n"
+                   << "  \"extensionsRequired\" : [ \"KHR_mesh_quantization\" ],\n";
+            }
+            this->gltf_scenes_nodes_meshes (js, &packed);
+            this->glb_packed_buffers (js, packed);
+            this->gltf_materials_asset (js, "saveglb");
+            this->write_glb (glb_file, js.str(), packed);
+        }
+
+        void set_winsize (int _w, int _h) { this->window_w = _w; this->window_h = _h; }
+
+    protected:
+
+        //! Read back the vertices of any model that has freed them (see VisualModel::setGpuResident)
+        void restore_host_vertices()
+        {
+            for (auto& m : this->vm) { m->restore_host_vertices(); }
+        }
+
+        /*!
+         * Output the scenes, nodes and meshes sections of the glTF, with four accessors per
+         * model. If packed is given, the nodes carry the scale and offset of each packed mesh,
+         * and the opening brace is left to the caller.
+         */
+        void gltf_scenes_nodes_meshes (std::ostream& fout, const std::vector<mplot::gltf_packed_mesh>* packed = nullptr) const
+        {
+            fout << (packed == nullptr ? "{\n" : "") << "  \"scenes\" : [ { \"nodes\" : [ ";
+            for (std::size_t vmi = 0u; vmi < this->vm.size(); ++vmi) {
+                fout << vmi << (vmi < this->vm.size()-1 ? ", " : "");
+            }
+            fout << " ] } ],\n";
+
+            fout << "  \"nodes\" : [\n";
+            // for loop over VisualModels "mesh" : 0, etc
+            for (std::size_t vmi = 0u; const auto& m : this->vm) {
+                fout << "    { \"mesh\" : " << vmi;
+                if (packed != nullptr && (*packed)[vmi].quantized) {
+                    const mplot::gltf_packed_mesh& pm = (*packed)[vmi];
+                    const sm::vec<float, 3> t = m->get_mv_offset() + sm::vec<float, 3>{ pm.offset[0], pm.offset[1], pm.offset[2] };
+                    const sm::vec<float, 3> sc = { pm.scale, pm.scale, pm.scale };
+                    fout << ", \"translation\" : " << t.str_mat() << ", \"scale\" : " << sc.str_mat();
+                } else {
+                    fout << ", \"translation\" : " << m->translation_str();
+                }
+                fout << (vmi < this->vm.size()-1 ? " },\n" : " }\n");
+                ++vmi;
             }
             fout << "  ],\n";
 
+            fout << "  \"meshes\" : [\n";
+            // for each VisualModel:
+            for (std::size_t vmi = 0u; vmi < this->vm.size(); ++vmi) {
+                fout << "    { \"primitives\" : [ { \"attributes\" : { \"POSITION\" : " << 1+vmi*4
+                     << ", \"COLOR_0\" : " << 2+vmi*4
+                     << ", \"NORMAL\" : " << 3+vmi*4 << " }, \"indices\" : " << vmi*4 << ", \"material\": 0 } ] }"
+                     << (vmi < this->vm.size()-1 ? ",\n" : "\n");
+            }
+            fout << "  ],\n";
+        }
+
+        //! Output the materials and asset sections of the glTF, naming the function that saved it
+        void gltf_materials_asset (std::ostream& fout, const std::string& saver) const
+        {
             // Default material is single sided, so make it double sided
             fout << "  \"materials\" : [ { \"doubleSided\" : true } ],\n";
 
             fout << "  \"asset\" : {\n"
-                 << "    \"generator\" : \"https://github.com/ABRG-Models/mplotologica: mplot::Visual::savegltf() (ver "
+                 << "    \"generator\" : \"https://github.com/ABRG-Models/mplotologica: mplot::Visual::" << saver << "() (ver "
                  << mplot::version_string() << ")\",\n"
                  << "    \"version\" : \"2.0\"\n" // This version is the *glTF* version.
                  << "  }\n";
             fout << "}\n";
-            fout.close();
         }
 
-        void set_winsize (int _w, int _h) { this->window_w = _w; this->window_h = _h; }
+        /*!
+         * Output the buffers, bufferViews and accessors sections of the JSON chunk of a .glb
+         * file. There is one buffer, the binary chunk, in which each model's data are laid out by
+         * VisualModel::write_glb_binary. The position bounds that glTF requires are found here;
+         * they are the only pass over the vertices before the data are written.
+         */
+        void glb_buffers (std::ostream& js, const bool interleaved) const
+        {
+            js << "  \"buffers\" : [ { \"byteLength\" : " << this->glb_binary_bytes() << " } ],\n";
+
+            js << "  \"bufferViews\" : [\n";
+            std::size_t offset = 0u;
+            for (std::size_t vmi = 0u; const auto& m : this->vm) {
+                const std::size_t ib = m->indices_bytes();
+                const std::size_t vb = m->vpos_bytes();
+                js << "    { \"buffer\" : 0, \"byteOffset\" : " << offset << ", \"byteLength\" : " << ib << ", \"target\" : 34963 },\n";
+                offset += ib;
+                if (interleaved) {
+                    js << "    { \"buffer\" : 0, \"byteOffset\" : " << offset << ", \"byteLength\" : " << 3u * vb
+                       << ", \"byteStride\" : 36, \"target\" : 34962 }";
+                    offset += 3u * vb;
+                } else {
+                    for (unsigned int a = 0u; a < 3u; ++a) {
+                        js << "    { \"buffer\" : 0, \"byteOffset\" : " << offset << ", \"byteLength\" : " << vb << ", \"target\" : 34962 }"
+                           << (a < 2u ? ",\n" : "");
+                        offset += vb;
+                    }
+                }
+                js << (vmi < this->vm.size()-1 ? ",\n" : "\n");
+                ++vmi;
+            }
+            js << "  ],\n";
+
+            js << "  \"accessors\" : [\n";
+            for (std::size_t vmi = 0u; const auto& m : this->vm) {
+                // The bufferViews of this model: indices, then one interleaved or three separate views
+                const std::size_t bv0 = vmi * (interleaved ? 2u : 4u);
+                js << "    { \"bufferView\" : " << bv0 << ", \"byteOffset\" : 0, \"componentType\" : 5125, \"type\" : \"SCALAR\", "
+                   << "\"count\" : " << m->indices_size() << " },\n";
+                const std::size_t nv = m->vpos_size() / 3u;
+                for (unsigned int a = 0u; a < 3u; ++a) {
+                    const std::size_t bv = interleaved ? bv0 + 1u : bv0 + 1u + a;
+                    const std::size_t bo = interleaved ? 12u * a : 0u;
+                    js << "    { \"bufferView\" : " << bv << ", \"byteOffset\" : " << bo
+                       << ", \"componentType\" : 5126, \"type\" : \"VEC3\", \"count\" : " << nv;
+                    if (a == 0u) {
+                        // vertex position requires max/min to be specified in the gltf format
+                        sm::vec<float, 3> pmin = { 0.0f, 0.0f, 0.0f };
+                        sm::vec<float, 3> pmax = { 0.0f, 0.0f, 0.0f };
+                        if (nv > 0u) {
+                            sm::vec<sm::range<float>, 3> ext = m->extents();
+                            pmin = { ext[0].min, ext[1].min, ext[2].min };
+                            pmax = { ext[0].max, ext[1].max, ext[2].max };
+                        }
+                        js << ", \"max\" : " << pmax.str_mat() << ", \"min\" : " << pmin.str_mat();
+                    }
+                    js << " }" << (a < 2u || vmi < this->vm.size()-1 ? ",\n" : "\n");
+                }
+                ++vmi;
+            }
+            js << "  ],\n";
+        }
 
-    protected:
+        //! Output the buffers, bufferViews and accessors sections for the packed meshes
+        void glb_packed_buffers (std::ostream& js, const std::vector<mplot::gltf_packed_mesh>& packed) const
+        {
+            std::size_t bin_bytes = 0u;
+            for (const auto& pm : packed) { bin_bytes += pm.bytes(); }
+            js << "  \"buffers\" : [ { \"byteLength\" : " << bin_bytes << " } ],\n";
+
+            js << "  \"bufferViews\" : [\n";
+            std::size_t offset = 0u;
+            for (std::size_t pmi = 0u; pmi < packed.size(); ++pmi) {
+                const mplot::gltf_packed_mesh& pm = packed[pmi];
+                js << "    { \"buffer\" : 0, \"byteOffset\" : " << offset << ", \"byteLength\" : " << pm.index_bytes()
+                   << ", \"target\" : 34963 },\n";
+                offset += pm.index_bytes();
+                const std::array<const mplot::gltf_packed_mesh::attribute*, 3> attrs = { &pm.position, &pm.colour, &pm.normal };
+                for (unsigned int a = 0u; a < 3u; ++a) {
+                    js << "    { \"buffer\" : 0, \"byteOffset\" : " << offset << ", \"byteLength\" : " << attrs[a]->data.size();
+                    // A stride is needed where the attribute is padded out to 4 bytes per vertex
+                    if (pm.quantized) { js << ", \"byteStride\" : " << attrs[a]->stride; }
+                    js << ", \"target\" : 34962 }" << (a < 2u ? ",\n" : "");
+                    offset += attrs[a]->data.size();
+                }
+                js << (pmi < packed.size()-1 ? ",\n" : "\n");
+            }
+            js << "  ],\n";
+
+            js << "  \"accessors\" : [\n";
+            for (std::size_t pmi = 0u; pmi < packed.size(); ++pmi) {
+                const mplot::gltf_packed_mesh& pm = packed[pmi];
+                const std::size_t bv0 = pmi * 4u;
+                js << "    { \"bufferView\" : " << bv0 << ", \"byteOffset\" : 0, \"componentType\" : " << pm.index_type
+                   << ", \"type\" : \"SCALAR\", \"count\" : " << pm.n_indices << " },\n";
+                const std::array<const mplot::gltf_packed_mesh::attribute*, 3> attrs = { &pm.position, &pm.colour, &pm.normal };
+                for (unsigned int a = 0u; a < 3u; ++a) {
+                    js << "    { \"bufferView\" : " << bv0 + 1u + a << ", \"byteOffset\" : 0, \"componentType\" : " << attrs[a]->component_type
+                       << (attrs[a]->normalized ? ", \"normalized\" : true" : "") << ", \"type\" : \"VEC3\", \"count\" : " << pm.n_vertices;
+                    if (a == 0u) {
+                        const sm::vec<float, 3> pmax = { pm.pos_max[0], pm.pos_max[1], pm.pos_max[2] };
+                        const sm::vec<float, 3> pmin = { pm.pos_min[0], pm.pos_min[1], pm.pos_min[2] };
+                        js << ", \"max\" : " << pmax.str_mat() << ", \"min\" : " << pmin.str_mat();
+                    }
+                    js << " }" << (a < 2u || pmi < packed.size()-1 ? ",\n" : "\n");
+                }
+            }
+            js << "  ],\n";
+        }
+
+        //! The size of the binary chunk of a .glb file of the models
+        std::size_t glb_binary_bytes() const
+        {
+            std::size_t bytes = 0u;
+            for (const auto& m : this->vm) { bytes += m->indices_bytes() + 3u * m->vpos_bytes(); }
+            return bytes;
+        }
+
+        //! Write a .glb file with the JSON chunk json and a binary chunk of the models' data
+        void write_glb (const std::string& glb_file, const std::string& json, const bool interleaved) const
+        {
+            this->write_glb_chunks (glb_file, json, this->glb_binary_bytes(),
+                                    [this, interleaved](std::ostream& bin) {
+                                        for (const auto& m : this->vm) { m->write_glb_binary (bin, interleaved); }
+                                    });
+        }
+
+        //! Write a .glb file with the JSON chunk json and a binary chunk of the packed meshes
+        void write_glb (const std::string& glb_file, const std::string& json, const std::vector<mplot::gltf_packed_mesh>& packed) const
+        {
+            std::size_t bin_bytes = 0u;
+            for (const auto& pm : packed) { bin_bytes += pm.bytes(); }
+            this->write_glb_chunks (glb_file, json, bin_bytes,
+                                    [&packed](std::ostream& bin) { for (const auto& pm : packed) { pm.write (bin); } });
+        }
+
+        //! Write a .glb file with the JSON chunk json and a binary chunk of bin_bytes that write_bin writes
+        void write_glb_chunks (const std::string& glb_file, std::string json, const std::size_t bin_bytes,
+                               const std::function<void(std::ostream&)>& write_bin) const
+        {
+            // The JSON chunk is padded with spaces to a multiple of 4 bytes. The binary data are
+            // all kept to multiples of 4 bytes, so they need no padding.
+            while (json.size() % 4u != 0u) { json += ' '; }
+            const std::size_t total = 12u + 8u + json.size() + 8u + bin_bytes;
+            if (total > std::numeric_limits<std::uint32_t>::max()) {
+                throw std::runtime_error ("Visual::saveglb(): The scene is too large for a glb file (over 4 GB)");
+            }
+            std::ofstream fout (glb_file, std::ios::out | std::ios::trunc | std::ios::binary);
+            if (!fout.is_open()) { throw std::runtime_error ("Visual::saveglb(): Failed to open file for writing"); }
+            auto put32 = [&fout](const std::size_t u) {
+                const std::uint32_t u32 = static_cast<std::uint32_t>(u);
+                fout.write (reinterpret_cast<const char*>(&u32), sizeof (u32));
+            };
+            put32 (0x46546c67u); // "glTF"
+            put32 (2u);          // The glb container version
+            put32 (total);
+            put32 (json.size());
+            put32 (0x4e4f534au); // "JSON"
+            fout.write (json.data(), static_cast<std::streamsize>(json.size()));
+            put32 (bin_bytes);
+            put32 (0x004e4942u); // "BIN"
+            write_bin (fout);
+            if (!fout.good()) { throw std::runtime_error ("Visual::saveglb(): Failed to write the file"); }
+        }
 
         //! Set up a perspective projection based on window width and height. Not public.
         void setPerspective()
@@ -654,15 +1736,172 @@ namespace mplot {
             this->invproj = this->projection.inverse();
         }
 
-        //! A vector of pointers to all the mplot::VisualModels (HexGridVisual,
-        //! ScatterVisual, etc) which are going to be rendered in the scene.
-        std::vector<std::unique_ptr<mplot::VisualModel<glver>>> vm;
+        //! All the mplot::VisualModels (HexGridVisual, ScatterVisual, etc) which are going to be
+        //! rendered in the scene, in the order in which they were added
+        mplot::slot_map<std::unique_ptr<mplot::VisualModel<glver>>> vm;
+        //! The handle of each model in vm, so that a pointer can be tested without dereferencing it
+        std::unordered_map<const mplot::VisualModel<glver>*, model_handle> vm_handles;
+
+        //! The order in which render() draws the models in vm this frame
+        std::vector<mplot::VisualModel<glver>*> model_order;
+        //! The models (with their translucency) and the scene view for which model_order was last
+        //! sorted (see sortModels)
+        std::vector<std::pair<mplot::VisualModel<glver>*, bool>> model_order_source;
+        sm::mat44<float> model_order_view;
+
+        /*!
+         * Set model_order: the models as they were added, or, if visual_options::sortModels is
+         * set, the opaque models front to back and then the translucent ones back to front. The
+         * sort is made again only when sceneview, the models or their translucency have changed
+         * since it was last made. The models' scene matrices must already be set for the frame.
+         */
+        void order_models (const sm::mat44<float>& sceneview, const bool sort)
+        {
+            if (!sort) {
+                this->model_order_source.clear();
+                this->model_order.clear();
+                for (auto& m : this->vm) { this->model_order.push_back (m.get()); }
+                return;
+            }
+            bool same = this->model_order_view.mat == sceneview.mat && this->model_order_source.size() == this->vm.size();
+            auto src = this->model_order_source.begin();
+            for (auto mi = this->vm.begin(); same && mi != this->vm.end(); ++mi, ++src) {
+                same = src->first == mi->get() && src->second == ((*mi)->getAlpha() < 1.0f);
+            }
+            if (same) { return; }
+
+            this->model_order_view = sceneview;
+            this->model_order_source.resize (this->vm.size());
+            // Each model's depth, negated for the translucent models, which come after the opaque ones
+            std::vector<std::pair<float, std::size_t>> keys (this->vm.size());
+            for (std::size_t i = 0; const auto& m : this->vm) {
+                const bool translucent = m->getAlpha() < 1.0f;
+                this->model_order_source[i] = { m.get(), translucent };
+                const float d = m->view_depth();
+                keys[i] = { translucent ? -d : d, i };
+                ++i;
+            }
+            std::stable_sort (keys.begin(), keys.end(), [this](const auto& a, const auto& b) {
+                const bool ta = this->model_order_source[a.second].second;
+                const bool tb = this->model_order_source[b.second].second;
+                return ta != tb ? tb : a.first < b.first;
+            });
+            this->model_order.clear();
+            for (const auto& k : keys) { this->model_order.push_back (this->model_order_source[k.second].first); }
+        }
+
+        //! What partial_redraw_rect knows of a model from the last frame
+        struct partial_model_state
+        {
+            const mplot::VisualModel<glver>* model = nullptr;
+            std::uint64_t changes = 0;
+            std::array<float, 16> model_matrix = {};
+            mplot::screen_rect rect;
+            bool rect_known = false;
+        };
+        //! The models and the scene of the last frame drawn with partialRedraw, for partial_redraw_rect
+        std::vector<partial_model_state> partial_models;
+        std::vector<float> partial_key;
+        //! Set by requestFullRedraw and by frames that could not be drawn in part
+        bool partial_full = true;
+
+        /*!
+         * For partialRedraw, find dirty, the rectangle of the framebuffer (of size dims) in which
+         * the models that changed since the last frame were, or are now, drawn. Returns false if
+         * the whole frame must be drawn: because the view, the projection, the lighting, the
+         * framebuffer or the set of models has changed, because a model that changed covers an
+         * unknown rectangle (see VisualModel::screen_bounds), or because dirty would cover more
+         * than half of the frame. An empty dirty rectangle means that nothing has changed. The
+         * models' scene matrices must already be set for the frame. Call partial_redraw_forget
+         * for a frame that is not drawn by way of this function.
+         */
+        bool partial_redraw_rect (const sm::mat44<float>& sceneview, const sm::mat44<float>& p_draw,
+                                  const sm::vec<int, 2>& dims, const std::size_t n_texts, mplot::screen_rect& dirty)
+        {
+            std::vector<float> key (sceneview.mat.begin(), sceneview.mat.end());
+            key.insert (key.end(), p_draw.mat.begin(), p_draw.mat.end());
+            key.insert (key.end(), this->bgcolour.begin(), this->bgcolour.end());
+            key.insert (key.end(), this->light_colour.begin(), this->light_colour.end());
+            key.insert (key.end(), this->diffuse_position.begin(), this->diffuse_position.end());
+            key.insert (key.end(), { this->ambient_intensity, this->diffuse_intensity,
+                                     static_cast<float>(dims[0]), static_cast<float>(dims[1]),
+                                     static_cast<float>(this->aa_samples), static_cast<float>(this->ptype),
+                                     static_cast<float>(n_texts),
+                                     this->options.test (visual_options::showCoordArrows) ? 1.0f : 0.0f,
+                                     this->options.test (visual_options::coordArrowsInScene) ? 1.0f : 0.0f,
+                                     this->options.test (visual_options::showTitle) ? 1.0f : 0.0f });
+
+            std::vector<partial_model_state> now (this->vm.size());
+            auto st = now.begin();
+            for (const auto& mp : this->vm) {
+                const mplot::VisualModel<glver>* m = mp.get();
+                st->model = m;
+                st->changes = m->change_count();
+                st->model_matrix = m->model_matrix().mat;
+                st->rect_known = m->screen_bounds (p_draw, dims, st->rect);
+                ++st;
+            }
+
+            bool partial = !this->partial_full && key == this->partial_key && now.size() == this->partial_models.size();
+            dirty = {};
+            for (std::size_t i = 0; partial && i < now.size(); ++i) {
+                const partial_model_state& was = this->partial_models[i];
+                if (was.model != now[i].model) { partial = false; break; }
+                if (was.changes == now[i].changes && was.model_matrix == now[i].model_matrix
+                    && was.rect_known == now[i].rect_known && was.rect == now[i].rect) { continue; }
+                if (!was.rect_known || !now[i].rect_known) { partial = false; break; }
+                dirty.unite (was.rect);
+                dirty.unite (now[i].rect);
+            }
+            // Scissoring most of the frame would save little
+            if (partial && dirty.area() * 2 > static_cast<std::int64_t>(dims[0]) * dims[1]) { partial = false; }
+
+            this->partial_key = std::move (key);
+            this->partial_models = std::move (now);
+            this->partial_full = false;
+            return partial;
+        }
+
+        //! Forget the last frame, so that the next frame drawn with partialRedraw is drawn in full
+        void partial_redraw_forget()
+        {
+            this->partial_full = true;
+            this->partial_key.clear();
+            this->partial_models.clear();
+        }
 
         // Initialize OpenGL shaders, set some flags (Alpha, Anti-aliasing), read in any external
         // state from json, and set up the coordinate arrows and any VisualTextModels that will be
         // required to render the Visual.
         virtual void init_gl() = 0;
 
+        //! A memory report with a child for each model and one for the coordinate arrows (see getMemoryReport)
+        mplot::memory_report models_memory_report() const
+        {
+            mplot::memory_report r;
+            r.name = "Visual";
+            std::size_t i = 0;
+            for (const auto& m : this->vm) {
+                mplot::memory_report mr = m->get_memory_report();
+                mr.name = "model " + std::to_string (i++);
+                r.children.push_back (std::move (mr));
+            }
+            if (this->coordArrows) {
+                r.children.push_back (this->coordArrows->get_memory_report());
+                r.children.back().name = "coordArrows";
+            }
+            return r;
+        }
+
+        //! A memory report of the texts ts, each a child of the report
+        static mplot::memory_report texts_memory_report (const std::vector<const mplot::VisualTextModel<glver>*>& ts)
+        {
+            mplot::memory_report r;
+            r.name = "texts";
+            for (const auto t : ts) { if (t != nullptr) { r.children.push_back (t->get_memory_report()); } }
+            return r;
+        }
+
         //! The window (and OpenGL context) for this Visual
         mplot::win_t* window = nullptr;
 
@@ -676,9 +1915,31 @@ namespace mplot {
 
         //! The user's 'selected visual model'. For model specific changes to alpha and possibly colour
         unsigned int selectedVisualModel = 0u;
+        //! The handle of the selected model, invalid until one is selected (when the first model in
+        //! the scene is the selected one)
+        model_handle selected_handle;
+
+        //! Select the model with the index idx in the order of the models, if there is one
+        void select_model (const unsigned int idx)
+        {
+            if (idx < this->vm.size()) {
+                this->selectedVisualModel = idx;
+                this->selected_handle = this->vm.handle_at (idx);
+            }
+            std::cout << "Selected visual model index " << this->selectedVisualModel << std::endl;
+        }
+
+        //! The selected model, or nullptr if it has been removed from the scene (or there are no models)
+        mplot::VisualModel<glver>* selected_model()
+        {
+            if (!this->selected_handle.valid()) { return this->vm.empty() ? nullptr : this->vm.begin()->get(); }
+            return this->getVisualModel (this->selected_handle);
+        }
 
         //! A little model of the coordinate axes.
         std::unique_ptr<mplot::CoordArrows<glver>> coordArrows;
+        //! The axis labels of the coordArrows (see updateCoordLabels)
+        std::array<std::string, 3> coord_labels = { "X", "Y", "Z" };
 
         //! Position coordinate arrows on screen. Configurable at mplot::Visual construction.
         sm::vec<float, 2> coordArrowsOffset = { -0.8f, -0.8f };
@@ -711,6 +1972,8 @@ namespace mplot {
 
         //! Screen coordinates of the position of the last mouse press
         sm::vec<float,2> mousePressPosition = { 0.0f, 0.0f };
+        //! Set by cursor_position_callback during a drag, until apply_pointer_motion moves the scene
+        bool pointer_moved = false;
 
         //! The current rotation axis. World frame?
         sm::vec<float, 3> rotationAxis = { 0.0f, 0.0f, 0.0f };
@@ -748,7 +2011,8 @@ namespace mplot {
         template<bool owned = true>
         bool key_callback (int _key, int scancode, int action, int mods) // can't be virtual.
         {
-            bool needs_render = false;
+            // Keys may reset the view, so first apply any drag that is waiting for the next frame
+            bool needs_render = this->apply_pointer_motion();
 
             if constexpr (owned == true) { // If Visual is 'owned' then the owning system deals with program exit
                 // Exit action
@@ -783,6 +2047,7 @@ namespace mplot {
                           << "Ctrl-z: Show the current scenetrans/rotation and save to /tmp/Visual.json\n"
                           << "Ctrl-u: Reduce zNear cutoff plane\n"
                           << "Ctrl-i: Increase zNear cutoff plane\n"
+                          << "Ctrl-b: Toggle the memory report (and output it to stdout)\n"
                           << "F1-F10: Select model index (with shift: toggle hide)\n"
                           << "Shift-Left: Decrease opacity of selected model\n"
                           << "Shift-Right: Increase opacity of selected model\n"
@@ -854,35 +2119,25 @@ namespace mplot {
 
             // Set selected model
             if (_key == key::f1 && action == keyaction::press) {
-                this->selectedVisualModel = 0;
-                std::cout << "Selected visual model index " << this->selectedVisualModel << std::endl;
+                this->select_model (0);
             } else if (_key == key::f2 && action == keyaction::press) {
-                if (this->vm.size() > 1) { this->selectedVisualModel = 1; }
-                std::cout << "Selected visual model index " << this->selectedVisualModel << std::endl;
+                this->select_model (1);
             } else if (_key == key::f3 && action == keyaction::press) {
-                if (this->vm.size() > 2) { this->selectedVisualModel = 2; }
-                std::cout << "Selected visual model index " << this->selectedVisualModel << std::endl;
+                this->select_model (2);
             } else if (_key == key::f4 && action == keyaction::press) {
-                if (this->vm.size() > 3) { this->selectedVisualModel = 3; }
-                std::cout << "Selected visual model index " << this->selectedVisualModel << std::endl;
+                this->select_model (3);
             } else if (_key == key::f5 && action == keyaction::press) {
-                if (this->vm.size() > 4) { this->selectedVisualModel = 4; }
-                std::cout << "Selected visual model index " << this->selectedVisualModel << std::endl;
+                this->select_model (4);
             } else if (_key == key::f6 && action == keyaction::press) {
-                if (this->vm.size() > 5) { this->selectedVisualModel = 5; }
-                std::cout << "Selected visual model index " << this->selectedVisualModel << std::endl;
+                this->select_model (5);
             } else if (_key == key::f7 && action == keyaction::press) {
-                if (this->vm.size() > 6) { this->selectedVisualModel = 6; }
-                std::cout << "Selected visual model index " << this->selectedVisualModel << std::endl;
+                this->select_model (6);
             } else if (_key == key::f8 && action == keyaction::press) {
-                if (this->vm.size() > 7) { this->selectedVisualModel = 7; }
-                std::cout << "Selected visual model index " << this->selectedVisualModel << std::endl;
+                this->select_model (7);
             } else if (_key == key::f9 && action == keyaction::press) {
-                if (this->vm.size() > 8) { this->selectedVisualModel = 8; }
-                std::cout << "Selected visual model index " << this->selectedVisualModel << std::endl;
+                this->select_model (8);
             } else if (_key == key::f10 && action == keyaction::press) {
-                if (this->vm.size() > 9) { this->selectedVisualModel = 9; }
-                std::cout << "Selected visual model index " << this->selectedVisualModel << std::endl;
+                this->select_model (9);
             }
 
             // Toggle hide model if the shift key is down
@@ -890,15 +2145,15 @@ namespace mplot {
                  || _key == key::f4 || _key == key::f5 || _key == key::f6
                  || _key == key::f7 || _key == key::f8 || _key == key::f9)
                 && action == keyaction::press && (mods & keymod::shift)) {
-                this->vm[this->selectedVisualModel]->toggleHide();
+                if (mplot::VisualModel<glver>* m = this->selected_model()) { m->toggleHide(); }
             }
 
             // Increment/decrement alpha for selected model
             if (_key == key::left && (action == keyaction::press || action == keyaction::repeat) && (mods & keymod::shift)) {
-                if (!this->vm.empty()) { this->vm[this->selectedVisualModel]->decAlpha(); }
+                if (mplot::VisualModel<glver>* m = this->selected_model()) { m->decAlpha(); }
             }
             if (_key == key::right && (action == keyaction::press || action == keyaction::repeat) && (mods & keymod::shift)) {
-                if (!this->vm.empty()) { this->vm[this->selectedVisualModel]->incAlpha(); }
+                if (mplot::VisualModel<glver>* m = this->selected_model()) { m->incAlpha(); }
             }
 
             // Cyl (and possibly spherical) projection radius
@@ -972,6 +2227,12 @@ namespace mplot {
                 needs_render = true;
             }
 
+            if (_key == key::b && (mods & keymod::control) && action == keyaction::press) {
+                this->options.flip (visual_options::showMemory);
+                std::cout << this->getMemoryReport().summary() << std::endl;
+                needs_render = true;
+            }
+
             this->key_callback_extra (_key, scancode, action, mods);
 
             return needs_render;
@@ -985,11 +2246,43 @@ namespace mplot {
             this->rotation.postmultiply (rotnQuat);
         }
 
+        /*!
+         * Record the cursor position. A mouse may report positions far more often than frames
+         * are drawn, so the rotation or translation of the scene that a drag makes is not
+         * computed here, but once per frame from the latest position, by apply_pointer_motion.
+         * Returns true if the scene will move, so that the caller can request a redraw.
+         */
         virtual bool cursor_position_callback (double x, double y)
         {
             this->cursorpos[0] = static_cast<float>(x);
             this->cursorpos[1] = static_cast<float>(y);
 
+            // The next render() picks at the new cursor position (see setPickCallback)
+            if (this->pick_callback) {
+                this->pick_cursor = this->cursorpos;
+                this->pick_wanted = true;
+                this->requestRedraw();
+            }
+
+            if (this->state.test (visual_state::rotateMode) || this->state.test (visual_state::translateMode)) {
+                this->pointer_moved = true;
+                return true;
+            }
+            return false;
+        }
+
+        /*!
+         * Move the scene for the cursor positions recorded by cursor_position_callback since the
+         * last call. A drag's rotation is from the position at which the button was pressed, and
+         * its translation accumulates from the last position applied, so only the latest position
+         * matters. Called at the start of render(), and before the other input callbacks change
+         * the state that a drag depends on. Returns true if the scene moved.
+         */
+        bool apply_pointer_motion()
+        {
+            if (!this->pointer_moved) { return false; }
+            this->pointer_moved = false;
+
             sm::vec<float, 3> mouseMoveWorld = { 0.0f, 0.0f, 0.0f };
 
             bool needs_render = false;
@@ -1088,11 +2381,16 @@ namespace mplot {
                 needs_render = true; // updates viewproj; uses this->scenetrans
             }
 
+            // The view is moving, so the next frames may be drawn at a reduced resolution
+            if (needs_render) { this->scaler.interacted (std::chrono::steady_clock::now()); }
             return needs_render;
         }
 
         virtual void mouse_button_callback (int button, int action, int mods = 0)
         {
+            // Finish the drag so far, before the button changes the mode
+            this->apply_pointer_motion();
+
             // If the scene is locked, then ignore the mouse movements
             if (this->state.test (visual_state::sceneLocked)) { return; }
 
@@ -1144,6 +2442,9 @@ namespace mplot {
 
             if (this->state.test (visual_state::sceneLocked)) { return false; }
 
+            // A drag in progress uses the scene translation, so apply it first
+            this->apply_pointer_motion();
+
             if (this->ptype == perspective_type::orthographic) {
                 // In orthographic, the wheel should scale ortho_lb and ortho_rt
                 sm::vec<float, 2> _lb = this->ortho_lb + (yoffset * this->scenetrans_stepsize);
@@ -1167,6 +2468,7 @@ namespace mplot {
                 sceneview_rotn.rotate (this->rotation);
                 this->cyl_cam_pos += sceneview_rotn * scroll_move_y;
             }
+            this->scaler.interacted (std::chrono::steady_clock::now());
             return true; // needs_render
         }
 
@@ -0,0 +1,114 @@
+/*!
+ * \file
+ *
+ * The GL-independent part of a batch of VisualModels that mplot::Visual draws with a single
+ * glMultiDrawElementsIndirect call. The vertices of all the batched models are packed into
+ * shared buffers (the 'arenas'), with one draw command per model, and each model's matrices and
+ * alpha are written into a shader storage buffer once per frame. The GL calls are made in
+ * mplot::VisualBatchMX and mplot::VisualBatchNoMX.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <sm/mat44>
+#include <mplot/gl/version.h>
+#include <mplot/VisualModelBase.h>
+
+namespace mplot {
+
+    template <int glver>
+    struct VisualBatchBase
+    {
+        //! glMultiDrawElementsIndirect, base instances and shader storage blocks need desktop OpenGL 4.3
+        static constexpr bool supported = mplot::gl::version::multi_draw_indirect (glver);
+
+        //! One draw command, laid out as glMultiDrawElementsIndirect requires
+        struct draw_command
+        {
+            GLuint count = 0;
+            GLuint instance_count = 1;
+            GLuint first_index = 0;
+            GLint base_vertex = 0;
+            GLuint base_instance = 0;
+        };
+
+        //! The models in the batch, in the order of their draw commands
+        std::vector<mplot::VisualModelBase<glver>*> models;
+        //! The upload generation of each model when the arenas were packed
+        std::vector<std::size_t> generations;
+        //! One draw command per model
+        std::vector<draw_command> commands;
+        //! batch_state_stride floats per model, written each frame by update()
+        std::vector<float> model_state;
+
+        //! The packed vertex positions, normals and colours and indices of all the models
+        std::vector<float> arena_posn;
+        std::vector<float> arena_norm;
+        std::vector<float> arena_col;
+        std::vector<GLuint> arena_ind;
+
+        //! True if the arenas must be repacked to draw the models _models
+        bool needs_rebuild (const std::vector<mplot::VisualModelBase<glver>*>& _models) const
+        {
+            if (_models != this->models) { return true; }
+            for (std::size_t i = 0; i < _models.size(); ++i) {
+                if (_models[i]->get_upload_generation() != this->generations[i]) { return true; }
+            }
+            return false;
+        }
+
+        //! Pack the vertices of _models into the arenas and set up one draw command for each
+        void pack (const std::vector<mplot::VisualModelBase<glver>*>& _models)
+        {
+            this->models = _models;
+            this->generations.resize (_models.size());
+            this->commands.resize (_models.size());
+            this->arena_posn.clear();
+            this->arena_norm.clear();
+            this->arena_col.clear();
+            this->arena_ind.clear();
+            for (std::size_t i = 0; i < _models.size(); ++i) {
+                draw_command& dc = this->commands[i];
+                dc.first_index = static_cast<GLuint>(this->arena_ind.size());
+                dc.base_vertex = static_cast<GLint>(this->arena_posn.size() / 3);
+                dc.base_instance = static_cast<GLuint>(i);
+                _models[i]->append_to_batch (this->arena_posn, this->arena_norm, this->arena_col, this->arena_ind);
+                dc.count = static_cast<GLuint>(this->arena_ind.size()) - dc.first_index;
+                this->generations[i] = _models[i]->get_upload_generation();
+            }
+        }
+
+        //! Release the CPU-side copies of the arenas (once they have been uploaded)
+        void free_arenas()
+        {
+            for (auto* a : { &this->arena_posn, &this->arena_norm, &this->arena_col }) { std::vector<float>().swap (*a); }
+            std::vector<GLuint>().swap (this->arena_ind);
+        }
+
+        /*!
+         * Write the state of each model into model_state and set its draw command's instance
+         * count to 0 if it is hidden or lies outside the frustum of the projection p. Returns the
+         * number of models to be drawn.
+         */
+        std::size_t update (const sm::mat44<float>& p)
+        {
+            constexpr std::size_t stride = mplot::VisualModelBase<glver>::batch_state_stride;
+            this->model_state.resize (this->models.size() * stride);
+            std::size_t n_drawn = 0;
+            for (std::size_t i = 0; i < this->models.size(); ++i) {
+                const mplot::VisualModelBase<glver>* m = this->models[i];
+                m->write_batch_state (this->model_state.data() + i * stride);
+                const bool drawn = !m->getHide() && !m->outside_frustum (p);
+                this->commands[i].instance_count = drawn ? 1u : 0u;
+                n_drawn += drawn ? 1u : 0u;
+            }
+            return n_drawn;
+        }
+    };
+
+} // namespace mplot
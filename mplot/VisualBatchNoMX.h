@@ -0,0 +1,133 @@
+/*!
+ * \file
+ *
+ * A batch of VisualModels, drawn with a single glMultiDrawElementsIndirect call (OpenGL 4.3+),
+ * making its GL calls through the single context GL functions. See mplot::VisualBatchBase.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+#include <sm/mat44>
+#include <mplot/VisualCommon.h>
+#include <mplot/VisualDefaultShaders.h>
+#include <mplot/VisualBatchBase.h>
+#include <mplot/gl/util_nomx.h>
+#include <mplot/gl/loadshaders_nomx.h>
+
+namespace mplot {
+
+    template <int glver>
+    struct VisualBatchNoMX : public mplot::VisualBatchBase<glver>
+    {
+        VisualBatchNoMX() {}
+
+        ~VisualBatchNoMX()
+        {
+            if (this->prog != 0) {
+                glDeleteProgram (this->prog);
+                glDeleteVertexArrays (1, &this->vao);
+                glDeleteBuffers (num_buffers, this->buffers);
+            }
+        }
+
+        /*!
+         * Draw _models, all of which should be batchable(), with the projection p. The arenas
+         * are repacked if the models, or any of their vertices, have changed since the last
+         * call. rs is the parent Visual's record of the GL state.
+         */
+        void render (const std::vector<mplot::VisualModelBase<glver>*>& _models, const sm::mat44<float>& p,
+                     mplot::visgl::render_state& rs)
+        {
+            if (_models.empty()) { return; }
+            if (this->prog == 0) { this->init(); }
+            if (this->needs_rebuild (_models)) {
+                this->pack (_models);
+                this->upload_arenas (rs);
+                this->free_arenas();
+            }
+            if (this->update (p) == 0) { return; }
+
+            mplot::gl::Util::use_program (rs, this->prog);
+            if (this->colour_by_datum_loc != -1) { glUniform1i (this->colour_by_datum_loc, 0); }
+            mplot::gl::Util::bind_vao (rs, this->vao);
+
+#ifdef GL_VERSION_4_3
+            // Both buffers are rewritten every frame, so they are orphaned rather than updated
+            glBindBuffer (GL_DRAW_INDIRECT_BUFFER, this->buffers[indirect_buffer]);
+            glBufferData (GL_DRAW_INDIRECT_BUFFER, this->commands.size() * sizeof (typename mplot::VisualBatchBase<glver>::draw_command),
+                          this->commands.data(), GL_STREAM_DRAW);
+            rs.counts.bytes_uploaded += this->commands.size() * sizeof (typename mplot::VisualBatchBase<glver>::draw_command);
+            glBindBufferBase (GL_SHADER_STORAGE_BUFFER, mplot::visgl::batch_state_binding, this->buffers[state_buffer]);
+            glBufferData (GL_SHADER_STORAGE_BUFFER, this->model_state.size() * sizeof(float), this->model_state.data(), GL_STREAM_DRAW);
+            rs.counts.bytes_uploaded += this->model_state.size() * sizeof(float);
+
+            glMultiDrawElementsIndirect (GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(this->commands.size()), 0);
+            ++rs.counts.draw_calls;
+
+            glBindBuffer (GL_DRAW_INDIRECT_BUFFER, 0);
+#else
+            throw std::runtime_error ("VisualBatch: GL headers lack glMultiDrawElementsIndirect");
+#endif
+            mplot::gl::Util::checkError (__FILE__, __LINE__);
+        }
+
+    protected:
+        enum buffer_idx { posn_buffer, norm_buffer, col_buffer, idx_buffer, id_buffer, indirect_buffer, state_buffer, num_buffers };
+        //! The batch shader program (VisualBatch.vert.glsl with the default fragment shader)
+        GLuint prog = 0;
+        //! The location of the colour_by_datum uniform, which the default fragment shader reads
+        GLint colour_by_datum_loc = -1;
+        //! The vertex array object for the arenas
+        GLuint vao = 0;
+        //! The arena, batch id, draw command and model state buffers
+        GLuint buffers[num_buffers] = {};
+
+        //! Compile the batch shader program and create the vertex array and buffers
+        void init()
+        {
+            std::vector<mplot::gl::ShaderInfo> shader_progs = {
+                {GL_VERTEX_SHADER, "VisualBatch.vert.glsl", mplot::getDefaultBatchVtxShader(glver), 0 },
+                {GL_FRAGMENT_SHADER, "Visual.frag.glsl", mplot::getDefaultFragShader(glver), 0 }
+            };
+            this->prog = mplot::gl::LoadShaders (shader_progs);
+            const GLuint block = glGetUniformBlockIndex (this->prog, "SceneState");
+            if (block != GL_INVALID_INDEX) { glUniformBlockBinding (this->prog, block, mplot::visgl::scene_state_binding); }
+            this->colour_by_datum_loc = glGetUniformLocation (this->prog, "colour_by_datum");
+            glGenVertexArrays (1, &this->vao);
+            glGenBuffers (num_buffers, this->buffers);
+            mplot::gl::Util::checkError (__FILE__, __LINE__);
+        }
+
+        //! Upload the arenas into their buffers, along with the per-instance batch ids 0, 1, 2...
+        void upload_arenas (mplot::visgl::render_state& rs)
+        {
+            mplot::gl::Util::bind_vao (rs, this->vao);
+            auto upload = [this, &rs](const buffer_idx b, const std::vector<float>& dat, const unsigned int attrib, const GLint sz) {
+                glBindBuffer (GL_ARRAY_BUFFER, this->buffers[b]);
+                glBufferData (GL_ARRAY_BUFFER, dat.size() * sizeof(float), dat.data(), GL_STATIC_DRAW);
+                rs.counts.bytes_uploaded += dat.size() * sizeof(float);
+                glVertexAttribPointer (attrib, sz, GL_FLOAT, GL_FALSE, 0, (void*)(0));
+                glEnableVertexAttribArray (attrib);
+            };
+            upload (posn_buffer, this->arena_posn, visgl::posnLoc, 3);
+            upload (norm_buffer, this->arena_norm, visgl::normLoc, 3);
+            upload (col_buffer, this->arena_col, visgl::colLoc, 3);
+            std::vector<float> ids (this->models.size());
+            for (std::size_t i = 0; i < ids.size(); ++i) { ids[i] = static_cast<float>(i); }
+            upload (id_buffer, ids, visgl::batchIdLoc, 1);
+            glVertexAttribDivisor (visgl::batchIdLoc, 1);
+
+            glBindBuffer (GL_ELEMENT_ARRAY_BUFFER, this->buffers[idx_buffer]);
+            glBufferData (GL_ELEMENT_ARRAY_BUFFER, this->arena_ind.size() * sizeof(GLuint), this->arena_ind.data(), GL_STATIC_DRAW);
+            rs.counts.bytes_uploaded += this->arena_ind.size() * sizeof(GLuint);
+            mplot::gl::Util::checkError (__FILE__, __LINE__);
+        }
+    };
+
+} // namespace mplot
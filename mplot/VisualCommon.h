@@ -6,11 +6,18 @@
  * Author: Seb James.
  */
 
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
 #include <stdexcept>
 #include <iostream>
 #include <cstring>
 #include <sm/vec>
 #include <mplot/tools.h>
+#include <mplot/frame_profiler.h>
+#include <mplot/recycler.h>
 
 namespace mplot {
 
@@ -25,6 +32,192 @@ namespace mplot {
             unsigned int /*GLuint*/ gprog = 0;
             //! A text shader program, which uses textures to draw text on quads.
             unsigned int /*GLuint*/ tprog = 0;
+            //! The ID pass programs of Visual::pick, for triangles and for sprites (linked on the first pick)
+            unsigned int /*GLuint*/ pick_prog = 0;
+            unsigned int /*GLuint*/ pick_sprite_prog = 0;
+        };
+
+        /*!
+         * The locations of the uniforms used in the mplot::Visual shader programs. These are
+         * looked up once, when a program is linked, rather than on every render call. A location
+         * of -1 means that the program has no such (active) uniform, in which case a call to
+         * glUniform* with that location is silently ignored.
+         */
+        struct shader_uniforms
+        {
+            int /*GLint*/ m_matrix = -1;
+            int v_matrix = -1;
+            int p_matrix = -1;
+            int alpha = -1;
+            // Lighting, in the graphics shaders
+            int light_colour = -1;
+            int ambient_intensity = -1;
+            int diffuse_position = -1;
+            int diffuse_intensity = -1;
+            // In the cylindrical projection shader
+            int cyl_cam_pos = -1;
+            int cyl_radius = -1;
+            int cyl_height = -1;
+            // Colour mapping by datum through a lookup texture (VisualModel::colour_by_datum)
+            int colour_by_datum = -1;
+            int colour_lut = -1;
+            // ...and with the datums sampled from a texture (VisualModel::colour_by_datum_texture)
+            int datum_texture = -1;
+            int datum_scale = -1;
+            int datum_texture_offset = -1;
+            int cell_grid = -1;
+            int cell_grid_colour = -1;
+            int cell_border_colour = -1;
+            // ...and with the datums of the elements read from a texture (VisualModel::colour_by_element)
+            int element_offset = -1;
+            int element_scale = -1;
+            // ...and with a disc coloured per fragment (VisualModel::colour_by_polar)
+            int polar_inner = -1;
+            // The bend of a flat model onto a cylinder (VisualModel::vertex_curvature)
+            int curvature = -1;
+            int curvature_offset = -1;
+            // In the text shader
+            int textColor = -1;
+            int text_sdf = -1;
+            int text_billboard = -1;
+            // In the pick shaders (VisualModel::render_pick)
+            int model_id = -1;
+            int pick_mode = -1;
+            int element_base = -1;
+            int sprite_radius = -1;
+            int viewport = -1;
+        };
+
+        /*!
+         * The per-frame scene state, laid out to match the std140 SceneState uniform block in the
+         * default shaders (see VisualDefaultShaders.h). mplot::Visual writes one of these into a
+         * uniform buffer object once per frame, rather than setting each uniform in each program.
+         */
+        struct scene_state
+        {
+            std::array<float, 16> p_matrix = {};
+            std::array<float, 4> cyl_cam_pos = {};
+            std::array<float, 3> light_colour = {};
+            float ambient_intensity = 1.0f;
+            std::array<float, 3> diffuse_position = {};
+            float diffuse_intensity = 0.0f;
+            float cyl_radius = 0.005f;
+            float cyl_height = 0.01f;
+            std::array<float, 2> pad = {}; // std140 rounds the block up to a multiple of vec4
+        };
+        static_assert (sizeof (scene_state) == 128, "scene_state must match the std140 SceneState block");
+
+        //! The uniform buffer binding point to which the SceneState block is attached
+        static constexpr unsigned int scene_state_binding = 0;
+
+        //! The texture unit to which a VisualModel's colour lookup texture is bound
+        static constexpr unsigned int colour_lut_unit = 1;
+
+        //! The texture unit to which a VisualModel's datum texture is bound
+        static constexpr unsigned int datum_texture_unit = 2;
+
+        //! The texture units to which the accumulation and weight textures of order independent
+        //! transparency are bound for its composite pass (this one and the next)
+        static constexpr unsigned int oit_first_unit = 3;
+
+        //! The texture unit to which the cube map of the cube map cylindrical projection is bound
+        //! for its resampling pass
+        static constexpr unsigned int cyl_cube_unit = 5;
+
+        //! The texture unit to which the resolved scene is bound for the final pass of
+        //! VisualBase::antiAliasing
+        static constexpr unsigned int post_process_unit = 6;
+
+        //! The texture units to which a VisualModel's volume texture and the texture of its brick
+        //! maxima are bound (this one and the next)
+        static constexpr unsigned int volume_first_unit = 7;
+
+        //! The shader storage binding point of the BatchState block (see mplot::VisualBatchBase)
+        static constexpr unsigned int batch_state_binding = 1;
+
+        //! The first of the six shader storage binding points used by the GPU mesh compute shaders
+        //! (see VisualModelBase::gpu_mesh)
+        static constexpr unsigned int gpu_mesh_first_binding = 2;
+
+        //! The first of the four shader storage binding points used by the jump flooding compute
+        //! shader (see VisualModelBase::set_jump_flood_grid), after those of the GPU mesh
+        static constexpr unsigned int jump_flood_first_binding = 8;
+
+        //! The image unit to which the jump flooding compute shader writes the cells' data
+        static constexpr unsigned int jump_flood_image_unit = 0;
+
+        //! The parts of a model that VisualModel::render draws. Visual draws the triangles of
+        //! translucent models, and then their other parts, in separate passes when it blends them
+        //! order independently (see VisualBase::orderIndependentTransparency).
+        enum class model_parts { all, triangles, others };
+
+        /*!
+         * A record of the OpenGL state that mplot::Visual and its models change as they render,
+         * so that a GL call need only be made when the state actually changes, without querying
+         * the driver with glGetIntegerv (a synchronous round trip on many drivers). A member that
+         * holds 'unknown' forces the next call to be made. Visual resets this at the start of
+         * each frame, because client code may change GL state between frames.
+         */
+        struct render_state
+        {
+            static constexpr unsigned int unknown = 0xffffffff;
+            //! The GLuint ID of the shader program in use
+            unsigned int program = unknown;
+            //! The GLuint ID of the bound vertex array object
+            unsigned int vao = unknown;
+            //! Whether GL_BLEND is enabled. 0 for disabled, 1 for enabled
+            unsigned int blend = unknown;
+            //! The draw calls, texture binds and buffer uploads made (read by the frame_profiler)
+            mplot::render_counts counts;
+            //! The parts of each model that its render() should draw
+            model_parts parts = model_parts::all;
+            //! If false, models don't call glGetError after they draw (see VisualBase::tiledGpuProfile)
+            bool check_errors = true;
+        };
+
+        /*!
+         * The GL names and the emptied vertex vectors of the VisualTextModels that a Visual has
+         * deleted, for its new text models to reuse, so that rebuilding many labels makes few
+         * glGen/glDelete calls and few heap allocations. A text model's vertex array object is
+         * kept with its own buffers, so the attribute pointers and element buffer recorded in a
+         * reused vertex array object are those that its new owner would set up anyway.
+         */
+        struct text_model_pool
+        {
+            //! A text model's vertex array object and its position, normal, colour, index and
+            //! texture buffers
+            struct gl_names
+            {
+                unsigned int vao = 0;
+                std::array<unsigned int, 5> vbos = {};
+            };
+            //! Vectors that have grown beyond this capacity (such as a console's) are freed
+            static constexpr std::size_t max_kept_capacity = 16384;
+
+            mplot::recycler<gl_names> names;
+            //! Four float vectors (positions, normals, colours and textures) per text model
+            mplot::recycler<std::vector<float>> floats = mplot::recycler<std::vector<float>>(256);
+            mplot::recycler<std::vector<unsigned int>> indices;
+            //! Reused for the 16 bit copy of each text model's indices
+            std::vector<unsigned short> indices16;
+
+            //! If v has no storage, give it that of a vector that was given back
+            void take (std::vector<float>& v) { if (v.capacity() == 0u) { this->floats.take (v); } }
+            void take (std::vector<unsigned int>& v) { if (v.capacity() == 0u) { this->indices.take (v); } }
+
+            //! Keep the storage of v for reuse (or free it, if it is too big or the pool is full),
+            //! leaving v empty
+            void give (std::vector<float>& v) { text_model_pool::give_back (this->floats, v); }
+            void give (std::vector<unsigned int>& v) { text_model_pool::give_back (this->indices, v); }
+
+        private:
+            template <typename V>
+            static void give_back (mplot::recycler<V>& r, V& v)
+            {
+                v.clear();
+                if (v.capacity() > 0u && v.capacity() <= max_kept_capacity) { r.put (std::move (v)); }
+                V().swap (v);
+            }
         };
 
         // This defines different graphics shader types, as used in mplot::Visual. The essential
@@ -37,21 +230,66 @@ namespace mplot {
             spherical     // not implemented, but we could have a spherical projection
         };
 
-        //! The locations for the position, normal and colour vertex attributes in the
-        //! mplot::Visual GLSL programs
-        enum AttribLocn { posnLoc = 0, normLoc = 1, colLoc = 2, textureLoc = 3 };
+        //! The locations for the position, normal and colour vertex attributes (and the
+        //! per-instance position/scale, colour and direction attributes, the colour mapping
+        //! datum and the model index in a batch) in the mplot::Visual GLSL programs
+        enum AttribLocn { posnLoc = 0, normLoc = 1, colLoc = 2, textureLoc = 3, instPosnLoc = 4, instColLoc = 5, instDirnLoc = 6, datumLoc = 7, batchIdLoc = 8 };
+
+        //! A model with no more than this many vertices has its indices uploaded to the GPU as 16
+        //! bit (GL_UNSIGNED_SHORT) rather than 32 bit values
+        static constexpr std::size_t short_index_max_vertices = 65536;
+
+        //! Narrow the n 32 bit indices from in into 16 bit values in out (which is resized to n)
+        inline void narrow_indices (const unsigned int* in, const std::size_t n, std::vector<unsigned short>& out)
+        {
+            out.resize (n);
+            for (std::size_t i = 0; i < n; ++i) { out[i] = static_cast<unsigned short>(in[i]); }
+        }
+
+        //! A model with no more than this many vertices may share its vertex buffers with the
+        //! models whose meshes are identical to its own (see VisualModelBase::setShareMesh)
+        static constexpr std::size_t share_mesh_max_vertices = 8192;
+
+        /*!
+         * The key of a mesh in the mesh registry of mplot::VisualResources: the context group in
+         * which its buffers were made, the hash of its indices, positions, normals and colours
+         * (see hash_words), the number of indices and the number of floats in its positions.
+         */
+        using mesh_key = std::tuple<unsigned int, std::uint64_t, std::size_t, std::size_t>;
+
+        /*!
+         * The key of one vertex buffer in the geometry registry of mplot::VisualResources (see
+         * VisualModelBase::setShareGeometry): the context group in which it was made, which of a
+         * model's buffers it is (idxVBO, posnVBO or normVBO), the hash of its contents and the
+         * number of elements in it.
+         */
+        using buffer_key = std::tuple<unsigned int, unsigned int, std::uint64_t, std::size_t>;
+
+        //! Add the n 32 bit words at data to the FNV-1a hash h
+        inline std::uint64_t hash_words (std::uint64_t h, const void* data, const std::size_t n)
+        {
+            const unsigned char* d = static_cast<const unsigned char*>(data);
+            for (std::size_t i = 0; i < n; ++i) {
+                std::uint32_t w = 0;
+                std::memcpy (&w, d + i * sizeof(w), sizeof(w));
+                h = (h ^ w) * 0x100000001b3ull;
+            }
+            return h;
+        }
 
         //! A struct to hold information about font glyph properties
         struct CharInfo
         {
-            //! ID handle of the glyph texture
-            unsigned int textureID;
+            //! ID handle of the glyph texture (the VisualFace's glyph atlas)
+            unsigned int textureID = 0;
             //! Size of glyph
-            sm::vec<int,2>  size;
+            sm::vec<int,2>  size = { 0, 0 };
             //! Offset from baseline to left/top of glyph
-            sm::vec<int,2>  bearing;
+            sm::vec<int,2>  bearing = { 0, 0 };
             //! Offset to advance to next glyph
-            unsigned int advance;
+            unsigned int advance = 0;
+            //! Texture coordinates of the glyph within the atlas: left, top, right, bottom
+            sm::vec<float,4> uv = { 0.0f, 0.0f, 1.0f, 1.0f };
         };
 
     } // namespace gl
@@ -4,12 +4,25 @@
 #pragma once
 
 #include <vector>
+#include <array>
+#include <algorithm>
 #include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <cmath>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <stdexcept>
 #include <sm/vec>
 #include <sm/vvec>
 #include <sm/scale>
+#include <sm/range>
 #include <mplot/VisualModel.h>
 #include <mplot/ColourMap.h>
+#include <mplot/data_slot.h>
+#include <mplot/frame_stream.h>
+#include <mplot/element_mask.h>
 
 namespace mplot
 {
@@ -21,7 +34,7 @@ namespace mplot
         VisualDataModel() : mplot::VisualModel<glver>::VisualModel() {}
         VisualDataModel (const sm::vec<float> _offset) : mplot::VisualModel<glver>::VisualModel (_offset) {}
         //! Deconstructor should *not* deallocate data - client code should do that
-        ~VisualDataModel() {}
+        ~VisualDataModel() { if (this->dataSlot != nullptr) { this->dataSlot->set_notify (nullptr); } }
 
         //! Reset the autoscaled flags so that the next time data is transformed by
         //! the Scale objects they will autoscale again (assuming they have
@@ -50,6 +63,28 @@ namespace mplot
         void setVectorData (const std::vector<sm::vec<T>>* _vectors) { this->vectorData = _vectors; }
         void setDataCoords (std::vector<sm::vec<float>>* _coords) { this->dataCoords = _coords; }
 
+        /*!
+         * Take the scalar data from n values of T held elsewhere (a numpy buffer, a mapped file,
+         * an arena), the first at first and each stride_bytes after the last, so that one field
+         * of an array of records can be shown. The values are gathered into external_scalars,
+         * which the model owns and reuses, and scalarData points there; the memory at first is
+         * not read again, and need not outlive the call.
+         */
+        void setScalarData (const T* first, const std::size_t n, const std::size_t stride_bytes = sizeof (T))
+        {
+            VisualDataModel<T, glver>::gather (first, n, stride_bytes, this->external_scalars);
+            this->scalarData = &this->external_scalars;
+        }
+        void setScalarData (std::span<const T> _data) { this->setScalarData (_data.data(), _data.size()); }
+
+        //! Take the vector data from n vectors held elsewhere, stride_bytes apart (see setScalarData)
+        void setVectorData (const sm::vec<T>* first, const std::size_t n, const std::size_t stride_bytes = sizeof (sm::vec<T>))
+        {
+            VisualDataModel<T, glver>::gather (first, n, stride_bytes, this->external_vectors);
+            this->vectorData = &this->external_vectors;
+        }
+        void setVectorData (std::span<const sm::vec<T>> _vectors) { this->setVectorData (_vectors.data(), _vectors.size()); }
+
         void updateZScale (const sm::scale<T, float>& zscale)
         {
             this->zScale = zscale;
@@ -72,21 +107,409 @@ namespace mplot
         {
             this->cm.setHue (_hue);
             this->cm.setType (_cmt);
+            // A model that is coloured by datum (or on the GPU, or is a volume) changes colour map
+            // with no change to its vertices. A polar lookup is remade when the model is.
+            if ((this->datum_colour_mode() != 0 && !this->colour_by_polar) || this->gpu_mesh || this->has_volume()) {
+                this->bake_colour_lut();
+                if (this->gpu_mesh) { this->gpu_mesh_update(); }
+            }
+        }
+
+        //! Sample this->cm at n evenly spaced points in [0,1] to make the colour lookup table for
+        //! the colour_by_datum, colour_by_datum_texture and colour_by_element modes. Call after
+        //! changing cm, if not through setColourMap().
+        void bake_colour_lut (const unsigned int n = 256)
+        {
+            std::vector<float> rgb (3u * n);
+            for (unsigned int i = 0; i < n; ++i) {
+                std::array<float, 3> c = this->cm.convert (n > 1 ? static_cast<float>(i) / static_cast<float>(n - 1) : 0.0f);
+                std::copy (c.begin(), c.end(), rgb.begin() + 3u * i);
+            }
+            this->set_colour_lut (rgb);
+        }
+
+        /*!
+         * In gpu_mesh mode, pass scalarData and the z and colour scalings (which must be linear)
+         * to the GPU mesh compute shader. A scaling that is to be autoscaled, and has not been, is
+         * autoscaled from the range of the data (on the GPU, at every update, if gpu_autoscale).
+         * z_mult multiplies the z scaling.
+         */
+        void set_gpu_mesh_scalar_data (const float z_mult = 1.0f)
+        {
+            if (this->scalarData == nullptr) { throw std::runtime_error ("VisualDataModel: gpu_mesh needs scalar data"); }
+            if (this->colour_lut.empty()) { this->bake_colour_lut(); }
+            this->gpu_mesh_autoscale = { this->gpu_autoscale && this->zScale.do_autoscale,
+                                         this->gpu_autoscale && this->colourScale.do_autoscale };
+            const bool autoscale_z = this->zScale.do_autoscale && !this->zScale.ready() && !this->gpu_mesh_autoscale[0];
+            const bool autoscale_c = this->colourScale.do_autoscale && !this->colourScale.ready() && !this->gpu_mesh_autoscale[1];
+            if (autoscale_z || autoscale_c) {
+                sm::range<T> r;
+                r.search_init();
+                for (const T& d : *this->scalarData) { if (!std::isnan (d)) { r.update (d); } }
+                if (autoscale_z) { this->zScale.compute_scaling (r.min, r.max); }
+                if (autoscale_c) { this->colourScale.compute_scaling (r.min, r.max); }
+            }
+            this->gpu_mesh_zscale = { z_mult * static_cast<float>(this->zScale.getParams (0)),
+                                      z_mult * static_cast<float>(this->zScale.getParams (1)) };
+            this->gpu_mesh_cscale = { static_cast<float>(this->colourScale.getParams (0)),
+                                      static_cast<float>(this->colourScale.getParams (1)) };
+            this->gpu_mesh_zrange = { z_mult * static_cast<float>(this->zScale.output_range.min),
+                                      z_mult * static_cast<float>(this->zScale.output_range.max) };
+            this->gpu_mesh_crange = { static_cast<float>(this->colourScale.output_range.min),
+                                      static_cast<float>(this->colourScale.output_range.max) };
+            this->set_gpu_mesh_data (std::vector<float> (this->scalarData->begin(), this->scalarData->end()));
+        }
+
+        /*!
+         * Take the scalar data from buf, a shader storage buffer of one float per element that is
+         * written by a compute shader (for example one of an mplot::gl::compute_manager's, in this
+         * context or one that shares its objects), rather than from scalarData. The model must be
+         * in gpu_mesh mode (see setGpuMesh). Its first build still needs scalarData, from which
+         * the positions and any autoscaled z and colour scalings are found (unless gpu_autoscale
+         * is set, in which case the scalings follow the range of buf). After each write to
+         * buf (and the writer's glMemoryBarrier), call updateDataBuffer(). The data then go from
+         * the simulation to the screen without passing through the CPU.
+         */
+        void setScalarDataBuffer (const GLuint buf)
+        {
+            if (!this->gpu_mesh) { throw std::runtime_error ("VisualDataModel::setScalarDataBuffer: the model must be in gpu_mesh mode"); }
+            this->setGpuMeshDataBuffer (buf);
+        }
+
+        //! Regenerate the model from the buffer given to setScalarDataBuffer, after a write to it
+        void updateDataBuffer() { this->gpu_mesh_update(); }
+
+        /*!
+         * If true (and the model is in gpu_mesh mode), an autoscaled zScale or colourScale is
+         * autoscaled on the GPU each time the mesh is generated: a compute shader finds the range
+         * of the data and the mesh shader maps it onto the scale's output range. Data that
+         * arrive through setScalarDataBuffer are then autoscaled frame by frame without being
+         * read back. Set before finalize().
+         */
+        bool gpu_autoscale = false;
+
+        /*!
+         * Take the model's scalar and vector data from slot, into which simulation threads
+         * publish without taking the Visual's context (see mplot/data_slot.h). At the start of
+         * each render(), if a new frame has been published, the model points scalarData (and
+         * vectorData) at the frame's non-empty arrays and rebuilds with reinit_data(). Each
+         * publish requests a redraw. The slot must outlive the model, or be detached with
+         * setDataSlot (nullptr).
+         */
+        void setDataSlot (mplot::data_slot<T>* slot)
+        {
+            if (this->dataSlot != nullptr) { this->dataSlot->set_notify (nullptr); }
+            this->dataSlot = slot;
+            this->take_data_enabled = slot != nullptr || this->playback.active();
+            // publish() runs on the simulation thread, so it only asks for a render; take_data()
+            // counts the change to the model, on the render thread
+            if (slot != nullptr) { slot->set_notify ([this]() { this->request_render(); }); }
+        }
+
+        //! Rebuild from the latest frame in dataSlot, if there is a new one (and fetch more of
+        //! any playback, see setPlayback)
+        void take_data() override
+        {
+            if (this->playback.active()) { this->playback_prefetch(); }
+            if (this->dataSlot == nullptr || !this->dataSlot->take()) { return; }
+            const typename mplot::data_slot<T>::frame& f = this->dataSlot->latest();
+            if (!f.scalars.empty()) { this->scalarData = &f.scalars; }
+            if (!f.vectors.empty()) { this->vectorData = &f.vectors; }
+            this->reinit_data();
+            this->scene_changed();
+        }
+
+        /*!
+         * Play back a recorded time series, frames, each frame of which holds one datum per
+         * element of the model. The model must be built (finalized) in colour_by_element mode;
+         * playback changes its colours, not its geometry, so give it a flat zScale. The frames
+         * are copied, unscaled, into datum_texture, which holds two blocks of block_frames frames
+         * (by default, as many as fit in playback_max_rows rows of texels). One linear
+         * colourScale, autoscaled over all of the frames if do_autoscale is set, maps them all
+         * onto the colour map on the GPU (or as they are copied, if datum_texture_format is
+         * unorm16 or unorm8). showFrame() then shows a frame by setting
+         * element_offset, so moving between the frames of a block costs one uniform. While one
+         * block is shown, the next one in the direction of play is copied in,
+         * playback_prefetch_frames frames at each render. frames must outlive the playback; call
+         * endPlayback() before giving the model new data.
+         */
+        void setPlayback (const std::vector<std::vector<T>>* frames, const std::size_t block_frames = 0)
+        {
+            if (!this->colour_by_element) { throw std::runtime_error ("VisualDataModel::setPlayback: the model must be in colour_by_element mode"); }
+            if (frames == nullptr || frames->empty()) { throw std::runtime_error ("VisualDataModel::setPlayback: there are no frames"); }
+            const std::size_t n = frames->front().size();
+            if (n == 0 || (this->scalarData != nullptr && this->scalarData->size() != n)) {
+                throw std::runtime_error ("VisualDataModel::setPlayback: each frame needs one datum per element");
+            }
+            for (const std::vector<T>& f : *frames) {
+                if (f.size() != n) { throw std::runtime_error ("VisualDataModel::setPlayback: the frames differ in size"); }
+            }
+            // One colour scaling for the whole series, so that one frame can be compared with another
+            if (this->colourScale.do_autoscale) {
+                sm::range<T> r;
+                r.search_init();
+                for (const std::vector<T>& f : *frames) {
+                    for (const T& d : f) { if (!std::isnan (d)) { r.update (d); } }
+                }
+                this->colourScale.compute_scaling (r.min, r.max);
+            }
+            this->start_playback (frames->size(), n, block_frames);
+            this->playback.frames = frames;
+            this->showFrame (0);
+        }
+
+        /*!
+         * Play back a recorded time series that is streamed from disk by stream (see
+         * mplot/frame_stream.h), as for setPlayback (frames), but with the frames coming from the
+         * stream's reads ahead rather than from memory. At each render, the frames that the
+         * stream has read since the last are copied into datum_texture; showFrame() waits only
+         * for the frame that it shows, if it hasn't been read, and moves the stream's read
+         * ahead to it. A series of any length can be scrubbed through in this way. The
+         * colourScale can't be autoscaled over a series that may not fit in memory, so if it is
+         * set to autoscale, it is autoscaled over the first frame; better to set its range. The
+         * stream must outlive the playback.
+         */
+        void setPlayback (mplot::frame_stream<T>* stream, const std::size_t block_frames = 0)
+        {
+            if (!this->colour_by_element) { throw std::runtime_error ("VisualDataModel::setPlayback: the model must be in colour_by_element mode"); }
+            if (stream == nullptr || stream->frames() == 0u) { throw std::runtime_error ("VisualDataModel::setPlayback: there are no frames"); }
+            const std::size_t n = stream->frame_size();
+            if (n == 0 || (this->scalarData != nullptr && this->scalarData->size() != n)) {
+                throw std::runtime_error ("VisualDataModel::setPlayback: each frame needs one datum per element");
+            }
+            if (this->colourScale.do_autoscale) {
+                sm::range<T> r;
+                r.search_init();
+                stream->wait_frame (0, [&r](const T* d, const std::size_t len) {
+                    for (std::size_t i = 0; i < len; ++i) { if (!std::isnan (d[i])) { r.update (d[i]); } }
+                });
+                this->colourScale.compute_scaling (r.min, r.max);
+            }
+            this->start_playback (stream->frames(), n, block_frames);
+            this->playback.stream = stream;
+            this->showFrame (0);
+        }
+
+        /*!
+         * Show frame f of the playback. If f is in a block that has not (or not yet wholly)
+         * arrived in datum_texture, its frames up to f are copied in now.
+         */
+        void showFrame (const std::size_t f)
+        {
+            playback_state& p = this->playback;
+            if (!p.active()) { throw std::runtime_error ("VisualDataModel::showFrame: there is no playback (see setPlayback)"); }
+            if (f >= p.n_frames) { throw std::out_of_range ("VisualDataModel::showFrame: no such frame"); }
+            p.forward = f >= p.frame;
+            p.frame = f;
+            const std::size_t b = f / p.block_frames;
+            const std::size_t s = b % 2u;
+            if (p.block[s] != b) {
+                p.block[s] = b;
+                p.loaded[s] = 0;
+                p.present[s].assign (p.block_frames, false);
+            }
+            if (p.stream != nullptr) {
+                // Read ahead from f, and wait for f itself if it hasn't been read
+                p.stream->seek (f, p.forward);
+                if (!p.present[s][f % p.block_frames]) { this->stream_load (s, f % p.block_frames, 1u, true); }
+            } else {
+                this->playback_load (s, f % p.block_frames + 1u);
+            }
+            this->element_offset = static_cast<int>((s * p.block_frames + f % p.block_frames) * p.frame_texels);
+            // Make the other half of datum_texture ready for the next block in the direction of play
+            const std::size_t n_blocks = (p.n_frames + p.block_frames - 1u) / p.block_frames;
+            const std::size_t next = p.forward ? b + 1u : b - 1u; // b - 1 wraps past n_blocks at b == 0
+            if (n_blocks > 1u && next < n_blocks && p.block[next % 2u] != next) {
+                p.block[next % 2u] = next;
+                p.loaded[next % 2u] = 0;
+                p.present[next % 2u].assign (p.block_frames, false);
+            }
+            this->scene_changed();
+        }
+
+        //! The number of frames of the playback (0 if there is none)
+        std::size_t playbackFrames() const { return this->playback.n_frames; }
+
+        //! The frame shown by the playback
+        std::size_t currentFrame() const { return this->playback.frame; }
+
+        //! End the playback, going back to colouring the model from scalarData (if set)
+        void endPlayback()
+        {
+            this->playback = playback_state{};
+            this->take_data_enabled = this->dataSlot != nullptr;
+            this->element_offset = 0;
+            this->element_scale = { 1.0f, 0.0f };
+            if (this->scalarData != nullptr) { this->reinit_data(); }
+        }
+
+        /*!
+         * Append the colour of datum ri to vertexColors n times or, if colour_by_datum, append its
+         * scaled colour value (from dcolour) to vertexDatums n times. If colour_by_element, ri
+         * itself is appended to vertexDatums n times (see set_element_datums).
+         */
+        void push_colour (const uint64_t ri, const std::size_t n)
+        {
+            if (this->colour_by_element) {
+                this->vertexDatums.insert (this->vertexDatums.end(), n, static_cast<float>(ri));
+            } else if (this->colour_by_datum) {
+                this->vertexDatums.insert (this->vertexDatums.end(), n, this->dcolour[ri]);
+            } else {
+                std::array<float, 3> clr = this->setColour (ri);
+                for (std::size_t i = 0; i < n; ++i) { this->vertex_push (clr, this->vertexColors); }
+            }
+        }
+
+        /*!
+         * Write the colour of datum ri to the n vertices from vertex vi, as push_colour appends
+         * it, into buffers already sized by grow_element_buffers. Elements that write distinct
+         * vertices can be written in parallel.
+         */
+        void write_colour (const uint64_t ri, const std::size_t vi, const std::size_t n)
+        {
+            if (this->colour_by_element) {
+                std::fill_n (this->vertexDatums.begin() + vi, n, static_cast<float>(ri));
+            } else if (this->colour_by_datum) {
+                std::fill_n (this->vertexDatums.begin() + vi, n, this->dcolour[ri]);
+            } else {
+                const std::array<float, 3> clr = this->setColour (ri);
+                for (std::size_t i = 0; i < n; ++i) { std::copy (clr.begin(), clr.end(), this->vertexColors.begin() + 3u * (vi + i)); }
+            }
+        }
+
+        /*!
+         * Make room at the end of the buffers for n_elements elements of vpe vertices and ipe
+         * indices each, so that for_elements can write them at fixed offsets. Returns the first
+         * new vertex. The colours go into vertexDatums if colour_by_datum or colour_by_element.
+         */
+        std::size_t grow_element_buffers (const std::size_t n_elements, const std::size_t vpe, const std::size_t ipe)
+        {
+            const std::size_t v0 = this->vertexPositions.size() / 3u;
+            const std::size_t nv = v0 + n_elements * vpe;
+            this->vertexPositions.resize (3u * nv);
+            this->vertexNormals.resize (3u * nv);
+            if (this->colour_by_datum || this->colour_by_element) {
+                this->vertexDatums.resize (nv);
+            } else {
+                this->vertexColors.resize (3u * nv);
+            }
+            this->indices.resize (this->indices.size() + n_elements * ipe);
+            return v0;
+        }
+
+        /*!
+         * Call f (e) for each element e in [0, n), in parallel if parallel_build (and OpenMP is
+         * available). f must write only element e's part of the buffers.
+         */
+        template <typename F>
+        void for_elements (const std::size_t n, F f)
+        {
+            const int64_t ne = static_cast<int64_t>(n);
+#ifdef _OPENMP
+#pragma omp parallel for if (this->parallel_build)
+#endif
+            for (int64_t e = 0; e < ne; ++e) { f (static_cast<std::size_t>(e)); }
+        }
+
+        /*!
+         * Re-make the model after its data has changed (called by updateData and updateCoords).
+         * This rebuilds the whole model (or, with cached_topology, only rewrites its colours);
+         * grid models override it to rewrite only the vertex data that depend on the data,
+         * keeping the indices they made at the first build.
+         */
+        virtual void reinit_data()
+        {
+            if (!this->recolour_cached_topology()) { this->reinit(); }
+        }
+
+        /*!
+         * Scale scalarData into dcolour with colourScale. A colour scale that the client fixed
+         * (by setting its parameters, leaving do_autoscale false) is used as it is; otherwise
+         * the scale is autoscaled afresh from the data.
+         */
+        void scale_colour_data()
+        {
+            if (this->colourScale.do_autoscale == true || !this->colourScale.ready()) {
+                this->colourScale.do_autoscale = true;
+                this->colourScale.reset();
+            }
+            this->dcolour.resize (this->scalarData->size());
+            this->colourScale.transform (*this->scalarData, this->dcolour);
+        }
+
+        /*!
+         * If cached_topology, record that the colour vertices that initializeVertices has
+         * appended since the last call are coloured by datum i. Models that call this (after the
+         * vertices of each datum) can be recoloured by recolour_cached_topology.
+         */
+        void note_colour_datum (const std::size_t i)
+        {
+            if (this->cached_topology) {
+                this->colour_vertex_datum.resize (this->vertexColors.size() / 3u, static_cast<std::uint32_t>(i));
+            }
+        }
+
+        //! The colour_vertex_datum of a vertex (of a frame, say) that keeps its colour
+        static constexpr std::uint32_t fixed_colour_vertex = std::numeric_limits<std::uint32_t>::max();
+
+        //! If cached_topology, record that the colour vertices appended since the last call to
+        //! note_colour_datum (or to this) keep their colours when the model is recoloured
+        void note_fixed_colour()
+        {
+            if (this->cached_topology) {
+                this->colour_vertex_datum.resize (this->vertexColors.size() / 3u, fixed_colour_vertex);
+            }
+        }
+
+        /*!
+         * With cached_topology, rewrite only vertexColors from scalarData (through the datums
+         * that note_colour_datum recorded at the last build) and upload only the colour buffer.
+         * Returns false, for a full rebuild, if there is no recorded build to reuse, or the
+         * number of data or the coordinates have changed since.
+         */
+        bool recolour_cached_topology()
+        {
+            const bool coords_changed = this->topology_changed;
+            this->topology_changed = false;
+            if (!this->cached_topology || coords_changed || this->scalarData == nullptr || this->indices.empty()
+                || this->colour_vertex_datum.empty() || this->scalarData->size() != this->colour_datum_count) {
+                return false;
+            }
+            this->restore_host_vertices();
+            if (this->vertexColors.size() != 3u * this->colour_vertex_datum.size()) { return false; }
+            this->scale_colour_data();
+            // One conversion per datum, then a copy to each of its vertices
+            this->cm.convert (this->dcolour, this->datum_colours);
+            for (std::size_t v = 0; v < this->colour_vertex_datum.size(); ++v) {
+                if (this->colour_vertex_datum[v] == fixed_colour_vertex) { continue; }
+                const float* c = this->datum_colours.data() + 3u * this->colour_vertex_datum[v];
+                std::copy (c, c + 3, this->vertexColors.begin() + 3u * v);
+            }
+            this->reinit_colour_buffer();
+            return true;
         }
 
         //! Update the scalar data
         virtual void updateData (const std::vector<T>* _data)
         {
             this->scalarData = _data;
-            this->reinit();
+            this->reinit_data();
+        }
+
+        //! Update the scalar data from memory held elsewhere (see setScalarData)
+        void updateData (const T* first, const std::size_t n, const std::size_t stride_bytes = sizeof (T))
+        {
+            this->setScalarData (first, n, stride_bytes);
+            this->reinit_data();
         }
+        void updateData (std::span<const T> _data) { this->updateData (_data.data(), _data.size()); }
 
         //! Update the scalar data with an associated z-scaling
         void updateData (const std::vector<T>* _data, const sm::scale<T, float>& zscale)
         {
             this->scalarData = _data;
             this->zScale = zscale;
-            this->reinit();
+            this->reinit_data();
         }
 
         //! Update the scalar data, along with both the z-scaling and the colour-scaling
@@ -95,7 +518,7 @@ namespace mplot
             this->scalarData = _data;
             this->zScale = zscale;
             this->colourScale = cscale;
-            this->reinit();
+            this->reinit_data();
         }
 
         //! Update coordinate data and scalar data along with z-scaling for scalar data
@@ -103,9 +526,10 @@ namespace mplot
                                  const sm::scale<T, float>& zscale)
         {
             this->dataCoords = _coords;
+            this->topology_changed = true;
             this->scalarData = _data;
             this->zScale = zscale;
-            this->reinit();
+            this->reinit_data();
         }
 
         //! Update coordinate data and scalar data along with z- and colour-scaling for scalar data
@@ -113,32 +537,117 @@ namespace mplot
                                  const sm::scale<T, float>& zscale, const sm::scale<T, float>& cscale)
         {
             this->dataCoords = _coords;
+            this->topology_changed = true;
             this->scalarData = _data;
             this->zScale = zscale;
             this->colourScale = cscale;
-            this->reinit();
+            this->reinit_data();
         }
 
         //! Update just the coordinate data
         virtual void updateCoords (std::vector<sm::vec<float>>* _coords)
         {
             this->dataCoords = _coords;
-            this->reinit();
+            this->topology_changed = true;
+            this->reinit_data();
         }
 
         //! Update the vector data (for plotting quiver plots)
         void updateData (const std::vector<sm::vec<T>>* _vectors)
         {
             this->vectorData = _vectors;
-            this->reinit();
+            this->reinit_data();
         }
 
+        //! Update the vector data from memory held elsewhere (see setVectorData)
+        void updateData (const sm::vec<T>* first, const std::size_t n, const std::size_t stride_bytes = sizeof (sm::vec<T>))
+        {
+            this->setVectorData (first, n, stride_bytes);
+            this->reinit_data();
+        }
+        void updateData (std::span<const sm::vec<T>> _vectors) { this->updateData (_vectors.data(), _vectors.size()); }
+
         //! Update both coordinate and vector data
         void updateData (std::vector<sm::vec<float>>* _coords, const std::vector<sm::vec<T>>* _vectors)
         {
             this->dataCoords = _coords;
+            this->topology_changed = true;
             this->vectorData = _vectors;
-            this->reinit();
+            this->reinit_data();
+        }
+
+        /*!
+         * Recolour only the elements of runs (spans [begin, end) of element indices) from
+         * scalarData, with the colourScale of the last full update (which is not autoscaled
+         * again), and upload only what has changed. Element i owns the vpe vertices from vertex
+         * i * vpe (or, if the model has a mask, from its slot times vpe; masked elements are
+         * skipped), whose colours (or datums, if colour_by_datum) are rewritten and marked for a
+         * sub-range upload. If colour_by_element or colour_by_datum_texture, texel i of
+         * datum_texture holds the datum of element i and only the texture rows that hold the
+         * runs are uploaded. Used by the grid models' updateRegion and updateElements.
+         */
+        void recolour_runs (const std::vector<std::array<std::size_t, 2>>& runs, const std::size_t vpe)
+        {
+            if (this->scalarData == nullptr) { throw std::runtime_error ("VisualDataModel::recolour_runs: no scalar data"); }
+            const std::size_t n = this->scalarData->size();
+            if (this->dcolour.size() < n) { this->dcolour.resize (n); }
+            const bool in_texture = this->colour_by_element || this->colour_by_datum_texture;
+            for (const std::array<std::size_t, 2>& r : runs) {
+                if (r[0] >= r[1]) { continue; }
+                if (r[1] > n) { throw std::runtime_error ("VisualDataModel::recolour_runs: element out of range"); }
+                for (std::size_t i = r[0]; i < r[1]; ++i) {
+                    this->dcolour[i] = this->colourScale.transform_one ((*this->scalarData)[i]);
+                }
+                if (in_texture) {
+                    if (this->datum_texture.size() < r[1]) { throw std::runtime_error ("VisualDataModel::recolour_runs: datum_texture is too small"); }
+                    std::copy (this->dcolour.begin() + r[0], this->dcolour.begin() + r[1], this->datum_texture.begin() + r[0]);
+                    this->reinit_datum_texels (r[0], r[1]);
+                } else if (this->colour_by_datum) {
+                    for (std::size_t i = r[0]; i < r[1]; ++i) {
+                        const std::uint32_t k = this->mask.slot (i);
+                        if (k == mplot::element_mask::none) { continue; }
+                        std::fill_n (this->vertexDatums.begin() + k * vpe, vpe, this->dcolour[i]);
+                    }
+                } else {
+                    this->restore_host_vertices();
+                    // The blocks of the run's kept elements, which are consecutive
+                    std::size_t k0 = std::numeric_limits<std::size_t>::max();
+                    std::size_t k1 = 0;
+                    for (std::size_t i = r[0]; i < r[1]; ++i) {
+                        const std::uint32_t k = this->mask.slot (i);
+                        if (k == mplot::element_mask::none) { continue; }
+                        if (this->vertexColors.size() < 3u * vpe * (k + 1u)) { throw std::runtime_error ("VisualDataModel::recolour_runs: vertexColors is too small"); }
+                        const std::array<float, 3> clr = this->cm.convert (this->dcolour[i]);
+                        for (std::size_t j = 0; j < vpe; ++j) {
+                            std::copy (clr.begin(), clr.end(), this->vertexColors.begin() + 3u * (k * vpe + j));
+                        }
+                        k0 = std::min (k0, std::size_t{k});
+                        k1 = k + 1u;
+                    }
+                    if (k1 > 0u) { this->mark_dirty_colours (k0 * vpe, k1 * vpe); }
+                }
+            }
+            if (in_texture) {
+                this->scene_changed();
+            } else {
+                this->reinit_colour_buffer();
+            }
+        }
+
+        //! Merge a list of element indices into runs of consecutive indices for recolour_runs
+        template <typename I>
+        static std::vector<std::array<std::size_t, 2>> element_runs (const std::vector<I>& elements)
+        {
+            std::vector<std::array<std::size_t, 2>> runs;
+            for (const I e : elements) {
+                const std::size_t i = static_cast<std::size_t>(e);
+                if (!runs.empty() && runs.back()[1] == i) {
+                    ++runs.back()[1];
+                } else {
+                    runs.push_back ({ i, i + 1u });
+                }
+            }
+            return runs;
         }
 
         //! An overridable function to set the colour of rect ri
@@ -189,15 +698,16 @@ namespace mplot
 
                 this->dcolour2.resize (this->datasize);
                 this->dcolour3.resize (this->datasize);
-                sm::vvec<float> veclens(this->dcopy);
+                // One pass over vectorData fills all four buffers. The vector lengths go into dcopy,
+                // which is then z-scaled in place (the buffers keep their capacity between updates)
                 for (unsigned int i = 0; i < this->datasize; ++i) {
-                    veclens[i] = (*this->vectorData)[i].length();
+                    this->dcopy[i] = (*this->vectorData)[i].length();
                     this->dcolour[i] = (*this->vectorData)[i][0];
                     this->dcolour2[i] = (*this->vectorData)[i][1];
                     // Could also extract a third colour for Trichrome vs Duochrome (or for raw RGB signal)
                     this->dcolour3[i] = (*this->vectorData)[i][2];
                 }
-                this->zScale.transform (veclens, this->dcopy);
+                this->zScale.transform (this->dcopy, this->dcopy);
 
                 // Handle case where this->cm.getType() == mplot::ColourMapType::RGB and there is
                 // exactly one colour. ColourMapType::RGB (and RGBMono/Grey) assumes R/G/B data all
@@ -246,6 +756,193 @@ namespace mplot
         //! hexes.
         const std::vector<sm::vec<T>>* vectorData = nullptr;
 
+        //! The scalar and vector data gathered by setScalarData and setVectorData from memory
+        //! that the model does not own
+        std::vector<T> external_scalars;
+        std::vector<sm::vec<T>> external_vectors;
+
+        //! Copy n values of V, stride_bytes apart from first, into out. The values need not be
+        //! aligned in the source, which may be an array of packed records.
+        template <typename V>
+        static void gather (const V* first, const std::size_t n, const std::size_t stride_bytes, std::vector<V>& out)
+        {
+            static_assert (std::is_trivially_copyable_v<V>);
+            out.resize (n);
+            if (n == 0) { return; }
+            if (first == nullptr) { throw std::runtime_error ("VisualDataModel: external data is null"); }
+            if (stride_bytes == sizeof (V)) {
+                std::memcpy (out.data(), first, n * sizeof (V));
+                return;
+            }
+            const unsigned char* p = reinterpret_cast<const unsigned char*>(first);
+            for (std::size_t i = 0; i < n; ++i, p += stride_bytes) { std::memcpy (&out[i], p, sizeof (V)); }
+        }
+
+        //! The slot from which the data are taken at render time, if any (see setDataSlot)
+        mplot::data_slot<T>* dataSlot = nullptr;
+
+        //! The most frames of the playback that are copied into datum_texture at each render
+        std::size_t playback_prefetch_frames = 8;
+        //! By default, a playback's two blocks of frames fill up to this many rows of
+        //! datum_texture. Textures of 2048 rows are supported on all GL versions.
+        unsigned int playback_max_rows = 2048;
+
+        //! The state of a playback (see setPlayback)
+        struct playback_state
+        {
+            static constexpr std::size_t no_block = std::numeric_limits<std::size_t>::max();
+            //! The frames, if they are in memory, or else the stream that they come from
+            const std::vector<std::vector<T>>* frames = nullptr;
+            mplot::frame_stream<T>* stream = nullptr;
+            std::size_t n_frames = 0;
+            std::size_t block_frames = 0;
+            //! The texels from the start of one frame to the start of the next
+            std::size_t frame_texels = 0;
+            std::size_t frame = 0;
+            bool forward = true;
+            //! The block held in each half of datum_texture, and how many of its frames are there
+            std::array<std::size_t, 2> block = { no_block, no_block };
+            std::array<std::size_t, 2> loaded = { 0u, 0u };
+            //! With a stream, which frames of each block are there (they arrive in any order)
+            std::array<std::vector<bool>, 2> present;
+            //! The map applied to the frames as they are copied in (if prescale, colourScale)
+            bool prescale = false;
+            std::array<float, 2> scale = { 1.0f, 0.0f };
+            bool active() const { return this->frames != nullptr || this->stream != nullptr; }
+        };
+        playback_state playback;
+
+        //! Set up datum_texture and the playback state for n_frames frames of n datums, in blocks of
+        //! block_frames (see setPlayback). The caller then sets playback.frames or playback.stream.
+        void start_playback (const std::size_t n_frames, const std::size_t n, const std::size_t block_frames)
+        {
+            // Each frame starts a row of texels, so a frame is element_offset texels on
+            const unsigned int w = std::clamp (static_cast<unsigned int>(n), 1u, this->element_texture_width);
+            const std::size_t rows = (n + w - 1u) / w;
+            std::size_t bf = block_frames;
+            if (bf == 0) { bf = std::max (std::size_t{1}, std::size_t{this->playback_max_rows} / (2u * rows)); }
+            bf = std::min (bf, n_frames);
+            const std::size_t n_blocks = (n_frames + bf - 1u) / bf;
+            const std::size_t h = rows * bf * (n_blocks > 1u ? 2u : 1u);
+
+            this->playback = playback_state{};
+            this->playback.n_frames = n_frames;
+            this->playback.block_frames = bf;
+            this->playback.frame_texels = rows * w;
+            this->datum_texture.assign (std::size_t{w} * h, 0.0f);
+            this->datum_texture_dims = { w, static_cast<unsigned int>(h) };
+            this->reinit_datum_texture();
+            const std::array<float, 2> cs = { static_cast<float>(this->colourScale.getParams (0)),
+                                              static_cast<float>(this->colourScale.getParams (1)) };
+            // A normalized datum_texture_format holds only [0,1], so its frames are colour scaled as they are copied in
+            this->playback.prescale = this->datum_gpu_format() == mplot::datum_format::unorm16
+                                      || this->datum_gpu_format() == mplot::datum_format::unorm8;
+            this->playback.scale = this->playback.prescale ? cs : std::array<float, 2>{ 1.0f, 0.0f };
+            this->element_scale = this->playback.prescale ? std::array<float, 2>{ 1.0f, 0.0f } : cs;
+            this->take_data_enabled = true;
+        }
+
+        //! Copy the frames of the block in half s of datum_texture, from the first that is not
+        //! there up to (not including) frame upto of the block
+        void playback_load (const std::size_t s, const std::size_t upto)
+        {
+            playback_state& p = this->playback;
+            const std::size_t f0 = p.block[s] * p.block_frames;
+            const std::size_t end = std::min ({ upto, p.block_frames, p.n_frames - f0 });
+            if (p.loaded[s] >= end) { return; }
+            const std::size_t t0 = (s * p.block_frames + p.loaded[s]) * p.frame_texels;
+            for (std::size_t k = p.loaded[s]; k < end; ++k) {
+                const std::vector<T>& fr = (*p.frames)[f0 + k];
+                std::transform (fr.begin(), fr.end(), this->datum_texture.begin() + (s * p.block_frames + k) * p.frame_texels,
+                                [sc = p.scale](const T& d) { return sc[0] * static_cast<float>(d) + sc[1]; });
+            }
+            this->reinit_datum_texels (t0, (s * p.block_frames + end) * p.frame_texels);
+            p.loaded[s] = end;
+        }
+
+        //! Copy up to playback_prefetch_frames frames into one half of datum_texture: the rest
+        //! of the block shown, if it is not all there, or else the next block
+        void playback_prefetch()
+        {
+            playback_state& p = this->playback;
+            const std::size_t cur = (p.frame / p.block_frames) % 2u;
+            if (p.stream != nullptr) {
+                // The rest of the block shown, in the direction of play, then the next block
+                const std::size_t c = this->stream_load (cur, p.frame % p.block_frames, this->playback_prefetch_frames, false);
+                const std::size_t nxt = cur ^ 1u;
+                if (c < this->playback_prefetch_frames && p.block[nxt] != playback_state::no_block) {
+                    const std::size_t nb = std::min (p.block_frames, p.n_frames - p.block[nxt] * p.block_frames);
+                    this->stream_load (nxt, p.forward ? 0u : nb - 1u, this->playback_prefetch_frames - c, false);
+                }
+                return;
+            }
+            for (const std::size_t s : { cur, cur ^ 1u }) {
+                if (p.block[s] == playback_state::no_block) { continue; }
+                const std::size_t n0 = p.loaded[s];
+                this->playback_load (s, n0 + this->playback_prefetch_frames);
+                if (p.loaded[s] != n0) { return; } // one upload per render, of one contiguous run
+            }
+        }
+
+        /*!
+         * Copy the frames of the block in half s of datum_texture that the playback's stream has
+         * read, from frame k0 of the block on in the direction of play, skipping the frames
+         * that are there already and stopping at the first that hasn't been read (or after
+         * max_frames). If wait, wait for the first to be read. The frames copied are uploaded in
+         * one run of texels. Returns the number copied.
+         */
+        std::size_t stream_load (const std::size_t s, const std::size_t k0, const std::size_t max_frames, const bool wait)
+        {
+            playback_state& p = this->playback;
+            const std::size_t f0 = p.block[s] * p.block_frames;
+            const std::size_t nb = std::min (p.block_frames, p.n_frames - f0);
+            std::size_t t_lo = std::numeric_limits<std::size_t>::max();
+            std::size_t t_hi = 0;
+            std::size_t copied = 0;
+            // Going backwards, k wraps past nb at k == 0
+            for (std::size_t k = k0; k < nb && copied < max_frames; k = p.forward ? k + 1u : k - 1u) {
+                if (p.present[s][k]) { continue; }
+                const std::size_t t = (s * p.block_frames + k) * p.frame_texels;
+                auto copy = [this, t, sc = p.scale](const T* d, const std::size_t len) {
+                    std::transform (d, d + len, this->datum_texture.begin() + t,
+                                    [sc](const T& v) { return sc[0] * static_cast<float>(v) + sc[1]; });
+                };
+                if (wait && copied == 0u) {
+                    p.stream->wait_frame (f0 + k, copy);
+                } else if (!p.stream->with_frame (f0 + k, copy)) {
+                    break;
+                }
+                p.present[s][k] = true;
+                ++copied;
+                t_lo = std::min (t_lo, t);
+                t_hi = std::max (t_hi, t + p.frame_texels);
+            }
+            if (copied > 0u) { this->reinit_datum_texels (t_lo, t_hi); }
+            return copied;
+        }
+
+        //! If true, the grid models write the vertices of their elements in parallel (with
+        //! OpenMP, see for_elements). Set false if setColour is overridden with code that must
+        //! run in one thread.
+        bool parallel_build = true;
+
+        /*!
+         * If true, the model keeps the positions, normals and indices of its first build, and
+         * updateData rewrites and uploads only its colours: for a fixed mesh whose values change
+         * each step (see recolour_cached_topology). updateCoords, or a change in the number of
+         * data, rebuilds the model in full. Supported by QuadsVisual, QuadsMeshVisual and
+         * PointRowsVisual. Set it before finalize().
+         */
+        bool cached_topology = false;
+        //! With cached_topology, the datum that colours each colour vertex, and the number of
+        //! data, of the last build (see note_colour_datum)
+        std::vector<std::uint32_t> colour_vertex_datum;
+        std::size_t colour_datum_count = 0;
+        //! The colour of each datum, for recolour_cached_topology
+        std::vector<float> datum_colours;
+        //! Set when the coordinates are updated, so that the next reinit_data rebuilds in full
+        bool topology_changed = false;
+
         //! The coordinates at which to visualize data, if appropriate (e.g. scatter
         //! graph, quiver plot). Note fixed type of float, which is suitable for
         //! OpenGL coordinates. Not const as child code may resize or update content.
@@ -265,6 +962,11 @@ namespace mplot
         //! For the third field of vectorData
         sm::vvec<float> dcolour3;
 
+        //! The elements that are drawn, for the grid models that take a mask (see mplot/element_mask.h)
+        mplot::element_mask mask;
+        //! dcolour of the kept elements, in block order, when there is a mask
+        std::vector<float> dcolour_kept;
+
         //! The length of the data structure that will be visualized. May be length of
         //! this->scalarData or of this->vectorData.
         unsigned int datasize = 0;
@@ -97,17 +97,59 @@ OpenGL 4.5
 
 namespace mplot {
 
+    // The per-frame scene state, shared by the graphics and text programs in a single uniform
+    // buffer (see mplot::visgl::scene_state). Members are highp so that the block matches between
+    // vertex and fragment stages on OpenGL ES.
+    inline constexpr const char* sceneStateBlock = "layout(std140) uniform SceneState\n"
+    "{\n"
+    "    highp mat4 p_matrix;\n"
+    "    highp vec4 cyl_cam_pos;\n"
+    "    highp vec3 light_colour;\n"
+    "    highp float ambient_intensity;\n"
+    "    highp vec3 diffuse_position;\n"
+    "    highp float diffuse_intensity;\n"
+    "    highp float cyl_radius;\n"
+    "    highp float cyl_height;\n"
+    "};\n";
+
+    // The bend of a flat model onto a cylinder, applied to the vertices by the vertex shaders of
+    // triangles when curvature.x (the radius) is positive. x is arc length (curvature.y is the
+    // angle per unit of x and curvature.z the angle of x = 0), y runs along the axis and z moves
+    // in towards the axis. curvature_offset is then subtracted. See
+    // VisualModelBase::vertex_curvature.
+    inline constexpr const char* curvatureBlock = "uniform highp vec4 curvature;\n"
+    "uniform highp vec3 curvature_offset;\n"
+    "vec3 curve_position(vec3 p)\n"
+    "{\n"
+    "    if (curvature.x <= 0.0) { return p; }\n"
+    "    float th = curvature.z + p.x * curvature.y;\n"
+    "    return vec3((curvature.x - p.z) * cos(th), (curvature.x - p.z) * sin(th), p.y) - curvature_offset;\n"
+    "}\n"
+    "vec3 curve_normal(vec3 p, vec3 n)\n"
+    "{\n"
+    "    if (curvature.x <= 0.0) { return n; }\n"
+    "    float th = curvature.z + p.x * curvature.y;\n"
+    "    return vec3(-cos(th), -sin(th), 0.0);\n"
+    "}\n";
+
     // The default vertex shader. To study this GLSL, see Visual.vert.glsl, which has
     // some code comments.
-    const char* defaultVtxShader = "uniform mat4 mvp_matrix;\n"
+    inline constexpr const char* defaultVtxShader = "uniform mat4 mvp_matrix;\n"
     "uniform mat4 vp_matrix;\n"
     "uniform mat4 m_matrix;\n"
     "uniform mat4 v_matrix;\n"
-    "uniform mat4 p_matrix;\n"
     "uniform float alpha;\n"
+    "uniform int colour_by_datum;\n"
+    "uniform highp sampler2D datum_texture;\n"
+    "uniform int element_offset;\n"
+    "uniform highp vec2 element_scale;\n"
     "layout(location = 0) in vec4 position;\n"
     "layout(location = 1) in vec4 normalin;\n"
     "layout(location = 2) in vec3 color;\n"
+    "layout(location = 4) in vec4 instance_posn;\n"
+    "layout(location = 5) in vec4 instance_colour;\n"
+    "layout(location = 6) in vec4 instance_dirn;\n"
+    "layout(location = 7) in float datum;\n"
     "out VERTEX\n"
     "{\n"
     "    vec4 normal;\n"
@@ -116,55 +158,210 @@ namespace mplot {
     "} vertex;\n"
     "void main()\n"
     "{\n"
-    "    gl_Position = (p_matrix * v_matrix * m_matrix * position);\n"
-    "    vertex.color = vec4(color, alpha);\n"
-    "    vertex.fragpos = vec3(m_matrix * position);\n"
-    "    vertex.normal = normalin;\n"
+    "    vec3 ipos = curve_position(position.xyz) * instance_posn.w;\n"
+    "    vec3 inorm = curve_normal(position.xyz, normalin.xyz);\n"
+    "    if (dot(instance_dirn.xyz, instance_dirn.xyz) > 0.0) {\n"
+    "        vec3 axis = normalize(instance_dirn.xyz);\n"
+    "        vec3 a = abs(axis.z) < 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0);\n"
+    "        vec3 u = normalize(cross(a, axis));\n"
+    "        mat3 rotn = mat3(u, cross(axis, u), axis);\n"
+    "        ipos = rotn * vec3(ipos.xy * instance_dirn.w, ipos.z);\n"
+    "        inorm = rotn * vec3(inorm.xy / instance_dirn.w, inorm.z);\n"
+    "    }\n"
+    "    vec4 iposition = vec4(ipos + instance_posn.xyz, position.w);\n"
+    "    highp float edatum = datum;\n"
+    "    if (colour_by_datum == 3) {\n"
+    "        int w = textureSize(datum_texture, 0).x;\n"
+    "        int e = int(datum + 0.5) + element_offset;\n"
+    "        edatum = element_scale.x * texelFetch(datum_texture, ivec2(e % w, e / w), 0).r + element_scale.y;\n"
+    "    }\n"
+    "    vec3 icolor = (colour_by_datum == 1 || colour_by_datum == 3) ? vec3(edatum, 0.0, 0.0) : mix(instance_colour.rgb, color, instance_colour.a);\n"
+    "    gl_Position = (p_matrix * v_matrix * m_matrix * iposition);\n"
+    "    vertex.color = vec4(icolor, alpha);\n"
+    "    vertex.fragpos = vec3(m_matrix * iposition);\n"
+    "    vertex.normal = vec4(inorm, normalin.w);\n"
     "}\n";
 
-    std::string getDefaultVtxShader (const int glver)
+    inline std::string getDefaultVtxShader (const int glver)
     {
         std::string shdr;
         shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += sceneStateBlock;
+        shdr += curvatureBlock;
         shdr += defaultVtxShader;
         return shdr;
     }
 
     // Default fragment shader. To study this GLSL, see Visual.frag.glsl.
-    const char* defaultFragShader = "in VERTEX\n"
+    inline constexpr const char* defaultFragShader = "in VERTEX\n"
     "{\n"
     "    vec4 normal;\n"
     "    vec4 color;\n"
     "    vec3 fragpos;\n"
     "} vertex;\n"
-    "uniform vec3 light_colour;\n"
-    "uniform float ambient_intensity;\n"
-    "uniform vec3 diffuse_position;\n"
-    "uniform float diffuse_intensity;\n"
+    "uniform int colour_by_datum;\n"
+    "uniform sampler2D colour_lut;\n"
+    "uniform highp sampler2D datum_texture;\n"
+    "uniform vec2 datum_scale;\n"
+    "uniform vec2 datum_texture_offset;\n"
+    "uniform vec4 cell_grid;\n"
+    "uniform vec3 cell_grid_colour;\n"
+    "uniform vec3 cell_border_colour;\n"
+    "uniform float polar_inner;\n"
     "out vec4 finalcolor;\n"
     "void main()\n"
     "{\n"
+    "    vec4 col = vertex.color;\n"
+    "    if (colour_by_datum == 4) {\n"
+    "        if (col.b > 1.5) {\n"
+    "            highp float r = length(col.rg);\n"
+    "            if (r > 1.0 || r < polar_inner) { discard; }\n"
+    "            vec2 ts = vec2(textureSize(colour_lut, 0));\n"
+    "            highp float a = fract(atan(col.g, col.r) / 6.28318531) + 0.5 / ts.x;\n"
+    "            highp float rr = clamp((r - polar_inner) / max(1.0 - polar_inner, 1e-6), 0.0, 1.0);\n"
+    "            col.rgb = texture(colour_lut, vec2(a, (rr * (ts.y - 1.0) + 0.5) / ts.y)).rgb;\n"
+    "        }\n"
+    "    } else if (colour_by_datum != 0) {\n"
+    "        highp vec2 tc = col.rg;\n"
+    "        highp float d = colour_by_datum == 2 ? datum_scale.x * texture(datum_texture, col.rg + datum_texture_offset).r + datum_scale.y : col.r;\n"
+    "        float n = float(textureSize(colour_lut, 0).x);\n"
+    "        col.rgb = texture(colour_lut, vec2((clamp(d, 0.0, 1.0) * (n - 1.0) + 0.5) / n, 0.5)).rgb;\n"
+    "        if (colour_by_datum == 2 && cell_grid.z > 0.5) {\n"
+    "            highp vec2 c = tc * vec2(textureSize(datum_texture, 0));\n"
+    "            highp vec2 fw = max(fwidth(c), vec2(1e-6));\n"
+    "            highp vec2 hw = 0.5 * (cell_grid.z > 1.5 ? cell_grid.xy * fw : cell_grid.xy);\n"
+    "            highp vec2 e = abs(c - floor(c + 0.5));\n"
+    "            vec2 on = 1.0 - smoothstep(hw - 0.5 * fw, hw + 0.5 * fw, e);\n"
+    "            col.rgb = mix(col.rgb, cell_grid_colour, max(on.x, on.y));\n"
+    "        }\n"
+    "        if (colour_by_datum == 2 && cell_grid.w > 0.5\n"
+    "            && (any(lessThan(tc, vec2(0.0))) || any(greaterThan(tc, vec2(1.0))))) {\n"
+    "            col.rgb = cell_border_colour;\n"
+    "        }\n"
+    "    }\n"
     "    vec3 norm = normalize(vec3(vertex.normal));\n"
     "    vec3 light_dirn = normalize(diffuse_position - vertex.fragpos);\n"
     "    float effective_diffuse = max(dot(norm, light_dirn), 0.0);\n"
     "    vec3 diffuse = diffuse_intensity * effective_diffuse * light_colour;\n"
     "    vec3 ambient = ambient_intensity * light_colour;\n"
-    "    vec3 result = (ambient+diffuse) * vec3(vertex.color);\n"
-    "    finalcolor = vec4(result, vertex.color.w);\n"
+    "    vec3 result = (ambient+diffuse) * vec3(col);\n"
+    "    finalcolor = vec4(result, col.w);\n"
     "}\n";
 
-    std::string getDefaultFragShader (const int glver)
+    inline std::string getDefaultFragShader (const int glver)
     {
         std::string shdr;
         shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += sceneStateBlock;
         shdr += defaultFragShader;
         return shdr;
     }
 
+    // The vertex shader of the unlit program, which is the default vertex shader without the
+    // normals (see VisualModelBase::setUnlit). See VisualUnlit.vert.glsl.
+    inline constexpr const char* defaultUnlitVtxShader = "uniform mat4 m_matrix;\n"
+    "uniform mat4 v_matrix;\n"
+    "uniform float alpha;\n"
+    "uniform int colour_by_datum;\n"
+    "uniform highp sampler2D datum_texture;\n"
+    "uniform int element_offset;\n"
+    "uniform highp vec2 element_scale;\n"
+    "layout(location = 0) in vec4 position;\n"
+    "layout(location = 2) in vec3 color;\n"
+    "layout(location = 4) in vec4 instance_posn;\n"
+    "layout(location = 5) in vec4 instance_colour;\n"
+    "layout(location = 6) in vec4 instance_dirn;\n"
+    "layout(location = 7) in float datum;\n"
+    "out vec4 vcolor;\n"
+    "void main()\n"
+    "{\n"
+    "    vec3 ipos = curve_position(position.xyz) * instance_posn.w;\n"
+    "    if (dot(instance_dirn.xyz, instance_dirn.xyz) > 0.0) {\n"
+    "        vec3 axis = normalize(instance_dirn.xyz);\n"
+    "        vec3 a = abs(axis.z) < 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0);\n"
+    "        vec3 u = normalize(cross(a, axis));\n"
+    "        mat3 rotn = mat3(u, cross(axis, u), axis);\n"
+    "        ipos = rotn * vec3(ipos.xy * instance_dirn.w, ipos.z);\n"
+    "    }\n"
+    "    highp float edatum = datum;\n"
+    "    if (colour_by_datum == 3) {\n"
+    "        int w = textureSize(datum_texture, 0).x;\n"
+    "        int e = int(datum + 0.5) + element_offset;\n"
+    "        edatum = element_scale.x * texelFetch(datum_texture, ivec2(e % w, e / w), 0).r + element_scale.y;\n"
+    "    }\n"
+    "    vec3 icolor = (colour_by_datum == 1 || colour_by_datum == 3) ? vec3(edatum, 0.0, 0.0) : mix(instance_colour.rgb, color, instance_colour.a);\n"
+    "    gl_Position = p_matrix * v_matrix * m_matrix * vec4(ipos + instance_posn.xyz, position.w);\n"
+    "    vcolor = vec4(icolor, alpha);\n"
+    "}\n";
+
+    inline std::string getDefaultUnlitVtxShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += sceneStateBlock;
+        shdr += curvatureBlock;
+        shdr += defaultUnlitVtxShader;
+        return shdr;
+    }
+
+    // The fragment shader of the unlit program: the vertex (or colour mapped) colour, with no
+    // lighting. See VisualUnlit.frag.glsl.
+    inline constexpr const char* defaultUnlitFragShader = "in vec4 vcolor;\n"
+    "uniform int colour_by_datum;\n"
+    "uniform sampler2D colour_lut;\n"
+    "uniform highp sampler2D datum_texture;\n"
+    "uniform vec2 datum_scale;\n"
+    "uniform vec2 datum_texture_offset;\n"
+    "uniform vec4 cell_grid;\n"
+    "uniform vec3 cell_grid_colour;\n"
+    "uniform vec3 cell_border_colour;\n"
+    "uniform float polar_inner;\n"
+    "out vec4 finalcolor;\n"
+    "void main()\n"
+    "{\n"
+    "    vec4 col = vcolor;\n"
+    "    if (colour_by_datum == 4) {\n"
+    "        if (col.b > 1.5) {\n"
+    "            highp float r = length(col.rg);\n"
+    "            if (r > 1.0 || r < polar_inner) { discard; }\n"
+    "            vec2 ts = vec2(textureSize(colour_lut, 0));\n"
+    "            highp float a = fract(atan(col.g, col.r) / 6.28318531) + 0.5 / ts.x;\n"
+    "            highp float rr = clamp((r - polar_inner) / max(1.0 - polar_inner, 1e-6), 0.0, 1.0);\n"
+    "            col.rgb = texture(colour_lut, vec2(a, (rr * (ts.y - 1.0) + 0.5) / ts.y)).rgb;\n"
+    "        }\n"
+    "    } else if (colour_by_datum != 0) {\n"
+    "        highp vec2 tc = col.rg;\n"
+    "        highp float d = colour_by_datum == 2 ? datum_scale.x * texture(datum_texture, col.rg + datum_texture_offset).r + datum_scale.y : col.r;\n"
+    "        float n = float(textureSize(colour_lut, 0).x);\n"
+    "        col.rgb = texture(colour_lut, vec2((clamp(d, 0.0, 1.0) * (n - 1.0) + 0.5) / n, 0.5)).rgb;\n"
+    "        if (colour_by_datum == 2 && cell_grid.z > 0.5) {\n"
+    "            highp vec2 c = tc * vec2(textureSize(datum_texture, 0));\n"
+    "            highp vec2 fw = max(fwidth(c), vec2(1e-6));\n"
+    "            highp vec2 hw = 0.5 * (cell_grid.z > 1.5 ? cell_grid.xy * fw : cell_grid.xy);\n"
+    "            highp vec2 e = abs(c - floor(c + 0.5));\n"
+    "            vec2 on = 1.0 - smoothstep(hw - 0.5 * fw, hw + 0.5 * fw, e);\n"
+    "            col.rgb = mix(col.rgb, cell_grid_colour, max(on.x, on.y));\n"
+    "        }\n"
+    "        if (colour_by_datum == 2 && cell_grid.w > 0.5\n"
+    "            && (any(lessThan(tc, vec2(0.0))) || any(greaterThan(tc, vec2(1.0))))) {\n"
+    "            col.rgb = cell_border_colour;\n"
+    "        }\n"
+    "    }\n"
+    "    finalcolor = col;\n"
+    "}\n";
+
+    inline std::string getDefaultUnlitFragShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += defaultUnlitFragShader;
+        return shdr;
+    }
+
     // Default text vertex shader. See VisText.vert.glsl
-    const char* defaultTextVtxShader = "uniform mat4 m_matrix;\n"
+    inline constexpr const char* defaultTextVtxShader = "uniform mat4 m_matrix;\n"
     "uniform mat4 v_matrix;\n"
-    "uniform mat4 p_matrix;\n"
+    "uniform int text_billboard;\n"
     "layout(location = 0) in vec4 position;\n"
     "layout(location = 1) in vec4 vnormal;\n"
     "layout(location = 2) in vec4 vcolor;\n"
@@ -172,29 +369,41 @@ namespace mplot {
     "out vec2 TexCoords;\n"
     "void main()\n"
     "{\n"
-    "    gl_Position = p_matrix * v_matrix * m_matrix * position;\n"
+    "    if (text_billboard == 1) {\n"
+    "        vec4 anchor = v_matrix * m_matrix * vec4(0.0, 0.0, 0.0, 1.0);\n"
+    "        gl_Position = p_matrix * vec4(anchor.xy + position.xy * anchor.w, anchor.z, anchor.w);\n"
+    "    } else {\n"
+    "        gl_Position = p_matrix * v_matrix * m_matrix * position;\n"
+    "    }\n"
     "    TexCoords = texture.xy;\n"
     "}";
 
-    std::string getDefaultTextVtxShader (const int glver)
+    inline std::string getDefaultTextVtxShader (const int glver)
     {
         std::string shdr;
         shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += sceneStateBlock;
         shdr += defaultTextVtxShader;
         return shdr;
     }
 
     // Default text fragment shader. See VisText.frag.glsl
-    const char* defaultTextFragShader = "in vec2 TexCoords;\n"
+    inline constexpr const char* defaultTextFragShader = "in vec2 TexCoords;\n"
     "out vec4 color;\n"
     "uniform sampler2D text;\n"
     "uniform vec3 textColor;\n"
+    "uniform int text_sdf;\n"
     "void main()\n"
     "{\n"
-    "    color = vec4(textColor, texture(text, TexCoords).r);\n"
+    "    float a = texture(text, TexCoords).r;\n"
+    "    if (text_sdf == 1) {\n"
+    "        float w = max(0.7 * fwidth(a), 0.0001);\n"
+    "        a = smoothstep(0.5 - w, 0.5 + w, a);\n"
+    "    }\n"
+    "    color = vec4(textColor, a);\n"
     "}\n";
 
-    std::string getDefaultTextFragShader (const int glver)
+    inline std::string getDefaultTextFragShader (const int glver)
     {
         std::string shdr;
         shdr += mplot::gl::version::shaderpreamble (glver);
@@ -203,18 +412,22 @@ namespace mplot {
     }
 
     // Cylindrical projection
-    const char* defaultCylShader = "uniform mat4 mvp_matrix;\n"
+    inline constexpr const char* defaultCylShader = "uniform mat4 mvp_matrix;\n"
     "uniform mat4 vp_matrix;\n"
     "uniform mat4 m_matrix;\n"
     "uniform mat4 v_matrix;\n"
-    "uniform mat4 p_matrix;\n"
     "uniform float alpha;\n"
-    "uniform float cyl_radius = 0.005;\n"
-    "uniform float cyl_height = 0.01;\n"
-    "uniform vec4 cyl_cam_pos = vec4(0);\n"
+    "uniform int colour_by_datum;\n"
+    "uniform highp sampler2D datum_texture;\n"
+    "uniform int element_offset;\n"
+    "uniform highp vec2 element_scale;\n"
     "layout(location = 0) in vec4 position;\n"
     "layout(location = 1) in vec4 normalin;\n"
     "layout(location = 2) in vec3 color;\n"
+    "layout(location = 4) in vec4 instance_posn;\n"
+    "layout(location = 5) in vec4 instance_colour;\n"
+    "layout(location = 6) in vec4 instance_dirn;\n"
+    "layout(location = 7) in float datum;\n"
     "out VERTEX\n"
     "{\n"
     "    vec4 normal;\n"
@@ -226,7 +439,25 @@ namespace mplot {
     "    const float pi = 3.1415927;\n"
     "    const float two_pi = 6.283185307;\n"
     "    const float heading_offset = 1.570796327;\n"
-    "    vec4 pv = (v_matrix * m_matrix * position);\n"
+    "    vec3 ipos = curve_position(position.xyz) * instance_posn.w;\n"
+    "    vec3 inorm = curve_normal(position.xyz, normalin.xyz);\n"
+    "    if (dot(instance_dirn.xyz, instance_dirn.xyz) > 0.0) {\n"
+    "        vec3 axis = normalize(instance_dirn.xyz);\n"
+    "        vec3 a = abs(axis.z) < 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0);\n"
+    "        vec3 u = normalize(cross(a, axis));\n"
+    "        mat3 rotn = mat3(u, cross(axis, u), axis);\n"
+    "        ipos = rotn * vec3(ipos.xy * instance_dirn.w, ipos.z);\n"
+    "        inorm = rotn * vec3(inorm.xy / instance_dirn.w, inorm.z);\n"
+    "    }\n"
+    "    vec4 iposition = vec4(ipos + instance_posn.xyz, position.w);\n"
+    "    highp float edatum = datum;\n"
+    "    if (colour_by_datum == 3) {\n"
+    "        int w = textureSize(datum_texture, 0).x;\n"
+    "        int e = int(datum + 0.5) + element_offset;\n"
+    "        edatum = element_scale.x * texelFetch(datum_texture, ivec2(e % w, e / w), 0).r + element_scale.y;\n"
+    "    }\n"
+    "    vec3 icolor = (colour_by_datum == 1 || colour_by_datum == 3) ? vec3(edatum, 0.0, 0.0) : mix(instance_colour.rgb, color, instance_colour.a);\n"
+    "    vec4 pv = (v_matrix * m_matrix * iposition);\n"
     "    vec4 ray = pv - (v_matrix * cyl_cam_pos);\n"
     "    vec3 rho_phi_z;\n"
     "    rho_phi_z[0] = sqrt (ray.x * ray.x + ray.y * ray.y);\n"
@@ -241,23 +472,1160 @@ namespace mplot {
     "        y_s = (cyl_radius * tan (theta)) / cyl_height;\n"
     "        gl_PointSize = 1;\n"
     "        gl_Position = vec4(x_s, y_s, -1.0, 1.0);\n"
-    "        vertex.color = vec4(color, alpha);\n"
-    "        vertex.fragpos = vec3(m_matrix * position);\n"
-    "        vertex.normal = normalin;\n"
+    "        vertex.color = vec4(icolor, alpha);\n"
+    "        vertex.fragpos = vec3(m_matrix * iposition);\n"
+    "        vertex.normal = vec4(inorm, normalin.w);\n"
     "    } else {\n"
     "        gl_Position = vec4(0.0, 0.0, -100.0, 1.0);\n"
-    "        vertex.color = vec4(color, 0.0);\n"
-    "        vertex.fragpos = vec3(m_matrix * position);\n"
-    "        vertex.normal = normalin;\n"
+    "        vertex.color = vec4(icolor, 0.0);\n"
+    "        vertex.fragpos = vec3(m_matrix * iposition);\n"
+    "        vertex.normal = vec4(inorm, normalin.w);\n"
     "    }\n"
     "}\n";
 
-    std::string getDefaultCylVtxShader (const int glver)
+    inline std::string getDefaultCylVtxShader (const int glver)
     {
         std::string shdr;
         shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += sceneStateBlock;
+        shdr += curvatureBlock;
         shdr += defaultCylShader;
         return shdr;
     }
 
+    // The vertex shader for batches of VisualModels drawn with one glMultiDrawElementsIndirect
+    // call (OpenGL 4.3+). Each model's matrices and alpha are read from the BatchState storage
+    // block, indexed by the per-instance batch_id (set from each draw's base instance). See
+    // VisualBatch.vert.glsl. It is used with the default fragment shader.
+    inline constexpr const char* defaultBatchVtxShader = "uniform int colour_by_datum;\n"
+    "struct batch_model\n"
+    "{\n"
+    "    mat4 m_matrix;\n"
+    "    mat4 v_matrix;\n"
+    "    vec4 params;\n"
+    "};\n"
+    "layout(std430, binding = 1) readonly buffer BatchState\n"
+    "{\n"
+    "    batch_model models[];\n"
+    "};\n"
+    "layout(location = 0) in vec4 position;\n"
+    "layout(location = 1) in vec4 normalin;\n"
+    "layout(location = 2) in vec3 color;\n"
+    "layout(location = 8) in float batch_id;\n"
+    "out VERTEX\n"
+    "{\n"
+    "    vec4 normal;\n"
+    "    vec4 color;\n"
+    "    vec3 fragpos;\n"
+    "} vertex;\n"
+    "void main()\n"
+    "{\n"
+    "    batch_model bm = models[int(batch_id + 0.5)];\n"
+    "    gl_Position = (p_matrix * bm.v_matrix * bm.m_matrix * position);\n"
+    "    vertex.color = vec4(color, bm.params.x);\n"
+    "    vertex.fragpos = vec3(bm.m_matrix * position);\n"
+    "    vertex.normal = normalin;\n"
+    "}\n";
+
+    inline std::string getDefaultBatchVtxShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += sceneStateBlock;
+        shdr += defaultBatchVtxShader;
+        return shdr;
+    }
+
+    // The vertex shader for VisualModel polylines. Each segment of a polyline is one instance of
+    // six vertices (two triangles), expanded from its end points (p_a and p_b), mitred to the
+    // points beyond them (p_prev and p_next). The w of each point is its arc length along the
+    // polyline. See VisualPolyline.vert.glsl.
+    inline constexpr const char* defaultPolylineVtxShader = "uniform mat4 m_matrix;\n"
+    "uniform mat4 v_matrix;\n"
+    "uniform float alpha;\n"
+    "uniform vec3 line_colour;\n"
+    "uniform vec3 line_normal;\n"
+    "uniform float line_width;\n"
+    "uniform int width_in_pixels;\n"
+    "uniform vec2 viewport;\n"
+    "uniform vec4 data_pre;\n"
+    "uniform vec4 data_post;\n"
+    "uniform ivec2 data_log;\n"
+    "layout(location = 0) in vec4 p_prev;\n"
+    "layout(location = 1) in vec4 p_a;\n"
+    "layout(location = 2) in vec4 p_b;\n"
+    "layout(location = 3) in vec4 p_next;\n"
+    "out LINE\n"
+    "{\n"
+    "    vec4 color;\n"
+    "    vec3 fragpos;\n"
+    "    vec3 normal;\n"
+    "    highp float arclen;\n"
+    "    vec2 modelpos;\n"
+    "} line;\n"
+    "// The point d in model coordinates: an affine map, an optional natural log and an affine map\n"
+    "// of each of x and y (the identity unless set with VisualModel::set_polyline_transform)\n"
+    "vec4 to_model (vec4 d)\n"
+    "{\n"
+    "    vec2 u = vec2(data_pre.x * d.x + data_pre.y, data_pre.z * d.y + data_pre.w);\n"
+    "    if (data_log.x != 0) { u.x = log (u.x); }\n"
+    "    if (data_log.y != 0) { u.y = log (u.y); }\n"
+    "    return vec4(data_post.x * u.x + data_post.y, data_post.z * u.y + data_post.w, d.z, d.w);\n"
+    "}\n"
+    "vec3 unit (vec3 v)\n"
+    "{\n"
+    "    float l = length (v);\n"
+    "    return l > 0.0 ? v / l : vec3(0.0);\n"
+    "}\n"
+    "// The offset of a corner at a join, for the segment normal n and the normal n_o of the\n"
+    "// neighbouring segment. A butt end if there is no neighbour or the mitre would be too long.\n"
+    "vec3 join (vec3 n, vec3 n_o, bool has_o)\n"
+    "{\n"
+    "    if (!has_o) { return n; }\n"
+    "    vec3 m = unit (n + n_o);\n"
+    "    float c = dot (m, n);\n"
+    "    return c < 0.25 ? n : m / c;\n"
+    "}\n"
+    "// The normal to direction d in the plane of the line\n"
+    "vec3 model_normal (vec3 d) { return unit (cross (d, line_normal)); }\n"
+    "// The normal to screen direction d\n"
+    "vec3 screen_normal (vec2 d) { return unit (vec3(-d.y, d.x, 0.0)); }\n"
+    "void main()\n"
+    "{\n"
+    "    // Corners 0 and 1 are at p_a, 2 and 3 at p_b; the triangles are 0,1,2 and 0,2,3\n"
+    "    int corner = gl_VertexID == 3 ? 0 : (gl_VertexID == 4 ? 2 : (gl_VertexID == 5 ? 3 : gl_VertexID));\n"
+    "    bool at_b = corner >= 2;\n"
+    "    float side = (corner == 1 || corner == 2) ? 0.5 : -0.5;\n"
+    "    bool has_o = at_b ? p_next.xyz != p_b.xyz : p_prev.xyz != p_a.xyz;\n"
+    "    vec4 pa = to_model (p_a);\n"
+    "    vec4 pb = to_model (p_b);\n"
+    "    vec4 p = at_b ? pb : pa;\n"
+    "    vec4 o = to_model (at_b ? p_next : p_prev);\n"
+    "    mat4 pvm = p_matrix * v_matrix * m_matrix;\n"
+    "    if (width_in_pixels == 0) {\n"
+    "        vec3 n = model_normal (pb.xyz - pa.xyz);\n"
+    "        vec3 n_o = model_normal (at_b ? o.xyz - p.xyz : p.xyz - o.xyz);\n"
+    "        gl_Position = pvm * vec4(p.xyz + join (n, n_o, has_o) * side * line_width, 1.0);\n"
+    "    } else {\n"
+    "        vec2 half_vp = 0.5 * viewport;\n"
+    "        vec4 cp = pvm * vec4(p.xyz, 1.0);\n"
+    "        vec4 ca = pvm * vec4(pa.xyz, 1.0);\n"
+    "        vec4 cb = pvm * vec4(pb.xyz, 1.0);\n"
+    "        vec4 co = pvm * vec4(o.xyz, 1.0);\n"
+    "        vec2 sp = cp.xy / cp.w * half_vp;\n"
+    "        vec2 so = co.xy / co.w * half_vp;\n"
+    "        vec3 n = screen_normal (cb.xy / cb.w * half_vp - ca.xy / ca.w * half_vp);\n"
+    "        vec3 n_o = screen_normal (at_b ? so - sp : sp - so);\n"
+    "        vec2 off = join (n, n_o, has_o).xy * side * line_width;\n"
+    "        gl_Position = vec4(cp.xy + off / half_vp * cp.w, cp.zw);\n"
+    "    }\n"
+    "    line.color = vec4(line_colour, alpha);\n"
+    "    line.fragpos = vec3(m_matrix * vec4(p.xyz, 1.0));\n"
+    "    line.normal = line_normal;\n"
+    "    line.arclen = p.w;\n"
+    "    line.modelpos = p.xy;\n"
+    "}\n";
+
+    inline std::string getDefaultPolylineVtxShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += sceneStateBlock;
+        shdr += defaultPolylineVtxShader;
+        return shdr;
+    }
+
+    // The fragment shader for VisualModel polylines, lit as Visual.frag.glsl. Fragments in the
+    // gaps between dashes are discarded. See VisualPolyline.frag.glsl.
+    inline constexpr const char* defaultPolylineFragShader = "in LINE\n"
+    "{\n"
+    "    vec4 color;\n"
+    "    vec3 fragpos;\n"
+    "    vec3 normal;\n"
+    "    highp float arclen;\n"
+    "    vec2 modelpos;\n"
+    "} line;\n"
+    "// The lengths of the dashes and of the gaps (no dashes if dash.y is 0)\n"
+    "uniform highp vec2 dash;\n"
+    "// Fragments outside x in [clip_box.x, clip_box.y], y in [clip_box.z, clip_box.w] (in model\n"
+    "// coordinates) are discarded. No clipping if clip_box.x > clip_box.y.\n"
+    "uniform vec4 clip_box;\n"
+    "out vec4 finalcolor;\n"
+    "void main()\n"
+    "{\n"
+    "    if (dash.y > 0.0 && mod (line.arclen, dash.x + dash.y) > dash.x) { discard; }\n"
+    "    if (clip_box.x <= clip_box.y\n"
+    "        && (line.modelpos.x < clip_box.x || line.modelpos.x > clip_box.y\n"
+    "            || line.modelpos.y < clip_box.z || line.modelpos.y > clip_box.w)) { discard; }\n"
+    "    vec3 norm = normalize(line.normal);\n"
+    "    vec3 light_dirn = normalize(diffuse_position - line.fragpos);\n"
+    "    float effective_diffuse = max(dot(norm, light_dirn), 0.0);\n"
+    "    vec3 diffuse = diffuse_intensity * effective_diffuse * light_colour;\n"
+    "    vec3 ambient = ambient_intensity * light_colour;\n"
+    "    vec3 result = (ambient+diffuse) * line.color.rgb;\n"
+    "    finalcolor = vec4(result, line.color.a);\n"
+    "}\n";
+
+    inline std::string getDefaultPolylineFragShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += sceneStateBlock;
+        shdr += defaultPolylineFragShader;
+        return shdr;
+    }
+
+    // The vertex shader for VisualModel sprites (sphere impostors), drawn as GL_POINTS. Each
+    // point is sized to cover its sphere on the screen. See VisualSprite.vert.glsl.
+    inline constexpr const char* defaultSpriteVtxShader = "uniform mat4 m_matrix;\n"
+    "uniform mat4 v_matrix;\n"
+    "uniform float alpha;\n"
+    "uniform float sprite_radius;\n"
+    "uniform vec2 viewport;\n"
+    "layout(location = 0) in vec3 position;\n"
+    "layout(location = 1) in vec4 colour;\n"
+    "out SPRITE\n"
+    "{\n"
+    "    vec4 color;\n"
+    "    vec3 centre;\n"
+    "    float radius;\n"
+    "    vec3 light;\n"
+    "} sprite;\n"
+    "// The sprite covers this much more than the sphere's radius, as a sphere away from the\n"
+    "// centre of a perspective view projects to an ellipse a little larger than its radius\n"
+    "const float margin = 1.25;\n"
+    "void main()\n"
+    "{\n"
+    "    mat4 vm = v_matrix * m_matrix;\n"
+    "    vec4 eye = vm * vec4(position, 1.0);\n"
+    "    sprite.centre = eye.xyz;\n"
+    "    sprite.radius = sprite_radius * colour.a * length (vm[0].xyz);\n"
+    "    sprite.color = vec4(colour.rgb, alpha);\n"
+    "    sprite.light = (v_matrix * vec4(diffuse_position, 1.0)).xyz;\n"
+    "    gl_Position = p_matrix * eye;\n"
+    "    gl_PointSize = sprite.radius > 0.0 ? 2.0 * margin * sprite.radius * abs (p_matrix[1][1]) / abs (gl_Position.w) * 0.5 * viewport.y : 0.0;\n"
+    "}\n";
+
+    inline std::string getDefaultSpriteVtxShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += sceneStateBlock;
+        shdr += defaultSpriteVtxShader;
+        return shdr;
+    }
+
+    // The fragment shader for VisualModel sprites. The view ray through each fragment is
+    // intersected with the sprite's sphere, to find the fragment's depth and normal; it is then
+    // lit as Visual.frag.glsl. See VisualSprite.frag.glsl.
+    inline constexpr const char* defaultSpriteFragShader = "precision highp float;\n"
+    "in SPRITE\n"
+    "{\n"
+    "    vec4 color;\n"
+    "    vec3 centre;\n"
+    "    float radius;\n"
+    "    vec3 light;\n"
+    "} sprite;\n"
+    "const float margin = 1.25;\n"
+    "out vec4 finalcolor;\n"
+    "void main()\n"
+    "{\n"
+    "    // The point on the sprite, in the plane through the sphere's centre, of this fragment\n"
+    "    vec2 q = (gl_PointCoord * 2.0 - 1.0) * vec2(1.0, -1.0) * margin;\n"
+    "    vec3 on_plane = sprite.centre + vec3(q * sprite.radius, 0.0);\n"
+    "    // The view ray through that point (along -z in an orthographic projection)\n"
+    "    bool ortho = p_matrix[3][3] > 0.5;\n"
+    "    vec3 ro = ortho ? vec3(on_plane.xy, sprite.centre.z + 2.0 * sprite.radius) : vec3(0.0);\n"
+    "    vec3 rd = ortho ? vec3(0.0, 0.0, -1.0) : normalize (on_plane);\n"
+    "    vec3 oc = ro - sprite.centre;\n"
+    "    float b = dot (oc, rd);\n"
+    "    float h = b * b - (dot (oc, oc) - sprite.radius * sprite.radius);\n"
+    "    if (h < 0.0) { discard; }\n"
+    "    vec3 hit = ro + (-b - sqrt (h)) * rd;\n"
+    "    vec4 clip = p_matrix * vec4(hit, 1.0);\n"
+    "    gl_FragDepth = 0.5 * (clip.z / clip.w) + 0.5;\n"
+    "    vec3 norm = (hit - sprite.centre) / sprite.radius;\n"
+    "    vec3 light_dirn = normalize(sprite.light - hit);\n"
+    "    float effective_diffuse = max(dot(norm, light_dirn), 0.0);\n"
+    "    vec3 diffuse = diffuse_intensity * effective_diffuse * light_colour;\n"
+    "    vec3 ambient = ambient_intensity * light_colour;\n"
+    "    vec3 result = (ambient+diffuse) * sprite.color.rgb;\n"
+    "    finalcolor = vec4(result, sprite.color.a);\n"
+    "}\n";
+
+    inline std::string getDefaultSpriteFragShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += sceneStateBlock;
+        shdr += defaultSpriteFragShader;
+        return shdr;
+    }
+
+    // The vertex shader for VisualModel bars. Each bar is one instance of six vertices (two
+    // triangles) between the base line and the bar's top, widened by half the outline width at
+    // the sides and the top so that the outline is centred on the bar's edges. See
+    // VisualBars.vert.glsl.
+    inline constexpr const char* defaultBarVtxShader = "uniform mat4 m_matrix;\n"
+    "uniform mat4 v_matrix;\n"
+    "uniform float bar_width;\n"
+    "uniform float bar_base;\n"
+    "uniform float bar_z;\n"
+    "uniform float bar_line_width;\n"
+    "layout(location = 0) in vec2 bar_xtop;\n"
+    "out BAR\n"
+    "{\n"
+    "    vec3 fragpos;\n"
+    "    vec2 local;\n"
+    "    vec2 size;\n"
+    "} bar;\n"
+    "void main()\n"
+    "{\n"
+    "    // Corners 0 and 1 are on the base, 2 and 3 at the top; the triangles are 0,1,2 and 0,2,3\n"
+    "    int corner = gl_VertexID == 3 ? 0 : (gl_VertexID == 4 ? 2 : (gl_VertexID == 5 ? 3 : gl_VertexID));\n"
+    "    float side = (corner == 1 || corner == 2) ? 1.0 : -1.0;\n"
+    "    float h = bar_xtop.y - bar_base;\n"
+    "    float up = h < 0.0 ? -1.0 : 1.0;\n"
+    "    float hl = 0.5 * bar_line_width;\n"
+    "    vec2 local = vec2(side * (0.5 * bar_width + hl), corner >= 2 ? abs(h) + hl : 0.0);\n"
+    "    vec4 p = vec4(bar_xtop.x + local.x, bar_base + up * local.y, bar_z, 1.0);\n"
+    "    gl_Position = p_matrix * v_matrix * m_matrix * p;\n"
+    "    bar.fragpos = vec3(m_matrix * p);\n"
+    "    bar.local = local;\n"
+    "    bar.size = vec2(0.5 * bar_width, abs(h));\n"
+    "}\n";
+
+    inline std::string getDefaultBarVtxShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += sceneStateBlock;
+        shdr += defaultBarVtxShader;
+        return shdr;
+    }
+
+    // The fragment shader for VisualModel bars, lit as Visual.frag.glsl. Fragments within half
+    // the outline width of a bar's sides or top take the outline colour. See VisualBars.frag.glsl.
+    inline constexpr const char* defaultBarFragShader = "in BAR\n"
+    "{\n"
+    "    vec3 fragpos;\n"
+    "    vec2 local;\n"
+    "    vec2 size;\n"
+    "} bar;\n"
+    "uniform float alpha;\n"
+    "uniform vec3 bar_colour;\n"
+    "uniform vec3 bar_line_colour;\n"
+    "uniform float bar_line_width;\n"
+    "out vec4 finalcolor;\n"
+    "void main()\n"
+    "{\n"
+    "    float hl = 0.5 * bar_line_width;\n"
+    "    bool on_line = hl > 0.0 && (abs (abs (bar.local.x) - bar.size.x) <= hl || abs (bar.local.y - bar.size.y) <= hl);\n"
+    "    vec3 clr = on_line ? bar_line_colour : bar_colour;\n"
+    "    vec3 norm = vec3(0.0, 0.0, 1.0);\n"
+    "    vec3 light_dirn = normalize(diffuse_position - bar.fragpos);\n"
+    "    float effective_diffuse = max(dot(norm, light_dirn), 0.0);\n"
+    "    vec3 diffuse = diffuse_intensity * effective_diffuse * light_colour;\n"
+    "    vec3 ambient = ambient_intensity * light_colour;\n"
+    "    vec3 result = (ambient+diffuse) * clr;\n"
+    "    finalcolor = vec4(result, alpha);\n"
+    "}\n";
+
+    inline std::string getDefaultBarFragShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += sceneStateBlock;
+        shdr += defaultBarFragShader;
+        return shdr;
+    }
+
+    // The vertex shader for the volume of a VisualModel. The box that the volume fills is drawn
+    // from gl_VertexID alone, with no vertex attributes. See VisualVolume.vert.glsl.
+    inline constexpr const char* defaultVolumeVtxShader = "uniform mat4 m_matrix;\n"
+    "uniform mat4 v_matrix;\n"
+    "uniform vec3 box_min;\n"
+    "uniform vec3 box_max;\n"
+    "out VOLUME\n"
+    "{\n"
+    "    vec3 entry;\n"
+    "    vec3 dirn;\n"
+    "} vol;\n"
+    "// The corners (x in bit 0, y in bit 1, z in bit 2) of the twelve triangles of the box, each\n"
+    "// wound anticlockwise as seen from outside the box\n"
+    "const int corners[36] = int[36](0, 3, 1,  0, 2, 3,  4, 5, 7,  4, 7, 6,  0, 4, 6,  0, 6, 2,\n"
+    "                                1, 3, 7,  1, 7, 5,  0, 1, 5,  0, 5, 4,  2, 6, 7,  2, 7, 3);\n"
+    "void main()\n"
+    "{\n"
+    "    int c = corners[gl_VertexID];\n"
+    "    vec3 f = vec3(float(c & 1), float((c >> 1) & 1), float((c >> 2) & 1));\n"
+    "    vol.entry = mix (box_min, box_max, f);\n"
+    "    mat4 vm = v_matrix * m_matrix;\n"
+    "    mat4 ivm = inverse (vm);\n"
+    "    // The ray runs from the eye, or along -z in an orthographic projection\n"
+    "    bool ortho = p_matrix[3][3] > 0.5;\n"
+    "    vol.dirn = ortho ? (ivm * vec4(0.0, 0.0, -1.0, 0.0)).xyz : vol.entry - (ivm * vec4(0.0, 0.0, 0.0, 1.0)).xyz;\n"
+    "    gl_Position = p_matrix * vm * vec4(vol.entry, 1.0);\n"
+    "}\n";
+
+    inline std::string getDefaultVolumeVtxShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += sceneStateBlock;
+        shdr += defaultVolumeVtxShader;
+        return shdr;
+    }
+
+    // The fragment shader for the volume of a VisualModel, which marches the view ray through
+    // the volume texture, compositing its samples front to back. See VisualVolume.frag.glsl.
+    inline constexpr const char* defaultVolumeFragShader = "precision highp float;\n"
+    "uniform mat4 m_matrix;\n"
+    "uniform mat4 v_matrix;\n"
+    "uniform vec3 box_min;\n"
+    "uniform vec3 box_max;\n"
+    "uniform highp sampler3D volume;\n"
+    "uniform highp sampler3D volume_bricks;\n"
+    "uniform sampler2D colour_lut;\n"
+    "uniform vec3 volume_dims;\n"
+    "uniform vec3 brick_dims;\n"
+    "uniform float brick_size;\n"
+    "uniform float sample_step;\n"
+    "uniform float density;\n"
+    "uniform float threshold;\n"
+    "uniform float alpha;\n"
+    "in VOLUME\n"
+    "{\n"
+    "    vec3 entry;\n"
+    "    vec3 dirn;\n"
+    "} vol;\n"
+    "out vec4 finalcolor;\n"
+    "// No ray takes more samples than this (a 512 voxel cube is 887 voxels corner to corner)\n"
+    "const int max_samples = 4096;\n"
+    "void main()\n"
+    "{\n"
+    "    // The ray in voxel coordinates, with t measured in voxels from the entry point\n"
+    "    vec3 ext = box_max - box_min;\n"
+    "    vec3 p0 = (vol.entry - box_min) / ext * volume_dims;\n"
+    "    vec3 dv = normalize (vol.dirn / ext * volume_dims);\n"
+    "    vec3 safe_dv = mix (dv, vec3(1e-6), lessThan (abs (dv), vec3(1e-6)));\n"
+    "    vec3 inv = 1.0 / safe_dv;\n"
+    "    // Where the ray leaves the volume\n"
+    "    vec3 ta = -p0 * inv;\n"
+    "    vec3 tb = (volume_dims - p0) * inv;\n"
+    "    vec3 tfar = max (ta, tb);\n"
+    "    float t_exit = min (min (tfar.x, tfar.y), tfar.z);\n"
+    "    float n_lut = float(textureSize (colour_lut, 0).x);\n"
+    "    vec3 ahead = step (vec3(0.0), dv);\n"
+    "    vec4 acc = vec4(0.0);\n"
+    "    float t_hit = -1.0;\n"
+    "    float t = 0.5 * sample_step;\n"
+    "    for (int i = 0; i < max_samples && t < t_exit; ++i) {\n"
+    "        vec3 p = p0 + t * dv;\n"
+    "        // Empty space skipping: jump to the first sample beyond a transparent brick\n"
+    "        vec3 b = floor (p / brick_size);\n"
+    "        if (textureLod (volume_bricks, (b + 0.5) / brick_dims, 0.0).r <= threshold) {\n"
+    "            vec3 tb_far = ((b + ahead) * brick_size - p0) * inv;\n"
+    "            float t_far = min (min (tb_far.x, tb_far.y), tb_far.z);\n"
+    "            t = max (t + sample_step, (floor (t_far / sample_step) + 0.5) * sample_step);\n"
+    "            continue;\n"
+    "        }\n"
+    "        float d = textureLod (volume, p / volume_dims, 0.0).r;\n"
+    "        if (d > threshold) { // false for NaN\n"
+    "            vec3 c = textureLod (colour_lut, vec2((clamp (d, 0.0, 1.0) * (n_lut - 1.0) + 0.5) / n_lut, 0.5), 0.0).rgb;\n"
+    "            // The opacity of a voxel, corrected for the length of ray that the sample stands for\n"
+    "            float a = 1.0 - pow (1.0 - clamp (density * d, 0.0, 0.999), sample_step);\n"
+    "            acc.rgb += (1.0 - acc.a) * a * c;\n"
+    "            acc.a += (1.0 - acc.a) * a;\n"
+    "            if (t_hit < 0.0) { t_hit = t; }\n"
+    "            // Early ray termination\n"
+    "            if (acc.a > 0.99) { break; }\n"
+    "        }\n"
+    "        t += sample_step;\n"
+    "    }\n"
+    "    if (acc.a < 1.0 / 255.0) { discard; }\n"
+    "    // The depth is that of the first sample that was seen\n"
+    "    vec3 hit = box_min + (p0 + t_hit * dv) / volume_dims * ext;\n"
+    "    vec4 clip = p_matrix * v_matrix * m_matrix * vec4(hit, 1.0);\n"
+    "    gl_FragDepth = 0.5 * (clip.z / clip.w) + 0.5;\n"
+    "    finalcolor = vec4(acc.rgb / acc.a, acc.a * alpha);\n"
+    "}\n";
+
+    inline std::string getDefaultVolumeFragShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += sceneStateBlock;
+        shdr += defaultVolumeFragShader;
+        return shdr;
+    }
+
+    // The vertex shader for the raster of a VisualModel. Each event is one instance of six
+    // vertices (a tick) or one point, placed by the window of time and coloured by the
+    // population of its neuron. Events outside the window are clipped. See VisualRaster.vert.glsl.
+    inline constexpr const char* defaultRasterVtxShader = "uniform mat4 m_matrix;\n"
+    "uniform mat4 v_matrix;\n"
+    "uniform vec2 raster_window;\n"
+    "uniform vec2 raster_extent;\n"
+    "uniform vec2 raster_tick;\n"
+    "uniform float raster_z;\n"
+    "uniform int raster_points;\n"
+    "uniform float raster_point_size;\n"
+    "uniform vec3 raster_colour;\n"
+    "uniform int n_pops;\n"
+    "uniform uint pop_first[16];\n"
+    "uniform vec3 pop_colour[16];\n"
+    "layout(location = 0) in float ev_t;\n"
+    "layout(location = 1) in uint ev_neuron;\n"
+    "out vec3 ev_colour;\n"
+    "void main()\n"
+    "{\n"
+    "    float u = (ev_t - raster_window.x) / (raster_window.y - raster_window.x);\n"
+    "    vec3 c = raster_colour;\n"
+    "    for (int p = 0; p < n_pops; ++p) { if (ev_neuron >= pop_first[p]) { c = pop_colour[p]; } }\n"
+    "    ev_colour = c;\n"
+    "    vec2 xy = vec2(u * raster_extent.x, (float(ev_neuron) + 0.5) * raster_extent.y);\n"
+    "    if (raster_points == 0) {\n"
+    "        // Corners 0 and 1 are at the bottom, 2 and 3 at the top; the triangles are 0,1,2 and 0,2,3\n"
+    "        int corner = gl_VertexID == 3 ? 0 : (gl_VertexID == 4 ? 2 : (gl_VertexID == 5 ? 3 : gl_VertexID));\n"
+    "        vec2 f = vec2((corner == 1 || corner == 2) ? 0.5 : -0.5, corner >= 2 ? 0.5 : -0.5);\n"
+    "        xy += f * vec2(raster_tick.x, raster_tick.y * raster_extent.y);\n"
+    "    }\n"
+    "    gl_PointSize = raster_point_size;\n"
+    "    gl_Position = p_matrix * v_matrix * m_matrix * vec4(xy, raster_z, 1.0);\n"
+    "    if (!(u >= 0.0 && u <= 1.0)) { gl_Position = vec4(0.0, 0.0, 2.0, 1.0); }\n"
+    "}\n";
+
+    inline std::string getDefaultRasterVtxShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += sceneStateBlock;
+        shdr += defaultRasterVtxShader;
+        return shdr;
+    }
+
+    // The fragment shader for VisualModel rasters: unlit, in the colour of the event's
+    // population. See VisualRaster.frag.glsl.
+    inline constexpr const char* defaultRasterFragShader = "in vec3 ev_colour;\n"
+    "uniform float alpha;\n"
+    "out vec4 finalcolor;\n"
+    "void main()\n"
+    "{\n"
+    "    finalcolor = vec4(ev_colour, alpha);\n"
+    "}\n";
+
+    inline std::string getDefaultRasterFragShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += defaultRasterFragShader;
+        return shdr;
+    }
+
+    // The vertex shader for the point cloud cache of a VisualModel: flat coloured points of
+    // cloud_point_size pixels. See VisualCloud.vert.glsl.
+    inline constexpr const char* defaultCloudVtxShader = "uniform mat4 m_matrix;\n"
+    "uniform mat4 v_matrix;\n"
+    "uniform float cloud_point_size;\n"
+    "layout(location = 0) in vec3 position;\n"
+    "layout(location = 1) in vec4 colour;\n"
+    "out vec3 pt_colour;\n"
+    "void main()\n"
+    "{\n"
+    "    pt_colour = colour.rgb;\n"
+    "    gl_PointSize = cloud_point_size;\n"
+    "    gl_Position = p_matrix * v_matrix * m_matrix * vec4(position, 1.0);\n"
+    "}\n";
+
+    inline std::string getDefaultCloudVtxShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += sceneStateBlock;
+        shdr += defaultCloudVtxShader;
+        return shdr;
+    }
+
+    // The fragment shader for VisualModel point clouds: unlit, in the colour of the point. See
+    // VisualCloud.frag.glsl.
+    inline constexpr const char* defaultCloudFragShader = "in vec3 pt_colour;\n"
+    "uniform float alpha;\n"
+    "out vec4 finalcolor;\n"
+    "void main()\n"
+    "{\n"
+    "    finalcolor = vec4(pt_colour, alpha);\n"
+    "}\n";
+
+    inline std::string getDefaultCloudFragShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += defaultCloudFragShader;
+        return shdr;
+    }
+
+    // The vertex shader for the ID pass with which mplot::Visual::pick finds the model and
+    // element under a pixel. Vertices are placed as in the default vertex shader. See
+    // VisualPick.vert.glsl.
+    inline constexpr const char* defaultPickVtxShader = "uniform mat4 m_matrix;\n"
+    "uniform mat4 v_matrix;\n"
+    "uniform int pick_mode;\n"
+    "layout(location = 0) in vec4 position;\n"
+    "layout(location = 4) in vec4 instance_posn;\n"
+    "layout(location = 6) in vec4 instance_dirn;\n"
+    "layout(location = 7) in float datum;\n"
+    "flat out highp int pick_element;\n"
+    "void main()\n"
+    "{\n"
+    "    vec3 ipos = curve_position(position.xyz) * instance_posn.w;\n"
+    "    if (dot(instance_dirn.xyz, instance_dirn.xyz) > 0.0) {\n"
+    "        vec3 axis = normalize(instance_dirn.xyz);\n"
+    "        vec3 a = abs(axis.z) < 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0);\n"
+    "        vec3 u = normalize(cross(a, axis));\n"
+    "        mat3 rotn = mat3(u, cross(axis, u), axis);\n"
+    "        ipos = rotn * vec3(ipos.xy * instance_dirn.w, ipos.z);\n"
+    "    }\n"
+    "    gl_Position = p_matrix * v_matrix * m_matrix * vec4(ipos + instance_posn.xyz, position.w);\n"
+    "    pick_element = pick_mode == 1 ? int(datum + 0.5) : (pick_mode == 2 ? gl_InstanceID : -1);\n"
+    "}\n";
+
+    inline std::string getDefaultPickVtxShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += sceneStateBlock;
+        shdr += curvatureBlock;
+        shdr += defaultPickVtxShader;
+        return shdr;
+    }
+
+    // The fragment shader for the ID pass, which writes the model's id and the element's index.
+    // OpenGL ES before 3.2 has no gl_PrimitiveID, so there the triangle can't be given. See
+    // VisualPick.frag.glsl.
+    inline constexpr const char* defaultPickFragShader = "precision highp int;\n"
+    "uniform highp uint model_id;\n"
+    "uniform highp int element_base;\n"
+    "flat in highp int pick_element;\n"
+    "out highp uvec4 pick_id;\n"
+    "void main()\n"
+    "{\n"
+    "#ifdef MPLOT_PICK_PRIMITIVE_ID\n"
+    "    int e = pick_element >= 0 ? pick_element : element_base + gl_PrimitiveID;\n"
+    "#else\n"
+    "    int e = pick_element;\n"
+    "#endif\n"
+    "    pick_id = uvec4(model_id, uint(e), 0u, 0u);\n"
+    "}\n";
+
+    inline std::string getDefaultPickFragShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        if (!mplot::gl::version::gles (glver) || glver >= mplot::gl::version_3_2_es) {
+            shdr += "#define MPLOT_PICK_PRIMITIVE_ID\n";
+        }
+        shdr += defaultPickFragShader;
+        return shdr;
+    }
+
+    // The vertex shader for the sprites of a VisualModel in the ID pass. Each point is sized as
+    // in the sprite vertex shader and its element is the sprite's index. See
+    // VisualPickSprite.vert.glsl.
+    inline constexpr const char* defaultPickSpriteVtxShader = "uniform mat4 m_matrix;\n"
+    "uniform mat4 v_matrix;\n"
+    "uniform float sprite_radius;\n"
+    "uniform vec2 viewport;\n"
+    "layout(location = 0) in vec3 position;\n"
+    "layout(location = 1) in vec4 colour;\n"
+    "out vec3 centre;\n"
+    "out float radius;\n"
+    "flat out highp int pick_element;\n"
+    "const float margin = 1.25;\n"
+    "void main()\n"
+    "{\n"
+    "    mat4 vm = v_matrix * m_matrix;\n"
+    "    vec4 eye = vm * vec4(position, 1.0);\n"
+    "    centre = eye.xyz;\n"
+    "    radius = sprite_radius * colour.a * length (vm[0].xyz);\n"
+    "    pick_element = gl_VertexID;\n"
+    "    gl_Position = p_matrix * eye;\n"
+    "    gl_PointSize = radius > 0.0 ? 2.0 * margin * radius * abs (p_matrix[1][1]) / abs (gl_Position.w) * 0.5 * viewport.y : 0.0;\n"
+    "}\n";
+
+    inline std::string getDefaultPickSpriteVtxShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += sceneStateBlock;
+        shdr += defaultPickSpriteVtxShader;
+        return shdr;
+    }
+
+    // The fragment shader for sprites in the ID pass. Fragments off the sphere are discarded and
+    // the depth is that of the sphere, as in the sprite fragment shader. See
+    // VisualPickSprite.frag.glsl.
+    inline constexpr const char* defaultPickSpriteFragShader = "precision highp float;\n"
+    "precision highp int;\n"
+    "uniform highp uint model_id;\n"
+    "in vec3 centre;\n"
+    "in float radius;\n"
+    "flat in highp int pick_element;\n"
+    "const float margin = 1.25;\n"
+    "out highp uvec4 pick_id;\n"
+    "void main()\n"
+    "{\n"
+    "    vec2 q = (gl_PointCoord * 2.0 - 1.0) * vec2(1.0, -1.0) * margin;\n"
+    "    vec3 on_plane = centre + vec3(q * radius, 0.0);\n"
+    "    bool ortho = p_matrix[3][3] > 0.5;\n"
+    "    vec3 ro = ortho ? vec3(on_plane.xy, centre.z + 2.0 * radius) : vec3(0.0);\n"
+    "    vec3 rd = ortho ? vec3(0.0, 0.0, -1.0) : normalize (on_plane);\n"
+    "    vec3 oc = ro - centre;\n"
+    "    float b = dot (oc, rd);\n"
+    "    float h = b * b - (dot (oc, oc) - radius * radius);\n"
+    "    if (h < 0.0) { discard; }\n"
+    "    vec3 hit = ro + (-b - sqrt (h)) * rd;\n"
+    "    vec4 clip = p_matrix * vec4(hit, 1.0);\n"
+    "    gl_FragDepth = 0.5 * (clip.z / clip.w) + 0.5;\n"
+    "    pick_id = uvec4(model_id, uint(pick_element), 0u, 0u);\n"
+    "}\n";
+
+    inline std::string getDefaultPickSpriteFragShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += sceneStateBlock;
+        shdr += defaultPickSpriteFragShader;
+        return shdr;
+    }
+
+    // The fragment shader for translucent models when they are blended order independently
+    // (weighted, blended order independent transparency; McGuire and Bavoil, 2013). It is lit
+    // as the default fragment shader, and then adds its weighted, premultiplied colour to the
+    // accumulation target and its weighted alpha to the weight target. The alpha of the
+    // accumulation target is blended down to the revealage, the product of (1 - alpha). See
+    // VisualOit.frag.glsl.
+    inline constexpr const char* defaultOitFragShader = "precision highp float;\n"
+    "in VERTEX\n"
+    "{\n"
+    "    vec4 normal;\n"
+    "    vec4 color;\n"
+    "    vec3 fragpos;\n"
+    "} vertex;\n"
+    "uniform int colour_by_datum;\n"
+    "uniform sampler2D colour_lut;\n"
+    "uniform highp sampler2D datum_texture;\n"
+    "uniform vec2 datum_scale;\n"
+    "uniform vec2 datum_texture_offset;\n"
+    "uniform vec4 cell_grid;\n"
+    "uniform vec3 cell_grid_colour;\n"
+    "uniform vec3 cell_border_colour;\n"
+    "uniform float polar_inner;\n"
+    "layout(location = 0) out vec4 accum;\n"
+    "layout(location = 1) out float weight;\n"
+    "void main()\n"
+    "{\n"
+    "    vec4 col = vertex.color;\n"
+    "    if (colour_by_datum == 4) {\n"
+    "        if (col.b > 1.5) {\n"
+    "            highp float r = length(col.rg);\n"
+    "            if (r > 1.0 || r < polar_inner) { discard; }\n"
+    "            vec2 ts = vec2(textureSize(colour_lut, 0));\n"
+    "            highp float a = fract(atan(col.g, col.r) / 6.28318531) + 0.5 / ts.x;\n"
+    "            highp float rr = clamp((r - polar_inner) / max(1.0 - polar_inner, 1e-6), 0.0, 1.0);\n"
+    "            col.rgb = texture(colour_lut, vec2(a, (rr * (ts.y - 1.0) + 0.5) / ts.y)).rgb;\n"
+    "        }\n"
+    "    } else if (colour_by_datum != 0) {\n"
+    "        highp vec2 tc = col.rg;\n"
+    "        highp float d = colour_by_datum == 2 ? datum_scale.x * texture(datum_texture, col.rg + datum_texture_offset).r + datum_scale.y : col.r;\n"
+    "        float n = float(textureSize(colour_lut, 0).x);\n"
+    "        col.rgb = texture(colour_lut, vec2((clamp(d, 0.0, 1.0) * (n - 1.0) + 0.5) / n, 0.5)).rgb;\n"
+    "        if (colour_by_datum == 2 && cell_grid.z > 0.5) {\n"
+    "            highp vec2 c = tc * vec2(textureSize(datum_texture, 0));\n"
+    "            highp vec2 fw = max(fwidth(c), vec2(1e-6));\n"
+    "            highp vec2 hw = 0.5 * (cell_grid.z > 1.5 ? cell_grid.xy * fw : cell_grid.xy);\n"
+    "            highp vec2 e = abs(c - floor(c + 0.5));\n"
+    "            vec2 on = 1.0 - smoothstep(hw - 0.5 * fw, hw + 0.5 * fw, e);\n"
+    "            col.rgb = mix(col.rgb, cell_grid_colour, max(on.x, on.y));\n"
+    "        }\n"
+    "        if (colour_by_datum == 2 && cell_grid.w > 0.5\n"
+    "            && (any(lessThan(tc, vec2(0.0))) || any(greaterThan(tc, vec2(1.0))))) {\n"
+    "            col.rgb = cell_border_colour;\n"
+    "        }\n"
+    "    }\n"
+    "    vec3 norm = normalize(vec3(vertex.normal));\n"
+    "    vec3 light_dirn = normalize(diffuse_position - vertex.fragpos);\n"
+    "    float effective_diffuse = max(dot(norm, light_dirn), 0.0);\n"
+    "    vec3 diffuse = diffuse_intensity * effective_diffuse * light_colour;\n"
+    "    vec3 ambient = ambient_intensity * light_colour;\n"
+    "    vec3 result = (ambient+diffuse) * vec3(col);\n"
+    "    float w = clamp (pow (min (1.0, col.a * 10.0) + 0.01, 3.0) * 1e8 * pow (1.0 - gl_FragCoord.z * 0.9, 3.0), 1e-2, 3e3);\n"
+    "    accum = vec4(result * col.a * w, col.a);\n"
+    "    weight = col.a * w;\n"
+    "}\n";
+
+    inline std::string getDefaultOitFragShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += sceneStateBlock;
+        shdr += defaultOitFragShader;
+        return shdr;
+    }
+
+    // The vertex shader for the full-window passes (the composite pass of order independent
+    // transparency and the resampling of the cube map cylindrical projection): one triangle that
+    // covers the viewport. See VisualFullWindow.vert.glsl.
+    inline constexpr const char* defaultFullWindowVtxShader = "void main()\n"
+    "{\n"
+    "    vec2 p = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));\n"
+    "    gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);\n"
+    "}\n";
+
+    inline std::string getDefaultFullWindowVtxShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += defaultFullWindowVtxShader;
+        return shdr;
+    }
+
+    // The fragment shader for the composite pass, which blends the weighted average colour of
+    // the translucent fragments over the opaque scene. See VisualOitComposite.frag.glsl.
+    inline constexpr const char* defaultOitCompositeFragShader = "precision highp float;\n"
+    "uniform sampler2D accum_texture;\n"
+    "uniform sampler2D weight_texture;\n"
+    "out vec4 finalcolor;\n"
+    "void main()\n"
+    "{\n"
+    "    ivec2 p = ivec2(gl_FragCoord.xy);\n"
+    "    vec4 a = texelFetch(accum_texture, p, 0);\n"
+    "    if (a.a >= 1.0) { discard; }\n"
+    "    float w = texelFetch(weight_texture, p, 0).r;\n"
+    "    finalcolor = vec4(a.rgb / max(w, 1e-5), 1.0 - a.a);\n"
+    "}\n";
+
+    inline std::string getDefaultOitCompositeFragShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += defaultOitCompositeFragShader;
+        return shdr;
+    }
+
+    // The fragment shader for the cube map cylindrical projection, which looks up the colour of
+    // each pixel of the cylindrical view in the cube map into which the scene was drawn. Its
+    // mapping is the inverse of that in VisCyl.vert.glsl. See VisualCylCube.frag.glsl.
+    inline constexpr const char* defaultCylCubeFragShader = "precision highp float;\n"
+    "uniform samplerCube scene_cube;\n"
+    "uniform vec4 viewport;\n"
+    "out vec4 finalcolor;\n"
+    "void main()\n"
+    "{\n"
+    "    const float pi = 3.1415927;\n"
+    "    vec2 s = (gl_FragCoord.xy - viewport.xy) / viewport.zw * 2.0 - 1.0;\n"
+    "    float a = 0.5 * pi - s.x * pi;\n"
+    "    float q = sin (atan (s.y * cyl_height / cyl_radius));\n"
+    "    finalcolor = vec4(texture(scene_cube, vec3(cos (a), sin (a), q)).rgb, 1.0);\n"
+    "}\n";
+
+    inline std::string getDefaultCylCubeFragShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += sceneStateBlock;
+        shdr += defaultCylCubeFragShader;
+        return shdr;
+    }
+
+    // The fragment shader that copies the resolved scene into the window when the scene is drawn
+    // off-screen (see VisualBase::antiAliasing), through an FXAA filter if fxaa is 1. See
+    // VisualPostProcess.frag.glsl.
+    inline constexpr const char* defaultPostProcessFragShader = "precision highp float;\n"
+    "uniform sampler2D scene_texture;\n"
+    "uniform int fxaa;\n"
+    "out vec4 finalcolor;\n"
+    "void main()\n"
+    "{\n"
+    "    ivec2 p = ivec2(gl_FragCoord.xy);\n"
+    "    vec4 cm = texelFetch(scene_texture, p, 0);\n"
+    "    if (fxaa == 0) { finalcolor = cm; return; }\n"
+    "    vec2 inv = 1.0 / vec2(textureSize(scene_texture, 0));\n"
+    "    vec2 uv = gl_FragCoord.xy * inv;\n"
+    "    const vec3 luma = vec3(0.299, 0.587, 0.114);\n"
+    "    float lm = dot(cm.rgb, luma);\n"
+    "    float lnw = dot(texture(scene_texture, uv + vec2(-1.0, 1.0) * inv).rgb, luma);\n"
+    "    float lne = dot(texture(scene_texture, uv + vec2(1.0, 1.0) * inv).rgb, luma);\n"
+    "    float lsw = dot(texture(scene_texture, uv + vec2(-1.0, -1.0) * inv).rgb, luma);\n"
+    "    float lse = dot(texture(scene_texture, uv + vec2(1.0, -1.0) * inv).rgb, luma);\n"
+    "    float lmin = min(lm, min(min(lnw, lne), min(lsw, lse)));\n"
+    "    float lmax = max(lm, max(max(lnw, lne), max(lsw, lse)));\n"
+    "    vec2 dir = vec2((lsw + lse) - (lnw + lne), (lnw + lsw) - (lne + lse));\n"
+    "    float reduce = max((lnw + lne + lsw + lse) * 0.03125, 0.0078125);\n"
+    "    float rcp_min = 1.0 / (min(abs(dir.x), abs(dir.y)) + reduce);\n"
+    "    dir = clamp(dir * rcp_min, vec2(-8.0), vec2(8.0)) * inv;\n"
+    "    vec3 a = 0.5 * (texture(scene_texture, uv + dir * (1.0 / 3.0 - 0.5)).rgb\n"
+    "                    + texture(scene_texture, uv + dir * (2.0 / 3.0 - 0.5)).rgb);\n"
+    "    vec3 b = a * 0.5 + 0.25 * (texture(scene_texture, uv - dir * 0.5).rgb\n"
+    "                               + texture(scene_texture, uv + dir * 0.5).rgb);\n"
+    "    float lb = dot(b, luma);\n"
+    "    finalcolor = vec4((lb < lmin || lb > lmax) ? a : b, cm.a);\n"
+    "}\n";
+
+    inline std::string getDefaultPostProcessFragShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += defaultPostProcessFragShader;
+        return shdr;
+    }
+
+    // The compute shader for VisualModel::gpu_mesh (OpenGL 4.3+), which generates the z
+    // positions, normals and colours of a model's vertices from one datum per element, writing
+    // them into the model's vertex buffers. See VisualGpuMesh.comp.glsl.
+    inline constexpr const char* defaultGpuMeshComputeShader = "layout(local_size_x = 64) in;\n"
+    "\n"
+    "// The number of vertices to generate\n"
+    "uniform uint n_vertices;\n"
+    "// z = z_scale.x * datum + z_scale.y\n"
+    "uniform vec2 z_scale;\n"
+    "// The colour_lut position of a datum is colour_scale.x * datum + colour_scale.y\n"
+    "uniform vec2 colour_scale;\n"
+    "// Bit 0 set: z_scale maps the range of the data (in data_range) onto z_range instead. Bit 1\n"
+    "// set: colour_scale maps it onto colour_range.\n"
+    "uniform uint autoscale;\n"
+    "uniform vec2 z_range;\n"
+    "uniform vec2 colour_range;\n"
+    "// The colour lookup texture\n"
+    "uniform sampler2D colour_lut;\n"
+    "\n"
+    "// z_src: up to four elements whose mean datum gives z (-1 for none, from z_src.x onwards; z is\n"
+    "// kept if z_src.x is -1). norm_src.xyz: the vertices\n"
+    "// from which the normal is computed (-1 to keep the normal). norm_src.w: the colour element.\n"
+    "struct MeshSource\n"
+    "{\n"
+    "    ivec4 z_src;\n"
+    "    ivec4 norm_src;\n"
+    "};\n"
+    "\n"
+    "layout(std430, binding = 2) readonly buffer MeshData { float data[]; };\n"
+    "layout(std430, binding = 3) readonly buffer MeshSources { MeshSource sources[]; };\n"
+    "layout(std430, binding = 4) buffer Positions { float posn[]; };\n"
+    "layout(std430, binding = 5) buffer Normals { float norm[]; };\n"
+    "layout(std430, binding = 6) buffer Colours { float col[]; };\n"
+    "// The min and max of the data, found by VisualGpuMeshRange.comp.glsl (if autoscale != 0)\n"
+    "layout(std430, binding = 7) readonly buffer MeshRange { vec4 data_range; };\n"
+    "\n"
+    "// The z and colour scalings in use\n"
+    "vec2 zsc;\n"
+    "vec2 csc;\n"
+    "\n"
+    "// The linear scaling that maps the range of the data onto r\n"
+    "vec2 range_scale (vec2 r)\n"
+    "{\n"
+    "    float span = data_range.y - data_range.x;\n"
+    "    if (!(span > 0.0)) { return vec2(0.0, r.x); }\n"
+    "    float m = (r.y - r.x) / span;\n"
+    "    return vec2(m, r.x - m * data_range.x);\n"
+    "}\n"
+    "\n"
+    "// NaN data are treated as 0\n"
+    "float datum (int e)\n"
+    "{\n"
+    "    float d = data[e];\n"
+    "    return isnan(d) ? 0.0 : d;\n"
+    "}\n"
+    "\n"
+    "// The generated z of vertex v (or its existing z, if it has no z sources)\n"
+    "float vertex_z (uint v)\n"
+    "{\n"
+    "    ivec4 s = sources[v].z_src;\n"
+    "    float sum = 0.0;\n"
+    "    float n = 0.0;\n"
+    "    for (int k = 0; k < 4; ++k) {\n"
+    "        if (s[k] >= 0) {\n"
+    "            sum += datum (s[k]);\n"
+    "            n += 1.0;\n"
+    "        }\n"
+    "    }\n"
+    "    return n > 0.0 ? zsc.x * (sum / n) + zsc.y : posn[3u * v + 2u];\n"
+    "}\n"
+    "\n"
+    "vec3 vertex_posn (uint v)\n"
+    "{\n"
+    "    return vec3(posn[3u * v], posn[3u * v + 1u], vertex_z (v));\n"
+    "}\n"
+    "\n"
+    "void main()\n"
+    "{\n"
+    "    uint v = gl_GlobalInvocationID.x;\n"
+    "    if (v >= n_vertices) { return; }\n"
+    "    zsc = (autoscale & 1u) != 0u ? range_scale (z_range) : z_scale;\n"
+    "    csc = (autoscale & 2u) != 0u ? range_scale (colour_range) : colour_scale;\n"
+    "    MeshSource ms = sources[v];\n"
+    "\n"
+    "    // The normal is computed from the generated positions, so it is found before any z is written\n"
+    "    if (ms.norm_src.x >= 0) {\n"
+    "        vec3 v0 = vertex_posn (uint(ms.norm_src.x));\n"
+    "        vec3 v1 = vertex_posn (uint(ms.norm_src.y));\n"
+    "        vec3 v2 = vertex_posn (uint(ms.norm_src.z));\n"
+    "        vec3 n = normalize (cross (v2 - v0, v1 - v0));\n"
+    "        norm[3u * v] = n.x;\n"
+    "        norm[3u * v + 1u] = n.y;\n"
+    "        norm[3u * v + 2u] = n.z;\n"
+    "    }\n"
+    "\n"
+    "    if (ms.z_src.x >= 0) { posn[3u * v + 2u] = vertex_z (v); }\n"
+    "\n"
+    "    if (ms.norm_src.w >= 0) {\n"
+    "        float c = clamp (csc.x * datum (ms.norm_src.w) + csc.y, 0.0, 1.0);\n"
+    "        float n = float(textureSize (colour_lut, 0).x);\n"
+    "        // As Visual.frag.glsl samples it. There are no derivatives in a compute shader, so the LOD is given.\n"
+    "        vec3 rgb = textureLod (colour_lut, vec2((c * (n - 1.0) + 0.5) / n, 0.5), 0.0).rgb;\n"
+    "        col[3u * v] = rgb.r;\n"
+    "        col[3u * v + 1u] = rgb.g;\n"
+    "        col[3u * v + 2u] = rgb.b;\n"
+    "    }\n"
+    "}\n";
+
+    inline std::string getDefaultGpuMeshComputeShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += defaultGpuMeshComputeShader;
+        return shdr;
+    }
+
+    // The compute shader that finds the range of the data for the GPU mesh's autoscaling
+    // (VisualModel::gpu_mesh_autoscale), in one workgroup. See VisualGpuMeshRange.comp.glsl.
+    inline constexpr const char* defaultGpuMeshRangeComputeShader = "layout(local_size_x = 256) in;\n"
+    "\n"
+    "// The number of data\n"
+    "uniform uint n_data;\n"
+    "layout(std430, binding = 2) readonly buffer MeshData { float data[]; };\n"
+    "layout(std430, binding = 7) writeonly buffer MeshRange { vec4 data_range; };\n"
+    "\n"
+    "shared vec2 r[256];\n"
+    "\n"
+    "void main()\n"
+    "{\n"
+    "    uint l = gl_LocalInvocationID.x;\n"
+    "    float inf = uintBitsToFloat(0x7f800000u);\n"
+    "    vec2 m = vec2(inf, -inf);\n"
+    "    // Each invocation finds the range of every 256th datum (NaNs are skipped)...\n"
+    "    for (uint i = l; i < n_data; i += 256u) {\n"
+    "        float d = data[i];\n"
+    "        if (!isnan(d)) { m = vec2(min(m.x, d), max(m.y, d)); }\n"
+    "    }\n"
+    "    r[l] = m;\n"
+    "    memoryBarrierShared();\n"
+    "    barrier();\n"
+    "    // ...and the workgroup combines them\n"
+    "    for (uint s = 128u; s > 0u; s >>= 1) {\n"
+    "        if (l < s) { r[l] = vec2(min(r[l].x, r[l + s].x), max(r[l].y, r[l + s].y)); }\n"
+    "        memoryBarrierShared();\n"
+    "        barrier();\n"
+    "    }\n"
+    "    if (l == 0u) { data_range = vec4(r[0], 0.0, 0.0); }\n"
+    "}\n";
+
+    inline std::string getDefaultGpuMeshRangeComputeShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += defaultGpuMeshRangeComputeShader;
+        return shdr;
+    }
+
+
+    // The compute shader that fills the cells of VisualModel's jump flooding (see
+    // VisualModelBase::set_jump_flood_grid) in four kinds of pass. See VisualJumpFlood.comp.glsl.
+    inline constexpr const char* defaultJumpFloodComputeShader = "layout(local_size_x = 8, local_size_y = 8) in;\n"
+    "\n"
+    "// The pass: 0 clears the site index of each texel to -1, 1 seeds each site's texel with its\n"
+    "// index, 2 is one step of flooding and 3 writes each texel the datum of its site into cells\n"
+    "uniform uint pass;\n"
+    "// The step of a flooding pass, in texels\n"
+    "uniform int step_size;\n"
+    "// The grid of texels, which covers the rectangle lo to hi of the model's x and y\n"
+    "uniform ivec2 dims;\n"
+    "uniform vec2 lo;\n"
+    "uniform vec2 hi;\n"
+    "uniform uint n_sites;\n"
+    "uniform uint n_data;\n"
+    "\n"
+    "layout(std430, binding = 8) readonly buffer Sites { vec2 sites[]; };\n"
+    "layout(std430, binding = 9) readonly buffer SiteData { float data[]; };\n"
+    "// The site index of each texel (in rows of dims.x), read from src and written to dst\n"
+    "layout(std430, binding = 10) readonly buffer Src { int src[]; };\n"
+    "layout(std430, binding = 11) buffer Dst { int dst[]; };\n"
+    "layout(r32f, binding = 0) writeonly uniform image2D cells;\n"
+    "\n"
+    "// The model coordinates of the centre of texel t\n"
+    "vec2 texel_posn (ivec2 t)\n"
+    "{\n"
+    "    return lo + (vec2(t) + 0.5) * (hi - lo) / vec2(dims);\n"
+    "}\n"
+    "\n"
+    "void main()\n"
+    "{\n"
+    "    if (pass == 1u) {\n"
+    "        // One invocation per site, in rows as wide as the dispatch\n"
+    "        uint s = gl_GlobalInvocationID.y * gl_NumWorkGroups.x * gl_WorkGroupSize.x + gl_GlobalInvocationID.x;\n"
+    "        if (s >= n_sites) { return; }\n"
+    "        vec2 u = (sites[s] - lo) / (hi - lo);\n"
+    "        // Sites outside the rectangle (or NaN) seed nothing\n"
+    "        if (!(all(greaterThanEqual(u, vec2(0.0))) && all(lessThanEqual(u, vec2(1.0))))) { return; }\n"
+    "        ivec2 st = min(ivec2(u * vec2(dims)), dims - 1);\n"
+    "        // Of the sites in one texel, the last keeps it, whatever the order of the invocations\n"
+    "        atomicMax (dst[st.y * dims.x + st.x], int(s));\n"
+    "        return;\n"
+    "    }\n"
+    "\n"
+    "    ivec2 t = ivec2(gl_GlobalInvocationID.xy);\n"
+    "    if (any(greaterThanEqual(t, dims))) { return; }\n"
+    "    int i = t.y * dims.x + t.x;\n"
+    "    if (pass == 0u) {\n"
+    "        dst[i] = -1;\n"
+    "        return;\n"
+    "    }\n"
+    "    if (pass == 3u) {\n"
+    "        int s = src[i];\n"
+    "        float d = (s >= 0 && uint(s) < n_data) ? data[s] : 0.0;\n"
+    "        imageStore (cells, t, vec4(d, 0.0, 0.0, 0.0));\n"
+    "        return;\n"
+    "    }\n"
+    "\n"
+    "    // Keep the nearest of this texel's site and the sites of the eight texels step_size away\n"
+    "    vec2 p = texel_posn (t);\n"
+    "    int best = src[i];\n"
+    "    float best_d = 0.0;\n"
+    "    if (best >= 0) {\n"
+    "        vec2 e = sites[best] - p;\n"
+    "        best_d = dot (e, e);\n"
+    "    }\n"
+    "    for (int dy = -1; dy <= 1; ++dy) {\n"
+    "        for (int dx = -1; dx <= 1; ++dx) {\n"
+    "            ivec2 q = t + ivec2(dx, dy) * step_size;\n"
+    "            if ((dx == 0 && dy == 0) || any(lessThan(q, ivec2(0))) || any(greaterThanEqual(q, dims))) { continue; }\n"
+    "            int c = src[q.y * dims.x + q.x];\n"
+    "            if (c < 0 || c == best) { continue; }\n"
+    "            vec2 e = sites[c] - p;\n"
+    "            float dd = dot (e, e);\n"
+    "            if (best < 0 || dd < best_d) {\n"
+    "                best = c;\n"
+    "                best_d = dd;\n"
+    "            }\n"
+    "        }\n"
+    "    }\n"
+    "    dst[i] = best;\n"
+    "}\n";
+
+    inline std::string getDefaultJumpFloodComputeShader (const int glver)
+    {
+        std::string shdr;
+        shdr += mplot::gl::version::shaderpreamble (glver);
+        shdr += defaultJumpFloodComputeShader;
+        return shdr;
+    }
 } // namespace mplot
@@ -13,14 +13,22 @@
 #pragma once
 
 #include <map>
+#include <unordered_map>
+#include <array>
+#include <string>
+#include <vector>
 #include <iostream>
 #include <utility>
-#include <fstream>
+#include <cstdint>
+#include <algorithm>
 
 #include <mplot/tools.h>
 #include <mplot/VisualCommon.h> // for visgl::CharInfo
 #include <mplot/VisualFont.h>
 #include <mplot/TextFeatures.h>
+#include <mplot/unicode.h>
+#include <mplot/memory_report.h>
+#include <mplot/startup_profile.h>
 
 // FreeType for text rendering
 #include <ft2build.h>
@@ -31,7 +39,11 @@
  * have different code for Linux and Mac. Both tested only on Intel CPUs.
  */
 
-#ifdef __linux__
+#if defined MPLOT_CORE && !defined MPLOT_CORE_FONTS
+
+// The fonts are embedded once, by the mplot_core library, rather than by each translation unit
+
+#elif defined __linux__
 
 # ifdef __aarch64__
 
@@ -97,7 +109,6 @@ asm("\t.global ___start_dvsansbi_ttf\n\t.global ___stop_dvsansbi_ttf\n___start_d
 #elif defined _MSC_VER
 
 # include <mplot/fonts/verafonts.h> // Includes vera fonts AND DejaVu fonts.
-# include <cstdlib>
 
 #elif defined _mplot_WIN__INCBIN // Define this only for parsing this file with the incbin executable to create verafonts.h
 
@@ -128,8 +139,15 @@ INCBIN(dvsansbi, "./fonts/dejavu/DejaVuSans-BoldOblique.ttf");
 # error "Inline assembly code for including truetype fonts in the binary only work on Linux/MacOS (and then, probably only on Intel compatible compilers. Sorry about that!"
 #endif
 
+// embedded_font is inline, unless it is compiled once, into the mplot_core library
+#ifdef MPLOT_CORE_FONTS
+# define MPLOT_EMBEDDED_FONT_LINKAGE
+#else
+# define MPLOT_EMBEDDED_FONT_LINKAGE inline
+#endif
+
 // These external pointers are set up by the inline assembly above
-#ifndef _MSC_VER
+#if !defined _MSC_VER && !(defined MPLOT_CORE && !defined MPLOT_CORE_FONTS)
 extern const char __start_verabd_ttf[];
 extern const char __stop_verabd_ttf[];
 extern const char __start_verabi_ttf[];
@@ -165,223 +183,469 @@ namespace mplot {
 
     namespace visgl {
 
+#if defined MPLOT_CORE && !defined MPLOT_CORE_FONTS
+        //! The start and end of the TTF data for _font (or nulls). Defined in the mplot_core
+        //! library, which embeds the fonts once (see core/fonts.cpp).
+        std::pair<const void*, const void*> embedded_font (const mplot::VisualFont _font);
+#else
+        //! The start and end of the TTF data for _font that is embedded in the program (or nulls)
+        MPLOT_EMBEDDED_FONT_LINKAGE std::pair<const void*, const void*> embedded_font (const mplot::VisualFont _font)
+        {
+            switch (_font) {
+#ifdef _MSC_VER
+            case VisualFont::DVSans: return { vf_dvsansData, vf_dvsansEnd };
+            case VisualFont::DVSansItalic: return { vf_dvsansitData, vf_dvsansitEnd };
+            case VisualFont::DVSansBold: return { vf_dvsansbdData, vf_dvsansbdEnd };
+            case VisualFont::DVSansBoldItalic: return { vf_dvsansbiData, vf_dvsansbiEnd };
+            case VisualFont::Vera: return { vf_veraData, vf_veraEnd };
+            case VisualFont::VeraItalic: return { vf_veraitData, vf_veraitEnd };
+            case VisualFont::VeraBold: return { vf_verabdData, vf_verabdEnd };
+            case VisualFont::VeraBoldItalic: return { vf_verabiData, vf_verabiEnd };
+            case VisualFont::VeraMono: return { vf_veramonoData, vf_veramonoEnd };
+            case VisualFont::VeraMonoItalic: return { vf_veramoitData, vf_veramoitEnd };
+            case VisualFont::VeraMonoBold: return { vf_veramobdData, vf_veramobdEnd };
+            case VisualFont::VeraMonoBoldItalic: return { vf_veramobiData, vf_veramobiEnd };
+            case VisualFont::VeraSerif: return { vf_veraseData, vf_veraseEnd };
+            case VisualFont::VeraSerifBold: return { vf_verasebdData, vf_verasebdEnd };
+#else
+            case VisualFont::DVSans: return { __start_dvsans_ttf, __stop_dvsans_ttf };
+            case VisualFont::DVSansItalic: return { __start_dvsansit_ttf, __stop_dvsansit_ttf };
+            case VisualFont::DVSansBold: return { __start_dvsansbd_ttf, __stop_dvsansbd_ttf };
+            case VisualFont::DVSansBoldItalic: return { __start_dvsansbi_ttf, __stop_dvsansbi_ttf };
+            case VisualFont::Vera: return { __start_vera_ttf, __stop_vera_ttf };
+            case VisualFont::VeraItalic: return { __start_verait_ttf, __stop_verait_ttf };
+            case VisualFont::VeraBold: return { __start_verabd_ttf, __stop_verabd_ttf };
+            case VisualFont::VeraBoldItalic: return { __start_verabi_ttf, __stop_verabi_ttf };
+            case VisualFont::VeraMono: return { __start_veramono_ttf, __stop_veramono_ttf };
+            case VisualFont::VeraMonoItalic: return { __start_veramoit_ttf, __stop_veramoit_ttf };
+            case VisualFont::VeraMonoBold: return { __start_veramobd_ttf, __stop_veramobd_ttf };
+            case VisualFont::VeraMonoBoldItalic: return { __start_veramobi_ttf, __stop_veramobi_ttf };
+            case VisualFont::VeraSerif: return { __start_verase_ttf, __stop_verase_ttf };
+            case VisualFont::VeraSerifBold: return { __start_verasebd_ttf, __stop_verasebd_ttf };
+#endif
+            default: return { nullptr, nullptr };
+            }
+        }
+#endif
+
+        /*!
+         * Glyphs are rasterized on demand into a single, shelf-packed GL_RED atlas texture. The
+         * printable ASCII and Latin-1 characters are loaded at construction (and are never
+         * evicted); any other code point is rasterized the first time that get_glyph() is called
+         * for it. If the atlas fills up, it is grown (up to atlas_max_dim pixels high), and after
+         * that, the least recently used shelf of glyphs is evicted to make room.
+         *
+         * Whenever existing glyphs move or are evicted, VisualFaceBase::generation is
+         * incremented, so that VisualTextModels can re-compute their texture coordinates.
+         *
+         * This base class does the FreeType work and keeps a CPU-side copy of the atlas. The
+         * derived classes VisualFaceMX and VisualFaceNoMX do the GL texture uploads.
+         */
         struct VisualFaceBase
         {
             VisualFaceBase () {}
-            ~VisualFaceBase () {}
+            virtual ~VisualFaceBase ()
+            {
+                // The face is held open so that glyphs can be rasterized on demand
+                if (this->face != nullptr) { FT_Done_Face (this->face); }
+            }
 
             //! Set true for informational/debug messages
             static constexpr bool debug_visualface = false;
 
             //! The FT_Face that we're managing
-            FT_Face face;
+            FT_Face face = nullptr;
 
-            //! The OpenGL character info stuff
+            //! The OpenGL character info stuff. Holds only those glyphs that have been loaded.
             std::map<char32_t, mplot::visgl::CharInfo> glchars;
 
-        protected:
+            //! The GL texture ID of the glyph atlas
+            unsigned int atlas_texture = 0;
 
-            void init_common (const mplot::VisualFont _font, unsigned int fontpixels, FT_Library& ft_freetype)
+            //! Width and height of the glyph atlas in pixels
+            sm::vec<int, 2> atlas_dims = { 0, 0 };
+
+            //! The maximum height (and width) of the atlas texture. Derived classes reduce this to
+            //! GL_MAX_TEXTURE_SIZE if necessary.
+            int atlas_max_dim = 4096;
+
+            //! Incremented whenever the atlas coordinates of already-loaded glyphs become invalid
+            unsigned int generation = 0;
+
+            /*!
+             * If true, the atlas holds a signed distance field of each glyph (0.5 on the outline,
+             * rising inside it), which VisText.frag.glsl thresholds, so that one atlas serves
+             * every size of text. This needs FreeType 2.11 or later; with an older FreeType, the
+             * glyphs are rasterized as usual and the threshold only antialiases their edges.
+             */
+            bool sdf = false;
+
+            /*!
+             * The memory held by this face: the atlas texture, its CPU copy and glyph tables. The
+             * bytes of a std::map are estimated as those of its elements and their tree nodes.
+             */
+            mplot::memory_report get_memory_report() const
             {
-                std::string fontpath = "";
-#ifdef _MSC_VER
-		char* userprofile = getenv ("USERPROFILE");
-		std::string uppath("");
-		if (userprofile != nullptr) {
-		    uppath = std::string (userprofile);
-		}
-
-                switch (_font) {
-                case VisualFont::DVSans:
-                {
-                    fontpath = uppath + "\\AppData\\Local\\Temp\\DejaVuSans.ttf";
-                    this->makeTempFontFile<const unsigned char> (fontpath, vf_dvsansData, vf_dvsansEnd);
-                    break;
-                }
-                case VisualFont::DVSansItalic:
-                {
-                    fontpath = uppath + "\\AppData\\Local\\Temp\\DejaVuSans-Oblique.ttf";
-                    this->makeTempFontFile<const unsigned char> (fontpath, vf_dvsansitData, vf_dvsansitEnd);
-                    break;
-                }
-                case VisualFont::DVSansBold:
-                {
-                    fontpath = uppath + "\\AppData\\Local\\Temp\\DejaVuSans-Bold.ttf";
-                    this->makeTempFontFile<const unsigned char> (fontpath, vf_dvsansbdData, vf_dvsansbdEnd);
-                    break;
-                }
-                case VisualFont::DVSansBoldItalic:
-                {
-                    fontpath = uppath + "\\AppData\\Local\\Temp\\DejaVuSans-BoldOblique.ttf";
-                    this->makeTempFontFile<const unsigned char> (fontpath, vf_dvsansbiData, vf_dvsansbiEnd);
-                    break;
-                }
-                case VisualFont::Vera:
-                {
-                    fontpath = uppath + "\\AppData\\Local\\Temp\\Vera.ttf";
-                    this->makeTempFontFile<const unsigned char> (fontpath, vf_veraData, vf_veraEnd);
-                    break;
-                }
-                case VisualFont::VeraItalic:
-                {
-                    fontpath = uppath + "\\AppData\\Local\\Temp\\VeraIt.ttf";
-                    this->makeTempFontFile<const unsigned char> (fontpath, vf_veraitData, vf_veraitEnd);
-                    break;
-                }
-                case VisualFont::VeraBold:
-                {
-                    fontpath = uppath + "\\AppData\\Local\\Temp\\VeraBd.ttf";
-                    this->makeTempFontFile<const unsigned char> (fontpath, vf_verabdData, vf_verabdEnd);
-                    break;
-                }
-                case VisualFont::VeraBoldItalic:
-                {
-                    fontpath = uppath + "\\AppData\\Local\\Temp\\VeraBI.ttf";
-                    this->makeTempFontFile<const unsigned char> (fontpath, vf_verabiData, vf_verabiEnd);
-                    break;
-                }
-                case VisualFont::VeraMono:
-                {
-                    fontpath = uppath + "\\AppData\\Local\\Temp\\VeraMono.ttf";
-                    this->makeTempFontFile<const unsigned char> (fontpath, vf_veramonoData, vf_veramonoEnd);
-                    break;
-                }
-                case VisualFont::VeraMonoBold:
-                {
-                    fontpath = uppath + "\\AppData\\Local\\Temp\\VeraMoBd.ttf";
-                    this->makeTempFontFile<const unsigned char> (fontpath, vf_veramobdData, vf_veramobdEnd);
-                    break;
-                }
-                case VisualFont::VeraMonoItalic:
-                {
-                    fontpath = uppath + "\\AppData\\Local\\Temp\\VeraMoIt.ttf";
-                    this->makeTempFontFile<const unsigned char> (fontpath, vf_veramoitData, vf_veramoitEnd);
-                    break;
-                }
-                case VisualFont::VeraMonoBoldItalic:
-                {
-                    fontpath = uppath + "\\AppData\\Local\\Temp\\VeraMoBI.ttf";
-                    this->makeTempFontFile<const unsigned char> (fontpath, vf_veramobiData, vf_veramobiEnd);
-                    break;
-                }
-                case VisualFont::VeraSerif:
-                {
-                    fontpath = uppath + "\\AppData\\Local\\Temp\\VeraSe.ttf";
-                    this->makeTempFontFile<const unsigned char> (fontpath, vf_veraseData, vf_veraseEnd);
-                    break;
-                }
-                case VisualFont::VeraSerifBold:
-                {
-                    fontpath = uppath + "\\AppData\\Local\\Temp\\VeraSeBd.ttf";
-                    this->makeTempFontFile<const unsigned char> (fontpath, vf_verasebdData, vf_verasebdEnd);
-                    break;
-                }
-                default:
-                {
-                    std::cout << "ERROR::Unsupported mplot font\n";
-                    break;
-                }
-                }
-#else	 // Non-windows:
-                switch (_font) {
-                case VisualFont::DVSans:
-                {
-                    fontpath = "/tmp/DejaVuSans.ttf";
-                    this->makeTempFontFile (fontpath, __start_dvsans_ttf, __stop_dvsans_ttf);
-                    break;
-                }
-                case VisualFont::DVSansItalic:
-                {
-                    fontpath = "/tmp/DejaVuSans-Oblique.ttf";
-                    this->makeTempFontFile (fontpath, __start_dvsansit_ttf, __stop_dvsansit_ttf);
-                    break;
-                }
-                case VisualFont::DVSansBold:
-                {
-                    fontpath = "/tmp/DejaVuSans-Bold.ttf";
-                    this->makeTempFontFile (fontpath, __start_dvsansbd_ttf, __stop_dvsansbd_ttf);
-                    break;
-                }
-                case VisualFont::DVSansBoldItalic:
-                {
-                    fontpath = "/tmp/DejaVuSans-BoldOblique.ttf";
-                    this->makeTempFontFile (fontpath, __start_dvsansbi_ttf, __stop_dvsansbi_ttf);
-                    break;
-                }
-                case VisualFont::Vera:
-                {
-                    fontpath = "/tmp/Vera.ttf";
-                    this->makeTempFontFile (fontpath, __start_vera_ttf, __stop_vera_ttf);
-                    break;
-                }
-                case VisualFont::VeraItalic:
-                {
-                    fontpath = "/tmp/VeraIt.ttf";
-                    this->makeTempFontFile (fontpath, __start_verait_ttf, __stop_verait_ttf);
-                    break;
-                }
-                case VisualFont::VeraBold:
-                {
-                    fontpath = "/tmp/VeraBd.ttf";
-                    this->makeTempFontFile (fontpath, __start_verabd_ttf, __stop_verabd_ttf);
-                    break;
+                mplot::memory_report r;
+                r.name = "face";
+                r.add_vector ("atlas_pixels", this->atlas_pixels);
+                r.add_vector ("atlas_staging", this->atlas_staging);
+                r.add_vector ("shelves", this->shelves);
+                const std::size_t gb = this->glchars.size() * (sizeof (decltype (this->glchars)::value_type) + 4u * sizeof (void*));
+                r.add_cpu ("glchars", gb, gb);
+                const std::size_t eb = this->atlas_entries.size() * (sizeof (decltype (this->atlas_entries)::value_type) + 4u * sizeof (void*));
+                r.add_cpu ("atlas_entries", eb, eb);
+                // The atlas is GL_RED, one byte per pixel
+                if (this->atlas_texture != 0u) {
+                    r.add_gpu ("atlas_texture", static_cast<std::size_t>(this->atlas_dims.x()) * static_cast<std::size_t>(this->atlas_dims.y()));
+                }
+                return r;
+            }
+
+            /*!
+             * Return the CharInfo for the Unicode character c, rasterizing the glyph into the
+             * atlas if it has not yet been loaded. A character that the font does not contain
+             * has a zero size and zero advance (as it always had).
+             */
+            mplot::visgl::CharInfo get_glyph (const char32_t c)
+            {
+                ++this->use_tick;
+                auto gi = this->glchars.find (c);
+                if (gi == this->glchars.end()) {
+                    mplot::startup_profile::counter_scope startup_count (mplot::startup_profile::glyph_ns());
+                    gi = this->load_glyph (c);
+                }
+                // Touch the glyph's shelf so that it is not the next to be evicted
+                auto ai = this->atlas_entries.find (c);
+                if (ai != this->atlas_entries.end()) { this->shelves[ai->second.shelf].last_use = this->use_tick; }
+                return gi->second;
+            }
+
+            //! The layout metrics of a string in this face, in pixels (see measure())
+            struct text_metrics
+            {
+                //! The sum of the glyph advances
+                int advance = 0;
+                //! The greatest extent of any glyph above the baseline (at least 0)
+                int max_bearingy = 0;
+                //! The greatest extent of any glyph below the baseline (at least 0)
+                int max_drop = 0;
+            };
+
+            /*!
+             * Measure the UTF-8 string txt. Layout code measures the same strings (tick labels,
+             * legend entries) again and again, so the results for up to measured_max strings are
+             * kept. Glyph metrics don't change when the atlas is re-packed, so neither do these.
+             */
+            text_metrics measure (const std::string& txt)
+            {
+                auto mi = this->measured.find (txt);
+                if (mi != this->measured.end()) { return mi->second; }
+                const text_metrics m = this->measure (mplot::unicode::fromUtf8 (txt));
+                if (this->measured.size() >= measured_max) { this->measured.clear(); }
+                this->measured.emplace (txt, m);
+                return m;
+            }
+
+            //! Measure the string utxt. The pre-loaded Latin-1 glyphs are measured without a
+            //! lookup in glchars.
+            text_metrics measure (const std::basic_string<char32_t>& utxt)
+            {
+                text_metrics m;
+                for (const char32_t c : utxt) {
+                    glyph_metrics g;
+                    if (c < this->latin1_metrics.size() && this->latin1_metrics[c].loaded) {
+                        g = this->latin1_metrics[c];
+                    } else {
+                        g = glyph_metrics::of (this->get_glyph (c));
+                    }
+                    m.advance += g.advance;
+                    m.max_bearingy = std::max (m.max_bearingy, g.bearingy);
+                    m.max_drop = std::max (m.max_drop, g.drop);
                 }
-                case VisualFont::VeraBoldItalic:
+                return m;
+            }
+
+        protected:
+            //! Upload all of atlas_pixels into atlas_texture, (re)allocating the texture
+            virtual void upload_atlas() = 0;
+            //! Upload the glyph in atlas_staging into atlas_texture at x, y with size w by h
+            virtual void upload_atlas_region (const int x, const int y, const int w, const int h) = 0;
+
+            //! Gap left between glyphs in the atlas, so that GL_LINEAR sampling doesn't bleed
+            static constexpr int atlas_padding = 1;
+
+            //! A shelf (a row) of glyphs in the atlas
+            struct atlas_shelf
+            {
+                //! Top of the shelf in atlas pixels
+                int y = 0;
+                //! The height of the shelf
+                int h = 0;
+                //! The x position at which the next glyph can be placed
+                int x = atlas_padding;
+                //! Value of use_tick when any glyph on the shelf was last requested
+                std::uint64_t last_use = 0;
+                //! Shelves created for the pre-loaded glyphs are never evicted
+                bool pinned = false;
+            };
+
+            //! Where a glyph lives in the atlas
+            struct atlas_entry
+            {
+                int x = 0;
+                int y = 0;
+                int shelf = 0;
+            };
+
+            //! CPU-side copy of the atlas texture
+            std::vector<unsigned char> atlas_pixels;
+            //! A tightly packed copy of the last glyph added, for upload_atlas_region()
+            std::vector<unsigned char> atlas_staging;
+            //! The shelves, in order down the atlas
+            std::vector<atlas_shelf> shelves;
+            //! Atlas location of each loaded glyph that has a bitmap
+            std::map<char32_t, atlas_entry> atlas_entries;
+            //! A counter to order glyph requests for least-recently-used eviction
+            std::uint64_t use_tick = 0;
+            //! True while the constructor pre-loads glyphs (skips per-glyph uploads)
+            bool preloading = false;
+
+            //! The metrics of one glyph that matter for layout, in pixels
+            struct glyph_metrics
+            {
+                int advance = 0;
+                int bearingy = 0;
+                int drop = 0;
+                bool loaded = false;
+                static glyph_metrics of (const mplot::visgl::CharInfo& ci)
                 {
-                    fontpath = "/tmp/VeraBI.ttf";
-                    this->makeTempFontFile (fontpath, __start_verabi_ttf, __stop_verabi_ttf);
-                    break;
+                    return glyph_metrics{ static_cast<int>(ci.advance >> 6), ci.bearing.y(), ci.size.y() - ci.bearing.y(), true };
+                }
+            };
+            //! Metrics of the pre-loaded glyphs (those below U+0100), indexed by code point
+            std::array<glyph_metrics, 0x100> latin1_metrics = {};
+            //! The metrics of recently measured strings
+            std::unordered_map<std::string, text_metrics> measured;
+            //! The most strings to hold in measured before it is emptied
+            static constexpr std::size_t measured_max = 4096;
+            //! Set when the atlas was resized or had glyphs evicted and needs a full upload
+            bool atlas_dirty = false;
+
+            //! Rasterize the glyphs for printable ASCII and Latin-1 into the atlas and upload it
+            void preload_latin1()
+            {
+                this->preloading = true;
+                for (char32_t c = 0x20; c < 0x7f; ++c) { this->load_glyph (c); }
+                for (char32_t c = 0xa0; c < 0x100; ++c) { this->load_glyph (c); }
+                this->preloading = false;
+                for (const auto& gc : this->glchars) {
+                    if (gc.first < this->latin1_metrics.size()) { this->latin1_metrics[gc.first] = glyph_metrics::of (gc.second); }
+                }
+                this->upload_atlas();
+                this->atlas_dirty = false;
+            }
+
+            //! Choose an initial atlas size from the font pixel size.
+            void init_atlas (unsigned int fontpixels)
+            {
+                int w = 256;
+                // Room for about 16 glyphs across
+                while (w < static_cast<int>(fontpixels) * 16 && w < this->atlas_max_dim) { w *= 2; }
+                w = std::min (w, this->atlas_max_dim);
+                this->atlas_dims = { w, std::max (64, w / 4) };
+                this->atlas_pixels.assign (this->atlas_dims.x() * this->atlas_dims.y(), 0);
+                this->shelves.clear();
+                this->atlas_entries.clear();
+            }
+
+            //! Write the texture coordinates for glyph c located at ae into its CharInfo
+            void set_uv (mplot::visgl::CharInfo& ci, const atlas_entry& ae)
+            {
+                const float W = static_cast<float>(this->atlas_dims.x());
+                const float H = static_cast<float>(this->atlas_dims.y());
+                ci.uv = { ae.x / W, ae.y / H, (ae.x + ci.size.x()) / W, (ae.y + ci.size.y()) / H };
+            }
+
+            //! Find a place in the atlas for a w by h glyph. Return the shelf index, or -1.
+            int allocate (const int w, const int h, int& x, int& y)
+            {
+                const int pw = w + atlas_padding;
+                const int ph = h + atlas_padding;
+                if (pw > this->atlas_dims.x()) { return -1; }
+
+                // Best fit: the shortest existing shelf that is tall enough and has room
+                int best = -1;
+                for (int i = 0; i < static_cast<int>(this->shelves.size()); ++i) {
+                    const atlas_shelf& s = this->shelves[i];
+                    if (s.h >= ph && s.x + pw <= this->atlas_dims.x()
+                        && (best == -1 || s.h < this->shelves[best].h)) { best = i; }
+                }
+
+                if (best == -1) {
+                    // Open a new shelf, growing the atlas downwards if necessary
+                    const int top = this->shelves.empty() ? atlas_padding : this->shelves.back().y + this->shelves.back().h;
+                    while (top + ph > this->atlas_dims.y() && this->atlas_dims.y() < this->atlas_max_dim) {
+                        this->grow_atlas();
+                    }
+                    if (top + ph <= this->atlas_dims.y()) {
+                        atlas_shelf s;
+                        s.y = top;
+                        s.h = ph;
+                        s.pinned = this->preloading;
+                        this->shelves.push_back (s);
+                        best = static_cast<int>(this->shelves.size()) - 1;
+                    } else {
+                        best = this->evict_shelf (ph);
+                        if (best == -1) { return -1; }
+                    }
                 }
-                case VisualFont::VeraMono:
-                {
-                    fontpath = "/tmp/VeraMono.ttf";
-                    this->makeTempFontFile (fontpath, __start_veramono_ttf, __stop_veramono_ttf);
-                    break;
+
+                atlas_shelf& s = this->shelves[best];
+                x = s.x;
+                y = s.y;
+                s.x += pw;
+                s.last_use = this->use_tick;
+                return best;
+            }
+
+            //! Double the height of the atlas. Existing pixels keep their place.
+            void grow_atlas()
+            {
+                this->atlas_dims[1] = std::min (this->atlas_dims.y() * 2, this->atlas_max_dim);
+                // Row-major data, so the new rows are simply appended
+                this->atlas_pixels.resize (this->atlas_dims.x() * this->atlas_dims.y(), 0);
+                for (auto& ae : this->atlas_entries) { this->set_uv (this->glchars[ae.first], ae.second); }
+                this->atlas_dirty = true;
+                ++this->generation;
+                if constexpr (debug_visualface == true) {
+                    std::cout << "Glyph atlas grown to " << this->atlas_dims << std::endl;
                 }
-                case VisualFont::VeraMonoBold:
-                {
-                    fontpath = "/tmp/VeraMoBd.ttf";
-                    this->makeTempFontFile (fontpath, __start_veramobd_ttf, __stop_veramobd_ttf);
-                    break;
+            }
+
+            //! Evict the least recently used, unpinned shelf with height >= ph. Return its index or -1
+            int evict_shelf (const int ph)
+            {
+                int lru = -1;
+                for (int i = 0; i < static_cast<int>(this->shelves.size()); ++i) {
+                    const atlas_shelf& s = this->shelves[i];
+                    if (s.pinned || s.h < ph) { continue; }
+                    if (lru == -1 || s.last_use < this->shelves[lru].last_use) { lru = i; }
+                }
+                if (lru == -1) { return -1; }
+
+                auto ai = this->atlas_entries.begin();
+                while (ai != this->atlas_entries.end()) {
+                    if (ai->second.shelf == lru) {
+                        this->glchars.erase (ai->first);
+                        ai = this->atlas_entries.erase (ai);
+                    } else { ++ai; }
+                }
+                atlas_shelf& s = this->shelves[lru];
+                std::fill (this->atlas_pixels.begin() + s.y * this->atlas_dims.x(),
+                           this->atlas_pixels.begin() + (s.y + s.h) * this->atlas_dims.x(), 0);
+                s.x = atlas_padding;
+                this->atlas_dirty = true;
+                ++this->generation;
+                if constexpr (debug_visualface == true) {
+                    std::cout << "Evicted glyph atlas shelf " << lru << std::endl;
                 }
-                case VisualFont::VeraMonoItalic:
-                {
-                    fontpath = "/tmp/VeraMoIt.ttf";
-                    this->makeTempFontFile (fontpath, __start_veramoit_ttf, __stop_veramoit_ttf);
-                    break;
+                return lru;
+            }
+
+            //! Rasterize the glyph for c, add it to the atlas and to glchars.
+            std::map<char32_t, mplot::visgl::CharInfo>::iterator load_glyph (const char32_t c)
+            {
+                mplot::visgl::CharInfo glchar;
+                glchar.textureID = this->atlas_texture;
+
+                // Check glyph index first, if it's 0 the font doesn't have it
+                if (FT_Get_Char_Index (this->face, c) == 0) {
+                    return this->glchars.insert_or_assign (c, glchar).first;
                 }
-                case VisualFont::VeraMonoBoldItalic:
-                {
-                    fontpath = "/tmp/VeraMoBI.ttf";
-                    this->makeTempFontFile (fontpath, __start_veramobi_ttf, __stop_veramobi_ttf);
-                    break;
+#if FREETYPE_MAJOR > 2 || (FREETYPE_MAJOR == 2 && FREETYPE_MINOR >= 11)
+                // A signed distance field is rendered from the glyph's outline, so load it unrendered
+                const bool render_sdf = this->sdf;
+#else
+                constexpr bool render_sdf = false;
+#endif
+                if (FT_Load_Char (this->face, c, render_sdf ? FT_LOAD_DEFAULT : FT_LOAD_RENDER)) {
+                    std::cout << "ERROR::FREETYPE: Failed to load Glyph for Unicode 0x"
+                              << std::hex << static_cast<unsigned int>(c) << std::dec << std::endl;
+                    return this->glchars.insert_or_assign (c, glchar).first;
+                }
+#if FREETYPE_MAJOR > 2 || (FREETYPE_MAJOR == 2 && FREETYPE_MINOR >= 11)
+                // The field's bitmap has a margin of its spread, which the bearing includes, so
+                // the glyph is placed as usual.
+                if (render_sdf && FT_Render_Glyph (this->face->glyph, FT_RENDER_MODE_SDF)) {
+                    std::cout << "ERROR::FREETYPE: Failed to render SDF for Unicode 0x"
+                              << std::hex << static_cast<unsigned int>(c) << std::dec << std::endl;
+                    return this->glchars.insert_or_assign (c, glchar).first;
                 }
-                case VisualFont::VeraSerif:
-                {
-                    fontpath = "/tmp/VeraSe.ttf";
-                    this->makeTempFontFile (fontpath, __start_verase_ttf, __stop_verase_ttf);
-                    break;
+#endif
+
+                const FT_Bitmap& bm = this->face->glyph->bitmap;
+                const int w = static_cast<int>(bm.width);
+                const int h = static_cast<int>(bm.rows);
+                glchar.size = { w, h };
+                glchar.bearing = { this->face->glyph->bitmap_left, this->face->glyph->bitmap_top };
+                glchar.advance = static_cast<unsigned int>(this->face->glyph->advance.x);
+
+                if (w > 0 && h > 0) {
+                    atlas_entry ae;
+                    ae.shelf = this->allocate (w, h, ae.x, ae.y);
+                    if (ae.shelf == -1) {
+                        std::cout << "ERROR::FREETYPE: No room in glyph atlas for Unicode 0x"
+                                  << std::hex << static_cast<unsigned int>(c) << std::dec << std::endl;
+                        // The glyph keeps its metrics, but samples the (empty) padding pixel
+                        glchar.uv = { 0.0f, 0.0f, 0.0f, 0.0f };
+                    } else {
+                        this->atlas_staging.resize (w * h);
+                        for (int r = 0; r < h; ++r) {
+                            const unsigned char* row = bm.buffer + r * bm.pitch;
+                            std::copy (row, row + w, this->atlas_pixels.begin() + (ae.y + r) * this->atlas_dims.x() + ae.x);
+                            std::copy (row, row + w, this->atlas_staging.begin() + r * w);
+                        }
+                        this->set_uv (glchar, ae);
+                        this->atlas_entries[c] = ae;
+                        if (!this->preloading) {
+                            if (this->atlas_dirty) {
+                                this->upload_atlas();
+                                this->atlas_dirty = false;
+                            } else {
+                                this->upload_atlas_region (ae.x, ae.y, w, h);
+                            }
+                        }
+                    }
                 }
-                case VisualFont::VeraSerifBold:
-                {
-                    fontpath = "/tmp/VeraSeBd.ttf";
-                    this->makeTempFontFile (fontpath, __start_verasebd_ttf, __stop_verasebd_ttf);
-                    break;
+
+                if constexpr (debug_visualface == true) {
+                    std::cout << "Inserting character into this->glchars with info: ID:" << glchar.textureID
+                              << ", Size:" << glchar.size << ", Bearing:" << glchar.bearing
+                              << ", Advance:" << glchar.advance << ", uv:" << glchar.uv << std::endl;
                 }
-                default:
-                {
+                return this->glchars.insert_or_assign (c, glchar).first;
+            }
+
+            void init_common (const mplot::VisualFont _font, unsigned int fontpixels, FT_Library& ft_freetype)
+            {
+                // FreeType reads the face straight from the embedded data, which lives as long as
+                // the program, so no font file is written
+                const std::pair<const void*, const void*> ttf = embedded_font (_font);
+                if (ttf.first == nullptr) {
                     std::cout << "ERROR::Unsupported mplot font\n";
-                    break;
+                    return;
                 }
-                }
-#endif // Windows/Non-windows
+                const FT_Byte* ttf_start = static_cast<const FT_Byte*>(ttf.first);
+                const FT_Long ttf_bytes = static_cast<FT_Long>(static_cast<const FT_Byte*>(ttf.second) - ttf_start);
 
                 // Keep the face as a mplot::Visual owned resource, shared by VisTextModels?
                 if constexpr (debug_visualface == true) {
-                    std::cout << "FT_New_Face (ft_freetype, " << fontpath << ", 0, &this->face);\n";
+                    std::cout << "FT_New_Memory_Face (ft_freetype, " << ttf.first << ", " << ttf_bytes << ", 0, &this->face);\n";
                 }
-                if (FT_New_Face (ft_freetype, fontpath.c_str(), 0, &this->face)) {
-                    std::cout << "ERROR::FREETYPE: Failed to load font (font file may be invalid)" << std::endl;
+                if (FT_New_Memory_Face (ft_freetype, ttf_start, ttf_bytes, 0, &this->face)) {
+                    std::cout << "ERROR::FREETYPE: Failed to load font (font data may be invalid)" << std::endl;
+                    return;
                 }
 
                 FT_Set_Pixel_Sizes (this->face, 0, fontpixels);
@@ -389,28 +653,6 @@ namespace mplot {
                 // Can I check this->face for how many glyphs it has? Yes:
                 // std::cout << "This face has " << this->face->num_glyphs << " glyphs.\n";
             }
-
-            //! Create a temporary font file at fontpath, using the embedded data
-            //! starting from filestart and extending to filenend
-            template <typename T = const char>
-            void makeTempFontFile (const std::string& fontpath, T* file_start, T* file_stop)
-            {
-                T* p;
-                if (!mplot::tools::fileExists (fontpath)) {
-                    std::ofstream fout;
-                    fout.open (fontpath.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
-                    if (fout.is_open()) {
-                        for (p = file_start; p < file_stop; p++) { fout << *p; }
-                        fout.close();
-                    } else {
-                        std::cout << "WARNING: Failed to open " << fontpath << "!!\n";
-                    }
-                } else {
-                    if constexpr (debug_visualface == true) {
-                        std::cout << "INFO: " << fontpath << " already exists, no need to re-create it\n";
-                    }
-                }
-            }
         };
     } // namespace gl
 } // namespace mplot
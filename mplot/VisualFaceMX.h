@@ -13,6 +13,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <stdexcept>
+
 #include <mplot/VisualFaceBase.h>
 
 #if defined __gl3_h_ || defined __gl_h_
@@ -21,6 +24,8 @@
 # error "GL headers should have been included already"
 #endif
 
+#include <mplot/gl/util_mx.h>
+
 namespace mplot {
 
     namespace visgl {
@@ -39,69 +44,70 @@ namespace mplot {
              * VisualResources holds a map of VisualFace instances, to avoid many copies
              * of font textures for separate VisualTextModel instances which might have
              * the same pixel size.
+             *
+             * If \a _sdf is true, the atlas holds signed distance fields of the glyphs, from which
+             * text of any size can be drawn.
              */
             VisualFaceMX (const mplot::VisualFont _font, unsigned int fontpixels, FT_Library& ft_freetype,
-                          GladGLContext* glfn = nullptr)
+                          GladGLContext* _glfn = nullptr, const bool _sdf = false)
             {
+                if (_glfn == nullptr) { throw std::runtime_error ("glfn problem"); }
+                this->glfn = _glfn;
+                this->sdf = _sdf;
                 this->init_common (_font, fontpixels, ft_freetype);
 
-                // How far to loop. In principle, up to 21 bits worth - that's 2097151 possible characters!
-                for (char32_t c = 0; c < 2097151; c++) {
-                    // Check glyph index first, if it's 0 it's a blank so skip.
-                    if (FT_Get_Char_Index (this->face, c) == 0) { continue; }
-
-                    // load character glyph
-                    if (FT_Load_Char (this->face, c, FT_LOAD_RENDER)) {
-                        std::cout << "ERROR::FREETYPE: Failed to load Glyph for Unicode 0x"
-                                  << std::hex << static_cast<unsigned int>(c) << std::dec << std::endl;
-                        continue;
-                    }
-
-                    // generate texture
-                    unsigned int texture = 0;
-
-                    if (glfn == nullptr) { throw std::runtime_error ("glfn problem"); }
-                    glfn->GenTextures (1, &texture);
-                    glfn->BindTexture (GL_TEXTURE_2D, texture);
-                    glfn->TexImage2D(
-                        GL_TEXTURE_2D,
-                        0,
-                        GL_RED,
-                        this->face->glyph->bitmap.width,
-                        this->face->glyph->bitmap.rows,
-                        0,
-                        GL_RED,
-                        GL_UNSIGNED_BYTE,
-                        this->face->glyph->bitmap.buffer
-                        );
-                    // set texture options
-                    glfn->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-                    glfn->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-                    glfn->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-                    glfn->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // Could be GL_NEAREST, but doesn't look as good.
-
-                    // now store character for later use
-                    mplot::visgl::CharInfo glchar = {
-                        texture,
-                        {static_cast<int>(this->face->glyph->bitmap.width), static_cast<int>(this->face->glyph->bitmap.rows)}, // size
-                        {this->face->glyph->bitmap_left, this->face->glyph->bitmap_top}, // bearing
-                        static_cast<unsigned int>(this->face->glyph->advance.x)          // advance
-                    };
-
-                    if constexpr (debug_visualface == true) {
-                        std::cout << "Inserting character into this->glchars with info: ID:" << glchar.textureID
-                                  << ", Size:" << glchar.size << ", Bearing:" << glchar.bearing
-                                  << ", Advance:" << glchar.advance << std::endl;
-                    }
-                    this->glchars.insert (std::pair<char32_t, mplot::visgl::CharInfo>(c, glchar));
-                }
-                glfn->BindTexture(GL_TEXTURE_2D, 0);
-
-                // At this point could FT_Done_Face() etc, I think. as we no longer do anything Freetypey with it.
-                FT_Done_Face (this->face);
+                GLint max_tex = 0;
+                this->glfn->GetIntegerv (GL_MAX_TEXTURE_SIZE, &max_tex);
+                if (max_tex > 0) { this->atlas_max_dim = std::min (this->atlas_max_dim, static_cast<int>(max_tex)); }
+                this->init_atlas (fontpixels);
+
+                this->glfn->GenTextures (1, &this->atlas_texture);
+
+                // Rasterize the common characters now. Anything else is loaded on first use.
+                this->preload_latin1();
+            }
+
+            ~VisualFaceMX()
+            {
+                if (this->atlas_texture != 0) { this->glfn->DeleteTextures (1, &this->atlas_texture); }
+            }
+
+            //! The GL function pointers with which the atlas texture is updated
+            GladGLContext* get_glfn() const { return this->glfn; }
+
+            //! Change the GL function pointers, to those of another context in the same share
+            //! group (the atlas texture is shared between the group's contexts)
+            void set_glfn (GladGLContext* _glfn) { this->glfn = _glfn; }
+
+        protected:
+            //! The GL function pointers for the context in which the atlas texture lives
+            GladGLContext* glfn = nullptr;
+
+            //! (Re)allocate the atlas texture from the CPU-side copy of the atlas
+            void upload_atlas() final
+            {
+                this->glfn->BindTexture (GL_TEXTURE_2D, this->atlas_texture);
+                this->glfn->PixelStorei (GL_UNPACK_ALIGNMENT, 1);
+                this->glfn->TexImage2D (GL_TEXTURE_2D, 0, GL_RED, this->atlas_dims.x(), this->atlas_dims.y(),
+                                        0, GL_RED, GL_UNSIGNED_BYTE, this->atlas_pixels.data());
+                // set texture options
+                this->glfn->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                this->glfn->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                this->glfn->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                this->glfn->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // Could be GL_NEAREST, but doesn't look as good.
+                this->glfn->BindTexture (GL_TEXTURE_2D, 0);
+                mplot::gl::Util::checkError (__FILE__, __LINE__, this->glfn);
             }
 
-            ~VisualFaceMX() {}
+            //! Copy a single, newly rasterized glyph into the atlas texture
+            void upload_atlas_region (const int x, const int y, const int w, const int h) final
+            {
+                this->glfn->BindTexture (GL_TEXTURE_2D, this->atlas_texture);
+                this->glfn->PixelStorei (GL_UNPACK_ALIGNMENT, 1);
+                this->glfn->TexSubImage2D (GL_TEXTURE_2D, 0, x, y, w, h, GL_RED, GL_UNSIGNED_BYTE, this->atlas_staging.data());
+                this->glfn->BindTexture (GL_TEXTURE_2D, 0);
+                mplot::gl::Util::checkError (__FILE__, __LINE__, this->glfn);
+            }
         };
     } // namespace gl
 } // namespace mplot
@@ -12,6 +12,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <stdexcept>
+
 #include <mplot/VisualFaceBase.h>
 
 #if defined __gl3_h_ || defined __gl_h_
@@ -20,6 +23,8 @@
 # error "GL headers should have been included already"
 #endif
 
+#include <mplot/gl/util_nomx.h>
+
 namespace mplot {
 
     namespace visgl {
@@ -38,68 +43,58 @@ namespace mplot {
              * VisualResources holds a map of VisualFace instances, to avoid many copies
              * of font textures for separate VisualTextModel instances which might have
              * the same pixel size.
+             *
+             * If \a _sdf is true, the atlas holds signed distance fields of the glyphs, from which
+             * text of any size can be drawn.
              */
-            VisualFaceNoMX (const mplot::VisualFont _font, unsigned int fontpixels, FT_Library& ft_freetype)
+            VisualFaceNoMX (const mplot::VisualFont _font, unsigned int fontpixels, FT_Library& ft_freetype,
+                            const bool _sdf = false)
             {
+                this->sdf = _sdf;
                 this->init_common (_font, fontpixels, ft_freetype);
 
-                // How far to loop. In principle, up to 21 bits worth - that's 2097151 possible characters!
-                for (char32_t c = 0; c < 2097151; c++) {
-                    // Check glyph index first, if it's 0 it's a blank so skip.
-                    if (FT_Get_Char_Index (this->face, c) == 0) { continue; }
-
-                    // load character glyph
-                    if (FT_Load_Char (this->face, c, FT_LOAD_RENDER)) {
-                        std::cout << "ERROR::FREETYPE: Failed to load Glyph for Unicode 0x"
-                                  << std::hex << static_cast<unsigned int>(c) << std::dec << std::endl;
-                        continue;
-                    }
-
-                    // generate texture
-                    unsigned int texture = 0;
-
-                    glGenTextures (1, &texture);
-                    glBindTexture (GL_TEXTURE_2D, texture);
-                    glTexImage2D(
-                        GL_TEXTURE_2D,
-                        0,
-                        GL_RED,
-                        this->face->glyph->bitmap.width,
-                        this->face->glyph->bitmap.rows,
-                        0,
-                        GL_RED,
-                        GL_UNSIGNED_BYTE,
-                        this->face->glyph->bitmap.buffer
-                        );
-                    // set texture options
-                    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-                    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-                    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-                    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // Could be GL_NEAREST, but doesn't look as good.
+                GLint max_tex = 0;
+                glGetIntegerv (GL_MAX_TEXTURE_SIZE, &max_tex);
+                if (max_tex > 0) { this->atlas_max_dim = std::min (this->atlas_max_dim, static_cast<int>(max_tex)); }
+                this->init_atlas (fontpixels);
 
-                    // now store character for later use
-                    mplot::visgl::CharInfo glchar = {
-                        texture,
-                        {static_cast<int>(this->face->glyph->bitmap.width), static_cast<int>(this->face->glyph->bitmap.rows)}, // size
-                        {this->face->glyph->bitmap_left, this->face->glyph->bitmap_top}, // bearing
-                        static_cast<unsigned int>(this->face->glyph->advance.x)          // advance
-                    };
+                glGenTextures (1, &this->atlas_texture);
 
-                    if constexpr (debug_visualface == true) {
-                        std::cout << "Inserting character into this->glchars with info: ID:" << glchar.textureID
-                                  << ", Size:" << glchar.size << ", Bearing:" << glchar.bearing
-                                  << ", Advance:" << glchar.advance << std::endl;
-                    }
-                    this->glchars.insert (std::pair<char32_t, mplot::visgl::CharInfo>(c, glchar));
-                }
+                // Rasterize the common characters now. Anything else is loaded on first use.
+                this->preload_latin1();
+            }
 
-                glBindTexture(GL_TEXTURE_2D, 0);
+            ~VisualFaceNoMX()
+            {
+                if (this->atlas_texture != 0) { glDeleteTextures (1, &this->atlas_texture); }
+            }
 
-                // At this point could FT_Done_Face() etc, I think. as we no longer do anything Freetypey with it.
-                FT_Done_Face (this->face);
+        protected:
+            //! (Re)allocate the atlas texture from the CPU-side copy of the atlas
+            void upload_atlas() final
+            {
+                glBindTexture (GL_TEXTURE_2D, this->atlas_texture);
+                glPixelStorei (GL_UNPACK_ALIGNMENT, 1);
+                glTexImage2D (GL_TEXTURE_2D, 0, GL_RED, this->atlas_dims.x(), this->atlas_dims.y(),
+                              0, GL_RED, GL_UNSIGNED_BYTE, this->atlas_pixels.data());
+                // set texture options
+                glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // Could be GL_NEAREST, but doesn't look as good.
+                glBindTexture (GL_TEXTURE_2D, 0);
+                mplot::gl::Util::checkError (__FILE__, __LINE__);
             }
 
-            ~VisualFaceNoMX() {}
+            //! Copy a single, newly rasterized glyph into the atlas texture
+            void upload_atlas_region (const int x, const int y, const int w, const int h) final
+            {
+                glBindTexture (GL_TEXTURE_2D, this->atlas_texture);
+                glPixelStorei (GL_UNPACK_ALIGNMENT, 1);
+                glTexSubImage2D (GL_TEXTURE_2D, 0, x, y, w, h, GL_RED, GL_UNSIGNED_BYTE, this->atlas_staging.data());
+                glBindTexture (GL_TEXTURE_2D, 0);
+                mplot::gl::Util::checkError (__FILE__, __LINE__);
+            }
         };
     } // namespace gl
 } // namespace mplot
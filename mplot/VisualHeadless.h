@@ -0,0 +1,322 @@
+/*!
+ * \file
+ *
+ * A Visual with no window, for rendering figures on machines without a display (such as GPU
+ * nodes in a cluster). The OpenGL context is a surfaceless EGL context on a GBM render node, as in
+ * mplot::gl::compute_manager_cli. There is no default framebuffer, so the scene is only ever
+ * drawn off-screen, by saveImage (which renders at the Visual's width and height) or by
+ * saveImageOffscreen (which renders at any size, in tiles if necessary). renderBatch renders
+ * many scenes, one after the other, in the one context, with their PNGs encoded on worker
+ * threads.
+ *
+ * Link with EGL and gbm (OpenGL::EGL gbm in CMake). Because it defines mplot::win_t, this header
+ * can't be included in the same translation unit as mplot/Visual.h.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+#pragma once
+
+#include <string>
+#include <future>
+#include <functional>
+#include <cstddef>
+#include <stdexcept>
+
+// EGL and gbm for a headless OpenGL context
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <gbm.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace mplot {
+    // There is no window; VisualBase::window stays nullptr
+    struct headless_window;
+    using win_t = headless_window;
+}
+
+#include <mplot/VisualOwnableMX.h>
+
+namespace mplot {
+
+    /*!
+     * VisualHeadless - an mplot::VisualOwnableMX that owns a windowless EGL context
+     *
+     * Use it as you would mplot::Visual, binding and adding VisualModels, but call saveImage or
+     * saveImageOffscreen instead of keepOpen:
+     *
+     * \code
+     *   mplot::VisualHeadless<> v (7680, 4320, "figure");
+     *   // ...add VisualModels...
+     *   v.saveImage ("figure.png"); // an 8K image
+     * \endcode
+     *
+     * \tparam glver The OpenGL version, encoded as a single int (see mplot::gl::version)
+     */
+    template <int glver = mplot::gl::version_4_1>
+    class VisualHeadless : public mplot::VisualOwnableMX<glver>
+    {
+    public:
+        /*!
+         * Create a headless visualiser that renders images of _width by _height pixels by
+         * default, using the GPU at render_node.
+         */
+        VisualHeadless (const int _width, const int _height, const std::string& _title = "mplot::VisualHeadless",
+                        const bool _version_stdout = true, const std::string& _render_node = "/dev/dri/renderD128")
+            : render_node (_render_node)
+        {
+            this->window_w = _width;
+            this->window_h = _height;
+            this->title = _title;
+            this->options.set (visual_options::versionStdout, _version_stdout);
+            this->options.set (visual_options::renderSwapsBuffers, false);
+
+            this->init_resources();
+            this->init_gl();
+        }
+
+        //! Deconstructor releases the EGL context and the GBM device
+        ~VisualHeadless()
+        {
+            this->setContext();
+            this->delete_frame_target();
+            this->deconstructCommon();
+            eglMakeCurrent (this->egl_dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            if (this->egl_ctx != EGL_NO_CONTEXT) { eglDestroyContext (this->egl_dpy, this->egl_ctx); }
+            if (this->egl_dpy != EGL_NO_DISPLAY) { eglTerminate (this->egl_dpy); }
+            if (this->gbm != nullptr) { gbm_device_destroy (this->gbm); }
+            if (this->drm_fd >= 0) { close (this->drm_fd); }
+        }
+
+        //! Create the EGL context, load GL through it and initialize freetype
+        void init_resources()
+        {
+            mplot::VisualResourcesMX<glver>::i().create();
+            {
+                mplot::startup_profile::scope startup_phase (this->startup, "window");
+                this->init_context();
+            }
+            this->setContext();
+            this->init_glad (eglGetProcAddress);
+            if (this->glfn == nullptr) { throw std::runtime_error ("Failed to load GL for headless Visual"); }
+            this->freetype_init();
+            this->releaseContext();
+        }
+
+        void setContext() final
+        {
+            if (eglGetCurrentContext() == this->egl_ctx) { return; } // current already
+            if (eglMakeCurrent (this->egl_dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, this->egl_ctx) == EGL_FALSE) {
+                throw std::runtime_error ("Failed to eglMakeCurrent for headless Visual");
+            }
+        }
+
+        void releaseContext() final
+        {
+            if (eglGetCurrentContext() != EGL_NO_CONTEXT) { eglMakeCurrent (this->egl_dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT); }
+        }
+
+        //! Render the scene at the Visual's width and height into an off-screen framebuffer and save it to img_filename
+        sm::vec<int, 2> saveImage (const std::string& img_filename, const bool transparent_bg = false)
+        {
+            return this->saveImageOffscreen (img_filename, { this->window_w, this->window_h }, transparent_bg);
+        }
+
+        /*!
+         * There is no window to read back from asynchronously, so this renders and saves the
+         * image as saveImage does, and returns a future that is already ready.
+         */
+        std::future<sm::vec<int, 2>> saveImageAsync (const std::string& img_filename, const bool transparent_bg = false)
+        {
+            std::promise<sm::vec<int, 2>> p;
+            p.set_value (this->saveImage (img_filename, transparent_bg));
+            return p.get_future();
+        }
+
+        /*!
+         * Render the scene into an off-screen framebuffer of the Visual's width and height. The
+         * framebuffer is kept for the next call, so that the scene can be rendered frame after
+         * frame, as it would be in a window (to benchmark it, say). If finish is true, wait until
+         * the GPU has drawn the frame.
+         */
+        void renderFrame (const bool finish = false)
+        {
+            this->setContext();
+            if (this->frame_fbo == 0 || this->frame_dims[0] != this->window_w || this->frame_dims[1] != this->window_h) {
+                this->delete_frame_target();
+                this->frame_dims = { this->window_w, this->window_h };
+                this->glfn->GenFramebuffers (1, &this->frame_fbo);
+                this->glfn->GenRenderbuffers (2, this->frame_rbo);
+                this->glfn->BindRenderbuffer (GL_RENDERBUFFER, this->frame_rbo[0]);
+                this->glfn->RenderbufferStorage (GL_RENDERBUFFER, GL_RGBA8, this->frame_dims[0], this->frame_dims[1]);
+                this->glfn->BindRenderbuffer (GL_RENDERBUFFER, this->frame_rbo[1]);
+                this->glfn->RenderbufferStorage (GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, this->frame_dims[0], this->frame_dims[1]);
+                this->glfn->BindRenderbuffer (GL_RENDERBUFFER, 0);
+                this->glfn->BindFramebuffer (GL_FRAMEBUFFER, this->frame_fbo);
+                this->glfn->FramebufferRenderbuffer (GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->frame_rbo[0]);
+                this->glfn->FramebufferRenderbuffer (GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, this->frame_rbo[1]);
+                if (this->glfn->CheckFramebufferStatus (GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+                    this->delete_frame_target();
+                    throw std::runtime_error ("VisualHeadless::renderFrame: Failed to make the framebuffer");
+                }
+            }
+            this->glfn->BindFramebuffer (GL_FRAMEBUFFER, this->frame_fbo);
+            this->render();
+            if (finish) { this->glfn->Finish(); }
+            this->glfn->BindFramebuffer (GL_FRAMEBUFFER, 0);
+        }
+
+        /*!
+         * Render n scenes into PNG files, keeping this Visual's context, its shaders and its
+         * font faces and glyphs from one scene to the next. For scene i, the models of the last
+         * scene are removed and build_scene (*this, i) adds the models of the new one (and sets
+         * its view, size and colours as it needs). The frame is rendered with renderFrame and
+         * read back through a pixel pack buffer while the next scene is built, and its PNG is
+         * written to ro.file_prefix + i + ".png" by a pool of ro.encoder_threads encoders.
+         * No scene is dropped: if ro.queue_capacity frames are waiting for the encoders, the
+         * next frame waits for them. Returns once every PNG is written, with the stats of the
+         * batch. Throws if the Visual is already recording.
+         *
+         * \code
+         *   mplot::VisualHeadless<> v (1024, 768, "batch", false);
+         *   mplot::recording_options ro;
+         *   ro.file_prefix = "./figs/fig"; // fig00000.png, fig00001.png, ...
+         *   ro.encoder_threads = 4;
+         *   v.renderBatch (params.size(), [&params](mplot::VisualHeadless<>& hv, std::size_t i) {
+         *       auto gv = std::make_unique<mplot::GraphVisual<double>> (sm::vec<float>{0,0,0});
+         *       hv.bindmodel (gv);
+         *       gv->setdata (x, model (params[i]));
+         *       gv->finalize();
+         *       hv.addVisualModel (gv);
+         *   }, ro);
+         * \endcode
+         */
+        mplot::recording_stats renderBatch (const std::size_t n,
+                                            const std::function<void(VisualHeadless<glver>&, std::size_t)>& build_scene,
+                                            const mplot::recording_options& ro = {})
+        {
+            if (this->recorder) { throw std::runtime_error ("VisualHeadless::renderBatch: already recording"); }
+            mplot::recording_options bro = ro;
+            bro.raw_stream = nullptr;
+            bro.wait_when_full = true;
+            this->startRecording (bro);
+            try {
+                for (std::size_t i = 0; i < n; ++i) {
+                    this->setContext();
+                    this->clearVisualModels();
+                    build_scene (*this, i);
+                    // render() reads the frame into the capture ring for the recorder
+                    this->renderFrame();
+                }
+            } catch (...) {
+                this->stopRecording();
+                throw;
+            }
+            return this->stopRecording();
+        }
+
+        //! Set up the passed-in VisualModel with functions that need access to Visual attributes.
+        template <typename T>
+        void bindmodel (std::unique_ptr<T>& model)
+        {
+            mplot::VisualBase<glver>::template bindmodel<T> (model); // base class binds
+            model->setContext = &mplot::VisualBase<glver>::set_context;
+            model->releaseContext = &mplot::VisualBase<glver>::release_context;
+            model->get_glfn = &mplot::VisualOwnableMX<glver>::get_glfn;
+        }
+
+        template <typename T>
+        void bindextra (std::unique_ptr<T>& model)
+        {
+            model->setContext = &mplot::VisualBase<glver>::set_context;
+            model->releaseContext = &mplot::VisualBase<glver>::release_context;
+            model->get_glfn = &mplot::VisualOwnableMX<glver>::get_glfn;
+        }
+
+        //! Bind the coordArrows and title text, when they are made, to this Visual's context
+        void bind_overlays() override
+        {
+            if (this->coordArrows != nullptr) { this->bindextra (this->coordArrows); }
+            if (this->textModel != nullptr) { this->bindextra (this->textModel); }
+        }
+
+    protected:
+        //! Open the render node and create a surfaceless EGL context of the version glver on it
+        void init_context()
+        {
+            this->drm_fd = open (this->render_node.c_str(), O_RDWR);
+            if (this->drm_fd < 0) {
+                throw std::runtime_error ("Failed to open " + this->render_node + " for headless Visual");
+            }
+            this->gbm = gbm_create_device (this->drm_fd);
+            if (this->gbm == nullptr) {
+                throw std::runtime_error ("Failed to gbm_create_device for headless Visual");
+            }
+            this->egl_dpy = eglGetPlatformDisplay (EGL_PLATFORM_GBM_MESA, this->gbm, NULL);
+            if (this->egl_dpy == EGL_NO_DISPLAY) {
+                throw std::runtime_error ("Failed to eglGetPlatformDisplay for headless Visual");
+            }
+            if (eglInitialize (this->egl_dpy, NULL, NULL) == EGL_FALSE) {
+                throw std::runtime_error ("Failed to eglInitialize display for headless Visual");
+            }
+            const char* egl_extension_st = eglQueryString (this->egl_dpy, EGL_EXTENSIONS);
+            if (egl_extension_st == nullptr || std::string(egl_extension_st).find ("EGL_KHR_surfaceless_context") == std::string::npos) {
+                throw std::runtime_error ("EGL display does not support EGL_KHR_surfaceless_context");
+            }
+
+            constexpr bool es = mplot::gl::version::gles (glver);
+            const EGLint config_attribs[] = {
+                EGL_RENDERABLE_TYPE, es ? EGL_OPENGL_ES3_BIT_KHR : EGL_OPENGL_BIT,
+                EGL_NONE
+            };
+            EGLConfig cfg;
+            EGLint count = 0;
+            if (eglChooseConfig (this->egl_dpy, config_attribs, &cfg, 1, &count) == EGL_FALSE || count < 1) {
+                throw std::runtime_error ("Failed to eglChooseConfig for headless Visual");
+            }
+            if (eglBindAPI (es ? EGL_OPENGL_ES_API : EGL_OPENGL_API) == EGL_FALSE) {
+                throw std::runtime_error ("Failed to eglBindAPI for headless Visual");
+            }
+            const EGLint ctx_attribs[] = {
+                EGL_CONTEXT_MAJOR_VERSION, mplot::gl::version::major (glver),
+                EGL_CONTEXT_MINOR_VERSION, mplot::gl::version::minor (glver),
+                EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                mplot::gl::version::compat (glver) ? EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT : EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                EGL_NONE
+            };
+            // The profile mask does not apply to OpenGL ES, so stop the attribute list before it
+            const EGLint es_ctx_attribs[] = {
+                EGL_CONTEXT_MAJOR_VERSION, mplot::gl::version::major (glver),
+                EGL_CONTEXT_MINOR_VERSION, mplot::gl::version::minor (glver),
+                EGL_NONE
+            };
+            this->egl_ctx = eglCreateContext (this->egl_dpy, cfg, EGL_NO_CONTEXT, es ? es_ctx_attribs : ctx_attribs);
+            if (this->egl_ctx == EGL_NO_CONTEXT) {
+                throw std::runtime_error ("Failed to eglCreateContext for headless Visual");
+            }
+        }
+
+        void delete_frame_target()
+        {
+            if (this->frame_fbo != 0) { this->glfn->DeleteFramebuffers (1, &this->frame_fbo); }
+            if (this->frame_rbo[0] != 0) { this->glfn->DeleteRenderbuffers (2, this->frame_rbo); }
+            this->frame_fbo = 0;
+            this->frame_rbo[0] = 0;
+            this->frame_rbo[1] = 0;
+        }
+
+        //! The framebuffer that renderFrame draws into, with its colour and depth renderbuffers
+        GLuint frame_fbo = 0;
+        GLuint frame_rbo[2] = { 0, 0 };
+        sm::vec<int, 2> frame_dims = { 0, 0 };
+
+        //! The DRM render node that the context is created on
+        std::string render_node;
+        int drm_fd = -1;
+        struct gbm_device* gbm = nullptr;
+        EGLDisplay egl_dpy = EGL_NO_DISPLAY;
+        EGLContext egl_ctx = EGL_NO_CONTEXT;
+    };
+
+} // namespace mplot
@@ -69,15 +69,32 @@ namespace mplot {
 
             this->init_resources();
             this->init_gl();
+        }
+
+        /*!
+         * Construct a new visualiser whose window shares its OpenGL context with that of
+         * _share. Font faces and their glyph atlas textures are then created once for the
+         * whole share group, rather than once per window. (Vertex arrays are not shared between
+         * contexts, so each VisualModel still belongs to the one Visual that it was added to.)
+         */
+        VisualMX (const int _width, const int _height, const std::string& _title,
+               VisualMX<glver>& _share, const bool _version_stdout = true)
+        {
+            this->window_w = _width;
+            this->window_h = _height;
+            this->title = _title;
+            this->options.set (visual_options::versionStdout, _version_stdout);
+            this->context_share = &_share;
 
-            // Special tasks: re-bind coordArrows and title text
-            this->bindextra (this->coordArrows);
-            this->bindextra (this->textModel);
+            this->init_resources();
+            this->init_gl();
         }
 
         //! Deconstructor destroys GLFW/Qt window and deregisters access to VisualResources
         ~VisualMX()
         {
+            // The worker finishes its queued uploads first, as the models' vertices still exist
+            this->setUploadWorker (false);
             this->setContext();
             glfwDestroyWindow (this->window);
             this->deconstructCommon();
@@ -88,12 +105,19 @@ namespace mplot {
         // happen, and lastly initializes the freetype code.
         void init_resources()
         {
-            mplot::VisualGlfw<glver>::i().init(); // Init GLFW windows system
+            {
+                mplot::startup_profile::scope startup_phase (this->startup, "glfwInit");
+                mplot::VisualGlfw<glver>::i().init(); // Init GLFW windows system
+            }
             // VisualResources provides font management. Ensure it exists in memory.
             mplot::VisualResourcesMX<glver>::i().create();
             // Set up the window that will present the OpenGL graphics.  This has to
             // happen BEFORE the call to VisualResources::freetype_init()
-            this->init_window();
+            {
+                // init_window also loads GL, which is timed as a phase of its own ("GLAD")
+                mplot::startup_profile::scope startup_phase (this->startup, "window");
+                this->init_window();
+            }
             this->setContext(); // For freetype_init
             this->freetype_init();
             this->releaseContext();
@@ -106,8 +130,13 @@ namespace mplot {
         }
 
         //! Make this Visual the current one, so that when creating/adding a visual model, the vao
-        //! ids relate to the correct OpenGL context.
-        void setContext() final { glfwMakeContextCurrent (this->window); }
+        //! ids relate to the correct OpenGL context. glfwGetCurrentContext only reads a thread
+        //! local, so glfwMakeContextCurrent (a round trip to the driver) is skipped if this
+        //! Visual's context is current already.
+        void setContext() final
+        {
+            if (glfwGetCurrentContext() != this->window) { glfwMakeContextCurrent (this->window); }
+        }
 
         //! swapBuffers implementation for glfw
         void swapBuffers() final { glfwSwapBuffers (this->window); }
@@ -139,7 +168,10 @@ namespace mplot {
         }
 
         //! Release the OpenGL context
-        void releaseContext() final { glfwMakeContextCurrent (nullptr); }
+        void releaseContext() final
+        {
+            if (glfwGetCurrentContext() != nullptr) { glfwMakeContextCurrent (nullptr); }
+        }
 
         /*!
          * \brief OpenGL context check
@@ -157,6 +189,22 @@ namespace mplot {
         //! Obtain the window pointer
         win_t* getWindow() { return this->window; }
 
+        /*!
+         * If false, input callbacks that change the scene only request a redraw (see
+         * requestRedraw), rather than rendering straight away. A loop that drives several
+         * windows (see mplot::VisualManager) clears this, so that each window is rendered only
+         * from the loop. Cursor motion always only requests a redraw, as the drag it makes is
+         * applied once per frame (see VisualBase::apply_pointer_motion).
+         */
+        bool render_in_callbacks = true;
+
+        /*!
+         * If true, input callbacks hold the context mutex (see lockContext) while they change
+         * the scene, so that another thread can render the window. Set by
+         * mplot::VisualManager::run_threaded().
+         */
+        bool lock_in_callbacks = false;
+
         /*!
          * Set up the passed-in VisualModel (or indeed, VisualTextModel) with functions that need access to Visual attributes.
          */
@@ -167,6 +215,9 @@ namespace mplot {
             model->setContext = &mplot::VisualBase<glver>::set_context;
             model->releaseContext = &mplot::VisualBase<glver>::release_context;
             model->get_glfn = &mplot::VisualOwnableMX<glver>::get_glfn;
+            if constexpr (requires { model->get_upload_worker; }) {
+                model->get_upload_worker = &mplot::VisualMX<glver>::get_upload_worker;
+            }
         }
 
         template <typename T>
@@ -177,6 +228,55 @@ namespace mplot {
             model->get_glfn = &mplot::VisualOwnableMX<glver>::get_glfn;
         }
 
+        /*!
+         * Fill the vertex buffers of large models on a worker thread, in a hidden window whose
+         * context shares this window's objects (see mplot/gl/upload_worker_mx.h). A model whose
+         * full upload (after finalize, finalize_async or reinit_async) is at least min_bytes is
+         * then uploaded without holding up render(); it goes on drawing its old buffers (or
+         * nothing, the first time) until a fence shows that the new ones are ready. Streaming,
+         * compact, batched, instanced and shared models are still uploaded by the render thread.
+         * Pass false to finish the queued uploads and stop the worker.
+         */
+        void setUploadWorker (const bool enable, const std::size_t min_bytes = std::size_t{16} << 20)
+        {
+            if (!enable) {
+                this->upload_worker.reset();
+                if (this->upload_window != nullptr) {
+                    glfwDestroyWindow (this->upload_window);
+                    this->upload_window = nullptr;
+                }
+                return;
+            }
+            if (this->upload_worker == nullptr) {
+                // The hidden window is created here, on the main thread, as GLFW requires
+                glfwWindowHint (GLFW_VISIBLE, GLFW_FALSE);
+                this->upload_window = glfwCreateWindow (1, 1, "upload worker", nullptr, this->window);
+                glfwWindowHint (GLFW_VISIBLE, GLFW_TRUE);
+                if (this->upload_window == nullptr) { throw std::runtime_error ("VisualMX::setUploadWorker: Failed to create the worker's context"); }
+                GLFWwindow* w = this->upload_window;
+                this->upload_worker = std::make_unique<mplot::gl::upload_worker> ([w]() { glfwMakeContextCurrent (w); },
+                                                                                  []() { glfwMakeContextCurrent (nullptr); },
+                                                                                  glfwGetProcAddress);
+            }
+            this->upload_worker->min_bytes = min_bytes;
+        }
+
+        //! The upload worker, if setUploadWorker has started one, with its counts of jobs and bytes
+        const mplot::gl::upload_worker* getUploadWorker() const { return this->upload_worker.get(); }
+
+        //! The callback given to models (see VisualModelImpl::get_upload_worker)
+        static mplot::gl::upload_worker* get_upload_worker (mplot::VisualBase<glver>* _v)
+        {
+            return static_cast<mplot::VisualMX<glver>*>(_v)->upload_worker.get();
+        }
+
+        //! Bind the coordArrows and title text, when they are made, to this Visual's context
+        void bind_overlays() override
+        {
+            if (this->coordArrows != nullptr) { this->bindextra (this->coordArrows); }
+            if (this->textModel != nullptr) { this->bindextra (this->textModel); }
+        }
+
         /*
          * A note on setContext() in keepOpen/poll/waitevents/wait:
          *
@@ -188,14 +288,14 @@ namespace mplot {
 
         /*!
          * Keep on rendering until readToFinish is set true. Used to keep a window open, and
-         * responsive, while displaying the result of a simulation. FIXME: This won't work for two
-         * or more windows because it will block.
+         * responsive, while displaying the result of a simulation. This blocks on the one
+         * window; to drive two or more windows, use mplot::VisualManager.
          */
         void keepOpen()
         {
+            this->requestRedraw();
             while (this->state.test (visual_state::readyToFinish) == false) {
-                glfwWaitEventsTimeout (0.01667); // 16.67 ms ~ 60 Hz
-                this->render();
+                this->render_and_wait();
             }
         }
 
@@ -206,12 +306,51 @@ namespace mplot {
         void pauseOpen()
         {
             this->state.set (visual_state::paused);
+            this->requestRedraw();
             while (this->state.test (visual_state::paused) == true && this->state.test (visual_state::readyToFinish) == false) {
-                glfwWaitEventsTimeout (0.01667); // 16.67 ms ~ 60 Hz
-                this->render();
+                this->render_and_wait();
+            }
+        }
+
+        /*!
+         * Run the tasks given to spawn() (see mplot/frame_tasks.h) until they have all returned
+         * or the user signals readyToFinish. Each pass resumes the tasks that are ready, renders
+         * at each frame tick if the scene has changed (or on every tick, without
+         * visual_options::renderOnDemand), resumes the tasks waiting for that frame, and then
+         * waits for events until a task next needs waking. Tasks that have not returned when the
+         * window closes stay suspended; tasks.clear() destroys them.
+         */
+        void runTasks()
+        {
+            this->requestRedraw();
+            while (!this->tasks.empty() && this->state.test (visual_state::readyToFinish) == false) {
+                this->tasks.resume_woken();
+                if (this->tasks.frame_due()) {
+                    const bool rendered = this->needs_render || !this->options.test (visual_options::renderOnDemand);
+                    if (rendered) { this->render(); }
+                    this->tasks.frame_done (rendered);
+                }
+                const double w = this->tasks.wait_s();
+                if (w == 0.0) {
+                    glfwPollEvents();
+                } else if (w > 0.0) {
+                    glfwWaitEventsTimeout (w);
+                } else {
+                    glfwWaitEvents();
+                }
             }
         }
 
+        /*!
+         * Flag that the scene needs to be rendered, and wake up keepOpen() or pauseOpen() if
+         * they are waiting for events.
+         */
+        void requestRedraw() override
+        {
+            const bool was_needed = this->needs_render.exchange (true);
+            if (!was_needed && this->window != nullptr) { glfwPostEmptyEvent(); }
+        }
+
         //! Wrapper around the glfw polling function
         void poll() { glfwPollEvents(); }
         //! A wait-for-events with a timeout wrapper
@@ -231,9 +370,28 @@ namespace mplot {
 
     private:
 
+        /*!
+         * One pass of the keepOpen()/pauseOpen() loop. Render if the scene has changed, then
+         * block until there are events to process. Without visual_options::renderOnDemand,
+         * render on every pass and wait no more than 16.67 ms (~60 Hz).
+         */
+        void render_and_wait()
+        {
+            if (this->options.test (visual_options::renderOnDemand) == true) {
+                if (this->needs_render) { this->render(); }
+                glfwWaitEvents();
+            } else {
+                this->render();
+                glfwWaitEventsTimeout (0.01667); // 16.67 ms ~ 60 Hz
+            }
+        }
+
         void init_window()
         {
-            this->window = glfwCreateWindow (this->window_w, this->window_h, this->title.c_str(), NULL, NULL);
+            // A window created with a share window shares its context's objects (see context_share)
+            GLFWwindow* share_win = nullptr;
+            if (this->context_share != nullptr) { share_win = static_cast<VisualMX<glver>*>(this->context_share)->getWindow(); }
+            this->window = glfwCreateWindow (this->window_w, this->window_h, this->title.c_str(), NULL, share_win);
             if (!this->window) {
                 // Window or OpenGL context creation failed
                 throw std::runtime_error("GLFW window creation failed!");
@@ -248,6 +406,7 @@ namespace mplot {
             glfwSetWindowSizeCallback (this->window, window_size_callback_dispatch);
             glfwSetWindowCloseCallback (this->window, window_close_callback_dispatch);
             glfwSetScrollCallback (this->window, scroll_callback_dispatch);
+            glfwSetWindowRefreshCallback (this->window, window_refresh_callback_dispatch);
 
             glfwMakeContextCurrent (this->window);
 
@@ -258,35 +417,65 @@ namespace mplot {
         //! Context mutex to prevent contexts being acquired in a non-threadsafe manner.
         std::mutex context_mutex;
 
+        //! The thread that fills large models' buffers (see setUploadWorker)
+        std::unique_ptr<mplot::gl::upload_worker> upload_worker;
+        //! The hidden window that holds the upload worker's context
+        GLFWwindow* upload_window = nullptr;
+
+        //! The context mutex, locked if lock_in_callbacks
+        std::unique_lock<std::mutex> callback_lock()
+        {
+            if (this->lock_in_callbacks) { return std::unique_lock<std::mutex> (this->context_mutex); }
+            return std::unique_lock<std::mutex>{};
+        }
+
+        //! Render now, from an input callback, or (if !render_in_callbacks) leave it to the loop
+        void callback_render()
+        {
+            if (this->render_in_callbacks) { this->render(); } else { this->requestRedraw(); }
+        }
+
         /*
          * GLFW callback dispatch functions
          */
         static void key_callback_dispatch (GLFWwindow* _window, int key, int scancode, int action, int mods)
         {
             VisualMX<glver>* self = static_cast<VisualMX<glver>*>(glfwGetWindowUserPointer (_window));
+            auto lk = self->callback_lock();
             if (self->key_callback (key, scancode, action, mods)) {
-                self->render();
+                self->callback_render();
             }
         }
         static void mouse_button_callback_dispatch (GLFWwindow* _window, int button, int action, int mods)
         {
             VisualMX<glver>* self = static_cast<VisualMX<glver>*>(glfwGetWindowUserPointer (_window));
+            auto lk = self->callback_lock();
             self->mouse_button_callback (button, action, mods);
+            self->requestRedraw();
         }
         static void cursor_position_callback_dispatch (GLFWwindow* _window, double x, double y)
         {
             VisualMX<glver>* self = static_cast<VisualMX<glver>*>(glfwGetWindowUserPointer (_window));
+            auto lk = self->callback_lock();
+            // A drag is applied (and drawn) once per frame, however fast the mouse reports
             if (self->cursor_position_callback (x, y)) {
-                self->render();
+                self->requestRedraw();
             }
         }
         static void window_size_callback_dispatch (GLFWwindow* _window, int width, int height)
         {
             VisualMX<glver>* self = static_cast<VisualMX<glver>*>(glfwGetWindowUserPointer (_window));
+            auto lk = self->callback_lock();
             if (self->window_size_callback (width, height)) {
-                self->render();
+                self->callback_render();
             }
         }
+        static void window_refresh_callback_dispatch (GLFWwindow* _window)
+        {
+            // The window system has damaged the window contents
+            VisualMX<glver>* self = static_cast<VisualMX<glver>*>(glfwGetWindowUserPointer (_window));
+            self->requestRedraw();
+        }
         static void window_close_callback_dispatch (GLFWwindow* _window)
         {
             VisualMX<glver>* self = static_cast<VisualMX<glver>*>(glfwGetWindowUserPointer (_window));
@@ -295,8 +484,9 @@ namespace mplot {
         static void scroll_callback_dispatch (GLFWwindow* _window, double xoffset, double yoffset)
         {
             VisualMX<glver>* self = static_cast<VisualMX<glver>*>(glfwGetWindowUserPointer (_window));
+            auto lk = self->callback_lock();
             if (self->scroll_callback (xoffset, yoffset)) {
-                self->render();
+                self->callback_render();
             }
         }
 
@@ -0,0 +1,172 @@
+/*!
+ * \file
+ *
+ * A manager for several mplot::Visual windows, which drives them all from one event loop.
+ * VisualMX::keepOpen() blocks on its own window, so a program with several windows would
+ * otherwise have to call render() on each in turn, and each buffer swap could wait for a vertical
+ * refresh, dividing the frame rate by the number of windows.
+ *
+ * The manager renders only the windows whose scenes have changed (see
+ * VisualBase::requestRedraw), or every window on each pass for those without
+ * visual_options::renderOnDemand. In run() and step(), just one window (paced_window) keeps
+ * vertical sync, with a swap interval of 1, so that the loop as a whole runs at the display's
+ * refresh rate; the others swap immediately. run_threaded() instead renders each window on its
+ * own thread, in its own context, each synced to the refresh.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <utility>
+#include <mplot/Visual.h>
+
+namespace mplot {
+
+    //! V is the type of the windows, which is mplot::Visual or another class derived from mplot::VisualMX
+    template <typename V = mplot::Visual<>>
+    class VisualManager
+    {
+    public:
+        //! Create a window, owned by the manager, with the arguments of a V constructor
+        template <typename... A>
+        V& emplace (A&&... args)
+        {
+            this->owned.push_back (std::make_unique<V> (std::forward<A>(args)...));
+            this->add (*this->owned.back());
+            return *this->owned.back();
+        }
+
+        //! Manage an existing window, which must outlive the manager's loop
+        void add (V& v)
+        {
+            v.render_in_callbacks = false;
+            this->windows.push_back (&v);
+            this->swap_intervals_set = false;
+        }
+
+        //! The number of windows
+        std::size_t size() const { return this->windows.size(); }
+
+        //! Window i
+        V& operator[] (const std::size_t i) { return *this->windows.at (i); }
+
+        //! The window that keeps vertical sync in run() and step()
+        std::size_t paced_window = 0;
+
+        //! If true, finished() is true once any window is ready to finish; otherwise, once all are
+        bool finish_on_any = false;
+
+        //! True if the windows are ready to finish (see finish_on_any)
+        bool finished() const
+        {
+            if (this->windows.empty()) { return true; }
+            std::size_t n_finished = 0;
+            for (const V* v : this->windows) { if (v->readyToFinish()) { ++n_finished; } }
+            return this->finish_on_any ? n_finished > 0 : n_finished == this->windows.size();
+        }
+
+        /*!
+         * One pass of the loop: render each window that needs it, then process events. If the
+         * paced window was rendered, its buffer swap has already waited for the refresh, so
+         * events are only polled; otherwise the pass waits for events (for up to a frame if any
+         * window renders continuously).
+         */
+        void step()
+        {
+            this->set_swap_intervals();
+            bool paced_rendered = false;
+            bool continuous = false;
+            for (std::size_t i = 0; i < this->windows.size(); ++i) {
+                V* v = this->windows[i];
+                if (v->readyToFinish()) { continue; }
+                const bool on_demand = v->options.test (visual_options::renderOnDemand);
+                if (!on_demand) { continuous = true; }
+                if (v->needs_render || !on_demand) {
+                    v->render();
+                    if (i == this->paced_window) { paced_rendered = true; }
+                }
+            }
+            if (paced_rendered) {
+                glfwPollEvents();
+            } else if (continuous) {
+                glfwWaitEventsTimeout (frame_period);
+            } else {
+                glfwWaitEvents();
+            }
+        }
+
+        //! Run the single threaded loop until finished()
+        void run()
+        {
+            for (V* v : this->windows) { v->requestRedraw(); }
+            while (!this->finished()) { this->step(); }
+        }
+
+        /*!
+         * Render each window on its own thread until finished(). Events are processed on this
+         * (the main) thread, and input callbacks hold each window's context mutex while they
+         * change its scene. Code that changes a window's models while this runs (from another
+         * thread) must hold the window's context with lockContext() and unlockContext().
+         */
+        void run_threaded()
+        {
+            // The contexts are made current on the render threads, so none may be current here
+            glfwMakeContextCurrent (nullptr);
+            std::atomic<bool> stop = false;
+            std::vector<std::thread> threads;
+            for (V* v : this->windows) {
+                v->lock_in_callbacks = true;
+                v->requestRedraw();
+                threads.emplace_back ([v, &stop]() {
+                    v->lockContext();
+                    glfwSwapInterval (1);
+                    v->unlockContext();
+                    while (!stop && !v->readyToFinish()) {
+                        if (v->needs_render || !v->options.test (visual_options::renderOnDemand)) {
+                            v->lockContext();
+                            v->render();
+                            v->unlockContext();
+                        } else {
+                            std::this_thread::sleep_for (std::chrono::milliseconds (1));
+                        }
+                    }
+                });
+            }
+            while (!this->finished()) { glfwWaitEventsTimeout (frame_period); }
+            stop = true;
+            for (auto& t : threads) { t.join(); }
+            for (V* v : this->windows) { v->lock_in_callbacks = false; }
+            this->swap_intervals_set = false;
+        }
+
+        //! The longest wait for events, in seconds, when a window renders continuously
+        static constexpr double frame_period = 1.0 / 60.0;
+
+    private:
+        //! Give the paced window a swap interval of 1 and the others 0
+        void set_swap_intervals()
+        {
+            if (this->swap_intervals_set) { return; }
+            for (std::size_t i = 0; i < this->windows.size(); ++i) {
+                this->windows[i]->setContext();
+                glfwSwapInterval (i == this->paced_window ? 1 : 0);
+            }
+            this->swap_intervals_set = true;
+        }
+
+        //! The windows, in the order in which they were added
+        std::vector<V*> windows;
+        //! The windows created with emplace
+        std::vector<std::unique_ptr<V>> owned;
+        bool swap_intervals_set = false;
+    };
+
+} // namespace mplot
@@ -47,3 +47,15 @@ namespace mplot {
     };
 
 } // namespace mplot
+
+#if defined MPLOT_CORE && defined GLAD_OPTION_GL_MX
+// Instantiated once, in the compiled mplot_core library (see core/visual.cpp)
+namespace mplot {
+    extern template struct VisualModelBase<mplot::gl::version_4_1>;
+    extern template struct VisualModelBase<mplot::gl::version_4_5>;
+    extern template struct VisualModelImpl<mplot::gl::version_4_1, 1>;
+    extern template struct VisualModelImpl<mplot::gl::version_4_5, 1>;
+    extern template struct VisualModel<mplot::gl::version_4_1>;
+    extern template struct VisualModel<mplot::gl::version_4_5>;
+} // namespace mplot
+#endif
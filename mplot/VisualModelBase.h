@@ -26,9 +26,19 @@
 #include <string>
 #include <memory>
 #include <functional>
+#include <future>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <cmath>
+#include <cstring>
+#include <limits>
 #include <bitset>
+#include <bit>
+#include <ostream>
+#include <utility>
+#include <span>
+#include <stdexcept>
 
 #include <mplot/gl/version.h>
 
@@ -43,6 +53,20 @@
 
 #include <mplot/VisualCommon.h>
 #include <mplot/colour.h>
+#include <mplot/unit_meshes.h>
+#include <mplot/glb_file.h>
+#include <mplot/gltf_pack.h>
+#include <mplot/glb_animation.h>
+#include <mplot/geometry_cache.h>
+#include <mplot/upload_stats.h>
+#include <mplot/datum_format.h>
+#include <mplot/volume_bricks.h>
+#include <mplot/screen_rect.h>
+#include <mplot/label_declutter.h>
+#include <mplot/trace.h>
+#include <mplot/memory_report.h>
+#include <mplot/startup_profile.h>
+#include <mplot/tessellation.h>
 
 namespace mplot {
 
@@ -83,6 +107,19 @@ namespace mplot {
             this->model_scaling.setToIdentity();
         }
 
+        //! Leave the transform hierarchy: the children are left with no parent
+        virtual ~VisualModelBase()
+        {
+            if (this->parent_model != nullptr) {
+                auto& sibs = this->parent_model->child_models;
+                sibs.erase (std::remove (sibs.begin(), sibs.end(), this), sibs.end());
+            }
+            for (auto c : this->child_models) {
+                c->parent_model = nullptr;
+                c->transform_changed();
+            }
+        }
+
         /*!
          * Set up the passed-in VisualTextModel with functions that need access to the parent Visual attributes.
          */
@@ -96,6 +133,19 @@ namespace mplot {
             model->get_shaderprogs = &mplot::VisualBase<glver>::get_shaderprogs;
             model->get_gprog = &mplot::VisualBase<glver>::get_gprog;
             model->get_tprog = &mplot::VisualBase<glver>::get_tprog;
+            model->get_gprog_uniforms = &mplot::VisualBase<glver>::get_gprog_uniforms;
+            model->get_tprog_uniforms = &mplot::VisualBase<glver>::get_tprog_uniforms;
+            model->get_render_state = &mplot::VisualBase<glver>::get_render_state;
+            // Only text models have storage to recycle
+            if constexpr (requires { model->get_text_pool; }) {
+                model->get_text_pool = &mplot::VisualBase<glver>::get_text_pool;
+            }
+            // ...and only the other models are drawn into the pick buffer
+            if constexpr (requires { model->get_pick_uniforms; }) {
+                model->get_pick_uniforms = &mplot::VisualBase<glver>::get_pick_uniforms;
+                model->get_pick_sprite_uniforms = &mplot::VisualBase<glver>::get_pick_sprite_uniforms;
+            }
+            model->requestRedraw = &mplot::VisualBase<glver>::request_redraw;
             model->setContext = &mplot::VisualBase<glver>::set_context;
             model->releaseContext = &mplot::VisualBase<glver>::release_context;
         }
@@ -118,13 +168,35 @@ namespace mplot {
 
         virtual void clearTexts() = 0;
 
+        //! Set the texts aside for reuse as the model is rebuilt (see pooledTextModel)
+        virtual void poolTexts() = 0;
+
+        //! Destroy any texts set aside by poolTexts() that the rebuild did not reuse
+        virtual void dropTextPool() = 0;
+
+        //! True if the model has any child VisualTextModels
+        virtual bool has_texts() const = 0;
+
+        //! The number of child VisualTextModels
+        virtual std::size_t num_texts() const = 0;
+
         //! Clear out the model, *including text models*
         void clear()
         {
+            this->wait_for_build();
             this->vertexPositions.clear();
             this->vertexNormals.clear();
             this->vertexColors.clear();
             this->indices.clear();
+            this->host_released = false;
+            this->mesh_source = {};
+            this->instance_data.clear();
+            this->vertexDatums.clear();
+            this->clear_polylines();
+            this->clear_sprites();
+            this->clear_bars();
+            this->clear_raster();
+            this->clear_cloud();
             this->clearTexts();
             this->idx = 0u;
             this->reinit_buffers();
@@ -133,33 +205,63 @@ namespace mplot {
         //! Re-create the model - called after updating data
         void reinit()
         {
+            MPLOT_TRACE_SCOPE ("VisualModel::reinit");
+            this->wait_for_build();
+            ++this->stats.reinits;
             if (this->setContext != nullptr) { this->setContext (this->parentVis); }
+            if (this->instanced && !this->indices.empty()) {
+                // An instanced model keeps its mesh; initializeVertices() recomputes only the
+                // instances, and only the instance buffer is uploaded
+                this->instance_data.clear();
+                this->compute_vertices();
+                this->reinit_instances();
+                return;
+            }
             // Fixme: Better not to clear, then repeatedly pushback here:
             this->vertexPositions.clear();
             this->vertexNormals.clear();
             this->vertexColors.clear();
             this->indices.clear();
+            this->host_released = false;
+            this->mesh_source = {};
+            this->instance_data.clear();
+            this->vertexDatums.clear();
+            this->clear_polylines();
+            this->clear_sprites();
+            this->clear_bars();
             // NB: Do NOT call clearTexts() here! We're only updating the model itself.
             this->idx = 0u;
-            this->initializeVertices();
+            this->compute_vertices();
             this->reinit_buffers();
         }
 
         /*!
          * For some models it's important to clear the texts when reinitialising. This is NOT the
          * same as VisualModel::clear() followed by initializeVertices(). For the same effect, you
-         * can call clearTexts() then reinit().
+         * can call clearTexts() then reinit(). The old texts are pooled while
+         * initializeVertices() runs, so a model that makes its labels with pooledTextModel()
+         * reuses those that are unchanged.
          */
         void reinit_with_clearTexts()
         {
+            this->wait_for_build();
+            ++this->stats.reinits;
             if (this->setContext != nullptr) { this->setContext (this->parentVis); }
             this->vertexPositions.clear();
             this->vertexNormals.clear();
             this->vertexColors.clear();
             this->indices.clear();
-            this->clearTexts();
+            this->host_released = false;
+            this->mesh_source = {};
+            this->instance_data.clear();
+            this->vertexDatums.clear();
+            this->clear_polylines();
+            this->clear_sprites();
+            this->clear_bars();
+            this->poolTexts();
             this->idx = 0u;
-            this->initializeVertices();
+            this->compute_vertices();
+            this->dropTextPool();
             this->reinit_buffers();
         }
 
@@ -171,34 +273,241 @@ namespace mplot {
             this->indices.reserve (6u * n_vertices);
         }
 
+        /*!
+         * Reserve space for n_vertices more vertices and n_indices more indices than the model
+         * has now. Use the *_vertex_count and *_index_count functions to get exact numbers for the
+         * primitives you are about to compute, and call this once for the whole model (or a large
+         * part of it) rather than for each primitive. A container that already has some capacity
+         * at least doubles it, so that many small calls do not make a reallocation each.
+         */
+        void reserve_geometry (std::size_t n_vertices, std::size_t n_indices)
+        {
+            auto grow = [](auto& v, const std::size_t n) {
+                if (v.capacity() < v.size() + n) { v.reserve (std::max (v.size() + n, 2u * v.capacity())); }
+            };
+            grow (this->vertexPositions, 3u * n_vertices);
+            grow (this->vertexNormals, 3u * n_vertices);
+            grow (this->vertexColors, 3u * n_vertices);
+            grow (this->indices, n_indices);
+        }
+
+        // The numbers of vertices and indices that the compute* primitives add to the model
+        //! computeSphere
+        static constexpr std::size_t sphere_vertex_count (int rings = 10, int segments = 12) { return 2u + static_cast<std::size_t>(segments) * (rings - 1); }
+        static constexpr std::size_t sphere_index_count (int rings = 10, int segments = 12) { return 6u * static_cast<std::size_t>(segments) * (rings - 1); }
+        //! computeSphereGeoFast (and computeSphereGeo)
+        static constexpr std::size_t geodesic_vertex_count (int iterations = 2) { return mplot::unit_meshes::geodesic_vertex_count (iterations); }
+        static constexpr std::size_t geodesic_index_count (int iterations = 2) { return mplot::unit_meshes::geodesic_index_count (iterations); }
+        //! computeTube and computeFlaredTube
+        static constexpr std::size_t tube_vertex_count (int segments = 12) { return 4u * static_cast<std::size_t>(segments) + 2u; }
+        static constexpr std::size_t tube_index_count (int segments = 12) { return 24u * static_cast<std::size_t>(segments); }
+        //! computeCone
+        static constexpr std::size_t cone_vertex_count (int segments = 12) { return 3u * static_cast<std::size_t>(segments) + 2u; }
+        static constexpr std::size_t cone_index_count (int segments = 12) { return 18u * static_cast<std::size_t>(segments); }
+        //! computeRing (a computeFlatQuad for each segment)
+        static constexpr std::size_t ring_vertex_count (int segments = 12) { return 4u * static_cast<std::size_t>(segments); }
+        static constexpr std::size_t ring_index_count (int segments = 12) { return 6u * static_cast<std::size_t>(segments); }
+        //! computeFlatLine, computeFlatLineP and computeFlatLineN (without rounded caps)
+        static constexpr std::size_t flat_line_vertex_count() { return 4u; }
+        static constexpr std::size_t flat_line_index_count() { return 6u; }
+
         /*!
          * A function to call initialiseVertices and postVertexInit after any necessary attributes
          * have been set (see, for example, setting the colour maps up in VisualDataModel).
          */
         void finalize()
         {
+            MPLOT_TRACE_SCOPE ("VisualModel::finalize");
+            mplot::startup_profile::counter_scope startup_count (mplot::startup_profile::finalize_ns());
+            this->wait_for_build();
             if (this->setContext != nullptr) { this->setContext (this->parentVis); }
-            this->initializeVertices();
+            this->finalize_vertices();
+            this->choose_compact();
             this->postVertexInitRequired = true;
             // Release context after creating and finalizing this VisualModel. On Visual::render(),
             // context will be re-acquired.
             if (this->releaseContext != nullptr) { this->releaseContext (this->parentVis); }
         }
 
+        /*!
+         * Run initializeVertices on a worker thread, so that the render thread is not held up
+         * while a large model computes its vertices. No GL context is needed. The returned future
+         * becomes ready when the vertices have been computed; the buffers are then uploaded by
+         * the render thread during the next render() (as finalize leaves them to be).
+         *
+         * The model's initializeVertices must make no GL calls, so it must not add labels (or
+         * other text models) and it must not change draw_spans. Until the upload, the model is
+         * drawn from its previous buffers (if it had any). Don't change the model, or call
+         * finalize or reinit, while the build is running, except through wait_for_build. A
+         * Visual waits for the build before it deletes the model, as does the model's destructor.
+         */
+        std::shared_future<void> finalize_async()
+        {
+            if (this->async_build.valid()) {
+                throw std::runtime_error ("VisualModel::finalize_async: a build is already running");
+            }
+            this->wait_for_upload();
+            this->async_build = std::async (std::launch::async, [this]() {
+                this->finalize_vertices();
+                this->choose_compact();
+                // changes is counted on the render thread, by async_build_running
+                this->request_render();
+            }).share();
+            return this->async_build;
+        }
+
+        /*!
+         * As finalize_async, but re-create the model from its data as reinit does. The model
+         * keeps drawing its previous vertices until the new ones have been uploaded.
+         */
+        std::shared_future<void> reinit_async()
+        {
+            if (this->async_build.valid()) {
+                throw std::runtime_error ("VisualModel::reinit_async: a build is already running");
+            }
+            this->wait_for_upload();
+            ++this->stats.reinits;
+            this->async_build = std::async (std::launch::async, [this]() {
+                if (!this->instanced || this->indices.empty()) {
+                    this->vertexPositions.clear();
+                    this->vertexNormals.clear();
+                    this->vertexColors.clear();
+                    this->indices.clear();
+                    this->mesh_source = {};
+                    this->vertexDatums.clear();
+                    this->clear_polylines();
+                    this->clear_sprites();
+                    this->clear_bars();
+                    this->idx = 0u;
+                }
+                this->instance_data.clear();
+                this->compute_vertices();
+                this->request_render();
+            }).share();
+            return this->async_build;
+        }
+
+        /*!
+         * Wait for a build started by finalize_async or reinit_async to finish (rethrowing any
+         * exception that it threw). The buffers are uploaded at the next render().
+         */
+        void wait_for_build()
+        {
+            this->wait_for_upload();
+            if (this->async_build.valid()) {
+                this->async_build.wait();
+                this->async_build_running();
+            }
+        }
+
+        /*!
+         * Wait for any upload of the model's buffers on its Visual's upload worker to finish (so
+         * that its vertices may be changed), and take up the new buffers. Only the multicontext
+         * VisualModel uploads on a worker (see VisualMX::setUploadWorker).
+         */
+        virtual void wait_for_upload() {}
+
+        //! Compute the model's vertices with initializeVertices(), adding the time taken to the upload stats
+        void compute_vertices()
+        {
+            MPLOT_TRACE_SCOPE ("VisualModel::initializeVertices");
+            const auto t0 = std::chrono::steady_clock::now();
+            if (!this->load_cached_geometry()) {
+                this->initializeVertices();
+                this->store_cached_geometry();
+            }
+            this->stats.build_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        }
+
+        //! True if the model's triangles can be kept in its geometry cache (see setGeometryCache)
+        bool geometry_cacheable() const
+        {
+            return !this->geometry_cache_dir.empty() && !this->instanced && !this->streaming && !this->compact_vertices
+            && !this->gpu_mesh && !this->lod_enabled && !this->take_data_enabled && !this->host_only;
+        }
+
+        //! Draw the model from its geometry cache file, if it has one, returning true if it does
+        bool load_cached_geometry()
+        {
+            if (!this->geometry_cacheable()) { return false; }
+            mplot::mapped_mesh mm = mplot::geometry_cache::load (this->geometry_cache_dir, this->geometry_cache_key);
+            if (mm.file == nullptr) { return false; }
+            this->setMappedMesh (mm);
+            ++this->stats.geometry_cache_hits;
+            return true;
+        }
+
+        //! Write the model's geometry cache file, if it has a cache and it built only triangles
+        void store_cached_geometry()
+        {
+            if (!this->geometry_cacheable() || !this->mesh_source.empty() || this->datum_colour_mode() != 0
+                || this->has_texts() || !this->polylines.empty() || !this->sprites.empty() || !this->bar_sets.empty()
+                || !this->volume.empty() || !this->raster_ring.empty() || this->has_cloud() || !this->draw_spans.empty()) {
+                return;
+            }
+            const std::vector<GLuint>& ind = this->indices;
+            const std::vector<std::uint32_t> ind32 (ind.begin(), ind.end());
+            mplot::geometry_cache::store (this->geometry_cache_dir, this->geometry_cache_key,
+                                          this->vertexPositions, this->vertexNormals, this->vertexColors, ind32);
+        }
+
+        //! The GL-free part of finalize(): compute the vertices, counting a finalize in the upload stats
+        void finalize_vertices()
+        {
+            ++this->stats.finalizes;
+            this->compute_vertices();
+        }
+
+        /*!
+         * The model's counts of rebuilds (finalize, reinit), of buffer uploads (reinit_buffers,
+         * reinit_colour_buffer, reinit_instances), of the bytes sent to each buffer, and of the
+         * time spent computing vertices and uploading them, since the model was created or
+         * reset_upload_stats was called. See VisualBase::getUploadStats for a scene's totals.
+         * While a finalize_async build runs, its build time is not yet counted.
+         */
+        const mplot::upload_stats& get_upload_stats() const { return this->stats; }
+
+        void reset_upload_stats() { this->stats = {}; }
+
+        /*!
+         * If set, this is called after each upload of the model's buffers (by postVertexInit,
+         * reinit_buffers, reinit_colour_buffer or reinit_instances) with the model, whose
+         * get_upload_stats() then includes the upload. Use it to feed telemetry. It must not
+         * throw. Visual::setUploadHook sets it for all of a Visual's models.
+         */
+        std::function<void(const VisualModelBase<glver>&)> upload_hook;
+
         //! Render the VisualModel. Note that it is assumed that the OpenGL context has been
         //! obtained by the parent Visual::render call.
         virtual void render() = 0;
 
+        /*!
+         * Draw the model's triangles and sprites into the ID pass of Visual::pick, with the id
+         * model_id and the index of each element. The element is the index that the model was
+         * built with when it is coloured by element (colour_by_element), the instance of an
+         * instanced model, the sprite for sprites and otherwise the triangle. Polylines, bars and
+         * texts are not drawn.
+         */
+        virtual void render_pick (const std::uint32_t model_id) = 0;
+
         //! Setter for the viewmatrix
-        void setViewMatrix (const sm::mat44<float>& mv) { this->viewmatrix = mv; }
+        void setViewMatrix (const sm::mat44<float>& mv) { this->viewmatrix = mv; this->view_changed(); }
 
         virtual void setSceneMatrixTexts (const sm::mat44<float>& sv) = 0;
 
-        //! When setting the scene matrix, also have to set the text's scene matrices.
+        /*!
+         * When setting the scene matrix, also have to set the text's scene matrices. Visual calls
+         * this for each model on each frame, so if sv is unchanged (and nothing has disturbed the
+         * texts' scene matrices) there is nothing to do. The texts of a child model (see
+         * setParentModel) are placed in the scene by sv and the parent's world_matrix().
+         */
         void setSceneMatrix (const sm::mat44<float>& sv)
         {
+            if (this->texts_scene_current && this->texts_scene_n == this->num_texts() && sv.mat == this->scenematrix.mat) { return; }
             this->scenematrix = sv;
-            this->setSceneMatrixTexts (sv);
+            this->setSceneMatrixTexts (this->parent_model == nullptr ? sv : sv * this->parent_model->world_matrix());
+            this->texts_scene_current = true;
+            this->texts_scene_n = this->num_texts();
         }
 
         virtual void setSceneTranslationTexts (const sm::vec<float>& v0) = 0;
@@ -211,6 +520,7 @@ namespace mplot {
             this->scenematrix.translate (this->sv_offset);
             this->scenematrix.prerotate (this->sv_rotation);
             this->setSceneTranslationTexts (v0);
+            this->texts_scene_current = false;
         }
 
         //! Set a translation (only) into the scene view matrix
@@ -218,6 +528,7 @@ namespace mplot {
         {
             this->sv_offset += v0;
             this->scenematrix.translate (v0);
+            this->texts_scene_current = false;
         }
 
         //! Set a rotation (only) into the scene view matrix
@@ -227,6 +538,7 @@ namespace mplot {
             this->sv_rotation = r;
             this->scenematrix.translate (this->sv_offset);
             this->scenematrix.prerotate (this->sv_rotation);
+            this->texts_scene_current = false;
         }
 
         //! Add a rotation to the scene view matrix
@@ -234,6 +546,7 @@ namespace mplot {
         {
             this->sv_rotation.premultiply (r);
             this->scenematrix.prerotate (r);
+            this->texts_scene_current = false;
         }
 
         //! Set a translation to the model view matrix
@@ -243,6 +556,7 @@ namespace mplot {
             this->mv_offset = v0;
             this->viewmatrix.translate (this->mv_offset);
             this->viewmatrix.prerotate (this->mv_rotation);
+            this->view_changed();
         }
 
         //! Add a translation to the model view matrix
@@ -250,6 +564,7 @@ namespace mplot {
         {
             this->mv_offset += v0;
             this->viewmatrix.translate (v0);
+            this->view_changed();
         }
 
         //! Set a rotation (only) into the view, but keep texts fixed
@@ -259,6 +574,7 @@ namespace mplot {
             this->mv_rotation = r;
             this->viewmatrix.translate (this->mv_offset);
             this->viewmatrix.prerotate (this->mv_rotation);
+            this->view_changed();
         }
 
         virtual void setViewRotationTexts (const sm::quaternion<float>& r) = 0;
@@ -271,6 +587,8 @@ namespace mplot {
             this->viewmatrix.translate (this->mv_offset);
             this->viewmatrix.prerotate (this->mv_rotation);
             this->setViewRotationTexts (r);
+            this->texts_scene_current = false; // setViewRotationTexts sets the texts' scene rotation
+            this->view_changed();
         }
 
         virtual void addViewRotationTexts (const sm::quaternion<float>& r) = 0;
@@ -281,6 +599,7 @@ namespace mplot {
             this->mv_rotation.premultiply (r);
             this->viewmatrix.prerotate (r);
             this->addViewRotationTexts (r);
+            this->view_changed();
         }
 
         //! Apply a further rotation to the model view matrix, but keep texts fixed
@@ -288,25 +607,75 @@ namespace mplot {
         {
             this->mv_rotation.premultiply (r);
             this->viewmatrix.prerotate (r);
+            this->view_changed();
+        }
+
+        /*!
+         * Make this model a child of parent in a transform hierarchy, so that it is drawn
+         * transformed by parent's world_matrix() and then by its own viewmatrix. Moving or
+         * rotating the parent (with setViewTranslation, setViewRotation and so on) moves the
+         * children with it. Pass nullptr to detach the model. A model leaves the hierarchy when
+         * it is destroyed, and its children are then left with no parent.
+         */
+        void setParentModel (VisualModelBase<glver>* parent)
+        {
+            if (parent == this->parent_model) { return; }
+            for (const VisualModelBase<glver>* p = parent; p != nullptr; p = p->parent_model) {
+                if (p == this) { throw std::runtime_error ("VisualModel::setParentModel: the hierarchy would have a cycle"); }
+            }
+            if (this->parent_model != nullptr) {
+                auto& sibs = this->parent_model->child_models;
+                sibs.erase (std::remove (sibs.begin(), sibs.end(), this), sibs.end());
+            }
+            this->parent_model = parent;
+            if (parent != nullptr) { parent->child_models.push_back (this); }
+            this->transform_changed();
+            this->scene_changed();
+        }
+
+        //! The parent of this model in the transform hierarchy, or nullptr
+        VisualModelBase<glver>* getParentModel() const { return this->parent_model; }
+
+        //! The models whose parent (see setParentModel) is this model
+        const std::vector<VisualModelBase<glver>*>& getChildModels() const { return this->child_models; }
+
+        /*!
+         * The model's transform into the scene: its viewmatrix, preceded by the world_matrix()
+         * of its parent, if it has one. This is cached, and recomputed only after the model or
+         * one of its ancestors has been moved.
+         */
+        const sm::mat44<float>& world_matrix() const
+        {
+            if (this->transform_dirty) { this->update_transform(); }
+            return this->world_cache;
+        }
+
+        //! model_scaling * world_matrix(), the m_matrix with which the model is drawn. Cached.
+        const sm::mat44<float>& model_matrix() const
+        {
+            if (this->transform_dirty) { this->update_transform(); }
+            return this->model_cache;
         }
 
         // The alpha attribute accessors
-        void setAlpha (const float _a) { this->alpha = _a; }
+        void setAlpha (const float _a) { this->alpha = _a; this->scene_changed(); }
         float getAlpha() const { return this->alpha; }
         void incAlpha()
         {
             this->alpha += 0.1f;
             this->alpha = this->alpha > 1.0f ? 1.0f : this->alpha;
+            this->scene_changed();
         }
         void decAlpha()
         {
             this->alpha -= 0.1f;
             this->alpha = this->alpha < 0.0f ? 0.0f : this->alpha;
+            this->scene_changed();
         }
 
         // The hide attribute accessors
-        void setHide (const bool _h = true) { this->hide = _h; }
-        void toggleHide() { this->hide = this->hide ? false : true; }
+        void setHide (const bool _h = true) { this->hide = _h; this->scene_changed(); }
+        void toggleHide() { this->hide = this->hide ? false : true; this->scene_changed(); }
         float hidden() const { return this->hide; }
 
         /*
@@ -445,45 +814,1866 @@ namespace mplot {
             }
             return base64::encode (_bytes);
         }
+
+        /*!
+         * Write the indices (as uint32) and then the positions, colours and normals (as float
+         * triplets) to bin, the binary chunk of a .glb file, straight from the model's vectors.
+         * If interleaved, the position, colour and normal of each vertex are written together, 36
+         * bytes per vertex, through a small block. glb files are little-endian, as must be the host.
+         */
+        void write_glb_binary (std::ostream& bin, const bool interleaved) const
+        {
+            if constexpr (std::endian::native != std::endian::little) {
+                throw std::runtime_error ("VisualModel::write_glb_binary: glb data are little-endian, and this host is not");
+            }
+            const std::size_t nf = this->vertexPositions.size();
+            if (this->vertexColors.size() != nf || this->vertexNormals.size() != nf) {
+                throw std::runtime_error ("Expect vertexPositions, Colors and Normals vectors all to have same size");
+            }
+            auto write_floats = [&bin](const float* f, const std::size_t n) {
+                bin.write (reinterpret_cast<const char*>(f), static_cast<std::streamsize>(n * sizeof (float)));
+            };
+            bin.write (reinterpret_cast<const char*>(this->indices.data()), static_cast<std::streamsize>(this->indices.size() * sizeof (GLuint)));
+            if (!interleaved) {
+                write_floats (this->vertexPositions.data(), nf);
+                write_floats (this->vertexColors.data(), nf);
+                write_floats (this->vertexNormals.data(), nf);
+                return;
+            }
+            constexpr std::size_t block_vertices = 4096u;
+            std::vector<float> block (9u * std::min (block_vertices, nf / 3u));
+            for (std::size_t f0 = 0u; f0 < nf; f0 += 3u * block_vertices) {
+                const std::size_t f1 = std::min (nf, f0 + 3u * block_vertices);
+                float* bp = block.data();
+                for (std::size_t f = f0; f < f1; f += 3u, bp += 9) {
+                    std::copy_n (this->vertexPositions.data() + f, 3, bp);
+                    std::copy_n (this->vertexColors.data() + f, 3, bp + 3);
+                    std::copy_n (this->vertexNormals.data() + f, 3, bp + 6);
+                }
+                write_floats (block.data(), 3u * (f1 - f0));
+            }
+        }
+
+        //! Pack this model's mesh into a copy for Visual::saveglb as opts asks (see mplot/gltf_pack.h)
+        mplot::gltf_packed_mesh gltf_pack (const mplot::gltf_options& opts) const
+        {
+            return mplot::gltf_pack (this->vertexPositions, this->vertexColors, this->vertexNormals, this->indices, opts);
+        }
+
+        //! Add this model's current state to anim as a frame at time t (see Visual::addAnimationFrame)
+        void add_glb_animation_frame (mplot::glb_animation& anim, const float t)
+        {
+            this->restore_host_vertices();
+            anim.add_frame (t, this->indices, this->vertexPositions, this->vertexColors, this->vertexNormals, this->mv_offset);
+        }
         // end Visual::savegltf() methods
 
         //! If true, then this VisualModel should always be viewed in a plane - it's a 2D model
         bool twodimensional = false;
 
-        //! The current indices index
-        GLuint idx = 0u;
+        /*!
+         * Call with true to draw this model with no lighting, in its own colours. The parent
+         * Visual draws it with the unlit program, which does no lighting and has no normals, so
+         * the model's normals are not uploaded (unless it is compact, streaming or generated on
+         * the GPU). Two dimensional models are always unlit. In the cylindrical projection and
+         * in the transparency passes, which have no unlit program, a model without normals is
+         * lit as if it faced along its z axis.
+         */
+        void setUnlit (const bool u = true) { this->unlit = u; }
 
-        //! Set scaling in all dimensions
-        void setSizeScale (const float scl)
+        //! True if the model is drawn without lighting. See setUnlit()
+        bool is_unlit() const { return this->unlit || this->twodimensional; }
+
+        /*!
+         * If true (the default), the parent Visual skips rendering this model when its bounding
+         * box lies wholly outside the view frustum. Call with false for a model whose vertices
+         * are moved by its shader, or whose render() override has work to do even when the model
+         * is off screen.
+         */
+        void setFrustumCulling (const bool c = true) { this->frustum_culling = c; }
+
+        /*!
+         * Call with true to allow the parent Visual to draw this model in a batch with the other
+         * batched models in the scene: their vertices are packed into shared buffers and all of
+         * them are drawn with a single glMultiDrawElementsIndirect call. This is for static
+         * models; a batch is repacked in full whenever any of its models is re-uploaded. It needs
+         * desktop OpenGL 4.3 or later; on earlier versions the model is drawn on its own as usual.
+         * See also batchable().
+         */
+        void setBatched (const bool b = true) { this->batched = b; this->scene_changed(); }
+
+        /*!
+         * Call with true to put the model in its Visual's static layer. The static models are
+         * drawn into an off-screen colour and depth buffer only when one of them, the view or the
+         * lighting changes, and that buffer is copied into each frame before the other (dynamic)
+         * models are drawn. Use it for the parts of a scene that rarely change, such as the axes,
+         * colour bars and labels of a dashboard. A static model is redrawn after each change made
+         * through its own functions (each of which calls scene_changed(), or uploads to its
+         * buffers); call scene_changed() after changing it any other way (through a pointer to
+         * one of its texts, say, or in a GL buffer of its that client code writes).
+         */
+        void setStaticLayer (const bool s = true) { this->static_layer = s; this->scene_changed(); }
+        bool getStaticLayer() const { return this->static_layer; }
+
+        //! A count of the changes to the model, by which its Visual knows when to redraw the static layer
+        std::uint64_t change_count() const { return this->changes; }
+
+        /*!
+         * Call with true to keep the model's vertices on the CPU. Its buffers are never uploaded
+         * and it is not drawn. This is for models whose vertices are merged into those of another
+         * model, as the panels of an mplot::PanelGrid are.
+         */
+        void setHostOnly (const bool h = true) { this->host_only = h; }
+
+        //! True if the model has been setHostOnly()
+        bool getHostOnly() const { return this->host_only; }
+
+        /*!
+         * Call with true to keep this model's vertices on the GPU only. After each full upload,
+         * vertexPositions, vertexNormals, vertexColors and indices are freed, so a large scene
+         * does not hold a second copy of its meshes in RAM. The model still draws, and reinit()
+         * rebuilds the vertices from the model's data (freeing them again after the upload).
+         * Code that would read or rewrite the vectors in place first calls
+         * restore_host_vertices(), which reads them back from the GPU; Visual::savegltf and
+         * saveglb do this, as do the partial updates of GridVisual and VisualDataModel (or they
+         * fall back to reinit()). Streaming, compact, mapped, GPU generated, host only, shared
+         * mesh, batched and level of detail models keep their vectors.
+         */
+        void setGpuResident (const bool g = true) { this->gpu_resident = g; }
+
+        //! True if the model has been setGpuResident()
+        bool getGpuResident() const { return this->gpu_resident; }
+
+        //! True if setGpuResident() has freed the vectors since the last upload (and they have not
+        //! been restored or rebuilt)
+        bool host_vertices_released() const { return this->host_released; }
+
+        //! If the vectors have been freed (see setGpuResident), read them back from the GPU
+        virtual void restore_host_vertices() = 0;
+
+        //! True if the model has been setBatched() and is of a kind that can be drawn in a batch:
+        //! not instanced, streaming, compact, GPU generated or GPU coloured, drawn in spans or
+        //! levels of detail, coloured by datum, labelled or with polylines, sprites, bars, a volume, a raster,
+        //! a point cloud cache or a vertex_curvature.
+        bool batchable() const
         {
-            this->model_scaling.setToIdentity();
-            this->model_scaling[0] = scl;
-            this->model_scaling[5] = scl;
-            this->model_scaling[10] = scl;
+            return this->batched && !this->instanced && !this->streaming && !this->compact_vertices && !this->gpu_mesh
+            && this->external_colour_buffer == 0 && this->draw_spans.empty() && this->datum_colour_mode() == 0 && !this->has_texts()
+            && this->mesh_source.empty() && !this->async_build.valid() && !this->lod_enabled
+            && this->polylines.empty() && this->sprites.empty() && this->bar_sets.empty() && this->volume.empty()
+            && this->raster_ring.empty() && !this->has_cloud() && !this->take_data_enabled && !this->has_vertex_curvature();
         }
-        //! Set scaling in xy only
-        void setSizeScale (const float xscl, const float yscl)
+
+        //! Incremented on each upload of the model's vertices, so a batch can tell when to repack
+        std::size_t get_upload_generation() const { return this->upload_generation; }
+
+        //! Append the model's vertices and indices (counted from its first vertex) to the
+        //! buffers of a batch
+        void append_to_batch (std::vector<float>& posn, std::vector<float>& norm,
+                              std::vector<float>& col, std::vector<GLuint>& ind) const
         {
-            this->model_scaling.setToIdentity();
-            this->model_scaling[0] = xscl;
-            this->model_scaling[5] = yscl;
+            posn.insert (posn.end(), this->vertexPositions.begin(), this->vertexPositions.end());
+            norm.insert (norm.end(), this->vertexNormals.begin(), this->vertexNormals.end());
+            col.insert (col.end(), this->vertexColors.begin(), this->vertexColors.end());
+            // A model without colours (or normals) still occupies its place in the shared buffers
+            norm.resize (posn.size(), 0.0f);
+            col.resize (posn.size(), 0.0f);
+            ind.insert (ind.end(), this->indices.begin(), this->indices.end());
+        }
+
+        //! The number of floats written by write_batch_state()
+        static constexpr std::size_t batch_state_stride = 36;
+
+        //! Write the model (m_matrix) and scene (v_matrix) matrices with which render() would draw
+        //! the model, followed by its alpha and three unused floats, to out
+        void write_batch_state (float* out) const
+        {
+            const sm::mat44<float>& m = this->model_matrix();
+            std::copy (m.mat.begin(), m.mat.end(), out);
+            std::copy (this->scenematrix.mat.begin(), this->scenematrix.mat.end(), out + 16);
+            out[32] = this->alpha;
+            out[33] = 0.0f;
+            out[34] = 0.0f;
+            out[35] = 0.0f;
         }
 
+        //! True if the model is hidden (see setHide())
+        bool getHide() const { return this->hide; }
+
         /*!
-         * A function that will be runtime defined to get_shaderprogs from a pointer to
-         * Visual (saving a boilerplate argument and avoiding that killer circular
-         * dependency at the cost of one line of boilerplate in client programs)
+         * True if the model's bounding box (transformed by its view and scene matrices and by the
+         * projection p) lies wholly outside the view frustum, so that render() can be skipped.
+         * This is conservative; it returns false for models whose bounds are not known from the
+         * last upload (instanced models, those with draw_spans, polylines, sprites, bars, a volume, a
+         * raster, a point cloud cache, a vertex_curvature or child texts, or those not yet uploaded).
          */
-        std::function<mplot::visgl::visual_shaderprogs(mplot::VisualBase<glver>*)> get_shaderprogs;
-        //! Get the graphics shader prog id
-        std::function<GLuint(mplot::VisualBase<glver>*)> get_gprog;
-        //! Get the text shader prog id
-        std::function<GLuint(mplot::VisualBase<glver>*)> get_tprog;
+        bool outside_frustum (const sm::mat44<float>& p) const
+        {
+            if (!this->frustum_culling || !this->bounds_valid || this->instanced
+                || !this->draw_spans.empty() || this->has_texts() || this->needs_viewport() || this->has_bars()
+                || this->has_volume() || this->has_raster() || this->has_cloud() || this->take_data_enabled
+                || this->has_vertex_curvature()) { return false; }
+            const sm::mat44<float> mvp = p * this->scenematrix * this->model_matrix();
+            // Count the corners that lie beyond each of the six clip planes
+            std::array<unsigned int, 6> beyond = {};
+            for (unsigned int c = 0; c < 8; ++c) {
+                sm::vec<float, 4> corner = { (c & 1) ? this->bb_max[0] : this->bb_min[0],
+                                             (c & 2) ? this->bb_max[1] : this->bb_min[1],
+                                             (c & 4) ? this->bb_max[2] : this->bb_min[2], 1.0f };
+                sm::vec<float, 4> q = mvp * corner;
+                for (unsigned int i = 0; i < 3; ++i) {
+                    if (q[i] < -q[3]) { ++beyond[2 * i]; }
+                    if (q[i] > q[3]) { ++beyond[2 * i + 1]; }
+                }
+            }
+            for (auto b : beyond) { if (b == 8) { return true; } }
+            return false;
+        }
+
+        /*!
+         * Declare the rectangle of the framebuffer (in pixels from its bottom left corner) within
+         * which this model draws, for a Visual that redraws only the parts of the frame that
+         * change (see VisualBase::partialRedraw). Pass an empty rectangle to have it found from
+         * the model's bounds again (see screen_bounds).
+         */
+        void setScreenRect (const mplot::screen_rect& r) { this->declared_rect = r; this->scene_changed(); }
+
+        //! Extend the box from mn to mx (in normalized device coordinates) to hold the model's
+        //! texts, projected by p. False if that is not known (see VisualTextModel::clip_bounds).
+        virtual bool texts_clip_bounds (const sm::mat44<float>& p, sm::vec<float, 2>& mn, sm::vec<float, 2>& mx) const = 0;
+
+        /*!
+         * Find r, the rectangle of a framebuffer of size dims that this model covers with the
+         * projection p and its current scene matrix: the rectangle given to setScreenRect, or else
+         * that of the corners of its bounding box and of its texts. Returns false if it is not
+         * known, for the models whose bounds are not known to outside_frustum (other than those
+         * with texts) and for those with a corner behind the camera.
+         */
+        bool screen_bounds (const sm::mat44<float>& p, const sm::vec<int, 2>& dims, mplot::screen_rect& r) const
+        {
+            if (!this->declared_rect.empty()) { r = this->declared_rect; return true; }
+            if (!this->bounds_valid || this->instanced || !this->draw_spans.empty() || this->needs_viewport()
+                || this->has_bars() || this->has_volume() || this->has_raster() || this->has_cloud()
+                || this->take_data_enabled || this->has_vertex_curvature()) { return false; }
+            const sm::mat44<float> mvp = p * this->scenematrix * this->model_matrix();
+            sm::vec<float, 2> mn = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+            sm::vec<float, 2> mx = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+            for (unsigned int c = 0; c < 8; ++c) {
+                sm::vec<float, 4> corner = { (c & 1) ? this->bb_max[0] : this->bb_min[0],
+                                             (c & 2) ? this->bb_max[1] : this->bb_min[1],
+                                             (c & 4) ? this->bb_max[2] : this->bb_min[2], 1.0f };
+                sm::vec<float, 4> q = mvp * corner;
+                if (q[3] <= 0.0f) { return false; }
+                mn = { std::min (mn[0], q[0] / q[3]), std::min (mn[1], q[1] / q[3]) };
+                mx = { std::max (mx[0], q[0] / q[3]), std::max (mx[1], q[1] / q[3]) };
+            }
+            if (this->has_texts() && !this->texts_clip_bounds (p, mn, mx)) { return false; }
+            // A margin of a few pixels for the edges that anti-aliasing blurs
+            r = mplot::screen_rect::from_ndc (mn, mx, dims, 2);
+            return true;
+        }
+
+        /*!
+         * The distance in front of the camera of the centre of the model's bounding box (or of its
+         * origin, if it has no valid bounds), with the current scene matrix. Visual orders the
+         * models by this when it sorts them (see VisualBase::sortModels).
+         */
+        float view_depth() const
+        {
+            sm::vec<float, 4> c = { 0.0f, 0.0f, 0.0f, 1.0f };
+            if (this->bounds_valid) {
+                for (unsigned int i = 0; i < 3; ++i) { c[i] = 0.5f * (this->bb_min[i] + this->bb_max[i]); }
+            }
+            return -(this->scenematrix * this->model_matrix() * c)[2];
+        }
+
+        /*!
+         * Call with true before finalize() for a model whose vertices are re-uploaded every frame
+         * (with reinit() or reinit_buffers()). Its vertex buffers are then allocated for
+         * streaming. On OpenGL 4.4+ (not ES), they are persistently mapped buffers holding a ring
+         * of stream_regions copies of the data, guarded by fences. On earlier versions, they are
+         * GL_STREAM_DRAW buffers that are orphaned on each update.
+         */
+        void setStreaming (const bool s = true) { this->streaming = s; }
+
+        /*!
+         * Call with true before finalize() to store this model's vertices on the GPU in one
+         * interleaved buffer of compact_stride bytes per vertex: a float3 position, a normal
+         * packed as GL_INT_2_10_10_10_REV and an RGBA8 colour (with alpha as its A). That is 20
+         * bytes per vertex, rather than the 36 bytes of the three float3 buffers used by default,
+         * at the cost of about 10 bits of precision in the normals and 8 bits in the colours.
+         * Each upload repacks and uploads the whole model (streaming and mark_dirty() do not
+         * apply to a compact model).
+         */
+        void setCompactVertices (const bool c = true) { this->compact_vertices = c; }
+
+        /*!
+         * Call with true to have finalize() make this model compact (see setCompactVertices) if
+         * nothing that it uses needs the float vertex buffers: it is not streaming, batched,
+         * generated on the GPU, drawn from a mapped mesh or coloured by datum. Visual::bindmodel
+         * calls this in the tiled GPU profile (see VisualBase::tiledGpuProfile).
+         */
+        void setCompactByDefault (const bool c = true) { this->compact_by_default = c; }
+
+        /*!
+         * A small model (of up to visgl::share_mesh_max_vertices vertices) whose indices,
+         * positions, normals and colours are identical to those of another model in the same
+         * context group shares that model's vertex buffers, rather than uploading its own. The
+         * buffers are reference counted in mplot::VisualResources and are deleted with their
+         * last user. A model that later changes its vertices takes buffers of its own again and
+         * does not share from then on. Call with false before finalize() to never share. A model
+         * that is streaming, compact, batched, generated on the GPU, drawn from a mapped mesh or
+         * in levels of detail never shares.
+         */
+        void setShareMesh (const bool s = true) { this->share_mesh_enabled = s; }
+
+        /*!
+         * Share the index, position and normal buffers of this model with those of any other
+         * models in the same context group that hold the same data, keeping a colour buffer of
+         * its own. This is for many views of one grid (a dashboard of the fields of a
+         * simulation, say), whose geometry is then held on the GPU once per grid, rather than
+         * once per view. Each buffer is shared separately, so views whose heights differ (with
+         * a non-zero zScale) still share their indices. Unlike setShareMesh, this suits models
+         * of any size, as the cost of hashing a buffer is small beside the cost of building it.
+         * A buffer is hashed whenever it is uploaded; one whose data have changed leaves what it
+         * shared, and takes a buffer of its own (or shares again, if its new data match those of
+         * another model). A model that shares its geometry does not share its whole mesh. Call
+         * before finalize(). Streaming, compact, batched and GPU generated models, and those
+         * drawn from a mapped mesh, never share their geometry.
+         */
+        void setShareGeometry (const bool s = true) { this->share_geometry_enabled = s; }
+
+        /*!
+         * Draw the mesh mm, which is memory mapped from a file (see mplot::glb_file), in place of
+         * vertexPositions, vertexNormals, vertexColors and indices. Call this from
+         * initializeVertices(). At upload, the data go straight from the mapping into the vertex
+         * buffers, so there are no CPU-side copies of them; the model holds the file mapped, and
+         * its vertex vectors stay empty. Such a model can't be streamed, compact, batched or
+         * saved with Visual::savegltf/saveglb.
+         */
+        void setMappedMesh (const mplot::mapped_mesh& mm)
+        {
+            if (this->streaming || this->compact_vertices) {
+                throw std::runtime_error ("VisualModel::setMappedMesh: a mapped mesh can't be streaming or compact");
+            }
+            this->vertexPositions.clear();
+            this->vertexNormals.clear();
+            this->vertexColors.clear();
+            this->indices.clear();
+            this->mesh_source = mm;
+            this->idx = static_cast<GLuint>(mm.n_vertices);
+        }
+
+        /*!
+         * Keep the model's triangles in a cache file in the directory dir (see
+         * mplot/geometry_cache.h), named for key, a hash of all the inputs and parameters on which
+         * the vertices depend (see mplot::geometry_key). If the file exists when the model is
+         * built (by finalize or reinit), it is memory mapped and drawn as by setMappedMesh, and
+         * initializeVertices is not called. Otherwise, initializeVertices runs and the file is
+         * written. Call before finalize(). Such a model is static: its vectors are empty after a
+         * hit, so it can't be updated with reinitColours or updateData, and a model that makes
+         * anything other than triangles (texts, polylines, spans, colours by datum) is never
+         * written to the cache. An instanced, streaming, compact or level of detail model has no
+         * cache. Pass an empty dir to build as usual.
+         */
+        void setGeometryCache (const std::string& dir, const std::uint64_t key)
+        {
+            this->geometry_cache_dir = dir;
+            this->geometry_cache_key = key;
+        }
+
+        /*!
+         * Draw a mesh of n_vertices vertices and n_indices (32 bit) indices whose data client code
+         * writes straight into the model's buffers on the GPU (see buffer_name), for example with
+         * cudaMemcpy through cudaGraphicsGLRegisterBuffer (see mplot/compoundray/cuda_gl.h), so
+         * they never pass through the CPU. Call before finalize(), as for setMappedMesh. Each full
+         * upload allocates the buffers without filling them, so write the buffers after the
+         * first upload (for which a client can call reinit_buffers() after finalize()). bb_min
+         * and bb_max bound the positions, for frustum culling. Such a model can't be streamed,
+         * compact, batched or saved with Visual::savegltf/saveglb, and reinit() forgets the mesh.
+         */
+        void setDeviceMesh (const std::size_t n_vertices, const std::size_t n_indices,
+                            const sm::vec<float, 3>& _bb_min, const sm::vec<float, 3>& _bb_max)
+        {
+            if (this->streaming || this->compact_vertices) {
+                throw std::runtime_error ("VisualModel::setDeviceMesh: a device mesh can't be streaming or compact");
+            }
+            this->vertexPositions.clear();
+            this->vertexNormals.clear();
+            this->vertexColors.clear();
+            this->indices.clear();
+            this->mesh_source = {};
+            this->mesh_source.n_vertices = n_vertices;
+            this->mesh_source.n_indices = n_indices;
+            this->idx = static_cast<GLuint>(n_vertices);
+            this->bb_min = _bb_min;
+            this->bb_max = _bb_max;
+        }
+
+        /*!
+         * The GL name of the buffer that holds the model's positions, normals, colours, indices
+         * or (for an instanced model) instances, for client code that writes it on the GPU (see
+         * setDeviceMesh and setColourBuffer). 0 before the first upload, and for any other t. The
+         * buffers of a compact model (see setCompact) interleave its vertices, and a streaming
+         * model's buffers change on each upload.
+         */
+        GLuint buffer_name (const mplot::upload_target t) const
+        {
+            if (t == mplot::upload_target::instances) { return this->instanceVBO; }
+            const unsigned int vb = static_cast<unsigned int>(t);
+            return (this->vbos == nullptr || vb >= numVBO) ? 0 : this->vbos[vb];
+        }
+
+        //! The size in bytes of the GL buffer buf (see mplot::gl::Util::buffer_bytes)
+        virtual std::size_t gpu_buffer_bytes (const GLuint buf) const = 0;
+
+        //! Add a child "texts" to r, of the memory reports of each of the model's texts
+        virtual void add_text_memory (mplot::memory_report& r) const = 0;
+
+        /*!
+         * The memory held by this model (see mplot/memory_report.h): the used and allocated
+         * bytes of its vertex vectors and the other vectors of its modes, the sizes of its GL
+         * buffers (read back from GL, so the model's context must be current) and the sizes of
+         * its textures (from the dimensions with which they were allocated). Buffers that the
+         * model shares with other models (see setShareMesh and setShareGeometry) are marked
+         * shared. The model's texts are reported in a child named "texts".
+         */
+        mplot::memory_report get_memory_report() const
+        {
+            mplot::memory_report r;
+            r.name = "VisualModel";
+            r.add_vector ("indices", this->indices);
+            r.add_vector ("vertexPositions", this->vertexPositions);
+            r.add_vector ("vertexNormals", this->vertexNormals);
+            r.add_vector ("vertexColors", this->vertexColors);
+            r.add_vector ("vertexDatums", this->vertexDatums);
+            r.add_vector ("draw_spans", this->draw_spans);
+            r.add_vector ("instance_data", this->instance_data);
+            r.add_vector ("colour_lut", this->colour_lut);
+            r.add_vector ("datum_texture", this->datum_texture);
+            r.add_vector ("datum_texture_packed", this->datum_texture_packed);
+            r.add_vector ("compact_data", this->compact_data);
+            r.add_vector ("gpu_mesh_sources", this->gpu_mesh_sources);
+            r.add_vector ("gpu_mesh_data", this->gpu_mesh_data);
+            r.add_vector ("jump_flood_data", this->jump_flood_data);
+            r.add_vector ("polylines", this->polylines);
+            r.add_vector ("polyline_points", this->polyline_points);
+            r.add_vector ("sprites", this->sprites);
+            r.add_vector ("bar_sets", this->bar_sets);
+            r.add_vector ("bar_data", this->bar_data);
+            r.add_vector ("volume", this->volume);
+            r.add_vector ("volume_packed", this->volume_packed);
+            r.add_vector ("raster_ring", this->raster_ring);
+            r.add_vector ("raster_populations", this->raster_populations);
+            r.add_vector ("cloud_draws", this->cloud_draws);
+            if (this->mesh_source.file != nullptr) {
+                // The mapped file (a geometry cache file or a glb) that the mesh is drawn from
+                r.add_cpu ("mesh_source (mapped)", this->mesh_source.file->size(), this->mesh_source.file->size());
+            }
+
+            if (this->vbos != nullptr) {
+                const char* names[numVBO] = { "posnVBO", "normVBO", "colVBO", "idxVBO" };
+                for (unsigned int vb = 0; vb < numVBO; ++vb) {
+                    const bool sh = this->mesh_shared || this->buffer_shared[vb];
+                    r.add_gpu (names[vb], this->gpu_buffer_bytes (this->vbos[vb]), sh, this->vbos[vb]);
+                }
+            }
+            r.add_gpu ("compactVBO", this->gpu_buffer_bytes (this->compactVBO));
+            r.add_gpu ("instanceVBO", this->gpu_buffer_bytes (this->instanceVBO));
+            r.add_gpu ("datumVBO", this->gpu_buffer_bytes (this->datumVBO));
+            for (unsigned int i = 0; i < 3u; ++i) { r.add_gpu ("gpu_mesh_buffers", this->gpu_buffer_bytes (this->gpu_mesh_buffers[i])); }
+            for (unsigned int i = 0; i < 4u; ++i) { r.add_gpu ("jump_flood_buffers", this->gpu_buffer_bytes (this->jump_flood_buffers[i])); }
+            r.add_gpu ("polyline_vbo", this->gpu_buffer_bytes (this->polyline_vbo));
+            r.add_gpu ("sprite_vbo", this->gpu_buffer_bytes (this->sprite_vbo));
+            r.add_gpu ("bar_vbo", this->gpu_buffer_bytes (this->bar_vbo));
+            r.add_gpu ("raster_vbo", this->gpu_buffer_bytes (this->raster_vbo));
+            r.add_gpu ("cloud_vbo", this->gpu_buffer_bytes (this->cloud_vbo));
+
+            // Textures, from the sizes with which they were allocated
+            if (this->colour_lut_texture != 0) {
+                r.add_gpu ("colour_lut_texture", std::max (this->colour_lut.size() / 3u, std::size_t{1}) * 4u);
+            }
+            if (this->datum_texture_id != 0) {
+                r.add_gpu ("datum_texture_id", std::size_t{this->datum_texture_alloc[0]} * this->datum_texture_alloc[1]
+                           * mplot::datum_pack::bytes (this->datum_texture_alloc_format));
+            }
+            if (this->jump_flood_texture != 0) {
+                r.add_gpu ("jump_flood_texture", std::size_t{this->jump_flood_alloc[0]} * this->jump_flood_alloc[1] * sizeof (float));
+            }
+            if (this->volume_texture != 0) {
+                const std::array<unsigned int, 3>& d = this->volume_alloc;
+                const std::size_t vb = this->volume_format == mplot::datum_format::float32 ? 4u : 2u;
+                r.add_gpu ("volume_texture", std::size_t{d[0]} * d[1] * d[2] * vb);
+                const std::array<unsigned int, 3> bd = mplot::volume::brick_dims (d);
+                r.add_gpu ("volume_brick_texture", std::size_t{bd[0]} * bd[1] * bd[2]);
+            }
+
+            this->add_text_memory (r);
+            return r;
+        }
+
+        /*!
+         * Mark vertices [begin, end) as changed since the last upload. The next reinit_buffers()
+         * then re-uploads only the marked spans of vertexPositions, vertexNormals and vertexColors
+         * (with BufferSubData) rather than the whole model. This applies if the vertices and
+         * indices are unchanged in number, or have only grown (in which case the new elements are
+         * uploaded too) and still fit in the space allocated for them on the GPU; otherwise, or
+         * if nothing is marked, everything is uploaded as usual. Once anything is marked,
+         * unmarked elements are assumed unchanged.
+         */
+        void mark_dirty (const std::size_t begin, const std::size_t end)
+        {
+            for (unsigned int vb : { posnVBO, normVBO, colVBO }) {
+                this->dirty_ranges[vb].push_back ({ 3u * begin, 3u * end });
+            }
+        }
+
+        //! Mark only the colours of vertices [begin, end) as changed. See mark_dirty().
+        //! reinit_colour_buffer() uploads only these spans of vertexColors.
+        void mark_dirty_colours (const std::size_t begin, const std::size_t end)
+        {
+            this->dirty_ranges[colVBO].push_back ({ 3u * begin, 3u * end });
+        }
+
+        //! Mark elements [begin, end) of indices as changed. See mark_dirty().
+        void mark_dirty_indices (const std::size_t begin, const std::size_t end)
+        {
+            this->dirty_ranges[idxVBO].push_back ({ begin, end });
+        }
+
+        /*!
+         * A span [first, first + count) of indices to draw, with the model translated by offset
+         * (in model coordinates). See draw_spans.
+         */
+        struct draw_span
+        {
+            std::size_t first = 0;
+            std::size_t count = 0;
+            sm::vec<float> offset = { 0.0f, 0.0f, 0.0f };
+        };
+
+        /*!
+         * If not empty, render() draws only these spans of indices, each with its own offset,
+         * instead of drawing all of indices in one call. A model can use this to skip geometry
+         * that is no longer needed without re-uploading its buffers, or to move part of itself
+         * (see the scrolling window in GraphVisual).
+         */
+        std::vector<draw_span> draw_spans;
+
+        //! True if the model chooses between levels of detail as it is drawn (see update_lod)
+        bool has_lod() const { return this->lod_enabled; }
+
+        /*!
+         * Give a model with levels of detail the projection and the height of the viewport (in
+         * pixels) for the frame that is about to be drawn. The Visual calls this each frame,
+         * before render(), for each model that has_lod().
+         */
+        void set_lod_view (const sm::mat44<float>& p, const int viewport_h)
+        {
+            this->lod_projection = p;
+            this->lod_viewport_h = viewport_h;
+        }
+
+        /*!
+         * Draw only those of the model's texts that are on the screen and that do not overlap a
+         * text of higher priority (see TextFeatures::priority and mplot/label_declutter.h). The
+         * choice is made again whenever the projection, the scene, the model's view or its
+         * number of texts changes, or the model is changed (see change_count). A text moved on
+         * its own, through the pointer from addLabel, is placed again at the next of these.
+         */
+        void setDeclutterTexts (const bool d = true)
+        {
+            this->declutter_enabled = d;
+            this->declutter_key_n = std::numeric_limits<std::size_t>::max();
+            this->scene_changed();
+        }
+        //! True if the model declutters its texts (see setDeclutterTexts)
+        bool has_declutter() const { return this->declutter_enabled; }
+
+        /*!
+         * Give a model that declutters its texts the projection and the size of the framebuffer
+         * (in pixels) for the frame that is about to be drawn. The Visual calls this each frame,
+         * before render(), for each model that has_declutter().
+         */
+        void set_declutter_view (const sm::mat44<float>& p, const sm::vec<int, 2>& dims)
+        {
+            this->declutter_projection = p;
+            this->declutter_dims = dims;
+        }
+
+        //! The texts chosen at the last declutter, with the numbers culled and suppressed
+        const mplot::label_declutter& getDeclutter() const { return this->declutter; }
+
+        /*!
+         * Allocate GPU space for at least nvertices vertices and nindices indices at the next
+         * full upload, so that a model that grows by appending (and marks what it appends with
+         * mark_dirty) can be updated with BufferSubData until it reaches this size. Without a
+         * reservation, a marked model that outgrows its buffers is given twice the space it needs.
+         */
+        void reserve_buffers (const std::size_t nvertices, const std::size_t nindices)
+        {
+            for (unsigned int vb : { posnVBO, normVBO, colVBO }) { this->buffer_reserve[vb] = 3u * nvertices; }
+            this->buffer_reserve[idxVBO] = nindices;
+        }
+
+        /*!
+         * If true, the model's vertices describe a single instance (such as a unit sphere
+         * centred on the origin) and render() draws it once for each entry in instance_data with
+         * one DrawElementsInstanced call. Memory and setup time then scale with the number of
+         * instances, rather than with the number of instances times the size of the mesh. Once
+         * the mesh exists, reinit() keeps it, so initializeVertices() should build the mesh only
+         * if indices is empty.
+         */
+        bool instanced = false;
+
+        //! The number of floats per instance in instance_data
+        static constexpr unsigned int instance_stride = 12;
+
+        /*!
+         * Per-instance data for an instanced model; instance_stride floats per instance. These are
+         * x, y, z (the offset of the instance), s (its scale), r, g, b (its colour), w (the weight
+         * of the mesh's own vertex colour; 0 to colour the instance with r, g, b), then dx, dy, dz
+         * (a direction onto which the mesh's z axis is rotated; all 0 for no rotation) and rs (a
+         * further scaling of the mesh's x and y, applied only if the instance is rotated).
+         */
+        std::vector<float> instance_data;
+
+        //! Add an instance at position p, scaled by scale, coloured clr and, if dirn is not zero,
+        //! with its z axis rotated onto dirn (and its x and y scaled by radial_scale)
+        void add_instance (const sm::vec<float>& p, const float scale, const std::array<float, 3>& clr,
+                           const sm::vec<float>& dirn = { 0.0f, 0.0f, 0.0f }, const float radial_scale = 1.0f)
+        {
+            this->instance_data.insert (this->instance_data.end(), { p[0], p[1], p[2], scale, clr[0], clr[1], clr[2], 0.0f,
+                                                                     dirn[0], dirn[1], dirn[2], radial_scale });
+        }
+
+        //! The number of instances in instance_data
+        std::size_t instance_count() const { return this->instance_data.size() / instance_stride; }
+
+        /*!
+         * Mark instances [begin, end) as changed (or appended) since the last upload. The next
+         * upload of instance_data then writes only the marked instances, if they fit in the
+         * space allocated on the GPU; a marked instance buffer that outgrows its allocation is
+         * given twice the space it needs, so that appending one instance at a time costs O(1)
+         * per instance. If nothing is marked, all of instance_data is uploaded.
+         */
+        void mark_dirty_instances (const std::size_t begin, const std::size_t end)
+        {
+            this->instance_dirty.push_back ({ begin, end });
+        }
+
+        //! Upload instance_data (and nothing else) after changing it
+        virtual void reinit_instances() = 0;
+
+        /*!
+         * If true, the model is coloured by a datum per vertex, in vertexDatums, rather than by
+         * vertexColors (which should be left empty). The fragment shader maps each datum (in the
+         * range [0,1]) to a colour by sampling a texture made from colour_lut, so changing the
+         * colour map needs no per-vertex work and the colour data is one float per vertex.
+         * reinit_colour_buffer() uploads vertexDatums in this mode.
+         */
+        bool colour_by_datum = false;
+
+        //! The colour datum of each vertex (if colour_by_datum) or its element index (if colour_by_element)
+        std::vector<float> vertexDatums;
+
+        //! Set the colour lookup table (RGB triplets, evenly spaced in [0,1]) used if colour_by_datum
+        void set_colour_lut (const std::vector<float>& rgb)
+        {
+            this->colour_lut = rgb;
+            this->colour_lut_rows = 1u;
+            this->colour_lut_changed = true;
+        }
+
+        /*!
+         * If true, the model has a disc that is coloured per fragment from a 2D colour lookup
+         * texture, rather than tessellated into rings and segments: it looks smooth at any size
+         * and is a single quad (see computePolarDisc). The red and green of the disc's
+         * vertexColors are the position in the disc, in units of its radius, and blue is 2. The
+         * fragment shader finds the angle and radius of each fragment, discards those outside
+         * the disc (or inside polar_inner) and samples the lookup set by set_polar_colour_lut.
+         * Vertices with blue less than 2, such as those of a frame, keep their colours.
+         */
+        bool colour_by_polar = false;
+
+        //! The inner radius of the colour_by_polar disc, as a proportion of its radius
+        float polar_inner = 0.0f;
+
+        /*!
+         * Set the colour lookup for colour_by_polar: rows rows of RGB triplets. Row k is the
+         * colour at the proportion k / (rows - 1) of the way from polar_inner to the rim, and
+         * texel i of a row is the colour at the angle 2pi i / (the row length), anticlockwise
+         * from ux. The colours are interpolated (around the disc, too) between texels.
+         */
+        void set_polar_colour_lut (const std::vector<float>& rgb, const unsigned int rows)
+        {
+            this->colour_lut = rgb;
+            this->colour_lut_rows = rows;
+            this->colour_lut_changed = true;
+        }
+
+        /*!
+         * If vertex_curvature[0], a radius, is positive, the vertex shaders bend the model onto a
+         * cylinder about the z axis: the vertex (x, y, z) is drawn at the angle
+         * vertex_curvature[2] + x * vertex_curvature[1], at the height y and at the distance
+         * radius - z from the axis, less vertex_curvature_offset. Its normal points in towards
+         * the axis. A flat mesh, uploaded once, can then be curved differently on each frame at
+         * no cost on the CPU (see CurvyTellyVisual::shader_curvature). Curved models are neither
+         * frustum culled nor batched, as their bounds are those of the flat mesh.
+         */
+        sm::vec<float, 4> vertex_curvature = { 0.0f, 0.0f, 0.0f, 0.0f };
+        //! Subtracted from the curved positions (see vertex_curvature)
+        sm::vec<float, 3> vertex_curvature_offset = { 0.0f, 0.0f, 0.0f };
+        //! True if the vertex shaders curve the model (see vertex_curvature)
+        bool has_vertex_curvature() const { return this->vertex_curvature[0] > 0.0f; }
+
+        /*!
+         * If true, the model is coloured by datums sampled from a 2D texture, datum_texture, at
+         * texture coordinates given in the red and green components of vertexColors. Each
+         * sampled datum is mapped to a colour through colour_lut, as for colour_by_datum, so a
+         * model made of a few large triangles can show an image of any resolution. Use either
+         * this or colour_by_datum, not both.
+         */
+        bool colour_by_datum_texture = false;
+
+        //! The datums for the datum texture, in rows of datum_texture_dims[0] elements
+        std::vector<float> datum_texture;
+
+        //! The width and height of the datum texture, in texels
+        std::array<unsigned int, 2> datum_texture_dims = { 0u, 0u };
+
+        /*!
+         * The format in which datum_texture is held on the GPU. A float16, unorm16 or unorm8
+         * texture halves or quarters the bytes uploaded each time the datums change, for the
+         * cost of packing them on the CPU. The normalized formats hold [0,1] (in 65536 or 256
+         * steps), which is all that the colour scaled datums of datum_texture need. Set before
+         * the first render.
+         */
+        mplot::datum_format datum_texture_format = mplot::datum_format::float32;
+
+        //! datum_texture_format, as the GL version can hold it (OpenGL ES 3 has no GL_R16)
+        mplot::datum_format datum_gpu_format() const
+        {
+            if constexpr (mplot::gl::version::gles (glver)) {
+                if (this->datum_texture_format == mplot::datum_format::unorm16) { return mplot::datum_format::float16; }
+            }
+            return this->datum_texture_format;
+        }
+
+        //! The GL internal format and pixel type of the texels of the datum texture
+        std::array<GLenum, 2> datum_texture_gl_type() const
+        {
+            switch (this->datum_gpu_format()) {
+            case mplot::datum_format::float16: return { GL_R16F, GL_HALF_FLOAT };
+            case mplot::datum_format::unorm16: return { GL_R16, GL_UNSIGNED_SHORT };
+            case mplot::datum_format::unorm8: return { GL_R8, GL_UNSIGNED_BYTE };
+            default: return { GL_R32F, GL_FLOAT };
+            }
+        }
+
+        /*!
+         * The texels x0 <= x < x1, y0 <= y < y1 of datum_texture, ready to upload in the GPU
+         * format, and the row length (in texels) with which to read them. float32 texels are read
+         * in place, within the rows of the whole texture; others are packed into
+         * datum_texture_packed.
+         */
+        std::pair<const void*, unsigned int> datum_texels_for_upload (const unsigned int x0, const unsigned int y0,
+                                                                      const unsigned int x1, const unsigned int y1)
+        {
+            const std::size_t w = this->datum_texture_dims[0];
+            const mplot::datum_format f = this->datum_gpu_format();
+            if (f == mplot::datum_format::float32) {
+                return { this->datum_texture.data() + y0 * w + x0, static_cast<unsigned int>(w) };
+            }
+            const std::size_t rw = x1 - x0;
+            const std::size_t b = mplot::datum_pack::bytes (f);
+            this->datum_texture_packed.resize (rw * (y1 - y0) * b);
+            for (std::size_t y = y0; y < y1; ++y) {
+                mplot::datum_pack::pack (f, this->datum_texture.data() + y * w + x0, rw, this->datum_texture_packed.data() + (y - y0) * rw * b);
+            }
+            return { this->datum_texture_packed.data(), static_cast<unsigned int>(rw) };
+        }
+
+        //! Call after changing datum_texture, so that it is uploaded before the next render
+        void reinit_datum_texture()
+        {
+            this->datum_texture_changed = true;
+            this->datum_texture_rect = { 0u, 0u, 0u, 0u };
+        }
+
+        /*!
+         * Call after changing only the texels x0 <= x < x1, y0 <= y < y1 of datum_texture, so
+         * that only that rectangle (or the smallest rectangle that bounds it and the others marked
+         * since the last upload) is uploaded before the next render.
+         */
+        void reinit_datum_texture (const unsigned int x0, const unsigned int y0, const unsigned int x1, const unsigned int y1)
+        {
+            if (x0 >= x1 || y0 >= y1) { return; }
+            std::array<unsigned int, 4>& r = this->datum_texture_rect;
+            if (!this->datum_texture_changed) {
+                r = { x0, y0, x1, y1 };
+            } else if (r[2] > 0u) {
+                r = { std::min (r[0], x0), std::min (r[1], y0), std::max (r[2], x1), std::max (r[3], y1) };
+            } // else the whole texture is to be uploaded already
+            this->datum_texture_changed = true;
+        }
+
+        //! Call after changing only the elements [begin, end) of datum_texture (counted in rows
+        //! from texel 0), so that only the part row or the rows that they cover are uploaded
+        void reinit_datum_texels (const std::size_t begin, const std::size_t end)
+        {
+            const std::size_t w = this->datum_texture_dims[0];
+            if (w == 0 || begin >= end) { return; }
+            const unsigned int y0 = static_cast<unsigned int>(begin / w);
+            const unsigned int y1 = static_cast<unsigned int>((end - 1) / w) + 1u;
+            if (y1 - y0 == 1u) {
+                this->reinit_datum_texture (static_cast<unsigned int>(begin % w), y0, static_cast<unsigned int>((end - 1) % w) + 1u, y1);
+            } else {
+                this->reinit_datum_texture (0u, y0, static_cast<unsigned int>(w), y1);
+            }
+        }
+
+        /*!
+         * If true, each entry in vertexDatums is the index of the element (a pixel, a hex) to
+         * which the vertex belongs, and the vertex shader reads that element's datum from
+         * datum_texture. The colours then change by replacing only datum_texture (see
+         * set_element_datums), one float per element, while the positions, normals and
+         * vertexDatums stay as they are in GPU memory. Element indices are exact up to 2^24.
+         */
+        bool colour_by_element = false;
+
+        //! The width of datum_texture in colour_by_element mode. Textures at least this wide
+        //! are supported on all GL versions.
+        static constexpr unsigned int element_texture_width = 2048;
+
+        //! Lay out one datum per element in datum_texture for colour_by_element mode
+        void set_element_datums (const std::vector<float>& d)
+        {
+            const unsigned int n = static_cast<unsigned int>(d.size());
+            const unsigned int w = std::clamp (n, 1u, element_texture_width);
+            const unsigned int h = std::max ((n + w - 1u) / w, 1u);
+            this->datum_texture.assign (d.begin(), d.end());
+            this->datum_texture.resize (std::size_t{w} * h, 0.0f);
+            this->datum_texture_dims = { w, h };
+            this->element_offset = 0;
+            this->element_scale = { 1.0f, 0.0f };
+            this->reinit_datum_texture();
+        }
+
+        /*!
+         * In colour_by_element mode, element e reads its datum d from texel e + element_offset of
+         * datum_texture and is coloured as element_scale[0] * d + element_scale[1]. With several
+         * frames of data stacked in datum_texture, changing element_offset shows another frame
+         * with no upload at all (see VisualDataModel::setPlayback). set_element_datums resets
+         * both to the identity.
+         */
+        int element_offset = 0;
+        //! The linear map of element datums onto [0,1] for the colour lookup (see element_offset)
+        std::array<float, 2> element_scale = { 1.0f, 0.0f };
+
+        /*!
+         * GPU mesh generation (desktop OpenGL 4.3 or later). If gpu_mesh is true, the z positions,
+         * normals and colours of the first gpu_mesh_sources.size() vertices are regenerated from
+         * one datum per element by a compute shader, which writes them straight into the model's
+         * vertex buffers. The z of a vertex is the scaled mean of the data of up to four elements,
+         * its normal is found from the positions of three vertices and its colour is looked up in
+         * colour_lut from the scaled datum of one element. The derived model fills
+         * gpu_mesh_sources when it builds its vertices (see HexGridVisual and CartGridVisual).
+         * After that, a data update is a call to set_gpu_mesh_data() or, if the data are written
+         * by another compute shader into the buffer given to setGpuMeshDataBuffer(), a call to
+         * gpu_mesh_update(), and needs no per-vertex work on the CPU. This does not apply to
+         * streaming, compact or batched models.
+         */
+        bool gpu_mesh = false;
+
+        //! Compute shaders and shader storage buffers need desktop OpenGL 4.3
+        static constexpr bool gpu_mesh_supported = mplot::gl::version::at_least (glver, 4, 3);
+
+        //! Call with true before finalize() to generate the mesh on the GPU. See gpu_mesh.
+        void setGpuMesh (const bool g = true)
+        {
+            if (g && !gpu_mesh_supported) {
+                throw std::runtime_error ("VisualModel::setGpuMesh: GPU mesh generation needs OpenGL 4.3 or later");
+            }
+            this->gpu_mesh = g;
+        }
+
+        //! Where the GPU mesh compute shader finds the values for one vertex. The layout matches
+        //! the MeshSource struct in VisualGpuMesh.comp.glsl.
+        struct gpu_mesh_source
+        {
+            //! The elements whose mean datum gives the vertex z (-1 for none; all -1 keeps the z)
+            std::array<GLint, 4> z_src = { -1, -1, -1, -1 };
+            //! Vertices v0, v1 and v2; the normal is (v2 - v0) x (v1 - v0) (-1 keeps the normal)
+            std::array<GLint, 3> norm_src = { -1, -1, -1 };
+            //! The element whose datum gives the colour (-1 keeps the colour)
+            GLint colour_src = -1;
+        };
+        static_assert (sizeof (gpu_mesh_source) == 8u * sizeof (GLint), "gpu_mesh_source must match the std430 MeshSource struct");
+
+        //! One gpu_mesh_source for each of the first gpu_mesh_sources.size() vertices
+        std::vector<gpu_mesh_source> gpu_mesh_sources;
+        //! The z of a vertex is gpu_mesh_zscale[0] * datum + gpu_mesh_zscale[1]
+        std::array<float, 2> gpu_mesh_zscale = { 1.0f, 0.0f };
+        //! The position in colour_lut of a datum is gpu_mesh_cscale[0] * datum + gpu_mesh_cscale[1]
+        std::array<float, 2> gpu_mesh_cscale = { 1.0f, 0.0f };
+        /*!
+         * If gpu_mesh_autoscale[0] is true, gpu_mesh_zscale is not used. Instead, each time the
+         * mesh is generated, the range of the data is found on the GPU and mapped linearly onto
+         * gpu_mesh_zrange. Likewise for the colours, with gpu_mesh_autoscale[1] and
+         * gpu_mesh_crange. The data then need never come to the CPU to be autoscaled.
+         */
+        std::array<bool, 2> gpu_mesh_autoscale = { false, false };
+        std::array<float, 2> gpu_mesh_zrange = { 0.0f, 1.0f };
+        std::array<float, 2> gpu_mesh_crange = { 0.0f, 1.0f };
+
+        //! Call after changing gpu_mesh_sources
+        void reinit_gpu_mesh_sources()
+        {
+            this->gpu_mesh_sources_changed = true;
+            this->gpu_mesh_update();
+        }
+
+        //! Set the data (one float per element) from which the mesh is generated in gpu_mesh mode
+        void set_gpu_mesh_data (std::vector<float>&& d)
+        {
+            this->gpu_mesh_data = std::move (d);
+            this->gpu_mesh_data_changed = true;
+            this->gpu_mesh_update();
+        }
+
+        /*!
+         * Generate the mesh from the data in the shader storage buffer buf (one float per element),
+         * rather than from set_gpu_mesh_data(). The buffer is not owned by the model. Pass 0 to go
+         * back to the model's own data buffer.
+         */
+        void setGpuMeshDataBuffer (const GLuint buf)
+        {
+            this->gpu_mesh_external_data = buf;
+            this->gpu_mesh_update();
+        }
+
+        //! Regenerate the mesh on the GPU before the next render (for example, after writing to
+        //! the buffer given to setGpuMeshDataBuffer)
+        void gpu_mesh_update()
+        {
+            this->gpu_mesh_pending = true;
+            this->scene_changed();
+        }
+
+        /*!
+         * Voronoi cells computed on the GPU by jump flooding (desktop OpenGL 4.3 or later). Once
+         * set_jump_flood_grid() has laid a grid of texels over a rectangle of the model's x/y
+         * plane, each render after the sites or their data have changed runs a compute shader:
+         * it seeds the grid with the sites, floods each texel with its nearest site in about
+         * log2 of the grid's width steps, and writes to each texel the datum of its site. That
+         * texture is then the model's datum texture (see colour_by_datum_texture), so one
+         * rectangle over the grid shows the cells, coloured through colour_lut and datum_scale,
+         * at a cost that depends on the number of texels, not of sites. Moving the sites, or
+         * changing their data, is a buffer upload. See VoronoiVisual::jump_flood.
+         */
+        static constexpr bool jump_flood_supported = gpu_mesh_supported;
+
+        //! Flood a grid of dims texels over the rectangle from lo to hi in model x and y
+        void set_jump_flood_grid (const std::array<float, 2>& lo, const std::array<float, 2>& hi,
+                                  const std::array<unsigned int, 2>& dims)
+        {
+            if (!jump_flood_supported) {
+                throw std::runtime_error ("VisualModel::set_jump_flood_grid: jump flooding needs OpenGL 4.3 or later");
+            }
+            if (dims[0] == 0u || dims[1] == 0u || !(hi[0] > lo[0]) || !(hi[1] > lo[1])) {
+                throw std::runtime_error ("VisualModel::set_jump_flood_grid: the grid is empty");
+            }
+            this->jump_flood_lo = lo;
+            this->jump_flood_hi = hi;
+            this->jump_flood_dims = dims;
+            this->datum_texture_dims = dims;
+            this->jump_flood_pending = true;
+            this->scene_changed();
+        }
+
+        //! Set the x and y of the sites, in model coordinates. Sites outside the grid's
+        //! rectangle own no texels.
+        void set_jump_flood_sites (std::vector<std::array<float, 2>>&& s)
+        {
+            this->jump_flood_sites = std::move (s);
+            this->jump_flood_sites_changed = true;
+            this->jump_flood_pending = true;
+            this->scene_changed();
+        }
+
+        //! Set the datum of each site (one per site; missing data are 0)
+        void set_jump_flood_data (std::vector<float>&& d)
+        {
+            this->jump_flood_data = std::move (d);
+            this->jump_flood_data_changed = true;
+            this->jump_flood_pending = true;
+            this->scene_changed();
+        }
+
+        //! True if the model's datum texture comes from jump flooding
+        bool has_jump_flood() const { return this->jump_flood_dims[0] > 0u; }
+
+        //! The number of steps of flooding for the grid: one for each halving of the step from
+        //! half the grid's larger side down to 1, and one more step of 1, which corrects most of
+        //! the texels that the halving steps assign to a site other than their nearest
+        unsigned int jump_flood_steps() const
+        {
+            unsigned int steps = 1u;
+            for (unsigned int k = std::max (this->jump_flood_dims[0], this->jump_flood_dims[1]) / 2u; k > 0u; k /= 2u) { ++steps; }
+            return steps;
+        }
+
+        /*!
+         * Draw the model with its vertex colours read from buf, a client-owned buffer of three
+         * floats per vertex, rather than from vertexColors. buf may be a shader storage buffer
+         * that a compute shader writes (for example one of an mplot::gl::compute_manager's), in
+         * this context or one that shares its objects, so the colours need never come back to the
+         * CPU. Call requestRedraw() after each write. Pass 0 to go back to vertexColors. This does
+         * not apply to streaming, compact or batched models.
+         */
+        void setColourBuffer (const GLuint buf)
+        {
+            this->external_colour_buffer = buf;
+            this->colour_buffer_changed = true;
+            this->scene_changed();
+        }
+
+        /*!
+         * In colour_by_datum_texture mode, sample the datums from tex, a client-owned single
+         * channel float texture of datum_texture_dims texels, rather than from datum_texture.
+         * tex may be an image that a compute shader writes (see mplot::gl::texture_pingpong), so
+         * the data go from the simulation to the screen without passing through the CPU. Each
+         * texel d is coloured as datum_scale[0] * d + datum_scale[1]. Call requestRedraw() after
+         * each write. Pass 0 to go back to datum_texture.
+         */
+        void setDatumTexture (const GLuint tex)
+        {
+            this->external_datum_texture = tex;
+            this->scene_changed();
+        }
+
+        //! The linear map of the texels of the datum texture onto [0,1] for the colour lookup.
+        //! datum_texture holds values that are already colour scaled, so this is the identity
+        //! unless the datums come from a client's texture (see setDatumTexture).
+        std::array<float, 2> datum_scale = { 1.0f, 0.0f };
+
+        //! Added to the texture coordinates at which the datum texture is sampled. Moving a
+        //! pattern held in a repeating texture (see datum_texture_repeat) is then one uniform.
+        std::array<float, 2> datum_texture_offset = { 0.0f, 0.0f };
+
+        //! If true, the datum texture repeats beyond [0,1] rather than clamping to its edges.
+        //! Set before the first render.
+        bool datum_texture_repeat = false;
+
+        //! The units of the widths of the lines of cell_grid
+        enum class cell_grid_units { none, texels, pixels };
+
+        /*!
+         * Lines that the fragment shader draws along the edges of the texels of the datum texture
+         * (for colour_by_datum_texture), so that a grid of cells needs no vertices and stays
+         * crisp at any zoom. The widths are across the texture's first and second axes, in texels
+         * or in pixels of the framebuffer. With border, the fragments at which the texture
+         * coordinates lie outside [0,1] (a margin of the model's rectangle beyond the texture)
+         * take border_colour. Changing any of these is a change of uniform (see GridVisual).
+         */
+        struct cell_grid_lines
+        {
+            cell_grid_units units = cell_grid_units::none;
+            std::array<float, 2> width = { 0.0f, 0.0f };
+            std::array<float, 3> colour = mplot::colour::grey80;
+            bool border = false;
+            std::array<float, 3> border_colour = mplot::colour::grey80;
+        };
+        cell_grid_lines cell_grid;
+
+        /*!
+         * Polylines drawn by the GPU. Only the points of a polyline are uploaded (with the arc
+         * length to each point); a vertex shader expands each segment into a quad of the
+         * polyline's width, mitring the joins, and the fragment shader cuts the dashes. Changing
+         * a width, a colour or the dashes is then a change of uniform, with no work on the CPU
+         * and no upload. A width may be given in model units (so that the line scales with the
+         * model, as a computeFlatLine does) or in pixels (so that it does not). The polylines
+         * are drawn after the model's triangles. A model that adds them in initializeVertices()
+         * has them cleared, with its vertices, on reinit().
+         *
+         * The points need not be in model coordinates. Each polyline has a transform (see
+         * polyline_transform) that the vertex shader applies to its points, so that moving a
+         * polyline onto new axes, or onto log axes, is also a change of uniform. A clip box in
+         * model coordinates, outside which the fragment shader discards the line, goes with it.
+         */
+
+        /*!
+         * The transform of the x and y of a polyline's points to model coordinates. For x (and
+         * likewise for y) model_x = scale[0] * f (pre_scale[0] * x + pre_offset[0]) + offset[0],
+         * where f is the natural log if log[0] is true and the identity otherwise. z is unchanged.
+         * The default is the identity.
+         */
+        struct polyline_transform
+        {
+            std::array<float, 2> pre_scale = { 1.0f, 1.0f };
+            std::array<float, 2> pre_offset = { 0.0f, 0.0f };
+            std::array<bool, 2> log = { false, false };
+            std::array<float, 2> scale = { 1.0f, 1.0f };
+            std::array<float, 2> offset = { 0.0f, 0.0f };
+
+            //! Apply the transform to the point d (as the vertex shader does)
+            sm::vec<float> apply (const sm::vec<float>& d) const
+            {
+                sm::vec<float> m = d;
+                for (unsigned int j = 0; j < 2u; ++j) {
+                    float u = this->pre_scale[j] * d[j] + this->pre_offset[j];
+                    if (this->log[j]) { u = std::log (u); }
+                    m[j] = this->scale[j] * u + this->offset[j];
+                }
+                return m;
+            }
+
+            //! True if this is the identity transform
+            bool is_identity() const
+            {
+                return this->pre_scale == std::array<float, 2>{ 1.0f, 1.0f } && this->pre_offset == std::array<float, 2>{ 0.0f, 0.0f }
+                && !this->log[0] && !this->log[1]
+                && this->scale == std::array<float, 2>{ 1.0f, 1.0f } && this->offset == std::array<float, 2>{ 0.0f, 0.0f };
+            }
+        };
+
+        struct polyline
+        {
+            //! The index in polyline_points of the copy of the first point that precedes it
+            std::size_t first = 0;
+            //! The number of points
+            std::size_t count = 0;
+            std::array<float, 3> colour = { 0.0f, 0.0f, 0.0f };
+            float width = 0.1f;
+            //! If true, width is in pixels on the screen. Otherwise it is in model units.
+            bool width_in_pixels = false;
+            //! The normal of the plane in which a polyline of model units width is expanded
+            sm::vec<float> normal = { 0.0f, 0.0f, 1.0f };
+            //! The lengths (in model units, along the line) of the dashes and of the gaps between
+            //! them. The line is solid if gap is 0.
+            float dash = 0.0f;
+            float gap = 0.0f;
+            //! The transform of the points to model coordinates
+            polyline_transform transform;
+            //! The clip box (x min, x max, y min, y max) in model coordinates. No clipping if
+            //! clip[0] > clip[1].
+            std::array<float, 4> clip = { 1.0f, 0.0f, 1.0f, 0.0f };
+        };
+
+        /*!
+         * Add a polyline through the points pts, of colour clr and width w, expanded in the plane
+         * with normal _uz. Returns its index, for the set_polyline_* functions.
+         */
+        std::size_t add_polyline (std::span<const sm::vec<float>> pts, const std::array<float, 3>& clr,
+                                  const float w = 0.1f, const sm::vec<float>& _uz = { 0.0f, 0.0f, 1.0f })
+        {
+            polyline pl;
+            pl.first = this->polyline_points.size() / 4u;
+            pl.count = pts.size();
+            pl.colour = clr;
+            pl.width = w;
+            pl.normal = _uz;
+            this->polyline_points.resize (this->polyline_points.size() + 4u * (pts.size() + 2u));
+            this->write_polyline_points (pl, pts);
+            this->polylines.push_back (pl);
+            this->polylines_changed = true;
+            this->scene_changed();
+            return this->polylines.size() - 1u;
+        }
+
+        /*!
+         * Change the points of polyline i. If there are as many points as before they are
+         * rewritten in place; otherwise all of the polylines are repacked. Either way, the points
+         * are uploaded at the next render.
+         */
+        void set_polyline_points (const std::size_t i, std::span<const sm::vec<float>> pts)
+        {
+            polyline& pl = this->polylines.at (i);
+            if (pts.size() != pl.count) {
+                // Repack, with polyline i's points replaced
+                std::vector<float> packed;
+                packed.reserve (this->polyline_points.size() + 4u * pts.size());
+                for (std::size_t j = 0; j < this->polylines.size(); ++j) {
+                    polyline& pj = this->polylines[j];
+                    const std::size_t n_floats = 4u * ((j == i ? pts.size() : pj.count) + 2u);
+                    const std::size_t old_first = pj.first;
+                    pj.first = packed.size() / 4u;
+                    if (j == i) {
+                        pj.count = pts.size();
+                        packed.resize (packed.size() + n_floats);
+                    } else {
+                        packed.insert (packed.end(), this->polyline_points.begin() + 4u * old_first,
+                                       this->polyline_points.begin() + 4u * old_first + n_floats);
+                    }
+                }
+                this->polyline_points.swap (packed);
+            }
+            this->write_polyline_points (pl, pts);
+            this->polylines_changed = true;
+            this->scene_changed();
+        }
+
+        //! Set the width of polyline i, in pixels if in_pixels is true and otherwise in model units
+        void set_polyline_width (const std::size_t i, const float w, const bool in_pixels = false)
+        {
+            this->polylines.at (i).width = w;
+            this->polylines.at (i).width_in_pixels = in_pixels;
+            this->scene_changed();
+        }
+
+        //! Set the colour of polyline i
+        void set_polyline_colour (const std::size_t i, const std::array<float, 3>& clr)
+        {
+            this->polylines.at (i).colour = clr;
+            this->scene_changed();
+        }
+
+        //! Draw polyline i dashed, with dashes of length dash and gaps of length gap (in model
+        //! units). A gap of 0 makes the line solid again.
+        void set_polyline_dashes (const std::size_t i, const float dash, const float gap)
+        {
+            polyline& pl = this->polylines.at (i);
+            // The arc lengths are those of the transformed line only while it is dashed
+            if (pl.gap <= 0.0f && gap > 0.0f && !pl.transform.is_identity()) { this->rewrite_arc_lengths (pl); }
+            pl.dash = dash;
+            pl.gap = gap;
+            this->scene_changed();
+        }
+
+        /*!
+         * Set the transform of the points of polyline i to model coordinates. This is a change
+         * of uniform, with no upload, unless the polyline is dashed, in which case its arc
+         * lengths are recomputed along the transformed line and uploaded.
+         */
+        void set_polyline_transform (const std::size_t i, const polyline_transform& t)
+        {
+            polyline& pl = this->polylines.at (i);
+            pl.transform = t;
+            if (pl.gap > 0.0f) { this->rewrite_arc_lengths (pl); }
+            this->scene_changed();
+        }
+
+        //! Clip polyline i to the box x in [xmin, xmax], y in [ymin, ymax] (in model coordinates).
+        //! A box with xmin > xmax turns the clipping off.
+        void set_polyline_clip (const std::size_t i, const std::array<float, 4>& box)
+        {
+            this->polylines.at (i).clip = box;
+            this->scene_changed();
+        }
+
+        //! Remove all the polylines
+        void clear_polylines()
+        {
+            this->polylines.clear();
+            this->polyline_points.clear();
+            this->polylines_changed = true;
+        }
+
+        //! Remove the polylines from index n onwards, keeping the first n
+        void truncate_polylines (const std::size_t n)
+        {
+            if (n >= this->polylines.size()) { return; }
+            this->polyline_points.resize (4u * this->polylines[n].first);
+            this->polylines.resize (n);
+            this->polylines_changed = true;
+            this->scene_changed();
+        }
+
+        //! The model's polylines (see add_polyline)
+        const std::vector<polyline>& get_polylines() const { return this->polylines; }
+
+        //! True if the model has polylines to draw
+        bool has_polylines() const { return !this->polylines.empty(); }
+
+        /*!
+         * Sphere impostors: points drawn by the GPU as spheres. Each sprite is 16 bytes (its
+         * position and an RGBA8 colour), however many there are, and is drawn as one GL_POINTS
+         * vertex. The fragment shader intersects the view ray with the sprite's sphere, so each
+         * sphere is shaded and depth tested as a true sphere would be. The radius of a sprite is
+         * sprite_radius (a uniform, so changing it needs no upload) times the sprite's size,
+         * which is stored in the alpha byte. Sprites can be no larger on the screen than the
+         * largest point size that the GL implementation supports.
+         */
+        struct sprite
+        {
+            std::array<float, 3> posn = { 0.0f, 0.0f, 0.0f };
+            //! The colour in rgb, and the size (a proportion of sprite_radius) in a
+            std::array<std::uint8_t, 4> colour = { 0, 0, 0, 255 };
+        };
+        static_assert (sizeof (sprite) == 16u, "sprite must be 16 bytes, as its vertex attributes assume");
+
+        //! Add a sprite at p of colour clr, of radius size * sprite_radius (size is clamped to [0, 1])
+        void add_sprite (const sm::vec<float>& p, const std::array<float, 3>& clr, const float size = 1.0f)
+        {
+            sprite sp;
+            sp.posn = { p[0], p[1], p[2] };
+            sp.colour = { to_colour_byte (clr[0]), to_colour_byte (clr[1]), to_colour_byte (clr[2]), to_colour_byte (size) };
+            this->sprite_dirty_first = std::min (this->sprite_dirty_first, this->sprites.size());
+            this->sprites.push_back (sp);
+            this->sprites_changed = true;
+            this->scene_changed();
+        }
+
+        //! Replace sprite i. Only the sprites from the first changed one onwards are uploaded.
+        void set_sprite (const std::size_t i, const sm::vec<float>& p, const std::array<float, 3>& clr, const float size = 1.0f)
+        {
+            sprite& sp = this->sprites.at (i);
+            sp.posn = { p[0], p[1], p[2] };
+            sp.colour = { to_colour_byte (clr[0]), to_colour_byte (clr[1]), to_colour_byte (clr[2]), to_colour_byte (size) };
+            this->sprite_dirty_first = std::min (this->sprite_dirty_first, i);
+            this->sprites_changed = true;
+            this->scene_changed();
+        }
+
+        //! Change the colour of sprite i, keeping its position and size
+        void set_sprite_colour (const std::size_t i, const std::array<float, 3>& clr)
+        {
+            sprite& sp = this->sprites.at (i);
+            for (std::size_t j = 0; j < 3u; ++j) { sp.colour[j] = to_colour_byte (clr[j]); }
+            this->sprite_dirty_first = std::min (this->sprite_dirty_first, i);
+            this->sprites_changed = true;
+            this->scene_changed();
+        }
+
+        //! A colour component (or sprite size) in [0, 1] as a byte
+        static std::uint8_t to_colour_byte (const float c)
+        {
+            return static_cast<std::uint8_t>(std::clamp (c, 0.0f, 1.0f) * 255.0f + 0.5f);
+        }
+
+        //! Reserve space for n sprites
+        void reserve_sprites (const std::size_t n) { this->sprites.reserve (n); }
+
+        //! Set the radius (in model units) of a sprite of size 1. No upload is needed.
+        void set_sprite_radius (const float r)
+        {
+            this->sprite_radius = r;
+            this->scene_changed();
+        }
+
+        //! Remove all the sprites
+        void clear_sprites()
+        {
+            this->sprites.clear();
+            this->sprite_dirty_first = 0;
+            this->sprites_changed = true;
+        }
+
+        //! True if the model has sprites to draw
+        bool has_sprites() const { return !this->sprites.empty(); }
+
+        /*!
+         * Bars: rectangles standing on a common base line, as in a bar graph or a histogram, each
+         * drawn by the GPU from 8 bytes (the x of its centre and the y of its top). A set of bars
+         * is one instanced draw of six vertices per bar, with its width, base, colours and
+         * outline in uniforms, so changing the heights of the bars is one small buffer write.
+         */
+        struct bar_set
+        {
+            //! The index in bar_data of the first bar (in pairs of floats)
+            std::size_t first = 0;
+            //! The number of bars
+            std::size_t count = 0;
+            //! The width of each bar, in model units
+            float width = 0.1f;
+            //! The y of the base of the bars
+            float base = 0.0f;
+            //! The z at which the bars are drawn
+            float z = 0.0f;
+            std::array<float, 3> colour = { 0.0f, 0.0f, 0.0f };
+            //! The outline, drawn over the sides and top of each bar (not its base). No outline
+            //! is drawn if line_width is 0.
+            std::array<float, 3> line_colour = { 0.0f, 0.0f, 0.0f };
+            float line_width = 0.0f;
+        };
+
+        //! Add a set of bars, one for each (x, top) in bars, with the width, base, z and colours
+        //! of bs. Returns its index, for set_bars and set_bar_tops.
+        std::size_t add_bars (std::span<const sm::vec<float, 2>> bars, const bar_set& bs)
+        {
+            bar_set b = bs;
+            b.first = this->bar_data.size() / 2u;
+            b.count = bars.size();
+            this->bar_data.reserve (this->bar_data.size() + 2u * bars.size());
+            for (const auto& xy : bars) { this->bar_data.insert (this->bar_data.end(), { xy[0], xy[1] }); }
+            this->mark_bars_dirty (b.first, this->bar_data.size() / 2u);
+            this->bar_sets.push_back (b);
+            this->scene_changed();
+            return this->bar_sets.size() - 1u;
+        }
+
+        /*!
+         * Change the tops of the bars of set i (tops must have one entry per bar). Only these
+         * bars are uploaded, at the next render.
+         */
+        void set_bar_tops (const std::size_t i, std::span<const float> tops)
+        {
+            const bar_set& b = this->bar_sets.at (i);
+            if (tops.size() != b.count) {
+                throw std::runtime_error ("VisualModel::set_bar_tops: tops must have one entry per bar (see set_bars)");
+            }
+            float* out = this->bar_data.data() + 2u * b.first;
+            for (std::size_t j = 0; j < b.count; ++j) { out[2u * j + 1u] = tops[j]; }
+            this->mark_bars_dirty (b.first, b.first + b.count);
+            this->scene_changed();
+        }
+
+        //! Replace the bars of set i. If there are as many as before they are rewritten in place;
+        //! otherwise all of the bar sets are repacked.
+        void set_bars (const std::size_t i, std::span<const sm::vec<float, 2>> bars)
+        {
+            bar_set& b = this->bar_sets.at (i);
+            if (bars.size() != b.count) {
+                std::vector<float> packed;
+                packed.reserve (this->bar_data.size() + 2u * bars.size());
+                for (std::size_t j = 0; j < this->bar_sets.size(); ++j) {
+                    bar_set& bj = this->bar_sets[j];
+                    const std::size_t old_first = bj.first;
+                    bj.first = packed.size() / 2u;
+                    if (j == i) {
+                        bj.count = bars.size();
+                        packed.resize (packed.size() + 2u * bars.size());
+                    } else {
+                        packed.insert (packed.end(), this->bar_data.begin() + 2u * old_first,
+                                       this->bar_data.begin() + 2u * (old_first + bj.count));
+                    }
+                }
+                this->bar_data.swap (packed);
+                this->mark_bars_dirty (0, this->bar_data.size() / 2u);
+            } else {
+                this->mark_bars_dirty (b.first, b.first + b.count);
+            }
+            float* out = this->bar_data.data() + 2u * b.first;
+            for (std::size_t j = 0; j < bars.size(); ++j) {
+                out[2u * j] = bars[j][0];
+                out[2u * j + 1u] = bars[j][1];
+            }
+            this->scene_changed();
+        }
+
+        //! Set the colour and outline of bar set i. No upload is needed.
+        void set_bar_colours (const std::size_t i, const std::array<float, 3>& clr,
+                              const std::array<float, 3>& line_clr, const float line_w)
+        {
+            bar_set& b = this->bar_sets.at (i);
+            b.colour = clr;
+            b.line_colour = line_clr;
+            b.line_width = line_w;
+            this->scene_changed();
+        }
+
+        //! Remove all the bars
+        void clear_bars()
+        {
+            this->bar_sets.clear();
+            this->bar_data.clear();
+            this->bar_dirty = { 0, 0 };
+        }
+
+        //! The model's bar sets (see add_bars)
+        const std::vector<bar_set>& get_bar_sets() const { return this->bar_sets; }
+
+        //! True if the model has bars to draw
+        bool has_bars() const { return !this->bar_sets.empty(); }
+
+        /*!
+         * A volume: a 3D field of datums in [0,1] that fills the box from box_min to box_max
+         * (in model coordinates) and is drawn by ray marching. The datums are held on the GPU
+         * in a 3D texture, and the box is drawn as its front faces in one draw call, each
+         * fragment of which marches its view ray through the texture. Each sample is coloured
+         * through colour_lut and given the opacity of volume_density times its datum per voxel
+         * of ray; the samples are composited front to back, and the march stops once the ray
+         * is (almost) opaque. A coarse texture of the maxima of the bricks of the volume (see
+         * mplot/volume_bricks.h) lets a ray jump over bricks whose datums are no more than
+         * volume_threshold, which are transparent. The camera should be outside the box, and
+         * the volume is not hidden by other models inside it.
+         *
+         * vals holds dims[0] * dims[1] * dims[2] datums, with x varying fastest, then y, then z.
+         * Datums that are NaN are transparent.
+         */
+        void set_volume (std::span<const float> vals, const std::array<unsigned int, 3>& dims,
+                         const sm::vec<float>& box_min, const sm::vec<float>& box_max)
+        {
+            const std::size_t n = std::size_t{dims[0]} * dims[1] * dims[2];
+            if (vals.size() != n) {
+                throw std::runtime_error ("VisualModel::set_volume: vals must hold dims[0] * dims[1] * dims[2] datums");
+            }
+            this->volume.assign (vals.begin(), vals.end());
+            this->volume_dims = dims;
+            this->volume_box = { box_min, box_max };
+            this->volume_changed = true;
+            this->scene_changed();
+        }
+
+        //! Write the datums of the volume through the returned span, then call reinit_volume()
+        std::span<float> volume_datums() { return this->volume; }
+
+        //! Call after writing to volume_datums(), so that the volume is uploaded before the next render
+        void reinit_volume()
+        {
+            this->volume_changed = true;
+            this->scene_changed();
+        }
+
+        /*!
+         * Set the transfer of the volume: density is the opacity of a voxel of datum 1 (a datum
+         * d is d * density opaque), step the spacing of the samples along a ray in voxels and
+         * threshold the datum at or below which a sample (or a brick) is transparent. No
+         * upload is needed.
+         */
+        void set_volume_transfer (const float density, const float step = 0.5f, const float threshold = 0.0f)
+        {
+            this->volume_density = std::clamp (density, 0.0f, 1.0f);
+            this->volume_step = std::max (step, 0.01f);
+            this->volume_threshold = threshold;
+            this->scene_changed();
+        }
+
+        //! Remove the volume
+        void clear_volume()
+        {
+            this->volume.clear();
+            this->volume.shrink_to_fit();
+            this->volume_dims = { 0u, 0u, 0u };
+            this->volume_changed = true;
+        }
+
+        //! True if the model has a volume to draw
+        bool has_volume() const { return !this->volume.empty(); }
+
+        /*!
+         * The format in which the volume is held on the GPU: float16 (GL_R16F, the default) or
+         * float32 (GL_R32F), which takes twice the memory. A float32 volume is sampled with
+         * the nearest texel on OpenGL ES, which can't filter it. Other formats are taken as
+         * float16. Set before the first render.
+         */
+        mplot::datum_format volume_format = mplot::datum_format::float16;
+
+        //! The GL internal format, pixel type and filter of the volume texture
+        std::array<GLenum, 3> volume_texture_gl_type() const
+        {
+            if (this->volume_format == mplot::datum_format::float32) {
+                if constexpr (mplot::gl::version::gles (glver)) { return { GL_R32F, GL_FLOAT, GL_NEAREST }; }
+                return { GL_R32F, GL_FLOAT, GL_LINEAR };
+            }
+            return { GL_R16F, GL_HALF_FLOAT, GL_LINEAR };
+        }
+
+        //! True if the volume's box is seen in a mirror (its view and model matrices, or its
+        //! corners, flip an odd number of axes), so that its front faces wind clockwise
+        bool volume_mirrored() const
+        {
+            const sm::mat44<float> vm = this->scenematrix * this->model_matrix();
+            const auto& m = vm.mat;
+            const float det = m[0] * (m[5] * m[10] - m[9] * m[6])
+            - m[4] * (m[1] * m[10] - m[9] * m[2])
+            + m[8] * (m[1] * m[6] - m[5] * m[2]);
+            bool mirrored = det < 0.0f;
+            for (unsigned int j = 0; j < 3u; ++j) {
+                if (this->volume_box[1][j] < this->volume_box[0][j]) { mirrored = !mirrored; }
+            }
+            return mirrored;
+        }
+
+        /*!
+         * A spike raster: events, each the time of a spike and the index of the neuron that
+         * fired, held in a ring of raster_capacity events and drawn by the GPU as a tick (one
+         * instance of six vertices) or as a point, at x = (t - t0) / (t1 - t0) * raster_extent[0]
+         * and y = neuron * raster_extent[1]. Appending events writes them into the ring,
+         * overwriting the oldest once it is full, and only the appended events are uploaded, so
+         * appends cost O(events) however many the ring holds. The window [t0, t1] of time that
+         * is shown, the size of the ticks and the colours of the populations (ranges of neurons)
+         * are uniforms, so that scrolling the window needs no upload. Events outside the window
+         * are not drawn.
+         */
+        struct raster_event
+        {
+            float t = 0.0f;
+            std::uint32_t neuron = 0;
+        };
+        static_assert (sizeof (raster_event) == 8u, "raster_event must be 8 bytes, as its vertex attributes assume");
+
+        //! A population of neurons, from neuron first up to the first neuron of the next
+        struct raster_population
+        {
+            std::uint32_t first = 0;
+            std::array<float, 3> colour = { 0.0f, 0.0f, 0.0f };
+        };
+
+        //! The most populations that a raster can colour
+        static constexpr unsigned int raster_max_populations = 16;
+
+        //! Make the raster a ring of n events. Any events in the raster are discarded.
+        void set_raster_capacity (const std::size_t n)
+        {
+            this->raster_ring.assign (n, raster_event{});
+            this->raster_total = 0;
+            this->raster_uploaded = 0;
+            this->raster_realloc = true;
+            this->scene_changed();
+        }
+
+        //! The number of events the raster's ring holds
+        std::size_t raster_capacity() const { return this->raster_ring.size(); }
+
+        //! Append the events ev to the raster
+        void append_raster_events (std::span<const raster_event> ev)
+        {
+            const std::size_t n = this->raster_ring.size();
+            if (n == 0) { throw std::runtime_error ("VisualModel::append_raster_events: set_raster_capacity first"); }
+            // Only the last n of the events can be held
+            const std::size_t skip = ev.size() > n ? ev.size() - n : 0u;
+            this->raster_total += skip;
+            for (std::size_t i = skip; i < ev.size(); ++i) { this->raster_ring[this->raster_total++ % n] = ev[i]; }
+            this->scene_changed();
+        }
+
+        //! Append one event, a spike of neuron at time t
+        void append_raster_event (const float t, const std::uint32_t neuron)
+        {
+            const raster_event e = { t, neuron };
+            this->append_raster_events (std::span<const raster_event>(&e, 1));
+        }
+
+        //! Show the events from time t0 to t1. No upload is needed.
+        void set_raster_window (const float t0, const float t1)
+        {
+            this->raster_window = { t0, t1 };
+            this->scene_changed();
+        }
+
+        //! Colour the neurons by population. pops are sorted by their first neurons; the neurons
+        //! before the first population take raster_colour.
+        void set_raster_populations (std::span<const raster_population> pops)
+        {
+            if (pops.size() > raster_max_populations) {
+                throw std::runtime_error ("VisualModel::set_raster_populations: too many populations");
+            }
+            this->raster_populations.assign (pops.begin(), pops.end());
+            std::sort (this->raster_populations.begin(), this->raster_populations.end(),
+                       [](const raster_population& a, const raster_population& b) { return a.first < b.first; });
+            this->scene_changed();
+        }
+
+        //! Remove the raster
+        void clear_raster()
+        {
+            this->raster_ring.clear();
+            this->raster_ring.shrink_to_fit();
+            this->raster_total = 0;
+            this->raster_uploaded = 0;
+            this->raster_realloc = true;
+        }
+
+        //! True if the model has a raster to draw
+        bool has_raster() const { return !this->raster_ring.empty(); }
+
+        //! The number of events in the raster (no more than its capacity)
+        std::size_t raster_count() const
+        {
+            return static_cast<std::size_t>(std::min (this->raster_total, static_cast<std::uint64_t>(this->raster_ring.size())));
+        }
+
+        //! The width of the raster (the window of time) and the height of a neuron's row, in model units
+        std::array<float, 2> raster_extent = { 1.0f, 0.01f };
+        //! The width of a tick in model units, and its height as a proportion of a row
+        std::array<float, 2> raster_tick = { 0.002f, 0.8f };
+        //! If true, draw each event as a point of raster_point_size pixels rather than as a tick
+        bool raster_points = false;
+        float raster_point_size = 2.0f;
+        //! The colour of the events of neurons in no population
+        std::array<float, 3> raster_colour = { 0.0f, 0.0f, 0.0f };
+        //! The z at which the raster is drawn
+        float raster_z = 0.0f;
+
+        /*!
+         * A cache of point cloud nodes on the GPU, for models that stream points in and out (see
+         * PointCloudVisual). The cache is one vertex buffer of cloud_slots slots, each of room for
+         * cloud_slot_points cloud_points. A slot is written with write_cloud_slot, which queues
+         * the points to be uploaded into it at the next render and then frees them, so the host
+         * holds only the points that have yet to be uploaded. Each render draws the slots and
+         * counts given to set_cloud_draws as flat coloured GL_POINTS of cloud_point_size pixels.
+         */
+        struct cloud_point
+        {
+            std::array<float, 3> p = { 0.0f, 0.0f, 0.0f };
+            //! The colour, RGBA8 (red in the lowest byte)
+            std::uint32_t rgba = 0;
+        };
+        static_assert (sizeof (cloud_point) == 16u, "cloud_point must be 16 bytes, as its vertex attributes assume");
+
+        //! The points to draw from one slot of the cache
+        struct cloud_draw
+        {
+            std::uint32_t slot = 0;
+            std::uint32_t count = 0;
+        };
+
+        //! Make the cache n_slots slots of slot_points points. Anything in the cache is discarded.
+        void set_cloud_slots (const std::size_t n_slots, const std::size_t slot_points)
+        {
+            this->cloud_slots = n_slots;
+            this->cloud_slot_points = slot_points;
+            this->cloud_writes.clear();
+            this->cloud_draws.clear();
+            this->cloud_realloc = true;
+            this->scene_changed();
+        }
+
+        //! The number of slots in the cache and the number of points each holds
+        std::size_t cloud_slot_count() const { return this->cloud_slots; }
+        std::size_t cloud_slot_size() const { return this->cloud_slot_points; }
+
+        //! Upload pts into slot at the next render
+        void write_cloud_slot (const std::uint32_t slot, std::vector<cloud_point>&& pts)
+        {
+            if (slot >= this->cloud_slots || pts.size() > this->cloud_slot_points) {
+                throw std::runtime_error ("VisualModel::write_cloud_slot: no such slot, or too many points for a slot");
+            }
+            this->cloud_writes.emplace_back (slot, std::move (pts));
+            this->scene_changed();
+        }
+
+        //! Draw these slots of the cache (each from its first point) from the next render on
+        void set_cloud_draws (std::vector<cloud_draw>&& d)
+        {
+            this->cloud_draws = std::move (d);
+            this->scene_changed();
+        }
+
+        //! Remove the point cloud cache
+        void clear_cloud()
+        {
+            this->cloud_slots = 0;
+            this->cloud_slot_points = 0;
+            this->cloud_writes.clear();
+            this->cloud_draws.clear();
+            this->cloud_realloc = true;
+        }
+
+        //! True if the model has a point cloud cache
+        bool has_cloud() const { return this->cloud_slots > 0 && this->cloud_slot_points > 0; }
+
+        //! The size of the cloud's points, in pixels
+        float cloud_point_size = 2.0f;
+
+        //! The bytes of colour for clr (in [0,1]) with alpha 255, as a cloud_point's rgba
+        static std::uint32_t cloud_rgba (const std::array<float, 3>& clr)
+        {
+            auto b = [](const float c) { return static_cast<std::uint32_t>(std::clamp (c, 0.0f, 1.0f) * 255.0f + 0.5f); };
+            return b (clr[0]) | (b (clr[1]) << 8) | (b (clr[2]) << 16) | (0xffu << 24);
+        }
+
+        //! True if the model must be told the size of the viewport (see set_viewport_size)
+        bool needs_viewport() const { return this->has_polylines() || this->has_sprites(); }
+
+        /*!
+         * Give the model the size of the viewport (in framebuffer pixels) for the frame that is
+         * about to be drawn, for the polylines with widths in pixels and for the sprites. The
+         * Visual calls this each frame, before render(), for each model that needs_viewport().
+         */
+        void set_viewport_size (const int w, const int h) { this->viewport_size = { w, h }; }
+
+        //! The value of the colour_by_datum shader uniform for this model
+        int datum_colour_mode() const
+        {
+            if (this->colour_by_polar) { return 4; }
+            if (this->colour_by_element) { return 3; }
+            if (this->colour_by_datum_texture) { return 2; }
+            return this->colour_by_datum ? 1 : 0;
+        }
+
+        //! The current indices index
+        GLuint idx = 0u;
+
+        //! Set scaling in all dimensions
+        void setSizeScale (const float scl)
+        {
+            this->model_scaling.setToIdentity();
+            this->model_scaling[0] = scl;
+            this->model_scaling[5] = scl;
+            this->model_scaling[10] = scl;
+            this->transform_changed();
+        }
+        //! Set scaling in xy only
+        void setSizeScale (const float xscl, const float yscl)
+        {
+            this->model_scaling.setToIdentity();
+            this->model_scaling[0] = xscl;
+            this->model_scaling[5] = yscl;
+            this->transform_changed();
+        }
+
+        /*!
+         * A function that will be runtime defined to get_shaderprogs from a pointer to
+         * Visual (saving a boilerplate argument and avoiding that killer circular
+         * dependency at the cost of one line of boilerplate in client programs)
+         */
+        std::function<mplot::visgl::visual_shaderprogs(mplot::VisualBase<glver>*)> get_shaderprogs;
+        //! Get the graphics shader prog id
+        std::function<GLuint(mplot::VisualBase<glver>*)> get_gprog;
+        //! Get the text shader prog id
+        std::function<GLuint(mplot::VisualBase<glver>*)> get_tprog;
+        //! Get the uniform locations in the graphics shader prog
+        std::function<const mplot::visgl::shader_uniforms&(mplot::VisualBase<glver>*)> get_gprog_uniforms;
+        //! Get the uniform locations in the text shader prog
+        std::function<const mplot::visgl::shader_uniforms&(mplot::VisualBase<glver>*)> get_tprog_uniforms;
+        //! Get the uniform locations in the pick and pick sprite shader progs
+        std::function<const mplot::visgl::shader_uniforms&(mplot::VisualBase<glver>*)> get_pick_uniforms;
+        std::function<const mplot::visgl::shader_uniforms&(mplot::VisualBase<glver>*)> get_pick_sprite_uniforms;
+        //! Get the parent Visual's record of the current GL render state
+        std::function<mplot::visgl::render_state&(mplot::VisualBase<glver>*)> get_render_state;
+
+        //! Set OpenGL context. Should call parentVis->setContext().
+        std::function<void(mplot::VisualBase<glver>*)> setContext;
+        //! Release OpenGL context. Should call parentVis->releaseContext().
+        std::function<void(mplot::VisualBase<glver>*)> releaseContext;
+        //! Flag that the scene needs rendering. Should call parentVis->requestRedraw().
+        std::function<void(mplot::VisualBase<glver>*)> requestRedraw;
+
+        //! Tell the parent Visual (if there is one) that this model has changed, so that the scene is re-rendered
+        void scene_changed()
+        {
+            ++this->changes;
+            this->request_render();
+        }
+
+        /*!
+         * Ask the parent Visual (if there is one) to render, without counting a change to the
+         * model (changes is only touched on the render thread). VisualBase::requestRedraw sets an
+         * atomic flag, so this may be called from any thread once the model is bound.
+         */
+        void request_render()
+        {
+            if (this->requestRedraw != nullptr && this->parentVis != nullptr) { this->requestRedraw (this->parentVis); }
+        }
 
-        //! Set OpenGL context. Should call parentVis->setContext().
-        std::function<void(mplot::VisualBase<glver>*)> setContext;
-        //! Release OpenGL context. Should call parentVis->releaseContext().
-        std::function<void(mplot::VisualBase<glver>*)> releaseContext;
+        //! The viewmatrix has changed: the cached transforms of the model and its subtree are stale
+        void view_changed()
+        {
+            this->transform_changed();
+            this->scene_changed();
+        }
+
+        //! Mark the cached transforms of this model and of its descendants for recomputation.
+        //! The descendants' texts take their scene from this model, so they are updated too.
+        void transform_changed()
+        {
+            this->transform_dirty = true;
+            for (auto c : this->child_models) {
+                c->texts_scene_current = false;
+                c->transform_changed();
+            }
+        }
+
+        //! Recompute world_cache and model_cache
+        void update_transform() const
+        {
+            this->world_cache = this->parent_model == nullptr ? this->viewmatrix : this->parent_model->world_matrix() * this->viewmatrix;
+            this->model_cache = this->model_scaling * this->world_cache;
+            this->transform_dirty = false;
+        }
 
         //! Setter for the parent pointer, parentVis
         void set_parent (mplot::VisualBase<glver>* _vis)
@@ -494,6 +2684,59 @@ namespace mplot {
 
     protected:
 
+        //! Add bytes to the model's count for buffer t and to the parent Visual's count of bytes uploaded
+        void count_upload (const mplot::upload_target t, const std::size_t bytes)
+        {
+            this->stats.bytes[static_cast<std::size_t>(t)] += bytes;
+            ++this->changes;
+            if (this->get_render_state && this->parentVis != nullptr) {
+                this->get_render_state (this->parentVis).counts.bytes_uploaded += bytes;
+            }
+        }
+
+        //! The upload_target of the vertex buffer vbos[vb]
+        static constexpr mplot::upload_target vbo_target (const unsigned int vb)
+        {
+            static_assert (static_cast<unsigned int>(mplot::upload_target::indices) == idxVBO
+                           && static_cast<unsigned int>(mplot::upload_target::colours) == colVBO);
+            return vb < numVBO ? static_cast<mplot::upload_target>(vb) : mplot::upload_target::other;
+        }
+
+        /*!
+         * Times an upload into stats.upload_ms, from construction to destruction. Nested timers
+         * (postVertexInit called from within reinit_buffers, say) are not timed again. When
+         * the outermost timer ends, the upload_hook is called.
+         */
+        struct upload_timer
+        {
+            upload_timer (VisualModelBase<glver>* _m) : m(_m)
+            {
+                if (this->m->upload_depth++ == 0) { this->t0 = std::chrono::steady_clock::now(); }
+            }
+            ~upload_timer()
+            {
+                if (--this->m->upload_depth > 0) { return; }
+                this->m->stats.upload_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - this->t0).count();
+                if (this->m->upload_hook) { this->m->upload_hook (*this->m); }
+            }
+            upload_timer (const upload_timer&) = delete;
+            upload_timer& operator= (const upload_timer&) = delete;
+            VisualModelBase<glver>* m;
+            std::chrono::steady_clock::time_point t0 = {};
+        };
+
+        //! Count a call in the upload_stats member counter and time the upload that follows
+        [[nodiscard]] upload_timer time_upload (std::uint64_t mplot::upload_stats::* counter)
+        {
+            ++(this->stats.*counter);
+            return upload_timer (this);
+        }
+
+        //! The model's counts of rebuilds and uploads (see get_upload_stats)
+        mplot::upload_stats stats;
+        //! The depth of nested upload_timers
+        unsigned int upload_depth = 0;
+
         //! The model-specific view matrix.
         sm::mat44<float> viewmatrix = {};
         //! The model-specific scene view matrix.
@@ -501,6 +2744,23 @@ namespace mplot {
         //! An additional scaling applied to viewmatrix to scale the size of the model [see render()]
         sm::mat44<float> model_scaling = {};
 
+        //! The parent of this model in the transform hierarchy (see setParentModel)
+        VisualModelBase<glver>* parent_model = nullptr;
+        //! The models whose parent is this model
+        std::vector<VisualModelBase<glver>*> child_models;
+        //! The cached world_matrix()
+        mutable sm::mat44<float> world_cache = {};
+        //! The cached model_matrix()
+        mutable sm::mat44<float> model_cache = {};
+        //! True if world_cache and model_cache must be recomputed. Writing viewmatrix directly
+        //! (rather than with setViewMatrix and the like) after the first render needs
+        //! transform_changed() to be called.
+        mutable bool transform_dirty = true;
+        //! True if the texts' scene matrices are those that setSceneMatrix last set, for the
+        //! texts_scene_n texts that the model then had
+        bool texts_scene_current = false;
+        std::size_t texts_scene_n = 0u;
+
         /*!
          * The spatial offset of this VisualModel within the mplot::Visual 'scene
          * view'. Note that this is not incorporated into the computation of the
@@ -538,6 +2798,726 @@ namespace mplot {
         //! Vertex Buffer Objects stored in an array
         std::unique_ptr<GLuint[]> vbos;
 
+        //! The buffer for instance_data (if instanced)
+        GLuint instanceVBO = 0;
+        //! The number of floats allocated for instanceVBO
+        std::size_t instance_capacity = 0;
+        //! The number of instances in instanceVBO, which are drawn
+        std::size_t uploaded_instances = 0;
+        //! Changed [begin, end) instance ranges, from mark_dirty_instances
+        std::vector<std::array<std::size_t, 2>> instance_dirty;
+
+        //! The buffer for vertexDatums (if colour_by_datum or colour_by_element)
+        GLuint datumVBO = 0;
+        //! The number of floats allocated for datumVBO
+        std::size_t datum_capacity = 0;
+        //! RGB triplets for the colour lookup texture
+        std::vector<float> colour_lut;
+        //! The number of rows of texels in colour_lut (more than 1 for colour_by_polar)
+        unsigned int colour_lut_rows = 1u;
+        //! True if colour_lut has changed since it was last uploaded into colour_lut_texture
+        bool colour_lut_changed = false;
+        //! The colour lookup texture (if colour_by_datum or colour_by_datum_texture)
+        GLuint colour_lut_texture = 0;
+        //! True if datum_texture has changed since it was last uploaded into datum_texture_id
+        bool datum_texture_changed = false;
+        //! The datum texture (if colour_by_datum_texture or colour_by_element)
+        GLuint datum_texture_id = 0;
+        //! The dimensions with which datum_texture_id was allocated
+        std::array<unsigned int, 2> datum_texture_alloc = { 0u, 0u };
+        //! The format with which datum_texture_id was allocated
+        mplot::datum_format datum_texture_alloc_format = mplot::datum_format::float32;
+        //! datum_texture, packed for upload if datum_texture_format is not float32
+        std::vector<unsigned char> datum_texture_packed;
+        //! The texels x0, y0, x1, y1 of datum_texture to upload, if datum_texture_changed. An
+        //! empty rectangle means the whole texture.
+        std::array<unsigned int, 4> datum_texture_rect = { 0u, 0u, 0u, 0u };
+
+        //! A client-owned texture of datums (see setDatumTexture)
+        GLuint external_datum_texture = 0;
+        //! A client-owned buffer of vertex colours (see setColourBuffer)
+        GLuint external_colour_buffer = 0;
+        //! True if the colour attribute must be pointed at external_colour_buffer (or colVBO) again
+        bool colour_buffer_changed = false;
+
+        //! The data for the GPU mesh (see set_gpu_mesh_data)
+        std::vector<float> gpu_mesh_data;
+        //! True if gpu_mesh_data has changed since it was last uploaded
+        bool gpu_mesh_data_changed = false;
+        //! True if gpu_mesh_sources has changed since it was last uploaded
+        bool gpu_mesh_sources_changed = false;
+        //! True if the mesh must be regenerated on the GPU before the next render
+        bool gpu_mesh_pending = false;
+        //! A client-owned shader storage buffer of data for the GPU mesh (see setGpuMeshDataBuffer)
+        GLuint gpu_mesh_external_data = 0;
+        //! The GPU mesh compute shader program
+        GLuint gpu_mesh_prog = 0;
+        //! The model's own GPU mesh data, sources and data range buffers
+        GLuint gpu_mesh_buffers[3] = { 0, 0, 0 };
+        //! The compute shader program that finds the range of the data (see gpu_mesh_autoscale)
+        GLuint gpu_mesh_range_prog = 0;
+
+        //! The rectangle and grid of texels that jump flooding fills (see set_jump_flood_grid)
+        std::array<float, 2> jump_flood_lo = { 0.0f, 0.0f };
+        std::array<float, 2> jump_flood_hi = { 1.0f, 1.0f };
+        std::array<unsigned int, 2> jump_flood_dims = { 0u, 0u };
+        //! The sites and their data (see set_jump_flood_sites and set_jump_flood_data)
+        std::vector<std::array<float, 2>> jump_flood_sites;
+        std::vector<float> jump_flood_data;
+        //! True if the sites or data have changed since they were last uploaded
+        bool jump_flood_sites_changed = false;
+        bool jump_flood_data_changed = false;
+        //! True if the cells must be flooded again before the next render
+        bool jump_flood_pending = false;
+        //! The jump flooding compute shader program
+        GLuint jump_flood_prog = 0;
+        //! The sites, data and the two (ping-ponged) site index buffers
+        GLuint jump_flood_buffers[4] = { 0, 0, 0, 0 };
+        //! The texture of the cells' data, which is the model's datum texture
+        GLuint jump_flood_texture = 0;
+        //! The dimensions with which jump_flood_buffers[2 and 3] and jump_flood_texture were allocated
+        std::array<unsigned int, 2> jump_flood_alloc = { 0u, 0u };
+
+        //! The polylines (see add_polyline)
+        std::vector<polyline> polylines;
+        //! Four floats (x, y, z and the arc length from the first point) for each point of each
+        //! polyline, with a copy of the first point before, and of the last point after, each
+        //! polyline's points. A segment's vertex shader reads the points either side of it from
+        //! these, to find its joins; the copies mark the ends.
+        std::vector<float> polyline_points;
+        //! True if polyline_points has changed since it was last uploaded
+        bool polylines_changed = false;
+        //! The program, vertex array and points buffer with which the polylines are drawn
+        GLuint polyline_prog = 0;
+        GLuint polyline_vao = 0;
+        GLuint polyline_vbo = 0;
+        //! The number of floats allocated for polyline_vbo
+        std::size_t polyline_capacity = 0;
+        //! The viewport size from set_viewport_size
+        std::array<int, 2> viewport_size = { 0, 0 };
+
+        //! The sphere impostors (see add_sprite)
+        std::vector<sprite> sprites;
+        //! True if sprites has changed since it was last uploaded
+        bool sprites_changed = false;
+        //! The first sprite that has changed since the last upload, from which sprites are uploaded
+        std::size_t sprite_dirty_first = 0;
+        //! The radius in model units of a sprite of size 1
+        float sprite_radius = 0.05f;
+        //! The program, vertex array and buffer with which the sprites are drawn
+        GLuint sprite_prog = 0;
+        GLuint sprite_vao = 0;
+        GLuint sprite_vbo = 0;
+        //! The number of sprites allocated for sprite_vbo
+        std::size_t sprite_capacity = 0;
+
+        //! The bar sets (see add_bars)
+        std::vector<bar_set> bar_sets;
+        //! Two floats (the x of its centre and the y of its top) for each bar of each bar set
+        std::vector<float> bar_data;
+        //! The bars [begin, end) that have changed since the last upload
+        std::array<std::size_t, 2> bar_dirty = { 0, 0 };
+        //! The program, vertex array and buffer with which the bars are drawn
+        GLuint bar_prog = 0;
+        GLuint bar_vao = 0;
+        GLuint bar_vbo = 0;
+        //! The number of bars allocated for bar_vbo
+        std::size_t bar_capacity = 0;
+
+        //! The datums of the volume (see set_volume)
+        std::vector<float> volume;
+        //! The size of the volume in voxels
+        std::array<unsigned int, 3> volume_dims = { 0u, 0u, 0u };
+        //! The corners of the box that the volume fills, in model coordinates
+        std::array<sm::vec<float>, 2> volume_box = { sm::vec<float>{ 0.0f, 0.0f, 0.0f }, sm::vec<float>{ 1.0f, 1.0f, 1.0f } };
+        //! True if the volume has changed since it was last uploaded
+        bool volume_changed = false;
+        //! The opacity of a voxel of datum 1
+        float volume_density = 0.05f;
+        //! The spacing of the samples along a ray, in voxels
+        float volume_step = 0.5f;
+        //! The datum at or below which the volume is transparent
+        float volume_threshold = 0.0f;
+        //! The program and (empty) vertex array with which the volume is drawn
+        GLuint volume_prog = 0;
+        GLuint volume_vao = 0;
+        //! The volume texture and the texture of its brick maxima
+        GLuint volume_texture = 0;
+        GLuint volume_brick_texture = 0;
+        //! The size in voxels with which volume_texture was allocated
+        std::array<unsigned int, 3> volume_alloc = { 0u, 0u, 0u };
+        //! Slices of the volume packed into volume_format for their upload
+        std::vector<unsigned char> volume_packed;
+
+        //! The ring of raster events (see set_raster_capacity)
+        std::vector<raster_event> raster_ring;
+        //! The number of events appended to the raster, and the number when it was last uploaded
+        std::uint64_t raster_total = 0;
+        std::uint64_t raster_uploaded = 0;
+        //! True if raster_vbo must be reallocated to the size of the ring
+        bool raster_realloc = true;
+        //! The window of time shown by the raster
+        std::array<float, 2> raster_window = { 0.0f, 1.0f };
+        //! The populations, by first neuron (see set_raster_populations)
+        std::vector<raster_population> raster_populations;
+        //! The program, vertex array and buffer with which the raster is drawn
+        GLuint raster_prog = 0;
+        GLuint raster_vao = 0;
+        GLuint raster_vbo = 0;
+
+        //! The point cloud cache (see set_cloud_slots)
+        std::size_t cloud_slots = 0;
+        std::size_t cloud_slot_points = 0;
+        //! The slots to upload at the next render, and the points to upload into each
+        std::vector<std::pair<std::uint32_t, std::vector<cloud_point>>> cloud_writes;
+        std::vector<cloud_draw> cloud_draws;
+        //! True if the buffer must be (re)allocated for the slots
+        bool cloud_realloc = true;
+        GLuint cloud_prog = 0;
+        GLuint cloud_vao = 0;
+        GLuint cloud_vbo = 0;
+
+        //! Add bars [begin, end) to those to upload
+        void mark_bars_dirty (const std::size_t begin, const std::size_t end)
+        {
+            if (this->bar_dirty[1] <= this->bar_dirty[0]) {
+                this->bar_dirty = { begin, end };
+            } else {
+                this->bar_dirty = { std::min (begin, this->bar_dirty[0]), std::max (end, this->bar_dirty[1]) };
+            }
+        }
+
+        //! Write the points pts of polyline pl (and the copies of its end points), with their arc
+        //! lengths, into polyline_points
+        void write_polyline_points (const polyline& pl, std::span<const sm::vec<float>> pts)
+        {
+            if (pts.empty()) { return; }
+            float* out = this->polyline_points.data() + 4u * pl.first;
+            for (std::size_t k = 0; k < pts.size(); ++k) {
+                float* o = out + 4u * (k + 1u);
+                o[0] = pts[k][0];
+                o[1] = pts[k][1];
+                o[2] = pts[k][2];
+            }
+            this->rewrite_arc_lengths (pl);
+        }
+
+        //! Write the arc lengths of the points of polyline pl (and of the copies of its end
+        //! points), measured along the line in model coordinates, i.e. after its transform
+        void rewrite_arc_lengths (const polyline& pl)
+        {
+            if (pl.count == 0u) { return; }
+            float* out = this->polyline_points.data() + 4u * pl.first;
+            const bool ident = pl.transform.is_identity();
+            auto model_point = [&pl, ident](const float* o)
+            {
+                const sm::vec<float> d = { o[0], o[1], o[2] };
+                return ident ? d : pl.transform.apply (d);
+            };
+            float s = 0.0f;
+            sm::vec<float> last = model_point (out + 4);
+            for (std::size_t k = 0; k < pl.count; ++k) {
+                float* o = out + 4u * (k + 1u);
+                const sm::vec<float> m = model_point (o);
+                if (k > 0) { s += (m - last).length(); }
+                last = m;
+                o[3] = s;
+            }
+            std::copy (out + 4, out + 8, out);
+            std::copy (out + 4u * pl.count, out + 4u * (pl.count + 1u), out + 4u * (pl.count + 1u));
+            this->polylines_changed = true;
+        }
+
+        //! If true, the vertices are stored interleaved in compactVBO. See setCompactVertices()
+        bool compact_vertices = false;
+        //! If true, finalize() sets compact_vertices where it can. See setCompactByDefault()
+        bool compact_by_default = false;
+
+        //! Once the vertices have been computed, make the model compact if it prefers to be and can be
+        void choose_compact()
+        {
+            if (!this->compact_by_default || this->compact_vertices) { return; }
+            this->compact_vertices = !this->streaming && !this->batched && !this->gpu_mesh
+            && this->mesh_source.empty() && this->datum_colour_mode() == 0;
+        }
+        //! Bytes per vertex in compactVBO: float3 position, packed normal and RGBA8 colour
+        static constexpr std::size_t compact_stride = 20;
+        //! The interleaved vertex buffer (if compact_vertices)
+        GLuint compactVBO = 0;
+        //! The number of bytes allocated for compactVBO
+        std::size_t compact_capacity = 0;
+        //! The interleaved vertex data, packed from vertexPositions, vertexNormals and vertexColors
+        std::vector<unsigned char> compact_data;
+
+        //! Pack the unit vector n into a GL_INT_2_10_10_10_REV word (with w = 1)
+        static std::uint32_t pack_normal (const float* n)
+        {
+            std::uint32_t p = 1u << 30;
+            for (unsigned int i = 0; i < 3; ++i) {
+                const auto c = static_cast<std::int32_t>(std::round (std::clamp (n[i], -1.0f, 1.0f) * 511.0f));
+                p |= (static_cast<std::uint32_t>(c) & 0x3ffu) << (10u * i);
+            }
+            return p;
+        }
+
+        //! Pack vertexPositions, vertexNormals and vertexColors (and alpha) into compact_data
+        void pack_compact_vertices()
+        {
+            const std::size_t n = this->vertexPositions.size() / 3;
+            this->compact_data.resize (n * compact_stride);
+            const bool have_norms = this->vertexNormals.size() >= 3 * n;
+            const bool have_cols = this->vertexColors.size() >= 3 * n;
+            const unsigned char a = static_cast<unsigned char>(std::clamp (this->alpha, 0.0f, 1.0f) * 255.0f + 0.5f);
+            constexpr float no_norm[3] = { 0.0f, 0.0f, 1.0f };
+            for (std::size_t i = 0; i < n; ++i) {
+                unsigned char* v = this->compact_data.data() + i * compact_stride;
+                std::memcpy (v, this->vertexPositions.data() + 3 * i, 3 * sizeof(float));
+                const std::uint32_t pn = pack_normal (have_norms ? this->vertexNormals.data() + 3 * i : no_norm);
+                std::memcpy (v + 12, &pn, sizeof(pn));
+                for (std::size_t j = 0; j < 3; ++j) {
+                    v[16 + j] = have_cols ? static_cast<unsigned char>(std::clamp (this->vertexColors[3 * i + j], 0.0f, 1.0f) * 255.0f + 0.5f) : 0;
+                }
+                v[19] = a;
+            }
+        }
+
+        //! If true, the vertex buffers are streaming buffers. See setStreaming()
+        bool streaming = false;
+        //! True if glver supports glBufferStorage, so that streaming buffers can be persistently mapped
+        static constexpr bool persistent_streaming = mplot::gl::version::buffer_storage (glver);
+        //! The number of regions in the ring of each persistently mapped streaming buffer
+        static constexpr unsigned int stream_regions = 3;
+        //! How long to wait (in ns) for the GPU to finish with a streaming buffer region
+        static constexpr std::uint64_t stream_timeout = 1000000000;
+        //! The state of the streaming vertex buffers
+        struct stream_buffers
+        {
+            //! Pointer to each persistently mapped buffer
+            std::array<void*, numVBO> mapped = {};
+            //! Capacity, in bytes, of one region of each buffer
+            std::array<std::size_t, numVBO> capacity = {};
+            //! Byte offset of the current data in each buffer
+            std::array<std::size_t, numVBO> offset = {};
+            //! The region of the ring that was last written
+            unsigned int region = 0;
+            //! A fence for each region, set when the region was last drawn from
+            std::array<GLsync, stream_regions> fences = {};
+        };
+        //! Streaming buffer state, used if streaming is true
+        stream_buffers stream;
+
+        //! Changed [begin, end) element ranges of each buffer, from the mark_dirty functions
+        std::array<std::vector<std::array<std::size_t, 2>>, numVBO> dirty_ranges = {};
+        //! The number of elements in each buffer when it was last uploaded
+        std::array<std::size_t, numVBO> uploaded_sizes = {};
+        //! Dirty ranges separated by fewer than this many elements are uploaded as one
+        static constexpr std::size_t dirty_merge_gap = 96;
+        //! The minimum number of elements to allocate for each buffer (see reserve_buffers)
+        std::array<std::size_t, numVBO> buffer_reserve = {};
+        //! The number of elements allocated for each buffer on the GPU at its last full upload
+        std::array<std::size_t, numVBO> buffer_capacity = {};
+
+        //! A mesh that is drawn from a memory mapped file, in place of the vertex vectors. See setMappedMesh()
+        mplot::mapped_mesh mesh_source;
+        //! The directory and the key of the model's geometry cache file. See setGeometryCache()
+        std::string geometry_cache_dir;
+        std::uint64_t geometry_cache_key = 0u;
+
+        //! If true, the model is drawn with no lighting. See setUnlit()
+        bool unlit = false;
+        //! True if the model's normals were left out of its last upload, so that normVBO is empty
+        bool normals_omitted = false;
+        //! True if an upload should leave out the normals. See setUnlit()
+        bool omit_normals() const { return this->is_unlit() && !this->gpu_mesh; }
+
+        //! If false, the model never shares its vertex buffers. See setShareMesh()
+        bool share_mesh_enabled = true;
+        //! If true, the model shares its index, position and normal buffers. See setShareGeometry()
+        bool share_geometry_enabled = false;
+        //! For each buffer, true if it is registered in the geometry registry under buffer_keys[vb]
+        //! (and may be in use by other models too)
+        std::array<bool, numVBO> buffer_shared = {};
+        //! The geometry registry keys of the shared buffers
+        std::array<visgl::buffer_key, numVBO> buffer_keys = {};
+        //! True if vbos are registered in the mesh registry under shared_key (and may be in use by
+        //! other models too)
+        bool mesh_shared = false;
+        //! Set when a shared mesh changes, after which the model keeps buffers of its own
+        bool mesh_changed = false;
+        //! The registry key of the shared mesh
+        visgl::mesh_key shared_key = {};
+
+        //! True if the model is of a kind that can share its vertex buffers. See setShareMesh()
+        bool mesh_sharable() const
+        {
+            return this->share_mesh_enabled && !this->share_geometry_enabled && !this->mesh_changed && !this->host_only && !this->streaming
+            && !this->compact_vertices && !this->batched && !this->gpu_mesh && !this->lod_enabled
+            && this->mesh_source.empty() && !this->indices.empty()
+            && this->vertexPositions.size() / 3 <= visgl::share_mesh_max_vertices;
+        }
+
+        //! True if buffer vb can be shared through the geometry registry. See setShareGeometry()
+        bool geometry_sharable (const unsigned int vb) const
+        {
+            return this->share_geometry_enabled && !this->host_only && !this->streaming && !this->compact_vertices
+            && !this->batched && !this->gpu_mesh && this->mesh_source.empty() && !this->indices.empty()
+            && (vb == idxVBO || vb == posnVBO || (vb == normVBO && !this->omit_normals()));
+        }
+
+        //! The geometry registry key of buffer vb, if it were drawn in context group g
+        visgl::buffer_key make_buffer_key (const unsigned int g, const unsigned int vb) const
+        {
+            std::uint64_t h = 0xcbf29ce484222325ull;
+            h = visgl::hash_words (h, this->buffer_data (vb), this->buffer_size (vb));
+            // Indices are narrowed to 16 bits for small models, so the number of vertices (which
+            // decides that) goes into the key of an index buffer
+            const std::uint64_t nv = vb == idxVBO ? this->vertexPositions.size() : 0u;
+            h = visgl::hash_words (h, &nv, 2);
+            return { g, vb, h, this->buffer_size (vb) };
+        }
+
+        //! The registry key of the model's mesh, if it were drawn in context group g
+        visgl::mesh_key make_mesh_key (const unsigned int g) const
+        {
+            std::uint64_t h = 0xcbf29ce484222325ull;
+            h = visgl::hash_words (h, this->indices.data(), this->indices.size());
+            h = visgl::hash_words (h, this->vertexPositions.data(), this->vertexPositions.size());
+            h = visgl::hash_words (h, this->vertexNormals.data(), this->vertexNormals.size());
+            h = visgl::hash_words (h, this->vertexColors.data(), this->vertexColors.size());
+            // Normals and colours are hashed end to end, so their lengths go into the hash too
+            // and an unlit model, whose buffers have no normals, shares only with unlit models
+            const std::uint64_t sizes[3] = { this->vertexNormals.size(), this->vertexColors.size(), this->omit_normals() ? 1u : 0u };
+            h = visgl::hash_words (h, sizes, 6);
+            return { g, h, this->indices.size(), this->vertexPositions.size() };
+        }
+
+        //! The number of elements in indices (vb == idxVBO) or in the vertex data for vb
+        std::size_t buffer_size (const unsigned int vb) const
+        {
+            if (!this->mesh_source.empty()) {
+                return vb == idxVBO ? this->mesh_source.n_indices : (vb < numVBO ? 3u * this->mesh_source.n_vertices : 0u);
+            }
+            switch (vb) {
+            case posnVBO: return this->vertexPositions.size();
+            case normVBO: return this->vertexNormals.size();
+            case colVBO: return this->vertexColors.size();
+            case idxVBO: return this->indices.size();
+            default: return 0;
+            }
+        }
+
+        //! The CPU-side data for buffer vb
+        const void* buffer_data (const unsigned int vb) const
+        {
+            if (!this->mesh_source.empty()) {
+                switch (vb) {
+                case posnVBO: return this->mesh_source.positions;
+                case normVBO: return this->mesh_source.normals;
+                case colVBO: return this->mesh_source.colours;
+                case idxVBO: return this->mesh_source.indices;
+                default: return nullptr;
+                }
+            }
+            switch (vb) {
+            case posnVBO: return this->vertexPositions.data();
+            case normVBO: return this->vertexNormals.data();
+            case colVBO: return this->vertexColors.data();
+            case idxVBO: return this->indices.data();
+            default: return nullptr;
+            }
+        }
+
+        //! The type of the indices in vbos[idxVBO]: GL_UNSIGNED_SHORT if the model had few
+        //! enough vertices at its last full upload (see short_indices_possible), else GL_UNSIGNED_INT
+        GLenum index_type = GL_UNSIGNED_INT;
+
+        //! The size in bytes of one element of vbos[idxVBO]
+        std::size_t index_size() const { return this->index_type == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint); }
+
+        //! True if the model has few enough vertices for its indices to be uploaded as 16 bit
+        //! values. Streaming models always have 32 bit indices.
+        bool short_indices_possible() const
+        {
+            // The indices of a device mesh are written as 32 bit values on the GPU
+            return !this->streaming && this->buffer_size (posnVBO) / 3 <= visgl::short_index_max_vertices
+            && (this->mesh_source.empty() || this->mesh_source.indices != nullptr);
+        }
+
+        //! True if any dirty ranges have been marked
+        bool any_dirty() const
+        {
+            for (const auto& dr : this->dirty_ranges) { if (!dr.empty()) { return true; } }
+            return false;
+        }
+
+        //! True if buffer vb can be updated from its dirty ranges, because it has the size it had
+        //! when last uploaded, or has grown within its GPU allocation. Streaming buffers are
+        //! always rewritten in full.
+        bool sub_update_possible (const unsigned int vb) const
+        {
+            const std::size_t n = this->buffer_size (vb);
+            // Omitted normals need no update, unless the model is to be lit now
+            if (vb == normVBO && this->normals_omitted) { return this->omit_normals(); }
+            // 16 bit indices can't be extended to address more vertices than they were chosen for
+            if (vb == idxVBO && this->index_type == GL_UNSIGNED_SHORT && !this->short_indices_possible()) { return false; }
+            return !this->streaming && this->uploaded_sizes[vb] <= n && n <= this->buffer_capacity[vb];
+        }
+
+        //! True if all buffers can be updated from their dirty ranges. See sub_update_possible()
+        bool sub_update_possible() const
+        {
+            if (!this->any_dirty()) { return false; }
+            for (unsigned int vb : { posnVBO, normVBO, colVBO, idxVBO }) {
+                if (!this->sub_update_possible (vb)) { return false; }
+            }
+            return true;
+        }
+
+        //! Return the dirty ranges for vb, plus any elements appended since the last upload,
+        //! sorted, clamped to the buffer size and merged where they overlap or nearly touch. The
+        //! ranges for vb are cleared.
+        std::vector<std::array<std::size_t, 2>> take_dirty_ranges (const unsigned int vb)
+        {
+            std::vector<std::array<std::size_t, 2>> merged;
+            std::vector<std::array<std::size_t, 2>>& dr = this->dirty_ranges[vb];
+            const std::size_t n = this->buffer_size (vb);
+            if (n > this->uploaded_sizes[vb]) { dr.push_back ({ this->uploaded_sizes[vb], n }); }
+            std::sort (dr.begin(), dr.end());
+            for (auto r : dr) {
+                r[1] = std::min (r[1], n);
+                if (r[0] >= r[1]) { continue; }
+                if (!merged.empty() && r[0] <= merged.back()[1] + dirty_merge_gap) {
+                    merged.back()[1] = std::max (merged.back()[1], r[1]);
+                } else {
+                    merged.push_back (r);
+                }
+            }
+            dr.clear();
+            return merged;
+        }
+
+        //! If true, the parent Visual may draw this model in a batch. See setBatched()
+        bool batched = false;
+        //! If true, the model is drawn in the parent Visual's static layer. See setStaticLayer()
+        bool static_layer = false;
+        //! Incremented by scene_changed() and by each upload. See change_count()
+        std::uint64_t changes = 0u;
+        //! If true, the model's vertices are kept on the CPU only. See setHostOnly()
+        bool host_only = false;
+        //! If true, the vectors are freed after each full upload. See setGpuResident()
+        bool gpu_resident = false;
+        //! True while the vectors of a gpu_resident model are freed. See host_vertices_released()
+        bool host_released = false;
+        //! The number of uploads of the vertices. See get_upload_generation()
+        std::size_t upload_generation = 0;
+
+        //! If true, the parent Visual may skip rendering this model. See setFrustumCulling()
+        bool frustum_culling = true;
+        //! True if bb_min and bb_max bound vertexPositions as of the last upload
+        bool bounds_valid = false;
+        //! The rectangle given to setScreenRect (empty if none was)
+        mplot::screen_rect declared_rect;
+        //! The minimum corner of the model frame bounding box of vertexPositions
+        sm::vec<float, 3> bb_min = { 0.0f, 0.0f, 0.0f };
+        //! The maximum corner of the model frame bounding box of vertexPositions
+        sm::vec<float, 3> bb_max = { 0.0f, 0.0f, 0.0f };
+
+        //! Compute bb_min and bb_max from vertexPositions. Called on each upload of the vertices.
+        void compute_bounds()
+        {
+            // The bounds of freed vertices (see setGpuResident) are those of the last upload
+            if (this->host_vertices_absent()) { return; }
+            // Those of a device mesh were given to setDeviceMesh
+            if (!this->mesh_source.empty() && this->mesh_source.positions == nullptr) {
+                this->bounds_valid = this->mesh_source.n_vertices > 0;
+                return;
+            }
+            const std::size_t n = this->buffer_size (posnVBO) / 3;
+            // A mesh generated on the GPU has z positions that are not known on the CPU
+            this->bounds_valid = n > 0 && !this->gpu_mesh;
+            if (n == 0) { return; }
+            this->bb_min = { _max, _max, _max };
+            this->bb_max = { _low, _low, _low };
+            const float* vp = static_cast<const float*>(this->buffer_data (posnVBO));
+            for (std::size_t i = 0; i < n; ++i, vp += 3) {
+                for (unsigned int j = 0; j < 3; ++j) {
+                    this->bb_min[j] = std::min (this->bb_min[j], vp[j]);
+                    this->bb_max[j] = std::max (this->bb_max[j], vp[j]);
+                }
+            }
+        }
+
+        /*!
+         * True while a build from finalize_async or reinit_async is running. Once it has
+         * finished, this sets postVertexInitRequired (so that the caller uploads the new
+         * vertices), counts the change to the model (here, on the render thread, rather than on
+         * the build's), rethrows any exception from the build and returns false.
+         */
+        bool async_build_running()
+        {
+            if (!this->async_build.valid()) { return false; }
+            if (this->async_build.wait_for (std::chrono::seconds(0)) != std::future_status::ready) { return true; }
+            std::shared_future<void> f = std::move (this->async_build);
+            this->async_build = {};
+            f.get();
+            this->postVertexInitRequired = true;
+            this->scene_changed();
+            return false;
+        }
+
+        //! The build started by finalize_async or reinit_async, if any
+        std::shared_future<void> async_build;
+
+        /*!
+         * Called by render() after any upload of the buffers and before drawing. A model that
+         * holds its geometry at several levels of detail sets lod_enabled and overrides this to
+         * choose the draw_spans for lod_projection and lod_viewport_h (see mplot/lod.h).
+         */
+        virtual void update_lod() {}
+        //! Set by a model that overrides update_lod
+        bool lod_enabled = false;
+
+        /*!
+         * Called by render() before anything else is done for the frame. A model that takes its
+         * data from a data_slot (see VisualDataModel::setDataSlot) sets take_data_enabled and
+         * overrides this to rebuild from the latest published data.
+         */
+        virtual void take_data() {}
+        //! Set by a model that overrides take_data
+        bool take_data_enabled = false;
+        //! The projection and viewport height from set_lod_view
+        sm::mat44<float> lod_projection = {};
+        int lod_viewport_h = 0;
+
+        /*!
+         * The tessellation policy of a model that builds its spheres and tubes with the rings and
+         * segments that it chooses (see mplot/tessellation.h). A model that supports adaptive
+         * tessellation gives a setTessellation that sets lod_enabled, records the extent of its
+         * primitives with tessellation_extent and, in update_lod, rebuilds when
+         * update_tessellation returns true.
+         */
+        mplot::tessellation tessellation;
+        //! The box (model coordinates) in which the primitives lie, and the largest of their diameters
+        sm::vec<float, 3> tessellation_lo = { _max, _max, _max };
+        sm::vec<float, 3> tessellation_hi = { _low, _low, _low };
+        float tessellation_diameter = 0.0f;
+
+        //! Forget the extent of the primitives (at the start of a build)
+        void tessellation_extent_reset()
+        {
+            this->tessellation_lo = { _max, _max, _max };
+            this->tessellation_hi = { _low, _low, _low };
+            this->tessellation_diameter = 0.0f;
+        }
+
+        //! Add a primitive of the given diameter at c to the extent
+        void tessellation_extent (const sm::vec<float, 3>& c, const float diameter)
+        {
+            for (unsigned int j = 0; j < 3; ++j) {
+                this->tessellation_lo[j] = std::min (this->tessellation_lo[j], c[j]);
+                this->tessellation_hi[j] = std::max (this->tessellation_hi[j], c[j]);
+            }
+            this->tessellation_diameter = std::max (this->tessellation_diameter, diameter);
+        }
+
+        /*!
+         * Choose the tessellation level for the largest primitive at the nearest point of the
+         * extent, with the view from set_lod_view. True if the level changed, in which case the
+         * model should rebuild its geometry.
+         */
+        bool update_tessellation()
+        {
+            if (!this->tessellation.adaptive || this->lod_viewport_h <= 0 || this->tessellation_diameter <= 0.0f) { return false; }
+            const sm::mat44<float> mv = this->scenematrix * this->model_matrix();
+            const float d = mplot::tessellation::max_screen_size (this->lod_projection, mv, this->tessellation_lo, this->tessellation_hi,
+                                                                  this->tessellation_diameter, this->lod_viewport_h);
+            if (!this->tessellation.update (d)) { return false; }
+            ++this->stats.tessellation_changes;
+            return true;
+        }
+
+        //! Set by setDeclutterTexts
+        bool declutter_enabled = false;
+        //! The projection and framebuffer size from set_declutter_view
+        sm::mat44<float> declutter_projection = {};
+        sm::vec<int, 2> declutter_dims = { 0, 0 };
+        //! The boxes of the texts and the choice of those to draw
+        mplot::label_declutter declutter;
+        //! The state for which declutter last ran
+        sm::mat44<float> declutter_key_p = {};
+        sm::mat44<float> declutter_key_sv = {};
+        sm::mat44<float> declutter_key_mv = {};
+        sm::vec<int, 2> declutter_key_dims = { 0, 0 };
+        std::size_t declutter_key_n = std::numeric_limits<std::size_t>::max();
+        std::uint64_t declutter_key_changes = 0;
+
+        //! True if declutter must run again for a model with n_texts texts, recording the state
+        //! for which it will run
+        bool declutter_stale (const std::size_t n_texts)
+        {
+            if (n_texts == this->declutter_key_n && this->changes == this->declutter_key_changes
+                && this->declutter_dims[0] == this->declutter_key_dims[0] && this->declutter_dims[1] == this->declutter_key_dims[1]
+                && this->declutter_projection.mat == this->declutter_key_p.mat
+                && this->scenematrix.mat == this->declutter_key_sv.mat && this->viewmatrix.mat == this->declutter_key_mv.mat) {
+                return false;
+            }
+            this->declutter_key_n = n_texts;
+            this->declutter_key_changes = this->changes;
+            this->declutter_key_dims = this->declutter_dims;
+            this->declutter_key_p = this->declutter_projection;
+            this->declutter_key_sv = this->scenematrix;
+            this->declutter_key_mv = this->viewmatrix;
+            return true;
+        }
+
+        //! True if the vectors may be freed after a full upload (see setGpuResident)
+        bool gpu_resident_possible() const
+        {
+            return this->gpu_resident && !this->host_only && !this->streaming && !this->compact_vertices
+            && !this->gpu_mesh && this->mesh_source.empty() && !this->share_geometry_enabled && !this->mesh_shared
+            && !this->batched && !this->lod_enabled;
+        }
+
+        //! After a full upload of a gpu_resident model, free the CPU copies of the vertices
+        void release_host_vertices()
+        {
+            if (!this->gpu_resident_possible() || this->indices.empty()) { return; }
+            std::vector<GLuint>().swap (this->indices);
+            std::vector<float>().swap (this->vertexPositions);
+            std::vector<float>().swap (this->vertexNormals);
+            std::vector<float>().swap (this->vertexColors);
+            this->host_released = true;
+        }
+
+        //! True if the vectors were freed and are still empty, so that the buffers hold the
+        //! vertices and an upload would lose them
+        bool host_vertices_absent() const
+        {
+            return this->host_released && this->indices.empty() && this->vertexPositions.empty();
+        }
+
+        //! In place of an upload for a host_only model: forget the dirty ranges as an upload would
+        void skip_upload()
+        {
+            this->wait_for_build();
+            this->mark_uploaded();
+            this->postVertexInitRequired = false;
+        }
+
+        //! Forget all dirty ranges and record the sizes of the buffers after a full upload
+        void mark_uploaded()
+        {
+            ++this->upload_generation;
+            // The upload replaces any vertices that were generated on the GPU
+            if (this->gpu_mesh) { this->gpu_mesh_pending = true; }
+            // Freed vectors (see setGpuResident) leave the buffers, and their sizes, as they were
+            const bool absent = this->host_vertices_absent();
+            for (unsigned int vb : { posnVBO, normVBO, colVBO, idxVBO }) {
+                this->dirty_ranges[vb].clear();
+                if (!absent) { this->uploaded_sizes[vb] = this->buffer_size (vb); }
+            }
+        }
+
         //! CPU-side data for indices
         std::vector<GLuint> indices = {};
         //! CPU-side data for vertex positions
@@ -577,18 +3557,17 @@ namespace mplot {
         //! Push three floats onto the vector of floats \a vp
         void vertex_push (const float& x, const float& y, const float& z, std::vector<float>& vp)
         {
-            sm::vec<float> vec = { x, y, z };
-            std::copy (vec.begin(), vec.end(), std::back_inserter (vp));
+            vp.insert (vp.end(), { x, y, z });
         }
         //! Push array of 3 floats onto the vector of floats \a vp
         void vertex_push (const std::array<float, 3>& arr, std::vector<float>& vp)
         {
-            std::copy (arr.begin(), arr.end(), std::back_inserter (vp));
+            vp.insert (vp.end(), arr.begin(), arr.end());
         }
         //! Push sm::vec of 3 floats onto the vector of floats \a vp
         void vertex_push (const sm::vec<float>& vec, std::vector<float>& vp)
         {
-            std::copy (vec.begin(), vec.end(), std::back_inserter (vp));
+            vp.insert (vp.end(), vec.begin(), vec.end());
         }
 
         //! Set up a vertex buffer object - bind, buffer and set vertex array object attribute
@@ -640,6 +3619,10 @@ namespace mplot {
                           std::array<float, 3> colStart, std::array<float, 3> colEnd,
                           float r = 1.0f, int segments = 12, float rotation = 0.0f)
         {
+            // The sines and cosines of the segment angles (cached, if there is no rotation)
+            mplot::unit_meshes::circle rotated;
+            if (rotation != 0.0f) { rotated = mplot::unit_meshes::make_circle (segments, rotation); }
+            const mplot::unit_meshes::circle& uc = rotation != 0.0f ? rotated : mplot::unit_meshes::get_circle (segments);
             // The vector from start to end defines direction of the tube
             sm::vec<float> vstart = start;
             sm::vec<float> vend = end;
@@ -655,9 +3638,7 @@ namespace mplot {
 
             // Start cap vertices (a triangle fan)
             for (int j = 0; j < segments; j++) {
-                // t is the angle of the segment
-                float t = rotation + j * sm::mathconst<float>::two_pi/(float)segments;
-                sm::vec<float> c = _ux * std::sin(t) * r + _uy * std::cos(t) * r;
+                sm::vec<float> c = _ux * uc.sin_t[j] * r + _uy * uc.cos_t[j] * r;
                 this->vertex_push (vstart+c, this->vertexPositions);
                 this->vertex_push (-v, this->vertexNormals);
                 this->vertex_push (colStart, this->vertexColors);
@@ -665,8 +3646,7 @@ namespace mplot {
 
             // Intermediate, near start cap. Normals point in direction c
             for (int j = 0; j < segments; j++) {
-                float t = rotation + j * sm::mathconst<float>::two_pi/(float)segments;
-                sm::vec<float> c = _ux * std::sin(t) * r + _uy * std::cos(t) * r;
+                sm::vec<float> c = _ux * uc.sin_t[j] * r + _uy * uc.cos_t[j] * r;
                 this->vertex_push (vstart+c, this->vertexPositions);
                 c.renormalize();
                 this->vertex_push (c, this->vertexNormals);
@@ -675,8 +3655,7 @@ namespace mplot {
 
             // Intermediate, near end cap. Normals point in direction c
             for (int j = 0; j < segments; j++) {
-                float t = rotation + (float)j * sm::mathconst<float>::two_pi/(float)segments;
-                sm::vec<float> c = _ux * std::sin(t) * r + _uy * std::cos(t) * r;
+                sm::vec<float> c = _ux * uc.sin_t[j] * r + _uy * uc.cos_t[j] * r;
                 this->vertex_push (vend+c, this->vertexPositions);
                 c.renormalize();
                 this->vertex_push (c, this->vertexNormals);
@@ -685,8 +3664,7 @@ namespace mplot {
 
             // Bottom cap vertices
             for (int j = 0; j < segments; j++) {
-                float t = rotation + (float)j * sm::mathconst<float>::two_pi/(float)segments;
-                sm::vec<float> c = _ux * std::sin(t) * r + _uy * std::cos(t) * r;
+                sm::vec<float> c = _ux * uc.sin_t[j] * r + _uy * uc.cos_t[j] * r;
                 this->vertex_push (vend+c, this->vertexPositions);
                 this->vertex_push (v, this->vertexNormals);
                 this->vertex_push (colEnd, this->vertexColors);
@@ -845,6 +3823,8 @@ namespace mplot {
                                 std::array<float, 3> colStart, std::array<float, 3> colEnd,
                                 float r = 1.0f, float r_end = 1.0f, int segments = 12)
         {
+            // The (cached) sines and cosines of the segment angles
+            const mplot::unit_meshes::circle& uc = mplot::unit_meshes::get_circle (segments);
             // The vector from start to end defines a vector and a plane. Find a
             // 'circle' of points in that plane.
             sm::vec<float> vstart = start;
@@ -876,9 +3856,7 @@ namespace mplot {
             // Start cap vertices. Draw as a triangle fan, but record indices so that we
             // only need a single call to glDrawElements.
             for (int j = 0; j < segments; j++) {
-                // t is the angle of the segment
-                float t = j * sm::mathconst<float>::two_pi/(float)segments;
-                sm::vec<float> c = inplane * std::sin(t) * r + v_x_inplane * std::cos(t) * r;
+                sm::vec<float> c = inplane * uc.sin_t[j] * r + v_x_inplane * uc.cos_t[j] * r;
                 this->vertex_push (vstart+c, this->vertexPositions);
                 this->vertex_push (-v, this->vertexNormals);
                 this->vertex_push (colStart, this->vertexColors);
@@ -886,8 +3864,7 @@ namespace mplot {
 
             // Intermediate, near start cap. Normals point in direction c
             for (int j = 0; j < segments; j++) {
-                float t = j * sm::mathconst<float>::two_pi/(float)segments;
-                sm::vec<float> c = inplane * std::sin(t) * r + v_x_inplane * std::cos(t) * r;
+                sm::vec<float> c = inplane * uc.sin_t[j] * r + v_x_inplane * uc.cos_t[j] * r;
                 this->vertex_push (vstart+c, this->vertexPositions);
                 c.renormalize();
                 this->vertex_push (c, this->vertexNormals);
@@ -896,8 +3873,7 @@ namespace mplot {
 
             // Intermediate, near end cap. Normals point in direction c
             for (int j = 0; j < segments; j++) {
-                float t = (float)j * sm::mathconst<float>::two_pi/(float)segments;
-                sm::vec<float> c = inplane * std::sin(t) * r_end + v_x_inplane * std::cos(t) * r_end;
+                sm::vec<float> c = inplane * uc.sin_t[j] * r_end + v_x_inplane * uc.cos_t[j] * r_end;
                 this->vertex_push (vend+c, this->vertexPositions);
                 c.renormalize();
                 this->vertex_push (c, this->vertexNormals);
@@ -906,8 +3882,7 @@ namespace mplot {
 
             // Bottom cap vertices
             for (int j = 0; j < segments; j++) {
-                float t = (float)j * sm::mathconst<float>::two_pi/(float)segments;
-                sm::vec<float> c = inplane * std::sin(t) * r_end + v_x_inplane * std::cos(t) * r_end;
+                sm::vec<float> c = inplane * uc.sin_t[j] * r_end + v_x_inplane * uc.cos_t[j] * r_end;
                 this->vertex_push (vend+c, this->vertexPositions);
                 this->vertex_push (v, this->vertexNormals);
                 this->vertex_push (colEnd, this->vertexColors);
@@ -982,6 +3957,108 @@ namespace mplot {
             this->idx += nverts;
         } // end computeFlaredTube with randomly initialized end vertices
 
+        /*!
+         * Compute many tubes (as computeTube) in one call. Tube i goes from starts[i] to ends[i]
+         * and its colour transitions from col_starts[i] to col_ends[i]. The sines and cosines of
+         * the segment angles and the pattern of indices of one tube are computed once, the vertex
+         * and index vectors are sized once for all the tubes and each tube's vertices are then
+         * written in place (in parallel, if OpenMP is available). This is much faster than a
+         * computeTube call per tube for models with very many tubes.
+         *
+         * Unlike computeTube, which orients the vertices around each tube at random, this
+         * orients them from the coordinate axis that is most nearly perpendicular to the tube, so
+         * that the result does not depend on the order in which the tubes are computed.
+         */
+        void computeTubes (std::span<const sm::vec<float>> starts, std::span<const sm::vec<float>> ends,
+                           std::span<const std::array<float, 3>> col_starts,
+                           std::span<const std::array<float, 3>> col_ends,
+                           const float r = 1.0f, const int segments = 12)
+        {
+            if (ends.size() != starts.size() || col_starts.size() != starts.size() || col_ends.size() != starts.size()) {
+                throw std::runtime_error ("VisualModel::computeTubes: starts, ends and colours must have the same size");
+            }
+            const std::size_t n = starts.size();
+            const std::size_t seg = static_cast<std::size_t>(segments);
+            const std::size_t nv = tube_vertex_count (segments);
+            const std::size_t ni = tube_index_count (segments);
+            const mplot::unit_meshes::circle& uc = mplot::unit_meshes::get_circle (segments);
+
+            // The indices of one tube, relative to its first vertex (as in computeFlaredTube)
+            std::vector<GLuint> pattern;
+            pattern.reserve (ni);
+            const GLuint end_middle = static_cast<GLuint>(nv) - 1u;
+            for (GLuint j = 0; j < seg; ++j) {
+                pattern.insert (pattern.end(), { 0u, 1u + j, 1u + (j + 1u) % static_cast<GLuint>(seg) });
+            }
+            for (GLuint ls = 0; ls < 3u; ++ls) {
+                const GLuint a = 1u + ls * static_cast<GLuint>(seg);
+                const GLuint b = a + static_cast<GLuint>(seg);
+                for (GLuint j = 0; j < seg; ++j) {
+                    const GLuint jn = (j + 1u) % static_cast<GLuint>(seg);
+                    pattern.insert (pattern.end(), { a + j, a + jn, b + j, b + j, b + jn, a + jn });
+                }
+            }
+            const GLuint bottom = 1u + 3u * static_cast<GLuint>(seg);
+            for (GLuint j = 0; j < seg; ++j) {
+                pattern.insert (pattern.end(), { end_middle, bottom + j, bottom + (j + 1u) % static_cast<GLuint>(seg) });
+            }
+
+            const std::size_t v0 = this->vertexPositions.size();
+            const std::size_t i0 = this->indices.size();
+            this->vertexPositions.resize (v0 + 3u * nv * n);
+            this->vertexNormals.resize (v0 + 3u * nv * n);
+            this->vertexColors.resize (v0 + 3u * nv * n);
+            this->indices.resize (i0 + ni * n);
+            const GLuint idx0 = this->idx;
+
+            const std::int64_t n_tubes = static_cast<std::int64_t>(n);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (std::int64_t ti = 0; ti < n_tubes; ++ti) {
+                const std::size_t t = static_cast<std::size_t>(ti);
+                sm::vec<float> v = ends[t] - starts[t];
+                v.renormalize();
+                // The coordinate axis least aligned with v gives the in-plane basis vectors
+                sm::vec<float> axis = { 0.0f, 0.0f, 0.0f };
+                const float ax = std::abs (v[0]), ay = std::abs (v[1]), az = std::abs (v[2]);
+                axis[(ax <= ay && ax <= az) ? 0 : (ay <= az ? 1 : 2)] = 1.0f;
+                sm::vec<float> inplane = axis.cross (v);
+                inplane.renormalize();
+                const sm::vec<float> v_x_inplane = v.cross (inplane);
+
+                float* p = this->vertexPositions.data() + v0 + 3u * nv * t;
+                float* nm = this->vertexNormals.data() + v0 + 3u * nv * t;
+                float* cl = this->vertexColors.data() + v0 + 3u * nv * t;
+                // Vertex k of the tube gets position o, normal nrm and colour c
+                auto set_vertex = [p, nm, cl](std::size_t k, const sm::vec<float>& o, const sm::vec<float>& nrm,
+                                              const std::array<float, 3>& c) {
+                    for (std::size_t j = 0; j < 3u; ++j) {
+                        p[3u * k + j] = o[j];
+                        nm[3u * k + j] = nrm[j];
+                        cl[3u * k + j] = c[j];
+                    }
+                };
+                set_vertex (0, starts[t], -v, col_starts[t]);
+                set_vertex (nv - 1u, ends[t], v, col_ends[t]);
+                // The four rings: start cap, start of side, end of side and end cap
+                for (std::size_t j = 0; j < seg; ++j) {
+                    const sm::vec<float> u = inplane * uc.sin_t[j] + v_x_inplane * uc.cos_t[j];
+                    const sm::vec<float> ps = starts[t] + u * r;
+                    const sm::vec<float> pe = ends[t] + u * r;
+                    set_vertex (1u + j, ps, -v, col_starts[t]);
+                    set_vertex (1u + seg + j, ps, u, col_starts[t]);
+                    set_vertex (1u + 2u * seg + j, pe, u, col_ends[t]);
+                    set_vertex (1u + 3u * seg + j, pe, v, col_ends[t]);
+                }
+
+                GLuint* ip = this->indices.data() + i0 + ni * t;
+                const GLuint first = idx0 + static_cast<GLuint>(nv * t);
+                for (std::size_t k = 0; k < ni; ++k) { ip[k] = first + pattern[k]; }
+            }
+            this->idx += static_cast<GLuint>(nv * n);
+        } // end computeTubes
+
         /*!
          * Create an open (no end caps) flared tube from \a start to \a end, with radius
          * \a r at the start and a colour which transitions from the colour \a colStart
@@ -1010,6 +4087,8 @@ namespace mplot {
                                     std::array<float, 3> colStart, std::array<float, 3> colEnd,
                                     float r = 1.0f, float r_end = 1.0f, int segments = 12)
         {
+            // The (cached) sines and cosines of the segment angles
+            const mplot::unit_meshes::circle& uc = mplot::unit_meshes::get_circle (segments);
             // The vector from start to end defines a vector and a plane. Find a
             // 'circle' of points in that plane.
             sm::vec<float> vstart = start;
@@ -1043,8 +4122,7 @@ namespace mplot {
             // c1(t) = ( (p1-x1).normalized std::sin(t) + v.normalized cross (p1-x1).normalized * std::cos(t) )
             // c1(t) = ( inplane std::sin(t) + v * inplane * std::cos(t)
             for (int j = 0; j < segments; j++) {
-                float t = j * sm::mathconst<float>::two_pi/(float)segments;
-                sm::vec<float> c = inplane * std::sin(t) * r + v_x_inplane * std::cos(t) * r_mod;
+                sm::vec<float> c = inplane * uc.sin_t[j] * r + v_x_inplane * uc.cos_t[j] * r_mod;
                 this->vertex_push (vstart+c, this->vertexPositions);
                 c.renormalize();
                 this->vertex_push (c, this->vertexNormals);
@@ -1057,8 +4135,7 @@ namespace mplot {
             r_mod = r_end / v_x_inplane.cross (v).length();
 
             for (int j = 0; j < segments; j++) {
-                float t = (float)j * sm::mathconst<float>::two_pi/(float)segments;
-                sm::vec<float> c = inplane * std::sin(t) * r_end + v_x_inplane * std::cos(t) * r_mod;
+                sm::vec<float> c = inplane * uc.sin_t[j] * r_end + v_x_inplane * uc.cos_t[j] * r_mod;
                 this->vertex_push (vend+c, this->vertexPositions);
                 c.renormalize();
                 this->vertex_push (c, this->vertexNormals);
@@ -1152,6 +4229,24 @@ namespace mplot {
             this->idx += 4;
         }
 
+        /*!
+         * Compute the quad that covers a disc of radius r at centre, in the plane of ux and uy,
+         * for colour_by_polar. Its colours are the positions of its corners in the disc.
+         */
+        void computePolarDisc (const sm::vec<float>& centre, const float r)
+        {
+            const sm::vec<float> dx = this->ux * r;
+            const sm::vec<float> dy = this->uy * r;
+            this->computeFlatQuad (centre - dx - dy, centre - dx + dy, centre + dx + dy, centre + dx - dy,
+                                   std::array<float, 3>{ 0.0f, 0.0f, 2.0f });
+            const std::array<float, 8> rg = { -1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f, 1.0f, -1.0f };
+            float* c = this->vertexColors.data() + this->vertexColors.size() - 12u;
+            for (std::size_t i = 0; i < 4u; ++i) {
+                c[3u * i] = rg[2u * i];
+                c[3u * i + 1u] = rg[2u * i + 1u];
+            }
+        }
+
         /*!
          * Compute a tube. This version requires unit vectors for orientation of the
          * tube end faces/vertices (useful for graph markers). The other version uses a
@@ -1175,6 +4270,10 @@ namespace mplot {
                               std::array<float, 3> col,
                               float r = 1.0f, int segments = 12, float rotation = 0.0f)
         {
+            // The sines and cosines of the segment angles (cached, if there is no rotation)
+            mplot::unit_meshes::circle rotated;
+            if (rotation != 0.0f) { rotated = mplot::unit_meshes::make_circle (segments, rotation); }
+            const mplot::unit_meshes::circle& uc = rotation != 0.0f ? rotated : mplot::unit_meshes::get_circle (segments);
             // v is a face normal
             sm::vec<float> v = _uy.cross(_ux);
             v.renormalize();
@@ -1186,9 +4285,7 @@ namespace mplot {
 
             // Polygon vertices (a triangle fan)
             for (int j = 0; j < segments; j++) {
-                // t is the angle of the segment
-                float t = rotation + j * sm::mathconst<float>::two_pi/(float)segments;
-                sm::vec<float> c = _ux * std::sin(t) * r + _uy * std::cos(t) * r;
+                sm::vec<float> c = _ux * uc.sin_t[j] * r + _uy * uc.cos_t[j] * r;
                 this->vertex_push (vstart+c, this->vertexPositions);
                 this->vertex_push (-v, this->vertexNormals);
                 this->vertex_push (col, this->vertexColors);
@@ -1228,19 +4325,19 @@ namespace mplot {
         void computeRing (sm::vec<float> ro, std::array<float, 3> rc, float r = 1.0f,
                           float t = 0.1f, int segments = 12)
         {
+            // The (cached) sines and cosines of the segment angles
+            const mplot::unit_meshes::circle& uc = mplot::unit_meshes::get_circle (segments);
             for (int j = 0; j < segments; j++) {
-                float segment = sm::mathconst<float>::two_pi * static_cast<float>(j) / segments;
                 // x and y of inner point
-                float xin = (r-(t*0.5f)) * std::cos(segment);
-                float yin = (r-(t*0.5f)) * std::sin(segment);
-                float xout = (r+(t*0.5f)) * std::cos(segment);
-                float yout = (r+(t*0.5f)) * std::sin(segment);
+                float xin = (r-(t*0.5f)) * uc.cos_t[j];
+                float yin = (r-(t*0.5f)) * uc.sin_t[j];
+                float xout = (r+(t*0.5f)) * uc.cos_t[j];
+                float yout = (r+(t*0.5f)) * uc.sin_t[j];
                 int segjnext = (j+1) % segments;
-                float segnext = sm::mathconst<float>::two_pi * static_cast<float>(segjnext) / segments;
-                float xin_n = (r-(t*0.5f)) * std::cos(segnext);
-                float yin_n = (r-(t*0.5f)) * std::sin(segnext);
-                float xout_n = (r+(t*0.5f)) * std::cos(segnext);
-                float yout_n = (r+(t*0.5f)) * std::sin(segnext);
+                float xin_n = (r-(t*0.5f)) * uc.cos_t[segjnext];
+                float yin_n = (r-(t*0.5f)) * uc.sin_t[segjnext];
+                float xout_n = (r+(t*0.5f)) * uc.cos_t[segjnext];
+                float yout_n = (r+(t*0.5f)) * uc.sin_t[segjnext];
 
                 // Now draw a quad
                 sm::vec<float> c4 = { xin, yin, 0.0f };
@@ -1389,25 +4486,35 @@ namespace mplot {
             } else {
                 static_assert (iterations <= 10, "computeSphereGeoFast: This is an abitrary iterations limit (10 gives 20971520 faces)");
             }
-            // Note that we need double precision to compute higher iterations of the geodesic (iterations > 5)
-            constexpr sm::geometry_ce::icosahedral_geodesic<F, iterations>  geo = sm::geometry_ce::make_icosahedral_geodesic<F, iterations>();
-
-            // Now essentially copy geo into vertex buffers
-            for (auto v : geo.poly.vertices) {
-                this->vertex_push (v.as_float() * r + so, this->vertexPositions);
-                this->vertex_push (v.as_float(), this->vertexNormals);
-                this->vertex_push (sc, this->vertexColors);
-            }
-            for (auto f : geo.poly.faces) {
-                this->indices.push_back (this->idx + f[0]);
-                this->indices.push_back (this->idx + f[1]);
-                this->indices.push_back (this->idx + f[2]);
-            }
+            // The geodesic is computed at compile time and its unit mesh is shared by all models
+            const mplot::unit_meshes::sphere& us = mplot::unit_meshes::get_geodesic<F, iterations>();
+            this->push_unit_sphere (us, so, r);
+            const std::size_t nverts = us.posn.size() / 3u;
+            for (std::size_t v = 0; v < nverts; ++v) { this->vertex_push (sc, this->vertexColors); }
             // idx is the *vertex index* and should be incremented by the number of vertices in the polyhedron
-            int n_verts = static_cast<int>(geo.poly.vertices.size());
-            this->idx += n_verts;
+            this->idx += static_cast<GLuint>(nverts);
 
-            return n_verts;
+            return static_cast<int>(nverts);
+        }
+
+        /*!
+         * Push the positions, normals and indices of the unit sphere us, scaled by r and placed at
+         * so. The colours are left to the caller, as is the increment of idx.
+         */
+        void push_unit_sphere (const mplot::unit_meshes::sphere& us, const sm::vec<float>& so, const float r)
+        {
+            const std::size_t nf = us.posn.size();
+            const std::size_t p0 = this->vertexPositions.size();
+            this->vertexPositions.resize (p0 + nf);
+            for (std::size_t i = 0; i < nf; i += 3u) {
+                this->vertexPositions[p0 + i] = so[0] + us.posn[i] * r;
+                this->vertexPositions[p0 + i + 1u] = so[1] + us.posn[i + 1u] * r;
+                this->vertexPositions[p0 + i + 2u] = so[2] + us.posn[i + 2u] * r;
+            }
+            this->vertexNormals.insert (this->vertexNormals.end(), us.norm.begin(), us.norm.end());
+            const std::size_t i0 = this->indices.size();
+            this->indices.resize (i0 + us.indices.size());
+            for (std::size_t i = 0; i < us.indices.size(); ++i) { this->indices[i0 + i] = this->idx + us.indices[i]; }
         }
 
         /*!
@@ -1426,127 +4533,62 @@ namespace mplot {
         void computeSphere (sm::vec<float> so, std::array<float, 3> sc,
                             float r = 1.0f, int rings = 10, int segments = 12)
         {
-            // First cap, draw as a triangle fan, but record indices so that
-            // we only need a single call to glDrawElements.
-            float rings0 = -sm::mathconst<float>::pi_over_2;
-            float _z0  = std::sin(rings0);
-            float z0  = r * _z0;
-            float r0 =  std::cos(rings0);
-            float rings1 = sm::mathconst<float>::pi * (-0.5f + 1.0f / rings);
-            float _z1 = std::sin(rings1);
-            float z1 = r * _z1;
-            float r1 = std::cos(rings1);
-            // Push the central point
-            this->vertex_push (so[0]+0.0f, so[1]+0.0f, so[2]+z0, this->vertexPositions);
-            this->vertex_push (0.0f, 0.0f, -1.0f, this->vertexNormals);
-            this->vertex_push (sc, this->vertexColors);
-
-            GLuint capMiddle = this->idx++;
-            GLuint ringStartIdx = this->idx;
-            GLuint lastRingStartIdx = this->idx;
-
-            bool firstseg = true;
-            for (int j = 0; j < segments; j++) {
-                float segment = sm::mathconst<float>::two_pi * static_cast<float>(j) / segments;
-                float x = std::cos(segment);
-                float y = std::sin(segment);
-
-                float _x1 = x*r1;
-                float x1 = _x1*r;
-                float _y1 = y*r1;
-                float y1 = _y1*r;
-
-                this->vertex_push (so[0]+x1, so[1]+y1, so[2]+z1, this->vertexPositions);
-                this->vertex_push (_x1, _y1, _z1, this->vertexNormals);
-                this->vertex_push (sc, this->vertexColors);
+            // The unit sphere for this tessellation is computed once and cached
+            const mplot::unit_meshes::sphere& us = mplot::unit_meshes::get_sphere (rings, segments);
+            this->push_unit_sphere (us, so, r);
+            const std::size_t nverts = us.posn.size() / 3u;
+            for (std::size_t v = 0; v < nverts; ++v) { this->vertex_push (sc, this->vertexColors); }
+            this->idx += static_cast<GLuint>(nverts);
+        } // end of sphere calculation
 
-                if (!firstseg) {
-                    this->indices.push_back (capMiddle);
-                    this->indices.push_back (this->idx-1);
-                    this->indices.push_back (this->idx++);
-                } else {
-                    this->idx++;
-                    firstseg = false;
-                }
+        /*!
+         * Compute many spheres (as the one colour computeSphere) in one call. Sphere i is at
+         * centres[i] with colour colours[i]. The vertex and index vectors are sized once for all
+         * the spheres and each sphere is then written in place (in parallel, if OpenMP is
+         * available).
+         */
+        void computeSpheres (std::span<const sm::vec<float>> centres, std::span<const std::array<float, 3>> colours,
+                             const float r = 1.0f, const int rings = 10, const int segments = 12)
+        {
+            if (colours.size() != centres.size()) {
+                throw std::runtime_error ("VisualModel::computeSpheres: centres and colours must have the same size");
             }
-            this->indices.push_back (capMiddle);
-            this->indices.push_back (this->idx-1);
-            this->indices.push_back (capMiddle+1);
-
-            // Now add the triangles around the rings
-            for (int i = 2; i < rings; i++) {
-
-                rings0 = sm::mathconst<float>::pi * (-0.5f + static_cast<float>(i) / rings);
-                _z0  = std::sin(rings0);
-                z0  = r * _z0;
-                r0 =  std::cos(rings0);
-
-                for (int j = 0; j < segments; j++) {
-
-                    // "current" segment
-                    float segment = sm::mathconst<float>::two_pi * static_cast<float>(j) / segments;
-                    float x = std::cos(segment);
-                    float y = std::sin(segment);
-
-                    // One vertex per segment
-                    float _x0 = x*r0;
-                    float x0 = _x0*r;
-                    float _y0 = y*r0;
-                    float y0 = _y0*r;
-
-                    // NB: Only add ONE vertex per segment. ALREADY have the first ring!
-                    this->vertex_push (so[0]+x0, so[1]+y0, so[2]+z0, this->vertexPositions);
-                    // The vertex normal of a vertex that makes up a sphere is
-                    // just a normal vector in the direction of the vertex.
-                    this->vertex_push (_x0, _y0, _z0, this->vertexNormals);
-                    this->vertex_push (sc, this->vertexColors);
-
-                    if (j == segments - 1) {
-                        // Last vertex is back to the start
-                        this->indices.push_back (ringStartIdx++);
-                        this->indices.push_back (this->idx);
-                        this->indices.push_back (lastRingStartIdx);
-                        this->indices.push_back (lastRingStartIdx);
-                        this->indices.push_back (this->idx++);
-                        this->indices.push_back (lastRingStartIdx+segments);
-                    } else {
-                        this->indices.push_back (ringStartIdx++);
-                        this->indices.push_back (this->idx);
-                        this->indices.push_back (ringStartIdx);
-                        this->indices.push_back (ringStartIdx);
-                        this->indices.push_back (this->idx++);
-                        this->indices.push_back (this->idx);
+            const mplot::unit_meshes::sphere& us = mplot::unit_meshes::get_sphere (rings, segments);
+            const std::size_t n = centres.size();
+            const std::size_t nf = us.posn.size();
+            const std::size_t nverts = nf / 3u;
+            const std::size_t ni = us.indices.size();
+
+            const std::size_t v0 = this->vertexPositions.size();
+            const std::size_t i0 = this->indices.size();
+            this->vertexPositions.resize (v0 + nf * n);
+            this->vertexNormals.resize (v0 + nf * n);
+            this->vertexColors.resize (v0 + nf * n);
+            this->indices.resize (i0 + ni * n);
+            const GLuint idx0 = this->idx;
+
+            const std::int64_t n_spheres = static_cast<std::int64_t>(n);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (std::int64_t si = 0; si < n_spheres; ++si) {
+                const std::size_t s = static_cast<std::size_t>(si);
+                float* p = this->vertexPositions.data() + v0 + nf * s;
+                float* nm = this->vertexNormals.data() + v0 + nf * s;
+                float* cl = this->vertexColors.data() + v0 + nf * s;
+                for (std::size_t i = 0; i < nf; i += 3u) {
+                    for (std::size_t j = 0; j < 3u; ++j) {
+                        p[i + j] = centres[s][j] + us.posn[i + j] * r;
+                        nm[i + j] = us.norm[i + j];
+                        cl[i + j] = colours[s][j];
                     }
                 }
-                lastRingStartIdx += segments;
-            }
-
-            // bottom cap
-            rings0 = sm::mathconst<float>::pi_over_2;
-            _z0  = std::sin(rings0);
-            z0  = r * _z0;
-            r0 =  std::cos(rings0);
-            // Push the central point of the bottom cap
-            this->vertex_push (so[0]+0.0f, so[1]+0.0f, so[2]+z0, this->vertexPositions);
-            this->vertex_push (0.0f, 0.0f, 1.0f, this->vertexNormals);
-            this->vertex_push (sc, this->vertexColors);
-            capMiddle = this->idx++;
-            firstseg = true;
-            // No more vertices to push, just do the indices for the bottom cap
-            ringStartIdx = lastRingStartIdx;
-            for (int j = 0; j < segments; j++) {
-                if (j != segments - 1) {
-                    this->indices.push_back (capMiddle);
-                    this->indices.push_back (ringStartIdx++);
-                    this->indices.push_back (ringStartIdx);
-                } else {
-                    // Last segment
-                    this->indices.push_back (capMiddle);
-                    this->indices.push_back (ringStartIdx);
-                    this->indices.push_back (lastRingStartIdx);
-                }
+                GLuint* ip = this->indices.data() + i0 + ni * s;
+                const GLuint first = idx0 + static_cast<GLuint>(nverts * s);
+                for (std::size_t k = 0; k < ni; ++k) { ip[k] = first + us.indices[k]; }
             }
-        } // end of sphere calculation
+            this->idx += static_cast<GLuint>(nverts * n);
+        }
 
         /*!
          * Sphere, two colour version.
@@ -1564,129 +4606,16 @@ namespace mplot {
         void computeSphere (sm::vec<float> so, std::array<float, 3> sc, std::array<float, 3> sc2,
                             float r = 1.0f, int rings = 10, int segments = 12)
         {
-            // First cap, draw as a triangle fan, but record indices so that
-            // we only need a single call to glDrawElements.
-            float rings0 = -sm::mathconst<float>::pi_over_2;
-            float _z0  = std::sin(rings0);
-            float z0  = r * _z0;
-            float r0 =  std::cos(rings0);
-            float rings1 = sm::mathconst<float>::pi * (-0.5f + 1.0f / rings);
-            float _z1 = std::sin(rings1);
-            float z1 = r * _z1;
-            float r1 = std::cos(rings1);
-            // Push the central point
-            this->vertex_push (so[0]+0.0f, so[1]+0.0f, so[2]+z0, this->vertexPositions);
-            this->vertex_push (0.0f, 0.0f, -1.0f, this->vertexNormals);
-            this->vertex_push (sc2, this->vertexColors);
-
-            GLuint capMiddle = this->idx++;
-            GLuint ringStartIdx = this->idx;
-            GLuint lastRingStartIdx = this->idx;
-
-            bool firstseg = true;
-            for (int j = 0; j < segments; j++) {
-                float segment = sm::mathconst<float>::two_pi * static_cast<float>(j) / segments;
-                float x = std::cos(segment);
-                float y = std::sin(segment);
-
-                float _x1 = x*r1;
-                float x1 = _x1*r;
-                float _y1 = y*r1;
-                float y1 = _y1*r;
-
-                this->vertex_push (so[0]+x1, so[1]+y1, so[2]+z1, this->vertexPositions);
-                this->vertex_push (_x1, _y1, _z1, this->vertexNormals);
-                this->vertex_push (sc2, this->vertexColors);
-
-                if (!firstseg) {
-                    this->indices.push_back (capMiddle);
-                    this->indices.push_back (this->idx-1);
-                    this->indices.push_back (this->idx++);
-                } else {
-                    this->idx++;
-                    firstseg = false;
-                }
-            }
-            this->indices.push_back (capMiddle);
-            this->indices.push_back (this->idx-1);
-            this->indices.push_back (capMiddle+1);
-
-            // Now add the triangles around the rings
-            for (int i = 2; i < rings; i++) {
-
-                rings0 = sm::mathconst<float>::pi * (-0.5f + static_cast<float>(i) / rings);
-                _z0  = std::sin(rings0);
-                z0  = r * _z0;
-                r0 =  std::cos(rings0);
-
-                for (int j = 0; j < segments; j++) {
-
-                    // "current" segment
-                    float segment = sm::mathconst<float>::two_pi * static_cast<float>(j) / segments;
-                    float x = std::cos(segment);
-                    float y = std::sin(segment);
-
-                    // One vertex per segment
-                    float _x0 = x*r0;
-                    float x0 = _x0*r;
-                    float _y0 = y*r0;
-                    float y0 = _y0*r;
-
-                    // NB: Only add ONE vertex per segment. ALREADY have the first ring!
-                    this->vertex_push (so[0]+x0, so[1]+y0, so[2]+z0, this->vertexPositions);
-                    // The vertex normal of a vertex that makes up a sphere is
-                    // just a normal vector in the direction of the vertex.
-                    this->vertex_push (_x0, _y0, _z0, this->vertexNormals);
-                    if (i == 2 || i > (rings-2)) {
-                        this->vertex_push (sc2, this->vertexColors);
-                    } else {
-                        this->vertex_push (sc, this->vertexColors);
-                    }
-                    if (j == segments - 1) {
-                        // Last vertex is back to the start
-                        this->indices.push_back (ringStartIdx++);
-                        this->indices.push_back (this->idx);
-                        this->indices.push_back (lastRingStartIdx);
-                        this->indices.push_back (lastRingStartIdx);
-                        this->indices.push_back (this->idx++);
-                        this->indices.push_back (lastRingStartIdx+segments);
-                    } else {
-                        this->indices.push_back (ringStartIdx++);
-                        this->indices.push_back (this->idx);
-                        this->indices.push_back (ringStartIdx);
-                        this->indices.push_back (ringStartIdx);
-                        this->indices.push_back (this->idx++);
-                        this->indices.push_back (this->idx);
-                    }
-                }
-                lastRingStartIdx += segments;
-            }
-
-            // bottom cap
-            rings0 = sm::mathconst<float>::pi_over_2;
-            _z0  = std::sin(rings0);
-            z0  = r * _z0;
-            r0 =  std::cos(rings0);
-            // Push the central point of the bottom cap
-            this->vertex_push (so[0]+0.0f, so[1]+0.0f, so[2]+z0, this->vertexPositions);
-            this->vertex_push (0.0f, 0.0f, 1.0f, this->vertexNormals);
-            this->vertex_push (sc2, this->vertexColors);
-            capMiddle = this->idx++;
-            firstseg = true;
-            // No more vertices to push, just do the indices for the bottom cap
-            ringStartIdx = lastRingStartIdx;
-            for (int j = 0; j < segments; j++) {
-                if (j != segments - 1) {
-                    this->indices.push_back (capMiddle);
-                    this->indices.push_back (ringStartIdx++);
-                    this->indices.push_back (ringStartIdx);
-                } else {
-                    // Last segment
-                    this->indices.push_back (capMiddle);
-                    this->indices.push_back (ringStartIdx);
-                    this->indices.push_back (lastRingStartIdx);
-                }
+            const mplot::unit_meshes::sphere& us = mplot::unit_meshes::get_sphere (rings, segments);
+            this->push_unit_sphere (us, so, r);
+            // The caps, the first two rings and the last ring have colour sc2, the rest sc
+            const std::size_t nverts = us.posn.size() / 3u;
+            for (std::size_t v = 0; v < nverts; ++v) {
+                const int ring = (v == 0 || v == nverts - 1) ? 0 : 1 + static_cast<int>((v - 1) / segments);
+                const bool second = ring <= 2 || ring > (rings - 2);
+                this->vertex_push (second ? sc2 : sc, this->vertexColors);
             }
+            this->idx += static_cast<GLuint>(nverts);
         }
 
         /*!
@@ -1738,6 +4667,8 @@ namespace mplot {
                           std::array<float, 3> col,
                           float r = 1.0f, int segments = 12)
         {
+            // The (cached) sines and cosines of the segment angles
+            const mplot::unit_meshes::circle& uc = mplot::unit_meshes::get_circle (segments);
             // Cone is drawn as a base ring around a centre-of-the-base vertex, an
             // intermediate ring which is on the base ring, but has different normals, a
             // 'ring' around the tip (with suitable normals) and a 'tip' vertex
@@ -1761,8 +4692,7 @@ namespace mplot {
 
             // Base ring with normals in direction -v
             for (int j = 0; j < segments; j++) {
-                float t = j * sm::mathconst<float>::two_pi / static_cast<float>(segments);
-                sm::vec<float> c = inplane * std::sin(t) * r + v_x_inplane * std::cos(t) * r;
+                sm::vec<float> c = inplane * uc.sin_t[j] * r + v_x_inplane * uc.cos_t[j] * r;
                 // Subtract the vector which makes this circle
                 c = c + (v * ringoffset);
                 this->vertex_push (vbase+c, this->vertexPositions);
@@ -1772,8 +4702,7 @@ namespace mplot {
 
             // Intermediate ring of vertices around/aligned with the base ring with normals in direction c
             for (int j = 0; j < segments; j++) {
-                float t = j * sm::mathconst<float>::two_pi / static_cast<float>(segments);
-                sm::vec<float> c = inplane * std::sin(t) * r + v_x_inplane * std::cos(t) * r;
+                sm::vec<float> c = inplane * uc.sin_t[j] * r + v_x_inplane * uc.cos_t[j] * r;
                 c = c + (v * ringoffset);
                 this->vertex_push (vbase+c, this->vertexPositions);
                 c.renormalize();
@@ -1783,8 +4712,7 @@ namespace mplot {
 
             // Intermediate ring of vertices around the tip with normals direction c
             for (int j = 0; j < segments; j++) {
-                float t = j * sm::mathconst<float>::two_pi / static_cast<float>(segments);
-                sm::vec<float> c = inplane * std::sin(t) * r + v_x_inplane * std::cos(t) * r;
+                sm::vec<float> c = inplane * uc.sin_t[j] * r + v_x_inplane * uc.cos_t[j] * r;
                 c = c + (v * ringoffset);
                 this->vertex_push (vtip, this->vertexPositions);
                 c.renormalize();
@@ -2087,6 +5015,59 @@ namespace mplot {
 
         } // end computeFlatLine
 
+        /*!
+         * Compute many flat lines (as computeFlatLine without shortening) in one call. Line i goes
+         * from starts[i] to ends[i] with colour cols[i], and all of the lines lie in the plane with
+         * normal _uz. The vertex and index vectors are sized once for all the lines and each
+         * line's 4 vertices and 6 indices are then written in place (in parallel, if OpenMP is
+         * available). This is much faster than a computeFlatLine call per line for large line sets.
+         */
+        void computeFlatLines (std::span<const sm::vec<float>> starts, std::span<const sm::vec<float>> ends,
+                               const sm::vec<float>& _uz, std::span<const std::array<float, 3>> cols,
+                               const float w = 0.1f)
+        {
+            if (ends.size() != starts.size() || cols.size() != starts.size()) {
+                throw std::runtime_error ("VisualModel::computeFlatLines: starts, ends and cols must have the same size");
+            }
+            const std::size_t n = starts.size();
+            constexpr std::size_t nv = flat_line_vertex_count();
+            constexpr std::size_t ni = flat_line_index_count();
+            constexpr std::array<GLuint, ni> pattern = { 0u, 1u, 2u, 0u, 2u, 3u };
+            const std::size_t v0 = this->vertexPositions.size();
+            const std::size_t i0 = this->indices.size();
+            this->vertexPositions.resize (v0 + 3u * nv * n);
+            this->vertexNormals.resize (v0 + 3u * nv * n);
+            this->vertexColors.resize (v0 + 3u * nv * n);
+            this->indices.resize (i0 + ni * n);
+            const GLuint idx0 = this->idx;
+
+            const std::int64_t n_lines = static_cast<std::int64_t>(n);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (std::int64_t li = 0; li < n_lines; ++li) {
+                const std::size_t l = static_cast<std::size_t>(li);
+                sm::vec<float> vv = (ends[l] - starts[l]).cross (_uz);
+                vv.renormalize();
+                const sm::vec<float> ww = vv * w * 0.5f;
+                const std::array<sm::vec<float>, nv> c = { starts[l] + ww, starts[l] - ww, ends[l] - ww, ends[l] + ww };
+                float* p = this->vertexPositions.data() + v0 + 3u * nv * l;
+                float* nm = this->vertexNormals.data() + v0 + 3u * nv * l;
+                float* cl = this->vertexColors.data() + v0 + 3u * nv * l;
+                for (std::size_t k = 0; k < nv; ++k) {
+                    for (std::size_t j = 0; j < 3u; ++j) {
+                        p[3u * k + j] = c[k][j];
+                        nm[3u * k + j] = _uz[j];
+                        cl[3u * k + j] = cols[l][j];
+                    }
+                }
+                GLuint* ip = this->indices.data() + i0 + ni * l;
+                const GLuint first = idx0 + static_cast<GLuint>(nv * l);
+                for (std::size_t k = 0; k < ni; ++k) { ip[k] = first + pattern[k]; }
+            }
+            this->idx += static_cast<GLuint>(nv * n);
+        } // end computeFlatLines
+
         // Like computeFlatLine but with option to add rounded start/end caps (I lazily
         // draw a whole circle around start/end to achieve this, rather than figuring
         // out a semi-circle).
@@ -2119,6 +5100,8 @@ namespace mplot {
             sm::vec<float> c4 = vend + ww;
 
             int segments = 12;
+            // The (cached) sines and cosines of the segment angles
+            const mplot::unit_meshes::circle& uc = mplot::unit_meshes::get_circle (segments);
             float r = 0.5f * w;
             unsigned int startvertices = 0u;
             if (startcaps) {
@@ -2129,8 +5112,7 @@ namespace mplot {
                 ++startvertices;
                 // Start cap vertices (a triangle fan)
                 for (int j = 0; j < segments; j++) {
-                    float t = j * sm::mathconst<float>::two_pi / static_cast<float>(segments);
-                    sm::vec<float> c = { std::sin(t) * r, std::cos(t) * r, 0.0f };
+                    sm::vec<float> c = { uc.sin_t[j] * r, uc.cos_t[j] * r, 0.0f };
                     this->vertex_push (vstart+c, this->vertexPositions);
                     this->vertex_push (_uz, this->vertexNormals);
                     this->vertex_push (col, this->vertexColors);
@@ -2163,8 +5145,7 @@ namespace mplot {
                 ++endvertices;
                 // End cap vertices (a triangle fan)
                 for (int j = 0; j < segments; j++) {
-                    float t = j * sm::mathconst<float>::two_pi / static_cast<float>(segments);
-                    sm::vec<float> c = { std::sin(t) * r, std::cos(t) * r, 0.0f };
+                    sm::vec<float> c = { uc.sin_t[j] * r, uc.cos_t[j] * r, 0.0f };
                     this->vertex_push (vend+c, this->vertexPositions);
                     this->vertex_push (_uz, this->vertexNormals);
                     this->vertex_push (col, this->vertexColors);
@@ -2499,6 +5480,8 @@ namespace mplot {
         void computeFlatCircleLine (sm::vec<float> centre, sm::vec<float> norm, sm::vec<float> inplane, float radius,
                                     float linewidth, std::array<float, 3> col, int segments = 128)
         {
+            // The (cached) sines and cosines of the segment angles
+            const mplot::unit_meshes::circle& uc = mplot::unit_meshes::get_circle (segments);
             inplane.renormalize();
             sm::vec<float> norm_x_inplane = norm.cross(inplane);
 
@@ -2508,12 +5491,11 @@ namespace mplot {
             // Inner ring at radius radius-linewidth/2 with normals in direction norm;
             // Outer ring at radius radius+linewidth/2 with normals also in direction norm
             for (int j = 0; j < segments; j++) {
-                float t = j * sm::mathconst<float>::two_pi / static_cast<float>(segments);
-                sm::vec<float> c_in = inplane * std::sin(t) * r_in + norm_x_inplane * std::cos(t) * r_in;
+                sm::vec<float> c_in = inplane * uc.sin_t[j] * r_in + norm_x_inplane * uc.cos_t[j] * r_in;
                 this->vertex_push (centre+c_in, this->vertexPositions);
                 this->vertex_push (norm, this->vertexNormals);
                 this->vertex_push (col, this->vertexColors);
-                sm::vec<float> c_out = inplane * std::sin(t) * r_out + norm_x_inplane * std::cos(t) * r_out;
+                sm::vec<float> c_out = inplane * uc.sin_t[j] * r_out + norm_x_inplane * uc.cos_t[j] * r_out;
                 this->vertex_push (centre+c_out, this->vertexPositions);
                 this->vertex_push (norm, this->vertexNormals);
                 this->vertex_push (col, this->vertexColors);
@@ -16,12 +16,25 @@
 #endif
 
 #include <type_traits>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <string>
 
 #include <mplot/VisualModelBase.h>
 
 #include <mplot/gl/util_mx.h>
+#include <mplot/gl/loadshaders_mx.h>
+#include <mplot/gl/debug_group_mx.h>
+#include <mplot/gl/upload_worker_mx.h>
+#include <mplot/VisualDefaultShaders.h>
 #include <mplot/VisualTextModel.h>
+#include <mplot/VisualResourcesMX.h>
 #include <mplot/TextGeometry.h>
+#include <mplot/text_layout.h>
 
 namespace mplot {
 
@@ -41,12 +54,84 @@ namespace mplot {
         //! destroy gl buffers in the deconstructor
         virtual ~VisualModelImpl() // clang gives -Wdelete-non-abstract-non-virtual-dtor without virtual
         {
+            // A caller that kept its own copy of the future of finalize_async (or reinit_async)
+            // may not have waited for the build, which would go on writing into the model. Any
+            // exception from the build goes with the model.
+            if (this->async_build.valid()) {
+                try { this->wait_for_build(); } catch (...) {}
+            }
             // Explicitly clear owned VisualTextModels
             this->texts.clear();
+            this->text_pool.clear();
+            // The upload worker may still be reading the vertices
+            if (this->upload_job != nullptr) {
+                this->upload_job->wait();
+                GladGLContext* _glfn = this->get_glfn(this->parentVis);
+                if (!this->upload_job->names.empty()) {
+                    _glfn->DeleteBuffers (static_cast<GLsizei>(this->upload_job->names.size()), this->upload_job->names.data());
+                }
+                if (this->upload_job->fence != nullptr) { _glfn->DeleteSync (this->upload_job->fence); }
+                this->upload_job.reset();
+            }
             if (this->vbos != nullptr) {
                 GladGLContext* _glfn = this->get_glfn(this->parentVis);
-                _glfn->DeleteBuffers (this->numVBO, this->vbos.get());
+                // The buffers of a shared mesh (or of shared geometry) are deleted by their last user
+                for (unsigned int vb = 0; vb < this->numVBO; ++vb) { if (this->buffer_shared[vb]) { this->leave_buffer (vb, false); } }
+                if (!this->mesh_shared || this->leave_mesh()) { _glfn->DeleteBuffers (this->numVBO, this->vbos.get()); }
                 _glfn->DeleteVertexArrays (1, &this->vao);
+                if (this->instanceVBO != 0) { _glfn->DeleteBuffers (1, &this->instanceVBO); }
+                if (this->datumVBO != 0) { _glfn->DeleteBuffers (1, &this->datumVBO); }
+                if (this->compactVBO != 0) { _glfn->DeleteBuffers (1, &this->compactVBO); }
+                if (this->gpu_mesh_prog != 0) {
+                    _glfn->DeleteProgram (this->gpu_mesh_prog);
+                    _glfn->DeleteBuffers (3, this->gpu_mesh_buffers);
+                }
+                if (this->gpu_mesh_range_prog != 0) { _glfn->DeleteProgram (this->gpu_mesh_range_prog); }
+                if (this->jump_flood_prog != 0) {
+                    _glfn->DeleteProgram (this->jump_flood_prog);
+                    _glfn->DeleteBuffers (4, this->jump_flood_buffers);
+                }
+                if (this->jump_flood_texture != 0) { _glfn->DeleteTextures (1, &this->jump_flood_texture); }
+                if (this->colour_lut_texture != 0) { _glfn->DeleteTextures (1, &this->colour_lut_texture); }
+                if (this->datum_texture_id != 0) { _glfn->DeleteTextures (1, &this->datum_texture_id); }
+                for (auto& f : this->stream.fences) { if (f != nullptr) { _glfn->DeleteSync (f); } }
+            }
+            if (this->polyline_prog != 0) {
+                GladGLContext* _glfn = this->get_glfn(this->parentVis);
+                _glfn->DeleteProgram (this->polyline_prog);
+                _glfn->DeleteVertexArrays (1, &this->polyline_vao);
+                _glfn->DeleteBuffers (1, &this->polyline_vbo);
+            }
+            if (this->sprite_prog != 0) {
+                GladGLContext* _glfn = this->get_glfn(this->parentVis);
+                _glfn->DeleteProgram (this->sprite_prog);
+                _glfn->DeleteVertexArrays (1, &this->sprite_vao);
+                _glfn->DeleteBuffers (1, &this->sprite_vbo);
+            }
+            if (this->bar_prog != 0) {
+                GladGLContext* _glfn = this->get_glfn(this->parentVis);
+                _glfn->DeleteProgram (this->bar_prog);
+                _glfn->DeleteVertexArrays (1, &this->bar_vao);
+                _glfn->DeleteBuffers (1, &this->bar_vbo);
+            }
+            if (this->volume_prog != 0) {
+                GladGLContext* _glfn = this->get_glfn(this->parentVis);
+                _glfn->DeleteProgram (this->volume_prog);
+                _glfn->DeleteVertexArrays (1, &this->volume_vao);
+                _glfn->DeleteTextures (1, &this->volume_texture);
+                _glfn->DeleteTextures (1, &this->volume_brick_texture);
+            }
+            if (this->raster_prog != 0) {
+                GladGLContext* _glfn = this->get_glfn(this->parentVis);
+                _glfn->DeleteProgram (this->raster_prog);
+                _glfn->DeleteVertexArrays (1, &this->raster_vao);
+                _glfn->DeleteBuffers (1, &this->raster_vbo);
+            }
+            if (this->cloud_prog != 0) {
+                GladGLContext* _glfn = this->get_glfn(this->parentVis);
+                _glfn->DeleteProgram (this->cloud_prog);
+                _glfn->DeleteVertexArrays (1, &this->cloud_vao);
+                _glfn->DeleteBuffers (1, &this->cloud_vbo);
             }
         }
 
@@ -63,6 +148,19 @@ namespace mplot {
             model->get_shaderprogs = &mplot::VisualBase<glver>::get_shaderprogs;
             model->get_gprog = &mplot::VisualBase<glver>::get_gprog;
             model->get_tprog = &mplot::VisualBase<glver>::get_tprog;
+            model->get_gprog_uniforms = &mplot::VisualBase<glver>::get_gprog_uniforms;
+            model->get_tprog_uniforms = &mplot::VisualBase<glver>::get_tprog_uniforms;
+            model->get_render_state = &mplot::VisualBase<glver>::get_render_state;
+            // Only text models have storage to recycle
+            if constexpr (requires { model->get_text_pool; }) {
+                model->get_text_pool = &mplot::VisualBase<glver>::get_text_pool;
+            }
+            // ...and only the other models are drawn into the pick buffer
+            if constexpr (requires { model->get_pick_uniforms; }) {
+                model->get_pick_uniforms = &mplot::VisualBase<glver>::get_pick_uniforms;
+                model->get_pick_sprite_uniforms = &mplot::VisualBase<glver>::get_pick_sprite_uniforms;
+            }
+            model->requestRedraw = &mplot::VisualBase<glver>::request_redraw;
 
             model->get_glfn = &mplot::VisualOwnableMX<glver>::get_glfn;
 
@@ -73,6 +171,15 @@ namespace mplot {
         //! Common code to call after the vertices have been set up. GL has to have been initialised.
         void postVertexInit() final
         {
+            if (this->host_only) { this->skip_upload(); return; }
+            // Take up the buffers of an upload that is still on the worker (see VisualMX::setUploadWorker)
+            if (this->upload_job != nullptr) {
+                this->wait_for_upload();
+                if (this->postVertexInitRequired == false) { return; }
+            }
+            // A large model's buffers may be filled on the Visual's upload worker instead
+            if (this->offload_upload()) { return; }
+            auto timer = this->time_upload (&mplot::upload_stats::full_uploads);
             GladGLContext* _glfn = this->get_glfn(this->parentVis);
 
             // Do gl memory allocation of vertex array once only
@@ -80,7 +187,7 @@ namespace mplot {
                 // Create vertex array object
                 _glfn->GenVertexArrays (1, &this->vao); // Safe for OpenGL 4.4-
             }
-            _glfn->BindVertexArray (this->vao);
+            mplot::gl::Util::bind_vao (this->get_render_state (this->parentVis), this->vao, _glfn);
 
             // Create the vertex buffer objects (once only)
             if (this->vbos == nullptr) {
@@ -88,21 +195,34 @@ namespace mplot {
                 _glfn->GenBuffers (this->numVBO, this->vbos.get()); // OpenGL 4.4- safe
             }
 
-            // Set up the indices buffer - bind and buffer the data in this->indices
-            _glfn->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->vbos[this->idxVBO]);
-
-            std::size_t sz = this->indices.size() * sizeof(GLuint);
-            _glfn->BufferData(GL_ELEMENT_ARRAY_BUFFER, sz, this->indices.data(), GL_STATIC_DRAW);
-
-            // Binds data from the "C++ world" to the OpenGL shader world for
-            // "position", "normalin" and "color"
-            // (bind, buffer and set vertex array object attribute)
-            this->setupVBO (this->vbos[this->posnVBO], this->vertexPositions, visgl::posnLoc);
-            this->setupVBO (this->vbos[this->normVBO], this->vertexNormals, visgl::normLoc);
-            this->setupVBO (this->vbos[this->colVBO], this->vertexColors, visgl::colLoc);
+            // Identical meshes share one set of buffers (see VisualModelBase::setShareMesh)
+            const bool shared = this->share_mesh();
+            this->leave_unsharable_buffers();
+
+            if (this->streaming) {
+                this->stream_buffers_update();
+            } else if (this->compact_vertices) {
+                this->upload_buffer (this->idxVBO);
+                this->upload_compact();
+            } else if (shared) {
+                // The buffers of an identical mesh already hold the vertices
+            } else {
+                // Set up the indices buffer, then bind data from the "C++ world" to the OpenGL
+                // shader world for "position", "normalin" and "color" (bind, buffer and set
+                // vertex array object attribute)
+                this->upload_geometry (this->idxVBO, false);
+                this->upload_geometry (this->posnVBO, false);
+                this->upload_geometry (this->normVBO, false);
+                this->upload_buffer (this->colVBO);
+            }
+            this->mark_uploaded();
+            this->compute_bounds();
+            this->release_host_vertices();
+            if (this->instanced) { this->upload_instances(); }
+            if (this->colour_by_datum || this->colour_by_element) { this->upload_datums(); }
 
             // Unbind only the vertex array (not the buffers, that causes GL_INVALID_ENUM errors)
-            _glfn->BindVertexArray(0); // carefully unbind and rebind
+            mplot::gl::Util::bind_vao (this->get_render_state (this->parentVis), 0, _glfn); // carefully unbind and rebind
             mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
 
             this->postVertexInitRequired = false;
@@ -117,70 +237,289 @@ namespace mplot {
          */
         void reinit_buffers() final
         {
+            if (this->host_only) { this->skip_upload(); return; }
+            auto timer = this->time_upload (&mplot::upload_stats::reinit_buffers);
             GladGLContext* _glfn = this->get_glfn(this->parentVis);
             if (this->setContext != nullptr) { this->setContext (this->parentVis); }
+            MPLOT_TRACE_GL_MX (_glfn, "VisualModel::reinit_buffers");
+            this->wait_for_build();
             if (this->postVertexInitRequired == true) { this->postVertexInit(); }
+            // Regenerate a GPU mesh after its data or vertices have changed
+            if (this->gpu_mesh && this->gpu_mesh_pending) { this->run_gpu_mesh(); }
             // Now re-set up the VBOs
-            _glfn->BindVertexArray (this->vao);                                    // carefully unbind and rebind
-            _glfn->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->vbos[this->idxVBO]);  // carefully unbind and rebind
-
-            std::size_t sz = this->indices.size() * sizeof(GLuint);
-            _glfn->BufferData(GL_ELEMENT_ARRAY_BUFFER, sz, this->indices.data(), GL_STATIC_DRAW);
-            this->setupVBO (this->vbos[this->posnVBO], this->vertexPositions, visgl::posnLoc);
-            this->setupVBO (this->vbos[this->normVBO], this->vertexNormals, visgl::normLoc);
-            this->setupVBO (this->vbos[this->colVBO], this->vertexColors, visgl::colLoc);
+            mplot::gl::Util::bind_vao (this->get_render_state (this->parentVis), this->vao, _glfn); // carefully unbind and rebind
+            const bool shared = this->share_mesh();
+            this->leave_unsharable_buffers();
+            if (this->streaming) {
+                this->stream_buffers_update();
+            } else if (this->compact_vertices) {
+                this->upload_buffer (this->idxVBO);
+                this->upload_compact();
+            } else if (shared) {
+                // The vertices are unchanged and are in the buffers of the shared mesh
+            } else if (this->host_vertices_absent()) {
+                // The buffers hold the vertices that were freed after the last upload (see setGpuResident)
+            } else if (this->sub_update_possible()) {
+                // Only some spans of the vertex data were changed (see mark_dirty)
+                this->upload_geometry (this->idxVBO, true);
+                this->upload_geometry (this->posnVBO, true);
+                this->upload_geometry (this->normVBO, true);
+                this->upload_dirty_ranges (this->colVBO);
+            } else {
+                this->upload_geometry (this->idxVBO, false);
+                this->upload_geometry (this->posnVBO, false);
+                this->upload_geometry (this->normVBO, false);
+                this->upload_buffer (this->colVBO);
+            }
+            this->mark_uploaded();
+            this->compute_bounds();
+            this->release_host_vertices();
+            if (this->instanced) { this->upload_instances(); }
+            if (this->colour_by_datum || this->colour_by_element) { this->upload_datums(); }
 
-            _glfn->BindVertexArray(0);                                // carefully unbind and rebind
+            mplot::gl::Util::bind_vao (this->get_render_state (this->parentVis), 0, _glfn); // carefully unbind and rebind
             mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);  // carefully unbind and rebind
+            this->scene_changed();
         }
 
         //! reinit ONLY vertexColors buffer
         void reinit_colour_buffer() final
         {
+            if (this->host_only) { this->skip_upload(); return; }
+            // The colours of a shared mesh are part of its key, so it is re-uploaded (or re-shared) in full
+            if (this->mesh_shared) { this->reinit_buffers(); return; }
+            auto timer = this->time_upload (&mplot::upload_stats::reinit_colour_buffers);
             if (this->setContext != nullptr) { this->setContext (this->parentVis); }
+            this->wait_for_build();
             if (this->postVertexInitRequired == true) { this->postVertexInit(); }
             GladGLContext* _glfn = this->get_glfn(this->parentVis);
             // Now re-set up the VBOs
-            _glfn->BindVertexArray (this->vao);  // carefully unbind and rebind
-            this->setupVBO (this->vbos[this->colVBO], this->vertexColors, visgl::colLoc);
-            _glfn->BindVertexArray(0);  // carefully unbind and rebind
+            mplot::gl::Util::bind_vao (this->get_render_state (this->parentVis), this->vao, _glfn); // carefully unbind and rebind
+            ++this->upload_generation;
+            if (this->colour_by_datum || this->colour_by_element) {
+                this->upload_datums();
+            } else if (this->compact_vertices) {
+                // The colours are interleaved with the positions and normals
+                this->upload_compact();
+            } else if (this->streaming) {
+                // All the buffers move to the next region of the ring together
+                this->stream_buffers_update();
+            } else if (!this->dirty_ranges[this->colVBO].empty() && this->sub_update_possible (this->colVBO)) {
+                this->upload_dirty_ranges (this->colVBO);
+            } else if (this->host_vertices_absent()) {
+                // The buffer holds the colours that were freed after the last upload (see setGpuResident)
+            } else {
+                this->upload_buffer (this->colVBO);
+                this->dirty_ranges[this->colVBO].clear();
+                this->uploaded_sizes[this->colVBO] = this->vertexColors.size();
+            }
+            mplot::gl::Util::bind_vao (this->get_render_state (this->parentVis), 0, _glfn); // carefully unbind and rebind
+            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+            this->scene_changed();
+        }
+
+        //! Upload ONLY instance_data
+        void reinit_instances() final
+        {
+            if (this->host_only) { this->skip_upload(); return; }
+            auto timer = this->time_upload (&mplot::upload_stats::reinit_instances);
+            if (this->setContext != nullptr) { this->setContext (this->parentVis); }
+            this->wait_for_build();
+            if (this->postVertexInitRequired == true) { this->postVertexInit(); }
+            GladGLContext* _glfn = this->get_glfn(this->parentVis);
+            mplot::gl::Util::bind_vao (this->get_render_state (this->parentVis), this->vao, _glfn);
+            this->upload_instances();
+            mplot::gl::Util::bind_vao (this->get_render_state (this->parentVis), 0, _glfn);
             mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+            this->scene_changed();
+        }
+
+        /*!
+         * Read indices, vertexPositions, vertexNormals and vertexColors back from the buffers
+         * after setGpuResident() has freed them. The vectors are kept until the next full upload.
+         */
+        void restore_host_vertices() final
+        {
+            if (!this->host_vertices_absent()) { return; }
+            if (this->setContext != nullptr) { this->setContext (this->parentVis); }
+            GladGLContext* _glfn = this->get_glfn(this->parentVis);
+            // Copy the first bytes bytes of buffer vb to dst
+            auto read_back = [this, _glfn] (const unsigned int vb, void* dst, const std::size_t bytes)
+            {
+                if (bytes == 0) { return; }
+                _glfn->BindBuffer (GL_COPY_READ_BUFFER, this->vbos[vb]);
+                const void* p = _glfn->MapBufferRange (GL_COPY_READ_BUFFER, 0, bytes, GL_MAP_READ_BIT);
+                if (p != nullptr) {
+                    std::memcpy (dst, p, bytes);
+                    _glfn->UnmapBuffer (GL_COPY_READ_BUFFER);
+                }
+                _glfn->BindBuffer (GL_COPY_READ_BUFFER, 0);
+            };
+            const std::size_t n_idx = this->uploaded_sizes[this->idxVBO];
+            this->indices.resize (n_idx);
+            if (this->index_type == GL_UNSIGNED_SHORT) {
+                std::vector<GLushort> indices16 (n_idx);
+                read_back (this->idxVBO, indices16.data(), n_idx * sizeof(GLushort));
+                std::copy (indices16.begin(), indices16.end(), this->indices.begin());
+            } else {
+                read_back (this->idxVBO, this->indices.data(), n_idx * sizeof(GLuint));
+            }
+            this->vertexPositions.resize (this->uploaded_sizes[this->posnVBO]);
+            read_back (this->posnVBO, this->vertexPositions.data(), this->vertexPositions.size() * sizeof(float));
+            this->vertexNormals.resize (this->uploaded_sizes[this->normVBO]);
+            if (this->normals_omitted) {
+                // An unlit model's normals were never uploaded; face them along z
+                for (std::size_t i = 2; i < this->vertexNormals.size(); i += 3) { this->vertexNormals[i] = 1.0f; }
+            } else {
+                read_back (this->normVBO, this->vertexNormals.data(), this->vertexNormals.size() * sizeof(float));
+            }
+            this->vertexColors.resize (this->uploaded_sizes[this->colVBO]);
+            read_back (this->colVBO, this->vertexColors.data(), this->vertexColors.size() * sizeof(float));
+            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+            this->host_released = false;
+        }
+
+        void clearTexts()
+        {
+            this->texts.clear();
+            this->texts_scene_current = false;
+        }
+
+        //! Move the texts into text_pool, from which pooledTextModel() can take them back
+        void poolTexts() final
+        {
+            for (auto& t : this->texts) {
+                std::string key = t->getText();
+                this->text_pool.emplace (std::move (key), std::move (t));
+            }
+            this->texts.clear();
+            this->texts_scene_current = false;
+        }
+
+        //! Destroy the text models left in text_pool
+        void dropTextPool() final { this->text_pool.clear(); }
+
+        /*!
+         * Return a text model for _txt in the font, size and resolution of tfeatures. If the last
+         * poolTexts() pooled one that shows _txt in those features, it is taken from the pool
+         * (and setupPooledText() need only move it), otherwise a new one is made. Use this in
+         * place of makeVisualTextModel for labels that recur from one rebuild to the next, such
+         * as tick labels.
+         */
+        std::unique_ptr<mplot::VisualTextModel<glver>> pooledTextModel (const std::string& _txt,
+                                                                        const mplot::TextFeatures& tfeatures)
+        {
+            auto [first, last] = this->text_pool.equal_range (_txt);
+            for (auto ti = first; ti != last; ++ti) {
+                const mplot::TextFeatures& tf = ti->second->getFeatures();
+                if (tf.fontsize == tfeatures.fontsize && tf.face_res() == tfeatures.face_res()
+                    && tf.font == tfeatures.font && tf.sdf == tfeatures.sdf && tf.billboard == tfeatures.billboard) {
+                    std::unique_ptr<mplot::VisualTextModel<glver>> tmup = std::move (ti->second);
+                    this->text_pool.erase (ti);
+                    tmup->setPriority (tfeatures.priority);
+                    return tmup;
+                }
+            }
+            return this->makeVisualTextModel (tfeatures);
+        }
+
+        //! Set up tm, from pooledTextModel(), to show _txt at _mv_offset in colour _clr. A pooled
+        //! model that already shows _txt in _clr is only moved, keeping its quads and buffers.
+        void setupPooledText (mplot::VisualTextModel<glver>& tm, const std::string& _txt,
+                              const sm::vec<float>& _mv_offset, const std::array<float, 3>& _clr)
+        {
+            if (!tm.empty() && tm.clr_text == _clr && tm.getText() == _txt) {
+                tm.setViewTranslation (_mv_offset);
+            } else {
+                tm.resetView();
+                tm.setupText (_txt, _mv_offset, _clr);
+            }
+        }
+
+        bool has_texts() const final { return !this->texts.empty(); }
+
+        bool texts_clip_bounds (const sm::mat44<float>& p, sm::vec<float, 2>& mn, sm::vec<float, 2>& mx) const final
+        {
+            for (const auto& t : this->texts) { if (!t->clip_bounds (p, mn, mx)) { return false; } }
+            return true;
+        }
+
+        std::size_t num_texts() const final { return this->texts.size(); }
+
+        std::size_t gpu_buffer_bytes (const GLuint buf) const final
+        {
+            return mplot::gl::Util::buffer_bytes (buf, this->get_glfn (this->parentVis));
         }
 
-        void clearTexts() { this->texts.clear(); }
+        void add_text_memory (mplot::memory_report& r) const final
+        {
+            if (this->texts.empty()) { return; }
+            mplot::memory_report tr;
+            tr.name = "texts";
+            for (const auto& t : this->texts) { tr.children.push_back (t->get_memory_report()); }
+            r.children.push_back (std::move (tr));
+        }
+
+        //! The model's text models, such as a graph's tick and axis labels
+        const std::vector<std::unique_ptr<mplot::VisualTextModel<glver>>>& getTexts() const { return this->texts; }
 
         static constexpr bool debug_render = false;
         //! Render the VisualModel. Note that it is assumed that the OpenGL context has been
         //! obtained by the parent Visual::render call.
         void render() // not final
         {
-            if (this->hide == true) { return; }
+            if (this->hide == true || this->host_only) { return; }
 
-            // Execute post-vertex init at render, as GL should be available.
-            if (this->postVertexInitRequired == true) { this->postVertexInit(); }
+            // Rebuild from any data published to the model's data slot (once the upload worker,
+            // if it is filling the buffers, has finished reading the vertices)
+            if (this->take_data_enabled && this->upload_job == nullptr) { this->take_data(); }
 
-            GLint prev_shader = 0;
+            // Execute post-vertex init at render, as GL should be available (and, after
+            // finalize_async, once the vertices have been computed). While the upload worker
+            // fills the buffers, the model is drawn from its previous buffers.
+            if (!this->async_build_running() && !this->upload_running() && this->postVertexInitRequired == true) { this->postVertexInit(); }
+            if (this->lod_enabled) { this->update_lod(); }
+            // Flood the Voronoi cells before the draw that samples them
+            if (this->jump_flood_pending) { this->run_jump_flood(); }
 
             GladGLContext* _glfn = this->get_glfn (this->parentVis);
-            _glfn->GetIntegerv (GL_CURRENT_PROGRAM, &prev_shader);
+            // The parent Visual records the GL state, so no glGet query is needed here
+            mplot::visgl::render_state& rs = this->get_render_state (this->parentVis);
             // Ensure the correct program is in play for this VisualModel
-            _glfn->UseProgram (this->get_gprog(this->parentVis));
+            mplot::gl::Util::use_program (rs, this->get_gprog (this->parentVis), _glfn);
 
-            if (!this->indices.empty()) {
+            if (this->uploaded_sizes[this->idxVBO] > 0 && rs.parts != mplot::visgl::model_parts::others) {
                 // It is only necessary to bind the vertex array object before rendering
                 // (not the vertex buffer objects)
-                _glfn->BindVertexArray (this->vao);
+                mplot::gl::Util::bind_vao (rs, this->vao, _glfn);
+                if (this->colour_buffer_changed) { this->bind_colour_buffer(); }
+
+                // Uniform locations were looked up when the program was linked
+                const mplot::visgl::shader_uniforms& u = this->get_gprog_uniforms (this->parentVis);
 
                 // Pass this->float to GLSL so the model can have an alpha value.
-                GLint loc_a = _glfn->GetUniformLocation (this->get_gprog(this->parentVis), static_cast<const GLchar*>("alpha"));
-                if (loc_a != -1) { _glfn->Uniform1f (loc_a, this->alpha); }
+                if (u.alpha != -1) { _glfn->Uniform1f (u.alpha, this->alpha); }
+
+                // Colour by datum (per vertex, from the datum texture or per element) through the
+                // colour lookup texture, or by vertex colour
+                const int datum_mode = this->datum_colour_mode();
+                if (u.colour_by_datum != -1) { _glfn->Uniform1i (u.colour_by_datum, datum_mode); }
+                if (datum_mode != 0) { this->bind_colour_lut (u); }
+                if (datum_mode == 2 || datum_mode == 3) { this->bind_datum_texture (u); }
 
-                GLint loc_v = _glfn->GetUniformLocation (this->get_gprog(this->parentVis), static_cast<const GLchar*>("v_matrix"));
-                if (loc_v != -1) { _glfn->UniformMatrix4fv (loc_v, 1, GL_FALSE, this->scenematrix.mat.data()); }
+                if (u.v_matrix != -1) { _glfn->UniformMatrix4fv (u.v_matrix, 1, GL_FALSE, this->scenematrix.mat.data()); }
 
                 // Should be able to apply scaling to the model matrix
-                GLint loc_m = _glfn->GetUniformLocation (this->get_gprog(this->parentVis), static_cast<const GLchar*>("m_matrix"));
-                if (loc_m != -1) { _glfn->UniformMatrix4fv (loc_m, 1, GL_FALSE, (this->model_scaling * this->viewmatrix).mat.data()); }
+                GLint loc_m = u.m_matrix;
+                if (loc_m != -1) { _glfn->UniformMatrix4fv (loc_m, 1, GL_FALSE, this->model_matrix().mat.data()); }
+
+                // The bend onto a cylinder (a zero radius leaves the vertices as they are)
+                const sm::vec<float, 4>& vc = this->vertex_curvature;
+                if (u.curvature != -1) { _glfn->Uniform4f (u.curvature, vc[0], vc[1], vc[2], vc[3]); }
+                if (u.curvature_offset != -1) {
+                    const sm::vec<float, 3>& vo = this->vertex_curvature_offset;
+                    _glfn->Uniform3f (u.curvature_offset, vo[0], vo[1], vo[2]);
+                }
 
                 if constexpr (debug_render) {
                     std::cout << "VisualModel::render: scenematrix:\n" << this->scenematrix << std::endl;
@@ -188,18 +527,144 @@ namespace mplot {
                 }
 
                 // Draw the triangles
-                _glfn->DrawElements (GL_TRIANGLES, static_cast<unsigned int>(this->indices.size()), GL_UNSIGNED_INT, 0);
+                if (this->instanced) {
+                    _glfn->DrawElementsInstanced (GL_TRIANGLES, static_cast<unsigned int>(this->uploaded_sizes[this->idxVBO]), this->index_type,
+                                                  reinterpret_cast<void*>(this->stream.offset[this->idxVBO]),
+                                                  static_cast<GLsizei>(this->uploaded_instances));
+                    ++rs.counts.draw_calls;
+                } else if (this->draw_spans.empty()) {
+                    _glfn->DrawElements (GL_TRIANGLES, static_cast<unsigned int>(this->uploaded_sizes[this->idxVBO]), this->index_type,
+                                         reinterpret_cast<void*>(this->stream.offset[this->idxVBO]));
+                    ++rs.counts.draw_calls;
+                } else {
+                    for (const auto& ds : this->draw_spans) {
+                        if (ds.count == 0) { continue; }
+                        if (loc_m != -1) {
+                            sm::mat44<float> offset_matrix;
+                            offset_matrix.translate (ds.offset);
+                            _glfn->UniformMatrix4fv (loc_m, 1, GL_FALSE, (this->model_matrix() * offset_matrix).mat.data());
+                        }
+                        const std::size_t byte_offset = this->stream.offset[this->idxVBO] + ds.first * this->index_size();
+                        _glfn->DrawElements (GL_TRIANGLES, static_cast<unsigned int>(ds.count), this->index_type,
+                                             reinterpret_cast<void*>(byte_offset));
+                        ++rs.counts.draw_calls;
+                    }
+                }
+
+                if constexpr (mplot::VisualModelBase<glver>::persistent_streaming) {
+                    if (this->streaming) {
+                        // Fence the region just drawn from, so it is not overwritten too soon
+                        GLsync& f = this->stream.fences[this->stream.region];
+                        if (f != nullptr) { _glfn->DeleteSync (f); }
+                        f = _glfn->FenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                    }
+                }
 
-                // Unbind the VAO
-                _glfn->BindVertexArray(0);
+                // The VAO is left bound; the next model's render binds its own (and Visual
+                // unbinds at the end of the frame)
             }
-            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+            if (rs.check_errors) { mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn); }
+
+            // The other parts are drawn in a later pass for order independent transparency
+            if (rs.parts == mplot::visgl::model_parts::triangles) { return; }
+
+            if (!this->polylines.empty()) { this->render_polylines(); }
+            if (!this->sprites.empty()) { this->render_sprites(); }
+            if (!this->bar_sets.empty()) { this->render_bars(); }
+            if (!this->volume.empty()) { this->render_volume(); }
+            if (!this->raster_ring.empty()) { this->render_raster(); }
+            if (this->has_cloud()) { this->render_cloud(); }
+
+            // Now render any VisualTextModels (only those that survive the declutter, if it is on)
+            if (this->declutter_enabled) {
+                this->update_declutter();
+                for (std::size_t i = 0; i < this->texts.size(); ++i) {
+                    if (this->declutter.shown[i]) { this->texts[i]->render(); }
+                }
+            } else {
+                auto ti = this->texts.begin();
+                while (ti != this->texts.end()) { (*ti)->render(); ti++; }
+            }
+        }
 
-            // Now render any VisualTextModels
-            auto ti = this->texts.begin();
-            while (ti != this->texts.end()) { (*ti)->render(); ti++; }
+        //! Choose the texts to draw for declutter_projection and declutter_dims, if either, the
+        //! model or its texts have changed since the last choice (see setDeclutterTexts)
+        void update_declutter()
+        {
+            if (!this->declutter_stale (this->texts.size())) { return; }
+            this->declutter.boxes.resize (this->texts.size());
+            for (std::size_t i = 0; i < this->texts.size(); ++i) {
+                this->texts[i]->declutter_box (this->declutter_projection, this->declutter_dims, this->declutter.boxes[i]);
+            }
+            this->declutter.run (this->declutter_dims);
+        }
 
-            _glfn->UseProgram (prev_shader);
+        //! Draw the model into the ID pass of Visual::pick (see VisualModelBase::render_pick)
+        void render_pick (const std::uint32_t model_id) final
+        {
+            if (this->hide == true || this->host_only) { return; }
+            GladGLContext* _glfn = this->get_glfn (this->parentVis);
+            mplot::visgl::render_state& rs = this->get_render_state (this->parentVis);
+            const mplot::visgl::visual_shaderprogs progs = this->get_shaderprogs (this->parentVis);
+            const sm::mat44<float>& m = this->model_matrix();
+
+            if (this->uploaded_sizes[this->idxVBO] > 0 && progs.pick_prog != 0) {
+                mplot::gl::Util::use_program (rs, progs.pick_prog, _glfn);
+                const mplot::visgl::shader_uniforms& u = this->get_pick_uniforms (this->parentVis);
+                mplot::gl::Util::bind_vao (rs, this->vao, _glfn);
+                _glfn->UniformMatrix4fv (u.m_matrix, 1, GL_FALSE, m.mat.data());
+                _glfn->UniformMatrix4fv (u.v_matrix, 1, GL_FALSE, this->scenematrix.mat.data());
+                _glfn->Uniform1ui (u.model_id, model_id);
+                _glfn->Uniform1i (u.pick_mode, this->instanced ? 2 : (this->colour_by_element ? 1 : 0));
+                const sm::vec<float, 4>& vc = this->vertex_curvature;
+                const sm::vec<float, 3>& vo = this->vertex_curvature_offset;
+                _glfn->Uniform4f (u.curvature, vc[0], vc[1], vc[2], vc[3]);
+                _glfn->Uniform3f (u.curvature_offset, vo[0], vo[1], vo[2]);
+                _glfn->Uniform1i (u.element_base, 0);
+                if (this->instanced) {
+                    _glfn->DrawElementsInstanced (GL_TRIANGLES, static_cast<unsigned int>(this->uploaded_sizes[this->idxVBO]), this->index_type,
+                                                  reinterpret_cast<void*>(this->stream.offset[this->idxVBO]),
+                                                  static_cast<GLsizei>(this->uploaded_instances));
+                    ++rs.counts.draw_calls;
+                } else if (this->draw_spans.empty()) {
+                    _glfn->DrawElements (GL_TRIANGLES, static_cast<unsigned int>(this->uploaded_sizes[this->idxVBO]), this->index_type,
+                                         reinterpret_cast<void*>(this->stream.offset[this->idxVBO]));
+                    ++rs.counts.draw_calls;
+                } else {
+                    for (const auto& ds : this->draw_spans) {
+                        if (ds.count == 0) { continue; }
+                        sm::mat44<float> offset_matrix;
+                        offset_matrix.translate (ds.offset);
+                        _glfn->UniformMatrix4fv (u.m_matrix, 1, GL_FALSE, (m * offset_matrix).mat.data());
+                        // gl_PrimitiveID counts from 0 in each draw call
+                        _glfn->Uniform1i (u.element_base, static_cast<GLint>(ds.first / 3));
+                        const std::size_t byte_offset = this->stream.offset[this->idxVBO] + ds.first * this->index_size();
+                        _glfn->DrawElements (GL_TRIANGLES, static_cast<unsigned int>(ds.count), this->index_type,
+                                             reinterpret_cast<void*>(byte_offset));
+                        ++rs.counts.draw_calls;
+                    }
+                }
+            }
+
+            // Sprites are drawn from the buffer that render_sprites uploaded
+            if (!this->sprites.empty() && this->sprite_vao != 0 && progs.pick_sprite_prog != 0) {
+                mplot::gl::Util::use_program (rs, progs.pick_sprite_prog, _glfn);
+                const mplot::visgl::shader_uniforms& u = this->get_pick_sprite_uniforms (this->parentVis);
+                mplot::gl::Util::bind_vao (rs, this->sprite_vao, _glfn);
+                _glfn->UniformMatrix4fv (u.m_matrix, 1, GL_FALSE, m.mat.data());
+                _glfn->UniformMatrix4fv (u.v_matrix, 1, GL_FALSE, this->scenematrix.mat.data());
+                _glfn->Uniform1ui (u.model_id, model_id);
+                _glfn->Uniform1f (u.sprite_radius, this->sprite_radius);
+                _glfn->Uniform2f (u.viewport, static_cast<float>(this->viewport_size[0]), static_cast<float>(this->viewport_size[1]));
+#ifdef GL_PROGRAM_POINT_SIZE
+                _glfn->Enable (GL_PROGRAM_POINT_SIZE);
+#endif
+                _glfn->DrawArrays (GL_POINTS, 0, static_cast<GLsizei>(this->sprites.size()));
+                ++rs.counts.draw_calls;
+#ifdef GL_PROGRAM_POINT_SIZE
+                _glfn->Disable (GL_PROGRAM_POINT_SIZE);
+#endif
+            }
             mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
         }
 
@@ -295,6 +760,74 @@ namespace mplot {
             return this->texts.back()->getTextGeometry();
         }
 
+        /*!
+         * Add many text labels, label i reading _texts[i] at _offsets[i] (within the model
+         * coordinates), all with the font features tfeatures, and return their geometries. This
+         * gives the same labels as calling addLabel for each, but the work is split: the glyphs
+         * that the labels use are looked up (and rasterized into the face's atlas if they are
+         * new) once each, on this thread, and then the labels' UTF-8 is decoded and their quads
+         * and vertices are made on n_threads worker threads (0 for one per hardware thread).
+         * Last, the labels' buffers are filled here, with the GL context made current just once.
+         * Use this for the thousands of labels of a scatter plot or of a HEALPix grid.
+         */
+        std::vector<mplot::TextGeometry> addLabels (const std::vector<std::string>& _texts,
+                                                    const std::vector<sm::vec<float, 3>>& _offsets,
+                                                    const mplot::TextFeatures& tfeatures = mplot::TextFeatures(),
+                                                    const unsigned int n_threads = 0)
+        {
+            if (_texts.size() != _offsets.size()) {
+                throw std::runtime_error ("VisualModel::addLabels: need one offset for each text");
+            }
+            if (_texts.empty()) { return {}; }
+            if (this->get_shaderprogs(this->parentVis).tprog == 0) {
+                throw std::runtime_error ("No text shader prog. Did your VisualModel-derived class set it up?");
+            }
+
+            if (this->setContext != nullptr) { this->setContext (this->parentVis); } // For VisualTextModel
+
+            const std::size_t n = _texts.size();
+            std::vector<std::unique_ptr<mplot::VisualTextModel<glver>>> tms (n);
+            for (auto& tm : tms) { tm = this->makeVisualTextModel (tfeatures); }
+
+            std::vector<std::basic_string<char32_t>> utxts (n);
+            mplot::text_layout::for_each (n, n_threads, [&](const std::size_t i) { utxts[i] = mplot::unicode::fromUtf8 (_texts[i]); });
+
+            // The labels share their face. Take a copy of each glyph that they use, so that the
+            // workers need not touch the face. If loading a glyph moved others in the atlas, look
+            // them all up again; if they still moved, the atlas can't hold them all together, and
+            // each label is laid out again from the face when it is rendered.
+            auto face = tms[0]->getFace();
+            const std::vector<char32_t> cps = mplot::text_layout::code_points (utxts);
+            std::unordered_map<char32_t, mplot::visgl::CharInfo> glyphs;
+            glyphs.reserve (cps.size());
+            unsigned int generation = face->generation;
+            for (int pass = 0; pass < 2; ++pass) {
+                generation = face->generation;
+                for (const char32_t c : cps) { glyphs[c] = face->get_glyph (c); }
+                if (face->generation == generation) { break; }
+            }
+            auto glyph_of = [&glyphs](const char32_t c) { return glyphs.find (c)->second; };
+
+            std::vector<mplot::TextGeometry> geoms (n);
+            mplot::text_layout::for_each (n, n_threads, [&](const std::size_t i) {
+                geoms[i] = tms[i]->layoutText (utxts[i], glyph_of, generation);
+                sm::vec<float, 3> locn = _offsets[i];
+                if (tfeatures.centre_horz == true) { locn[0] = -geoms[i].half_width(); }
+                tms[i]->placeText (locn + this->mv_offset, tfeatures.colour);
+            });
+
+            this->texts.reserve (this->texts.size() + n);
+            for (auto& tm : tms) {
+                tm->uploadText();
+                this->texts.push_back (std::move (tm));
+            }
+
+            // As this is a setup function, release the context
+            if (this->releaseContext != nullptr) { this->releaseContext (this->parentVis); }
+
+            return geoms;
+        }
+
         void setSceneMatrixTexts (const sm::mat44<float>& sv) final
         {
             auto ti = this->texts.begin();
@@ -319,8 +852,9 @@ namespace mplot {
                                              // translation is already there in the text,
                                              // but in the MODEL view.
 
-                // Rotate the view of the text an opposite amount, to keep it facing forwards
-                (*ti)->setViewRotation (r.invert());
+                // Rotate the view of the text an opposite amount, to keep it facing forwards. A
+                // billboard text faces forwards anyway (see TextFeatures::billboard).
+                if (!(*ti)->getBillboard()) { (*ti)->setViewRotation (r.invert()); }
                 ti++;
             }
         }
@@ -334,10 +868,165 @@ namespace mplot {
         //! Get the GladGLContext function pointer
         std::function<GladGLContext*(mplot::VisualBase<glver>*)> get_glfn;
 
+        //! Get the parent Visual's upload worker, if it has one (see VisualMX::setUploadWorker)
+        std::function<mplot::gl::upload_worker*(mplot::VisualBase<glver>*)> get_upload_worker;
+
+        //! True while the buffers are being filled on the Visual's upload worker
+        bool upload_pending() const { return this->upload_job != nullptr; }
+
+        /*!
+         * Block until an upload on the upload worker has finished and its fence has signalled,
+         * then take up the new buffers. Called before the model's vertices are changed (by
+         * finalize, reinit and the other calls that wait for a build).
+         */
+        void wait_for_upload() final
+        {
+            if (this->upload_job == nullptr) { return; }
+            if (this->setContext != nullptr) { this->setContext (this->parentVis); }
+            this->upload_job->wait();
+            if (this->upload_job->fence != nullptr) {
+                GladGLContext* _glfn = this->get_glfn(this->parentVis);
+                while (_glfn->ClientWaitSync (this->upload_job->fence, 0, mplot::VisualModelBase<glver>::stream_timeout) == GL_TIMEOUT_EXPIRED) {}
+            }
+            this->adopt_upload();
+        }
+
     protected:
+        //! The upload in flight on the Visual's upload worker, if any
+        std::shared_ptr<mplot::gl::upload_job> upload_job;
+        //! The 16 bit indices that the upload worker is reading (when short indices are possible)
+        std::vector<GLushort> upload_indices16;
+        //! The index type of the indices in upload_job
+        GLenum upload_index_type = GL_UNSIGNED_INT;
+        //! Set if an upload on the worker failed, after which the model uploads on the render thread
+        bool upload_worker_failed = false;
+
+        /*!
+         * Start a full upload of the buffers on the Visual's upload worker, if it has one and the
+         * model is large enough (see upload_worker::min_bytes) and is a plain model: not
+         * streaming, compact, batched, instanced, coloured by datum, a device or GPU mesh, sharing or
+         * sharable, nor reserving room to grow. Returns true if the upload was started, in which
+         * case postVertexInitRequired stays set until the new buffers are taken up.
+         */
+        bool offload_upload()
+        {
+            if (this->upload_worker_failed || this->get_upload_worker == nullptr) { return false; }
+            mplot::gl::upload_worker* w = this->get_upload_worker (this->parentVis);
+            if (w == nullptr || !w->ok()) { return false; }
+            if (this->streaming || this->compact_vertices || this->batched || this->instanced || this->colour_by_datum || this->colour_by_element
+                || this->gpu_mesh || !this->mesh_source.empty() || this->mesh_shared || this->mesh_sharable()
+                || this->any_dirty() || this->host_vertices_absent() || this->external_colour_buffer != 0) {
+                return false;
+            }
+            for (unsigned int vb = 0; vb < this->numVBO; ++vb) {
+                if (this->buffer_shared[vb] || this->geometry_sharable (vb) || this->buffer_reserve[vb] > this->buffer_size (vb)) { return false; }
+            }
+
+            auto j = std::make_shared<mplot::gl::upload_job>();
+            j->buffers.resize (this->numVBO);
+            std::size_t total = 0;
+            for (unsigned int vb = 0; vb < this->numVBO; ++vb) {
+                if (vb == this->normVBO && this->omit_normals()) { continue; } // an empty buffer
+                std::size_t elsz = sizeof(float);
+                const void* data = this->buffer_data (vb);
+                if (vb == this->idxVBO && this->short_indices_possible()) {
+                    visgl::narrow_indices (static_cast<const GLuint*>(data), this->buffer_size (vb), this->upload_indices16);
+                    data = this->upload_indices16.data();
+                    elsz = sizeof(GLushort);
+                }
+                j->buffers[vb] = { data, this->buffer_size (vb) * elsz };
+                total += j->buffers[vb].bytes;
+            }
+            if (total < w->min_bytes) {
+                std::vector<GLushort>().swap (this->upload_indices16);
+                return false;
+            }
+            this->upload_index_type = this->upload_indices16.empty() ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+            // The new buffers are drawn from once the render thread sees that the fence has signalled
+            j->on_done = [rr = this->requestRedraw, pv = this->parentVis]() { if (rr) { rr (pv); } };
+            this->upload_job = j;
+            w->submit (j);
+            return true;
+        }
+
+        /*!
+         * True while an upload on the upload worker is in flight. Once the worker is done and its
+         * fence has signalled (which is tested without blocking), the new buffers are taken up
+         * and this returns false.
+         */
+        bool upload_running()
+        {
+            if (this->upload_job == nullptr) { return false; }
+            if (!this->upload_job->done.load (std::memory_order_acquire)) { return true; }
+            if (this->upload_job->fence != nullptr) {
+                GladGLContext* _glfn = this->get_glfn(this->parentVis);
+                if (_glfn->ClientWaitSync (this->upload_job->fence, 0, 0) == GL_TIMEOUT_EXPIRED) { return true; }
+            }
+            this->adopt_upload();
+            return false;
+        }
+
+        /*!
+         * Swap the buffers filled by the upload worker into the model in place of its old ones,
+         * pointing the vertex array at them (vertex arrays can't be shared between contexts, so
+         * only the buffers were made on the worker). If the upload failed, the model is left to
+         * upload on the render thread.
+         */
+        void adopt_upload()
+        {
+            std::shared_ptr<mplot::gl::upload_job> j = std::move (this->upload_job);
+            this->upload_job.reset();
+            std::vector<GLushort>().swap (this->upload_indices16);
+            GladGLContext* _glfn = this->get_glfn(this->parentVis);
+            if (j->fence != nullptr) { _glfn->DeleteSync (j->fence); }
+            if (!j->error.empty() || j->names.size() != this->numVBO) {
+                if (!j->names.empty()) { _glfn->DeleteBuffers (static_cast<GLsizei>(j->names.size()), j->names.data()); }
+                std::cerr << "VisualModel: " << j->error << "; uploading on the render thread instead\n";
+                this->upload_worker_failed = true;
+                return;
+            }
+            auto timer = this->time_upload (&mplot::upload_stats::worker_uploads);
+
+            if (this->vbos == nullptr) {
+                _glfn->GenVertexArrays (1, &this->vao);
+                this->vbos = std::make_unique<GLuint[]>(this->numVBO);
+            } else {
+                _glfn->DeleteBuffers (this->numVBO, this->vbos.get());
+            }
+            for (unsigned int vb = 0; vb < this->numVBO; ++vb) { this->vbos[vb] = j->names[vb]; }
+
+            mplot::gl::Util::bind_vao (this->get_render_state (this->parentVis), this->vao, _glfn);
+            this->index_type = this->upload_index_type;
+            _glfn->BindBuffer (GL_ELEMENT_ARRAY_BUFFER, this->vbos[this->idxVBO]);
+            this->normals_omitted = this->omit_normals();
+            for (unsigned int vb : { this->posnVBO, this->normVBO, this->colVBO }) {
+                const unsigned int attrib = vb == this->posnVBO ? visgl::posnLoc : (vb == this->normVBO ? visgl::normLoc : visgl::colLoc);
+                if (vb == this->normVBO && this->normals_omitted) {
+                    _glfn->DisableVertexAttribArray (attrib);
+                    continue;
+                }
+                _glfn->BindBuffer (GL_ARRAY_BUFFER, this->vbos[vb]);
+                _glfn->VertexAttribPointer (attrib, 3, GL_FLOAT, GL_FALSE, 0, (void*)(0));
+                _glfn->EnableVertexAttribArray (attrib);
+            }
+            for (unsigned int vb = 0; vb < this->numVBO; ++vb) {
+                this->buffer_capacity[vb] = this->buffer_size (vb);
+                this->count_upload (this->vbo_target (vb), j->buffers[vb].bytes);
+            }
+            this->mark_uploaded();
+            this->compute_bounds();
+            this->release_host_vertices();
+            mplot::gl::Util::bind_vao (this->get_render_state (this->parentVis), 0, _glfn);
+            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+
+            this->postVertexInitRequired = false;
+            this->scene_changed();
+        }
 
         //! A vector of pointers to text models that should be rendered.
         std::vector<std::unique_ptr<mplot::VisualTextModel<glver>>> texts;
+        //! Text models set aside by poolTexts() for reuse, keyed by their text
+        std::multimap<std::string, std::unique_ptr<mplot::VisualTextModel<glver>>> text_pool;
 
         //! Set up a vertex buffer object - bind, buffer and set vertex array object attribute
         void setupVBO (GLuint& buf, std::vector<float>& dat, unsigned int bufferAttribPosition) final
@@ -348,12 +1037,1245 @@ namespace mplot {
             _glfn->BindBuffer (GL_ARRAY_BUFFER, buf);
             mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
             _glfn->BufferData (GL_ARRAY_BUFFER, sz, dat.data(), GL_STATIC_DRAW);
+            this->count_upload (mplot::upload_target::other, sz);
             mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
             _glfn->VertexAttribPointer (bufferAttribPosition, 3, GL_FLOAT, GL_FALSE, 0, (void*)(0));
             mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
             _glfn->EnableVertexAttribArray (bufferAttribPosition);
             mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
         }
+
+        /*!
+         * Upload indices, positions, normals and colours into the streaming buffers. With
+         * persistent_streaming, the data are written into the next region of each buffer's ring,
+         * once any earlier draw from that region has completed. Otherwise each buffer is orphaned
+         * and re-filled with BufferSubData. This is called with this->vao bound.
+         */
+        void stream_buffers_update()
+        {
+            GladGLContext* _glfn = this->get_glfn(this->parentVis);
+            if constexpr (mplot::VisualModelBase<glver>::persistent_streaming) {
+                this->stream.region = (this->stream.region + 1) % mplot::VisualModelBase<glver>::stream_regions;
+                GLsync& f = this->stream.fences[this->stream.region];
+                if (f != nullptr) {
+                    _glfn->ClientWaitSync (f, GL_SYNC_FLUSH_COMMANDS_BIT, mplot::VisualModelBase<glver>::stream_timeout);
+                    _glfn->DeleteSync (f);
+                    f = nullptr;
+                }
+            }
+            this->index_type = GL_UNSIGNED_INT;
+            this->stream_vbo (this->idxVBO, GL_ELEMENT_ARRAY_BUFFER, this->indices.data(),
+                              this->indices.size() * sizeof(GLuint), 0);
+            this->stream_vbo (this->posnVBO, GL_ARRAY_BUFFER, this->vertexPositions.data(),
+                              this->vertexPositions.size() * sizeof(float), visgl::posnLoc);
+            this->stream_vbo (this->normVBO, GL_ARRAY_BUFFER, this->vertexNormals.data(),
+                              this->vertexNormals.size() * sizeof(float), visgl::normLoc);
+            this->stream_vbo (this->colVBO, GL_ARRAY_BUFFER, this->vertexColors.data(),
+                              this->vertexColors.size() * sizeof(float), visgl::colLoc);
+            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+        }
+
+        //! Write sz bytes of data into the streaming buffer vbos[vb] and (for GL_ARRAY_BUFFER
+        //! targets) point the vertex attribute at the data's offset within the buffer.
+        void stream_vbo (const unsigned int vb, const GLenum target, const void* data,
+                         const std::size_t sz, const unsigned int bufferAttribPosition)
+        {
+            GladGLContext* _glfn = this->get_glfn(this->parentVis);
+            _glfn->BindBuffer (target, this->vbos[vb]);
+            if constexpr (mplot::VisualModelBase<glver>::persistent_streaming) {
+                constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+                if (this->stream.mapped[vb] == nullptr || sz > this->stream.capacity[vb]) {
+                    // Buffer storage is immutable, so replace the buffer with a larger one
+                    this->stream.capacity[vb] = std::max (sz + sz / 2, std::size_t{4096});
+                    _glfn->DeleteBuffers (1, &this->vbos[vb]);
+                    _glfn->GenBuffers (1, &this->vbos[vb]);
+                    _glfn->BindBuffer (target, this->vbos[vb]);
+                    const std::size_t bytes = this->stream.capacity[vb] * mplot::VisualModelBase<glver>::stream_regions;
+                    _glfn->BufferStorage (target, bytes, nullptr, flags);
+                    this->stream.mapped[vb] = _glfn->MapBufferRange (target, 0, bytes, flags);
+                    if (this->stream.mapped[vb] == nullptr) {
+                        throw std::runtime_error ("VisualModel: Failed to map streaming vertex buffer");
+                    }
+                }
+                this->stream.offset[vb] = this->stream.region * this->stream.capacity[vb];
+                if (sz > 0) {
+                    std::memcpy (static_cast<unsigned char*>(this->stream.mapped[vb]) + this->stream.offset[vb], data, sz);
+                    this->count_upload (this->vbo_target (vb), sz);
+                }
+            } else {
+                // Orphan the old storage, so the driver need not wait until the GPU is done with it
+                if (sz > this->stream.capacity[vb]) { this->stream.capacity[vb] = sz + sz / 2; }
+                _glfn->BufferData (target, this->stream.capacity[vb], nullptr, GL_STREAM_DRAW);
+                if (sz > 0) { _glfn->BufferSubData (target, 0, sz, data); this->count_upload (this->vbo_target (vb), sz); }
+                this->stream.offset[vb] = 0;
+            }
+            if (target == GL_ARRAY_BUFFER) {
+                _glfn->VertexAttribPointer (bufferAttribPosition, 3, GL_FLOAT, GL_FALSE, 0,
+                                            reinterpret_cast<void*>(this->stream.offset[vb]));
+                _glfn->EnableVertexAttribArray (bufferAttribPosition);
+            }
+        }
+
+        /*!
+         * Share the buffers of a registered mesh that is identical to this model's (see
+         * VisualModelBase::setShareMesh), or register this model's own buffers so that later
+         * identical models can share them. Returns true if vbos are shared buffers that already
+         * hold the model's vertices, so that nothing need be uploaded. A model whose shared mesh
+         * has changed leaves it, with buffers of its own. Called with this->vao bound.
+         */
+        bool share_mesh()
+        {
+            if (!this->mesh_shared && !this->mesh_sharable()) { return false; }
+            GladGLContext* _glfn = this->get_glfn(this->parentVis);
+            auto& res = mplot::VisualResourcesMX<glver>::i();
+            unsigned int g = 0;
+            const bool sharable = this->mesh_sharable() && res.find_group (this->parentVis, g);
+            if (this->mesh_shared) {
+                if (sharable && this->make_mesh_key (g) == this->shared_key) { return true; }
+                // The old buffers may still be in use by the other users of the mesh
+                if (!this->leave_mesh()) {
+                    _glfn->GenBuffers (this->numVBO, this->vbos.get());
+                    this->buffer_capacity = {};
+                }
+                this->mesh_changed = true;
+                return false;
+            }
+            if (!sharable) { return false; }
+            this->shared_key = this->make_mesh_key (g);
+            const std::array<unsigned int, 4>* b = res.acquire_mesh (this->shared_key);
+            this->mesh_shared = true;
+            if (b == nullptr) {
+                // The first of its kind. The caller uploads into the registered buffers.
+                res.register_mesh (this->shared_key, this->vbos.get());
+                return false;
+            }
+            _glfn->DeleteBuffers (this->numVBO, this->vbos.get());
+            for (unsigned int vb = 0; vb < this->numVBO; ++vb) {
+                this->vbos[vb] = (*b)[vb];
+                this->buffer_capacity[vb] = this->buffer_size (vb);
+            }
+            this->index_type = this->short_indices_possible() ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+            _glfn->BindBuffer (GL_ELEMENT_ARRAY_BUFFER, this->vbos[this->idxVBO]);
+            this->normals_omitted = this->omit_normals();
+            if (this->normals_omitted) { _glfn->DisableVertexAttribArray (visgl::normLoc); }
+            for (unsigned int vb : { this->posnVBO, this->normVBO, this->colVBO }) {
+                if (vb == this->normVBO && this->normals_omitted) { continue; }
+                const unsigned int attrib = vb == this->posnVBO ? visgl::posnLoc : (vb == this->normVBO ? visgl::normLoc : visgl::colLoc);
+                _glfn->BindBuffer (GL_ARRAY_BUFFER, this->vbos[vb]);
+                _glfn->VertexAttribPointer (attrib, 3, GL_FLOAT, GL_FALSE, 0, (void*)(0));
+                _glfn->EnableVertexAttribArray (attrib);
+            }
+            if (this->external_colour_buffer != 0) { this->colour_buffer_changed = true; }
+            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+            return true;
+        }
+
+        //! Leave the shared mesh. Returns true if this model was its last user, in which case the
+        //! buffers are now this model's alone.
+        bool leave_mesh()
+        {
+            this->mesh_shared = false;
+            return mplot::VisualResourcesMX<glver>::i().release_mesh (this->shared_key);
+        }
+
+        /*!
+         * Share buffer vb (the indices, positions or normals) with the other models in the
+         * context group whose buffer vb holds the same data (see
+         * VisualModelBase::setShareGeometry), or register this model's buffer so that later
+         * models can share it. Returns true if vbos[vb] is a shared buffer that already holds the
+         * data, so that nothing need be uploaded. A model whose data have changed leaves the
+         * buffer it shared. Called with this->vao bound.
+         */
+        bool share_buffer (const unsigned int vb)
+        {
+            if (!this->buffer_shared[vb] && !this->geometry_sharable (vb)) { return false; }
+            GladGLContext* _glfn = this->get_glfn(this->parentVis);
+            auto& res = mplot::VisualResourcesMX<glver>::i();
+            unsigned int g = 0;
+            const bool sharable = this->geometry_sharable (vb) && res.find_group (this->parentVis, g);
+            const visgl::buffer_key k = sharable ? this->make_buffer_key (g, vb) : visgl::buffer_key{};
+            if (this->buffer_shared[vb]) {
+                if (sharable && k == this->buffer_keys[vb]) { return true; }
+                this->leave_buffer (vb, true);
+            }
+            if (!sharable) { return false; }
+            this->buffer_keys[vb] = k;
+            this->buffer_shared[vb] = true;
+            const unsigned int* b = res.acquire_buffer (k);
+            if (b == nullptr) {
+                // The first of its kind. The caller uploads into the registered buffer.
+                res.register_buffer (k, this->vbos[vb]);
+                return false;
+            }
+            _glfn->DeleteBuffers (1, &this->vbos[vb]);
+            this->vbos[vb] = *b;
+            this->buffer_capacity[vb] = this->buffer_size (vb);
+            if (vb == this->idxVBO) {
+                this->index_type = this->short_indices_possible() ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+                _glfn->BindBuffer (GL_ELEMENT_ARRAY_BUFFER, this->vbos[vb]);
+            } else {
+                if (vb == this->normVBO) { this->normals_omitted = false; }
+                const unsigned int attrib = vb == this->posnVBO ? visgl::posnLoc : visgl::normLoc;
+                _glfn->BindBuffer (GL_ARRAY_BUFFER, this->vbos[vb]);
+                _glfn->VertexAttribPointer (attrib, 3, GL_FLOAT, GL_FALSE, 0, (void*)(0));
+                _glfn->EnableVertexAttribArray (attrib);
+            }
+            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+            return true;
+        }
+
+        //! Leave the shared buffer vb. If other models still use it and replace is true, a new,
+        //! empty buffer of this model's own takes its place; if replace is false vbos[vb] is zeroed.
+        void leave_buffer (const unsigned int vb, const bool replace)
+        {
+            this->buffer_shared[vb] = false;
+            if (mplot::VisualResourcesMX<glver>::i().release_buffer (this->buffer_keys[vb])) { return; }
+            if (replace) {
+                GladGLContext* _glfn = this->get_glfn(this->parentVis);
+                _glfn->GenBuffers (1, &this->vbos[vb]);
+                this->buffer_capacity[vb] = 0;
+            } else {
+                this->vbos[vb] = 0;
+            }
+        }
+
+        //! Leave any shared geometry buffers that the model can no longer share (it has become
+        //! streaming, say), before they are written to
+        void leave_unsharable_buffers()
+        {
+            for (unsigned int vb : { this->idxVBO, this->posnVBO, this->normVBO }) {
+                if (this->buffer_shared[vb] && !this->geometry_sharable (vb)) { this->leave_buffer (vb, true); }
+            }
+        }
+
+        //! Upload buffer vb in full, or just its dirty ranges if sub is true and they fit, unless
+        //! it is shared geometry that already holds the data. Called with this->vao bound.
+        void upload_geometry (const unsigned int vb, const bool sub)
+        {
+            const GLuint before = this->vbos[vb];
+            if (this->share_buffer (vb)) {
+                this->dirty_ranges[vb].clear();
+                return;
+            }
+            if (sub && this->vbos[vb] == before && this->sub_update_possible (vb)) {
+                this->upload_dirty_ranges (vb);
+            } else {
+                this->upload_buffer (vb);
+            }
+        }
+
+        /*!
+         * Upload all of buffer vb, allocating space for at least buffer_reserve[vb] elements. If
+         * vb has dirty ranges (it is being updated incrementally but has outgrown its allocation)
+         * twice its size is allocated, so that it can go on growing with BufferSubData updates.
+         * This is called with this->vao bound.
+         */
+        void upload_buffer (const unsigned int vb)
+        {
+            GladGLContext* _glfn = this->get_glfn(this->parentVis);
+            if (vb == this->normVBO) {
+                // An unlit model is drawn without normals (see VisualModelBase::setUnlit)
+                this->normals_omitted = this->omit_normals();
+                if (this->normals_omitted) {
+                    _glfn->DisableVertexAttribArray (visgl::normLoc);
+                    return;
+                }
+            }
+            const GLenum target = vb == this->idxVBO ? GL_ELEMENT_ARRAY_BUFFER : GL_ARRAY_BUFFER;
+            std::size_t elsz = sizeof(float); // GLuint indices are the same size (16 bit ones are narrowed below)
+            const std::size_t n = this->buffer_size (vb);
+            const void* data = this->buffer_data (vb);
+            std::vector<GLushort> indices16;
+            if (vb == this->idxVBO) {
+                this->index_type = this->short_indices_possible() ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+                if (this->index_type == GL_UNSIGNED_SHORT) {
+                    visgl::narrow_indices (static_cast<const GLuint*>(data), n, indices16);
+                    data = indices16.data();
+                    elsz = sizeof(GLushort);
+                }
+            }
+            std::size_t cap = std::max (n, this->buffer_reserve[vb]);
+            if (!this->dirty_ranges[vb].empty()) { cap = std::max (cap, 2u * n); }
+
+            _glfn->BindBuffer (target, this->vbos[vb]);
+            if (cap == n) {
+                _glfn->BufferData (target, n * elsz, data, GL_STATIC_DRAW);
+                this->count_upload (this->vbo_target (vb), n * elsz);
+            } else {
+                _glfn->BufferData (target, cap * elsz, nullptr, GL_DYNAMIC_DRAW);
+                _glfn->BufferSubData (target, 0, n * elsz, data);
+                this->count_upload (this->vbo_target (vb), n * elsz);
+            }
+            this->buffer_capacity[vb] = cap;
+
+            if (vb != this->idxVBO) {
+                const unsigned int attrib = vb == this->posnVBO ? visgl::posnLoc : (vb == this->normVBO ? visgl::normLoc : visgl::colLoc);
+                _glfn->VertexAttribPointer (attrib, 3, GL_FLOAT, GL_FALSE, 0, (void*)(0));
+                _glfn->EnableVertexAttribArray (attrib);
+            }
+            // A client colour buffer takes the place of colVBO again at the next render
+            if (vb == this->colVBO && this->external_colour_buffer != 0) { this->colour_buffer_changed = true; }
+            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+        }
+
+        //! Upload the (merged) dirty ranges of buffer vb with BufferSubData. Called with this->vao bound.
+        void upload_dirty_ranges (const unsigned int vb)
+        {
+            GladGLContext* _glfn = this->get_glfn(this->parentVis);
+            const GLenum target = vb == this->idxVBO ? GL_ELEMENT_ARRAY_BUFFER : GL_ARRAY_BUFFER;
+            static_assert (sizeof(GLuint) == sizeof(float), "upload_dirty_ranges assumes GLuint and float are the same size");
+            constexpr std::size_t elsz = sizeof(float);
+            if (vb == this->normVBO && this->normals_omitted) { this->take_dirty_ranges (vb); return; }
+            const unsigned char* data = static_cast<const unsigned char*>(this->buffer_data (vb));
+            if (data == nullptr) { return; }
+            _glfn->BindBuffer (target, this->vbos[vb]);
+            if (vb == this->idxVBO && this->index_type == GL_UNSIGNED_SHORT) {
+                std::vector<GLushort> indices16;
+                for (const auto& r : this->take_dirty_ranges (vb)) {
+                    visgl::narrow_indices (reinterpret_cast<const GLuint*>(data) + r[0], r[1] - r[0], indices16);
+                    _glfn->BufferSubData (target, r[0] * sizeof(GLushort), (r[1] - r[0]) * sizeof(GLushort), indices16.data());
+                    this->count_upload (this->vbo_target (vb), (r[1] - r[0]) * sizeof(GLushort));
+                }
+            } else {
+                for (const auto& r : this->take_dirty_ranges (vb)) {
+                    _glfn->BufferSubData (target, r[0] * elsz, (r[1] - r[0]) * elsz, data + r[0] * elsz);
+                    this->count_upload (this->vbo_target (vb), (r[1] - r[0]) * elsz);
+                }
+            }
+            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+        }
+
+        /*!
+         * Pack the vertices into compact_data and upload them into compactVBO, pointing the
+         * position, normal and colour attributes at their interleaved fields. Reallocates only
+         * when the model has outgrown the buffer. Called with this->vao bound.
+         */
+        void upload_compact()
+        {
+            GladGLContext* _glfn = this->get_glfn(this->parentVis);
+            constexpr GLsizei stride = mplot::VisualModelBase<glver>::compact_stride;
+            this->pack_compact_vertices();
+            if (this->compactVBO == 0) { _glfn->GenBuffers (1, &this->compactVBO); }
+            _glfn->BindBuffer (GL_ARRAY_BUFFER, this->compactVBO);
+            const std::size_t n = this->compact_data.size();
+            if (n > this->compact_capacity || this->compact_capacity == 0) {
+                this->compact_capacity = std::max (n, std::size_t{stride});
+                _glfn->BufferData (GL_ARRAY_BUFFER, this->compact_capacity, nullptr, GL_STATIC_DRAW);
+            }
+            if (n > 0) { _glfn->BufferSubData (GL_ARRAY_BUFFER, 0, n, this->compact_data.data()); this->count_upload (mplot::upload_target::compact, n); }
+
+            _glfn->VertexAttribPointer (visgl::posnLoc, 3, GL_FLOAT, GL_FALSE, stride, (void*)(0));
+            _glfn->EnableVertexAttribArray (visgl::posnLoc);
+            _glfn->VertexAttribPointer (visgl::normLoc, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)(12));
+            _glfn->EnableVertexAttribArray (visgl::normLoc);
+            _glfn->VertexAttribPointer (visgl::colLoc, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)(16));
+            _glfn->EnableVertexAttribArray (visgl::colLoc);
+            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+        }
+
+        //! Point the colour attribute at external_colour_buffer (or, if it is 0, at colVBO).
+        //! Called with this->vao bound.
+        void bind_colour_buffer()
+        {
+            GladGLContext* _glfn = this->get_glfn(this->parentVis);
+            const GLuint buf = this->external_colour_buffer != 0 ? this->external_colour_buffer : this->vbos[this->colVBO];
+            _glfn->BindBuffer (GL_ARRAY_BUFFER, buf);
+            _glfn->VertexAttribPointer (visgl::colLoc, 3, GL_FLOAT, GL_FALSE, 0, (void*)(0));
+            _glfn->EnableVertexAttribArray (visgl::colLoc);
+            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+            this->colour_buffer_changed = false;
+        }
+
+        /*!
+         * Draw the polylines (see VisualModelBase::add_polyline), one instanced draw of six
+         * vertices per segment for each polyline. The program, vertex array and points buffer are
+         * created on the first call, and the points are uploaded if they have changed.
+         */
+        void render_polylines()
+        {
+            GladGLContext* _glfn = this->get_glfn (this->parentVis);
+            mplot::visgl::render_state& rs = this->get_render_state (this->parentVis);
+            if (this->polyline_prog == 0) {
+                std::vector<mplot::gl::ShaderInfo> shader_progs = {
+                    {GL_VERTEX_SHADER, "VisualPolyline.vert.glsl", mplot::getDefaultPolylineVtxShader(glver), 0 },
+                    {GL_FRAGMENT_SHADER, "VisualPolyline.frag.glsl", mplot::getDefaultPolylineFragShader(glver), 0 }
+                };
+                this->polyline_prog = mplot::gl::LoadShadersMX (shader_progs, _glfn);
+                const GLuint block = _glfn->GetUniformBlockIndex (this->polyline_prog, "SceneState");
+                if (block != GL_INVALID_INDEX) { _glfn->UniformBlockBinding (this->polyline_prog, block, mplot::visgl::scene_state_binding); }
+                _glfn->GenVertexArrays (1, &this->polyline_vao);
+                _glfn->GenBuffers (1, &this->polyline_vbo);
+                mplot::gl::Util::bind_vao (rs, this->polyline_vao, _glfn);
+                // p_prev, p_a, p_b and p_next advance by one point per instance (one segment)
+                for (GLuint a = 0; a < 4u; ++a) {
+                    _glfn->VertexAttribDivisor (a, 1);
+                    _glfn->EnableVertexAttribArray (a);
+                }
+                this->polylines_changed = true;
+            }
+            mplot::gl::Util::bind_vao (rs, this->polyline_vao, _glfn);
+            _glfn->BindBuffer (GL_ARRAY_BUFFER, this->polyline_vbo);
+            if (this->polylines_changed) {
+                const std::size_t n = this->polyline_points.size();
+                if (n > this->polyline_capacity || this->polyline_capacity == 0) {
+                    this->polyline_capacity = std::max (n, std::size_t{4});
+                    _glfn->BufferData (GL_ARRAY_BUFFER, this->polyline_capacity * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+                }
+                if (n > 0) { _glfn->BufferSubData (GL_ARRAY_BUFFER, 0, n * sizeof(float), this->polyline_points.data()); this->count_upload (mplot::upload_target::polylines, n * sizeof(float)); }
+                this->polylines_changed = false;
+            }
+
+            mplot::gl::Util::use_program (rs, this->polyline_prog, _glfn);
+            auto loc = [this, _glfn](const char* name) { return _glfn->GetUniformLocation (this->polyline_prog, name); };
+            _glfn->UniformMatrix4fv (loc ("m_matrix"), 1, GL_FALSE, this->model_matrix().mat.data());
+            _glfn->UniformMatrix4fv (loc ("v_matrix"), 1, GL_FALSE, this->scenematrix.mat.data());
+            _glfn->Uniform1f (loc ("alpha"), this->alpha);
+            _glfn->Uniform2f (loc ("viewport"), static_cast<float>(this->viewport_size[0]), static_cast<float>(this->viewport_size[1]));
+            const GLint loc_colour = loc ("line_colour");
+            const GLint loc_normal = loc ("line_normal");
+            const GLint loc_width = loc ("line_width");
+            const GLint loc_pixels = loc ("width_in_pixels");
+            const GLint loc_dash = loc ("dash");
+            const GLint loc_pre = loc ("data_pre");
+            const GLint loc_post = loc ("data_post");
+            const GLint loc_log = loc ("data_log");
+            const GLint loc_clip = loc ("clip_box");
+            constexpr GLsizei stride = 4 * sizeof(float);
+            for (const auto& pl : this->polylines) {
+                if (pl.count < 2u) { continue; }
+                _glfn->Uniform3f (loc_colour, pl.colour[0], pl.colour[1], pl.colour[2]);
+                _glfn->Uniform3f (loc_normal, pl.normal[0], pl.normal[1], pl.normal[2]);
+                _glfn->Uniform1f (loc_width, pl.width);
+                _glfn->Uniform1i (loc_pixels, pl.width_in_pixels ? 1 : 0);
+                _glfn->Uniform2f (loc_dash, pl.dash, pl.gap);
+                const auto& t = pl.transform;
+                _glfn->Uniform4f (loc_pre, t.pre_scale[0], t.pre_offset[0], t.pre_scale[1], t.pre_offset[1]);
+                _glfn->Uniform4f (loc_post, t.scale[0], t.offset[0], t.scale[1], t.offset[1]);
+                _glfn->Uniform2i (loc_log, t.log[0] ? 1 : 0, t.log[1] ? 1 : 0);
+                _glfn->Uniform4f (loc_clip, pl.clip[0], pl.clip[1], pl.clip[2], pl.clip[3]);
+                for (GLuint a = 0; a < 4u; ++a) {
+                    _glfn->VertexAttribPointer (a, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>((pl.first + a) * stride));
+                }
+                _glfn->DrawArraysInstanced (GL_TRIANGLES, 0, 6, static_cast<GLsizei>(pl.count - 1u));
+                ++rs.counts.draw_calls;
+            }
+            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+        }
+
+        /*!
+         * Draw the bar sets (see VisualModelBase::add_bars), one instanced draw of six vertices
+         * per bar for each set. The program, vertex array and buffer are created on the first
+         * call. Only the bars that have changed are uploaded, unless the buffer has to grow.
+         */
+        void render_bars()
+        {
+            GladGLContext* _glfn = this->get_glfn (this->parentVis);
+            mplot::visgl::render_state& rs = this->get_render_state (this->parentVis);
+            if (this->bar_prog == 0) {
+                std::vector<mplot::gl::ShaderInfo> shader_progs = {
+                    {GL_VERTEX_SHADER, "VisualBars.vert.glsl", mplot::getDefaultBarVtxShader(glver), 0 },
+                    {GL_FRAGMENT_SHADER, "VisualBars.frag.glsl", mplot::getDefaultBarFragShader(glver), 0 }
+                };
+                this->bar_prog = mplot::gl::LoadShadersMX (shader_progs, _glfn);
+                const GLuint block = _glfn->GetUniformBlockIndex (this->bar_prog, "SceneState");
+                if (block != GL_INVALID_INDEX) { _glfn->UniformBlockBinding (this->bar_prog, block, mplot::visgl::scene_state_binding); }
+                _glfn->GenVertexArrays (1, &this->bar_vao);
+                _glfn->GenBuffers (1, &this->bar_vbo);
+                mplot::gl::Util::bind_vao (rs, this->bar_vao, _glfn);
+                // bar_xtop advances by one bar per instance
+                _glfn->VertexAttribDivisor (0, 1);
+                _glfn->EnableVertexAttribArray (0);
+            }
+            mplot::gl::Util::bind_vao (rs, this->bar_vao, _glfn);
+            _glfn->BindBuffer (GL_ARRAY_BUFFER, this->bar_vbo);
+            const std::size_t n = this->bar_data.size() / 2u;
+            if (n > this->bar_capacity || this->bar_capacity == 0) {
+                // Grow geometrically, so that adding bars a few at a time costs O(1) per bar
+                this->bar_capacity = std::max ({ n, 2u * this->bar_capacity, std::size_t{1} });
+                _glfn->BufferData (GL_ARRAY_BUFFER, this->bar_capacity * 2u * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+                this->bar_dirty = { 0, n };
+            }
+            const std::size_t d0 = std::min (this->bar_dirty[0], n);
+            const std::size_t d1 = std::min (this->bar_dirty[1], n);
+            if (d1 > d0) {
+                _glfn->BufferSubData (GL_ARRAY_BUFFER, d0 * 2u * sizeof(float), (d1 - d0) * 2u * sizeof(float), this->bar_data.data() + 2u * d0);
+                this->count_upload (mplot::upload_target::bars, (d1 - d0) * 2u * sizeof(float));
+            }
+            this->bar_dirty = { 0, 0 };
+
+            mplot::gl::Util::use_program (rs, this->bar_prog, _glfn);
+            auto loc = [this, _glfn](const char* name) { return _glfn->GetUniformLocation (this->bar_prog, name); };
+            _glfn->UniformMatrix4fv (loc ("m_matrix"), 1, GL_FALSE, this->model_matrix().mat.data());
+            _glfn->UniformMatrix4fv (loc ("v_matrix"), 1, GL_FALSE, this->scenematrix.mat.data());
+            _glfn->Uniform1f (loc ("alpha"), this->alpha);
+            const GLint loc_width = loc ("bar_width");
+            const GLint loc_base = loc ("bar_base");
+            const GLint loc_z = loc ("bar_z");
+            const GLint loc_colour = loc ("bar_colour");
+            const GLint loc_line_colour = loc ("bar_line_colour");
+            const GLint loc_line_width = loc ("bar_line_width");
+            constexpr GLsizei stride = 2 * sizeof(float);
+            for (const auto& b : this->bar_sets) {
+                if (b.count == 0u) { continue; }
+                _glfn->Uniform1f (loc_width, b.width);
+                _glfn->Uniform1f (loc_base, b.base);
+                _glfn->Uniform1f (loc_z, b.z);
+                _glfn->Uniform3f (loc_colour, b.colour[0], b.colour[1], b.colour[2]);
+                _glfn->Uniform3f (loc_line_colour, b.line_colour[0], b.line_colour[1], b.line_colour[2]);
+                _glfn->Uniform1f (loc_line_width, b.line_width);
+                _glfn->VertexAttribPointer (0, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(b.first * stride));
+                _glfn->DrawArraysInstanced (GL_TRIANGLES, 0, 6, static_cast<GLsizei>(b.count));
+                ++rs.counts.draw_calls;
+            }
+            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+        }
+
+        /*!
+         * Draw the volume (see set_volume) with one draw of the 36 vertices of its box, the
+         * fragments of whose front faces ray march the volume texture. The volume and the
+         * texture of its brick maxima are uploaded first, if the volume has changed.
+         */
+        void render_volume()
+        {
+            GladGLContext* _glfn = this->get_glfn (this->parentVis);
+            mplot::visgl::render_state& rs = this->get_render_state (this->parentVis);
+            if (this->volume_prog == 0) {
+                std::vector<mplot::gl::ShaderInfo> shader_progs = {
+                    {GL_VERTEX_SHADER, "VisualVolume.vert.glsl", mplot::getDefaultVolumeVtxShader(glver), 0 },
+                    {GL_FRAGMENT_SHADER, "VisualVolume.frag.glsl", mplot::getDefaultVolumeFragShader(glver), 0 }
+                };
+                this->volume_prog = mplot::gl::LoadShadersMX (shader_progs, _glfn);
+                const GLuint block = _glfn->GetUniformBlockIndex (this->volume_prog, "SceneState");
+                if (block != GL_INVALID_INDEX) { _glfn->UniformBlockBinding (this->volume_prog, block, mplot::visgl::scene_state_binding); }
+                // The box's corners come from gl_VertexID, but a vertex array must be bound to draw
+                _glfn->GenVertexArrays (1, &this->volume_vao);
+                _glfn->GenTextures (1, &this->volume_texture);
+                _glfn->GenTextures (1, &this->volume_brick_texture);
+                this->volume_changed = true;
+                this->volume_alloc = { 0u, 0u, 0u };
+            }
+            const std::array<unsigned int, 3>& d = this->volume_dims;
+            const std::array<unsigned int, 3> bd = mplot::volume::brick_dims (d);
+            if (this->volume_changed) { this->upload_volume(); }
+
+            mplot::gl::Util::use_program (rs, this->volume_prog, _glfn);
+            auto loc = [this, _glfn](const char* name) { return _glfn->GetUniformLocation (this->volume_prog, name); };
+            _glfn->UniformMatrix4fv (loc ("m_matrix"), 1, GL_FALSE, this->model_matrix().mat.data());
+            _glfn->UniformMatrix4fv (loc ("v_matrix"), 1, GL_FALSE, this->scenematrix.mat.data());
+            const sm::vec<float>& b0 = this->volume_box[0];
+            const sm::vec<float>& b1 = this->volume_box[1];
+            _glfn->Uniform3f (loc ("box_min"), b0[0], b0[1], b0[2]);
+            _glfn->Uniform3f (loc ("box_max"), b1[0], b1[1], b1[2]);
+            _glfn->Uniform3f (loc ("volume_dims"), static_cast<float>(d[0]), static_cast<float>(d[1]), static_cast<float>(d[2]));
+            _glfn->Uniform3f (loc ("brick_dims"), static_cast<float>(bd[0]), static_cast<float>(bd[1]), static_cast<float>(bd[2]));
+            _glfn->Uniform1f (loc ("brick_size"), static_cast<float>(mplot::volume::brick_size));
+            _glfn->Uniform1f (loc ("sample_step"), this->volume_step);
+            _glfn->Uniform1f (loc ("density"), this->volume_density);
+            _glfn->Uniform1f (loc ("threshold"), this->volume_threshold);
+            _glfn->Uniform1f (loc ("alpha"), this->alpha);
+
+            mplot::visgl::shader_uniforms lut_uniforms;
+            lut_uniforms.colour_lut = loc ("colour_lut");
+            this->bind_colour_lut (lut_uniforms);
+            _glfn->ActiveTexture (GL_TEXTURE0 + visgl::volume_first_unit);
+            _glfn->BindTexture (GL_TEXTURE_3D, this->volume_texture);
+            _glfn->ActiveTexture (GL_TEXTURE0 + visgl::volume_first_unit + 1u);
+            _glfn->BindTexture (GL_TEXTURE_3D, this->volume_brick_texture);
+            _glfn->ActiveTexture (GL_TEXTURE0);
+            rs.counts.texture_binds += 2;
+            _glfn->Uniform1i (loc ("volume"), visgl::volume_first_unit);
+            _glfn->Uniform1i (loc ("volume_bricks"), visgl::volume_first_unit + 1u);
+
+            // Only the front faces of the box are drawn, so that each ray is marched once
+            mplot::gl::Util::bind_vao (rs, this->volume_vao, _glfn);
+            _glfn->Enable (GL_CULL_FACE);
+            _glfn->CullFace (this->volume_mirrored() ? GL_FRONT : GL_BACK);
+            _glfn->DrawArrays (GL_TRIANGLES, 0, 36);
+            ++rs.counts.draw_calls;
+            _glfn->CullFace (GL_BACK);
+            _glfn->Disable (GL_CULL_FACE);
+            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+        }
+
+        /*!
+         * Upload the volume into volume_texture (in volume_format, a few slices at a time, so
+         * that a packed copy of the whole volume is never made) and its brick maxima into
+         * volume_brick_texture.
+         */
+        void upload_volume()
+        {
+            GladGLContext* _glfn = this->get_glfn (this->parentVis);
+            const std::array<unsigned int, 3>& d = this->volume_dims;
+            const std::array<unsigned int, 3> bd = mplot::volume::brick_dims (d);
+            const std::array<GLenum, 3> gt = this->volume_texture_gl_type();
+            _glfn->PixelStorei (GL_UNPACK_ALIGNMENT, 1);
+
+            _glfn->BindTexture (GL_TEXTURE_3D, this->volume_texture);
+            if (d != this->volume_alloc) {
+                _glfn->TexImage3D (GL_TEXTURE_3D, 0, static_cast<GLint>(gt[0]), static_cast<GLsizei>(d[0]),
+                                   static_cast<GLsizei>(d[1]), static_cast<GLsizei>(d[2]), 0, GL_RED, gt[1], nullptr);
+                _glfn->TexParameteri (GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, static_cast<GLint>(gt[2]));
+                _glfn->TexParameteri (GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, static_cast<GLint>(gt[2]));
+                _glfn->TexParameteri (GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                _glfn->TexParameteri (GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                _glfn->TexParameteri (GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+                this->volume_alloc = d;
+            }
+            const std::size_t slice = std::size_t{d[0]} * d[1];
+            if (this->volume_format == mplot::datum_format::float32) {
+                _glfn->TexSubImage3D (GL_TEXTURE_3D, 0, 0, 0, 0, static_cast<GLsizei>(d[0]), static_cast<GLsizei>(d[1]),
+                                      static_cast<GLsizei>(d[2]), GL_RED, GL_FLOAT, this->volume.data());
+            } else {
+                // Pack and upload about 16 MB of datums at a time
+                const unsigned int slices = std::max (1u, static_cast<unsigned int>((std::size_t{1} << 23) / std::max (slice, std::size_t{1})));
+                for (unsigned int z = 0; z < d[2]; z += slices) {
+                    const unsigned int nz = std::min (slices, d[2] - z);
+                    this->volume_packed.resize (2u * slice * nz);
+                    mplot::datum_pack::pack (mplot::datum_format::float16, this->volume.data() + z * slice, slice * nz, this->volume_packed.data());
+                    _glfn->TexSubImage3D (GL_TEXTURE_3D, 0, 0, 0, static_cast<GLint>(z), static_cast<GLsizei>(d[0]),
+                                          static_cast<GLsizei>(d[1]), static_cast<GLsizei>(nz), GL_RED, GL_HALF_FLOAT, this->volume_packed.data());
+                }
+                this->volume_packed.clear();
+                this->volume_packed.shrink_to_fit();
+            }
+            this->count_upload (mplot::upload_target::volume, slice * d[2] * (gt[1] == GL_FLOAT ? 4u : 2u));
+
+            const std::vector<std::uint8_t> bmax = mplot::volume::brick_max (this->volume, d);
+            _glfn->BindTexture (GL_TEXTURE_3D, this->volume_brick_texture);
+            _glfn->TexImage3D (GL_TEXTURE_3D, 0, GL_R8, static_cast<GLsizei>(bd[0]), static_cast<GLsizei>(bd[1]),
+                               static_cast<GLsizei>(bd[2]), 0, GL_RED, GL_UNSIGNED_BYTE, bmax.data());
+            _glfn->TexParameteri (GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            _glfn->TexParameteri (GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            _glfn->TexParameteri (GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            _glfn->TexParameteri (GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            _glfn->TexParameteri (GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+            this->count_upload (mplot::upload_target::volume, bmax.size());
+            _glfn->BindTexture (GL_TEXTURE_3D, 0);
+            this->volume_changed = false;
+            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+        }
+
+        /*!
+         * Draw the raster (see set_raster_capacity) with one instanced draw of six vertices per
+         * event, or one draw of a point per event. The program, vertex array and buffer are
+         * created on the first call. Only the events appended since the last render are uploaded,
+         * in at most two writes (either side of the end of the ring).
+         */
+        void render_raster()
+        {
+            using event_t = typename mplot::VisualModelBase<glver>::raster_event;
+            GladGLContext* _glfn = this->get_glfn (this->parentVis);
+            mplot::visgl::render_state& rs = this->get_render_state (this->parentVis);
+            if (this->raster_prog == 0) {
+                std::vector<mplot::gl::ShaderInfo> shader_progs = {
+                    {GL_VERTEX_SHADER, "VisualRaster.vert.glsl", mplot::getDefaultRasterVtxShader(glver), 0 },
+                    {GL_FRAGMENT_SHADER, "VisualRaster.frag.glsl", mplot::getDefaultRasterFragShader(glver), 0 }
+                };
+                this->raster_prog = mplot::gl::LoadShadersMX (shader_progs, _glfn);
+                const GLuint block = _glfn->GetUniformBlockIndex (this->raster_prog, "SceneState");
+                if (block != GL_INVALID_INDEX) { _glfn->UniformBlockBinding (this->raster_prog, block, mplot::visgl::scene_state_binding); }
+                _glfn->GenVertexArrays (1, &this->raster_vao);
+                _glfn->GenBuffers (1, &this->raster_vbo);
+                mplot::gl::Util::bind_vao (rs, this->raster_vao, _glfn);
+                _glfn->BindBuffer (GL_ARRAY_BUFFER, this->raster_vbo);
+                // 8 bytes per event: its time and then its neuron
+                constexpr GLsizei stride = sizeof(event_t);
+                _glfn->VertexAttribPointer (0, 1, GL_FLOAT, GL_FALSE, stride, nullptr);
+                _glfn->EnableVertexAttribArray (0);
+                _glfn->VertexAttribIPointer (1, 1, GL_UNSIGNED_INT, stride, reinterpret_cast<void*>(sizeof(float)));
+                _glfn->EnableVertexAttribArray (1);
+                this->raster_realloc = true;
+            }
+            mplot::gl::Util::bind_vao (rs, this->raster_vao, _glfn);
+            _glfn->BindBuffer (GL_ARRAY_BUFFER, this->raster_vbo);
+            const std::size_t cap = this->raster_ring.size();
+            if (this->raster_realloc) {
+                _glfn->BufferData (GL_ARRAY_BUFFER, cap * sizeof(event_t), nullptr, GL_DYNAMIC_DRAW);
+                this->raster_uploaded = 0;
+                this->raster_realloc = false;
+            }
+            // Upload the events appended since the last upload that are still in the ring
+            std::uint64_t from = std::max (this->raster_uploaded, this->raster_total > cap ? this->raster_total - cap : std::uint64_t{0});
+            while (from < this->raster_total) {
+                const std::size_t slot = static_cast<std::size_t>(from % cap);
+                const std::size_t n = static_cast<std::size_t>(std::min (this->raster_total - from, static_cast<std::uint64_t>(cap - slot)));
+                _glfn->BufferSubData (GL_ARRAY_BUFFER, slot * sizeof(event_t), n * sizeof(event_t), this->raster_ring.data() + slot);
+                this->count_upload (mplot::upload_target::raster, n * sizeof(event_t));
+                from += n;
+            }
+            this->raster_uploaded = this->raster_total;
+            const std::size_t count = this->raster_count();
+            if (count == 0) { return; }
+
+            mplot::gl::Util::use_program (rs, this->raster_prog, _glfn);
+            auto loc = [this, _glfn](const char* name) { return _glfn->GetUniformLocation (this->raster_prog, name); };
+            _glfn->UniformMatrix4fv (loc ("m_matrix"), 1, GL_FALSE, this->model_matrix().mat.data());
+            _glfn->UniformMatrix4fv (loc ("v_matrix"), 1, GL_FALSE, this->scenematrix.mat.data());
+            _glfn->Uniform1f (loc ("alpha"), this->alpha);
+            _glfn->Uniform2f (loc ("raster_window"), this->raster_window[0], this->raster_window[1]);
+            _glfn->Uniform2f (loc ("raster_extent"), this->raster_extent[0], this->raster_extent[1]);
+            _glfn->Uniform2f (loc ("raster_tick"), this->raster_tick[0], this->raster_tick[1]);
+            _glfn->Uniform1f (loc ("raster_z"), this->raster_z);
+            _glfn->Uniform1i (loc ("raster_points"), this->raster_points ? 1 : 0);
+            _glfn->Uniform1f (loc ("raster_point_size"), this->raster_point_size);
+            _glfn->Uniform3f (loc ("raster_colour"), this->raster_colour[0], this->raster_colour[1], this->raster_colour[2]);
+            const GLsizei npops = static_cast<GLsizei>(this->raster_populations.size());
+            _glfn->Uniform1i (loc ("n_pops"), npops);
+            if (npops > 0) {
+                std::array<GLuint, VisualModelBase<glver>::raster_max_populations> firsts = {};
+                std::array<float, 3u * VisualModelBase<glver>::raster_max_populations> colours = {};
+                for (GLsizei p = 0; p < npops; ++p) {
+                    firsts[p] = this->raster_populations[p].first;
+                    for (unsigned int j = 0; j < 3u; ++j) { colours[3u * p + j] = this->raster_populations[p].colour[j]; }
+                }
+                _glfn->Uniform1uiv (loc ("pop_first"), npops, firsts.data());
+                _glfn->Uniform3fv (loc ("pop_colour"), npops, colours.data());
+            }
+            // Points advance by one event per vertex; ticks by one event per instance
+            const GLuint divisor = this->raster_points ? 0u : 1u;
+            _glfn->VertexAttribDivisor (0, divisor);
+            _glfn->VertexAttribDivisor (1, divisor);
+            if (this->raster_points) {
+#ifdef GL_PROGRAM_POINT_SIZE
+                // Desktop GL takes gl_PointSize from the vertex shader only when this is enabled
+                _glfn->Enable (GL_PROGRAM_POINT_SIZE);
+#endif
+                _glfn->DrawArrays (GL_POINTS, 0, static_cast<GLsizei>(count));
+#ifdef GL_PROGRAM_POINT_SIZE
+                _glfn->Disable (GL_PROGRAM_POINT_SIZE);
+#endif
+            } else {
+                _glfn->DrawArraysInstanced (GL_TRIANGLES, 0, 6, static_cast<GLsizei>(count));
+            }
+            ++rs.counts.draw_calls;
+            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+        }
+
+        /*!
+         * Draw the point cloud cache (see set_cloud_slots): upload the slots written since the
+         * last render, each with one write into its part of the buffer, and draw the slots of
+         * cloud_draws as GL_POINTS, one draw call per slot.
+         */
+        void render_cloud()
+        {
+            using point_t = typename mplot::VisualModelBase<glver>::cloud_point;
+            GladGLContext* _glfn = this->get_glfn (this->parentVis);
+            mplot::visgl::render_state& rs = this->get_render_state (this->parentVis);
+            if (this->cloud_prog == 0) {
+                std::vector<mplot::gl::ShaderInfo> shader_progs = {
+                    {GL_VERTEX_SHADER, "VisualCloud.vert.glsl", mplot::getDefaultCloudVtxShader(glver), 0 },
+                    {GL_FRAGMENT_SHADER, "VisualCloud.frag.glsl", mplot::getDefaultCloudFragShader(glver), 0 }
+                };
+                this->cloud_prog = mplot::gl::LoadShadersMX (shader_progs, _glfn);
+                const GLuint block = _glfn->GetUniformBlockIndex (this->cloud_prog, "SceneState");
+                if (block != GL_INVALID_INDEX) { _glfn->UniformBlockBinding (this->cloud_prog, block, mplot::visgl::scene_state_binding); }
+                _glfn->GenVertexArrays (1, &this->cloud_vao);
+                _glfn->GenBuffers (1, &this->cloud_vbo);
+                mplot::gl::Util::bind_vao (rs, this->cloud_vao, _glfn);
+                _glfn->BindBuffer (GL_ARRAY_BUFFER, this->cloud_vbo);
+                // 16 bytes per point: its position and then its RGBA8 colour
+                constexpr GLsizei stride = sizeof(point_t);
+                _glfn->VertexAttribPointer (0, 3, GL_FLOAT, GL_FALSE, stride, nullptr);
+                _glfn->EnableVertexAttribArray (0);
+                _glfn->VertexAttribPointer (1, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, reinterpret_cast<void*>(3 * sizeof(float)));
+                _glfn->EnableVertexAttribArray (1);
+                this->cloud_realloc = true;
+            }
+            mplot::gl::Util::bind_vao (rs, this->cloud_vao, _glfn);
+            _glfn->BindBuffer (GL_ARRAY_BUFFER, this->cloud_vbo);
+            const std::size_t slot_bytes = this->cloud_slot_points * sizeof(point_t);
+            if (this->cloud_realloc) {
+                _glfn->BufferData (GL_ARRAY_BUFFER, this->cloud_slots * slot_bytes, nullptr, GL_DYNAMIC_DRAW);
+                this->cloud_realloc = false;
+            }
+            for (const auto& [slot, pts] : this->cloud_writes) {
+                if (pts.empty()) { continue; }
+                _glfn->BufferSubData (GL_ARRAY_BUFFER, slot * slot_bytes, pts.size() * sizeof(point_t), pts.data());
+                this->count_upload (mplot::upload_target::cloud, pts.size() * sizeof(point_t));
+            }
+            this->cloud_writes.clear();
+            if (this->cloud_draws.empty()) { return; }
+
+            mplot::gl::Util::use_program (rs, this->cloud_prog, _glfn);
+            auto loc = [this, _glfn](const char* name) { return _glfn->GetUniformLocation (this->cloud_prog, name); };
+            _glfn->UniformMatrix4fv (loc ("m_matrix"), 1, GL_FALSE, this->model_matrix().mat.data());
+            _glfn->UniformMatrix4fv (loc ("v_matrix"), 1, GL_FALSE, this->scenematrix.mat.data());
+            _glfn->Uniform1f (loc ("alpha"), this->alpha);
+            _glfn->Uniform1f (loc ("cloud_point_size"), this->cloud_point_size);
+#ifdef GL_PROGRAM_POINT_SIZE
+            // Desktop GL takes gl_PointSize from the vertex shader only when this is enabled
+            _glfn->Enable (GL_PROGRAM_POINT_SIZE);
+#endif
+            for (const auto& d : this->cloud_draws) {
+                if (d.count == 0) { continue; }
+                _glfn->DrawArrays (GL_POINTS, static_cast<GLint>(d.slot * this->cloud_slot_points), static_cast<GLsizei>(d.count));
+                ++rs.counts.draw_calls;
+            }
+#ifdef GL_PROGRAM_POINT_SIZE
+            _glfn->Disable (GL_PROGRAM_POINT_SIZE);
+#endif
+            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+        }
+
+        /*!
+         * Draw the sprites (see add_sprite) as GL_POINTS, each of which the sprite shaders ray
+         * trace as a lit sphere. The point size is limited by the GL implementation (see
+         * GL_ALIASED_POINT_SIZE_RANGE), so very large sprites are clipped to squares.
+         */
+        void render_sprites()
+        {
+            using sprite_t = typename mplot::VisualModelBase<glver>::sprite;
+            GladGLContext* _glfn = this->get_glfn (this->parentVis);
+            mplot::visgl::render_state& rs = this->get_render_state (this->parentVis);
+            if (this->sprite_prog == 0) {
+                std::vector<mplot::gl::ShaderInfo> shader_progs = {
+                    {GL_VERTEX_SHADER, "VisualSprite.vert.glsl", mplot::getDefaultSpriteVtxShader(glver), 0 },
+                    {GL_FRAGMENT_SHADER, "VisualSprite.frag.glsl", mplot::getDefaultSpriteFragShader(glver), 0 }
+                };
+                this->sprite_prog = mplot::gl::LoadShadersMX (shader_progs, _glfn);
+                const GLuint block = _glfn->GetUniformBlockIndex (this->sprite_prog, "SceneState");
+                if (block != GL_INVALID_INDEX) { _glfn->UniformBlockBinding (this->sprite_prog, block, mplot::visgl::scene_state_binding); }
+                _glfn->GenVertexArrays (1, &this->sprite_vao);
+                _glfn->GenBuffers (1, &this->sprite_vbo);
+                mplot::gl::Util::bind_vao (rs, this->sprite_vao, _glfn);
+                _glfn->BindBuffer (GL_ARRAY_BUFFER, this->sprite_vbo);
+                // 16 bytes per sprite: its position and then its RGBA8 colour and size
+                constexpr GLsizei stride = sizeof(sprite_t);
+                _glfn->VertexAttribPointer (0, 3, GL_FLOAT, GL_FALSE, stride, nullptr);
+                _glfn->EnableVertexAttribArray (0);
+                _glfn->VertexAttribPointer (1, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, reinterpret_cast<void*>(3 * sizeof(float)));
+                _glfn->EnableVertexAttribArray (1);
+                this->sprites_changed = true;
+                this->sprite_dirty_first = 0;
+            }
+            mplot::gl::Util::bind_vao (rs, this->sprite_vao, _glfn);
+            _glfn->BindBuffer (GL_ARRAY_BUFFER, this->sprite_vbo);
+            if (this->sprites_changed) {
+                // Upload the sprites from the first changed one, growing the buffer geometrically
+                // so that appending sprites one at a time costs O(1) per sprite
+                const std::size_t n = this->sprites.size();
+                if (n > this->sprite_capacity || this->sprite_capacity == 0) {
+                    this->sprite_capacity = std::max ({ n, 2u * this->sprite_capacity, std::size_t{1} });
+                    _glfn->BufferData (GL_ARRAY_BUFFER, this->sprite_capacity * sizeof(sprite_t), nullptr, GL_DYNAMIC_DRAW);
+                    this->sprite_dirty_first = 0;
+                }
+                const std::size_t first = std::min (this->sprite_dirty_first, n);
+                if (n > first) {
+                    _glfn->BufferSubData (GL_ARRAY_BUFFER, first * sizeof(sprite_t), (n - first) * sizeof(sprite_t), this->sprites.data() + first);
+                    this->count_upload (mplot::upload_target::sprites, (n - first) * sizeof(sprite_t));
+                }
+                this->sprite_dirty_first = n;
+                this->sprites_changed = false;
+            }
+
+            mplot::gl::Util::use_program (rs, this->sprite_prog, _glfn);
+            auto loc = [this, _glfn](const char* name) { return _glfn->GetUniformLocation (this->sprite_prog, name); };
+            _glfn->UniformMatrix4fv (loc ("m_matrix"), 1, GL_FALSE, this->model_matrix().mat.data());
+            _glfn->UniformMatrix4fv (loc ("v_matrix"), 1, GL_FALSE, this->scenematrix.mat.data());
+            _glfn->Uniform1f (loc ("alpha"), this->alpha);
+            _glfn->Uniform1f (loc ("sprite_radius"), this->sprite_radius);
+            _glfn->Uniform2f (loc ("viewport"), static_cast<float>(this->viewport_size[0]), static_cast<float>(this->viewport_size[1]));
+#ifdef GL_PROGRAM_POINT_SIZE
+            // Desktop GL takes gl_PointSize from the vertex shader only when this is enabled
+            _glfn->Enable (GL_PROGRAM_POINT_SIZE);
+#endif
+            _glfn->DrawArrays (GL_POINTS, 0, static_cast<GLsizei>(this->sprites.size()));
+            ++rs.counts.draw_calls;
+#ifdef GL_PROGRAM_POINT_SIZE
+            _glfn->Disable (GL_PROGRAM_POINT_SIZE);
+#endif
+            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+        }
+
+        /*!
+         * Regenerate the z positions, normals and colours of the first gpu_mesh_sources.size()
+         * vertices with the GPU mesh compute shader, which writes them into the position, normal
+         * and colour buffers (see VisualModelBase::gpu_mesh). The sources and (unless the data
+         * are in a client buffer) the data are uploaded first, if they have changed.
+         */
+        void run_gpu_mesh()
+        {
+            if (this->streaming || this->compact_vertices || this->datum_colour_mode() != 0) {
+                throw std::runtime_error ("VisualModel: gpu_mesh needs float vertex and colour buffers (not streaming, compact or coloured by datum)");
+            }
+            GladGLContext* _glfn = this->get_glfn(this->parentVis);
+            if (this->gpu_mesh_prog == 0) {
+                std::vector<mplot::gl::ShaderInfo> shader_progs = {
+                    {GL_COMPUTE_SHADER, "VisualGpuMesh.comp.glsl", mplot::getDefaultGpuMeshComputeShader(glver), 0 }
+                };
+                this->gpu_mesh_prog = mplot::gl::LoadShadersMX (shader_progs, _glfn);
+                _glfn->GenBuffers (3, this->gpu_mesh_buffers);
+                this->gpu_mesh_sources_changed = true;
+                this->gpu_mesh_data_changed = true;
+            }
+            if (this->gpu_mesh_sources_changed) {
+                _glfn->BindBuffer (GL_SHADER_STORAGE_BUFFER, this->gpu_mesh_buffers[1]);
+                _glfn->BufferData (GL_SHADER_STORAGE_BUFFER, this->gpu_mesh_sources.size() * sizeof (typename mplot::VisualModelBase<glver>::gpu_mesh_source),
+                                   this->gpu_mesh_sources.data(), GL_STATIC_DRAW);
+                this->count_upload (mplot::upload_target::gpu_mesh, this->gpu_mesh_sources.size() * sizeof (typename mplot::VisualModelBase<glver>::gpu_mesh_source));
+                this->gpu_mesh_sources_changed = false;
+            }
+            if (this->gpu_mesh_data_changed && this->gpu_mesh_external_data == 0) {
+                _glfn->BindBuffer (GL_SHADER_STORAGE_BUFFER, this->gpu_mesh_buffers[0]);
+                _glfn->BufferData (GL_SHADER_STORAGE_BUFFER, this->gpu_mesh_data.size() * sizeof(float), this->gpu_mesh_data.data(), GL_DYNAMIC_DRAW);
+                this->count_upload (mplot::upload_target::gpu_mesh, this->gpu_mesh_data.size() * sizeof(float));
+                this->gpu_mesh_data_changed = false;
+            }
+            this->gpu_mesh_pending = false;
+            const GLuint n = static_cast<GLuint>(std::min (this->gpu_mesh_sources.size(), this->vertexPositions.size() / 3u));
+            if (n == 0 || this->vbos == nullptr) { return; }
+
+            mplot::visgl::render_state& rs = this->get_render_state (this->parentVis);
+            constexpr GLuint b0 = visgl::gpu_mesh_first_binding;
+            const GLuint data_buffer = this->gpu_mesh_external_data != 0 ? this->gpu_mesh_external_data : this->gpu_mesh_buffers[0];
+            if (this->gpu_mesh_autoscale[0] || this->gpu_mesh_autoscale[1]) {
+                // Find the range of the data on the GPU, for the mesh shader's autoscaling
+                if (this->gpu_mesh_range_prog == 0) {
+                    std::vector<mplot::gl::ShaderInfo> shader_progs = {
+                        {GL_COMPUTE_SHADER, "VisualGpuMeshRange.comp.glsl", mplot::getDefaultGpuMeshRangeComputeShader(glver), 0 }
+                    };
+                    this->gpu_mesh_range_prog = mplot::gl::LoadShadersMX (shader_progs, _glfn);
+                    _glfn->BindBuffer (GL_SHADER_STORAGE_BUFFER, this->gpu_mesh_buffers[2]);
+                    _glfn->BufferData (GL_SHADER_STORAGE_BUFFER, 4 * sizeof(float), nullptr, GL_DYNAMIC_COPY);
+                }
+                GLint data_bytes = 0;
+                _glfn->BindBuffer (GL_SHADER_STORAGE_BUFFER, data_buffer);
+                _glfn->GetBufferParameteriv (GL_SHADER_STORAGE_BUFFER, GL_BUFFER_SIZE, &data_bytes);
+                mplot::gl::Util::use_program (rs, this->gpu_mesh_range_prog, _glfn);
+                _glfn->Uniform1ui (_glfn->GetUniformLocation (this->gpu_mesh_range_prog, "n_data"), static_cast<GLuint>(data_bytes) / sizeof(float));
+                _glfn->BindBufferBase (GL_SHADER_STORAGE_BUFFER, b0, data_buffer);
+                _glfn->BindBufferBase (GL_SHADER_STORAGE_BUFFER, b0 + 5u, this->gpu_mesh_buffers[2]);
+                _glfn->DispatchCompute (1, 1, 1);
+                _glfn->MemoryBarrier (GL_SHADER_STORAGE_BARRIER_BIT);
+            }
+            mplot::gl::Util::use_program (rs, this->gpu_mesh_prog, _glfn);
+            _glfn->Uniform1ui (_glfn->GetUniformLocation (this->gpu_mesh_prog, "n_vertices"), n);
+            _glfn->Uniform2f (_glfn->GetUniformLocation (this->gpu_mesh_prog, "z_scale"), this->gpu_mesh_zscale[0], this->gpu_mesh_zscale[1]);
+            _glfn->Uniform2f (_glfn->GetUniformLocation (this->gpu_mesh_prog, "colour_scale"), this->gpu_mesh_cscale[0], this->gpu_mesh_cscale[1]);
+            const GLuint autoscale = (this->gpu_mesh_autoscale[0] ? 1u : 0u) | (this->gpu_mesh_autoscale[1] ? 2u : 0u);
+            _glfn->Uniform1ui (_glfn->GetUniformLocation (this->gpu_mesh_prog, "autoscale"), autoscale);
+            _glfn->Uniform2f (_glfn->GetUniformLocation (this->gpu_mesh_prog, "z_range"), this->gpu_mesh_zrange[0], this->gpu_mesh_zrange[1]);
+            _glfn->Uniform2f (_glfn->GetUniformLocation (this->gpu_mesh_prog, "colour_range"), this->gpu_mesh_crange[0], this->gpu_mesh_crange[1]);
+            mplot::visgl::shader_uniforms lut_uniforms;
+            lut_uniforms.colour_lut = _glfn->GetUniformLocation (this->gpu_mesh_prog, "colour_lut");
+            this->bind_colour_lut (lut_uniforms);
+
+            _glfn->BindBufferBase (GL_SHADER_STORAGE_BUFFER, b0, data_buffer);
+            _glfn->BindBufferBase (GL_SHADER_STORAGE_BUFFER, b0 + 1u, this->gpu_mesh_buffers[1]);
+            _glfn->BindBufferBase (GL_SHADER_STORAGE_BUFFER, b0 + 2u, this->vbos[this->posnVBO]);
+            _glfn->BindBufferBase (GL_SHADER_STORAGE_BUFFER, b0 + 3u, this->vbos[this->normVBO]);
+            _glfn->BindBufferBase (GL_SHADER_STORAGE_BUFFER, b0 + 4u, this->vbos[this->colVBO]);
+            _glfn->BindBufferBase (GL_SHADER_STORAGE_BUFFER, b0 + 5u, this->gpu_mesh_buffers[2]);
+            _glfn->DispatchCompute ((n + 63u) / 64u, 1, 1);
+            // The buffers are next read as vertex attributes, by this model's draw
+            _glfn->MemoryBarrier (GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+            _glfn->BindBuffer (GL_SHADER_STORAGE_BUFFER, 0);
+            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+        }
+
+        /*!
+         * Fill jump_flood_texture with the Voronoi cells of the sites by jump flooding (see
+         * VisualModelBase::set_jump_flood_grid). The sites and data are uploaded first, if they
+         * have changed. The site indices of the texels are ping-ponged between two buffers, one
+         * step of flooding reading one and writing the other.
+         */
+        void run_jump_flood()
+        {
+            this->jump_flood_pending = false;
+            const std::array<unsigned int, 2>& d = this->jump_flood_dims;
+            if (d[0] == 0u || d[1] == 0u) { return; }
+            GladGLContext* _glfn = this->get_glfn(this->parentVis);
+            if (this->jump_flood_prog == 0) {
+                std::vector<mplot::gl::ShaderInfo> shader_progs = {
+                    {GL_COMPUTE_SHADER, "VisualJumpFlood.comp.glsl", mplot::getDefaultJumpFloodComputeShader(glver), 0 }
+                };
+                this->jump_flood_prog = mplot::gl::LoadShadersMX (shader_progs, _glfn);
+                _glfn->GenBuffers (4, this->jump_flood_buffers);
+                this->jump_flood_sites_changed = true;
+                this->jump_flood_data_changed = true;
+            }
+            if (d != this->jump_flood_alloc) {
+                const std::size_t n_texels = std::size_t{d[0]} * d[1];
+                for (unsigned int b = 2; b < 4; ++b) {
+                    _glfn->BindBuffer (GL_SHADER_STORAGE_BUFFER, this->jump_flood_buffers[b]);
+                    _glfn->BufferData (GL_SHADER_STORAGE_BUFFER, n_texels * sizeof(GLint), nullptr, GL_DYNAMIC_COPY);
+                }
+                // An image must have immutable storage, so a new size needs a new texture
+                if (this->jump_flood_texture != 0) { _glfn->DeleteTextures (1, &this->jump_flood_texture); }
+                _glfn->GenTextures (1, &this->jump_flood_texture);
+                _glfn->BindTexture (GL_TEXTURE_2D, this->jump_flood_texture);
+                _glfn->TexStorage2D (GL_TEXTURE_2D, 1, GL_R32F, static_cast<GLsizei>(d[0]), static_cast<GLsizei>(d[1]));
+                _glfn->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+                _glfn->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+                _glfn->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                _glfn->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                _glfn->BindTexture (GL_TEXTURE_2D, 0);
+                this->jump_flood_alloc = d;
+            }
+            // The site and data buffers are never empty, so that they can always be bound
+            if (this->jump_flood_sites_changed) {
+                const std::size_t bytes = this->jump_flood_sites.size() * sizeof (std::array<float, 2>);
+                _glfn->BindBuffer (GL_SHADER_STORAGE_BUFFER, this->jump_flood_buffers[0]);
+                _glfn->BufferData (GL_SHADER_STORAGE_BUFFER, std::max (bytes, sizeof (std::array<float, 2>)),
+                                   bytes > 0u ? this->jump_flood_sites.data() : nullptr, GL_DYNAMIC_DRAW);
+                this->count_upload (mplot::upload_target::jump_flood, bytes);
+                this->jump_flood_sites_changed = false;
+            }
+            if (this->jump_flood_data_changed) {
+                const std::size_t bytes = this->jump_flood_data.size() * sizeof(float);
+                _glfn->BindBuffer (GL_SHADER_STORAGE_BUFFER, this->jump_flood_buffers[1]);
+                _glfn->BufferData (GL_SHADER_STORAGE_BUFFER, std::max (bytes, sizeof(float)),
+                                   bytes > 0u ? this->jump_flood_data.data() : nullptr, GL_DYNAMIC_DRAW);
+                this->count_upload (mplot::upload_target::jump_flood, bytes);
+                this->jump_flood_data_changed = false;
+            }
+
+            mplot::visgl::render_state& rs = this->get_render_state (this->parentVis);
+            const GLuint prog = this->jump_flood_prog;
+            mplot::gl::Util::use_program (rs, prog, _glfn);
+            const GLuint n_sites = static_cast<GLuint>(this->jump_flood_sites.size());
+            _glfn->Uniform2i (_glfn->GetUniformLocation (prog, "dims"), static_cast<GLint>(d[0]), static_cast<GLint>(d[1]));
+            _glfn->Uniform2f (_glfn->GetUniformLocation (prog, "lo"), this->jump_flood_lo[0], this->jump_flood_lo[1]);
+            _glfn->Uniform2f (_glfn->GetUniformLocation (prog, "hi"), this->jump_flood_hi[0], this->jump_flood_hi[1]);
+            _glfn->Uniform1ui (_glfn->GetUniformLocation (prog, "n_sites"), n_sites);
+            _glfn->Uniform1ui (_glfn->GetUniformLocation (prog, "n_data"), static_cast<GLuint>(this->jump_flood_data.size()));
+            const GLint pass_loc = _glfn->GetUniformLocation (prog, "pass");
+            const GLint step_loc = _glfn->GetUniformLocation (prog, "step_size");
+
+            constexpr GLuint b0 = visgl::jump_flood_first_binding;
+            _glfn->BindBufferBase (GL_SHADER_STORAGE_BUFFER, b0, this->jump_flood_buffers[0]);
+            _glfn->BindBufferBase (GL_SHADER_STORAGE_BUFFER, b0 + 1u, this->jump_flood_buffers[1]);
+            // The site indices are read from jump_flood_buffers[2 + cur] and written to [3 - cur]
+            unsigned int cur = 0;
+            auto bind_indices = [this, _glfn, &cur]() {
+                _glfn->BindBufferBase (GL_SHADER_STORAGE_BUFFER, b0 + 2u, this->jump_flood_buffers[2u + cur]);
+                _glfn->BindBufferBase (GL_SHADER_STORAGE_BUFFER, b0 + 3u, this->jump_flood_buffers[3u - cur]);
+            };
+            const GLuint gx = (d[0] + 7u) / 8u;
+            const GLuint gy = (d[1] + 7u) / 8u;
+
+            // Clear, then seed, the indices in one buffer, which the first step then reads
+            bind_indices();
+            _glfn->Uniform1ui (pass_loc, 0u);
+            _glfn->DispatchCompute (gx, gy, 1);
+            _glfn->MemoryBarrier (GL_SHADER_STORAGE_BARRIER_BIT);
+            if (n_sites > 0u) {
+                // One invocation per site, in rows of 64 workgroups of 8 by 8
+                _glfn->Uniform1ui (pass_loc, 1u);
+                _glfn->DispatchCompute (64u, (n_sites + 4095u) / 4096u, 1);
+                _glfn->MemoryBarrier (GL_SHADER_STORAGE_BARRIER_BIT);
+            }
+            cur = 1;
+
+            // Flood with steps from half the larger side of the grid down to 1, and then 1 again
+            _glfn->Uniform1ui (pass_loc, 2u);
+            const unsigned int n_steps = this->jump_flood_steps();
+            unsigned int k = std::max (d[0], d[1]) / 2u;
+            for (unsigned int si = 0; si < n_steps; ++si) {
+                bind_indices();
+                _glfn->Uniform1i (step_loc, static_cast<GLint>(std::max (k, 1u)));
+                _glfn->DispatchCompute (gx, gy, 1);
+                _glfn->MemoryBarrier (GL_SHADER_STORAGE_BARRIER_BIT);
+                k /= 2u;
+                cur ^= 1u;
+            }
+
+            // Write the datum of each texel's site to the cells texture
+            bind_indices();
+            _glfn->BindImageTexture (visgl::jump_flood_image_unit, this->jump_flood_texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+            _glfn->Uniform1ui (pass_loc, 3u);
+            _glfn->DispatchCompute (gx, gy, 1);
+            // The texture is next sampled by this model's draw
+            _glfn->MemoryBarrier (GL_TEXTURE_FETCH_BARRIER_BIT);
+            _glfn->BindBuffer (GL_SHADER_STORAGE_BUFFER, 0);
+            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+        }
+
+        /*!
+         * Upload instance_data into instanceVBO and point the per-instance attributes at it
+         * (advancing once per instance). Reallocates only when instance_data has outgrown the
+         * buffer. If instances were marked with mark_dirty_instances, only those are written.
+         * Called with this->vao bound.
+         */
+        void upload_instances()
+        {
+            GladGLContext* _glfn = this->get_glfn(this->parentVis);
+            constexpr GLsizei stride = mplot::VisualModelBase<glver>::instance_stride * sizeof(float);
+            if (this->instanceVBO == 0) { _glfn->GenBuffers (1, &this->instanceVBO); }
+            _glfn->BindBuffer (GL_ARRAY_BUFFER, this->instanceVBO);
+            constexpr std::size_t is = mplot::VisualModelBase<glver>::instance_stride;
+            const std::size_t n = this->instance_data.size();
+            if (n > this->instance_capacity || this->instance_capacity == 0) {
+                // An instance buffer that is being appended to (see mark_dirty_instances) grows geometrically
+                const std::size_t grow = this->instance_dirty.empty() ? n : 2u * n;
+                this->instance_capacity = std::max (grow, std::size_t{is});
+                _glfn->BufferData (GL_ARRAY_BUFFER, this->instance_capacity * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+                this->instance_dirty.clear();
+            }
+            if (this->instance_dirty.empty()) {
+                if (n > 0) { _glfn->BufferSubData (GL_ARRAY_BUFFER, 0, n * sizeof(float), this->instance_data.data()); this->count_upload (mplot::upload_target::instances, n * sizeof(float)); }
+            } else {
+                for (const auto& r : this->instance_dirty) {
+                    const std::size_t b = std::min (is * r[0], n);
+                    const std::size_t e = std::min (is * r[1], n);
+                    if (b < e) { _glfn->BufferSubData (GL_ARRAY_BUFFER, b * sizeof(float), (e - b) * sizeof(float), this->instance_data.data() + b); this->count_upload (mplot::upload_target::instances, (e - b) * sizeof(float)); }
+                }
+                this->instance_dirty.clear();
+            }
+            this->uploaded_instances = n / is;
+
+            _glfn->VertexAttribPointer (visgl::instPosnLoc, 4, GL_FLOAT, GL_FALSE, stride, (void*)(0));
+            _glfn->VertexAttribDivisor (visgl::instPosnLoc, 1);
+            _glfn->EnableVertexAttribArray (visgl::instPosnLoc);
+            _glfn->VertexAttribPointer (visgl::instColLoc, 4, GL_FLOAT, GL_FALSE, stride, (void*)(4 * sizeof(float)));
+            _glfn->VertexAttribDivisor (visgl::instColLoc, 1);
+            _glfn->EnableVertexAttribArray (visgl::instColLoc);
+            _glfn->VertexAttribPointer (visgl::instDirnLoc, 4, GL_FLOAT, GL_FALSE, stride, (void*)(8 * sizeof(float)));
+            _glfn->VertexAttribDivisor (visgl::instDirnLoc, 1);
+            _glfn->EnableVertexAttribArray (visgl::instDirnLoc);
+            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+        }
+
+        /*!
+         * Upload vertexDatums into datumVBO and point the datum attribute at it. The colour
+         * attribute array is disabled, as a colour_by_datum (or colour_by_element) model has no
+         * vertexColors. Called
+         * with this->vao bound.
+         */
+        void upload_datums()
+        {
+            GladGLContext* _glfn = this->get_glfn(this->parentVis);
+            if (this->datumVBO == 0) { _glfn->GenBuffers (1, &this->datumVBO); }
+            _glfn->BindBuffer (GL_ARRAY_BUFFER, this->datumVBO);
+            const std::size_t n = this->vertexDatums.size();
+            if (n > this->datum_capacity || this->datum_capacity == 0) {
+                this->datum_capacity = std::max (n, std::size_t{1});
+                _glfn->BufferData (GL_ARRAY_BUFFER, this->datum_capacity * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+            }
+            if (n > 0) { _glfn->BufferSubData (GL_ARRAY_BUFFER, 0, n * sizeof(float), this->vertexDatums.data()); this->count_upload (mplot::upload_target::datums, n * sizeof(float)); }
+            _glfn->VertexAttribPointer (visgl::datumLoc, 1, GL_FLOAT, GL_FALSE, 0, (void*)(0));
+            _glfn->EnableVertexAttribArray (visgl::datumLoc);
+            _glfn->DisableVertexAttribArray (visgl::colLoc);
+            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+        }
+
+        //! Bind the colour lookup texture (uploading colour_lut first, if it has changed) to
+        //! visgl::colour_lut_unit for the colour_lut sampler
+        void bind_colour_lut (const mplot::visgl::shader_uniforms& u)
+        {
+            GladGLContext* _glfn = this->get_glfn(this->parentVis);
+            if (this->colour_lut_texture == 0) {
+                _glfn->GenTextures (1, &this->colour_lut_texture);
+                this->colour_lut_changed = true;
+            }
+            _glfn->ActiveTexture (GL_TEXTURE0 + visgl::colour_lut_unit);
+            _glfn->BindTexture (GL_TEXTURE_2D, this->colour_lut_texture);
+            ++this->get_render_state (this->parentVis).counts.texture_binds;
+            if (this->colour_lut_changed) {
+                // RGBA bytes are renderable, filterable and 4-byte aligned on all GL versions
+                const std::size_t n = this->colour_lut.size() / 3;
+                std::vector<unsigned char> rgba (4 * std::max (n, std::size_t{1}), 255);
+                for (std::size_t i = 0; i < n; ++i) {
+                    for (std::size_t j = 0; j < 3; ++j) {
+                        rgba[4 * i + j] = static_cast<unsigned char>(std::clamp (this->colour_lut[3 * i + j], 0.0f, 1.0f) * 255.0f + 0.5f);
+                    }
+                }
+                // A polar colour lookup is colour_lut_rows rows of texels, which wrap around in angle
+                const std::size_t rows = (this->colour_lut_rows > 1u && n >= this->colour_lut_rows) ? this->colour_lut_rows : 1u;
+                const GLsizei w = static_cast<GLsizei>(std::max (n / rows, std::size_t{1}));
+                _glfn->TexImage2D (GL_TEXTURE_2D, 0, GL_RGBA8, w, static_cast<GLsizei>(rows), 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+                _glfn->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                _glfn->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                _glfn->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, this->colour_by_polar ? GL_REPEAT : GL_CLAMP_TO_EDGE);
+                _glfn->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                this->colour_lut_changed = false;
+            }
+            if (u.colour_lut != -1) { _glfn->Uniform1i (u.colour_lut, visgl::colour_lut_unit); }
+            if (u.polar_inner != -1) { _glfn->Uniform1f (u.polar_inner, this->polar_inner); }
+            _glfn->ActiveTexture (GL_TEXTURE0);
+            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+        }
+
+        //! Bind the datum texture (uploading datum_texture first, if it has changed), the cells
+        //! of jump flooding, or the client's texture given to setDatumTexture, to
+        //! visgl::datum_texture_unit for the datum_texture sampler
+        void bind_datum_texture (const mplot::visgl::shader_uniforms& u)
+        {
+            GladGLContext* _glfn = this->get_glfn(this->parentVis);
+            // The cells of jump flooding, or the client's texture, if either
+            const GLuint ext = this->jump_flood_texture != 0 ? this->jump_flood_texture : this->external_datum_texture;
+            if (ext == 0 && this->datum_texture_id == 0) {
+                _glfn->GenTextures (1, &this->datum_texture_id);
+                this->datum_texture_changed = true;
+            }
+            _glfn->ActiveTexture (GL_TEXTURE0 + visgl::datum_texture_unit);
+            if (ext != 0) {
+                // Written on the GPU (by the client, or by jump flooding), so there is nothing to upload
+                _glfn->BindTexture (GL_TEXTURE_2D, ext);
+            } else {
+                _glfn->BindTexture (GL_TEXTURE_2D, this->datum_texture_id);
+            }
+            ++this->get_render_state (this->parentVis).counts.texture_binds;
+            if (ext == 0 && this->datum_texture_changed) {
+                const std::array<unsigned int, 2>& d = this->datum_texture_dims;
+                if (this->datum_texture.size() < std::size_t{d[0]} * d[1]) {
+                    throw std::runtime_error ("VisualModel: datum_texture is smaller than datum_texture_dims");
+                }
+                const GLsizei w = static_cast<GLsizei>(d[0]);
+                const GLsizei h = static_cast<GLsizei>(d[1]);
+                const std::array<GLenum, 2> gt = this->datum_texture_gl_type();
+                // Rows of 8 or 16 bit texels need not be 4 byte aligned
+                _glfn->PixelStorei (GL_UNPACK_ALIGNMENT, 1);
+                if (d != this->datum_texture_alloc || this->datum_gpu_format() != this->datum_texture_alloc_format) {
+                    // Single float texels are not filterable on all GL versions, so sample the nearest
+                    const auto px = this->datum_texels_for_upload (0u, 0u, d[0], d[1]);
+                    _glfn->TexImage2D (GL_TEXTURE_2D, 0, static_cast<GLint>(gt[0]), w, h, 0, GL_RED, gt[1], px.first);
+                    _glfn->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+                    _glfn->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+                    const GLint wrap = this->datum_texture_repeat ? GL_REPEAT : GL_CLAMP_TO_EDGE;
+                    _glfn->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+                    _glfn->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+                    this->datum_texture_alloc = d;
+                    this->datum_texture_alloc_format = this->datum_gpu_format();
+                } else if (this->datum_texture_rect[2] > 0u) {
+                    // Upload only the changed rectangle (float32 rows are read from within the whole texture)
+                    const std::array<unsigned int, 4>& r = this->datum_texture_rect;
+                    const unsigned int x1 = std::min (r[2], d[0]);
+                    const unsigned int y1 = std::min (r[3], d[1]);
+                    if (r[0] < x1 && r[1] < y1) {
+                        const auto px = this->datum_texels_for_upload (r[0], r[1], x1, y1);
+                        _glfn->PixelStorei (GL_UNPACK_ROW_LENGTH, static_cast<GLint>(px.second));
+                        _glfn->TexSubImage2D (GL_TEXTURE_2D, 0, static_cast<GLint>(r[0]), static_cast<GLint>(r[1]),
+                                         static_cast<GLsizei>(x1 - r[0]), static_cast<GLsizei>(y1 - r[1]), GL_RED, gt[1], px.first);
+                        _glfn->PixelStorei (GL_UNPACK_ROW_LENGTH, 0);
+                    }
+                } else {
+                    const auto px = this->datum_texels_for_upload (0u, 0u, d[0], d[1]);
+                    _glfn->TexSubImage2D (GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RED, gt[1], px.first);
+                }
+                this->datum_texture_changed = false;
+                this->datum_texture_rect = { 0u, 0u, 0u, 0u };
+            }
+            if (u.datum_texture != -1) { _glfn->Uniform1i (u.datum_texture, visgl::datum_texture_unit); }
+            if (u.datum_scale != -1) { _glfn->Uniform2f (u.datum_scale, this->datum_scale[0], this->datum_scale[1]); }
+            if (u.datum_texture_offset != -1) { _glfn->Uniform2f (u.datum_texture_offset, this->datum_texture_offset[0], this->datum_texture_offset[1]); }
+            if (u.cell_grid != -1) {
+                const auto& cg = this->cell_grid;
+                _glfn->Uniform4f (u.cell_grid, cg.width[0], cg.width[1], static_cast<float>(cg.units), cg.border ? 1.0f : 0.0f);
+            }
+            if (u.cell_grid_colour != -1) {
+                const std::array<float, 3>& gc = this->cell_grid.colour;
+                _glfn->Uniform3f (u.cell_grid_colour, gc[0], gc[1], gc[2]);
+            }
+            if (u.cell_border_colour != -1) {
+                const std::array<float, 3>& bc = this->cell_grid.border_colour;
+                _glfn->Uniform3f (u.cell_border_colour, bc[0], bc[1], bc[2]);
+            }
+            if (u.element_offset != -1) { _glfn->Uniform1i (u.element_offset, this->element_offset); }
+            if (u.element_scale != -1) { _glfn->Uniform2f (u.element_scale, this->element_scale[0], this->element_scale[1]); }
+            _glfn->ActiveTexture (GL_TEXTURE0);
+            mplot::gl::Util::checkError (__FILE__, __LINE__, _glfn);
+        }
     };
 
 } // namespace mplot
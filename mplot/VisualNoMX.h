@@ -68,10 +68,25 @@ namespace mplot {
 
             this->init_resources();
             this->init_gl();
+        }
+
+        /*!
+         * Construct a new visualiser whose window shares its OpenGL context with that of
+         * _share. Font faces and their glyph atlas textures are then created once for the
+         * whole share group, rather than once per window. (Vertex arrays are not shared between
+         * contexts, so each VisualModel still belongs to the one Visual that it was added to.)
+         */
+        VisualNoMX (const int _width, const int _height, const std::string& _title,
+               VisualNoMX<glver>& _share, const bool _version_stdout = true)
+        {
+            this->window_w = _width;
+            this->window_h = _height;
+            this->title = _title;
+            this->options.set (visual_options::versionStdout, _version_stdout);
+            this->context_share = &_share;
 
-            // Special tasks: re-bind coordArrows and title text
-            this->bindextra (this->coordArrows);
-            this->bindextra (this->textModel);
+            this->init_resources();
+            this->init_gl();
         }
 
         //! Deconstructor destroys GLFW/Qt window and deregisters access to VisualResources
@@ -87,12 +102,19 @@ namespace mplot {
         // happen, and lastly initializes the freetype code.
         void init_resources()
         {
-            mplot::VisualGlfw<glver>::i().init(); // Init GLFW windows system
+            {
+                mplot::startup_profile::scope startup_phase (this->startup, "glfwInit");
+                mplot::VisualGlfw<glver>::i().init(); // Init GLFW windows system
+            }
             // VisualResources provides font management. Ensure it exists in memory.
             mplot::VisualResourcesNoMX<glver>::i().create();
             // Set up the window that will present the OpenGL graphics.  This has to
             // happen BEFORE the call to VisualResources::freetype_init()
-            this->init_window();
+            {
+                // init_window also loads GL, which is timed as a phase of its own ("GLAD")
+                mplot::startup_profile::scope startup_phase (this->startup, "window");
+                this->init_window();
+            }
             this->setContext(); // For freetype_init
             this->freetype_init();
             this->releaseContext();
@@ -105,8 +127,13 @@ namespace mplot {
         }
 
         //! Make this Visual the current one, so that when creating/adding a visual model, the vao
-        //! ids relate to the correct OpenGL context.
-        void setContext() final { glfwMakeContextCurrent (this->window); }
+        //! ids relate to the correct OpenGL context. glfwGetCurrentContext only reads a thread
+        //! local, so glfwMakeContextCurrent (a round trip to the driver) is skipped if this
+        //! Visual's context is current already.
+        void setContext() final
+        {
+            if (glfwGetCurrentContext() != this->window) { glfwMakeContextCurrent (this->window); }
+        }
 
         //! swapBuffers implementation for glfw
         void swapBuffers() final { glfwSwapBuffers (this->window); }
@@ -138,7 +165,10 @@ namespace mplot {
         }
 
         //! Release the OpenGL context
-        void releaseContext() final { glfwMakeContextCurrent (nullptr); }
+        void releaseContext() final
+        {
+            if (glfwGetCurrentContext() != nullptr) { glfwMakeContextCurrent (nullptr); }
+        }
 
         /*!
          * \brief OpenGL context check
@@ -174,6 +204,13 @@ namespace mplot {
             model->releaseContext = &mplot::VisualBase<glver>::release_context;
         }
 
+        //! Bind the coordArrows and title text, when they are made, to this Visual's context
+        void bind_overlays() override
+        {
+            if (this->coordArrows != nullptr) { this->bindextra (this->coordArrows); }
+            if (this->textModel != nullptr) { this->bindextra (this->textModel); }
+        }
+
         /*
          * A note on setContext() in keepOpen/poll/waitevents/wait:
          *
@@ -190,9 +227,9 @@ namespace mplot {
          */
         void keepOpen()
         {
+            this->requestRedraw();
             while (this->state.test (visual_state::readyToFinish) == false) {
-                glfwWaitEventsTimeout (0.01667); // 16.67 ms ~ 60 Hz
-                this->render();
+                this->render_and_wait();
             }
         }
 
@@ -203,12 +240,51 @@ namespace mplot {
         void pauseOpen()
         {
             this->state.set (visual_state::paused);
+            this->requestRedraw();
             while (this->state.test (visual_state::paused) == true && this->state.test (visual_state::readyToFinish) == false) {
-                glfwWaitEventsTimeout (0.01667); // 16.67 ms ~ 60 Hz
-                this->render();
+                this->render_and_wait();
             }
         }
 
+        /*!
+         * Run the tasks given to spawn() (see mplot/frame_tasks.h) until they have all returned
+         * or the user signals readyToFinish. Each pass resumes the tasks that are ready, renders
+         * at each frame tick if the scene has changed (or on every tick, without
+         * visual_options::renderOnDemand), resumes the tasks waiting for that frame, and then
+         * waits for events until a task next needs waking. Tasks that have not returned when the
+         * window closes stay suspended; tasks.clear() destroys them.
+         */
+        void runTasks()
+        {
+            this->requestRedraw();
+            while (!this->tasks.empty() && this->state.test (visual_state::readyToFinish) == false) {
+                this->tasks.resume_woken();
+                if (this->tasks.frame_due()) {
+                    const bool rendered = this->needs_render || !this->options.test (visual_options::renderOnDemand);
+                    if (rendered) { this->render(); }
+                    this->tasks.frame_done (rendered);
+                }
+                const double w = this->tasks.wait_s();
+                if (w == 0.0) {
+                    glfwPollEvents();
+                } else if (w > 0.0) {
+                    glfwWaitEventsTimeout (w);
+                } else {
+                    glfwWaitEvents();
+                }
+            }
+        }
+
+        /*!
+         * Flag that the scene needs to be rendered, and wake up keepOpen() or pauseOpen() if
+         * they are waiting for events.
+         */
+        void requestRedraw() override
+        {
+            const bool was_needed = this->needs_render.exchange (true);
+            if (!was_needed && this->window != nullptr) { glfwPostEmptyEvent(); }
+        }
+
         //! Wrapper around the glfw polling function
         void poll() { glfwPollEvents(); }
         //! A wait-for-events with a timeout wrapper
@@ -228,9 +304,28 @@ namespace mplot {
 
     private:
 
+        /*!
+         * One pass of the keepOpen()/pauseOpen() loop. Render if the scene has changed, then
+         * block until there are events to process. Without visual_options::renderOnDemand,
+         * render on every pass and wait no more than 16.67 ms (~60 Hz).
+         */
+        void render_and_wait()
+        {
+            if (this->options.test (visual_options::renderOnDemand) == true) {
+                if (this->needs_render) { this->render(); }
+                glfwWaitEvents();
+            } else {
+                this->render();
+                glfwWaitEventsTimeout (0.01667); // 16.67 ms ~ 60 Hz
+            }
+        }
+
         void init_window()
         {
-            this->window = glfwCreateWindow (this->window_w, this->window_h, this->title.c_str(), NULL, NULL);
+            // A window created with a share window shares its context's objects (see context_share)
+            GLFWwindow* share_win = nullptr;
+            if (this->context_share != nullptr) { share_win = static_cast<VisualNoMX<glver>*>(this->context_share)->getWindow(); }
+            this->window = glfwCreateWindow (this->window_w, this->window_h, this->title.c_str(), NULL, share_win);
             if (!this->window) {
                 // Window or OpenGL context creation failed
                 throw std::runtime_error("GLFW window creation failed!");
@@ -245,6 +340,7 @@ namespace mplot {
             glfwSetWindowSizeCallback (this->window, window_size_callback_dispatch);
             glfwSetWindowCloseCallback (this->window, window_close_callback_dispatch);
             glfwSetScrollCallback (this->window, scroll_callback_dispatch);
+            glfwSetWindowRefreshCallback (this->window, window_refresh_callback_dispatch);
 
             glfwMakeContextCurrent (this->window);
 
@@ -269,12 +365,14 @@ namespace mplot {
         {
             VisualNoMX<glver>* self = static_cast<VisualNoMX<glver>*>(glfwGetWindowUserPointer (_window));
             self->mouse_button_callback (button, action, mods);
+            self->requestRedraw();
         }
         static void cursor_position_callback_dispatch (GLFWwindow* _window, double x, double y)
         {
             VisualNoMX<glver>* self = static_cast<VisualNoMX<glver>*>(glfwGetWindowUserPointer (_window));
+            // A drag is applied (and drawn) once per frame, however fast the mouse reports
             if (self->cursor_position_callback (x, y)) {
-                self->render();
+                self->requestRedraw();
             }
         }
         static void window_size_callback_dispatch (GLFWwindow* _window, int width, int height)
@@ -284,6 +382,12 @@ namespace mplot {
                 self->render();
             }
         }
+        static void window_refresh_callback_dispatch (GLFWwindow* _window)
+        {
+            // The window system has damaged the window contents
+            VisualNoMX<glver>* self = static_cast<VisualNoMX<glver>*>(glfwGetWindowUserPointer (_window));
+            self->requestRedraw();
+        }
         static void window_close_callback_dispatch (GLFWwindow* _window)
         {
             VisualNoMX<glver>* self = static_cast<VisualNoMX<glver>*>(glfwGetWindowUserPointer (_window));
@@ -31,7 +31,13 @@ namespace mplot { namespace gl { static constexpr int multicontext = 0; } }
 #include <mplot/VisualResourcesNoMX.h>
 #include <mplot/VisualTextModel.h>
 #include <mplot/VisualBase.h>
+#include <mplot/VisualBatchNoMX.h>
 #include <mplot/gl/loadshaders_nomx.h>
+#include <mplot/gl/debug_group_nomx.h>
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <exception>
 
 namespace mplot {
 
@@ -71,33 +77,197 @@ namespace mplot {
         //! Deconstruct gl memory/context
         void deconstructCommon()
         {
-            // Explicitly deconstruct any owned VisualModels
+            // Explicitly deconstruct any owned VisualModels, once any builds from
+            // finalize_async have finished (their errors can no longer be reported)
+            for (auto& m : this->vm) {
+                try { m->wait_for_build(); } catch (const std::exception&) {}
+            }
             this->vm.clear();
+            this->vm_handles.clear();
             // Explicitly deconstruct coordArrows, textModel and texts here
             this->coordArrows.reset(nullptr);
             this->textModel.reset(nullptr);
+            this->profileText.reset(nullptr);
+            this->memoryText.reset(nullptr);
             for (auto& t : this->texts) { t.reset(nullptr); }
+            // Now that every text model is gone, delete the GL names that they left for reuse
+            this->text_pool.names.drain ([](mplot::visgl::text_model_pool::gl_names& n) {
+                glDeleteBuffers (static_cast<GLsizei>(n.vbos.size()), n.vbos.data());
+                glDeleteVertexArrays (1, &n.vao);
+            });
 
             if (this->shaders.gprog) {
-                glDeleteProgram (this->shaders.gprog);
+                // shaders.gprog is one of the two graphics programs
+                if (this->proj2d_prog) { glDeleteProgram (this->proj2d_prog); }
+                if (this->cyl_prog) { glDeleteProgram (this->cyl_prog); }
+                if (this->unlit_prog) { glDeleteProgram (this->unlit_prog); }
+                this->proj2d_prog = 0;
+                this->cyl_prog = 0;
+                this->unlit_prog = 0;
                 this->shaders.gprog = 0;
+                this->gprog_uniforms = {};
                 this->active_gprog = mplot::visgl::graphics_shader_type::none;
             }
             if (this->shaders.tprog) {
                 glDeleteProgram (this->shaders.tprog);
                 this->shaders.tprog = 0;
+                this->tprog_uniforms = {};
+            }
+            if (this->scene_ubo) {
+                glDeleteBuffers (1, &this->scene_ubo);
+                this->scene_ubo = 0;
+            }
+            this->batch.reset (nullptr);
+            this->stopRecording();
+            this->stopStreaming();
+            this->stopProfiling();
+            this->free_captures();
+            this->free_pick();
+            this->free_oit();
+            this->free_cyl_cube();
+            this->free_aa();
+            this->free_static_layer();
+            if (this->fullwindow_vao) {
+                glDeleteVertexArrays (1, &this->fullwindow_vao);
+                this->fullwindow_vao = 0;
             }
             // Free up the Fonts associated with this mplot::Visual
             mplot::VisualResourcesNoMX<glver>::i().freetype_deinit (this);
         }
 
     protected:
+        //! The batch in which the batchable models are drawn (created when first needed)
+        std::unique_ptr<mplot::VisualBatchNoMX<glver>> batch;
+        //! The batchable models found in the current render() call
+        std::vector<mplot::VisualModelBase<glver>*> batch_models;
+        //! When blending order independently, the translucent models found in the current
+        //! render() call and the opaque models that it drew on their own (not in the batch)
+        std::vector<mplot::VisualModelBase<glver>*> translucent_models;
+        std::vector<mplot::VisualModelBase<glver>*> opaque_models;
+        //! The framebuffer for order independent transparency, its accumulation and weight
+        //! textures, its depth renderbuffer and their size
+        GLuint oit_fbo = 0;
+        std::array<GLuint, 2> oit_tex = { 0, 0 };
+        GLuint oit_depth = 0;
+        sm::vec<int, 2> oit_dims = { 0, 0 };
+        //! The programs of the accumulation and composite passes (linked when first needed) and
+        //! the uniform locations of the first
+        GLuint oit_prog = 0;
+        mplot::visgl::shader_uniforms oit_uniforms;
+        GLuint oit_composite_prog = 0;
+        //! Set if the framebuffer can't be made (its half float formats may not be renderable
+        //! here), after which translucent models are drawn in order
+        bool oit_unavailable = false;
+        //! The empty vertex array from which the full-window passes (the OIT composite and the
+        //! resampling of the cube map cylindrical projection) draw
+        GLuint fullwindow_vao = 0;
+        //! For the cube map cylindrical projection (see VisualBase::cylindricalCubeMap): the cube
+        //! map into which the scene is drawn, its depth renderbuffer, its framebuffer and the
+        //! size of its faces
+        GLuint cyl_cube_tex = 0;
+        GLuint cyl_cube_depth = 0;
+        GLuint cyl_cube_fbo = 0;
+        int cyl_cube_face = 0;
+        //! The program that resamples the cube map onto the cylinder (linked when first needed)
+        GLuint cyl_cube_prog = 0;
+        //! Set if the cube map framebuffer can't be made, after which the cylindrical projection
+        //! is drawn by the VisCyl.vert.glsl program
+        bool cyl_cube_unavailable = false;
+        //! For antiAliasing: the off-screen framebuffer into which render() draws the scene, its
+        //! colour and depth renderbuffers, their size and samples per pixel
+        GLuint aa_fbo = 0;
+        std::array<GLuint, 2> aa_rbo = { 0, 0 };
+        sm::vec<int, 2> aa_dims = { 0, 0 };
+        int aa_fbo_samples = -1;
+        //! The framebuffer and texture into which the scene is resolved, and their size
+        GLuint aa_resolve_fbo = 0;
+        GLuint aa_resolve_tex = 0;
+        sm::vec<int, 2> aa_resolve_dims = { 0, 0 };
+        //! The program that copies (or FXAA filters) the resolved scene into the window, and the
+        //! location of its fxaa uniform
+        GLuint post_prog = 0;
+        GLint post_fxaa = -1;
+        //! Set if the off-screen framebuffers can't be made, after which render() draws
+        //! straight into the window
+        bool aa_unavailable = false;
+        //! For the static layer (see VisualModel::setStaticLayer): the framebuffer into which the
+        //! static models are drawn, its colour and depth renderbuffers and their size. The
+        //! samples and formats are those of the framebuffer that it is copied into.
+        GLuint static_fbo = 0;
+        std::array<GLuint, 2> static_rbo = { 0, 0 };
+        sm::vec<int, 2> static_dims = { 0, 0 };
+        std::array<GLint, 3> static_formats = { -1, 0, 0 };
+        //! What the static layer was last drawn with (the scene and projection matrices, the
+        //! lighting, background and size) and the static models, with their change counts
+        std::vector<float> static_key;
+        std::vector<std::pair<mplot::VisualModelBase<glver>*, std::uint64_t>> static_drawn;
+        //! Set if the static layer can't be made or copied, after which all of the models are
+        //! drawn on each frame
+        bool static_unavailable = false;
+
+        /*!
+         * Attach the SceneState uniform block of the linked shader program prog (if it has one)
+         * to the scene_state uniform buffer binding point and look up the locations of the
+         * remaining mplot::Visual uniforms. Scene state uniforms that are declared outside a
+         * SceneState block (as they may be in older, user-supplied shader files) are found
+         * here too, so that render() can still set them individually.
+         */
+        mplot::visgl::shader_uniforms setup_uniforms (const GLuint prog)
+        {
+            mplot::visgl::shader_uniforms u;
+            if (prog == 0) { return u; }
+            const GLuint block = glGetUniformBlockIndex (prog, "SceneState");
+            if (block != GL_INVALID_INDEX) { glUniformBlockBinding (prog, block, mplot::visgl::scene_state_binding); }
+            auto loc = [prog](const char* name) { return glGetUniformLocation (prog, static_cast<const GLchar*>(name)); };
+            u.m_matrix = loc ("m_matrix");
+            u.v_matrix = loc ("v_matrix");
+            u.p_matrix = loc ("p_matrix");
+            u.alpha = loc ("alpha");
+            u.light_colour = loc ("light_colour");
+            u.ambient_intensity = loc ("ambient_intensity");
+            u.diffuse_position = loc ("diffuse_position");
+            u.diffuse_intensity = loc ("diffuse_intensity");
+            u.cyl_cam_pos = loc ("cyl_cam_pos");
+            u.cyl_radius = loc ("cyl_radius");
+            u.cyl_height = loc ("cyl_height");
+            u.colour_by_datum = loc ("colour_by_datum");
+            u.colour_lut = loc ("colour_lut");
+            u.datum_texture = loc ("datum_texture");
+            u.datum_scale = loc ("datum_scale");
+            u.datum_texture_offset = loc ("datum_texture_offset");
+            u.cell_grid = loc ("cell_grid");
+            u.cell_grid_colour = loc ("cell_grid_colour");
+            u.cell_border_colour = loc ("cell_border_colour");
+            u.element_offset = loc ("element_offset");
+            u.element_scale = loc ("element_scale");
+            u.polar_inner = loc ("polar_inner");
+            u.curvature = loc ("curvature");
+            u.curvature_offset = loc ("curvature_offset");
+            u.textColor = loc ("textColor");
+            u.text_sdf = loc ("text_sdf");
+            u.text_billboard = loc ("text_billboard");
+            u.model_id = loc ("model_id");
+            u.pick_mode = loc ("pick_mode");
+            u.element_base = loc ("element_base");
+            u.sprite_radius = loc ("sprite_radius");
+            u.viewport = loc ("viewport");
+            return u;
+        }
+
         void freetype_init() final
         {
             // Now make sure that Freetype is set up (we assume that caller code has set the correct OpenGL context)
-            mplot::VisualResourcesNoMX<glver>::i().freetype_init (this);
+            mplot::startup_profile::scope startup_phase (this->startup, "FreeType init");
+            mplot::VisualResourcesNoMX<glver>::i().freetype_init (this, this->context_share);
         }
 
+        /*!
+         * The Visual with which this one shares its OpenGL context (its objects, such as
+         * textures and buffers), or null. Set before init_resources(). The Visuals of a share
+         * group hold one set of font faces and glyph atlases between them.
+         */
+        mplot::VisualBase<glver>* context_share = nullptr;
+
     public:
         // Do one-time init of the Visual's resources. This gets/creates the VisualResources,
         // registers this visual with resources, calls init_window for any glfw stuff that needs to
@@ -115,68 +285,1249 @@ namespace mplot {
         //! Take a screenshot of the window. Return vec containing width * height or {-1, -1} on
         //! failure. Set transparent_bg to get a transparent background.
         sm::vec<int, 2> saveImage (const std::string& img_filename, const bool transparent_bg = false)
+        {
+            std::future<sm::vec<int, 2>> f = this->saveImageAsync (img_filename, transparent_bg);
+            this->complete_captures (true);
+            return f.get();
+        }
+
+        /*!
+         * Start a screenshot of the window. ReadPixels writes into one of a ring of pixel pack
+         * buffers, so it returns without waiting for the GPU. Each render() checks the fences of
+         * the pending captures and maps those that are complete; the PNG is then encoded on a
+         * worker thread. If all of the buffers in the ring are in use, this waits for the oldest.
+         */
+        std::future<sm::vec<int, 2>> saveImageAsync (const std::string& img_filename, const bool transparent_bg = false)
         {
             this->setContext();
+            MPLOT_TRACE_GL ("Visual::saveImage");
+            typename mplot::VisualBase<glver>::pending_capture& c = this->next_capture_slot();
+            c.filename = img_filename;
+            c.transparent_bg = transparent_bg;
+            c.record = false;
+            c.result = std::promise<sm::vec<int, 2>>{};
+            std::future<sm::vec<int, 2>> f = c.result.get_future();
+            if (!this->read_into_capture (c)) { c.result.set_value ({ -1, -1 }); }
+            return f;
+        }
+
+        //! Find the model and element under the window coordinates (x, y). See VisualBase::pick.
+        typename mplot::VisualBase<glver>::pick_result pick (const double x, const double y) final
+        {
+            this->setContext();
+            // Finish any pick that render() started for the pick callback, as the two share a buffer
+            if (this->pick_fence != nullptr) { this->complete_pick (true); }
+            typename mplot::VisualBase<glver>::pick_result r;
+            if (this->start_pick ({ static_cast<float>(x), static_cast<float>(y) })) { this->finish_pick (true, r); }
+            return r;
+        }
+
+        /*!
+         * Render the scene into an off-screen framebuffer at the size dims (in pixels) and save it
+         * as a PNG. dims need not match the window, and there need not be a window at all (see
+         * mplot::VisualHeadless). An image that is larger than the biggest renderbuffer the GL
+         * allows is drawn in tiles. samples sets the multisample anti-aliasing (by default, that
+         * of antiAliasing, or 4). Returns dims, or {-1, -1} on failure.
+         */
+        sm::vec<int, 2> saveImageOffscreen (const std::string& img_filename, const sm::vec<int, 2> dims,
+                                            const bool transparent_bg = false, const int samples = -1)
+        {
+            if (dims[0] <= 0 || dims[1] <= 0) { return { -1, -1 }; }
+            this->setContext();
+            MPLOT_TRACE_GL ("Visual::saveImageOffscreen");
+            std::vector<unsigned char> rgba = this->render_offscreen (dims, samples);
+            if (rgba.empty()) { return { -1, -1 }; }
+            return mplot::VisualBase<glver>::encode_capture (img_filename, rgba, dims, transparent_bg);
+        }
+
+        /*!
+         * Render the scene into off-screen framebuffers at the size dims and return its RGBA
+         * pixels, top row first (or an empty vector if the framebuffers could not be made). Each
+         * tile is drawn into a multisampled framebuffer, resolved into a second framebuffer (through
+         * FXAA, if antiAliasing asks for it) and read straight into its place in the image.
+         */
+        std::vector<unsigned char> render_offscreen (const sm::vec<int, 2> dims, int samples = -1)
+        {
+            this->setContext();
+            GLint max_rb = 0;
+            glGetIntegerv (GL_MAX_RENDERBUFFER_SIZE, &max_rb);
+            GLint max_vp[2] = { 0, 0 };
+            glGetIntegerv (GL_MAX_VIEWPORT_DIMS, max_vp);
+            GLint max_samples = 0;
+            glGetIntegerv (GL_MAX_SAMPLES, &max_samples);
+            // By default, the Visual's own antiAliasing samples (or 4)
+            if (samples < 0) { samples = this->aa_samples >= 0 ? this->aa_samples : 4; }
+            samples = std::clamp (samples, 0, static_cast<int>(max_samples));
+            const bool fxaa = this->options.test (visual_options::fxaa);
+
+            const sm::vec<int, 2> tdims = { std::min ({ dims[0], static_cast<int>(max_rb), static_cast<int>(max_vp[0]) }),
+                                            std::min ({ dims[1], static_cast<int>(max_rb), static_cast<int>(max_vp[1]) }) };
+            if (tdims[0] <= 0 || tdims[1] <= 0) { return {}; }
+            const sm::vec<int, 2> ntiles = { (dims[0] + tdims[0] - 1) / tdims[0], (dims[1] + tdims[1] - 1) / tdims[1] };
+            if (ntiles.product() > 1 && this->ptype == perspective_type::cylindrical) {
+                throw std::runtime_error ("VisualOwnable::render_offscreen: The cylindrical projection can't be tiled");
+            }
+
+            GLint prev_draw_fbo = 0;
+            GLint prev_read_fbo = 0;
+            glGetIntegerv (GL_DRAW_FRAMEBUFFER_BINDING, &prev_draw_fbo);
+            glGetIntegerv (GL_READ_FRAMEBUFFER_BINDING, &prev_read_fbo);
+
+            // fbo[0] is drawn into (rbo[0] colour, rbo[1] depth) and resolved into fbo[1] (rbo[2])
+            GLuint fbo[2] = { 0, 0 };
+            GLuint rbo[3] = { 0, 0, 0 };
+            glGenFramebuffers (2, fbo);
+            glGenRenderbuffers (3, rbo);
+            glBindRenderbuffer (GL_RENDERBUFFER, rbo[0]);
+            glRenderbufferStorageMultisample (GL_RENDERBUFFER, samples, GL_RGBA8, tdims[0], tdims[1]);
+            glBindRenderbuffer (GL_RENDERBUFFER, rbo[1]);
+            glRenderbufferStorageMultisample (GL_RENDERBUFFER, samples, GL_DEPTH_COMPONENT24, tdims[0], tdims[1]);
+            glBindRenderbuffer (GL_RENDERBUFFER, rbo[2]);
+            glRenderbufferStorage (GL_RENDERBUFFER, GL_RGBA8, tdims[0], tdims[1]);
+            glBindRenderbuffer (GL_RENDERBUFFER, 0);
+            glBindFramebuffer (GL_FRAMEBUFFER, fbo[0]);
+            glFramebufferRenderbuffer (GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, rbo[0]);
+            glFramebufferRenderbuffer (GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rbo[1]);
+            bool complete = glCheckFramebufferStatus (GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+            glBindFramebuffer (GL_FRAMEBUFFER, fbo[1]);
+            glFramebufferRenderbuffer (GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, rbo[2]);
+            complete = complete && glCheckFramebufferStatus (GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+            std::vector<unsigned char> rgba;
+            if (complete) {
+                rgba.resize (4u * static_cast<std::size_t>(dims[0]) * static_cast<std::size_t>(dims[1]));
+                // The projection is computed from window_w and window_h, so give it the image's aspect ratio
+                const int ww = this->window_w;
+                const int wh = this->window_h;
+                this->window_w = dims[0];
+                this->window_h = dims[1];
+                this->tile.active = true;
+                this->tile.dims = tdims;
+                glPixelStorei (GL_PACK_ALIGNMENT, 1);
+                glPixelStorei (GL_PACK_ROW_LENGTH, dims[0]);
+                for (int ty = 0; ty < ntiles[1]; ++ty) {
+                    for (int tx = 0; tx < ntiles[0]; ++tx) {
+                        const sm::vec<int, 2> origin = { tx * tdims[0], ty * tdims[1] };
+                        this->tile.clip_transform = mplot::VisualBase<glver>::tile_clip_transform (dims, origin, tdims);
+                        glBindFramebuffer (GL_FRAMEBUFFER, fbo[0]);
+                        this->render();
+                        if (!fxaa || !this->resolve_aa (fbo[0], tdims, fbo[1], tdims)) {
+                            glBindFramebuffer (GL_READ_FRAMEBUFFER, fbo[0]);
+                            glBindFramebuffer (GL_DRAW_FRAMEBUFFER, fbo[1]);
+                            glBlitFramebuffer (0, 0, tdims[0], tdims[1], 0, 0, tdims[0], tdims[1], GL_COLOR_BUFFER_BIT, GL_NEAREST);
+                        }
+                        glBindFramebuffer (GL_READ_FRAMEBUFFER, fbo[1]);
+                        // The tiles at the top and right edges may overhang the image
+                        glPixelStorei (GL_PACK_SKIP_PIXELS, origin[0]);
+                        glPixelStorei (GL_PACK_SKIP_ROWS, origin[1]);
+                        glReadPixels (0, 0, std::min (tdims[0], dims[0] - origin[0]), std::min (tdims[1], dims[1] - origin[1]),
+                                                GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+                    }
+                }
+                glPixelStorei (GL_PACK_ROW_LENGTH, 0);
+                glPixelStorei (GL_PACK_SKIP_PIXELS, 0);
+                glPixelStorei (GL_PACK_SKIP_ROWS, 0);
+                this->tile.active = false;
+                this->window_w = ww;
+                this->window_h = wh;
+                this->requestRedraw();
+            }
+
+            glBindFramebuffer (GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(prev_draw_fbo));
+            glBindFramebuffer (GL_READ_FRAMEBUFFER, static_cast<GLuint>(prev_read_fbo));
+            glDeleteFramebuffers (2, fbo);
+            glDeleteRenderbuffers (3, rbo);
+            mplot::gl::Util::checkError (__FILE__, __LINE__);
+
+            // GL gives the bottom row first; PNG wants the top row first
+            const std::size_t row = 4u * static_cast<std::size_t>(dims[0]);
+            for (std::size_t i = 0, j = static_cast<std::size_t>(dims[1]) - 1; i < j && !rgba.empty(); ++i, --j) {
+                std::swap_ranges (rgba.begin() + i * row, rgba.begin() + (i + 1) * row, rgba.begin() + j * row);
+            }
+            return rgba;
+        }
+
+        //! Stop recording, once the frames that have been captured are written. Returns the final stats.
+        mplot::recording_stats stopRecording()
+        {
+            if (!this->recorder) { return {}; }
+            this->setContext();
+            this->complete_captures (true);
+            mplot::recording_stats rs = this->recorder->finish(); // waits for the queued frames to be written
+            this->recorder.reset (nullptr);
+            return rs;
+        }
+
+        //! Stop profiling, freeing the GL timer queries. Returns the latest complete profile.
+        mplot::frame_profile stopProfiling()
+        {
+            if (!this->profiler) { return {}; }
+            this->setContext();
+            mplot::frame_profile fp = this->profiler->latest();
+            this->profiler->for_each_query ([this](unsigned int q) { glDeleteQueries (1, &q); });
+            this->profiler.reset (nullptr);
+            this->profileText.reset (nullptr);
+            return fp;
+        }
+
+        //! The memory held by the Visual's models, texts and faces (see VisualBase::getMemoryReport)
+        mplot::memory_report getMemoryReport()
+        {
+            this->setContext();
+            mplot::memory_report r = this->models_memory_report();
+            std::vector<const mplot::VisualTextModel<glver>*> ts = { this->textModel.get(), this->profileText.get(), this->memoryText.get() };
+            for (const auto& t : this->texts) { ts.push_back (t.get()); }
+            mplot::memory_report tr = mplot::VisualBase<glver>::texts_memory_report (ts);
+            if (!tr.children.empty()) { r.children.push_back (std::move (tr)); }
+            r.children.push_back (mplot::VisualResourcesNoMX<glver>::i().get_memory_report (this));
+            return r;
+        }
+
+    protected:
+        //! Take the next GPU timestamp of the frame being profiled
+        void profile_stamp()
+        {
+#ifdef GL_TIMESTAMP
+            unsigned int& q = this->profiler->stamp();
+            if (q == 0) { glGenQueries (1, &q); }
+            glQueryCounter (q, GL_TIMESTAMP);
+#endif
+        }
+
+        /*!
+         * Read the timestamps of the earlier profiled frames that the GPU has finished (so
+         * that render() never waits for the GPU), then start profiling this frame
+         */
+        void profile_begin_frame (const mplot::render_counts& between_frames)
+        {
+#ifdef GL_TIMESTAMP
+            this->profiler->collect ([this](const std::vector<unsigned int>& queries, const std::size_t n,
+                                            std::vector<std::uint64_t>& ns) {
+                if (n == 0) { return true; }
+                // Timestamps are written in order, so if the last is available, all are
+                GLint available = 0;
+                glGetQueryObjectiv (queries[n - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+                if (available == 0) { return false; }
+                ns.resize (n);
+                for (std::size_t i = 0; i < n; ++i) {
+                    GLuint64 t = 0;
+                    glGetQueryObjectui64v (queries[i], GL_QUERY_RESULT, &t);
+                    ns[i] = static_cast<std::uint64_t>(t);
+                }
+                return true;
+            });
+#else
+            this->profiler->gpu_timing = false;
+#endif
+            this->profiler->begin_frame (between_frames);
+            this->profile_stamp();
+        }
+
+        void profile_begin_item (const mplot::profile_item::kind what, const void* model = nullptr)
+        {
+            this->profiler->begin_item (what, model, this->glstate.counts);
+            this->profile_stamp();
+        }
+
+        void profile_end_item()
+        {
+            this->profile_stamp();
+            this->profiler->end_item (this->glstate.counts);
+        }
+
+        void profile_end_frame()
+        {
+            this->profile_stamp();
+            this->profiler->end_frame (this->glstate.counts);
+            this->profiler->next_frame();
+        }
+
+        //! Show a summary of the latest frame profile, updating it every profile_text_period profiles
+        void render_profile_text()
+        {
+            if (!this->profileText) {
+                this->profileText = std::make_unique<mplot::VisualTextModel<glver>> (mplot::TextFeatures (0.02f, 48));
+                this->bindmodel (this->profileText);
+                this->profile_text_shown = 0;
+            }
+            const std::uint64_t n = this->profiler->completed();
+            if (n > 0 && (this->profile_text_shown == 0 || n >= this->profile_text_shown + profile_text_period)) {
+                this->profileText->setupText (mplot::profile_summary (this->profiler->latest()));
+                this->profile_text_shown = n;
+            }
+            this->profileText->setSceneTranslation (this->textPosition ({-0.8f, -0.8f}));
+            this->profileText->setVisibleOn (this->bgcolour);
+            this->profileText->render();
+        }
 
+        //! The summary shown with visual_options::showProfile, and the completed() count that it shows
+        std::unique_ptr<mplot::VisualTextModel<glver>> profileText;
+        std::uint64_t profile_text_shown = 0;
+        static constexpr std::uint64_t profile_text_period = 15;
+
+        //! Show a summary of the memory report (see visual_options::showMemory), made again every memory_text_period frames
+        void render_memory_text()
+        {
+            if (!this->memoryText) {
+                this->memoryText = std::make_unique<mplot::VisualTextModel<glver>> (mplot::TextFeatures (0.02f, 48));
+                this->bindmodel (this->memoryText);
+                this->memory_text_frames = 0;
+            }
+            if (this->memory_text_frames++ % memory_text_period == 0) {
+                this->memoryText->setupText (this->getMemoryReport().summary());
+            }
+            this->memoryText->setSceneTranslation (this->textPosition ({-0.8f, 0.7f}));
+            this->memoryText->setVisibleOn (this->bgcolour);
+            this->memoryText->render();
+        }
+
+        //! The summary shown with visual_options::showMemory, and the frames since it was made
+        std::unique_ptr<mplot::VisualTextModel<glver>> memoryText;
+        std::uint64_t memory_text_frames = 0;
+        static constexpr std::uint64_t memory_text_period = 60;
+
+        //! The slot in the capture ring for the next capture. If it is still pending, wait for it.
+        typename mplot::VisualBase<glver>::pending_capture& next_capture_slot()
+        {
+            typename mplot::VisualBase<glver>::pending_capture& c = this->captures[this->next_capture];
+            if (c.busy) { this->complete_capture (c, true); }
+            this->next_capture = (this->next_capture + 1) % mplot::VisualBase<glver>::capture_ring_size;
+            return c;
+        }
+
+        //! Start reading the viewport into the pixel pack buffer of capture c. Returns false if the viewport is empty.
+        bool read_into_capture (typename mplot::VisualBase<glver>::pending_capture& c)
+        {
             GLint viewport[4]; // current viewport
             glGetIntegerv (GL_VIEWPORT, viewport);
+            c.dims[0] = viewport[2];
+            c.dims[1] = viewport[3];
 
-            sm::vec<int, 2> dims;
-            dims[0] = viewport[2];
-            dims[1] = viewport[3];
-            auto bits = std::make_unique<GLubyte[]>(dims.product() * 4);
-            auto rbits = std::make_unique<GLubyte[]>(dims.product() * 4);
-
-            glFinish(); // finish all commands of OpenGL
+            const GLsizeiptr sz = static_cast<GLsizeiptr>(c.dims.product()) * 4;
+            if (sz <= 0) { return false; }
+            if (c.pbo == 0) { glGenBuffers (1, &c.pbo); }
+            glBindBuffer (GL_PIXEL_PACK_BUFFER, c.pbo);
+            if (sz > c.pbo_size) {
+                glBufferData (GL_PIXEL_PACK_BUFFER, sz, nullptr, GL_STREAM_READ);
+                c.pbo_size = sz;
+            }
             glPixelStorei (GL_PACK_ALIGNMENT, 1);
             glPixelStorei (GL_PACK_ROW_LENGTH, 0);
             glPixelStorei (GL_PACK_SKIP_ROWS, 0);
             glPixelStorei (GL_PACK_SKIP_PIXELS, 0);
-            glReadPixels (0, 0, dims[0], dims[1], GL_RGBA, GL_UNSIGNED_BYTE, bits.get());
-
-            for (int i = 0; i < dims[1]; ++i) {
-                int rev_line = (dims[1] - i - 1) * 4 * dims[0];
-                int for_line = i * 4 * dims[0];
-                if (transparent_bg) {
-                    for (int j = 0; j < 4 * dims[0]; ++j) {
-                        rbits[rev_line + j] = bits[for_line + j];
+            glReadPixels (0, 0, c.dims[0], c.dims[1], GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            c.fence = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            glBindBuffer (GL_PIXEL_PACK_BUFFER, 0);
+            // Flush, so that the fence will signal without the need for a flushing wait
+            glFlush();
+            c.busy = true;
+            return true;
+        }
+
+        //! While recording or streaming, start reading back the frame that render() has just drawn
+        void record_frame()
+        {
+            typename mplot::VisualBase<glver>::pending_capture& c = this->next_capture_slot();
+            c.record = true;
+            this->read_into_capture (c);
+        }
+
+        /*!
+         * If the GPU has written the pixels of capture c (or if wait is true, once it has), copy
+         * them out of the pixel pack buffer, bottom row last, and start the PNG encode. Returns
+         * false if c is still pending.
+         */
+        bool complete_capture (typename mplot::VisualBase<glver>::pending_capture& c, const bool wait)
+        {
+            if (!c.busy) { return true; }
+            constexpr GLuint64 wait_ns = 100000000; // 100 ms per ClientWaitSync call
+            GLenum status = glClientWaitSync (c.fence, 0, wait ? wait_ns : 0);
+            while (wait && status == GL_TIMEOUT_EXPIRED) {
+                status = glClientWaitSync (c.fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait_ns);
+            }
+            if (status == GL_TIMEOUT_EXPIRED) { return false; }
+            glDeleteSync (c.fence);
+            c.fence = nullptr;
+            c.busy = false;
+            if (status == GL_WAIT_FAILED) {
+                if (!c.record) { c.result.set_value ({ -1, -1 }); }
+                return true;
+            }
+
+            const std::size_t row = 4u * static_cast<std::size_t>(c.dims[0]);
+            const std::size_t rows = static_cast<std::size_t>(c.dims[1]);
+            std::vector<unsigned char> rgba;
+            std::vector<unsigned char> stream_rgba;
+            // Drop the frame, rather than wait, if the recorder's encoders are behind, and if the
+            // streamer's rate control doesn't admit it
+            const bool to_recorder = c.record && this->recorder && this->recorder->acquire (rgba, row * rows);
+            const bool to_streamer = c.record && this->streamer && this->streamer->acquire (stream_rgba, row * rows);
+            if (c.record && !to_recorder && !to_streamer) { return true; }
+            if (!c.record) { rgba.resize (row * rows); }
+            // The frame is copied out of the pixel pack buffer once, into the recorder's buffer if it has one
+            std::vector<unsigned char>& dst = c.record && !to_recorder ? stream_rgba : rgba;
+            glBindBuffer (GL_PIXEL_PACK_BUFFER, c.pbo);
+            const unsigned char* mapped = static_cast<const unsigned char*>(
+                glMapBufferRange (GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(dst.size()), GL_MAP_READ_BIT));
+            if (mapped == nullptr) {
+                glBindBuffer (GL_PIXEL_PACK_BUFFER, 0);
+                if (!c.record) { c.result.set_value ({ -1, -1 }); }
+                return true;
+            }
+            // GL gives the bottom row first; PNG wants the top row first
+            for (std::size_t i = 0; i < rows; ++i) {
+                std::memcpy (dst.data() + (rows - i - 1) * row, mapped + i * row, row);
+            }
+            glUnmapBuffer (GL_PIXEL_PACK_BUFFER);
+            glBindBuffer (GL_PIXEL_PACK_BUFFER, 0);
+            if (to_streamer) {
+                if (to_recorder) { std::memcpy (stream_rgba.data(), rgba.data(), rgba.size()); }
+                this->streamer->push (std::move (stream_rgba), c.dims);
+            }
+            if (to_recorder) {
+                this->recorder->push (std::move (rgba), c.dims);
+            } else if (!c.record) {
+                this->start_capture_job (c, std::move (rgba));
+            }
+            return true;
+        }
+
+        //! Complete the pending captures, oldest first. If wait is false, stop at the first that is still pending.
+        void complete_captures (const bool wait)
+        {
+            for (std::size_t i = 0; i < mplot::VisualBase<glver>::capture_ring_size; ++i) {
+                auto& c = this->captures[(this->next_capture + i) % mplot::VisualBase<glver>::capture_ring_size];
+                if (!this->complete_capture (c, wait)) { break; }
+            }
+        }
+
+        //! Link the ID pass programs and make (or resize) the ID pass framebuffer. Returns false if it is incomplete.
+        bool setup_pick (const sm::vec<int, 2> dims)
+        {
+            if (this->shaders.pick_prog == 0) {
+                std::vector<mplot::gl::ShaderInfo> pick_progs = {
+                    {GL_VERTEX_SHADER, "VisualPick.vert.glsl", mplot::getDefaultPickVtxShader(glver), 0 },
+                    {GL_FRAGMENT_SHADER, "VisualPick.frag.glsl", mplot::getDefaultPickFragShader(glver), 0 }
+                };
+                this->shaders.pick_prog = mplot::gl::LoadShaders (pick_progs);
+                this->pick_uniforms = this->setup_uniforms (this->shaders.pick_prog);
+                std::vector<mplot::gl::ShaderInfo> sprite_progs = {
+                    {GL_VERTEX_SHADER, "VisualPickSprite.vert.glsl", mplot::getDefaultPickSpriteVtxShader(glver), 0 },
+                    {GL_FRAGMENT_SHADER, "VisualPickSprite.frag.glsl", mplot::getDefaultPickSpriteFragShader(glver), 0 }
+                };
+                this->shaders.pick_sprite_prog = mplot::gl::LoadShaders (sprite_progs);
+                this->pick_sprite_uniforms = this->setup_uniforms (this->shaders.pick_sprite_prog);
+            }
+            if (this->pick_fbo != 0 && this->pick_dims == dims) { return true; }
+            if (this->pick_fbo == 0) {
+                glGenFramebuffers (1, &this->pick_fbo);
+                glGenRenderbuffers (2, this->pick_rbo.data());
+            }
+            glBindRenderbuffer (GL_RENDERBUFFER, this->pick_rbo[0]);
+            glRenderbufferStorage (GL_RENDERBUFFER, GL_RGBA32UI, dims[0], dims[1]);
+            glBindRenderbuffer (GL_RENDERBUFFER, this->pick_rbo[1]);
+            glRenderbufferStorage (GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, dims[0], dims[1]);
+            glBindRenderbuffer (GL_RENDERBUFFER, 0);
+            glBindFramebuffer (GL_FRAMEBUFFER, this->pick_fbo);
+            glFramebufferRenderbuffer (GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->pick_rbo[0]);
+            glFramebufferRenderbuffer (GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, this->pick_rbo[1]);
+            const bool complete = glCheckFramebufferStatus (GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+            this->pick_dims = dims;
+            return complete;
+        }
+
+        /*!
+         * Draw the ID pass at the window coordinates xy and start reading its pixel into
+         * pick_pbo, setting pick_fence. Only the one pixel is drawn (the rest is scissored out),
+         * with the projection and the scene matrices of the last render(). The models of vm are
+         * drawn with the ids 1, 2, 3... in order, leaving 0 for the background, and their handles
+         * kept in pick_handles, so that finish_pick finds the right model even if models are
+         * removed before the pixel is read. Returns false if xy is outside the window or the
+         * projection is cylindrical.
+         */
+        bool start_pick (const sm::vec<float, 2> xy)
+        {
+            if (this->ptype == perspective_type::cylindrical) { return false; }
+            const sm::vec<int, 2> dims = { static_cast<int>(this->window_w * mplot::retinaScale),
+                                           static_cast<int>(this->window_h * mplot::retinaScale) };
+            // Window coordinates count down from the top; GL's pixels count up from the bottom
+            const int px = static_cast<int>(xy[0] * mplot::retinaScale);
+            const int py = dims[1] - 1 - static_cast<int>(xy[1] * mplot::retinaScale);
+            if (px < 0 || py < 0 || px >= dims[0] || py >= dims[1]) { return false; }
+
+            GLint prev_draw_fbo = 0;
+            GLint prev_read_fbo = 0;
+            glGetIntegerv (GL_DRAW_FRAMEBUFFER_BINDING, &prev_draw_fbo);
+            glGetIntegerv (GL_READ_FRAMEBUFFER_BINDING, &prev_read_fbo);
+            bool ok = this->setup_pick (dims);
+            if (ok) {
+                glViewport (0, 0, dims[0], dims[1]);
+                glEnable (GL_SCISSOR_TEST);
+                glScissor (px, py, 1, 1);
+                constexpr GLuint background[4] = { 0, 0, 0, 0 };
+                glClearBufferuiv (GL_COLOR, 0, background);
+                constexpr GLfloat far_depth = 1.0f;
+                glClearBufferfv (GL_DEPTH, 0, &far_depth);
+                // The SceneState block may hold the projection of an off-screen tile
+                glBindBuffer (GL_UNIFORM_BUFFER, this->scene_ubo);
+                glBufferSubData (GL_UNIFORM_BUFFER, 0, sizeof (this->projection.mat), this->projection.mat.data());
+                glBindBufferBase (GL_UNIFORM_BUFFER, mplot::visgl::scene_state_binding, this->scene_ubo);
+                this->pick_handles.clear();
+                for (auto mi = this->vm.begin(); mi != this->vm.end(); ++mi) {
+                    this->pick_handles.push_back (mi.handle());
+                    (*mi)->render_pick (static_cast<std::uint32_t>(this->pick_handles.size()));
+                }
+                mplot::gl::Util::bind_vao (this->glstate, 0);
+
+                if (this->pick_pbo == 0) {
+                    glGenBuffers (1, &this->pick_pbo);
+                    glBindBuffer (GL_PIXEL_PACK_BUFFER, this->pick_pbo);
+                    glBufferData (GL_PIXEL_PACK_BUFFER, 4 * sizeof (GLuint), nullptr, GL_STREAM_READ);
+                }
+                glBindBuffer (GL_PIXEL_PACK_BUFFER, this->pick_pbo);
+                glBindFramebuffer (GL_READ_FRAMEBUFFER, this->pick_fbo);
+                glPixelStorei (GL_PACK_ALIGNMENT, 4);
+                glPixelStorei (GL_PACK_ROW_LENGTH, 0);
+                glPixelStorei (GL_PACK_SKIP_ROWS, 0);
+                glPixelStorei (GL_PACK_SKIP_PIXELS, 0);
+                glReadPixels (px, py, 1, 1, GL_RGBA_INTEGER, GL_UNSIGNED_INT, nullptr);
+                this->pick_fence = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                glBindBuffer (GL_PIXEL_PACK_BUFFER, 0);
+                glDisable (GL_SCISSOR_TEST);
+                glFlush();
+            }
+            glBindFramebuffer (GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(prev_draw_fbo));
+            glBindFramebuffer (GL_READ_FRAMEBUFFER, static_cast<GLuint>(prev_read_fbo));
+            glViewport (0, 0, dims[0], dims[1]);
+            mplot::gl::Util::checkError (__FILE__, __LINE__);
+            return ok;
+        }
+
+        /*!
+         * If the GPU has written the pixel of the pick in flight (or if wait is true, once it
+         * has), read it into r. Returns false if the pick is still pending.
+         */
+        bool finish_pick (const bool wait, typename mplot::VisualBase<glver>::pick_result& r)
+        {
+            if (this->pick_fence == nullptr) { return true; }
+            constexpr GLuint64 wait_ns = 100000000; // 100 ms per ClientWaitSync call
+            GLenum status = glClientWaitSync (this->pick_fence, 0, wait ? wait_ns : 0);
+            while (wait && status == GL_TIMEOUT_EXPIRED) {
+                status = glClientWaitSync (this->pick_fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait_ns);
+            }
+            if (status == GL_TIMEOUT_EXPIRED) { return false; }
+            glDeleteSync (this->pick_fence);
+            this->pick_fence = nullptr;
+            if (status == GL_WAIT_FAILED) { return true; }
+
+            glBindBuffer (GL_PIXEL_PACK_BUFFER, this->pick_pbo);
+            const GLuint* id = static_cast<const GLuint*>(
+                glMapBufferRange (GL_PIXEL_PACK_BUFFER, 0, 4 * sizeof (GLuint), GL_MAP_READ_BIT));
+            if (id != nullptr) {
+                if (id[0] > 0 && id[0] <= this->pick_handles.size()) {
+                    // The model drawn with this id, if it is still in the scene
+                    r.model = this->getVisualModel (this->pick_handles[id[0] - 1]);
+                    if (r.model != nullptr) { r.element = id[1]; }
+                }
+                glUnmapBuffer (GL_PIXEL_PACK_BUFFER);
+            }
+            glBindBuffer (GL_PIXEL_PACK_BUFFER, 0);
+            return true;
+        }
+
+        //! Pass the result of the pick in flight to the pick callback, once it is ready (or if wait, when it is)
+        void complete_pick (const bool wait)
+        {
+            typename mplot::VisualBase<glver>::pick_result r;
+            if (this->finish_pick (wait, r) && this->pick_callback) { this->pick_callback (r); }
+        }
+
+        //! Link the order independent transparency programs and make (or resize) its framebuffer. Returns false if it is incomplete.
+        bool setup_oit (const sm::vec<int, 2> dims)
+        {
+            if (this->oit_prog == 0) {
+                std::vector<mplot::gl::ShaderInfo> accum_progs = {
+                    {GL_VERTEX_SHADER, "Visual.vert.glsl", mplot::getDefaultVtxShader(glver), 0 },
+                    {GL_FRAGMENT_SHADER, "VisualOit.frag.glsl", mplot::getDefaultOitFragShader(glver), 0 }
+                };
+                this->oit_prog = mplot::gl::LoadShaders (accum_progs);
+                this->oit_uniforms = this->setup_uniforms (this->oit_prog);
+                std::vector<mplot::gl::ShaderInfo> composite_progs = {
+                    {GL_VERTEX_SHADER, "VisualFullWindow.vert.glsl", mplot::getDefaultFullWindowVtxShader(glver), 0 },
+                    {GL_FRAGMENT_SHADER, "VisualOitComposite.frag.glsl", mplot::getDefaultOitCompositeFragShader(glver), 0 }
+                };
+                this->oit_composite_prog = mplot::gl::LoadShaders (composite_progs);
+                mplot::gl::Util::use_program (this->glstate, this->oit_composite_prog);
+                glUniform1i (glGetUniformLocation (this->oit_composite_prog, "accum_texture"), mplot::visgl::oit_first_unit);
+                glUniform1i (glGetUniformLocation (this->oit_composite_prog, "weight_texture"), mplot::visgl::oit_first_unit + 1);
+            }
+            if (this->fullwindow_vao == 0) { glGenVertexArrays (1, &this->fullwindow_vao); }
+            if (this->oit_fbo != 0 && this->oit_dims == dims) { return true; }
+            if (this->oit_fbo == 0) {
+                glGenFramebuffers (1, &this->oit_fbo);
+                glGenTextures (2, this->oit_tex.data());
+                glGenRenderbuffers (1, &this->oit_depth);
+            }
+            // RGBA16F accumulates the weighted colour and the revealage; R16F the weighted alpha
+            constexpr std::array<GLenum, 2> internal_format = { GL_RGBA16F, GL_R16F };
+            constexpr std::array<GLenum, 2> format = { GL_RGBA, GL_RED };
+            glActiveTexture (GL_TEXTURE0 + mplot::visgl::oit_first_unit);
+            for (std::size_t i = 0; i < 2; ++i) {
+                glBindTexture (GL_TEXTURE_2D, this->oit_tex[i]);
+                glTexImage2D (GL_TEXTURE_2D, 0, internal_format[i], dims[0], dims[1], 0, format[i], GL_HALF_FLOAT, nullptr);
+                glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+                glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            }
+            glBindTexture (GL_TEXTURE_2D, 0);
+            glActiveTexture (GL_TEXTURE0);
+            glBindRenderbuffer (GL_RENDERBUFFER, this->oit_depth);
+            glRenderbufferStorage (GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, dims[0], dims[1]);
+            glBindRenderbuffer (GL_RENDERBUFFER, 0);
+            glBindFramebuffer (GL_DRAW_FRAMEBUFFER, this->oit_fbo);
+            glFramebufferTexture2D (GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->oit_tex[0], 0);
+            glFramebufferTexture2D (GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, this->oit_tex[1], 0);
+            glFramebufferRenderbuffer (GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, this->oit_depth);
+            constexpr std::array<GLenum, 2> draw_buffers = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+            glDrawBuffers (2, draw_buffers.data());
+            this->oit_dims = dims;
+            return glCheckFramebufferStatus (GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        }
+
+        /*!
+         * Blend the translucent_models over the scene drawn so far, order independently (see
+         * VisualBase::orderIndependentTransparency). The opaque models' triangles are drawn
+         * again, depth only, into the OIT framebuffer; the translucent models' triangles are
+         * accumulated there, tested against that depth; and one composite pass blends the
+         * result into the framebuffer that render() is drawing into.
+         */
+        void render_translucent()
+        {
+            GLint prev_draw_fbo = 0;
+            glGetIntegerv (GL_DRAW_FRAMEBUFFER_BINDING, &prev_draw_fbo);
+            GLint viewport[4];
+            glGetIntegerv (GL_VIEWPORT, viewport);
+            const bool ready = this->setup_oit ({ viewport[2], viewport[3] });
+            glBindFramebuffer (GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(prev_draw_fbo));
+            if (!ready) {
+                std::cerr << "VisualOwnable: Order independent transparency is unavailable; translucent models are drawn in order\n";
+                this->oit_unavailable = true;
+                for (auto m : this->translucent_models) { m->render(); }
+                return;
+            }
+
+            // The depth of the opaque models, against which the translucent fragments are tested
+            glBindFramebuffer (GL_DRAW_FRAMEBUFFER, this->oit_fbo);
+            glColorMask (GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+            glClear (GL_DEPTH_BUFFER_BIT);
+            this->glstate.parts = mplot::visgl::model_parts::triangles;
+            for (auto m : this->opaque_models) { m->render(); }
+            if constexpr (mplot::VisualBatchBase<glver>::supported) {
+                if (!this->batch_models.empty() && this->batch != nullptr) {
+                    this->batch->render (this->batch_models, this->projection, this->glstate);
+                }
+            }
+            glColorMask (GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+            // Accumulate the translucent triangles, without writing depth
+            constexpr std::array<GLfloat, 4> accum_clear = { 0.0f, 0.0f, 0.0f, 1.0f };
+            constexpr std::array<GLfloat, 4> weight_clear = { 0.0f, 0.0f, 0.0f, 0.0f };
+            glClearBufferfv (GL_COLOR, 0, accum_clear.data());
+            glClearBufferfv (GL_COLOR, 1, weight_clear.data());
+            glDepthMask (GL_FALSE);
+            mplot::gl::Util::set_blend (this->glstate, true);
+            glBlendFuncSeparate (GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+            const GLuint gprog = this->shaders.gprog;
+            const mplot::visgl::shader_uniforms gprog_uniforms = this->gprog_uniforms;
+            this->shaders.gprog = this->oit_prog;
+            this->gprog_uniforms = this->oit_uniforms;
+            for (auto m : this->translucent_models) { m->render(); }
+            this->shaders.gprog = gprog;
+            this->gprog_uniforms = gprog_uniforms;
+            glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            glDepthMask (GL_TRUE);
+
+            // Blend the weighted average colour over the scene
+            glBindFramebuffer (GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(prev_draw_fbo));
+            glDisable (GL_DEPTH_TEST);
+            mplot::gl::Util::use_program (this->glstate, this->oit_composite_prog);
+            for (unsigned int i = 0; i < 2; ++i) {
+                glActiveTexture (GL_TEXTURE0 + mplot::visgl::oit_first_unit + i);
+                glBindTexture (GL_TEXTURE_2D, this->oit_tex[i]);
+                ++this->glstate.counts.texture_binds;
+            }
+            glActiveTexture (GL_TEXTURE0);
+            mplot::gl::Util::bind_vao (this->glstate, this->fullwindow_vao);
+            glDrawArrays (GL_TRIANGLES, 0, 3);
+            ++this->glstate.counts.draw_calls;
+            glEnable (GL_DEPTH_TEST);
+
+            // Then the translucent models' sprites, polylines, bars and texts, as usual
+            this->glstate.parts = mplot::visgl::model_parts::others;
+            for (auto m : this->translucent_models) { m->render(); }
+            this->glstate.parts = mplot::visgl::model_parts::all;
+            mplot::gl::Util::use_program (this->glstate, this->shaders.gprog);
+            mplot::gl::Util::checkError (__FILE__, __LINE__);
+        }
+
+        //! Link the cube map cylindrical projection's program and make (or resize) its cube map and framebuffer. Returns false if it is incomplete.
+        bool setup_cyl_cube (const int face)
+        {
+            if (this->cyl_cube_prog == 0) {
+                std::vector<mplot::gl::ShaderInfo> resample_progs = {
+                    {GL_VERTEX_SHADER, "VisualFullWindow.vert.glsl", mplot::getDefaultFullWindowVtxShader(glver), 0 },
+                    {GL_FRAGMENT_SHADER, "VisualCylCube.frag.glsl", mplot::getDefaultCylCubeFragShader(glver), 0 }
+                };
+                this->cyl_cube_prog = mplot::gl::LoadShaders (resample_progs);
+                this->setup_uniforms (this->cyl_cube_prog); // attaches its SceneState block
+                mplot::gl::Util::use_program (this->glstate, this->cyl_cube_prog);
+                glUniform1i (glGetUniformLocation (this->cyl_cube_prog, "scene_cube"), mplot::visgl::cyl_cube_unit);
+            }
+            if (this->fullwindow_vao == 0) { glGenVertexArrays (1, &this->fullwindow_vao); }
+            if (this->cyl_cube_fbo != 0 && this->cyl_cube_face == face) { return true; }
+            if (this->cyl_cube_fbo == 0) {
+                glGenFramebuffers (1, &this->cyl_cube_fbo);
+                glGenTextures (1, &this->cyl_cube_tex);
+                glGenRenderbuffers (1, &this->cyl_cube_depth);
+            }
+#ifdef GL_TEXTURE_CUBE_MAP_SEAMLESS
+            // Filter across the edges of the faces (always so on OpenGL ES 3)
+            glEnable (GL_TEXTURE_CUBE_MAP_SEAMLESS);
+#endif
+            glActiveTexture (GL_TEXTURE0 + mplot::visgl::cyl_cube_unit);
+            glBindTexture (GL_TEXTURE_CUBE_MAP, this->cyl_cube_tex);
+            for (unsigned int i = 0; i < 6; ++i) {
+                glTexImage2D (GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGBA8, face, face, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            }
+            glTexParameteri (GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri (GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri (GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri (GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri (GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+            glBindTexture (GL_TEXTURE_CUBE_MAP, 0);
+            glActiveTexture (GL_TEXTURE0);
+            glBindRenderbuffer (GL_RENDERBUFFER, this->cyl_cube_depth);
+            glRenderbufferStorage (GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, face, face);
+            glBindRenderbuffer (GL_RENDERBUFFER, 0);
+            glBindFramebuffer (GL_DRAW_FRAMEBUFFER, this->cyl_cube_fbo);
+            glFramebufferTexture2D (GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X, this->cyl_cube_tex, 0);
+            glFramebufferRenderbuffer (GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, this->cyl_cube_depth);
+            this->cyl_cube_face = face;
+            return glCheckFramebufferStatus (GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        }
+
+        /*!
+         * Draw the models in the cube map cylindrical projection (see
+         * VisualBase::cylindricalCubeMap). Each face of the cube map is drawn with a 90 degree
+         * perspective view from cyl_cam_pos (in the coordinates of sceneview), and then one
+         * full-window pass resamples the cube map onto the cylinder, in the framebuffer that
+         * render() is drawing into. p_draw is the projection that is restored to the SceneState
+         * uniform buffer for the texts that render() draws next.
+         */
+        void render_cylinder_cube (const sm::mat44<float>& sceneview, const sm::mat44<float>& p_draw)
+        {
+            GLint prev_draw_fbo = 0;
+            glGetIntegerv (GL_DRAW_FRAMEBUFFER_BINDING, &prev_draw_fbo);
+            GLint viewport[4];
+            glGetIntegerv (GL_VIEWPORT, viewport);
+            const int face = this->cyl_cube_size > 0 ? this->cyl_cube_size : std::max (64, viewport[2] / 4);
+            const bool ready = this->setup_cyl_cube (face);
+            glBindFramebuffer (GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(prev_draw_fbo));
+            if (!ready) {
+                std::cerr << "VisualOwnable: The cube map cylindrical projection is unavailable\n";
+                this->cyl_cube_unavailable = true;
+                return;
+            }
+
+            // Draw the scene into each face, in turn, replacing the projection in the SceneState block
+            const sm::vec<float, 4> cam = sceneview * this->cyl_cam_pos;
+            sm::mat44<float> face_projection;
+            face_projection.perspective (90.0f, 1.0f, this->zNear, this->zFar);
+            mplot::gl::Util::use_program (this->glstate, this->shaders.gprog);
+            glBindFramebuffer (GL_DRAW_FRAMEBUFFER, this->cyl_cube_fbo);
+            glViewport (0, 0, face, face);
+            for (unsigned int i = 0; i < 6; ++i) {
+                glFramebufferTexture2D (GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, this->cyl_cube_tex, 0);
+                glClearBufferfv (GL_COLOR, 0, this->bgcolour.data());
+                glClear (GL_DEPTH_BUFFER_BIT);
+                const sm::mat44<float> p_face = face_projection * mplot::VisualBase<glver>::cube_face_view (i, cam);
+                glBindBuffer (GL_UNIFORM_BUFFER, this->scene_ubo);
+                glBufferSubData (GL_UNIFORM_BUFFER, 0, sizeof (p_face.mat), p_face.mat.data());
+                for (auto& m : this->vm) { m->render(); }
+            }
+
+            // Resample onto the cylinder
+            glBindFramebuffer (GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(prev_draw_fbo));
+            glViewport (viewport[0], viewport[1], viewport[2], viewport[3]);
+            glBindBuffer (GL_UNIFORM_BUFFER, this->scene_ubo);
+            glBufferSubData (GL_UNIFORM_BUFFER, 0, sizeof (p_draw.mat), p_draw.mat.data());
+            glDisable (GL_DEPTH_TEST);
+            mplot::gl::Util::use_program (this->glstate, this->cyl_cube_prog);
+            glUniform4f (glGetUniformLocation (this->cyl_cube_prog, "viewport"),
+                         static_cast<float>(viewport[0]), static_cast<float>(viewport[1]),
+                         static_cast<float>(viewport[2]), static_cast<float>(viewport[3]));
+            glActiveTexture (GL_TEXTURE0 + mplot::visgl::cyl_cube_unit);
+            glBindTexture (GL_TEXTURE_CUBE_MAP, this->cyl_cube_tex);
+            ++this->glstate.counts.texture_binds;
+            glActiveTexture (GL_TEXTURE0);
+            mplot::gl::Util::bind_vao (this->glstate, this->fullwindow_vao);
+            glDrawArrays (GL_TRIANGLES, 0, 3);
+            ++this->glstate.counts.draw_calls;
+            glEnable (GL_DEPTH_TEST);
+            mplot::gl::Util::use_program (this->glstate, this->shaders.gprog);
+            mplot::gl::Util::checkError (__FILE__, __LINE__);
+        }
+
+        //! Delete the cube map, framebuffer and program of the cube map cylindrical projection
+        void free_cyl_cube()
+        {
+            if (this->cyl_cube_fbo) {
+                glDeleteFramebuffers (1, &this->cyl_cube_fbo);
+                glDeleteTextures (1, &this->cyl_cube_tex);
+                glDeleteRenderbuffers (1, &this->cyl_cube_depth);
+            }
+            this->cyl_cube_fbo = 0;
+            this->cyl_cube_tex = 0;
+            this->cyl_cube_depth = 0;
+            this->cyl_cube_face = 0;
+            if (this->cyl_cube_prog) { glDeleteProgram (this->cyl_cube_prog); }
+            this->cyl_cube_prog = 0;
+        }
+
+        //! Make (or resize) the off-screen framebuffer into which render() draws for antiAliasing, with samples per pixel (as far as the GL allows). Returns false if it is incomplete.
+        bool setup_aa (const sm::vec<int, 2> dims, const int samples)
+        {
+            if (this->aa_fbo != 0 && this->aa_dims == dims && this->aa_fbo_samples == samples) { return true; }
+            if (this->aa_fbo == 0) {
+                glGenFramebuffers (1, &this->aa_fbo);
+                glGenRenderbuffers (2, this->aa_rbo.data());
+            }
+            GLint max_samples = 0;
+            glGetIntegerv (GL_MAX_SAMPLES, &max_samples);
+            const int rb_samples = std::clamp (samples, 0, static_cast<int>(max_samples));
+            glBindRenderbuffer (GL_RENDERBUFFER, this->aa_rbo[0]);
+            glRenderbufferStorageMultisample (GL_RENDERBUFFER, rb_samples, GL_RGBA8, dims[0], dims[1]);
+            glBindRenderbuffer (GL_RENDERBUFFER, this->aa_rbo[1]);
+            glRenderbufferStorageMultisample (GL_RENDERBUFFER, rb_samples, GL_DEPTH_COMPONENT24, dims[0], dims[1]);
+            glBindRenderbuffer (GL_RENDERBUFFER, 0);
+            glBindFramebuffer (GL_DRAW_FRAMEBUFFER, this->aa_fbo);
+            glFramebufferRenderbuffer (GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->aa_rbo[0]);
+            glFramebufferRenderbuffer (GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, this->aa_rbo[1]);
+            this->aa_dims = dims;
+            this->aa_fbo_samples = samples;
+            return glCheckFramebufferStatus (GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        }
+
+        //! Link the post process program and make (or resize) the framebuffer into which the scene is resolved. Returns false if it is incomplete.
+        bool setup_aa_resolve (const sm::vec<int, 2> dims)
+        {
+            if (this->post_prog == 0) {
+                std::vector<mplot::gl::ShaderInfo> post_progs = {
+                    {GL_VERTEX_SHADER, "VisualFullWindow.vert.glsl", mplot::getDefaultFullWindowVtxShader(glver), 0 },
+                    {GL_FRAGMENT_SHADER, "VisualPostProcess.frag.glsl", mplot::getDefaultPostProcessFragShader(glver), 0 }
+                };
+                this->post_prog = mplot::gl::LoadShaders (post_progs);
+                mplot::gl::Util::use_program (this->glstate, this->post_prog);
+                glUniform1i (glGetUniformLocation (this->post_prog, "scene_texture"), mplot::visgl::post_process_unit);
+                this->post_fxaa = glGetUniformLocation (this->post_prog, "fxaa");
+            }
+            if (this->fullwindow_vao == 0) { glGenVertexArrays (1, &this->fullwindow_vao); }
+            if (this->aa_resolve_fbo != 0 && this->aa_resolve_dims == dims) { return true; }
+            if (this->aa_resolve_fbo == 0) {
+                glGenFramebuffers (1, &this->aa_resolve_fbo);
+                glGenTextures (1, &this->aa_resolve_tex);
+            }
+            glActiveTexture (GL_TEXTURE0 + mplot::visgl::post_process_unit);
+            glBindTexture (GL_TEXTURE_2D, this->aa_resolve_tex);
+            glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA8, dims[0], dims[1], 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            // FXAA samples between texels
+            glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glBindTexture (GL_TEXTURE_2D, 0);
+            glActiveTexture (GL_TEXTURE0);
+            glBindFramebuffer (GL_DRAW_FRAMEBUFFER, this->aa_resolve_fbo);
+            glFramebufferTexture2D (GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->aa_resolve_tex, 0);
+            this->aa_resolve_dims = dims;
+            return glCheckFramebufferStatus (GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        }
+
+        /*!
+         * Copy the scene in the framebuffer src (of size dims, and perhaps multisampled) into the
+         * framebuffer dst, of size dst_dims. It is resolved into aa_resolve_tex, which the post
+         * process program draws into dst, through FXAA if visual_options::fxaa is set. If dst is
+         * bigger than src (for dynamicResolution), the texture's linear filter scales it up.
+         * Returns false (having copied nothing) if the resolve framebuffer can't be made.
+         */
+        bool resolve_aa (const GLuint src, const sm::vec<int, 2> dims, const GLuint dst, const sm::vec<int, 2> dst_dims)
+        {
+            GLint prev_read_fbo = 0;
+            glGetIntegerv (GL_READ_FRAMEBUFFER_BINDING, &prev_read_fbo);
+            const bool ready = this->setup_aa_resolve (dims);
+            glBindFramebuffer (GL_DRAW_FRAMEBUFFER, dst);
+            if (!ready) { return false; }
+
+            glBindFramebuffer (GL_READ_FRAMEBUFFER, src);
+            glBindFramebuffer (GL_DRAW_FRAMEBUFFER, this->aa_resolve_fbo);
+            glBlitFramebuffer (0, 0, dims[0], dims[1], 0, 0, dims[0], dims[1], GL_COLOR_BUFFER_BIT, GL_NEAREST);
+            glBindFramebuffer (GL_READ_FRAMEBUFFER, static_cast<GLuint>(prev_read_fbo));
+            glBindFramebuffer (GL_DRAW_FRAMEBUFFER, dst);
+
+            // The resolved colour (and alpha, for a transparent background) replaces what is in dst
+            glViewport (0, 0, dst_dims[0], dst_dims[1]);
+            glDisable (GL_DEPTH_TEST);
+            mplot::gl::Util::set_blend (this->glstate, false);
+            mplot::gl::Util::use_program (this->glstate, this->post_prog);
+            glUniform1i (this->post_fxaa, this->options.test (visual_options::fxaa) ? 1 : 0);
+            glActiveTexture (GL_TEXTURE0 + mplot::visgl::post_process_unit);
+            glBindTexture (GL_TEXTURE_2D, this->aa_resolve_tex);
+            ++this->glstate.counts.texture_binds;
+            glActiveTexture (GL_TEXTURE0);
+            mplot::gl::Util::bind_vao (this->glstate, this->fullwindow_vao);
+            glDrawArrays (GL_TRIANGLES, 0, 3);
+            ++this->glstate.counts.draw_calls;
+            mplot::gl::Util::set_blend (this->glstate, true);
+            glEnable (GL_DEPTH_TEST);
+            mplot::gl::Util::use_program (this->glstate, this->shaders.gprog);
+            mplot::gl::Util::checkError (__FILE__, __LINE__);
+            return true;
+        }
+
+        /*!
+         * The samples, colour format and depth format (0 if it has no depth buffer) of the
+         * framebuffer fbo, which is bound to GL_DRAW_FRAMEBUFFER. A multisampled framebuffer can
+         * only be blitted into one of the same formats.
+         */
+        std::array<GLint, 3> draw_framebuffer_formats (const GLuint fbo)
+        {
+            std::array<GLint, 3> f = { 0, GL_RGBA8, 0 };
+            glGetIntegerv (GL_SAMPLES, &f[0]);
+            const GLenum depth_att = fbo == 0 ? GL_DEPTH : GL_DEPTH_ATTACHMENT;
+            const GLenum stencil_att = fbo == 0 ? GL_STENCIL : GL_STENCIL_ATTACHMENT;
+            GLint obj = GL_NONE;
+            glGetFramebufferAttachmentParameteriv (GL_DRAW_FRAMEBUFFER, depth_att, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &obj);
+            if (obj == GL_NONE) { return f; }
+            GLint depth_bits = 0;
+            GLint depth_type = GL_UNSIGNED_NORMALIZED;
+            GLint stencil_bits = 0;
+            glGetFramebufferAttachmentParameteriv (GL_DRAW_FRAMEBUFFER, depth_att, GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE, &depth_bits);
+            glGetFramebufferAttachmentParameteriv (GL_DRAW_FRAMEBUFFER, depth_att, GL_FRAMEBUFFER_ATTACHMENT_COMPONENT_TYPE, &depth_type);
+            glGetFramebufferAttachmentParameteriv (GL_DRAW_FRAMEBUFFER, stencil_att, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &obj);
+            if (obj != GL_NONE) {
+                glGetFramebufferAttachmentParameteriv (GL_DRAW_FRAMEBUFFER, stencil_att, GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE, &stencil_bits);
+            }
+            if (depth_type == GL_FLOAT) {
+                f[2] = stencil_bits > 0 ? GL_DEPTH32F_STENCIL8 : GL_DEPTH_COMPONENT32F;
+            } else if (stencil_bits > 0) {
+                f[2] = GL_DEPTH24_STENCIL8;
+            } else {
+                f[2] = depth_bits == 16 ? GL_DEPTH_COMPONENT16 : GL_DEPTH_COMPONENT24;
+            }
+            return f;
+        }
+
+        //! Make (or resize) the static layer framebuffer with the samples and formats f (see draw_framebuffer_formats). Returns false if it is incomplete.
+        bool setup_static_layer (const sm::vec<int, 2> dims, const std::array<GLint, 3>& f)
+        {
+            if (this->static_fbo != 0 && this->static_dims == dims && this->static_formats == f) { return true; }
+            if (this->static_fbo == 0) {
+                glGenFramebuffers (1, &this->static_fbo);
+                glGenRenderbuffers (2, this->static_rbo.data());
+            }
+            glBindRenderbuffer (GL_RENDERBUFFER, this->static_rbo[0]);
+            glRenderbufferStorageMultisample (GL_RENDERBUFFER, f[0], static_cast<GLenum>(f[1]), dims[0], dims[1]);
+            glBindRenderbuffer (GL_RENDERBUFFER, this->static_rbo[1]);
+            glRenderbufferStorageMultisample (GL_RENDERBUFFER, f[0], f[2] ? static_cast<GLenum>(f[2]) : GL_DEPTH_COMPONENT24, dims[0], dims[1]);
+            glBindRenderbuffer (GL_RENDERBUFFER, 0);
+            glBindFramebuffer (GL_DRAW_FRAMEBUFFER, this->static_fbo);
+            glFramebufferRenderbuffer (GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->static_rbo[0]);
+            const GLenum att = (f[2] == GL_DEPTH24_STENCIL8 || f[2] == GL_DEPTH32F_STENCIL8) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+            glFramebufferRenderbuffer (GL_DRAW_FRAMEBUFFER, att, GL_RENDERBUFFER, this->static_rbo[1]);
+            this->static_dims = dims;
+            this->static_formats = f;
+            this->static_key.clear(); // the layer must be redrawn
+            return glCheckFramebufferStatus (GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        }
+
+        /*!
+         * If any model is in the static layer, copy the layer (redrawing it first if its models,
+         * the view or the lighting have changed) into the bound draw framebuffer, replacing its
+         * colour and depth. Returns true if the static models are then in the frame, so that
+         * render() need not draw them. Translucent models are not drawn in the layer when they
+         * are blended order independently (oit).
+         */
+        bool composite_static_layer (const sm::mat44<float>& sceneview, const sm::mat44<float>& p_draw,
+                                     const sm::vec<int, 2> dims, const bool oit)
+        {
+            if (this->static_unavailable || this->tile.active || this->ptype == perspective_type::cylindrical) { return false; }
+            std::vector<std::pair<mplot::VisualModelBase<glver>*, std::uint64_t>> statics;
+            for (auto& m : this->vm) {
+                if (m->getStaticLayer() && !(oit && m->getAlpha() < 1.0f)) { statics.emplace_back (m.get(), m->change_count()); }
+            }
+            if (statics.empty()) { return false; }
+
+            std::vector<float> key (sceneview.mat.begin(), sceneview.mat.end());
+            key.insert (key.end(), p_draw.mat.begin(), p_draw.mat.end());
+            key.insert (key.end(), this->bgcolour.begin(), this->bgcolour.end());
+            key.insert (key.end(), this->light_colour.begin(), this->light_colour.end());
+            key.insert (key.end(), this->diffuse_position.begin(), this->diffuse_position.end());
+            key.insert (key.end(), { this->ambient_intensity, this->diffuse_intensity,
+                                     static_cast<float>(dims[0]), static_cast<float>(dims[1]) });
+
+            GLint target = 0;
+            glGetIntegerv (GL_DRAW_FRAMEBUFFER_BINDING, &target);
+            const std::array<GLint, 3> f = this->draw_framebuffer_formats (static_cast<GLuint>(target));
+            if (!this->setup_static_layer (dims, f)) {
+                std::cerr << "VisualOwnable: The static layer framebuffer is unavailable; drawing all models on each frame\n";
+                this->static_unavailable = true;
+                glBindFramebuffer (GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(target));
+                return false;
+            }
+
+            if (key != this->static_key || statics != this->static_drawn) {
+                glBindFramebuffer (GL_DRAW_FRAMEBUFFER, this->static_fbo);
+                glClearBufferfv (GL_COLOR, 0, this->bgcolour.data());
+                const GLfloat far_depth = 1.0f;
+                glClearBufferfv (GL_DEPTH, 0, &far_depth);
+                sm::mat44<float> scenetransonly;
+                scenetransonly.translate (this->scenetrans);
+                const bool all_unlit = this->lighting_neutral();
+                // The program of the lit models, put back after each unlit one
+                const GLuint lit_prog = this->shaders.gprog;
+                const mplot::visgl::shader_uniforms lit_uniforms = this->gprog_uniforms;
+                for (auto& s : statics) {
+                    mplot::VisualModelBase<glver>* m = s.first;
+                    m->setSceneMatrix (m->twodimensional == true ? scenetransonly : sceneview);
+                    if (m->has_lod()) { m->set_lod_view (this->projection, this->window_h); }
+                    if (m->needs_viewport()) { m->set_viewport_size (dims[0], dims[1]); }
+                    if (m->has_declutter()) { m->set_declutter_view (this->projection, dims); }
+                    if (m->outside_frustum (this->projection)) { continue; }
+                    const bool unlit = this->unlit_prog != 0 && (all_unlit || m->is_unlit());
+                    if (unlit) {
+                        this->shaders.gprog = this->unlit_prog;
+                        this->gprog_uniforms = this->unlit_uniforms;
                     }
-                } else {
-                    for (int j = 0; j < 4 * dims[0]; ++j) {
-                        rbits[rev_line + j] = (j % 4 == 3) ? 255 : bits[for_line + j];
+                    m->render();
+                    if (unlit) {
+                        this->shaders.gprog = lit_prog;
+                        this->gprog_uniforms = lit_uniforms;
                     }
                 }
+                // Drawing may upload (a level of detail, say), so record the counts as they are now
+                for (auto& s : statics) { s.second = s.first->change_count(); }
+                this->static_key = std::move (key);
+                this->static_drawn = std::move (statics);
+            }
+
+            GLint prev_read_fbo = 0;
+            glGetIntegerv (GL_READ_FRAMEBUFFER_BINDING, &prev_read_fbo);
+            glBindFramebuffer (GL_READ_FRAMEBUFFER, this->static_fbo);
+            glBindFramebuffer (GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(target));
+            const GLbitfield mask = GL_COLOR_BUFFER_BIT | (f[2] ? GL_DEPTH_BUFFER_BIT : 0);
+            glBlitFramebuffer (0, 0, dims[0], dims[1], 0, 0, dims[0], dims[1], mask, GL_NEAREST);
+            glBindFramebuffer (GL_READ_FRAMEBUFFER, static_cast<GLuint>(prev_read_fbo));
+            // A framebuffer of some other colour format can't take a multisampled copy
+            if (glGetError() != GL_NO_ERROR) {
+                std::cerr << "VisualOwnable: The static layer can't be copied into this framebuffer; drawing all models on each frame\n";
+                this->static_unavailable = true;
+                this->free_static_layer();
+                glBindFramebuffer (GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(target));
+                return false;
+            }
+            return true;
+        }
+
+        /*!
+         * Bind fbo to GL_DRAW_FRAMEBUFFER and tell the GL that the contents of its attachments are
+         * no longer needed, so that a tiled GPU need not write them back to memory (see
+         * VisualBase::tiledGpuProfile). fbo is left bound.
+         */
+        void invalidate_framebuffer (const GLuint fbo, const std::array<GLenum, 2>& attachments)
+        {
+            glBindFramebuffer (GL_DRAW_FRAMEBUFFER, fbo);
+            if constexpr (mplot::VisualBase<glver>::invalidate_supported) {
+                glInvalidateFramebuffer (GL_DRAW_FRAMEBUFFER, 2, attachments.data());
+            }
+        }
+
+        //! Delete the framebuffers, renderbuffers, texture and program of antiAliasing
+        void free_aa()
+        {
+            if (this->aa_fbo) {
+                glDeleteFramebuffers (1, &this->aa_fbo);
+                glDeleteRenderbuffers (2, this->aa_rbo.data());
+            }
+            this->aa_fbo = 0;
+            this->aa_rbo = { 0, 0 };
+            this->aa_dims = { 0, 0 };
+            this->aa_fbo_samples = -1;
+            if (this->aa_resolve_fbo) {
+                glDeleteFramebuffers (1, &this->aa_resolve_fbo);
+                glDeleteTextures (1, &this->aa_resolve_tex);
+            }
+            this->aa_resolve_fbo = 0;
+            this->aa_resolve_tex = 0;
+            this->aa_resolve_dims = { 0, 0 };
+            if (this->post_prog) { glDeleteProgram (this->post_prog); }
+            this->post_prog = 0;
+            this->post_fxaa = -1;
+        }
+
+        //! Delete the static layer framebuffer and renderbuffers
+        void free_static_layer()
+        {
+            if (this->static_fbo) {
+                glDeleteFramebuffers (1, &this->static_fbo);
+                glDeleteRenderbuffers (2, this->static_rbo.data());
+            }
+            this->static_fbo = 0;
+            this->static_rbo = { 0, 0 };
+            this->static_dims = { 0, 0 };
+            this->static_formats = { -1, 0, 0 };
+            this->static_key.clear();
+            this->static_drawn.clear();
+        }
+
+        //! Delete the order independent transparency framebuffer, textures and programs
+        void free_oit()
+        {
+            if (this->oit_fbo) {
+                glDeleteFramebuffers (1, &this->oit_fbo);
+                glDeleteTextures (2, this->oit_tex.data());
+                glDeleteRenderbuffers (1, &this->oit_depth);
             }
-            unsigned int error = lodepng::encode (img_filename, rbits.get(), dims[0], dims[1]);
-            if (error) {
-                std::cerr << "encoder error " << error << ": " << lodepng_error_text (error) << std::endl;
-                dims.set_from (-1);
-                return dims;
+            this->oit_fbo = 0;
+            this->oit_tex = { 0, 0 };
+            this->oit_depth = 0;
+            this->oit_dims = { 0, 0 };
+            if (this->oit_prog) { glDeleteProgram (this->oit_prog); }
+            if (this->oit_composite_prog) { glDeleteProgram (this->oit_composite_prog); }
+            this->oit_prog = 0;
+            this->oit_uniforms = {};
+            this->oit_composite_prog = 0;
+        }
+
+        //! Delete the ID pass framebuffer, buffer and programs
+        void free_pick()
+        {
+            if (this->pick_fence != nullptr) { glDeleteSync (this->pick_fence); }
+            this->pick_fence = nullptr;
+            if (this->pick_pbo) { glDeleteBuffers (1, &this->pick_pbo); }
+            this->pick_pbo = 0;
+            if (this->pick_fbo) {
+                glDeleteFramebuffers (1, &this->pick_fbo);
+                glDeleteRenderbuffers (2, this->pick_rbo.data());
             }
-            return dims;
+            this->pick_fbo = 0;
+            this->pick_rbo = { 0, 0 };
+            this->pick_dims = { 0, 0 };
+            if (this->shaders.pick_prog) { glDeleteProgram (this->shaders.pick_prog); }
+            if (this->shaders.pick_sprite_prog) { glDeleteProgram (this->shaders.pick_sprite_prog); }
+            this->shaders.pick_prog = 0;
+            this->shaders.pick_sprite_prog = 0;
         }
 
+        //! Complete all of the captures, wait for their encodes and delete the pixel pack buffers
+        void free_captures()
+        {
+            this->complete_captures (true);
+            this->finish_capture_jobs();
+            for (auto& c : this->captures) {
+                if (c.pbo) { glDeleteBuffers (1, &c.pbo); }
+                c.pbo = 0;
+                c.pbo_size = 0;
+            }
+        }
+
+    public:
+
         //! Render the scene
         void render() noexcept final
         {
             this->setContext();
+            MPLOT_TRACE_GL ("Visual::render");
+            // Until the first frame has been drawn, it is timed as phases of the startup
+            const bool first_frame = !this->startup.complete();
+            if (first_frame) { this->startup.mark ("scene setup"); }
+            mplot::startup_profile::scope startup_render (this->startup, "first render");
+            using sc = std::chrono::steady_clock;
+            const sc::time_point frame_start = sc::now();
+            // Was this frame asked for by anything other than the last frame (see dynamicResolution)?
+            const bool changed = this->needs_render && !this->scaler_catch_up;
+            this->scaler_catch_up = false;
 
-            if (this->ptype == perspective_type::orthographic || this->ptype == perspective_type::perspective) {
+            // Hand any screenshots that the GPU has finished writing to the PNG encoder
+            this->complete_captures (false);
+            // Apply the input events from the stream's clients before drawing the frame
+            this->dispatch_stream_input();
+            // Move the scene once for the pointer positions since the last frame
+            this->apply_pointer_motion();
+            // Close up the gaps left by models removed since the last frame
+            this->vm.compact();
+            // Pass the result of the last cursor pick to the pick callback, if the GPU has written it
+            if (this->pick_fence != nullptr) { this->complete_pick (false); }
+
+            // Client code may have changed the GL state since the last frame. Its counts are
+            // of the uploads made since then.
+            const mplot::render_counts between_frames = this->glstate.counts;
+            this->glstate = {};
+            const bool tiled = this->options.test (visual_options::tiledGpuProfile);
+            this->glstate.check_errors = !tiled;
+            if (this->profiler) { this->profile_begin_frame (between_frames); }
+
+            // The cube map cylindrical projection draws the models with the projection2d program
+            // (see render_cylinder_cube)
+            const bool cyl_cube = this->ptype == perspective_type::cylindrical
+            && this->options.test (visual_options::cylindricalCubeMap) && !this->cyl_cube_unavailable;
+
+            if (this->ptype == perspective_type::orthographic || this->ptype == perspective_type::perspective || cyl_cube) {
                 if (this->active_gprog != mplot::visgl::graphics_shader_type::projection2d) {
-                    if (this->shaders.gprog) { glDeleteProgram (this->shaders.gprog); }
-                    this->shaders.gprog = mplot::gl::LoadShaders (this->proj2d_shader_progs);
+                    this->shaders.gprog = this->proj2d_prog;
+                    this->gprog_uniforms = this->proj2d_uniforms;
                     this->active_gprog = mplot::visgl::graphics_shader_type::projection2d;
                 }
             } else if (this->ptype == perspective_type::cylindrical) {
                 if (this->active_gprog != mplot::visgl::graphics_shader_type::cylindrical) {
-                    if (this->shaders.gprog) { glDeleteProgram (this->shaders.gprog); }
-                    this->shaders.gprog = mplot::gl::LoadShaders (this->cyl_shader_progs);
+                    this->shaders.gprog = this->cyl_prog;
+                    this->gprog_uniforms = this->cyl_uniforms;
                     this->active_gprog = mplot::visgl::graphics_shader_type::cylindrical;
                 }
             }
 
-            glUseProgram (this->shaders.gprog);
-            glViewport (0, 0, this->window_w * mplot::retinaScale, this->window_h * mplot::retinaScale);
+            mplot::gl::Util::use_program (this->glstate, this->shaders.gprog);
+            // With antiAliasing, the scene is drawn into an off-screen framebuffer, which is
+            // copied into the window's at the end of the frame (see resolve_aa). With
+            // dynamicResolution, a moving scene is drawn into it at a reduced size.
+            GLint window_fbo = 0;
+            const sm::vec<int, 2> window_dims = { static_cast<int>(this->window_w * mplot::retinaScale),
+                                                  static_cast<int>(this->window_h * mplot::retinaScale) };
+            const float rscale = (this->tile.active || this->aa_unavailable) ? 1.0f : this->scaler.begin_frame (frame_start, changed);
+            sm::vec<int, 2> draw_dims = window_dims;
+            if (rscale < 1.0f) {
+                draw_dims = { std::max (1, static_cast<int>(window_dims[0] * rscale + 0.5f)),
+                              std::max (1, static_cast<int>(window_dims[1] * rscale + 0.5f)) };
+            }
+            bool aa = !this->tile.active && !this->aa_unavailable
+            && (this->aa_samples >= 0 || this->options.test (visual_options::fxaa) || rscale < 1.0f
+                || this->options.test (visual_options::partialRedraw));
+            if (aa) {
+                // A GLFW window is the default framebuffer; a widget's may be another
+                if (this->window == nullptr) { glGetIntegerv (GL_DRAW_FRAMEBUFFER_BINDING, &window_fbo); }
+                aa = this->setup_aa (draw_dims, this->aa_samples);
+                if (aa) {
+                    glBindFramebuffer (GL_DRAW_FRAMEBUFFER, this->aa_fbo);
+                } else {
+                    std::cerr << "VisualOwnable: The anti-aliasing framebuffer is unavailable; drawing into the window\n";
+                    this->aa_unavailable = true;
+                    draw_dims = window_dims;
+                    glBindFramebuffer (GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(window_fbo));
+                }
+            }
+            if (this->tile.active) {
+                glViewport (0, 0, this->tile.dims[0], this->tile.dims[1]);
+            } else {
+                glViewport (0, 0, draw_dims[0], draw_dims[1]);
+            }
 
             // Set the perspective
             if (this->ptype == perspective_type::orthographic) {
@@ -185,12 +1536,10 @@ namespace mplot {
                 this->setPerspective();
             } else if (this->ptype == perspective_type::cylindrical) {
                 // Set cylindrical-specific uniforms
-                GLint loc_campos = glGetUniformLocation (this->shaders.gprog, static_cast<const GLchar*>("cyl_cam_pos"));
-                if (loc_campos != -1) { glUniform4fv (loc_campos, 1, this->cyl_cam_pos.data()); }
-                GLint loc_cyl_radius = glGetUniformLocation (this->shaders.gprog, static_cast<const GLchar*>("cyl_radius"));
-                if (loc_cyl_radius != -1) { glUniform1f (loc_cyl_radius, this->cyl_radius); }
-                GLint loc_cyl_height = glGetUniformLocation (this->shaders.gprog, static_cast<const GLchar*>("cyl_height"));
-                if (loc_cyl_height != -1) { glUniform1f (loc_cyl_height, this->cyl_height); }
+                const mplot::visgl::shader_uniforms& u = this->gprog_uniforms;
+                if (u.cyl_cam_pos != -1) { glUniform4fv (u.cyl_cam_pos, 1, this->cyl_cam_pos.data()); }
+                if (u.cyl_radius != -1) { glUniform1f (u.cyl_radius, this->cyl_radius); }
+                if (u.cyl_height != -1) { glUniform1f (u.cyl_height, this->cyl_height); }
             } else {
                 // unknown projection
                 return;
@@ -205,6 +1554,42 @@ namespace mplot {
             // And this rotation completes the transition from model to world
             sceneview.prerotate (this->rotation);
 
+            sm::mat44<float> scenetransonly;
+            scenetransonly.translate (this->scenetrans);
+
+            // The framebuffer size, for the models that draw in pixels
+            const int vp_w = static_cast<int>(this->window_w * mplot::retinaScale);
+            const int vp_h = static_cast<int>(this->window_h * mplot::retinaScale);
+            for (auto& m : this->vm) {
+                if (m->twodimensional == true) {
+                    // It's a two-d thing. Now what?
+                    m->setSceneMatrix (scenetransonly);
+                } else {
+                    m->setSceneMatrix (sceneview);
+                }
+                if (m->has_lod()) { m->set_lod_view (this->projection, this->window_h); }
+                if (m->needs_viewport()) { m->set_viewport_size (vp_w, vp_h); }
+                if (m->has_declutter()) { m->set_declutter_view (this->projection, { vp_w, vp_h }); }
+            }
+
+            // With partialRedraw, only the rectangle in which models changed is cleared and
+            // drawn. The rest of the off-screen framebuffer still holds the last frame.
+            mplot::screen_rect dirty;
+            bool partial = false;
+            if (this->options.test (visual_options::partialRedraw)) {
+                if (aa && !tiled && this->ptype != perspective_type::cylindrical && rscale == 1.0f
+                    && !(this->profiler && this->options.test (visual_options::showProfile))
+                    && !this->options.test (visual_options::showMemory)) {
+                    partial = this->partial_redraw_rect (sceneview, this->projection, draw_dims, this->texts.size(), dirty);
+                } else {
+                    this->partial_redraw_forget();
+                }
+            }
+            if (partial) {
+                glEnable (GL_SCISSOR_TEST);
+                glScissor (dirty.x0, dirty.y0, dirty.width(), dirty.height());
+            }
+
             // Clear color buffer and **also depth buffer**
             glClear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -214,61 +1599,142 @@ namespace mplot {
             // Lighting shader variables
             //
             // Ambient light colour
-            GLint loc_lightcol = glGetUniformLocation (this->shaders.gprog, static_cast<const GLchar*>("light_colour"));
-            if (loc_lightcol != -1) { glUniform3fv (loc_lightcol, 1, this->light_colour.data()); }
+            const mplot::visgl::shader_uniforms& gu = this->gprog_uniforms;
+            if (gu.light_colour != -1) { glUniform3fv (gu.light_colour, 1, this->light_colour.data()); }
             // Ambient light intensity
-            GLint loc_ai = glGetUniformLocation (this->shaders.gprog, static_cast<const GLchar*>("ambient_intensity"));
-            if (loc_ai != -1) { glUniform1f (loc_ai, this->ambient_intensity); }
+            if (gu.ambient_intensity != -1) { glUniform1f (gu.ambient_intensity, this->ambient_intensity); }
             // Diffuse light position
-            GLint loc_dp = glGetUniformLocation (this->shaders.gprog, static_cast<const GLchar*>("diffuse_position"));
-            if (loc_dp != -1) { glUniform3fv (loc_dp, 1, this->diffuse_position.data()); }
+            if (gu.diffuse_position != -1) { glUniform3fv (gu.diffuse_position, 1, this->diffuse_position.data()); }
             // Diffuse light intensity
-            GLint loc_di = glGetUniformLocation (this->shaders.gprog, static_cast<const GLchar*>("diffuse_intensity"));
-            if (loc_di != -1) { glUniform1f (loc_di, this->diffuse_intensity); }
+            if (gu.diffuse_intensity != -1) { glUniform1f (gu.diffuse_intensity, this->diffuse_intensity); }
+
+            // The projection that the shaders use. For a tile of an off-screen image, this
+            // selects the tile's part of the whole image's clip space.
+            const sm::mat44<float> p_draw = this->tile.active ? this->tile.clip_transform * this->projection : this->projection;
 
-            // Switch to text shader program and set the projection matrix
-            glUseProgram (this->shaders.tprog);
-            GLint loc_p = glGetUniformLocation (this->shaders.tprog, static_cast<const GLchar*>("p_matrix"));
-            if (loc_p != -1) { glUniformMatrix4fv (loc_p, 1, GL_FALSE, this->projection.mat.data()); }
+            // Write the scene state for this frame into the uniform buffer, from which the
+            // SceneState block in each default shader program reads it
+            mplot::visgl::scene_state ss;
+            std::copy (p_draw.mat.begin(), p_draw.mat.end(), ss.p_matrix.begin());
+            std::copy (this->cyl_cam_pos.begin(), this->cyl_cam_pos.end(), ss.cyl_cam_pos.begin());
+            std::copy (this->light_colour.begin(), this->light_colour.end(), ss.light_colour.begin());
+            ss.ambient_intensity = this->ambient_intensity;
+            std::copy (this->diffuse_position.begin(), this->diffuse_position.end(), ss.diffuse_position.begin());
+            ss.diffuse_intensity = this->diffuse_intensity;
+            ss.cyl_radius = this->cyl_radius;
+            ss.cyl_height = this->cyl_height;
+            glBindBuffer (GL_UNIFORM_BUFFER, this->scene_ubo);
+            glBufferSubData (GL_UNIFORM_BUFFER, 0, sizeof (mplot::visgl::scene_state), &ss);
+            glBindBufferBase (GL_UNIFORM_BUFFER, mplot::visgl::scene_state_binding, this->scene_ubo);
+
+            // Switch to text shader program and set the projection matrix (for shaders without a
+            // SceneState block)
+            mplot::gl::Util::use_program (this->glstate, this->shaders.tprog);
+            GLint loc_p = this->tprog_uniforms.p_matrix;
+            if (loc_p != -1) { glUniformMatrix4fv (loc_p, 1, GL_FALSE, p_draw.mat.data()); }
 
             // Switch back to the regular shader prog and render the VisualModels.
-            glUseProgram (this->shaders.gprog);
+            mplot::gl::Util::use_program (this->glstate, this->shaders.gprog);
+
+            // Set the projection matrix just once (if it is not in the SceneState block)
+            loc_p = gu.p_matrix;
+            if (loc_p != -1) { glUniformMatrix4fv (loc_p, 1, GL_FALSE, p_draw.mat.data()); }
+
+            // With order independent transparency, translucent models are drawn after the rest
+            // of the scene (see render_translucent)
+            const bool oit = this->options.test (visual_options::orderIndependentTransparency)
+            && this->ptype != perspective_type::cylindrical && !this->oit_unavailable;
+            this->translucent_models.clear();
+            this->opaque_models.clear();
 
-            // Set the projection matrix just once
-            loc_p = glGetUniformLocation (this->shaders.gprog, static_cast<const GLchar*>("p_matrix"));
-            if (loc_p != -1) { glUniformMatrix4fv (loc_p, 1, GL_FALSE, this->projection.mat.data()); }
+            // The static models (see VisualModel::setStaticLayer) are copied into the frame from
+            // the static layer, which is redrawn only when they, the view or the lighting change.
+            // The loop below then draws only the dynamic models.
+            const bool static_drawn = this->composite_static_layer (sceneview, p_draw, draw_dims, oit);
 
             if ((this->ptype == perspective_type::orthographic || this->ptype == perspective_type::perspective)
                 &&  this->options.test(visual_options::showCoordArrows)) {
+                if (this->coordArrows == nullptr) { this->make_coord_arrows(); }
                 // Ensure coordarrows centre sphere will be visible on BG:
-                this->coordArrows->setColourForBackground (this->bgcolour); // releases context...
-                this->setContext(); // ...so re-acquire if we're managing it
+                if (this->bgcolour != this->coordarrows_bgcolour) {
+                    this->coordArrows->setColourForBackground (this->bgcolour); // releases context...
+                    this->setContext(); // ...so re-acquire if we're managing it
+                    this->coordarrows_bgcolour = this->bgcolour;
+                }
 
                 if (this->options.test (visual_options::coordArrowsInScene) == true) {
                     this->coordArrows->setSceneMatrix (sceneview);
                 } else {
                     this->positionCoordArrows();
                 }
+                if (this->profiler) { this->profile_begin_item (mplot::profile_item::kind::coord_arrows); }
                 this->coordArrows->render();
+                if (this->profiler) { this->profile_end_item(); }
+                if (oit) { this->opaque_models.push_back (this->coordArrows.get()); }
             }
 
-            sm::mat44<float> scenetransonly;
-            scenetransonly.translate (this->scenetrans);
+            // Batchable models are gathered up here and drawn together (see VisualModel::setBatched)
+            constexpr bool batching = mplot::VisualBatchBase<glver>::supported;
+            const bool cylindrical = this->ptype == perspective_type::cylindrical;
+            this->batch_models.clear();
 
-            auto vmi = this->vm.begin();
-            while (vmi != this->vm.end()) {
-                if ((*vmi)->twodimensional == true) {
-                    // It's a two-d thing. Now what?
-                    (*vmi)->setSceneMatrix (scenetransonly);
-                } else {
-                    (*vmi)->setSceneMatrix (sceneview);
+            // Draw them in the order that they were added, or by depth (see sortModels)
+            this->order_models (sceneview, this->options.test (visual_options::sortModels) && !cylindrical);
+            // Models that need no lighting, and all models if the lighting is neutral, are drawn
+            // with the unlit program. A model without normals gets this constant normal from the
+            // lit programs (those of the cylindrical projection and of transparency, say).
+            const bool all_unlit = this->lighting_neutral();
+            // The program of the lit models, put back after each unlit one
+            const GLuint lit_prog = this->shaders.gprog;
+            const mplot::visgl::shader_uniforms lit_uniforms = this->gprog_uniforms;
+            glVertexAttrib4f (mplot::visgl::normLoc, 0.0f, 0.0f, 1.0f, 0.0f);
+            for (auto m : this->model_order) {
+                if (static_drawn && m->getStaticLayer() && !(oit && m->getAlpha() < 1.0f)) {
+                    // In the frame already, but the translucent models must be depth tested against it
+                    if (oit) { this->opaque_models.push_back (m); }
+                    continue;
+                }
+                if (oit && m->getAlpha() < 1.0f) {
+                    if (!m->outside_frustum (this->projection)) { this->translucent_models.push_back (m); }
+                } else if (batching && !cylindrical && m->batchable()) {
+                    this->batch_models.push_back (m);
+                } else if (!cyl_cube && (cylindrical || !m->outside_frustum (this->projection))) {
+                    // Skip models that lie wholly outside the view frustum (not for the cylindrical
+                    // projection). With the cube map, the models are drawn in render_cylinder_cube.
+                    if (this->profiler) { this->profile_begin_item (mplot::profile_item::kind::model, m); }
+                    const bool unlit = !cylindrical && this->unlit_prog != 0 && (all_unlit || m->is_unlit());
+                    if (unlit) {
+                        this->shaders.gprog = this->unlit_prog;
+                        this->gprog_uniforms = this->unlit_uniforms;
+                    }
+                    m->render();
+                    if (unlit) {
+                        this->shaders.gprog = lit_prog;
+                        this->gprog_uniforms = lit_uniforms;
+                    }
+                    if (this->profiler) { this->profile_end_item(); }
+                    if (oit) { this->opaque_models.push_back (m); }
+                }
+            }
+
+            if constexpr (batching) {
+                if (!this->batch_models.empty()) {
+                    if (this->batch == nullptr) { this->batch = std::make_unique<mplot::VisualBatchNoMX<glver>>(); }
+                    if (this->profiler) { this->profile_begin_item (mplot::profile_item::kind::batch); }
+                    this->batch->render (this->batch_models, this->projection, this->glstate);
+                    if (this->profiler) { this->profile_end_item(); }
                 }
-                (*vmi)->render();
-                ++vmi;
             }
 
+            if (cyl_cube) { this->render_cylinder_cube (sceneview, p_draw); }
+
+            // Only if there are translucent models is order independent transparency needed
+            if (!this->translucent_models.empty()) { this->render_translucent(); }
+
+            if (this->profiler) { this->profile_begin_item (mplot::profile_item::kind::texts); }
             sm::vec<float, 3> v0 = this->textPosition ({-0.8f, 0.8f});
             if (this->options.test (visual_options::showTitle) == true) {
+                if (this->textModel == nullptr) { this->make_title(); }
                 // Render the title text
                 this->textModel->setSceneTranslation (v0);
                 this->textModel->setVisibleOn (this->bgcolour);
@@ -282,16 +1748,72 @@ namespace mplot {
                 (*ti)->render();
                 ++ti;
             }
+            if (this->profiler && this->options.test (visual_options::showProfile)) { this->render_profile_text(); }
+            if (this->options.test (visual_options::showMemory)) { this->render_memory_text(); }
+            if (this->profiler) {
+                this->profile_end_item();
+                this->profile_end_frame();
+            }
+
+            if (partial) { glDisable (GL_SCISSOR_TEST); }
+
+            // Copy the off-screen scene into the window
+            if (aa) {
+                if (!this->resolve_aa (this->aa_fbo, draw_dims, static_cast<GLuint>(window_fbo), window_dims)) {
+                    std::cerr << "VisualOwnable: The anti-aliasing resolve framebuffer is unavailable\n";
+                    this->aa_unavailable = true;
+                } else if (tiled) {
+                    this->invalidate_framebuffer (this->aa_fbo, { GL_COLOR_ATTACHMENT0, GL_DEPTH_ATTACHMENT });
+                    glBindFramebuffer (GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(window_fbo));
+                }
+            }
 
-            if (this->options.test (visual_options::renderSwapsBuffers) == true) {
+            // Models leave their VAO bound, so unbind it before handing back to client code
+            mplot::gl::Util::bind_vao (this->glstate, 0);
+
+            // Read back the frame for the recorder and the streamer before the buffers are swapped
+            if ((this->recorder || (this->streamer && this->streamer->watched())) && !this->tile.active) { this->record_frame(); }
+
+            // Start a pick at the cursor for the pick callback (see setPickCallback), unless one is in flight
+            if (this->pick_wanted && this->pick_fence == nullptr && !this->tile.active) {
+                this->pick_wanted = false;
+                this->start_pick (this->pick_cursor);
+            }
+
+            // The scene is now up to date (see requestRedraw)
+            this->needs_render = false;
+            // A later render delivers the pick, or starts the one that waited for it
+            if (this->pick_fence != nullptr || this->pick_wanted) { this->requestRedraw(); }
+
+            if (this->options.test (visual_options::renderSwapsBuffers) == true && !this->tile.active) {
+                // The depth and stencil of a GLFW window's default framebuffer aren't needed again
+                if (tiled && this->window != nullptr) { this->invalidate_framebuffer (0, { GL_DEPTH, GL_STENCIL }); }
+                MPLOT_TRACE_SCOPE ("Visual::swapBuffers");
+                mplot::startup_profile::scope startup_swap (this->startup, "first swap");
                 this->swapBuffers();
             }
+
+            // A reduced frame is followed by another, which is drawn at full resolution once the
+            // scene has been still for long enough
+            if (!this->tile.active) {
+                this->scaler.end_frame (frame_start, sc::now());
+                if (this->scaler.reduced()) {
+                    this->scaler_catch_up = true;
+                    this->requestRedraw();
+                }
+            }
+
+            if (first_frame) {
+                startup_render.end();
+                this->startup.finish();
+            }
         }
 
     public:
 #ifdef GLAD_GL // Only define if GL was included with GLAD
         void init_glad (GLADloadfunc procaddressfn)
         {
+            mplot::startup_profile::scope startup_phase (this->startup, "GLAD");
             this->glfn_version = gladLoadGL (procaddressfn);
             if (this->glfn_version == 0) {
                 throw std::runtime_error ("Failed to initialize GLAD GL context");
@@ -356,6 +1878,7 @@ namespace mplot {
         void init_gl()
         {
             this->setContext(); // if managing context
+            mplot::startup_profile::scope startup_phase (this->startup, "init_gl (shaders)");
 
             if (this->options.test (visual_options::versionStdout) == true) {
                 unsigned char* glv = (unsigned char*)glGetString(GL_VERSION);
@@ -366,19 +1889,45 @@ namespace mplot {
 
             this->setSwapInterval();
 
+            // In release builds, GL errors come through the debug output rather than glGetError
+            mplot::gl::Util::enable_debug_output();
+
+            // The uniform buffer for the per-frame scene state, shared by all the shader programs
+            glGenBuffers (1, &this->scene_ubo);
+            glBindBuffer (GL_UNIFORM_BUFFER, this->scene_ubo);
+            glBufferData (GL_UNIFORM_BUFFER, sizeof (mplot::visgl::scene_state), nullptr, GL_DYNAMIC_DRAW);
+            glBindBufferBase (GL_UNIFORM_BUFFER, mplot::visgl::scene_state_binding, this->scene_ubo);
+            glBindBuffer (GL_UNIFORM_BUFFER, 0);
+            mplot::gl::Util::checkError (__FILE__, __LINE__);
+
             // Load up the shaders
             this->proj2d_shader_progs = {
                 {GL_VERTEX_SHADER, "Visual.vert.glsl", mplot::getDefaultVtxShader(glver), 0 },
                 {GL_FRAGMENT_SHADER, "Visual.frag.glsl", mplot::getDefaultFragShader(glver), 0 }
             };
-            this->shaders.gprog = mplot::gl::LoadShaders (this->proj2d_shader_progs);
-            this->active_gprog = mplot::visgl::graphics_shader_type::projection2d;
+            this->proj2d_prog = mplot::gl::LoadShaders (this->proj2d_shader_progs);
+            this->proj2d_uniforms = this->setup_uniforms (this->proj2d_prog);
 
-            // Alternative cylindrical shader for possible later use. (NB: not loaded immediately)
+            // Alternative cylindrical shader, linked now so that a later switch of projection
+            // doesn't have to compile it mid-frame
             this->cyl_shader_progs = {
                 {GL_VERTEX_SHADER, "VisCyl.vert.glsl", mplot::getDefaultCylVtxShader(glver), 0 },
                 {GL_FRAGMENT_SHADER, "Visual.frag.glsl", mplot::getDefaultFragShader(glver), 0 }
             };
+            this->cyl_prog = mplot::gl::LoadShaders (this->cyl_shader_progs);
+            this->cyl_uniforms = this->setup_uniforms (this->cyl_prog);
+
+            // The unlit program, for models that need no lighting (see VisualModelBase::setUnlit)
+            this->unlit_shader_progs = {
+                {GL_VERTEX_SHADER, "VisualUnlit.vert.glsl", mplot::getDefaultUnlitVtxShader(glver), 0 },
+                {GL_FRAGMENT_SHADER, "VisualUnlit.frag.glsl", mplot::getDefaultUnlitFragShader(glver), 0 }
+            };
+            this->unlit_prog = mplot::gl::LoadShaders (this->unlit_shader_progs);
+            this->unlit_uniforms = this->setup_uniforms (this->unlit_prog);
+
+            this->shaders.gprog = this->proj2d_prog;
+            this->gprog_uniforms = this->proj2d_uniforms;
+            this->active_gprog = mplot::visgl::graphics_shader_type::projection2d;
 
             // A specific text shader is loaded for text rendering
             this->text_shader_progs = {
@@ -386,10 +1935,11 @@ namespace mplot {
                 {GL_FRAGMENT_SHADER, "VisText.frag.glsl" , mplot::getDefaultTextFragShader(glver), 0 }
             };
             this->shaders.tprog = mplot::gl::LoadShaders (this->text_shader_progs);
+            this->tprog_uniforms = this->setup_uniforms (this->shaders.tprog);
 
             // OpenGL options
             glEnable (GL_DEPTH_TEST);
-            glEnable (GL_BLEND);
+            mplot::gl::Util::set_blend (this->glstate, true);
             glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
             glDisable (GL_CULL_FACE);
             mplot::gl::Util::checkError (__FILE__, __LINE__);
@@ -415,28 +1965,50 @@ namespace mplot {
                 // No problem if we couldn't read /tmp/Visual.json
             }
 
+            this->releaseContext();
+        }
+
+        /*!
+         * The coordinate arrows and the title are made on first use (and their fonts loaded
+         * then), so a Visual that shows neither does no font work. Called by render() with the
+         * context current.
+         */
+        void make_coord_arrows()
+        {
+            mplot::startup_profile::scope startup_phase (this->startup, "coord arrows");
             // Use coordArrowsOffset to set the location of the CoordArrows *scene*
             this->coordArrows = std::make_unique<mplot::CoordArrows<glver>>();
+            this->coordarrows_bgcolour = { -1.0f, -1.0f, -1.0f, -1.0f };
             // For CoordArrows, because we don't add via Visual::addVisualModel(), we
             // have to set the get_shaderprogs function here:
             this->bindmodel (this->coordArrows);
+            this->coordArrows->x_label = this->coord_labels[0];
+            this->coordArrows->y_label = this->coord_labels[1];
+            this->coordArrows->z_label = this->coord_labels[2];
             // And NOW we can proceed to init:
             this->coordArrows->init (this->coordArrowsLength, this->coordArrowsThickness, this->coordArrowsEm); // sets up text
+            this->bind_overlays();
             this->coordArrows->finalize(); // VisualModel::finalize releases context (normally this is the right thing)...
             this->setContext();            // ...but we've got more work to do, so re-acquire context (if we're managing it)
-
             mplot::gl::Util::checkError (__FILE__, __LINE__);
+        }
 
-            // Set up the title, which may or may not be rendered
+        //! Set up the title text model (see make_coord_arrows)
+        void make_title()
+        {
+            mplot::startup_profile::scope startup_phase (this->startup, "title");
             mplot::TextFeatures title_tf(0.035f, 64);
             this->textModel = std::make_unique<mplot::VisualTextModel<glver>> (title_tf);
             this->bindmodel (this->textModel);
+            this->bind_overlays();
             this->textModel->setSceneTranslation ({0.0f, 0.0f, 0.0f});
             this->textModel->setupText (this->title);
-
-            this->releaseContext();
+            this->setContext();
         }
 
+        //! A Visual that manages its context binds the coordArrows and textModel to it here
+        virtual void bind_overlays() {}
+
         //! A VisualTextModel for a title text.
         std::unique_ptr<mplot::VisualTextModel<glver>> textModel = nullptr;
         //! Text models for labels
@@ -13,10 +13,17 @@
 #include <iostream>
 #include <tuple>
 #include <set>
+#include <map>
+#include <array>
+#include <cstddef>
 #include <stdexcept>
 #include <memory>
+#include <string>
+#include <functional>
 #include <mplot/gl/version.h>
+#include <mplot/VisualCommon.h>
 #include <mplot/VisualFont.h>
+#include <mplot/memory_report.h>
 // FreeType for text rendering
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -42,8 +49,51 @@ namespace mplot {
             for (auto& ft : this->freetypes) { FT_Done_FreeType (ft.second); }
         }
 
-        //! FreeType library object
-        std::map<mplot::VisualBase<glver>*, FT_Library> freetypes;
+        //! FreeType library objects, one for each context group
+        std::map<unsigned int, FT_Library> freetypes;
+
+        /*!
+         * The context group of each mplot::Visual. The Visuals of a group share their OpenGL
+         * contexts (their windows were created with a share window; see the VisualMX
+         * constructor that takes a Visual to share with), so the group needs only one FT_Library
+         * and one set of VisualFaces (with their glyph atlas textures), however many windows it
+         * has. A Visual that shares with no other is a group of one.
+         */
+        std::map<mplot::VisualBase<glver>*, unsigned int> groups;
+        //! The id for the next new context group (ids are not reused, unlike Visual addresses)
+        unsigned int next_group = 0;
+
+        //! A set of vertex buffers (indices, positions, normals and colours) shared by the models
+        //! whose meshes have the same visgl::mesh_key
+        struct shared_mesh
+        {
+            std::array<unsigned int, 4> /*GLuint*/ buffers = {};
+            unsigned int users = 0;
+        };
+        //! The mesh registry, from which VisualModels with identical meshes share buffers
+        std::map<visgl::mesh_key, shared_mesh> meshes;
+
+        //! One vertex buffer shared by the models whose buffers of that kind hold the same data
+        struct shared_buffer
+        {
+            unsigned int /*GLuint*/ buffer = 0;
+            unsigned int users = 0;
+        };
+        //! The geometry registry, from which VisualModels that draw the same grid (or other
+        //! geometry) share their index, position and normal buffers
+        std::map<visgl::buffer_key, shared_buffer> geometry;
+
+        //! Add _vis to the context group of _share or, if _share is null, to a new group of its own
+        void join_group (mplot::VisualBase<glver>* _vis, mplot::VisualBase<glver>* _share)
+        {
+            if (this->groups.count (_vis) > 0) { return; }
+            auto sg = _share == nullptr ? this->groups.end() : this->groups.find (_share);
+            this->groups[_vis] = sg == this->groups.end() ? this->next_group++ : sg->second;
+        }
+
+        //! Called as _vis leaves context group g. survivor is another member, or null if g is now empty.
+        virtual void leaving_group (mplot::VisualBase<glver>* _vis, mplot::VisualBase<glver>* survivor,
+                                    const unsigned int g) = 0;
 
     public:
         VisualResourcesBase(const VisualResourcesBase<glver>&) = delete;
@@ -57,14 +107,122 @@ namespace mplot {
 
         // Note: freetype_init function is in derived class
 
-        //! When a mplot::Visual goes out of scope, its freetype library instance should be
+        //! The context group of _vis (which must have called freetype_init)
+        unsigned int group_of (mplot::VisualBase<glver>* _vis) const { return this->groups.at (_vis); }
+
+        //! Set g to the context group of _vis. Returns false if _vis is in no group.
+        bool find_group (mplot::VisualBase<glver>* _vis, unsigned int& g) const
+        {
+            auto gi = this->groups.find (_vis);
+            if (gi == this->groups.end()) { return false; }
+            g = gi->second;
+            return true;
+        }
+
+        //! If a mesh with key k is registered, count one more user of it and return its buffers.
+        //! Otherwise return null.
+        const std::array<unsigned int, 4>* acquire_mesh (const visgl::mesh_key& k)
+        {
+            auto mi = this->meshes.find (k);
+            if (mi == this->meshes.end()) { return nullptr; }
+            ++mi->second.users;
+            return &mi->second.buffers;
+        }
+
+        //! Register the four buffers of a newly uploaded mesh with key k, with one user
+        void register_mesh (const visgl::mesh_key& k, const unsigned int* buffers)
+        {
+            shared_mesh& m = this->meshes[k];
+            for (std::size_t i = 0; i < m.buffers.size(); ++i) { m.buffers[i] = buffers[i]; }
+            m.users = 1;
+        }
+
+        //! Count one less user of the mesh with key k. Returns true if that was its last user, in
+        //! which case the mesh leaves the registry and its buffers belong to that user alone.
+        bool release_mesh (const visgl::mesh_key& k)
+        {
+            auto mi = this->meshes.find (k);
+            if (mi == this->meshes.end()) { return true; }
+            if (--mi->second.users > 0) { return false; }
+            this->meshes.erase (mi);
+            return true;
+        }
+
+        //! If a buffer with key k is registered, count one more user of it and return it.
+        //! Otherwise return null.
+        const unsigned int* acquire_buffer (const visgl::buffer_key& k)
+        {
+            auto bi = this->geometry.find (k);
+            if (bi == this->geometry.end()) { return nullptr; }
+            ++bi->second.users;
+            return &bi->second.buffer;
+        }
+
+        //! Register the newly uploaded buffer b with key k, with one user
+        void register_buffer (const visgl::buffer_key& k, const unsigned int b)
+        {
+            this->geometry[k] = shared_buffer{ b, 1u };
+        }
+
+        //! Count one less user of the buffer with key k. Returns true if that was its last user,
+        //! in which case the buffer leaves the registry and belongs to that user alone.
+        bool release_buffer (const visgl::buffer_key& k)
+        {
+            auto bi = this->geometry.find (k);
+            if (bi == this->geometry.end()) { return true; }
+            if (--bi->second.users > 0) { return false; }
+            this->geometry.erase (bi);
+            return true;
+        }
+
+        //! The number of buffers in the geometry registry
+        std::size_t geometry_buffers() const { return this->geometry.size(); }
+
+        /*!
+         * Add the buffers of the mesh and geometry registries of context group g to r, as shared
+         * GPU memory, with their numbers of users. buffer_bytes gives the size of a buffer (see
+         * mplot::gl::Util::buffer_bytes), so a context of group g must be current.
+         */
+        void add_shared_memory (mplot::memory_report& r, const unsigned int g,
+                                const std::function<std::size_t(unsigned int)>& buffer_bytes) const
+        {
+            for (const auto& m : this->meshes) {
+                if (std::get<0>(m.first) != g) { continue; }
+                const std::string n = "shared mesh (" + std::to_string (m.second.users) + " users)";
+                for (const auto b : m.second.buffers) { r.add_gpu (n, buffer_bytes (b), true, b); }
+            }
+            for (const auto& gb : this->geometry) {
+                if (std::get<0>(gb.first) != g) { continue; }
+                const std::string n = "shared buffer (" + std::to_string (gb.second.users) + " users)";
+                r.add_gpu (n, buffer_bytes (gb.second.buffer), true, gb.second.buffer);
+            }
+        }
+
+        //! The number of Visuals in context group g
+        std::size_t group_size (const unsigned int g) const
+        {
+            std::size_t n = 0;
+            for (const auto& m : this->groups) { if (m.second == g) { ++n; } }
+            return n;
+        }
+
+        //! When a mplot::Visual goes out of scope, it leaves its context group. When the last
+        //! Visual of a group goes, the group's faces and freetype library instance are
         //! deinitialized.
         void freetype_deinit (mplot::VisualBase<glver>* _vis)
         {
-            // First clear the faces associated with VisualBase<>* _vis
-            this->clearVisualFaces (_vis);
+            auto gi = this->groups.find (_vis);
+            if (gi == this->groups.end()) { return; }
+            const unsigned int g = gi->second;
+            this->groups.erase (gi);
+            mplot::VisualBase<glver>* survivor = nullptr;
+            for (const auto& m : this->groups) { if (m.second == g) { survivor = m.first; break; } }
+            this->leaving_group (_vis, survivor, g);
+            if (survivor != nullptr) { return; }
+            // First clear the faces of the group
+            this->clearVisualFaces (g);
             // Second, clean up the FreeType library instance and erase from this->freetypes
-            auto freetype = this->freetypes.find (_vis);
+            auto freetype = this->freetypes.find (g);
             if (freetype != this->freetypes.end()) {
                 FT_Done_FreeType (freetype->second);
                 this->freetypes.erase (freetype);
@@ -72,7 +230,7 @@ namespace mplot {
         }
 
         // Note: get/clearVisualFace functions are in derived classes
-        virtual void clearVisualFaces (mplot::VisualBase<glver>* _vis) = 0;
+        virtual void clearVisualFaces (const unsigned int g) = 0;
     };
 
 } // namespace mplot
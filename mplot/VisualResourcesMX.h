@@ -29,39 +29,68 @@ namespace mplot {
         ~VisualResourcesMX() { this->faces.clear(); }
 
         //! The collection of VisualFaces generated for this instance of the
-        //! application. Create one VisualFace for each unique combination of VisualFont
-        //! and fontpixels (the texture resolution)
-        std::map<std::tuple<mplot::VisualFont, unsigned int, mplot::VisualBase<glver>*>,
+        //! application. Create one VisualFace for each unique combination of VisualFont,
+        //! fontpixels (the texture resolution) and atlas type (bitmap or signed distance field)
+        //! in each context group
+        std::map<std::tuple<mplot::VisualFont, unsigned int, unsigned int, bool>,
                  std::unique_ptr<mplot::visgl::VisualFaceMX>> faces;
+
+        //! The GL function pointers of each Visual, with which a group's faces may be re-pointed
+        std::map<mplot::VisualBase<glver>*, GladGLContext*> glfns;
+
+        //! The faces of group g were made with the GL functions of _vis. If it leaves, they are
+        //! given those of the survivor (the group's contexts share their textures).
+        void leaving_group (mplot::VisualBase<glver>* _vis, mplot::VisualBase<glver>* survivor,
+                            const unsigned int g) final
+        {
+            auto gf = this->glfns.find (_vis);
+            GladGLContext* old_glfn = gf == this->glfns.end() ? nullptr : gf->second;
+            if (gf != this->glfns.end()) { this->glfns.erase (gf); }
+            if (survivor == nullptr || old_glfn == nullptr) { return; }
+            for (auto& f : this->faces) {
+                if (std::get<2>(f.first) == g && f.second->get_glfn() == old_glfn) {
+                    f.second->set_glfn (this->glfns.at (survivor));
+                }
+            }
+        }
     public:
         VisualResourcesMX(const VisualResourcesMX<glver>&) = delete;
         VisualResourcesMX& operator=(const VisualResourcesMX<glver> &) = delete;
         VisualResourcesMX(VisualResourcesMX<glver> &&) = delete;
         VisualResourcesMX & operator=(VisualResourcesMX<glver> &&) = delete;
 
-        //! Initialize a freetype library instance and add to this->freetypes. I wanted
+        //! Register _vis in its context group (that of _share, if given). The group's freetype
+        //! library instance is made later, by freetype_of. I wanted
         //! to have only a single freetype library instance, but this didn't work, so I
-        //! create one FT_Library for each OpenGL context (i.e. one for each mplot::Visual
-        //! window). Thus, arguably, the FT_Library should be a member of mplot::Visual,
+        //! create one FT_Library for each group of OpenGL contexts (i.e. one for each
+        //! mplot::Visual window, unless windows were created sharing a context with another
+        //! Visual, _share). Thus, arguably, the FT_Library should be a member of mplot::Visual,
         //! but that's a task for the future, as I coded it this way under the false
         //! assumption that I'd only need one FT_Library.
-        void freetype_init (mplot::VisualBase<glver>* _vis, GladGLContext* glfn = nullptr)
+        void freetype_init (mplot::VisualBase<glver>* _vis, GladGLContext* glfn = nullptr,
+                            mplot::VisualBase<glver>* _share = nullptr)
         {
+            this->join_group (_vis, _share);
+            this->glfns[_vis] = glfn;
+        }
+
+        //! The FT_Library of context group g, which is initialized when the group's first face
+        //! is made (so that a Visual with no text does no FreeType work)
+        FT_Library& freetype_of (const unsigned int g, GladGLContext* glfn)
+        {
+            auto fi = this->freetypes.find (g);
+            if (fi != this->freetypes.end()) { return fi->second; }
+            // Use of gl calls here may make it neat to set up GL here in VisualResources?
+            glfn->PixelStorei(GL_UNPACK_ALIGNMENT, 1); // disable byte-alignment restriction
+            mplot::gl::Util::checkError (__FILE__, __LINE__, glfn);
+
             FT_Library freetype = nullptr;
-            try {
-                freetype = this->freetypes.at (_vis);
-            } catch (const std::out_of_range&) {
-                // Use of gl calls here may make it neat to set up GL here in VisualResources?
-                glfn->PixelStorei(GL_UNPACK_ALIGNMENT, 1); // disable byte-alignment restriction
-                mplot::gl::Util::checkError (__FILE__, __LINE__, glfn);
-
-                if (FT_Init_FreeType (&freetype)) {
-                    std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
-                } else {
-                    // Successfully initialized freetype
-                    this->freetypes[_vis] = freetype;
-                }
+            if (FT_Init_FreeType (&freetype)) {
+                std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+                throw std::runtime_error ("VisualResources: Could not init FreeType Library");
             }
+            // Successfully initialized freetype
+            return this->freetypes[g] = freetype;
         }
 
         //! The instance public function. Uses the very short name 'i' to keep code tidy.
@@ -76,16 +105,21 @@ namespace mplot {
         void create() final {}
 
         //! Return a pointer to a VisualFace for the given \a font at the given texture
-        //! resolution, \a fontpixels and the given window (i.e. OpenGL context) \a _win.
+        //! resolution, \a fontpixels and the given window (i.e. OpenGL context) \a _win. The
+        //! VisualFace is shared by all the Visuals in the context group of _vis.
         mplot::visgl::VisualFaceMX* getVisualFace (mplot::VisualFont font, unsigned int fontpixels,
-                                                   mplot::VisualBase<glver>* _vis, GladGLContext* glfn)
+                                                   mplot::VisualBase<glver>* _vis, GladGLContext* glfn,
+                                                   const bool sdf = false)
         {
             mplot::visgl::VisualFaceMX* rtn = nullptr;
-            auto key = std::make_tuple(font, fontpixels, _vis);
+            const unsigned int g = this->group_of (_vis);
+            auto key = std::make_tuple(font, fontpixels, g, sdf);
             try {
                 rtn = this->faces.at(key).get();
             } catch (const std::out_of_range&) {
-                this->faces[key] = std::make_unique<mplot::visgl::VisualFaceMX> (font, fontpixels, this->freetypes.at(_vis), glfn);
+                // Making the face rasterizes its Latin-1 glyphs (see mplot::startup_profile)
+                mplot::startup_profile::counter_scope startup_count (mplot::startup_profile::glyph_ns());
+                this->faces[key] = std::make_unique<mplot::visgl::VisualFaceMX> (font, fontpixels, this->freetype_of (g, glfn), glfn, sdf);
                 rtn = this->faces.at(key).get();
             }
             return rtn;
@@ -94,16 +128,40 @@ namespace mplot {
         mplot::visgl::VisualFaceMX* getVisualFace (const mplot::TextFeatures& tf,
                                                    mplot::VisualBase<glver>* _vis, GladGLContext* glfn)
         {
-            return this->getVisualFace (tf.font, tf.fontres, _vis, glfn);
+            return this->getVisualFace (tf.font, tf.face_res(), _vis, glfn, tf.sdf);
+        }
+
+        /*!
+         * The memory held by the faces of the context group of _vis, each a child of the report,
+         * and by the group's shared meshes and buffers. The context of _vis must be current.
+         */
+        mplot::memory_report get_memory_report (mplot::VisualBase<glver>* _vis) const
+        {
+            mplot::memory_report r;
+            r.name = "VisualResources";
+            unsigned int g = 0;
+            if (!this->find_group (_vis, g)) { return r; }
+            for (const auto& f : this->faces) {
+                if (std::get<2>(f.first) != g) { continue; }
+                mplot::memory_report fr = f.second->get_memory_report();
+                fr.name = "face " + std::to_string (std::get<1>(f.first)) + "px" + (std::get<3>(f.first) ? " sdf" : "");
+                r.children.push_back (std::move (fr));
+            }
+            auto gf = this->glfns.find (_vis);
+            if (gf != this->glfns.end() && gf->second != nullptr) {
+                GladGLContext* glfn = gf->second;
+                this->add_shared_memory (r, g, [glfn](const unsigned int b) { return mplot::gl::Util::buffer_bytes (b, glfn); });
+            }
+            return r;
         }
 
-        //! Loop through this->faces clearing out those associated with the given mplot::Visual
-        void clearVisualFaces (mplot::VisualBase<glver>* _vis) final
+        //! Loop through this->faces clearing out those of the context group g
+        void clearVisualFaces (const unsigned int g) final
         {
             auto f = this->faces.begin();
             while (f != this->faces.end()) {
-                // f->first is a key. If its third, Visual<>* element == _vis, then delete and erase
-                if (std::get<mplot::VisualBase<glver>*>(f->first) == _vis) {
+                // f->first is a key. If its third, group element == g, then delete and erase
+                if (std::get<2>(f->first) == g) {
                     f = this->faces.erase (f);
                 } else { f++; }
             }
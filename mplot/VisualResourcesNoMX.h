@@ -32,10 +32,14 @@ namespace mplot {
         ~VisualResourcesNoMX() { this->faces.clear(); }
 
         //! The collection of VisualFaces generated for this instance of the
-        //! application. Create one VisualFace for each unique combination of VisualFont
-        //! and fontpixels (the texture resolution)
-        std::map<std::tuple<mplot::VisualFont, unsigned int, mplot::VisualBase<glver>*>,
+        //! application. Create one VisualFace for each unique combination of VisualFont,
+        //! fontpixels (the texture resolution) and atlas type (bitmap or signed distance field)
+        //! in each context group
+        std::map<std::tuple<mplot::VisualFont, unsigned int, unsigned int, bool>,
                  std::unique_ptr<mplot::visgl::VisualFaceNoMX>> faces;
+
+        //! The faces use the global GL functions, so nothing changes as a Visual leaves its group
+        void leaving_group (mplot::VisualBase<glver>*, mplot::VisualBase<glver>*, const unsigned int) final {}
     public:
         VisualResourcesNoMX(const VisualResourcesNoMX<glver>&) = delete;
         VisualResourcesNoMX& operator=(const VisualResourcesNoMX<glver> &) = delete;
@@ -53,41 +57,53 @@ namespace mplot {
         //! A function to call to simply make sure the singleton instance exists
         void create() final {}
 
-        //! Initialize a freetype library instance and add to this->freetypes. I wanted
+        //! Register _vis in its context group (that of _share, if given). The group's freetype
+        //! library instance is made later, by freetype_of. I wanted
         //! to have only a single freetype library instance, but this didn't work, so I
-        //! create one FT_Library for each OpenGL context (i.e. one for each mplot::Visual
-        //! window). Thus, arguably, the FT_Library should be a member of mplot::Visual,
+        //! create one FT_Library for each group of OpenGL contexts (i.e. one for each
+        //! mplot::Visual window, unless windows were created sharing a context with another
+        //! Visual, _share). Thus, arguably, the FT_Library should be a member of mplot::Visual,
         //! but that's a task for the future, as I coded it this way under the false
         //! assumption that I'd only need one FT_Library.
-        void freetype_init (mplot::VisualBase<glver>* _vis)
+        void freetype_init (mplot::VisualBase<glver>* _vis, mplot::VisualBase<glver>* _share = nullptr)
+        {
+            this->join_group (_vis, _share);
+        }
+
+        //! The FT_Library of context group g, which is initialized when the group's first face
+        //! is made (so that a Visual with no text does no FreeType work)
+        FT_Library& freetype_of (const unsigned int g)
         {
+            auto fi = this->freetypes.find (g);
+            if (fi != this->freetypes.end()) { return fi->second; }
+            // Use of gl calls here may make it neat to set up GL here in VisualResources?
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // disable byte-alignment restriction
+            mplot::gl::Util::checkError (__FILE__, __LINE__);
+
             FT_Library freetype = nullptr;
-            try {
-                freetype = this->freetypes.at (_vis);
-            } catch (const std::out_of_range&) {
-                // Use of gl calls here may make it neat to set up GL here in VisualResources?
-                glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // disable byte-alignment restriction
-                mplot::gl::Util::checkError (__FILE__, __LINE__);
-
-                if (FT_Init_FreeType (&freetype)) {
-                    std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
-                } else {
-                    // Successfully initialized freetype
-                    this->freetypes[_vis] = freetype;
-                }
+            if (FT_Init_FreeType (&freetype)) {
+                std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+                throw std::runtime_error ("VisualResources: Could not init FreeType Library");
             }
+            // Successfully initialized freetype
+            return this->freetypes[g] = freetype;
         }
 
         //! Return a pointer to a VisualFace for the given \a font at the given texture
-        //! resolution, \a fontpixels and the given window (i.e. OpenGL context) \a _win.
-        mplot::visgl::VisualFaceNoMX* getVisualFace (mplot::VisualFont font, unsigned int fontpixels, mplot::VisualBase<glver>* _vis)
+        //! resolution, \a fontpixels and the given window (i.e. OpenGL context) \a _win. The
+        //! VisualFace is shared by all the Visuals in the context group of _vis.
+        mplot::visgl::VisualFaceNoMX* getVisualFace (mplot::VisualFont font, unsigned int fontpixels, mplot::VisualBase<glver>* _vis,
+                                                     const bool sdf = false)
         {
             mplot::visgl::VisualFaceNoMX* rtn = nullptr;
-            auto key = std::make_tuple(font, fontpixels, _vis);
+            const unsigned int g = this->group_of (_vis);
+            auto key = std::make_tuple(font, fontpixels, g, sdf);
             try {
                 rtn = this->faces.at(key).get();
             } catch (const std::out_of_range&) {
-                this->faces[key] = std::make_unique<mplot::visgl::VisualFaceNoMX> (font, fontpixels, this->freetypes.at(_vis));
+                // Making the face rasterizes its Latin-1 glyphs (see mplot::startup_profile)
+                mplot::startup_profile::counter_scope startup_count (mplot::startup_profile::glyph_ns());
+                this->faces[key] = std::make_unique<mplot::visgl::VisualFaceNoMX> (font, fontpixels, this->freetype_of (g), sdf);
                 rtn = this->faces.at(key).get();
             }
             return rtn;
@@ -95,16 +111,36 @@ namespace mplot {
 
         mplot::visgl::VisualFaceNoMX* getVisualFace (const mplot::TextFeatures& tf, mplot::VisualBase<glver>* _vis)
         {
-            return this->getVisualFace (tf.font, tf.fontres, _vis);
+            return this->getVisualFace (tf.font, tf.face_res(), _vis, tf.sdf);
+        }
+
+        /*!
+         * The memory held by the faces of the context group of _vis, each a child of the report,
+         * and by the group's shared meshes and buffers. The context of _vis must be current.
+         */
+        mplot::memory_report get_memory_report (mplot::VisualBase<glver>* _vis) const
+        {
+            mplot::memory_report r;
+            r.name = "VisualResources";
+            unsigned int g = 0;
+            if (!this->find_group (_vis, g)) { return r; }
+            for (const auto& f : this->faces) {
+                if (std::get<2>(f.first) != g) { continue; }
+                mplot::memory_report fr = f.second->get_memory_report();
+                fr.name = "face " + std::to_string (std::get<1>(f.first)) + "px" + (std::get<3>(f.first) ? " sdf" : "");
+                r.children.push_back (std::move (fr));
+            }
+            this->add_shared_memory (r, g, [](const unsigned int b) { return mplot::gl::Util::buffer_bytes (b); });
+            return r;
         }
 
-        //! Loop through this->faces clearing out those associated with the given mplot::Visual
-        void clearVisualFaces (mplot::VisualBase<glver>* _vis) final
+        //! Loop through this->faces clearing out those of the context group g
+        void clearVisualFaces (const unsigned int g) final
         {
             auto f = this->faces.begin();
             while (f != this->faces.end()) {
-                // f->first is a key. If its third, Visual<>* element == _vis, then delete and erase
-                if (std::get<mplot::VisualBase<glver>*>(f->first) == _vis) {
+                // f->first is a key. If its third, group element == g, then delete and erase
+                if (std::get<2>(f->first) == g) {
                     f = this->faces.erase (f);
                 } else { f++; }
             }
@@ -28,3 +28,15 @@ namespace mplot {
             : mplot::VisualTextModelImpl<glver, mplot::gl::multicontext>::VisualTextModelImpl(_tf) {}
     };
 } // namespace mplot
+
+#if defined MPLOT_CORE && defined GLAD_OPTION_GL_MX
+// Instantiated once, in the compiled mplot_core library (see core/visual.cpp)
+namespace mplot {
+    extern template struct VisualTextModelBase<mplot::gl::version_4_1>;
+    extern template struct VisualTextModelBase<mplot::gl::version_4_5>;
+    extern template class VisualTextModelImpl<mplot::gl::version_4_1, 1>;
+    extern template class VisualTextModelImpl<mplot::gl::version_4_5, 1>;
+    extern template struct VisualTextModel<mplot::gl::version_4_1>;
+    extern template struct VisualTextModel<mplot::gl::version_4_5>;
+} // namespace mplot
+#endif
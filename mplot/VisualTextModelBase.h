@@ -15,7 +15,9 @@
 #include <array>
 #include <map>
 #include <limits>
+#include <algorithm>
 #include <memory>
+#include <stdexcept>
 
 #include <mplot/gl/version.h>
 
@@ -29,6 +31,9 @@
 #include <mplot/TextGeometry.h>
 #include <mplot/TextFeatures.h>
 #include <mplot/colour.h>
+#include <mplot/console_ring.h>
+#include <mplot/label_declutter.h>
+#include <mplot/memory_report.h>
 
 namespace mplot {
 
@@ -45,7 +50,7 @@ namespace mplot {
         VisualTextModelBase (mplot::TextFeatures _tfeatures)
         {
             this->tfeatures = _tfeatures;
-            this->fontscale = tfeatures.fontsize / static_cast<float>(tfeatures.fontres);
+            this->fontscale = tfeatures.fontsize / static_cast<float>(tfeatures.face_res());
         }
 
         virtual ~VisualTextModelBase() {}
@@ -64,15 +69,22 @@ namespace mplot {
         void setViewMatrix (const sm::mat44<float>& mv) { this->viewmatrix = mv; }
 
         //! Setter for VisualTextModel::scenematrix, the scene view
-        void setSceneMatrix (const sm::mat44<float>& sv) { this->scenematrix = sv; }
+        void setSceneMatrix (const sm::mat44<float>& sv)
+        {
+            this->scenematrix = sv;
+            this->scene_from_offset = false;
+        }
 
-        //! Set the translation specified by \a v0 into the scene translation
+        //! Set the translation specified by \a v0 into the scene translation. Visual does this
+        //! for its texts on every frame, so an unchanged translation returns at once.
         void setSceneTranslation (const sm::vec<float>& v0)
         {
+            if (this->scene_from_offset && v0 == this->sv_offset) { return; }
             this->sv_offset = v0;
             this->scenematrix.setToIdentity();
             this->scenematrix.translate (this->sv_offset);
             this->scenematrix.prerotate (this->sv_rotation);
+            this->scene_from_offset = true;
         }
 
         //! Set a translation (only) into the scene view matrix
@@ -80,6 +92,7 @@ namespace mplot {
         {
             this->sv_offset += v0;
             this->scenematrix.translate (v0);
+            this->scene_from_offset = false;
         }
 
         //! Set a rotation (only) into the scene view matrix
@@ -91,6 +104,7 @@ namespace mplot {
             this->scenematrix.translate (this->sv_offset);
             //std::cout << "Rotate by sv_rotn: "  << sv_rotation << std::endl;
             this->scenematrix.prerotate (this->sv_rotation);
+            this->scene_from_offset = true;
         }
 
         //! Add a rotation to the scene view matrix
@@ -98,6 +112,7 @@ namespace mplot {
         {
             this->sv_rotation.premultiply (r);
             this->scenematrix.prerotate (r);
+            this->scene_from_offset = false;
         }
 
         //! Set a translation to the model view matrix
@@ -141,9 +156,116 @@ namespace mplot {
         //! Return the geometry for the stored txt
         virtual mplot::TextGeometry getTextGeometry() = 0;
 
+        //! Compute the geometries of several texts, such as a set of tick labels, in one call
+        std::vector<mplot::TextGeometry> getTextGeometries (const std::vector<std::string>& txts)
+        {
+            std::vector<mplot::TextGeometry> geoms;
+            geoms.reserve (txts.size());
+            for (const auto& t : txts) { geoms.push_back (this->getTextGeometry (t)); }
+            return geoms;
+        }
+
+        //! The font features with which this text model was made
+        const mplot::TextFeatures& getFeatures() const { return this->tfeatures; }
+
+        //! Make the text face the camera (or not), as TextFeatures::billboard does
+        void setBillboard (const bool b = true)
+        {
+            this->tfeatures.billboard = b;
+            if (this->requestRedraw != nullptr && this->parentVis != nullptr) { this->requestRedraw (this->parentVis); }
+        }
+        bool getBillboard() const { return this->tfeatures.billboard; }
+
+        //! Set the priority with which the text is kept when it overlaps others (see TextFeatures::priority)
+        void setPriority (const float pr) { this->tfeatures.priority = pr; }
+        float getPriority() const { return this->tfeatures.priority; }
+
+        //! True if no quads have been set up for the text
+        bool empty() const { return this->quads.empty(); }
+
+        //! The model view offset, as set by setupText or setViewTranslation
+        const sm::vec<float>& getViewTranslation() const { return this->mv_offset; }
+
+        //! The model view rotation, as set by setupText or setViewRotation
+        const sm::quaternion<float>& getViewRotation() const { return this->mv_rotation; }
+
+        //! Clear the model view offset and rotation, ready for a fresh setupText()
+        void resetView()
+        {
+            this->mv_offset = { 0.0f };
+            this->mv_rotation = {};
+            this->viewmatrix.setToIdentity();
+        }
+
+        //! True if this text model is a console (see setupConsole)
+        bool is_console() const { return this->console.capacity() > 0u; }
+
+        /*!
+         * Append a line (or several, if _line contains newlines) to a console. Only the quads of
+         * the new lines are written, into their slots of the console's buffers, at the next
+         * render; the oldest lines are overwritten once the console is full.
+         */
+        void appendLine (const std::string& _line)
+        {
+            this->console.append (mplot::unicode::fromUtf8 (_line));
+            if (this->requestRedraw != nullptr && this->parentVis != nullptr) { this->requestRedraw (this->parentVis); }
+        }
+
+        //! Scroll the console back to show the lines that end lines_back before the newest (0
+        //! follows the newest). Nothing is uploaded; the lines are chosen at the draw.
+        void scrollConsole (const std::size_t lines_back)
+        {
+            this->console.scroll_back (lines_back);
+            if (this->requestRedraw != nullptr && this->parentVis != nullptr) { this->requestRedraw (this->parentVis); }
+        }
+
+        //! The lines of a console
+        const mplot::console_ring& getConsole() const { return this->console; }
+
         float width() const { return this->extents[1] - this->extents[0]; }
         float height() const { return this->extents[3] - this->extents[2]; }
 
+        /*!
+         * Extend the box from mn to mx (in normalized device coordinates) to hold the corners of
+         * this text's extents, as projected by p and the text's scene and view matrices (see
+         * VisualModel::screen_bounds). Returns false if the text's place on the screen is not
+         * known (a corner lies behind the camera, or the text is a console, whose lines move).
+         */
+        bool clip_bounds (const sm::mat44<float>& p, sm::vec<float, 2>& mn, sm::vec<float, 2>& mx) const
+        {
+            if (this->is_console()) { return false; }
+            // No quads, so nothing is drawn
+            if (this->extents[0] > this->extents[1]) { return true; }
+            const sm::mat44<float> mvp = p * this->scenematrix * this->viewmatrix;
+            // A billboard's corners are offset from its origin in the eye frame (see VisText.vert.glsl)
+            const sm::mat44<float> sv = this->scenematrix * this->viewmatrix;
+            const sm::vec<float, 4> anchor = sv * sm::vec<float, 4>{ 0.0f, 0.0f, 0.0f, 1.0f };
+            for (unsigned int c = 0; c < 4; ++c) {
+                const sm::vec<float, 4> corner = { this->extents[(c & 1) ? 1 : 0], this->extents[(c & 2) ? 3 : 2], 0.0f, 1.0f };
+                sm::vec<float, 4> q = mvp * corner;
+                if (this->tfeatures.billboard) {
+                    q = p * sm::vec<float, 4>{ anchor[0] + corner[0] * anchor[3], anchor[1] + corner[1] * anchor[3], anchor[2], anchor[3] };
+                }
+                if (q[3] <= 0.0f) { return false; }
+                const sm::vec<float, 2> ndc = { q[0] / q[3], q[1] / q[3] };
+                mn = { std::min (mn[0], ndc[0]), std::min (mn[1], ndc[1]) };
+                mx = { std::max (mx[0], ndc[0]), std::max (mx[1], ndc[1]) };
+            }
+            return true;
+        }
+
+        //! Set b to the text's rectangle in a framebuffer of size dims, projected by p, and its
+        //! priority, for a label_declutter (see VisualModel::update_declutter)
+        void declutter_box (const sm::mat44<float>& p, const sm::vec<int, 2>& dims, mplot::label_box& b) const
+        {
+            sm::vec<float, 2> mn = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+            sm::vec<float, 2> mx = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+            b.priority = this->tfeatures.priority;
+            b.known = this->clip_bounds (p, mn, mx);
+            // A text with no quads leaves mn and mx as they were and draws nothing
+            b.r = (b.known && mn[0] <= mx[0]) ? mplot::screen_rect::from_ndc (mn, mx, dims, 0) : mplot::screen_rect{};
+        }
+
         std::string getText() const
         {
             std::string s = {};
@@ -192,11 +314,13 @@ namespace mplot {
                 this->vertex_push (quad[6], quad[7],  quad[8],  this->vertexPositions); //3
                 this->vertex_push (quad[9], quad[10], quad[11], this->vertexPositions); //4
 
-                // Add the info for drawing the textures on the quads
-                this->vertex_push (0.0f, 1.0f, 0.0f, this->vertexTextures);
-                this->vertex_push (0.0f, 0.0f, 0.0f, this->vertexTextures);
-                this->vertex_push (1.0f, 0.0f, 0.0f, this->vertexTextures);
-                this->vertex_push (1.0f, 1.0f, 0.0f, this->vertexTextures);
+                // Add the info for drawing the textures on the quads. uv is the glyph's
+                // rectangle in the atlas: left, top, right, bottom.
+                const sm::vec<float, 4>& uv = this->quad_uvs[qi];
+                this->vertex_push (uv[0], uv[3], 0.0f, this->vertexTextures);
+                this->vertex_push (uv[0], uv[1], 0.0f, this->vertexTextures);
+                this->vertex_push (uv[2], uv[1], 0.0f, this->vertexTextures);
+                this->vertex_push (uv[2], uv[3], 0.0f, this->vertexTextures);
 
                 // All same colours
                 this->vertex_push (this->clr_backing, this->vertexColors);
@@ -227,6 +351,20 @@ namespace mplot {
         //! Common code to call after the vertices have been set up.
         virtual void postVertexInit() = 0;
 
+        //! The positions and texture coordinates of the vertices of this->quads, as
+        //! initializeVertices lays them out, for a console's updates of its buffers
+        void console_vertices (std::vector<float>& posns, std::vector<float>& uvs) const
+        {
+            posns.resize (12u * this->quads.size());
+            uvs.resize (12u * this->quads.size());
+            for (std::size_t qi = 0; qi < this->quads.size(); ++qi) {
+                std::copy (this->quads[qi].begin(), this->quads[qi].end(), posns.begin() + 12u * qi);
+                const sm::vec<float, 4>& uv = this->quad_uvs[qi];
+                const std::array<float, 12> t = { uv[0], uv[3], 0.0f, uv[0], uv[1], 0.0f, uv[2], uv[1], 0.0f, uv[2], uv[3], 0.0f };
+                std::copy (t.begin(), t.end(), uvs.begin() + 12u * qi);
+            }
+        }
+
     public:
         //! The colour of the text
         std::array<float, 3> clr_text = {0.0f, 0.0f, 0.0f};
@@ -243,11 +381,21 @@ namespace mplot {
         std::function<GLuint(mplot::VisualBase<glver>*)> get_gprog;
         //! Get the text shader prog id
         std::function<GLuint(mplot::VisualBase<glver>*)> get_tprog;
+        //! Get the uniform locations in the graphics shader prog
+        std::function<const mplot::visgl::shader_uniforms&(mplot::VisualBase<glver>*)> get_gprog_uniforms;
+        //! Get the uniform locations in the text shader prog
+        std::function<const mplot::visgl::shader_uniforms&(mplot::VisualBase<glver>*)> get_tprog_uniforms;
+        //! Get the parent Visual's record of the current GL render state
+        std::function<mplot::visgl::render_state&(mplot::VisualBase<glver>*)> get_render_state;
+        //! Get the parent Visual's pool of the GL names and vertex vectors of deleted text models
+        std::function<mplot::visgl::text_model_pool&(mplot::VisualBase<glver>*)> get_text_pool;
 
         //! Set OpenGL context. Should call parentVis->setContext().
         std::function<void(mplot::VisualBase<glver>*)> setContext;
         //! Release OpenGL context. Should call parentVis->releaseContext().
         std::function<void(mplot::VisualBase<glver>*)> releaseContext;
+        //! Flag that the scene needs rendering. Should call parentVis->requestRedraw().
+        std::function<void(mplot::VisualBase<glver>*)> requestRedraw;
 
         //! Setter for the parent pointer, parentVis
         void set_parent (mplot::VisualBase<glver>* _vis)
@@ -256,17 +404,132 @@ namespace mplot {
             this->parentVis = _vis;
         }
 
+    protected:
+        //! Add bytes to the parent Visual's count of the bytes uploaded to GL buffers
+        void count_upload (const std::size_t bytes)
+        {
+            if (this->get_render_state && this->parentVis != nullptr) {
+                this->get_render_state (this->parentVis).counts.bytes_uploaded += bytes;
+            }
+        }
+
+        //! The parent Visual's pool of text model storage, or nullptr if this is not bound to one
+        mplot::visgl::text_model_pool* text_pool()
+        {
+            if (!this->get_text_pool || this->parentVis == nullptr) { return nullptr; }
+            return &this->get_text_pool (this->parentVis);
+        }
+
+        //! Take the vertex array object and buffers of a deleted text model from the pool, if
+        //! it has any, for this text model (which has none yet)
+        bool take_names()
+        {
+            mplot::visgl::text_model_pool* pool = this->text_pool();
+            mplot::visgl::text_model_pool::gl_names n;
+            if (pool == nullptr || !pool->names.take (n)) { return false; }
+            this->vao = n.vao;
+            this->vbos = std::make_unique<GLuint[]>(this->numVBO);
+            for (int i = 0; i < this->numVBO; ++i) { this->vbos[i] = n.vbos[i]; }
+            return true;
+        }
+
+        //! Give this text model's vertex array object and buffers to the pool. Returns false if
+        //! the pool is full (or there is none), in which case the caller must delete them.
+        bool give_names()
+        {
+            mplot::visgl::text_model_pool* pool = this->text_pool();
+            if (pool == nullptr) { return false; }
+            mplot::visgl::text_model_pool::gl_names n;
+            n.vao = this->vao;
+            for (int i = 0; i < this->numVBO; ++i) { n.vbos[i] = this->vbos[i]; }
+            return pool->names.put (std::move (n));
+        }
+
+        //! Empty the CPU-side vertex vectors, ready for initializeVertices, giving any that have
+        //! no storage the storage of those of a deleted text model
+        void clear_vertex_storage()
+        {
+            this->vertexPositions.clear();
+            this->vertexNormals.clear();
+            this->vertexColors.clear();
+            this->vertexTextures.clear();
+            this->indices.clear();
+            mplot::visgl::text_model_pool* pool = this->text_pool();
+            if (pool == nullptr) { return; }
+            pool->take (this->vertexPositions);
+            pool->take (this->vertexNormals);
+            pool->take (this->vertexColors);
+            pool->take (this->vertexTextures);
+            pool->take (this->indices);
+        }
+
+        //! Once the vertices are in the GL buffers, give the storage of the CPU-side vertex
+        //! vectors back to the pool for the next text model (or free it)
+        void release_vertex_storage()
+        {
+            mplot::visgl::text_model_pool* pool = this->text_pool();
+            if (pool == nullptr) {
+                std::vector<float>().swap (this->vertexPositions);
+                std::vector<float>().swap (this->vertexNormals);
+                std::vector<float>().swap (this->vertexColors);
+                std::vector<float>().swap (this->vertexTextures);
+                std::vector<GLuint>().swap (this->indices);
+                return;
+            }
+            pool->give (this->vertexPositions);
+            pool->give (this->vertexNormals);
+            pool->give (this->vertexColors);
+            pool->give (this->vertexTextures);
+            pool->give (this->indices);
+        }
+
+    public:
+        //! The size in bytes of the GL buffer buf (see mplot::gl::Util::buffer_bytes)
+        virtual std::size_t gpu_buffer_bytes (const GLuint buf) const = 0;
+
+        //! The memory held by this text model: its vertex vectors and quads, and its buffers
+        mplot::memory_report get_memory_report() const
+        {
+            mplot::memory_report r;
+            r.name = "text";
+            r.add_vector ("quads", this->quads);
+            r.add_vector ("quad_uvs", this->quad_uvs);
+            r.add_vector ("indices", this->indices);
+            r.add_vector ("vertexPositions", this->vertexPositions);
+            r.add_vector ("vertexNormals", this->vertexNormals);
+            r.add_vector ("vertexColors", this->vertexColors);
+            r.add_vector ("vertexTextures", this->vertexTextures);
+            r.add_vector ("batch_txts", this->batch_txts);
+            r.add_vector ("batch_offsets", this->batch_offsets);
+            if (this->vbos != nullptr) {
+                const char* names[numVBO] = { "posnVBO", "normVBO", "colVBO", "idxVBO", "textureVBO" };
+                for (int i = 0; i < numVBO; ++i) { r.add_gpu (names[i], this->gpu_buffer_bytes (this->vbos[i])); }
+            }
+            return r;
+        }
+
     protected:
         // The text features for this VisualTextModel
         mplot::TextFeatures tfeatures;
 
+        //! Scale a face's text_metrics (in pixels) into a TextGeometry in model units
+        template <typename M>
+        mplot::TextGeometry scaled_geometry (const M& m) const
+        {
+            mplot::TextGeometry geom;
+            geom.total_advance = m.advance * this->fontscale;
+            geom.max_bearingy = m.max_bearingy * this->fontscale;
+            geom.max_drop = m.max_drop * this->fontscale;
+            return geom;
+        }
+
         // face is in derived class
 
         //! The colour of the backing quad's vertices. Doesn't have any effect.
         std::array<float, 3> clr_backing = {1.0f, 1.0f, 0.0f};
 
         //! A scaling factor based on the desired width of an 'm'
-        float fontscale = 1.0f; //  fontscale = tfeatures.fontsize/(float)tfeatures.fontres;
+        float fontscale = 1.0f; //  fontscale = tfeatures.fontsize/(float)tfeatures.face_res();
 
         //! model-view offset within the scene. Any model-view offset of the parent
         //! object should be incorporated into this offset. That is, if this
@@ -286,6 +549,8 @@ namespace mplot {
         sm::vec<float> sv_offset = { 0.0f };
         //! Scene view rotation
         sm::quaternion<float> sv_rotation = {};
+        //! True if scenematrix is the translation sv_offset and rotation sv_rotation
+        bool scene_from_offset = false;
         //! The text-model-specific view matrix and a scene matrix
         sm::mat44<float> viewmatrix = {};
         //! Before, I wrote: We protect the scene matrix as updating it with the parent
@@ -296,14 +561,24 @@ namespace mplot {
 
         //! The text string stored for debugging
         std::basic_string<char32_t> txt;
+        //! The texts and their offsets, if this model was set up with setupTexts
+        std::vector<std::basic_string<char32_t>> batch_txts;
+        std::vector<sm::vec<float>> batch_offsets;
+        //! The lines of a console (see setupConsole), the number of them shown and their spacing
+        mplot::console_ring console;
+        std::size_t console_rows = 0;
+        float console_line_height = 0.0f;
         //! The Quads that form the 'medium' for the text textures. 12 float = 4 corners
         std::vector<std::array<float,12>> quads = {};
         //! left, right, top and bottom extents of the text for this
         //! VisualTextModel. setupText should modify these as it sets up quads. Order of
         //! numbers is left, right, bottom, top
         sm::vec<float, 4> extents = { 1e7, -1e7, 1e7, -1e7 };
-        //! The texture ID for each quad - so that we draw the right texture image over each quad.
-        std::vector<unsigned int> quad_ids = {};
+        //! The atlas texture coordinates for each quad (left, top, right, bottom)
+        std::vector<sm::vec<float, 4>> quad_uvs = {};
+        //! The VisualFace::generation that the quads were set up with. If the face's atlas
+        //! changes, the quads are set up again.
+        unsigned int face_generation = 0;
         //! Position within vertex buffer object (if I use an array of VBO)
         enum VBOPos { posnVBO, normVBO, colVBO, idxVBO, textureVBO, numVBO };
         //! The OpenGL Vertex Array Object
@@ -312,8 +587,13 @@ namespace mplot {
         GLuint vbo = 0;
         //! Vertex Buffer Objects stored in an array
         std::unique_ptr<GLuint[]> vbos;
-        //! CPU-side data for indices
+        //! CPU-side data for indices, which is emptied once it is in vbos[idxVBO]
         std::vector<GLuint> indices = {};
+        //! The number of indices in vbos[idxVBO]
+        std::size_t index_count = 0;
+        //! The type of the indices in vbos[idxVBO] (GL_UNSIGNED_SHORT unless the text has more
+        //! than visgl::short_index_max_vertices vertices)
+        GLenum index_type = GL_UNSIGNED_INT;
         //! CPU-side data for quad vertex positions
         std::vector<float> vertexPositions = {};
         //! CPU-side data for quad vertex normals
@@ -11,6 +11,7 @@
 #pragma once
 
 #include <mplot/VisualTextModelBase.h>
+#include <mplot/text_layout.h>
 
 #if defined __gl3_h_ || defined __gl_h_
 // GL headers have been externally included
@@ -19,6 +20,7 @@
 #endif
 
 #include <mplot/gl/util_nomx.h>
+#include <mplot/gl/debug_group_nomx.h>
 #include <mplot/VisualFaceNoMX.h>
 #include <mplot/VisualResourcesNoMX.h>
 
@@ -40,7 +42,8 @@ namespace mplot {
 
         ~VisualTextModelImpl()
         {
-            if (this->vbos != nullptr) {
+            // The parent Visual keeps the buffers for its next text model, if it has room
+            if (this->vbos != nullptr && !this->give_names()) {
                 glDeleteBuffers (this->numVBO, this->vbos.get());
                 glDeleteVertexArrays (1, &this->vao);
             }
@@ -51,45 +54,52 @@ namespace mplot {
         {
             if (this->hide == true) { return; }
 
-            GLint prev_shader;
-            GLuint tshaderprog = this->get_tprog (this->parentVis);
+            // If glyphs were moved or evicted in the face's atlas, re-make the quads
+            if (this->face != nullptr && this->face->generation != this->face_generation) {
+                if (this->is_console()) {
+                    this->console.mark_all_pending();
+                    this->face_generation = this->face->generation;
+                } else if (this->batch_txts.empty()) {
+                    this->setupText (std::basic_string<char32_t>(this->txt));
+                } else {
+                    this->setupBatchedTexts();
+                }
+            }
 
-            glGetIntegerv (GL_CURRENT_PROGRAM, &prev_shader);
+            GLuint tshaderprog = this->get_tprog (this->parentVis);
 
-            // Ensure the correct program is in play for this VisualModel
-            glUseProgram (tshaderprog);
+            // Ensure the correct program is in play for this VisualModel. The parent Visual
+            // records the GL state, so no glGet query is needed.
+            mplot::visgl::render_state& rs = this->get_render_state (this->parentVis);
+            mplot::gl::Util::use_program (rs, tshaderprog);
 
             // Set uniforms
-            GLint loc_tc = glGetUniformLocation (tshaderprog, static_cast<const GLchar*>("textColor"));
-            if (loc_tc != -1) { glUniform3f (loc_tc, this->clr_text[0], this->clr_text[1], this->clr_text[2]); }
-            GLint loc_a = glGetUniformLocation (tshaderprog, static_cast<const GLchar*>("alpha"));
-            if (loc_a != -1) { glUniform1f (loc_a, this->alpha); }
-            GLint loc_v = glGetUniformLocation (tshaderprog, static_cast<const GLchar*>("v_matrix"));
-            if (loc_v != -1) { glUniformMatrix4fv (loc_v, 1, GL_FALSE, this->scenematrix.mat.data()); }
-            GLint loc_m = glGetUniformLocation (tshaderprog, static_cast<const GLchar*>("m_matrix"));
-            if (loc_m != -1) { glUniformMatrix4fv (loc_m, 1, GL_FALSE, this->viewmatrix.mat.data()); }
+            const mplot::visgl::shader_uniforms& u = this->get_tprog_uniforms (this->parentVis);
+            if (u.textColor != -1) { glUniform3f (u.textColor, this->clr_text[0], this->clr_text[1], this->clr_text[2]); }
+            if (u.text_sdf != -1) { glUniform1i (u.text_sdf, (this->face != nullptr && this->face->sdf) ? 1 : 0); }
+            if (u.text_billboard != -1) { glUniform1i (u.text_billboard, this->tfeatures.billboard ? 1 : 0); }
+            if (u.alpha != -1) { glUniform1f (u.alpha, this->alpha); }
+            if (u.v_matrix != -1) { glUniformMatrix4fv (u.v_matrix, 1, GL_FALSE, this->scenematrix.mat.data()); }
+            if (u.m_matrix != -1) { glUniformMatrix4fv (u.m_matrix, 1, GL_FALSE, this->viewmatrix.mat.data()); }
 
             glActiveTexture (GL_TEXTURE0);
 
-            // It is only necessary to bind the vertex array object before rendering
-            glBindVertexArray (this->vao);
-
-            // We have a max of (2^32)-1 characters. Should be enough.
-            for (unsigned int i = 0U; i < this->quads.size(); ++i) {
-                // Bind the right texture for the quad.
-                glBindTexture (GL_TEXTURE_2D, this->quad_ids[i]);
-                // This is 'draw a subset of the elements from the vertex array
-                // object'. You say how many indices to draw and which base *vertex* you
-                // start from. In my scheme, I have 4 vertices for each two triangles
-                // that are constructed. Thus, I draw 6 indices, but increment the base
-                // vertex by 4 for each letter.
-                glDrawElementsBaseVertex (GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, 4*i);
+            // All the glyphs of the face are in its atlas texture, so the whole text is drawn
+            // with one texture bind and one draw call (or, for a console, one for each run of
+            // its ring of lines that is shown).
+            if (this->is_console()) {
+                this->upload_console_lines();
+                this->render_console (rs, u);
+            } else if (this->face != nullptr && this->index_count > 0u) {
+                glBindTexture (GL_TEXTURE_2D, this->face->atlas_texture);
+                ++rs.counts.texture_binds;
+                // It is only necessary to bind the vertex array object before rendering
+                mplot::gl::Util::bind_vao (rs, this->vao);
+                glDrawElements (GL_TRIANGLES, static_cast<GLsizei>(this->index_count), this->index_type, 0);
+                ++rs.counts.draw_calls;
             }
 
-            glBindVertexArray(0);
-            glUseProgram (prev_shader);
-
-            mplot::gl::Util::checkError (__FILE__, __LINE__);
+            if (rs.check_errors) { mplot::gl::Util::checkError (__FILE__, __LINE__); }
         }
 
         //! Compute the geometry for a sample text.
@@ -101,17 +111,8 @@ namespace mplot {
                 this->face = VisualResourcesNoMX<glver>::i().getVisualFace (this->tfeatures, this->parentVis);
             }
 
-            // First convert string from ASCII/UTF-8 into Unicode.
-            std::basic_string<char32_t> utxt = mplot::unicode::fromUtf8(_txt);
-            for (std::basic_string<char32_t>::const_iterator c = utxt.begin(); c != utxt.end(); c++) {
-                mplot::visgl::CharInfo ci = this->face->glchars[*c];
-                float drop = (ci.size.y() - ci.bearing.y()) * this->fontscale;
-                geom.max_drop = (drop > geom.max_drop) ? drop : geom.max_drop;
-                float bearingy = ci.bearing.y() * this->fontscale;
-                geom.max_bearingy = (bearingy > geom.max_bearingy) ? bearingy : geom.max_bearingy;
-                geom.total_advance += ((ci.advance>>6)*this->fontscale);
-            }
-            return geom;
+            // The face caches the metrics of the strings it has measured
+            return this->scaled_geometry (this->face->measure (_txt));
         }
 
         //! Return the geometry for the stored txt
@@ -123,15 +124,7 @@ namespace mplot {
                 this->face = VisualResourcesNoMX<glver>::i().getVisualFace (this->tfeatures, this->parentVis);
             }
 
-            for (std::basic_string<char32_t>::const_iterator c = this->txt.begin(); c != this->txt.end(); c++) {
-                mplot::visgl::CharInfo ci = this->face->glchars[*c];
-                float drop = (ci.size.y() - ci.bearing.y()) * this->fontscale;
-                geom.max_drop = (drop > geom.max_drop) ? drop : geom.max_drop;
-                float bearingy = ci.bearing.y() * this->fontscale;
-                geom.max_bearingy = (bearingy > geom.max_bearingy) ? bearingy : geom.max_bearingy;
-                geom.total_advance += ((ci.advance>>6)*this->fontscale);
-            }
-            return geom;
+            return this->scaled_geometry (this->face->measure (this->txt));
         }
 
         //! For some reason, I can't place these setupText functions in the base class. Compiler
@@ -171,93 +164,254 @@ namespace mplot {
         //! With the given text and font size information, create the quads for the text.
         void setupText (const std::basic_string<char32_t>& _txt)
         {
+            MPLOT_TRACE_GL ("VisualTextModel::setupText");
             if (this->face == nullptr) {
                 this->face = VisualResourcesNoMX<glver>::i().getVisualFace (this->tfeatures, this->parentVis);
             }
 
             this->txt = _txt;
+            this->batch_txts.clear();
+            this->batch_offsets.clear();
+            this->face_generation = this->face->generation;
             // With glyph information from txt, set up this->quads.
             this->quads.clear();
-            this->quad_ids.clear();
-            // Our string of letters starts at this location
-            float letter_pos = 0.0f;
-            float letter_y = 0.0f;
-            float text_epsilon = 0.0f;
-            for (std::basic_string<char32_t>::const_iterator c = this->txt.begin(); c != this->txt.end(); c++) {
-
-                if (*c == '\n') {
-                    // Skip newline, but add a y offset and reset letter_pos
-                    letter_pos = 0.0f;
-                    mplot::visgl::CharInfo ch = this->face->glchars['h'];
-                    letter_y += this->line_spacing * -ch.size.y() * this->fontscale;
-                    continue;
-                }
+            this->quad_uvs.clear();
+            this->layoutQuads (this->txt, sm::vec<float>{ 0.0f, 0.0f, 0.0f });
 
-                // Add a quad to this->quads
-                mplot::visgl::CharInfo ci = this->face->glchars[*c];
-
-                float xpos = letter_pos + ci.bearing.x() * this->fontscale;
-                float ypos = letter_y /*this->mv_offset[1]*/ - (ci.size.y() - ci.bearing.y()) * this->fontscale;
-                float w = ci.size.x() * this->fontscale;
-                float h = ci.size.y() * this->fontscale;
-
-                // Update extents
-                if (xpos < this->extents[0]) { this->extents[0] = xpos; } // left
-                if (xpos+w > this->extents[1]) { this->extents[1] = xpos+w; } // right
-                if (ypos < this->extents[2]) { this->extents[2] = ypos; } // bottom
-                if (ypos+h > this->extents[3]) { this->extents[3] = ypos+h; } // top
-
-                // What's the order of the vertices for the quads? It is:
-                // Bottom left, Top left, top right, bottom right.
-                std::array<float,12> tbox = { xpos,   ypos,     /*this->mv_offset[2]+*/text_epsilon,
-                                              xpos,   ypos+h,   text_epsilon,
-                                              xpos+w, ypos+h,   text_epsilon,
-                                              xpos+w, ypos,     text_epsilon };
-                text_epsilon -= 10.0f * std::numeric_limits<float>::epsilon();
-                if constexpr (mplot::VisualTextModelBase<glver>::debug_textquads == true) {
-                    std::cout << "Text box added as quad from\n("
-                              << tbox[0] << "," << tbox[1] << "," << tbox[2]
-                              << ") to (" << tbox[3] << "," << tbox[4] << "," << tbox[5]
-                              << ") to (" << tbox[6] << "," << tbox[7] << "," << tbox[8]
-                              << ") to (" << tbox[9] << "," << tbox[10] << "," << tbox[11]
-                              << "). w="<<w<<", h="<<h<<"\n";
-                    std::cout << "Texture ID for that character is: " << ci.textureID << std::endl;
-                }
-                this->quads.push_back (tbox);
-                this->quad_ids.push_back (ci.textureID);
+            // Ensure we've cleared out vertex info
+            this->clear_vertex_storage();
+
+            this->initializeVertices();
+
+            this->postVertexInit();
+            this->release_vertex_storage();
+        }
+
+        /*!
+         * Set up many texts in this one model, text i at _offsets[i] within the model, all in the
+         * colour _clr, so that they are drawn with a single draw call. This is for labels that
+         * share their font features and colour, such as the tick labels of many graphs. Any view
+         * translation or rotation of the model applies to all of the texts.
+         */
+        void setupTexts (const std::vector<std::string>& _txts, const std::vector<sm::vec<float>>& _offsets,
+                         std::array<float, 3> _clr = {0,0,0})
+        {
+            MPLOT_TRACE_GL ("VisualTextModel::setupTexts");
+            if (_txts.size() != _offsets.size()) {
+                throw std::runtime_error ("VisualTextModel::setupTexts: need one offset for each text");
+            }
+            this->clr_text = _clr;
+            this->batch_txts.resize (_txts.size());
+            for (std::size_t i = 0; i < _txts.size(); ++i) { this->batch_txts[i] = mplot::unicode::fromUtf8 (_txts[i]); }
+            this->batch_offsets = _offsets;
+            this->setupBatchedTexts();
+        }
 
-                // The value in ci.advance has to be divided by 64 to bring it into the
-                // same units as the ci.size and ci.bearing values.
-                letter_pos += ((ci.advance>>6)*this->fontscale);
+        //! This text's face, which is found (or made, on the GL thread) if the text has none yet
+        mplot::visgl::VisualFaceNoMX* getFace()
+        {
+            if (this->face == nullptr) {
+                this->face = VisualResourcesNoMX<glver>::i().getVisualFace (this->tfeatures, this->parentVis);
             }
+            return this->face;
+        }
 
-            //std::cout << "After setupText, extents are: (LRBT): " << this->extents << std::endl;
+        /*!
+         * Set _txt up as the text, with quads laid out from glyph_of (see mplot::text_layout),
+         * returning its geometry. This makes no GL calls (nor any calls on the face), so it,
+         * and placeText, can run on a worker thread, with glyph_of reading a table of the
+         * face's glyphs made beforehand, as of the face's generation _generation (see
+         * VisualModel::addLabels). uploadText then puts the vertices into the GL buffers.
+         */
+        template <typename F>
+        mplot::TextGeometry layoutText (const std::basic_string<char32_t>& _txt, F&& glyph_of, const unsigned int _generation)
+        {
+            this->txt = _txt;
+            this->batch_txts.clear();
+            this->batch_offsets.clear();
+            this->face_generation = _generation;
+            this->quads.clear();
+            this->quad_uvs.clear();
+            mplot::text_layout::layout (this->txt, sm::vec<float>{ 0.0f, 0.0f, 0.0f }, glyph_of,
+                                        this->fontscale, this->line_spacing, this->quads, this->quad_uvs, this->extents);
+            return mplot::text_layout::measure (this->txt, glyph_of, this->fontscale);
+        }
 
-            // Ensure we've cleared out vertex info
+        //! Place the text laid out by layoutText at _mv_offset, in colour _clr, and make its vertices (no GL calls)
+        void placeText (const sm::vec<float> _mv_offset, std::array<float, 3> _clr = {0,0,0})
+        {
+            this->mv_offset = _mv_offset;
+            this->viewmatrix.translate (this->mv_offset);
+            this->clr_text = _clr;
             this->vertexPositions.clear();
             this->vertexNormals.clear();
             this->vertexColors.clear();
             this->vertexTextures.clear();
             this->indices.clear();
-
             this->initializeVertices();
+        }
 
+        //! Put the vertices made by placeText into the GL buffers (on the GL thread)
+        void uploadText()
+        {
+            this->postVertexInit();
+            this->release_vertex_storage();
+        }
+
+        /*!
+         * Make this text model a console: a scrolling log of up to _capacity lines of up to
+         * _columns glyphs, of which the newest _rows are shown (see scrollConsole). The quads of
+         * all the lines are in one set of buffers, which are allocated here, so appendLine()
+         * writes only the quads of the lines that it appends and a scroll uploads nothing. The
+         * first line shown has its baseline at _mv_offset, and the lines go down from it.
+         */
+        void setupConsole (const std::size_t _capacity, const std::size_t _columns, const std::size_t _rows,
+                           const sm::vec<float> _mv_offset, std::array<float, 3> _clr = {0,0,0})
+        {
+            if (_capacity == 0u || _columns == 0u) { throw std::runtime_error ("VisualTextModel::setupConsole: the console is empty"); }
+            if (this->face == nullptr) {
+                this->face = VisualResourcesNoMX<glver>::i().getVisualFace (this->tfeatures, this->parentVis);
+            }
+            this->mv_offset = _mv_offset;
+            this->viewmatrix.translate (this->mv_offset);
+            this->clr_text = _clr;
+            this->txt.clear();
+            this->batch_txts.clear();
+            this->batch_offsets.clear();
+            this->face_generation = this->face->generation;
+            this->console.reset (_capacity, _columns);
+            this->console_rows = _rows;
+            mplot::visgl::CharInfo ch = this->face->get_glyph ('h');
+            this->console_line_height = this->line_spacing * ch.size.y() * this->fontscale;
+
+            // Empty quads for every glyph of every line, which appended lines overwrite
+            this->quads.assign (_capacity * _columns, std::array<float, 12>{});
+            this->quad_uvs.assign (_capacity * _columns, sm::vec<float, 4>{});
+            this->clear_vertex_storage();
+            this->initializeVertices();
             this->postVertexInit();
+
+            // The buffers hold the quads from here on
+            this->quads.clear();
+            this->quad_uvs.clear();
+            this->release_vertex_storage();
         }
 
+        std::size_t gpu_buffer_bytes (const GLuint buf) const final { return mplot::gl::Util::buffer_bytes (buf); }
+
     protected:
+        //! Make the quads for batch_txts at batch_offsets (see setupTexts)
+        void setupBatchedTexts()
+        {
+            if (this->face == nullptr) {
+                this->face = VisualResourcesNoMX<glver>::i().getVisualFace (this->tfeatures, this->parentVis);
+            }
+
+            // txt holds all of the texts, one per line, for getText() and debugText()
+            this->txt.clear();
+            for (const auto& t : this->batch_txts) {
+                if (!this->txt.empty()) { this->txt += U'\n'; }
+                this->txt += t;
+            }
+            this->face_generation = this->face->generation;
+            this->quads.clear();
+            this->quad_uvs.clear();
+            for (std::size_t i = 0; i < this->batch_txts.size(); ++i) {
+                this->layoutQuads (this->batch_txts[i], this->batch_offsets[i]);
+            }
+
+            this->clear_vertex_storage();
+
+            this->initializeVertices();
+
+            this->postVertexInit();
+            this->release_vertex_storage();
+        }
+
+        //! Append the quads for the glyphs of _txt, starting at _at, to this->quads
+        void layoutQuads (const std::basic_string<char32_t>& _txt, const sm::vec<float>& _at)
+        {
+            mplot::text_layout::layout (_txt, _at, [this](const char32_t c) { return this->face->get_glyph (c); },
+                                        this->fontscale, this->line_spacing, this->quads, this->quad_uvs, this->extents);
+        }
+
+        //! Write the quads of the console's lines that were appended since the last render into
+        //! their slots of the position and texture buffers
+        void upload_console_lines()
+        {
+            const auto [b, e] = this->console.pending();
+            if (b == e) { return; }
+            const std::size_t cap = this->console.capacity();
+            const std::size_t cols = this->console.width();
+            std::vector<float> posns;
+            std::vector<float> uvs;
+            // The pending lines are in at most two runs of consecutive slots
+            for (std::size_t n0 = b; n0 < e;) {
+                const std::size_t s0 = this->console.slot_of (n0);
+                const std::size_t n1 = std::min (e, n0 + (cap - s0));
+                this->quads.clear();
+                this->quad_uvs.clear();
+                for (std::size_t n = n0; n < n1; ++n) {
+                    const std::size_t q0 = this->quads.size();
+                    const float y = -static_cast<float>(this->console.slot_of (n)) * this->console_line_height;
+                    this->layoutQuads (this->console.line (n), sm::vec<float>{ 0.0f, y, 0.0f });
+                    // The unused glyphs of the line are empty quads
+                    this->quads.resize (q0 + cols, std::array<float, 12>{});
+                    this->quad_uvs.resize (q0 + cols, sm::vec<float, 4>{});
+                }
+                this->console_vertices (posns, uvs);
+                const GLintptr at = static_cast<GLintptr>(s0 * cols * 12u * sizeof(float));
+                const GLsizeiptr sz = static_cast<GLsizeiptr>(posns.size() * sizeof(float));
+                glBindBuffer (GL_ARRAY_BUFFER, this->vbos[this->posnVBO]);
+                glBufferSubData (GL_ARRAY_BUFFER, at, sz, posns.data());
+                glBindBuffer (GL_ARRAY_BUFFER, this->vbos[this->textureVBO]);
+                glBufferSubData (GL_ARRAY_BUFFER, at, sz, uvs.data());
+                this->count_upload (2u * static_cast<std::size_t>(sz));
+                n0 = n1;
+            }
+            this->quads.clear();
+            this->quad_uvs.clear();
+            this->console.mark_uploaded();
+        }
+
+        //! Draw the visible lines of the console, each run of slots translated to its rows
+        void render_console (mplot::visgl::render_state& rs, const mplot::visgl::shader_uniforms& u)
+        {
+            const std::size_t cols = this->console.width();
+            const std::size_t index_bytes = this->index_type == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+            bool bound = false;
+            for (const mplot::console_ring::span& sp : this->console.visible_spans (this->console_rows)) {
+                if (sp.n == 0u) { continue; }
+                if (!bound) {
+                    glBindTexture (GL_TEXTURE_2D, this->face->atlas_texture);
+                    ++rs.counts.texture_binds;
+                    mplot::gl::Util::bind_vao (rs, this->vao);
+                    bound = true;
+                }
+                // Slot s is at y = -s * console_line_height, and is shown in row sp.row + s - sp.first_slot
+                sm::mat44<float> shift;
+                shift.translate (sm::vec<float>{ 0.0f, (static_cast<float>(sp.first_slot) - static_cast<float>(sp.row)) * this->console_line_height, 0.0f });
+                const sm::mat44<float> m = this->viewmatrix * shift;
+                if (u.m_matrix != -1) { glUniformMatrix4fv (u.m_matrix, 1, GL_FALSE, m.mat.data()); }
+                glDrawElements (GL_TRIANGLES, static_cast<GLsizei>(sp.n * cols * 6u), this->index_type,
+                                     reinterpret_cast<const void*>(sp.first_slot * cols * 6u * index_bytes));
+                ++rs.counts.draw_calls;
+            }
+        }
 
         //! Common code to call after the vertices have been set up.
         void postVertexInit() final
         {
-            if (this->vbos == nullptr) {
+            // A deleted text model's vertex array object and buffers are reused if there are any
+            const bool make_names = this->vbos == nullptr && !this->take_names();
+            if (make_names) {
                 // Create vertex array object
                 glGenVertexArrays (1, &this->vao); // Safe for OpenGL 4.4-
             }
 
-            glBindVertexArray (this->vao);
+            mplot::gl::Util::bind_vao (this->get_render_state (this->parentVis), this->vao);
 
-            if (this->vbos == nullptr) {
+            if (make_names) {
                 // Create the vertex buffer objects
                 this->vbos = std::make_unique<GLuint[]>(this->numVBO);
                 glGenBuffers (this->numVBO, this->vbos.get()); // OpenGL 4.4- safe
@@ -267,8 +421,24 @@ namespace mplot {
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->vbos[this->idxVBO]);
 
             //std::cout << "indices.size(): " << this->indices.size() << std::endl;
-            std::size_t sz = this->indices.size() * sizeof(GLuint);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sz, this->indices.data(), GL_STATIC_DRAW);
+            if (this->vertexPositions.size() / 3 <= visgl::short_index_max_vertices) {
+                // A text's quads can nearly always be indexed with 16 bits. The copy is made
+                // in the parent Visual's pool, whose capacity lasts from one text to the next.
+                std::vector<GLushort> own16;
+                mplot::visgl::text_model_pool* pool = this->text_pool();
+                std::vector<GLushort>& indices16 = pool != nullptr ? pool->indices16 : own16;
+                visgl::narrow_indices (this->indices.data(), this->indices.size(), indices16);
+                this->index_type = GL_UNSIGNED_SHORT;
+                glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices16.size() * sizeof(GLushort), indices16.data(), GL_STATIC_DRAW);
+                this->count_upload (indices16.size() * sizeof(GLushort));
+                if (indices16.capacity() > mplot::visgl::text_model_pool::max_kept_capacity) { std::vector<GLushort>().swap (indices16); }
+            } else {
+                this->index_type = GL_UNSIGNED_INT;
+                std::size_t sz = this->indices.size() * sizeof(GLuint);
+                glBufferData(GL_ELEMENT_ARRAY_BUFFER, sz, this->indices.data(), GL_STATIC_DRAW);
+                this->count_upload (sz);
+            }
+            this->index_count = this->indices.size();
 
             // Binds data from the "C++ world" to the OpenGL shader world for
             // "position", "normalin" and "color"
@@ -278,7 +448,9 @@ namespace mplot {
             this->setupVBO (this->vbos[this->colVBO], this->vertexColors, visgl::colLoc);
             this->setupVBO (this->vbos[this->textureVBO], this->vertexTextures, visgl::textureLoc);
 
-            glBindVertexArray(0); // carefully unbind
+            mplot::gl::Util::bind_vao (this->get_render_state (this->parentVis), 0); // carefully unbind
+
+            if (this->requestRedraw != nullptr && this->parentVis != nullptr) { this->requestRedraw (this->parentVis); }
         }
 
         //! A face for this text. The face is specfied by tfeatures.font
@@ -290,6 +462,7 @@ namespace mplot {
             std::size_t sz = dat.size() * sizeof(float);
             glBindBuffer (GL_ARRAY_BUFFER, buf);
             glBufferData (GL_ARRAY_BUFFER, sz, dat.data(), GL_STATIC_DRAW);
+            this->count_upload (sz);
             glVertexAttribPointer (bufferAttribPosition, 3, GL_FLOAT, GL_FALSE, 0, (void*)(0));
             glEnableVertexAttribArray (bufferAttribPosition);
         }
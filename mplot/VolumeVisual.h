@@ -0,0 +1,72 @@
+/*!
+ * \file
+ *
+ * A VisualModel to show a 3D scalar field, such as the state of a 3D simulation, as a volume
+ * that is ray marched on the GPU (see VisualModelBase::set_volume). The data are colour scaled
+ * into [0,1] by colourScale and coloured through the model's colour map, which, with the
+ * density and threshold of set_volume_transfer, is the transfer function. However many voxels
+ * there are, the volume is drawn with one draw call of 36 vertices.
+ *
+ * \author Seb James
+ * \date 2026
+ */
+#pragma once
+
+#include <array>
+#include <stdexcept>
+#include <sm/vec>
+#include <sm/vvec>
+#include <mplot/VisualDataModel.h>
+
+namespace mplot {
+
+    //! The template argument T is the type of the data which this VolumeVisual will visualize
+    template <typename T, int glver = mplot::gl::version_4_1>
+    struct VolumeVisual : public VisualDataModel<T, glver>
+    {
+        VolumeVisual (const sm::vec<float> _offset)
+        {
+            this->mv_offset = _offset;
+            this->viewmatrix.translate (this->mv_offset);
+            this->colourScale.do_autoscale = true;
+        }
+
+        //! Show data, a volume of dims[0] * dims[1] * dims[2] values in which x varies fastest,
+        //! then y, then z. data must outlive the model (as for setScalarData).
+        void setVolume (const sm::vvec<T>* data, const std::array<unsigned int, 3>& _dims)
+        {
+            this->setScalarData (data);
+            this->dims = _dims;
+        }
+
+        //! The size of the volume in voxels
+        std::array<unsigned int, 3> dims = { 0u, 0u, 0u };
+
+        //! The size of a voxel in model units. The box of the volume is centred on the model's origin.
+        sm::vec<float> voxel_size = { 1.0f, 1.0f, 1.0f };
+
+        void initializeVertices()
+        {
+            if (this->scalarData == nullptr) { return; }
+            const std::size_t n = std::size_t{this->dims[0]} * this->dims[1] * this->dims[2];
+            if (this->scalarData->size() != n) {
+                throw std::runtime_error ("VolumeVisual: the data must hold dims[0] * dims[1] * dims[2] values");
+            }
+            // Scale the data into dcolour and hand its storage to the volume, so that the
+            // scaled volume is not copied
+            this->dcolour.resize (n);
+            this->colourScale.transform (*this->scalarData, this->dcolour);
+            this->volume.swap (this->dcolour);
+            this->dcolour.clear();
+            this->dcolour.shrink_to_fit();
+
+            const sm::vec<float> half = sm::vec<float>{ static_cast<float>(this->dims[0]), static_cast<float>(this->dims[1]),
+                                                        static_cast<float>(this->dims[2]) } * this->voxel_size * 0.5f;
+            this->volume_dims = this->dims;
+            this->volume_box = { -half, half };
+            this->bake_colour_lut();
+            this->reinit_volume();
+        }
+    };
+
+} // namespace mplot
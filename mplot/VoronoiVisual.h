@@ -13,6 +13,9 @@
 
 #include <iostream>
 #include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
 #include <vector>
 #include <array>
 #include <map>
@@ -73,23 +76,16 @@ namespace mplot {
                 return;
             }
 
+            if (this->jump_flood) {
+                this->initializeJumpFlood();
+                return;
+            }
+
             this->setupScaling();
+            // The topology is re-made along with the diagram
+            this->topology.valid = false;
 
-            sm::quaternion<float> rq;
-            if (this->data_z_direction != this->uz) {
-                // Find the rotation between data_z_direction and uz
-                this->dcoords.resize (ncoords);
-                sm::vec<float> r_axis = this->data_z_direction.cross (this->uz);
-                r_axis.renormalize();
-                float r_angle = this->data_z_direction.angle (this->uz, r_axis);
-                rq.rotate(r_axis, r_angle);
-                for (size_t i = 0; i < ncoords; ++i) {
-                    this->dcoords[i] = rq * (*this->dataCoords)[i];
-                }
-                this->dcoords_ptr = &this->dcoords;
-            } else {
-                this->dcoords_ptr = this->dataCoords;
-            }
+            sm::quaternion<float> rq = this->rotate_coords();
 
             // Use mplot::range to find the extents of dataCoords. From these create a
             // rectangle to pass to jcv_diagram_generate.
@@ -218,6 +214,14 @@ namespace mplot {
                 }
             }
 
+            // There is one triangle (3 vertices and 3 indices) per edge, so the space for them can
+            // be reserved in one go
+            std::size_t n_edges = 0;
+            for (int i = 0; i < diagram.numsites; ++i) {
+                for (const jcv_graphedge* e = sites[i].edges; e; e = e->next) { ++n_edges; }
+            }
+            this->reserve_geometry (3u * n_edges, 3u * n_edges);
+
             // To draw triangles iterate over the 'sites' and get the edges
             this->triangle_counts.resize (ncoords, 0);
             this->site_indices.resize (ncoords, 0);
@@ -268,6 +272,8 @@ namespace mplot {
                 std::cout << "WARNING: numsites != ncoords ?!?!\n";
             }
 
+            this->cache_topology (diagram, edge_pos_centres);
+
             // Draw optional objects
             if (this->debug_edges) {
                 // Now scan through the edges drawing tubes for debug
@@ -345,16 +351,41 @@ namespace mplot {
             jcv_diagram_free (&diagram);
         }
 
+        /*!
+         * Called by updateData() and updateCoords(). If the sites have the same x and y as when
+         * the diagram was generated (after any rotation by data_z_direction), only their z and
+         * data have changed. The cells' triangles are then rewritten from the cached topology
+         * (positions, normals and colours, in place) without generating a new Voronoi diagram, and
+         * only they are uploaded. Otherwise (or if debug_edges or debug_dataCoords, which draw
+         * geometry that depends on z, are set) the model is rebuilt with reinit().
+         */
+        void reinit_data() override
+        {
+            if (this->jump_flood) {
+                this->update_jump_flood();
+                return;
+            }
+            if (!this->rewrite_cells()) { this->reinit(); }
+        }
+
         void reinitColoursScalar()
         {
             if (this->colourScale.do_autoscale == true) { this->colourScale.reset(); }
             this->dcolour.resize (this->scalarData->size());
             this->colourScale.transform (*(this->scalarData), this->dcolour);
 
+            // Convert the colour of each site in bulk
+            sm::vvec<float> site_dcolour (this->triangle_counts.size());
+            for (std::size_t i = 0u; i < this->triangle_counts.size(); ++i) {
+                site_dcolour[i] = this->dcolour[this->site_indices[i]];
+            }
+            std::vector<float> site_rgb;
+            this->cm.convert (site_dcolour, site_rgb);
+
             // Replace elements of vertexColors
             unsigned int tcounts = 0;
             for (std::size_t i = 0u; i < this->triangle_counts.size(); ++i) {
-                auto c = this->cm.convert (this->dcolour[this->site_indices[i]]);
+                const float* c = site_rgb.data() + 3 * i;
                 std::size_t d_idx = tcounts * 9; // 3 floats per vtx, 3 vtxs per tri
                 for (std::size_t j = 0; j < 3 * this->triangle_counts[i]; ++j) {
                     // This is ONE colour vertex. Need 3 per triangle.
@@ -409,6 +440,12 @@ namespace mplot {
 
         void reinitColours()
         {
+            if (this->jump_flood) {
+                // The cells change colour with the colour lookup and datum_scale uniforms
+                this->bake_colour_lut();
+                this->update_jump_flood();
+                return;
+            }
             if (this->vertexColors.size() < this->triangle_count_sum * 3) {
                 throw std::runtime_error ("vertexColors is not big enough to reinitColours()");
             }
@@ -447,14 +484,234 @@ namespace mplot {
         //! surface with a rectangular grid.
         float border_width = std::numeric_limits<float>::epsilon();
 
+        /*!
+         * If true (set before finalize, with a glver of OpenGL 4.3 or later), compute the cells
+         * on the GPU by jump flooding (see VisualModelBase::set_jump_flood_grid) rather than
+         * generating a Voronoi diagram on the CPU. The model is then one flat rectangle, at z =
+         * jump_flood_z, over the x and y extent of the sites (plus border_width), with square
+         * texels, jump_flood_texels of them along its longer side. Each cell is coloured from the
+         * scalar datum of its site through the colour map and a linear colourScale. Moving the
+         * sites (updateCoords) or changing the data (updateData) then uploads the sites and data
+         * and floods the cells again at the next render, with no diagram and no rebuild, which
+         * suits many sites that move every frame. The z of the sites, zScale, vectorData,
+         * data_z_direction and the debug options do not apply. The rectangle is fixed when the
+         * model is built, so a site that moves off it loses its cell.
+         */
+        bool jump_flood = false;
+        unsigned int jump_flood_texels = 1024;
+        float jump_flood_z = 0.0f;
+
         // Do we add index labels?
         bool labelIndices = false;
         sm::vec<float, 3> labelOffset = { 0.04f, 0.0f, 0.0f };
         float labelSize = 0.03f;
 
     protected:
-        //! Compute a triangle from 3 arbitrary corners
-        void computeTriangle (sm::vec<float> c1, sm::vec<float> c2, sm::vec<float> c3, const std::array<float, 3>& colr)
+        //! Lay the jump flooding grid over the extent of the sites and make the rectangle that shows it
+        void initializeJumpFlood()
+        {
+            if (this->scalarData == nullptr) { throw std::runtime_error ("VoronoiVisual: jump_flood needs scalar data"); }
+            if (this->data_z_direction != this->uz) {
+                throw std::runtime_error ("VoronoiVisual: jump_flood shows cells in the x/y plane only");
+            }
+            sm::range<float> rx, ry;
+            rx.search_init();
+            ry.search_init();
+            for (const sm::vec<float>& c : *this->dataCoords) {
+                rx.update (c[0]);
+                ry.update (c[1]);
+            }
+            const std::array<float, 2> lo = { rx.min - this->border_width, ry.min - this->border_width };
+            const std::array<float, 2> hi = { rx.max + this->border_width, ry.max + this->border_width };
+            const float w = hi[0] - lo[0];
+            const float h = hi[1] - lo[1];
+            if (!(w > 0.0f && h > 0.0f) || this->jump_flood_texels == 0u) {
+                throw std::runtime_error ("VoronoiVisual: the jump_flood rectangle is empty (increase border_width)");
+            }
+            const float texel = std::max (w, h) / static_cast<float>(this->jump_flood_texels);
+            const std::array<unsigned int, 2> dims = { std::max (1u, static_cast<unsigned int>(std::ceil (w / texel - 0.001f))),
+                                                       std::max (1u, static_cast<unsigned int>(std::ceil (h / texel - 0.001f))) };
+            this->set_jump_flood_grid (lo, hi, dims);
+            this->colour_by_datum_texture = true;
+            this->bake_colour_lut();
+            this->update_jump_flood();
+
+            // One rectangle over the grid, whose corners carry the texture coordinates in their colours
+            const std::array<std::array<float, 2>, 4> corners = { { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 0.0f, 1.0f }, { 1.0f, 1.0f } } };
+            for (const auto& c : corners) {
+                this->vertex_push (sm::vec<float>{ (lo[0] + c[0] * w) * this->zoom, (lo[1] + c[1] * h) * this->zoom, this->jump_flood_z },
+                                   this->vertexPositions);
+                this->vertex_push (std::array<float, 3>{ c[0], c[1], 0.0f }, this->vertexColors);
+                this->vertex_push (this->uz, this->vertexNormals);
+            }
+            this->indices.insert (this->indices.end(), { this->idx, this->idx + 1, this->idx + 2, this->idx + 2, this->idx + 1, this->idx + 3 });
+            this->idx += 4;
+        }
+
+        //! Pass the sites, their data and the (linear) colour scaling to the jump flooding pass
+        void update_jump_flood()
+        {
+            if (this->dataCoords == nullptr || this->scalarData == nullptr) { return; }
+            std::vector<std::array<float, 2>> sites (this->dataCoords->size());
+            for (std::size_t i = 0; i < sites.size(); ++i) { sites[i] = { (*this->dataCoords)[i][0], (*this->dataCoords)[i][1] }; }
+            std::vector<float> d (this->scalarData->size());
+            sm::range<float> r;
+            r.search_init();
+            for (std::size_t i = 0; i < d.size(); ++i) {
+                // NaN data are shown as 0
+                const float di = static_cast<float>((*this->scalarData)[i]);
+                d[i] = std::isnan (di) ? 0.0f : di;
+                r.update (d[i]);
+            }
+            if (this->colourScale.do_autoscale) {
+                this->colourScale.reset();
+                if (!d.empty()) { this->colourScale.compute_scaling (static_cast<F>(r.min), static_cast<F>(r.max)); }
+            }
+            this->datum_scale = { static_cast<float>(this->colourScale.getParams (0)), static_cast<float>(this->colourScale.getParams (1)) };
+            this->set_jump_flood_sites (std::move (sites));
+            this->set_jump_flood_data (std::move (d));
+        }
+
+        /*!
+         * Point dcoords_ptr at the data coordinates, rotated so that data_z_direction becomes
+         * uz (into dcoords) if necessary. Returns the rotation.
+         */
+        sm::quaternion<float> rotate_coords()
+        {
+            sm::quaternion<float> rq;
+            if (this->data_z_direction != this->uz) {
+                // Find the rotation between data_z_direction and uz
+                const std::size_t ncoords = this->dataCoords->size();
+                this->dcoords.resize (ncoords);
+                sm::vec<float> r_axis = this->data_z_direction.cross (this->uz);
+                r_axis.renormalize();
+                float r_angle = this->data_z_direction.angle (this->uz, r_axis);
+                rq.rotate(r_axis, r_angle);
+                for (size_t i = 0; i < ncoords; ++i) {
+                    this->dcoords[i] = rq * (*this->dataCoords)[i];
+                }
+                this->dcoords_ptr = &this->dcoords;
+            } else {
+                this->dcoords_ptr = this->dataCoords;
+            }
+            return rq;
+        }
+
+        /*!
+         * Record the cells of diagram in topology: the site and edge ends of each triangle (in
+         * the order in which initializeVertices made them) and the sites around each edge end.
+         */
+        template <typename M>
+        void cache_topology (const jcv_diagram& diagram, const M& edge_pos_centres)
+        {
+            cell_topology& t = this->topology;
+            const std::size_t ncoords = this->dcoords_ptr->size();
+            t.site_xy.resize (ncoords);
+            for (std::size_t i = 0; i < ncoords; ++i) { t.site_xy[i] = { (*this->dcoords_ptr)[i][0], (*this->dcoords_ptr)[i][1] }; }
+            t.border_width = this->border_width;
+            t.zoom = this->zoom;
+
+            // Number the edge ends, and list the data indices of the sites around each
+            const jcv_site* sites = jcv_diagram_get_sites (&diagram);
+            std::map<sm::vec<float, 3>, unsigned int, veccmp> site_index;
+            for (int i = 0; i < diagram.numsites; ++i) { site_index[sites[i].p] = static_cast<unsigned int>(sites[i].index); }
+            std::map<sm::vec<float, 3>, unsigned int, veccmp> end_id;
+            t.end_xy.clear();
+            t.end_site_start.assign (1, 0u);
+            t.end_sites.clear();
+            for (const auto& epc : edge_pos_centres) {
+                end_id[epc.first] = static_cast<unsigned int>(t.end_xy.size());
+                t.end_xy.push_back ({ epc.first[0], epc.first[1] });
+                for (const auto& cce : epc.second) { t.end_sites.push_back (site_index[cce]); }
+                t.end_site_start.push_back (static_cast<unsigned int>(t.end_sites.size()));
+            }
+
+            t.tri_site.clear();
+            t.tri_ends.clear();
+            t.tri_site.reserve (this->triangle_count_sum);
+            t.tri_ends.reserve (this->triangle_count_sum);
+            for (int i = 0; i < diagram.numsites; ++i) {
+                for (const jcv_graphedge* e = sites[i].edges; e; e = e->next) {
+                    std::array<unsigned int, 2> ends = {};
+                    for (unsigned int j = 0; j < 2; ++j) {
+                        // The ends were keyed with z = 0 (they now hold their mean z)
+                        auto ei = end_id.find (sm::vec<float, 3>{ e->pos[j][0], e->pos[j][1], 0.0f });
+                        // An end with no entry (see initializeVertices) has z = 0; give it an empty cluster
+                        if (ei == end_id.end()) {
+                            ends[j] = static_cast<unsigned int>(t.end_xy.size());
+                            t.end_xy.push_back ({ e->pos[j][0], e->pos[j][1] });
+                            t.end_site_start.push_back (static_cast<unsigned int>(t.end_sites.size()));
+                        } else {
+                            ends[j] = ei->second;
+                        }
+                    }
+                    t.tri_site.push_back (static_cast<unsigned int>(sites[i].index));
+                    t.tri_ends.push_back (ends);
+                }
+            }
+            t.valid = true;
+        }
+
+        /*!
+         * Rewrite the cells' triangles from topology with the current z values and data. Returns
+         * false (having changed nothing) if the topology does not fit the current data coordinates.
+         */
+        bool rewrite_cells()
+        {
+            cell_topology& t = this->topology;
+            if (!t.valid || this->debug_edges || this->debug_dataCoords || this->dataCoords == nullptr) { return false; }
+            const std::size_t ncoords = this->dataCoords->size();
+            if (ncoords != t.site_xy.size() || this->border_width != t.border_width || this->zoom != t.zoom
+                || this->vertexPositions.size() < 9u * t.tri_site.size()) {
+                return false;
+            }
+            this->determine_datasize();
+            if (this->datasize != ncoords) { return false; }
+
+            sm::quaternion<float> rq = this->rotate_coords();
+            const std::vector<sm::vec<float>>& dc = *this->dcoords_ptr;
+            for (std::size_t i = 0; i < ncoords; ++i) {
+                if (dc[i][0] != t.site_xy[i][0] || dc[i][1] != t.site_xy[i][1]) { return false; }
+            }
+
+            if (this->setContext != nullptr) { this->setContext (this->parentVis); }
+            this->setupScaling();
+
+            // The z of each edge end is the mean z of the sites around it
+            const std::size_t n_ends = t.end_xy.size();
+            std::vector<float> end_z (n_ends, 0.0f);
+            for (std::size_t k = 0; k < n_ends; ++k) {
+                const unsigned int b = t.end_site_start[k];
+                const unsigned int e = t.end_site_start[k + 1];
+                if (e == b) { continue; }
+                float zsum = 0.0f;
+                for (unsigned int j = b; j < e; ++j) { zsum += dc[t.end_sites[j]][2]; }
+                end_z[k] = zsum / (e - b);
+            }
+
+            const bool rotated = this->data_z_direction != this->uz;
+            const sm::quaternion<float> rqinv = rotated ? rq.invert() : rq;
+            for (std::size_t ti = 0; ti < t.tri_site.size(); ++ti) {
+                const unsigned int si = t.tri_site[ti];
+                const std::array<unsigned int, 2>& en = t.tri_ends[ti];
+                sm::vec<float> c1 = dc[si];
+                sm::vec<float> c2 = { t.end_xy[en[0]][0], t.end_xy[en[0]][1], end_z[en[0]] };
+                sm::vec<float> c3 = { t.end_xy[en[1]][0], t.end_xy[en[1]][1], end_z[en[1]] };
+                if (rotated) {
+                    c1 = rqinv * c1;
+                    c2 = rqinv * c2;
+                    c3 = rqinv * c3;
+                }
+                this->writeTriangle (9u * ti, c1, c2, c3, this->setColour (si));
+            }
+
+            this->mark_dirty (0, 3u * t.tri_site.size());
+            this->reinit_buffers();
+            return true;
+        }
+
+        //! The zoomed corners and face normal of the triangle c1, c2, c3
+        std::array<sm::vec<float>, 4> triangleGeometry (sm::vec<float> c1, sm::vec<float> c2, sm::vec<float> c3) const
         {
             c1 *= this->zoom;
             c2 *= this->zoom;
@@ -464,6 +721,30 @@ namespace mplot {
             sm::vec<float> u2 = c2-c3;
             sm::vec<float> v = u1.cross(u2);
             v.renormalize();
+            return { c1, c2, c3, v };
+        }
+
+        //! Overwrite the triangle whose first vertex float is at vertexPositions[i0] (see computeTriangle)
+        void writeTriangle (const std::size_t i0, sm::vec<float> c1, sm::vec<float> c2, sm::vec<float> c3, const std::array<float, 3>& colr)
+        {
+            const std::array<sm::vec<float>, 4> g = this->triangleGeometry (c1, c2, c3);
+            for (unsigned int i = 0; i < 3U; ++i) {
+                for (unsigned int j = 0; j < 3U; ++j) {
+                    this->vertexPositions[i0 + 3 * i + j] = g[i][j];
+                    this->vertexNormals[i0 + 3 * i + j] = g[3][j];
+                    this->vertexColors[i0 + 3 * i + j] = colr[j];
+                }
+            }
+        }
+
+        //! Compute a triangle from 3 arbitrary corners
+        void computeTriangle (sm::vec<float> c1, sm::vec<float> c2, sm::vec<float> c3, const std::array<float, 3>& colr)
+        {
+            const std::array<sm::vec<float>, 4> g = this->triangleGeometry (c1, c2, c3);
+            c1 = g[0];
+            c2 = g[1];
+            c3 = g[2];
+            const sm::vec<float>& v = g[3];
             // Push corner vertices
             this->vertex_push (c1, this->vertexPositions);
             this->vertex_push (c2, this->vertexPositions);
@@ -488,6 +769,28 @@ namespace mplot {
         std::vector<sm::vec<float>> dcoords;
         //! A pointer either to dcoords or this->dataCoords
         const std::vector<sm::vec<float>>* dcoords_ptr;
+
+        /*!
+         * The Voronoi cells from the last build, from which reinit_data rewrites the triangles
+         * when only the z values and data have changed
+         */
+        struct cell_topology
+        {
+            bool valid = false;
+            //! The x and y of each (rotated) data coordinate when the diagram was generated
+            std::vector<std::array<float, 2>> site_xy;
+            float border_width = 0.0f;
+            float zoom = 1.0f;
+            //! The x and y of each edge end
+            std::vector<std::array<float, 2>> end_xy;
+            //! The data indices of the sites around edge end k are end_sites[end_site_start[k]] up to end_sites[end_site_start[k+1]]
+            std::vector<unsigned int> end_site_start;
+            std::vector<unsigned int> end_sites;
+            //! For each triangle, the data index of its site and its two edge ends
+            std::vector<unsigned int> tri_site;
+            std::vector<std::array<unsigned int, 2>> tri_ends;
+        };
+        cell_topology topology;
     };
 
 } // namespace mplot
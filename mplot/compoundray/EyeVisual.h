@@ -6,16 +6,26 @@
 
 #include <array>
 #include <vector>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
 #include <sm/mathconst>
 #include <sm/vec>
 #include <mplot/VisualModel.h>
 #include <mplot/gl/version.h>
+#include <mplot/compoundray/cuda_gl.h>
 
 #include "cameras/CompoundEyeDataTypes.h"
 
 namespace mplot::compoundray
 {
-    //! This class creates a visualization of a compound-ray format compound eye model
+    /*!
+     * This class creates a visualization of a compound-ray format compound eye model. For eyes
+     * of many ommatidia, set instanced = true before finalize(). One disc (and cone) mesh is then
+     * drawn for each ommatidium, placed, oriented and sized from a per-ommatidium instance, and
+     * reinitColours() uploads only the instance buffer (see initializeInstances).
+     */
     template<int glver = mplot::gl::version_4_1>
     class EyeVisual : public mplot::VisualModel<glver>
     {
@@ -46,6 +56,24 @@ namespace mplot::compoundray
         {
             if (ommData == nullptr) { return; }
             if (ommData->empty()) { return; }
+
+            if (this->instanced) {
+                // Rewrite only the colours of the instances and upload the instance buffer
+                const std::size_t n_inst = this->instance_count();
+                if (n_inst == 0u) { return; } // model doesn't exist yet
+                if (n_inst != ommData->size()) {
+                    throw std::runtime_error ("EyeVisual: instance/n_omm sizes mismatch!");
+                }
+                for (std::size_t i = 0u; i < n_inst; ++i) {
+                    float* ic = this->instance_data.data() + i * this->instance_stride + 4u;
+                    ic[0] = (*ommData)[i][0];
+                    ic[1] = (*ommData)[i][1];
+                    ic[2] = (*ommData)[i][2];
+                }
+                this->reinit_instances();
+                return;
+            }
+
             size_t n_verts = this->vertexColors.size(); // should be tube_vertices * n_omm
             if (n_verts == 0u) { return; } // model doesn't exist yet
 
@@ -78,13 +106,59 @@ namespace mplot::compoundray
             this->reinit_colour_buffer();
         }
 
+        /*!
+         * Colour the ommatidia from d_colours, on the GPU: one RGB triple of floats for each
+         * ommatidium, pitch bytes apart (12 for float3s, 16 for float4s), such as the ray
+         * tracer's per-ommatidium results. They are copied device to device into the instance
+         * buffer of an instanced eye, or into each ommatidium's vertices in the colour buffer,
+         * without passing through ommData, which is unchanged (so reinitColours() puts its
+         * colours back). The GL context must be current, as on the render thread.
+         */
+        void reinitColoursDevice (const void* d_colours, const std::size_t pitch)
+        {
+            if (ommData == nullptr || ommData->empty() || d_colours == nullptr) { return; }
+            if (this->compact_vertices || this->streaming) {
+                throw std::runtime_error ("EyeVisual: device colours need a model that is neither compact nor streaming");
+            }
+            const std::size_t n_omm = ommData->size();
+            constexpr std::size_t v3 = 3 * sizeof(float);
+            const mplot::upload_target t = this->instanced ? mplot::upload_target::instances : mplot::upload_target::colours;
+            const GLuint buf = this->buffer_name (t);
+            if (buf == 0) { return; } // model doesn't exist yet
+
+            // Register the buffer once, and again only after it has been reallocated
+            const std::array<std::size_t, 3> key = { buf, this->get_upload_generation(), this->instance_capacity };
+            if (this->device_colours == nullptr || key != this->device_colours_key) {
+                this->device_colours.reset();
+                this->device_colours = std::make_unique<mplot::compoundray::cuda_gl_buffer>(buf, cudaGraphicsRegisterFlagsNone);
+                this->device_colours_key = key;
+            }
+            std::size_t bytes = 0;
+            void* dst = this->device_colours->map (bytes);
+            if (this->instanced) {
+                if (this->instance_count() != n_omm) { throw std::runtime_error ("EyeVisual: instance/n_omm sizes mismatch!"); }
+                // The colour is at float 4 of each instance
+                mplot::compoundray::copy_strided (dst, bytes, 4u * sizeof(float), this->instance_stride * sizeof(float),
+                                                  d_colours, pitch, v3, n_omm);
+            } else {
+                const std::size_t nv = disc_vertices + (this->show_cones ? cone_vertices : 0);
+                for (std::size_t j = 0; j < nv; ++j) {
+                    mplot::compoundray::copy_strided (dst, bytes, j * v3, nv * v3, d_colours, pitch, v3, n_omm);
+                }
+            }
+            this->device_colours->unmap();
+            this->scene_changed();
+        }
+
         //! Initialize vertex buffer objects and vertex array object.
         void initializeVertices()
         {
-            this->vertexPositions.clear();
-            this->vertexNormals.clear();
-            this->vertexColors.clear();
-            this->indices.clear();
+            if (!this->instanced) {
+                this->vertexPositions.clear();
+                this->vertexNormals.clear();
+                this->vertexColors.clear();
+                this->indices.clear();
+            }
 
             // Sanity check our data pointers and return or throw
             if (ommData == nullptr || ommatidia == nullptr) { return; }
@@ -103,6 +177,15 @@ namespace mplot::compoundray
                 this->focal_point_sum += (*ommatidia)[i].focalPointOffset;
             }
 
+            if (this->instanced) {
+                this->initializeInstances();
+                return;
+            }
+
+            const std::size_t v_per_omm = disc_vertices + (this->show_cones ? cone_vertices : 0);
+            const std::size_t i_per_omm = this->tube_index_count (tube_faces) + (this->show_cones ? this->cone_index_count (tube_faces) : 0u);
+            this->reserve_geometry (n_omm * v_per_omm, n_omm * i_per_omm);
+
             if (this->focal_point_sum > 0.0f) {
                 // We have focal points, so draw with the relativePosition representing the centre
                 // of the ommatidial lens - the base of a cone - which then extends back to the cone
@@ -161,9 +244,73 @@ namespace mplot::compoundray
 
         }
 
+        /*!
+         * Set up the parameters of each ommatidium's instance of the one disc (and cone) mesh.
+         * The mesh lies along the z axis. The shader scales it by s along z, and by s times
+         * radial_scale across z, then rotates its z axis onto the ommatidium's direction:
+         *
+         * - with focal points, s is the focal point offset (the cone's length) and radial_scale
+         *   is tan(acceptance angle / 2), so s * radial_scale is the lens radius;
+         * - without, s is cone_length and radial_scale is the disc radius over cone_length.
+         *
+         * The mesh is built for the first instances. A disc is 0.1 times its radius thick, which
+         * the mesh can only give for one ratio of radius to s; the mean ratio over the eye is
+         * used.
+         */
+        void initializeInstances()
+        {
+            const std::size_t n_omm = this->ommData->size();
+            const bool focal = this->focal_point_sum > 0.0f;
+            this->instance_data.clear();
+            this->instance_data.reserve (n_omm * this->instance_stride);
+            float radial_sum = 0.0f;
+            for (std::size_t i = 0u; i < n_omm; ++i) {
+                const Ommatidium& om = (*this->ommatidia)[i];
+                sm::vec<float, 3> pos = { om.relativePosition.x, om.relativePosition.y, om.relativePosition.z };
+                sm::vec<float, 3> dir = { om.relativeDirection.x, om.relativeDirection.y, om.relativeDirection.z };
+                dir.renormalize();
+                float s = 0.0f;
+                float radial = 0.0f;
+                if (focal) {
+                    s = om.focalPointOffset;
+                    radial = std::tan (om.acceptanceAngleRadians / 2.0f);
+                } else {
+                    s = this->cone_length;
+                    float radius = this->disc_width / 2.0f;
+                    if (radius < 0.0f) { radius = this->cone_length * std::tan (om.acceptanceAngleRadians / 2.0f); }
+                    radial = radius / this->cone_length;
+                }
+                radial_sum += radial;
+                this->add_instance (pos, s, (*this->ommData)[i], dir, radial);
+            }
+
+            if (!this->indices.empty()) { return; } // The mesh is kept on a reinit
+            const float t = 0.1f * radial_sum / static_cast<float>(n_omm);
+            const std::array<float, 3> clr = { 1.0f, 1.0f, 1.0f };
+            const sm::vec<float, 3> o = { 0.0f, 0.0f, 0.0f };
+            const sm::vec<float, 3> uz1 = { 0.0f, 0.0f, 1.0f };
+            if (focal) {
+                // The disc faces out from the lens; the cone's tip (the detector) is behind it
+                this->computeTube (o, uz1 * t, clr, clr, 1.0f, tube_faces);
+                if (this->show_cones == true) { this->computeCone (o, -uz1, 0.0f, clr, 1.0f, tube_faces); }
+            } else {
+                // The disc lies behind the lens; the cone's tip is at the lens
+                this->computeTube (o, -uz1 * t, clr, clr, 1.0f, tube_faces);
+                if (this->show_cones == true) { this->computeCone (uz1, o, 0.0f, clr, 1.0f, tube_faces); }
+            }
+        }
+
         // Visualize in two modes "disc" mode, showing just a 2D disc for each ommatidium and
-        // disc+cone mode, where the acceptance angle is displayed too. Runtime switchable.
+        // disc+cone mode, where the acceptance angle is displayed too. Runtime switchable (with
+        // set_show_cones, or by setting show_cones and calling reinit on a model that is not
+        // instanced).
         bool show_cones = false;
+        void set_show_cones (const bool b)
+        {
+            this->show_cones = b;
+            this->indices.clear(); // An instanced model would otherwise keep its mesh
+            this->reinit();
+        }
         // The colours detected by each ommatidium
         std::vector<std::array<float, 3>>* ommData = nullptr;
         // The position and orientation of each oimmatidium
@@ -177,12 +324,26 @@ namespace mplot::compoundray
         static constexpr int cone_vertices = tube_faces * 3 + 2;
         static constexpr int disc_vertices = tube_faces * 4 + 2;
         // Setter for cone_length must reinit vertices
-        void set_cone_length (float _cone_length) { this->cone_length = _cone_length; this->reinit(); }
+        void set_cone_length (float _cone_length)
+        {
+            this->cone_length = _cone_length;
+            this->indices.clear(); // The disc thickness of an instanced mesh depends on the cone length
+            this->reinit();
+        }
         float get_cone_length() { return this->cone_length; }
         // Setter for the disc width. To replace cone length? Or operate as alternative?
-        void set_disc_width (float _disc_width) { this->disc_width = _disc_width; this->reinit(); }
+        void set_disc_width (float _disc_width)
+        {
+            this->disc_width = _disc_width;
+            this->indices.clear();
+            this->reinit();
+        }
         float get_disc_width() { return this->disc_width; }
     private:
+        // The colour (or instance) buffer registered with CUDA for reinitColoursDevice, and the
+        // buffer name, upload generation and instance capacity for which it was registered
+        std::unique_ptr<mplot::compoundray::cuda_gl_buffer> device_colours;
+        std::array<std::size_t, 3> device_colours_key = {};
         // User-modifiable ommatidial cone length which is used if there's no focal point offset
         float cone_length = 0.1f;
         // User-modifiable ommatidial disc width. If negative ignored?
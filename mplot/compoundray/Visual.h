@@ -8,6 +8,7 @@
  */
 
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <mplot/Visual.h>
 
@@ -45,15 +46,29 @@ namespace mplot::compoundray {
             fout.close();
         }
 
+        //! Save the scene to a binary glTF (.glb) file in compound-ray format. See mplot::Visual::saveglb.
+        void saveglb (const std::string& glb_file, const bool interleaved = false)
+        {
+            std::ostringstream js;
+            this->gltf_scenes (js);
+            this->gltf_nodes (js);
+            this->gltf_cameras (js);
+            this->gltf_meshes (js);
+            this->glb_buffers (js, interleaved);
+            this->gltf_materials (js);
+            this->gltf_asset (js);
+            this->write_glb (glb_file, js.str(), interleaved);
+        }
+
     protected:
         //! Compound-ray gltf needs a background-shader to be specified. This is added to the
         //! "scenes" section
-        void compoundRayBackground (std::ofstream& fout) const
+        void compoundRayBackground (std::ostream& fout) const
         {
             fout << "\"extras\" : { \"background-shader\": \"simple_sky\" }, ";
         }
 
-        void compoundRayPanCam (std::ofstream& fout) const
+        void compoundRayPanCam (std::ostream& fout) const
         {
             fout << "    {\n"
                  << "      \"name\" : \"regular-panoramic\",\n"
@@ -70,7 +85,7 @@ namespace mplot::compoundray {
                  << "    }";
         }
 
-        void compoundRayEyeCam (std::ofstream& fout) const
+        void compoundRayEyeCam (std::ostream& fout) const
         {
             fout << "    {\n"
                  << "      \"name\" : \"simulated-compound-eye\",\n"
@@ -90,7 +105,7 @@ namespace mplot::compoundray {
         }
 
         //! This outputs an example of a compound-ray compatible cameras section
-        void compoundRayCameras (std::ofstream& fout) const
+        void compoundRayCameras (std::ostream& fout) const
         {
             fout << "  \"cameras\" : [\n";
             // Output camera sections of the cameras array
@@ -103,7 +118,7 @@ namespace mplot::compoundray {
 
         //! Hardcoded camera nodes for compound-ray compatible gltf. This goes in the gltf "nodes"
         //! section.
-        void compoundRayCameraNodes (std::ofstream& fout) const
+        void compoundRayCameraNodes (std::ostream& fout) const
         {
             fout << "    {\n"
                  << "      \"camera\" : 0,\n"
@@ -128,7 +143,7 @@ namespace mplot::compoundray {
         }
 
         //! Output a scenes section of glTF
-        void gltf_scenes (std::ofstream& fout) const
+        void gltf_scenes (std::ostream& fout) const
         {
             fout << "{\n  \"scenes\" : [ { ";
             if (this->enable_compound_ray_gltf == true) { compoundRayBackground (fout); }
@@ -140,7 +155,7 @@ namespace mplot::compoundray {
         }
 
         //! Output a nodes section of glTF
-        void gltf_nodes (std::ofstream& fout) const
+        void gltf_nodes (std::ostream& fout) const
         {
             fout << "  \"nodes\" : [\n";
             if (this->enable_compound_ray_gltf == true) { compoundRayCameraNodes (fout); }
@@ -154,13 +169,13 @@ namespace mplot::compoundray {
         }
 
         //! Output a cameras section of glTF
-        void gltf_cameras (std::ofstream& fout) const
+        void gltf_cameras (std::ostream& fout) const
         {
             if (this->enable_compound_ray_gltf == true) { compoundRayCameras (fout); }
         }
 
         //! Output a meshes section of glTF
-        void gltf_meshes (std::ofstream& fout) const
+        void gltf_meshes (std::ostream& fout) const
         {
             // glTF meshes
             fout << "  \"meshes\" : [\n";
@@ -175,7 +190,7 @@ namespace mplot::compoundray {
         }
 
         // Output the buffers, bufferviews and accessors sections of glTF
-        void gltf_buffers (std::ofstream& fout) const
+        void gltf_buffers (std::ostream& fout) const
         {
             // glTF buffers
             fout << "  \"buffers\" : [\n";
@@ -277,14 +292,14 @@ namespace mplot::compoundray {
         }
 
         //! Output a materials section of glTF
-        void gltf_materials (std::ofstream& fout) const
+        void gltf_materials (std::ostream& fout) const
         {
             // Default material is single sided, so make it double sided
             fout << "  \"materials\" : [ { \"doubleSided\" : true } ],\n";
         }
 
         //! Output the asset section of glTF
-        void gltf_asset (std::ofstream& fout) const
+        void gltf_asset (std::ostream& fout) const
         {
             fout << "  \"asset\" : {\n"
                  << "    \"generator\" : \"https://github.com/ABRG-Models/mplotologica [version "
@@ -0,0 +1,94 @@
+/*
+ * CUDA/OpenGL interoperability for compound-ray: copy data that the ray tracer holds on the GPU
+ * straight into the buffers of VisualModels, without a round trip through the host.
+ *
+ * Include this after the GL headers (mplot/VisualModel.h, say), as cuda_gl_interop.h needs them.
+ *
+ * Author: Seb James
+ * Date: 2025
+ */
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+#include <cuda_runtime.h>
+#include <cuda_gl_interop.h>
+
+namespace mplot::compoundray
+{
+    //! Throw a runtime_error naming what if e is not cudaSuccess
+    inline void cuda_check (const cudaError_t e, const char* what)
+    {
+        if (e != cudaSuccess) {
+            throw std::runtime_error (std::string("mplot::compoundray: ") + what + ": " + cudaGetErrorString (e));
+        }
+    }
+
+    /*!
+     * A GL buffer registered with CUDA (with cudaGraphicsGLRegisterBuffer) for as long as this
+     * object lives. map() gives the buffer's device pointer, valid until unmap() (or the
+     * destructor). The GL context that owns the buffer must be current, and the buffer must not
+     * be drawn from while it is mapped.
+     */
+    class cuda_gl_buffer
+    {
+    public:
+        cuda_gl_buffer (const GLuint buf, const unsigned int flags = cudaGraphicsRegisterFlagsNone)
+        {
+            cuda_check (cudaGraphicsGLRegisterBuffer (&this->resource, buf, flags), "cudaGraphicsGLRegisterBuffer");
+        }
+        ~cuda_gl_buffer()
+        {
+            this->unmap();
+            if (this->resource != nullptr) { cudaGraphicsUnregisterResource (this->resource); }
+        }
+        cuda_gl_buffer (const cuda_gl_buffer&) = delete;
+        cuda_gl_buffer& operator= (const cuda_gl_buffer&) = delete;
+
+        //! Map the buffer for CUDA, returning its device pointer. Its size in bytes is put in bytes.
+        void* map (std::size_t& bytes)
+        {
+            if (this->mapped == nullptr) {
+                cuda_check (cudaGraphicsMapResources (1, &this->resource), "cudaGraphicsMapResources");
+                cuda_check (cudaGraphicsResourceGetMappedPointer (&this->mapped, &this->mapped_bytes, this->resource),
+                            "cudaGraphicsResourceGetMappedPointer");
+            }
+            bytes = this->mapped_bytes;
+            return this->mapped;
+        }
+
+        //! Hand the buffer back to GL, so that it can be drawn from
+        void unmap()
+        {
+            if (this->mapped == nullptr) { return; }
+            cudaGraphicsUnmapResources (1, &this->resource);
+            this->mapped = nullptr;
+            this->mapped_bytes = 0;
+        }
+
+    private:
+        cudaGraphicsResource_t resource = nullptr;
+        void* mapped = nullptr;
+        std::size_t mapped_bytes = 0;
+    };
+
+    /*!
+     * Copy n elements of el_bytes bytes, src_stride bytes apart on the device, to dst + dst_offset
+     * (bytes), dst_stride bytes apart on the device, checking that they fit in dst_bytes. With
+     * el_bytes = 12 and dst_stride = 12, this packs a strided view of float3s into a vertex buffer.
+     */
+    inline void copy_strided (void* dst, const std::size_t dst_bytes, const std::size_t dst_offset, const std::size_t dst_stride,
+                              const void* src, const std::size_t src_stride, const std::size_t el_bytes, const std::size_t n,
+                              const cudaMemcpyKind kind = cudaMemcpyDeviceToDevice)
+    {
+        if (n == 0) { return; }
+        if (dst_offset + (n - 1) * dst_stride + el_bytes > dst_bytes) {
+            throw std::runtime_error ("mplot::compoundray::copy_strided: the data don't fit in the buffer");
+        }
+        cuda_check (cudaMemcpy2D (static_cast<char*>(dst) + dst_offset, dst_stride, src, src_stride, el_bytes, n, kind),
+                    "cudaMemcpy2D");
+    }
+
+} // namespace
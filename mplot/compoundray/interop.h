@@ -17,6 +17,7 @@
 #include <sm/mat44>
 #include <mplot/Visual.h>
 #include <mplot/VerticesVisual.h>
+#include <mplot/compoundray/cuda_gl.h>
 
 // scene exists at global scope in libEyeRenderer.so
 extern MulticamScene* scene;
@@ -146,6 +147,124 @@ namespace mplot::compoundray
         }
     }
 
+    // The distance in bytes between the elements of a compound-ray BufferView (0 means packed)
+    template <typename V>
+    std::size_t view_stride (const V& v, const std::size_t el_bytes)
+    {
+        return v.byte_stride > 0 ? static_cast<std::size_t>(v.byte_stride) : el_bytes;
+    }
+
+    /*!
+     * As scene_to_visualmodels, but each model's buffers are allocated first (see
+     * VisualModel::setDeviceMesh) and are filled from compound-ray's device buffers with device
+     * to device copies, through cudaGraphicsGLRegisterBuffer, so that a large scene's meshes don't
+     * make a round trip through the host at load time. Only what must be converted goes by way of
+     * the host: ushort4 and uchar4 colours, material colours and the indices of a mesh's second
+     * and later primitives (which are offset by the vertices of those before them). The GL
+     * context of thevisual must be current.
+     */
+    void scene_to_visualmodels_interop (MulticamScene* thescene, mplot::Visual<>* thevisual)
+    {
+        constexpr std::size_t v3 = 3 * sizeof(float);
+        std::vector<std::shared_ptr<MulticamScene::MeshGroup>> mymeshes = thescene->getMeshes();
+        std::vector<MaterialData::Pbr> mymats = thescene->getMaterials();
+        for (unsigned int mi = 0; mi < mymeshes.size(); ++mi) {
+            const MulticamScene::MeshGroup& mesh = *mymeshes[mi];
+            sm::mat44<float> tfm;
+            for (unsigned int tfi = 0; tfi < 16; ++tfi) { tfm[tfi] = mesh.transform[tfi]; }
+            tfm.transpose_inplace();
+
+            std::size_t n_verts = 0;
+            std::size_t n_inds = 0;
+            for (unsigned int ii = 0; ii < mesh.indices.size(); ++ii) {
+                n_verts += mesh.positions[ii].count;
+                n_inds += mesh.indices[ii].count;
+            }
+            if (n_verts == 0 || n_inds == 0) { continue; }
+
+            auto vertvm = std::make_unique<mplot::VerticesVisual<>> (tfm, sm::vvec<uint32_t>{}, sm::vvec<sm::vec<float>>{},
+                                                                     sm::vvec<sm::vec<float>>{}, sm::vvec<sm::vec<float>>{});
+            thevisual->bindmodel (vertvm);
+            const sm::vec<float, 3> bb_min = { mesh.object_aabb.m_min.x, mesh.object_aabb.m_min.y, mesh.object_aabb.m_min.z };
+            const sm::vec<float, 3> bb_max = { mesh.object_aabb.m_max.x, mesh.object_aabb.m_max.y, mesh.object_aabb.m_max.z };
+            vertvm->setDeviceMesh (n_verts, n_inds, bb_min, bb_max);
+            vertvm->finalize();
+            // Allocate the buffers now, rather than at the first render, so that they can be filled
+            vertvm->reinit_buffers();
+
+            {
+                constexpr unsigned int wd = cudaGraphicsRegisterFlagsWriteDiscard;
+                mplot::compoundray::cuda_gl_buffer posn_gl (vertvm->buffer_name (mplot::upload_target::positions), wd);
+                mplot::compoundray::cuda_gl_buffer norm_gl (vertvm->buffer_name (mplot::upload_target::normals), wd);
+                mplot::compoundray::cuda_gl_buffer colr_gl (vertvm->buffer_name (mplot::upload_target::colours), wd);
+                mplot::compoundray::cuda_gl_buffer ind_gl (vertvm->buffer_name (mplot::upload_target::indices), wd);
+                std::size_t posn_bytes = 0, norm_bytes = 0, colr_bytes = 0, ind_bytes = 0;
+                void* posn = posn_gl.map (posn_bytes);
+                void* norm = norm_gl.map (norm_bytes);
+                void* colr = colr_gl.map (colr_bytes);
+                void* ind = ind_gl.map (ind_bytes);
+
+                // The first vertex and index of each primitive in the model's buffers
+                std::size_t v0 = 0;
+                std::size_t i0 = 0;
+                for (unsigned int ii = 0; ii < mesh.indices.size(); ++ii) {
+                    const auto& pv = mesh.positions[ii];
+                    const std::size_t nv = pv.count;
+                    copy_strided (posn, posn_bytes, v0 * v3, v3, reinterpret_cast<const void*>(pv.data), view_stride (pv, sizeof(float3)), v3, nv);
+                    const auto& nview = mesh.normals[ii];
+                    copy_strided (norm, norm_bytes, v0 * v3, v3, reinterpret_cast<const void*>(nview.data), view_stride (nview, sizeof(float3)), v3, nview.count);
+
+                    // Colours: float3 vertex colours are copied as they are; others are converted on the host
+                    if (mesh.host_color_types[ii] == 5126) { // TINYGLTF_COMPONENT_TYPE_FLOAT
+                        const auto& cv = mesh.host_colors_f3[ii];
+                        copy_strided (colr, colr_bytes, v0 * v3, v3, reinterpret_cast<const void*>(cv.data), view_stride (cv, sizeof(float3)), v3, cv.count);
+                    } else {
+                        sm::vvec<sm::vec<float>> c (nv, sm::vec<float>{0,1,1});
+                        if (mesh.host_color_types[ii] == -1) { // No colour vertices, so the material's colour
+                            c.set_from (sm::vec<float>{1,0,1});
+                            if (static_cast<size_t>(mesh.material_idx[ii]) < mymats.size()) {
+                                const MaterialData::Pbr& mypbr = mymats[mesh.material_idx[ii]];
+                                c.set_from (sm::vec<float>{ mypbr.base_color.x, mypbr.base_color.y, mypbr.base_color.z });
+                            }
+                        } else if (mesh.host_color_types[ii] == 5123) { // TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT
+                            cuda::CopiedBufferView<ushort4> clr_buf (mesh.host_colors_us4[ii]);
+                            for (std::size_t j = 0; j < clr_buf.bv_data.size() && j < nv; ++j) {
+                                const ushort4 u = clr_buf[j];
+                                c[j] = { u.x / 65535.0f, u.y / 65535.0f, u.z / 65535.0f };
+                            }
+                        } else if (mesh.host_color_types[ii] == 5121) { // TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE
+                            cuda::CopiedBufferView<uchar4> clr_buf (mesh.host_colors_uc4[ii]);
+                            for (std::size_t j = 0; j < clr_buf.bv_data.size() && j < nv; ++j) {
+                                const uchar4 u = clr_buf[j];
+                                c[j] = { u.x / 255.0f, u.y / 255.0f, u.z / 255.0f };
+                            }
+                        }
+                        copy_strided (colr, colr_bytes, v0 * v3, v3, c.data(), v3, v3, nv, cudaMemcpyHostToDevice);
+                    }
+
+                    // Indices: those of the first primitive need no offset, so are copied as they are
+                    const auto& iv = mesh.indices[ii];
+                    const std::size_t isz = iv.elmt_byte_size > 0 ? static_cast<std::size_t>(iv.elmt_byte_size) : sizeof(uint32_t);
+                    if (v0 == 0 && isz == sizeof(uint32_t)) {
+                        copy_strided (ind, ind_bytes, i0 * sizeof(uint32_t), sizeof(uint32_t), reinterpret_cast<const void*>(iv.data),
+                                      view_stride (iv, sizeof(uint32_t)), sizeof(uint32_t), iv.count);
+                    } else {
+                        cuda::CopiedBufferView<uint32_t> ind_buf (iv);
+                        sm::vvec<uint32_t> these_inds (ind_buf.bv_data.size(), 0u);
+                        std::swap (these_inds, ind_buf.bv_data);
+                        these_inds += static_cast<uint32_t>(v0);
+                        copy_strided (ind, ind_bytes, i0 * sizeof(uint32_t), sizeof(uint32_t), these_inds.data(),
+                                      sizeof(uint32_t), sizeof(uint32_t), these_inds.size(), cudaMemcpyHostToDevice);
+                    }
+                    v0 += nv;
+                    i0 += iv.count;
+                }
+                // The buffers are unmapped and unregistered here, so that GL can draw from them
+            }
+            thevisual->addVisualModel (vertvm);
+        }
+    }
+
     // From the camera localspace, we can create a matrix which specifies a camera pose within the world frame
     sm::mat44<float> getCameraSpace (MulticamScene* thescene)
     {
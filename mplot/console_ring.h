@@ -0,0 +1,123 @@
+/*!
+ * \file
+ *
+ * The lines of a console (a scrolling log of text; see VisualTextModel::setupConsole), held in a
+ * ring of fixed capacity. Line n of all those ever appended is in slot n % capacity, and each
+ * slot has room for the quads of a fixed number of glyphs, so appending a line rewrites only
+ * that slot, and the lines shown are at most two runs of consecutive slots.
+ *
+ * \author Seb James
+ * \date 2026
+ */
+#pragma once
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
+
+namespace mplot {
+
+    struct console_ring
+    {
+        //! A run of n consecutive slots from first_slot, to be shown from row (counted down
+        //! from the top row, 0) onwards
+        struct span
+        {
+            std::size_t first_slot = 0;
+            std::size_t n = 0;
+            std::size_t row = 0;
+        };
+
+        //! Empty the ring and make it hold _capacity lines of up to _columns characters
+        void reset (const std::size_t _capacity, const std::size_t _columns)
+        {
+            this->lines.assign (_capacity, std::basic_string<char32_t>{});
+            this->columns = _columns;
+            this->n_total = 0;
+            this->n_uploaded = 0;
+            this->scroll = 0;
+        }
+
+        //! Append txt as one line or, if it contains newlines, as several. Each line is cut to
+        //! the first columns characters. A line appended to a full ring replaces the oldest.
+        void append (std::basic_string_view<char32_t> txt)
+        {
+            if (this->lines.empty()) { return; }
+            for (;;) {
+                const std::size_t nl = txt.find (U'\n');
+                std::basic_string_view<char32_t> l = txt.substr (0, nl);
+                if (!l.empty() && l.back() == U'\r') { l.remove_suffix (1); }
+                this->lines[this->n_total % this->lines.size()] = std::basic_string<char32_t>(l.substr (0, this->columns));
+                ++this->n_total;
+                if (nl == std::basic_string_view<char32_t>::npos) { break; }
+                txt.remove_prefix (nl + 1);
+            }
+        }
+
+        //! The number of lines the ring holds
+        std::size_t capacity() const { return this->lines.size(); }
+        //! The number of characters (glyph quads) in each slot
+        std::size_t width() const { return this->columns; }
+        //! The number of lines ever appended
+        std::size_t total() const { return this->n_total; }
+        //! The number of lines held (the newest, up to capacity() of them)
+        std::size_t size() const { return std::min (this->n_total, this->lines.size()); }
+        //! The index (among all the lines ever appended) of the oldest line held
+        std::size_t oldest() const { return this->n_total - this->size(); }
+
+        //! The slot of line n
+        std::size_t slot_of (const std::size_t n) const { return n % this->lines.size(); }
+        //! Line n, which must be held (oldest() <= n < total())
+        const std::basic_string<char32_t>& line (const std::size_t n) const { return this->lines[this->slot_of (n)]; }
+
+        //! The lines [first, second) that have been appended (and are still held) since
+        //! mark_uploaded()
+        std::pair<std::size_t, std::size_t> pending() const
+        {
+            return { std::max (this->n_uploaded, this->oldest()), this->n_total };
+        }
+        void mark_uploaded() { this->n_uploaded = this->n_total; }
+        //! Make all of the lines held pending, so that their quads are all written again
+        void mark_all_pending() { this->n_uploaded = 0; }
+
+        //! Show the rows lines that end lines_back before the newest (0 follows the newest line)
+        void scroll_back (const std::size_t lines_back) { this->scroll = lines_back; }
+        std::size_t scrolled_back() const { return this->scroll; }
+
+        //! The lines [first, second) to show in rows rows: the newest, scrolled back by up to as
+        //! many lines as are held before them
+        std::pair<std::size_t, std::size_t> visible (const std::size_t rows) const
+        {
+            const std::size_t held = this->size();
+            const std::size_t back = std::min (this->scroll, held > rows ? held - rows : std::size_t{0});
+            const std::size_t last = this->n_total - back;
+            return { std::max (this->oldest(), last > rows ? last - rows : std::size_t{0}), last };
+        }
+
+        //! The runs of slots that hold the visible lines, in the order they are shown. The
+        //! second is empty unless the lines wrap around the end of the ring.
+        std::array<span, 2> visible_spans (const std::size_t rows) const
+        {
+            std::array<span, 2> sp = {};
+            const auto [first, last] = this->visible (rows);
+            if (first == last) { return sp; }
+            const std::size_t s0 = this->slot_of (first);
+            sp[0] = { s0, std::min (last - first, this->lines.size() - s0), 0 };
+            if (sp[0].n < last - first) { sp[1] = { 0, last - first - sp[0].n, sp[0].n }; }
+            return sp;
+        }
+
+    private:
+        std::vector<std::basic_string<char32_t>> lines;
+        std::size_t columns = 0;
+        //! Lines ever appended, and those whose quads were written (see pending)
+        std::size_t n_total = 0;
+        std::size_t n_uploaded = 0;
+        std::size_t scroll = 0;
+    };
+
+} // namespace mplot
@@ -0,0 +1,265 @@
+/*!
+ * \file
+ *
+ * Contour lines (isolines) of a 2D field, for mplot::ContourVisual. The field is given at the
+ * vertices of a mesh of cells: quads for a rectangular grid (marching squares) or triangles for
+ * the dual triangulation of a hexgrid (marching triangles). The segments that cross each cell
+ * are joined into strips, so that each contour is one polyline rather than one line per cell.
+ *
+ * Levels are traced in parallel, and their strips are gathered into one buffer of points in the
+ * order of the levels, so the output does not depend on the number of threads.
+ *
+ * \author Seb James
+ * \date 2026
+ */
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <span>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+#include <sm/vec>
+
+namespace mplot {
+    namespace contours {
+
+        //! One contour line: points [first, first + count) of a lines' points
+        struct strip
+        {
+            std::size_t first = 0;
+            std::size_t count = 0;
+            //! The index of the strip's level
+            unsigned int level = 0;
+            //! True if the strip is a loop (its last point repeats its first)
+            bool closed = false;
+        };
+
+        //! The contours of a field: the points of all the strips, in one buffer
+        struct lines
+        {
+            std::vector<sm::vec<float>> points;
+            std::vector<strip> strips;
+
+            //! Empty the lines, keeping their storage
+            void clear()
+            {
+                this->points.clear();
+                this->strips.clear();
+            }
+
+            std::span<const sm::vec<float>> strip_points (const std::size_t i) const
+            {
+                return std::span<const sm::vec<float>>(this->points).subspan (this->strips[i].first, this->strips[i].count);
+            }
+        };
+
+        /*!
+         * Make each cell (N vertex indices) anticlockwise in the xy plane, which the tracing needs
+         * in order to join its segments into strips.
+         */
+        template <std::size_t N>
+        void make_anticlockwise (std::span<const sm::vec<float>> positions, std::vector<std::array<unsigned int, N>>& cells)
+        {
+            for (auto& c : cells) {
+                float a2 = 0.0f;
+                for (std::size_t k = 0; k < N; ++k) {
+                    const sm::vec<float>& p = positions[c[k]];
+                    const sm::vec<float>& q = positions[c[(k + 1u) % N]];
+                    a2 += p[0] * q[1] - q[0] * p[1];
+                }
+                if (a2 < 0.0f) { std::reverse (c.begin(), c.end()); }
+            }
+        }
+
+        namespace detail {
+
+            //! The key of the edge between vertices a and b
+            inline std::uint64_t edge_key (const unsigned int a, const unsigned int b)
+            {
+                return (std::uint64_t{std::min (a, b)} << 32) | std::uint64_t{std::max (a, b)};
+            }
+
+            //! A segment from a point on one edge to a point on another, with the values above
+            //! the level on its left
+            struct segment
+            {
+                std::uint64_t from = 0;
+                std::uint64_t to = 0;
+            };
+
+            /*!
+             * The segments that cross each cell at level, in the order of the cells. Each cell is
+             * anticlockwise, so that a segment that leaves a cell across an edge is met by the
+             * segment that enters the neighbouring cell there.
+             */
+            template <typename T, std::size_t N>
+            void cell_segments (std::span<const T> values, std::span<const std::array<unsigned int, N>> cells,
+                                const float level, std::vector<segment>& segs)
+            {
+                for (const auto& c : cells) {
+                    std::array<bool, N> above;
+                    unsigned int n_above = 0;
+                    for (std::size_t k = 0; k < N; ++k) {
+                        above[k] = static_cast<float>(values[c[k]]) > level;
+                        n_above += above[k] ? 1u : 0u;
+                    }
+                    if (n_above == 0u || n_above == N) { continue; }
+                    // Going anticlockwise, a segment starts on an edge from above to below the
+                    // level and ends on an edge from below to above it
+                    std::array<unsigned int, N> downs, ups;
+                    unsigned int nd = 0, nu = 0;
+                    for (unsigned int k = 0; k < N; ++k) {
+                        const unsigned int k1 = (k + 1u) % N;
+                        if (above[k] && !above[k1]) { downs[nd++] = k; }
+                        if (!above[k] && above[k1]) { ups[nu++] = k; }
+                    }
+                    auto key = [&c](const unsigned int k) { return edge_key (c[k], c[(k + 1u) % N]); };
+                    if (nd == 1u) {
+                        segs.push_back ({ key (downs[0]), key (ups[0]) });
+                    } else {
+                        // A saddle of a quad, which the value at the centre of the cell resolves:
+                        // if it is above the level, the segments cut off the corners below it
+                        float mean = 0.0f;
+                        for (std::size_t k = 0; k < N; ++k) { mean += static_cast<float>(values[c[k]]); }
+                        const bool centre_above = mean / static_cast<float>(N) > level;
+                        for (unsigned int i = 0; i < nd; ++i) {
+                            const unsigned int d = downs[i];
+                            const unsigned int u = centre_above ? (d + 1u) % N : (d + N - 1u) % N;
+                            segs.push_back ({ key (d), key (u) });
+                        }
+                    }
+                }
+            }
+
+            //! The point at which the field crosses level on the edge with key k
+            template <typename T>
+            sm::vec<float> edge_point (std::span<const sm::vec<float>> positions, std::span<const T> values,
+                                       const std::uint64_t k, const float level)
+            {
+                const unsigned int a = static_cast<unsigned int>(k >> 32);
+                const unsigned int b = static_cast<unsigned int>(k & 0xffffffffu);
+                const float va = static_cast<float>(values[a]);
+                const float vb = static_cast<float>(values[b]);
+                const float t = va == vb ? 0.5f : std::clamp ((level - va) / (vb - va), 0.0f, 1.0f);
+                return positions[a] + (positions[b] - positions[a]) * t;
+            }
+
+            /*!
+             * Join the segments into strips, appended to out. A segment's end is the start of at
+             * most one other, so the open strips (those that meet the edge of the mesh) are
+             * followed from the segments that nothing leads into, and the segments left over
+             * form loops.
+             */
+            template <typename T>
+            void join (std::span<const sm::vec<float>> positions, std::span<const T> values, const std::vector<segment>& segs,
+                       const float level, const unsigned int level_index, lines& out)
+            {
+                std::unordered_map<std::uint64_t, std::size_t> starting;
+                std::unordered_map<std::uint64_t, std::size_t> ending;
+                starting.reserve (segs.size());
+                ending.reserve (segs.size());
+                for (std::size_t i = 0; i < segs.size(); ++i) {
+                    starting.emplace (segs[i].from, i);
+                    ending.emplace (segs[i].to, i);
+                }
+                std::vector<bool> used (segs.size(), false);
+                auto follow = [&](std::size_t i, const bool closed) {
+                    strip s;
+                    s.first = out.points.size();
+                    s.level = level_index;
+                    s.closed = closed;
+                    out.points.push_back (edge_point (positions, values, segs[i].from, level));
+                    while (!used[i]) {
+                        used[i] = true;
+                        out.points.push_back (edge_point (positions, values, segs[i].to, level));
+                        auto next = starting.find (segs[i].to);
+                        if (next == starting.end()) { break; }
+                        i = next->second;
+                    }
+                    s.count = out.points.size() - s.first;
+                    out.strips.push_back (s);
+                };
+                for (std::size_t i = 0; i < segs.size(); ++i) {
+                    if (!used[i] && ending.find (segs[i].from) == ending.end()) { follow (i, false); }
+                }
+                for (std::size_t i = 0; i < segs.size(); ++i) {
+                    if (!used[i]) { follow (i, true); }
+                }
+            }
+
+        } // namespace detail
+
+        /*!
+         * Trace the contours of the field values (one per position) at each of levels, across
+         * cells whose N vertices are anticlockwise (see make_anticlockwise), into out. The
+         * levels are traced on n_threads threads (0 for one per hardware thread). out is
+         * cleared first, but keeps its storage, so reusing it as the field changes allocates
+         * only when the contours grow.
+         */
+        template <typename T, std::size_t N>
+        void trace (std::span<const sm::vec<float>> positions, std::span<const T> values,
+                    std::span<const std::array<unsigned int, N>> cells, std::span<const float> levels,
+                    lines& out, unsigned int n_threads = 0)
+        {
+            static_assert (N == 3 || N == 4, "mplot::contours::trace: cells are triangles or quads");
+            if (values.size() < positions.size()) {
+                throw std::runtime_error ("mplot::contours::trace: there are fewer values than positions");
+            }
+            out.clear();
+            const unsigned int n_levels = static_cast<unsigned int>(levels.size());
+            if (n_levels == 0u) { return; }
+            std::vector<lines> per_level (n_levels);
+
+            if (n_threads == 0) { n_threads = std::thread::hardware_concurrency(); }
+            n_threads = std::max (1u, std::min (n_threads, n_levels));
+            std::atomic<unsigned int> next_level = 0;
+            std::vector<std::exception_ptr> errors (n_threads);
+            auto worker = [&](unsigned int ti) {
+                try {
+                    std::vector<detail::segment> segs;
+                    for (unsigned int l = next_level++; l < n_levels; l = next_level++) {
+                        segs.clear();
+                        detail::cell_segments (values, cells, levels[l], segs);
+                        detail::join (positions, values, segs, levels[l], l, per_level[l]);
+                    }
+                } catch (...) {
+                    errors[ti] = std::current_exception();
+                    next_level = n_levels;
+                }
+            };
+            std::vector<std::thread> workers;
+            for (unsigned int ti = 1; ti < n_threads; ++ti) { workers.emplace_back (worker, ti); }
+            worker (0);
+            for (auto& w : workers) { w.join(); }
+            for (auto& e : errors) {
+                if (e) { std::rethrow_exception (e); }
+            }
+
+            // Gather the levels into the one buffer
+            std::size_t np = 0, ns = 0;
+            for (const auto& pl : per_level) {
+                np += pl.points.size();
+                ns += pl.strips.size();
+            }
+            out.points.reserve (np);
+            out.strips.reserve (ns);
+            for (const auto& pl : per_level) {
+                const std::size_t base = out.points.size();
+                out.points.insert (out.points.end(), pl.points.begin(), pl.points.end());
+                for (strip s : pl.strips) {
+                    s.first += base;
+                    out.strips.push_back (s);
+                }
+            }
+        }
+
+    } // namespace contours
+} // namespace mplot
@@ -0,0 +1,192 @@
+/*!
+ * \file
+ *
+ * Convolutions of the data on a grid: a general 2D kernel or a separable one (a row kernel then
+ * a column kernel) over a rectangular grid of w by h values in rows, and a set of taps over the
+ * neighbourhoods of the hexes of an sm::hexgrid, found by walking its neighbour table. These are
+ * the CPU reference of the compute shaders in mplot::gl::convolution_kernels (see
+ * mplot/gl/convolution_kernels.h), which do the same sums, in the same order, for fields too large
+ * to convolve on every frame on the CPU.
+ *
+ * The kernels are not flipped: the output at x is the sum, over the kernel's taps, of each tap's
+ * weight times the input at x plus the tap's offset (for the symmetric kernels of smoothing or of
+ * edge detection, this is the same as a convolution).
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+
+namespace mplot {
+
+    //! What a rectangular convolution reads beyond the edges of the grid
+    enum class edge_mode : unsigned int
+    {
+        //! Zero
+        zero,
+        //! The nearest edge value
+        clamp,
+        //! The value from the opposite edge (for a periodic grid)
+        wrap
+    };
+
+    //! One weight of a hex kernel, at the hex reached by dr steps east and then dg steps north east
+    struct hex_tap
+    {
+        int dr = 0;
+        int dg = 0;
+        float w = 0.0f;
+    };
+
+    struct convolution
+    {
+        //! The neighbours of a hex: east, north east, north west, west, south west and south east (-1 for none)
+        using hex_neighbours = std::array<int, 6>;
+
+        //! The input at column x, row y of the w by h grid in, read beyond the edges by edge
+        static float rect_at (const std::vector<float>& in, const int w, const int h, int x, int y, const edge_mode edge)
+        {
+            if (edge == edge_mode::clamp) {
+                x = std::clamp (x, 0, w - 1);
+                y = std::clamp (y, 0, h - 1);
+            } else if (edge == edge_mode::wrap) {
+                x = ((x % w) + w) % w;
+                y = ((y % h) + h) % h;
+            } else if (x < 0 || y < 0 || x >= w || y >= h) {
+                return 0.0f;
+            }
+            return in[static_cast<std::size_t>(y) * w + x];
+        }
+
+        /*!
+         * Convolve the w by h grid in with the kw by kh kernel k (in rows, centred on its middle
+         * tap, so kw and kh should be odd)
+         */
+        static std::vector<float> rect (const std::vector<float>& in, const int w, const int h,
+                                        const std::vector<float>& k, const int kw, const int kh,
+                                        const edge_mode edge = edge_mode::zero)
+        {
+            std::vector<float> out (static_cast<std::size_t>(w) * h, 0.0f);
+            for (int y = 0; y < h; ++y) {
+                for (int x = 0; x < w; ++x) {
+                    float s = 0.0f;
+                    for (int j = 0; j < kh; ++j) {
+                        for (int i = 0; i < kw; ++i) {
+                            s += k[static_cast<std::size_t>(j) * kw + i] * convolution::rect_at (in, w, h, x + i - kw / 2, y + j - kh / 2, edge);
+                        }
+                    }
+                    out[static_cast<std::size_t>(y) * w + x] = s;
+                }
+            }
+            return out;
+        }
+
+        //! Convolve the w by h grid in along its rows (dir 0) or its columns (dir 1) with the centred 1D kernel k
+        static std::vector<float> line (const std::vector<float>& in, const int w, const int h, const std::vector<float>& k,
+                                        const unsigned int dir, const edge_mode edge = edge_mode::zero)
+        {
+            std::vector<float> out (static_cast<std::size_t>(w) * h, 0.0f);
+            const int kn = static_cast<int>(k.size());
+            for (int y = 0; y < h; ++y) {
+                for (int x = 0; x < w; ++x) {
+                    float s = 0.0f;
+                    for (int i = 0; i < kn; ++i) {
+                        const int o = i - kn / 2;
+                        s += k[i] * (dir == 0u ? convolution::rect_at (in, w, h, x + o, y, edge) : convolution::rect_at (in, w, h, x, y + o, edge));
+                    }
+                    out[static_cast<std::size_t>(y) * w + x] = s;
+                }
+            }
+            return out;
+        }
+
+        //! Convolve the w by h grid in with the separable kernel of row kernel kx and column kernel ky
+        static std::vector<float> separable (const std::vector<float>& in, const int w, const int h,
+                                             const std::vector<float>& kx, const std::vector<float>& ky,
+                                             const edge_mode edge = edge_mode::zero)
+        {
+            return convolution::line (convolution::line (in, w, h, kx, 0u, edge), w, h, ky, 1u, edge);
+        }
+
+        //! The 2 * radius + 1 taps of a Gaussian of sigma (in taps), normalised to sum to 1
+        static std::vector<float> gaussian (const float sigma, const int radius)
+        {
+            std::vector<float> k (2 * static_cast<std::size_t>(std::max (radius, 0)) + 1, 0.0f);
+            float sum = 0.0f;
+            for (int i = -radius; i <= radius; ++i) {
+                const float g = sigma > 0.0f ? std::exp (-static_cast<float>(i * i) / (2.0f * sigma * sigma)) : (i == 0 ? 1.0f : 0.0f);
+                k[i + radius] = g;
+                sum += g;
+            }
+            for (float& g : k) { g /= sum; }
+            return k;
+        }
+
+        //! The neighbour table of the hexgrid hg, from its d_ne ... d_nse
+        template <typename H>
+        static std::vector<hex_neighbours> neighbours_of (const H& hg)
+        {
+            std::vector<hex_neighbours> nb (hg.num());
+            for (std::size_t i = 0; i < nb.size(); ++i) {
+                nb[i] = { static_cast<int>(hg.d_ne[i]), static_cast<int>(hg.d_nne[i]), static_cast<int>(hg.d_nnw[i]),
+                          static_cast<int>(hg.d_nw[i]), static_cast<int>(hg.d_nsw[i]), static_cast<int>(hg.d_nse[i]) };
+            }
+            return nb;
+        }
+
+        //! The hex reached from hex i by dr steps east (west if negative) then dg steps north east (south west), or -1
+        static int hex_walk (const std::vector<hex_neighbours>& nb, int i, const int dr, const int dg)
+        {
+            for (int s = 0; s < std::abs (dr) && i >= 0; ++s) { i = nb[i][dr > 0 ? 0 : 3]; }
+            for (int s = 0; s < std::abs (dg) && i >= 0; ++s) { i = nb[i][dg > 0 ? 1 : 4]; }
+            return i;
+        }
+
+        /*!
+         * Convolve the data in on the hexes of the neighbour table nb with taps. A tap whose
+         * walk leaves the grid adds nothing (so near a boundary, the sum of the taps that are
+         * used is less than that of the kernel).
+         */
+        static std::vector<float> hex (const std::vector<float>& in, const std::vector<hex_neighbours>& nb, const std::vector<hex_tap>& taps)
+        {
+            std::vector<float> out (nb.size(), 0.0f);
+            for (std::size_t i = 0; i < nb.size(); ++i) {
+                float s = 0.0f;
+                for (const hex_tap& t : taps) {
+                    const int j = convolution::hex_walk (nb, static_cast<int>(i), t.dr, t.dg);
+                    if (j >= 0) { s += t.w * in[j]; }
+                }
+                out[i] = s;
+            }
+            return out;
+        }
+
+        //! The taps of a Gaussian of sigma (in hex spacings) over the hexes within radius steps, normalised to sum to 1
+        static std::vector<hex_tap> hex_gaussian (const float sigma, const int radius)
+        {
+            std::vector<hex_tap> taps;
+            const float root_3_over_2 = std::sqrt (3.0f) / 2.0f;
+            float sum = 0.0f;
+            for (int dg = -radius; dg <= radius; ++dg) {
+                for (int dr = -radius; dr <= radius; ++dr) {
+                    if ((std::abs (dr) + std::abs (dg) + std::abs (dr + dg)) / 2 > radius) { continue; }
+                    const float x = static_cast<float>(dr) + 0.5f * static_cast<float>(dg);
+                    const float y = root_3_over_2 * static_cast<float>(dg);
+                    const float g = sigma > 0.0f ? std::exp (-(x * x + y * y) / (2.0f * sigma * sigma)) : (dr == 0 && dg == 0 ? 1.0f : 0.0f);
+                    taps.push_back ({ dr, dg, g });
+                    sum += g;
+                }
+            }
+            for (hex_tap& t : taps) { t.w /= sum; }
+            return taps;
+        }
+    };
+
+} // namespace mplot
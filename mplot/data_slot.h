@@ -0,0 +1,131 @@
+/*!
+ * \file
+ *
+ * Lock-free handoff of data from a simulation thread to the render thread. A triple_buffer holds
+ * three copies of a value: the writer fills one and publishes it, the reader takes the most
+ * recently published one, and the third is the one in between. Neither side ever waits for the
+ * other, and the reader always sees a complete value.
+ *
+ * A data_slot is a triple_buffer of the scalar and vector data of a VisualDataModel. A simulation
+ * thread writes into the slot and publishes, without touching GL (or the Visual's context
+ * mutex). The model takes the latest data at the start of its render() and rebuilds from it (see
+ * VisualDataModel::setDataSlot).
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include <sm/vec>
+
+namespace mplot {
+
+    /*!
+     * A single-producer, single-consumer triple buffer. Only the writer may call write_buffer()
+     * and publish(); only the reader may call update() and read_buffer().
+     */
+    template <typename T>
+    class triple_buffer
+    {
+    public:
+        //! The buffer for the writer to fill. It holds whatever was published two publishes ago
+        //! (or a default T), so its capacity is reused.
+        T& write_buffer() { return this->bufs[this->back]; }
+
+        //! Hand the write buffer to the reader, replacing any value that it has not yet taken
+        void publish()
+        {
+            const std::uint8_t old = this->middle.exchange (this->back | fresh_bit, std::memory_order_acq_rel);
+            this->back = old & index_mask;
+        }
+
+        //! Take the latest published value, if there is one that the reader has not yet taken.
+        //! Returns true if read_buffer() has changed.
+        bool update()
+        {
+            if ((this->middle.load (std::memory_order_acquire) & fresh_bit) == 0) { return false; }
+            const std::uint8_t old = this->middle.exchange (this->front, std::memory_order_acq_rel);
+            this->front = old & index_mask;
+            return true;
+        }
+
+        //! The value most recently taken by update(). It is unchanged until the next update().
+        const T& read_buffer() const { return this->bufs[this->front]; }
+
+        //! True if a value has been published that the reader has not yet taken
+        bool fresh() const { return (this->middle.load (std::memory_order_acquire) & fresh_bit) != 0; }
+
+    private:
+        static constexpr std::uint8_t index_mask = 0x3;
+        static constexpr std::uint8_t fresh_bit = 0x4;
+
+        std::array<T, 3> bufs = {};
+        //! The index of the buffer in the middle, and the fresh_bit if it was published but not yet taken
+        std::atomic<std::uint8_t> middle = 1;
+        //! The writer's buffer (used only by the writer)
+        std::uint8_t back = 0;
+        //! The reader's buffer (used only by the reader)
+        std::uint8_t front = 2;
+    };
+
+    /*!
+     * The scalar and/or vector data of a VisualDataModel, handed from a simulation thread to the
+     * render thread. Fill write() (leaving unused members empty) and call publish().
+     */
+    template <typename T>
+    class data_slot
+    {
+    public:
+        struct frame
+        {
+            std::vector<T> scalars;
+            std::vector<sm::vec<T>> vectors;
+        };
+
+        //! The frame for the simulation thread to fill
+        frame& write() { return this->buf.write_buffer(); }
+
+        //! Publish the frame filled through write(), and tell the Visual that it should render
+        void publish()
+        {
+            this->buf.publish();
+            std::lock_guard<std::mutex> lock (this->notify_mutex);
+            if (this->notify) { this->notify(); }
+        }
+
+        //! Called by the model: take the latest frame, if there is a new one
+        bool take() { return this->buf.update(); }
+
+        //! The frame most recently taken
+        const frame& latest() const { return this->buf.read_buffer(); }
+
+        //! True if a frame has been published but not yet taken
+        bool fresh() const { return this->buf.fresh(); }
+
+        /*!
+         * Set the function that publish() calls, on the simulation thread, after each publish.
+         * VisualDataModel::setDataSlot sets it to request a redraw of the model's Visual (which
+         * is safe from any thread). Only publish() and set_notify take the mutex that guards it,
+         * so it may be changed (or cleared with nullptr) while the simulation publishes, and
+         * the old function is no longer running once set_notify returns.
+         */
+        void set_notify (std::function<void()> f)
+        {
+            std::lock_guard<std::mutex> lock (this->notify_mutex);
+            this->notify = std::move (f);
+        }
+
+    private:
+        triple_buffer<frame> buf;
+        std::mutex notify_mutex;
+        std::function<void()> notify;
+    };
+
+} // namespace mplot
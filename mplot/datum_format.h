@@ -0,0 +1,123 @@
+/*!
+ * \file
+ *
+ * The formats in which a VisualModel's datum texture (see VisualModelBase::datum_texture_format)
+ * may be held on the GPU, and the packing of float datums into them. The datums of the texture
+ * modes are colour scaled into [0,1] before they are uploaded, so 16 bits (or, for most colour
+ * maps, 8) hold all that a colour lookup can show. A packed texture halves (or quarters) the
+ * bytes uploaded per frame, and the texels are read back as floats by the shaders with no
+ * change to the GLSL.
+ *
+ * \author Seb James
+ * \date 2026
+ */
+
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace mplot {
+
+    //! The storage of the texels of a datum texture
+    enum class datum_format
+    {
+        float32, // GL_R32F: the datums as they are
+        float16, // GL_R16F: half floats, with an 11 bit significand
+        unorm16, // GL_R16: [0,1] in 65536 steps (GL_R16F on OpenGL ES, which lacks GL_R16)
+        unorm8   // GL_R8: [0,1] in 256 steps
+    };
+
+    namespace datum_pack {
+
+        //! The bytes per texel of format f
+        constexpr std::size_t bytes (const datum_format f)
+        {
+            return f == datum_format::float32 ? 4u : (f == datum_format::unorm8 ? 1u : 2u);
+        }
+
+        //! f as an IEEE 754 half float, rounded to the nearest (ties to even)
+        inline std::uint16_t to_half (const float f)
+        {
+            const std::uint32_t x = std::bit_cast<std::uint32_t>(f);
+            const std::uint32_t sign = (x >> 16) & 0x8000u;
+            const std::uint32_t ax = x & 0x7fffffffu;
+            if (ax >= 0x7f800000u) { // infinity, or NaN (kept quiet)
+                return static_cast<std::uint16_t>(sign | 0x7c00u | (ax > 0x7f800000u ? 0x200u : 0u));
+            }
+            if (ax >= 0x477ff000u) { return static_cast<std::uint16_t>(sign | 0x7c00u); } // rounds past 65504
+            if (ax < 0x38800000u) {
+                // Below the smallest normal half, 2^-14: in units of the smallest subnormal, 2^-24
+                const float a = std::bit_cast<float>(ax);
+                return static_cast<std::uint16_t>(sign | static_cast<std::uint32_t>(std::nearbyint (a * 16777216.0f)));
+            }
+            // Re-bias the exponent and drop 13 bits of the significand, rounding half to even. A
+            // carry out of the significand correctly increments the exponent.
+            std::uint32_t h = (ax - 0x38000000u) >> 13;
+            const std::uint32_t rem = ax & 0x1fffu;
+            if (rem > 0x1000u || (rem == 0x1000u && (h & 1u))) { ++h; }
+            return static_cast<std::uint16_t>(sign | h);
+        }
+
+        //! The float value of half float h
+        inline float from_half (const std::uint16_t h)
+        {
+            const std::uint32_t sign = (std::uint32_t{h} & 0x8000u) << 16;
+            const std::uint32_t e = (h >> 10) & 0x1fu;
+            const std::uint32_t m = h & 0x3ffu;
+            if (e == 0u) {
+                const float v = std::ldexp (static_cast<float>(m), -24);
+                return sign ? -v : v;
+            }
+            if (e == 31u) { return std::bit_cast<float>(sign | 0x7f800000u | (m << 13)); }
+            return std::bit_cast<float>(sign | ((e + 112u) << 23) | (m << 13));
+        }
+
+        //! d in [0,1] as an unsigned normalized integer of max steps. NaN is packed as 0.
+        template <typename U>
+        inline U to_unorm (const float d)
+        {
+            constexpr float max = static_cast<float>(static_cast<U>(~U{0}));
+            if (!(d > 0.0f)) { return U{0}; }
+            if (d >= 1.0f) { return static_cast<U>(~U{0}); }
+            return static_cast<U>(std::lround (d * max));
+        }
+
+        //! Pack the n datums from src into dst, which has room for n * bytes (f) bytes
+        inline void pack (const datum_format f, const float* src, const std::size_t n, unsigned char* dst)
+        {
+            switch (f) {
+            case datum_format::float32:
+            {
+                std::memcpy (dst, src, n * sizeof (float));
+                break;
+            }
+            case datum_format::float16:
+            {
+                for (std::size_t i = 0; i < n; ++i) {
+                    const std::uint16_t h = to_half (src[i]);
+                    std::memcpy (dst + 2u * i, &h, 2u);
+                }
+                break;
+            }
+            case datum_format::unorm16:
+            {
+                for (std::size_t i = 0; i < n; ++i) {
+                    const std::uint16_t u = to_unorm<std::uint16_t> (src[i]);
+                    std::memcpy (dst + 2u * i, &u, 2u);
+                }
+                break;
+            }
+            case datum_format::unorm8:
+            {
+                for (std::size_t i = 0; i < n; ++i) { dst[i] = to_unorm<std::uint8_t> (src[i]); }
+                break;
+            }
+            }
+        }
+
+    } // namespace datum_pack
+} // namespace mplot
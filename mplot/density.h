@@ -0,0 +1,169 @@
+/*!
+ * \file
+ *
+ * 2D density binning for the density mode of mplot::ScatterVisual. The x and y of each point
+ * are counted into a rectangle of bins in data space, so a scatter set of tens of millions of
+ * points becomes one texture of counts, whose cost to draw does not depend on the number of
+ * points. The points are binned on several threads, each into its own histogram, and the
+ * histograms are then summed, so the counts do not depend on the number of threads.
+ *
+ * \author Seb James
+ * \date 2026
+ */
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <span>
+#include <thread>
+#include <exception>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <sm/vec>
+
+namespace mplot {
+    namespace density {
+
+        //! A rectangle of bins from lo to hi in x and y, dims[0] bins wide and dims[1] high
+        struct bin_grid
+        {
+            std::array<float, 2> lo = { 0.0f, 0.0f };
+            std::array<float, 2> hi = { 1.0f, 1.0f };
+            std::array<unsigned int, 2> dims = { 256u, 256u };
+
+            //! The index of the bin (in rows of dims[0]) that holds p, or -1 for a point outside
+            //! the rectangle (or with a NaN coordinate). Points on hi go in the last bin.
+            std::int64_t bin_of (const sm::vec<float>& p) const
+            {
+                std::array<std::int64_t, 2> b = { 0, 0 };
+                for (unsigned int j = 0; j < 2u; ++j) {
+                    const float x = p[j];
+                    if (!(x >= this->lo[j] && x <= this->hi[j])) { return -1; }
+                    const float u = this->hi[j] > this->lo[j] ? (x - this->lo[j]) / (this->hi[j] - this->lo[j]) : 0.0f;
+                    b[j] = std::min (static_cast<std::int64_t>(u * static_cast<float>(this->dims[j])),
+                                     static_cast<std::int64_t>(this->dims[j]) - 1);
+                }
+                return b[1] * this->dims[0] + b[0];
+            }
+
+            std::size_t size() const { return std::size_t{this->dims[0]} * this->dims[1]; }
+        };
+
+        namespace detail {
+            //! Run job (chunk) for chunks [0, n_threads) of work, one on each thread, rethrowing
+            //! the first exception
+            template <typename F>
+            void for_each_chunk (const unsigned int n_threads, F&& job)
+            {
+                std::vector<std::exception_ptr> errors (n_threads);
+                auto worker = [&](unsigned int ti) {
+                    try {
+                        job (ti);
+                    } catch (...) {
+                        errors[ti] = std::current_exception();
+                    }
+                };
+                std::vector<std::thread> workers;
+                for (unsigned int ti = 1; ti < n_threads; ++ti) { workers.emplace_back (worker, ti); }
+                worker (0);
+                for (auto& w : workers) { w.join(); }
+                for (auto& e : errors) {
+                    if (e) { std::rethrow_exception (e); }
+                }
+            }
+
+            inline unsigned int threads_for (unsigned int n_threads, const std::size_t n)
+            {
+                if (n_threads == 0) { n_threads = std::thread::hardware_concurrency(); }
+                // Below a few thousand points per thread, the threads cost more than they save
+                constexpr std::size_t min_per_thread = 4096;
+                const std::size_t most = std::max (std::size_t{1}, n / min_per_thread);
+                return static_cast<unsigned int>(std::max (std::size_t{1}, std::min (std::size_t{n_threads}, most)));
+            }
+        } // namespace detail
+
+        //! The range of the x and y coordinates of points, as a bin_grid of dims bins. NaN
+        //! coordinates are skipped.
+        inline bin_grid extent (std::span<const sm::vec<float>> points, const std::array<unsigned int, 2>& dims,
+                                unsigned int n_threads = 0)
+        {
+            n_threads = detail::threads_for (n_threads, points.size());
+            constexpr float inf = std::numeric_limits<float>::infinity();
+            std::vector<std::array<float, 4>> ranges (n_threads, { inf, inf, -inf, -inf });
+            detail::for_each_chunk (n_threads, [&](const unsigned int ti) {
+                const std::size_t b = points.size() * ti / n_threads;
+                const std::size_t e = points.size() * (ti + 1u) / n_threads;
+                std::array<float, 4>& r = ranges[ti];
+                for (std::size_t i = b; i < e; ++i) {
+                    for (unsigned int j = 0; j < 2u; ++j) {
+                        const float x = points[i][j];
+                        if (x < r[j]) { r[j] = x; }
+                        if (x > r[2u + j]) { r[2u + j] = x; }
+                    }
+                }
+            });
+            bin_grid g;
+            g.dims = dims;
+            g.lo = { inf, inf };
+            g.hi = { -inf, -inf };
+            for (const auto& r : ranges) {
+                for (unsigned int j = 0; j < 2u; ++j) {
+                    g.lo[j] = std::min (g.lo[j], r[j]);
+                    g.hi[j] = std::max (g.hi[j], r[2u + j]);
+                }
+            }
+            // No points (or all NaN) give the unit square
+            for (unsigned int j = 0; j < 2u; ++j) {
+                if (!(g.hi[j] >= g.lo[j])) { g.lo[j] = 0.0f; g.hi[j] = 1.0f; }
+            }
+            return g;
+        }
+
+        /*!
+         * Count the points in each bin of g into counts (g.size() of them, in rows of g.dims[0]),
+         * on n_threads threads (0 for one per hardware thread). Points outside g are not
+         * counted. Returns the largest count.
+         */
+        inline float bin (std::span<const sm::vec<float>> points, const bin_grid& g, std::vector<float>& counts,
+                          unsigned int n_threads = 0)
+        {
+            n_threads = detail::threads_for (n_threads, points.size());
+            const std::size_t nb = g.size();
+            // Each thread counts into its own histogram
+            std::vector<std::vector<std::uint32_t>> hists (n_threads);
+            detail::for_each_chunk (n_threads, [&](const unsigned int ti) {
+                std::vector<std::uint32_t>& h = hists[ti];
+                h.assign (nb, 0u);
+                const std::size_t b = points.size() * ti / n_threads;
+                const std::size_t e = points.size() * (ti + 1u) / n_threads;
+                for (std::size_t i = b; i < e; ++i) {
+                    const std::int64_t k = g.bin_of (points[i]);
+                    if (k >= 0) { ++h[static_cast<std::size_t>(k)]; }
+                }
+            });
+            // Sum the histograms, again in parallel, over ranges of bins
+            counts.resize (nb);
+            const unsigned int n_sum = std::max (1u, std::min (n_threads, static_cast<unsigned int>((nb + 4095u) / 4096u)));
+            std::vector<float> maxes (n_sum, 0.0f);
+            detail::for_each_chunk (n_sum, [&](const unsigned int ti) {
+                const std::size_t b = nb * ti / n_sum;
+                const std::size_t e = nb * (ti + 1u) / n_sum;
+                for (std::size_t k = b; k < e; ++k) {
+                    std::uint64_t c = 0;
+                    for (const auto& h : hists) { c += h[k]; }
+                    counts[k] = static_cast<float>(c);
+                    maxes[ti] = std::max (maxes[ti], counts[k]);
+                }
+            });
+            return *std::max_element (maxes.begin(), maxes.end());
+        }
+
+        //! The texel for a bin of count c: c, or log(1 + c) on a log scale
+        inline float texel (const float c, const bool log_scale) { return log_scale ? std::log1p (c) : c; }
+
+    } // namespace density
+} // namespace mplot
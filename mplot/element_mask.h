@@ -0,0 +1,130 @@
+/*!
+ * \file
+ *
+ * An element_mask says which elements of a grid are drawn. This is what
+ * mplot::GridVisual::setMask and mplot::HexGridVisual::setMask take. A masked element emits no
+ * vertices and no indices and is left out of every colour update, so an irregular domain (the
+ * shape of a cortex, or a boundary read from an SVG) laid on a rectangular or hexagonal grid
+ * costs only what is inside it.
+ *
+ * The kept elements are given vertex blocks in order of element index. kept() lists them (block k
+ * is element kept()[k]) and slot (i) gives the block of element i. A mask can be made from one
+ * flag per element, from the NaNs of the data, or from a closed boundary around the elements'
+ * centres. An empty mask keeps every element.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <sm/vec>
+
+namespace mplot {
+
+    class element_mask
+    {
+    public:
+        //! The slot of an element that is masked out
+        static constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+
+        //! An empty mask, which keeps every element
+        element_mask() = default;
+
+        //! A mask from one flag per element: keep[i] is true to draw element i
+        explicit element_mask (const std::vector<bool>& keep) { this->set (keep); }
+
+        //! Keep the elements i for which keep[i] is true
+        void set (const std::vector<bool>& keep)
+        {
+            this->slots.assign (keep.size(), none);
+            this->kept_elements.clear();
+            for (std::size_t i = 0; i < keep.size(); ++i) {
+                if (!keep[i]) { continue; }
+                this->slots[i] = static_cast<std::uint32_t>(this->kept_elements.size());
+                this->kept_elements.push_back (static_cast<std::uint32_t>(i));
+            }
+        }
+
+        //! A mask that keeps the elements whose datum is not NaN
+        template <typename T>
+        static element_mask from_nan (const std::vector<T>& data)
+        {
+            std::vector<bool> keep (data.size(), true);
+            for (std::size_t i = 0; i < data.size(); ++i) { keep[i] = !std::isnan (data[i]); }
+            return element_mask (keep);
+        }
+
+        /*!
+         * A mask that keeps the n elements whose centres (from centre_of (i), an sm::vec<float,
+         * 2>) lie inside the closed polygon boundary (by the even-odd rule, so a boundary may
+         * include holes joined to it by a cut).
+         */
+        template <typename F>
+        static element_mask from_boundary (const std::size_t n, F centre_of, const std::vector<sm::vec<float, 2>>& boundary)
+        {
+            std::vector<bool> keep (n, false);
+            for (std::size_t i = 0; i < n; ++i) { keep[i] = element_mask::inside (centre_of (i), boundary); }
+            return element_mask (keep);
+        }
+
+        //! True if p is inside the closed polygon boundary (by the even-odd rule)
+        static bool inside (const sm::vec<float, 2>& p, const std::vector<sm::vec<float, 2>>& boundary)
+        {
+            bool in = false;
+            const std::size_t nb = boundary.size();
+            for (std::size_t i = 0, j = nb - 1; i < nb; j = i++) {
+                const sm::vec<float, 2>& a = boundary[i];
+                const sm::vec<float, 2>& b = boundary[j];
+                if ((a[1] > p[1]) != (b[1] > p[1])
+                    && p[0] < (b[0] - a[0]) * (p[1] - a[1]) / (b[1] - a[1]) + a[0]) {
+                    in = !in;
+                }
+            }
+            return in;
+        }
+
+        //! True if the mask keeps every element (it was never set)
+        bool empty() const { return this->slots.empty(); }
+
+        //! The number of elements the mask is for (0 if it is empty)
+        std::size_t size() const { return this->slots.size(); }
+
+        //! The number of elements drawn out of n (all n if the mask is empty)
+        std::size_t count (const std::size_t n) const { return this->empty() ? n : this->kept_elements.size(); }
+
+        //! True if element i is drawn
+        bool keeps (const std::size_t i) const { return this->empty() || (i < this->slots.size() && this->slots[i] != none); }
+
+        //! The element of block k (k itself if the mask is empty)
+        std::size_t element (const std::size_t k) const { return this->empty() ? k : this->kept_elements[k]; }
+
+        //! The block of element i (i itself if the mask is empty), or none if it is masked out
+        std::uint32_t slot (const std::size_t i) const
+        {
+            if (this->empty()) { return static_cast<std::uint32_t>(i); }
+            return i < this->slots.size() ? this->slots[i] : none;
+        }
+
+        //! The kept elements, in order of index (empty if the mask is empty)
+        const std::vector<std::uint32_t>& kept() const { return this->kept_elements; }
+
+        //! Copy the elements of from that are kept into to, in block order
+        template <typename V, typename W>
+        void gather (const V& from, W& to) const
+        {
+            to.resize (this->kept_elements.size());
+            for (std::size_t k = 0; k < this->kept_elements.size(); ++k) { to[k] = from[this->kept_elements[k]]; }
+        }
+
+    private:
+        std::vector<std::uint32_t> slots;
+        std::vector<std::uint32_t> kept_elements;
+    };
+
+} // namespace mplot
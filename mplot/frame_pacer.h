@@ -0,0 +1,125 @@
+/*!
+ * \file
+ *
+ * A frame_pacer decides when a simulation loop that calls Visual::maybe_render on every step
+ * should actually render. It can render at a target frame rate, once every N steps or once
+ * every T ms. It also measures what rendering costs and skips frames that would leave the
+ * simulation less than its share of the time (see frame_pacing::max_render_fraction), so a
+ * slow render never stalls the simulation, whatever the display's refresh rate.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace mplot {
+
+    //! When to render, given to Visual::setFramePacing
+    struct frame_pacing
+    {
+        enum class policy
+        {
+            //! Render on every call of maybe_render (subject to max_render_fraction)
+            every_call,
+            //! Render at no more than fps frames per second
+            target_fps,
+            //! Render at most once per steps calls of maybe_render
+            every_n_steps,
+            //! Render when at least interval_ms have passed since the last frame
+            interval
+        };
+        policy what = policy::target_fps;
+        double fps = 60.0;
+        unsigned int steps = 1;
+        double interval_ms = 100.0;
+        /*!
+         * The largest fraction of the wall time to spend rendering. A frame that is due is
+         * skipped if, since the end of the last frame, less than the measured render cost
+         * times (1 - f) / f has passed. 1 means never skip.
+         */
+        double max_render_fraction = 0.5;
+    };
+
+    class frame_pacer
+    {
+        using sc = std::chrono::steady_clock;
+
+    public:
+        frame_pacing pacing;
+
+        /*!
+         * Count a simulation step at time now, and return true if a frame should be rendered
+         * now. If it returns true, call rendered() once the frame has been drawn.
+         */
+        bool due (const sc::time_point now)
+        {
+            ++this->steps_since;
+            if (this->n_rendered == 0) { return true; }
+
+            bool policy_due = true;
+            const double since_start_ms = std::chrono::duration<double, std::milli>(now - this->last_start).count();
+            switch (this->pacing.what) {
+            case frame_pacing::policy::target_fps:
+                policy_due = this->pacing.fps <= 0.0 || since_start_ms >= 1000.0 / this->pacing.fps;
+                break;
+            case frame_pacing::policy::every_n_steps:
+                policy_due = this->steps_since >= this->pacing.steps;
+                break;
+            case frame_pacing::policy::interval:
+                policy_due = since_start_ms >= this->pacing.interval_ms;
+                break;
+            case frame_pacing::policy::every_call:
+            default:
+                break;
+            }
+            if (!policy_due) { return false; }
+
+            // Leave the simulation its share of the time
+            const double f = this->pacing.max_render_fraction;
+            if (f > 0.0 && f < 1.0) {
+                const double since_end_ms = std::chrono::duration<double, std::milli>(now - this->last_end).count();
+                if (since_end_ms < this->cost_ms * (1.0 - f) / f) {
+                    if (!this->skipping) { ++this->n_skipped; }
+                    this->skipping = true;
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        //! Record a frame that was rendered from start to end
+        void rendered (const sc::time_point start, const sc::time_point end)
+        {
+            const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+            // A moving average that follows changes in the scene within a few frames
+            this->cost_ms = this->n_rendered == 0 ? ms : 0.8 * this->cost_ms + 0.2 * ms;
+            this->last_start = start;
+            this->last_end = end;
+            this->steps_since = 0;
+            this->skipping = false;
+            ++this->n_rendered;
+        }
+
+        //! The measured cost of rendering a frame, in ms
+        double render_cost_ms() const { return this->cost_ms; }
+        //! The number of frames rendered
+        std::uint64_t frames_rendered() const { return this->n_rendered; }
+        //! The number of frames that were due but skipped to leave the simulation its time
+        std::uint64_t frames_skipped() const { return this->n_skipped; }
+
+    private:
+        double cost_ms = 0.0;
+        sc::time_point last_start = {};
+        sc::time_point last_end = {};
+        unsigned int steps_since = 0;
+        std::uint64_t n_rendered = 0;
+        std::uint64_t n_skipped = 0;
+        //! True while a due frame is being skipped (so that it is counted once)
+        bool skipping = false;
+    };
+
+} // namespace mplot
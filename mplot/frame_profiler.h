@@ -0,0 +1,245 @@
+/*!
+ * \file
+ *
+ * A frame_profiler records where the time of each frame that mplot::Visual renders goes, while
+ * profiling is on (see VisualBase::startProfiling). For each VisualModel that is drawn (and for
+ * the batch of batched models, the coordinate arrows and the scene's texts) it records the CPU
+ * time of the render() call, the GPU time of the GL commands that the call issued and counts of
+ * the draw calls, texture binds and bytes uploaded to buffers.
+ *
+ * GPU times come from GL timestamp queries, which are read back frames later, once the GPU has
+ * passed them, so the profiler never waits for the GPU. A frame's profile is therefore complete
+ * (and available from latest()) a frame or two after it was rendered.
+ *
+ * The profiler makes no GL calls itself: the Visual issues and reads the timestamp queries, whose
+ * ids the profiler keeps.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+namespace mplot {
+
+    //! Counts of the GL work done while rendering (see visgl::render_state)
+    struct render_counts
+    {
+        std::uint64_t draw_calls = 0;
+        std::uint64_t texture_binds = 0;
+        //! Bytes passed to glBufferData and glBufferSubData
+        std::uint64_t bytes_uploaded = 0;
+
+        render_counts operator- (const render_counts& rhs) const
+        {
+            return { this->draw_calls - rhs.draw_calls, this->texture_binds - rhs.texture_binds,
+                     this->bytes_uploaded - rhs.bytes_uploaded };
+        }
+    };
+
+    //! One part of a frame: the rendering of one model, of the batch, of the coord arrows or of the texts
+    struct profile_item
+    {
+        enum class kind { model, batch, coord_arrows, texts };
+        kind what = kind::model;
+        //! For kind::model, the model (compare with the pointer returned by Visual::addVisualModel)
+        const void* model = nullptr;
+        double cpu_ms = 0.0;
+        //! The GPU time, or -1 if the GPU could not be timed
+        double gpu_ms = -1.0;
+        render_counts counts;
+    };
+
+    //! The profile of one frame
+    struct frame_profile
+    {
+        //! The number of the frame, counted from startProfiling
+        std::uint64_t frame = 0;
+        //! The CPU time of the whole render() call
+        double cpu_ms = 0.0;
+        //! The GPU time from the start to the end of the frame's commands, or -1 if not timed
+        double gpu_ms = -1.0;
+        //! The work done in render()
+        render_counts counts;
+        //! Bytes uploaded since the previous frame, outside render() (by reinit_buffers, for example)
+        std::uint64_t bytes_uploaded_between = 0;
+        std::vector<profile_item> items;
+    };
+
+    //! A one line summary of a frame profile, as shown with visual_options::showProfile
+    inline std::string profile_summary (const frame_profile& fp)
+    {
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision (2) << "CPU " << fp.cpu_ms << " ms";
+        if (fp.gpu_ms >= 0.0) { ss << ", GPU " << fp.gpu_ms << " ms"; }
+        ss << ", " << fp.counts.draw_calls << " draws, " << fp.counts.texture_binds << " texture binds, "
+           << std::setprecision (1) << static_cast<double>(fp.counts.bytes_uploaded + fp.bytes_uploaded_between) / 1024.0
+           << " kB uploaded";
+        return ss.str();
+    }
+
+    class frame_profiler
+    {
+        using sc = std::chrono::steady_clock;
+
+    public:
+        //! The number of frames whose GPU times may be awaited at once
+        static constexpr std::size_t n_slots = 3;
+
+        //! If false, no GPU timestamps are taken, and profiles are complete at end_frame
+        bool gpu_timing = true;
+
+        //! Called with each frame's profile once it is complete
+        std::function<void(const frame_profile&)> on_profile;
+
+        /*!
+         * Start a frame. between holds the counts accumulated since the last frame. The slot for
+         * the frame is the oldest; if its GPU times have not yet been read, its frame is
+         * completed without them.
+         */
+        void begin_frame (const render_counts& between)
+        {
+            slot& s = this->slots[this->current];
+            if (s.awaiting_gpu) { this->complete (s); }
+            s.profile.frame = this->n_frames++;
+            s.profile.cpu_ms = 0.0;
+            s.profile.gpu_ms = -1.0;
+            s.profile.counts = {};
+            s.profile.bytes_uploaded_between = between.bytes_uploaded;
+            s.profile.items.clear();
+            s.n_stamps = 0;
+            s.t0 = sc::now();
+        }
+
+        //! Start an item of the current frame, given the counts so far in the frame
+        void begin_item (const profile_item::kind what, const void* model, const render_counts& now)
+        {
+            slot& s = this->slots[this->current];
+            s.profile.items.push_back ({ what, model, 0.0, -1.0, now });
+            this->item_t0 = sc::now();
+        }
+
+        //! End the current item (after its render call), given the counts so far
+        void end_item (const render_counts& now)
+        {
+            profile_item& it = this->slots[this->current].profile.items.back();
+            it.cpu_ms = std::chrono::duration<double, std::milli>(sc::now() - this->item_t0).count();
+            it.counts = now - it.counts;
+        }
+
+        //! End the frame, given its counts. Then call next_frame().
+        void end_frame (const render_counts& now)
+        {
+            slot& s = this->slots[this->current];
+            s.profile.cpu_ms = std::chrono::duration<double, std::milli>(sc::now() - s.t0).count();
+            s.profile.counts = now;
+        }
+
+        /*!
+         * The id of the GL query for the next timestamp of the current frame. It is 0 if the
+         * query has not yet been generated, in which case the caller generates it into the
+         * returned reference. A frame takes one timestamp as it begins, two for each item (as
+         * it begins and as it ends) and one as it ends.
+         */
+        unsigned int& stamp()
+        {
+            slot& s = this->slots[this->current];
+            if (s.n_stamps >= s.queries.size()) { s.queries.push_back (0); }
+            return s.queries[s.n_stamps++];
+        }
+
+        //! Move on from the frame that has just ended. It is complete once collect() has read its timestamps.
+        void next_frame()
+        {
+            slot& s = this->slots[this->current];
+            if (this->gpu_timing) {
+                s.awaiting_gpu = true;
+            } else {
+                this->complete (s);
+            }
+            this->current = (this->current + 1) % n_slots;
+        }
+
+        /*!
+         * Read the GPU times of the frames that await them, oldest first. read (queries, n, ns)
+         * writes the n timestamps of queries into ns (in nanoseconds) and returns true, or
+         * returns false if the GPU has not yet written them, in which case collection stops.
+         */
+        template <typename F>
+        void collect (F read)
+        {
+            // The current slot is the one used longest ago
+            for (std::size_t i = 0; i < n_slots; ++i) {
+                slot& s = this->slots[(this->current + i) % n_slots];
+                if (!s.awaiting_gpu) { continue; }
+                if (!read (s.queries, s.n_stamps, this->ns)) { break; }
+                this->apply_gpu_times (s);
+                this->complete (s);
+            }
+        }
+
+        //! Call f (id) for each GL query that has been generated (to delete them)
+        template <typename F>
+        void for_each_query (F f)
+        {
+            for (slot& s : this->slots) {
+                for (unsigned int& q : s.queries) { if (q != 0) { f (q); } q = 0; }
+            }
+        }
+
+        //! The most recent complete profile
+        const frame_profile& latest() const { return this->last; }
+
+        //! The number of complete profiles
+        std::uint64_t completed() const { return this->n_completed; }
+
+    private:
+        struct slot
+        {
+            frame_profile profile;
+            std::vector<unsigned int> queries;
+            std::size_t n_stamps = 0;
+            bool awaiting_gpu = false;
+            sc::time_point t0 = {};
+        };
+
+        //! From the timestamps in ns, set the GPU times of slot s (stamps 0 and n-1 bracket the frame)
+        void apply_gpu_times (slot& s)
+        {
+            const std::size_t n_items = s.profile.items.size();
+            if (s.n_stamps != 2u * n_items + 2u || this->ns.size() < s.n_stamps) { return; }
+            auto ms = [this](std::size_t a, std::size_t b) { return static_cast<double>(this->ns[b] - this->ns[a]) * 1e-6; };
+            for (std::size_t i = 0; i < n_items; ++i) { s.profile.items[i].gpu_ms = ms (2u * i + 1u, 2u * i + 2u); }
+            s.profile.gpu_ms = ms (0, s.n_stamps - 1u);
+        }
+
+        void complete (slot& s)
+        {
+            s.awaiting_gpu = false;
+            if (this->n_completed > 0 && s.profile.frame < this->last.frame) { return; }
+            this->last = s.profile;
+            ++this->n_completed;
+            if (this->on_profile) { this->on_profile (this->last); }
+        }
+
+        std::array<slot, n_slots> slots = {};
+        std::size_t current = 0;
+        sc::time_point item_t0 = {};
+        std::uint64_t n_frames = 0;
+        std::uint64_t n_completed = 0;
+        frame_profile last;
+        //! Timestamps read by collect
+        std::vector<std::uint64_t> ns;
+    };
+
+} // namespace mplot
@@ -0,0 +1,202 @@
+/*!
+ * \file
+ *
+ * A frame_recorder takes the frames that mplot::Visual captures while it is recording (see
+ * VisualBase::startRecording) and writes them out on a pool of encoder threads, either as a
+ * numbered sequence of PNG files or as raw RGBA frames written to a stream (such as a pipe to
+ * ffmpeg opened with popen).
+ *
+ * The frames wait in a bounded queue. The render thread never waits for the encoders; if the
+ * queue is full when a frame is captured, the frame is dropped and counted in the stats. A batch
+ * render, which must not lose a frame, sets recording_options::wait_when_full instead, so that
+ * acquire waits for an encoder to take a frame from the queue.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <utility>
+#include <algorithm>
+#include <sm/vec>
+#include <mplot/lodepng.h>
+
+namespace mplot {
+
+    //! How a Visual records its frames
+    struct recording_options
+    {
+        //! Frame n is written to file_prefix + n (zero padded to number_width digits) + ".png"
+        std::string file_prefix = "frame";
+        unsigned int number_width = 5;
+        //! If non-null, the frames are written to this stream as raw, top-row-first RGBA bytes instead of PNGs
+        std::FILE* raw_stream = nullptr;
+        //! The number of encoder threads (frames to a raw_stream are always written by one thread, in order)
+        unsigned int encoder_threads = 2;
+        //! The most frames that may wait for an encoder before new frames are dropped
+        std::size_t queue_capacity = 8;
+        //! If false, the alpha channel is set to 255 in the PNGs
+        bool transparent_bg = false;
+        //! If true, acquire waits for room in a full queue, rather than dropping the frame
+        bool wait_when_full = false;
+    };
+
+    //! Counts of the frames that a frame_recorder has handled
+    struct recording_stats
+    {
+        //! Frames that were queued for encoding
+        std::size_t captured = 0;
+        //! Frames that were written out
+        std::size_t written = 0;
+        //! Frames that were dropped because the queue was full
+        std::size_t dropped = 0;
+        //! Frames that could not be written
+        std::size_t failed = 0;
+        //! Frames waiting in the queue now, and the most that have waited at once
+        std::size_t queued = 0;
+        std::size_t queue_high_water = 0;
+    };
+
+    class frame_recorder
+    {
+    public:
+        frame_recorder (const recording_options& _opts) : opts (_opts)
+        {
+            if (this->opts.queue_capacity == 0) { this->opts.queue_capacity = 1; }
+            unsigned int n = this->opts.raw_stream != nullptr ? 1u : std::max (1u, this->opts.encoder_threads);
+            for (unsigned int i = 0; i < n; ++i) { this->encoders.emplace_back (&frame_recorder::encode_loop, this); }
+        }
+
+        ~frame_recorder() { this->finish(); }
+
+        frame_recorder (const frame_recorder&) = delete;
+        frame_recorder& operator= (const frame_recorder&) = delete;
+
+        /*!
+         * Get a buffer of bytes bytes into which the next frame can be copied. Returns false (and
+         * counts the frame as dropped) if the queue is full, unless opts.wait_when_full, in which
+         * case it waits for an encoder to make room. Buffers are reused from frames that have
+         * been written, so recording does not allocate once it is under way.
+         */
+        bool acquire (std::vector<unsigned char>& buf, const std::size_t bytes)
+        {
+            std::unique_lock<std::mutex> lock (this->m);
+            if (this->opts.wait_when_full) {
+                this->room.wait (lock, [this] { return this->queue.size() < this->opts.queue_capacity; });
+            }
+            if (this->queue.size() >= this->opts.queue_capacity) {
+                ++this->stats.dropped;
+                return false;
+            }
+            if (!this->spare.empty()) {
+                buf = std::move (this->spare.back());
+                this->spare.pop_back();
+            }
+            buf.resize (bytes);
+            return true;
+        }
+
+        //! Queue a frame (in a buffer from acquire) for encoding
+        void push (std::vector<unsigned char>&& buf, const sm::vec<int, 2> dims)
+        {
+            {
+                std::lock_guard<std::mutex> lock (this->m);
+                this->queue.push_back ({ std::move (buf), dims, this->stats.captured++ });
+                this->stats.queue_high_water = std::max (this->stats.queue_high_water, this->queue.size());
+            }
+            this->cv.notify_one();
+        }
+
+        recording_stats get_stats()
+        {
+            std::lock_guard<std::mutex> lock (this->m);
+            recording_stats s = this->stats;
+            s.queued = this->queue.size();
+            return s;
+        }
+
+        //! Write out the frames that are still queued, stop the encoders and return the final stats
+        recording_stats finish()
+        {
+            {
+                std::lock_guard<std::mutex> lock (this->m);
+                this->stopping = true;
+            }
+            this->cv.notify_all();
+            for (auto& t : this->encoders) {
+                if (t.joinable()) { t.join(); }
+            }
+            if (this->opts.raw_stream != nullptr) { std::fflush (this->opts.raw_stream); }
+            return this->get_stats();
+        }
+
+    private:
+        struct frame
+        {
+            std::vector<unsigned char> rgba;
+            sm::vec<int, 2> dims;
+            std::size_t number;
+        };
+
+        void encode_loop()
+        {
+            for (;;) {
+                frame f;
+                {
+                    std::unique_lock<std::mutex> lock (this->m);
+                    this->cv.wait (lock, [this] { return this->stopping || !this->queue.empty(); });
+                    if (this->queue.empty()) { return; } // stopping, and nothing left to write
+                    f = std::move (this->queue.front());
+                    this->queue.pop_front();
+                }
+                this->room.notify_one();
+
+                bool ok = false;
+                if (this->opts.raw_stream != nullptr) {
+                    ok = std::fwrite (f.rgba.data(), 1, f.rgba.size(), this->opts.raw_stream) == f.rgba.size();
+                } else {
+                    if (!this->opts.transparent_bg) {
+                        for (std::size_t i = 3; i < f.rgba.size(); i += 4) { f.rgba[i] = 255; }
+                    }
+                    std::stringstream fn;
+                    fn << this->opts.file_prefix << std::setw (this->opts.number_width) << std::setfill ('0') << f.number << ".png";
+                    unsigned int error = lodepng::encode (fn.str(), f.rgba.data(), f.dims[0], f.dims[1]);
+                    if (error) {
+                        std::cerr << "encoder error " << error << ": " << lodepng_error_text (error) << std::endl;
+                    }
+                    ok = error == 0;
+                }
+
+                std::lock_guard<std::mutex> lock (this->m);
+                if (ok) { ++this->stats.written; } else { ++this->stats.failed; }
+                if (this->spare.size() < this->opts.queue_capacity) { this->spare.push_back (std::move (f.rgba)); }
+            }
+        }
+
+        recording_options opts;
+        std::vector<std::thread> encoders;
+        //! Guards queue, spare, stats and stopping
+        std::mutex m;
+        std::condition_variable cv;
+        //! Notified when an encoder takes a frame from the queue (for acquire, if opts.wait_when_full)
+        std::condition_variable room;
+        std::deque<frame> queue;
+        //! Buffers from written frames, for acquire to reuse
+        std::vector<std::vector<unsigned char>> spare;
+        recording_stats stats;
+        bool stopping = false;
+    };
+
+} // namespace mplot
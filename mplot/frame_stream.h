@@ -0,0 +1,365 @@
+/*!
+ * \file
+ *
+ * A frame_stream reads the frames of a recorded time series, one frame of frame_size() datums at
+ * a time, from a frame_source (a raw binary file, memory mapped; an HDF5 dataset, see
+ * mplot/hdf5_frame_source.h; or a client function) on a background I/O thread. The frames are
+ * read into a small pool of buffers, which are reused, so that a series far larger than memory
+ * can be played back, or scrubbed through, at the speed of the disk.
+ *
+ * The stream reads ahead of the frame that was last asked for (see seek), in the direction of
+ * play. The reader, such as VisualDataModel::setPlayback, takes what has arrived with
+ * with_frame, which never waits, or wait_frame, which does.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <mplot/mapped_file.h>
+
+namespace mplot {
+
+    /*!
+     * A source of the frames of a time series, each of frame_size() datums. read() is only ever
+     * called on a frame_stream's I/O thread, so a source need not be thread safe.
+     */
+    template <typename T>
+    struct frame_source
+    {
+        virtual ~frame_source() {}
+        //! The number of frames
+        virtual std::size_t frames() const = 0;
+        //! The number of datums in each frame
+        virtual std::size_t frame_size() const = 0;
+        //! Read frame f into out, which holds frame_size() datums. Throws if it can't.
+        virtual void read (const std::size_t f, T* out) = 0;
+    };
+
+    //! Frames of T stored one after another, with no gaps, in a raw binary file, which is memory mapped
+    template <typename T>
+    struct raw_frame_source : public frame_source<T>
+    {
+        //! Map path, in which the first frame of _frame_size datums starts header_bytes from the start
+        raw_frame_source (const std::string& path, const std::size_t _frame_size, const std::size_t _header_bytes = 0)
+            : mf (path), n (_frame_size), header_bytes (_header_bytes)
+        {
+            if (this->n == 0) { throw std::runtime_error ("raw_frame_source: the frames are empty"); }
+            const std::size_t body = this->mf.size() > this->header_bytes ? this->mf.size() - this->header_bytes : 0u;
+            this->n_frames = body / (this->n * sizeof (T)); // a part frame at the end is ignored
+        }
+        std::size_t frames() const final { return this->n_frames; }
+        std::size_t frame_size() const final { return this->n; }
+        //! Copy frame f out of the mapping. Its pages are read from the disk here, on the I/O thread.
+        void read (const std::size_t f, T* out) final
+        {
+            if (f >= this->n_frames) { throw std::out_of_range ("raw_frame_source: no such frame"); }
+            std::memcpy (out, this->mf.data() + this->header_bytes + f * this->n * sizeof (T), this->n * sizeof (T));
+        }
+    private:
+        mplot::mapped_file mf;
+        std::size_t n = 0;
+        std::size_t header_bytes = 0;
+        std::size_t n_frames = 0;
+    };
+
+    //! Frames read by a client function, called as loader (f, out) on the I/O thread
+    template <typename T>
+    struct function_frame_source : public frame_source<T>
+    {
+        using frame_loader = std::function<void(std::size_t, T*)>;
+        function_frame_source (const std::size_t _n_frames, const std::size_t _frame_size, frame_loader _loader)
+            : n_frames (_n_frames), n (_frame_size), loader (std::move (_loader)) {}
+        std::size_t frames() const final { return this->n_frames; }
+        std::size_t frame_size() const final { return this->n; }
+        void read (const std::size_t f, T* out) final { this->loader (f, out); }
+    private:
+        std::size_t n_frames = 0;
+        std::size_t n = 0;
+        frame_loader loader;
+    };
+
+    //! How a frame_stream reads
+    struct frame_stream_options
+    {
+        //! The number of frame buffers in the pool
+        std::size_t buffers = 16;
+        //! How many frames after the one asked for (before it, when playing backwards) are read
+        //! ahead. No more than buffers - 1.
+        std::size_t read_ahead = 8;
+    };
+
+    //! Counts of what a frame_stream has done
+    struct frame_stream_stats
+    {
+        //! Frames read from the source
+        std::size_t reads = 0;
+        //! Frames asked for (with with_frame) that were in the pool, and that were not
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+        //! Calls to wait_frame that had to wait for the frame to be read
+        std::size_t waits = 0;
+        //! Frames that the source failed to read
+        std::size_t failed = 0;
+    };
+
+    template <typename T>
+    class frame_stream
+    {
+    public:
+        //! Stream the frames of _src, starting to read from frame 0 onwards straight away
+        frame_stream (std::unique_ptr<mplot::frame_source<T>> _src, const frame_stream_options& _opts = {})
+            : src (std::move (_src)), opts (_opts)
+        {
+            if (!this->src) { throw std::runtime_error ("frame_stream: there is no source"); }
+            this->n_frames = this->src->frames();
+            this->n = this->src->frame_size();
+            this->opts.buffers = std::max (std::size_t{1}, this->opts.buffers);
+            this->opts.read_ahead = std::min (this->opts.read_ahead, this->opts.buffers - 1u);
+            this->slots.resize (this->opts.buffers);
+            for (slot& s : this->slots) { s.data.resize (this->n); }
+            this->io = std::thread (&frame_stream::io_loop, this);
+        }
+
+        //! Stop the I/O thread (once it has finished any read that it is in)
+        ~frame_stream()
+        {
+            {
+                std::lock_guard<std::mutex> lock (this->m);
+                this->stopping = true;
+            }
+            this->want.notify_all();
+            if (this->io.joinable()) { this->io.join(); }
+        }
+
+        frame_stream (const frame_stream&) = delete;
+        frame_stream& operator= (const frame_stream&) = delete;
+
+        //! The number of frames in the series
+        std::size_t frames() const { return this->n_frames; }
+        //! The number of datums in each frame
+        std::size_t frame_size() const { return this->n; }
+
+        //! Ask for frame f next, and for the frames after it (before it, if !forward) to be read ahead
+        void seek (const std::size_t f, const bool forward = true)
+        {
+            {
+                std::lock_guard<std::mutex> lock (this->m);
+                this->cursor = std::min (f, this->n_frames > 0u ? this->n_frames - 1u : 0u);
+                this->forward = forward;
+                this->error = nullptr; // try again any frame that failed
+            }
+            this->want.notify_one();
+        }
+
+        /*!
+         * If frame f has been read, call use (data, frame_size()) with it and return true.
+         * Otherwise return false at once. The frame's buffer is not reused while use runs
+         * (which it does without the stream's lock held).
+         */
+        template <typename F>
+        bool with_frame (const std::size_t f, F&& use)
+        {
+            std::unique_lock<std::mutex> lock (this->m);
+            slot* s = this->find (f);
+            if (s == nullptr || !s->ready) {
+                ++this->stats.misses;
+                return false;
+            }
+            ++this->stats.hits;
+            this->use_slot (*s, lock, use);
+            return true;
+        }
+
+        /*!
+         * Call use (data, frame_size()) with frame f, waiting for it to be read if it hasn't been
+         * (if f is not being read or read ahead, the stream seeks to it first). Rethrows the
+         * exception of a failed read.
+         */
+        template <typename F>
+        void wait_frame (const std::size_t f, F&& use)
+        {
+            if (f >= this->n_frames) { throw std::out_of_range ("frame_stream::wait_frame: no such frame"); }
+            std::unique_lock<std::mutex> lock (this->m);
+            slot* s = this->find (f);
+            if (s == nullptr || !s->ready) {
+                ++this->stats.waits;
+                if (s == nullptr && !this->in_window (f)) {
+                    this->cursor = f;
+                    this->error = nullptr;
+                    this->want.notify_one();
+                }
+                this->arrived.wait (lock, [this, f, &s] {
+                    s = this->find (f);
+                    return this->stopping || this->error != nullptr || (s != nullptr && s->ready);
+                });
+                if ((s == nullptr || !s->ready) && this->error != nullptr) {
+                    std::exception_ptr e = this->error;
+                    throw std::runtime_error ("frame_stream::wait_frame: failed to read frame " + std::to_string (f)
+                                              + ": " + frame_stream::what (e));
+                }
+                if (s == nullptr || !s->ready) { throw std::runtime_error ("frame_stream::wait_frame: the stream has stopped"); }
+            }
+            this->use_slot (*s, lock, use);
+        }
+
+        frame_stream_stats get_stats()
+        {
+            std::lock_guard<std::mutex> lock (this->m);
+            return this->stats;
+        }
+
+    private:
+        static constexpr std::size_t no_frame = std::numeric_limits<std::size_t>::max();
+
+        //! One buffer of the pool, holding frame (once ready), unless frame is no_frame
+        struct slot
+        {
+            std::vector<T> data;
+            std::size_t frame = no_frame;
+            bool ready = false;
+            unsigned int pins = 0;
+            std::uint64_t last_use = 0;
+        };
+
+        static std::string what (const std::exception_ptr& e)
+        {
+            try { std::rethrow_exception (e); }
+            catch (const std::exception& ex) { return ex.what(); }
+            catch (...) { return "unknown error"; }
+        }
+
+        //! The slot holding (or reading) frame f, or nullptr. Call with m held.
+        slot* find (const std::size_t f)
+        {
+            for (slot& s : this->slots) { if (s.frame == f) { return &s; } }
+            return nullptr;
+        }
+
+        //! Pin s, call use on its frame without the lock, then unpin it. Call with lock held.
+        template <typename F>
+        void use_slot (slot& s, std::unique_lock<std::mutex>& lock, F&& use)
+        {
+            ++s.pins;
+            s.last_use = ++this->tick;
+            lock.unlock();
+            try {
+                use (static_cast<const T*>(s.data.data()), this->n);
+            } catch (...) {
+                lock.lock();
+                --s.pins;
+                throw;
+            }
+            lock.lock();
+            --s.pins;
+            this->want.notify_one(); // s may now be reused
+        }
+
+        //! Is frame f within read_ahead frames of the cursor, in the direction of play?
+        bool in_window (const std::size_t f) const
+        {
+            return this->forward ? (f >= this->cursor && f - this->cursor <= this->opts.read_ahead)
+                                 : (f <= this->cursor && this->cursor - f <= this->opts.read_ahead);
+        }
+
+        //! The nearest frame of the window that is not in the pool, or no_frame
+        std::size_t next_wanted()
+        {
+            for (std::size_t d = 0; d <= this->opts.read_ahead; ++d) {
+                if (this->forward ? this->cursor + d >= this->n_frames : d > this->cursor) { break; }
+                const std::size_t f = this->forward ? this->cursor + d : this->cursor - d;
+                if (this->find (f) == nullptr) { return f; }
+            }
+            return no_frame;
+        }
+
+        //! A slot to read into: an empty one, or the least recently used of those that hold a
+        //! frame outside the window and are not in use. nullptr if there is none.
+        slot* victim()
+        {
+            slot* v = nullptr;
+            for (slot& s : this->slots) {
+                if (s.frame == no_frame) { return &s; }
+                if (!s.ready || s.pins > 0u || this->in_window (s.frame)) { continue; }
+                if (v == nullptr || s.last_use < v->last_use) { v = &s; }
+            }
+            return v;
+        }
+
+        void io_loop()
+        {
+            for (;;) {
+                std::unique_lock<std::mutex> lock (this->m);
+                std::size_t f = no_frame;
+                slot* s = nullptr;
+                this->want.wait (lock, [this, &f, &s] {
+                    if (this->stopping) { return true; }
+                    if (this->error != nullptr) { return false; } // until the next seek
+                    f = this->next_wanted();
+                    if (f == no_frame) { return false; }
+                    s = this->victim();
+                    return s != nullptr;
+                });
+                if (this->stopping) { return; }
+                s->frame = f;
+                s->ready = false;
+                lock.unlock();
+
+                std::exception_ptr e = nullptr;
+                try {
+                    this->src->read (f, s->data.data());
+                } catch (...) {
+                    e = std::current_exception();
+                }
+
+                lock.lock();
+                if (e != nullptr) {
+                    s->frame = no_frame;
+                    this->error = e;
+                    ++this->stats.failed;
+                } else {
+                    s->ready = true;
+                    s->last_use = ++this->tick;
+                    ++this->stats.reads;
+                }
+                lock.unlock();
+                this->arrived.notify_all();
+            }
+        }
+
+        std::unique_ptr<mplot::frame_source<T>> src;
+        frame_stream_options opts;
+        std::size_t n_frames = 0;
+        std::size_t n = 0;
+        //! Guards everything below
+        std::mutex m;
+        //! Notified when there may be a frame for the I/O thread to read, and when a frame has been read
+        std::condition_variable want;
+        std::condition_variable arrived;
+        std::vector<slot> slots;
+        std::size_t cursor = 0;
+        bool forward = true;
+        std::uint64_t tick = 0;
+        //! The exception of the last failed read; no more is read until the next seek
+        std::exception_ptr error = nullptr;
+        frame_stream_stats stats;
+        bool stopping = false;
+        std::thread io;
+    };
+
+} // namespace mplot
@@ -0,0 +1,912 @@
+/*!
+ * \file
+ *
+ * A frame_streamer serves the frames that mplot::Visual captures while it is streaming (see
+ * VisualBase::startStreaming) to web browsers, so that a scene rendered on a machine with no
+ * display (such as a GPU node of a cluster, with mplot::VisualHeadless) can be watched, and
+ * driven, from anywhere that can reach it over the network.
+ *
+ * It is a small HTTP server on one thread. GET / returns a page that shows the stream and sends
+ * the keyboard and mouse events over a WebSocket; GET /stream is the stream itself, as MJPEG (a
+ * multipart/x-mixed-replace sequence of JPEGs, which browsers show in an img element); and GET
+ * /frame.jpg is the latest frame (try it with curl). The input events from the WebSocket at
+ * /input are queued for the Visual, which passes them to its key_callback,
+ * mouse_button_callback, cursor_position_callback and scroll_callback at the start of its next
+ * render.
+ *
+ * The bandwidth is bounded. The frames offered by the Visual are admitted at up to max_fps and
+ * within a budget of max_bytes_per_second for all the clients together; others are dropped
+ * before they are even copied out of the pixel pack buffer. A client that has not taken the
+ * last frame skips the next, so a slow client never holds up the others (or the render
+ * thread). The JPEG quality adapts: it falls when clients fall behind or the budget is
+ * exceeded, and rises again while there is bandwidth to spare.
+ *
+ * The server listens on 127.0.0.1 by default, which is reachable through an ssh tunnel (ssh -L
+ * 8080:localhost:8080 gpunode). There is no authentication, so take care with other addresses.
+ * Every request must name the server, in its Host header, by the address and port it listens on
+ * (or by localhost, or by one of streaming_options::allowed_hosts), which keeps out pages that
+ * reach it through a DNS rebinding. The input is only forwarded if
+ * streaming_options::forward_input is set, and the /input WebSocket refuses pages whose Origin
+ * is not the server's own (or that send no Origin).
+ * Streaming is not available on Windows.
+ *
+ * \author Seb James
+ * \date 2026
+ */
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cerrno>
+#include <cctype>
+#include <sm/vec>
+#include <mplot/jpeg_encoder.h>
+
+#ifndef _WIN32
+# include <sys/types.h>
+# include <sys/socket.h>
+# include <netinet/in.h>
+# include <netinet/tcp.h>
+# include <arpa/inet.h>
+# include <poll.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+namespace mplot {
+
+    //! How a Visual streams its frames
+    struct streaming_options
+    {
+        //! The address to listen on. 127.0.0.1 allows only local (or ssh tunnelled) clients;
+        //! 0.0.0.0 allows any.
+        std::string address = "127.0.0.1";
+        //! The port to listen on, or 0 for any free port (see frame_streamer::port)
+        unsigned short port = 8080;
+        //! The most frames per second to send
+        double max_fps = 30.0;
+        //! The most bytes per second to send, to all of the clients together
+        double max_bytes_per_second = 4.0 * 1024.0 * 1024.0;
+        //! The JPEG quality to start at, and the range in which it adapts
+        int quality = 75;
+        int min_quality = 20;
+        int max_quality = 90;
+        //! If true, the input events sent by clients over the /input WebSocket are passed to the
+        //! Visual. Off by default, as any web page open in a browser on this machine can reach
+        //! 127.0.0.1 (though an /input upgrade from a page of another origin is always refused).
+        bool forward_input = false;
+        //! The most clients at once (streams, input sockets and requests together)
+        std::size_t max_clients = 16;
+        //! The Host headers accepted besides the address and port listened on (and localhost on
+        //! that port, for a loopback address), such as "gpunode.example.org:8080" for a server
+        //! reached by name, or "localhost:9000" through ssh -L 9000:localhost:8080. A request
+        //! with any other Host is refused.
+        std::vector<std::string> allowed_hosts;
+        //! The most bytes of replies (such as WebSocket pongs) that may wait to be sent to one
+        //! client. A client that falls further behind, by not reading, is disconnected. (A stream
+        //! client that has not taken the last frame just skips the next.)
+        std::size_t max_pending_bytes = 64 * 1024;
+    };
+
+    //! Counts of the frames that a frame_streamer has handled
+    struct streaming_stats
+    {
+        //! Frames that were admitted, and encoded
+        std::size_t encoded = 0;
+        //! Frames that were dropped by the frame rate or bandwidth limits, or because the last
+        //! frame was still being encoded
+        std::size_t dropped = 0;
+        //! Frames that were sent to a client (one frame to two clients counts two)
+        std::size_t sent = 0;
+        //! Frames that a client skipped because it had not yet taken the one before
+        std::size_t skipped = 0;
+        //! The bytes of JPEG that were sent
+        std::size_t bytes_sent = 0;
+        //! The input events that were received from clients
+        std::size_t input_events = 0;
+        //! The clients receiving the stream now
+        std::size_t stream_clients = 0;
+        //! The JPEG quality now
+        int quality = 0;
+    };
+
+    //! A keyboard or mouse event from a client, for the Visual's callback of the same name
+    struct stream_input_event
+    {
+        enum class kind { key, mouse_button, cursor_position, scroll };
+        kind type = kind::key;
+        //! key, scancode, action and mods of a key event; button, action and mods of a mouse_button event
+        std::array<int, 4> i = { 0, 0, 0, 0 };
+        //! x and y of a cursor_position event; xoffset and yoffset of a scroll event
+        std::array<double, 2> d = { 0.0, 0.0 };
+
+        /*!
+         * Parse the text of an event from the page served at / (one of "k key scancode action
+         * mods", "b button action mods", "c x y" and "s xoffset yoffset"). Returns false if it
+         * is not an event.
+         */
+        bool parse (const std::string& txt)
+        {
+            std::istringstream ss (txt);
+            char c = 0;
+            ss >> c;
+            switch (c) {
+            case 'k': this->type = kind::key; ss >> this->i[0] >> this->i[1] >> this->i[2] >> this->i[3]; break;
+            case 'b': this->type = kind::mouse_button; ss >> this->i[0] >> this->i[1] >> this->i[2]; break;
+            case 'c': this->type = kind::cursor_position; ss >> this->d[0] >> this->d[1]; break;
+            case 's': this->type = kind::scroll; ss >> this->d[0] >> this->d[1]; break;
+            default: return false;
+            }
+            return !ss.fail();
+        }
+    };
+
+    /*!
+     * Decides which frames a frame_streamer sends, and at what JPEG quality. Frames are admitted
+     * at up to max_fps, and while a bucket of bytes, filled at max_bytes_per_second (and
+     * holding up to half a second of them), has room for another frame of the typical size.
+     */
+    struct stream_rate_control
+    {
+        double max_fps = 30.0;
+        double max_bytes_per_second = 4.0 * 1024.0 * 1024.0;
+        int quality = 75;
+        int min_quality = 20;
+        int max_quality = 90;
+
+        //! Should a frame offered at time t (in seconds), for n_clients clients, be sent?
+        bool admit (const double t, const std::size_t n_clients = 1)
+        {
+            this->refill (t);
+            if (this->last_admit >= 0.0 && this->max_fps > 0.0 && t - this->last_admit < 1.0 / this->max_fps) { return false; }
+            if (this->tokens < this->typical_cost (n_clients)) { return false; }
+            this->last_admit = t;
+            return true;
+        }
+
+        /*!
+         * A frame of bytes bytes was sent to n_clients clients, and behind of them skipped it
+         * because they had not yet taken the last. Takes the bytes from the bucket and adapts
+         * the quality: down if any client was behind or the frames, at max_fps, would not fit
+         * the budget, and up if they would fit with room to spare.
+         */
+        void sent (const std::size_t bytes, const std::size_t n_clients, const std::size_t behind)
+        {
+            const double cost = static_cast<double>(bytes) * static_cast<double>(n_clients);
+            this->tokens -= cost;
+            this->mean_bytes = this->mean_bytes < 0.0 ? static_cast<double>(bytes)
+                                                      : 0.8 * this->mean_bytes + 0.2 * static_cast<double>(bytes);
+            const double rate = this->mean_bytes * static_cast<double>(std::max (n_clients, std::size_t{1}))
+                                * (this->max_fps > 0.0 ? this->max_fps : 60.0);
+            if (behind > 0u || rate > this->max_bytes_per_second) {
+                this->quality = std::max (this->min_quality, this->quality - 5);
+            } else if (rate < 0.7 * this->max_bytes_per_second) {
+                this->quality = std::min (this->max_quality, this->quality + 1);
+            }
+        }
+
+        //! The bytes in the bucket now
+        double available() const { return this->tokens; }
+
+    private:
+        double tokens = 0.0;
+        bool started = false;
+        double last_t = -1.0;
+        double last_admit = -1.0;
+        //! The typical size of a frame (a moving average), or -1 before the first
+        double mean_bytes = -1.0;
+
+        double bucket_size() const { return 0.5 * this->max_bytes_per_second; }
+        //! The bytes that the next frame will probably take (at most a full bucket, so that frames larger than the bucket can still be sent)
+        double typical_cost (const std::size_t n_clients) const
+        {
+            return this->mean_bytes < 0.0 ? 0.0 : std::min (this->mean_bytes * static_cast<double>(n_clients), this->bucket_size());
+        }
+
+        void refill (const double t)
+        {
+            if (!this->started) {
+                this->tokens = this->bucket_size();
+                this->started = true;
+            }
+            if (this->last_t >= 0.0 && t > this->last_t) {
+                this->tokens = std::min (this->bucket_size(), this->tokens + (t - this->last_t) * this->max_bytes_per_second);
+            }
+            this->last_t = t;
+        }
+    };
+
+    namespace stream_detail {
+
+        //! The SHA-1 digest of txt (for the WebSocket handshake)
+        inline std::array<std::uint8_t, 20> sha1 (const std::string_view txt)
+        {
+            std::array<std::uint32_t, 5> h = { 0x67452301u, 0xefcdab89u, 0x98badcfeu, 0x10325476u, 0xc3d2e1f0u };
+            std::string msg (txt);
+            const std::uint64_t nbits = static_cast<std::uint64_t>(txt.size()) * 8u;
+            msg.push_back (static_cast<char>(0x80));
+            while (msg.size() % 64u != 56u) { msg.push_back ('\0'); }
+            for (int s = 56; s >= 0; s -= 8) { msg.push_back (static_cast<char>((nbits >> s) & 0xffu)); }
+            auto rotl = [](const std::uint32_t x, const int n) { return (x << n) | (x >> (32 - n)); };
+            for (std::size_t blk = 0; blk < msg.size(); blk += 64u) {
+                std::array<std::uint32_t, 80> w = {};
+                for (std::size_t i = 0; i < 16u; ++i) {
+                    for (std::size_t k = 0; k < 4u; ++k) {
+                        w[i] = (w[i] << 8) | static_cast<std::uint8_t>(msg[blk + 4u * i + k]);
+                    }
+                }
+                for (std::size_t i = 16; i < 80u; ++i) { w[i] = rotl (w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1); }
+                std::uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+                for (std::size_t i = 0; i < 80u; ++i) {
+                    std::uint32_t f = 0, k = 0;
+                    if (i < 20u) { f = (b & c) | (~b & d); k = 0x5a827999u; }
+                    else if (i < 40u) { f = b ^ c ^ d; k = 0x6ed9eba1u; }
+                    else if (i < 60u) { f = (b & c) | (b & d) | (c & d); k = 0x8f1bbcdcu; }
+                    else { f = b ^ c ^ d; k = 0xca62c1d6u; }
+                    const std::uint32_t t = rotl (a, 5) + f + e + k + w[i];
+                    e = d; d = c; c = rotl (b, 30); b = a; a = t;
+                }
+                h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+            }
+            std::array<std::uint8_t, 20> digest = {};
+            for (std::size_t i = 0; i < 20u; ++i) { digest[i] = static_cast<std::uint8_t>(h[i / 4u] >> (24u - 8u * (i % 4u))); }
+            return digest;
+        }
+
+        inline std::string base64 (const std::uint8_t* p, const std::size_t n)
+        {
+            static constexpr char tbl[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            std::string out;
+            for (std::size_t i = 0; i < n; i += 3u) {
+                const std::uint32_t v = (std::uint32_t{p[i]} << 16) | (i + 1u < n ? std::uint32_t{p[i + 1u]} << 8 : 0u)
+                                        | (i + 2u < n ? std::uint32_t{p[i + 2u]} : 0u);
+                out.push_back (tbl[(v >> 18) & 63u]);
+                out.push_back (tbl[(v >> 12) & 63u]);
+                out.push_back (i + 1u < n ? tbl[(v >> 6) & 63u] : '=');
+                out.push_back (i + 2u < n ? tbl[v & 63u] : '=');
+            }
+            return out;
+        }
+
+        //! The Sec-WebSocket-Accept value for the Sec-WebSocket-Key key (RFC 6455, section 4.2.2)
+        inline std::string websocket_accept (const std::string& key)
+        {
+            const std::array<std::uint8_t, 20> d = sha1 (key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11");
+            return base64 (d.data(), d.size());
+        }
+
+        //! True if a and b are the same but for the case of their letters
+        inline bool iequal (const std::string_view a, const std::string_view b)
+        {
+            return a.size() == b.size() && std::equal (a.begin(), a.end(), b.begin(), [](unsigned char x, unsigned char y) {
+                return std::tolower (x) == std::tolower (y);
+            });
+        }
+
+        /*!
+         * True if host (a request's Host header) names a server listening on address and port:
+         * as address:port, as localhost:port if address is a loopback address, as any IPv4
+         * address with port if address is 0.0.0.0, or as one of allowed. A page that reaches
+         * the server by a name of its own, which it has rebound to this machine (DNS
+         * rebinding), sends that name, and so is refused.
+         */
+        inline bool host_allowed (const std::string& host, const std::string& address, const unsigned short port,
+                                  const std::vector<std::string>& allowed = {})
+        {
+            if (host.empty()) { return false; }
+            for (const std::string& a : allowed) {
+                if (iequal (host, a)) { return true; }
+            }
+            // The name and the port (80 if the Host gives none)
+            const std::size_t colon = host.rfind (':');
+            const std::string name = host.substr (0, colon);
+            unsigned long host_port = 80;
+            if (colon != std::string::npos) {
+                const std::string digits = host.substr (colon + 1);
+                if (digits.empty() || digits.size() > 5u || !std::all_of (digits.begin(), digits.end(), [](unsigned char ch) {
+                    return std::isdigit (ch) != 0;
+                })) {
+                    return false;
+                }
+                host_port = std::stoul (digits);
+            }
+            if (host_port != port) { return false; }
+            if (iequal (name, address)) { return true; }
+#ifndef _WIN32
+            in_addr bound = {};
+            if (::inet_pton (AF_INET, address.c_str(), &bound) != 1) { return false; }
+            const std::uint32_t b = ntohl (bound.s_addr);
+            if ((b >> 24) == 127u || b == 0u) {
+                if (iequal (name, "localhost")) { return true; }
+            }
+            in_addr named = {};
+            if (b == 0u && ::inet_pton (AF_INET, name.c_str(), &named) == 1) { return true; }
+#endif
+            return false;
+        }
+
+        /*!
+         * True if a request with the Origin header origin (empty if it had none) came from a page
+         * served from host (the request's Host header, already checked by host_allowed). A
+         * browser sends the Origin of the page that opens a WebSocket, so this refuses a
+         * connection to /input from another site's page (cross-site WebSocket hijacking). A
+         * request with no Origin is refused too, as is "null", an opaque origin.
+         */
+        inline bool same_origin (const std::string& origin, const std::string& host)
+        {
+            const std::size_t sep = origin.find ("://");
+            if (sep == std::string::npos || host.empty()) { return false; }
+            return iequal (std::string_view (origin).substr (sep + 3), host);
+        }
+
+        /*!
+         * Take the first complete WebSocket frame from the bytes in buf, unmasking its payload
+         * into payload. Returns the frame's opcode, -1 if buf does not yet hold a whole frame,
+         * or -2 if the frame is not valid from a client (unmasked, longer than max_payload, or a
+         * control frame that is fragmented or longer than 125 bytes, which RFC 6455 forbids).
+         */
+        inline int websocket_take_frame (std::string& buf, std::string& payload, const std::size_t max_payload = 65536)
+        {
+            if (buf.size() < 2u) { return -1; }
+            const std::uint8_t b0 = static_cast<std::uint8_t>(buf[0]);
+            const std::uint8_t b1 = static_cast<std::uint8_t>(buf[1]);
+            if ((b1 & 0x80u) == 0u) { return -2; } // a client must mask its frames
+            std::size_t at = 2;
+            std::uint64_t len = b1 & 0x7fu;
+            if (len >= 126u) {
+                const std::size_t n = len == 126u ? 2u : 8u;
+                if (buf.size() < at + n) { return -1; }
+                len = 0;
+                for (std::size_t k = 0; k < n; ++k) { len = (len << 8) | static_cast<std::uint8_t>(buf[at + k]); }
+                at += n;
+            }
+            if (len > max_payload) { return -2; }
+            if ((b0 & 0x08u) != 0u && ((b0 & 0x80u) == 0u || len > 125u)) { return -2; } // a control frame
+            if (buf.size() < at + 4u + len) { return -1; }
+            const char* mask = buf.data() + at;
+            at += 4u;
+            payload.resize (static_cast<std::size_t>(len));
+            for (std::size_t k = 0; k < len; ++k) { payload[k] = static_cast<char>(buf[at + k] ^ mask[k % 4u]); }
+            buf.erase (0, at + static_cast<std::size_t>(len));
+            return b0 & 0x0f;
+        }
+
+        //! An unmasked (server to client) WebSocket frame
+        inline std::string websocket_frame (const int opcode, const std::string_view payload)
+        {
+            std::string f;
+            f.push_back (static_cast<char>(0x80u | static_cast<unsigned int>(opcode)));
+            // The length in 7 bits, or 126 and 16 bits, or 127 and 64 bits
+            const std::uint64_t len = payload.size();
+            if (len < 126u) {
+                f.push_back (static_cast<char>(len));
+            } else if (len <= 0xffffu) {
+                f.push_back (static_cast<char>(126));
+                for (int s = 8; s >= 0; s -= 8) { f.push_back (static_cast<char>((len >> s) & 0xffu)); }
+            } else {
+                f.push_back (static_cast<char>(127));
+                for (int s = 56; s >= 0; s -= 8) { f.push_back (static_cast<char>((len >> s) & 0xffu)); }
+            }
+            f.append (payload);
+            return f;
+        }
+
+        //! The page served at /, which shows the stream and sends the input events
+        inline const char* viewer_page()
+        {
+            return R"html(<!DOCTYPE html>
+<html><head><meta charset="utf-8"><title>mathplot stream</title>
+<style>body{margin:0;background:#222}img{display:block;margin:auto;outline:none;cursor:crosshair}</style></head>
+<body><img id="v" src="/stream" tabindex="0" draggable="false">
+<script>
+const v = document.getElementById('v');
+const ws = new WebSocket((location.protocol === 'https:' ? 'wss://' : 'ws://') + location.host + '/input');
+const send = (s) => { if (ws.readyState === 1) { ws.send(s); } };
+const mods = (e) => (e.shiftKey ? 1 : 0) | (e.ctrlKey ? 2 : 0) | (e.altKey ? 4 : 0) | (e.metaKey ? 8 : 0);
+// Key codes as GLFW's (see mplot/keys.h)
+const named = { Space: 32, Quote: 39, Comma: 44, Minus: 45, Period: 46, Slash: 47, Semicolon: 59, Equal: 61,
+  BracketLeft: 91, Backslash: 92, BracketRight: 93, Backquote: 96, Escape: 256, Enter: 257, Tab: 258,
+  Backspace: 259, Insert: 260, Delete: 261, ArrowRight: 262, ArrowLeft: 263, ArrowDown: 264, ArrowUp: 265,
+  PageUp: 266, PageDown: 267, Home: 268, End: 269, ShiftLeft: 340, ControlLeft: 341, AltLeft: 342,
+  MetaLeft: 343, ShiftRight: 344, ControlRight: 345, AltRight: 346, MetaRight: 347 };
+function keycode(e) {
+  let m = /^Key([A-Z])$/.exec(e.code) || /^Digit([0-9])$/.exec(e.code);
+  if (m) { return m[1].charCodeAt(0); }
+  m = /^F([0-9]+)$/.exec(e.code);
+  if (m) { return 289 + parseInt(m[1]); }
+  return named[e.code] ?? -1;
+}
+const key = (e, action) => { const k = keycode(e); if (k >= 0) { send('k ' + k + ' 0 ' + action + ' ' + mods(e)); e.preventDefault(); } };
+v.addEventListener('keydown', (e) => key(e, e.repeat ? 2 : 1));
+v.addEventListener('keyup', (e) => key(e, 0));
+// Browsers number the buttons left, middle, right; GLFW numbers them left, right, middle
+const button = (e) => [0, 2, 1][e.button] ?? e.button;
+const at = (e) => { const r = v.getBoundingClientRect();
+  return [(e.clientX - r.left) * v.naturalWidth / r.width, (e.clientY - r.top) * v.naturalHeight / r.height]; };
+v.addEventListener('mousemove', (e) => { const p = at(e); send('c ' + p[0] + ' ' + p[1]); });
+v.addEventListener('mousedown', (e) => { v.focus(); send('b ' + button(e) + ' 1 ' + mods(e)); e.preventDefault(); });
+window.addEventListener('mouseup', (e) => send('b ' + button(e) + ' 0 ' + mods(e)));
+v.addEventListener('contextmenu', (e) => e.preventDefault());
+v.addEventListener('wheel', (e) => { send('s ' + (-Math.sign(e.deltaX)) + ' ' + (-Math.sign(e.deltaY))); e.preventDefault(); }, { passive: false });
+</script></body></html>
+)html";
+        }
+
+    } // namespace stream_detail
+
+    class frame_streamer
+    {
+    public:
+        /*!
+         * Start serving on opts.address and opts.port. on_input (if set) is called, on the
+         * server's thread, whenever input events arrive, so that the Visual can be woken to
+         * render. Throws if the server can not listen on the address and port.
+         */
+        frame_streamer (const streaming_options& _opts, std::function<void()> _on_input = nullptr)
+            : opts (_opts), on_input (std::move (_on_input))
+        {
+            this->rate.max_fps = this->opts.max_fps;
+            this->rate.max_bytes_per_second = this->opts.max_bytes_per_second;
+            this->rate.min_quality = std::clamp (this->opts.min_quality, 1, 100);
+            this->rate.max_quality = std::clamp (this->opts.max_quality, this->rate.min_quality, 100);
+            this->rate.quality = std::clamp (this->opts.quality, this->rate.min_quality, this->rate.max_quality);
+            this->stats.quality = this->rate.quality;
+            this->listen();
+            this->server = std::thread (&frame_streamer::serve, this);
+        }
+
+        ~frame_streamer() { this->finish(); }
+
+        frame_streamer (const frame_streamer&) = delete;
+        frame_streamer& operator= (const frame_streamer&) = delete;
+
+        //! The port that the server listens on (the one actually chosen, if opts.port was 0)
+        unsigned short port() const { return this->bound_port; }
+
+        //! Is anyone watching? If not, the Visual need not read its frames back at all.
+        bool watched()
+        {
+            std::lock_guard<std::mutex> lock (this->m);
+            return this->n_stream_clients > 0u || this->still_wanted;
+        }
+
+        /*!
+         * Get a buffer of bytes bytes into which the next frame can be copied. Returns false (and
+         * counts the frame as dropped, if anyone is watching) if there are no clients to send it
+         * to, or the rate control does not admit it, or the last frame is still being encoded.
+         */
+        bool acquire (std::vector<unsigned char>& buf, const std::size_t bytes)
+        {
+            std::lock_guard<std::mutex> lock (this->m);
+            if (this->n_stream_clients == 0u && !this->still_wanted) { return false; }
+            const std::size_t n = std::max (this->n_stream_clients, std::size_t{1});
+            if (this->frame_waiting || this->encoding || !this->rate.admit (this->now(), n)) {
+                ++this->stats.dropped;
+                return false;
+            }
+            buf = std::move (this->spare);
+            buf.resize (bytes);
+            return true;
+        }
+
+        //! Queue a frame (in a buffer from acquire, top row first) to be encoded and sent
+        void push (std::vector<unsigned char>&& buf, const sm::vec<int, 2> dims)
+        {
+            {
+                std::lock_guard<std::mutex> lock (this->m);
+                this->frame_rgba = std::move (buf);
+                this->frame_dims = dims;
+                this->frame_waiting = true;
+            }
+            this->wake();
+        }
+
+        //! Move the input events received since the last call into events. Returns their number.
+        std::size_t take_input (std::vector<stream_input_event>& events)
+        {
+            std::lock_guard<std::mutex> lock (this->m);
+            events.clear();
+            std::swap (events, this->input);
+            return events.size();
+        }
+
+        streaming_stats get_stats()
+        {
+            std::lock_guard<std::mutex> lock (this->m);
+            streaming_stats s = this->stats;
+            s.stream_clients = this->n_stream_clients;
+            return s;
+        }
+
+        //! Close the connections, stop the server and return the final stats
+        streaming_stats finish()
+        {
+            this->stopping = true;
+            this->wake();
+            if (this->server.joinable()) { this->server.join(); }
+#ifndef _WIN32
+            for (int fd : { this->listen_fd, this->wake_fd[0], this->wake_fd[1] }) {
+                if (fd >= 0) { ::close (fd); }
+            }
+            this->listen_fd = this->wake_fd[0] = this->wake_fd[1] = -1;
+#endif
+            return this->get_stats();
+        }
+
+    private:
+        //! A connection, from its HTTP request to its close
+        struct client
+        {
+            enum class kind { request, stream, input };
+            int fd = -1;
+            kind type = kind::request;
+            std::string in;
+            //! The bytes still to be sent, from out_at on
+            std::string out;
+            std::size_t out_at = 0;
+            //! Close once out has been sent
+            bool close_after = false;
+            //! A /frame.jpg request that waits for the next frame
+            bool wants_frame = false;
+            bool closed = false;
+        };
+
+        streaming_options opts;
+        std::function<void()> on_input;
+        std::thread server;
+        std::atomic<bool> stopping = false;
+        int listen_fd = -1;
+        std::array<int, 2> wake_fd = { -1, -1 };
+        unsigned short bound_port = 0;
+        std::vector<client> clients;
+
+        //! Guards everything below
+        std::mutex m;
+        stream_rate_control rate;
+        streaming_stats stats;
+        std::vector<stream_input_event> input;
+        std::size_t n_stream_clients = 0;
+        //! Set when /frame.jpg was requested with no stream clients, so the next frame is kept
+        bool still_wanted = false;
+        //! The frame waiting to be encoded, and whether the server is encoding one now
+        std::vector<unsigned char> frame_rgba;
+        std::vector<unsigned char> spare;
+        sm::vec<int, 2> frame_dims = { 0, 0 };
+        bool frame_waiting = false;
+        bool encoding = false;
+
+        //! The latest frame as a JPEG, for /frame.jpg (used on the server thread only)
+        std::vector<std::uint8_t> latest_jpeg;
+
+        double now() const
+        {
+            using namespace std::chrono;
+            return duration<double>(steady_clock::now().time_since_epoch()).count();
+        }
+
+#ifdef _WIN32
+        void listen() { throw std::runtime_error ("mplot::frame_streamer: streaming is not available on Windows"); }
+        void wake() {}
+        void serve() {}
+#else
+        void listen()
+        {
+            if (::pipe (this->wake_fd.data()) != 0) { throw std::runtime_error ("mplot::frame_streamer: pipe failed"); }
+            for (int fd : this->wake_fd) { ::fcntl (fd, F_SETFL, ::fcntl (fd, F_GETFL) | O_NONBLOCK); }
+
+            this->listen_fd = ::socket (AF_INET, SOCK_STREAM, 0);
+            if (this->listen_fd < 0) { this->fail ("socket"); }
+            int one = 1;
+            ::setsockopt (this->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+            sockaddr_in sa = {};
+            sa.sin_family = AF_INET;
+            sa.sin_port = htons (this->opts.port);
+            if (::inet_pton (AF_INET, this->opts.address.c_str(), &sa.sin_addr) != 1) {
+                this->finish();
+                throw std::runtime_error ("mplot::frame_streamer: bad address " + this->opts.address);
+            }
+            if (::bind (this->listen_fd, reinterpret_cast<sockaddr*>(&sa), sizeof sa) != 0) { this->fail ("bind"); }
+            if (::listen (this->listen_fd, 8) != 0) { this->fail ("listen"); }
+            socklen_t sl = sizeof sa;
+            ::getsockname (this->listen_fd, reinterpret_cast<sockaddr*>(&sa), &sl);
+            this->bound_port = ntohs (sa.sin_port);
+            ::fcntl (this->listen_fd, F_SETFL, ::fcntl (this->listen_fd, F_GETFL) | O_NONBLOCK);
+        }
+
+        [[noreturn]] void fail (const std::string& what)
+        {
+            const std::string err = std::strerror (errno);
+            this->finish();
+            throw std::runtime_error ("mplot::frame_streamer: " + what + " " + this->opts.address + ":"
+                                      + std::to_string (this->opts.port) + ": " + err);
+        }
+
+        void wake()
+        {
+            const char c = 1;
+            if (this->wake_fd[1] >= 0) { [[maybe_unused]] auto r = ::write (this->wake_fd[1], &c, 1); }
+        }
+
+        //! The server's loop: accept, read requests and input, encode and send frames
+        void serve()
+        {
+            std::vector<pollfd> pfds;
+            std::array<char, 4096> rbuf = {};
+            while (!this->stopping) {
+                pfds.clear();
+                pfds.push_back ({ this->wake_fd[0], POLLIN, 0 });
+                pfds.push_back ({ this->listen_fd, POLLIN, 0 });
+                for (const client& c : this->clients) {
+                    const short ev = static_cast<short>(POLLIN | (c.out_at < c.out.size() ? POLLOUT : 0));
+                    pfds.push_back ({ c.fd, ev, 0 });
+                }
+                if (::poll (pfds.data(), static_cast<nfds_t>(pfds.size()), 250) < 0 && errno != EINTR) { break; }
+                if (this->stopping) { break; }
+
+                if (pfds[0].revents & POLLIN) {
+                    while (::read (this->wake_fd[0], rbuf.data(), rbuf.size()) > 0) {}
+                }
+                if (pfds[1].revents & POLLIN) { this->accept_clients(); }
+
+                // pfds[2..] are the clients as they were before accept_clients added any
+                for (std::size_t i = 0; i + 2u < pfds.size(); ++i) {
+                    client& c = this->clients[i];
+                    if (pfds[i + 2u].revents & (POLLERR | POLLHUP | POLLNVAL)) { c.closed = true; }
+                    if (!c.closed && (pfds[i + 2u].revents & POLLIN)) {
+                        const ssize_t n = ::recv (c.fd, rbuf.data(), rbuf.size(), 0);
+                        if (n <= 0) {
+                            c.closed = true;
+                        } else {
+                            c.in.append (rbuf.data(), static_cast<std::size_t>(n));
+                            this->handle_input (i);
+                        }
+                    }
+                }
+
+                this->send_frame();
+
+                for (client& c : this->clients) {
+                    while (!c.closed && c.out_at < c.out.size()) {
+                        const ssize_t n = ::send (c.fd, c.out.data() + c.out_at, c.out.size() - c.out_at, MSG_NOSIGNAL);
+                        if (n <= 0) {
+                            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) { break; }
+                            c.closed = true;
+                        } else {
+                            c.out_at += static_cast<std::size_t>(n);
+                        }
+                    }
+                    if (c.out_at >= c.out.size()) {
+                        c.out.clear();
+                        c.out_at = 0;
+                        if (c.close_after) { c.closed = true; }
+                    }
+                }
+                this->remove_closed();
+            }
+            for (client& c : this->clients) { ::close (c.fd); }
+            this->clients.clear();
+            std::lock_guard<std::mutex> lock (this->m);
+            this->n_stream_clients = 0;
+        }
+
+        void accept_clients()
+        {
+            for (;;) {
+                const int fd = ::accept (this->listen_fd, nullptr, nullptr);
+                if (fd < 0) { return; }
+                if (this->clients.size() >= this->opts.max_clients) { ::close (fd); continue; }
+                ::fcntl (fd, F_SETFL, ::fcntl (fd, F_GETFL) | O_NONBLOCK);
+                int one = 1;
+                ::setsockopt (fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+                client c;
+                c.fd = fd;
+                this->clients.push_back (std::move (c));
+            }
+        }
+
+        //! Handle the bytes that have arrived from client ci: its request, or its input events
+        void handle_input (const std::size_t ci)
+        {
+            client& c = this->clients[ci];
+            if (c.type == client::kind::request) {
+                const std::size_t eoh = c.in.find ("\r\n\r\n");
+                if (eoh == std::string::npos) {
+                    if (c.in.size() > 8192u) { c.closed = true; }
+                    return;
+                }
+                this->handle_request (ci, c.in.substr (0, eoh));
+                c.in.erase (0, eoh + 4u);
+            }
+            if (c.type != client::kind::input) {
+                c.in.clear();
+                return;
+            }
+            std::string payload;
+            std::size_t n_events = 0;
+            for (;;) {
+                const int op = stream_detail::websocket_take_frame (c.in, payload);
+                if (op == -1) { break; }
+                if (op == -2 || op == 0x8) { // invalid, or close
+                    this->queue (c, stream_detail::websocket_frame (0x8, ""));
+                    c.close_after = true;
+                    break;
+                }
+                if (op == 0x9) { // ping
+                    if (!this->queue (c, stream_detail::websocket_frame (0xa, payload))) { break; }
+                    continue;
+                }
+                stream_input_event ev;
+                if (op == 0x1 && this->opts.forward_input && ev.parse (payload)) {
+                    std::lock_guard<std::mutex> lock (this->m);
+                    this->input.push_back (ev);
+                    ++this->stats.input_events;
+                    ++n_events;
+                }
+            }
+            if (n_events > 0u && this->on_input) { this->on_input(); }
+        }
+
+        //! Reply to the HTTP request (its request line and headers) of client ci
+        void handle_request (const std::size_t ci, const std::string& req)
+        {
+            client& c = this->clients[ci];
+            std::istringstream ss (req);
+            std::string method, path;
+            ss >> method >> path;
+            // The headers that matter, with their names in lower case
+            std::string upgrade, ws_key, origin, host;
+            std::string line;
+            std::getline (ss, line);
+            while (std::getline (ss, line)) {
+                const std::size_t colon = line.find (':');
+                if (colon == std::string::npos) { continue; }
+                std::string name = line.substr (0, colon);
+                std::transform (name.begin(), name.end(), name.begin(), [](unsigned char ch) { return std::tolower (ch); });
+                std::string value = line.substr (colon + 1);
+                value.erase (0, value.find_first_not_of (" \t"));
+                while (!value.empty() && (value.back() == '\r' || value.back() == ' ')) { value.pop_back(); }
+                if (name == "upgrade") { upgrade = value; }
+                if (name == "sec-websocket-key") { ws_key = value; }
+                if (name == "origin") { origin = value; }
+                if (name == "host") { host = value; }
+            }
+            std::transform (upgrade.begin(), upgrade.end(), upgrade.begin(), [](unsigned char ch) { return std::tolower (ch); });
+
+            if (!stream_detail::host_allowed (host, this->opts.address, this->bound_port, this->opts.allowed_hosts)) {
+                this->reply (c, "403 Forbidden", "text/plain", "Host not allowed\n");
+            } else if (method != "GET") {
+                this->reply (c, "405 Method Not Allowed", "text/plain", "GET only\n");
+            } else if ((path == "/input" || upgrade == "websocket") && !stream_detail::same_origin (origin, host)) {
+                this->reply (c, "403 Forbidden", "text/plain", "Cross-origin input refused\n");
+            } else if (path == "/" || path == "/index.html") {
+                this->reply (c, "200 OK", "text/html; charset=utf-8", stream_detail::viewer_page());
+            } else if (path == "/stream") {
+                c.type = client::kind::stream;
+                c.out += "HTTP/1.1 200 OK\r\nContent-Type: multipart/x-mixed-replace; boundary=mplotframe\r\n"
+                         "Cache-Control: no-cache, no-store\r\nPragma: no-cache\r\nConnection: close\r\n\r\n";
+                std::lock_guard<std::mutex> lock (this->m);
+                ++this->n_stream_clients;
+            } else if (path == "/frame.jpg") {
+                if (!this->latest_jpeg.empty()) {
+                    this->reply (c, "200 OK", "image/jpeg",
+                                 std::string_view (reinterpret_cast<const char*>(this->latest_jpeg.data()), this->latest_jpeg.size()));
+                } else {
+                    // Wait for the next frame
+                    c.wants_frame = true;
+                    std::lock_guard<std::mutex> lock (this->m);
+                    this->still_wanted = true;
+                }
+                // Ask for a new frame, so that the next request gets a fresh one
+                if (this->on_input) { this->on_input(); }
+            } else if (path == "/input" && upgrade == "websocket" && !ws_key.empty()) {
+                c.type = client::kind::input;
+                c.out += "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                         "Sec-WebSocket-Accept: " + stream_detail::websocket_accept (ws_key) + "\r\n\r\n";
+            } else {
+                this->reply (c, "404 Not Found", "text/plain", "Not found\n");
+            }
+        }
+
+        //! Queue bytes to send to c, unless they would take what waits to be sent past
+        //! max_pending_bytes, in which case c is disconnected. Returns false if it was.
+        bool queue (client& c, const std::string_view bytes)
+        {
+            if (c.out.size() - c.out_at + bytes.size() > this->opts.max_pending_bytes) {
+                c.closed = true;
+                return false;
+            }
+            c.out.append (bytes);
+            return true;
+        }
+
+        void reply (client& c, const std::string& status, const std::string& type, const std::string_view body)
+        {
+            c.out += "HTTP/1.1 " + status + "\r\nContent-Type: " + type + "\r\nContent-Length: "
+                     + std::to_string (body.size()) + "\r\nCache-Control: no-cache\r\nConnection: close\r\n\r\n";
+            c.out.append (body);
+            c.close_after = true;
+        }
+
+        //! If a frame is waiting, encode it and pass it to each client that has taken the last
+        void send_frame()
+        {
+            std::vector<unsigned char> rgba;
+            sm::vec<int, 2> dims = { 0, 0 };
+            int quality = 75;
+            {
+                std::lock_guard<std::mutex> lock (this->m);
+                if (!this->frame_waiting) { return; }
+                rgba = std::move (this->frame_rgba);
+                dims = this->frame_dims;
+                quality = this->rate.quality;
+                this->frame_waiting = false;
+                this->encoding = true;
+            }
+            mplot::jpeg::encode (rgba.data(), dims[0], dims[1], quality, this->latest_jpeg);
+            const std::string header = "--mplotframe\r\nContent-Type: image/jpeg\r\nContent-Length: "
+                                       + std::to_string (this->latest_jpeg.size()) + "\r\n\r\n";
+            const std::string_view jpg (reinterpret_cast<const char*>(this->latest_jpeg.data()), this->latest_jpeg.size());
+            std::size_t n_sent = 0;
+            std::size_t behind = 0;
+            for (client& c : this->clients) {
+                if (c.closed) { continue; }
+                if (c.type == client::kind::stream) {
+                    if (c.out_at < c.out.size()) { ++behind; continue; } // still sending the last frame
+                    c.out += header;
+                    c.out.append (jpg);
+                    c.out += "\r\n";
+                    ++n_sent;
+                } else if (c.wants_frame) {
+                    this->reply (c, "200 OK", "image/jpeg", jpg);
+                    c.wants_frame = false;
+                }
+            }
+
+            std::lock_guard<std::mutex> lock (this->m);
+            this->still_wanted = false;
+            this->encoding = false;
+            this->spare = std::move (rgba);
+            ++this->stats.encoded;
+            this->stats.sent += n_sent;
+            this->stats.skipped += behind;
+            this->stats.bytes_sent += n_sent * this->latest_jpeg.size();
+            if (n_sent + behind > 0u) { this->rate.sent (this->latest_jpeg.size(), n_sent, behind); }
+            this->stats.quality = this->rate.quality;
+        }
+
+        void remove_closed()
+        {
+            std::size_t n_closed = 0;
+            std::size_t n_streams_closed = 0;
+            for (client& c : this->clients) {
+                if (!c.closed) { continue; }
+                ++n_closed;
+                if (c.type == client::kind::stream) { ++n_streams_closed; }
+                ::close (c.fd);
+                c.fd = -1;
+            }
+            if (n_closed == 0u) { return; }
+            this->clients.erase (std::remove_if (this->clients.begin(), this->clients.end(),
+                                                 [](const client& c) { return c.closed; }), this->clients.end());
+            std::lock_guard<std::mutex> lock (this->m);
+            this->n_stream_clients -= std::min (this->n_stream_clients, n_streams_closed);
+        }
+#endif
+    };
+
+} // namespace mplot
@@ -0,0 +1,309 @@
+/*!
+ * \file
+ *
+ * Simulation loops as C++20 coroutines, resumed by a Visual's event loop. A simulation that
+ * would otherwise interleave its steps with render(), poll() and waitevents() calls (and guess
+ * how long to wait) is written as a coroutine returning mplot::frame_task, which co_awaits the
+ * Visual whenever it has something to show:
+ *
+ *   mplot::frame_task sim (mplot::Visual<>& v, MyModel* m)
+ *   {
+ *       while (!v.readyToFinish()) {
+ *           step_the_model (m);
+ *           co_await v.next_frame();        // resume after the next frame
+ *       }
+ *   }
+ *   v.spawn (sim (v, model_ptr));
+ *   v.runTasks();
+ *
+ * Besides next_frame(), a task may co_await idle_for (ms) (resume once ms have passed, with no
+ * busy-waiting) and data_consumed (x): resume once x's data have been taken up by a render. For a
+ * mplot::data_slot, that's once the model has taken the slot's latest frame; for a VisualModel
+ * (or anything else), after the next frame that was actually rendered.
+ *
+ * Several tasks may be spawned on one Visual. They run cooperatively, one at a time, on the
+ * thread that calls runTasks(), so they may change the Visual's models without any locking. A
+ * task that is still suspended when its window closes is not resumed again. It is destroyed
+ * (running its locals' destructors) with the Visual, or by tasks.clear(). An exception thrown out
+ * of a task is rethrown from runTasks().
+ *
+ * The frame_scheduler holds no GL state and does no rendering; VisualNoMX/VisualMX::runTasks()
+ * drive it.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <coroutine>
+#include <concepts>
+#include <chrono>
+#include <vector>
+#include <functional>
+#include <exception>
+#include <stdexcept>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace mplot {
+
+    class frame_scheduler;
+
+    //! The return type of a simulation coroutine. Give it to Visual::spawn (or frame_scheduler::spawn).
+    class frame_task
+    {
+    public:
+        struct promise_type
+        {
+            frame_task get_return_object() { return frame_task (std::coroutine_handle<promise_type>::from_promise (*this)); }
+            // A task first runs when its scheduler gets to it, not when it is called
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() noexcept {}
+            void unhandled_exception() { this->exception = std::current_exception(); }
+            std::exception_ptr exception = nullptr;
+        };
+
+        frame_task (frame_task&& other) noexcept : h (std::exchange (other.h, {})) {}
+        frame_task& operator= (frame_task&& other) noexcept
+        {
+            if (this != &other) {
+                if (this->h) { this->h.destroy(); }
+                this->h = std::exchange (other.h, {});
+            }
+            return *this;
+        }
+        frame_task (const frame_task&) = delete;
+        frame_task& operator= (const frame_task&) = delete;
+        ~frame_task() { if (this->h) { this->h.destroy(); } }
+
+        //! True once the coroutine has returned (or if this task is empty)
+        bool done() const { return !this->h || this->h.done(); }
+
+    private:
+        friend class frame_scheduler;
+        explicit frame_task (std::coroutine_handle<promise_type> _h) : h (_h) {}
+        std::coroutine_handle<promise_type> h = {};
+    };
+
+    /*!
+     * The tasks of one Visual, what each is waiting for, and the frame clock. The event loop
+     * calls resume_woken(), then render() and frame_done() whenever frame_due(), and waits for
+     * events for no longer than wait_s().
+     */
+    class frame_scheduler
+    {
+        using sc = std::chrono::steady_clock;
+
+        enum class wake
+        {
+            //! Run on the next pass (a new task, or idle_for (0))
+            now,
+            //! Resume at the next frame tick
+            frame,
+            //! Resume after the next frame that was rendered
+            rendered,
+            //! Resume once deadline has passed
+            time,
+            //! Resume once consumed() returns true
+            data
+        };
+
+        struct entry
+        {
+            frame_task task;
+            wake what = wake::now;
+            sc::time_point deadline = {};
+            std::function<bool()> consumed;
+        };
+
+    public:
+        //! The rate of the frame ticks at which next_frame() resumes its tasks. 0 or less to tick on every pass.
+        double fps = 60.0;
+
+        //! Add a task. It first runs on the next pass of the event loop.
+        void spawn (frame_task&& t)
+        {
+            if (t.done()) { return; }
+            this->waiting.push_back (entry{ std::move (t), wake::now, {}, {} });
+        }
+
+        //! True when every task has returned
+        bool empty() const { return this->waiting.empty(); }
+
+        //! The number of tasks that have not yet returned
+        std::size_t size() const { return this->waiting.size(); }
+
+        //! The number of frame ticks so far
+        std::uint64_t frames() const { return this->n_frames; }
+
+        //! Destroy all the tasks without resuming them
+        void clear() { this->waiting.clear(); }
+
+        // The awaitables. Each one suspends the task that awaits it and records what it waits for.
+        struct awaiter
+        {
+            frame_scheduler* s;
+            wake what;
+            sc::time_point deadline;
+            std::function<bool()> consumed;
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend (std::coroutine_handle<> h) { this->s->suspend (h, this->what, this->deadline, std::move (this->consumed)); }
+            void await_resume() const noexcept {}
+        };
+
+        //! co_await this to resume at the next frame tick, just after it has been rendered
+        awaiter next_frame() { return { this, wake::frame, {}, {} }; }
+
+        //! co_await this to resume once ms milliseconds have passed (or on the next pass, for ms <= 0)
+        awaiter idle_for (const double ms)
+        {
+            if (ms <= 0.0) { return { this, wake::now, {}, {} }; }
+            const auto d = std::chrono::duration_cast<sc::duration>(std::chrono::duration<double, std::milli>(ms));
+            return { this, wake::time, sc::now() + d, {} };
+        }
+
+        /*!
+         * co_await this to resume once the data of x have been taken up by a render. If x is a
+         * mplot::data_slot (anything with fresh()), that is once its latest frame has been taken
+         * by its model. Otherwise (a VisualModel, say), it is after the next frame that was
+         * rendered. x must outlive the wait.
+         */
+        template <typename M>
+        awaiter data_consumed (const M& x)
+        {
+            if constexpr (requires { { x.fresh() } -> std::convertible_to<bool>; }) {
+                return { this, wake::data, {}, [&x]() { return !x.fresh(); } };
+            } else {
+                return { this, wake::rendered, {}, {} };
+            }
+        }
+
+        /*!
+         * Resume, once each, the tasks that are ready: new tasks, those whose idle time is up and
+         * those whose data have been consumed. Tasks that return are removed. Rethrows the first
+         * exception that escapes a task (after removing it).
+         */
+        void resume_woken()
+        {
+            const sc::time_point now = sc::now();
+            this->resume_if ([now](const entry& e) {
+                return e.what == wake::now
+                || (e.what == wake::time && e.deadline <= now)
+                || (e.what == wake::data && e.consumed());
+            });
+        }
+
+        //! True if a frame tick is due
+        bool frame_due() const { return this->fps <= 0.0 || sc::now() >= this->next_tick; }
+
+        /*!
+         * Called after each frame tick, with rendered true if a frame was drawn (rather than
+         * skipped for want of changes). Resumes the tasks waiting for the frame.
+         */
+        void frame_done (const bool rendered)
+        {
+            const sc::time_point now = sc::now();
+            // Schedule the next tick one period after this one. A tick that is more than a period
+            // late counts from now, so that missed ticks are not caught up in a burst.
+            const sc::time_point tick = now - this->next_tick > this->period() ? now : this->next_tick;
+            this->next_tick = tick + this->period();
+            ++this->n_frames;
+            this->resume_if ([rendered](const entry& e) {
+                return e.what == wake::frame || (rendered && e.what == wake::rendered);
+            });
+        }
+
+        /*!
+         * The seconds that the event loop may wait for events before the tasks need it again: 0
+         * if any task is ready, up to the next frame tick if any is waiting for a frame and up to
+         * the earliest idle deadline. While tasks wait for data slots, which are only taken by a
+         * render, the wait is up to the next tick. -1 if no task needs waking by time.
+         */
+        double wait_s() const
+        {
+            const sc::time_point now = sc::now();
+            sc::time_point until = sc::time_point::max();
+            for (const entry& e : this->waiting) {
+                switch (e.what) {
+                case wake::now:
+                    return 0.0;
+                case wake::time:
+                    until = std::min (until, e.deadline);
+                    break;
+                case wake::frame:
+                case wake::rendered:
+                case wake::data:
+                default:
+                    until = std::min (until, this->next_tick);
+                    break;
+                }
+            }
+            if (until == sc::time_point::max()) { return -1.0; }
+            return until <= now ? 0.0 : std::chrono::duration<double>(until - now).count();
+        }
+
+    private:
+        sc::duration period() const
+        {
+            if (this->fps <= 0.0) { return sc::duration::zero(); }
+            return std::chrono::duration_cast<sc::duration>(std::chrono::duration<double>(1.0 / this->fps));
+        }
+
+        /*!
+         * Called from the awaiters: the task with handle h now waits for what. The task is found
+         * by its handle, rather than taken to be the one that resume_if last resumed, so that an
+         * awaitable that is co_awaited from some other coroutine is refused, not recorded against
+         * the wrong task.
+         */
+        void suspend (const std::coroutine_handle<> h, const wake what, const sc::time_point deadline,
+                      std::function<bool()>&& consumed)
+        {
+            auto ei = std::find_if (this->waiting.begin(), this->waiting.end(),
+                                    [h](const entry& e) { return e.task.h.address() == h.address(); });
+            if (ei == this->waiting.end()) {
+                throw std::runtime_error ("frame_scheduler: co_await of a frame awaitable outside one of its own tasks");
+            }
+            entry& e = *ei;
+            e.what = what;
+            e.deadline = deadline;
+            e.consumed = std::move (consumed);
+        }
+
+        //! Resume each task for which f is true, once. Tasks spawned meanwhile wait for the next pass.
+        template <typename F>
+        void resume_if (F f)
+        {
+            std::exception_ptr ex = nullptr;
+            const std::size_t n = this->waiting.size();
+            std::vector<bool> finished (n, false);
+            for (std::size_t i = 0; i < n; ++i) {
+                if (!f (this->waiting[i])) { continue; }
+                auto h = this->waiting[i].task.h;
+                h.resume();
+                if (h.done()) {
+                    finished[i] = true;
+                    if (h.promise().exception && !ex) { ex = h.promise().exception; }
+                }
+            }
+            // Remove the finished tasks, keeping the others (and any spawned meanwhile) in order
+            std::vector<entry> kept;
+            kept.reserve (this->waiting.size());
+            for (std::size_t i = 0; i < this->waiting.size(); ++i) {
+                if (i < n && finished[i]) { continue; }
+                kept.push_back (std::move (this->waiting[i]));
+            }
+            this->waiting.swap (kept);
+            if (ex) { std::rethrow_exception (ex); }
+        }
+
+        std::vector<entry> waiting;
+        sc::time_point next_tick = {};
+        std::uint64_t n_frames = 0;
+    };
+
+} // namespace mplot
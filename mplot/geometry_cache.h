@@ -0,0 +1,193 @@
+/*!
+ * \file
+ *
+ * An on-disk cache of the triangles of VisualModels that are costly to build and that do not
+ * change from one run to the next (a HexGridVisual of a fixed, large hexgrid, say). A model
+ * with a cache (see VisualModel::setGeometryCache) writes its indices, positions, normals and
+ * colours to a file named for a key, a hash of everything that its vertices depend on. On the
+ * next run, the file is memory mapped (see mplot/mapped_file.h) and drawn in place of the
+ * vertex vectors, and initializeVertices is not called.
+ *
+ * A cache file is a 40 byte header (the magic number, a version, the key and the numbers of
+ * vertices and indices, all in the host's byte order) followed by the uint32 indices and then
+ * three floats per vertex of positions, normals and colours. A file that does not match its
+ * key or whose size is wrong is ignored, and is overwritten by the next build.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+#include <system_error>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <mplot/mapped_file.h>
+#include <mplot/glb_file.h>
+
+namespace mplot {
+
+    /*!
+     * A 64 bit FNV-1a hash of the inputs of a model's build, for a geometry cache key. Add every
+     * parameter and datum that changes the vertices, and a version number of the model's
+     * vertex code, which should be changed whenever that code changes what it builds.
+     */
+    struct geometry_key
+    {
+        std::uint64_t h = 14695981039346656037ull;
+
+        geometry_key& add_bytes (const void* p, const std::size_t n)
+        {
+            const unsigned char* c = static_cast<const unsigned char*>(p);
+            for (std::size_t i = 0; i < n; ++i) {
+                this->h ^= c[i];
+                this->h *= 1099511628211ull;
+            }
+            return *this;
+        }
+
+        //! Add a number, or any other trivially copyable value
+        template <typename T> requires std::is_trivially_copyable_v<T>
+        geometry_key& add (const T& v) { return this->add_bytes (&v, sizeof (T)); }
+
+        //! Add a string, with its length so that ("ab", "c") and ("a", "bc") differ
+        geometry_key& add (const std::string& s)
+        {
+            this->add (s.size());
+            return this->add_bytes (s.data(), s.size());
+        }
+
+        //! Add the elements of a vector, with its length
+        template <typename T> requires std::is_trivially_copyable_v<T>
+        geometry_key& add (const std::vector<T>& v)
+        {
+            this->add (v.size());
+            return this->add_bytes (v.data(), v.size() * sizeof (T));
+        }
+
+        std::uint64_t value() const { return this->h; }
+    };
+
+    //! Read and write the cache files of a directory of cached geometry
+    struct geometry_cache
+    {
+        //! "MPGC", the first four bytes of a cache file
+        static constexpr std::uint32_t magic = 0x4347504du;
+        static constexpr std::uint32_t version = 1u;
+        static constexpr std::size_t header_bytes = 40;
+
+        //! The path of the cache file for key in dir
+        static std::string path (const std::string& dir, const std::uint64_t key)
+        {
+            std::stringstream ss;
+            ss << std::hex << std::setw (16) << std::setfill ('0') << key;
+            return (std::filesystem::path (dir) / (ss.str() + ".mpgc")).string();
+        }
+
+        /*!
+         * Map the cache file for key in dir. The mesh is empty (see mapped_mesh::empty) if there
+         * is no such file or it is not a valid cache file for key.
+         */
+        static mplot::mapped_mesh load (const std::string& dir, const std::uint64_t key)
+        {
+            mplot::mapped_mesh mm;
+            const std::string p = geometry_cache::path (dir, key);
+            std::error_code ec;
+            if (!std::filesystem::is_regular_file (p, ec)) { return mm; }
+            std::shared_ptr<const mplot::mapped_file> f;
+            try {
+                f = std::make_shared<const mplot::mapped_file> (p, true);
+            } catch (const std::exception&) {
+                return mm;
+            }
+            const unsigned char* d = f->data();
+            if (f->size() < header_bytes) { return mm; }
+            std::uint32_t m = 0u;
+            std::uint32_t v = 0u;
+            std::uint64_t k = 0u;
+            std::uint64_t nv = 0u;
+            std::uint64_t ni = 0u;
+            std::memcpy (&m, d, 4);
+            std::memcpy (&v, d + 4, 4);
+            std::memcpy (&k, d + 8, 8);
+            std::memcpy (&nv, d + 16, 8);
+            std::memcpy (&ni, d + 24, 8);
+            if (m != magic || v != version || k != key) { return mm; }
+            if (nv > f->size() || ni > f->size() || f->size() != geometry_cache::file_bytes (nv, ni)) { return mm; }
+            // The data are 4 byte aligned, as the mapping is page aligned and the header is 40 bytes
+            const float* vdata = reinterpret_cast<const float*>(d + header_bytes + ni * 4u);
+            mm.indices = reinterpret_cast<const std::uint32_t*>(d + header_bytes);
+            mm.n_indices = ni;
+            mm.positions = vdata;
+            mm.normals = vdata + 3u * nv;
+            mm.colours = vdata + 6u * nv;
+            mm.n_vertices = nv;
+            mm.file = f;
+            return mm;
+        }
+
+        /*!
+         * Write the cache file for key in dir (which is made if need be), from three floats per
+         * vertex of positions, normals and colours and three indices per triangle. The file is
+         * written under a temporary name and then renamed, so a reader never maps half of one.
+         * Returns false if the data are inconsistent or the file could not be written.
+         */
+        static bool store (const std::string& dir, const std::uint64_t key,
+                           const std::vector<float>& positions, const std::vector<float>& normals,
+                           const std::vector<float>& colours, const std::vector<std::uint32_t>& indices)
+        {
+            if (positions.empty() || positions.size() % 3 != 0
+                || normals.size() != positions.size() || colours.size() != positions.size()) { return false; }
+            std::error_code ec;
+            std::filesystem::create_directories (dir, ec);
+            if (ec) { return false; }
+            const std::string p = geometry_cache::path (dir, key);
+            const std::string tmp = p + ".tmp";
+            {
+                std::ofstream f (tmp, std::ios::out | std::ios::binary | std::ios::trunc);
+                if (!f.is_open()) { return false; }
+                const std::uint64_t nv = positions.size() / 3;
+                const std::uint64_t ni = indices.size();
+                unsigned char hdr[header_bytes] = {};
+                std::memcpy (hdr, &magic, 4);
+                std::memcpy (hdr + 4, &version, 4);
+                std::memcpy (hdr + 8, &key, 8);
+                std::memcpy (hdr + 16, &nv, 8);
+                std::memcpy (hdr + 24, &ni, 8);
+                f.write (reinterpret_cast<const char*>(hdr), header_bytes);
+                f.write (reinterpret_cast<const char*>(indices.data()), static_cast<std::streamsize>(ni * 4u));
+                for (const auto* v : { &positions, &normals, &colours }) {
+                    f.write (reinterpret_cast<const char*>(v->data()), static_cast<std::streamsize>(v->size() * sizeof (float)));
+                }
+                if (!f.good()) {
+                    f.close();
+                    std::filesystem::remove (tmp, ec);
+                    return false;
+                }
+            }
+            std::filesystem::rename (tmp, p, ec);
+            if (ec) {
+                std::filesystem::remove (tmp, ec);
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        static std::size_t file_bytes (const std::uint64_t nv, const std::uint64_t ni)
+        {
+            return header_bytes + static_cast<std::size_t>(ni) * 4u + static_cast<std::size_t>(nv) * 9u * sizeof (float);
+        }
+    };
+
+} // namespace mplot
@@ -0,0 +1,460 @@
+#pragma once
+
+/*
+ * Reusable compute shader kernels that operate on Shader Storage Buffer Objects: a work efficient
+ * (Blelloch) exclusive prefix scan over any number of workgroups, a min/max/sum reduction, a
+ * histogram and a radix sort. Hold an mplot::gl::compute_kernels in your compute_manager subclass
+ * and call its init() once there is a GL context.
+ *
+ * Each kernel binds the buffers it uses to the binding indices 0 to 3 of GL_SHADER_STORAGE_BUFFER,
+ * so rebind your own buffers before your own dispatches.
+ *
+ * Note: You have to include a header like gl3.h or glext.h etc for the GL types and
+ * functions BEFORE including this file.
+ *
+ * Author: Seb James.
+ */
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+#include <sm/vec>
+#include <sm/range>
+#include <mplot/gl/version.h>
+#include <mplot/gl/util_nomx.h>
+#include <mplot/gl/compute_shaderprog.h>
+
+namespace mplot {
+    namespace gl {
+
+        namespace kernels {
+
+            // The header of every kernel: 128 invocations per workgroup (the fewest that OpenGL
+            // 3.1 ES guarantees), full precision and the index of the workgroup within a 2D grid
+            // of workgroups (so that more than 65535 workgroups can be dispatched)
+            inline constexpr const char* header = "precision highp float;\n"
+            "precision highp int;\n"
+            "layout (local_size_x = 128, local_size_y = 1, local_size_z = 1) in;\n"
+            "uint group_id() { return gl_WorkGroupID.x + gl_WorkGroupID.y * gl_NumWorkGroups.x; }\n"
+            "#define SYNC memoryBarrierShared(); barrier();\n";
+
+            // Exclusive scan of each block of 256 elements of d (of type TYPE) in place, with the
+            // sum of each block written to sums (if write_sums is not 0)
+            inline constexpr const char* scan_blocks = "layout (std430, binding = 0) buffer Data { TYPE d[]; };\n"
+            "layout (std430, binding = 1) buffer Sums { TYPE sums[]; };\n"
+            "uniform uint n;\n"
+            "uniform uint write_sums;\n"
+            "shared TYPE t[256];\n"
+            "void main()\n"
+            "{\n"
+            "    uint l = gl_LocalInvocationID.x;\n"
+            "    uint a = group_id() * 256u + l;\n"
+            "    uint b = a + 128u;\n"
+            "    t[l] = a < n ? d[a] : TYPE(0);\n"
+            "    t[l + 128u] = b < n ? d[b] : TYPE(0);\n"
+            "    uint offset = 1u;\n"
+            "    for (uint s = 128u; s > 0u; s >>= 1) {\n" // The up sweep
+            "        SYNC\n"
+            "        if (l < s) { t[offset * (2u * l + 2u) - 1u] += t[offset * (2u * l + 1u) - 1u]; }\n"
+            "        offset <<= 1;\n"
+            "    }\n"
+            "    SYNC\n"
+            "    if (l == 0u) {\n"
+            "        if (write_sums != 0u) { sums[group_id()] = t[255]; }\n"
+            "        t[255] = TYPE(0);\n"
+            "    }\n"
+            "    for (uint s = 1u; s < 256u; s <<= 1) {\n" // The down sweep
+            "        offset >>= 1;\n"
+            "        SYNC\n"
+            "        if (l < s) {\n"
+            "            uint ai = offset * (2u * l + 1u) - 1u;\n"
+            "            uint bi = offset * (2u * l + 2u) - 1u;\n"
+            "            TYPE x = t[ai];\n"
+            "            t[ai] = t[bi];\n"
+            "            t[bi] += x;\n"
+            "        }\n"
+            "    }\n"
+            "    SYNC\n"
+            "    if (a < n) { d[a] = t[l]; }\n"
+            "    if (b < n) { d[b] = t[l + 128u]; }\n"
+            "}\n";
+
+            // Add the scanned sum of each block of 256 elements to the elements of the block
+            inline constexpr const char* add_block_sums = "layout (std430, binding = 0) buffer Data { TYPE d[]; };\n"
+            "layout (std430, binding = 1) readonly buffer Sums { TYPE sums[]; };\n"
+            "uniform uint n;\n"
+            "void main()\n"
+            "{\n"
+            "    uint i = group_id() * 128u + gl_LocalInvocationID.x;\n"
+            "    if (i < n) { d[i] += sums[i / 256u]; }\n"
+            "}\n";
+
+            // Reduce each block of 256 elements to its min, max and sum, written to r. The first
+            // pass (FIRST_PASS) reads floats; later passes read the results of the pass before.
+            inline constexpr const char* reduce = "#ifdef FIRST_PASS\n"
+            "layout (std430, binding = 0) readonly buffer In { float d[]; };\n"
+            "vec4 load (uint i) { return vec4(d[i], d[i], d[i], 0.0); }\n"
+            "#else\n"
+            "layout (std430, binding = 0) readonly buffer In { vec4 d[]; };\n"
+            "vec4 load (uint i) { return d[i]; }\n"
+            "#endif\n"
+            "layout (std430, binding = 1) writeonly buffer Out { vec4 r[]; };\n"
+            "uniform uint n;\n"
+            "shared vec4 s[128];\n"
+            "vec4 combine (vec4 a, vec4 b) { return vec4(min(a.x, b.x), max(a.y, b.y), a.z + b.z, 0.0); }\n"
+            "void main()\n"
+            "{\n"
+            "    uint l = gl_LocalInvocationID.x;\n"
+            "    uint i = group_id() * 256u + l;\n"
+            "    float inf = uintBitsToFloat(0x7f800000u);\n"
+            "    vec4 v = vec4(inf, -inf, 0.0, 0.0);\n"
+            "    if (i < n) { v = load (i); }\n"
+            "    if (i + 128u < n) { v = combine (v, load (i + 128u)); }\n"
+            "    s[l] = v;\n"
+            "    SYNC\n"
+            "    for (uint st = 64u; st > 0u; st >>= 1) {\n"
+            "        if (l < st) { s[l] = combine (s[l], s[l + st]); }\n"
+            "        SYNC\n"
+            "    }\n"
+            "    if (l == 0u) { r[group_id()] = s[0]; }\n"
+            "}\n";
+
+            // Count the floats of d into nbins bins from lo to hi (or across the range that a
+            // reduction left in rng), clamping those outside into the end bins
+            inline constexpr const char* histogram = "layout (std430, binding = 0) readonly buffer In { float d[]; };\n"
+            "layout (std430, binding = 1) buffer Bins { uint h[]; };\n"
+            "layout (std430, binding = 2) readonly buffer Range { vec4 rng; };\n"
+            "uniform uint n;\n"
+            "uniform uint nbins;\n"
+            "uniform float lo;\n"
+            "uniform float hi;\n"
+            "uniform uint range_from_buffer;\n"
+            "void main()\n"
+            "{\n"
+            "    uint i = group_id() * 128u + gl_LocalInvocationID.x;\n"
+            "    if (i >= n) { return; }\n"
+            "    float a = range_from_buffer != 0u ? rng.x : lo;\n"
+            "    float b = range_from_buffer != 0u ? rng.y : hi;\n"
+            "    int bin = b > a ? int(floor((d[i] - a) / (b - a) * float(nbins))) : 0;\n"
+            "    atomicAdd (h[uint(clamp(bin, 0, int(nbins) - 1))], 1u);\n"
+            "}\n";
+
+            // Set n uints of v to value
+            inline constexpr const char* fill = "layout (std430, binding = 0) writeonly buffer Data { uint v[]; };\n"
+            "uniform uint n;\n"
+            "uniform uint value;\n"
+            "void main()\n"
+            "{\n"
+            "    uint i = group_id() * 128u + gl_LocalInvocationID.x;\n"
+            "    if (i < n) { v[i] = value; }\n"
+            "}\n";
+
+            // One pass of the radix sort: 1 in f for each key whose bit is 0, else 0
+            inline constexpr const char* split_flags = "layout (std430, binding = 0) readonly buffer Keys { uint k[]; };\n"
+            "layout (std430, binding = 1) writeonly buffer Flags { uint f[]; };\n"
+            "uniform uint n;\n"
+            "uniform uint bit;\n"
+            "void main()\n"
+            "{\n"
+            "    uint i = group_id() * 128u + gl_LocalInvocationID.x;\n"
+            "    if (i < n) { f[i] = ((k[i] >> bit) & 1u) == 0u ? 1u : 0u; }\n"
+            "}\n";
+
+            // ...and, with the flags scanned, move the keys (and values) whose bit is 0, in order,
+            // before those whose bit is 1
+            inline constexpr const char* split_scatter = "layout (std430, binding = 0) readonly buffer Keys { uint k[]; };\n"
+            "layout (std430, binding = 1) readonly buffer Flags { uint f[]; };\n"
+            "layout (std430, binding = 2) writeonly buffer KeysOut { uint ko[]; };\n"
+            "layout (std430, binding = 3) buffer Values { uint v[]; };\n" // in the first n, out after them
+            "uniform uint n;\n"
+            "uniform uint bit;\n"
+            "uniform uint has_values;\n"
+            "void main()\n"
+            "{\n"
+            "    uint i = group_id() * 128u + gl_LocalInvocationID.x;\n"
+            "    if (i >= n) { return; }\n"
+            "    uint zeros = f[n - 1u] + (((k[n - 1u] >> bit) & 1u) == 0u ? 1u : 0u);\n"
+            "    uint pos = ((k[i] >> bit) & 1u) == 0u ? f[i] : zeros + i - f[i];\n"
+            "    ko[pos] = k[i];\n"
+            "    if (has_values != 0u) { v[n + pos] = v[i]; }\n"
+            "}\n";
+
+        } // namespace kernels
+
+        /*!
+         * The kernels, and the scratch buffers they need. The buffers passed to the kernels are
+         * the names of SSBOs (such as mplot::gl::ssbo::name or mplot::gl::vvec_ssbo::name).
+         */
+        template <int glver>
+        struct compute_kernels
+        {
+            // Compile the kernels. Client code must ensure there is an OpenGL context available.
+            void init()
+            {
+                this->build (this->scan_float, kernels::scan_blocks, "#define TYPE float\n");
+                this->build (this->scan_uint, kernels::scan_blocks, "#define TYPE uint\n");
+                this->build (this->add_float, kernels::add_block_sums, "#define TYPE float\n");
+                this->build (this->add_uint, kernels::add_block_sums, "#define TYPE uint\n");
+                this->build (this->reduce_first, kernels::reduce, "#define FIRST_PASS\n");
+                this->build (this->reduce_next, kernels::reduce, "");
+                this->build (this->histogram_prog, kernels::histogram, "");
+                this->build (this->fill_prog, kernels::fill, "");
+                this->build (this->flags_prog, kernels::split_flags, "");
+                this->build (this->scatter_prog, kernels::split_scatter, "");
+                glGenBuffers (1, &this->reduction);
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, this->reduction);
+                glBufferData (GL_SHADER_STORAGE_BUFFER, 4 * sizeof(float), nullptr, GL_DYNAMIC_COPY);
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, 0);
+                mplot::gl::Util::checkError (__FILE__, __LINE__);
+            }
+
+            // Delete the scratch buffers (the programs are deleted with this object)
+            void deinit()
+            {
+                for (auto& s : this->scratch) { if (s.name != 0) { glDeleteBuffers (1, &s.name); } }
+                this->scratch.clear();
+                if (this->reduction != 0) { glDeleteBuffers (1, &this->reduction); }
+                this->reduction = 0;
+            }
+
+            // Replace the n floats of the SSBO buf with their exclusive prefix sum
+            void scan_floats (const GLuint buf, const std::size_t n) { this->scan (buf, n, false, 0); }
+
+            // Replace the n uints of the SSBO buf with their exclusive prefix sum
+            void scan_uints (const GLuint buf, const std::size_t n) { this->scan (buf, n, true, 0); }
+
+            /*!
+             * Reduce the n floats of the SSBO buf to their minimum, maximum and sum, which are
+             * left (as a vec4 of min, max, sum and 0) in the SSBO reduction_buffer(). Bind that to
+             * a shader that colour scales the data to autoscale it without any readback.
+             */
+            void reduce_floats (const GLuint buf, const std::size_t n)
+            {
+                std::size_t m = n;
+                GLuint in = buf;
+                bool first = true;
+                unsigned int k = 0;
+                do {
+                    const std::size_t groups = std::max (std::size_t{1}, (m + 255) / 256);
+                    const GLuint out = groups == 1 ? this->reduction : this->scratch_buffer (100 + (k++ % 2), groups * 4 * sizeof(float));
+                    compute_shaderprog<glver>& p = first ? this->reduce_first : this->reduce_next;
+                    p.use();
+                    p.set_uniform ("n", static_cast<unsigned int>(m));
+                    glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 0, in);
+                    glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 1, out);
+                    this->dispatch (p, groups);
+                    in = out;
+                    m = groups;
+                    first = false;
+                } while (m > 1);
+            }
+
+            // The SSBO that holds the result of the last reduce_floats
+            GLuint reduction_buffer() const { return this->reduction; }
+
+            // Reduce the n floats of buf and read back the range of the data (two floats)
+            sm::range<float> get_range (const GLuint buf, const std::size_t n)
+            {
+                const sm::vec<float, 3> r = this->reduce_and_read (buf, n);
+                return { r[0], r[1] };
+            }
+
+            // Reduce the n floats of buf and read back their sum
+            float sum (const GLuint buf, const std::size_t n) { return this->reduce_and_read (buf, n)[2]; }
+
+            /*!
+             * Count the n floats of the SSBO buf into the nbins uints of the SSBO bins, which
+             * divide the range lo to hi equally. Values outside the range are counted in the first
+             * or last bin.
+             */
+            void histogram (const GLuint buf, const std::size_t n, const GLuint bins, const unsigned int nbins,
+                            const float lo, const float hi)
+            {
+                this->run_histogram (buf, n, bins, nbins, lo, hi, false);
+            }
+
+            //! As histogram, but across the range of the data, found on the GPU with reduce_floats
+            void histogram (const GLuint buf, const std::size_t n, const GLuint bins, const unsigned int nbins)
+            {
+                this->reduce_floats (buf, n);
+                this->run_histogram (buf, n, bins, nbins, 0.0f, 1.0f, true);
+            }
+
+            /*!
+             * Sort the n uint keys of the SSBO keys into ascending order, with a stable radix sort
+             * of one bit per pass over the lowest bits bits of the keys. If values is not 0, it is
+             * an SSBO of 2n uints whose first n are reordered with the keys (a payload, such as
+             * the indices of the keys); the second n are scratch space.
+             */
+            void sort_uints (const GLuint keys, const std::size_t n, const GLuint values = 0, const unsigned int bits = 32)
+            {
+                if (n < 2) { return; }
+                const GLuint flags = this->scratch_buffer (200, n * sizeof(unsigned int));
+                const GLuint alt = this->scratch_buffer (201, n * sizeof(unsigned int));
+                const unsigned int u_n = static_cast<unsigned int>(n);
+                GLuint in = keys;
+                GLuint out = alt;
+                for (unsigned int b = 0; b < bits; ++b) {
+                    this->flags_prog.use();
+                    this->flags_prog.set_uniform ("n", u_n);
+                    this->flags_prog.set_uniform ("bit", b);
+                    glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 0, in);
+                    glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 1, flags);
+                    this->dispatch (this->flags_prog, (n + 127) / 128);
+
+                    this->scan_uints (flags, n);
+
+                    this->scatter_prog.use();
+                    this->scatter_prog.set_uniform ("n", u_n);
+                    this->scatter_prog.set_uniform ("bit", b);
+                    this->scatter_prog.set_uniform ("has_values", values != 0 ? 1u : 0u);
+                    glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 0, in);
+                    glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 1, flags);
+                    glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 2, out);
+                    glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 3, values != 0 ? values : flags);
+                    this->dispatch (this->scatter_prog, (n + 127) / 128);
+                    // The values were scattered into the second half; bring them back to the first
+                    if (values != 0) { this->copy (values, n * sizeof(unsigned int), values, 0, n * sizeof(unsigned int)); }
+                    std::swap (in, out);
+                }
+                // After an odd number of passes, the sorted keys are in the scratch buffer
+                if (in != keys) { this->copy (in, 0, keys, 0, n * sizeof(unsigned int)); }
+            }
+
+        private:
+            compute_shaderprog<glver> scan_float;
+            compute_shaderprog<glver> scan_uint;
+            compute_shaderprog<glver> add_float;
+            compute_shaderprog<glver> add_uint;
+            compute_shaderprog<glver> reduce_first;
+            compute_shaderprog<glver> reduce_next;
+            compute_shaderprog<glver> histogram_prog;
+            compute_shaderprog<glver> fill_prog;
+            compute_shaderprog<glver> flags_prog;
+            compute_shaderprog<glver> scatter_prog;
+            // The result of reduce_floats
+            GLuint reduction = 0;
+
+            // A scratch buffer, identified by its purpose (the level of a scan, say)
+            struct scratch_ssbo
+            {
+                unsigned int id = 0;
+                GLuint name = 0;
+                std::size_t bytes = 0;
+            };
+            std::vector<scratch_ssbo> scratch;
+
+            void build (compute_shaderprog<glver>& p, const char* body, const std::string& defines)
+            {
+                std::string src = mplot::gl::version::shaderpreamble (glver);
+                src += defines;
+                src += kernels::header;
+                src += body;
+                p.load_shaders ({ { GL_COMPUTE_SHADER, "", src, 0 } });
+                if (p.prog_id == 0) { throw std::runtime_error ("mplot::gl::compute_kernels: Failed to build a kernel"); }
+            }
+
+            // The scratch buffer id, of at least bytes bytes
+            GLuint scratch_buffer (const unsigned int id, const std::size_t bytes)
+            {
+                auto s = std::find_if (this->scratch.begin(), this->scratch.end(), [id](const scratch_ssbo& x) { return x.id == id; });
+                if (s == this->scratch.end()) {
+                    this->scratch.push_back ({ id, 0, 0 });
+                    s = this->scratch.end() - 1;
+                    glGenBuffers (1, &s->name);
+                }
+                if (s->bytes < bytes) {
+                    glBindBuffer (GL_SHADER_STORAGE_BUFFER, s->name);
+                    glBufferData (GL_SHADER_STORAGE_BUFFER, bytes, nullptr, GL_DYNAMIC_COPY);
+                    glBindBuffer (GL_SHADER_STORAGE_BUFFER, 0);
+                    s->bytes = bytes;
+                }
+                return s->name;
+            }
+
+            // Dispatch groups workgroups of p, as a 2D grid if there are more than 65535
+            void dispatch (const compute_shaderprog<glver>& p, const std::size_t groups) const
+            {
+                const std::size_t gx = std::min (std::max (groups, std::size_t{1}), std::size_t{65535});
+                const std::size_t gy = (std::max (groups, std::size_t{1}) + gx - 1) / gx;
+                p.dispatch (static_cast<GLuint>(gx), static_cast<GLuint>(gy), 1);
+            }
+
+            // Copy bytes bytes between buffers
+            void copy (const GLuint from, const std::size_t from_offset, const GLuint to, const std::size_t to_offset,
+                       const std::size_t bytes) const
+            {
+                glBindBuffer (GL_COPY_READ_BUFFER, from);
+                glBindBuffer (GL_COPY_WRITE_BUFFER, to);
+                glCopyBufferSubData (GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, from_offset, to_offset, bytes);
+                glBindBuffer (GL_COPY_READ_BUFFER, 0);
+                glBindBuffer (GL_COPY_WRITE_BUFFER, 0);
+            }
+
+            // Exclusive scan with one level of block sums for each 256 fold of n
+            void scan (const GLuint buf, const std::size_t n, const bool uints, const unsigned int level)
+            {
+                if (n == 0) { return; }
+                const std::size_t groups = (n + 255) / 256;
+                const GLuint sums = this->scratch_buffer (level, groups * sizeof(float)); // float and uint are 4 bytes
+                compute_shaderprog<glver>& sp = uints ? this->scan_uint : this->scan_float;
+                sp.use();
+                sp.set_uniform ("n", static_cast<unsigned int>(n));
+                sp.set_uniform ("write_sums", groups > 1 ? 1u : 0u);
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 0, buf);
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 1, sums);
+                this->dispatch (sp, groups);
+                if (groups == 1) { return; }
+
+                // Scan the block sums, then add each to its block
+                this->scan (sums, groups, uints, level + 1);
+                compute_shaderprog<glver>& ap = uints ? this->add_uint : this->add_float;
+                ap.use();
+                ap.set_uniform ("n", static_cast<unsigned int>(n));
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 0, buf);
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 1, sums);
+                this->dispatch (ap, (n + 127) / 128);
+            }
+
+            void run_histogram (const GLuint buf, const std::size_t n, const GLuint bins, const unsigned int nbins,
+                                const float lo, const float hi, const bool range_from_buffer)
+            {
+                if (nbins == 0) { return; }
+                this->fill_prog.use();
+                this->fill_prog.set_uniform ("n", nbins);
+                this->fill_prog.set_uniform ("value", 0u);
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 0, bins);
+                this->dispatch (this->fill_prog, (nbins + 127) / 128);
+                if (n == 0) { return; }
+
+                this->histogram_prog.use();
+                this->histogram_prog.set_uniform ("n", static_cast<unsigned int>(n));
+                this->histogram_prog.set_uniform ("nbins", nbins);
+                this->histogram_prog.set_uniform ("lo", lo);
+                this->histogram_prog.set_uniform ("hi", hi);
+                this->histogram_prog.set_uniform ("range_from_buffer", range_from_buffer ? 1u : 0u);
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 0, buf);
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 1, bins);
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 2, this->reduction);
+                this->dispatch (this->histogram_prog, (n + 127) / 128);
+            }
+
+            sm::vec<float, 3> reduce_and_read (const GLuint buf, const std::size_t n)
+            {
+                this->reduce_floats (buf, n);
+                sm::vec<float, 3> r = {};
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, this->reduction);
+                const float* p = static_cast<const float*>(glMapBufferRange (GL_SHADER_STORAGE_BUFFER, 0, 3 * sizeof(float), GL_MAP_READ_BIT));
+                if (p != nullptr) { r = { p[0], p[1], p[2] }; }
+                glUnmapBuffer (GL_SHADER_STORAGE_BUFFER);
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, 0);
+                mplot::gl::Util::checkError (__FILE__, __LINE__);
+                return r;
+            }
+        };
+
+    } // namespace gl
+} // namespace mplot
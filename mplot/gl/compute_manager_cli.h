@@ -21,6 +21,7 @@
 #include <mplot/gl/util_nomx.h>
 #include <mplot/gl/shaders.h>
 #include <mplot/gl/compute_shaderprog.h> // A compute-shader class
+#include <mplot/gl/compute_step.h> // Fenced compute steps
 
 // EGL and gbm for a headless OpenGL context
 #include <EGL/egl.h>
@@ -37,11 +38,11 @@ namespace mplot {
         using sc = std::chrono::steady_clock;
 
         // A default shader which won't compile (better than having an empty no-op default shader)
-        const char* defaultComputeShader = "This is an intentionally non-compiling non-shader\n";
+        inline constexpr const char* defaultComputeShader = "This is an intentionally non-compiling non-shader\n";
 
         // You may wish to pass a compiled-in shader that will fail, so that your system MUST find the
         // file-based shader in mplot::gl::LoadShaders.
-        const char* nonCompilingComputeShader = "This is an intentionally non-compiling non-shader\n";
+        inline constexpr const char* nonCompilingComputeShader = "This is an intentionally non-compiling non-shader\n";
 
         /*!
          * A gl compute environment. I think user will extend this class to add their data structures
@@ -54,6 +55,7 @@ namespace mplot {
             ~compute_manager_cli()
             {
                 // cleanup
+                this->profiler.deinit();
             }
 
             //! Init GLFW and then the GLFW window. What if you want to set window width
@@ -282,11 +284,31 @@ namespace mplot {
             unsigned int frame_count = 0;
             sc::time_point t0, t1;
 
+            // Times of the GPU work. Point a compute_shaderprog's profiler here to time its
+            // dispatches, and bracket uploads and readbacks with profiler.begin()/end().
+            gpu_profiler profiler;
+            // If non-zero, measure_compute() writes the profiler's stats to stdout every
+            // profile_every frames
+            unsigned int profile_every = 0;
+
+            // Submit the step s, timed by the profiler, without waiting for the GPU. Poll
+            // s.ready() before reading its results (see compute_step.h).
+            void submit (compute_step& s) { s.submit (&this->profiler); }
+
+            // Submit the step s, which writes out.write_buffer(). out.acquire() makes the result
+            // current once the GPU has finished, so that the next step can run while it is read.
+            template <typename T>
+            void submit (compute_step& s, step_buffers<T>& out) { out.submit (s, &this->profiler); }
+
             // Measure the time to execute nframes frames and output an FPS message. Client
             // code has to call this with every call to compute() to get the measurement
-            // (though its use is entirely optional).
+            // (though its use is entirely optional). This also collects the profiler's results.
             void measure_compute()
             {
+                this->profiler.collect();
+                if (this->profile_every > 0 && frame_count > 0 && (frame_count % this->profile_every) == 0) {
+                    this->profiler.print (std::cout);
+                }
                 if ((frame_count++ % nframes) == 0) {
                     this->t1 = sc::now();
                     sc::duration t_d = t1 - t0;
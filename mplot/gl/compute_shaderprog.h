@@ -3,6 +3,9 @@
 #include <vector>
 #include <string>
 #include <sstream>
+#include <unordered_map>
+#include <memory>
+#include <iostream>
 #include <cstddef>
 
 #include <sm/vec>
@@ -10,8 +13,11 @@
 
 #include <mplot/gl/version.h>
 #include <mplot/gl/util_nomx.h>
+#include <mplot/gl/debug_group_nomx.h>
 #include <mplot/gl/shaders.h>
 #include <mplot/gl/loadshaders_nomx.h>
+#include <mplot/gl/gpu_profiler.h>
+#include <mplot/gl/shader_watcher.h>
 
 namespace mplot {
     namespace gl {
@@ -21,6 +27,11 @@ namespace mplot {
         {
             GLuint prog_id = 0;
 
+            // If set, each dispatch is timed on the GPU as the profiler section called name, and
+            // its memory barrier is counted
+            gpu_profiler* profiler = nullptr;
+            std::string name = "dispatch";
+
             // Default constructor
             compute_shaderprog() {}
 
@@ -47,6 +58,35 @@ namespace mplot {
             void load_shaders (const std::vector<mplot::gl::ShaderInfo>& shaders)
             {
                 this->prog_id = mplot::gl::LoadShaders (shaders);
+                this->uniform_locations.clear();
+                this->shader_info = shaders;
+                if (this->watcher) { this->watcher->watch (this->shader_info); }
+            }
+
+            // Watch the program's shader files (or stop watching, if !w) for reload_if_changed()
+            void watch_shaders (const bool w = true)
+            {
+                if (!w) { this->watcher.reset(); return; }
+                if (!this->watcher) { this->watcher = std::make_unique<shader_watcher>(); }
+                this->watcher->watch (this->shader_info);
+            }
+
+            // Call at a frame boundary. If a watched shader file has changed, rebuild the program
+            // and, if it compiles and links, swap it in for the old one and return true. The
+            // caller must then set its uniforms again; buffers and textures are unaffected. If
+            // the new program fails, the old one is kept.
+            bool reload_if_changed()
+            {
+                if (!this->watcher || !this->watcher->changed()) { return false; }
+                const GLuint p = mplot::gl::LoadShaders (this->shader_info, false);
+                if (p == 0) {
+                    std::cerr << "compute_shaderprog: keeping the previous program" << std::endl;
+                    return false;
+                }
+                if (this->prog_id) { glDeleteProgram (this->prog_id); }
+                this->prog_id = p;
+                this->uniform_locations.clear();
+                return true;
             }
 
             void use() const { glUseProgram (this->prog_id); }
@@ -54,17 +94,44 @@ namespace mplot {
             // Convenience wrapper for dispatch
             void dispatch (GLuint ngrps_x, GLuint ngrps_y, GLuint ngrps_z) const
             {
+                MPLOT_TRACE_GL (this->name.c_str());
+                if (this->profiler != nullptr) {
+                    this->profiler->begin (this->name);
+                    glDispatchCompute (ngrps_x, ngrps_y, ngrps_z);
+                    this->profiler->end();
+                    this->profiler->barrier (GL_ALL_BARRIER_BITS);
+                    return;
+                }
                 glDispatchCompute (ngrps_x, ngrps_y, ngrps_z);
                 // Choices of GL_SHADER_IMAGE_ACCESS_BARRIER_BIT, GL_SHADER_STORAGE_BARRIER_BIT or GL_ALL_BARRIER_BITS (or others).
                 glMemoryBarrier (GL_ALL_BARRIER_BITS);
             }
 
+            // The location of the uniform glsl_varname, looked up in the program only on the first
+            // call for that name. Resolve the locations of the uniforms that are set on every
+            // dispatch once, and set them with set_uniform (location, value), which involves no
+            // string lookup at all. Throws if the uniform is not active.
+            GLint uniform_location (const std::string& glsl_varname)
+            {
+                auto li = this->uniform_locations.find (glsl_varname);
+                if (li != this->uniform_locations.end()) { return li->second; }
+                GLint uloc = glGetUniformLocation (this->prog_id, static_cast<const GLchar*>(glsl_varname.c_str()));
+                this->check_uniform_location (glsl_varname, uloc);
+                this->uniform_locations[glsl_varname] = uloc;
+                return uloc;
+            }
+
             // Set a uniform variable into the OpenGL context associated with this shader program
             template <typename T>
             void set_uniform (const std::string& glsl_varname, const T& value)
             {
-                GLint uloc = glGetUniformLocation (this->prog_id, static_cast<const GLchar*>(glsl_varname.c_str()));
-                this->check_uniform_location (glsl_varname, uloc);
+                this->set_uniform (this->uniform_location (glsl_varname), value);
+            }
+
+            // Set the uniform at the location uloc (from uniform_location)
+            template <typename T>
+            void set_uniform (const GLint uloc, const T& value)
+            {
                 if constexpr (std::is_same<std::decay_t<T>, float>::value == true) {
                     if (uloc != -1) { glUniform1f (uloc, static_cast<GLfloat>(value)); }
                 } else if constexpr (std::is_same<std::decay_t<T>, int>::value == true) {
@@ -80,8 +147,13 @@ namespace mplot {
             template <typename T, std::size_t N>
             void set_uniform (const std::string& glsl_varname, const sm::vec<T, N>& value)
             {
-                GLint uloc = glGetUniformLocation (this->prog_id, static_cast<const GLchar*>(glsl_varname.c_str()));
-                this->check_uniform_location (glsl_varname, uloc);
+                this->set_uniform (this->uniform_location (glsl_varname), value);
+            }
+
+            // Set the uniform array at the location uloc (from uniform_location)
+            template <typename T, std::size_t N>
+            void set_uniform (const GLint uloc, const sm::vec<T, N>& value)
+            {
                 if constexpr (std::is_same<std::decay_t<T>, float>::value == true) {
                     if (uloc != -1) { glUniform1fv (uloc, N, value.data()); }
                 } else if constexpr (std::is_same<std::decay_t<T>, int>::value == true) {
@@ -93,7 +165,24 @@ namespace mplot {
                 }
             }
 
+            // Attach the program's uniform block block_name to buffer binding point binding (see
+            // uniform_block.h). Throws if the program has no such active block.
+            void bind_uniform_block (const std::string& block_name, const GLuint binding) const
+            {
+                const GLuint bi = glGetUniformBlockIndex (this->prog_id, block_name.c_str());
+                if (bi == GL_INVALID_INDEX) {
+                    throw std::runtime_error ("compute_shaderprog: the program has no active uniform block " + block_name);
+                }
+                glUniformBlockBinding (this->prog_id, bi, binding);
+            }
+
         private:
+            // Uniform locations by name, filled by uniform_location
+            std::unordered_map<std::string, GLint> uniform_locations;
+            // The sources of the program, kept for reloading, and their watcher (if watching)
+            std::vector<mplot::gl::ShaderInfo> shader_info;
+            std::unique_ptr<shader_watcher> watcher;
+
             // Runtime check on a uniform location. If -1 throw exception. This is useful because
             // any uniform variable in a GLSL program which is not used may be compiled out and thus
             // be not 'active'. In this case, glGetUniformLocation will return -1. Our programmer
@@ -0,0 +1,162 @@
+/*!
+ * \file
+ *
+ * Fenced compute steps, so that a simulation can run ahead of its visualization instead of in
+ * lockstep with it.
+ *
+ * A compute_step holds the commands of one step of a computation (its dispatches and the
+ * barriers between them). submit() issues them, a final memory barrier and a fence, and
+ * returns at once. ready() then says, without blocking, whether the GPU has finished the step.
+ *
+ * step_buffers holds two output buffers: the one that the step in flight writes and the one
+ * that holds the latest finished result, which is what readers (a map(), a copy_from_gpu() or a
+ * VisualModel's setScalarDataBuffer) use. acquire() swaps them once the step in flight has
+ * finished, so the render of step n reads one buffer while step n+1 writes the other:
+ *
+ *   // once:
+ *   outputs.init (3, n);
+ *   step.commands = [&]{ prog.use(); prog.dispatch (n / 64, 1, 1); };
+ *   // each frame:
+ *   if (outputs.acquire()) { // a finished step is shown
+ *       model->setScalarDataBuffer (outputs.current().name);
+ *       model->updateDataBuffer();
+ *   }
+ *   if (!outputs.in_flight()) { outputs.submit (step); } // start the next one
+ *   v.render();
+ *
+ * \author Seb James
+ * \date 2026
+ */
+#pragma once
+
+// As for compute_manager.h, the client code includes the GL headers before this file.
+
+#include <string>
+#include <functional>
+#include <cstddef>
+#include <mplot/gl/ssbo.h>
+#include <mplot/gl/gpu_profiler.h>
+
+namespace mplot {
+    namespace gl {
+
+        // The commands of one step of a computation, and the fence that follows them on the GPU
+        struct compute_step
+        {
+            // The step's name, under which a profiler times it
+            std::string name = "step";
+            // Issues the step's dispatches (and any barriers needed between them)
+            std::function<void()> commands;
+            // The memory barrier issued after the commands (none if 0). Choose the bits that
+            // match how the results will be read (GL_SHADER_STORAGE_BARRIER_BIT for a following
+            // compute shader, GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT for vertex buffers and so on).
+            GLbitfield barrier = GL_ALL_BARRIER_BITS;
+            // The number of times the step has been submitted
+            unsigned long long submitted = 0;
+
+            ~compute_step() { this->fence.clear(); }
+
+            // Issue the commands, the barrier and a fence. Returns without waiting for the GPU.
+            void submit (gpu_profiler* profiler = nullptr)
+            {
+                if (!this->commands) { throw std::runtime_error ("mplot::gl::compute_step::submit: the step has no commands"); }
+                if (profiler != nullptr) { profiler->begin (this->name); }
+                this->commands();
+                if (profiler != nullptr) { profiler->end(); }
+                if (this->barrier != 0) {
+                    if (profiler != nullptr) { profiler->barrier (this->barrier); } else { glMemoryBarrier (this->barrier); }
+                }
+                this->fence.set();
+                ++this->submitted;
+            }
+
+            // True if the GPU has finished the last submission (or there has been none). Never blocks.
+            bool ready() { return this->fence.ready(); }
+
+            // Block until the GPU has finished the last submission
+            void wait() { this->fence.wait(); }
+
+        private:
+            gpu_fence fence;
+        };
+
+        // Double buffered outputs of a compute_step. The buffer being written is handed over to
+        // readers only once the fence of the step that wrote it has been passed.
+        template <typename T>
+        struct step_buffers
+        {
+            // Make the two buffers, of n elements of value val. The write buffer is bound to index.
+            void init (const unsigned int index, const std::size_t n, const T val = T{})
+            {
+                this->cur = 0;
+                this->last = nullptr;
+                this->step = 0;
+                this->buf[0].init (index, n, val);
+                this->buf[1].init (index, n, val);
+                this->write_buffer().bind();
+            }
+
+            void deinit()
+            {
+                this->last = nullptr;
+                this->buf[0].deinit();
+                this->buf[1].deinit();
+            }
+
+            // Submit s, whose commands write write_buffer(). If a step is still in flight, its
+            // buffer is written again and the result of that step won't be seen.
+            void submit (compute_step& s, gpu_profiler* profiler = nullptr)
+            {
+                this->write_buffer().bind();
+                s.submit (profiler);
+                this->last = &s;
+            }
+
+            // True if a submitted step has not yet been acquired
+            bool in_flight() const { return this->last != nullptr; }
+
+            // True if the step in flight has finished. Never blocks.
+            bool ready() { return this->last != nullptr && this->last->ready(); }
+
+            // If the step in flight has finished, make its buffer the current one and return true
+            bool acquire()
+            {
+                if (!this->ready()) { return false; }
+                this->swap();
+                return true;
+            }
+
+            // Block until the step in flight (if there is one) has finished, then acquire it
+            void acquire_wait()
+            {
+                if (this->last == nullptr) { return; }
+                this->last->wait();
+                this->swap();
+            }
+
+            // The buffer with the result of the latest acquired step
+            vvec_ssbo<T>& current() { return this->buf[this->cur]; }
+            // The buffer that the next submitted step writes
+            vvec_ssbo<T>& write_buffer() { return this->buf[this->cur ^ 1u]; }
+            // The number of steps acquired
+            unsigned long long steps() const { return this->step; }
+
+        private:
+            void swap()
+            {
+                this->cur ^= 1u;
+                this->last = nullptr;
+                ++this->step;
+                // Both buffers share the write binding; keep it on the one to be written next
+                this->write_buffer().bind();
+            }
+
+            vvec_ssbo<T> buf[2];
+            // The step in flight, which must outlive its submission
+            compute_step* last = nullptr;
+            unsigned int cur = 0;
+            unsigned long long step = 0;
+        };
+
+    } // namespace gl
+} // namespace mplot
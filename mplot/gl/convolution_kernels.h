@@ -0,0 +1,349 @@
+#pragma once
+
+/*
+ * Convolutions of grid data held in SSBOs, with compute shaders: a general 2D kernel and a
+ * separable one (a pass along the rows into a scratch buffer, then one along the columns) over a
+ * rectangular grid, and a set of hex_taps over the hexes of an sm::hexgrid, found by walking its
+ * neighbour table. Each is the sum that mplot::convolution (in mplot/convolution.h) computes on
+ * the CPU, with one invocation per element.
+ *
+ * The output is an SSBO of one float per element, which a HexGridVisual or CartGridVisual in
+ * gpu_mesh mode takes with setScalarDataBuffer. A rectangular convolution can also write a single
+ * channel float texture, which a GridVisual in GridVisMode::Texture takes with setDataTexture.
+ * The weights are a small upload, so a filter's parameters can be changed on every frame.
+ *
+ * Each convolution ends with the shader storage and texture fetch barrier that its readers need.
+ * Each kernel binds its buffers to the binding indices 0 to 3 of GL_SHADER_STORAGE_BUFFER (and
+ * the output texture to image unit 0), so rebind your own buffers before your own dispatches.
+ *
+ * Note: You have to include a header like gl3.h or glext.h etc for the GL types and
+ * functions BEFORE including this file.
+ *
+ * Author: Seb James.
+ */
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+#include <mplot/convolution.h>
+#include <mplot/gl/version.h>
+#include <mplot/gl/util_nomx.h>
+#include <mplot/gl/compute_shaderprog.h>
+#include <mplot/gl/compute_kernels.h>
+
+namespace mplot {
+    namespace gl {
+
+        namespace kernels {
+
+            // The input and output of a rectangular convolution, and the input read beyond the
+            // grid's edges as mplot::convolution::rect_at reads it (edge is an mplot::edge_mode)
+            inline constexpr const char* conv_rect_common = "layout (std430, binding = 0) readonly buffer In { float a[]; };\n"
+            "layout (std430, binding = 1) writeonly buffer Out { float b[]; };\n"
+            "layout (std430, binding = 2) readonly buffer Weights { float k[]; };\n"
+            "uniform uint w;\n"
+            "uniform uint h;\n"
+            "uniform uint edge;\n"
+            "#ifdef OUT_TEXTURE\n"
+            "layout (r32f, binding = 0) writeonly uniform highp image2D out_img;\n"
+            "#endif\n"
+            "int wrap (int x, int n) { return x - n * int(floor (float(x) / float(n))); }\n"
+            "float at (int x, int y)\n"
+            "{\n"
+            "    int iw = int(w);\n"
+            "    int ih = int(h);\n"
+            "    if (edge == 1u) {\n"
+            "        x = clamp (x, 0, iw - 1);\n"
+            "        y = clamp (y, 0, ih - 1);\n"
+            "    } else if (edge == 2u) {\n"
+            "        x = wrap (x, iw);\n"
+            "        y = wrap (y, ih);\n"
+            "    } else if (x < 0 || y < 0 || x >= iw || y >= ih) {\n"
+            "        return 0.0;\n"
+            "    }\n"
+            "    return a[uint(y) * w + uint(x)];\n"
+            "}\n"
+            "void store (uint i, int x, int y, float s)\n"
+            "{\n"
+            "    b[i] = s;\n"
+            "#ifdef OUT_TEXTURE\n"
+            "    imageStore (out_img, ivec2(x, y), vec4(s, 0.0, 0.0, 0.0));\n"
+            "#endif\n"
+            "}\n";
+
+            // A general kw by kh kernel, in rows from k[0]
+            inline constexpr const char* conv_rect = "uniform uint kw;\n"
+            "uniform uint kh;\n"
+            "void main()\n"
+            "{\n"
+            "    uint i = group_id() * 128u + gl_LocalInvocationID.x;\n"
+            "    if (i >= w * h) { return; }\n"
+            "    int x = int(i % w);\n"
+            "    int y = int(i / w);\n"
+            "    float s = 0.0;\n"
+            "    for (uint j = 0u; j < kh; ++j) {\n"
+            "        for (uint l = 0u; l < kw; ++l) {\n"
+            "            s += k[j * kw + l] * at (x + int(l) - int(kw / 2u), y + int(j) - int(kh / 2u));\n"
+            "        }\n"
+            "    }\n"
+            "    store (i, x, y, s);\n"
+            "}\n";
+
+            // A 1D kernel of kn taps from k[k0], along the rows (dir 0) or the columns (dir 1)
+            inline constexpr const char* conv_line = "uniform uint kn;\n"
+            "uniform uint k0;\n"
+            "uniform uint dir;\n"
+            "void main()\n"
+            "{\n"
+            "    uint i = group_id() * 128u + gl_LocalInvocationID.x;\n"
+            "    if (i >= w * h) { return; }\n"
+            "    int x = int(i % w);\n"
+            "    int y = int(i / w);\n"
+            "    float s = 0.0;\n"
+            "    for (uint l = 0u; l < kn; ++l) {\n"
+            "        int o = int(l) - int(kn / 2u);\n"
+            "        s += k[k0 + l] * (dir == 0u ? at (x + o, y) : at (x, y + o));\n"
+            "    }\n"
+            "    store (i, x, y, s);\n"
+            "}\n";
+
+            // A set of hex taps, each reached by walking the neighbour table nb (six ints per hex:
+            // east, north east, north west, west, south west, south east, -1 for none) as
+            // mplot::convolution::hex_walk walks it
+            inline constexpr const char* conv_hex = "layout (std430, binding = 0) readonly buffer In { float a[]; };\n"
+            "layout (std430, binding = 1) writeonly buffer Out { float b[]; };\n"
+            "struct Tap { int dr; int dg; float w; };\n"
+            "layout (std430, binding = 2) readonly buffer Taps { Tap t[]; };\n"
+            "layout (std430, binding = 3) readonly buffer Neighbours { int nb[]; };\n"
+            "uniform uint n;\n"
+            "uniform uint n_taps;\n"
+            "void main()\n"
+            "{\n"
+            "    uint i = group_id() * 128u + gl_LocalInvocationID.x;\n"
+            "    if (i >= n) { return; }\n"
+            "    float s = 0.0;\n"
+            "    for (uint q = 0u; q < n_taps; ++q) {\n"
+            "        int j = int(i);\n"
+            "        int dr = t[q].dr;\n"
+            "        int dg = t[q].dg;\n"
+            "        for (int m = 0; m < abs (dr) && j >= 0; ++m) { j = nb[6 * j + (dr > 0 ? 0 : 3)]; }\n"
+            "        for (int m = 0; m < abs (dg) && j >= 0; ++m) { j = nb[6 * j + (dg > 0 ? 1 : 4)]; }\n"
+            "        if (j >= 0) { s += t[q].w * a[j]; }\n"
+            "    }\n"
+            "    b[i] = s;\n"
+            "}\n";
+
+        } // namespace kernels
+
+        /*!
+         * The convolution kernels and the buffers of their weights. Hold one in your
+         * compute_manager subclass (or beside your Visual) and call init() once there is a GL
+         * context. Set a kernel with set_rect_kernel, set_separable_kernel or set_hex_taps, then
+         * convolve as often as the data change.
+         */
+        template <int glver>
+        struct convolution_kernels
+        {
+            //! What the rectangular convolutions read beyond the edges of the grid
+            mplot::edge_mode edge = mplot::edge_mode::zero;
+
+            // Compile the kernels. Client code must ensure there is an OpenGL context available.
+            void init()
+            {
+                if constexpr (!mplot::gl::version::at_least (glver, 4, 3) && !mplot::gl::version::es_at_least (glver, 3, 1)) {
+                    throw std::runtime_error ("mplot::gl::convolution_kernels: compute shaders need OpenGL 4.3 or OpenGL 3.1 ES");
+                }
+                const std::string tex = "#define OUT_TEXTURE 1\n";
+                this->build (this->rect_prog[0], "", kernels::conv_rect_common, kernels::conv_rect);
+                this->build (this->rect_prog[1], tex, kernels::conv_rect_common, kernels::conv_rect);
+                this->build (this->line_prog[0], "", kernels::conv_rect_common, kernels::conv_line);
+                this->build (this->line_prog[1], tex, kernels::conv_rect_common, kernels::conv_line);
+                this->build (this->hex_prog, "", "", kernels::conv_hex);
+                glGenBuffers (5, this->bufs.data());
+                mplot::gl::Util::checkError (__FILE__, __LINE__);
+            }
+
+            // Delete the buffers (the programs are deleted with this object)
+            void deinit()
+            {
+                if (this->bufs[0] != 0) { glDeleteBuffers (5, this->bufs.data()); }
+                this->bufs = { 0, 0, 0, 0, 0 };
+                this->scratch_bytes = 0;
+                this->n_neighbours = 0;
+            }
+
+            //! Set the general kernel for convolve_rect: kw by kh weights in rows (kw and kh odd)
+            void set_rect_kernel (const std::vector<float>& k, const unsigned int kw, const unsigned int kh)
+            {
+                if (k.size() != std::size_t{kw} * kh) { throw std::runtime_error ("mplot::gl::convolution_kernels::set_rect_kernel: k has not kw * kh weights"); }
+                this->upload (this->bufs[weights_buf], k.data(), k.size() * sizeof(float));
+                this->kdims = { kw, kh };
+            }
+
+            //! Set the row kernel kx and the column kernel ky for convolve_separable (each of odd length)
+            void set_separable_kernel (const std::vector<float>& kx, const std::vector<float>& ky)
+            {
+                std::vector<float> k (kx);
+                k.insert (k.end(), ky.begin(), ky.end());
+                this->upload (this->bufs[sep_weights_buf], k.data(), k.size() * sizeof(float));
+                this->sep_n = { static_cast<unsigned int>(kx.size()), static_cast<unsigned int>(ky.size()) };
+            }
+
+            //! Set the taps for convolve_hex (see mplot::convolution::hex_gaussian)
+            void set_hex_taps (const std::vector<mplot::hex_tap>& taps)
+            {
+                this->upload (this->bufs[taps_buf], taps.data(), taps.size() * sizeof (mplot::hex_tap));
+                this->n_taps = static_cast<unsigned int>(taps.size());
+            }
+
+            //! Set the hexgrid's neighbour table, once (see mplot::convolution::neighbours_of)
+            void set_hex_neighbours (const std::vector<mplot::convolution::hex_neighbours>& nb)
+            {
+                this->upload (this->bufs[neighbours_buf], nb.data(), nb.size() * sizeof (mplot::convolution::hex_neighbours));
+                this->n_neighbours = nb.size();
+            }
+
+            /*!
+             * Also write the outputs of the rectangular convolutions into tex, a single channel
+             * float (GL_R32F) texture of the grid's width and height. Pass 0 to stop.
+             */
+            void set_output_texture (const GLuint tex) { this->out_texture = tex; }
+
+            //! Convolve the w by h grid in the SSBO in (in rows) with the kernel of set_rect_kernel, into the SSBO out
+            void convolve_rect (const GLuint in, const GLuint out, const unsigned int w, const unsigned int h)
+            {
+                compute_shaderprog<glver>& p = this->rect_prog[this->out_texture != 0 ? 1 : 0];
+                this->set_grid (p, w, h);
+                p.set_uniform ("kw", this->kdims[0]);
+                p.set_uniform ("kh", this->kdims[1]);
+                this->bind (in, out, this->bufs[weights_buf], true);
+                this->dispatch (p, std::size_t{w} * h);
+                glMemoryBarrier (output_barrier);
+            }
+
+            /*!
+             * Convolve the w by h grid in the SSBO in with the separable kernel of
+             * set_separable_kernel, into the SSBO out. The pass along the rows writes a
+             * scratch buffer, which grows to fit.
+             */
+            void convolve_separable (const GLuint in, const GLuint out, const unsigned int w, const unsigned int h)
+            {
+                const std::size_t n = std::size_t{w} * h;
+                if (this->scratch_bytes < n * sizeof(float)) {
+                    this->upload (this->bufs[scratch_buf], nullptr, n * sizeof(float));
+                    this->scratch_bytes = n * sizeof(float);
+                }
+                compute_shaderprog<glver>& p0 = this->line_prog[0];
+                this->set_grid (p0, w, h);
+                this->set_line (p0, this->sep_n[0], 0u, 0u);
+                this->bind (in, this->bufs[scratch_buf], this->bufs[sep_weights_buf], false);
+                this->dispatch (p0, n);
+                glMemoryBarrier (GL_SHADER_STORAGE_BARRIER_BIT);
+
+                compute_shaderprog<glver>& p1 = this->line_prog[this->out_texture != 0 ? 1 : 0];
+                this->set_grid (p1, w, h);
+                this->set_line (p1, this->sep_n[1], this->sep_n[0], 1u);
+                this->bind (this->bufs[scratch_buf], out, this->bufs[sep_weights_buf], true);
+                this->dispatch (p1, n);
+                glMemoryBarrier (output_barrier);
+            }
+
+            //! Convolve the data on the hexes in the SSBO in with the taps of set_hex_taps, into the SSBO out
+            void convolve_hex (const GLuint in, const GLuint out)
+            {
+                if (this->n_neighbours == 0) { throw std::runtime_error ("mplot::gl::convolution_kernels::convolve_hex: call set_hex_neighbours first"); }
+                this->hex_prog.use();
+                this->hex_prog.set_uniform ("n", static_cast<unsigned int>(this->n_neighbours));
+                this->hex_prog.set_uniform ("n_taps", this->n_taps);
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 0, in);
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 1, out);
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 2, this->bufs[taps_buf]);
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 3, this->bufs[neighbours_buf]);
+                this->dispatch (this->hex_prog, this->n_neighbours);
+                glMemoryBarrier (output_barrier);
+            }
+
+        private:
+            // The barrier after each convolution, so that the output may be read by a following
+            // kernel, as a VisualModel's gpu mesh data or as a texture
+            static constexpr GLbitfield output_barrier = GL_SHADER_STORAGE_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT;
+            // The indices in bufs of the rect weights, the separable weights, the hex taps and
+            // neighbours, and the scratch buffer of the separable convolution
+            static constexpr unsigned int weights_buf = 0;
+            static constexpr unsigned int sep_weights_buf = 1;
+            static constexpr unsigned int taps_buf = 2;
+            static constexpr unsigned int neighbours_buf = 3;
+            static constexpr unsigned int scratch_buf = 4;
+            std::array<GLuint, 5> bufs = { 0, 0, 0, 0, 0 };
+            std::size_t scratch_bytes = 0;
+            std::array<unsigned int, 2> kdims = { 0u, 0u };
+            std::array<unsigned int, 2> sep_n = { 0u, 0u };
+            unsigned int n_taps = 0;
+            std::size_t n_neighbours = 0;
+            GLuint out_texture = 0;
+
+            // The two versions (without, then with, the output texture) of the rectangular kernels
+            std::array<compute_shaderprog<glver>, 2> rect_prog;
+            std::array<compute_shaderprog<glver>, 2> line_prog;
+            compute_shaderprog<glver> hex_prog;
+
+            void build (compute_shaderprog<glver>& p, const std::string& defines, const char* common, const char* body)
+            {
+                std::string src = mplot::gl::version::shaderpreamble (glver);
+                src += defines;
+                src += kernels::header;
+                src += common;
+                src += body;
+                p.load_shaders ({ { GL_COMPUTE_SHADER, "", src, 0 } });
+                if (p.prog_id == 0) { throw std::runtime_error ("mplot::gl::convolution_kernels: Failed to build a kernel"); }
+            }
+
+            void set_grid (compute_shaderprog<glver>& p, const unsigned int w, const unsigned int h)
+            {
+                p.use();
+                p.set_uniform ("w", w);
+                p.set_uniform ("h", h);
+                p.set_uniform ("edge", static_cast<unsigned int>(this->edge));
+            }
+
+            void set_line (compute_shaderprog<glver>& p, const unsigned int kn, const unsigned int k0, const unsigned int dir)
+            {
+                p.set_uniform ("kn", kn);
+                p.set_uniform ("k0", k0);
+                p.set_uniform ("dir", dir);
+            }
+
+            // Bind the input, output and weights, and the output texture if it is to be written
+            void bind (const GLuint in, const GLuint out, const GLuint weights, const bool to_texture)
+            {
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 0, in);
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 1, out);
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 2, weights);
+                if (to_texture && this->out_texture != 0) {
+                    glBindImageTexture (0, this->out_texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+                }
+            }
+
+            // Replace the contents of buf with bytes bytes from data (at least one float, so that the buffer is never empty)
+            void upload (const GLuint buf, const void* data, const std::size_t bytes)
+            {
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, buf);
+                glBufferData (GL_SHADER_STORAGE_BUFFER, std::max (bytes, sizeof(float)), bytes > 0 ? data : nullptr, GL_DYNAMIC_DRAW);
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, 0);
+                mplot::gl::Util::checkError (__FILE__, __LINE__);
+            }
+
+            // Dispatch one invocation per element, as a 2D grid of workgroups if there are more than 65535
+            void dispatch (const compute_shaderprog<glver>& p, const std::size_t n) const
+            {
+                const std::size_t groups = std::max ((n + 127) / 128, std::size_t{1});
+                const std::size_t gx = std::min (groups, std::size_t{65535});
+                p.dispatch (static_cast<GLuint>(gx), static_cast<GLuint>((groups + gx - 1) / gx), 1);
+            }
+        };
+
+    } // namespace gl
+} // namespace mplot
@@ -0,0 +1,44 @@
+#pragma once
+
+/*
+ * A GL debug group and trace event for a block of GL calls (see mplot/trace.h), for the
+ * multi-context (GladGLContext) build. With MPLOT_TRACE defined as 1, MPLOT_TRACE_GL_MX (glfn,
+ * name) pushes a debug group called name (where glfn has PushDebugGroup, from OpenGL 4.3 or
+ * KHR_debug) and records a trace event, both of which end with the enclosing block. Otherwise it
+ * compiles to nothing.
+ *
+ * As for util_mx.h, include the GL headers BEFORE this file.
+ *
+ * Author: Seb James.
+ */
+
+#include <mplot/trace.h>
+
+namespace mplot {
+    namespace gl {
+
+        struct debug_group_mx
+        {
+            debug_group_mx (GladGLContext* _glfn, const char* name) : scope (name)
+            {
+                if (_glfn == nullptr || _glfn->PushDebugGroup == nullptr) { return; }
+                _glfn->PushDebugGroup (GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+                this->glfn = _glfn;
+            }
+            ~debug_group_mx() { if (this->glfn != nullptr) { this->glfn->PopDebugGroup(); } }
+            debug_group_mx (const debug_group_mx&) = delete;
+            debug_group_mx& operator= (const debug_group_mx&) = delete;
+
+        private:
+            mplot::trace_scope scope;
+            GladGLContext* glfn = nullptr;
+        };
+
+    } // namespace gl
+} // namespace mplot
+
+#if MPLOT_TRACE
+# define MPLOT_TRACE_GL_MX(glfn, name) ::mplot::gl::debug_group_mx MPLOT_TRACE_CAT(mplot_debug_group_, __LINE__) (glfn, name)
+#else
+# define MPLOT_TRACE_GL_MX(glfn, name) ((void)0)
+#endif
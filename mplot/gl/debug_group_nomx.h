@@ -0,0 +1,43 @@
+#pragma once
+
+/*
+ * A GL debug group and trace event for a block of GL calls (see mplot/trace.h). With MPLOT_TRACE
+ * defined as 1, MPLOT_TRACE_GL (name) pushes a debug group called name (where the context has
+ * glPushDebugGroup, from OpenGL 4.3 or KHR_debug) and records a trace event, both of which end
+ * with the enclosing block. Otherwise it compiles to nothing.
+ *
+ * As for util_nomx.h, include the GL headers BEFORE this file.
+ *
+ * Author: Seb James.
+ */
+
+#include <mplot/trace.h>
+
+namespace mplot {
+    namespace gl {
+
+        struct debug_group
+        {
+            debug_group (const char* name) : scope (name)
+            {
+                if (glPushDebugGroup == nullptr) { return; }
+                glPushDebugGroup (GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+                this->pushed = true;
+            }
+            ~debug_group() { if (this->pushed) { glPopDebugGroup(); } }
+            debug_group (const debug_group&) = delete;
+            debug_group& operator= (const debug_group&) = delete;
+
+        private:
+            mplot::trace_scope scope;
+            bool pushed = false;
+        };
+
+    } // namespace gl
+} // namespace mplot
+
+#if MPLOT_TRACE
+# define MPLOT_TRACE_GL(name) ::mplot::gl::debug_group MPLOT_TRACE_CAT(mplot_debug_group_, __LINE__) (name)
+#else
+# define MPLOT_TRACE_GL(name) ((void)0)
+#endif
@@ -0,0 +1,60 @@
+#pragma once
+
+/*
+ * How GL errors are found. mplot::gl::Util::checkError polls glGetError, which makes the CPU wait
+ * for the GL on many drivers, and is called after most groups of GL calls. Polling is on in
+ * debug builds and off when NDEBUG is defined; define MPLOT_GL_POLL_ERRORS as 1 or 0 to choose
+ * for yourself, or set mplot::gl::poll_errors at runtime. With polling off, Visual reports GL
+ * errors through a debug message callback (OpenGL 4.3 or KHR_debug) where it can, which costs
+ * nothing until an error happens, though without the file and line of the call.
+ *
+ * As for util_nomx.h, include the GL headers BEFORE this file.
+ *
+ * Author: Seb James.
+ */
+
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#ifndef MPLOT_GL_POLL_ERRORS
+# ifdef NDEBUG
+#  define MPLOT_GL_POLL_ERRORS 0
+# else
+#  define MPLOT_GL_POLL_ERRORS 1
+# endif
+#endif
+
+#if defined GLAD_API_PTR
+# define MPLOT_GL_APIENTRY GLAD_API_PTR
+#elif defined APIENTRY
+# define MPLOT_GL_APIENTRY APIENTRY
+#else
+# define MPLOT_GL_APIENTRY
+#endif
+
+namespace mplot {
+    namespace gl {
+
+        // If true, checkError polls glGetError. Set before the Visual is made to choose the
+        // debug message callback instead.
+        inline bool poll_errors = (MPLOT_GL_POLL_ERRORS != 0);
+
+        // The number of GL errors reported to debug_message
+        inline std::atomic<unsigned long long> debug_errors = 0;
+
+        // The GL debug message callback. Errors (and other messages above notification severity)
+        // are written to stderr.
+        inline void MPLOT_GL_APIENTRY debug_message (GLenum, GLenum type, GLuint id, GLenum severity,
+                                                     GLsizei length, const GLchar* message, const void*)
+        {
+            if (severity == GL_DEBUG_SEVERITY_NOTIFICATION) { return; }
+            if (type == GL_DEBUG_TYPE_ERROR) { ++debug_errors; }
+            const std::size_t n = length < 0 ? std::strlen (message) : static_cast<std::size_t>(length);
+            std::cerr << (type == GL_DEBUG_TYPE_ERROR ? "GL error" : "GL message") << " (id " << id << "): "
+                      << std::string (message, n) << std::endl;
+        }
+
+    } // namespace gl
+} // namespace mplot
@@ -0,0 +1,232 @@
+/*!
+ * \file
+ *
+ * Timing of the work done on the GPU, by named section. Each section (a compute dispatch, an
+ * upload, a readback) is bracketed with GL_TIME_ELAPSED queries from a small ring, and the
+ * results are collected once they are available, so timing a section never stalls the
+ * pipeline. The CPU time spent issuing each section is recorded alongside, and the memory
+ * barriers issued through the profiler are counted.
+ *
+ * Where GL_TIME_ELAPSED is unavailable (OpenGL 3.1 ES), only the CPU times are recorded.
+ *
+ * \author Seb James
+ * \date 2026
+ */
+#pragma once
+
+// As for compute_manager.h, the client code includes the GL headers before this file.
+
+#include <map>
+#include <array>
+#include <algorithm>
+#include <string>
+#include <limits>
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+#include <stdexcept>
+
+namespace mplot {
+    namespace gl {
+
+        // The record of one named section of GPU work
+        struct section_stats
+        {
+            // The number of times the section has run, and the number of those for which a GPU
+            // time has been collected
+            unsigned long long count = 0;
+            unsigned long long gpu_count = 0;
+            // The number of runs that went untimed on the GPU because all of the section's
+            // queries were still in flight
+            unsigned long long dropped = 0;
+            // GPU execution times in milliseconds
+            double gpu_last_ms = 0.0;
+            double gpu_total_ms = 0.0;
+            double gpu_min_ms = std::numeric_limits<double>::max();
+            double gpu_max_ms = 0.0;
+            // CPU times, in milliseconds, to issue the section's commands
+            double cpu_last_ms = 0.0;
+            double cpu_total_ms = 0.0;
+
+            double gpu_mean_ms() const { return this->gpu_count > 0 ? this->gpu_total_ms / this->gpu_count : 0.0; }
+            double cpu_mean_ms() const { return this->count > 0 ? this->cpu_total_ms / this->count : 0.0; }
+        };
+
+        // The memory barriers issued through gpu_profiler::barrier
+        struct barrier_stats
+        {
+            unsigned long long count = 0;
+            // How many of the barriers were issued with each bitfield
+            std::map<GLbitfield, unsigned long long> by_bits;
+        };
+
+        struct gpu_profiler
+        {
+            // The number of queries per section. A section can run this many times before its
+            // first result must be available.
+            static constexpr unsigned int ring_size = 4;
+
+            // If false, begin(), end() and barrier() do no timing or counting (barrier() still
+            // issues its barrier)
+            bool enabled = true;
+
+            ~gpu_profiler() { this->deinit(); }
+
+            // Delete the queries. Call with the context current, before the context goes.
+            void deinit()
+            {
+#ifdef GL_TIME_ELAPSED
+                for (auto& s : this->sections) {
+                    if (s.second.queries[0] != 0) { glDeleteQueries (ring_size, s.second.queries.data()); }
+                    s.second.queries.fill (0);
+                }
+#endif
+                this->sections.clear();
+                this->open = nullptr;
+            }
+
+            // Start timing the section called name. Sections can't nest.
+            void begin (const std::string& name)
+            {
+                if (!this->enabled) { return; }
+                if (this->open != nullptr) {
+                    throw std::runtime_error ("gpu_profiler::begin: a section is already open (sections can't nest)");
+                }
+                section& s = this->sections[name];
+                this->open = &s;
+#ifdef GL_TIME_ELAPSED
+                if (s.queries[0] == 0) { glGenQueries (ring_size, s.queries.data()); }
+                this->collect (s);
+                s.timed = !s.in_flight[s.next];
+                if (s.timed) { glBeginQuery (GL_TIME_ELAPSED, s.queries[s.next]); } else { ++s.stats.dropped; }
+#endif
+                s.t0 = std::chrono::steady_clock::now();
+            }
+
+            // Stop timing the open section
+            void end()
+            {
+                if (!this->enabled || this->open == nullptr) { return; }
+                section& s = *this->open;
+                this->open = nullptr;
+#ifdef GL_TIME_ELAPSED
+                if (s.timed) {
+                    glEndQuery (GL_TIME_ELAPSED);
+                    s.in_flight[s.next] = true;
+                    s.next = (s.next + 1) % ring_size;
+                }
+#endif
+                const std::chrono::duration<double, std::milli> dt = std::chrono::steady_clock::now() - s.t0;
+                s.stats.cpu_last_ms = dt.count();
+                s.stats.cpu_total_ms += dt.count();
+                ++s.stats.count;
+            }
+
+            // Time the commands issued by f as the section called name
+            template <typename F>
+            void time (const std::string& name, F f)
+            {
+                this->begin (name);
+                f();
+                this->end();
+            }
+
+            // Issue glMemoryBarrier (bits), and count it
+            void barrier (const GLbitfield bits)
+            {
+                glMemoryBarrier (bits);
+                if (!this->enabled) { return; }
+                ++this->barriers.count;
+                ++this->barriers.by_bits[bits];
+            }
+
+            // Collect any GPU times that are now available, without waiting for the others
+            void collect()
+            {
+                for (auto& s : this->sections) { this->collect (s.second); }
+            }
+
+            // The stats of the section called name (which are all zero if it has never run)
+            section_stats stats (const std::string& name) const
+            {
+                auto si = this->sections.find (name);
+                return si == this->sections.end() ? section_stats{} : si->second.stats;
+            }
+
+            // The stats of every section, by name
+            std::map<std::string, section_stats> all_stats() const
+            {
+                std::map<std::string, section_stats> rtn;
+                for (const auto& s : this->sections) { rtn[s.first] = s.second.stats; }
+                return rtn;
+            }
+
+            const barrier_stats& barrier_counts() const { return this->barriers; }
+
+            // Zero the stats, keeping the queries (results still in flight count into the new stats)
+            void reset()
+            {
+                this->collect();
+                for (auto& s : this->sections) { s.second.stats = section_stats{}; }
+                this->barriers = barrier_stats{};
+            }
+
+            // Write one line per section and a line of barrier counts to os
+            void print (std::ostream& os) const
+            {
+                for (const auto& s : this->sections) {
+                    const section_stats& st = s.second.stats;
+                    os << std::setw(16) << std::left << s.first << std::right << std::fixed << std::setprecision(3)
+                       << " n=" << st.count << " gpu(ms) mean " << st.gpu_mean_ms()
+                       << " min " << (st.gpu_count > 0 ? st.gpu_min_ms : 0.0) << " max " << st.gpu_max_ms
+                       << " | cpu(ms) mean " << st.cpu_mean_ms();
+                    if (st.dropped > 0) { os << " (" << st.dropped << " untimed)"; }
+                    os << "\n";
+                }
+                os << "barriers: " << this->barriers.count;
+                for (const auto& b : this->barriers.by_bits) { os << " [0x" << std::hex << b.first << std::dec << "]x" << b.second; }
+                os << std::endl;
+            }
+
+        private:
+            struct section
+            {
+                std::array<GLuint, ring_size> queries = {};
+                std::array<bool, ring_size> in_flight = {};
+                unsigned int next = 0;
+                bool timed = false;
+                std::chrono::steady_clock::time_point t0;
+                section_stats stats;
+            };
+
+            // Collect the available results of s, oldest first
+            void collect ([[maybe_unused]] section& s)
+            {
+#ifdef GL_TIME_ELAPSED
+                for (unsigned int k = 0; k < ring_size; ++k) {
+                    const unsigned int q = (s.next + k) % ring_size;
+                    if (!s.in_flight[q]) { continue; }
+                    GLint available = 0;
+                    glGetQueryObjectiv (s.queries[q], GL_QUERY_RESULT_AVAILABLE, &available);
+                    if (available == 0) { continue; }
+                    GLuint64 ns = 0;
+                    glGetQueryObjectui64v (s.queries[q], GL_QUERY_RESULT, &ns);
+                    s.in_flight[q] = false;
+                    const double ms = static_cast<double>(ns) * 1.0e-6;
+                    s.stats.gpu_last_ms = ms;
+                    s.stats.gpu_total_ms += ms;
+                    s.stats.gpu_min_ms = std::min (s.stats.gpu_min_ms, ms);
+                    s.stats.gpu_max_ms = std::max (s.stats.gpu_max_ms, ms);
+                    ++s.stats.gpu_count;
+                }
+#endif
+            }
+
+            // std::map nodes don't move, so pointers to sections stay valid as sections are added
+            std::map<std::string, section> sections;
+            section* open = nullptr;
+            barrier_stats barriers;
+        };
+
+    } // namespace gl
+} // namespace mplot
@@ -0,0 +1,277 @@
+#pragma once
+
+/*
+ * The sampling of an image at the centres of a grid's elements, on the GPU: the work of
+ * mplot::image_sampling::resample (in mplot/image_sampling.h), done by a compute shader with one
+ * invocation per element. The image is held in a single channel float texture (or is any
+ * texture of the client's, of which the first channel is read) and the element centres, which
+ * are uploaded once, in an SSBO. Each resample() writes one float per element into an SSBO,
+ * which a HexGridVisual or CartGridVisual in gpu_mesh mode takes with setScalarDataBuffer, and
+ * (if one is given) into a single channel float texture of a GridVisual's dims, which a
+ * GridVisual in GridVisMode::Texture takes with setDataTexture. A new image is then a texture
+ * upload and one dispatch, and no resampled data pass through the CPU.
+ *
+ * Note: You have to include a header like gl3.h or glext.h etc for the GL types and
+ * functions BEFORE including this file.
+ *
+ * Author: Seb James.
+ */
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+#include <sm/vec>
+#include <mplot/image_sampling.h>
+#include <mplot/gl/version.h>
+#include <mplot/gl/util_nomx.h>
+#include <mplot/gl/texture.h>
+#include <mplot/gl/compute_shaderprog.h>
+#include <mplot/gl/compute_kernels.h>
+
+namespace mplot {
+    namespace gl {
+
+        namespace kernels {
+
+            // Sample the image img at the element centres pts, writing d (and, with OUT_TEXTURE,
+            // the texel (i % out_w, i / out_w) of out_img). The bilinear interpolation is done
+            // with texelFetch, as image_sampling::bilinear does it, so that it needs no filtering
+            // of float textures (which OpenGL 3.1 ES lacks).
+            inline constexpr const char* image_resample = "precision highp sampler2D;\n"
+            "layout (std430, binding = 0) readonly buffer Points { vec2 pts[]; };\n"
+            "layout (std430, binding = 1) writeonly buffer Data { float d[]; };\n"
+            "uniform sampler2D img;\n"
+            "uniform uint n;\n"
+            // The vectors are float arrays, as compute_shaderprog::set_uniform sets an sm::vec
+            "uniform float dims[2];\n"
+            "uniform float origin[2];\n"
+            "uniform float spacing[2];\n"
+            "uniform float footprint[2];\n"
+            "uniform uint filter_box;\n"
+            "uniform float outside;\n"
+            "#ifdef OUT_TEXTURE\n"
+            "layout (r32f, binding = 0) writeonly uniform highp image2D out_img;\n"
+            "uniform uint out_w;\n"
+            "#endif\n"
+            "vec2 v2 (float a[2]) { return vec2(a[0], a[1]); }\n"
+            "float at (int x, int y) { return texelFetch (img, ivec2(x, y), 0).r; }\n"
+            "float bilinear (vec2 q)\n"
+            "{\n"
+            "    vec2 f = floor (q);\n"
+            "    vec2 t = q - f;\n"
+            "    ivec2 mx = ivec2(v2 (dims)) - 1;\n"
+            "    ivec2 a = clamp (ivec2(f), ivec2(0), mx);\n"
+            "    ivec2 b = clamp (ivec2(f) + 1, ivec2(0), mx);\n"
+            "    float lo = at (a.x, a.y) + t.x * (at (b.x, a.y) - at (a.x, a.y));\n"
+            "    float hi = at (a.x, b.y) + t.x * (at (b.x, b.y) - at (a.x, b.y));\n"
+            "    return lo + t.y * (hi - lo);\n"
+            "}\n"
+            "float box (vec2 q)\n"
+            "{\n"
+            "    ivec2 a = max (ivec2(ceil (q - 0.5 * v2 (footprint))), ivec2(0));\n"
+            "    ivec2 b = min (ivec2(floor (q + 0.5 * v2 (footprint))), ivec2(v2 (dims)) - 1);\n"
+            "    if (b.x < a.x || b.y < a.y) { return bilinear (q); }\n"
+            "    float s = 0.0;\n"
+            "    for (int y = a.y; y <= b.y; ++y) {\n"
+            "        for (int x = a.x; x <= b.x; ++x) { s += at (x, y); }\n"
+            "    }\n"
+            "    return s / float((b.x - a.x + 1) * (b.y - a.y + 1));\n"
+            "}\n"
+            "void main()\n"
+            "{\n"
+            "    uint i = group_id() * 128u + gl_LocalInvocationID.x;\n"
+            "    if (i >= n) { return; }\n"
+            "    vec2 q = (pts[i] - v2 (origin)) / v2 (spacing);\n"
+            "    float v = outside;\n"
+            "    if (all (greaterThanEqual (q, vec2(-0.5))) && all (lessThanEqual (q, v2 (dims) - 0.5))) {\n"
+            "        v = filter_box != 0u ? box (q) : bilinear (q);\n"
+            "    }\n"
+            "    d[i] = v;\n"
+            "#ifdef OUT_TEXTURE\n"
+            "    imageStore (out_img, ivec2(int(i % out_w), int(i / out_w)), vec4(v, 0.0, 0.0, 0.0));\n"
+            "#endif\n"
+            "}\n";
+
+        } // namespace kernels
+
+        /*!
+         * The image resampling kernel, with the textures and buffers it reads and writes. Call
+         * init() once there is a GL context, set_points() once per grid and then, for each new
+         * image, set_image() (or set_image_texture()) and resample().
+         */
+        template <int glver>
+        struct image_resampler
+        {
+            //! How each element samples the image
+            mplot::image_filter filter = mplot::image_filter::bilinear;
+            //! The width of the image (and the scale of its height) in the grid's coordinates
+            sm::vec<float, 2> scale = { 1.0f, 1.0f };
+            //! The centre of the image in the grid's coordinates
+            sm::vec<float, 2> offset = { 0.0f, 0.0f };
+            //! The value of the elements off the image
+            float outside = 0.0f;
+
+            ~image_resampler() { this->deinit(); }
+
+            // Compile the kernels. Client code must ensure there is an OpenGL context available.
+            void init()
+            {
+                if constexpr (!mplot::gl::version::at_least (glver, 4, 3) && !mplot::gl::version::es_at_least (glver, 3, 1)) {
+                    throw std::runtime_error ("mplot::gl::image_resampler: compute shaders need OpenGL 4.3 or OpenGL 3.1 ES");
+                }
+                this->build (this->prog, "");
+                this->build (this->prog_tex, "#define OUT_TEXTURE 1\n");
+                glGenBuffers (1, &this->points);
+                glGenBuffers (1, &this->data);
+                mplot::gl::Util::checkError (__FILE__, __LINE__);
+            }
+
+            // Delete the textures and buffers (the programs are deleted with this object)
+            void deinit()
+            {
+                if (this->points != 0) { glDeleteBuffers (1, &this->points); }
+                if (this->data != 0) { glDeleteBuffers (1, &this->data); }
+                if (this->own_image != 0) { glDeleteTextures (1, &this->own_image); }
+                this->points = 0;
+                this->data = 0;
+                this->own_image = 0;
+                this->own_dims = { 0u, 0u };
+                this->image = 0;
+                this->n_points = 0;
+            }
+
+            /*!
+             * Set the element centres, in the grid's coordinates, and the width and height of an
+             * element (for image_filter::box). For an sm::hexgrid, these are (d_x[i], d_y[i]) and
+             * the hex's d; for an sm::grid, (*g)[i] and get_dx().
+             */
+            void set_points (const std::vector<sm::vec<float, 2>>& pts, const sm::vec<float, 2>& element_size = { 0.0f, 0.0f })
+            {
+                this->n_points = pts.size();
+                this->footprint = element_size;
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, this->points);
+                glBufferData (GL_SHADER_STORAGE_BUFFER, pts.size() * sizeof (sm::vec<float, 2>), pts.data(), GL_STATIC_DRAW);
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, this->data);
+                glBufferData (GL_SHADER_STORAGE_BUFFER, std::max (pts.size(), std::size_t{1}) * sizeof (float), nullptr, GL_DYNAMIC_COPY);
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, 0);
+                mplot::gl::Util::checkError (__FILE__, __LINE__);
+            }
+
+            /*!
+             * Upload the image (dims[0] * dims[1] floats in rows from the bottom left, as
+             * mplot::loadpng gives them) into the resampler's own texture. The texture is made
+             * again only when dims change; otherwise the upload replaces its texels.
+             */
+            void set_image (const float* pixels, const sm::vec<unsigned int, 2>& dims)
+            {
+                if (dims[0] == 0u || dims[1] == 0u) { throw std::runtime_error ("mplot::gl::image_resampler::set_image: the image is empty"); }
+                if (this->own_image == 0 || this->own_dims != dims) {
+                    if (this->own_image != 0) { glDeleteTextures (1, &this->own_image); }
+                    setup_image_texture (this->own_image, { static_cast<GLsizei>(dims[0]), static_cast<GLsizei>(dims[1]) },
+                                         texture_format::r32f, pixels);
+                    this->own_dims = dims;
+                } else {
+                    glBindTexture (GL_TEXTURE_2D, this->own_image);
+                    glTexSubImage2D (GL_TEXTURE_2D, 0, 0, 0, static_cast<GLsizei>(dims[0]), static_cast<GLsizei>(dims[1]), GL_RED, GL_FLOAT, pixels);
+                    glBindTexture (GL_TEXTURE_2D, 0);
+                    mplot::gl::Util::checkError (__FILE__, __LINE__);
+                }
+                this->image = this->own_image;
+                this->image_dims = dims;
+            }
+
+            /*!
+             * Sample tex, a texture of the client's of dims texels (a camera frame written on the
+             * GPU, say), instead of an uploaded image. Its first channel is read, with
+             * texelFetch, so it needs no filtering. It is not owned by the resampler.
+             */
+            void set_image_texture (const GLuint tex, const sm::vec<unsigned int, 2>& dims)
+            {
+                this->image = tex;
+                this->image_dims = dims;
+            }
+
+            /*!
+             * Also write each element's sample into tex, a single channel float (GL_R32F)
+             * texture of width texels, element i to texel (i % width, i / width), as a row
+             * major GridVisual lays out its datum texture. Pass 0 to stop.
+             */
+            void set_output_texture (const GLuint tex, const unsigned int width)
+            {
+                this->out_texture = tex;
+                this->out_width = std::max (width, 1u);
+            }
+
+            /*!
+             * Sample the image at each element centre. The samples are in data_buffer() (and in
+             * the output texture, if set) once the shader storage and texture fetch barrier that
+             * this issues has been passed.
+             */
+            void resample()
+            {
+                if (this->image == 0 || this->n_points == 0) { return; }
+                const mplot::image_placement pl = { this->image_dims, this->scale, this->offset };
+                const sm::vec<float, 2> sp = pl.spacing();
+                compute_shaderprog<glver>& p = this->out_texture != 0 ? this->prog_tex : this->prog;
+                p.use();
+                p.set_uniform ("n", static_cast<unsigned int>(this->n_points));
+                p.set_uniform ("dims", sm::vec<float, 2>{ static_cast<float>(this->image_dims[0]), static_cast<float>(this->image_dims[1]) });
+                p.set_uniform ("origin", pl.origin());
+                p.set_uniform ("spacing", sp);
+                p.set_uniform ("footprint", this->footprint / sp);
+                p.set_uniform ("filter_box", this->filter == mplot::image_filter::box ? 1u : 0u);
+                p.set_uniform ("outside", this->outside);
+                p.set_uniform ("img", 0);
+                glActiveTexture (GL_TEXTURE0);
+                glBindTexture (GL_TEXTURE_2D, this->image);
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 0, this->points);
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 1, this->data);
+                if (this->out_texture != 0) {
+                    p.set_uniform ("out_w", this->out_width);
+                    glBindImageTexture (0, this->out_texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+                }
+                const std::size_t groups = std::max ((this->n_points + 127) / 128, std::size_t{1});
+                const std::size_t gx = std::min (groups, std::size_t{65535});
+                p.dispatch (static_cast<GLuint>(gx), static_cast<GLuint>((groups + gx - 1) / gx), 1);
+                glMemoryBarrier (GL_SHADER_STORAGE_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+                glBindTexture (GL_TEXTURE_2D, 0);
+                mplot::gl::Util::checkError (__FILE__, __LINE__);
+            }
+
+            //! The SSBO of one float per element, written by resample() (for setScalarDataBuffer)
+            GLuint data_buffer() const { return this->data; }
+
+            //! The number of elements
+            std::size_t size() const { return this->n_points; }
+
+        private:
+            compute_shaderprog<glver> prog;
+            compute_shaderprog<glver> prog_tex;
+            GLuint points = 0;
+            GLuint data = 0;
+            std::size_t n_points = 0;
+            sm::vec<float, 2> footprint = { 0.0f, 0.0f };
+            // The texture sampled, which is own_image unless set_image_texture was called
+            GLuint image = 0;
+            sm::vec<unsigned int, 2> image_dims = { 0u, 0u };
+            GLuint own_image = 0;
+            sm::vec<unsigned int, 2> own_dims = { 0u, 0u };
+            GLuint out_texture = 0;
+            unsigned int out_width = 1u;
+
+            void build (compute_shaderprog<glver>& p, const char* defines)
+            {
+                std::string src = mplot::gl::version::shaderpreamble (glver);
+                src += defines;
+                src += kernels::header;
+                src += kernels::image_resample;
+                p.load_shaders ({ { GL_COMPUTE_SHADER, "", src, 0 } });
+                if (p.prog_id == 0) { throw std::runtime_error ("mplot::gl::image_resampler: Failed to build the kernel"); }
+            }
+        };
+
+    } // namespace gl
+} // namespace mplot
@@ -0,0 +1,293 @@
+#pragma once
+
+/*
+ * Isosurface extraction on the GPU with compute shaders: the same surface as
+ * mplot::isosurface::extract (marching tetrahedra, six to a cell) computed from a field held in
+ * an SSBO, for a compute_manager in which a 3D simulation already lives on the GPU. A first
+ * kernel counts the triangles of each cell, compute_kernels::scan_uints turns the counts into
+ * the place of each cell's triangles in the output and a second kernel writes them there, so
+ * that, as on the CPU, the output is written without atomics and in the same order from one run
+ * to the next.
+ *
+ * The output is an SSBO of two vec4s per vertex (the position, then the normal, each with 0 in
+ * w), three vertices to a triangle, which may be read back or bound as a vertex buffer.
+ *
+ * Note: You have to include a header like gl3.h or glext.h etc for the GL types and
+ * functions BEFORE including this file.
+ *
+ * Author: Seb James.
+ */
+
+#include <array>
+#include <string>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+#include <sm/vec>
+#include <mplot/gl/version.h>
+#include <mplot/gl/util_nomx.h>
+#include <mplot/gl/compute_shaderprog.h>
+#include <mplot/gl/compute_kernels.h>
+
+namespace mplot {
+    namespace gl {
+
+        namespace kernels {
+
+            // The field, its size and place, and the cutting of the cells into tetrahedra
+            inline constexpr const char* iso_common = "layout (std430, binding = 0) readonly buffer Field { float f[]; };\n"
+            "uniform uint nx;\n"
+            "uniform uint ny;\n"
+            "uniform uint nz;\n"
+            "uniform float level;\n"
+            "const uint tets[24] = uint[24](0u, 1u, 3u, 7u, 0u, 3u, 2u, 7u, 0u, 2u, 6u, 7u,\n"
+            "                               0u, 6u, 4u, 7u, 0u, 4u, 5u, 7u, 0u, 5u, 1u, 7u);\n"
+            "uint n_cells() { return (nx - 1u) * (ny - 1u) * (nz - 1u); }\n"
+            "uvec3 cell_of (uint i) { return uvec3(i % (nx - 1u), (i / (nx - 1u)) % (ny - 1u), i / ((nx - 1u) * (ny - 1u))); }\n"
+            "uvec3 corner_of (uvec3 c, uint k) { return c + uvec3(k & 1u, (k >> 1) & 1u, (k >> 2) & 1u); }\n"
+            "uint index_of (uvec3 p) { return (p.z * ny + p.y) * nx + p.x; }\n"
+            "uint cell_mask (uvec3 c)\n"
+            "{\n"
+            "    uint m = 0u;\n"
+            "    for (uint k = 0u; k < 8u; ++k) { if (f[index_of (corner_of (c, k))] > level) { m |= 1u << k; } }\n"
+            "    return m;\n"
+            "}\n"
+            "uint tet_mask (uint cmask, uint t)\n"
+            "{\n"
+            "    uint m = 0u;\n"
+            "    for (uint j = 0u; j < 4u; ++j) { m |= ((cmask >> tets[4u * t + j]) & 1u) << j; }\n"
+            "    return m;\n"
+            "}\n"
+            "uint tet_triangles (uint m)\n"
+            "{\n"
+            "    int n = bitCount (m);\n"
+            "    return n == 2 ? 2u : ((n == 1 || n == 3) ? 1u : 0u);\n"
+            "}\n";
+
+            // The number of triangles in each cell, into counts
+            inline constexpr const char* iso_count = "layout (std430, binding = 1) writeonly buffer Counts { uint counts[]; };\n"
+            "void main()\n"
+            "{\n"
+            "    uint i = group_id() * 128u + gl_LocalInvocationID.x;\n"
+            "    if (i >= n_cells()) { return; }\n"
+            "    uint cmask = cell_mask (cell_of (i));\n"
+            "    uint n = 0u;\n"
+            "    if (cmask != 0u && cmask != 255u) {\n"
+            "        for (uint t = 0u; t < 6u; ++t) { n += tet_triangles (tet_mask (cmask, t)); }\n"
+            "    }\n"
+            "    counts[i] = n;\n"
+            "}\n";
+
+            // ...and, with the counts scanned into offsets, the triangles of each cell
+            inline constexpr const char* iso_write = "layout (std430, binding = 1) readonly buffer Offsets { uint offsets[]; };\n"
+            "layout (std430, binding = 2) writeonly buffer Verts { vec4 v[]; };\n"
+            "uniform float origin[3];\n"
+            "uniform float spacing[3];\n"
+            "vec3 sp() { return vec3(spacing[0], spacing[1], spacing[2]); }\n"
+            "float at (uvec3 p) { return f[index_of (p)]; }\n"
+            "vec3 gradient (uvec3 p)\n"
+            "{\n"
+            "    uvec3 n = uvec3(nx, ny, nz);\n"
+            "    vec3 g = vec3(0.0);\n"
+            "    for (int j = 0; j < 3; ++j) {\n"
+            "        uvec3 lo = p;\n"
+            "        uvec3 hi = p;\n"
+            "        if (p[j] > 0u) { lo[j] -= 1u; }\n"
+            "        if (p[j] + 1u < n[j]) { hi[j] += 1u; }\n"
+            "        if (lo[j] == hi[j]) { continue; }\n"
+            "        g[j] = (at (hi) - at (lo)) / (float(hi[j] - lo[j]) * sp()[j]);\n"
+            "    }\n"
+            "    return g;\n"
+            "}\n"
+            // The vertex on the edge a to b, always computed from the end lower in the grid first
+            // so that the cells either side of the edge agree on it
+            "void edge_vertex (uvec3 a, uvec3 b, out vec3 p, out vec3 nrm)\n"
+            "{\n"
+            "    if (index_of (b) < index_of (a)) { uvec3 s = a; a = b; b = s; }\n"
+            "    float va = at (a);\n"
+            "    float vb = at (b);\n"
+            "    float t = va == vb ? 0.5 : clamp ((level - va) / (vb - va), 0.0, 1.0);\n"
+            "    p = vec3(origin[0], origin[1], origin[2]) + mix (vec3(a), vec3(b), t) * sp();\n"
+            "    vec3 n = -mix (gradient (a), gradient (b), t);\n"
+            "    float l = length (n);\n"
+            "    nrm = l > 0.0 ? n / l : vec3(0.0, 0.0, 1.0);\n"
+            "}\n"
+            "void triangle (uvec3 a0, uvec3 b0, uvec3 a1, uvec3 b1, uvec3 a2, uvec3 b2, uint k)\n"
+            "{\n"
+            "    vec3 p[3];\n"
+            "    vec3 n[3];\n"
+            "    edge_vertex (a0, b0, p[0], n[0]);\n"
+            "    edge_vertex (a1, b1, p[1], n[1]);\n"
+            "    edge_vertex (a2, b2, p[2], n[2]);\n"
+            "    uint o1 = 1u;\n"
+            "    uint o2 = 2u;\n"
+            "    if (dot (cross (p[1] - p[0], p[2] - p[0]), n[0] + n[1] + n[2]) < 0.0) { o1 = 2u; o2 = 1u; }\n"
+            "    v[6u * k] = vec4(p[0], 0.0);\n"
+            "    v[6u * k + 1u] = vec4(n[0], 0.0);\n"
+            "    v[6u * k + 2u] = vec4(p[o1], 0.0);\n"
+            "    v[6u * k + 3u] = vec4(n[o1], 0.0);\n"
+            "    v[6u * k + 4u] = vec4(p[o2], 0.0);\n"
+            "    v[6u * k + 5u] = vec4(n[o2], 0.0);\n"
+            "}\n"
+            "void main()\n"
+            "{\n"
+            "    uint i = group_id() * 128u + gl_LocalInvocationID.x;\n"
+            "    if (i >= n_cells()) { return; }\n"
+            "    uvec3 c = cell_of (i);\n"
+            "    uint cmask = cell_mask (c);\n"
+            "    if (cmask == 0u || cmask == 255u) { return; }\n"
+            "    uint k = offsets[i];\n"
+            "    for (uint t = 0u; t < 6u; ++t) {\n"
+            // The corners of the tetrahedron, inside ones first
+            "        uvec3 cin[4];\n"
+            "        uvec3 cout[4];\n"
+            "        uint n_in = 0u;\n"
+            "        uint n_out = 0u;\n"
+            "        for (uint j = 0u; j < 4u; ++j) {\n"
+            "            uint q = tets[4u * t + j];\n"
+            "            if (((cmask >> q) & 1u) != 0u) { cin[n_in++] = corner_of (c, q); } else { cout[n_out++] = corner_of (c, q); }\n"
+            "        }\n"
+            "        if (n_in == 1u) {\n"
+            "            triangle (cin[0], cout[0], cin[0], cout[1], cin[0], cout[2], k++);\n"
+            "        } else if (n_in == 3u) {\n"
+            "            triangle (cout[0], cin[0], cout[0], cin[1], cout[0], cin[2], k++);\n"
+            "        } else if (n_in == 2u) {\n"
+            "            triangle (cin[0], cout[0], cin[0], cout[1], cin[1], cout[1], k++);\n"
+            "            triangle (cin[0], cout[0], cin[1], cout[1], cin[1], cout[0], k++);\n"
+            "        }\n"
+            "    }\n"
+            "}\n";
+
+        } // namespace kernels
+
+        /*!
+         * The isosurface kernels, with the compute_kernels whose scan they use and the buffers of
+         * counts and vertices. Hold one in your compute_manager subclass and call init() once
+         * there is a GL context.
+         */
+        template <int glver>
+        struct isosurface_kernels
+        {
+            // Compile the kernels. Client code must ensure there is an OpenGL context available.
+            void init()
+            {
+                this->kern.init();
+                this->build (this->count_prog, kernels::iso_count);
+                this->build (this->write_prog, kernels::iso_write);
+                glGenBuffers (1, &this->counts);
+                glGenBuffers (1, &this->vertices);
+                mplot::gl::Util::checkError (__FILE__, __LINE__);
+            }
+
+            // Delete the buffers (the programs are deleted with this object)
+            void deinit()
+            {
+                this->kern.deinit();
+                if (this->counts != 0) { glDeleteBuffers (1, &this->counts); }
+                if (this->vertices != 0) { glDeleteBuffers (1, &this->vertices); }
+                this->counts = 0;
+                this->vertices = 0;
+                this->counts_bytes = 0;
+                this->vertices_bytes = 0;
+            }
+
+            /*!
+             * Extract the surface on which the field in the SSBO field (dims[0] * dims[1] *
+             * dims[2] floats, x varying fastest) is level, with the first value at origin and the
+             * values spacing apart. The triangles are left in vertex_buffer(); the number of them
+             * is returned (the one readback of the extraction). The vertex buffer grows to fit,
+             * but does not shrink.
+             */
+            std::size_t extract (const GLuint field, const std::array<unsigned int, 3>& dims, const float level,
+                                 const sm::vec<float, 3>& origin, const sm::vec<float, 3>& spacing)
+            {
+                if (dims[0] < 2u || dims[1] < 2u || dims[2] < 2u) { return 0; }
+                const std::size_t ncells = std::size_t{dims[0] - 1u} * (dims[1] - 1u) * (dims[2] - 1u);
+                // One count more than there are cells, left 0, so that after the scan it holds the total
+                this->grow (this->counts, this->counts_bytes, (ncells + 1) * sizeof(unsigned int));
+                const unsigned int zero = 0u;
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, this->counts);
+                glBufferSubData (GL_SHADER_STORAGE_BUFFER, ncells * sizeof(unsigned int), sizeof(unsigned int), &zero);
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, 0);
+
+                this->set_grid (this->count_prog, dims, level);
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 0, field);
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 1, this->counts);
+                this->dispatch (this->count_prog, (ncells + 127) / 128);
+
+                this->kern.scan_uints (this->counts, ncells + 1);
+
+                std::size_t n = 0;
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, this->counts);
+                const unsigned int* total = static_cast<const unsigned int*>(glMapBufferRange (GL_SHADER_STORAGE_BUFFER, ncells * sizeof(unsigned int),
+                                                                                               sizeof(unsigned int), GL_MAP_READ_BIT));
+                if (total != nullptr) { n = *total; }
+                glUnmapBuffer (GL_SHADER_STORAGE_BUFFER);
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, 0);
+                mplot::gl::Util::checkError (__FILE__, __LINE__);
+                if (n == 0) { return 0; }
+
+                // Two vec4s for each of three vertices per triangle
+                this->grow (this->vertices, this->vertices_bytes, n * 24 * sizeof(float));
+                this->set_grid (this->write_prog, dims, level);
+                this->write_prog.set_uniform ("origin", origin);
+                this->write_prog.set_uniform ("spacing", spacing);
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 0, field);
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 1, this->counts);
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, 2, this->vertices);
+                this->dispatch (this->write_prog, (ncells + 127) / 128);
+                return n;
+            }
+
+            // The SSBO that holds the triangles of the last extract: position, normal (two vec4s) per vertex
+            GLuint vertex_buffer() const { return this->vertices; }
+
+        private:
+            compute_kernels<glver> kern;
+            compute_shaderprog<glver> count_prog;
+            compute_shaderprog<glver> write_prog;
+            GLuint counts = 0;
+            std::size_t counts_bytes = 0;
+            GLuint vertices = 0;
+            std::size_t vertices_bytes = 0;
+
+            void build (compute_shaderprog<glver>& p, const char* body)
+            {
+                std::string src = mplot::gl::version::shaderpreamble (glver);
+                src += kernels::header;
+                src += kernels::iso_common;
+                src += body;
+                p.load_shaders ({ { GL_COMPUTE_SHADER, "", src, 0 } });
+                if (p.prog_id == 0) { throw std::runtime_error ("mplot::gl::isosurface_kernels: Failed to build a kernel"); }
+            }
+
+            void set_grid (compute_shaderprog<glver>& p, const std::array<unsigned int, 3>& dims, const float level)
+            {
+                p.use();
+                p.set_uniform ("nx", dims[0]);
+                p.set_uniform ("ny", dims[1]);
+                p.set_uniform ("nz", dims[2]);
+                p.set_uniform ("level", level);
+            }
+
+            // Make buf at least bytes bytes. Its contents are not kept.
+            void grow (const GLuint buf, std::size_t& capacity, const std::size_t bytes)
+            {
+                if (capacity >= bytes) { return; }
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, buf);
+                glBufferData (GL_SHADER_STORAGE_BUFFER, bytes, nullptr, GL_DYNAMIC_COPY);
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, 0);
+                capacity = bytes;
+            }
+
+            // Dispatch groups workgroups of p, as a 2D grid if there are more than 65535
+            void dispatch (const compute_shaderprog<glver>& p, const std::size_t groups) const
+            {
+                const std::size_t gx = std::min (std::max (groups, std::size_t{1}), std::size_t{65535});
+                const std::size_t gy = (std::max (groups, std::size_t{1}) + gx - 1) / gx;
+                p.dispatch (static_cast<GLuint>(gx), static_cast<GLuint>(gy), 1);
+            }
+        };
+
+    } // namespace gl
+} // namespace mplot
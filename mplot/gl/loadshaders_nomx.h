@@ -11,16 +11,73 @@
 #include <iostream>
 #include <cstring>
 #include <memory>
+#include <string>
 
 namespace mplot {
 
     namespace gl {
 
-        //! Shader loading code.
-        GLuint LoadShaders (const std::vector<mplot::gl::ShaderInfo>& shader_info)
+        /*!
+         * Shader loading code. If mplot::gl::program_cache_dir is set, the program is loaded from
+         * its cached binary when there is one, and its binary is cached when it is linked. A
+         * shader that fails to compile, or a program that fails to link, ends the process unless
+         * exit_on_error is false, in which case the log is printed and 0 is returned.
+         */
+        inline GLuint LoadShaders (const std::vector<mplot::gl::ShaderInfo>& shader_info, const bool exit_on_error = true)
         {
             if (shader_info.empty()) { return 0; }
 
+            // Test entry.filename. If this GLSL file can be read, then do so, otherwise,
+            // compile the default version specified in the ShaderInfo
+            std::vector<std::unique_ptr<GLchar[]>> sources;
+            for (auto entry : shader_info) {
+                if constexpr (debug_shaders == true) {
+                    std::cout << "Check file exists for " << entry.filename << std::endl;
+                }
+                if (mplot::tools::fileExists (entry.filename)) {
+                    std::cout << "Using " << mplot::gl::shader_type_str(entry.type)
+                              << " shader from the file " << entry.filename << std::endl;
+                    sources.push_back (mplot::gl::ReadShader (entry.filename));
+                } else {
+                    if constexpr (debug_shaders == true) {
+                        std::cout << "Using compiled-in " << mplot::gl::shader_type_str(entry.type) << " shader\n";
+                    }
+                    sources.push_back (mplot::gl::ReadDefaultShader (entry.compiledIn));
+                }
+                if (sources.back() == nullptr) { return 0; }
+            }
+
+            // Load the program from the binary cache, if possible
+            std::string cache_path;
+            if (!mplot::gl::program_cache_dir.empty()) {
+                GLint n_formats = 0;
+                glGetIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS, &n_formats);
+                if (n_formats > 0) {
+                    std::string driver;
+                    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+                        const GLubyte* str = glGetString (name);
+                        if (str != nullptr) { driver += reinterpret_cast<const char*>(str); }
+                        driver += '\n';
+                    }
+                    cache_path = mplot::gl::program_cache::key (shader_info, sources, driver);
+                    GLenum format = 0;
+                    std::vector<char> binary;
+                    if (mplot::gl::program_cache::read (cache_path, format, binary)) {
+                        GLuint program = glCreateProgram();
+                        glProgramBinary (program, format, binary.data(), static_cast<GLsizei>(binary.size()));
+                        GLint linked = 0;
+                        glGetProgramiv (program, GL_LINK_STATUS, &linked);
+                        if (linked) {
+                            if constexpr (debug_shaders == true) { std::cout << "Loaded program from " << cache_path << std::endl; }
+                            return program;
+                        }
+                        // The driver rejected the binary; compile the shaders (and replace the binary)
+                        glDeleteProgram (program);
+                        while (glGetError() != GL_NO_ERROR) {}
+                    }
+                }
+            }
+
             GLuint program = glCreateProgram();
 
 #ifdef GL_SHADER_COMPILER
@@ -34,37 +91,13 @@ namespace mplot {
                 }
             }
 #endif
-            for (auto entry : shader_info) {
+            for (std::size_t i = 0; i < shader_info.size(); ++i) {
+                const mplot::gl::ShaderInfo& entry = shader_info[i];
+                const std::unique_ptr<GLchar[]>& source = sources[i];
                 GLuint shader = glCreateShader (entry.type);
-                entry.shader = shader;
-                // Test entry.filename. If this GLSL file can be read, then do so, otherwise,
-                // compile the default version specified in the ShaderInfo
-                std::unique_ptr<GLchar[]> source;
                 if constexpr (debug_shaders == true) {
-                    std::cout << "Check file exists for " << entry.filename << std::endl;
-                }
-                if (mplot::tools::fileExists (entry.filename)) {
-                    std::cout << "Using " << mplot::gl::shader_type_str(entry.type)
-                              << " shader from the file " << entry.filename << std::endl;
-                    source = mplot::gl::ReadShader (entry.filename);
-                } else {
-                    if constexpr (debug_shaders == true) {
-                        std::cout << "Using compiled-in " << mplot::gl::shader_type_str(entry.type) << " shader\n";
-                    }
-                    source = mplot::gl::ReadDefaultShader (entry.compiledIn);
-                }
-                if (source == nullptr) {
-                    for (auto entry : shader_info) {
-                        glDeleteShader (entry.shader);
-                        entry.shader = 0;
-                    }
-                    return 0;
-
-                } else {
-                    if constexpr (debug_shaders == true) {
-                        std::cout << "Compiling this shader: \n" << "-----\n";
-                        std::cout << source.get() << "-----\n";
-                    }
+                    std::cout << "Compiling this shader: \n" << "-----\n";
+                    std::cout << source.get() << "-----\n";
                 }
                 GLint slen = (GLint)strlen (source.get());
                 const GLchar* sptr = source.get();
@@ -80,6 +113,11 @@ namespace mplot {
                     std::cerr << source.get();
                     std::cerr << "\n\n--------------------------\n";
                     std::cerr << infoLog << std::endl;
+                    if (!exit_on_error) {
+                        glDeleteShader (shader);
+                        glDeleteProgram (program);
+                        return 0;
+                    }
                     std::cerr << "Exiting.\n";
                     exit (2);
                 }
@@ -88,9 +126,11 @@ namespace mplot {
                 GLenum shaderError = glGetError();
                 if (shaderError == GL_INVALID_VALUE) {
                     std::cerr << "Shader compilation resulted in GL_INVALID_VALUE\n";
+                    if (!exit_on_error) { glDeleteShader (shader); glDeleteProgram (program); return 0; }
                     exit (3);
                 } else if (shaderError == GL_INVALID_OPERATION) {
                     std::cerr << "Shader compilation resulted in GL_INVALID_OPERATION\n";
+                    if (!exit_on_error) { glDeleteShader (shader); glDeleteProgram (program); return 0; }
                     exit (4);
                 } // shaderError is 0
 
@@ -101,6 +141,9 @@ namespace mplot {
                 glDeleteShader (shader); // Note it's correct to glDeleteShader after attaching it to program
             }
 
+            // Ask for a binary that can be retrieved for the cache
+            if (!cache_path.empty()) { glProgramParameteri (program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE); }
+
             GLint linked = 0;
             glLinkProgram (program);
             glGetProgramiv (program, GL_LINK_STATUS, &linked);
@@ -110,12 +153,24 @@ namespace mplot {
                 {
                     std::unique_ptr<GLchar[]> log = std::make_unique<GLchar[]>(len+1);
                     glGetProgramInfoLog (program, len, &len, log.get());
-                    std::cerr << "Shader linking failed: " << log.get() << std::endl << "Exiting.\n";
+                    std::cerr << "Shader linking failed: " << log.get() << std::endl << (exit_on_error ? "Exiting.\n" : "");
                 }
                 glDeleteProgram (program);
+                if (!exit_on_error) { return 0; }
                 exit (5);
             } // else successfully linked
 
+            if (!cache_path.empty()) {
+                GLint blen = 0;
+                glGetProgramiv (program, GL_PROGRAM_BINARY_LENGTH, &blen);
+                if (blen > 0) {
+                    std::vector<char> binary (blen);
+                    GLenum format = 0;
+                    glGetProgramBinary (program, blen, nullptr, &format, binary.data());
+                    if (glGetError() == GL_NO_ERROR) { mplot::gl::program_cache::write (cache_path, format, binary); }
+                }
+            }
+
             return program;
         }
     } // namespace gl
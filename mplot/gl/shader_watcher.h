@@ -0,0 +1,163 @@
+/*!
+ * \file
+ *
+ * Hot reloading of shader programs. A shader_watcher watches the GLSL files named in a set of
+ * mplot::gl::ShaderInfo from a background thread, and reports when one has been written. The
+ * program is then rebuilt, at a frame boundary and in the thread that owns the GL context,
+ * by compute_shaderprog::reload_if_changed() or hot_program::reload_if_changed(). If the new
+ * sources fail to compile or link, the old program is kept, so a typo in the editor costs a
+ * message on stderr rather than the simulation. Buffers, textures and their binding points
+ * belong to the context, not the program, and survive the swap; uniform values belong to the
+ * program and must be set again.
+ *
+ * Shaders that are compiled in (whose files don't exist) are not watched. With
+ * program_cache_dir set, an edited shader is compiled afresh (its sources key the cache) and
+ * going back to an earlier version of a file loads that version's binary.
+ *
+ * \author Seb James
+ * \date 2026
+ */
+#pragma once
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <utility>
+#include <filesystem>
+#include <system_error>
+#include <condition_variable>
+#include <mplot/gl/shaders.h>
+#include <mplot/gl/loadshaders_nomx.h>
+
+namespace mplot {
+    namespace gl {
+
+        struct shader_watcher
+        {
+            // How often the files are checked
+            std::chrono::milliseconds interval = std::chrono::milliseconds(250);
+
+            shader_watcher() = default;
+            shader_watcher (const shader_watcher&) = delete;
+            shader_watcher& operator= (const shader_watcher&) = delete;
+            ~shader_watcher() { this->stop(); }
+
+            // Start watching the files of shader_info that exist (replacing any earlier watch)
+            void watch (const std::vector<mplot::gl::ShaderInfo>& shader_info)
+            {
+                this->stop();
+                std::vector<std::pair<std::filesystem::path, std::filesystem::file_time_type>> files;
+                for (const auto& si : shader_info) {
+                    std::error_code ec;
+                    if (!std::filesystem::is_regular_file (si.filename, ec)) { continue; }
+                    files.emplace_back (si.filename, std::filesystem::last_write_time (si.filename, ec));
+                }
+                if (files.empty()) { return; }
+                this->running = true;
+                this->th = std::thread (&shader_watcher::poll, this, std::move (files));
+            }
+
+            void stop()
+            {
+                {
+                    std::lock_guard<std::mutex> lk (this->m);
+                    this->running = false;
+                }
+                this->cv.notify_all();
+                if (this->th.joinable()) { this->th.join(); }
+            }
+
+            // True if a watched file has been written since the last call. Call at a frame boundary.
+            bool changed() { return this->flag.exchange (false); }
+
+            // True if any file is being watched
+            bool watching() const { return this->th.joinable(); }
+
+        private:
+            // The watcher thread. A change is reported once a file's time has been the same for
+            // one interval, so that a file still being written is not read half done.
+            void poll (std::vector<std::pair<std::filesystem::path, std::filesystem::file_time_type>> files)
+            {
+                bool pending = false;
+                std::unique_lock<std::mutex> lk (this->m);
+                while (this->running) {
+                    this->cv.wait_for (lk, this->interval, [this] { return !this->running; });
+                    if (!this->running) { break; }
+                    bool moved = false;
+                    for (auto& f : files) {
+                        std::error_code ec;
+                        const auto t = std::filesystem::last_write_time (f.first, ec);
+                        if (!ec && t != f.second) {
+                            f.second = t;
+                            moved = true;
+                        }
+                    }
+                    if (moved) {
+                        pending = true;
+                    } else if (pending) {
+                        pending = false;
+                        this->flag = true;
+                    }
+                }
+            }
+
+            std::thread th;
+            std::mutex m;
+            std::condition_variable cv;
+            bool running = false;
+            std::atomic<bool> flag = false;
+        };
+
+        // A program, loaded with LoadShaders, that is rebuilt when its shader files change. Use
+        // for the graphics programs of client code (compute_shaderprog reloads itself).
+        struct hot_program
+        {
+            // The program, generated by glCreateProgram()
+            GLuint id = 0;
+
+            hot_program() = default;
+            hot_program (const hot_program&) = delete;
+            hot_program& operator= (const hot_program&) = delete;
+            ~hot_program() { this->deinit(); }
+
+            // Load the program from shader_info and (if watch) start watching its files
+            void load (const std::vector<mplot::gl::ShaderInfo>& _shader_info, const bool watch = true)
+            {
+                this->deinit();
+                this->shader_info = _shader_info;
+                this->id = mplot::gl::LoadShaders (this->shader_info);
+                if (watch) { this->watcher.watch (this->shader_info); }
+            }
+
+            // If a shader file has changed, rebuild the program, replacing id only if the new
+            // one compiles and links. Returns true if id was replaced.
+            bool reload_if_changed()
+            {
+                if (!this->watcher.changed()) { return false; }
+                const GLuint p = mplot::gl::LoadShaders (this->shader_info, false);
+                if (p == 0) {
+                    std::cerr << "mplot::gl::hot_program: keeping the previous program" << std::endl;
+                    return false;
+                }
+                if (this->id != 0) { glDeleteProgram (this->id); }
+                this->id = p;
+                return true;
+            }
+
+            void deinit()
+            {
+                this->watcher.stop();
+                if (this->id != 0) { glDeleteProgram (this->id); }
+                this->id = 0;
+            }
+
+        private:
+            std::vector<mplot::gl::ShaderInfo> shader_info;
+            shader_watcher watcher;
+        };
+
+    } // namespace gl
+} // namespace mplot
@@ -15,6 +15,11 @@
 #include <string>
 #include <memory>
 #include <filesystem>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <sstream>
+#include <system_error>
 
 namespace mplot {
 
@@ -48,7 +53,7 @@ namespace mplot {
         const bool debug_shaders = false;
 
         //! Read a shader from a file.
-        std::unique_ptr<GLchar[]> ReadShader (const std::string& filename)
+        inline std::unique_ptr<GLchar[]> ReadShader (const std::string& filename)
         {
             if (!std::filesystem::is_regular_file (filename)) { // restrict to regular files
                 std::cerr << "'" << filename << "' is not a regular file\n";
@@ -71,7 +76,7 @@ namespace mplot {
          * file: allocates some memory, copies the text into the new memory and then
          * returns a GLchar* pointer to the memory.
          */
-        std::unique_ptr<GLchar[]> ReadDefaultShader (const std::string& shadercontent)
+        inline std::unique_ptr<GLchar[]> ReadDefaultShader (const std::string& shadercontent)
         {
             std::size_t len = shadercontent.size();
             std::unique_ptr<GLchar[]> source = std::make_unique<GLchar[]>(len + 1);
@@ -80,7 +85,7 @@ namespace mplot {
             return source;
         }
 
-        std::string shader_type_str (GLuint shader_type)
+        inline std::string shader_type_str (GLuint shader_type)
         {
             std::string type("unknown");
             if (shader_type == GL_VERTEX_SHADER) {
@@ -95,5 +100,73 @@ namespace mplot {
             return type;
         }
 
+        /*!
+         * If non-empty, LoadShaders and LoadShadersMX keep the binaries of the programs that
+         * they link in this directory, and on later runs load a program from its binary rather
+         * than compiling its shaders. A binary is keyed by the shader sources and the driver
+         * (GL_VENDOR, GL_RENDERER and GL_VERSION), so an edited shader file or an updated driver
+         * gets a fresh compile. Empty (the default) disables the cache.
+         */
+        inline std::string program_cache_dir;
+
+        namespace program_cache {
+
+            constexpr char magic[8] = { 'm', 'p', 'l', 'o', 't', 'g', 'l', 'p' };
+
+            //! The cache key for the shaders of shader_info with the given sources on the driver described by driver
+            inline std::string key (const std::vector<mplot::gl::ShaderInfo>& shader_info,
+                                    const std::vector<std::unique_ptr<GLchar[]>>& sources, const std::string& driver)
+            {
+                std::string k = driver;
+                for (std::size_t i = 0; i < shader_info.size(); ++i) {
+                    k += '\n' + std::to_string (shader_info[i].type) + '\n' + sources[i].get();
+                }
+                std::stringstream ss;
+                ss << std::hex << std::hash<std::string>{}(k) << ".glprog";
+                return (std::filesystem::path (program_cache_dir) / ss.str()).string();
+            }
+
+            //! Read the binary (of the given format) from the cache file path. False if there isn't a valid one.
+            inline bool read (const std::string& path, GLenum& format, std::vector<char>& binary)
+            {
+                std::ifstream f (path, std::ios::binary);
+                if (!f.is_open()) { return false; }
+                char m[8] = {};
+                std::uint32_t fmt = 0;
+                std::uint64_t len = 0;
+                f.read (m, 8);
+                f.read (reinterpret_cast<char*>(&fmt), sizeof fmt);
+                f.read (reinterpret_cast<char*>(&len), sizeof len);
+                if (!f || std::memcmp (m, magic, 8) != 0 || len == 0 || len > (std::uint64_t{1} << 30)) { return false; }
+                binary.resize (len);
+                f.read (binary.data(), static_cast<std::streamsize>(len));
+                if (!f) { return false; }
+                format = static_cast<GLenum>(fmt);
+                return true;
+            }
+
+            //! Write a program binary to the cache file path (via a temporary file, so a reader never sees half of it)
+            inline void write (const std::string& path, const GLenum format, const std::vector<char>& binary)
+            {
+                std::error_code ec;
+                std::filesystem::create_directories (program_cache_dir, ec);
+                const std::string tmp = path + ".tmp";
+                {
+                    std::ofstream f (tmp, std::ios::binary | std::ios::trunc);
+                    if (!f.is_open()) { return; }
+                    const std::uint32_t fmt = static_cast<std::uint32_t>(format);
+                    const std::uint64_t len = binary.size();
+                    f.write (magic, 8);
+                    f.write (reinterpret_cast<const char*>(&fmt), sizeof fmt);
+                    f.write (reinterpret_cast<const char*>(&len), sizeof len);
+                    f.write (binary.data(), static_cast<std::streamsize>(len));
+                    if (!f) { return; }
+                }
+                std::filesystem::rename (tmp, path, ec);
+                if (ec) { std::filesystem::remove (tmp, ec); }
+            }
+
+        } // namespace program_cache
+
     } // namespace gl
 } // namespace
@@ -10,6 +10,9 @@
  */
 
 #include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
 #include <sm/vec>
 #include <sm/vvec>
 #include <sm/range>
@@ -18,6 +21,160 @@
 namespace mplot {
     namespace gl {
 
+        // How a mapped_view (or a persistent_ssbo) maps a buffer into CPU space. A write view
+        // discards the contents of the range it maps, so write every element through it.
+        enum class map_mode { read, write, read_write };
+
+        // The glMapBufferRange access bits for a map_mode
+        inline GLbitfield map_access (const map_mode m)
+        {
+            if (m == map_mode::read) { return GL_MAP_READ_BIT; }
+            if (m == map_mode::write) { return GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT; }
+            return GL_MAP_READ_BIT | GL_MAP_WRITE_BIT;
+        }
+
+        // The flags for the immutable storage of an SSBO (see ssbo::immutable and the setup_ssbo
+        // overloads that take them). Immutable storage is allocated once, with glBufferStorage
+        // (OpenGL 4.4), and is then written in place, so an upload never reallocates it.
+        struct storage_flags
+        {
+            // The storage may be written with glBufferSubData (GL_DYNAMIC_STORAGE_BIT)
+            bool dynamic = true;
+            // The storage may be mapped, and stay mapped while shaders use it (it is mapped
+            // persistently and coherently for reading and writing)
+            bool map_persistent = false;
+            // Prefer storage in CPU memory (GL_CLIENT_STORAGE_BIT), which is a hint only
+            bool client_storage = false;
+        };
+
+        // The glBufferStorage bits for the storage_flags f
+        inline GLbitfield storage_bits (const storage_flags f)
+        {
+            GLbitfield b = 0;
+#ifdef GL_VERSION_4_4
+            if (f.dynamic) { b |= GL_DYNAMIC_STORAGE_BIT; }
+            if (f.map_persistent) { b |= GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT; }
+            if (f.client_storage) { b |= GL_CLIENT_STORAGE_BIT; }
+#else
+            (void)f;
+#endif
+            return b;
+        }
+
+        // A fence in the GL command stream, for synchronizing the CPU with the GPU's use of a
+        // persistently mapped buffer
+        struct gpu_fence
+        {
+            GLsync sync = nullptr;
+
+            // Set the fence after the commands issued so far (replacing any earlier fence)
+            void set()
+            {
+                if (this->sync != nullptr) { glDeleteSync (this->sync); }
+                this->sync = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            }
+
+            // Block until the GPU has passed the fence (returning at once if there is none)
+            void wait()
+            {
+                if (this->sync == nullptr) { return; }
+                constexpr GLuint64 wait_ns = 100000000; // 100 ms per call
+                GLenum status = glClientWaitSync (this->sync, GL_SYNC_FLUSH_COMMANDS_BIT, wait_ns);
+                while (status == GL_TIMEOUT_EXPIRED) { status = glClientWaitSync (this->sync, 0, wait_ns); }
+                this->clear();
+                if (status == GL_WAIT_FAILED) { throw std::runtime_error ("mplot::gl::gpu_fence: glClientWaitSync failed"); }
+            }
+
+            // True if the GPU has passed the fence (or there is none). Never blocks.
+            bool ready()
+            {
+                if (this->sync == nullptr) { return true; }
+                const GLenum status = glClientWaitSync (this->sync, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+                if (status == GL_WAIT_FAILED) { throw std::runtime_error ("mplot::gl::gpu_fence: glClientWaitSync failed"); }
+                if (status == GL_TIMEOUT_EXPIRED) { return false; }
+                this->clear();
+                return true;
+            }
+
+            void clear()
+            {
+                if (this->sync != nullptr) { glDeleteSync (this->sync); }
+                this->sync = nullptr;
+            }
+        };
+
+        // A view of the first n elements of type T of a Shader Storage Buffer Object, mapped into
+        // CPU space for as long as the view lives. Read results in place through it, rather than
+        // copying them out with copy_from_gpu or ssbo_copy_to_vvec. A read view issues the memory
+        // barrier that makes the writes of earlier shader invocations visible to it, and mapping
+        // waits for the GPU to finish with the buffer. The buffer is unmapped when the view is
+        // destroyed, and it can't be used by a shader while the view lives.
+        template <typename T>
+        struct mapped_view
+        {
+            mapped_view (const unsigned int ssbo_idx, const unsigned int ssbo_name, const std::size_t _n,
+                         const map_mode m = map_mode::read)
+                : name(ssbo_name), n(_n)
+            {
+                if (m != map_mode::write) { glMemoryBarrier (GL_BUFFER_UPDATE_BARRIER_BIT); }
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, ssbo_idx, ssbo_name);
+                this->ptr = static_cast<T*>(glMapBufferRange (GL_SHADER_STORAGE_BUFFER, 0, _n * sizeof(T), map_access (m)));
+                mplot::gl::Util::checkError (__FILE__, __LINE__);
+                if (this->ptr == nullptr && _n > 0) { throw std::runtime_error ("mplot::gl::mapped_view: Failed to map the SSBO"); }
+            }
+            ~mapped_view() { this->unmap(); }
+
+            mapped_view (const mapped_view&) = delete;
+            mapped_view& operator= (const mapped_view&) = delete;
+            mapped_view (mapped_view&& o) noexcept
+                : name(o.name), n(o.n), ptr(std::exchange (o.ptr, nullptr)) {}
+            mapped_view& operator= (mapped_view&& o) noexcept
+            {
+                if (this != &o) {
+                    this->unmap();
+                    this->name = o.name;
+                    this->n = o.n;
+                    this->ptr = std::exchange (o.ptr, nullptr);
+                }
+                return *this;
+            }
+
+            // Unmap the buffer now, rather than when the view is destroyed
+            void unmap()
+            {
+                if (this->ptr == nullptr) { return; }
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, this->name);
+                glUnmapBuffer (GL_SHADER_STORAGE_BUFFER);
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, 0);
+                mplot::gl::Util::checkError (__FILE__, __LINE__);
+                this->ptr = nullptr;
+            }
+
+            T* data() { return this->ptr; }
+            const T* data() const { return this->ptr; }
+            std::size_t size() const { return this->ptr == nullptr ? 0 : this->n; }
+            bool empty() const { return this->size() == 0; }
+            T& operator[] (const std::size_t i) { return this->ptr[i]; }
+            const T& operator[] (const std::size_t i) const { return this->ptr[i]; }
+            T* begin() { return this->ptr; }
+            T* end() { return this->ptr + this->size(); }
+            const T* begin() const { return this->ptr; }
+            const T* end() const { return this->ptr + this->size(); }
+
+        private:
+            unsigned int name = 0;
+            std::size_t n = 0;
+            T* ptr = nullptr;
+        };
+
+        // Map n elements of the SSBO ssbo_name (at binding index ssbo_idx) into CPU space
+        template <typename T>
+        mapped_view<T> ssbo_map (const unsigned int ssbo_idx, const unsigned int ssbo_name, const std::size_t n,
+                                 const map_mode m = map_mode::read)
+        {
+            return mapped_view<T> (ssbo_idx, ssbo_name, n, m);
+        }
+
         // An SSBO and its data
         // @tparam index: The index of the buffer, used in the GLSL
         // @tparam T: The type of the data in the SSBO
@@ -29,6 +186,10 @@ namespace mplot {
             unsigned int name = 0;
             // The CPU-side data for the buffer
             sm::vec<T, N> data;
+            // If true, init() allocates immutable storage with the flags in storage (OpenGL 4.4),
+            // and copy_to_gpu() writes into that storage rather than reallocating it. Set before init().
+            bool immutable = false;
+            storage_flags storage;
 
             ssbo() {}
             ~ssbo() {}
@@ -37,12 +198,35 @@ namespace mplot {
             void init()
             {
                 glGenBuffers (1, &this->name);
-                this->copy_to_gpu();
+                if (!this->immutable) {
+                    this->copy_to_gpu();
+                    return;
+                }
+#ifdef GL_VERSION_4_4
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, index, this->name);
+                const GLbitfield flags = storage_bits (this->storage);
+                glBufferStorage (GL_SHADER_STORAGE_BUFFER, N * sizeof(T), this->data.data(), flags);
+                if (this->storage.map_persistent) {
+                    this->mapped_ptr = static_cast<T*>(glMapBufferRange (GL_SHADER_STORAGE_BUFFER, 0, N * sizeof(T),
+                                                                         flags & ~(GL_DYNAMIC_STORAGE_BIT | GL_CLIENT_STORAGE_BIT)));
+                    if (this->mapped_ptr == nullptr) { throw std::runtime_error ("mplot::gl::ssbo: Failed to map the SSBO"); }
+                }
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, 0);
+                mplot::gl::Util::checkError (__FILE__, __LINE__);
+#else
+                throw std::runtime_error ("mplot::gl::ssbo: GL headers lack glBufferStorage for immutable storage");
+#endif
             }
 
-            // Copy the data in the sm::vec data over to the GPU
+            // Copy the data in the sm::vec data over to the GPU. Mutable storage is reallocated
+            // (with glBufferData). Immutable storage is written in place: through its persistent
+            // mapping, once the GPU has passed the last fence(), or with glBufferSubData.
             void copy_to_gpu()
             {
+                if (this->immutable) {
+                    this->copy_to_gpu (0, N);
+                    return;
+                }
                 glBindBufferBase (GL_SHADER_STORAGE_BUFFER, index, this->name);
                 mplot::gl::Util::checkError (__FILE__, __LINE__);
                 glBufferData (GL_SHADER_STORAGE_BUFFER, N * sizeof(T), this->data.data(), GL_STATIC_DRAW);
@@ -51,12 +235,62 @@ namespace mplot {
                 mplot::gl::Util::checkError (__FILE__, __LINE__);
             }
 
+            // Copy count elements of data from element first over to the GPU, into the existing
+            // storage (with glBufferSubData, or through the persistent mapping)
+            void copy_to_gpu (const std::size_t first, const std::size_t count)
+            {
+                if (first + count > N) { throw std::runtime_error ("mplot::gl::ssbo::copy_to_gpu: range is out of bounds"); }
+                if (this->mapped_ptr != nullptr) {
+                    this->sync.wait();
+                    std::copy_n (this->data.begin() + first, count, this->mapped_ptr + first);
+                    return;
+                }
+                if (this->immutable && !this->storage.dynamic) {
+                    throw std::runtime_error ("mplot::gl::ssbo::copy_to_gpu: immutable storage is neither dynamic nor mapped");
+                }
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, index, this->name);
+                glBufferSubData (GL_SHADER_STORAGE_BUFFER, first * sizeof(T), count * sizeof(T), this->data.data() + first);
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, 0);
+                mplot::gl::Util::checkError (__FILE__, __LINE__);
+            }
+
+            // With persistently mapped storage, call after dispatching the shaders that use the
+            // buffer. The next copy_to_gpu, copy_from_gpu or get_range waits for them to finish.
+            void fence()
+            {
+#ifdef GL_VERSION_4_4
+                glMemoryBarrier (GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
+#endif
+                this->sync.set();
+            }
+
+            // The persistent mapping of the storage (if immutable and storage.map_persistent),
+            // else nullptr. Synchronize access through it with fence() and wait_fence().
+            T* mapped() { return this->mapped_ptr; }
+
+            // Block until the GPU has passed the last fence()
+            void wait_fence() { this->sync.wait(); }
+
+            // Map the GPU memory to CPU space and return a view of it, through which the data can
+            // be read (or written) in place. The buffer stays mapped until the view is destroyed.
+            // For persistently mapped storage, use mapped() instead.
+            mapped_view<T> map (const map_mode m = map_mode::read)
+            {
+                if (this->mapped_ptr != nullptr) { throw std::runtime_error ("mplot::gl::ssbo::map: storage is persistently mapped; use mapped()"); }
+                return mapped_view<T> (index, this->name, N, m);
+            }
+
             // Map the GPU memory to CPU space, then copy the values into this->data. NB: it's a
             // performance hit to *copy* to the mapped data to our sm::vec, because the data is
-            // *already in CPU accessible memory* after glMapBufferRange().
+            // *already in CPU accessible memory* after glMapBufferRange() (see map()).
             // However, in case you need it, here it is.
             void copy_from_gpu()
             {
+                if (this->mapped_ptr != nullptr) {
+                    this->sync.wait();
+                    std::copy_n (this->mapped_ptr, N, this->data.begin());
+                    return;
+                }
                 glBindBufferBase (GL_SHADER_STORAGE_BUFFER, index, this->name);
                 mplot::gl::Util::checkError (__FILE__, __LINE__);
                 T* cpuptr = static_cast<T*>(glMapBufferRange (GL_SHADER_STORAGE_BUFFER, 0, N*sizeof(T), GL_MAP_READ_BIT));
@@ -76,6 +310,11 @@ namespace mplot {
             {
                 sm::range<T> r;
                 r.search_init();
+                if (this->mapped_ptr != nullptr) {
+                    this->sync.wait();
+                    for (unsigned int i = 0; i < N; ++i) { r.update (this->mapped_ptr[i]); }
+                    return r;
+                }
                 glBindBufferBase (GL_SHADER_STORAGE_BUFFER, index, this->name);
                 mplot::gl::Util::checkError (__FILE__, __LINE__);
                 T* cpuptr = static_cast<T*>(glMapBufferRange (GL_SHADER_STORAGE_BUFFER, 0, N*sizeof(T), GL_MAP_READ_BIT));
@@ -86,6 +325,11 @@ namespace mplot {
                 mplot::gl::Util::checkError (__FILE__, __LINE__);
                 return r;
             }
+
+        private:
+            // The persistent mapping of immutable storage
+            T* mapped_ptr = nullptr;
+            gpu_fence sync;
         };
 
         // Set up a Shader Storage Buffer Object (SSBO) and buffer data into it (from a sm::vvec)
@@ -94,11 +338,35 @@ namespace mplot {
         {
             glGenBuffers (1, &ssbo_id);
             glBindBufferBase (GL_SHADER_STORAGE_BUFFER, target_index, ssbo_id);
-            // Mutable, re-locatable storage:
+            // Mutable, re-locatable storage (see the overload that takes storage_flags for immutable storage):
             glBufferData (GL_SHADER_STORAGE_BUFFER, data.size() * sizeof(T), data.data(), GL_STATIC_DRAW);
-            // Immutable storage would be:
-            // void glBufferStorage(GLenum target​, GLsizeiptr size​, const GLvoid * data​, GLbitfield flags​);
-            //glBufferStorage (GL_SHADER_STORAGE_BUFFER, data.size() * sizeof(T), data.data(), GL_CLIENT_STORAGE_BIT | GL_MAP_READ_BIT);
+            glBindBuffer (GL_SHADER_STORAGE_BUFFER, 0);
+            mplot::gl::Util::checkError (__FILE__, __LINE__);
+        }
+
+        // Set up a Shader Storage Buffer Object (SSBO) with immutable storage (OpenGL 4.4),
+        // allocated once with the flags f, and buffer data into it. Update it with
+        // update_ssbo (if f.dynamic) or through a persistent mapping (if f.map_persistent).
+        template<typename T>
+        void setup_ssbo (const GLuint target_index, unsigned int& ssbo_id, const sm::vvec<T>& data, const storage_flags f)
+        {
+#ifdef GL_VERSION_4_4
+            glGenBuffers (1, &ssbo_id);
+            glBindBufferBase (GL_SHADER_STORAGE_BUFFER, target_index, ssbo_id);
+            glBufferStorage (GL_SHADER_STORAGE_BUFFER, data.size() * sizeof(T), data.data(), storage_bits (f));
+            glBindBuffer (GL_SHADER_STORAGE_BUFFER, 0);
+            mplot::gl::Util::checkError (__FILE__, __LINE__);
+#else
+            throw std::runtime_error ("mplot::gl::setup_ssbo: GL headers lack glBufferStorage for immutable storage");
+#endif
+        }
+
+        // Write data into an existing SSBO from element first, without reallocating its storage
+        template<typename T>
+        void update_ssbo (const GLuint target_index, const unsigned int ssbo_id, const sm::vvec<T>& data, const std::size_t first = 0)
+        {
+            glBindBufferBase (GL_SHADER_STORAGE_BUFFER, target_index, ssbo_id);
+            glBufferSubData (GL_SHADER_STORAGE_BUFFER, first * sizeof(T), data.size() * sizeof(T), data.data());
             glBindBuffer (GL_SHADER_STORAGE_BUFFER, 0);
             mplot::gl::Util::checkError (__FILE__, __LINE__);
         }
@@ -133,7 +401,241 @@ namespace mplot {
             mplot::gl::Util::checkError (__FILE__, __LINE__);
         }
 
-        // Map the SSBO to cpu space, then make a copy of the data into a passed-in vvec.
+        // An SSBO and its data, like ssbo, but with a number of elements (and a binding index)
+        // that is chosen at runtime. The data is held in an sm::vvec rather than an sm::vec.
+        template <typename T>
+        struct vvec_ssbo
+        {
+            // The name of the buffer, generated with glGenBuffers()
+            unsigned int name = 0;
+            // The index of the buffer, used in the GLSL
+            unsigned int index = 0;
+            // The CPU-side data for the buffer
+            sm::vvec<T> data;
+
+            // Make the buffer, bound to index _index, with the contents of data. Client code must
+            // ensure there is an OpenGL context available.
+            void init (const unsigned int _index)
+            {
+                this->index = _index;
+                glGenBuffers (1, &this->name);
+                this->copy_to_gpu();
+            }
+
+            // Make the buffer, with n elements of value val
+            void init (const unsigned int _index, const std::size_t n, const T val = T{})
+            {
+                this->data.assign (n, val);
+                this->init (_index);
+            }
+
+            // Delete the buffer
+            void deinit()
+            {
+                if (this->name != 0) { glDeleteBuffers (1, &this->name); }
+                this->name = 0;
+                this->allocated = 0;
+            }
+
+            // Bind the buffer to its index
+            void bind() { glBindBufferBase (GL_SHADER_STORAGE_BUFFER, this->index, this->name); }
+
+            // Bind the buffer to binding index _index, which becomes its index
+            void bind (const unsigned int _index)
+            {
+                this->index = _index;
+                this->bind();
+            }
+
+            // The number of elements in the buffer's storage on the GPU
+            std::size_t size() const { return this->allocated; }
+
+            // Copy data over to the GPU. The storage is reallocated only if data has changed size.
+            void copy_to_gpu()
+            {
+                this->bind();
+                if (this->data.size() != this->allocated) {
+                    glBufferData (GL_SHADER_STORAGE_BUFFER, this->data.size() * sizeof(T), this->data.data(), GL_DYNAMIC_DRAW);
+                    this->allocated = this->data.size();
+                } else {
+                    glBufferSubData (GL_SHADER_STORAGE_BUFFER, 0, this->data.size() * sizeof(T), this->data.data());
+                }
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, 0);
+                mplot::gl::Util::checkError (__FILE__, __LINE__);
+            }
+
+            // Copy count elements of data from element first over to the existing storage on the GPU
+            void copy_to_gpu (const std::size_t first, const std::size_t count)
+            {
+                if (first + count > this->allocated || first + count > this->data.size()) {
+                    throw std::runtime_error ("mplot::gl::vvec_ssbo::copy_to_gpu: range is out of bounds");
+                }
+                this->bind();
+                glBufferSubData (GL_SHADER_STORAGE_BUFFER, first * sizeof(T), count * sizeof(T), this->data.data() + first);
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, 0);
+                mplot::gl::Util::checkError (__FILE__, __LINE__);
+            }
+
+            // Map the GPU memory to CPU space and return a view of it (see mapped_view)
+            mapped_view<T> map (const map_mode m = map_mode::read)
+            {
+                return mapped_view<T> (this->index, this->name, this->allocated, m);
+            }
+
+            // Copy the GPU memory into data (resized to the number of elements on the GPU)
+            void copy_from_gpu()
+            {
+                this->data.resize (this->allocated);
+                const mapped_view<T> v = this->map();
+                std::copy (v.begin(), v.end(), this->data.begin());
+            }
+
+            // Find the range of the data in the GPU memory
+            sm::range<T> get_range()
+            {
+                sm::range<T> r;
+                r.search_init();
+                const mapped_view<T> v = this->map();
+                for (const T& d : v) { r.update (d); }
+                return r;
+            }
+
+        private:
+            // The number of elements allocated on the GPU
+            std::size_t allocated = 0;
+        };
+
+        // A pair of vvec_ssbos for shaders that read one buffer and write the other, such as the
+        // steps of a scan or of a cellular automaton. After each dispatch, swap() exchanges the
+        // binding indices of the two buffers, so that the output of one step is the input of the
+        // next without a copy.
+        template <typename T>
+        struct ssbo_pingpong
+        {
+            // Make both buffers, of n elements of value val. The input buffer is bound to
+            // in_index and the output buffer to out_index.
+            void init (const unsigned int in_index, const unsigned int out_index, const std::size_t n, const T val = T{})
+            {
+                this->cur = 0;
+                this->buf[0].init (in_index, n, val);
+                this->buf[1].init (out_index, n, val);
+            }
+
+            // Make both buffers, with input holding the initial data of the input buffer
+            void init (const unsigned int in_index, const unsigned int out_index, const sm::vvec<T>& input)
+            {
+                this->cur = 0;
+                this->buf[0].data = input;
+                this->buf[0].init (in_index);
+                this->buf[1].init (out_index, input.size());
+            }
+
+            void deinit()
+            {
+                this->buf[0].deinit();
+                this->buf[1].deinit();
+            }
+
+            // Make the last output the next input, rebinding the two buffers to each other's index
+            void swap()
+            {
+                const unsigned int in_index = this->buf[this->cur].index;
+                const unsigned int out_index = this->buf[this->cur ^ 1u].index;
+                this->cur ^= 1u;
+                this->buf[this->cur].bind (in_index);
+                this->buf[this->cur ^ 1u].bind (out_index);
+            }
+
+            // The buffer that the next dispatch reads
+            vvec_ssbo<T>& input() { return this->buf[this->cur]; }
+            // The buffer that the next dispatch writes (and that the last dispatch wrote, until swap())
+            vvec_ssbo<T>& output() { return this->buf[this->cur ^ 1u]; }
+
+        private:
+            vvec_ssbo<T> buf[2];
+            unsigned int cur = 0;
+        };
+
+        // A Shader Storage Buffer Object of n elements of type T with immutable storage that is
+        // mapped into CPU space once, at init(), and stays mapped (persistently and coherently) so
+        // that data() can be kept across frames. The GPU and CPU must not use the buffer at the
+        // same time: after dispatching a shader that writes it, call fence(), and call wait()
+        // before reading it through data(). Needs OpenGL 4.4 (glBufferStorage).
+        template <typename T>
+        struct persistent_ssbo
+        {
+            // The name of the buffer, generated with glGenBuffers()
+            unsigned int name = 0;
+            // The binding index of the buffer, used in the GLSL
+            unsigned int index = 0;
+
+            // Make the buffer, with the initial contents initial (if not nullptr), and map it
+            void init (const unsigned int _index, const std::size_t _n, const map_mode m = map_mode::read_write,
+                       const T* initial = nullptr)
+            {
+#ifdef GL_VERSION_4_4
+                this->index = _index;
+                this->n = _n;
+                glGenBuffers (1, &this->name);
+                glBindBufferBase (GL_SHADER_STORAGE_BUFFER, this->index, this->name);
+                const GLbitfield flags = (map_access (m) & (GL_MAP_READ_BIT | GL_MAP_WRITE_BIT))
+                | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+                glBufferStorage (GL_SHADER_STORAGE_BUFFER, this->n * sizeof(T), initial, flags);
+                this->ptr = static_cast<T*>(glMapBufferRange (GL_SHADER_STORAGE_BUFFER, 0, this->n * sizeof(T), flags));
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, 0);
+                mplot::gl::Util::checkError (__FILE__, __LINE__);
+                if (this->ptr == nullptr) { throw std::runtime_error ("mplot::gl::persistent_ssbo: Failed to map the SSBO"); }
+#else
+                throw std::runtime_error ("mplot::gl::persistent_ssbo: GL headers lack glBufferStorage");
+#endif
+            }
+
+            // Unmap and delete the buffer (client code must ensure there is an OpenGL context)
+            void deinit()
+            {
+                this->sync.clear();
+                if (this->name == 0) { return; }
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, this->name);
+                glUnmapBuffer (GL_SHADER_STORAGE_BUFFER);
+                glBindBuffer (GL_SHADER_STORAGE_BUFFER, 0);
+                glDeleteBuffers (1, &this->name);
+                this->name = 0;
+                this->ptr = nullptr;
+                this->n = 0;
+            }
+
+            // Bind the buffer to its index again (if another buffer has been bound there)
+            void bind() { glBindBufferBase (GL_SHADER_STORAGE_BUFFER, this->index, this->name); }
+
+            // Call after dispatching the shaders that write (or read) the buffer
+            void fence()
+            {
+#ifdef GL_VERSION_4_4
+                // Make the shaders' writes visible through the mapping once the fence is passed
+                glMemoryBarrier (GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
+#endif
+                this->sync.set();
+            }
+
+            // Block until the GPU has finished the commands issued before the last fence()
+            void wait() { this->sync.wait(); }
+
+            T* data() { return this->ptr; }
+            const T* data() const { return this->ptr; }
+            std::size_t size() const { return this->n; }
+            T& operator[] (const std::size_t i) { return this->ptr[i]; }
+            const T& operator[] (const std::size_t i) const { return this->ptr[i]; }
+            T* begin() { return this->ptr; }
+            T* end() { return this->ptr + this->n; }
+
+        private:
+            std::size_t n = 0;
+            T* ptr = nullptr;
+            gpu_fence sync;
+        };
+
+        // Map the SSBO to cpu space, then make a copy of the data into a passed-in vvec (see
+        // ssbo_map for a view of the data in place, without the copy).
         //
         // ssbo_idx: The Index of the Shader Storage Buffer Object that we're reading from
         // ssbo_name: The name (really a number) of the Shader Storage Buffer Object that we're reading from
@@ -20,7 +20,7 @@ namespace mplot {
         // Set up a single texture suitable for filling with values within the
         // compute shader. Note: fixed format of GL_RGBA and GL_FLOAT; could set these
         // with template params.
-        void setup_texture (const GLuint image_texture_unit, unsigned int& texture_id, sm::vec<GLsizei, 2> dims)
+        inline void setup_texture (const GLuint image_texture_unit, unsigned int& texture_id, sm::vec<GLsizei, 2> dims)
         {
             glGenTextures (1, &texture_id); // generate a texture name and place it in texture_id
             // Bind a texture (GL_TEXTURE_2D) to the texture name
@@ -62,12 +62,137 @@ namespace mplot {
             }
         }
 
+        // Formats of the textures that compute shaders read and write as images. The image
+        // format qualifier in the GLSL must match (r32f, rg32f, rgba16f or rgba32f). OpenGL 3.1 ES
+        // has no rg32f images.
+        enum class texture_format { r32f, rg32f, rgba16f, rgba32f };
+
+        // The sized internal format of a texture_format, for glTexStorage2D and glBindImageTexture
+        constexpr GLenum internal_format (const texture_format f)
+        {
+            switch (f) {
+            case texture_format::r32f: return GL_R32F;
+            case texture_format::rg32f: return GL_RG32F;
+            case texture_format::rgba16f: return GL_RGBA16F;
+            default: return GL_RGBA32F;
+            }
+        }
+
+        // The number of channels (and so of floats per texel, when uploading) of a texture_format
+        constexpr unsigned int format_channels (const texture_format f)
+        {
+            return f == texture_format::r32f ? 1u : (f == texture_format::rg32f ? 2u : 4u);
+        }
+
+        // The pixel format of the float data uploaded into a texture of format f
+        constexpr GLenum pixel_format (const texture_format f)
+        {
+            return f == texture_format::r32f ? GL_RED : (f == texture_format::rg32f ? GL_RG : GL_RGBA);
+        }
+
+        // Set up an immutable texture of format f that a compute shader can load from and
+        // store to. If data is not nullptr, fill it with data, format_channels(f) floats per
+        // texel, in rows from texel (0, 0). The texture is sampled without filtering, so that it
+        // can also be sampled directly (for example by a VisualModel; see setDatumTexture).
+        inline void setup_image_texture (unsigned int& texture_id, sm::vec<GLsizei, 2> dims, const texture_format f,
+                                  const float* data = nullptr)
+        {
+            glGenTextures (1, &texture_id);
+            glBindTexture (GL_TEXTURE_2D, texture_id);
+            glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            // Immutable storage, which glBindImageTexture needs on OpenGL 3.1 ES
+            glTexStorage2D (GL_TEXTURE_2D, 1, internal_format (f), dims[0], dims[1]);
+            if (data != nullptr) {
+                glTexSubImage2D (GL_TEXTURE_2D, 0, 0, 0, dims[0], dims[1], pixel_format (f), GL_FLOAT, data);
+            }
+            glBindTexture (GL_TEXTURE_2D, 0);
+            mplot::gl::Util::checkError (__FILE__, __LINE__);
+        }
+
+        // A pair of image textures for stencil kernels (convolutions, reaction-diffusion), which
+        // read the neighbourhood of each texel of one texture and write the other. Each step
+        // reads input() through image unit in_unit and writes output() through image unit
+        // out_unit; swap() exchanges the textures' roles and rebinds the units, so the shader's
+        // bindings never change. To display the latest state, pass the texture last written
+        // (input(), after swap()) to a VisualModel's setDatumTexture or a GridVisual's
+        // setDataTexture, which sample it in place. The step must be followed by a
+        // glMemoryBarrier with GL_TEXTURE_FETCH_BARRIER_BIT before the texture is drawn.
+        struct texture_pingpong
+        {
+            texture_format format = texture_format::r32f;
+            sm::vec<GLsizei, 2> dims = { 0, 0 };
+            GLuint in_unit = 0;
+            GLuint out_unit = 1;
+
+            ~texture_pingpong() { this->deinit(); }
+
+            // Make both textures, of dims texels of format f, the input holding initial (if not
+            // nullptr; see setup_image_texture), and bind them to their image units
+            void init (const GLuint _in_unit, const GLuint _out_unit, const sm::vec<GLsizei, 2> _dims,
+                       const texture_format f = texture_format::r32f, const float* initial = nullptr)
+            {
+                this->deinit();
+                this->in_unit = _in_unit;
+                this->out_unit = _out_unit;
+                this->dims = _dims;
+                this->format = f;
+                this->cur = 0;
+                setup_image_texture (this->tex[0], this->dims, f, initial);
+                setup_image_texture (this->tex[1], this->dims, f);
+                this->bind();
+            }
+
+            void deinit()
+            {
+                if (this->tex[0] != 0) { glDeleteTextures (2, this->tex); }
+                this->tex[0] = 0;
+                this->tex[1] = 0;
+            }
+
+            // Bind input() to in_unit for reading and output() to out_unit for writing
+            void bind() const
+            {
+                const GLenum ifmt = internal_format (this->format);
+                glBindImageTexture (this->in_unit, this->input(), 0, GL_FALSE, 0, GL_READ_ONLY, ifmt);
+                glBindImageTexture (this->out_unit, this->output(), 0, GL_FALSE, 0, GL_WRITE_ONLY, ifmt);
+                mplot::gl::Util::checkError (__FILE__, __LINE__);
+            }
+
+            // Make the last output the next input
+            void swap()
+            {
+                this->cur ^= 1u;
+                this->bind();
+            }
+
+            // Replace the contents of input() with data (format_channels(format) floats per texel)
+            void upload (const float* data) const
+            {
+                glBindTexture (GL_TEXTURE_2D, this->input());
+                glTexSubImage2D (GL_TEXTURE_2D, 0, 0, 0, this->dims[0], this->dims[1], pixel_format (this->format), GL_FLOAT, data);
+                glBindTexture (GL_TEXTURE_2D, 0);
+                mplot::gl::Util::checkError (__FILE__, __LINE__);
+            }
+
+            // The texture that the next step reads (the result of the last step, after swap())
+            GLuint input() const { return this->tex[this->cur]; }
+            // The texture that the next step writes
+            GLuint output() const { return this->tex[this->cur ^ 1u]; }
+
+        private:
+            GLuint tex[2] = { 0, 0 };
+            unsigned int cur = 0;
+        };
+
 #ifdef I_HAD_FIGURED_OUT_SETUP_TEXTURE_WITH_DATA_PROPERLY
 # define USE_IMMUTABLE_STORAGE 1 // Should use immutable texture storage in order to use glBindImageTexture
 
         // Set up a shader-read-only texture with the provided rgb image data.
         // Just can't figure out how to make this work in GL 3.1 ES!
-        void setup_texture (const GLuint image_texture_unit, unsigned int& texture_id,
+        inline void setup_texture (const GLuint image_texture_unit, unsigned int& texture_id,
                             sm::vec<GLsizei, 2> dims, float* rgb_data)
         {
             std::cout << "setup_texture for READ_ONLY access of an image in shader\n";
@@ -119,7 +244,7 @@ namespace mplot {
         // Set up a shader-read-only texture with the provided rgb image data.  This is an
         // attempt to create one mutable texture, and an immutable one and copy the texture from
         // the mutable to the immutable. Doesn't work.
-        void setup_texture_alt (const GLuint image_texture_unit, unsigned int& texture_id,
+        inline void setup_texture_alt (const GLuint image_texture_unit, unsigned int& texture_id,
                                 sm::vec<GLsizei, 2> dims, float* rgb_data)
         {
             std::cout << "setup_texture for READ_ONLY access of an image in shader\n";
@@ -0,0 +1,85 @@
+/*!
+ * \file
+ *
+ * A typed uniform buffer object for the parameters of a compute (or any) shader program. The
+ * parameters are members of a struct T whose layout matches a std140 uniform block in the GLSL,
+ * for example
+ *
+ *   struct params { float dt; float diffusion; unsigned int n; unsigned int pad; };
+ *
+ * for
+ *
+ *   layout(std140, binding = 0) uniform Params { float dt; float diffusion; uint n; };
+ *
+ * Bind the block once; each update of the parameters is then a write into data and one
+ * glBufferSubData, with no uniform lookups.
+ *
+ * \author Seb James
+ * \date 2026
+ */
+#pragma once
+
+// As for compute_manager.h, the client code includes the GL headers before this file.
+
+#include <type_traits>
+#include <mplot/gl/util_nomx.h>
+
+namespace mplot {
+    namespace gl {
+
+        template <typename T>
+        struct uniform_block
+        {
+            static_assert (std::is_trivially_copyable_v<T>, "uniform_block data must be trivially copyable");
+            static_assert (sizeof (T) % 16 == 0, "A std140 uniform block is a whole number of vec4s; pad T to a multiple of 16 bytes");
+
+            // The parameters, laid out as the std140 block in the GLSL
+            T data = {};
+            // The name of the buffer, generated with glGenBuffers()
+            GLuint name = 0;
+            // The uniform buffer binding point to which the buffer is attached
+            GLuint binding = 0;
+
+            ~uniform_block() { this->deinit(); }
+
+            // Make the buffer, holding data, and attach it to binding point _binding. Attach the
+            // program's block to the same point with a layout(binding = ...) qualifier or with
+            // compute_shaderprog::bind_uniform_block.
+            void init (const GLuint _binding)
+            {
+                this->binding = _binding;
+                glGenBuffers (1, &this->name);
+                glBindBuffer (GL_UNIFORM_BUFFER, this->name);
+                glBufferData (GL_UNIFORM_BUFFER, sizeof (T), &this->data, GL_DYNAMIC_DRAW);
+                glBindBuffer (GL_UNIFORM_BUFFER, 0);
+                this->bind();
+                mplot::gl::Util::checkError (__FILE__, __LINE__);
+            }
+
+            void deinit()
+            {
+                if (this->name != 0) { glDeleteBuffers (1, &this->name); }
+                this->name = 0;
+            }
+
+            // Attach the buffer to its binding point (again, if another buffer has been attached there)
+            void bind() const { glBindBufferBase (GL_UNIFORM_BUFFER, this->binding, this->name); }
+
+            // Copy data over to the GPU, for the next dispatch
+            void update()
+            {
+                glBindBuffer (GL_UNIFORM_BUFFER, this->name);
+                glBufferSubData (GL_UNIFORM_BUFFER, 0, sizeof (T), &this->data);
+                glBindBuffer (GL_UNIFORM_BUFFER, 0);
+            }
+
+            // Set the parameters and copy them over to the GPU
+            void update (const T& _data)
+            {
+                this->data = _data;
+                this->update();
+            }
+        };
+
+    } // namespace gl
+} // namespace mplot
@@ -0,0 +1,204 @@
+/*!
+ * \file
+ *
+ * A thread that creates and fills vertex buffers in an OpenGL context of its own, which shares
+ * its objects with a Visual's context (see VisualMX::setUploadWorker). The BufferData calls for
+ * a large model then run on this thread, not in the render thread's postVertexInit, so a frame
+ * (of this window, or of any other panel) never waits for a multi-gigabyte copy into the
+ * driver.
+ *
+ * Each upload_job is a set of buffers to create and fill. The worker fills them, places a fence
+ * in its command stream and flushes, then marks the job done. The render thread polls the fence
+ * (without blocking) and, once it has signalled, points the model's vertex array (which, unlike
+ * buffers, can't be shared between contexts) at the new buffers and deletes the old ones. Until
+ * then, the model goes on drawing its previous buffers.
+ *
+ * This is the multicontext (GladGLContext) code; the worker loads GL into a GladGLContext of
+ * its own on its thread.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+#pragma once
+
+// As for compute_manager.h, the client code includes the GL headers before this file.
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace mplot {
+    namespace gl {
+
+        //! One set of buffers for the upload worker to create and fill
+        struct upload_job
+        {
+            //! The data for one buffer. The data must stay unchanged until the job is done.
+            struct buffer
+            {
+                const void* data = nullptr;
+                std::size_t bytes = 0;
+            };
+            std::vector<buffer> buffers;
+
+            //! Called on the worker thread once the job is done (to request a redraw, say)
+            std::function<void()> on_done;
+
+            // Written by the worker, and valid once done is true
+            //! The buffer names, one for each of buffers, in the share group of the worker's context
+            std::vector<GLuint> names;
+            //! A fence placed after the uploads. The render thread's context may use the buffers once it has signalled.
+            GLsync fence = nullptr;
+            //! Empty unless the job failed, in which case names is empty and fence is null
+            std::string error;
+
+            //! Set (with release semantics) when the worker has finished with the job's data
+            std::atomic<bool> done = false;
+
+            //! Block until the worker has finished with the job (its data may then be changed)
+            void wait() const { this->done.wait (false, std::memory_order_acquire); }
+        };
+
+        class upload_worker
+        {
+        public:
+            /*!
+             * Start the worker thread. make_current is called on the thread to make the
+             * worker's context current (the context must share objects with the contexts that
+             * will use the buffers); release_current is called on the thread as it exits. GL is
+             * loaded into the worker's own GladGLContext with procaddressfn.
+             */
+            upload_worker (std::function<void()> make_current, std::function<void()> release_current,
+                           GLADloadfunc procaddressfn)
+                : make_current_fn (std::move (make_current))
+                , release_current_fn (std::move (release_current))
+                , load_fn (procaddressfn)
+            {
+                this->thread = std::thread (&upload_worker::run, this);
+            }
+
+            upload_worker (const upload_worker&) = delete;
+            upload_worker& operator= (const upload_worker&) = delete;
+
+            //! Finish the queued jobs and stop the thread
+            ~upload_worker()
+            {
+                {
+                    std::lock_guard<std::mutex> lk (this->m);
+                    this->stop = true;
+                }
+                this->cv.notify_one();
+                if (this->thread.joinable()) { this->thread.join(); }
+            }
+
+            //! Queue a job. Its buffers' data must stay unchanged until it is done.
+            void submit (const std::shared_ptr<upload_job>& j)
+            {
+                {
+                    std::lock_guard<std::mutex> lk (this->m);
+                    this->jobs.push_back (j);
+                }
+                this->cv.notify_one();
+            }
+
+            //! Uploads of fewer bytes than this are left to the render thread, for which they cost little
+            std::size_t min_bytes = std::size_t{16} << 20;
+
+            //! Each buffer is filled with BufferSubData calls of up to this many bytes, to bound the driver's staging memory
+            std::size_t chunk_bytes = std::size_t{64} << 20;
+
+            //! The number of jobs done
+            std::uint64_t jobs_done() const { return this->n_jobs.load (std::memory_order_relaxed); }
+            //! The bytes uploaded
+            std::uint64_t bytes_uploaded() const { return this->n_bytes.load (std::memory_order_relaxed); }
+            //! False if GL could not be loaded in the worker's context (every job then fails)
+            bool ok() const { return !this->load_failed.load (std::memory_order_relaxed); }
+
+        private:
+            void run()
+            {
+                this->make_current_fn();
+                GladGLContext ctx = {};
+                if (gladLoadGLContext (&ctx, this->load_fn) == 0) { this->load_failed = true; }
+                while (true) {
+                    std::shared_ptr<upload_job> j;
+                    {
+                        std::unique_lock<std::mutex> lk (this->m);
+                        this->cv.wait (lk, [this]() { return this->stop || !this->jobs.empty(); });
+                        if (this->jobs.empty()) { break; } // stop, with nothing left to do
+                        j = std::move (this->jobs.front());
+                        this->jobs.pop_front();
+                    }
+                    if (this->load_failed) {
+                        j->error = "upload_worker: GL could not be loaded in the worker's context";
+                    } else {
+                        this->fill (ctx, *j);
+                    }
+                    this->n_jobs.fetch_add (1u, std::memory_order_relaxed);
+                    j->done.store (true, std::memory_order_release);
+                    j->done.notify_all();
+                    if (j->on_done) { j->on_done(); }
+                }
+                this->release_current_fn();
+            }
+
+            //! Create and fill the buffers of job j, then fence and flush
+            void fill (GladGLContext& ctx, upload_job& j)
+            {
+                const std::size_t n = j.buffers.size();
+                j.names.assign (n, 0u);
+                ctx.GenBuffers (static_cast<GLsizei>(n), j.names.data());
+                // The buffers are filled through GL_COPY_WRITE_BUFFER, which (unlike
+                // GL_ELEMENT_ARRAY_BUFFER) needs no vertex array bound. A buffer's first binding
+                // doesn't restrict the targets to which it may later be bound.
+                std::uint64_t total = 0;
+                for (std::size_t i = 0; i < n; ++i) {
+                    const upload_job::buffer& b = j.buffers[i];
+                    ctx.BindBuffer (GL_COPY_WRITE_BUFFER, j.names[i]);
+                    ctx.BufferData (GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(b.bytes), nullptr, GL_STATIC_DRAW);
+                    const unsigned char* src = static_cast<const unsigned char*>(b.data);
+                    for (std::size_t off = 0; src != nullptr && off < b.bytes; off += this->chunk_bytes) {
+                        const std::size_t sz = std::min (this->chunk_bytes, b.bytes - off);
+                        ctx.BufferSubData (GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(off), static_cast<GLsizeiptr>(sz), src + off);
+                    }
+                    total += b.bytes;
+                }
+                ctx.BindBuffer (GL_COPY_WRITE_BUFFER, 0);
+                const GLenum err = ctx.GetError();
+                if (err != GL_NO_ERROR) {
+                    ctx.DeleteBuffers (static_cast<GLsizei>(n), j.names.data());
+                    j.names.clear();
+                    j.error = "upload_worker: GL error " + std::to_string (err) + " while filling buffers";
+                    return;
+                }
+                j.fence = ctx.FenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                // Flush, so that the fence reaches the GPU and a wait on it in another context can end
+                ctx.Flush();
+                this->n_bytes.fetch_add (total, std::memory_order_relaxed);
+            }
+
+            std::function<void()> make_current_fn;
+            std::function<void()> release_current_fn;
+            GLADloadfunc load_fn = nullptr;
+
+            std::thread thread;
+            std::mutex m;
+            std::condition_variable cv;
+            std::deque<std::shared_ptr<upload_job>> jobs;
+            bool stop = false;
+            std::atomic<bool> load_failed = false;
+            std::atomic<std::uint64_t> n_jobs = 0;
+            std::atomic<std::uint64_t> n_bytes = 0;
+        };
+
+    } // namespace gl
+} // namespace mplot
@@ -9,14 +9,18 @@
 #include <stdexcept>
 #include <string>
 #include <iostream>
+#include <cstddef>
+#include <mplot/VisualCommon.h>
+#include <mplot/gl/error_policy.h>
 
 namespace mplot {
     namespace gl {
         //! A GL error checking function. The additional namespace was a class, but didn't need to be.
         namespace Util {
-            GLenum checkError (const char *file, int line, GladGLContext* glfn)
+            inline GLenum checkError (const char *file, int line, GladGLContext* glfn)
             {
                 GLenum errorCode = 0;
+                if (!mplot::gl::poll_errors) { return errorCode; } // see error_policy.h
 #ifndef __APPLE__ // MacOS didn't like multiple calls to glGetError(); don't know why
                 unsigned int ecount = 0;
                 std::string error;
@@ -72,6 +76,53 @@ namespace mplot {
 #endif
                 return errorCode;
             }
+
+            //! If checkError does not poll (see error_policy.h), report GL errors through a debug
+            //! message callback, where the context has one. Returns true if the callback is set.
+            inline bool enable_debug_output (GladGLContext* glfn)
+            {
+                if (mplot::gl::poll_errors || glfn->DebugMessageCallback == nullptr) { return false; }
+                glfn->Enable (GL_DEBUG_OUTPUT);
+                glfn->DebugMessageCallback (&mplot::gl::debug_message, nullptr);
+                return true;
+            }
+
+            //! Use the shader program prog, unless state records that it is already in use
+            inline void use_program (mplot::visgl::render_state& state, const GLuint prog, GladGLContext* glfn)
+            {
+                if (state.program == prog) { return; }
+                glfn->UseProgram (prog);
+                state.program = prog;
+            }
+
+            //! Bind the vertex array object vao, unless state records that it is already bound
+            inline void bind_vao (mplot::visgl::render_state& state, const GLuint vao, GladGLContext* glfn)
+            {
+                if (state.vao == vao) { return; }
+                glfn->BindVertexArray (vao);
+                state.vao = vao;
+            }
+
+            //! Enable or disable GL_BLEND, unless state records that it is already set so
+            inline void set_blend (mplot::visgl::render_state& state, const bool enable, GladGLContext* glfn)
+            {
+                const unsigned int b = enable ? 1u : 0u;
+                if (state.blend == b) { return; }
+                if (enable) { glfn->Enable (GL_BLEND); } else { glfn->Disable (GL_BLEND); }
+                state.blend = b;
+            }
+
+            //! The size in bytes of the data store of the buffer buf (0 if buf is 0). Binds buf to,
+            //! and then unbinds, GL_COPY_READ_BUFFER.
+            inline std::size_t buffer_bytes (const GLuint buf, GladGLContext* glfn)
+            {
+                if (buf == 0) { return 0u; }
+                GLint64 sz = 0;
+                glfn->BindBuffer (GL_COPY_READ_BUFFER, buf);
+                glfn->GetBufferParameteri64v (GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &sz);
+                glfn->BindBuffer (GL_COPY_READ_BUFFER, 0);
+                return sz > 0 ? static_cast<std::size_t>(sz) : 0u;
+            }
         } // namespace Util
     } // namespace gl
 } // namespace
@@ -67,6 +67,52 @@ namespace mplot {
             {
                 return (((gl_version_number >> 30) & 0x1) > 0x0) ? true : false;
             }
+            // True if this is a desktop OpenGL version of at least _major._minor (false for OpenGL ES)
+            static bool constexpr at_least (const int gl_version_number, const int _major, const int _minor)
+            {
+                return !version::gles (gl_version_number)
+                && (version::major (gl_version_number) > _major
+                    || (version::major (gl_version_number) == _major && version::minor (gl_version_number) >= _minor));
+            }
+            // True if this is an OpenGL ES version of at least _major._minor
+            static bool constexpr es_at_least (const int gl_version_number, const int _major, const int _minor)
+            {
+                return version::gles (gl_version_number)
+                && (version::major (gl_version_number) > _major
+                    || (version::major (gl_version_number) == _major && version::minor (gl_version_number) >= _minor));
+            }
+
+            /*
+             * The features that mathplot's faster paths need, and the versions that have them. macOS
+             * offers no more than OpenGL 4.1, which has none of the first four, so on a Mac these
+             * paths fall back to the ones that every version has (see features_string).
+             */
+
+            // Compute shaders and shader storage buffers (OpenGL 4.3, OpenGL ES 3.1)
+            static bool constexpr compute (const int gl_version_number)
+            {
+                return version::at_least (gl_version_number, 4, 3) || version::es_at_least (gl_version_number, 3, 1);
+            }
+            // Persistently mapped buffers, from glBufferStorage (OpenGL 4.4)
+            static bool constexpr buffer_storage (const int gl_version_number)
+            {
+                return version::at_least (gl_version_number, 4, 4);
+            }
+            // glMultiDrawElementsIndirect (OpenGL 4.3)
+            static bool constexpr multi_draw_indirect (const int gl_version_number)
+            {
+                return version::at_least (gl_version_number, 4, 3);
+            }
+            // glDebugMessageCallback (OpenGL 4.3, OpenGL ES 3.2)
+            static bool constexpr debug_output (const int gl_version_number)
+            {
+                return version::at_least (gl_version_number, 4, 3) || version::es_at_least (gl_version_number, 3, 2);
+            }
+            // glInvalidateFramebuffer (OpenGL 4.3, OpenGL ES 3.0)
+            static bool constexpr invalidate_framebuffer (const int gl_version_number)
+            {
+                return version::at_least (gl_version_number, 4, 3) || version::gles (gl_version_number);
+            }
             // Output a string describing the version number
             static inline std::string vstring (const int gl_version_number)
             {
@@ -80,6 +126,27 @@ namespace mplot {
                 }
                 return v;
             }
+            // List the features above that the version lacks, and what mathplot does without them
+            static inline std::string features_string (const int gl_version_number)
+            {
+                std::string f;
+                if (!version::compute (gl_version_number)) {
+                    f += "No compute shaders: compute_manager, GPU meshes (setGpuMesh) and jump flooding are unavailable\n";
+                }
+                if (!version::buffer_storage (gl_version_number)) {
+                    f += "No persistent mapping: streaming models orphan and refill their buffers on each upload\n";
+                }
+                if (!version::multi_draw_indirect (gl_version_number)) {
+                    f += "No multi-draw indirect: batched models (setBatched) are drawn one by one\n";
+                }
+                if (!version::debug_output (gl_version_number)) {
+                    f += "No debug output: GL errors are found by polling glGetError\n";
+                }
+                if (!version::invalidate_framebuffer (gl_version_number)) {
+                    f += "No glInvalidateFramebuffer: tiledGpuProfile can't discard depth and stencil\n";
+                }
+                return f.empty() ? std::string("OpenGL ") + version::vstring (gl_version_number) + " has all the features that mathplot uses\n" : f;
+            }
             // Return the version-specific shader preamble as a const char* from a constexpr function
             static constexpr const char* shaderpreamble (const int gl_version_number)
             {
@@ -0,0 +1,326 @@
+/*!
+ * \file
+ *
+ * A glb_animation writes the frames of one model to a single binary glTF (.glb) file, as they
+ * are captured (see VisualBase::startAnimationExport). The indices, positions, colours and
+ * normals of the first frame are written once. Each frame is then a morph target that holds the
+ * change of the colours (and, if asked, of the positions) from the first frame, and an
+ * animation with STEP interpolation sets the weight of frame k's target to 1 at time t_k and
+ * every other weight to 0.
+ *
+ * Frames are written to a spool file as they arrive, so only the first frame is held in
+ * memory. finish() writes the JSON chunk, which can only be known once the last frame is in,
+ * and then copies the spooled binary chunk after it.
+ *
+ * Morphed colours (COLOR_0 in a morph target) are optional in glTF 2.0. three.js and the Khronos
+ * sample viewer support them; a viewer that does not will show the first frame's colours.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <array>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+#include <system_error>
+#include <stdexcept>
+#include <algorithm>
+#include <limits>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <sm/vec>
+#include <mplot/version.h>
+
+namespace mplot {
+
+    //! How a glb_animation writes its frames
+    struct glb_animation_options
+    {
+        //! Store the change in the positions of each frame, as well as of the colours, for a model whose shape changes
+        bool positions = false;
+        //! The file to spool the binary data to while frames are added. If empty, the glb file's name with ".part" appended.
+        std::string spool_file = "";
+    };
+
+    class glb_animation
+    {
+    public:
+        glb_animation (const std::string& _glb_file, const glb_animation_options& _opts = {})
+            : glb_file (_glb_file), opts (_opts)
+        {
+            if constexpr (std::endian::native != std::endian::little) {
+                throw std::runtime_error ("mplot::glb_animation: glb data are little-endian, and this host is not");
+            }
+            if (this->opts.spool_file.empty()) { this->opts.spool_file = this->glb_file + ".part"; }
+            this->spool.open (this->opts.spool_file, std::ios::out | std::ios::trunc | std::ios::binary);
+            if (!this->spool.is_open()) { throw std::runtime_error ("mplot::glb_animation: Failed to open the spool file for writing"); }
+        }
+
+        //! Finish the file, if finish() has not been called
+        ~glb_animation()
+        {
+            try { this->finish(); } catch (const std::exception& e) { std::cerr << "mplot::glb_animation: " << e.what() << std::endl; }
+        }
+
+        glb_animation (const glb_animation&) = delete;
+        glb_animation& operator= (const glb_animation&) = delete;
+
+        /*!
+         * Add a frame at time t (in seconds) of a model with three floats per vertex of
+         * positions, colours and normals, three indices per triangle, and the translation of
+         * its node. The first frame's data are all written. The later frames must have the same
+         * numbers of vertices and indices, and only their colours (and positions) are written.
+         */
+        void add_frame (const float t, const std::vector<std::uint32_t>& indices, const std::vector<float>& positions,
+                        const std::vector<float>& colours, const std::vector<float>& normals,
+                        const sm::vec<float, 3>& translation = { 0.0f, 0.0f, 0.0f })
+        {
+            if (this->finished) { throw std::runtime_error ("mplot::glb_animation::add_frame: the file is finished"); }
+            if (positions.size() % 3u != 0u || colours.size() != positions.size() || normals.size() != positions.size()) {
+                throw std::runtime_error ("mplot::glb_animation::add_frame: Expect positions, colours and normals all to have the same size");
+            }
+            if (!this->times.empty() && !(t > this->times.back())) {
+                throw std::runtime_error ("mplot::glb_animation::add_frame: frame times must increase");
+            }
+
+            if (this->times.empty()) {
+                this->n_vertices = positions.size() / 3u;
+                this->n_indices = indices.size();
+                this->translation = translation;
+                this->base_positions = positions;
+                this->base_colours = colours;
+                this->base_pmin = this->bounds (positions, true);
+                this->base_pmax = this->bounds (positions, false);
+                this->write (indices.data(), 4u * indices.size());
+                this->write (positions.data(), 4u * positions.size());
+                this->write (colours.data(), 4u * colours.size());
+                this->write (normals.data(), 4u * normals.size());
+            } else if (positions.size() / 3u != this->n_vertices || indices.size() != this->n_indices) {
+                throw std::runtime_error ("mplot::glb_animation::add_frame: the model's mesh has changed since the first frame");
+            }
+
+            // Frame deltas, written through one block
+            this->delta.resize (positions.size());
+            for (std::size_t i = 0u; i < colours.size(); ++i) { this->delta[i] = colours[i] - this->base_colours[i]; }
+            this->write (this->delta.data(), 4u * this->delta.size());
+            if (this->opts.positions) {
+                for (std::size_t i = 0u; i < positions.size(); ++i) { this->delta[i] = positions[i] - this->base_positions[i]; }
+                this->dmin.push_back (this->bounds (this->delta, true));
+                this->dmax.push_back (this->bounds (this->delta, false));
+                this->write (this->delta.data(), 4u * this->delta.size());
+            }
+            this->times.push_back (t);
+        }
+
+        //! The number of frames added
+        std::size_t frames() const { return this->times.size(); }
+
+        //! The number of bytes spooled so far
+        std::size_t spooled_bytes() const { return this->bin_bytes; }
+
+        /*!
+         * Write the glb file from the frames added so far and remove the spool file. Nothing is
+         * written if no frame was added. Calls after the first do nothing.
+         */
+        void finish()
+        {
+            if (this->finished) { return; }
+            this->finished = true;
+            const std::size_t nf = this->times.size();
+            if (nf > 0u) {
+                // The animation's input (the times) and output (one weight per target per time)
+                this->write (this->times.data(), 4u * nf);
+                std::vector<float> w (nf, 0.0f);
+                for (std::size_t k = 0u; k < nf; ++k) {
+                    w[k] = 1.0f;
+                    this->write (w.data(), 4u * nf);
+                    w[k] = 0.0f;
+                }
+            }
+            this->spool.close();
+            std::error_code ec;
+            if (!this->spool_good) {
+                std::filesystem::remove (this->opts.spool_file, ec);
+                throw std::runtime_error ("mplot::glb_animation::finish: Failed to write the spool file");
+            }
+            if (nf == 0u) {
+                std::filesystem::remove (this->opts.spool_file, ec);
+                return;
+            }
+            try {
+                this->write_glb();
+            } catch (const std::exception&) {
+                std::filesystem::remove (this->opts.spool_file, ec);
+                throw;
+            }
+            std::filesystem::remove (this->opts.spool_file, ec);
+        }
+
+    private:
+        void write (const void* d, const std::size_t n)
+        {
+            this->spool.write (static_cast<const char*>(d), static_cast<std::streamsize>(n));
+            this->bin_bytes += n;
+            if (!this->spool.good()) { this->spool_good = false; }
+        }
+
+        //! The minimum (or maximum) of each of the three components of v
+        static sm::vec<float, 3> bounds (const std::vector<float>& v, const bool min)
+        {
+            sm::vec<float, 3> b = { 0.0f, 0.0f, 0.0f };
+            if (v.empty()) { return b; }
+            b = { v[0], v[1], v[2] };
+            for (std::size_t i = 3u; i < v.size(); i += 3u) {
+                for (unsigned int c = 0u; c < 3u; ++c) { b[c] = min ? std::min (b[c], v[i + c]) : std::max (b[c], v[i + c]); }
+            }
+            return b;
+        }
+
+        //! v as a JSON array, with all the digits of each float (so that bounds hold what they bound)
+        static std::string vec_str (const sm::vec<float, 3>& v)
+        {
+            std::ostringstream ss;
+            ss << std::setprecision (std::numeric_limits<float>::max_digits10) << "[ " << v[0] << ", " << v[1] << ", " << v[2] << " ]";
+            return ss.str();
+        }
+
+        //! The JSON chunk. The binary chunk's layout is as add_frame and finish spool it.
+        std::string json() const
+        {
+            const std::size_t nf = this->times.size();
+            const std::size_t nv = this->n_vertices;
+            const std::size_t vb = 12u * nv;
+            // Morph target attributes per frame (colours, and maybe positions)
+            const std::size_t per_frame = this->opts.positions ? 2u : 1u;
+
+            std::ostringstream js;
+            js << "{\n  \"scenes\" : [ { \"nodes\" : [ 0 ] } ],\n  \"scene\" : 0,\n";
+            js << "  \"nodes\" : [ { \"mesh\" : 0, \"translation\" : " << glb_animation::vec_str (this->translation) << " } ],\n";
+
+            // Accessors: 0 indices, 1-3 the first frame's position, colour and normal, then the
+            // targets, then the animation's times and weights.
+            js << "  \"meshes\" : [ { \"primitives\" : [ { \"attributes\" : { \"POSITION\" : 1, \"COLOR_0\" : 2, \"NORMAL\" : 3 }, "
+               << "\"indices\" : 0, \"material\" : 0, \"targets\" : [\n";
+            for (std::size_t k = 0u; k < nf; ++k) {
+                const std::size_t a = 4u + per_frame * k;
+                js << "      { \"COLOR_0\" : " << a;
+                if (this->opts.positions) { js << ", \"POSITION\" : " << a + 1u; }
+                js << " }" << (k + 1u < nf ? ",\n" : "\n");
+            }
+            js << "    ] } ], \"weights\" : [ ";
+            for (std::size_t k = 0u; k < nf; ++k) { js << (k == 0u ? "1" : "0") << (k + 1u < nf ? ", " : ""); }
+            js << " ] } ],\n";
+
+            const std::size_t acc_times = 4u + per_frame * nf;
+            js << "  \"animations\" : [ { \"channels\" : [ { \"sampler\" : 0, \"target\" : { \"node\" : 0, \"path\" : \"weights\" } } ],\n"
+               << "    \"samplers\" : [ { \"input\" : " << acc_times << ", \"output\" : " << acc_times + 1u
+               << ", \"interpolation\" : \"STEP\" } ] } ],\n";
+
+            js << "  \"buffers\" : [ { \"byteLength\" : " << this->bin_bytes << " } ],\n";
+
+            // bufferViews in the order of the spool, one per accessor
+            js << "  \"bufferViews\" : [\n";
+            std::size_t offset = 0u;
+            auto view = [&js, &offset](const std::size_t bytes, const int target, const bool last = false) {
+                js << "    { \"buffer\" : 0, \"byteOffset\" : " << offset << ", \"byteLength\" : " << bytes;
+                if (target != 0) { js << ", \"target\" : " << target; }
+                js << (last ? " }\n" : " },\n");
+                offset += bytes;
+            };
+            view (4u * this->n_indices, 34963);
+            for (unsigned int a = 0u; a < 3u; ++a) { view (vb, 34962); }
+            for (std::size_t k = 0u; k < per_frame * nf; ++k) { view (vb, 34962); }
+            view (4u * nf, 0);
+            view (4u * nf * nf, 0, true);
+            js << "  ],\n";
+
+            js << "  \"accessors\" : [\n";
+            js << "    { \"bufferView\" : 0, \"componentType\" : 5125, \"type\" : \"SCALAR\", \"count\" : " << this->n_indices << " },\n";
+            js << "    { \"bufferView\" : 1, \"componentType\" : 5126, \"type\" : \"VEC3\", \"count\" : " << nv
+               << ", \"max\" : " << glb_animation::vec_str (this->base_pmax) << ", \"min\" : " << glb_animation::vec_str (this->base_pmin) << " },\n";
+            js << "    { \"bufferView\" : 2, \"componentType\" : 5126, \"type\" : \"VEC3\", \"count\" : " << nv << " },\n";
+            js << "    { \"bufferView\" : 3, \"componentType\" : 5126, \"type\" : \"VEC3\", \"count\" : " << nv << " },\n";
+            for (std::size_t k = 0u; k < nf; ++k) {
+                const std::size_t a = 4u + per_frame * k;
+                js << "    { \"bufferView\" : " << a << ", \"componentType\" : 5126, \"type\" : \"VEC3\", \"count\" : " << nv << " },\n";
+                if (this->opts.positions) {
+                    // Morph target positions, like the base positions, need their bounds
+                    js << "    { \"bufferView\" : " << a + 1u << ", \"componentType\" : 5126, \"type\" : \"VEC3\", \"count\" : " << nv
+                       << ", \"max\" : " << glb_animation::vec_str (this->dmax[k]) << ", \"min\" : " << glb_animation::vec_str (this->dmin[k]) << " },\n";
+                }
+            }
+            js << "    { \"bufferView\" : " << acc_times << ", \"componentType\" : 5126, \"type\" : \"SCALAR\", \"count\" : " << nf
+               << std::setprecision (std::numeric_limits<float>::max_digits10)
+               << ", \"max\" : [ " << this->times.back() << " ], \"min\" : [ " << this->times.front() << " ] },\n";
+            js << "    { \"bufferView\" : " << acc_times + 1u << ", \"componentType\" : 5126, \"type\" : \"SCALAR\", \"count\" : " << nf * nf << " }\n";
+            js << "  ],\n";
+
+            js << "  \"materials\" : [ { \"doubleSided\" : true } ],\n";
+            js << "  \"asset\" : {\n"
+               << "    \"generator\" : \"https://github.com/ABRG-Models/mplotologica: mplot::glb_animation (ver "
+               << mplot::version_string() << ")\",\n"
+               << "    \"version\" : \"2.0\"\n"
+               << "  }\n}\n";
+            return js.str();
+        }
+
+        //! Write the glb file: its header and JSON chunk, then the spool file as its binary chunk
+        void write_glb() const
+        {
+            std::string js = this->json();
+            while (js.size() % 4u != 0u) { js += ' '; }
+            const std::size_t total = 12u + 8u + js.size() + 8u + this->bin_bytes;
+            if (total > std::numeric_limits<std::uint32_t>::max()) {
+                throw std::runtime_error ("mplot::glb_animation: The animation is too large for a glb file (over 4 GB)");
+            }
+            std::ifstream bin (this->opts.spool_file, std::ios::in | std::ios::binary);
+            if (!bin.is_open()) { throw std::runtime_error ("mplot::glb_animation: Failed to reopen the spool file"); }
+            std::ofstream fout (this->glb_file, std::ios::out | std::ios::trunc | std::ios::binary);
+            if (!fout.is_open()) { throw std::runtime_error ("mplot::glb_animation: Failed to open file for writing"); }
+            auto put32 = [&fout](const std::size_t u) {
+                const std::uint32_t u32 = static_cast<std::uint32_t>(u);
+                fout.write (reinterpret_cast<const char*>(&u32), sizeof (u32));
+            };
+            put32 (0x46546c67u); // "glTF"
+            put32 (2u);
+            put32 (total);
+            put32 (js.size());
+            put32 (0x4e4f534au); // "JSON"
+            fout.write (js.data(), static_cast<std::streamsize>(js.size()));
+            put32 (this->bin_bytes);
+            put32 (0x004e4942u); // "BIN"
+            fout << bin.rdbuf();
+            if (!fout.good()) { throw std::runtime_error ("mplot::glb_animation: Failed to write the file"); }
+        }
+
+        std::string glb_file;
+        glb_animation_options opts;
+        std::ofstream spool;
+        bool spool_good = true;
+        bool finished = false;
+        std::size_t bin_bytes = 0u;
+
+        std::size_t n_vertices = 0u;
+        std::size_t n_indices = 0u;
+        sm::vec<float, 3> translation = { 0.0f, 0.0f, 0.0f };
+        //! The first frame's positions and colours, from which each frame's change is found
+        std::vector<float> base_positions;
+        std::vector<float> base_colours;
+        sm::vec<float, 3> base_pmin = { 0.0f, 0.0f, 0.0f };
+        sm::vec<float, 3> base_pmax = { 0.0f, 0.0f, 0.0f };
+        //! The bounds of each frame's change of position (if opts.positions)
+        std::vector<sm::vec<float, 3>> dmin;
+        std::vector<sm::vec<float, 3>> dmax;
+        std::vector<float> times;
+        std::vector<float> delta;
+    };
+
+} // namespace mplot
@@ -0,0 +1,173 @@
+/*!
+ * \file
+ *
+ * Read the meshes in a binary glTF (.glb) file, such as one written by Visual::saveglb, without
+ * copying them. The file is memory mapped and each mesh is presented as pointers to its indices
+ * and vertex data in the mapped binary chunk. VisualModel::setMappedMesh uploads the data
+ * straight from the mapping into the model's vertex buffers (see MeshFileVisual).
+ *
+ * Only meshes with uint32 indices and tightly packed float VEC3 positions, normals and colours
+ * can be mapped. That is the (non-interleaved) layout of the files that Visual::saveglb writes,
+ * which is also the layout of a VisualModel's vertex buffers.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <string>
+#include <memory>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <bit>
+
+#include <nlohmann/json.hpp>
+#include <sm/vec>
+#include <mplot/mapped_file.h>
+
+namespace mplot {
+
+    //! One mesh in a memory mapped file. The pointers are valid for as long as file is held.
+    struct mapped_mesh
+    {
+        //! Holds the file mapped
+        std::shared_ptr<const mplot::mapped_file> file;
+        //! The indices (three per triangle)
+        const std::uint32_t* indices = nullptr;
+        std::size_t n_indices = 0;
+        //! Three floats per vertex in each of positions, normals and colours
+        const float* positions = nullptr;
+        const float* normals = nullptr;
+        const float* colours = nullptr;
+        std::size_t n_vertices = 0;
+        //! The translation of the node that places the mesh in the scene (Visual::saveglb writes mv_offset here)
+        sm::vec<float, 3> translation = { 0.0f, 0.0f, 0.0f };
+
+        //! With no file but with n_vertices, a mesh that is written on the GPU (see VisualModel::setDeviceMesh)
+        bool empty() const { return this->file == nullptr && this->n_vertices == 0; }
+    };
+
+    //! A memory mapped .glb file
+    class glb_file
+    {
+    public:
+        glb_file (const std::string& path)
+            : filepath (path), file (std::make_shared<const mplot::mapped_file> (path, true))
+        {
+            if constexpr (std::endian::native != std::endian::little) {
+                throw std::runtime_error ("glb_file: glb data are little-endian, and this host is not");
+            }
+            const unsigned char* d = this->file->data();
+            const std::size_t sz = this->file->size();
+            // 12 byte header, then the JSON chunk and the binary chunk, each with an 8 byte chunk header
+            if (sz < 20 || this->get32 (0) != 0x46546c67u || this->get32 (4) != 2u) {
+                throw std::runtime_error ("glb_file: " + path + " is not a version 2 glb file");
+            }
+            const std::size_t json_len = this->get32 (12);
+            if (this->get32 (16) != 0x4e4f534au || 20 + json_len > sz) {
+                throw std::runtime_error ("glb_file: " + path + " does not begin with a JSON chunk");
+            }
+            this->gltf = nlohmann::json::parse (d + 20, d + 20 + json_len);
+            const std::size_t bin_chunk = 20 + json_len;
+            if (bin_chunk + 8 <= sz && this->get32 (bin_chunk + 4) == 0x004e4942u) {
+                this->bin_offset = bin_chunk + 8;
+                this->bin_bytes = this->get32 (bin_chunk);
+                if (this->bin_offset + this->bin_bytes > sz) {
+                    throw std::runtime_error ("glb_file: " + path + " is truncated");
+                }
+            }
+        }
+
+        //! The number of meshes in the file
+        std::size_t num_meshes() const
+        {
+            return this->gltf.contains ("meshes") ? this->gltf["meshes"].size() : 0u;
+        }
+
+        //! Get mesh m (its first primitive)
+        mapped_mesh mesh (const std::size_t m) const
+        {
+            if (m >= this->num_meshes()) {
+                throw std::runtime_error ("glb_file: " + this->filepath + " has no mesh " + std::to_string (m));
+            }
+            const nlohmann::json& prim = this->gltf["meshes"][m]["primitives"].at (0);
+            const nlohmann::json& attr = prim.at ("attributes");
+            if (!prim.contains ("indices") || !attr.contains ("POSITION") || !attr.contains ("NORMAL") || !attr.contains ("COLOR_0")) {
+                throw std::runtime_error ("glb_file: mesh " + std::to_string (m) + " needs indices, POSITION, NORMAL and COLOR_0");
+            }
+            mapped_mesh mm;
+            mm.file = this->file;
+            std::size_t count = 0;
+            mm.indices = static_cast<const std::uint32_t*>(this->accessor_data (prim["indices"].get<std::size_t>(), 5125, "SCALAR", 4, count));
+            mm.n_indices = count;
+            mm.positions = static_cast<const float*>(this->accessor_data (attr["POSITION"].get<std::size_t>(), 5126, "VEC3", 12, mm.n_vertices));
+            mm.normals = static_cast<const float*>(this->accessor_data (attr["NORMAL"].get<std::size_t>(), 5126, "VEC3", 12, count));
+            if (count != mm.n_vertices) { throw std::runtime_error ("glb_file: mesh " + std::to_string (m) + " has unequal numbers of positions and normals"); }
+            mm.colours = static_cast<const float*>(this->accessor_data (attr["COLOR_0"].get<std::size_t>(), 5126, "VEC3", 12, count));
+            if (count != mm.n_vertices) { throw std::runtime_error ("glb_file: mesh " + std::to_string (m) + " has unequal numbers of positions and colours"); }
+
+            // The translation of the first node that uses the mesh
+            if (this->gltf.contains ("nodes")) {
+                for (const auto& node : this->gltf["nodes"]) {
+                    if (node.contains ("mesh") && node["mesh"].get<std::size_t>() == m) {
+                        if (node.contains ("translation")) {
+                            for (unsigned int i = 0; i < 3; ++i) { mm.translation[i] = node["translation"].at (i).get<float>(); }
+                        }
+                        break;
+                    }
+                }
+            }
+            return mm;
+        }
+
+    private:
+        //! Read the little-endian uint32 at byte offset o
+        std::uint32_t get32 (const std::size_t o) const
+        {
+            std::uint32_t u = 0;
+            std::memcpy (&u, this->file->data() + o, sizeof u);
+            return u;
+        }
+
+        /*!
+         * Return a pointer to the data of accessor a, checking that it has the given component
+         * type and type, and that its elements are tightly packed (elsz bytes apart), 4 byte
+         * aligned and lie within the binary chunk. count is set to the accessor's count.
+         */
+        const void* accessor_data (const std::size_t a, const int component_type, const std::string& type,
+                                   const std::size_t elsz, std::size_t& count) const
+        {
+            const nlohmann::json& acc = this->gltf.at ("accessors").at (a);
+            const std::string as = "glb_file: accessor " + std::to_string (a);
+            if (acc.at ("componentType").get<int>() != component_type || acc.at ("type").get<std::string>() != type) {
+                throw std::runtime_error (as + " is not of the type that a VisualModel buffer needs");
+            }
+            count = acc.at ("count").get<std::size_t>();
+            if (!acc.contains ("bufferView")) { throw std::runtime_error (as + " has no bufferView"); }
+            const nlohmann::json& bv = this->gltf.at ("bufferViews").at (acc["bufferView"].get<std::size_t>());
+            if (bv.value ("buffer", 0) != 0 || this->bin_offset == 0) {
+                throw std::runtime_error (as + " is not in the glb binary chunk");
+            }
+            if (bv.contains ("byteStride") && bv["byteStride"].get<std::size_t>() != elsz) {
+                throw std::runtime_error (as + " is interleaved (save the glb without interleaving to map it)");
+            }
+            const std::size_t offset = bv.value ("byteOffset", std::size_t{0}) + acc.value ("byteOffset", std::size_t{0});
+            if (offset % 4 != 0 || offset + count * elsz > this->bin_bytes
+                || offset + count * elsz > bv.value ("byteOffset", std::size_t{0}) + bv.at ("byteLength").get<std::size_t>()) {
+                throw std::runtime_error (as + " is misaligned or out of range");
+            }
+            return this->file->data() + this->bin_offset + offset;
+        }
+
+        std::string filepath;
+        std::shared_ptr<const mplot::mapped_file> file;
+        nlohmann::json gltf;
+        //! The offset and size of the binary chunk's data in the file
+        std::size_t bin_offset = 0;
+        std::size_t bin_bytes = 0;
+    };
+
+} // namespace mplot
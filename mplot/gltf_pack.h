@@ -0,0 +1,330 @@
+/*!
+ * \file
+ *
+ * Pack a model's mesh for a smaller glTF export (see Visual::saveglb with mplot::gltf_options).
+ *
+ * With quantize, the attributes are stored as KHR_mesh_quantization allows: positions as int16
+ * (with a node scale and translation that map them back into the model's frame), normals as
+ * normalized int8 and colours as normalized uint8. That is 16 bytes per vertex, rather than 36.
+ * Indices are stored as uint16 whenever there are few enough vertices.
+ *
+ * With reorder, the triangles are put in an order that reuses the post-transform vertex cache
+ * (the 'Tipsify' algorithm of Sander, Nehab and Barczak, 2007) and the vertices are then
+ * renumbered in the order that the triangles first use them, so that vertex fetches run
+ * forward through memory. Vertices that no triangle uses are dropped.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <ostream>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace mplot {
+
+    //! How Visual::saveglb writes the models' meshes
+    struct gltf_options
+    {
+        //! Interleave each model's positions, colours and normals in one buffer view (float data only)
+        bool interleaved = false;
+        //! Store the vertices with KHR_mesh_quantization: int16 positions, int8 normals and uint8 colours
+        bool quantize = false;
+        //! Reorder the triangles and vertices for the vertex cache and for vertex fetch
+        bool reorder = false;
+        //! The number of vertices in the cache that reorder optimizes for
+        unsigned int cache_size = 16;
+    };
+
+    //! glTF accessor component types
+    namespace gltf_component {
+        constexpr unsigned int byte = 5120;
+        constexpr unsigned int unsigned_byte = 5121;
+        constexpr unsigned int short_int = 5122;
+        constexpr unsigned int unsigned_short = 5123;
+        constexpr unsigned int unsigned_int = 5125;
+        constexpr unsigned int float_type = 5126;
+    }
+
+    /*!
+     * Reorder the triangles in indices (three per triangle, of n_vertices vertices) for a
+     * post-transform vertex cache of cache_size entries.
+     */
+    inline void gltf_optimize_vertex_cache (std::vector<std::uint32_t>& indices, const std::size_t n_vertices,
+                                            const unsigned int cache_size = 16)
+    {
+        const std::size_t n_tris = indices.size() / 3u;
+        if (n_tris == 0u || n_vertices == 0u) { return; }
+        // The triangles that use each vertex
+        std::vector<std::uint32_t> live (n_vertices, 0u);
+        for (std::size_t i = 0u; i < 3u * n_tris; ++i) { ++live[indices[i]]; }
+        std::vector<std::uint32_t> first (n_vertices + 1u, 0u);
+        for (std::size_t v = 0u; v < n_vertices; ++v) { first[v + 1u] = first[v] + live[v]; }
+        std::vector<std::uint32_t> adj (first[n_vertices]);
+        {
+            std::vector<std::uint32_t> fill (first.begin(), first.end() - 1);
+            for (std::size_t t = 0u; t < n_tris; ++t) {
+                for (unsigned int c = 0u; c < 3u; ++c) { adj[fill[indices[3u * t + c]]++] = static_cast<std::uint32_t>(t); }
+            }
+        }
+
+        const std::int64_t k = cache_size;
+        std::vector<std::int64_t> stamp (n_vertices, 0);
+        std::vector<std::uint8_t> emitted (n_tris, 0u);
+        std::vector<std::uint32_t> dead_end;
+        std::vector<std::uint32_t> candidates;
+        std::vector<std::uint32_t> out;
+        out.reserve (3u * n_tris);
+        std::int64_t s = k + 1;
+        std::size_t cursor = 1u;
+        std::int64_t f = 0;
+
+        while (f >= 0) {
+            candidates.clear();
+            for (std::uint32_t a = first[f]; a < first[f + 1]; ++a) {
+                const std::uint32_t t = adj[a];
+                if (emitted[t]) { continue; }
+                for (unsigned int c = 0u; c < 3u; ++c) {
+                    const std::uint32_t v = indices[3u * t + c];
+                    out.push_back (v);
+                    dead_end.push_back (v);
+                    candidates.push_back (v);
+                    --live[v];
+                    if (s - stamp[v] > k) { stamp[v] = s++; }
+                }
+                emitted[t] = 1u;
+            }
+            // The next fanning vertex: the candidate that will still be in the cache after its
+            // triangles are emitted and has been in it longest
+            std::int64_t best = -1;
+            std::int64_t best_p = -1;
+            for (const std::uint32_t v : candidates) {
+                if (live[v] == 0u) { continue; }
+                std::int64_t p = 0;
+                if (s - stamp[v] + 2 * static_cast<std::int64_t>(live[v]) <= k) { p = s - stamp[v]; }
+                if (p > best_p) { best_p = p; best = v; }
+            }
+            if (best == -1) {
+                // A dead end: take a recent vertex with triangles left, or else the next in order
+                while (!dead_end.empty()) {
+                    const std::uint32_t d = dead_end.back();
+                    dead_end.pop_back();
+                    if (live[d] > 0u) { best = d; break; }
+                }
+                while (best == -1 && cursor < n_vertices) {
+                    if (live[cursor] > 0u) { best = static_cast<std::int64_t>(cursor); }
+                    ++cursor;
+                }
+            }
+            f = best;
+        }
+        indices.swap (out);
+    }
+
+    /*!
+     * Renumber the vertices in the order in which indices first uses them, rewriting indices.
+     * Returns, for each new vertex, the old vertex that it copies. Unused vertices are dropped.
+     */
+    inline std::vector<std::uint32_t> gltf_optimize_vertex_fetch (std::vector<std::uint32_t>& indices, const std::size_t n_vertices)
+    {
+        constexpr std::uint32_t unset = std::numeric_limits<std::uint32_t>::max();
+        std::vector<std::uint32_t> remap (n_vertices, unset);
+        std::vector<std::uint32_t> order;
+        order.reserve (n_vertices);
+        for (auto& i : indices) {
+            if (remap[i] == unset) {
+                remap[i] = static_cast<std::uint32_t>(order.size());
+                order.push_back (i);
+            }
+            i = remap[i];
+        }
+        return order;
+    }
+
+    /*!
+     * The average number of vertex cache misses per triangle (the ACMR) of indices with a FIFO
+     * cache of cache_size entries. 3 is the worst; a regular grid can approach 0.5.
+     */
+    inline double gltf_acmr (const std::vector<std::uint32_t>& indices, const std::size_t n_vertices, const unsigned int cache_size = 16)
+    {
+        if (indices.size() < 3u) { return 0.0; }
+        // The time at which each vertex entered the cache; it is still there if fewer than
+        // cache_size misses have happened since
+        std::vector<std::int64_t> entered (n_vertices, std::numeric_limits<std::int64_t>::min() / 2);
+        std::int64_t misses = 0;
+        for (const auto i : indices) {
+            if (misses - entered[i] >= static_cast<std::int64_t>(cache_size)) { entered[i] = misses++; }
+        }
+        return static_cast<double>(misses) / static_cast<double>(indices.size() / 3u);
+    }
+
+    //! A model's mesh packed for a glTF buffer
+    struct gltf_packed_mesh
+    {
+        //! One vertex attribute: its bytes, component type, and stride (bytes from one vertex to the next)
+        struct attribute
+        {
+            std::vector<unsigned char> data;
+            unsigned int component_type = gltf_component::float_type;
+            bool normalized = false;
+            unsigned int stride = 12u;
+        };
+
+        std::size_t n_vertices = 0u;
+        std::size_t n_indices = 0u;
+        //! The indices, padded to a multiple of 4 bytes
+        std::vector<unsigned char> indices;
+        unsigned int index_type = gltf_component::unsigned_int;
+        attribute position;
+        attribute colour;
+        attribute normal;
+        //! The bounds of the stored positions (in the stored units), which glTF requires
+        std::array<float, 3> pos_min = { 0.0f, 0.0f, 0.0f };
+        std::array<float, 3> pos_max = { 0.0f, 0.0f, 0.0f };
+        //! The model frame position of a stored position q is offset + scale * q
+        float scale = 1.0f;
+        std::array<float, 3> offset = { 0.0f, 0.0f, 0.0f };
+        bool quantized = false;
+
+        //! The bytes of the index view and of the three attribute views
+        std::size_t index_bytes() const { return this->indices.size(); }
+        std::size_t bytes() const
+        {
+            return this->indices.size() + this->position.data.size() + this->colour.data.size() + this->normal.data.size();
+        }
+
+        //! Write the indices, positions, colours and normals, in that order
+        void write (std::ostream& bin) const
+        {
+            for (const auto* d : { &this->indices, &this->position.data, &this->colour.data, &this->normal.data }) {
+                bin.write (reinterpret_cast<const char*>(d->data()), static_cast<std::streamsize>(d->size()));
+            }
+        }
+    };
+
+    /*!
+     * Pack a mesh of three floats per vertex of positions, colours and normals, and three indices
+     * per triangle, for a glTF file, as opts asks (quantize and reorder). glb data are
+     * little-endian, as must be the host.
+     */
+    inline gltf_packed_mesh gltf_pack (const std::vector<float>& positions, const std::vector<float>& colours,
+                                       const std::vector<float>& normals, const std::vector<std::uint32_t>& _indices,
+                                       const gltf_options& opts)
+    {
+        if constexpr (std::endian::native != std::endian::little) {
+            throw std::runtime_error ("mplot::gltf_pack: glb data are little-endian, and this host is not");
+        }
+        if (colours.size() != positions.size() || normals.size() != positions.size() || positions.size() % 3u != 0u) {
+            throw std::runtime_error ("mplot::gltf_pack: Expect positions, colours and normals all to have the same size");
+        }
+        std::size_t nv = positions.size() / 3u;
+        for (const auto i : _indices) {
+            if (i >= nv) { throw std::runtime_error ("mplot::gltf_pack: an index is out of range"); }
+        }
+
+        // The reordering, as the old vertex of each new vertex
+        std::vector<std::uint32_t> indices = _indices;
+        std::vector<std::uint32_t> order;
+        if (opts.reorder) {
+            gltf_optimize_vertex_cache (indices, nv, opts.cache_size);
+            order = gltf_optimize_vertex_fetch (indices, nv);
+            nv = order.size();
+        }
+        auto src = [&order](const std::size_t v) { return order.empty() ? v : std::size_t{order[v]}; };
+
+        gltf_packed_mesh pm;
+        pm.n_vertices = nv;
+        pm.n_indices = indices.size();
+        pm.quantized = opts.quantize;
+
+        // Indices as uint16 if they fit, padded to 4 bytes
+        if (nv <= std::numeric_limits<std::uint16_t>::max()) {
+            pm.index_type = gltf_component::unsigned_short;
+            pm.indices.resize ((2u * indices.size() + 3u) & ~std::size_t{3});
+            for (std::size_t i = 0u; i < indices.size(); ++i) {
+                const std::uint16_t i16 = static_cast<std::uint16_t>(indices[i]);
+                std::memcpy (pm.indices.data() + 2u * i, &i16, 2);
+            }
+        } else {
+            pm.index_type = gltf_component::unsigned_int;
+            pm.indices.resize (4u * indices.size());
+            std::memcpy (pm.indices.data(), indices.data(), pm.indices.size());
+        }
+
+        if (!opts.quantize) {
+            for (auto* a : { &pm.position, &pm.colour, &pm.normal }) { a->data.resize (12u * nv); }
+            pm.pos_min = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+            pm.pos_max = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+            for (std::size_t v = 0u; v < nv; ++v) {
+                const std::size_t s = 3u * src (v);
+                std::memcpy (pm.position.data.data() + 12u * v, positions.data() + s, 12);
+                std::memcpy (pm.colour.data.data() + 12u * v, colours.data() + s, 12);
+                std::memcpy (pm.normal.data.data() + 12u * v, normals.data() + s, 12);
+                for (unsigned int c = 0u; c < 3u; ++c) {
+                    pm.pos_min[c] = std::min (pm.pos_min[c], positions[s + c]);
+                    pm.pos_max[c] = std::max (pm.pos_max[c], positions[s + c]);
+                }
+            }
+            if (nv == 0u) { pm.pos_min = { 0.0f, 0.0f, 0.0f }; pm.pos_max = { 0.0f, 0.0f, 0.0f }; }
+            return pm;
+        }
+
+        // Positions as int16 about the centre of their bounds, with one scale for all three axes
+        // (so that the normals need no correction for the node's scale)
+        std::array<float, 3> mn = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+        std::array<float, 3> mx = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+        for (std::size_t v = 0u; v < nv; ++v) {
+            for (unsigned int c = 0u; c < 3u; ++c) {
+                mn[c] = std::min (mn[c], positions[3u * src (v) + c]);
+                mx[c] = std::max (mx[c], positions[3u * src (v) + c]);
+            }
+        }
+        float half = 0.0f;
+        for (unsigned int c = 0u; c < 3u && nv > 0u; ++c) {
+            pm.offset[c] = 0.5f * (mn[c] + mx[c]);
+            half = std::max (half, 0.5f * (mx[c] - mn[c]));
+        }
+        pm.scale = half > 0.0f ? half / 32767.0f : 1.0f;
+
+        // int16 positions take 8 bytes, as glTF aligns each vertex to 4 bytes
+        pm.position.component_type = gltf_component::short_int;
+        pm.position.stride = 8u;
+        pm.position.data.assign (8u * nv, 0u);
+        pm.normal.component_type = gltf_component::byte;
+        pm.normal.normalized = true;
+        pm.normal.stride = 4u;
+        pm.normal.data.assign (4u * nv, 0u);
+        pm.colour.component_type = gltf_component::unsigned_byte;
+        pm.colour.normalized = true;
+        pm.colour.stride = 4u;
+        pm.colour.data.assign (4u * nv, 0u);
+        pm.pos_min = { 32767.0f, 32767.0f, 32767.0f };
+        pm.pos_max = { -32767.0f, -32767.0f, -32767.0f };
+        for (std::size_t v = 0u; v < nv; ++v) {
+            const std::size_t s = 3u * src (v);
+            for (unsigned int c = 0u; c < 3u; ++c) {
+                const float q = std::round ((positions[s + c] - pm.offset[c]) / pm.scale);
+                const std::int16_t q16 = static_cast<std::int16_t>(std::clamp (q, -32767.0f, 32767.0f));
+                std::memcpy (pm.position.data.data() + 8u * v + 2u * c, &q16, 2);
+                pm.pos_min[c] = std::min (pm.pos_min[c], static_cast<float>(q16));
+                pm.pos_max[c] = std::max (pm.pos_max[c], static_cast<float>(q16));
+                const std::int8_t n8 = static_cast<std::int8_t>(std::clamp (std::round (normals[s + c] * 127.0f), -127.0f, 127.0f));
+                std::memcpy (pm.normal.data.data() + 4u * v + c, &n8, 1);
+                pm.colour.data[4u * v + c] = static_cast<unsigned char>(std::round (std::clamp (colours[s + c], 0.0f, 1.0f) * 255.0f));
+            }
+        }
+        if (nv == 0u) { pm.pos_min = { 0.0f, 0.0f, 0.0f }; pm.pos_max = { 0.0f, 0.0f, 0.0f }; }
+        return pm;
+    }
+
+} // namespace mplot
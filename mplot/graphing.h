@@ -12,14 +12,12 @@
 #include <cmath>
 #include <limits>
 #include <deque>
+#include <vector>
+#include <span>
+#include <charconv>
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
-#ifdef MORPH_HAVE_STD_FORMAT
-# include <format>
-#else
-# include <sstream>
-# include <iomanip>
-# include <ios>
-#endif
 
 #include <sm/range>
 #include <sm/algo>
@@ -27,10 +25,15 @@
 
 namespace mplot::graphing {
 
-    //! Graph-specific number formatting for tick labels. You must pass in an adjacent
-    //! label (which affects the optimum precision to use for formatting)
+    /*!
+     * Graph-specific number formatting for tick labels, written into the caller's buffer out
+     * (which is not null terminated). You must pass in an adjacent label (which affects the
+     * optimum precision to use for formatting). Returns the number of chars written, which is
+     * 0 if out is too small; 32 chars is enough for any float or double. This makes no
+     * allocations.
+     */
     template <typename F>
-    static std::string number_format (const F num, const F adjacent_num)
+    static std::size_t number_format (std::span<char> out, const F num, const F adjacent_num)
     {
         sm::range<int> num_sigcols = sm::algo::significant_cols<F> (num);
         F num_diff = std::abs (num - adjacent_num);
@@ -51,38 +54,43 @@ namespace mplot::graphing {
             rounded = sm::algo::round_to_col (num, min_col);
         }
 
-#ifdef MORPH_HAVE_STD_FORMAT
-        std::string s = "0";
-        if (num != F{0}) {
-            if (num_sigcols.max > 3) {
-                s = std::format ("{:.{}e}", num, num_sigcols.max - min_col);
-            } else {
-                s = std::format ("{:.{}f}", num, (min_col <= 0 ? -min_col : 0));
-            }
+        char* const first = out.data();
+        char* const last = out.data() + out.size();
+        if (num == F{0}) {
+            if (out.empty()) { return 0; }
+            *first = '0';
+            return 1;
         }
-#else
-        std::stringstream ss;
-        if (num != F{0}) {
-            if (num_sigcols.max > 3) {
-                ss << std::scientific << std::setprecision (num_sigcols.max - min_col);
-            } else {
-                ss << std::fixed << std::setprecision ((min_col <= 0 ? -min_col : 0));
-            }
-            ss << num;
+        std::to_chars_result r;
+        if (num_sigcols.max > 3) {
+            // A negative precision is taken to be the default, 6, as printf would
+            const int prec = num_sigcols.max - min_col;
+            r = std::to_chars (first, last, num, std::chars_format::scientific, prec < 0 ? 6 : prec);
         } else {
-            ss << "0";
+            r = std::to_chars (first, last, num, std::chars_format::fixed, (min_col <= 0 ? -min_col : 0));
         }
-        std::string s = ss.str();
-#endif
-        if (num > F{-1} && num < F{1} && num != F{0}) {
+        if (r.ec != std::errc{}) { return 0; }
+        std::size_t n = static_cast<std::size_t>(r.ptr - first);
+
+        if (num > F{-1} && num < F{1}) {
             // It's a 0.something number. Get rid of any 0 preceding a '.'
-            std::string::size_type p = s.find ('.');
-            if (p != std::string::npos && p > 0) {
-                if (s[--p] == '0') { s.erase (p, 1); }
+            char* dot = std::find (first, first + n, '.');
+            if (dot != first + n && dot > first && *(dot - 1) == '0') {
+                std::copy (dot, first + n, dot - 1);
+                --n;
             }
         }
+        return n;
+    }
 
-        return s;
+    //! Graph-specific number formatting for tick labels. You must pass in an adjacent
+    //! label (which affects the optimum precision to use for formatting)
+    template <typename F>
+    static std::string number_format (const F num, const F adjacent_num)
+    {
+        char buf[64];
+        const std::size_t n = mplot::graphing::number_format<F> (std::span<char>(buf), num, adjacent_num);
+        return std::string (buf, n);
     }
 
     /*!
@@ -90,7 +98,9 @@ namespace mplot::graphing {
      * rmax. realmin and realmax gives the data range actually displayed on the graph - it's the
      * data range, plus any padding introduced by GraphVisual::dataaxisdist
      *
-     * This overload accepts a sm::range for the preferred number of ticks.
+     * This overload writes the ticks, in ascending order, into the caller's buffer out and
+     * returns how many there are. It makes no allocations. There are never more than 10 times
+     * _num_ticks_range.max ticks, nor more than out.size(); out should hold at least 3.
      *
      * The bool arg allows the client code to either accept that _num_ticks_range is
      * guidance OR to *force* the number of ticks to be in the range, even if it
@@ -98,21 +108,22 @@ namespace mplot::graphing {
      * of maketicks.
      */
     template <typename F>
-    static std::deque<F> maketicks (F rmin, F rmax, float realmin, float realmax, const sm::range<F>& _num_ticks_range)
+    static std::size_t maketicks (F rmin, F rmax, float realmin, float realmax, const sm::range<F>& _num_ticks_range,
+                                  std::span<F> out)
     {
-        std::deque<F> ticks = {};
+        if (out.size() < 2) { return 0; }
 
         if (std::numeric_limits<F>::has_quiet_NaN) { // If we are passed NaN for ranges, then return empty ticks
-            if (std::isnan (rmin) || std::isnan (rmax) || std::isnan (realmin) || std::isnan (realmax)) { return ticks; }
+            if (std::isnan (rmin) || std::isnan (rmax) || std::isnan (realmin) || std::isnan (realmax)) { return 0; }
         }
 
         F drange = rmax - rmin; // data range
         if (drange <= std::numeric_limits<F>::epsilon()
             || (_num_ticks_range.min == 2 && _num_ticks_range.max == 2)) {
             // Just two ticks in this case - one at drange min and one at max.
-            ticks.push_back (rmin);
-            ticks.push_back (rmax);
-            return ticks;
+            out[0] = rmin;
+            out[1] = rmax;
+            return 2;
         }
 
         F tickspacing = F{0};
@@ -149,39 +160,66 @@ namespace mplot::graphing {
             tbase -= F{1};
         }
 
+        // The most ticks to make (the limit also avoids an infinite loop)
+        const std::size_t cap = std::min (out.size(), static_cast<std::size_t>(std::max (F{0}, 10 * _num_ticks_range.max)));
+        std::size_t n = 0;
+
         // Realmax and realmin come from the full range of abscissa_scale/ord1_scale
         if (actual_numticks < _num_ticks_range.min || actual_numticks > _num_ticks_range.max) {
-            // In this case our 'neat' algorithm failed, so just force some ticks with linspace
+            // In this case our 'neat' algorithm failed, so just force some evenly spaced ticks
             int force_num = static_cast<int>(std::floor((_num_ticks_range.max + _num_ticks_range.min)  / F{2}));
-            sm::vvec<F> linticks;
-            linticks.linspace (rmin, rmax, force_num);
-            for (auto lt : linticks) { ticks.push_back (lt); }
+            n = std::min (cap, static_cast<std::size_t>(std::max (0, force_num)));
+            if (n == 1) { out[0] = rmin; }
+            for (std::size_t i = 0; n > 1 && i < n; ++i) {
+                out[i] = i + 1 == n ? rmax : rmin + (rmax - rmin) * static_cast<F>(i) / static_cast<F>(n - 1);
+            }
 
         } else {
-            // Our 'neat' algo found a nice tickspacing, so create the ticks for that:
+            // Our 'neat' algo found a nice tickspacing, so create the ticks for that, from the
+            // middle of the range up and then down. As out is in ascending order, the lower ticks
+            // are written after the upper ones, then reversed and rotated into place.
             F midrange = (rmin + rmax) * F{0.5};
             F a = std::round (midrange / tickspacing);
             F atick = a * tickspacing;
-            while (atick <= realmax && ticks.size() < (10 * _num_ticks_range.max)) { // 2nd test avoids inf loop
+            while (atick <= realmax && n < cap) {
                 // This tick is smaller than 100th of the size of one whole tick to tick spacing, so it must be 0.
-                ticks.push_back (std::abs(atick) < F{0.01} * std::abs(tickspacing) ? F{0} : atick);
+                out[n++] = std::abs(atick) < F{0.01} * std::abs(tickspacing) ? F{0} : atick;
                 atick += tickspacing;
             }
+            const std::size_t n_up = n;
             atick = (a * tickspacing) - tickspacing;
-            while (atick >= realmin && ticks.size() < (10 * _num_ticks_range.max)) {
-                ticks.push_front (std::abs(atick) < F{0.01} * std::abs(tickspacing) ? F{0} : atick);
+            while (atick >= realmin && n < cap) {
+                out[n++] = std::abs(atick) < F{0.01} * std::abs(tickspacing) ? F{0} : atick;
                 atick -= tickspacing;
             }
+            std::reverse (out.begin() + n_up, out.begin() + n);
+            std::rotate (out.begin(), out.begin() + n_up, out.begin() + n);
         }
 
         // If, for any reason, we ended up with just one tick (or none), revert to min/0/max
-        if (ticks.size() < 2) {
-            ticks.clear();
-            ticks.push_back (rmin);
-            if (rmin < F{0} && rmax > F{0}) { ticks.push_back (F{0}); }
-            ticks.push_back (rmax);
+        if (n < 2) {
+            n = 0;
+            out[n++] = rmin;
+            if (rmin < F{0} && rmax > F{0} && out.size() > 2) { out[n++] = F{0}; }
+            out[n++] = rmax;
         }
-        return ticks;
+        return n;
+    }
+
+    /*!
+     * Auto-computes the tick marker locations (in data space) for the data range rmin to
+     * rmax. realmin and realmax gives the data range actually displayed on the graph - it's the
+     * data range, plus any padding introduced by GraphVisual::dataaxisdist
+     *
+     * This overload accepts a sm::range for the preferred number of ticks.
+     */
+    template <typename F>
+    static std::deque<F> maketicks (F rmin, F rmax, float realmin, float realmax, const sm::range<F>& _num_ticks_range)
+    {
+        // Room for the most ticks that the span overload makes (and the min/0/max fallback)
+        std::vector<F> buf (std::max (std::size_t{3}, static_cast<std::size_t>(std::max (F{0}, 10 * _num_ticks_range.max))));
+        const std::size_t n = mplot::graphing::maketicks<F> (rmin, rmax, realmin, realmax, _num_ticks_range, std::span<F>(buf));
+        return std::deque<F> (buf.begin(), buf.begin() + n);
     }
 
     /*!
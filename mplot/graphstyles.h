@@ -32,6 +32,7 @@ namespace mplot {
         rod,
         cube,
         tetrahedron, // because you could...
+        sphere_impostor, // ScatterVisual: GL_POINTS drawn as ray traced spheres
         numstyles
     };
 
@@ -0,0 +1,129 @@
+/*!
+ * \file
+ *
+ * An mplot::frame_source that reads the frames of a time series from an HDF5 dataset, one
+ * hyperslab at a time, for an mplot::frame_stream (see mplot/frame_stream.h). The first dimension
+ * of the dataset is time; the other dimensions, together, make one frame. The dataset may be (and,
+ * for a series larger than memory, should be) chunked, ideally with one frame, or a few, per chunk.
+ *
+ * Link with HDF5 (this header is separate from frame_stream.h so that nothing else needs it).
+ * HDF5 is only called from the stream's I/O thread, so it need not be built thread safe, so long as
+ * nothing else in the program calls it at the same time.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <hdf5.h>
+#include <mplot/frame_stream.h>
+
+namespace mplot {
+
+    template <typename T>
+    struct hdf5_frame_source : public frame_source<T>
+    {
+        /*!
+         * Open the dataset dataset_path (such as "/sim/u") in the HDF5 file path. The dataset's
+         * chunk cache is given chunk_cache_bytes, which should hold at least the chunks of one
+         * frame, so that no chunk is read twice for one frame.
+         */
+        hdf5_frame_source (const std::string& path, const std::string& dataset_path,
+                           const std::size_t chunk_cache_bytes = 64u * 1024u * 1024u)
+        {
+            this->file = H5Fopen (path.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+            if (this->file < 0) { throw std::runtime_error ("hdf5_frame_source: Can't open " + path); }
+            hid_t dapl = H5Pcreate (H5P_DATASET_ACCESS);
+            // 12421 hash slots (a prime, as the HDF5 documentation advises); w0 = 1 evicts fully read chunks first
+            H5Pset_chunk_cache (dapl, 12421, chunk_cache_bytes, 1.0);
+            this->dset = H5Dopen2 (this->file, dataset_path.c_str(), dapl);
+            H5Pclose (dapl);
+            if (this->dset < 0) {
+                this->close();
+                throw std::runtime_error ("hdf5_frame_source: Can't open the dataset " + dataset_path + " in " + path);
+            }
+            this->fspace = H5Dget_space (this->dset);
+            const int nd = this->fspace < 0 ? -1 : H5Sget_simple_extent_ndims (this->fspace);
+            if (nd < 1) {
+                this->close();
+                throw std::runtime_error ("hdf5_frame_source: " + dataset_path + " is not an array of frames");
+            }
+            this->dims.resize (nd);
+            H5Sget_simple_extent_dims (this->fspace, this->dims.data(), nullptr);
+            this->n_frames = static_cast<std::size_t>(this->dims[0]);
+            this->n = 1u;
+            for (int d = 1; d < nd; ++d) { this->n *= static_cast<std::size_t>(this->dims[d]); }
+            // One frame is the hyperslab at start, of one frame by the rest of the dimensions
+            this->start.assign (nd, 0);
+            this->count = this->dims;
+            this->count[0] = 1;
+            const hsize_t mdims = static_cast<hsize_t>(this->n);
+            this->mspace = H5Screate_simple (1, &mdims, nullptr);
+        }
+
+        ~hdf5_frame_source() { this->close(); }
+
+        hdf5_frame_source (const hdf5_frame_source&) = delete;
+        hdf5_frame_source& operator= (const hdf5_frame_source&) = delete;
+
+        std::size_t frames() const final { return this->n_frames; }
+        std::size_t frame_size() const final { return this->n; }
+
+        //! Read the hyperslab of frame f into out, converting to T
+        void read (const std::size_t f, T* out) final
+        {
+            if (f >= this->n_frames) { throw std::out_of_range ("hdf5_frame_source: no such frame"); }
+            this->start[0] = static_cast<hsize_t>(f);
+            if (H5Sselect_hyperslab (this->fspace, H5S_SELECT_SET, this->start.data(), nullptr, this->count.data(), nullptr) < 0) {
+                throw std::runtime_error ("hdf5_frame_source: Can't select frame " + std::to_string (f));
+            }
+            if (H5Dread (this->dset, hdf5_frame_source<T>::mem_type(), this->mspace, this->fspace, H5P_DEFAULT, out) < 0) {
+                throw std::runtime_error ("hdf5_frame_source: Can't read frame " + std::to_string (f));
+            }
+        }
+
+    private:
+        //! The HDF5 memory type of T, into which HDF5 converts the stored values
+        static hid_t mem_type()
+        {
+            if constexpr (std::is_same_v<T, float>) { return H5T_NATIVE_FLOAT; }
+            else if constexpr (std::is_same_v<T, double>) { return H5T_NATIVE_DOUBLE; }
+            else if constexpr (std::is_same_v<T, std::int8_t>) { return H5T_NATIVE_INT8; }
+            else if constexpr (std::is_same_v<T, std::uint8_t>) { return H5T_NATIVE_UINT8; }
+            else if constexpr (std::is_same_v<T, std::int16_t>) { return H5T_NATIVE_INT16; }
+            else if constexpr (std::is_same_v<T, std::uint16_t>) { return H5T_NATIVE_UINT16; }
+            else if constexpr (std::is_same_v<T, std::int32_t>) { return H5T_NATIVE_INT32; }
+            else if constexpr (std::is_same_v<T, std::uint32_t>) { return H5T_NATIVE_UINT32; }
+            else if constexpr (std::is_same_v<T, std::int64_t>) { return H5T_NATIVE_INT64; }
+            else if constexpr (std::is_same_v<T, std::uint64_t>) { return H5T_NATIVE_UINT64; }
+            else { static_assert (std::is_same_v<T, float>, "hdf5_frame_source: unsupported datum type"); return -1; }
+        }
+
+        void close()
+        {
+            if (this->mspace >= 0) { H5Sclose (this->mspace); }
+            if (this->fspace >= 0) { H5Sclose (this->fspace); }
+            if (this->dset >= 0) { H5Dclose (this->dset); }
+            if (this->file >= 0) { H5Fclose (this->file); }
+            this->mspace = this->fspace = this->dset = this->file = -1;
+        }
+
+        hid_t file = -1;
+        hid_t dset = -1;
+        hid_t fspace = -1;
+        hid_t mspace = -1;
+        std::vector<hsize_t> dims;
+        std::vector<hsize_t> start;
+        std::vector<hsize_t> count;
+        std::size_t n_frames = 0;
+        std::size_t n = 0;
+    };
+
+} // namespace mplot
@@ -0,0 +1,142 @@
+/*!
+ * \file
+ *
+ * The sampling of an image at the centres of the elements of a grid (the hexes of an
+ * sm::hexgrid, or the pixels of an sm::grid). It is done on the CPU by
+ * image_sampling::resample, which is also the reference for the compute shader of
+ * mplot::gl::image_resampler (in mplot/gl/image_resample_kernels.h). That shader takes the
+ * same image_placement and filters and does the same per-element work on the GPU, so an image (a
+ * video frame, say) can be swapped on every frame.
+ *
+ * An image of w by h pixels, in rows from the bottom left (as mplot::loadpng gives it), is laid
+ * over the grid as an sm::hexgrid::resampleImage would lay it: the image has width scale[0] and
+ * height scale[1] * h / w, and is centred on offset. The first pixel's centre is at the bottom
+ * left corner of that rectangle and the last at the top right.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <sm/vec>
+#include <sm/vvec>
+
+namespace mplot {
+
+    //! How an image is sampled at an element's centre
+    enum class image_filter
+    {
+        //! Interpolate between the four pixels around the centre
+        bilinear,
+        //! The mean of the pixels whose centres lie within the element's footprint (bilinear if there are none)
+        box
+    };
+
+    //! Where the pixels of an image lie in the grid's coordinates
+    struct image_placement
+    {
+        //! The image's width and height in pixels
+        sm::vec<unsigned int, 2> dims = { 1u, 1u };
+        //! The width of the image and the scale of its height (see the file comment)
+        sm::vec<float, 2> scale = { 1.0f, 1.0f };
+        //! The centre of the image
+        sm::vec<float, 2> offset = { 0.0f, 0.0f };
+
+        //! The width and height of the image in the grid's coordinates
+        sm::vec<float, 2> extent() const
+        {
+            const float w = static_cast<float>(std::max (this->dims[0], 1u));
+            return { this->scale[0], this->scale[1] * static_cast<float>(this->dims[1]) / w };
+        }
+
+        //! The distance between the centres of neighbouring pixels
+        sm::vec<float, 2> spacing() const
+        {
+            const sm::vec<float, 2> e = this->extent();
+            return { e[0] / static_cast<float>(std::max (this->dims[0], 2u) - 1u),
+                     e[1] / static_cast<float>(std::max (this->dims[1], 2u) - 1u) };
+        }
+
+        //! The position of the centre of pixel (0, 0)
+        sm::vec<float, 2> origin() const { return this->offset - this->extent() / 2.0f; }
+
+        //! The position of p in pixels, with pixel (i, j)'s centre at (i, j)
+        sm::vec<float, 2> to_pixel (const sm::vec<float, 2>& p) const { return (p - this->origin()) / this->spacing(); }
+
+        //! True if the pixel position q lies on the image (within half a pixel of a pixel's centre)
+        bool on_image (const sm::vec<float, 2>& q) const
+        {
+            return q[0] >= -0.5f && q[1] >= -0.5f
+            && q[0] <= static_cast<float>(this->dims[0]) - 0.5f && q[1] <= static_cast<float>(this->dims[1]) - 0.5f;
+        }
+    };
+
+    struct image_sampling
+    {
+        //! The image, bilinearly interpolated at pixel position q (the edge pixels extend outwards)
+        static float bilinear (const std::vector<float>& img, const sm::vec<unsigned int, 2>& dims, const sm::vec<float, 2>& q)
+        {
+            const int w = static_cast<int>(dims[0]);
+            const int h = static_cast<int>(dims[1]);
+            const float fx = std::floor (q[0]);
+            const float fy = std::floor (q[1]);
+            const float tx = q[0] - fx;
+            const float ty = q[1] - fy;
+            const int x0 = std::clamp (static_cast<int>(fx), 0, w - 1);
+            const int x1 = std::clamp (static_cast<int>(fx) + 1, 0, w - 1);
+            const int y0 = std::clamp (static_cast<int>(fy), 0, h - 1);
+            const int y1 = std::clamp (static_cast<int>(fy) + 1, 0, h - 1);
+            auto at = [&img, w](const int x, const int y) { return img[static_cast<std::size_t>(y) * w + x]; };
+            const float b = at (x0, y0) + tx * (at (x1, y0) - at (x0, y0));
+            const float t = at (x0, y1) + tx * (at (x1, y1) - at (x0, y1));
+            return b + ty * (t - b);
+        }
+
+        /*!
+         * The mean of the pixels whose centres lie within footprint_px (a width and height in
+         * pixels) of pixel position q, or the bilinear sample at q if no pixel centre does.
+         */
+        static float box (const std::vector<float>& img, const sm::vec<unsigned int, 2>& dims, const sm::vec<float, 2>& q,
+                          const sm::vec<float, 2>& footprint_px)
+        {
+            const int x0 = std::max (static_cast<int>(std::ceil (q[0] - 0.5f * footprint_px[0])), 0);
+            const int y0 = std::max (static_cast<int>(std::ceil (q[1] - 0.5f * footprint_px[1])), 0);
+            const int x1 = std::min (static_cast<int>(std::floor (q[0] + 0.5f * footprint_px[0])), static_cast<int>(dims[0]) - 1);
+            const int y1 = std::min (static_cast<int>(std::floor (q[1] + 0.5f * footprint_px[1])), static_cast<int>(dims[1]) - 1);
+            if (x1 < x0 || y1 < y0) { return image_sampling::bilinear (img, dims, q); }
+            float s = 0.0f;
+            for (int y = y0; y <= y1; ++y) {
+                for (int x = x0; x <= x1; ++x) { s += img[static_cast<std::size_t>(y) * dims[0] + x]; }
+            }
+            return s / static_cast<float>((x1 - x0 + 1) * (y1 - y0 + 1));
+        }
+
+        /*!
+         * Sample the image img (pl.dims[0] * pl.dims[1] values, in rows from the bottom left) at
+         * each of points, with filter f. footprint is the width and height of an element in the
+         * grid's coordinates (for image_filter::box). Points off the image take the value
+         * outside.
+         */
+        static sm::vvec<float> resample (const std::vector<float>& img, const image_placement& pl,
+                                         const std::vector<sm::vec<float, 2>>& points,
+                                         const image_filter f = image_filter::bilinear,
+                                         const sm::vec<float, 2>& footprint = { 0.0f, 0.0f }, const float outside = 0.0f)
+        {
+            sm::vvec<float> out (points.size(), outside);
+            if (img.size() < std::size_t{pl.dims[0]} * pl.dims[1] || pl.dims[0] == 0u || pl.dims[1] == 0u) { return out; }
+            const sm::vec<float, 2> fp = footprint / pl.spacing();
+            for (std::size_t i = 0; i < points.size(); ++i) {
+                const sm::vec<float, 2> q = pl.to_pixel (points[i]);
+                if (!pl.on_image (q)) { continue; }
+                out[i] = f == image_filter::box ? image_sampling::box (img, pl.dims, q, fp) : image_sampling::bilinear (img, pl.dims, q);
+            }
+            return out;
+        }
+    };
+
+} // namespace mplot
@@ -0,0 +1,266 @@
+/*!
+ * \file
+ *
+ * The extraction of an isosurface, a triangle mesh of the surface on which a 3D field takes a
+ * given level, for mplot::IsosurfaceVisual. Each cell of the grid (the cube between eight
+ * neighbouring values) is cut into six tetrahedra around its main diagonal, and the surface is
+ * found in each tetrahedron by marching tetrahedra. Unlike marching cubes, this has no
+ * ambiguous cases and needs no case tables, and the cuts of neighbouring cells match, so the
+ * surface is closed wherever it does not meet the edge of the grid.
+ *
+ * The extraction is parallel over slabs of cells (one z layer each) in two passes: the first
+ * counts the triangles of each slab, and their prefix sum gives each slab the place in the
+ * output at which the second pass writes its triangles, so the output is sized once and is
+ * written without locks or copies. The triangles are not indexed (each has its own three
+ * vertices), and are in the same order for any number of threads.
+ *
+ * \author Seb James
+ * \date 2026
+ */
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <span>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+#include <sm/vec>
+
+namespace mplot {
+    namespace isosurface {
+
+        //! The tetrahedra into which a cell is cut, as corners of the cell (x in bit 0, y in bit
+        //! 1 and z in bit 2). Each contains the diagonal from corner 0 to corner 7.
+        static constexpr std::array<std::array<unsigned int, 4>, 6> tetrahedra = {{
+            { 0, 1, 3, 7 }, { 0, 3, 2, 7 }, { 0, 2, 6, 7 }, { 0, 6, 4, 7 }, { 0, 4, 5, 7 }, { 0, 5, 1, 7 }
+        }};
+
+        //! The number of triangles in a tetrahedron of which the corners in mask are inside
+        constexpr unsigned int tetrahedron_triangles (const unsigned int mask)
+        {
+            const unsigned int n = (mask & 1u) + ((mask >> 1) & 1u) + ((mask >> 2) & 1u) + ((mask >> 3) & 1u);
+            return n == 2u ? 2u : (n == 1u || n == 3u ? 1u : 0u);
+        }
+
+        //! A grid of dims[0] * dims[1] * dims[2] values (x varying fastest), with its position in space
+        template <typename T>
+        struct grid
+        {
+            std::span<const T> values;
+            std::array<unsigned int, 3> dims = { 0u, 0u, 0u };
+            //! The position of the first value and the spacing of the values along each axis
+            sm::vec<float> origin = { 0.0f, 0.0f, 0.0f };
+            sm::vec<float> spacing = { 1.0f, 1.0f, 1.0f };
+
+            float at (const unsigned int x, const unsigned int y, const unsigned int z) const
+            {
+                return static_cast<float>(this->values[(std::size_t{z} * this->dims[1] + y) * this->dims[0] + x]);
+            }
+
+            //! The gradient of the field at a grid point, by central differences (one sided at the edges)
+            sm::vec<float> gradient (const unsigned int x, const unsigned int y, const unsigned int z) const
+            {
+                const std::array<unsigned int, 3> p = { x, y, z };
+                sm::vec<float> g = { 0.0f, 0.0f, 0.0f };
+                for (unsigned int j = 0; j < 3u; ++j) {
+                    std::array<unsigned int, 3> lo = p, hi = p;
+                    if (p[j] > 0u) { --lo[j]; }
+                    if (p[j] + 1u < this->dims[j]) { ++hi[j]; }
+                    if (lo[j] == hi[j]) { continue; }
+                    g[j] = (this->at (hi[0], hi[1], hi[2]) - this->at (lo[0], lo[1], lo[2]))
+                    / (static_cast<float>(hi[j] - lo[j]) * this->spacing[j]);
+                }
+                return g;
+            }
+        };
+
+        namespace detail {
+
+            //! The triangles of the cells of slab z (the cells between grid layers z and z + 1)
+            template <typename T>
+            std::size_t count_slab (const grid<T>& g, const float level, const unsigned int z)
+            {
+                std::size_t n = 0;
+                std::array<float, 8> v;
+                for (unsigned int y = 0; y + 1u < g.dims[1]; ++y) {
+                    for (unsigned int x = 0; x + 1u < g.dims[0]; ++x) {
+                        unsigned int cmask = 0;
+                        for (unsigned int c = 0; c < 8u; ++c) {
+                            v[c] = g.at (x + (c & 1u), y + ((c >> 1) & 1u), z + ((c >> 2) & 1u));
+                            if (v[c] > level) { cmask |= 1u << c; }
+                        }
+                        if (cmask == 0u || cmask == 0xffu) { continue; }
+                        for (const auto& t : tetrahedra) {
+                            const unsigned int m = ((cmask >> t[0]) & 1u) | (((cmask >> t[1]) & 1u) << 1)
+                            | (((cmask >> t[2]) & 1u) << 2) | (((cmask >> t[3]) & 1u) << 3);
+                            n += tetrahedron_triangles (m);
+                        }
+                    }
+                }
+                return n;
+            }
+
+            //! Writes the triangles of a slab into positions and normals, from its k-th triangle onwards
+            template <typename T>
+            struct slab_writer
+            {
+                const grid<T>& g;
+                const float level;
+                float* pos;
+                float* nrm;
+
+                struct corner
+                {
+                    std::array<unsigned int, 3> p;
+                    std::size_t index;
+                    float v;
+                };
+
+                /*!
+                 * The vertex on the edge from a to b, written at vertex k. The end with the lower
+                 * index in the grid is always taken first, so that the cells either side of an
+                 * edge compute exactly the same vertex.
+                 */
+                void edge_vertex (corner a, corner b, const std::size_t k)
+                {
+                    if (b.index < a.index) { std::swap (a, b); }
+                    const float t = a.v == b.v ? 0.5f : std::clamp ((this->level - a.v) / (b.v - a.v), 0.0f, 1.0f);
+                    const sm::vec<float> ga = this->g.gradient (a.p[0], a.p[1], a.p[2]);
+                    const sm::vec<float> gb = this->g.gradient (b.p[0], b.p[1], b.p[2]);
+                    sm::vec<float> n = -(ga + (gb - ga) * t);
+                    const float len = n.length();
+                    n = len > 0.0f ? n / len : sm::vec<float>{ 0.0f, 0.0f, 1.0f };
+                    for (unsigned int j = 0; j < 3u; ++j) {
+                        const float pa = static_cast<float>(a.p[j]);
+                        const float pb = static_cast<float>(b.p[j]);
+                        this->pos[3u * k + j] = this->g.origin[j] + (pa + (pb - pa) * t) * this->g.spacing[j];
+                        this->nrm[3u * k + j] = n[j];
+                    }
+                }
+
+                //! Emit the triangle whose vertices are on edges e, at triangle k, wound to face along its normals
+                void triangle (const std::array<std::array<corner, 2>, 3>& e, const std::size_t k)
+                {
+                    for (unsigned int i = 0; i < 3u; ++i) { this->edge_vertex (e[i][0], e[i][1], 3u * k + i); }
+                    const float* p = this->pos + 9u * k;
+                    const float* n = this->nrm + 9u * k;
+                    const sm::vec<float> u = { p[3] - p[0], p[4] - p[1], p[5] - p[2] };
+                    const sm::vec<float> w = { p[6] - p[0], p[7] - p[1], p[8] - p[2] };
+                    const sm::vec<float> nsum = { n[0] + n[3] + n[6], n[1] + n[4] + n[7], n[2] + n[5] + n[8] };
+                    if (u.cross (w).dot (nsum) < 0.0f) {
+                        for (unsigned int j = 0; j < 3u; ++j) {
+                            std::swap (this->pos[9u * k + 3u + j], this->pos[9u * k + 6u + j]);
+                            std::swap (this->nrm[9u * k + 3u + j], this->nrm[9u * k + 6u + j]);
+                        }
+                    }
+                }
+
+                //! Write the triangles of slab z from triangle k. Returns the next triangle.
+                std::size_t write (const unsigned int z, std::size_t k)
+                {
+                    std::array<corner, 8> c;
+                    for (unsigned int y = 0; y + 1u < this->g.dims[1]; ++y) {
+                        for (unsigned int x = 0; x + 1u < this->g.dims[0]; ++x) {
+                            unsigned int cmask = 0;
+                            for (unsigned int i = 0; i < 8u; ++i) {
+                                c[i].p = { x + (i & 1u), y + ((i >> 1) & 1u), z + ((i >> 2) & 1u) };
+                                c[i].index = (std::size_t{c[i].p[2]} * this->g.dims[1] + c[i].p[1]) * this->g.dims[0] + c[i].p[0];
+                                c[i].v = this->g.at (c[i].p[0], c[i].p[1], c[i].p[2]);
+                                if (c[i].v > this->level) { cmask |= 1u << i; }
+                            }
+                            if (cmask == 0u || cmask == 0xffu) { continue; }
+                            for (const auto& t : tetrahedra) {
+                                // The corners of the tetrahedron, inside ones first
+                                std::array<corner, 4> in_c, out_c;
+                                unsigned int n_in = 0, n_out = 0;
+                                for (unsigned int i : t) {
+                                    if ((cmask >> i) & 1u) { in_c[n_in++] = c[i]; } else { out_c[n_out++] = c[i]; }
+                                }
+                                if (n_in == 1u) {
+                                    this->triangle ({{ { in_c[0], out_c[0] }, { in_c[0], out_c[1] }, { in_c[0], out_c[2] } }}, k++);
+                                } else if (n_in == 3u) {
+                                    this->triangle ({{ { out_c[0], in_c[0] }, { out_c[0], in_c[1] }, { out_c[0], in_c[2] } }}, k++);
+                                } else if (n_in == 2u) {
+                                    // A quad, around the edges from the two inside corners to the two outside ones
+                                    this->triangle ({{ { in_c[0], out_c[0] }, { in_c[0], out_c[1] }, { in_c[1], out_c[1] } }}, k++);
+                                    this->triangle ({{ { in_c[0], out_c[0] }, { in_c[1], out_c[1] }, { in_c[1], out_c[0] } }}, k++);
+                                }
+                            }
+                        }
+                    }
+                    return k;
+                }
+            };
+
+            //! Run job (slab) for each slab on n_threads threads, rethrowing the first exception
+            template <typename F>
+            void for_each_slab (const unsigned int n_slabs, unsigned int n_threads, F&& job)
+            {
+                if (n_threads == 0) { n_threads = std::thread::hardware_concurrency(); }
+                n_threads = std::max (1u, std::min (n_threads, n_slabs));
+                std::atomic<unsigned int> next_slab = 0;
+                std::vector<std::exception_ptr> errors (n_threads);
+                auto worker = [&](unsigned int ti) {
+                    try {
+                        for (unsigned int s = next_slab++; s < n_slabs; s = next_slab++) { job (s); }
+                    } catch (...) {
+                        errors[ti] = std::current_exception();
+                        next_slab = n_slabs;
+                    }
+                };
+                std::vector<std::thread> workers;
+                for (unsigned int ti = 1; ti < n_threads; ++ti) { workers.emplace_back (worker, ti); }
+                worker (0);
+                for (auto& w : workers) { w.join(); }
+                for (auto& e : errors) {
+                    if (e) { std::rethrow_exception (e); }
+                }
+            }
+
+        } // namespace detail
+
+        /*!
+         * Extract the surface on which the field g is level, on n_threads threads (0 for one per
+         * hardware thread). The surface passes between values above the level and values at or
+         * below it. Each triangle is three vertices, each a position (in positions) and a unit
+         * normal (in normals) of three floats. The normals point down the field's gradient, away
+         * from the values above the level, and each triangle winds anticlockwise seen from the
+         * side to which its normals point.
+         *
+         * positions and normals are grown to hold the triangles but are never shrunk, so that
+         * they can be reused as arenas (such as a VisualModel's vertexPositions and
+         * vertexNormals) from one level to the next without reallocation. The triangles are
+         * written from the start, and the number of them is returned.
+         */
+        template <typename T>
+        std::size_t extract (const grid<T>& g, const float level, std::vector<float>& positions, std::vector<float>& normals,
+                             const unsigned int n_threads = 0)
+        {
+            if (g.values.size() < std::size_t{g.dims[0]} * g.dims[1] * g.dims[2]) {
+                throw std::runtime_error ("mplot::isosurface::extract: the grid has fewer values than its dims");
+            }
+            if (g.dims[0] < 2u || g.dims[1] < 2u || g.dims[2] < 2u) { return 0; }
+            const unsigned int n_slabs = g.dims[2] - 1u;
+
+            // Count the triangles of each slab, and place each slab's after those of the slabs before it
+            std::vector<std::size_t> first (n_slabs + 1u, 0u);
+            detail::for_each_slab (n_slabs, n_threads, [&](const unsigned int s) { first[s + 1u] = detail::count_slab (g, level, s); });
+            for (unsigned int s = 0; s < n_slabs; ++s) { first[s + 1u] += first[s]; }
+            const std::size_t n = first[n_slabs];
+            if (positions.size() < 9u * n) { positions.resize (9u * n); }
+            if (normals.size() < 9u * n) { normals.resize (9u * n); }
+
+            detail::slab_writer<T> w { g, level, positions.data(), normals.data() };
+            detail::for_each_slab (n_slabs, n_threads, [&](const unsigned int s) { w.write (s, first[s]); });
+            return n;
+        }
+
+    } // namespace isosurface
+} // namespace mplot
@@ -0,0 +1,352 @@
+/*!
+ * \file
+ *
+ * A baseline JPEG encoder for the frames that mplot::frame_streamer sends to its clients. It
+ * writes 8 bit YCbCr with 4:2:0 chroma subsampling and the standard Huffman tables (those of
+ * Annex K of the JPEG standard), which every browser can decode, with the quality scaling of
+ * the IJG libjpeg.
+ *
+ * \author Seb James
+ * \date 2026
+ */
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+
+namespace mplot {
+    namespace jpeg {
+
+        namespace detail {
+
+            //! The index in natural (row by row) order of each coefficient in zigzag order
+            constexpr std::array<std::uint8_t, 64> zigzag = {
+                0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+                12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+                35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+                58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+            };
+
+            //! The example quantization tables of Annex K, in natural order
+            constexpr std::array<std::uint8_t, 64> luma_quant = {
+                16, 11, 10, 16,  24,  40,  51,  61,
+                12, 12, 14, 19,  26,  58,  60,  55,
+                14, 13, 16, 24,  40,  57,  69,  56,
+                14, 17, 22, 29,  51,  87,  80,  62,
+                18, 22, 37, 56,  68, 109, 103,  77,
+                24, 35, 55, 64,  81, 104, 113,  92,
+                49, 64, 78, 87, 103, 121, 120, 101,
+                72, 92, 95, 98, 112, 100, 103,  99
+            };
+            constexpr std::array<std::uint8_t, 64> chroma_quant = {
+                17, 18, 24, 47, 99, 99, 99, 99,
+                18, 21, 26, 66, 99, 99, 99, 99,
+                24, 26, 56, 99, 99, 99, 99, 99,
+                47, 66, 99, 99, 99, 99, 99, 99,
+                99, 99, 99, 99, 99, 99, 99, 99,
+                99, 99, 99, 99, 99, 99, 99, 99,
+                99, 99, 99, 99, 99, 99, 99, 99,
+                99, 99, 99, 99, 99, 99, 99, 99
+            };
+
+            //! The standard Huffman tables of Annex K: the number of codes of each length from 1
+            //! to 16 bits, then the values that they code
+            constexpr std::array<std::uint8_t, 16> dc_luma_bits = { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+            constexpr std::array<std::uint8_t, 12> dc_luma_vals = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+            constexpr std::array<std::uint8_t, 16> dc_chroma_bits = { 0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0 };
+            constexpr std::array<std::uint8_t, 12> dc_chroma_vals = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+            constexpr std::array<std::uint8_t, 16> ac_luma_bits = { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d };
+            constexpr std::array<std::uint8_t, 162> ac_luma_vals = {
+                0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+                0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+                0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+                0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+                0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+                0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+                0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+                0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+                0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+                0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+                0xf9, 0xfa
+            };
+            constexpr std::array<std::uint8_t, 16> ac_chroma_bits = { 0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77 };
+            constexpr std::array<std::uint8_t, 162> ac_chroma_vals = {
+                0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+                0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+                0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+                0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+                0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+                0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+                0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+                0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+                0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+                0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+                0xf9, 0xfa
+            };
+
+            //! The code and its length in bits for each of the 256 values of a Huffman table
+            struct huffman_codes
+            {
+                std::array<std::uint16_t, 256> code = {};
+                std::array<std::uint8_t, 256> length = {};
+
+                template <std::size_t NV>
+                huffman_codes (const std::array<std::uint8_t, 16>& bits, const std::array<std::uint8_t, NV>& vals)
+                {
+                    // Canonical codes: consecutive within a length, doubled for each longer length
+                    std::uint16_t c = 0;
+                    std::size_t k = 0;
+                    for (unsigned int len = 1; len <= 16u; ++len) {
+                        for (unsigned int i = 0; i < bits[len - 1u]; ++i, ++k) {
+                            this->code[vals[k]] = c++;
+                            this->length[vals[k]] = static_cast<std::uint8_t>(len);
+                        }
+                        c = static_cast<std::uint16_t>(c << 1);
+                    }
+                }
+            };
+
+            //! Writes the entropy coded segment, stuffing a zero after each 0xff byte
+            struct bit_writer
+            {
+                std::vector<std::uint8_t>& out;
+                std::uint32_t acc = 0;
+                unsigned int n_bits = 0;
+
+                void put (const std::uint32_t bits, const unsigned int n)
+                {
+                    if (n == 0u) { return; }
+                    this->acc = (this->acc << n) | (bits & ((1u << n) - 1u));
+                    this->n_bits += n;
+                    while (this->n_bits >= 8u) {
+                        const std::uint8_t b = static_cast<std::uint8_t>(this->acc >> (this->n_bits - 8u));
+                        this->out.push_back (b);
+                        if (b == 0xff) { this->out.push_back (0x00); }
+                        this->n_bits -= 8u;
+                    }
+                }
+
+                //! Pad the last byte with ones
+                void flush() { if (this->n_bits > 0u) { this->put (0x7f, 8u - this->n_bits); } }
+            };
+
+            //! The number of bits needed for the magnitude of v (its JPEG category)
+            inline unsigned int category (int v)
+            {
+                v = v < 0 ? -v : v;
+                unsigned int n = 0;
+                while (v > 0) { ++n; v >>= 1; }
+                return n;
+            }
+
+            //! The orthonormal 8 point DCT-II matrix, by which JPEG's forward DCT is C X C^T
+            inline const std::array<float, 64>& dct_matrix()
+            {
+                static const std::array<float, 64> m = [] {
+                    std::array<float, 64> c = {};
+                    const double pi = 3.14159265358979323846;
+                    for (int u = 0; u < 8; ++u) {
+                        const double s = u == 0 ? std::sqrt (0.125) : 0.5;
+                        for (int x = 0; x < 8; ++x) {
+                            c[u * 8 + x] = static_cast<float>(s * std::cos ((2.0 * x + 1.0) * u * pi / 16.0));
+                        }
+                    }
+                    return c;
+                }();
+                return m;
+            }
+
+            //! The quantization table for quality quality (1 to 100), scaled as libjpeg does
+            inline std::array<std::uint8_t, 64> scaled_quant (const std::array<std::uint8_t, 64>& base, int quality)
+            {
+                quality = std::clamp (quality, 1, 100);
+                const int scale = quality < 50 ? 5000 / quality : 200 - 2 * quality;
+                std::array<std::uint8_t, 64> q = {};
+                for (std::size_t i = 0; i < 64; ++i) {
+                    q[i] = static_cast<std::uint8_t>(std::clamp ((base[i] * scale + 50) / 100, 1, 255));
+                }
+                return q;
+            }
+
+            //! The DCT, quantization and entropy coding of one 8x8 block (samples level shifted by -128)
+            inline void encode_block (bit_writer& bw, const std::array<float, 64>& block,
+                                      const std::array<float, 64>& recip_quant, int& dc_pred,
+                                      const huffman_codes& dc, const huffman_codes& ac)
+            {
+                const std::array<float, 64>& c = dct_matrix();
+                std::array<float, 64> tmp = {};
+                // tmp = C X, then coefficients = tmp C^T
+                for (int u = 0; u < 8; ++u) {
+                    for (int x = 0; x < 8; ++x) {
+                        float s = 0.0f;
+                        for (int k = 0; k < 8; ++k) { s += c[u * 8 + k] * block[k * 8 + x]; }
+                        tmp[u * 8 + x] = s;
+                    }
+                }
+                std::array<int, 64> q = {};
+                for (int u = 0; u < 8; ++u) {
+                    for (int v = 0; v < 8; ++v) {
+                        float s = 0.0f;
+                        for (int k = 0; k < 8; ++k) { s += tmp[u * 8 + k] * c[v * 8 + k]; }
+                        q[u * 8 + v] = static_cast<int>(std::lround (s * recip_quant[u * 8 + v]));
+                    }
+                }
+
+                // The DC coefficient is coded as the difference from the last block's of the component
+                const int diff = q[0] - dc_pred;
+                dc_pred = q[0];
+                unsigned int n = category (diff);
+                bw.put (dc.code[n], dc.length[n]);
+                bw.put (static_cast<std::uint32_t>(diff < 0 ? diff - 1 : diff), n);
+
+                // The AC coefficients as runs of zeros, each followed by a non-zero coefficient
+                unsigned int run = 0;
+                for (std::size_t i = 1; i < 64; ++i) {
+                    const int coef = q[zigzag[i]];
+                    if (coef == 0) { ++run; continue; }
+                    while (run > 15u) {
+                        bw.put (ac.code[0xf0], ac.length[0xf0]); // 16 zeros
+                        run -= 16u;
+                    }
+                    n = category (coef);
+                    const unsigned int sym = (run << 4) | n;
+                    bw.put (ac.code[sym], ac.length[sym]);
+                    bw.put (static_cast<std::uint32_t>(coef < 0 ? coef - 1 : coef), n);
+                    run = 0;
+                }
+                if (run > 0u) { bw.put (ac.code[0x00], ac.length[0x00]); } // end of block
+            }
+
+            inline void put16 (std::vector<std::uint8_t>& out, const unsigned int v)
+            {
+                out.push_back (static_cast<std::uint8_t>(v >> 8));
+                out.push_back (static_cast<std::uint8_t>(v & 0xff));
+            }
+
+            template <std::size_t NV>
+            void put_huffman_table (std::vector<std::uint8_t>& out, const std::uint8_t tc_th,
+                                    const std::array<std::uint8_t, 16>& bits, const std::array<std::uint8_t, NV>& vals)
+            {
+                out.insert (out.end(), { 0xff, 0xc4 });
+                put16 (out, 2u + 1u + 16u + static_cast<unsigned int>(NV));
+                out.push_back (tc_th);
+                out.insert (out.end(), bits.begin(), bits.end());
+                out.insert (out.end(), vals.begin(), vals.end());
+            }
+
+        } // namespace detail
+
+        /*!
+         * Encode the width by height RGBA image rgba (rows top first, alpha ignored) as a baseline
+         * JPEG of quality quality (1 to 100; 75 is typical), into out, which is cleared first.
+         */
+        inline void encode (const std::uint8_t* rgba, const int width, const int height, const int quality,
+                            std::vector<std::uint8_t>& out)
+        {
+            using namespace detail;
+            out.clear();
+            if (rgba == nullptr || width <= 0 || height <= 0 || width > 65535 || height > 65535) { return; }
+
+            const std::array<std::uint8_t, 64> lq = scaled_quant (luma_quant, quality);
+            const std::array<std::uint8_t, 64> cq = scaled_quant (chroma_quant, quality);
+            std::array<float, 64> recip_lq = {};
+            std::array<float, 64> recip_cq = {};
+            for (std::size_t i = 0; i < 64; ++i) {
+                recip_lq[i] = 1.0f / lq[i];
+                recip_cq[i] = 1.0f / cq[i];
+            }
+            static const huffman_codes dc_luma (dc_luma_bits, dc_luma_vals);
+            static const huffman_codes ac_luma (ac_luma_bits, ac_luma_vals);
+            static const huffman_codes dc_chroma (dc_chroma_bits, dc_chroma_vals);
+            static const huffman_codes ac_chroma (ac_chroma_bits, ac_chroma_vals);
+
+            // A JPEG is typically a tenth of the size of the raw image, or less
+            out.reserve (static_cast<std::size_t>(width) * height / 4u + 1024u);
+
+            // Start of image and a JFIF header
+            out.insert (out.end(), { 0xff, 0xd8, 0xff, 0xe0, 0x00, 0x10, 'J', 'F', 'I', 'F', 0x00,
+                                     0x01, 0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00 });
+            // The quantization tables, in zigzag order
+            out.insert (out.end(), { 0xff, 0xdb });
+            put16 (out, 2u + 2u * 65u);
+            out.push_back (0x00);
+            for (std::size_t i = 0; i < 64; ++i) { out.push_back (lq[zigzag[i]]); }
+            out.push_back (0x01);
+            for (std::size_t i = 0; i < 64; ++i) { out.push_back (cq[zigzag[i]]); }
+            // Baseline frame of 3 components: Y sampled 2x2, Cb and Cr 1x1
+            out.insert (out.end(), { 0xff, 0xc0, 0x00, 0x11, 0x08 });
+            put16 (out, static_cast<unsigned int>(height));
+            put16 (out, static_cast<unsigned int>(width));
+            out.insert (out.end(), { 0x03, 0x01, 0x22, 0x00, 0x02, 0x11, 0x01, 0x03, 0x11, 0x01 });
+            put_huffman_table (out, 0x00, dc_luma_bits, dc_luma_vals);
+            put_huffman_table (out, 0x10, ac_luma_bits, ac_luma_vals);
+            put_huffman_table (out, 0x01, dc_chroma_bits, dc_chroma_vals);
+            put_huffman_table (out, 0x11, ac_chroma_bits, ac_chroma_vals);
+            // Start of scan
+            out.insert (out.end(), { 0xff, 0xda, 0x00, 0x0c, 0x03, 0x01, 0x00, 0x02, 0x11, 0x03, 0x11, 0x00, 0x3f, 0x00 });
+
+            bit_writer bw { out };
+            int pred_y = 0;
+            int pred_cb = 0;
+            int pred_cr = 0;
+            // One MCU of 16x16 pixels: four Y blocks, then one Cb and one Cr block of 2x2 averages
+            std::array<float, 256> ys = {};
+            std::array<float, 256> cbs = {};
+            std::array<float, 256> crs = {};
+            std::array<float, 64> block = {};
+            for (int my = 0; my < height; my += 16) {
+                for (int mx = 0; mx < width; mx += 16) {
+                    for (int j = 0; j < 16; ++j) {
+                        // Pixels beyond the edge repeat the edge
+                        const int py = std::min (my + j, height - 1);
+                        for (int i = 0; i < 16; ++i) {
+                            const int px = std::min (mx + i, width - 1);
+                            const std::uint8_t* p = rgba + (static_cast<std::size_t>(py) * width + px) * 4u;
+                            const float r = p[0];
+                            const float g = p[1];
+                            const float b = p[2];
+                            ys[j * 16 + i] = 0.299f * r + 0.587f * g + 0.114f * b - 128.0f;
+                            cbs[j * 16 + i] = -0.168736f * r - 0.331264f * g + 0.5f * b;
+                            crs[j * 16 + i] = 0.5f * r - 0.418688f * g - 0.081312f * b;
+                        }
+                    }
+                    for (int by = 0; by < 16; by += 8) {
+                        for (int bx = 0; bx < 16; bx += 8) {
+                            for (int j = 0; j < 8; ++j) {
+                                for (int i = 0; i < 8; ++i) { block[j * 8 + i] = ys[(by + j) * 16 + bx + i]; }
+                            }
+                            encode_block (bw, block, recip_lq, pred_y, dc_luma, ac_luma);
+                        }
+                    }
+                    for (int c = 0; c < 2; ++c) {
+                        const std::array<float, 256>& src = c == 0 ? cbs : crs;
+                        for (int j = 0; j < 8; ++j) {
+                            for (int i = 0; i < 8; ++i) {
+                                const int k = 2 * j * 16 + 2 * i;
+                                block[j * 8 + i] = 0.25f * (src[k] + src[k + 1] + src[k + 16] + src[k + 17]);
+                            }
+                        }
+                        encode_block (bw, block, recip_cq, c == 0 ? pred_cb : pred_cr, dc_chroma, ac_chroma);
+                    }
+                }
+            }
+            bw.flush();
+            // End of image
+            out.insert (out.end(), { 0xff, 0xd9 });
+        }
+
+        //! Encode rgba as a JPEG, returning its bytes
+        inline std::vector<std::uint8_t> encode (const std::uint8_t* rgba, const int width, const int height, const int quality = 75)
+        {
+            std::vector<std::uint8_t> out;
+            encode (rgba, width, height, quality, out);
+            return out;
+        }
+
+    } // namespace jpeg
+} // namespace mplot
@@ -0,0 +1,130 @@
+/*!
+ * \file
+ *
+ * A label_declutter chooses which of many labels to draw: those that lie wholly outside the
+ * framebuffer are culled, and of those that overlap, only the one with the highest priority
+ * is kept. The overlaps are found with a grid of buckets over the framebuffer, so each label is
+ * tested only against the kept labels that share a bucket with it. A VisualModel with
+ * setDeclutterTexts(true) runs it over its texts whenever the view changes (see
+ * VisualModel::update_declutter), which keeps the tens of thousands of labels of a dense
+ * ScatterVisual or HealpixVisual legible and cheap to draw.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+#include <sm/vec>
+#include <mplot/screen_rect.h>
+
+namespace mplot {
+
+    //! A label's rectangle on the screen and its priority
+    struct label_box
+    {
+        //! The pixels that the label covers, clamped to the framebuffer (so empty if off screen)
+        mplot::screen_rect r = {};
+        //! Of two overlapping labels, the one with the higher priority is kept
+        float priority = 0.0f;
+        //! False if the label's place is not known (see VisualTextModel::clip_bounds). Such a
+        //! label is always drawn and takes no part in the overlap tests.
+        bool known = true;
+    };
+
+    struct label_declutter
+    {
+        //! One box for each label. Fill these in and then call run().
+        std::vector<label_box> boxes;
+        //! After run(), shown[i] is 1 if the label of boxes[i] is to be drawn
+        std::vector<std::uint8_t> shown;
+
+        //! The width and height of a grid bucket, in pixels
+        int cell = 64;
+        //! Labels closer than this many pixels apart count as overlapping
+        int padding = 1;
+
+        //! The numbers of labels culled (off screen) and suppressed (by overlap) by the last run()
+        std::size_t n_culled = 0;
+        std::size_t n_suppressed = 0;
+
+        /*!
+         * Choose the labels to draw in a framebuffer of size dims. The labels are visited in
+         * order of decreasing priority (and, for equal priorities, in the order of boxes), and
+         * each is kept unless it is off screen or it overlaps a label kept before it. If dims is
+         * not known (zero), every label is shown.
+         */
+        void run (const sm::vec<int, 2>& dims)
+        {
+            const std::size_t n = this->boxes.size();
+            this->shown.assign (n, 1);
+            this->n_culled = 0;
+            this->n_suppressed = 0;
+            if (dims[0] <= 0 || dims[1] <= 0 || n == 0) { return; }
+
+            this->order.resize (n);
+            std::iota (this->order.begin(), this->order.end(), 0u);
+            std::stable_sort (this->order.begin(), this->order.end(), [this](const std::uint32_t a, const std::uint32_t b) {
+                return this->boxes[a].priority > this->boxes[b].priority;
+            });
+
+            const int c = std::max (this->cell, 1);
+            this->nx = (dims[0] + c - 1) / c;
+            this->ny = (dims[1] + c - 1) / c;
+            // Clearing the buckets keeps their capacity from one run to the next
+            this->buckets.resize (static_cast<std::size_t>(this->nx) * this->ny);
+            for (auto& b : this->buckets) { b.clear(); }
+
+            for (const std::uint32_t i : this->order) {
+                const label_box& lb = this->boxes[i];
+                if (!lb.known) { continue; }
+                if (lb.r.empty()) {
+                    this->shown[i] = 0;
+                    ++this->n_culled;
+                    continue;
+                }
+                const mplot::screen_rect pr = { lb.r.x0 - this->padding, lb.r.y0 - this->padding,
+                                                lb.r.x1 + this->padding, lb.r.y1 + this->padding };
+                const int cx0 = std::max (pr.x0, 0) / c;
+                const int cy0 = std::max (pr.y0, 0) / c;
+                const int cx1 = std::min (pr.x1 - 1, dims[0] - 1) / c;
+                const int cy1 = std::min (pr.y1 - 1, dims[1] - 1) / c;
+
+                bool overlaps = false;
+                for (int y = cy0; y <= cy1 && !overlaps; ++y) {
+                    for (int x = cx0; x <= cx1 && !overlaps; ++x) {
+                        for (const std::uint32_t j : this->buckets[y * this->nx + x]) {
+                            if (!pr.intersection (this->boxes[j].r).empty()) { overlaps = true; break; }
+                        }
+                    }
+                }
+                if (overlaps) {
+                    this->shown[i] = 0;
+                    ++this->n_suppressed;
+                    continue;
+                }
+                // Kept, so enter the label (without its padding) in each bucket that it touches
+                for (int y = lb.r.y0 / c; y <= (lb.r.y1 - 1) / c; ++y) {
+                    for (int x = lb.r.x0 / c; x <= (lb.r.x1 - 1) / c; ++x) { this->buckets[y * this->nx + x].push_back (i); }
+                }
+            }
+        }
+
+        //! The number of labels shown by the last run()
+        std::size_t n_shown() const { return this->boxes.size() - this->n_culled - this->n_suppressed; }
+
+    private:
+        //! The label indices in the order that run() visits them
+        std::vector<std::uint32_t> order;
+        //! For each grid bucket, the kept labels that touch it
+        std::vector<std::vector<std::uint32_t>> buckets;
+        int nx = 0;
+        int ny = 0;
+    };
+
+} // namespace mplot
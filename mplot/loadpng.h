@@ -12,13 +12,143 @@
 #include <vector>
 #include <string>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <stdexcept>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <iomanip>
 
 #include <sm/vec>
 #include <sm/vvec>
 
 namespace mplot {
 
+    /*
+     * If this is not empty, loadpng and friends keep the decoded RGBA pixels of each PNG that
+     * they load in a file in this directory. The cache file is used in place of decompressing
+     * the PNG for as long as the PNG's modification time and size are unchanged. For example:
+     *
+     *   mplot::loadpng_cache_dir = "/tmp/mplot_png_cache";
+     */
+    inline std::string loadpng_cache_dir = "";
+
+    namespace loadpng_impl {
+
+        // The first 8 bytes of a cache file
+        constexpr char cache_magic[8] = { 'm', 'p', 'l', 'o', 't', 'p', 'n', 'g' };
+
+        // Read the cached pixels in cache_path, if the cache was made from a PNG with the given mtime and size
+        inline bool read_cache (const std::filesystem::path& cache_path, const std::int64_t mtime, const std::uint64_t fsize,
+                                std::vector<unsigned char>& png, unsigned int& w, unsigned int& h)
+        {
+            std::ifstream f (cache_path, std::ios::in | std::ios::binary);
+            if (!f.is_open()) { return false; }
+            char magic[8];
+            std::int64_t c_mtime = 0;
+            std::uint64_t c_fsize = 0;
+            std::uint32_t c_w = 0;
+            std::uint32_t c_h = 0;
+            f.read (magic, 8);
+            f.read (reinterpret_cast<char*>(&c_mtime), sizeof c_mtime);
+            f.read (reinterpret_cast<char*>(&c_fsize), sizeof c_fsize);
+            f.read (reinterpret_cast<char*>(&c_w), sizeof c_w);
+            f.read (reinterpret_cast<char*>(&c_h), sizeof c_h);
+            if (!f.good() || std::memcmp (magic, cache_magic, 8) != 0 || c_mtime != mtime || c_fsize != fsize) { return false; }
+            png.resize (std::size_t{4} * c_w * c_h);
+            f.read (reinterpret_cast<char*>(png.data()), static_cast<std::streamsize>(png.size()));
+            if (f.gcount() != static_cast<std::streamsize>(png.size())) { return false; }
+            w = c_w;
+            h = c_h;
+            return true;
+        }
+
+        // Write the decoded pixels to cache_path (via a temporary file, so that a reader never sees half a cache file)
+        inline void write_cache (const std::filesystem::path& cache_path, const std::int64_t mtime, const std::uint64_t fsize,
+                                 const std::vector<unsigned char>& png, const unsigned int w, const unsigned int h)
+        {
+            std::error_code ec;
+            std::filesystem::create_directories (cache_path.parent_path(), ec);
+            std::filesystem::path tmp = cache_path;
+            tmp += ".tmp";
+            {
+                std::ofstream f (tmp, std::ios::out | std::ios::binary | std::ios::trunc);
+                if (!f.is_open()) { return; } // caching is best-effort
+                const std::uint32_t c_w = w;
+                const std::uint32_t c_h = h;
+                f.write (cache_magic, 8);
+                f.write (reinterpret_cast<const char*>(&mtime), sizeof mtime);
+                f.write (reinterpret_cast<const char*>(&fsize), sizeof fsize);
+                f.write (reinterpret_cast<const char*>(&c_w), sizeof c_w);
+                f.write (reinterpret_cast<const char*>(&c_h), sizeof c_h);
+                f.write (reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size()));
+                if (!f.good()) { f.close(); std::filesystem::remove (tmp, ec); return; }
+            }
+            std::filesystem::rename (tmp, cache_path, ec);
+            if (ec) { std::filesystem::remove (tmp, ec); }
+        }
+
+        // Decode filename into 8 bit RGBA pixels, top row first, by way of loadpng_cache_dir if it is set
+        inline void decode (const std::string& filename, std::vector<unsigned char>& png,
+                            unsigned int& w, unsigned int& h, const char* caller)
+        {
+            std::filesystem::path cache_path;
+            std::int64_t mtime = 0;
+            std::uint64_t fsize = 0;
+            if (!mplot::loadpng_cache_dir.empty()) {
+                std::error_code ec;
+                const auto ft = std::filesystem::last_write_time (filename, ec);
+                if (!ec) { fsize = std::filesystem::file_size (filename, ec); }
+                if (!ec) {
+                    mtime = static_cast<std::int64_t>(ft.time_since_epoch().count());
+                    // Name the cache file after a hash of the PNG's absolute path
+                    const std::string abs_path = std::filesystem::absolute (filename, ec).string();
+                    std::stringstream cn;
+                    cn << std::hex << std::setw (16) << std::setfill ('0') << std::hash<std::string>{}(abs_path) << ".rgba";
+                    cache_path = std::filesystem::path (mplot::loadpng_cache_dir) / cn.str();
+                    if (read_cache (cache_path, mtime, fsize, png, w, h)) { return; }
+                }
+            }
+
+            // Assume RGBA and bit depth of 8
+            unsigned lprtn = lodepng::decode (png, w, h, filename, LCT_RGBA, 8);
+            if (lprtn != 0) {
+                std::string err = std::string(caller) + ": lodepng::decode returned error code "
+                + std::to_string(lprtn) + std::string(": ") + std::string(lodepng_error_text (lprtn));
+                throw std::runtime_error (err);
+            }
+            if (png.size() % 4 != 0) {
+                throw std::runtime_error (std::string(caller) + ": Expect png vector to have size divisible by 4.");
+            }
+            if (!cache_path.empty()) { write_cache (cache_path, mtime, fsize, png, w, h); }
+        }
+
+        /*
+         * Convert the w x h RGBA pixels in png into out, which has n_elem elements of type E per
+         * pixel. conv (src, dst) converts the pixel at src into the n_elem elements at dst. The
+         * flips are resolved once per row, so the inner loop over a row's pixels is a plain,
+         * contiguous loop. The destination pixel order follows the flips; the channel order in
+         * each pixel is never changed.
+         */
+        template <typename E, typename F>
+        void convert_rows (const std::vector<unsigned char>& png, const unsigned int w, const unsigned int h,
+                           E* out, const std::size_t n_elem, const sm::vec<bool,2> flip, F conv)
+        {
+            for (unsigned int c = 0; c < h; ++c) {
+                const unsigned char* src = png.data() + std::size_t{4} * w * c;
+                E* dst = out + n_elem * w * (flip[1] ? (h - c - 1) : c);
+                if (flip[0]) {
+                    for (unsigned int r = 0; r < w; ++r) { conv (src + 4 * r, dst + n_elem * (w - r - 1)); }
+                } else {
+                    for (unsigned int r = 0; r < w; ++r) { conv (src + 4 * r, dst + n_elem * r); }
+                }
+            }
+        }
+
+    } // namespace loadpng_impl
+
     /*
      * Wrap lodepng::decode to load a PNG from file, placing the data into the
      * image_data array. Figure out based on the type of T, how to scale the numbers.
@@ -41,66 +171,33 @@ namespace mplot {
         std::vector<unsigned char> png;
         unsigned int w = 0;
         unsigned int h = 0;
-        // Assume RGBA and bit depth of 8
-        unsigned lprtn = lodepng::decode (png, w, h, filename, LCT_RGBA, 8);
-        if (lprtn != 0) {
-            std::string err = "mplot::loadpng: lodepng::decode returned error code "
-            + std::to_string(lprtn) + std::string(": ") + std::string(lodepng_error_text (lprtn));
-            throw std::runtime_error (err);
-        }
+        loadpng_impl::decode (filename, png, w, h, "mplot::loadpng");
         // For return:
         sm::vec<unsigned int, 2> dims = {w, h};
 
         // Now convert out into a value placed in image_data
         // If T is float or double, then get mean RGB, convert to range 0 to 1
         // If T is of integer type, then get mean and encode in range 0-255
-
-        unsigned int vsz = png.size();
-        if (vsz % 4 != 0) {
-            throw std::runtime_error ("mplot::loadpng: Expect png vector to have size divisible by 4.");
-        }
-
-        image_data.resize (vsz/4);
-
-        for (unsigned int c = 0; c < dims[1]; ++c) {
-            for (unsigned int r = 0; r < dims[0]; ++r) {
-                // Offset into png
-                unsigned int i = 4*r + 4*dims[0]*c;
-                // Offset into image_data depends on what flips the caller wants
-                unsigned int idx = flip[0] == true ?
-                (flip[1]==true ? ((dims[0]-r-1) + dims[0]*(dims[1]-c-1)) : ((dims[0]-r-1) + dims[0]*c))
-                : (flip[1]==true ? (r + dims[0]*(dims[1]-c-1)) : (r + dims[0]*c));
-
-                // The above unpacks as:
-
-                // flip[0]==false and flip[1]==false: (no flipping)
-                // idx = r + dims[0]*c
-
-                // flip[0]==false and flip[1]==true: (vertical flip)
-                // idx = (r + dims[0]*(dims[1]-c-1))
-
-                // flip[0]==true and flip[1]==false: (horizontal flip)
-                // ((dims[0]-r-1) + dims[0]*c))
-
-                // flip[0]==true and flip[1]==true:  (v-h flip)
-                // ((dims[0]-r-1) + dims[0]*(dims[1]-c-1))
-
-                if constexpr (std::is_same<std::decay_t<T>, float>::value == true
-                              || std::is_same<std::decay_t<T>, double>::value == true) {
-                    // monochrome 0-1 values
-                    image_data[idx] = (static_cast<T>(png[i] + png[i+1] + png[i+2]))/T{765}; // 3*255
-
-                } else if constexpr (std::is_same<std::decay_t<T>, unsigned int>::value == true
-                                     || std::is_same<std::decay_t<T>, unsigned char>::value == true) {
-                    // monochrome, 0-255 values
-                    image_data[idx] = (static_cast<T>(png[i] + png[i+1] + png[i+2]))/T{3};
-
-                } else {
-                    // C++-20 mechanism to trigger a compiler error for the else case. Not user friendly!
-                    //[]<bool flag = false>() { static_assert(flag, "no match"); }();
-                    throw std::runtime_error ("mplot::loadpng: type failure");
-                }
-            }
+        image_data.resize (png.size()/4);
+
+        if constexpr (std::is_same<std::decay_t<T>, float>::value == true
+                      || std::is_same<std::decay_t<T>, double>::value == true) {
+            // monochrome 0-1 values
+            loadpng_impl::convert_rows (png, w, h, image_data.data(), 1, flip, [](const unsigned char* p, T* d) {
+                *d = (static_cast<T>(p[0] + p[1] + p[2]))/T{765}; // 3*255
+            });
+
+        } else if constexpr (std::is_same<std::decay_t<T>, unsigned int>::value == true
+                             || std::is_same<std::decay_t<T>, unsigned char>::value == true) {
+            // monochrome, 0-255 values
+            loadpng_impl::convert_rows (png, w, h, image_data.data(), 1, flip, [](const unsigned char* p, T* d) {
+                *d = (static_cast<T>(p[0] + p[1] + p[2]))/T{3};
+            });
+
+        } else {
+            // C++-20 mechanism to trigger a compiler error for the else case. Not user friendly!
+            //[]<bool flag = false>() { static_assert(flag, "no match"); }();
+            throw std::runtime_error ("mplot::loadpng: type failure");
         }
 
         return dims;
@@ -123,75 +220,30 @@ namespace mplot {
         std::vector<unsigned char> png;
         unsigned int w = 0;
         unsigned int h = 0;
-        // Assume RGBA and bit depth of 8
-        unsigned lprtn = lodepng::decode (png, w, h, filename, LCT_RGBA, 8);
-        if (lprtn != 0) {
-            std::string err = "mplot::loadpng: lodepng::decode returned error code "
-            + std::to_string(lprtn) + std::string(": ") + std::string(lodepng_error_text (lprtn));
-            throw std::runtime_error (err);
-        }
+        loadpng_impl::decode (filename, png, w, h, "mplot::loadpng");
         // For return:
         sm::vec<unsigned int, 2> dims = {w, h};
 
-        // Now convert out into a value placed in image_data
-        // If T is float or double, then get mean RGB, convert to range 0 to 1
-        // If T is of integer type, then get mean and encode in range 0-255
-
-        unsigned int vsz = png.size();
-        if (vsz % 4 != 0) {
-            throw std::runtime_error ("mplot::loadpng: Expect png vector to have size divisible by 4.");
-        }
-
-        image_data.resize (vsz/4);
-
-        for (unsigned int c = 0; c < dims[1]; ++c) {
-            for (unsigned int r = 0; r < dims[0]; ++r) {
-
-                // Offset into png
-                unsigned int i = 4*r + 4*dims[0]*c;
-                // Offset into image_data depends on what flips the caller wants
-                unsigned int idx = flip[0] == true ?
-                (flip[1]==true ? ((dims[0]-r-1) + dims[0]*(dims[1]-c-1)) : ((dims[0]-r-1) + dims[0]*c))
-                : (flip[1]==true ? (r + dims[0]*(dims[1]-c-1)) : (r + dims[0]*c));
-
-                if constexpr ((std::is_same<std::decay_t<T>, float>::value == true
-                               || std::is_same<std::decay_t<T>, double>::value == true) && N==3) {
-                    // RGB, 0-1 values
-                    unsigned char p0 = png[i];
-                    unsigned char p1 = png[i+1];
-                    unsigned char p2 = png[i+2];
-                    image_data[idx] = { static_cast<T>(p0), static_cast<T>(p1), static_cast<T>(p2) };
-                    image_data[idx] /= T{255};
-
-                } else if constexpr ((std::is_same<std::decay_t<T>, float>::value == true
-                                      || std::is_same<std::decay_t<T>, double>::value == true) && N==4) {
-                    // RGBA 0-1 values
-                    image_data[idx][0] = static_cast<T>(png[i]) / T{255};
-                    image_data[idx][1] = static_cast<T>(png[i+1]) / T{255};
-                    image_data[idx][2] = static_cast<T>(png[i+2]) / T{255};
-                    image_data[idx][3] = static_cast<T>(png[i+3]) / T{255};
-
-                } else if constexpr ((std::is_same<std::decay_t<T>, unsigned char>::value == true
-                                      || std::is_same<std::decay_t<T>, unsigned int>::value == true) && N==3) {
-                    // RGB, 0-255 values
-                    image_data[idx][0] = static_cast<T>(png[i]);
-                    image_data[idx][1] = static_cast<T>(png[i+1]);
-                    image_data[idx][2] = static_cast<T>(png[i+2]);
-
-                } else if constexpr ((std::is_same<std::decay_t<T>, unsigned char>::value == true
-                                      || std::is_same<std::decay_t<T>, unsigned int>::value == true) && N==4) {
-                    // RGBA, 0-255 values
-                    image_data[idx][0] = static_cast<T>(png[i]);
-                    image_data[idx][1] = static_cast<T>(png[i+1]);
-                    image_data[idx][2] = static_cast<T>(png[i+2]);
-                    image_data[idx][3] = static_cast<T>(png[i+3]);
-
-                } else {
-                    // C++-20 mechanism to trigger a compiler error for the else case. Not user friendly!
-                    //[]<bool flag = false>() { static_assert(flag, "no match"); }();
-                    throw std::runtime_error ("mplot::loadpng: type failure (or N is not 3 or 4)");
-                }
-            }
+        image_data.resize (png.size()/4);
+
+        if constexpr ((std::is_same<std::decay_t<T>, float>::value == true
+                       || std::is_same<std::decay_t<T>, double>::value == true) && (N == 3 || N == 4)) {
+            // RGB or RGBA, 0-1 values
+            loadpng_impl::convert_rows (png, w, h, image_data.data(), 1, flip, [](const unsigned char* p, sm::vec<T, N>* d) {
+                for (std::size_t j = 0; j < N; ++j) { (*d)[j] = static_cast<T>(p[j]) / T{255}; }
+            });
+
+        } else if constexpr ((std::is_same<std::decay_t<T>, unsigned char>::value == true
+                              || std::is_same<std::decay_t<T>, unsigned int>::value == true) && (N == 3 || N == 4)) {
+            // RGB or RGBA, 0-255 values
+            loadpng_impl::convert_rows (png, w, h, image_data.data(), 1, flip, [](const unsigned char* p, sm::vec<T, N>* d) {
+                for (std::size_t j = 0; j < N; ++j) { (*d)[j] = static_cast<T>(p[j]); }
+            });
+
+        } else {
+            // C++-20 mechanism to trigger a compiler error for the else case. Not user friendly!
+            //[]<bool flag = false>() { static_assert(flag, "no match"); }();
+            throw std::runtime_error ("mplot::loadpng: type failure (or N is not 3 or 4)");
         }
 
         return dims;
@@ -205,61 +257,70 @@ namespace mplot {
         std::vector<unsigned char> png;
         unsigned int w = 0;
         unsigned int h = 0;
-        // Assume RGBA and bit depth of 8
-        unsigned lprtn = lodepng::decode (png, w, h, filename, LCT_RGBA, 8);
-        if (lprtn != 0) {
-            std::string err = "mplot::loadpng_rgb: lodepng::decode returned error code "
-            + std::to_string(lprtn) + std::string(": ") + std::string(lodepng_error_text (lprtn));
-            throw std::runtime_error (err);
-        }
+        loadpng_impl::decode (filename, png, w, h, "mplot::loadpng_rgb");
         // For return:
         sm::vec<unsigned int, 2> dims = {w, h};
 
         // Now convert out into a value placed in image_data
         // If T is float or double, then for each in RGB, convert to range 0 to 1
         // If T is of integer type, then for each in RGB encode in range 0-255
-
-        unsigned int vsz = png.size();
-        if (vsz % 4 != 0) {
-            throw std::runtime_error ("mplot::loadpng_rgb: Expect png vector to have size divisible by 4.");
+        image_data.resize (3*png.size()/4);
+
+        if constexpr (std::is_same<std::decay_t<T>, float>::value == true
+                      || std::is_same<std::decay_t<T>, double>::value == true) {
+            loadpng_impl::convert_rows (png, w, h, image_data.data(), 3, flip, [](const unsigned char* p, T* d) {
+                for (int j = 0; j < 3; ++j) { d[j] = static_cast<T>(p[j])/T{255}; }
+            });
+
+        } else if constexpr (std::is_same<std::decay_t<T>, unsigned int>::value == true
+                             || std::is_same<std::decay_t<T>, unsigned char>::value == true) {
+            // Copy RGB, 0-255 values
+            loadpng_impl::convert_rows (png, w, h, image_data.data(), 3, flip, [](const unsigned char* p, T* d) {
+                for (int j = 0; j < 3; ++j) { d[j] = static_cast<T>(p[j]); }
+            });
+
+        } else {
+            // C++-20 mechanism to trigger a compiler error for the else case. Not user friendly!
+            //[]<bool flag = false>() { static_assert(flag, "no match"); }();
+            throw std::runtime_error ("mplot::loadpng_rgb: type failure");
         }
 
-        image_data.resize (3*vsz/4);
-
-        for (unsigned int c = 0; c < dims[1]; ++c) {
-            for (unsigned int r = 0; r < dims[0]; ++r) {
-                // Offset into png
-                unsigned int i = 4*r + 4*dims[0]*c;
-                // Offset into image_data depends on what flips the caller wants
-                unsigned int idx_r = flip[0] == true ?
-                (flip[1]==true ? ((dims[0]-r-1) + dims[0]*(dims[1]-c-1)) : ((dims[0]-r-1) + dims[0]*c))
-                : (flip[1]==true ? (r + dims[0]*(dims[1]-c-1)) : (r + dims[0]*c));
-                idx_r *= 3; // Because our output is rgbrgb...
-                unsigned int idx_g = flip[0] == true ? idx_r-1 : idx_r+1;
-                unsigned int idx_b = flip[0] == true ? idx_r-2 : idx_r+2;
-
-                if constexpr (std::is_same<std::decay_t<T>, float>::value == true
-                              || std::is_same<std::decay_t<T>, double>::value == true) {
-                    image_data[idx_r] = static_cast<T>(png[i])/T{255};
-                    image_data[idx_g] = static_cast<T>(png[i+1])/T{255};
-                    image_data[idx_b] = static_cast<T>(png[i+2])/T{255};
-
-                } else if constexpr (std::is_same<std::decay_t<T>, unsigned int>::value == true
-                                     || std::is_same<std::decay_t<T>, unsigned char>::value == true) {
-                    // Copy RGB, 0-255 values
-                    image_data[idx_r] = static_cast<T>(png[i]);
-                    image_data[idx_g] = static_cast<T>(png[i+1]);
-                    image_data[idx_b] = static_cast<T>(png[i+2]);
+        return dims;
+    }
 
-                } else {
-                    // C++-20 mechanism to trigger a compiler error for the else case. Not user friendly!
-                    //[]<bool flag = false>() { static_assert(flag, "no match"); }();
-                    throw std::runtime_error ("mplot::loadpng_rgb: type failure");
+    // Convert the w x h RGBA pixels in png into the RGBARGBA... array out (as loadpng_rgba does)
+    template <typename T>
+    static void convert_rgba (const std::vector<unsigned char>& png, const unsigned int w, const unsigned int h,
+                              T* out, const sm::vec<bool,2> flip, const char* caller)
+    {
+        if constexpr (std::is_same<std::decay_t<T>, unsigned char>::value == true) {
+            // Each row is a straight copy of bytes
+            if (!flip[0]) {
+                const std::size_t row = std::size_t{4} * w;
+                for (unsigned int c = 0; c < h; ++c) {
+                    std::memcpy (out + row * (flip[1] ? (h - c - 1) : c), png.data() + row * c, row);
                 }
+            } else {
+                loadpng_impl::convert_rows (png, w, h, out, 4, flip, [](const unsigned char* p, T* d) { std::memcpy (d, p, 4); });
             }
-        }
 
-        return dims;
+        } else if constexpr (std::is_same<std::decay_t<T>, float>::value == true
+                             || std::is_same<std::decay_t<T>, double>::value == true) {
+            loadpng_impl::convert_rows (png, w, h, out, 4, flip, [](const unsigned char* p, T* d) {
+                for (int j = 0; j < 4; ++j) { d[j] = static_cast<T>(p[j])/T{255}; }
+            });
+
+        } else if constexpr (std::is_same<std::decay_t<T>, unsigned int>::value == true) {
+            // Copy RGBA, 0-255 values
+            loadpng_impl::convert_rows (png, w, h, out, 4, flip, [](const unsigned char* p, T* d) {
+                for (int j = 0; j < 4; ++j) { d[j] = static_cast<T>(p[j]); }
+            });
+
+        } else {
+            // C++-20 mechanism to trigger a compiler error for the else case. Not user friendly!
+            //[]<bool flag = false>() { static_assert(flag, "no match"); }();
+            throw std::runtime_error (std::string(caller) + ": type failure");
+        }
     }
 
     // Load a colour PNG and return a vector of type T with elements ordered as RGBARGBARGBA...
@@ -270,62 +331,12 @@ namespace mplot {
         std::vector<unsigned char> png;
         unsigned int w = 0;
         unsigned int h = 0;
-        // Assume RGBA and bit depth of 8
-        unsigned lprtn = lodepng::decode (png, w, h, filename, LCT_RGBA, 8);
-        if (lprtn != 0) {
-            std::string err = "mplot::loadpng_rgba: lodepng::decode returned error code "
-            + std::to_string(lprtn) + std::string(": ") + std::string(lodepng_error_text(lprtn));
-            throw std::runtime_error (err);
-        }
+        loadpng_impl::decode (filename, png, w, h, "mplot::loadpng_rgba");
         // For return:
         sm::vec<unsigned int, 2> dims = {w, h};
 
-        // Now convert out into a value placed in image_data
-        // If T is float or double, then get mean RGB, convert to range 0 to 1
-        // If T is of integer type, then get mean and encode in range 0-255
-
-        unsigned int vsz = png.size();
-        if (vsz % 4 != 0) {
-            throw std::runtime_error ("mplot::loadpng_rgba: Expect png vector to have size divisible by 4.");
-        }
-
-        image_data.resize (vsz);
-
-        for (unsigned int c = 0; c < dims[1]; ++c) {
-            for (unsigned int r = 0; r < dims[0]; ++r) {
-                // Offset into png
-                unsigned int i = 4*r + 4*dims[0]*c;
-                // Offset into image_data depends on what flips the caller wants
-                unsigned int idx_r = flip[0] == true ?
-                (flip[1]==true ? ((dims[0]-r-1) + dims[0]*(dims[1]-c-1)) : ((dims[0]-r-1) + dims[0]*c))
-                : (flip[1]==true ? (r + dims[0]*(dims[1]-c-1)) : (r + dims[0]*c));
-                idx_r *= 4; // Because our output is rgbargba...
-                unsigned int idx_g = flip[0] == true ? idx_r-1 : idx_r+1;
-                unsigned int idx_b = flip[0] == true ? idx_r-2 : idx_r+2;
-                unsigned int idx_a = flip[0] == true ? idx_r-3 : idx_r+3;
-
-                if constexpr (std::is_same<std::decay_t<T>, float>::value == true
-                              || std::is_same<std::decay_t<T>, double>::value == true) {
-                    image_data[idx_r] = static_cast<T>(png[i])/T{255};
-                    image_data[idx_g] = static_cast<T>(png[i+1])/T{255};
-                    image_data[idx_b] = static_cast<T>(png[i+2])/T{255};
-                    image_data[idx_a] = static_cast<T>(png[i+3])/T{255};
-
-                } else if constexpr (std::is_same<std::decay_t<T>, unsigned int>::value == true
-                                     || std::is_same<std::decay_t<T>, unsigned char>::value == true) {
-                    // Copy RGB, 0-255 values
-                    image_data[idx_r] = static_cast<T>(png[i]);
-                    image_data[idx_g] = static_cast<T>(png[i+1]);
-                    image_data[idx_b] = static_cast<T>(png[i+2]);
-                    image_data[idx_a] = static_cast<T>(png[i+3]);
-
-                } else {
-                    // C++-20 mechanism to trigger a compiler error for the else case. Not user friendly!
-                    //[]<bool flag = false>() { static_assert(flag, "no match"); }();
-                    throw std::runtime_error ("mplot::loadpng_rgba: type failure");
-                }
-            }
-        }
+        image_data.resize (png.size());
+        convert_rgba (png, w, h, image_data.data(), flip, "mplot::loadpng_rgba");
 
         return dims;
     }
@@ -338,63 +349,14 @@ namespace mplot {
         std::vector<unsigned char> png;
         unsigned int w = 0;
         unsigned int h = 0;
-        // Assume RGBA and bit depth of 8
-        unsigned lprtn = lodepng::decode (png, w, h, filename, LCT_RGBA, 8);
-        if (lprtn != 0) {
-            std::string err = "mplot::loadpng_rgba: lodepng::decode returned error code "
-            + std::to_string(lprtn) + std::string(": ") + std::string(lodepng_error_text(lprtn));
-            throw std::runtime_error (err);
-        }
+        loadpng_impl::decode (filename, png, w, h, "mplot::loadpng_rgba");
         // For return:
         sm::vec<unsigned int, 2> dims = {w, h};
         if (w != im_w || h != im_h) {
             throw std::runtime_error ("mplot::loadpng_rgba: Expect png to be the size specified in the template args.");
         }
 
-        // Now convert out into a value placed in image_data
-        // If T is float or double, then get mean RGB, convert to range 0 to 1
-        // If T is of integer type, then get mean and encode in range 0-255
-
-        unsigned int vsz = png.size();
-        if (vsz % 4 != 0) {
-            throw std::runtime_error ("mplot::loadpng_rgba: Expect png vector to have size divisible by 4.");
-        }
-
-        for (unsigned int c = 0; c < dims[1]; ++c) {
-            for (unsigned int r = 0; r < dims[0]; ++r) {
-                // Offset into png
-                unsigned int i = 4*r + 4*dims[0]*c;
-                // Offset into image_data depends on what flips the caller wants
-                unsigned int idx_r = flip[0] == true ?
-                (flip[1]==true ? ((dims[0]-r-1) + dims[0]*(dims[1]-c-1)) : ((dims[0]-r-1) + dims[0]*c))
-                : (flip[1]==true ? (r + dims[0]*(dims[1]-c-1)) : (r + dims[0]*c));
-                idx_r *= 4; // Because our output is rgbargba...
-                unsigned int idx_g = flip[0] == true ? idx_r-1 : idx_r+1;
-                unsigned int idx_b = flip[0] == true ? idx_r-2 : idx_r+2;
-                unsigned int idx_a = flip[0] == true ? idx_r-3 : idx_r+3;
-
-                if constexpr (std::is_same<std::decay_t<T>, float>::value == true
-                              || std::is_same<std::decay_t<T>, double>::value == true) {
-                    image_data[idx_r] = static_cast<T>(png[i])/T{255};
-                    image_data[idx_g] = static_cast<T>(png[i+1])/T{255};
-                    image_data[idx_b] = static_cast<T>(png[i+2])/T{255};
-                    image_data[idx_a] = static_cast<T>(png[i+3])/T{255};
-
-                } else if constexpr (std::is_same<std::decay_t<T>, unsigned int>::value == true
-                                     || std::is_same<std::decay_t<T>, unsigned char>::value == true) {
-                    // Copy RGB, 0-255 values
-                    image_data[idx_r] = static_cast<T>(png[i]);
-                    image_data[idx_g] = static_cast<T>(png[i+1]);
-                    image_data[idx_b] = static_cast<T>(png[i+2]);
-                    image_data[idx_a] = static_cast<T>(png[i+3]);
-
-                } else {
-                    // C++-20 mechanism to trigger a compiler error for the else case. Not user friendly!
-                    //[]<bool flag = false>() { static_assert(flag, "no match"); }();
-                    throw std::runtime_error ("mplot::loadpng_rgba: type failure");
-                }
-            }
-        }
+        convert_rgba (png, w, h, image_data.data(), flip, "mplot::loadpng_rgba");
 
         return dims;
     }
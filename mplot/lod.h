@@ -0,0 +1,135 @@
+/*!
+ * \file
+ *
+ * Helpers for VisualModels that hold their geometry at several levels of detail (such as
+ * mplot::HealpixVisual and mplot::GeodesicVisual). Each frame, such a model is given the
+ * projection and the height of the viewport (see VisualModelBase::set_lod_view) and, in its
+ * update_lod(), chooses the spans of its indices to draw so that its elements are about a pixel
+ * across on the screen.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <limits>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <sm/mathconst>
+#include <sm/vec>
+#include <sm/mat44>
+
+namespace mplot::lod {
+
+    //! How the data of the elements of a finer level are combined into an element of a coarser level
+    enum class aggregation { mean, max, min };
+
+    /*!
+     * The length in pixels on the screen of a line of length size (in eye coordinates) that lies
+     * across the line of sight at the point eye (in eye coordinates), for the projection p and a
+     * viewport viewport_h pixels high. This is exact for the orthographic projection and for the
+     * centre of the perspective view.
+     */
+    inline float screen_size (const sm::mat44<float>& p, const sm::vec<float, 4>& eye,
+                              const float size, const int viewport_h)
+    {
+        const sm::vec<float, 4> clip = p * eye;
+        const float w = std::abs (clip[3]);
+        if (w < std::numeric_limits<float>::epsilon()) { return std::numeric_limits<float>::max(); }
+        // p.mat[5] scales eye y into clip y, and clip space is 2 units high
+        return size * std::abs (p.mat[5]) / w * 0.5f * static_cast<float>(viewport_h);
+    }
+
+    //! Append the span [first, first + count) to spans, extending the last span if the two are contiguous
+    template <typename S>
+    inline void append_span (std::vector<S>& spans, const std::size_t first, const std::size_t count)
+    {
+        if (count == 0) { return; }
+        if (!spans.empty() && spans.back().first + spans.back().count == first) {
+            spans.back().count += count;
+        } else {
+            S s;
+            s.first = first;
+            s.count = count;
+            spans.push_back (s);
+        }
+    }
+
+    /*!
+     * For each of the unit vectors in from, find the nearest of the unit vectors in to. The
+     * vectors in to are put into a grid of cells about as wide as the spacing between them, and
+     * the cells around each vector in from are searched, in growing shells, until the nearest is
+     * certain to have been found. Returns the indices into to, one for each element of from.
+     */
+    inline std::vector<std::uint32_t> nearest (const std::vector<sm::vec<float>>& from,
+                                               const std::vector<sm::vec<float>>& to)
+    {
+        std::vector<std::uint32_t> near (from.size(), 0u);
+        if (to.size() < 2u) { return near; }
+
+        // Cells of about the spacing of evenly spread points on the unit sphere
+        const float cell = std::sqrt (4.0f * sm::mathconst<float>::pi / static_cast<float>(to.size()));
+        const std::int64_t n = static_cast<std::int64_t>(std::ceil (2.0f / cell)) + 1;
+        auto cell_of = [cell, n](const sm::vec<float>& v) {
+            sm::vec<std::int64_t, 3> c;
+            for (int i = 0; i < 3; ++i) {
+                c[i] = std::clamp (static_cast<std::int64_t>((v[i] + 1.0f) / cell), std::int64_t{0}, n - 1);
+            }
+            return c;
+        };
+        auto key_of = [n](const sm::vec<std::int64_t, 3>& c) { return static_cast<std::uint64_t>((c[0] * n + c[1]) * n + c[2]); };
+
+        // Sort the vectors in to by cell, and record where each occupied cell's vectors start and end
+        std::vector<std::pair<std::uint64_t, std::uint32_t>> keyed (to.size());
+        for (std::size_t i = 0; i < to.size(); ++i) { keyed[i] = { key_of (cell_of (to[i])), static_cast<std::uint32_t>(i) }; }
+        std::sort (keyed.begin(), keyed.end());
+        std::unordered_map<std::uint64_t, std::pair<std::size_t, std::size_t>> cells;
+        for (std::size_t i = 0; i < keyed.size();) {
+            std::size_t j = i;
+            while (j < keyed.size() && keyed[j].first == keyed[i].first) { ++j; }
+            cells[keyed[i].first] = { i, j };
+            i = j;
+        }
+
+        const std::int64_t n_from = static_cast<std::int64_t>(from.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (std::int64_t fi = 0; fi < n_from; ++fi) {
+            const sm::vec<float>& v = from[fi];
+            const sm::vec<std::int64_t, 3> c = cell_of (v);
+            float best_d = std::numeric_limits<float>::max();
+            std::uint32_t best = 0u;
+            for (std::int64_t r = 0; r < n; ++r) {
+                // The cells of the shell r away from c
+                for (std::int64_t dx = -r; dx <= r; ++dx) {
+                    for (std::int64_t dy = -r; dy <= r; ++dy) {
+                        for (std::int64_t dz = -r; dz <= r; ++dz) {
+                            if (std::max ({ std::abs (dx), std::abs (dy), std::abs (dz) }) != r) { continue; }
+                            const sm::vec<std::int64_t, 3> cc = { c[0] + dx, c[1] + dy, c[2] + dz };
+                            if (cc[0] < 0 || cc[1] < 0 || cc[2] < 0 || cc[0] >= n || cc[1] >= n || cc[2] >= n) { continue; }
+                            auto ci = cells.find (key_of (cc));
+                            if (ci == cells.end()) { continue; }
+                            for (std::size_t k = ci->second.first; k < ci->second.second; ++k) {
+                                const float d = (to[keyed[k].second] - v).length_sq();
+                                if (d < best_d) { best_d = d; best = keyed[k].second; }
+                            }
+                        }
+                    }
+                }
+                // Anything beyond the shells searched so far is more than r cells away
+                const float searched = static_cast<float>(r) * cell;
+                if (best_d <= searched * searched) { break; }
+            }
+            near[fi] = best;
+        }
+        return near;
+    }
+
+} // namespace mplot::lod
@@ -2054,6 +2054,10 @@ Copyright (c) 2005-2021 Lode Vandevenne
 
 // END INCLUDE lodepng.h
 
+// When linking to the mplot_core library (MPLOT_CORE), the implementation is compiled once, into
+// the library (see core/lodepng.cpp), and each translation unit sees only the declarations above
+#if !(defined MPLOT_CORE && !defined MPLOT_CORE_LODEPNG)
+
 #ifdef LODEPNG_COMPILE_DISK
 #include <limits.h> /* LONG_MAX */
 #include <stdio.h> /* file handling */
@@ -8519,3 +8523,5 @@ unsigned encode(const std::string& filename,
 #endif /* LODEPNG_COMPILE_PNG */
 } /* namespace lodepng */
 #endif /*LODEPNG_COMPILE_CPP*/
+
+#endif // !(MPLOT_CORE && !MPLOT_CORE_LODEPNG)
@@ -0,0 +1,89 @@
+/*!
+ * \file
+ *
+ * mapped_file, a read-only view of a whole file that is memory mapped where possible. Used to
+ * read large binary files (MNIST IDX files, .glb meshes) without copying them into memory first.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cstddef>
+
+#ifdef _WIN32
+// No mmap on Windows; mapped_file reads the whole file instead
+# include <fstream>
+#else
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+namespace mplot {
+
+    //! A read-only view of a whole file, memory mapped where possible
+    struct mapped_file
+    {
+        /*!
+         * Map the file at path. If sequential, tell the kernel that the file will be read from
+         * start to end (so that it reads ahead aggressively and can drop pages behind the reader).
+         */
+        mapped_file (const std::string& path, const bool sequential = false)
+        {
+#ifdef _WIN32
+            std::ifstream f (path, std::ios::in | std::ios::binary | std::ios::ate);
+            if (!f.is_open()) { throw std::runtime_error ("mapped_file: Can't open " + path); }
+            this->buf.resize (static_cast<std::size_t>(f.tellg()));
+            f.seekg (0);
+            f.read (reinterpret_cast<char*>(this->buf.data()), static_cast<std::streamsize>(this->buf.size()));
+            this->p = this->buf.data();
+            this->sz = this->buf.size();
+            (void)sequential;
+#else
+            int fd = open (path.c_str(), O_RDONLY);
+            if (fd < 0) { throw std::runtime_error ("mapped_file: Can't open " + path); }
+            struct stat st;
+            if (fstat (fd, &st) != 0) {
+                close (fd);
+                throw std::runtime_error ("mapped_file: Can't stat " + path);
+            }
+            this->sz = static_cast<std::size_t>(st.st_size);
+            if (this->sz > 0) {
+                void* m = mmap (nullptr, this->sz, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (m == MAP_FAILED) {
+                    close (fd);
+                    throw std::runtime_error ("mapped_file: Can't mmap " + path);
+                }
+                if (sequential) { madvise (m, this->sz, MADV_SEQUENTIAL); } // only a hint
+                this->p = static_cast<const unsigned char*>(m);
+            }
+            close (fd); // the mapping stays valid
+#endif
+        }
+        ~mapped_file()
+        {
+#ifndef _WIN32
+            if (this->p != nullptr) { munmap (const_cast<unsigned char*>(this->p), this->sz); }
+#endif
+        }
+        mapped_file (const mapped_file&) = delete;
+        mapped_file& operator= (const mapped_file&) = delete;
+
+        const unsigned char* data() const { return this->p; }
+        std::size_t size() const { return this->sz; }
+
+    private:
+        const unsigned char* p = nullptr;
+        std::size_t sz = 0;
+#ifdef _WIN32
+        std::vector<unsigned char> buf;
+#endif
+    };
+
+} // namespace mplot
@@ -0,0 +1,176 @@
+/*!
+ * \file
+ *
+ * A memory_report lists the memory held by a VisualModel (see VisualModelBase::get_memory_report),
+ * by a Visual's models and shared resources (VisualBase::getMemoryReport) or by the glyph atlas
+ * of a font face: the bytes in use and the bytes allocated of each of its std::vectors, and the
+ * bytes of each of its GL buffers and textures. A vector whose capacity is far above its size
+ * (one that was never shrunk after a build, say) shows up as unused capacity, and a report's
+ * children (a model's texts, a Visual's models) show which of them holds the most. Buffers that
+ * models share are reported by each of them (as shared), but counted once in the totals.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <set>
+#include <cstddef>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+namespace mplot {
+
+    //! One block of memory: a std::vector's data, or a GL buffer or texture
+    struct memory_item
+    {
+        std::string name;
+        //! The bytes in use (for a std::vector, its size)
+        std::size_t used = 0;
+        //! The bytes allocated (for a std::vector, its capacity). For GPU memory, as used.
+        std::size_t allocated = 0;
+        //! True if this is GPU memory
+        bool gpu = false;
+        //! True if the GPU memory may be shared with other models (which then all report it)
+        bool shared = false;
+        //! The GL name of a shared buffer, by which it is counted once in a report's totals
+        std::uint32_t gl_name = 0;
+    };
+
+    struct memory_report
+    {
+        //! What the report is of ("HexGridVisual", "texts", "glyph atlas", say)
+        std::string name;
+        std::vector<memory_item> items;
+        std::vector<memory_report> children;
+
+        //! Add the data of the vector v, if it has any capacity
+        template <typename T>
+        void add_vector (const std::string& n, const std::vector<T>& v)
+        {
+            if (v.capacity() == 0u) { return; }
+            this->items.push_back ({ n, v.size() * sizeof (T), v.capacity() * sizeof (T), false, false, 0u });
+        }
+
+        //! Add bytes of CPU memory, of which used are in use
+        void add_cpu (const std::string& n, const std::size_t used, const std::size_t allocated)
+        {
+            if (allocated == 0u) { return; }
+            this->items.push_back ({ n, used, allocated, false, false, 0u });
+        }
+
+        //! Add bytes of GPU memory (a buffer or a texture), if there are any. A shared buffer
+        //! (one that may also be in other reports) should be given its GL name.
+        void add_gpu (const std::string& n, const std::size_t bytes, const bool shared = false, const std::uint32_t gl_name = 0)
+        {
+            if (bytes == 0u) { return; }
+            this->items.push_back ({ n, bytes, bytes, true, shared, gl_name });
+        }
+
+        //! The CPU bytes in use by this report's items and those of its children
+        std::size_t cpu_used() const { return this->total ([](const memory_item& i) { return i.gpu ? 0u : i.used; }); }
+        //! The CPU bytes allocated
+        std::size_t cpu_allocated() const { return this->total ([](const memory_item& i) { return i.gpu ? 0u : i.allocated; }); }
+        //! The CPU bytes allocated but not in use (reserved capacity, or vectors that were never shrunk)
+        std::size_t cpu_unused() const { return this->cpu_allocated() - this->cpu_used(); }
+        //! The GPU bytes, counting each shared buffer once
+        std::size_t gpu_bytes() const
+        {
+            std::set<std::uint32_t> seen;
+            return this->gpu_total (seen, false);
+        }
+        //! The GPU bytes that may be shared with other reports
+        std::size_t gpu_shared_bytes() const
+        {
+            std::set<std::uint32_t> seen;
+            return this->gpu_total (seen, true);
+        }
+
+        //! bytes in B, kB, MB or GB
+        static std::string bytes_str (const std::size_t bytes)
+        {
+            std::stringstream ss;
+            const char* units[] = { "B", "kB", "MB", "GB", "TB" };
+            double b = static_cast<double>(bytes);
+            unsigned int u = 0;
+            while (b >= 1024.0 && u < 4u) { b /= 1024.0; ++u; }
+            ss << std::fixed << std::setprecision (u == 0u ? 0 : 1) << b << " " << units[u];
+            return ss.str();
+        }
+
+        /*!
+         * A short summary: the totals, and then the n children with the most memory (CPU
+         * allocated plus GPU), one to a line. This is the text that is shown in a Visual's window
+         * (see visual_options::showMemory).
+         */
+        std::string summary (const std::size_t n = 5) const
+        {
+            std::stringstream ss;
+            ss << this->name << ": CPU " << bytes_str (this->cpu_allocated()) << " (" << bytes_str (this->cpu_unused())
+               << " unused), GPU " << bytes_str (this->gpu_bytes());
+            if (this->gpu_shared_bytes() > 0u) { ss << " (" << bytes_str (this->gpu_shared_bytes()) << " shared)"; }
+            std::vector<const memory_report*> c;
+            for (const auto& ch : this->children) { c.push_back (&ch); }
+            std::stable_sort (c.begin(), c.end(), [](const memory_report* a, const memory_report* b) {
+                return a->cpu_allocated() + a->gpu_bytes() > b->cpu_allocated() + b->gpu_bytes();
+            });
+            for (std::size_t i = 0; i < std::min (n, c.size()); ++i) {
+                ss << "\n  " << c[i]->name << ": CPU " << bytes_str (c[i]->cpu_allocated())
+                   << " (" << bytes_str (c[i]->cpu_unused()) << " unused), GPU " << bytes_str (c[i]->gpu_bytes());
+            }
+            if (c.size() > n) { ss << "\n  (and " << (c.size() - n) << " more)"; }
+            return ss.str();
+        }
+
+        //! The whole report, as JSON, with the totals of each level
+        nlohmann::json json() const
+        {
+            nlohmann::json j;
+            j["name"] = this->name;
+            j["cpu_used"] = this->cpu_used();
+            j["cpu_allocated"] = this->cpu_allocated();
+            j["gpu"] = this->gpu_bytes();
+            j["items"] = nlohmann::json::array();
+            for (const auto& i : this->items) {
+                nlohmann::json ji;
+                ji["name"] = i.name;
+                ji[i.gpu ? "gpu" : "cpu_used"] = i.used;
+                if (!i.gpu) { ji["cpu_allocated"] = i.allocated; }
+                if (i.shared) { ji["shared"] = true; ji["gl_name"] = i.gl_name; }
+                j["items"].push_back (ji);
+            }
+            j["children"] = nlohmann::json::array();
+            for (const auto& c : this->children) { j["children"].push_back (c.json()); }
+            return j;
+        }
+
+    private:
+        template <typename F>
+        std::size_t total (F f) const
+        {
+            std::size_t t = 0u;
+            for (const auto& i : this->items) { t += f (i); }
+            for (const auto& c : this->children) { t += c.total (f); }
+            return t;
+        }
+
+        std::size_t gpu_total (std::set<std::uint32_t>& seen, const bool shared_only) const
+        {
+            std::size_t t = 0u;
+            for (const auto& i : this->items) {
+                if (!i.gpu || (shared_only && !i.shared)) { continue; }
+                if (i.shared && i.gl_name != 0u && !seen.insert (i.gl_name).second) { continue; }
+                t += i.used;
+            }
+            for (const auto& c : this->children) { t += c.gpu_total (seen, shared_only); }
+            return t;
+        }
+    };
+
+} // namespace mplot
@@ -0,0 +1,188 @@
+/*!
+ * \file
+ *
+ * A set of selected elements of a grid, each with a colour. This is what
+ * mplot::GridVisual::selected_pix holds. Membership is a dense bitset, so that testing an
+ * element is a shift and a mask, and each selected element holds a 16 bit index into a small
+ * palette of the colours in use, rather than a colour of its own.
+ *
+ * A pixel_selection is used much as a std::unordered_map<I, std::array<float, 3>> would be:
+ *
+ *   sel[6] = mplot::colour::forestgreen;   // select element 6
+ *   if (sel.contains (6)) { ... }
+ *   sel.erase (6);
+ *   for (auto sp : sel) { ... }            // sp.first is the index, sp.second the colour
+ *
+ * but iteration is in order of element index.
+ *
+ * \author Seb James
+ * \date 2026
+ */
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <utility>
+#include <algorithm>
+#include <limits>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+namespace mplot {
+
+    template <typename I>
+    struct pixel_selection
+    {
+        using colour_type = std::array<float, 3>;
+        using value_type = std::pair<I, colour_type>;
+
+        //! What sel[i] returns, so that sel[i] = clr selects element i with colour clr
+        struct reference
+        {
+            pixel_selection* sel;
+            I i;
+            reference& operator= (const colour_type& clr)
+            {
+                this->sel->set (this->i, clr);
+                return *this;
+            }
+            operator colour_type() const { return this->sel->at (this->i); }
+        };
+
+        //! Iterates over the selected elements in order of index
+        struct const_iterator
+        {
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = pixel_selection::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = value_type;
+
+            const pixel_selection* sel = nullptr;
+            std::size_t k = npos;
+
+            value_type operator*() const { return { static_cast<I>(this->k), this->sel->palette[this->sel->clr_idx[this->k]] }; }
+            const_iterator& operator++() { this->k = this->sel->next_from (this->k + 1u); return *this; }
+            const_iterator operator++ (int) { const_iterator t = *this; ++(*this); return t; }
+            bool operator== (const const_iterator& o) const { return this->k == o.k; }
+            bool operator!= (const const_iterator& o) const { return this->k != o.k; }
+        };
+
+        reference operator[] (const I i) { return reference{ this, i }; }
+
+        //! Select element i with colour clr (or change its colour if it is already selected)
+        void set (const I i, const colour_type& clr)
+        {
+            const std::size_t k = pixel_selection::to_index (i);
+            if (k >= this->clr_idx.size()) { this->reserve (k + 1u); }
+            this->clr_idx[k] = this->palette_index (clr);
+            std::uint64_t& w = this->bits[k >> 6];
+            const std::uint64_t b = std::uint64_t{1} << (k & 63u);
+            if ((w & b) == 0u) {
+                w |= b;
+                ++this->n_selected;
+            }
+        }
+
+        //! True if element i is selected
+        bool contains (const I i) const
+        {
+            if constexpr (std::is_signed_v<I>) { if (i < 0) { return false; } }
+            const std::size_t k = static_cast<std::size_t>(i);
+            return (k >> 6) < this->bits.size() && (this->bits[k >> 6] >> (k & 63u)) & 1u;
+        }
+
+        //! The colour of selected element i. Throws std::out_of_range if i is not selected.
+        colour_type at (const I i) const
+        {
+            if (!this->contains (i)) { throw std::out_of_range ("mplot::pixel_selection::at: element is not selected"); }
+            return this->palette[this->clr_idx[static_cast<std::size_t>(i)]];
+        }
+
+        //! Deselect element i. Returns the number of elements deselected (0 or 1).
+        std::size_t erase (const I i)
+        {
+            if (!this->contains (i)) { return 0u; }
+            const std::size_t k = static_cast<std::size_t>(i);
+            this->bits[k >> 6] &= ~(std::uint64_t{1} << (k & 63u));
+            --this->n_selected;
+            return 1u;
+        }
+
+        //! Deselect every element and forget the palette. The storage is kept.
+        void clear()
+        {
+            std::fill (this->bits.begin(), this->bits.end(), std::uint64_t{0});
+            this->palette.clear();
+            this->n_selected = 0u;
+        }
+
+        //! Make room for the elements 0 to n - 1, so that selecting them does not allocate
+        void reserve (const std::size_t n)
+        {
+            const std::size_t words = (n + 63u) / 64u;
+            if (words <= this->bits.size()) { return; }
+            this->bits.resize (words, std::uint64_t{0});
+            this->clr_idx.resize (64u * words, std::uint16_t{0});
+        }
+
+        bool empty() const { return this->n_selected == 0u; }
+        std::size_t size() const { return this->n_selected; }
+
+        //! The colours in use (an element's colour is one of these)
+        const std::vector<colour_type>& get_palette() const { return this->palette; }
+
+        const_iterator begin() const { return const_iterator{ this, this->next_from (0u) }; }
+        const_iterator end() const { return const_iterator{ this, npos }; }
+
+    private:
+        static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+        static std::size_t to_index (const I i)
+        {
+            if constexpr (std::is_signed_v<I>) {
+                if (i < 0) { throw std::out_of_range ("mplot::pixel_selection: negative element index"); }
+            }
+            return static_cast<std::size_t>(i);
+        }
+
+        //! The index in palette of clr, which is added if it is new
+        std::uint16_t palette_index (const colour_type& clr)
+        {
+            for (std::size_t p = 0; p < this->palette.size(); ++p) {
+                if (this->palette[p] == clr) { return static_cast<std::uint16_t>(p); }
+            }
+            if (this->palette.size() > std::numeric_limits<std::uint16_t>::max()) {
+                throw std::runtime_error ("mplot::pixel_selection: too many distinct colours");
+            }
+            this->palette.push_back (clr);
+            return static_cast<std::uint16_t>(this->palette.size() - 1u);
+        }
+
+        //! The first selected element at or after k, or npos
+        std::size_t next_from (const std::size_t k) const
+        {
+            std::size_t w = k >> 6;
+            if (w >= this->bits.size()) { return npos; }
+            std::uint64_t word = this->bits[w] & (~std::uint64_t{0} << (k & 63u));
+            while (word == 0u) {
+                if (++w == this->bits.size()) { return npos; }
+                word = this->bits[w];
+            }
+            return (w << 6) + static_cast<std::size_t>(std::countr_zero (word));
+        }
+
+        //! One bit per element, set if the element is selected
+        std::vector<std::uint64_t> bits;
+        //! The index into palette of the colour of each element (meaningful where its bit is set)
+        std::vector<std::uint16_t> clr_idx;
+        std::vector<colour_type> palette;
+        std::size_t n_selected = 0u;
+    };
+
+} // namespace mplot
@@ -0,0 +1,303 @@
+/*!
+ * \file
+ *
+ * An on-disk octree of a point cloud, for mplot::PointCloudVisual to draw clouds that are
+ * larger than GPU memory. build() writes the octree to a binary file and octree_file reads it
+ * back through a memory mapping (see mplot::mapped_file), so a node's points are read from disk
+ * only when it is first wanted.
+ *
+ * Each node holds a subsample of the points in its cube: at most one point in each cell of a
+ * sample_grid cubed grid over the cube, so that its points are spaced about spacing apart. The
+ * points it does not take are passed on to its eight children. Every point is in exactly one
+ * node, and drawing a node together with its ancestors shows all the points of its cube at that
+ * node's spacing (additive refinement). A node of no more than max_leaf_points points is a leaf
+ * and holds all of them.
+ *
+ * The file is a file_header, then the points of each node (in the order of the nodes) as
+ * file_points, then the nodes as file_nodes, in breadth first order, so that the children of a
+ * node are consecutive. All the records are little endian and naturally aligned.
+ *
+ * \author Seb James
+ * \date 2026
+ */
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <span>
+#include <bit>
+#include <deque>
+#include <string>
+#include <memory>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include <sm/vec>
+#include <mplot/mapped_file.h>
+
+namespace mplot {
+    namespace point_octree {
+
+        //! The first eight bytes of an octree file
+        static constexpr std::array<char, 8> magic = { 'M', 'P', 'O', 'C', 'T', 'R', 'E', 'E' };
+        static constexpr std::uint32_t file_version = 1;
+
+        struct file_header
+        {
+            std::array<char, 8> magic = point_octree::magic;
+            std::uint32_t version = file_version;
+            std::uint32_t n_nodes = 0;
+            std::uint64_t n_points = 0;
+            //! The cube of the root node: its lowest corner and the length of its sides
+            std::array<float, 3> lo = { 0.0f, 0.0f, 0.0f };
+            float size = 0.0f;
+            //! Where the nodes start, in bytes from the start of the file
+            std::uint64_t nodes_offset = 0;
+            //! The most points in any one node
+            std::uint32_t max_node_points = 0;
+            std::uint32_t sample_grid = 0;
+            //! The range of the values of the points
+            std::array<float, 2> value_range = { 0.0f, 0.0f };
+        };
+        static_assert (sizeof (file_header) == 64u, "file_header must be 64 bytes");
+
+        struct file_point
+        {
+            std::array<float, 3> p = { 0.0f, 0.0f, 0.0f };
+            float value = 0.0f;
+        };
+        static_assert (sizeof (file_point) == 16u, "file_point must be 16 bytes");
+
+        struct file_node
+        {
+            //! The centre of the node's cube and half the length of its sides
+            std::array<float, 3> centre = { 0.0f, 0.0f, 0.0f };
+            float half = 0.0f;
+            //! The spacing of the node's points (the size of a cell of its sample grid)
+            float spacing = 0.0f;
+            std::uint32_t count = 0;
+            //! The node's first point, counted in points from the first point of the file
+            std::uint64_t first_point = 0;
+            //! The index of the node's first child; its children are consecutive
+            std::uint32_t first_child = 0;
+            //! Bit i is set if the node has a child in octant i (bit 0 of i for x, 1 for y, 2 for z)
+            std::uint8_t child_mask = 0;
+            std::uint8_t depth = 0;
+            std::uint16_t reserved = 0;
+
+            unsigned int n_children() const { return static_cast<unsigned int>(std::popcount (this->child_mask)); }
+        };
+        static_assert (sizeof (file_node) == 40u, "file_node must be 40 bytes");
+
+        //! How to build an octree
+        struct build_params
+        {
+            //! A node takes at most one point from each cell of a sample_grid cubed grid over its cube
+            unsigned int sample_grid = 32;
+            //! A node with no more points than this is a leaf
+            unsigned int max_leaf_points = 32768;
+            //! The deepest a node can be (which bounds the depth for coincident points)
+            unsigned int max_depth = 20;
+        };
+
+        /*!
+         * Build the octree of the points (and their values, which may be empty) and write it to
+         * the file at path. Points with a NaN coordinate are left out. The points are reordered
+         * through an index, so the memory needed is the points' and an index's, and each node's
+         * points are written as soon as they are chosen.
+         */
+        inline file_header build (std::span<const sm::vec<float>> points, std::span<const float> values,
+                                  const std::string& path, const build_params& bp = {})
+        {
+            if (!values.empty() && values.size() != points.size()) {
+                throw std::runtime_error ("mplot::point_octree::build: there must be one value per point, or none");
+            }
+            if (bp.sample_grid == 0 || bp.sample_grid > 1024 || bp.max_leaf_points == 0 || bp.max_depth > 255) {
+                throw std::runtime_error ("mplot::point_octree::build: bad build_params");
+            }
+            std::vector<std::uint64_t> idx;
+            idx.reserve (points.size());
+            file_header hdr;
+            hdr.sample_grid = bp.sample_grid;
+            constexpr float inf = std::numeric_limits<float>::infinity();
+            std::array<float, 3> lo = { inf, inf, inf };
+            std::array<float, 3> hi = { -inf, -inf, -inf };
+            std::array<float, 2> vr = { inf, -inf };
+            for (std::size_t i = 0; i < points.size(); ++i) {
+                const sm::vec<float>& p = points[i];
+                if (std::isnan (p[0]) || std::isnan (p[1]) || std::isnan (p[2])) { continue; }
+                idx.push_back (i);
+                for (unsigned int j = 0; j < 3u; ++j) {
+                    lo[j] = std::min (lo[j], p[j]);
+                    hi[j] = std::max (hi[j], p[j]);
+                }
+                if (!values.empty()) {
+                    vr[0] = std::min (vr[0], values[i]);
+                    vr[1] = std::max (vr[1], values[i]);
+                }
+            }
+            if (idx.empty()) { lo = hi = { 0.0f, 0.0f, 0.0f }; }
+            if (!(vr[1] >= vr[0])) { vr = { 0.0f, 0.0f }; }
+            // The root is a cube a little larger than the points, so that the highest points
+            // fall inside its last cells
+            const float extent = std::max ({ hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2] });
+            hdr.size = extent > 0.0f ? extent * (1.0f + 1e-5f) : 1.0f;
+            hdr.lo = lo;
+            hdr.n_points = idx.size();
+            hdr.value_range = vr;
+
+            std::ofstream f (path, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!f.is_open()) { throw std::runtime_error ("mplot::point_octree::build: Can't open " + path); }
+            f.write (reinterpret_cast<const char*>(&hdr), sizeof (hdr));
+
+            struct pending
+            {
+                std::size_t b = 0;
+                std::size_t e = 0;
+                std::uint32_t node = 0;
+            };
+            std::vector<file_node> nodes (1);
+            nodes[0].half = 0.5f * hdr.size;
+            for (unsigned int j = 0; j < 3u; ++j) { nodes[0].centre[j] = lo[j] + nodes[0].half; }
+            std::deque<pending> queue = { { 0u, idx.size(), 0u } };
+
+            const std::size_t g = bp.sample_grid;
+            std::vector<std::uint8_t> taken (g * g * g);
+            std::vector<std::uint64_t> rest;
+            std::vector<file_point> out;
+            std::uint64_t next_point = 0;
+            while (!queue.empty()) {
+                const pending pd = queue.front();
+                queue.pop_front();
+                file_node& nd = nodes[pd.node];
+                const std::size_t n = pd.e - pd.b;
+                const std::array<float, 3> c0 = { nd.centre[0] - nd.half, nd.centre[1] - nd.half, nd.centre[2] - nd.half };
+                const float cell = 2.0f * nd.half / static_cast<float>(g);
+                auto cell_of = [&](const sm::vec<float>& p, const unsigned int j) {
+                    return std::min (static_cast<std::size_t>(std::max (0.0f, (p[j] - c0[j]) / cell)), g - 1u);
+                };
+
+                // Take the first point in each cell of the sample grid; the others are passed on
+                std::size_t taken_n = n;
+                if (n > bp.max_leaf_points && nd.depth < bp.max_depth) {
+                    std::fill (taken.begin(), taken.end(), std::uint8_t{0});
+                    rest.clear();
+                    taken_n = 0;
+                    for (std::size_t i = pd.b; i < pd.e; ++i) {
+                        const sm::vec<float>& p = points[idx[i]];
+                        const std::size_t k = (cell_of (p, 2) * g + cell_of (p, 1)) * g + cell_of (p, 0);
+                        if (taken[k]) {
+                            rest.push_back (idx[i]);
+                        } else {
+                            taken[k] = 1u;
+                            idx[pd.b + taken_n++] = idx[i];
+                        }
+                    }
+                }
+                nd.count = static_cast<std::uint32_t>(taken_n);
+                nd.first_point = next_point;
+                nd.spacing = taken_n < n ? cell : 0.0f;
+                next_point += taken_n;
+                hdr.max_node_points = std::max (hdr.max_node_points, nd.count);
+                out.resize (taken_n);
+                for (std::size_t i = 0; i < taken_n; ++i) {
+                    const std::uint64_t pi = idx[pd.b + i];
+                    out[i].p = { points[pi][0], points[pi][1], points[pi][2] };
+                    out[i].value = values.empty() ? 0.0f : values[pi];
+                }
+                f.write (reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size() * sizeof (file_point)));
+                if (taken_n == n) { continue; }
+
+                // Sort the rest into the octants, back into idx after the taken points
+                std::array<std::size_t, 9> oct_first = {};
+                auto octant = [&nd](const sm::vec<float>& p) {
+                    return (p[0] >= nd.centre[0] ? 1u : 0u) | (p[1] >= nd.centre[1] ? 2u : 0u) | (p[2] >= nd.centre[2] ? 4u : 0u);
+                };
+                for (const std::uint64_t pi : rest) { ++oct_first[octant (points[pi]) + 1u]; }
+                for (unsigned int o = 0; o < 8u; ++o) { oct_first[o + 1u] += oct_first[o]; }
+                std::array<std::size_t, 8> fill = {};
+                const std::size_t base = pd.b + taken_n;
+                for (const std::uint64_t pi : rest) {
+                    const unsigned int o = octant (points[pi]);
+                    idx[base + oct_first[o] + fill[o]++] = pi;
+                }
+                // The children are appended together, which keeps them consecutive
+                const std::uint32_t first_child = static_cast<std::uint32_t>(nodes.size());
+                std::uint8_t mask = 0;
+                const std::array<float, 3> centre = nd.centre;
+                const float half = nd.half;
+                const std::uint8_t depth = nd.depth;
+                for (unsigned int o = 0; o < 8u; ++o) {
+                    if (oct_first[o + 1u] == oct_first[o]) { continue; }
+                    mask |= static_cast<std::uint8_t>(1u << o);
+                    file_node ch;
+                    ch.half = 0.5f * half;
+                    for (unsigned int j = 0; j < 3u; ++j) { ch.centre[j] = centre[j] + ((o >> j) & 1u ? ch.half : -ch.half); }
+                    ch.depth = static_cast<std::uint8_t>(depth + 1u);
+                    queue.push_back ({ base + oct_first[o], base + oct_first[o + 1u], static_cast<std::uint32_t>(nodes.size()) });
+                    nodes.push_back (ch);
+                }
+                // nd may have moved as nodes grew
+                nodes[pd.node].first_child = first_child;
+                nodes[pd.node].child_mask = mask;
+            }
+
+            hdr.n_nodes = static_cast<std::uint32_t>(nodes.size());
+            hdr.nodes_offset = sizeof (file_header) + next_point * sizeof (file_point);
+            f.write (reinterpret_cast<const char*>(nodes.data()), static_cast<std::streamsize>(nodes.size() * sizeof (file_node)));
+            f.seekp (0);
+            f.write (reinterpret_cast<const char*>(&hdr), sizeof (hdr));
+            if (!f.good()) { throw std::runtime_error ("mplot::point_octree::build: Can't write " + path); }
+            return hdr;
+        }
+
+        //! An octree file, read through a memory mapping
+        struct octree_file
+        {
+            octree_file (const std::string& path)
+                : mf (std::make_unique<mplot::mapped_file> (path))
+            {
+                if (this->mf->size() < sizeof (file_header)) {
+                    throw std::runtime_error ("mplot::point_octree: " + path + " is too short to be an octree");
+                }
+                std::memcpy (&this->hdr, this->mf->data(), sizeof (file_header));
+                if (this->hdr.magic != magic || this->hdr.version != file_version) {
+                    throw std::runtime_error ("mplot::point_octree: " + path + " is not an octree file of this version");
+                }
+                const std::uint64_t pts_end = sizeof (file_header) + this->hdr.n_points * sizeof (file_point);
+                if (this->hdr.nodes_offset != pts_end
+                    || this->mf->size() < this->hdr.nodes_offset + std::uint64_t{this->hdr.n_nodes} * sizeof (file_node)) {
+                    throw std::runtime_error ("mplot::point_octree: " + path + " is truncated");
+                }
+            }
+
+            const file_header& header() const { return this->hdr; }
+
+            std::span<const file_node> nodes() const
+            {
+                return { reinterpret_cast<const file_node*>(this->mf->data() + this->hdr.nodes_offset), this->hdr.n_nodes };
+            }
+
+            //! The points of node i. Reading them pages them in from the disk.
+            std::span<const file_point> points (const std::uint32_t i) const
+            {
+                const file_node& nd = this->nodes()[i];
+                if (nd.first_point + nd.count > this->hdr.n_points) {
+                    throw std::runtime_error ("mplot::point_octree: a node's points are outside the file");
+                }
+                return { reinterpret_cast<const file_point*>(this->mf->data() + sizeof (file_header)) + nd.first_point, nd.count };
+            }
+
+        private:
+            std::unique_ptr<mplot::mapped_file> mf;
+            file_header hdr;
+        };
+
+    } // namespace point_octree
+} // namespace mplot
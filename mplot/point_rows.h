@@ -0,0 +1,115 @@
+/*!
+ * \file
+ *
+ * The triangulation of a surface made of rows of points, for PointRowsVisual and
+ * PointRowsMeshVisual. The points are listed row by row (in slice order) and each row in order
+ * along its curve; the points of one row share the same coordinate on the axis that the rows are
+ * perpendicular to. find_rows finds the rows in one pass. walk_pair then walks the strip of
+ * triangles between two adjacent rows. The strips depend only on their own two rows, so a model
+ * can triangulate them all in parallel and concatenate the results.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include <sm/vec>
+
+namespace mplot::point_rows {
+
+    //! A row of points: the indices of its first and last points
+    struct row
+    {
+        std::size_t first = 0;
+        std::size_t last = 0;
+    };
+
+    //! Find the rows in pts: runs of points with the same coordinate on axis
+    inline std::vector<row> find_rows (const std::vector<sm::vec<float, 3>>& pts, const unsigned int axis)
+    {
+        std::vector<row> rows;
+        for (std::size_t i = 0; i < pts.size(); ++i) {
+            if (i == 0 || pts[i][axis] != pts[rows.back().first][axis]) {
+                rows.push_back ({ i, i });
+            } else {
+                rows.back().last = i;
+            }
+        }
+        return rows;
+    }
+
+    /*!
+     * Walk the strip of triangles between rows a and b. start (r1, r2) is called for the first
+     * points of the two rows. Then each triangle adds one point: advance (from, to) is called with
+     * the point it moves on from (in the row that it moves along) and the new point. If the strip
+     * goes on, next (r1, r2) is called with the current point of each row, for the start of the
+     * next triangle.
+     *
+     * Each step moves along the row that gives the triangle with the smaller angle at the
+     * current point of the other row, until either row runs out.
+     */
+    template <typename Start, typename Advance, typename Next>
+    void walk_pair (const std::vector<sm::vec<float, 3>>& pts, const row& a, const row& b,
+                    Start start, Advance advance, Next next)
+    {
+        std::size_t r1 = a.first;
+        std::size_t r2 = b.first;
+        const std::size_t r1_e = a.last;
+        const std::size_t r2_e = b.last;
+
+        start (r1, r2);
+
+        while (r2 <= r2_e && r1 <= r1_e) {
+            std::size_t r1n = r1 + 1u;
+            std::size_t r2n = r2 + 1u;
+
+            // Both rows have run out
+            if (r1n > r1_e && r2n > r2_e) { break; }
+
+            bool completed_end_tri = false;
+            bool must_be_r1n = false;
+            if (r1n > r1_e) {
+                // Only r2n is possible
+                completed_end_tri = true;
+            } else if (r2n > r2_e) {
+                // Only r1n is possible, and this is the end of the row
+                must_be_r1n = true;
+                completed_end_tri = true;
+            } else {
+                // Compute distances to compute angles to decide
+                const float r1_to_r2_sq = (pts[r1] - pts[r2]).length_sq();
+                const float r1_to_r1n_sq = (pts[r1] - pts[r1n]).length_sq();
+                const float r1_to_r2n_sq = (pts[r1] - pts[r2n]).length_sq();
+                const float r2_to_r1n_sq = (pts[r2] - pts[r1n]).length_sq();
+                const float r2_to_r2n_sq = (pts[r2] - pts[r2n]).length_sq();
+
+                const float r1_to_r1n = std::sqrt (r1_to_r1n_sq);
+                const float r1_to_r2n = std::sqrt (r1_to_r2n_sq);
+                const float r2_to_r1n = std::sqrt (r2_to_r1n_sq);
+                const float r2_to_r2n = std::sqrt (r2_to_r2n_sq);
+
+                const float asq = r1_to_r2_sq;
+                const float alpha1 = std::acos ((r2_to_r1n_sq + r1_to_r1n_sq - asq) / (2.0f * r2_to_r1n * r1_to_r1n));
+                const float alpha2 = std::acos ((r2_to_r2n_sq + r1_to_r2n_sq - asq) / (2.0f * r2_to_r2n * r1_to_r2n));
+                must_be_r1n = alpha2 < alpha1;
+            }
+
+            if (must_be_r1n) {
+                advance (r1, r1n);
+                r1 = r1n;
+            } else {
+                advance (r2, r2n);
+                r2 = r2n;
+            }
+
+            if (completed_end_tri) { break; }
+
+            next (r1, r2);
+        }
+    }
+
+} // namespace mplot::point_rows
@@ -18,6 +18,7 @@ namespace mplot { using win_t = QOpenGLWidget; }
 
 // We need to be able to convert from Qt keycodes to mplot keycodes
 #include <mplot/qt/keycodes.h>
+#include <mplot/reinit_queue.h>
 
 
 namespace mplot {
@@ -73,11 +74,23 @@ namespace mplot {
             std::vector<std::unique_ptr<mplot::VisualModel<gl_version>>> newvisualmodels;
             std::vector<mplot::VisualModel<gl_version>*> model_ptrs;
 
-            // if >-1, then that model needs a reinit.
-            int needs_reinit = -1;
+            // Models that need a reinit (or a re-upload of their buffers) in the next paintGL
+            mplot::reinit_queue<mplot::VisualModel<gl_version>> needs_reinit;
+            // Queue model_ptrs[model_idx] for a full reinit (or remove it from the queue)
             void set_model_needs_reinit (int model_idx, bool reinit_required = true)
             {
-                this->needs_reinit = reinit_required ? model_idx : -1;
+                mplot::VisualModel<gl_version>* m = this->model_ptrs.at (model_idx);
+                if (reinit_required) { this->needs_reinit.request (m); } else { this->needs_reinit.cancel (m); }
+            }
+            // Queue model_ptrs[model_idx] for an update of the given kind (colours only, buffers or full)
+            void set_model_needs_update (int model_idx, mplot::reinit_kind kind)
+            {
+                this->needs_reinit.request (this->model_ptrs.at (model_idx), kind);
+            }
+            // Queue a model, by its pointer, for an update of the given kind
+            void set_model_needs_update (mplot::VisualModel<gl_version>* m, mplot::reinit_kind kind)
+            {
+                this->needs_reinit.request (m, kind);
             }
 
             viswidget_mx (QWidget* parent = 0) : QOpenGLWidget(parent)
@@ -125,10 +138,7 @@ namespace mplot {
                     }
                     this->newvisualmodels.clear();
                 }
-                if (this->needs_reinit > -1) {
-                    this->model_ptrs[this->needs_reinit]->reinit();
-                    this->needs_reinit = -1;
-                }
+                this->needs_reinit.process();
                 v.render();
             }
 
@@ -0,0 +1,64 @@
+/*!
+ * \file
+ *
+ * A recycler: a bounded stack of things that are costly to make and cheap to keep, so that a
+ * thing given up by one user can be taken by the next instead of being made again. Each
+ * mplot::Visual keeps the vertex array objects and buffers of its deleted VisualTextModels in
+ * recyclers (so rebuilding a graph's labels needs no glGenBuffers or glDeleteBuffers calls),
+ * along with their emptied vertex vectors (so the new labels do not grow theirs from nothing).
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace mplot {
+
+    template <typename T>
+    struct recycler
+    {
+        recycler() {}
+        recycler (const std::size_t _max_items) : max_items(_max_items) {}
+
+        //! Keep v for reuse. Returns false, leaving v alone, if max_items are already kept.
+        bool put (T&& v)
+        {
+            if (this->kept.size() >= this->max_items) { return false; }
+            this->kept.push_back (std::move (v));
+            return true;
+        }
+
+        //! Move the most recently kept thing into v. Returns false, leaving v alone, if none is kept.
+        bool take (T& v)
+        {
+            if (this->kept.empty()) { return false; }
+            v = std::move (this->kept.back());
+            this->kept.pop_back();
+            return true;
+        }
+
+        //! Call f on each kept thing (to free its resources) and then forget them all
+        template <typename F>
+        void drain (F f)
+        {
+            for (auto& v : this->kept) { f (v); }
+            this->kept.clear();
+        }
+
+        //! The number of things kept
+        std::size_t size() const { return this->kept.size(); }
+        bool empty() const { return this->kept.empty(); }
+
+        //! No more than this many things are kept
+        std::size_t max_items = 64;
+
+    private:
+        std::vector<T> kept;
+    };
+
+} // namespace mplot
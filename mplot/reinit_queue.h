@@ -0,0 +1,77 @@
+/*!
+ * \file
+ *
+ * A queue of VisualModels that need to be reinitialized or to have their buffers re-uploaded.
+ * Widget wrappers (mplot::qt::viswidget, mplot::wx::Canvas) can only touch OpenGL while their
+ * context is current, in their paint handlers, so client code queues the models that it has
+ * changed and the paint handler processes the whole queue before it renders.
+ *
+ * Each model appears in the queue at most once, with the largest update that was requested for
+ * it, so changing twenty models between two paints costs one paint with twenty uploads.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <map>
+#include <cstddef>
+
+namespace mplot {
+
+    //! The kinds of update, from the least to the most work
+    enum class reinit_kind
+    {
+        //! Upload vertexColors only (VisualModel::reinit_colour_buffer)
+        colours,
+        //! Upload the vertex buffers, as changed on the CPU (VisualModel::reinit_buffers)
+        buffers,
+        //! Rebuild the model from its data (VisualModel::reinit)
+        full
+    };
+
+    //! M is the model type (such as mplot::VisualModel<glver>)
+    template <typename M>
+    class reinit_queue
+    {
+    public:
+        //! Queue model m for an update of the given kind, keeping any larger update already queued
+        void request (M* m, const reinit_kind kind = reinit_kind::full)
+        {
+            if (m == nullptr) { return; }
+            auto [it, inserted] = this->queue.emplace (m, kind);
+            if (!inserted && kind > it->second) { it->second = kind; }
+        }
+
+        //! Remove m from the queue (for example, because it is about to be removed from the scene)
+        void cancel (M* m) { this->queue.erase (m); }
+
+        bool empty() const { return this->queue.empty(); }
+        std::size_t size() const { return this->queue.size(); }
+
+        //! Carry out the queued updates and empty the queue. Call with the GL context current.
+        void process()
+        {
+            for (auto [m, kind] : this->queue) {
+                switch (kind) {
+                case reinit_kind::colours:
+                    m->reinit_colour_buffer();
+                    break;
+                case reinit_kind::buffers:
+                    m->reinit_buffers();
+                    break;
+                case reinit_kind::full:
+                default:
+                    m->reinit();
+                    break;
+                }
+            }
+            this->queue.clear();
+        }
+
+    private:
+        std::map<M*, reinit_kind> queue;
+    };
+
+} // namespace mplot
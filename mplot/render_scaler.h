@@ -0,0 +1,104 @@
+/*!
+ * \file
+ *
+ * A render_scaler decides the resolution at which a Visual draws each frame, for dynamic
+ * resolution (see VisualBase::dynamicResolution). While the user rotates, translates or zooms
+ * the scene (and, with a frame time budget, while the scene changes and full resolution frames
+ * take longer than the budget) frames are drawn at a fraction of the window's resolution and
+ * scaled up into it. Once the scene has been still for settle_ms, the next frame is drawn at
+ * full resolution. A Visual that has drawn a reduced frame asks for another, so that this full
+ * resolution frame is drawn even if nothing else changes.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace mplot {
+
+    //! How dynamic resolution scales the frames, given to Visual::dynamicResolution
+    struct render_scaling
+    {
+        //! The fraction of the window's width and height at which reduced frames are drawn. 1
+        //! (or more) turns dynamic resolution off.
+        float scale = 1.0f;
+        /*!
+         * If > 0, frames are also reduced while the scene is changing, if full resolution frames
+         * take longer than this many ms (as measured from the start of render() to its return,
+         * which includes the swap of the buffers).
+         */
+        double budget_ms = 0.0;
+        //! A full resolution frame is drawn once the scene has been still for this long
+        double settle_ms = 150.0;
+    };
+
+    class render_scaler
+    {
+        using sc = std::chrono::steady_clock;
+
+    public:
+        render_scaling scaling;
+
+        //! Record that input moved the view at time now
+        void interacted (const sc::time_point now)
+        {
+            this->last_motion = now;
+            this->moved = true;
+        }
+
+        /*!
+         * Return the scale of the frame that starts at now: scaling.scale or 1. changed is true
+         * if something other than the scaler's own request for a full resolution frame (see
+         * reduced()) asked for this frame.
+         */
+        float begin_frame (const sc::time_point now, const bool changed)
+        {
+            this->frame_reduced = false;
+            if (this->scaling.scale <= 0.0f || this->scaling.scale >= 1.0f) { return 1.0f; }
+            if (changed && this->scaling.budget_ms > 0.0 && this->full_cost_ms > this->scaling.budget_ms) {
+                this->interacted (now);
+            }
+            if (!this->moved) { return 1.0f; }
+            const double since_ms = std::chrono::duration<double, std::milli>(now - this->last_motion).count();
+            this->frame_reduced = since_ms < this->scaling.settle_ms;
+            if (this->frame_reduced) {
+                ++this->n_reduced;
+                return this->scaling.scale;
+            }
+            this->moved = false;
+            return 1.0f;
+        }
+
+        //! Record the frame that began at start and finished at end
+        void end_frame (const sc::time_point start, const sc::time_point end)
+        {
+            if (this->frame_reduced) { return; }
+            const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+            // A moving average, as in frame_pacer
+            this->full_cost_ms = this->n_full == 0 ? ms : 0.8 * this->full_cost_ms + 0.2 * ms;
+            ++this->n_full;
+        }
+
+        //! True if the last frame was reduced, so a full resolution frame is still to be drawn
+        bool reduced() const { return this->frame_reduced; }
+        //! The measured cost of a full resolution frame, in ms
+        double full_frame_ms() const { return this->full_cost_ms; }
+        //! The numbers of frames drawn reduced and at full resolution
+        std::uint64_t frames_reduced() const { return this->n_reduced; }
+        std::uint64_t frames_full() const { return this->n_full; }
+
+    private:
+        double full_cost_ms = 0.0;
+        sc::time_point last_motion = {};
+        //! True from an interaction until the full resolution frame that follows it
+        bool moved = false;
+        bool frame_reduced = false;
+        std::uint64_t n_reduced = 0;
+        std::uint64_t n_full = 0;
+    };
+
+} // namespace mplot
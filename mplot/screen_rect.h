@@ -0,0 +1,80 @@
+/*!
+ * \file
+ *
+ * A rectangle of a framebuffer's pixels, for partial redraws (see VisualBase::partialRedraw).
+ * A VisualModel finds the rectangle that it covers from its bounding box and its texts (see
+ * VisualModel::screen_bounds), and the Visual redraws, with glScissor, only the rectangle that
+ * holds the models that changed.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <sm/vec>
+
+namespace mplot {
+
+    //! The pixels with x in [x0, x1) and y in [y0, y1), counted from the bottom left corner
+    struct screen_rect
+    {
+        int x0 = 0;
+        int y0 = 0;
+        int x1 = 0;
+        int y1 = 0;
+
+        bool empty() const { return this->x1 <= this->x0 || this->y1 <= this->y0; }
+        int width() const { return this->empty() ? 0 : this->x1 - this->x0; }
+        int height() const { return this->empty() ? 0 : this->y1 - this->y0; }
+        std::int64_t area() const { return static_cast<std::int64_t>(this->width()) * this->height(); }
+
+        //! Grow this rectangle to hold r as well
+        void unite (const screen_rect& r)
+        {
+            if (r.empty()) { return; }
+            if (this->empty()) { *this = r; return; }
+            this->x0 = std::min (this->x0, r.x0);
+            this->y0 = std::min (this->y0, r.y0);
+            this->x1 = std::max (this->x1, r.x1);
+            this->y1 = std::max (this->y1, r.y1);
+        }
+
+        //! The pixels in both this rectangle and r
+        screen_rect intersection (const screen_rect& r) const
+        {
+            screen_rect i = { std::max (this->x0, r.x0), std::max (this->y0, r.y0),
+                              std::min (this->x1, r.x1), std::min (this->y1, r.y1) };
+            return i.empty() ? screen_rect{} : i;
+        }
+
+        bool operator== (const screen_rect& r) const
+        {
+            return this->x0 == r.x0 && this->y0 == r.y0 && this->x1 == r.x1 && this->y1 == r.y1;
+        }
+        bool operator!= (const screen_rect& r) const { return !(*this == r); }
+
+        /*!
+         * The pixels of a framebuffer of size dims that the box from mn to mx (in normalized
+         * device coordinates) touches, with margin more pixels on each side (for line widths
+         * and anti-aliasing), clamped to the framebuffer.
+         */
+        static screen_rect from_ndc (const sm::vec<float, 2>& mn, const sm::vec<float, 2>& mx,
+                                     const sm::vec<int, 2>& dims, const int margin)
+        {
+            // Coordinates far outside clip space are brought in to [-2, 2] first, so that they
+            // convert to int without overflow (and still clamp to the edge of the framebuffer)
+            auto px = [](const float ndc, const int n) { return 0.5f * (std::clamp (ndc, -2.0f, 2.0f) + 1.0f) * static_cast<float>(n); };
+            screen_rect r;
+            r.x0 = std::clamp (static_cast<int>(std::floor (px (mn[0], dims[0]))) - margin, 0, dims[0]);
+            r.y0 = std::clamp (static_cast<int>(std::floor (px (mn[1], dims[1]))) - margin, 0, dims[1]);
+            r.x1 = std::clamp (static_cast<int>(std::ceil (px (mx[0], dims[0]))) + margin, 0, dims[0]);
+            r.y1 = std::clamp (static_cast<int>(std::ceil (px (mx[1], dims[1]))) + margin, 0, dims[1]);
+            return r.empty() ? screen_rect{} : r;
+        }
+    };
+
+} // namespace mplot
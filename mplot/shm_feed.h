@@ -0,0 +1,524 @@
+/*!
+ * \file
+ *
+ * A feed of data from a simulation process to a viewer process through POSIX shared memory.
+ * The simulation makes an shm_feed_writer, which creates a named shared memory segment of
+ * channels, and publishes frames into them: arrays of scalars, arrays of 3D vectors or batches
+ * of points to append to graphs. A viewer (a separate process, started and stopped at any time)
+ * attaches with an shm_feed_reader and passes the frames, in place in the mapped memory, to its
+ * models with feed_data() and feed_graph().
+ *
+ * Each channel is a single-producer, single-consumer ring of frames in the segment, whose two
+ * counters are lock-free atomics. Publishing a frame is one copy into the ring and one atomic
+ * store, and never waits for the viewer: if the ring is full (the viewer is slow, or there is no
+ * viewer), the frame is dropped (and counted), so the simulation runs at the same speed whether
+ * or not anything is watching.
+ *
+ * \author Seb James
+ * \date 2026
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <cerrno>
+#include <new>
+#include <span>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <sm/vec>
+
+namespace mplot {
+    namespace shm {
+
+        //! One point to append to dataset dataset of a GraphVisual
+        template <typename F>
+        struct graph_point
+        {
+            F x = F{0};
+            F y = F{0};
+            std::uint32_t dataset = 0u;
+        };
+
+        //! The type of the elements of a channel's frames
+        enum class element_type : std::uint32_t {
+            none, f32, f64, vec3_f32, vec3_f64, point_f32, point_f64
+        };
+
+        template <typename E> constexpr element_type element_type_of()
+        {
+            if constexpr (std::is_same_v<E, float>) { return element_type::f32; }
+            else if constexpr (std::is_same_v<E, double>) { return element_type::f64; }
+            else if constexpr (std::is_same_v<E, sm::vec<float, 3>>) { return element_type::vec3_f32; }
+            else if constexpr (std::is_same_v<E, sm::vec<double, 3>>) { return element_type::vec3_f64; }
+            else if constexpr (std::is_same_v<E, graph_point<float>>) { return element_type::point_f32; }
+            else if constexpr (std::is_same_v<E, graph_point<double>>) { return element_type::point_f64; }
+            else { return element_type::none; }
+        }
+
+        //! The size of an element of type t
+        constexpr std::size_t element_size (const element_type t)
+        {
+            switch (t) {
+            case element_type::f32: return sizeof(float);
+            case element_type::f64: return sizeof(double);
+            case element_type::vec3_f32: return sizeof (sm::vec<float, 3>);
+            case element_type::vec3_f64: return sizeof (sm::vec<double, 3>);
+            case element_type::point_f32: return sizeof (graph_point<float>);
+            case element_type::point_f64: return sizeof (graph_point<double>);
+            default: return 0u;
+            }
+        }
+
+        //! A channel to make in a feed: up to max_elements elements of type type per frame, with
+        //! room in the ring for n_slots frames
+        struct channel_spec
+        {
+            std::string name;
+            element_type type = element_type::f32;
+            std::size_t max_elements = 0;
+            unsigned int n_slots = 4;
+        };
+
+        //! Shorthand for a channel_spec of elements of type E
+        template <typename E>
+        channel_spec channel (const std::string& name, const std::size_t max_elements, const unsigned int n_slots = 4)
+        {
+            static_assert (element_type_of<E>() != element_type::none, "mplot::shm::channel: unsupported element type");
+            return { name, element_type_of<E>(), max_elements, n_slots };
+        }
+
+        namespace detail {
+            // The counters are shared between processes, so they must not need a lock
+            static_assert (std::atomic<std::uint64_t>::is_always_lock_free, "shm feeds need lock-free 64 bit atomics");
+
+            constexpr std::size_t cache_line = 64;
+            constexpr std::size_t max_channels = 16;
+            constexpr std::size_t max_name = 48;
+            constexpr std::array<char, 8> magic = { 'M', 'P', 'S', 'H', 'M', 'F', 'D', '1' };
+
+            constexpr std::size_t round_up (const std::size_t n) { return (n + cache_line - 1u) / cache_line * cache_line; }
+
+            //! out = a * b + c, or false if that overflows
+            constexpr bool mul_add (const std::uint64_t a, const std::uint64_t b, const std::uint64_t c, std::uint64_t& out)
+            {
+                constexpr std::uint64_t top = std::numeric_limits<std::uint64_t>::max();
+                if (b != 0u && a > (top - c) / b) { return false; }
+                out = a * b + c;
+                return true;
+            }
+
+            //! Where a channel is in the segment
+            struct channel_desc
+            {
+                std::array<char, max_name> name = {};
+                element_type type = element_type::none;
+                std::uint32_t n_slots = 0;
+                std::uint64_t max_elements = 0;
+                //! The bytes from one slot to the next (a count, then the elements)
+                std::uint64_t slot_stride = 0;
+                //! The offset of the channel's counters, after which come its slots
+                std::uint64_t offset = 0;
+            };
+
+            //! The counters of a channel, each in its own cache line: the frames published and
+            //! dropped (stored by the writer) and the frames freed (stored by the reader)
+            struct channel_state
+            {
+                alignas(cache_line) std::atomic<std::uint64_t> head;
+                std::atomic<std::uint64_t> dropped;
+                alignas(cache_line) std::atomic<std::uint64_t> tail;
+            };
+
+            struct segment_header
+            {
+                std::array<char, 8> magic = {};
+                std::uint32_t version = 1u;
+                std::uint32_t n_channels = 0u;
+                std::uint64_t bytes = 0u;
+                std::array<channel_desc, max_channels> channels = {};
+            };
+
+            //! The magic as one word, which is stored (and loaded) atomically at the start of a segment
+            inline std::uint64_t magic_word()
+            {
+                std::uint64_t w = 0u;
+                std::memcpy (&w, magic.data(), sizeof w);
+                return w;
+            }
+
+            static_assert (alignof (segment_header) >= std::atomic_ref<std::uint64_t>::required_alignment,
+                           "the magic word of a segment must be aligned for an atomic_ref");
+
+            //! The magic word of the segment mapped at base
+            inline std::atomic_ref<std::uint64_t> magic_ref (std::byte* base)
+            {
+                return std::atomic_ref<std::uint64_t> (*reinterpret_cast<std::uint64_t*>(base));
+            }
+
+            /*!
+             * True if the channel d lies within a segment of map_bytes bytes: it has a known type,
+             * a name that ends in the name array, at least one slot, slots that hold its largest
+             * frame, and counters and slots that end within the segment. A reader checks every
+             * channel of a segment, which may be stale or corrupt, before it indexes a slot.
+             */
+            inline bool valid_channel (const channel_desc& d, const std::size_t map_bytes)
+            {
+                const std::size_t esz = element_size (d.type);
+                if (esz == 0u || d.n_slots == 0u || d.name.back() != '\0') { return false; }
+                if (d.offset % alignof (channel_state) != 0u || d.slot_stride % sizeof (std::uint64_t) != 0u) { return false; }
+                std::uint64_t payload = 0u;
+                if (!mul_add (d.max_elements, esz, sizeof (std::uint64_t), payload) || d.slot_stride < payload) { return false; }
+                std::uint64_t end = 0u;
+                if (!mul_add (d.n_slots, d.slot_stride, round_up (sizeof (channel_state)), end)) { return false; }
+                if (end > std::numeric_limits<std::uint64_t>::max() - d.offset) { return false; }
+                return d.offset + end <= map_bytes;
+            }
+
+            inline std::string shm_name (const std::string& name) { return name.empty() || name[0] != '/' ? "/" + name : name; }
+
+            [[noreturn]] inline void fail (const std::string& what)
+            {
+                throw std::runtime_error ("mplot::shm: " + what + ": " + std::strerror (errno));
+            }
+
+            //! A mapping of a shared memory segment
+            struct mapping
+            {
+                std::byte* base = nullptr;
+                std::size_t bytes = 0;
+
+                mapping() = default;
+                mapping (const mapping&) = delete;
+                mapping& operator= (const mapping&) = delete;
+                ~mapping() { if (this->base != nullptr) { ::munmap (this->base, this->bytes); } }
+
+                segment_header& header() const { return *reinterpret_cast<segment_header*>(this->base); }
+                channel_state& state (const channel_desc& d) const { return *reinterpret_cast<channel_state*>(this->base + d.offset); }
+                //! Slot s of channel d: its element count, followed by its elements
+                std::byte* slot (const channel_desc& d, const std::uint64_t s) const
+                {
+                    return this->base + d.offset + round_up (sizeof (channel_state)) + (s % d.n_slots) * d.slot_stride;
+                }
+            };
+        } // namespace detail
+
+        /*!
+         * The simulation's end of a feed. It creates (replacing any old one) the named segment of
+         * channels, and removes it on destruction. Each channel must be published from one thread.
+         */
+        class shm_feed_writer
+        {
+        public:
+            shm_feed_writer (const std::string& _name, const std::vector<channel_spec>& specs)
+                : name (detail::shm_name (_name))
+            {
+                if (specs.empty() || specs.size() > detail::max_channels) {
+                    throw std::runtime_error ("mplot::shm_feed_writer: a feed has 1 to 16 channels");
+                }
+                detail::segment_header h;
+                h.magic = detail::magic;
+                h.n_channels = static_cast<std::uint32_t>(specs.size());
+                std::size_t at = detail::round_up (sizeof (detail::segment_header));
+                for (std::size_t i = 0; i < specs.size(); ++i) {
+                    const channel_spec& s = specs[i];
+                    if (s.name.empty() || s.name.size() >= detail::max_name || element_size (s.type) == 0u || s.n_slots < 2u) {
+                        throw std::runtime_error ("mplot::shm_feed_writer: bad spec for channel '" + s.name + "'");
+                    }
+                    detail::channel_desc& d = h.channels[i];
+                    std::memcpy (d.name.data(), s.name.data(), s.name.size());
+                    d.type = s.type;
+                    d.n_slots = s.n_slots;
+                    d.max_elements = s.max_elements;
+                    d.slot_stride = detail::round_up (sizeof (std::uint64_t) + s.max_elements * element_size (s.type));
+                    d.offset = at;
+                    at += detail::round_up (sizeof (detail::channel_state)) + d.n_slots * d.slot_stride;
+                }
+                h.bytes = at;
+
+                ::shm_unlink (this->name.c_str());
+                const int fd = ::shm_open (this->name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+                if (fd < 0) { detail::fail ("shm_open " + this->name); }
+                struct stat sb;
+                if (::fstat (fd, &sb) != 0) {
+                    ::close (fd);
+                    ::shm_unlink (this->name.c_str());
+                    detail::fail ("fstat " + this->name);
+                }
+                if (::ftruncate (fd, static_cast<off_t>(at)) != 0) {
+                    ::close (fd);
+                    ::shm_unlink (this->name.c_str());
+                    detail::fail ("ftruncate " + this->name);
+                }
+                void* p = ::mmap (nullptr, at, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                ::close (fd);
+                if (p == MAP_FAILED) {
+                    ::shm_unlink (this->name.c_str());
+                    detail::fail ("mmap " + this->name);
+                }
+                this->map.base = static_cast<std::byte*>(p);
+                this->map.bytes = at;
+                this->dev = sb.st_dev;
+                this->ino = sb.st_ino;
+                for (std::uint32_t i = 0; i < h.n_channels; ++i) {
+                    detail::channel_state* st = new (this->map.base + h.channels[i].offset) detail::channel_state;
+                    st->head.store (0u, std::memory_order_relaxed);
+                    st->dropped.store (0u, std::memory_order_relaxed);
+                    st->tail.store (0u, std::memory_order_relaxed);
+                }
+                // The magic goes in last, with a release store that pairs with the reader's acquire
+                // load of it, so that a reader never sees a half made header as valid
+                h.magic = {};
+                std::memcpy (this->map.base, &h, sizeof h);
+                detail::magic_ref (this->map.base).store (detail::magic_word(), std::memory_order_release);
+            }
+
+            /*!
+             * Removes the segment, unless it has already been replaced by a newer writer of the
+             * same name (this one's segment is still mapped here, so the newer one can't have
+             * been given its inode).
+             */
+            ~shm_feed_writer()
+            {
+                const int fd = ::shm_open (this->name.c_str(), O_RDONLY, 0);
+                if (fd < 0) { return; }
+                struct stat sb;
+                const bool ours = ::fstat (fd, &sb) == 0 && sb.st_dev == this->dev && sb.st_ino == this->ino;
+                ::close (fd);
+                if (ours) { ::shm_unlink (this->name.c_str()); }
+            }
+
+            shm_feed_writer (const shm_feed_writer&) = delete;
+            shm_feed_writer& operator= (const shm_feed_writer&) = delete;
+
+            //! The index of the channel called ch_name
+            std::size_t channel (const std::string& ch_name) const
+            {
+                const detail::segment_header& h = this->map.header();
+                for (std::uint32_t i = 0; i < h.n_channels; ++i) {
+                    if (ch_name == h.channels[i].name.data()) { return i; }
+                }
+                throw std::runtime_error ("mplot::shm_feed_writer: no channel '" + ch_name + "'");
+            }
+
+            /*!
+             * Publish a frame of elements into channel ch. Returns false (and counts a dropped
+             * frame) without waiting if the channel's ring is full. Throws if E is not the
+             * channel's type or there are more elements than its max_elements.
+             */
+            template <typename E>
+            bool publish (const std::size_t ch, std::span<const E> elements)
+            {
+                const detail::channel_desc& d = this->desc<E> (ch);
+                if (elements.size() > d.max_elements) { throw std::runtime_error ("mplot::shm_feed_writer: frame is too large"); }
+                detail::channel_state& st = this->map.state (d);
+                const std::uint64_t head = st.head.load (std::memory_order_relaxed);
+                if (head - st.tail.load (std::memory_order_acquire) >= d.n_slots) {
+                    st.dropped.store (st.dropped.load (std::memory_order_relaxed) + 1u, std::memory_order_relaxed);
+                    return false;
+                }
+                std::byte* slot = this->map.slot (d, head);
+                const std::uint64_t n = elements.size();
+                std::memcpy (slot, &n, sizeof n);
+                if (n > 0u) { std::memcpy (slot + sizeof n, elements.data(), elements.size_bytes()); }
+                st.head.store (head + 1u, std::memory_order_release);
+                return true;
+            }
+            template <typename E>
+            bool publish (const std::size_t ch, const std::vector<E>& elements) { return this->publish (ch, std::span<const E>(elements)); }
+
+            //! The number of frames of channel ch dropped because its ring was full
+            std::uint64_t dropped (const std::size_t ch) const
+            {
+                return this->map.state (this->map.header().channels.at (ch)).dropped.load (std::memory_order_relaxed);
+            }
+
+        private:
+            std::string name;
+            detail::mapping map;
+            //! The device and inode of the segment this writer created
+            dev_t dev = 0;
+            ino_t ino = 0;
+
+            template <typename E>
+            const detail::channel_desc& desc (const std::size_t ch) const
+            {
+                const detail::segment_header& h = this->map.header();
+                if (ch >= h.n_channels || h.channels[ch].type != element_type_of<E>()) {
+                    throw std::runtime_error ("mplot::shm_feed_writer: no channel of that type");
+                }
+                return h.channels[ch];
+            }
+        };
+
+        /*!
+         * The viewer's end of a feed, attached to the segment that an shm_feed_writer made. The
+         * frames are read in place in the mapped memory. Each channel must be read from one
+         * thread, and by one reader at a time.
+         */
+        class shm_feed_reader
+        {
+        public:
+            //! Attach to the feed called _name. Throws if there is no such feed (yet).
+            explicit shm_feed_reader (const std::string& _name)
+            {
+                const std::string name = detail::shm_name (_name);
+                const int fd = ::shm_open (name.c_str(), O_RDWR, 0);
+                if (fd < 0) { detail::fail ("shm_open " + name); }
+                struct stat sb;
+                if (::fstat (fd, &sb) != 0 || static_cast<std::size_t>(sb.st_size) < sizeof (detail::segment_header)) {
+                    ::close (fd);
+                    throw std::runtime_error ("mplot::shm_feed_reader: " + name + " is not a feed");
+                }
+                void* p = ::mmap (nullptr, static_cast<std::size_t>(sb.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                ::close (fd);
+                if (p == MAP_FAILED) { detail::fail ("mmap " + name); }
+                this->map.base = static_cast<std::byte*>(p);
+                this->map.bytes = static_cast<std::size_t>(sb.st_size);
+                // The header is read only after the magic has been seen with an acquire load
+                if (detail::magic_ref (this->map.base).load (std::memory_order_acquire) != detail::magic_word()) {
+                    throw std::runtime_error ("mplot::shm_feed_reader: " + name + " is not a feed (or is not yet made)");
+                }
+                const detail::segment_header& h = this->map.header();
+                if (h.version != 1u || h.n_channels > detail::max_channels || h.bytes > this->map.bytes) {
+                    throw std::runtime_error ("mplot::shm_feed_reader: " + name + " is not a feed");
+                }
+                for (std::uint32_t i = 0; i < h.n_channels; ++i) {
+                    if (!detail::valid_channel (h.channels[i], this->map.bytes)) {
+                        throw std::runtime_error ("mplot::shm_feed_reader: " + name + " has a corrupt channel " + std::to_string (i));
+                    }
+                }
+                this->held.assign (h.n_channels, false);
+            }
+
+            //! The index of the channel called ch_name
+            std::size_t channel (const std::string& ch_name) const
+            {
+                const detail::segment_header& h = this->map.header();
+                for (std::uint32_t i = 0; i < h.n_channels; ++i) {
+                    if (ch_name == h.channels[i].name.data()) { return i; }
+                }
+                throw std::runtime_error ("mplot::shm_feed_reader: no channel '" + ch_name + "'");
+            }
+
+            /*!
+             * Take the newest frame of channel ch (freeing any older unread frames), if there is
+             * one that has not been taken. out is then its elements, in the mapped memory, which
+             * the writer does not touch until release (ch) or the next take. Returns false if
+             * there is no new frame.
+             */
+            template <typename E>
+            bool take_latest (const std::size_t ch, std::span<const E>& out)
+            {
+                const detail::channel_desc& d = this->desc<E> (ch);
+                detail::channel_state& st = this->map.state (d);
+                const std::uint64_t head = st.head.load (std::memory_order_acquire);
+                std::uint64_t tail = st.tail.load (std::memory_order_relaxed);
+                // A frame taken before is done with
+                if (this->held[ch]) { ++tail; this->held[ch] = false; }
+                if (tail >= head) {
+                    st.tail.store (tail, std::memory_order_release);
+                    return false;
+                }
+                // Free the older frames, and hold the newest
+                st.tail.store (head - 1u, std::memory_order_release);
+                out = this->frame<E> (d, head - 1u);
+                this->held[ch] = true;
+                return true;
+            }
+
+            //! Free the frame last taken from channel ch
+            void release (const std::size_t ch)
+            {
+                if (ch >= this->held.size() || !this->held[ch]) { return; }
+                detail::channel_state& st = this->map.state (this->map.header().channels[ch]);
+                st.tail.store (st.tail.load (std::memory_order_relaxed) + 1u, std::memory_order_release);
+                this->held[ch] = false;
+            }
+
+            //! Call f (std::span<const E>) for each unread frame of channel ch, oldest first, freeing
+            //! each after f returns. Returns the number of frames.
+            template <typename E, typename Fn>
+            std::size_t for_each_new (const std::size_t ch, Fn&& f)
+            {
+                this->release (ch);
+                const detail::channel_desc& d = this->desc<E> (ch);
+                detail::channel_state& st = this->map.state (d);
+                const std::uint64_t head = st.head.load (std::memory_order_acquire);
+                std::uint64_t tail = st.tail.load (std::memory_order_relaxed);
+                std::size_t n = 0;
+                for (; tail < head; ++tail, ++n) {
+                    f (this->frame<E> (d, tail));
+                    st.tail.store (tail + 1u, std::memory_order_release);
+                }
+                return n;
+            }
+
+        private:
+            detail::mapping map;
+            //! Whether a frame of each channel is held (taken and not released)
+            std::vector<bool> held;
+
+            template <typename E>
+            const detail::channel_desc& desc (const std::size_t ch) const
+            {
+                const detail::segment_header& h = this->map.header();
+                if (ch >= h.n_channels || h.channels[ch].type != element_type_of<E>()) {
+                    throw std::runtime_error ("mplot::shm_feed_reader: no channel of that type");
+                }
+                return h.channels[ch];
+            }
+
+            template <typename E>
+            std::span<const E> frame (const detail::channel_desc& d, const std::uint64_t f) const
+            {
+                const std::byte* slot = this->map.slot (d, f);
+                std::uint64_t n = 0;
+                std::memcpy (&n, slot, sizeof n);
+                if (n > d.max_elements) { n = d.max_elements; }
+                return { reinterpret_cast<const E*>(slot + sizeof n), static_cast<std::size_t>(n) };
+            }
+        };
+
+        /*!
+         * Show the newest frame of scalars (or vectors) of channel ch in model (a
+         * VisualDataModel<T>, or anything with its updateData (const E* first, std::size_t n)),
+         * reading it from the mapped memory. Returns true if there was a new frame.
+         */
+        template <typename E, typename M>
+        bool feed_data (shm_feed_reader& r, const std::size_t ch, M& model)
+        {
+            std::span<const E> f;
+            if (!r.take_latest<E> (ch, f)) { return false; }
+            model.updateData (f.data(), f.size());
+            r.release (ch);
+            return true;
+        }
+
+        //! Append the points of each unread frame of channel ch to graph (a GraphVisual<F>).
+        //! Returns the number of points appended.
+        template <typename F, typename G>
+        std::size_t feed_graph (shm_feed_reader& r, const std::size_t ch, G& graph)
+        {
+            std::size_t n = 0;
+            r.for_each_new<graph_point<F>> (ch, [&graph, &n](std::span<const graph_point<F>> pts) {
+                for (const graph_point<F>& p : pts) { graph.append (p.x, p.y, p.dataset); }
+                n += pts.size();
+            });
+            return n;
+        }
+
+    } // namespace shm
+} // namespace mplot
@@ -0,0 +1,216 @@
+/*!
+ * \file
+ *
+ * A slot map: a container whose elements are found by generational handles. insert and erase
+ * are O(1), find is O(1), and the elements are iterated in the order in which they were
+ * inserted. A handle stays valid (and keeps finding the same element) however many other
+ * elements are inserted or erased, and becomes invalid when its element is erased, even if a
+ * later element reuses its slot.
+ *
+ * The elements are held contiguously. erase leaves a hole that iteration skips; the holes are
+ * removed by compact(), which runs once they outnumber the elements (so that erase is O(1)
+ * amortized) and which a caller may run at a quiet time, such as the start of a frame.
+ *
+ * mplot::VisualBase holds its VisualModels in a slot_map of unique_ptrs.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace mplot {
+
+    //! A handle to an element of a slot_map
+    struct slot_handle
+    {
+        static constexpr std::uint32_t invalid = std::numeric_limits<std::uint32_t>::max();
+        //! The element's slot
+        std::uint32_t slot = invalid;
+        //! The generation of the slot when the element was inserted
+        std::uint32_t generation = 0;
+        //! False for a default constructed handle (one that was never given an element)
+        bool valid() const { return this->slot != invalid; }
+        bool operator== (const slot_handle& rhs) const { return this->slot == rhs.slot && this->generation == rhs.generation; }
+        bool operator!= (const slot_handle& rhs) const { return !(*this == rhs); }
+    };
+
+    template <typename T>
+    struct slot_map
+    {
+        //! Insert v after the existing elements. O(1) amortized.
+        slot_handle insert (T&& v)
+        {
+            std::uint32_t s = 0;
+            if (this->free_slots.empty()) {
+                s = static_cast<std::uint32_t>(this->slots.size());
+                this->slots.push_back ({});
+            } else {
+                s = this->free_slots.back();
+                this->free_slots.pop_back();
+            }
+            this->slots[s].item = static_cast<std::uint32_t>(this->items.size());
+            this->items.push_back (std::move (v));
+            this->item_slots.push_back (s);
+            ++this->n_live;
+            return { s, this->slots[s].generation };
+        }
+
+        //! Erase the element of h, if it is present. Returns false if h was not valid. O(1)
+        //! amortized.
+        bool erase (const slot_handle& h)
+        {
+            if (!this->contains (h)) { return false; }
+            slot& sl = this->slots[h.slot];
+            // The element is destroyed on return, once the map no longer lists it
+            T gone = std::move (this->items[sl.item]);
+            this->items[sl.item] = T{};
+            this->item_slots[sl.item] = slot_handle::invalid;
+            sl.item = slot_handle::invalid;
+            ++sl.generation;
+            this->free_slots.push_back (h.slot);
+            --this->n_live;
+            if (this->holes() > this->n_live) { this->compact(); }
+            return true;
+        }
+
+        //! True if h refers to an element of the map. O(1)
+        bool contains (const slot_handle& h) const
+        {
+            return h.slot < this->slots.size() && this->slots[h.slot].generation == h.generation
+            && this->slots[h.slot].item != slot_handle::invalid;
+        }
+
+        //! The element of h, or nullptr if it is not present. O(1)
+        T* find (const slot_handle& h) { return this->contains (h) ? &this->items[this->slots[h.slot].item] : nullptr; }
+        const T* find (const slot_handle& h) const { return this->contains (h) ? &this->items[this->slots[h.slot].item] : nullptr; }
+
+        //! The handle of the n-th element in iteration order. O(1) without holes, else O(n).
+        slot_handle handle_at (const std::size_t n) const
+        {
+            const std::size_t i = this->item_index (n);
+            return { this->item_slots[i], this->slots[this->item_slots[i]].generation };
+        }
+
+        //! The n-th element in iteration order. O(1) without holes (see compact), else O(n).
+        T& operator[] (const std::size_t n) { return this->items[this->item_index (n)]; }
+        const T& operator[] (const std::size_t n) const { return this->items[this->item_index (n)]; }
+
+        //! The number of elements
+        std::size_t size() const { return this->n_live; }
+        bool empty() const { return this->n_live == 0; }
+
+        //! The number of holes left by erase, which iteration skips
+        std::size_t holes() const { return this->items.size() - this->n_live; }
+
+        //! Close up the holes, keeping the order of the elements. O(n) if there are holes.
+        void compact()
+        {
+            if (this->holes() == 0) { return; }
+            std::size_t j = 0;
+            for (std::size_t i = 0; i < this->items.size(); ++i) {
+                if (this->item_slots[i] == slot_handle::invalid) { continue; }
+                if (i != j) {
+                    this->items[j] = std::move (this->items[i]);
+                    this->item_slots[j] = this->item_slots[i];
+                }
+                this->slots[this->item_slots[j]].item = static_cast<std::uint32_t>(j);
+                ++j;
+            }
+            this->items.resize (j);
+            this->item_slots.resize (j);
+        }
+
+        //! Erase every element. Every handle becomes invalid.
+        void clear()
+        {
+            for (std::size_t i = 0; i < this->item_slots.size(); ++i) {
+                const std::uint32_t s = this->item_slots[i];
+                if (s == slot_handle::invalid) { continue; }
+                this->slots[s].item = slot_handle::invalid;
+                ++this->slots[s].generation;
+                this->free_slots.push_back (s);
+            }
+            this->items.clear();
+            this->item_slots.clear();
+            this->n_live = 0;
+        }
+
+        //! A forward iterator over the elements, in order, that skips the holes
+        template <typename M, typename V>
+        struct iter
+        {
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = V*;
+            using reference = V&;
+
+            M* m = nullptr;
+            std::size_t i = 0;
+
+            iter (M* _m, std::size_t _i) : m(_m), i(_i) { this->skip(); }
+            reference operator*() const { return this->m->items[this->i]; }
+            pointer operator->() const { return &this->m->items[this->i]; }
+            //! The handle of the element. O(1)
+            slot_handle handle() const
+            {
+                const std::uint32_t s = this->m->item_slots[this->i];
+                return { s, this->m->slots[s].generation };
+            }
+            iter& operator++() { ++this->i; this->skip(); return *this; }
+            iter operator++ (int) { iter t = *this; ++(*this); return t; }
+            bool operator== (const iter& rhs) const { return this->i == rhs.i; }
+            bool operator!= (const iter& rhs) const { return this->i != rhs.i; }
+        private:
+            void skip()
+            {
+                while (this->i < this->m->items.size() && this->m->item_slots[this->i] == slot_handle::invalid) { ++this->i; }
+            }
+        };
+        using iterator = iter<slot_map<T>, T>;
+        using const_iterator = iter<const slot_map<T>, const T>;
+
+        iterator begin() { return iterator (this, 0); }
+        iterator end() { return iterator (this, this->items.size()); }
+        const_iterator begin() const { return const_iterator (this, 0); }
+        const_iterator end() const { return const_iterator (this, this->items.size()); }
+
+    private:
+        //! A slot: the index of its element in items (invalid if it has none) and its generation
+        struct slot
+        {
+            std::uint32_t item = slot_handle::invalid;
+            std::uint32_t generation = 0;
+        };
+
+        //! The index in items of the n-th element
+        std::size_t item_index (const std::size_t n) const
+        {
+            if (this->holes() == 0) { return n; }
+            std::size_t seen = 0;
+            for (std::size_t i = 0; i < this->items.size(); ++i) {
+                if (this->item_slots[i] == slot_handle::invalid) { continue; }
+                if (seen++ == n) { return i; }
+            }
+            return this->items.size();
+        }
+
+        //! The elements, in insertion order, with holes where elements were erased
+        std::vector<T> items;
+        //! The slot of each of items (invalid for a hole)
+        std::vector<std::uint32_t> item_slots;
+        std::vector<slot> slots;
+        //! Slots that have no element, to be reused
+        std::vector<std::uint32_t> free_slots;
+        std::size_t n_live = 0;
+    };
+
+} // namespace mplot
@@ -0,0 +1,185 @@
+/*!
+ * \file
+ *
+ * A startup_profile records where the time went between the construction of a Visual and its
+ * first frame: the windowing system's init, the creation of the window (or EGL context), GLAD's
+ * loading of the GL functions, FreeType's init, the shader compilation in init_gl, the scene
+ * setup by client code (building and finalizing models), the coordinate arrows and title (made
+ * on first use), the first render and the first swap. See VisualBase::getStartupProfile.
+ *
+ * The phases are exclusive: a phase that runs inside another (the title, which is made during
+ * the first render) is subtracted from it, so the phases add up to the time to the first frame.
+ * Glyph rasterization and VisualModel::finalize happen within several phases, so their totals
+ * (from process-wide counters) are reported alongside the phases.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+namespace mplot {
+
+    struct startup_profile
+    {
+        using sc = std::chrono::steady_clock;
+
+        struct phase
+        {
+            std::string name;
+            double ms = 0.0;
+        };
+
+        //! The phases, in the order in which they were first entered
+        std::vector<phase> phases;
+        //! The milliseconds from construction to the end of the first frame (-1 until then)
+        double first_frame_ms = -1.0;
+        //! The milliseconds spent rasterizing glyphs and making faces in the startup (see glyph_ns)
+        double glyph_ms = 0.0;
+        //! The milliseconds spent in VisualModel::finalize in the startup (see finalize_ns)
+        double finalize_ms = 0.0;
+
+        startup_profile()
+        {
+            this->glyph_ns0 = startup_profile::glyph_ns().load (std::memory_order_relaxed);
+            this->finalize_ns0 = startup_profile::finalize_ns().load (std::memory_order_relaxed);
+        }
+
+        //! True once the first frame has been drawn, after which nothing more is recorded
+        bool complete() const { return this->first_frame_ms >= 0.0; }
+
+        //! The milliseconds recorded in phase n (0 if there is no such phase)
+        double ms (const std::string& n) const
+        {
+            for (const auto& p : this->phases) { if (p.name == n) { return p.ms; } }
+            return 0.0;
+        }
+
+        //! Add the time since the end of the last phase (or since construction) to phase n
+        void mark (const std::string& n)
+        {
+            if (this->complete()) { return; }
+            const sc::time_point now = sc::now();
+            this->add (n, std::chrono::duration<double, std::milli>(now - this->last).count());
+            this->last = now;
+        }
+
+        //! Record the end of the first frame
+        void finish()
+        {
+            if (this->complete()) { return; }
+            const sc::time_point now = sc::now();
+            this->first_frame_ms = std::chrono::duration<double, std::milli>(now - this->t0).count();
+            this->glyph_ms = static_cast<double>(startup_profile::glyph_ns().load (std::memory_order_relaxed) - this->glyph_ns0) * 1e-6;
+            this->finalize_ms = static_cast<double>(startup_profile::finalize_ns().load (std::memory_order_relaxed) - this->finalize_ns0) * 1e-6;
+            this->last = now;
+        }
+
+        /*!
+         * Time a phase from construction to destruction (or end()), unless the profile is
+         * complete. The time of any scope that is made inside this one is not counted in it.
+         */
+        struct scope
+        {
+            scope (startup_profile& _p, const char* _name) : p(_p), name(_name)
+            {
+                if (this->p.complete()) { return; }
+                this->active = true;
+                this->p.add (this->name, 0.0); // in the order of entry
+                this->t_start = sc::now();
+                this->p.nested.push_back (0.0);
+            }
+            ~scope() { this->end(); }
+            scope (const scope&) = delete;
+            scope& operator= (const scope&) = delete;
+
+            void end()
+            {
+                if (!this->active) { return; }
+                this->active = false;
+                const sc::time_point now = sc::now();
+                const double total = std::chrono::duration<double, std::milli>(now - this->t_start).count();
+                const double inner = this->p.nested.back();
+                this->p.nested.pop_back();
+                this->p.add (this->name, total - inner);
+                if (!this->p.nested.empty()) { this->p.nested.back() += total; }
+                this->p.last = now;
+            }
+
+        private:
+            startup_profile& p;
+            const char* name;
+            sc::time_point t_start = {};
+            bool active = false;
+        };
+
+        //! The phases, one to a line, with the time to the first frame
+        std::string summary() const
+        {
+            std::stringstream ss;
+            ss << std::fixed << std::setprecision (2);
+            for (const auto& p : this->phases) { ss << std::left << std::setw (22) << p.name << std::right << std::setw (10) << p.ms << " ms\n"; }
+            ss << std::left << std::setw (22) << "(glyphs)" << std::right << std::setw (10) << this->glyph_ms << " ms\n";
+            ss << std::left << std::setw (22) << "(finalize)" << std::right << std::setw (10) << this->finalize_ms << " ms\n";
+            ss << std::left << std::setw (22) << "time to first frame" << std::right << std::setw (10) << this->first_frame_ms << " ms";
+            return ss.str();
+        }
+
+        nlohmann::json json() const
+        {
+            nlohmann::json j;
+            j["phases"] = nlohmann::json::array();
+            for (const auto& p : this->phases) { j["phases"].push_back ({ { "name", p.name }, { "ms", p.ms } }); }
+            j["glyph_ms"] = this->glyph_ms;
+            j["finalize_ms"] = this->finalize_ms;
+            j["first_frame_ms"] = this->first_frame_ms;
+            return j;
+        }
+
+        //! The nanoseconds that this process has spent making font faces and rasterizing glyphs
+        static std::atomic<std::uint64_t>& glyph_ns() { static std::atomic<std::uint64_t> n = 0u; return n; }
+        //! The nanoseconds that this process has spent in VisualModel::finalize
+        static std::atomic<std::uint64_t>& finalize_ns() { static std::atomic<std::uint64_t> n = 0u; return n; }
+
+        //! Add the time of its lifetime to one of the process-wide counters (glyph_ns or finalize_ns)
+        struct counter_scope
+        {
+            counter_scope (std::atomic<std::uint64_t>& _c) : c(_c), t_start (sc::now()) {}
+            ~counter_scope()
+            {
+                const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(sc::now() - this->t_start).count();
+                this->c.fetch_add (static_cast<std::uint64_t>(ns), std::memory_order_relaxed);
+            }
+            counter_scope (const counter_scope&) = delete;
+            counter_scope& operator= (const counter_scope&) = delete;
+
+        private:
+            std::atomic<std::uint64_t>& c;
+            sc::time_point t_start;
+        };
+
+    private:
+        void add (const std::string& n, const double t)
+        {
+            for (auto& p : this->phases) { if (p.name == n) { p.ms += t; return; } }
+            this->phases.push_back ({ n, t });
+        }
+
+        sc::time_point t0 = sc::now();
+        sc::time_point last = t0;
+        //! For each open scope, the time of the scopes nested within it
+        std::vector<double> nested;
+        std::uint64_t glyph_ns0 = 0u;
+        std::uint64_t finalize_ns0 = 0u;
+    };
+
+} // namespace mplot
@@ -0,0 +1,145 @@
+/*!
+ * \file
+ *
+ * A tessellation policy chooses the rings and segments of the spheres and tubes of a model
+ * (ScatterVisual's markers, say, or a RodVisual) from their size on the screen, so that a sphere
+ * a few pixels across is not drawn with hundreds of triangles, nor a close-up one with too few.
+ *
+ * The policy has a short list of levels. Each frame, the model gives the policy (in
+ * tessellation::update) the diameter, in pixels, of its largest primitive at its nearest point
+ * (see tessellation::max_screen_size), and the policy chooses the coarsest level whose segments
+ * are no more than pixels_per_segment pixels long around the circumference. The level changes
+ * only once the diameter has moved a fraction (hysteresis) beyond the range of the current level,
+ * so a model that sits at the boundary between two levels is not rebuilt on every frame. The
+ * model rebuilds its geometry only when update returns true.
+ *
+ * Because the levels are few and fixed, the unit meshes of each level (see mplot/unit_meshes.h)
+ * are computed once and shared by every model with the same levels.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <sm/mathconst>
+#include <sm/vec>
+#include <sm/mat44>
+#include <mplot/lod.h>
+
+namespace mplot {
+
+    struct tessellation
+    {
+        //! The rings and segments of a sphere. A tube has the segments and no rings.
+        struct level
+        {
+            int rings = 16;
+            int segments = 20;
+        };
+
+        //! If false, the model keeps its fixed tessellation and update() never changes the level
+        bool adaptive = false;
+
+        //! The levels, in increasing order of segments
+        std::vector<level> levels = { { 3, 6 }, { 4, 8 }, { 6, 10 }, { 8, 12 }, { 12, 16 }, { 16, 20 }, { 24, 32 }, { 32, 48 } };
+
+        //! The length, in pixels, of a segment around the circumference of a primitive of the chosen level
+        float pixels_per_segment = 4.0f;
+
+        //! The fraction by which the ideal segment count must pass the range of the current level to change it
+        float hysteresis = 0.25f;
+
+        //! The index in levels that is passed to choose() when no level has yet been chosen
+        static constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+
+        //! The segments for which a circle of diameter_px pixels has segments pixels_per_segment long
+        float ideal_segments (const float diameter_px) const
+        {
+            return sm::mathconst<float>::pi * std::max (diameter_px, 0.0f) / std::max (this->pixels_per_segment, 0.01f);
+        }
+
+        /*!
+         * The level for a primitive of diameter_px pixels, given the current level (or none).
+         * The current level is kept while the ideal segment count lies between the segments of
+         * the level below it and those of the current level, widened by hysteresis.
+         */
+        std::size_t choose (const float diameter_px, const std::size_t current) const
+        {
+            if (this->levels.empty()) { return none; }
+            const float ideal = this->ideal_segments (diameter_px);
+            if (current < this->levels.size()) {
+                const float lo = current == 0 ? 0.0f : static_cast<float>(this->levels[current - 1].segments) * (1.0f - this->hysteresis);
+                const float hi = current + 1 == this->levels.size() ? std::numeric_limits<float>::max()
+                                                                    : static_cast<float>(this->levels[current].segments) * (1.0f + this->hysteresis);
+                if (ideal >= lo && ideal <= hi) { return current; }
+            }
+            // The coarsest level with enough segments, or the finest
+            for (std::size_t i = 0; i < this->levels.size(); ++i) {
+                if (static_cast<float>(this->levels[i].segments) >= ideal) { return i; }
+            }
+            return this->levels.size() - 1;
+        }
+
+        /*!
+         * Choose the level for a primitive of diameter_px pixels. Returns true if the level
+         * changed (and so the model needs to rebuild its geometry). Does nothing unless adaptive.
+         */
+        bool update (const float diameter_px)
+        {
+            if (!this->adaptive) { return false; }
+            const std::size_t l = this->choose (diameter_px, this->current);
+            if (l == this->current) { return false; }
+            this->current = l;
+            return true;
+        }
+
+        //! The index of the current level (none if there is none, as before the first update)
+        std::size_t current_level() const { return this->current; }
+
+        //! Forget the current level (after a change to levels, say)
+        void reset() { this->current = none; }
+
+        //! The rings of the current level, or fixed_rings if there is none
+        int rings (const int fixed_rings) const
+        {
+            return this->adaptive && this->current < this->levels.size() ? this->levels[this->current].rings : fixed_rings;
+        }
+
+        //! The segments of the current level, or fixed_segments if there is none
+        int segments (const int fixed_segments) const
+        {
+            return this->adaptive && this->current < this->levels.size() ? this->levels[this->current].segments : fixed_segments;
+        }
+
+        /*!
+         * The largest diameter in pixels of a primitive of the given diameter (in model
+         * coordinates) anywhere in the box [lo, hi] of model coordinates, for the model-to-eye
+         * transform mv, the projection p and a viewport viewport_h pixels high. For the
+         * perspective projection this is at a corner of the box (the nearest); a box that the
+         * eye is in gives the largest float.
+         */
+        static float max_screen_size (const sm::mat44<float>& p, const sm::mat44<float>& mv,
+                                      const sm::vec<float, 3>& lo, const sm::vec<float, 3>& hi,
+                                      const float diameter, const int viewport_h)
+        {
+            // The scale of mv, from the length of its transformed x axis
+            const float s = std::sqrt (sm::vec<float, 3>{ mv.mat[0], mv.mat[1], mv.mat[2] }.length_sq());
+            float sz = 0.0f;
+            for (unsigned int c = 0; c < 8u; ++c) {
+                const sm::vec<float, 4> corner = { (c & 1u) ? hi[0] : lo[0], (c & 2u) ? hi[1] : lo[1], (c & 4u) ? hi[2] : lo[2], 1.0f };
+                sz = std::max (sz, mplot::lod::screen_size (p, mv * corner, diameter * s, viewport_h));
+            }
+            return sz;
+        }
+
+    private:
+        std::size_t current = none;
+    };
+
+} // namespace mplot
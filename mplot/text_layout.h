@@ -0,0 +1,151 @@
+/*!
+ * \file
+ *
+ * The layout of a text's glyphs as quads, with their texture coordinates in a face's glyph atlas.
+ * VisualTextModel lays out its texts with text_layout::layout, looking its glyphs up in its face
+ * (which may rasterize them into the atlas, which is GL work). To set up many labels at once,
+ * VisualModel::addLabels looks up every glyph that the labels use just once, on the GL thread,
+ * and then lays the labels out from that table on worker threads (see text_layout::for_each).
+ *
+ * The glyphs are of a type like mplot::visgl::CharInfo, with a size, a bearing and an advance
+ * (in 1/64 pixels) and a uv rectangle, so that this header needs no GL.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include <limits>
+#include <sm/vec>
+#include <mplot/TextGeometry.h>
+
+namespace mplot {
+
+    struct text_layout
+    {
+        /*!
+         * Append the quads of the glyphs of _txt, starting at _at, to quads, and their atlas
+         * rectangles (left, top, right, bottom) to uvs, and grow extents (left, right, bottom,
+         * top) to hold them. glyph_of (c) gives the glyph of the code point c. A newline starts
+         * a new line line_spacing times the height of an 'h' below the last.
+         */
+        template <typename F>
+        static void layout (const std::basic_string<char32_t>& _txt, const sm::vec<float>& _at, F&& glyph_of,
+                            const float fontscale, const float line_spacing,
+                            std::vector<std::array<float, 12>>& quads, std::vector<sm::vec<float, 4>>& uvs,
+                            sm::vec<float, 4>& extents)
+        {
+            // The string of letters starts at this location
+            float letter_pos = 0.0f;
+            float letter_y = 0.0f;
+            float text_epsilon = 0.0f;
+            for (const char32_t c : _txt) {
+
+                if (c == '\n') {
+                    // Skip newline, but add a y offset and reset letter_pos
+                    letter_pos = 0.0f;
+                    const auto ch = glyph_of (U'h');
+                    letter_y += line_spacing * -ch.size.y() * fontscale;
+                    continue;
+                }
+
+                const auto ci = glyph_of (c);
+
+                float xpos = _at[0] + letter_pos + ci.bearing.x() * fontscale;
+                float ypos = _at[1] + letter_y - (ci.size.y() - ci.bearing.y()) * fontscale;
+                float w = ci.size.x() * fontscale;
+                float h = ci.size.y() * fontscale;
+
+                // Update extents
+                if (xpos < extents[0]) { extents[0] = xpos; } // left
+                if (xpos+w > extents[1]) { extents[1] = xpos+w; } // right
+                if (ypos < extents[2]) { extents[2] = ypos; } // bottom
+                if (ypos+h > extents[3]) { extents[3] = ypos+h; } // top
+
+                // What's the order of the vertices for the quads? It is:
+                // Bottom left, Top left, top right, bottom right.
+                quads.push_back ({ xpos,   ypos,     _at[2] + text_epsilon,
+                                   xpos,   ypos+h,   _at[2] + text_epsilon,
+                                   xpos+w, ypos+h,   _at[2] + text_epsilon,
+                                   xpos+w, ypos,     _at[2] + text_epsilon });
+                text_epsilon -= 10.0f * std::numeric_limits<float>::epsilon();
+                uvs.push_back (ci.uv);
+
+                // The value in ci.advance has to be divided by 64 to bring it into the
+                // same units as the ci.size and ci.bearing values.
+                letter_pos += ((ci.advance>>6) * fontscale);
+            }
+        }
+
+        //! The geometry of _txt, scaled by fontscale, as VisualFaceBase::measure gives it
+        template <typename F>
+        static mplot::TextGeometry measure (const std::basic_string<char32_t>& _txt, F&& glyph_of, const float fontscale)
+        {
+            int advance = 0;
+            int max_bearingy = 0;
+            int max_drop = 0;
+            for (const char32_t c : _txt) {
+                const auto ci = glyph_of (c);
+                advance += static_cast<int>(ci.advance >> 6);
+                max_bearingy = std::max (max_bearingy, static_cast<int>(ci.bearing.y()));
+                max_drop = std::max (max_drop, static_cast<int>(ci.size.y() - ci.bearing.y()));
+            }
+            mplot::TextGeometry geom;
+            geom.total_advance = advance * fontscale;
+            geom.max_bearingy = max_bearingy * fontscale;
+            geom.max_drop = max_drop * fontscale;
+            return geom;
+        }
+
+        //! The code points used in txts (and 'h', which sets the line spacing), sorted, each once
+        static std::vector<char32_t> code_points (const std::vector<std::basic_string<char32_t>>& txts)
+        {
+            std::vector<char32_t> cps = { U'h' };
+            for (const auto& t : txts) { cps.insert (cps.end(), t.begin(), t.end()); }
+            std::sort (cps.begin(), cps.end());
+            cps.erase (std::unique (cps.begin(), cps.end()), cps.end());
+            return cps;
+        }
+
+        //! Run job (i) for each i in [0, n) on n_threads threads (0 for one per hardware thread),
+        //! rethrowing the first exception
+        template <typename F>
+        static void for_each (const std::size_t n, unsigned int n_threads, F&& job)
+        {
+            if (n == 0u) { return; }
+            if (n_threads == 0) { n_threads = std::thread::hardware_concurrency(); }
+            n_threads = static_cast<unsigned int>(std::max (std::size_t{1}, std::min (static_cast<std::size_t>(n_threads), n)));
+            // Hand out the items in chunks, so that short jobs (a label each) don't contend on next
+            const std::size_t chunk = std::max (std::size_t{1}, n / (8u * n_threads));
+            std::atomic<std::size_t> next = 0;
+            std::vector<std::exception_ptr> errors (n_threads);
+            auto worker = [&](unsigned int ti) {
+                try {
+                    for (std::size_t i0 = next.fetch_add (chunk); i0 < n; i0 = next.fetch_add (chunk)) {
+                        const std::size_t i1 = std::min (n, i0 + chunk);
+                        for (std::size_t i = i0; i < i1; ++i) { job (i); }
+                    }
+                } catch (...) {
+                    errors[ti] = std::current_exception();
+                    next = n;
+                }
+            };
+            std::vector<std::thread> workers;
+            for (unsigned int ti = 1; ti < n_threads; ++ti) { workers.emplace_back (worker, ti); }
+            worker (0);
+            for (auto& w : workers) { w.join(); }
+            for (auto& e : errors) {
+                if (e) { std::rethrow_exception (e); }
+            }
+        }
+    };
+
+} // namespace mplot
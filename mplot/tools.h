@@ -70,7 +70,7 @@ namespace mplot
          * If the last character of input is a carriage return ('\\r' 0xd), then it is
          * erased from input.
          */
-        int stripTrailingCarriageReturn (std::string& input)
+        inline int stripTrailingCarriageReturn (std::string& input)
         {
             if (input[input.size()-1] == '\r') {
                 input.erase(input.size()-1, 1);
@@ -82,7 +82,7 @@ namespace mplot
         /*!
          * Erase trailing chars c from input. Return the number of chars removed.
          */
-        int stripTrailingChars (std::string& input, const char c = ' ')
+        inline int stripTrailingChars (std::string& input, const char c = ' ')
         {
             int i = 0;
             while (input.size()>0 && input[input.size()-1] == c) {
@@ -95,13 +95,13 @@ namespace mplot
         /*!
          * Erase trailing spaces from input. Return the number of spaces removed.
          */
-        int stripTrailingSpaces (std::string& input) { return tools::stripTrailingChars (input); }
+        inline int stripTrailingSpaces (std::string& input) { return tools::stripTrailingChars (input); }
 
         /*!
          * Erase trailing whitespace from input. Return the number of whitespace
          * characters removed.
          */
-        int stripTrailingWhitespace (std::string& input)
+        inline int stripTrailingWhitespace (std::string& input)
         {
             char c;
             std::string::size_type len = input.size(), pos = len;
@@ -120,7 +120,7 @@ namespace mplot
         /*!
          * Erase any leading character c from input. Return the number of chars removed.
          */
-        int stripLeadingChars (std::string& input, const char c = ' ')
+        inline int stripLeadingChars (std::string& input, const char c = ' ')
         {
             int i = 0;
             while (input.size()>0 && input[0] == c) {
@@ -133,7 +133,7 @@ namespace mplot
         /*!
          * Erase leading spaces from input. Return the number of spaces removed.
          */
-        int stripLeadingSpaces (std::string& input)
+        inline int stripLeadingSpaces (std::string& input)
         {
             return tools::stripLeadingChars (input);
         }
@@ -142,7 +142,7 @@ namespace mplot
          * Erase leading whitespace from input. Return the number of whitespace
          * characters removed.
          */
-        int stripLeadingWhitespace (std::string& input)
+        inline int stripLeadingWhitespace (std::string& input)
         {
             char c;
             std::string::size_type pos = 0;
@@ -161,7 +161,7 @@ namespace mplot
          * Erase leading and trailing whitespace from input. Return the number of
          * whitespace characters removed.
          */
-        int stripWhitespace (std::string& input)
+        inline int stripWhitespace (std::string& input)
         {
             int n = tools::stripLeadingWhitespace (input);
             n += tools::stripTrailingWhitespace (input);
@@ -171,7 +171,7 @@ namespace mplot
         /*!
          * Return true if input contains only space, tab, newline chars.
          */
-        bool containsOnlyWhitespace (std::string& input)
+        inline bool containsOnlyWhitespace (std::string& input)
         {
             bool rtn = true;
             for (std::string::size_type i = 0; i < input.size(); ++i) {
@@ -192,7 +192,7 @@ namespace mplot
          *
          * \return the number of terms replaced.
          */
-        int searchReplace (const std::string& searchTerm,
+        inline int searchReplace (const std::string& searchTerm,
                            const std::string& replaceTerm,
                            std::string& data,
                            const bool replaceAll = true)
@@ -229,13 +229,13 @@ namespace mplot
         }
 
         //! Convert str to lower case
-        void toLowerCase (std::string& str)
+        inline void toLowerCase (std::string& str)
         {
             std::transform (str.begin(), str.end(), str.begin(), mplot::to_lower());
         }
 
         //! Convert str to upper case
-        void toUpperCase (std::string& str)
+        inline void toUpperCase (std::string& str)
         {
             std::transform (str.begin(), str.end(), str.begin(), mplot::to_upper());
         }
@@ -244,7 +244,7 @@ namespace mplot
          * Remove filename-forbidden characters from str (including directory specifiers
          * '\' and '/'.
          */
-        void conditionAsFilename (std::string& str)
+        inline void conditionAsFilename (std::string& str)
         {
             std::string::size_type ptr = std::string::npos;
             while ((ptr = str.find_last_not_of (mplot::chars_common_file_safe, ptr)) != std::string::npos) {
@@ -259,7 +259,7 @@ namespace mplot
          * separator with nothing after it will NOT cause an additional empty value in
          * the returned vector. See also splitStringWithEncs
          */
-        std::vector<std::string> stringToVector (const std::string& s,
+        inline std::vector<std::string> stringToVector (const std::string& s,
                                                  const std::string& separator,
                                                  const bool ignoreTrailingEmptyVal = true)
         {
@@ -297,7 +297,7 @@ namespace mplot
          * Stat a file, return true if the file exists and is any kind of file except a
          * directory.
          */
-        bool fileExists (const std::string& path)
+        inline bool fileExists (const std::string& path)
         {
             if (std::filesystem::exists(path)) {
                 if (std::filesystem::is_regular_file (path)
@@ -313,7 +313,7 @@ namespace mplot
         }
 
         // A simpler readDirectoryTree than the old one (find that in process_colourtables.cpp)
-        void readDirectoryTree (std::vector<std::string>& vec, const std::string& dirPath)
+        inline void readDirectoryTree (std::vector<std::string>& vec, const std::string& dirPath)
         {
             for (const std::filesystem::directory_entry& dir_entry :
                  std::filesystem::recursive_directory_iterator (dirPath)) {
@@ -330,17 +330,17 @@ namespace mplot
         }
 
         // Redundant, but still used functions wrapping std::filesystem functions
-        bool dirExists (const std::string& path) { return std::filesystem::is_directory (path); }
-        bool regfileExists (const std::string& path) { return std::filesystem::is_regular_file (path); }
-        void createDir (const std::string& path) { std::filesystem::create_directories (path); }
-        void removeDir (const std::string& path) { std::filesystem::remove (path); }
-        std::string getPwd() { return std::filesystem::current_path().string(); }
-        void unlinkFile (const std::string& fpath) { std::filesystem::remove (fpath); }
+        inline bool dirExists (const std::string& path) { return std::filesystem::is_directory (path); }
+        inline bool regfileExists (const std::string& path) { return std::filesystem::is_regular_file (path); }
+        inline void createDir (const std::string& path) { std::filesystem::create_directories (path); }
+        inline void removeDir (const std::string& path) { std::filesystem::remove (path); }
+        inline std::string getPwd() { return std::filesystem::current_path().string(); }
+        inline void unlinkFile (const std::string& fpath) { std::filesystem::remove (fpath); }
 
         /*!
          * Copy a file from an input stream into a string.
          */
-        void copyFileToString (std::istream& from, std::string& to)
+        inline void copyFileToString (std::istream& from, std::string& to)
         {
             char buf[64];
             while (!from.eof()) {
@@ -352,7 +352,7 @@ namespace mplot
         /*!
          * Copy a string fromstr to a file named to
          */
-        void copyStringToFile (const std::string& fromstr, const std::string& to)
+        inline void copyStringToFile (const std::string& fromstr, const std::string& to)
         {
             std::ofstream out;
             out.open (to.c_str(), std::ios::out|std::ios::trunc);
@@ -369,7 +369,7 @@ namespace mplot
          * Given a path like /path/to/file in str, remove all the preceding /path/to/
          * stuff to leave just the filename.
          */
-        void stripUnixPath (std::string& unixPath)
+        inline void stripUnixPath (std::string& unixPath)
         {
             std::string::size_type pos (unixPath.find_last_of ('/'));
             if (pos != std::string::npos) { unixPath = unixPath.substr (++pos); }
@@ -379,7 +379,7 @@ namespace mplot
          * Given a path like /path/to/file in str, remove the final filename, leaving
          * just the path, "/path/to".
          */
-        void stripUnixFile (std::string& unixPath)
+        inline void stripUnixFile (std::string& unixPath)
         {
             std::string::size_type pos (unixPath.find_last_of ('/'));
             if (pos != std::string::npos) { unixPath = unixPath.substr (0, pos); }
@@ -390,7 +390,7 @@ namespace mplot
          * of a pair of strings, returning the filename as the second element. The
          * unixPath could then be reconstructed as rt.first + string("/") + rtn.second.
          */
-        std::pair<std::string, std::string> getUnixPathAndFile (const std::string& unixPath)
+        inline std::pair<std::string, std::string> getUnixPathAndFile (const std::string& unixPath)
         {
             std::string fpath(unixPath);
             std::string fname(unixPath);
@@ -403,7 +403,7 @@ namespace mplot
          * Given a path like /path/to/file.ext or just file.ext in str, remove the file
          * suffix.
          */
-        void stripFileSuffix (std::string& unixPath)
+        inline void stripFileSuffix (std::string& unixPath)
         {
             std::string::size_type pos (unixPath.rfind('.'));
             if (pos != std::string::npos) {
@@ -419,7 +419,7 @@ namespace mplot
         /*!
          * Return the current time in neat string format.
          */
-        std::string timeNow()
+        inline std::string timeNow()
         {
             std::time_t curtime = std::time (nullptr);
             return std::asctime(std::localtime (&curtime));
@@ -0,0 +1,168 @@
+/*!
+ * \file
+ *
+ * Scoped trace markers for a timeline of mplotologica's build, upload and render work, written
+ * as Chrome trace-event JSON (which chrome://tracing and https://ui.perfetto.dev both open).
+ * Each marker is a 'complete' event with its start, duration and thread, so the timeline shows
+ * initializeVertices on a build thread overlapping with the render thread's uploads, say, or a
+ * frame that stalled in swapBuffers.
+ *
+ * The markers are compiled out unless MPLOT_TRACE is defined as 1, when MPLOT_TRACE_SCOPE
+ * (name) makes a mplot::trace_scope that lasts to the end of the enclosing block. The GL code
+ * uses MPLOT_TRACE_GL (see mplot/gl/debug_group_nomx.h and debug_group_mx.h), which also
+ * brackets the block's GL calls in a glPushDebugGroup/glPopDebugGroup, so that the same names
+ * show up in RenderDoc and Nsight captures. Even when compiled in, events are only recorded
+ * between mplot::trace::start() and mplot::trace::stop(); otherwise a marker costs one atomic
+ * load.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <string>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef MPLOT_TRACE
+# define MPLOT_TRACE 0
+#endif
+
+namespace mplot {
+
+    /*!
+     * The process's trace file. Events are written through the file's buffer under a mutex, so
+     * they may come from any thread.
+     */
+    struct trace
+    {
+        //! Start recording events to the Chrome trace-event JSON file file. Throws if the file can't be opened.
+        static void start (const std::string& file)
+        {
+            std::lock_guard<std::mutex> lk (trace::m());
+            if (trace::out().is_open()) { trace::close(); }
+            trace::out().open (file, std::ios::out | std::ios::trunc);
+            if (!trace::out().is_open()) { throw std::runtime_error ("mplot::trace::start: Failed to open " + file); }
+            trace::out() << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+            trace::first() = true;
+            trace::t0() = std::chrono::steady_clock::now();
+            trace::on().store (true, std::memory_order_release);
+        }
+
+        //! Stop recording and complete the file
+        static void stop()
+        {
+            std::lock_guard<std::mutex> lk (trace::m());
+            trace::on().store (false, std::memory_order_release);
+            if (trace::out().is_open()) { trace::close(); }
+        }
+
+        //! Is a trace being recorded?
+        static bool enabled() { return trace::on().load (std::memory_order_relaxed); }
+
+        //! The microseconds from the start of the trace to t
+        static double us (const std::chrono::steady_clock::time_point t)
+        {
+            return std::chrono::duration<double, std::micro>(t - trace::t0()).count();
+        }
+
+        //! A small number for the calling thread, given to threads in the order that they first trace
+        static std::uint32_t thread_id()
+        {
+            static std::atomic<std::uint32_t> next = 1u;
+            thread_local const std::uint32_t id = next++;
+            return id;
+        }
+
+        //! Record an event of name (in category cat) on this thread from ts for dur microseconds
+        static void complete (const char* name, const char* cat, const double ts, const double dur)
+        {
+            trace::add ('X', name, cat, ts, dur);
+        }
+
+        //! Name the calling thread in the trace ("render", or "simulation", say)
+        static void name_thread (const std::string& name)
+        {
+            if (!trace::enabled()) { return; }
+            std::lock_guard<std::mutex> lk (trace::m());
+            if (trace::first()) { trace::first() = false; } else { trace::out() << ",\n"; }
+            trace::out() << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << trace::thread_id()
+                         << ",\"args\":{\"name\":\"";
+            trace::escaped (name.c_str());
+            trace::out() << "\"}}";
+        }
+
+    private:
+        static void add (const char ph, const char* name, const char* cat, const double ts, const double dur)
+        {
+            const std::uint32_t tid = trace::thread_id();
+            std::lock_guard<std::mutex> lk (trace::m());
+            if (!trace::out().is_open()) { return; }
+            if (trace::first()) { trace::first() = false; } else { trace::out() << ",\n"; }
+            trace::out() << "{\"name\":\"";
+            trace::escaped (name);
+            trace::out() << "\",\"cat\":\"" << cat << "\",\"ph\":\"" << ph << "\",\"pid\":1,\"tid\":" << tid
+                         << std::fixed << std::setprecision (3) << ",\"ts\":" << ts << ",\"dur\":" << dur << "}";
+        }
+
+        static void escaped (const char* s)
+        {
+            for (; *s != '\0'; ++s) {
+                if (*s == '"' || *s == '\\') { trace::out() << '\\'; }
+                if (static_cast<unsigned char>(*s) >= 0x20u) { trace::out() << *s; }
+            }
+        }
+
+        static void close()
+        {
+            trace::out() << "\n]}\n";
+            trace::out().close();
+        }
+
+        static std::mutex& m() { static std::mutex _m; return _m; }
+        static std::ofstream& out() { static std::ofstream _out; return _out; }
+        static bool& first() { static bool _first = true; return _first; }
+        static std::atomic<bool>& on() { static std::atomic<bool> _on = false; return _on; }
+        static std::chrono::steady_clock::time_point& t0() { static std::chrono::steady_clock::time_point _t0 = {}; return _t0; }
+    };
+
+    //! Record a trace event named name for the lifetime of this object (see MPLOT_TRACE_SCOPE)
+    struct trace_scope
+    {
+        trace_scope (const char* _name, const char* _cat = "mplot") : name (_name), cat (_cat)
+        {
+            if (trace::enabled()) { this->t_start = std::chrono::steady_clock::now(); this->active = true; }
+        }
+        ~trace_scope()
+        {
+            if (!this->active) { return; }
+            const double ts = trace::us (this->t_start);
+            trace::complete (this->name, this->cat, ts, trace::us (std::chrono::steady_clock::now()) - ts);
+        }
+        trace_scope (const trace_scope&) = delete;
+        trace_scope& operator= (const trace_scope&) = delete;
+
+    private:
+        const char* name;
+        const char* cat;
+        std::chrono::steady_clock::time_point t_start = {};
+        bool active = false;
+    };
+
+} // namespace mplot
+
+#define MPLOT_TRACE_CAT2(a, b) a##b
+#define MPLOT_TRACE_CAT(a, b) MPLOT_TRACE_CAT2(a, b)
+
+#if MPLOT_TRACE
+# define MPLOT_TRACE_SCOPE(name) ::mplot::trace_scope MPLOT_TRACE_CAT(mplot_trace_scope_, __LINE__) (name)
+#else
+# define MPLOT_TRACE_SCOPE(name) ((void)0)
+#endif
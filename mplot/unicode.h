@@ -156,7 +156,7 @@ namespace mplot::unicode {
 
     //! Convert an input 8 bit string encoded in UTF-8 (or ASCII) format into an
     //! output string of unicode characters.
-    std::basic_string<char32_t> fromUtf8 (const std::string& input)
+    inline std::basic_string<char32_t> fromUtf8 (const std::string& input)
     {
         std::basic_string<char32_t> utxt;
 
@@ -217,7 +217,7 @@ namespace mplot::unicode {
 
     // Convert the Unicode char32_t c into a std::string containing the
     // corrresponding UTF-8 character code sequence.
-    std::string toUtf8 (const char32_t c)
+    inline std::string toUtf8 (const char32_t c)
     {
         std::string rtn("");
         if (c < 0x80) {
@@ -243,14 +243,14 @@ namespace mplot::unicode {
     }
 
     // Append a Unicode character to the end of string s as a UTF-8 code sequence
-    void append (std::string& s, const char32_t c)
+    inline void append (std::string& s, const char32_t c)
     {
         std::string s1 = mplot::unicode::toUtf8(c);
         s += s1;
     }
 
     // Helper to return the subscript for the given num (expected to be in range 0-9)
-    std::string subs (int num)
+    inline std::string subs (int num)
     {
         std::string rtn ("x");
         if (num < 0 || num > 9) { return rtn; }
@@ -259,7 +259,7 @@ namespace mplot::unicode {
     }
 
     // Helper to return the superscript for the given num (expected to be in range 0-9)
-    std::string ss (int num)
+    inline std::string ss (int num)
     {
         std::string rtn ("x");
         if (num < 0 || num > 9) { return rtn; }
@@ -0,0 +1,221 @@
+/*!
+ * \file
+ *
+ * A process-wide cache of the unit meshes and trig tables from which VisualModelBase's
+ * primitives (computeSphere, computeTube, computeCone, computeRing and friends) are built. Models
+ * such as ScatterVisual emit thousands of spheres or tubes with the same tessellation; with the
+ * cache, the sines and cosines for each tessellation are computed once, and each primitive is a
+ * scale, translate and copy of the cached values.
+ *
+ * The cached values are computed with exactly the expressions that the compute functions used,
+ * so the geometry that is generated from them is bit-identical.
+ *
+ * The constexpr icosahedral geodesics are held here too (get_geodesic), so that
+ * computeSphereGeoFast and instanced geodesic markers share one copy of each mesh.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <vector>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <cmath>
+#include <cstddef>
+#include <sm/mathconst>
+#include <sm/geometry>
+
+namespace mplot::unit_meshes {
+
+    //! The sines and cosines of the angles t_j = j * 2pi / segments for j in [0, segments)
+    struct circle
+    {
+        std::vector<float> sin_t;
+        std::vector<float> cos_t;
+    };
+
+    /*!
+     * A sphere of radius 1 at the origin, made of rings and segments as in
+     * VisualModelBase::computeSphere. There is a vertex at each pole and segments vertices on each
+     * of rings - 1 rings, from the bottom cap (z = -1) to the top cap (z = 1).
+     */
+    struct sphere
+    {
+        //! Vertex positions, 3 floats per vertex
+        std::vector<float> posn;
+        //! Vertex normals, 3 floats per vertex
+        std::vector<float> norm;
+        //! Indices, counted from the first vertex of the sphere
+        std::vector<unsigned int> indices;
+    };
+
+    //! Compute the sines and cosines of the angles rotation + j * 2pi / segments (not cached)
+    inline circle make_circle (const int segments, const float rotation = 0.0f)
+    {
+        circle c;
+        c.sin_t.resize (segments > 0 ? segments : 0);
+        c.cos_t.resize (segments > 0 ? segments : 0);
+        for (int j = 0; j < segments; j++) {
+            float t = rotation + j * sm::mathconst<float>::two_pi / static_cast<float>(segments);
+            c.sin_t[j] = std::sin (t);
+            c.cos_t[j] = std::cos (t);
+        }
+        return c;
+    }
+
+    //! Return the (cached) sines and cosines for a circle of segments segments
+    inline const circle& get_circle (const int segments)
+    {
+        static std::map<int, circle> cache;
+        static std::mutex cache_mutex;
+        std::lock_guard<std::mutex> lock (cache_mutex);
+        auto ci = cache.find (segments);
+        if (ci != cache.end()) { return ci->second; }
+        return cache.emplace (segments, make_circle (segments)).first->second;
+    }
+
+    //! Return the (cached) unit sphere with the given numbers of rings and segments
+    inline const sphere& get_sphere (const int rings, const int segments)
+    {
+        static std::map<std::pair<int, int>, sphere> cache;
+        static std::mutex cache_mutex;
+        std::lock_guard<std::mutex> lock (cache_mutex);
+        auto si = cache.find ({ rings, segments });
+        if (si != cache.end()) { return si->second; }
+
+        sphere& s = cache[{ rings, segments }];
+        auto push3 = [](std::vector<float>& v, float a, float b, float c) { v.push_back (a); v.push_back (b); v.push_back (c); };
+
+        // Note: the segment angles are written as in computeSphere, which gives the same floats as
+        // get_circle's j * 2pi / segments
+        std::vector<float> seg_x (segments > 0 ? segments : 0);
+        std::vector<float> seg_y (segments > 0 ? segments : 0);
+        for (int j = 0; j < segments; j++) {
+            float segment = sm::mathconst<float>::two_pi * static_cast<float>(j) / segments;
+            seg_x[j] = std::cos (segment);
+            seg_y[j] = std::sin (segment);
+        }
+
+        // First cap, a triangle fan
+        float rings0 = -sm::mathconst<float>::pi_over_2;
+        float _z0  = std::sin (rings0);
+        float rings1 = sm::mathconst<float>::pi * (-0.5f + 1.0f / rings);
+        float _z1 = std::sin (rings1);
+        float r1 = std::cos (rings1);
+        push3 (s.posn, 0.0f, 0.0f, _z0);
+        push3 (s.norm, 0.0f, 0.0f, -1.0f);
+
+        unsigned int idx = 0;
+        unsigned int capMiddle = idx++;
+        unsigned int ringStartIdx = idx;
+        unsigned int lastRingStartIdx = idx;
+
+        bool firstseg = true;
+        for (int j = 0; j < segments; j++) {
+            float _x1 = seg_x[j] * r1;
+            float _y1 = seg_y[j] * r1;
+            push3 (s.posn, _x1, _y1, _z1);
+            push3 (s.norm, _x1, _y1, _z1);
+            if (!firstseg) {
+                s.indices.push_back (capMiddle);
+                s.indices.push_back (idx - 1);
+                s.indices.push_back (idx++);
+            } else {
+                idx++;
+                firstseg = false;
+            }
+        }
+        s.indices.push_back (capMiddle);
+        s.indices.push_back (idx - 1);
+        s.indices.push_back (capMiddle + 1);
+
+        // The triangles around the rings
+        for (int i = 2; i < rings; i++) {
+            rings0 = sm::mathconst<float>::pi * (-0.5f + static_cast<float>(i) / rings);
+            _z0  = std::sin (rings0);
+            float r0 =  std::cos (rings0);
+            for (int j = 0; j < segments; j++) {
+                float _x0 = seg_x[j] * r0;
+                float _y0 = seg_y[j] * r0;
+                push3 (s.posn, _x0, _y0, _z0);
+                push3 (s.norm, _x0, _y0, _z0);
+                if (j == segments - 1) {
+                    // Last vertex is back to the start
+                    s.indices.push_back (ringStartIdx++);
+                    s.indices.push_back (idx);
+                    s.indices.push_back (lastRingStartIdx);
+                    s.indices.push_back (lastRingStartIdx);
+                    s.indices.push_back (idx++);
+                    s.indices.push_back (lastRingStartIdx + segments);
+                } else {
+                    s.indices.push_back (ringStartIdx++);
+                    s.indices.push_back (idx);
+                    s.indices.push_back (ringStartIdx);
+                    s.indices.push_back (ringStartIdx);
+                    s.indices.push_back (idx++);
+                    s.indices.push_back (idx);
+                }
+            }
+            lastRingStartIdx += segments;
+        }
+
+        // Bottom cap
+        rings0 = sm::mathconst<float>::pi_over_2;
+        _z0  = std::sin (rings0);
+        push3 (s.posn, 0.0f, 0.0f, _z0);
+        push3 (s.norm, 0.0f, 0.0f, 1.0f);
+        capMiddle = idx++;
+        ringStartIdx = lastRingStartIdx;
+        for (int j = 0; j < segments; j++) {
+            if (j != segments - 1) {
+                s.indices.push_back (capMiddle);
+                s.indices.push_back (ringStartIdx++);
+                s.indices.push_back (ringStartIdx);
+            } else {
+                // Last segment
+                s.indices.push_back (capMiddle);
+                s.indices.push_back (ringStartIdx);
+                s.indices.push_back (lastRingStartIdx);
+            }
+        }
+        return s;
+    }
+
+    /*!
+     * Return the unit geodesic sphere made with sm::geometry_ce::make_icosahedral_geodesic<F,
+     * iterations>. The vertices and faces are in the (unordered) order that the constexpr code
+     * generates them. The geodesic is computed at compile time and converted into a sphere mesh
+     * once, on the first call.
+     */
+    template <typename F, int iterations>
+    inline const sphere& get_geodesic()
+    {
+        static const sphere g = []() {
+            constexpr sm::geometry_ce::icosahedral_geodesic<F, iterations> geo = sm::geometry_ce::make_icosahedral_geodesic<F, iterations>();
+            sphere s;
+            s.posn.reserve (3u * geo.poly.vertices.size());
+            s.norm.reserve (3u * geo.poly.vertices.size());
+            s.indices.reserve (3u * geo.poly.faces.size());
+            for (auto v : geo.poly.vertices) {
+                sm::vec<float, 3> vf = v.as_float();
+                for (int i = 0; i < 3; ++i) {
+                    s.posn.push_back (vf[i]);
+                    s.norm.push_back (vf[i]);
+                }
+            }
+            for (auto f : geo.poly.faces) {
+                for (int i = 0; i < 3; ++i) { s.indices.push_back (static_cast<unsigned int>(f[i])); }
+            }
+            return s;
+        }();
+        return g;
+    }
+
+    //! The numbers of vertices and indices in an icosahedral geodesic of the given iterations
+    constexpr std::size_t geodesic_vertex_count (int iterations) { return 10u * (std::size_t{1} << (2 * iterations)) + 2u; }
+    constexpr std::size_t geodesic_index_count (int iterations) { return 60u * (std::size_t{1} << (2 * iterations)); }
+
+} // namespace mplot::unit_meshes
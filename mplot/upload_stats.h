@@ -0,0 +1,79 @@
+/*!
+ * \file
+ *
+ * Counts of the rebuilds and GL uploads of a VisualModel (see VisualModelBase::get_upload_stats
+ * and VisualBase::getUploadStats), with which to find the models that re-upload too often, and
+ * to check the savings of dirty range updates and streaming buffers.
+ *
+ * \author Seb James
+ * \date 2025
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace mplot {
+
+    //! The buffers of a VisualModel. The first four are in the order of VisualModelBase::VBOPos.
+    enum class upload_target : unsigned int { positions, normals, colours, indices, compact, instances,
+                                              datums, polylines, sprites, bars, gpu_mesh, volume, raster, cloud,
+                                              jump_flood, other, count };
+
+    struct upload_stats
+    {
+        //! Calls to finalize (or finalize_async, or Visual::finalizeAll)
+        std::uint64_t finalizes = 0;
+        //! Calls to reinit (or reinit_async)
+        std::uint64_t reinits = 0;
+        //! Calls to reinit_buffers, including those made by reinit
+        std::uint64_t reinit_buffers = 0;
+        //! Calls to reinit_colour_buffer
+        std::uint64_t reinit_colour_buffers = 0;
+        //! Calls to reinit_instances, including those made by reinit for an instanced model
+        std::uint64_t reinit_instances = 0;
+        //! Full uploads of the buffers after finalize (postVertexInit)
+        std::uint64_t full_uploads = 0;
+        //! Full uploads whose buffers were filled on the Visual's upload worker thread (see VisualMX::setUploadWorker)
+        std::uint64_t worker_uploads = 0;
+        //! Builds that were read from a geometry cache file rather than computed (see VisualModel::setGeometryCache)
+        std::uint64_t geometry_cache_hits = 0;
+        //! Changes of an adaptive tessellation's level, each of which rebuilds the model (see mplot/tessellation.h)
+        std::uint64_t tessellation_changes = 0;
+        //! Bytes sent to each buffer, indexed by upload_target
+        std::array<std::uint64_t, static_cast<std::size_t>(upload_target::count)> bytes = {};
+        //! Milliseconds spent in initializeVertices
+        double build_ms = 0.0;
+        //! Milliseconds spent uploading to GL (in postVertexInit and the reinit_*buffer functions)
+        double upload_ms = 0.0;
+
+        std::uint64_t bytes_to (const upload_target t) const { return this->bytes[static_cast<std::size_t>(t)]; }
+
+        std::uint64_t total_bytes() const
+        {
+            std::uint64_t t = 0;
+            for (auto b : this->bytes) { t += b; }
+            return t;
+        }
+
+        upload_stats& operator+= (const upload_stats& rhs)
+        {
+            this->finalizes += rhs.finalizes;
+            this->reinits += rhs.reinits;
+            this->reinit_buffers += rhs.reinit_buffers;
+            this->reinit_colour_buffers += rhs.reinit_colour_buffers;
+            this->reinit_instances += rhs.reinit_instances;
+            this->full_uploads += rhs.full_uploads;
+            this->worker_uploads += rhs.worker_uploads;
+            this->geometry_cache_hits += rhs.geometry_cache_hits;
+            this->tessellation_changes += rhs.tessellation_changes;
+            for (std::size_t i = 0; i < this->bytes.size(); ++i) { this->bytes[i] += rhs.bytes[i]; }
+            this->build_ms += rhs.build_ms;
+            this->upload_ms += rhs.upload_ms;
+            return *this;
+        }
+    };
+
+} // namespace mplot
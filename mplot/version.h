@@ -15,7 +15,7 @@ namespace mplot {
     static constexpr unsigned int version_major = 4;
     static constexpr unsigned int version_minor = 0;
     //! Returns a string for the version of the mplotologica library
-    std::string version_string()
+    inline std::string version_string()
     {
         std::string vers = std::to_string (mplot::version_major) + std::string(".") + std::to_string (mplot::version_minor);
         return vers;
@@ -0,0 +1,88 @@
+/*!
+ * \file
+ *
+ * The bricks of a volume, with which the ray marching of VisualModelBase::set_volume skips
+ * empty space. A volume of datums in [0,1] is divided into cubes of brick_size voxels on a
+ * side, and the maximum of each brick is held in a small 3D texture. A ray that samples a
+ * brick whose maximum is no more than the volume threshold jumps to the far side of the brick
+ * without sampling the volume. The maximum of a brick includes the voxels one beyond each of
+ * its faces, as a trilinear sample near a face reads them.
+ *
+ * \author Seb James
+ * \date 2026
+ */
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <span>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+
+namespace mplot {
+    namespace volume {
+
+        //! The number of voxels on a side of a brick
+        static constexpr unsigned int brick_size = 8u;
+
+        //! The number of bricks that cover n voxels
+        constexpr unsigned int bricks (const unsigned int n, const unsigned int b = brick_size)
+        {
+            return (n + b - 1u) / b;
+        }
+
+        //! The number of bricks along each axis of a volume of dims voxels
+        constexpr std::array<unsigned int, 3> brick_dims (const std::array<unsigned int, 3>& dims,
+                                                          const unsigned int b = brick_size)
+        {
+            return { bricks (dims[0], b), bricks (dims[1], b), bricks (dims[2], b) };
+        }
+
+        /*!
+         * The maxima of the bricks of the volume v of dims voxels (x varying fastest), as bytes
+         * in the same order. A maximum is rounded up to the next byte, so that no datum in a
+         * brick is more than its byte / 255. NaN datums are ignored.
+         */
+        inline std::vector<std::uint8_t> brick_max (std::span<const float> v, const std::array<unsigned int, 3>& dims,
+                                                    const unsigned int b = brick_size)
+        {
+            const std::size_t n = std::size_t{dims[0]} * dims[1] * dims[2];
+            if (v.size() < n) { throw std::runtime_error ("mplot::volume::brick_max: the volume is smaller than its dims"); }
+            const std::array<unsigned int, 3> bd = brick_dims (dims, b);
+            std::vector<float> mx (std::size_t{bd[0]} * bd[1] * bd[2], 0.0f);
+            if (mx.empty()) { return {}; }
+            // Brick k covers voxels [k * b - 1, k * b + b], so voxel i lies in bricks (i - 1) / b
+            // to (i + 1) / b (at most two of them)
+            auto first = [b](const unsigned int i) { return i > 0u ? (i - 1u) / b : 0u; };
+            auto last = [b](const unsigned int i, const unsigned int nb) { return std::min ((i + 1u) / b, nb - 1u); };
+            std::size_t i = 0;
+            for (unsigned int z = 0; z < dims[2]; ++z) {
+                const unsigned int z0 = first (z), z1 = last (z, bd[2]);
+                for (unsigned int y = 0; y < dims[1]; ++y) {
+                    const unsigned int y0 = first (y), y1 = last (y, bd[1]);
+                    for (unsigned int x = 0; x < dims[0]; ++x, ++i) {
+                        const float d = v[i];
+                        if (!(d > 0.0f)) { continue; } // zero, negative or NaN can't raise a maximum
+                        const unsigned int x0 = first (x), x1 = last (x, bd[0]);
+                        for (unsigned int bz = z0; bz <= z1; ++bz) {
+                            for (unsigned int by = y0; by <= y1; ++by) {
+                                float* row = mx.data() + (std::size_t{bz} * bd[1] + by) * bd[0];
+                                for (unsigned int bx = x0; bx <= x1; ++bx) { row[bx] = std::max (row[bx], d); }
+                            }
+                        }
+                    }
+                }
+            }
+            std::vector<std::uint8_t> out (mx.size());
+            for (std::size_t k = 0; k < mx.size(); ++k) {
+                out[k] = static_cast<std::uint8_t>(std::ceil (std::clamp (mx[k], 0.0f, 1.0f) * 255.0f));
+            }
+            return out;
+        }
+
+    } // namespace volume
+} // namespace mplot
@@ -37,7 +37,7 @@
 #endif
 #endif // APPLE
 
-auto mygetprocaddress(const char* name)
+inline auto mygetprocaddress(const char* name)
 {
     // Convert name into uname
     std::string name_str (name);
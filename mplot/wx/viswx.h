@@ -20,6 +20,7 @@ namespace mplot { using win_t = wxGLCanvas; }
 #include <mplot/VisualOwnableNoMX.h>
 // We need to be able to convert from wxWidgets keycodes to mplot keycodes
 #include <mplot/wx/keycodes.h>
+#include <mplot/reinit_queue.h>
 
 #include <mplot/wx/mygetprocaddress.h>
 
@@ -104,10 +105,7 @@ namespace mplot {
                     }
                     this->newvisualmodels.clear();
                 }
-                if (this->needs_reinit > -1) {
-                    this->model_ptrs[this->needs_reinit]->reinit();
-                    this->needs_reinit = -1;
-                }
+                this->needs_reinit.process();
                 v.render();
                 SwapBuffers();
             }
@@ -198,14 +196,27 @@ namespace mplot {
             // API for user to say that model 4 (say) need to be reinitialized.
             void set_model_needs_reinit (int model_idx, bool reinit_required = true)
             {
-                this->needs_reinit = reinit_required ? model_idx : -1;
+                mplot::VisualModel<glver>* m = this->model_ptrs.at (model_idx);
+                if (reinit_required) { this->needs_reinit.request (m); } else { this->needs_reinit.cancel (m); }
+            }
+
+            // Say that model 4 (say) needs an update of the given kind (colours only, buffers or full)
+            void set_model_needs_update (int model_idx, mplot::reinit_kind kind)
+            {
+                this->needs_reinit.request (this->model_ptrs.at (model_idx), kind);
+            }
+
+            // Queue a model, by its pointer, for an update of the given kind
+            void set_model_needs_update (mplot::VisualModel<glver>* m, mplot::reinit_kind kind)
+            {
+                this->needs_reinit.request (m, kind);
             }
 
             // In your wx code, build VisualModels that should be added to the scene and add them to this.
             std::vector<std::unique_ptr<mplot::VisualModel<glver>>> newvisualmodels;
             std::vector<mplot::VisualModel<glver>*> model_ptrs;
-            // if >-1, then that model needs a reinit.
-            int needs_reinit = -1;
+            // Models that need a reinit (or a re-upload of their buffers) in the next OnPaint
+            mplot::reinit_queue<mplot::VisualModel<glver>> needs_reinit;
 
             bool ready() { return this->glInitialized; }
 
@@ -5,8 +5,16 @@ out vec4 color;
 
 uniform sampler2D text;
 uniform vec3 textColor;
+// 1 if the glyph atlas holds signed distance fields (see TextFeatures::sdf)
+uniform int text_sdf;
 
 void main()
 {
-    color = vec4(textColor, texture(text, TexCoords).r);
+    float a = texture(text, TexCoords).r;
+    if (text_sdf == 1) {
+        // The outline is at 0.5. Antialias over about a pixel, whatever the scale of the text.
+        float w = max(0.7 * fwidth(a), 0.0001);
+        a = smoothstep(0.5 - w, 0.5 + w, a);
+    }
+    color = vec4(textColor, a);
 }
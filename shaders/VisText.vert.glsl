@@ -3,7 +3,22 @@
 
 uniform mat4 m_matrix;
 uniform mat4 v_matrix;
-uniform mat4 p_matrix;
+// If 1, the text faces the camera: its origin is placed by v_matrix * m_matrix and its glyphs
+// are laid out in the eye frame's x-y plane
+uniform int text_billboard;
+
+// Per-frame scene state, written once per frame by mplot::Visual into a uniform buffer
+layout(std140) uniform SceneState
+{
+    highp mat4 p_matrix;          // projection matrix
+    highp vec4 cyl_cam_pos;       // Camera position for the cylindrical projection
+    highp vec3 light_colour;      // Colour for both ambient and diffuse. Probably white.
+    highp float ambient_intensity; // Ambient intensity
+    highp vec3 diffuse_position;  // Positioned light
+    highp float diffuse_intensity; // Diffuse light intensity
+    highp float cyl_radius;       // Parameters of our cylindrical screen
+    highp float cyl_height;
+};
 
 layout(location = 0) in vec4 position; // Attrib location 0 is vertex position
 layout(location = 1) in vec4 vnormal;  // Attrib location 1 is vertex normal
@@ -14,6 +29,11 @@ out vec2 TexCoords;
 
 void main()
 {
-    gl_Position = p_matrix * v_matrix * m_matrix * position;
+    if (text_billboard == 1) {
+        vec4 anchor = v_matrix * m_matrix * vec4(0.0, 0.0, 0.0, 1.0);
+        gl_Position = p_matrix * vec4(anchor.xy + position.xy * anchor.w, anchor.z, anchor.w);
+    } else {
+        gl_Position = p_matrix * v_matrix * m_matrix * position;
+    }
     TexCoords = texture.xy;
 }
@@ -11,18 +11,80 @@ in VERTEX
 // diffuse_intensity to 0. That means I have just one shader for objects and it's easy
 // to change the lighting.
 
-uniform vec3 light_colour;       // Colour for both ambient and diffuse. Probably white.
-uniform float ambient_intensity; // Ambient intensity
-uniform vec3 diffuse_position;   // Positioned light
-uniform float diffuse_intensity; // Diffuse light intensity
+// Per-frame scene state, written once per frame by mplot::Visual into a uniform buffer
+layout(std140) uniform SceneState
+{
+    highp mat4 p_matrix;          // projection matrix
+    highp vec4 cyl_cam_pos;       // Camera position for the cylindrical projection
+    highp vec3 light_colour;      // Colour for both ambient and diffuse. Probably white.
+    highp float ambient_intensity; // Ambient intensity
+    highp vec3 diffuse_position;  // Positioned light
+    highp float diffuse_intensity; // Diffuse light intensity
+    highp float cyl_radius;       // Parameters of our cylindrical screen
+    highp float cyl_height;
+};
 
 //uniform mat4 lv_matrix; // 'light' scene view matrix
 //uniform mat4 p_matrix; // projection matrix
 
+// If colour_by_datum is 1 or 3, the vertex shader passed a datum in [0,1] in vertex.color.r which is
+// mapped to a colour by looking it up in the 1D colour map texture colour_lut. If it is 2,
+// vertex.color.rg are coordinates at which the datum is sampled from datum_texture. If it is 4,
+// a disc is coloured per fragment from a 2D colour_lut (see VisualModel::colour_by_polar).
+uniform int colour_by_datum;
+uniform sampler2D colour_lut;
+uniform highp sampler2D datum_texture;
+// Maps a texel of datum_texture into [0,1] (see VisualModel::datum_scale)
+uniform vec2 datum_scale;
+// Added to the coordinates at which datum_texture is sampled (see VisualModel::datum_texture_offset)
+uniform vec2 datum_texture_offset;
+// Lines along the edges of the texels of datum_texture (see VisualModel::cell_grid): xy are
+// their widths across the texture's axes, z their units (0: no lines, 1: texels, 2: pixels)
+// and w is 1 to colour the fragments outside the texture with cell_border_colour
+uniform vec4 cell_grid;
+uniform vec3 cell_grid_colour;
+uniform vec3 cell_border_colour;
+// The inner radius of a disc coloured per fragment, as a proportion of its radius
+// (see VisualModel::colour_by_polar)
+uniform float polar_inner;
+
 out vec4 finalcolor;
 
 void main()
 {
+    vec4 col = vertex.color;
+    if (colour_by_datum == 4) {
+        // vertex.color.rg is the position in the disc (in units of its radius), which is
+        // coloured from the rows of colour_lut by angle (along a row) and radius (across rows).
+        // Vertices with blue less than 2 are not part of the disc and keep their colours.
+        if (col.b > 1.5) {
+            highp float r = length(col.rg);
+            if (r > 1.0 || r < polar_inner) { discard; }
+            vec2 ts = vec2(textureSize(colour_lut, 0));
+            highp float a = fract(atan(col.g, col.r) / 6.28318531) + 0.5 / ts.x;
+            highp float rr = clamp((r - polar_inner) / max(1.0 - polar_inner, 1e-6), 0.0, 1.0);
+            col.rgb = texture(colour_lut, vec2(a, (rr * (ts.y - 1.0) + 0.5) / ts.y)).rgb;
+        }
+    } else if (colour_by_datum != 0) {
+        // The texture coordinates, before col.rgb is overwritten
+        highp vec2 tc = col.rg;
+        highp float d = colour_by_datum == 2 ? datum_scale.x * texture(datum_texture, col.rg + datum_texture_offset).r + datum_scale.y : col.r;
+        // Sample texel centres so that 0 and 1 give the first and last colours of the map
+        float n = float(textureSize(colour_lut, 0).x);
+        col.rgb = texture(colour_lut, vec2((clamp(d, 0.0, 1.0) * (n - 1.0) + 0.5) / n, 0.5)).rgb;
+        if (colour_by_datum == 2 && cell_grid.z > 0.5) {
+            highp vec2 c = tc * vec2(textureSize(datum_texture, 0));
+            highp vec2 fw = max(fwidth(c), vec2(1e-6));
+            highp vec2 hw = 0.5 * (cell_grid.z > 1.5 ? cell_grid.xy * fw : cell_grid.xy);
+            highp vec2 e = abs(c - floor(c + 0.5));
+            vec2 on = 1.0 - smoothstep(hw - 0.5 * fw, hw + 0.5 * fw, e);
+            col.rgb = mix(col.rgb, cell_grid_colour, max(on.x, on.y));
+        }
+        if (colour_by_datum == 2 && cell_grid.w > 0.5
+            && (any(lessThan(tc, vec2(0.0))) || any(greaterThan(tc, vec2(1.0))))) {
+            col.rgb = cell_border_colour;
+        }
+    }
     vec3 norm = normalize(vec3(vertex.normal));
     //vec3 dpos_trans = vec3(p_matrix * lv_matrix * vec4(diffuse_position, 1));
     //vec3 light_dirn = normalize(dpos_trans - vertex.fragpos);
@@ -30,8 +92,8 @@ void main()
     float effective_diffuse = max(dot(norm, light_dirn), 0.0);
     vec3 diffuse = diffuse_intensity * effective_diffuse * light_colour;
     vec3 ambient = ambient_intensity * light_colour;
-    vec3 result = (ambient+diffuse) * vec3(vertex.color);
-    finalcolor = vec4(result, vertex.color.w);
+    vec3 result = (ambient+diffuse) * vec3(col);
+    finalcolor = vec4(result, col.w);
     // Compared with simple shader:
     // finalcolor = vertex.color;
 }
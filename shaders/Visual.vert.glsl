@@ -7,13 +7,63 @@
 //uniform mat4 vp_matrix; // sceneview-projection matrix
 uniform mat4 m_matrix; // model matrix
 uniform mat4 v_matrix; // scene view matrix
-uniform mat4 p_matrix; // projection matrix
 // alpha - to make a model see-through
 uniform float alpha;
+// If 1, the model is coloured by the per-vertex datum, through the colour_lut texture. If 2, color
+// holds coordinates into the datum_texture (see Visual.frag.glsl). If 3, datum is the index of
+// the vertex's element, whose datum is read from datum_texture here.
+uniform int colour_by_datum;
+uniform highp sampler2D datum_texture;
+// In mode 3, the element's datum is at texel element index + element_offset, and is scaled by
+// element_scale (see VisualModel::element_offset)
+uniform int element_offset;
+uniform highp vec2 element_scale;
+
+// Per-frame scene state, written once per frame by mplot::Visual into a uniform buffer
+layout(std140) uniform SceneState
+{
+    highp mat4 p_matrix;          // projection matrix
+    highp vec4 cyl_cam_pos;       // Camera position for the cylindrical projection
+    highp vec3 light_colour;      // Colour for both ambient and diffuse. Probably white.
+    highp float ambient_intensity; // Ambient intensity
+    highp vec3 diffuse_position;  // Positioned light
+    highp float diffuse_intensity; // Diffuse light intensity
+    highp float cyl_radius;       // Parameters of our cylindrical screen
+    highp float cyl_height;
+};
+
+// The bend of a flat model onto a cylinder (see VisualModelBase::vertex_curvature). If
+// curvature.x (the radius) is positive, a vertex's x is arc length around the cylinder
+// (curvature.y is the angle per unit x and curvature.z the angle of x = 0), its y runs along the
+// axis and its z moves it in towards the axis. curvature_offset is subtracted from the result.
+uniform highp vec4 curvature;
+uniform highp vec3 curvature_offset;
+
+vec3 curve_position (vec3 p)
+{
+    if (curvature.x <= 0.0) { return p; }
+    float th = curvature.z + p.x * curvature.y;
+    return vec3((curvature.x - p.z) * cos(th), (curvature.x - p.z) * sin(th), p.y) - curvature_offset;
+}
+
+// The bent surface faces in towards the axis
+vec3 curve_normal (vec3 p, vec3 n)
+{
+    if (curvature.x <= 0.0) { return n; }
+    float th = curvature.z + p.x * curvature.y;
+    return vec3(-cos(th), -sin(th), 0.0);
+}
 
 layout(location = 0) in vec4 position; // Attrib location 0
 layout(location = 1) in vec4 normalin; // Attrib location 1
 layout(location = 2) in vec3 color;    // Attrib location 2
+// Per-instance attributes, used by instanced models such as ScatterVisual and QuiverVisual. When an instanced
+// model is not being drawn these arrays are disabled and GL supplies (0,0,0,1) which leaves
+// position and color unchanged.
+layout(location = 4) in vec4 instance_posn;   // xyz: offset of the instance, w: its scale
+layout(location = 5) in vec4 instance_colour; // rgb: instance colour, a: weight of the vertex colour
+layout(location = 6) in vec4 instance_dirn;   // xyz: direction for the model's z axis, w: radial scale
+layout(location = 7) in float datum;          // Colour-mapping datum in [0,1], used if colour_by_datum == 1 (element index if 3)
 
 out VERTEX
 {
@@ -24,11 +74,34 @@ out VERTEX
 
 void main (void)
 {
-    gl_Position = (p_matrix * v_matrix * m_matrix * position);
-    vertex.color = vec4(color, alpha);
-    vertex.fragpos = vec3(m_matrix * position);
+    // Place, scale and orient this instance. If instance_dirn is non-zero, the model's z axis
+    // is rotated onto it, after scaling the model's x and y by instance_dirn.w
+    vec3 ipos = curve_position(position.xyz) * instance_posn.w;
+    vec3 inorm = curve_normal(position.xyz, normalin.xyz);
+    if (dot(instance_dirn.xyz, instance_dirn.xyz) > 0.0) {
+        vec3 axis = normalize(instance_dirn.xyz);
+        vec3 a = abs(axis.z) < 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0);
+        vec3 u = normalize(cross(a, axis));
+        mat3 rotn = mat3(u, cross(axis, u), axis);
+        ipos = rotn * vec3(ipos.xy * instance_dirn.w, ipos.z);
+        inorm = rotn * vec3(inorm.xy / instance_dirn.w, inorm.z);
+    }
+    vec4 iposition = vec4(ipos + instance_posn.xyz, position.w);
+    // In element colour mode, the datum is looked up by element index in datum_texture (rows of
+    // textureSize(datum_texture).x elements)
+    highp float edatum = datum;
+    if (colour_by_datum == 3) {
+        int w = textureSize(datum_texture, 0).x;
+        int e = int(datum + 0.5) + element_offset;
+        edatum = element_scale.x * texelFetch(datum_texture, ivec2(e % w, e / w), 0).r + element_scale.y;
+    }
+    // In datum colour modes, the datum is passed to the fragment shader in the red channel
+    vec3 icolor = (colour_by_datum == 1 || colour_by_datum == 3) ? vec3(edatum, 0.0, 0.0) : mix(instance_colour.rgb, color, instance_colour.a);
+    gl_Position = (p_matrix * v_matrix * m_matrix * iposition);
+    vertex.color = vec4(icolor, alpha);
+    vertex.fragpos = vec3(m_matrix * iposition);
     // Normals are all automatically computed, so there's no need for
     // this line and the cube program doesn't bother to pass in the
     // normals. Maybe required only for lighting?
-    vertex.normal = normalin;
+    vertex.normal = vec4(inorm, normalin.w);
 }
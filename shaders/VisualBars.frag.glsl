@@ -0,0 +1,45 @@
+// The fragment shader for the bars of a VisualModel. Lit as Visual.frag.glsl; fragments within
+// half the outline width of a bar's sides or top take the outline colour.
+#version 410
+
+// Per-frame scene state, written once per frame by mplot::Visual into a uniform buffer
+layout(std140) uniform SceneState
+{
+    highp mat4 p_matrix;          // projection matrix
+    highp vec4 cyl_cam_pos;       // Camera position for the cylindrical projection
+    highp vec3 light_colour;      // Colour for both ambient and diffuse. Probably white.
+    highp float ambient_intensity; // Ambient intensity
+    highp vec3 diffuse_position;  // Positioned light
+    highp float diffuse_intensity; // Diffuse light intensity
+    highp float cyl_radius;       // Parameters of our cylindrical screen
+    highp float cyl_height;
+};
+
+in BAR
+{
+    vec3 fragpos;
+    vec2 local;
+    vec2 size;
+} bar;
+
+uniform float alpha;           // the model's alpha
+uniform vec3 bar_colour;
+uniform vec3 bar_line_colour;
+uniform float bar_line_width;
+
+out vec4 finalcolor;
+
+void main (void)
+{
+    float hl = 0.5 * bar_line_width;
+    bool on_line = hl > 0.0 && (abs (abs (bar.local.x) - bar.size.x) <= hl || abs (bar.local.y - bar.size.y) <= hl);
+    vec3 clr = on_line ? bar_line_colour : bar_colour;
+    // The bars lie in the model's x-y plane
+    vec3 norm = vec3(0.0, 0.0, 1.0);
+    vec3 light_dirn = normalize(diffuse_position - bar.fragpos);
+    float effective_diffuse = max(dot(norm, light_dirn), 0.0);
+    vec3 diffuse = diffuse_intensity * effective_diffuse * light_colour;
+    vec3 ambient = ambient_intensity * light_colour;
+    vec3 result = (ambient+diffuse) * clr;
+    finalcolor = vec4(result, alpha);
+}
@@ -0,0 +1,52 @@
+// The vertex shader for the bars of a VisualModel (see VisualModel::add_bars). Each bar is drawn
+// as one instance of six vertices (two triangles) from the base line to the bar's top, widened
+// by half the outline width at the sides and the top so that the outline is centred on the
+// bar's edges.
+#version 410
+
+// Per-frame scene state, written once per frame by mplot::Visual into a uniform buffer
+layout(std140) uniform SceneState
+{
+    highp mat4 p_matrix;          // projection matrix
+    highp vec4 cyl_cam_pos;       // Camera position for the cylindrical projection
+    highp vec3 light_colour;      // Colour for both ambient and diffuse. Probably white.
+    highp float ambient_intensity; // Ambient intensity
+    highp vec3 diffuse_position;  // Positioned light
+    highp float diffuse_intensity; // Diffuse light intensity
+    highp float cyl_radius;       // Parameters of our cylindrical screen
+    highp float cyl_height;
+};
+
+uniform mat4 m_matrix;      // model matrix
+uniform mat4 v_matrix;      // scene view matrix
+uniform float bar_width;    // the width of each bar, in model units
+uniform float bar_base;     // the y of the base line
+uniform float bar_z;
+uniform float bar_line_width; // the width of the outline (0 for none)
+
+// Per-instance attribute: the x of the bar's centre and the y of its top
+layout(location = 0) in vec2 bar_xtop;
+
+out BAR
+{
+    vec3 fragpos;
+    vec2 local; // the position relative to the centre of the bar's base, upwards from the base
+    vec2 size;  // the half width and the height of the bar
+} bar;
+
+void main()
+{
+    // Corners 0 and 1 are on the base, 2 and 3 at the top; the triangles are 0,1,2 and 0,2,3
+    int corner = gl_VertexID == 3 ? 0 : (gl_VertexID == 4 ? 2 : (gl_VertexID == 5 ? 3 : gl_VertexID));
+    float side = (corner == 1 || corner == 2) ? 1.0 : -1.0;
+    float h = bar_xtop.y - bar_base;
+    // A bar with its top below the base line hangs down from it
+    float up = h < 0.0 ? -1.0 : 1.0;
+    float hl = 0.5 * bar_line_width;
+    vec2 local = vec2(side * (0.5 * bar_width + hl), corner >= 2 ? abs(h) + hl : 0.0);
+    vec4 p = vec4(bar_xtop.x + local.x, bar_base + up * local.y, bar_z, 1.0);
+    gl_Position = p_matrix * v_matrix * m_matrix * p;
+    bar.fragpos = vec3(m_matrix * p);
+    bar.local = local;
+    bar.size = vec2(0.5 * bar_width, abs(h));
+}
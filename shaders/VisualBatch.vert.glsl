@@ -0,0 +1,54 @@
+// The vertex shader for batches of VisualModels that mplot::Visual draws with a single
+// glMultiDrawElementsIndirect call. Requires OpenGL 4.3 (for the shader storage block).
+#version 430
+
+// alpha and the matrices come from BatchState, but colour_by_datum is still read by Visual.frag.glsl
+uniform int colour_by_datum;
+
+// Per-frame scene state, written once per frame by mplot::Visual into a uniform buffer
+layout(std140) uniform SceneState
+{
+    highp mat4 p_matrix;          // projection matrix
+    highp vec4 cyl_cam_pos;       // Camera position for the cylindrical projection
+    highp vec3 light_colour;      // Colour for both ambient and diffuse. Probably white.
+    highp float ambient_intensity; // Ambient intensity
+    highp vec3 diffuse_position;  // Positioned light
+    highp float diffuse_intensity; // Diffuse light intensity
+    highp float cyl_radius;       // Parameters of our cylindrical screen
+    highp float cyl_height;
+};
+
+// The state of each model in the batch, written once per frame
+struct batch_model
+{
+    mat4 m_matrix; // model matrix
+    mat4 v_matrix; // scene view matrix
+    vec4 params;   // x: alpha
+};
+layout(std430, binding = 1) readonly buffer BatchState
+{
+    batch_model models[];
+};
+
+layout(location = 0) in vec4 position; // Attrib location 0
+layout(location = 1) in vec4 normalin; // Attrib location 1
+layout(location = 2) in vec3 color;    // Attrib location 2
+// The index of the model in the batch. This is a per-instance attribute holding 0, 1, 2, ...;
+// each draw command's base instance selects the element for its model.
+layout(location = 8) in float batch_id;
+
+out VERTEX
+{
+    vec4 normal;
+    vec4 color;
+    vec3 fragpos; // fragment position
+} vertex;
+
+void main (void)
+{
+    batch_model bm = models[int(batch_id + 0.5)];
+    gl_Position = (p_matrix * bm.v_matrix * bm.m_matrix * position);
+    vertex.color = vec4(color, bm.params.x);
+    vertex.fragpos = vec3(bm.m_matrix * position);
+    vertex.normal = normalin;
+}
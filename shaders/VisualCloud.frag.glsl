@@ -0,0 +1,14 @@
+// The fragment shader for the point cloud cache of a VisualModel. The points are unlit, in
+// their own colours.
+#version 410
+
+in vec3 pt_colour;
+
+uniform float alpha;
+
+out vec4 finalcolor;
+
+void main()
+{
+    finalcolor = vec4(pt_colour, alpha);
+}
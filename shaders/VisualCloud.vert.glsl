@@ -0,0 +1,34 @@
+// The vertex shader for the point cloud cache of a VisualModel (see
+// VisualModel::set_cloud_slots). Each point is drawn as a flat coloured point of
+// cloud_point_size pixels.
+#version 410
+
+// Per-frame scene state, written once per frame by mplot::Visual into a uniform buffer
+layout(std140) uniform SceneState
+{
+    highp mat4 p_matrix;          // projection matrix
+    highp vec4 cyl_cam_pos;       // Camera position for the cylindrical projection
+    highp vec3 light_colour;      // Colour for both ambient and diffuse. Probably white.
+    highp float ambient_intensity; // Ambient intensity
+    highp vec3 diffuse_position;  // Positioned light
+    highp float diffuse_intensity; // Diffuse light intensity
+    highp float cyl_radius;       // Parameters of our cylindrical screen
+    highp float cyl_height;
+};
+
+
+uniform mat4 m_matrix;      // model matrix
+uniform mat4 v_matrix;      // scene view matrix
+uniform float cloud_point_size;
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec4 colour; // RGBA8, normalized
+
+out vec3 pt_colour;
+
+void main()
+{
+    pt_colour = colour.rgb;
+    gl_PointSize = cloud_point_size;
+    gl_Position = p_matrix * v_matrix * m_matrix * vec4(position, 1.0);
+}
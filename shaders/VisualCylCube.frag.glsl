@@ -0,0 +1,38 @@
+// The fragment shader for the cube map cylindrical projection in mplot::Visual
+// (Visual::cylindricalCubeMap). The scene has been drawn into the six faces of scene_cube, from
+// cyl_cam_pos. Each pixel of the cylindrical view looks up the colour in the direction that
+// VisCyl.vert.glsl would have projected onto it: its x gives the heading, and its y gives the
+// height of the ray above the xy plane, per unit of horizontal distance.
+#version 410
+
+precision highp float;
+
+// Per-frame scene state, written once per frame by mplot::Visual into a uniform buffer
+layout(std140) uniform SceneState
+{
+    highp mat4 p_matrix;
+    highp vec4 cyl_cam_pos;
+    highp vec3 light_colour;
+    highp float ambient_intensity;
+    highp vec3 diffuse_position;
+    highp float diffuse_intensity;
+    highp float cyl_radius;       // Parameters of our cylindrical screen
+    highp float cyl_height;
+};
+
+uniform samplerCube scene_cube;
+uniform vec4 viewport; // x, y, width, height
+
+out vec4 finalcolor;
+
+void main()
+{
+    const float pi = 3.1415927;
+    // The pixel's position in [-1,1], as x_s and y_s in VisCyl.vert.glsl
+    vec2 s = (gl_FragCoord.xy - viewport.xy) / viewport.zw * 2.0 - 1.0;
+    // The heading of the ray, and its height per unit of horizontal distance (the inverse of
+    // y_s = cyl_radius * tan (asin (z / rho)) / cyl_height)
+    float a = 0.5 * pi - s.x * pi;
+    float q = sin (atan (s.y * cyl_height / cyl_radius));
+    finalcolor = vec4(texture(scene_cube, vec3(cos (a), sin (a), q)).rgb, 1.0);
+}
@@ -0,0 +1,10 @@
+// The vertex shader for the full-window passes in mplot::Visual (the composite pass of order
+// independent transparency and the resampling of the cube map cylindrical projection). Three
+// vertices, with no attributes, make one triangle that covers the viewport.
+#version 410
+
+void main()
+{
+    vec2 p = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+    gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+}
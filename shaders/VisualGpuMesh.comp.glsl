@@ -0,0 +1,108 @@
+// The compute shader that generates the z positions, normals and colours of a VisualModel's
+// vertices from one datum per element (VisualModel::gpu_mesh). Requires OpenGL 4.3.
+#version 430
+
+layout(local_size_x = 64) in;
+
+// The number of vertices to generate
+uniform uint n_vertices;
+// z = z_scale.x * datum + z_scale.y
+uniform vec2 z_scale;
+// The colour_lut position of a datum is colour_scale.x * datum + colour_scale.y
+uniform vec2 colour_scale;
+// Bit 0 set: z_scale maps the range of the data (in data_range) onto z_range instead. Bit 1
+// set: colour_scale maps it onto colour_range.
+uniform uint autoscale;
+uniform vec2 z_range;
+uniform vec2 colour_range;
+// The colour lookup texture
+uniform sampler2D colour_lut;
+
+// z_src: up to four elements whose mean datum gives z (-1 for none, from z_src.x onwards; z is
+// kept if z_src.x is -1). norm_src.xyz: the vertices
+// from which the normal is computed (-1 to keep the normal). norm_src.w: the colour element.
+struct MeshSource
+{
+    ivec4 z_src;
+    ivec4 norm_src;
+};
+
+layout(std430, binding = 2) readonly buffer MeshData { float data[]; };
+layout(std430, binding = 3) readonly buffer MeshSources { MeshSource sources[]; };
+layout(std430, binding = 4) buffer Positions { float posn[]; };
+layout(std430, binding = 5) buffer Normals { float norm[]; };
+layout(std430, binding = 6) buffer Colours { float col[]; };
+// The min and max of the data, found by VisualGpuMeshRange.comp.glsl (if autoscale != 0)
+layout(std430, binding = 7) readonly buffer MeshRange { vec4 data_range; };
+
+// The z and colour scalings in use
+vec2 zsc;
+vec2 csc;
+
+// The linear scaling that maps the range of the data onto r
+vec2 range_scale (vec2 r)
+{
+    float span = data_range.y - data_range.x;
+    if (!(span > 0.0)) { return vec2(0.0, r.x); }
+    float m = (r.y - r.x) / span;
+    return vec2(m, r.x - m * data_range.x);
+}
+
+// NaN data are treated as 0
+float datum (int e)
+{
+    float d = data[e];
+    return isnan(d) ? 0.0 : d;
+}
+
+// The generated z of vertex v (or its existing z, if it has no z sources)
+float vertex_z (uint v)
+{
+    ivec4 s = sources[v].z_src;
+    float sum = 0.0;
+    float n = 0.0;
+    for (int k = 0; k < 4; ++k) {
+        if (s[k] >= 0) {
+            sum += datum (s[k]);
+            n += 1.0;
+        }
+    }
+    return n > 0.0 ? zsc.x * (sum / n) + zsc.y : posn[3u * v + 2u];
+}
+
+vec3 vertex_posn (uint v)
+{
+    return vec3(posn[3u * v], posn[3u * v + 1u], vertex_z (v));
+}
+
+void main()
+{
+    uint v = gl_GlobalInvocationID.x;
+    if (v >= n_vertices) { return; }
+    zsc = (autoscale & 1u) != 0u ? range_scale (z_range) : z_scale;
+    csc = (autoscale & 2u) != 0u ? range_scale (colour_range) : colour_scale;
+    MeshSource ms = sources[v];
+
+    // The normal is computed from the generated positions, so it is found before any z is written
+    if (ms.norm_src.x >= 0) {
+        vec3 v0 = vertex_posn (uint(ms.norm_src.x));
+        vec3 v1 = vertex_posn (uint(ms.norm_src.y));
+        vec3 v2 = vertex_posn (uint(ms.norm_src.z));
+        vec3 n = normalize (cross (v2 - v0, v1 - v0));
+        norm[3u * v] = n.x;
+        norm[3u * v + 1u] = n.y;
+        norm[3u * v + 2u] = n.z;
+    }
+
+    if (ms.z_src.x >= 0) { posn[3u * v + 2u] = vertex_z (v); }
+
+    if (ms.norm_src.w >= 0) {
+        float c = clamp (csc.x * datum (ms.norm_src.w) + csc.y, 0.0, 1.0);
+        float n = float(textureSize (colour_lut, 0).x);
+        // As Visual.frag.glsl samples it. There are no derivatives in a compute shader, so the LOD is given.
+        vec3 rgb = textureLod (colour_lut, vec2((c * (n - 1.0) + 0.5) / n, 0.5), 0.0).rgb;
+        col[3u * v] = rgb.r;
+        col[3u * v + 1u] = rgb.g;
+        col[3u * v + 2u] = rgb.b;
+    }
+}
@@ -0,0 +1,35 @@
+// The compute shader that finds the range of the data from which a VisualModel's mesh is generated
+// on the GPU, for its autoscaling (VisualModel::gpu_mesh_autoscale). One workgroup. Requires
+// OpenGL 4.3.
+#version 430
+
+layout(local_size_x = 256) in;
+
+// The number of data
+uniform uint n_data;
+layout(std430, binding = 2) readonly buffer MeshData { float data[]; };
+layout(std430, binding = 7) writeonly buffer MeshRange { vec4 data_range; };
+
+shared vec2 r[256];
+
+void main()
+{
+    uint l = gl_LocalInvocationID.x;
+    float inf = uintBitsToFloat(0x7f800000u);
+    vec2 m = vec2(inf, -inf);
+    // Each invocation finds the range of every 256th datum (NaNs are skipped)...
+    for (uint i = l; i < n_data; i += 256u) {
+        float d = data[i];
+        if (!isnan(d)) { m = vec2(min(m.x, d), max(m.y, d)); }
+    }
+    r[l] = m;
+    memoryBarrierShared();
+    barrier();
+    // ...and the workgroup combines them
+    for (uint s = 128u; s > 0u; s >>= 1) {
+        if (l < s) { r[l] = vec2(min(r[l].x, r[l + s].x), max(r[l].y, r[l + s].y)); }
+        memoryBarrierShared();
+        barrier();
+    }
+    if (l == 0u) { data_range = vec4(r[0], 0.0, 0.0); }
+}
@@ -0,0 +1,84 @@
+// The compute shader that fills the Voronoi cells of a VisualModel by jump flooding
+// (VisualModelBase::set_jump_flood_grid). Requires OpenGL 4.3.
+#version 430
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+// The pass: 0 clears the site index of each texel to -1, 1 seeds each site's texel with its
+// index, 2 is one step of flooding and 3 writes each texel the datum of its site into cells
+uniform uint pass;
+// The step of a flooding pass, in texels
+uniform int step_size;
+// The grid of texels, which covers the rectangle lo to hi of the model's x and y
+uniform ivec2 dims;
+uniform vec2 lo;
+uniform vec2 hi;
+uniform uint n_sites;
+uniform uint n_data;
+
+layout(std430, binding = 8) readonly buffer Sites { vec2 sites[]; };
+layout(std430, binding = 9) readonly buffer SiteData { float data[]; };
+// The site index of each texel (in rows of dims.x), read from src and written to dst
+layout(std430, binding = 10) readonly buffer Src { int src[]; };
+layout(std430, binding = 11) buffer Dst { int dst[]; };
+layout(r32f, binding = 0) writeonly uniform image2D cells;
+
+// The model coordinates of the centre of texel t
+vec2 texel_posn (ivec2 t)
+{
+    return lo + (vec2(t) + 0.5) * (hi - lo) / vec2(dims);
+}
+
+void main()
+{
+    if (pass == 1u) {
+        // One invocation per site, in rows as wide as the dispatch
+        uint s = gl_GlobalInvocationID.y * gl_NumWorkGroups.x * gl_WorkGroupSize.x + gl_GlobalInvocationID.x;
+        if (s >= n_sites) { return; }
+        vec2 u = (sites[s] - lo) / (hi - lo);
+        // Sites outside the rectangle (or NaN) seed nothing
+        if (!(all(greaterThanEqual(u, vec2(0.0))) && all(lessThanEqual(u, vec2(1.0))))) { return; }
+        ivec2 st = min(ivec2(u * vec2(dims)), dims - 1);
+        // Of the sites in one texel, the last keeps it, whatever the order of the invocations
+        atomicMax (dst[st.y * dims.x + st.x], int(s));
+        return;
+    }
+
+    ivec2 t = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(t, dims))) { return; }
+    int i = t.y * dims.x + t.x;
+    if (pass == 0u) {
+        dst[i] = -1;
+        return;
+    }
+    if (pass == 3u) {
+        int s = src[i];
+        float d = (s >= 0 && uint(s) < n_data) ? data[s] : 0.0;
+        imageStore (cells, t, vec4(d, 0.0, 0.0, 0.0));
+        return;
+    }
+
+    // Keep the nearest of this texel's site and the sites of the eight texels step_size away
+    vec2 p = texel_posn (t);
+    int best = src[i];
+    float best_d = 0.0;
+    if (best >= 0) {
+        vec2 e = sites[best] - p;
+        best_d = dot (e, e);
+    }
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            ivec2 q = t + ivec2(dx, dy) * step_size;
+            if ((dx == 0 && dy == 0) || any(lessThan(q, ivec2(0))) || any(greaterThanEqual(q, dims))) { continue; }
+            int c = src[q.y * dims.x + q.x];
+            if (c < 0 || c == best) { continue; }
+            vec2 e = sites[c] - p;
+            float dd = dot (e, e);
+            if (best < 0 || dd < best_d) {
+                best = c;
+                best_d = dd;
+            }
+        }
+    }
+    dst[i] = best;
+}
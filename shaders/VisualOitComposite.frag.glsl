@@ -0,0 +1,20 @@
+// The fragment shader for the composite pass of order independent transparency in mplot::Visual.
+// The weighted average colour of the translucent fragments at each pixel is blended over the
+// opaque scene with the alpha 1 - revealage. Pixels with no translucent fragments are discarded.
+#version 410
+
+precision highp float;
+
+uniform sampler2D accum_texture;  // See VisualOit.frag.glsl
+uniform sampler2D weight_texture;
+
+out vec4 finalcolor;
+
+void main()
+{
+    ivec2 p = ivec2(gl_FragCoord.xy);
+    vec4 a = texelFetch(accum_texture, p, 0);
+    if (a.a >= 1.0) { discard; }
+    float w = texelFetch(weight_texture, p, 0).r;
+    finalcolor = vec4(a.rgb / max(w, 1e-5), 1.0 - a.a);
+}
@@ -0,0 +1,26 @@
+// The fragment shader for the ID pass of mplot::Visual::pick. Writes the model's id and the
+// element's index into an RGBA32UI framebuffer. mplot::getDefaultPickFragShader defines
+// MPLOT_PICK_PRIMITIVE_ID except on OpenGL ES before 3.2, which has no gl_PrimitiveID.
+#version 410
+#define MPLOT_PICK_PRIMITIVE_ID
+
+precision highp int;
+
+// The id of the model (its index in the Visual, plus one, as 0 is the background)
+uniform highp uint model_id;
+// The index of the first triangle of the draw call (for a model drawn in spans)
+uniform highp int element_base;
+
+flat in highp int pick_element;
+
+out highp uvec4 pick_id;
+
+void main (void)
+{
+#ifdef MPLOT_PICK_PRIMITIVE_ID
+    int e = pick_element >= 0 ? pick_element : element_base + gl_PrimitiveID;
+#else
+    int e = pick_element; // -1 becomes 0xffffffff, for no element
+#endif
+    pick_id = uvec4(model_id, uint(e), 0u, 0u);
+}
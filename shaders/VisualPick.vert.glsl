@@ -0,0 +1,67 @@
+// The vertex shader for the ID pass of mplot::Visual::pick, which draws the id of each model and
+// the index of each of its elements into an integer framebuffer. Vertices are placed, scaled and
+// oriented as in Visual.vert.glsl.
+#version 410
+
+uniform mat4 m_matrix; // model matrix
+uniform mat4 v_matrix; // scene view matrix
+// Where the element index comes from. 0: the triangle (gl_PrimitiveID, in the fragment shader),
+// 1: the datum, which holds the element index (VisualModel::colour_by_element), 2: the instance
+uniform int pick_mode;
+
+// Per-frame scene state, written once per frame by mplot::Visual into a uniform buffer
+layout(std140) uniform SceneState
+{
+    highp mat4 p_matrix;          // projection matrix
+    highp vec4 cyl_cam_pos;       // Camera position for the cylindrical projection
+    highp vec3 light_colour;      // Colour for both ambient and diffuse. Probably white.
+    highp float ambient_intensity; // Ambient intensity
+    highp vec3 diffuse_position;  // Positioned light
+    highp float diffuse_intensity; // Diffuse light intensity
+    highp float cyl_radius;       // Parameters of our cylindrical screen
+    highp float cyl_height;
+};
+
+// The bend of a flat model onto a cylinder (see VisualModelBase::vertex_curvature). If
+// curvature.x (the radius) is positive, a vertex's x is arc length around the cylinder
+// (curvature.y is the angle per unit x and curvature.z the angle of x = 0), its y runs along the
+// axis and its z moves it in towards the axis. curvature_offset is subtracted from the result.
+uniform highp vec4 curvature;
+uniform highp vec3 curvature_offset;
+
+vec3 curve_position (vec3 p)
+{
+    if (curvature.x <= 0.0) { return p; }
+    float th = curvature.z + p.x * curvature.y;
+    return vec3((curvature.x - p.z) * cos(th), (curvature.x - p.z) * sin(th), p.y) - curvature_offset;
+}
+
+// The bent surface faces in towards the axis
+vec3 curve_normal (vec3 p, vec3 n)
+{
+    if (curvature.x <= 0.0) { return n; }
+    float th = curvature.z + p.x * curvature.y;
+    return vec3(-cos(th), -sin(th), 0.0);
+}
+
+layout(location = 0) in vec4 position;
+layout(location = 4) in vec4 instance_posn;   // xyz: offset of the instance, w: its scale
+layout(location = 6) in vec4 instance_dirn;   // xyz: direction for the model's z axis, w: radial scale
+layout(location = 7) in float datum;          // The element index if pick_mode == 1
+
+// The element, or -1 if the fragment shader is to use gl_PrimitiveID
+flat out highp int pick_element;
+
+void main (void)
+{
+    vec3 ipos = curve_position(position.xyz) * instance_posn.w;
+    if (dot(instance_dirn.xyz, instance_dirn.xyz) > 0.0) {
+        vec3 axis = normalize(instance_dirn.xyz);
+        vec3 a = abs(axis.z) < 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0);
+        vec3 u = normalize(cross(a, axis));
+        mat3 rotn = mat3(u, cross(axis, u), axis);
+        ipos = rotn * vec3(ipos.xy * instance_dirn.w, ipos.z);
+    }
+    gl_Position = p_matrix * v_matrix * m_matrix * vec4(ipos + instance_posn.xyz, position.w);
+    pick_element = pick_mode == 1 ? int(datum + 0.5) : (pick_mode == 2 ? gl_InstanceID : -1);
+}
@@ -0,0 +1,47 @@
+// The fragment shader for sprites in the ID pass of mplot::Visual::pick. As in
+// VisualSprite.frag.glsl, fragments off the sphere are discarded and the rest take the sphere's
+// depth, so that a sprite hides what lies behind it.
+#version 410
+
+precision highp float;
+precision highp int;
+
+// Per-frame scene state, written once per frame by mplot::Visual into a uniform buffer
+layout(std140) uniform SceneState
+{
+    highp mat4 p_matrix;          // projection matrix
+    highp vec4 cyl_cam_pos;       // Camera position for the cylindrical projection
+    highp vec3 light_colour;      // Colour for both ambient and diffuse. Probably white.
+    highp float ambient_intensity; // Ambient intensity
+    highp vec3 diffuse_position;  // Positioned light
+    highp float diffuse_intensity; // Diffuse light intensity
+    highp float cyl_radius;       // Parameters of our cylindrical screen
+    highp float cyl_height;
+};
+
+uniform highp uint model_id;
+
+in vec3 centre;
+in float radius;
+flat in highp int pick_element;
+
+const float margin = 1.25;
+
+out highp uvec4 pick_id;
+
+void main (void)
+{
+    vec2 q = (gl_PointCoord * 2.0 - 1.0) * vec2(1.0, -1.0) * margin;
+    vec3 on_plane = centre + vec3(q * radius, 0.0);
+    bool ortho = p_matrix[3][3] > 0.5;
+    vec3 ro = ortho ? vec3(on_plane.xy, centre.z + 2.0 * radius) : vec3(0.0);
+    vec3 rd = ortho ? vec3(0.0, 0.0, -1.0) : normalize (on_plane);
+    vec3 oc = ro - centre;
+    float b = dot (oc, rd);
+    float h = b * b - (dot (oc, oc) - radius * radius);
+    if (h < 0.0) { discard; }
+    vec3 hit = ro + (-b - sqrt (h)) * rd;
+    vec4 clip = p_matrix * vec4(hit, 1.0);
+    gl_FragDepth = 0.5 * (clip.z / clip.w) + 0.5;
+    pick_id = uvec4(model_id, uint(pick_element), 0u, 0u);
+}
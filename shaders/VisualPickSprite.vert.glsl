@@ -0,0 +1,42 @@
+// The vertex shader for the sprites of a VisualModel in the ID pass of mplot::Visual::pick. Each
+// point is sized as in VisualSprite.vert.glsl, and its element is the index of the sprite.
+#version 410
+
+// Per-frame scene state, written once per frame by mplot::Visual into a uniform buffer
+layout(std140) uniform SceneState
+{
+    highp mat4 p_matrix;          // projection matrix
+    highp vec4 cyl_cam_pos;       // Camera position for the cylindrical projection
+    highp vec3 light_colour;      // Colour for both ambient and diffuse. Probably white.
+    highp float ambient_intensity; // Ambient intensity
+    highp vec3 diffuse_position;  // Positioned light
+    highp float diffuse_intensity; // Diffuse light intensity
+    highp float cyl_radius;       // Parameters of our cylindrical screen
+    highp float cyl_height;
+};
+
+uniform mat4 m_matrix;
+uniform mat4 v_matrix;
+uniform float sprite_radius;
+uniform vec2 viewport;
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec4 colour; // the alpha channel scales the sprite's radius
+
+out vec3 centre;  // The sphere's centre, in eye coordinates
+out float radius; // and its radius
+flat out highp int pick_element;
+
+// As in VisualSprite.vert.glsl
+const float margin = 1.25;
+
+void main (void)
+{
+    mat4 vm = v_matrix * m_matrix;
+    vec4 eye = vm * vec4(position, 1.0);
+    centre = eye.xyz;
+    radius = sprite_radius * colour.a * length (vm[0].xyz);
+    pick_element = gl_VertexID;
+    gl_Position = p_matrix * eye;
+    gl_PointSize = radius > 0.0 ? 2.0 * margin * radius * abs (p_matrix[1][1]) / abs (gl_Position.w) * 0.5 * viewport.y : 0.0;
+}
@@ -0,0 +1,48 @@
+// The fragment shader for the polylines of a VisualModel. Lit as Visual.frag.glsl; fragments
+// in the gaps between dashes are discarded.
+#version 410
+
+// Per-frame scene state, written once per frame by mplot::Visual into a uniform buffer
+layout(std140) uniform SceneState
+{
+    highp mat4 p_matrix;          // projection matrix
+    highp vec4 cyl_cam_pos;       // Camera position for the cylindrical projection
+    highp vec3 light_colour;      // Colour for both ambient and diffuse. Probably white.
+    highp float ambient_intensity; // Ambient intensity
+    highp vec3 diffuse_position;  // Positioned light
+    highp float diffuse_intensity; // Diffuse light intensity
+    highp float cyl_radius;       // Parameters of our cylindrical screen
+    highp float cyl_height;
+};
+
+in LINE
+{
+    vec4 color;
+    vec3 fragpos;
+    vec3 normal;
+    highp float arclen; // arc length along the polyline
+    vec2 modelpos;      // the position on the line in model coordinates
+} line;
+
+// The lengths of the dashes and of the gaps between them (no dashes if dash.y is 0)
+uniform highp vec2 dash;
+// The box (x min, x max, y min, y max, in model coordinates) outside which fragments are
+// discarded. There is no clipping if clip_box.x > clip_box.y.
+uniform vec4 clip_box;
+
+out vec4 finalcolor;
+
+void main (void)
+{
+    if (dash.y > 0.0 && mod (line.arclen, dash.x + dash.y) > dash.x) { discard; }
+    if (clip_box.x <= clip_box.y
+        && (line.modelpos.x < clip_box.x || line.modelpos.x > clip_box.y
+            || line.modelpos.y < clip_box.z || line.modelpos.y > clip_box.w)) { discard; }
+    vec3 norm = normalize(line.normal);
+    vec3 light_dirn = normalize(diffuse_position - line.fragpos);
+    float effective_diffuse = max(dot(norm, light_dirn), 0.0);
+    vec3 diffuse = diffuse_intensity * effective_diffuse * light_colour;
+    vec3 ambient = ambient_intensity * light_colour;
+    vec3 result = (ambient+diffuse) * line.color.rgb;
+    finalcolor = vec4(result, line.color.a);
+}
@@ -0,0 +1,119 @@
+// The vertex shader for the polylines of a VisualModel (see VisualModel::add_polyline). Each
+// segment of a polyline is drawn as one instance of six vertices (two triangles), which are
+// expanded here from the segment's end points to the width of the line.
+#version 410
+
+// Per-frame scene state, written once per frame by mplot::Visual into a uniform buffer
+layout(std140) uniform SceneState
+{
+    highp mat4 p_matrix;          // projection matrix
+    highp vec4 cyl_cam_pos;       // Camera position for the cylindrical projection
+    highp vec3 light_colour;      // Colour for both ambient and diffuse. Probably white.
+    highp float ambient_intensity; // Ambient intensity
+    highp vec3 diffuse_position;  // Positioned light
+    highp float diffuse_intensity; // Diffuse light intensity
+    highp float cyl_radius;       // Parameters of our cylindrical screen
+    highp float cyl_height;
+};
+
+uniform mat4 m_matrix;      // model matrix
+uniform mat4 v_matrix;      // scene view matrix
+uniform float alpha;        // the model's alpha
+uniform vec3 line_colour;
+uniform vec3 line_normal;   // the normal of the plane in which a model units width is applied
+uniform float line_width;   // in model units, or in pixels if width_in_pixels is 1
+uniform int width_in_pixels;
+uniform vec2 viewport;      // the size of the viewport in pixels
+// The transform of the points to model coordinates (see VisualModel::set_polyline_transform).
+// data_pre is the affine map applied first (scale and offset of x, then of y), data_log says
+// whether the natural log of x (and of y) is then taken and data_post is the affine map after it.
+uniform vec4 data_pre;
+uniform vec4 data_post;
+uniform ivec2 data_log;
+
+// Per-instance attributes: the point before the segment, its two end points and the point
+// after it. The w of each is the arc length along the polyline. At the ends of a polyline,
+// p_prev (or p_next) is a copy of p_a (or p_b).
+layout(location = 0) in vec4 p_prev;
+layout(location = 1) in vec4 p_a;
+layout(location = 2) in vec4 p_b;
+layout(location = 3) in vec4 p_next;
+
+out LINE
+{
+    vec4 color;
+    vec3 fragpos;
+    vec3 normal;
+    highp float arclen;
+    vec2 modelpos;      // for the clip box of the fragment shader
+} line;
+
+// The point d in model coordinates. The identity unless a transform has been set.
+vec4 to_model (vec4 d)
+{
+    vec2 u = vec2(data_pre.x * d.x + data_pre.y, data_pre.z * d.y + data_pre.w);
+    if (data_log.x != 0) { u.x = log (u.x); }
+    if (data_log.y != 0) { u.y = log (u.y); }
+    return vec4(data_post.x * u.x + data_post.y, data_post.z * u.y + data_post.w, d.z, d.w);
+}
+
+// normalize, but a zero vector stays zero
+vec3 unit (vec3 v)
+{
+    float l = length (v);
+    return l > 0.0 ? v / l : vec3(0.0);
+}
+
+// The offset of a corner at a join, for the segment normal n and the normal n_o of the
+// neighbouring segment. A butt end if there is no neighbour or the mitre would be too long.
+vec3 join (vec3 n, vec3 n_o, bool has_o)
+{
+    if (!has_o) { return n; }
+    vec3 m = unit (n + n_o);
+    float c = dot (m, n);
+    return c < 0.25 ? n : m / c;
+}
+
+// The normal to direction d in the plane of the line
+vec3 model_normal (vec3 d) { return unit (cross (d, line_normal)); }
+// The normal to screen direction d
+vec3 screen_normal (vec2 d) { return unit (vec3(-d.y, d.x, 0.0)); }
+
+void main (void)
+{
+    // Corners 0 and 1 are at p_a, 2 and 3 at p_b; the triangles are 0,1,2 and 0,2,3
+    int corner = gl_VertexID == 3 ? 0 : (gl_VertexID == 4 ? 2 : (gl_VertexID == 5 ? 3 : gl_VertexID));
+    bool at_b = corner >= 2;
+    float side = (corner == 1 || corner == 2) ? 0.5 : -0.5;
+    // The end copies (with no neighbour) are found before the transform, which may not be exact
+    bool has_o = at_b ? p_next.xyz != p_b.xyz : p_prev.xyz != p_a.xyz;
+    vec4 pa = to_model (p_a);
+    vec4 pb = to_model (p_b);
+    vec4 p = at_b ? pb : pa;
+    vec4 o = to_model (at_b ? p_next : p_prev);
+    mat4 pvm = p_matrix * v_matrix * m_matrix;
+    if (width_in_pixels == 0) {
+        // Expand in the model frame, in the plane with normal line_normal (as computeFlatLine)
+        vec3 n = model_normal (pb.xyz - pa.xyz);
+        vec3 n_o = model_normal (at_b ? o.xyz - p.xyz : p.xyz - o.xyz);
+        gl_Position = pvm * vec4(p.xyz + join (n, n_o, has_o) * side * line_width, 1.0);
+    } else {
+        // Expand on the screen, in pixels
+        vec2 half_vp = 0.5 * viewport;
+        vec4 cp = pvm * vec4(p.xyz, 1.0);
+        vec4 ca = pvm * vec4(pa.xyz, 1.0);
+        vec4 cb = pvm * vec4(pb.xyz, 1.0);
+        vec4 co = pvm * vec4(o.xyz, 1.0);
+        vec2 sp = cp.xy / cp.w * half_vp;
+        vec2 so = co.xy / co.w * half_vp;
+        vec3 n = screen_normal (cb.xy / cb.w * half_vp - ca.xy / ca.w * half_vp);
+        vec3 n_o = screen_normal (at_b ? so - sp : sp - so);
+        vec2 off = join (n, n_o, has_o).xy * side * line_width;
+        gl_Position = vec4(cp.xy + off / half_vp * cp.w, cp.zw);
+    }
+    line.color = vec4(line_colour, alpha);
+    line.fragpos = vec3(m_matrix * vec4(p.xyz, 1.0));
+    line.normal = line_normal;
+    line.arclen = p.w;
+    line.modelpos = p.xy;
+}
@@ -0,0 +1,38 @@
+// The fragment shader of the final, full-window pass in mplot::Visual when the scene is drawn
+// into an off-screen framebuffer (see VisualBase::antiAliasing). It copies the resolved scene
+// into the window, or, if fxaa is 1, filters it with a simple version of FXAA (after Timothy
+// Lottes' "Fast Approximate Anti-Aliasing"): the luma gradient across each pixel gives the
+// direction of any edge through it, along which the colour is blurred, unless the blurred luma
+// falls outside the range of the pixel's neighbourhood.
+#version 410
+
+precision highp float;
+uniform sampler2D scene_texture; // The resolved scene
+uniform int fxaa;                // 1 to filter, 0 to copy
+out vec4 finalcolor;
+void main()
+{
+    ivec2 p = ivec2(gl_FragCoord.xy);
+    vec4 cm = texelFetch(scene_texture, p, 0);
+    if (fxaa == 0) { finalcolor = cm; return; }
+    vec2 inv = 1.0 / vec2(textureSize(scene_texture, 0));
+    vec2 uv = gl_FragCoord.xy * inv;
+    const vec3 luma = vec3(0.299, 0.587, 0.114);
+    float lm = dot(cm.rgb, luma);
+    float lnw = dot(texture(scene_texture, uv + vec2(-1.0, 1.0) * inv).rgb, luma);
+    float lne = dot(texture(scene_texture, uv + vec2(1.0, 1.0) * inv).rgb, luma);
+    float lsw = dot(texture(scene_texture, uv + vec2(-1.0, -1.0) * inv).rgb, luma);
+    float lse = dot(texture(scene_texture, uv + vec2(1.0, -1.0) * inv).rgb, luma);
+    float lmin = min(lm, min(min(lnw, lne), min(lsw, lse)));
+    float lmax = max(lm, max(max(lnw, lne), max(lsw, lse)));
+    vec2 dir = vec2((lsw + lse) - (lnw + lne), (lnw + lsw) - (lne + lse));
+    float reduce = max((lnw + lne + lsw + lse) * 0.03125, 0.0078125);
+    float rcp_min = 1.0 / (min(abs(dir.x), abs(dir.y)) + reduce);
+    dir = clamp(dir * rcp_min, vec2(-8.0), vec2(8.0)) * inv;
+    vec3 a = 0.5 * (texture(scene_texture, uv + dir * (1.0 / 3.0 - 0.5)).rgb
+                    + texture(scene_texture, uv + dir * (2.0 / 3.0 - 0.5)).rgb);
+    vec3 b = a * 0.5 + 0.25 * (texture(scene_texture, uv - dir * 0.5).rgb
+                               + texture(scene_texture, uv + dir * 0.5).rgb);
+    float lb = dot(b, luma);
+    finalcolor = vec4((lb < lmin || lb > lmax) ? a : b, cm.a);
+}
@@ -0,0 +1,14 @@
+// The fragment shader for the raster of a VisualModel. The events are unlit, in the colour of
+// their populations.
+#version 410
+
+in vec3 ev_colour;
+
+uniform float alpha;
+
+out vec4 finalcolor;
+
+void main()
+{
+    finalcolor = vec4(ev_colour, alpha);
+}
@@ -0,0 +1,57 @@
+// The vertex shader for the raster of a VisualModel (see VisualModel::set_raster_capacity).
+// Each event is drawn as one instance of six vertices (a tick across its neuron's row) or, if
+// raster_points is set, as one point. Its x is its time within the window raster_window, and it
+// takes the colour of its neuron's population. Events outside the window are clipped.
+#version 410
+
+// Per-frame scene state, written once per frame by mplot::Visual into a uniform buffer
+layout(std140) uniform SceneState
+{
+    highp mat4 p_matrix;          // projection matrix
+    highp vec4 cyl_cam_pos;       // Camera position for the cylindrical projection
+    highp vec3 light_colour;      // Colour for both ambient and diffuse. Probably white.
+    highp float ambient_intensity; // Ambient intensity
+    highp vec3 diffuse_position;  // Positioned light
+    highp float diffuse_intensity; // Diffuse light intensity
+    highp float cyl_radius;       // Parameters of our cylindrical screen
+    highp float cyl_height;
+};
+
+
+uniform mat4 m_matrix;      // model matrix
+uniform mat4 v_matrix;      // scene view matrix
+uniform vec2 raster_window; // the times shown at x = 0 and at x = raster_extent.x
+uniform vec2 raster_extent; // the width of the raster and the height of a neuron's row
+uniform vec2 raster_tick;   // the width of a tick, and its height as a proportion of a row
+uniform float raster_z;
+uniform int raster_points;  // if not 0, draw points rather than ticks
+uniform float raster_point_size;
+uniform vec3 raster_colour; // the colour of neurons in no population
+uniform int n_pops;         // the populations, in order of their first neurons
+uniform uint pop_first[16];
+uniform vec3 pop_colour[16];
+
+// Per-instance (or per-point) attributes: the time of the spike and its neuron
+layout(location = 0) in float ev_t;
+layout(location = 1) in uint ev_neuron;
+
+out vec3 ev_colour;
+
+void main()
+{
+    float u = (ev_t - raster_window.x) / (raster_window.y - raster_window.x);
+    vec3 c = raster_colour;
+    for (int p = 0; p < n_pops; ++p) { if (ev_neuron >= pop_first[p]) { c = pop_colour[p]; } }
+    ev_colour = c;
+    vec2 xy = vec2(u * raster_extent.x, (float(ev_neuron) + 0.5) * raster_extent.y);
+    if (raster_points == 0) {
+        // Corners 0 and 1 are at the bottom, 2 and 3 at the top; the triangles are 0,1,2 and 0,2,3
+        int corner = gl_VertexID == 3 ? 0 : (gl_VertexID == 4 ? 2 : (gl_VertexID == 5 ? 3 : gl_VertexID));
+        vec2 f = vec2((corner == 1 || corner == 2) ? 0.5 : -0.5, corner >= 2 ? 0.5 : -0.5);
+        xy += f * vec2(raster_tick.x, raster_tick.y * raster_extent.y);
+    }
+    gl_PointSize = raster_point_size;
+    gl_Position = p_matrix * v_matrix * m_matrix * vec4(xy, raster_z, 1.0);
+    // An event outside the window (or with no time) goes beyond the far plane, to be clipped
+    if (!(u >= 0.0 && u <= 1.0)) { gl_Position = vec4(0.0, 0.0, 2.0, 1.0); }
+}
@@ -0,0 +1,60 @@
+// The fragment shader for the sprites (sphere impostors) of a VisualModel. The view ray
+// through each fragment is intersected with the sprite's sphere, to give the fragment its
+// depth and normal, and it is then lit as in Visual.frag.glsl.
+#version 410
+
+precision highp float;
+
+// Per-frame scene state, written once per frame by mplot::Visual into a uniform buffer
+layout(std140) uniform SceneState
+{
+    highp mat4 p_matrix;          // projection matrix
+    highp vec4 cyl_cam_pos;       // Camera position for the cylindrical projection
+    highp vec3 light_colour;      // Colour for both ambient and diffuse. Probably white.
+    highp float ambient_intensity; // Ambient intensity
+    highp vec3 diffuse_position;  // Positioned light
+    highp float diffuse_intensity; // Diffuse light intensity
+    highp float cyl_radius;       // Parameters of our cylindrical screen
+    highp float cyl_height;
+};
+
+in SPRITE
+{
+    vec4 color;
+    vec3 centre;
+    float radius;
+    vec3 light;
+} sprite;
+
+// As in VisualSprite.vert.glsl
+const float margin = 1.25;
+
+out vec4 finalcolor;
+
+void main (void)
+{
+    // The point on the sprite, in the plane through the sphere's centre, of this fragment
+    vec2 q = (gl_PointCoord * 2.0 - 1.0) * vec2(1.0, -1.0) * margin;
+    vec3 on_plane = sprite.centre + vec3(q * sprite.radius, 0.0);
+    // The view ray through that point (along -z in an orthographic projection)
+    bool ortho = p_matrix[3][3] > 0.5;
+    vec3 ro = ortho ? vec3(on_plane.xy, sprite.centre.z + 2.0 * sprite.radius) : vec3(0.0);
+    vec3 rd = ortho ? vec3(0.0, 0.0, -1.0) : normalize (on_plane);
+    // Intersect the ray with the sphere. A fragment whose ray misses it is not drawn.
+    vec3 oc = ro - sprite.centre;
+    float b = dot (oc, rd);
+    float h = b * b - (dot (oc, oc) - sprite.radius * sprite.radius);
+    if (h < 0.0) { discard; }
+    vec3 hit = ro + (-b - sqrt (h)) * rd;
+    // The depth of the hit (for the default depth range of 0 to 1)
+    vec4 clip = p_matrix * vec4(hit, 1.0);
+    gl_FragDepth = 0.5 * (clip.z / clip.w) + 0.5;
+
+    vec3 norm = (hit - sprite.centre) / sprite.radius;
+    vec3 light_dirn = normalize(sprite.light - hit);
+    float effective_diffuse = max(dot(norm, light_dirn), 0.0);
+    vec3 diffuse = diffuse_intensity * effective_diffuse * light_colour;
+    vec3 ambient = ambient_intensity * light_colour;
+    vec3 result = (ambient+diffuse) * sprite.color.rgb;
+    finalcolor = vec4(result, sprite.color.a);
+}
@@ -0,0 +1,51 @@
+// The vertex shader for the sprites (sphere impostors) of a VisualModel (see
+// VisualModel::add_sprite). Each sprite is one GL_POINTS vertex, sized here so that the point
+// covers the sprite's sphere on the screen.
+#version 410
+
+// Per-frame scene state, written once per frame by mplot::Visual into a uniform buffer
+layout(std140) uniform SceneState
+{
+    highp mat4 p_matrix;          // projection matrix
+    highp vec4 cyl_cam_pos;       // Camera position for the cylindrical projection
+    highp vec3 light_colour;      // Colour for both ambient and diffuse. Probably white.
+    highp float ambient_intensity; // Ambient intensity
+    highp vec3 diffuse_position;  // Positioned light
+    highp float diffuse_intensity; // Diffuse light intensity
+    highp float cyl_radius;       // Parameters of our cylindrical screen
+    highp float cyl_height;
+};
+
+uniform mat4 m_matrix;      // model matrix
+uniform mat4 v_matrix;      // scene view matrix
+uniform float alpha;        // the model's alpha
+uniform float sprite_radius; // the radius, in model units, of a sprite of size 1
+uniform vec2 viewport;      // the size of the viewport in pixels
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec4 colour; // RGBA8; the alpha is the size of the sprite
+
+out SPRITE
+{
+    vec4 color;
+    vec3 centre; // the sphere's centre in eye coordinates
+    float radius; // and its radius
+    vec3 light;  // the diffuse light position in eye coordinates
+} sprite;
+
+// The sprite covers this much more than the sphere's radius, as a sphere away from the
+// centre of a perspective view projects to an ellipse a little larger than its radius
+const float margin = 1.25;
+
+void main (void)
+{
+    mat4 vm = v_matrix * m_matrix;
+    vec4 eye = vm * vec4(position, 1.0);
+    sprite.centre = eye.xyz;
+    sprite.radius = sprite_radius * colour.a * length (vm[0].xyz);
+    sprite.color = vec4(colour.rgb, alpha);
+    sprite.light = (v_matrix * vec4(diffuse_position, 1.0)).xyz;
+    gl_Position = p_matrix * eye;
+    // The projected diameter of the sphere, in pixels (p_matrix[1][1] scales eye y into clip y)
+    gl_PointSize = sprite.radius > 0.0 ? 2.0 * margin * sprite.radius * abs (p_matrix[1][1]) / abs (gl_Position.w) * 0.5 * viewport.y : 0.0;
+}
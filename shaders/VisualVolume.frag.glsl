@@ -0,0 +1,98 @@
+// The fragment shader for the volume of a VisualModel. The view ray through the fragment is
+// marched through the volume texture from where it enters the box to where it leaves. Each
+// sample is coloured through the colour lookup texture and composited front to back; the march
+// stops once the ray is almost opaque. Bricks of the volume whose maxima are no more than the
+// threshold are crossed in one step.
+#version 410
+
+precision highp float;
+
+// Per-frame scene state, written once per frame by mplot::Visual into a uniform buffer
+layout(std140) uniform SceneState
+{
+    highp mat4 p_matrix;          // projection matrix
+    highp vec4 cyl_cam_pos;       // Camera position for the cylindrical projection
+    highp vec3 light_colour;      // Colour for both ambient and diffuse. Probably white.
+    highp float ambient_intensity; // Ambient intensity
+    highp vec3 diffuse_position;  // Positioned light
+    highp float diffuse_intensity; // Diffuse light intensity
+    highp float cyl_radius;       // Parameters of our cylindrical screen
+    highp float cyl_height;
+};
+
+uniform mat4 m_matrix;
+uniform mat4 v_matrix;
+uniform vec3 box_min;
+uniform vec3 box_max;
+uniform highp sampler3D volume;        // the datums, in [0,1]
+uniform highp sampler3D volume_bricks; // the maximum datum of each brick
+uniform sampler2D colour_lut;
+uniform vec3 volume_dims;   // the size of the volume in voxels
+uniform vec3 brick_dims;    // the size of volume_bricks in bricks
+uniform float brick_size;   // the voxels on a side of a brick
+uniform float sample_step;  // the spacing of the samples, in voxels
+uniform float density;      // the opacity of a voxel of datum 1
+uniform float threshold;    // the datum at or below which the volume is transparent
+uniform float alpha;
+
+in VOLUME
+{
+    vec3 entry;
+    vec3 dirn;
+} vol;
+
+out vec4 finalcolor;
+
+// No ray takes more samples than this (a 512 voxel cube is 887 voxels corner to corner)
+const int max_samples = 4096;
+
+void main (void)
+{
+    // The ray in voxel coordinates, with t measured in voxels from the entry point
+    vec3 ext = box_max - box_min;
+    vec3 p0 = (vol.entry - box_min) / ext * volume_dims;
+    vec3 dv = normalize (vol.dirn / ext * volume_dims);
+    vec3 safe_dv = mix (dv, vec3(1e-6), lessThan (abs (dv), vec3(1e-6)));
+    vec3 inv = 1.0 / safe_dv;
+    // Where the ray leaves the volume
+    vec3 ta = -p0 * inv;
+    vec3 tb = (volume_dims - p0) * inv;
+    vec3 tfar = max (ta, tb);
+    float t_exit = min (min (tfar.x, tfar.y), tfar.z);
+
+    float n_lut = float(textureSize (colour_lut, 0).x);
+    vec3 ahead = step (vec3(0.0), dv);
+    vec4 acc = vec4(0.0);
+    float t_hit = -1.0;
+    float t = 0.5 * sample_step;
+    for (int i = 0; i < max_samples && t < t_exit; ++i) {
+        vec3 p = p0 + t * dv;
+        // Empty space skipping: jump to the first sample beyond a transparent brick
+        vec3 b = floor (p / brick_size);
+        if (textureLod (volume_bricks, (b + 0.5) / brick_dims, 0.0).r <= threshold) {
+            vec3 tb_far = ((b + ahead) * brick_size - p0) * inv;
+            float t_far = min (min (tb_far.x, tb_far.y), tb_far.z);
+            t = max (t + sample_step, (floor (t_far / sample_step) + 0.5) * sample_step);
+            continue;
+        }
+        float d = textureLod (volume, p / volume_dims, 0.0).r;
+        if (d > threshold) { // false for NaN
+            vec3 c = textureLod (colour_lut, vec2((clamp (d, 0.0, 1.0) * (n_lut - 1.0) + 0.5) / n_lut, 0.5), 0.0).rgb;
+            // The opacity of a voxel, corrected for the length of ray that the sample stands for
+            float a = 1.0 - pow (1.0 - clamp (density * d, 0.0, 0.999), sample_step);
+            acc.rgb += (1.0 - acc.a) * a * c;
+            acc.a += (1.0 - acc.a) * a;
+            if (t_hit < 0.0) { t_hit = t; }
+            // Early ray termination
+            if (acc.a > 0.99) { break; }
+        }
+        t += sample_step;
+    }
+    if (acc.a < 1.0 / 255.0) { discard; }
+
+    // The depth is that of the first sample that was seen
+    vec3 hit = box_min + (p0 + t_hit * dv) / volume_dims * ext;
+    vec4 clip = p_matrix * v_matrix * m_matrix * vec4(hit, 1.0);
+    gl_FragDepth = 0.5 * (clip.z / clip.w) + 0.5;
+    finalcolor = vec4(acc.rgb / acc.a, acc.a * alpha);
+}
@@ -0,0 +1,47 @@
+// The vertex shader for the volume of a VisualModel (see VisualModel::set_volume). The box that
+// the volume fills is drawn as twelve triangles from gl_VertexID alone (there are no vertex
+// attributes); the front faces are kept, and each of their fragments marches its view ray
+// through the volume in VisualVolume.frag.glsl.
+#version 410
+
+// Per-frame scene state, written once per frame by mplot::Visual into a uniform buffer
+layout(std140) uniform SceneState
+{
+    highp mat4 p_matrix;          // projection matrix
+    highp vec4 cyl_cam_pos;       // Camera position for the cylindrical projection
+    highp vec3 light_colour;      // Colour for both ambient and diffuse. Probably white.
+    highp float ambient_intensity; // Ambient intensity
+    highp vec3 diffuse_position;  // Positioned light
+    highp float diffuse_intensity; // Diffuse light intensity
+    highp float cyl_radius;       // Parameters of our cylindrical screen
+    highp float cyl_height;
+};
+
+uniform mat4 m_matrix;      // model matrix
+uniform mat4 v_matrix;      // scene view matrix
+uniform vec3 box_min;       // the corners of the box, in model coordinates
+uniform vec3 box_max;
+
+out VOLUME
+{
+    vec3 entry; // the point on the box, in model coordinates
+    vec3 dirn;  // the direction of the view ray, in model coordinates
+} vol;
+
+// The corners (x in bit 0, y in bit 1, z in bit 2) of the twelve triangles of the box, each
+// wound anticlockwise as seen from outside the box
+const int corners[36] = int[36](0, 3, 1,  0, 2, 3,  4, 5, 7,  4, 7, 6,  0, 4, 6,  0, 6, 2,
+                                1, 3, 7,  1, 7, 5,  0, 1, 5,  0, 5, 4,  2, 6, 7,  2, 7, 3);
+
+void main()
+{
+    int c = corners[gl_VertexID];
+    vec3 f = vec3(float(c & 1), float((c >> 1) & 1), float((c >> 2) & 1));
+    vol.entry = mix (box_min, box_max, f);
+    mat4 vm = v_matrix * m_matrix;
+    mat4 ivm = inverse (vm);
+    // The ray runs from the eye, or along -z in an orthographic projection
+    bool ortho = p_matrix[3][3] > 0.5;
+    vol.dirn = ortho ? (ivm * vec4(0.0, 0.0, -1.0, 0.0)).xyz : vol.entry - (ivm * vec4(0.0, 0.0, 0.0, 1.0)).xyz;
+    gl_Position = p_matrix * vm * vec4(vol.entry, 1.0);
+}
@@ -3,6 +3,7 @@
 #include <list>
 #include <array>
 #include <iostream>
+#include <cmath>
 #include <mplot/ColourMap.h>
 
 int main ()
@@ -81,5 +82,48 @@ int main ()
     if (c != mid_jet) { --rtn; std::cout << "ulli fail\n"; }
     std::cout << "(unsigned long long int) Colour: " << c[0] << "," << c[1] << ","<< c[2] << std::endl;
 
+    // With a lookup table the same size as the Jet (CET_R4) table, colours are unchanged
+    mplot::ColourMap<float> cmlut(mplot::ColourMapType::Jet);
+    cmlut.setLUTResolution (256);
+    for (int i = 0; i <= 1000; ++i) {
+        float d = static_cast<float>(i) / 1000.0f;
+        if (cmlut.convert (d) != cmf.convert (d)) { --rtn; std::cout << "lut fail at " << d << "\n"; break; }
+    }
+    if (cmlut.convert (std::numeric_limits<float>::quiet_NaN()) != cmf.convert (std::numeric_limits<float>::quiet_NaN())) {
+        --rtn; std::cout << "lut nan fail\n";
+    }
+
+    // A 2D lookup table is rebuilt when the hues change, and quantizes colours only a little
+    mplot::ColourMap<float> cm2(mplot::ColourMapType::Duochrome);
+    mplot::ColourMap<float> cm2lut(mplot::ColourMapType::Duochrome);
+    cm2lut.setLUTResolution (256);
+    cm2.setHueRB();
+    cm2lut.setHueRB();
+    for (int i = 0; i <= 20; ++i) {
+        for (int j = 0; j <= 20; ++j) {
+            std::array<float, 3> c1 = cm2.convert (i / 20.0f, j / 20.0f);
+            std::array<float, 3> c2 = cm2lut.convert (i / 20.0f, j / 20.0f);
+            for (int k = 0; k < 3; ++k) {
+                if (std::abs (c1[k] - c2[k]) > 0.01f) { --rtn; std::cout << "lut2 fail\n"; i = j = 21; break; }
+            }
+        }
+    }
+
+    // Bulk conversion writes the same colours as convert(T), with and without a lookup table
+    std::vector<float> data = { 0.0f, 0.25f, 0.5f, std::numeric_limits<float>::quiet_NaN(), 1.0f };
+    std::vector<float> rgb;
+    cmlut.convert (data, rgb, 2);
+    std::vector<float> rgb_nolut;
+    cmf.convert (data, rgb_nolut);
+    if (rgb.size() != 30 || rgb_nolut.size() != 15) { --rtn; std::cout << "bulk size fail\n"; }
+    for (std::size_t i = 0; i < data.size() && rgb.size() == 30 && rgb_nolut.size() == 15; ++i) {
+        std::array<float, 3> c = cmf.convert (data[i]);
+        for (std::size_t k = 0; k < 3; ++k) {
+            if (rgb[6 * i + k] != c[k] || rgb[6 * i + 3 + k] != c[k] || rgb_nolut[3 * i + k] != c[k]) {
+                --rtn; std::cout << "bulk fail at " << i << "\n"; break;
+            }
+        }
+    }
+
     return rtn;
 }
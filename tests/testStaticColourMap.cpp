@@ -0,0 +1,61 @@
+// Test that StaticColourMap, and the batch ColourMap::convert that uses it, give the colours of
+// ColourMap::convert (T)
+#include <vector>
+#include <array>
+#include <limits>
+#include <iostream>
+#include <mplot/ColourMap.h>
+
+template <typename T>
+int compare_batch (const mplot::ColourMapType t, const std::vector<T>& data)
+{
+    mplot::ColourMap<T> cm (t);
+    std::vector<float> rgb;
+    cm.convert (data, rgb, 2);
+    int bad = 0;
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        std::array<float, 3> c = cm.convert (data[i]);
+        for (std::size_t k = 0; k < 3; ++k) {
+            if (c[k] != rgb[6 * i + k] || c[k] != rgb[6 * i + 3 + k]) { ++bad; }
+        }
+    }
+    if (bad) { std::cout << "Batch convert differs for " << mplot::ColourMap<T>::colourMapTypeToStr (t) << std::endl; }
+    return bad;
+}
+
+int main()
+{
+    int rtn = 0;
+
+    // Data in and out of range, and a NaN
+    std::vector<float> dataf;
+    for (int i = 0; i <= 1000; ++i) { dataf.push_back (-0.1f + 1.2f * static_cast<float>(i) / 1000.0f); }
+    dataf.push_back (std::numeric_limits<float>::quiet_NaN());
+    std::vector<double> datad (dataf.begin(), dataf.end());
+
+    // Tabulated and analytic static types, and a type (Monoval) that is converted per datum
+    const std::vector<mplot::ColourMapType> types = {
+        mplot::ColourMapType::Jet, mplot::ColourMapType::Plasma, mplot::ColourMapType::CET_L02,
+        mplot::ColourMapType::Devon, mplot::ColourMapType::Fire, mplot::ColourMapType::CyclicFour,
+        mplot::ColourMapType::Greyscale, mplot::ColourMapType::MonovalBlue, mplot::ColourMapType::Monoval
+    };
+    for (auto t : types) {
+        if (compare_batch<float> (t, dataf) != 0) { --rtn; }
+        if (compare_batch<double> (t, datad) != 0) { --rtn; }
+    }
+
+    // The single datum convert
+    using cmap = mplot::StaticColourMap<float, mplot::ColourMapType::Viridis>;
+    mplot::ColourMap<float> cm (mplot::ColourMapType::Viridis);
+    for (float d = -0.05f; d < 1.1f; d += 0.01f) {
+        if (cmap::convert (d) != cm.convert (d)) { --rtn; std::cout << "Viridis differs at " << d << std::endl; }
+    }
+    if (cmap::convert (std::numeric_limits<float>::quiet_NaN()) != cm.convert (std::numeric_limits<float>::quiet_NaN())) { --rtn; }
+
+    // Only the stateless maps are static
+    if (!mplot::colourmap_table<mplot::ColourMapType::Inferno>().size()) { --rtn; }
+    if (mplot::colourmap_table<mplot::ColourMapType::Fire>().size()) { --rtn; }
+    if (mplot::static_colourmap_types::visit (mplot::ColourMapType::HSV1D, []<mplot::ColourMapType>() {})) { --rtn; }
+
+    return rtn;
+}
@@ -0,0 +1,69 @@
+// Test the ring of lines behind VisualTextModel's console mode
+
+#include <iostream>
+#include <string>
+#include <mplot/console_ring.h>
+
+int main()
+{
+    int rtn = 0;
+    mplot::console_ring r;
+    r.reset (4, 5);
+
+    // Newlines split a text into lines, a trailing \r is dropped and lines are cut to 5 characters
+    r.append (U"one\r\ntwo\nthree!!");
+    if (r.total() != 3u || r.line (0) != U"one" || r.line (1) != U"two" || r.line (2) != U"three") {
+        std::cout << "append did not split and cut the lines\n";
+        rtn -= 1;
+    }
+    auto p = r.pending();
+    if (p.first != 0u || p.second != 3u) { std::cout << "pending " << p.first << "," << p.second << "\n"; rtn -= 1; }
+    r.mark_uploaded();
+    p = r.pending();
+    if (p.first != p.second) { std::cout << "nothing should be pending after mark_uploaded\n"; rtn -= 1; }
+
+    // Three more lines: the ring holds lines 2 to 5, in slots 2, 3, 0, 1
+    r.append (U"four");
+    r.append (U"five");
+    r.append (U"six");
+    if (r.size() != 4u || r.oldest() != 2u || r.slot_of (5) != 1u || r.line (5) != U"six") {
+        std::cout << "the ring did not wrap\n";
+        rtn -= 1;
+    }
+    p = r.pending();
+    if (p.first != 3u || p.second != 6u) { std::cout << "pending after wrap " << p.first << "," << p.second << "\n"; rtn -= 1; }
+
+    // All four held lines are shown in two runs: slots 2 and 3 from row 0, then slots 0 and 1 from row 2
+    std::array<mplot::console_ring::span, 2> sp = r.visible_spans (10);
+    if (sp[0].first_slot != 2u || sp[0].n != 2u || sp[0].row != 0u
+        || sp[1].first_slot != 0u || sp[1].n != 2u || sp[1].row != 2u) {
+        std::cout << "visible spans " << sp[0].first_slot << "+" << sp[0].n << "@" << sp[0].row << ", "
+                  << sp[1].first_slot << "+" << sp[1].n << "@" << sp[1].row << "\n";
+        rtn -= 1;
+    }
+
+    // Two rows show the newest two lines (4 and 5, in slots 0 and 1) in one run
+    sp = r.visible_spans (2);
+    if (sp[0].first_slot != 0u || sp[0].n != 2u || sp[1].n != 0u) { std::cout << "two rows\n"; rtn -= 1; }
+
+    // Scrolled back by one line, two rows show lines 3 and 4; scrolling further stops at the oldest
+    r.scroll_back (1);
+    auto v = r.visible (2);
+    if (v.first != 3u || v.second != 5u) { std::cout << "scrolled back 1: " << v.first << "," << v.second << "\n"; rtn -= 1; }
+    r.scroll_back (100);
+    v = r.visible (2);
+    if (v.first != 2u || v.second != 4u) { std::cout << "scrolled back 100: " << v.first << "," << v.second << "\n"; rtn -= 1; }
+
+    // Marking all pending rewrites every held line
+    r.mark_all_pending();
+    p = r.pending();
+    if (p.first != 2u || p.second != 6u) { std::cout << "mark_all_pending " << p.first << "," << p.second << "\n"; rtn -= 1; }
+
+    // An empty ring shows nothing
+    mplot::console_ring e;
+    e.reset (3, 10);
+    sp = e.visible_spans (5);
+    if (sp[0].n != 0u || sp[1].n != 0u) { std::cout << "empty ring shows lines\n"; rtn -= 1; }
+
+    return rtn;
+}
@@ -0,0 +1,146 @@
+// Test the tracing of contour lines on quad and triangle meshes
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <cmath>
+#include <sm/vec>
+#include <mplot/contours.h>
+
+// An nx by ny grid of unit spacing, with its cells as quads or as two triangles each
+struct test_mesh
+{
+    std::vector<sm::vec<float>> pos;
+    std::vector<std::array<unsigned int, 4>> quads;
+    std::vector<std::array<unsigned int, 3>> tris;
+
+    test_mesh (const unsigned int nx, const unsigned int ny)
+    {
+        for (unsigned int y = 0; y < ny; ++y) {
+            for (unsigned int x = 0; x < nx; ++x) { this->pos.push_back ({ static_cast<float>(x), static_cast<float>(y), 0.0f }); }
+        }
+        for (unsigned int y = 0; y + 1u < ny; ++y) {
+            for (unsigned int x = 0; x + 1u < nx; ++x) {
+                const unsigned int i = y * nx + x;
+                // Clockwise, so that make_anticlockwise has something to do
+                this->quads.push_back ({ i, i + nx, i + nx + 1u, i + 1u });
+                this->tris.push_back ({ i, i + 1u, i + nx + 1u });
+                this->tris.push_back ({ i, i + nx + 1u, i + nx });
+            }
+        }
+        mplot::contours::make_anticlockwise<4> (this->pos, this->quads);
+        mplot::contours::make_anticlockwise<3> (this->pos, this->tris);
+    }
+};
+
+int main()
+{
+    int rtn = 0;
+    namespace mc = mplot::contours;
+
+    // Circles about the centre of a grid: each level is one closed strip at its radius
+    test_mesh m (41, 41);
+    std::vector<float> r (m.pos.size());
+    for (std::size_t i = 0; i < m.pos.size(); ++i) {
+        r[i] = (m.pos[i] - sm::vec<float>{ 20.0f, 20.0f, 0.0f }).length();
+    }
+    const std::vector<float> levels = { 5.0f, 10.0f, 15.0f };
+    mc::lines q1;
+    mc::trace<float, 4> (m.pos, r, m.quads, levels, q1, 1);
+    if (q1.strips.size() != 3u) {
+        std::cout << "circles gave " << q1.strips.size() << " strips\n";
+        rtn -= 1;
+    }
+    for (std::size_t s = 0; s < q1.strips.size(); ++s) {
+        const mc::strip& st = q1.strips[s];
+        auto pts = q1.strip_points (s);
+        if (st.level != s || !st.closed || pts.size() < 10u || pts.front() != pts.back()) {
+            std::cout << "strip " << s << " is not a closed loop of its level\n";
+            rtn -= 1;
+        }
+        float area2 = 0.0f;
+        for (std::size_t k = 0; k < pts.size(); ++k) {
+            const float rk = (pts[k] - sm::vec<float>{ 20.0f, 20.0f, 0.0f }).length();
+            if (std::abs (rk - levels[s]) > 0.1f) {
+                std::cout << "strip " << s << " has a point at radius " << rk << "\n";
+                rtn -= 1;
+                break;
+            }
+            if (k > 0) { area2 += pts[k - 1][0] * pts[k][1] - pts[k][0] * pts[k - 1][1]; }
+        }
+        // The values above the level (outside the circle) are on the left, so the loop is clockwise
+        if (area2 >= 0.0f) {
+            std::cout << "strip " << s << " winds the wrong way\n";
+            rtn -= 1;
+        }
+    }
+
+    // The same on triangles, and on more threads
+    mc::lines t1, t4;
+    mc::trace<float, 3> (m.pos, r, m.tris, levels, t1, 1);
+    mc::trace<float, 3> (m.pos, r, m.tris, levels, t4, 4);
+    if (t1.strips.size() != 3u || t1.points != t4.points || t1.strips.size() != t4.strips.size()) {
+        std::cout << "triangles gave " << t1.strips.size() << " strips, or differed by thread\n";
+        rtn -= 1;
+    }
+    mc::lines q4;
+    mc::trace<float, 4> (m.pos, r, m.quads, levels, q4, 4);
+    if (q1.points != q4.points) {
+        std::cout << "quads differed by thread\n";
+        rtn -= 1;
+    }
+
+    // A ramp in x: each level is one open strip across the grid. The values above the level
+    // (to the right) are on its left, so it runs from top to bottom.
+    test_mesh m2 (10, 6);
+    std::vector<double> ramp (m2.pos.size());
+    for (std::size_t i = 0; i < m2.pos.size(); ++i) { ramp[i] = m2.pos[i][0]; }
+    const std::vector<float> rl = { 2.5f, 6.25f };
+    mc::lines o;
+    mc::trace<double, 4> (m2.pos, ramp, m2.quads, rl, o);
+    if (o.strips.size() != 2u) {
+        std::cout << "the ramp gave " << o.strips.size() << " strips\n";
+        rtn -= 1;
+    } else {
+        for (std::size_t s = 0; s < 2u; ++s) {
+            auto pts = o.strip_points (s);
+            if (o.strips[s].closed || pts.size() != 6u || pts.front()[1] != 5.0f || pts.back()[1] != 0.0f
+                || std::abs (pts[2][0] - rl[s]) > 1e-6f) {
+                std::cout << "ramp strip " << s << " is wrong\n";
+                rtn -= 1;
+            }
+        }
+    }
+
+    // A saddle cell: the mean of its corners decides which corners are cut off
+    std::vector<sm::vec<float>> sp = { { 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } };
+    std::vector<std::array<unsigned int, 4>> sc = { { 0u, 1u, 2u, 3u } };
+    std::vector<float> sv = { 1.0f, 0.0f, 1.0f, 0.0f };
+    mc::lines sl;
+    const std::vector<float> slo = { 0.4f };
+    mc::trace<float, 4> (sp, sv, sc, slo, sl);
+    // The centre (0.5) is above 0.4: the two corners below it (1 and 3) are cut off
+    bool ok = sl.strips.size() == 2u;
+    if (ok) {
+        for (std::size_t s = 0; s < 2u && ok; ++s) {
+            const sm::vec<float> mid = (sl.strip_points (s)[0] + sl.strip_points (s)[1]) * 0.5f;
+            const float d1 = (mid - sp[1]).length();
+            const float d3 = (mid - sp[3]).length();
+            ok = std::min (d1, d3) < 0.5f;
+        }
+    }
+    if (!ok) {
+        std::cout << "the saddle was resolved wrongly\n";
+        rtn -= 1;
+    }
+
+    // The lines are reused: clearing keeps the storage, and no levels give no lines
+    const std::size_t cap = q1.points.capacity();
+    mc::trace<float, 4> (m.pos, r, m.quads, std::span<const float>{}, q1);
+    if (!q1.points.empty() || !q1.strips.empty() || q1.points.capacity() != cap) {
+        std::cout << "reused lines were not cleared, or lost their storage\n";
+        rtn -= 1;
+    }
+
+    return rtn;
+}
@@ -0,0 +1,104 @@
+// Test the rectangular, separable and hex convolutions of mplot/convolution.h
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include "mplot/convolution.h"
+
+int main()
+{
+    int rtn = 0;
+    using cv = mplot::convolution;
+
+    // A 5 by 4 grid, valued by index
+    const int w = 5;
+    const int h = 4;
+    std::vector<float> in (w * h, 0.0f);
+    for (int i = 0; i < w * h; ++i) { in[i] = static_cast<float>(i); }
+
+    // The edge modes
+    if (cv::rect_at (in, w, h, -1, 0, mplot::edge_mode::zero) != 0.0f
+        || cv::rect_at (in, w, h, -1, 5, mplot::edge_mode::clamp) != in[3 * w]
+        || cv::rect_at (in, w, h, -1, -1, mplot::edge_mode::wrap) != in[3 * w + 4]
+        || cv::rect_at (in, w, h, 6, 4, mplot::edge_mode::wrap) != in[1]) {
+        std::cout << "edge modes\n";
+        --rtn;
+    }
+
+    // A kernel with one weight, off the centre, shifts the grid (it is not flipped)
+    const std::vector<float> shift = { 0, 0, 0,  0, 0, 1,  0, 0, 0 };
+    std::vector<float> out = cv::rect (in, w, h, shift, 3, 3, mplot::edge_mode::zero);
+    if (out[0] != in[1] || out[w - 1] != 0.0f) { std::cout << "shift\n"; --rtn; }
+
+    // A 3x3 box on a constant field: the constant with clamped edges, less at zero edges
+    std::vector<float> ones (w * h, 1.0f);
+    const std::vector<float> box (9, 1.0f / 9.0f);
+    out = cv::rect (ones, w, h, box, 3, 3, mplot::edge_mode::clamp);
+    for (float v : out) { if (std::abs (v - 1.0f) > 1e-5f) { std::cout << "box clamp\n"; --rtn; break; } }
+    out = cv::rect (ones, w, h, box, 3, 3, mplot::edge_mode::zero);
+    if (std::abs (out[0] - 4.0f / 9.0f) > 1e-5f || std::abs (out[w + 1] - 1.0f) > 1e-5f) { std::cout << "box zero\n"; --rtn; }
+
+    // A separable kernel gives the same as the general kernel of their outer product
+    const std::vector<float> kx = cv::gaussian (1.0f, 2);
+    const std::vector<float> ky = cv::gaussian (0.7f, 1);
+    float ksum = 0.0f;
+    for (float k : kx) { ksum += k; }
+    if (kx.size() != 5u || std::abs (ksum - 1.0f) > 1e-5f || !(kx[2] > kx[1] && kx[1] > kx[0]) || kx[0] != kx[4]) {
+        std::cout << "gaussian\n";
+        --rtn;
+    }
+    std::vector<float> k2 (kx.size() * ky.size());
+    for (std::size_t j = 0; j < ky.size(); ++j) {
+        for (std::size_t i = 0; i < kx.size(); ++i) { k2[j * kx.size() + i] = kx[i] * ky[j]; }
+    }
+    for (auto edge : { mplot::edge_mode::zero, mplot::edge_mode::clamp, mplot::edge_mode::wrap }) {
+        const std::vector<float> a = cv::separable (in, w, h, kx, ky, edge);
+        const std::vector<float> b = cv::rect (in, w, h, k2, static_cast<int>(kx.size()), static_cast<int>(ky.size()), edge);
+        for (int i = 0; i < w * h; ++i) {
+            if (std::abs (a[i] - b[i]) > 1e-4f) {
+                std::cout << "separable " << static_cast<unsigned int>(edge) << " at " << i << ": " << a[i] << " != " << b[i] << "\n";
+                --rtn;
+                break;
+            }
+        }
+    }
+
+    // A parallelogram of n by n hexes in axial coordinates, hex (r, g) at index g * n + r
+    const int n = 7;
+    std::vector<cv::hex_neighbours> nb (n * n);
+    auto idx = [n](const int r, const int g) { return (r < 0 || g < 0 || r >= n || g >= n) ? -1 : g * n + r; };
+    for (int g = 0; g < n; ++g) {
+        for (int r = 0; r < n; ++r) {
+            nb[g * n + r] = { idx (r + 1, g), idx (r, g + 1), idx (r - 1, g + 1), idx (r - 1, g), idx (r, g - 1), idx (r + 1, g - 1) };
+        }
+    }
+    if (cv::hex_walk (nb, idx (3, 3), 2, -1) != idx (5, 2) || cv::hex_walk (nb, idx (3, 3), -4, 0) != -1) { std::cout << "hex_walk\n"; --rtn; }
+
+    // The hexes within 1 and 2 steps
+    const std::vector<mplot::hex_tap> t1 = cv::hex_gaussian (1.0f, 1);
+    const std::vector<mplot::hex_tap> t2 = cv::hex_gaussian (1.0f, 2);
+    float tsum = 0.0f;
+    for (const mplot::hex_tap& t : t2) { tsum += t.w; }
+    if (t1.size() != 7u || t2.size() != 19u || std::abs (tsum - 1.0f) > 1e-5f) { std::cout << "hex_gaussian " << t1.size() << " " << t2.size() << "\n"; --rtn; }
+    // Every neighbour of the centre is at the same distance, so has the same weight
+    float w_east = 0.0f;
+    for (const mplot::hex_tap& t : t1) { if (t.dr == 1 && t.dg == 0) { w_east = t.w; } }
+    for (const mplot::hex_tap& t : t1) {
+        if ((t.dr != 0 || t.dg != 0) && std::abs (t.w - w_east) > 1e-6f) {
+            std::cout << "hex ring weights\n";
+            --rtn;
+            break;
+        }
+    }
+
+    // A normalised kernel leaves a constant field unchanged away from the boundary, and loses weight at it
+    std::vector<float> hones (n * n, 1.0f);
+    std::vector<float> hout = cv::hex (hones, nb, t2);
+    if (std::abs (hout[idx (3, 3)] - 1.0f) > 1e-5f || !(hout[idx (0, 0)] < 0.9f)) { std::cout << "hex constant " << hout[idx (3, 3)] << "\n"; --rtn; }
+    // A single tap moves the data
+    std::vector<float> hin (n * n, 0.0f);
+    for (int i = 0; i < n * n; ++i) { hin[i] = static_cast<float>(i); }
+    hout = cv::hex (hin, nb, { { -1, 1, 1.0f } });
+    if (hout[idx (3, 3)] != hin[idx (2, 4)] || hout[idx (0, 3)] != 0.0f) { std::cout << "hex shift\n"; --rtn; }
+
+    return rtn;
+}
@@ -0,0 +1,56 @@
+// Test the lock-free handoff of data between threads in mplot/data_slot.h
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include "mplot/data_slot.h"
+
+int main()
+{
+    int rtn = 0;
+
+    // Nothing to take before the first publish; then the latest publish is taken, once
+    mplot::triple_buffer<int> tb;
+    if (tb.update() || tb.fresh()) { std::cout << "update before publish\n"; --rtn; }
+    tb.write_buffer() = 1;
+    tb.publish();
+    tb.write_buffer() = 2;
+    tb.publish();
+    if (!tb.update() || tb.read_buffer() != 2) { std::cout << "did not take the latest value\n"; --rtn; }
+    if (tb.update()) { std::cout << "took the same value twice\n"; --rtn; }
+
+    // A writer thread publishes frames whose elements all hold the frame number. The reader must
+    // only ever see complete frames, in increasing order.
+    mplot::data_slot<float> slot;
+    int notified = 0;
+    slot.set_notify ([&notified]() { ++notified; });
+    constexpr int n_frames = 20000;
+    constexpr std::size_t n_data = 64;
+    std::thread writer ([&slot]() {
+        for (int f = 1; f <= n_frames; ++f) {
+            auto& fr = slot.write();
+            fr.scalars.assign (n_data, static_cast<float>(f));
+            slot.publish();
+        }
+    });
+    float last = 0.0f;
+    bool torn = false;
+    bool backwards = false;
+    while (last < static_cast<float>(n_frames)) {
+        if (!slot.take()) { continue; }
+        const auto& fr = slot.latest();
+        if (fr.scalars.size() != n_data) { torn = true; break; }
+        for (auto v : fr.scalars) { if (v != fr.scalars[0]) { torn = true; } }
+        if (fr.scalars[0] <= last) { backwards = true; }
+        last = fr.scalars[0];
+    }
+    writer.join();
+    // Once cleared, notify is not called
+    slot.set_notify (nullptr);
+    slot.publish();
+    if (torn) { std::cout << "a frame was torn\n"; --rtn; }
+    if (backwards) { std::cout << "frames went backwards\n"; --rtn; }
+    if (notified != n_frames) { std::cout << "notify was not called on each publish\n"; --rtn; }
+
+    return rtn;
+}
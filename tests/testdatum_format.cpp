@@ -0,0 +1,70 @@
+// Test the packing of datums into the formats of mplot::datum_format
+#include <iostream>
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "mplot/datum_format.h"
+
+int main()
+{
+    int rtn = 0;
+    namespace dp = mplot::datum_pack;
+
+    // Half floats, including the rounding at the edges of the normal and subnormal ranges
+    const float tiny = std::ldexp (1.0f, -24); // the smallest subnormal half
+    if (dp::to_half (1.0f) != 0x3c00u || dp::to_half (-2.0f) != 0xc000u || dp::to_half (0.0f) != 0u
+        || dp::to_half (65504.0f) != 0x7bffu || dp::to_half (65520.0f) != 0x7c00u
+        || dp::to_half (tiny) != 1u || dp::to_half (0.5f * tiny) != 0u || dp::to_half (1.5f * tiny) != 2u
+        || dp::to_half (std::ldexp (1.0f, -14)) != 0x0400u) {
+        std::cout << "to_half failed\n";
+        --rtn;
+    }
+    // 1 + 2^-11 is half way between two halves and rounds to the even one, 1
+    if (dp::to_half (1.0f + std::ldexp (1.0f, -11)) != 0x3c00u || dp::to_half (1.0f + 3.0f * std::ldexp (1.0f, -11)) != 0x3c02u) {
+        std::cout << "to_half tie failed\n";
+        --rtn;
+    }
+    const std::uint16_t hnan = dp::to_half (std::numeric_limits<float>::quiet_NaN());
+    if ((hnan & 0x7c00u) != 0x7c00u || (hnan & 0x3ffu) == 0u || !std::isnan (dp::from_half (hnan))) {
+        std::cout << "NaN failed\n";
+        --rtn;
+    }
+    // Every finite half survives a round trip through float
+    for (std::uint32_t h = 0; h < 0x10000u; ++h) {
+        if ((h & 0x7c00u) == 0x7c00u) { continue; }
+        if (dp::to_half (dp::from_half (static_cast<std::uint16_t>(h))) != h) {
+            std::cout << "round trip failed at " << h << "\n";
+            --rtn;
+            break;
+        }
+    }
+
+    // Normalized integers clamp to [0,1], and NaN packs as 0
+    if (dp::to_unorm<std::uint8_t> (0.5f) != 128u || dp::to_unorm<std::uint8_t> (1.5f) != 255u
+        || dp::to_unorm<std::uint8_t> (-1.0f) != 0u || dp::to_unorm<std::uint16_t> (1.0f) != 65535u
+        || dp::to_unorm<std::uint8_t> (std::numeric_limits<float>::quiet_NaN()) != 0u) {
+        std::cout << "to_unorm failed\n";
+        --rtn;
+    }
+
+    // pack writes bytes (f) bytes per datum
+    const std::vector<float> d = { 0.0f, 0.25f, 1.0f };
+    std::vector<unsigned char> b (d.size() * dp::bytes (mplot::datum_format::unorm8));
+    dp::pack (mplot::datum_format::unorm8, d.data(), d.size(), b.data());
+    if (b != std::vector<unsigned char>{ 0u, 64u, 255u }) {
+        std::cout << "pack unorm8 failed\n";
+        --rtn;
+    }
+    std::vector<unsigned char> h (d.size() * dp::bytes (mplot::datum_format::float16));
+    dp::pack (mplot::datum_format::float16, d.data(), d.size(), h.data());
+    std::uint16_t h1 = 0;
+    std::memcpy (&h1, h.data() + 2, 2);
+    if (h.size() != 6u || dp::from_half (h1) != 0.25f) {
+        std::cout << "pack float16 failed\n";
+        --rtn;
+    }
+
+    return rtn;
+}
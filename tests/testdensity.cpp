@@ -0,0 +1,67 @@
+// Test the 2D density binning of mplot::density (for ScatterVisual's density mode)
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <sm/vec>
+#include <mplot/density.h>
+
+int main()
+{
+    int rtn = 0;
+    namespace md = mplot::density;
+
+    // A 10 x 4 lattice of points over [0,9] x [0,3], plus a second point at (0,0) and a NaN
+    std::vector<sm::vec<float>> pts;
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 10; ++x) { pts.push_back ({ static_cast<float>(x), static_cast<float>(y), 0.0f }); }
+    }
+    pts.push_back ({ 0.0f, 0.0f, 0.0f });
+    pts.push_back ({ std::numeric_limits<float>::quiet_NaN(), 1.0f, 0.0f });
+
+    md::bin_grid g = md::extent (pts, { 10u, 4u }, 1);
+    if (g.lo[0] != 0.0f || g.hi[0] != 9.0f || g.lo[1] != 0.0f || g.hi[1] != 3.0f) {
+        std::cout << "extent is [" << g.lo[0] << "," << g.hi[0] << "] x [" << g.lo[1] << "," << g.hi[1] << "]\n";
+        rtn -= 1;
+    }
+
+    // 10 bins 0.9 wide across [0,9]: each column of the lattice has its own bin, and x = 9 (on hi) is in the last
+    std::vector<float> counts;
+    const float cmax = md::bin (pts, g, counts, 1);
+    float total = 0.0f;
+    for (float c : counts) { total += c; }
+    if (counts.size() != 40u || cmax != 2.0f || counts[0] != 2.0f || total != 41.0f) {
+        std::cout << "bin gave " << counts.size() << " bins, max " << cmax << ", total " << total << "\n";
+        rtn -= 1;
+    }
+    if (g.bin_of ({ 9.0f, 3.0f, 0.0f }) != 39 || g.bin_of ({ 9.5f, 0.0f, 0.0f }) != -1 || g.bin_of ({ 4.6f, 1.2f, 0.0f }) != 15) {
+        std::cout << "bin_of is wrong\n";
+        rtn -= 1;
+    }
+
+    // Many points on many threads count the same as on one
+    std::vector<sm::vec<float>> many (200000);
+    for (std::size_t i = 0; i < many.size(); ++i) {
+        const float t = static_cast<float>(i) * 0.001f;
+        many[i] = { std::sin (t) * t, std::cos (1.3f * t), 0.0f };
+    }
+    md::bin_grid gm = md::extent (many, { 64u, 32u });
+    std::vector<float> c1, c8;
+    const float m1 = md::bin (many, gm, c1, 1);
+    const float m8 = md::bin (many, gm, c8, 8);
+    float t8 = 0.0f;
+    for (float c : c8) { t8 += c; }
+    if (c1 != c8 || m1 != m8 || t8 != static_cast<float>(many.size())) {
+        std::cout << "the bins differed by thread, or lost points (" << t8 << ")\n";
+        rtn -= 1;
+    }
+
+    if (md::texel (0.0f, true) != 0.0f || std::abs (md::texel (std::exp (2.0f) - 1.0f, true) - 2.0f) > 1e-5f
+        || md::texel (7.0f, false) != 7.0f) {
+        std::cout << "texel is wrong\n";
+        rtn -= 1;
+    }
+
+    return rtn;
+}
@@ -0,0 +1,46 @@
+// Test mplot::element_mask: the kept elements and their blocks, and the masks from NaNs and boundaries
+#include <iostream>
+#include <vector>
+#include <limits>
+#include <sm/vec>
+#include "mplot/element_mask.h"
+
+int main()
+{
+    int rtn = 0;
+
+    // An empty mask keeps everything, and each element is its own block
+    mplot::element_mask m0;
+    if (!m0.empty() || m0.count (10) != 10u || !m0.keeps (7) || m0.slot (7) != 7u || m0.element (3) != 3u) {
+        std::cout << "empty mask\n";
+        --rtn;
+    }
+
+    // The kept elements are numbered in order of index
+    mplot::element_mask m (std::vector<bool>{ true, false, false, true, true, false });
+    if (m.empty() || m.size() != 6u || m.count (6) != 3u) { std::cout << "count\n"; --rtn; }
+    if (m.keeps (1) || !m.keeps (3) || m.keeps (6)) { std::cout << "keeps\n"; --rtn; }
+    if (m.slot (0) != 0u || m.slot (3) != 1u || m.slot (4) != 2u || m.slot (5) != mplot::element_mask::none) { std::cout << "slot\n"; --rtn; }
+    for (std::size_t k = 0; k < m.count (6); ++k) {
+        if (m.slot (m.element (k)) != k) { std::cout << "element and slot disagree at " << k << "\n"; --rtn; }
+    }
+    std::vector<float> d = { 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f };
+    std::vector<float> g;
+    m.gather (d, g);
+    if (g != std::vector<float>{ 0.0f, 3.0f, 4.0f }) { std::cout << "gather\n"; --rtn; }
+
+    // A mask from NaNs
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    mplot::element_mask mn = mplot::element_mask::from_nan (std::vector<float>{ nan, 1.0f, nan, 2.0f });
+    if (mn.count (4) != 2u || mn.keeps (0) || !mn.keeps (1) || mn.keeps (2) || !mn.keeps (3)) { std::cout << "from_nan\n"; --rtn; }
+
+    // A mask from an L shaped (concave) boundary, on a 4 by 4 grid of unit elements centred at 0.5, 1.5...
+    const std::vector<sm::vec<float, 2>> ell = { { 0.0f, 0.0f }, { 4.0f, 0.0f }, { 4.0f, 2.0f }, { 2.0f, 2.0f }, { 2.0f, 4.0f }, { 0.0f, 4.0f } };
+    auto centre_of = [](const std::size_t i) { return sm::vec<float, 2>{ 0.5f + static_cast<float>(i % 4u), 0.5f + static_cast<float>(i / 4u) }; };
+    mplot::element_mask mb = mplot::element_mask::from_boundary (16u, centre_of, ell);
+    if (mb.count (16) != 12u) { std::cout << "from_boundary keeps " << mb.count (16) << "\n"; --rtn; }
+    if (mb.keeps (10) || mb.keeps (15) || !mb.keeps (8) || !mb.keeps (3) || !mb.keeps (12)) { std::cout << "from_boundary\n"; --rtn; }
+    if (mplot::element_mask::inside (sm::vec<float, 2>{ 1.0f, 1.0f }, {})) { std::cout << "inside nothing\n"; --rtn; }
+
+    return rtn;
+}
@@ -0,0 +1,71 @@
+// Test the frame pacing policies of mplot::frame_pacer, with the clock faked
+#include <chrono>
+#include "mplot/frame_pacer.h"
+
+int main()
+{
+    int rtn = 0;
+    using sc = std::chrono::steady_clock;
+    using ms = std::chrono::milliseconds;
+    const sc::time_point t = sc::now();
+
+    // Render at most once per 4 steps; rendering is cheap so nothing is skipped
+    {
+        mplot::frame_pacer p;
+        p.pacing.what = mplot::frame_pacing::policy::every_n_steps;
+        p.pacing.steps = 4;
+        int n = 0;
+        for (int i = 0; i < 20; ++i) {
+            const sc::time_point now = t + ms(10 * i);
+            if (p.due (now)) { ++n; p.rendered (now, now); }
+        }
+        // Steps 0, 4, 8, 12, 16
+        if (n != 5 || p.frames_rendered() != 5u || p.frames_skipped() != 0u) { --rtn; }
+    }
+
+    // 10 fps, stepping each ms, so a frame every 100 ms
+    {
+        mplot::frame_pacer p;
+        p.pacing.fps = 10.0;
+        int n = 0;
+        for (int i = 0; i < 1000; ++i) {
+            const sc::time_point now = t + ms(i);
+            if (p.due (now)) { ++n; p.rendered (now, now); }
+        }
+        if (n != 10) { --rtn; }
+    }
+
+    // Every call, but each render takes 30 ms and may have no more than half of the time
+    {
+        mplot::frame_pacer p;
+        p.pacing.what = mplot::frame_pacing::policy::every_call;
+        p.pacing.max_render_fraction = 0.5;
+        sc::time_point now = t;
+        int n = 0;
+        for (int i = 0; i < 100; ++i) {
+            now += ms(1); // a simulation step
+            if (p.due (now)) {
+                ++n;
+                p.rendered (now, now + ms(30));
+                now += ms(30);
+            }
+        }
+        // 100 ms of simulation and 30 ms frames leave room for no more than 4 frames
+        if (n < 3 || n > 4) { --rtn; }
+        if (p.render_cost_ms() < 29.0 || p.render_cost_ms() > 31.0) { --rtn; }
+        if (p.frames_skipped() == 0u) { --rtn; }
+    }
+
+    // An interval of 50 ms; the first call always renders
+    {
+        mplot::frame_pacer p;
+        p.pacing.what = mplot::frame_pacing::policy::interval;
+        p.pacing.interval_ms = 50.0;
+        if (!p.due (t)) { --rtn; }
+        p.rendered (t, t);
+        if (p.due (t + ms(49))) { --rtn; }
+        if (!p.due (t + ms(50))) { --rtn; }
+    }
+
+    return rtn;
+}
@@ -0,0 +1,81 @@
+// Test the bookkeeping of mplot::frame_profiler, with the GPU timestamps faked
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include "mplot/frame_profiler.h"
+
+int main()
+{
+    int rtn = 0;
+
+    mplot::frame_profiler p;
+    int completed = 0;
+    p.on_profile = [&completed](const mplot::frame_profile&) { ++completed; };
+
+    // The fake GPU has written the timestamps of a query once gpu_done >= its id. Query q is at q ms.
+    unsigned int next_id = 1;
+    unsigned int gpu_done = 0;
+    auto read = [&gpu_done](const std::vector<unsigned int>& queries, const std::size_t n, std::vector<std::uint64_t>& ns) {
+        if (n > 0 && queries[n - 1] > gpu_done) { return false; }
+        ns.resize (n);
+        for (std::size_t i = 0; i < n; ++i) { ns[i] = std::uint64_t{queries[i]} * 1000000u; }
+        return true;
+    };
+    auto stamp = [&p, &next_id]() {
+        unsigned int& q = p.stamp();
+        if (q == 0) { q = next_id++; }
+    };
+
+    // One frame, drawing two models, with 10 bytes uploaded before it
+    int m1 = 0, m2 = 0;
+    p.collect (read);
+    p.begin_frame ({ 0, 0, 10 });
+    stamp();                                                     // 1
+    p.begin_item (mplot::profile_item::kind::model, &m1, { 0, 0, 0 });
+    stamp();                                                     // 2
+    stamp();                                                     // 3
+    p.end_item ({ 1, 1, 100 });
+    p.begin_item (mplot::profile_item::kind::model, &m2, { 1, 1, 100 });
+    stamp();                                                     // 4
+    stamp();                                                     // 5
+    p.end_item ({ 3, 1, 100 });
+    stamp();                                                     // 6
+    p.end_frame ({ 3, 1, 100 });
+    p.next_frame();
+
+    // The GPU has not finished the frame, so nothing is complete yet
+    p.collect (read);
+    if (completed != 0) { std::cout << "profile completed before the GPU finished\n"; --rtn; }
+
+    gpu_done = 6;
+    p.collect (read);
+    if (completed != 1) { std::cout << "profile not completed once the GPU finished\n"; --rtn; }
+
+    const mplot::frame_profile& fp = p.latest();
+    if (fp.items.size() != 2u) { std::cout << "wrong number of items\n"; --rtn; }
+    if (fp.items[0].model != &m1 || fp.items[1].model != &m2) { std::cout << "wrong models\n"; --rtn; }
+    if (fp.items[0].gpu_ms != 1.0 || fp.items[1].gpu_ms != 1.0 || fp.gpu_ms != 5.0) { std::cout << "wrong GPU times\n"; --rtn; }
+    if (fp.items[1].counts.draw_calls != 2u || fp.items[1].counts.bytes_uploaded != 0u) { std::cout << "wrong item counts\n"; --rtn; }
+    if (fp.counts.draw_calls != 3u || fp.bytes_uploaded_between != 10u) { std::cout << "wrong frame counts\n"; --rtn; }
+
+    // If the GPU falls behind by more than n_slots frames, the oldest frame completes without GPU times
+    for (std::size_t f = 0; f <= mplot::frame_profiler::n_slots; ++f) {
+        p.collect (read);
+        p.begin_frame ({});
+        stamp();
+        stamp();
+        p.end_frame ({});
+        p.next_frame();
+    }
+    if (completed != 2 || p.latest().gpu_ms != -1.0) { std::cout << "a frame the GPU had not finished was not dropped\n"; --rtn; }
+
+    // Without GPU timing, frames complete as they end
+    mplot::frame_profiler p2;
+    p2.gpu_timing = false;
+    p2.begin_frame ({});
+    p2.end_frame ({ 5, 0, 0 });
+    p2.next_frame();
+    if (p2.completed() != 1u || p2.latest().counts.draw_calls != 5u) { std::cout << "untimed frame not completed\n"; --rtn; }
+
+    return rtn;
+}
@@ -0,0 +1,99 @@
+// Test that mplot::frame_stream reads frames ahead on its I/O thread, from a raw file and from a function
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <stdexcept>
+#include "mplot/frame_stream.h"
+
+int main()
+{
+    int rtn = 0;
+    constexpr std::size_t n = 100;   // datums per frame
+    constexpr std::size_t nf = 50;   // frames
+
+    // A raw file of nf frames of n floats, valued 1000 * frame + datum, after a 16 byte header
+    const std::string path = "./testframe_stream.raw";
+    {
+        std::FILE* fp = std::fopen (path.c_str(), "wb");
+        if (fp == nullptr) { std::cout << "Can't write " << path << "\n"; return -1; }
+        const char header[16] = {};
+        std::fwrite (header, 1, sizeof header, fp);
+        std::vector<float> fr (n);
+        for (std::size_t f = 0; f < nf; ++f) {
+            for (std::size_t i = 0; i < n; ++i) { fr[i] = 1000.0f * f + i; }
+            std::fwrite (fr.data(), sizeof (float), n, fp);
+        }
+        std::fwrite (fr.data(), sizeof (float), n / 2, fp); // a part frame, which is ignored
+        std::fclose (fp);
+    }
+
+    auto frame_ok = [](const std::size_t f, const float* d, const std::size_t len) {
+        if (len != n) { return false; }
+        for (std::size_t i = 0; i < len; ++i) { if (d[i] != 1000.0f * f + i) { return false; } }
+        return true;
+    };
+
+    {
+        mplot::frame_stream_options o;
+        o.buffers = 6;
+        o.read_ahead = 4;
+        mplot::frame_stream<float> fs (std::make_unique<mplot::raw_frame_source<float>> (path, n, 16), o);
+        if (fs.frames() != nf || fs.frame_size() != n) { std::cout << "frames " << fs.frames() << "\n"; --rtn; }
+
+        // Every frame, played forwards, arrives intact
+        for (std::size_t f = 0; f < nf; ++f) {
+            fs.seek (f, true);
+            bool ok = false;
+            fs.wait_frame (f, [&](const float* d, std::size_t len) { ok = frame_ok (f, d, len); });
+            if (!ok) { std::cout << "frame " << f << "\n"; --rtn; break; }
+        }
+        // Once the I/O thread has caught up, the frames read ahead are there without a wait
+        fs.seek (20, true);
+        fs.wait_frame (20, [](const float*, std::size_t) {});
+        bool ahead = false;
+        for (int tries = 0; tries < 200 && !ahead; ++tries) {
+            ahead = fs.with_frame (24, [](const float*, std::size_t) {});
+            if (!ahead) { std::this_thread::sleep_for (std::chrono::milliseconds (5)); }
+        }
+        if (!ahead) { std::cout << "read ahead\n"; --rtn; }
+        // Backwards, and a jump to a frame far from the cursor
+        fs.seek (10, false);
+        bool ok = false;
+        fs.wait_frame (7, [&](const float* d, std::size_t len) { ok = frame_ok (7, d, len); });
+        fs.wait_frame (45, [&](const float* d, std::size_t len) { ok = ok && frame_ok (45, d, len); });
+        if (!ok) { std::cout << "backwards and jump\n"; --rtn; }
+        // A frame that isn't in the pool, and isn't being read, is not waited for
+        if (fs.with_frame (0, [](const float*, std::size_t) {})) { std::cout << "frame 0 still pooled\n"; --rtn; }
+        mplot::frame_stream_stats st = fs.get_stats();
+        if (st.reads < nf || st.failed != 0u || st.misses == 0u) { std::cout << "stats: reads " << st.reads << "\n"; --rtn; }
+    }
+    std::remove (path.c_str());
+
+    // A function source; a read that throws is rethrown by wait_frame, and a seek tries again
+    {
+        std::atomic<int> fail_at = 3;
+        auto loader = [&fail_at](std::size_t f, int* out) {
+            if (static_cast<int>(f) == fail_at) { throw std::runtime_error ("bad frame"); }
+            for (std::size_t i = 0; i < 4; ++i) { out[i] = static_cast<int>(10 * f + i); }
+        };
+        mplot::frame_stream<int> fs (std::make_unique<mplot::function_frame_source<int>> (8, 4, loader));
+        int v = -1;
+        fs.wait_frame (2, [&v](const int* d, std::size_t) { v = d[3]; });
+        if (v != 23) { std::cout << "function source " << v << "\n"; --rtn; }
+        bool threw = false;
+        try {
+            fs.wait_frame (3, [](const int*, std::size_t) {});
+        } catch (const std::runtime_error&) { threw = true; }
+        if (!threw) { std::cout << "no exception\n"; --rtn; }
+        fail_at = -1;
+        fs.seek (3);
+        fs.wait_frame (3, [&v](const int* d, std::size_t) { v = d[0]; });
+        if (v != 30 || fs.get_stats().failed != 1u) { std::cout << "retry " << v << "\n"; --rtn; }
+    }
+
+    return rtn;
+}
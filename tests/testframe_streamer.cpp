@@ -0,0 +1,333 @@
+// Test the frame streamer that serves a streaming Visual's frames (as MJPEG) to web browsers,
+// and its JPEG encoder, WebSocket framing and rate control
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+#include <cstring>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#include <mplot/frame_streamer.h>
+
+// Connect to the streamer on 127.0.0.1:port and send req
+int connect_and_send (const unsigned short port, const std::string& req)
+{
+    const int fd = ::socket (AF_INET, SOCK_STREAM, 0);
+    sockaddr_in sa = {};
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons (port);
+    ::inet_pton (AF_INET, "127.0.0.1", &sa.sin_addr);
+    if (::connect (fd, reinterpret_cast<sockaddr*>(&sa), sizeof sa) != 0) { ::close (fd); return -1; }
+    ::send (fd, req.data(), req.size(), MSG_NOSIGNAL);
+    return fd;
+}
+
+// Read from fd until what has arrived contains needle (or 2 s pass)
+bool read_until (const int fd, std::string& got, const std::string& needle)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    char buf[4096];
+    while (got.find (needle) == std::string::npos) {
+        if (std::chrono::steady_clock::now() - t0 > std::chrono::seconds (2)) { return false; }
+        pollfd p = { fd, POLLIN, 0 };
+        if (::poll (&p, 1, 50) <= 0) { continue; }
+        const ssize_t n = ::recv (fd, buf, sizeof buf, 0);
+        if (n <= 0) { return got.find (needle) != std::string::npos; }
+        got.append (buf, static_cast<std::size_t>(n));
+    }
+    return true;
+}
+
+// A masked WebSocket text frame, as a browser sends
+std::string client_frame (const std::string& payload)
+{
+    std::string f;
+    f.push_back (static_cast<char>(0x81));
+    f.push_back (static_cast<char>(0x80 | payload.size()));
+    const char mask[4] = { 0x12, 0x34, 0x56, 0x78 };
+    f.append (mask, 4);
+    for (std::size_t i = 0; i < payload.size(); ++i) { f.push_back (static_cast<char>(payload[i] ^ mask[i % 4])); }
+    return f;
+}
+
+int main()
+{
+    int rtn = 0;
+
+    // The JPEG encoder: markers, dimensions, and smaller files at lower quality
+    {
+        const int w = 37;
+        const int h = 21;
+        std::vector<std::uint8_t> img (w * h * 4);
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                std::uint8_t* p = img.data() + (y * w + x) * 4;
+                p[0] = static_cast<std::uint8_t>(x * 7);
+                p[1] = static_cast<std::uint8_t>(y * 12);
+                p[2] = static_cast<std::uint8_t>((x * y) & 0xff);
+                p[3] = 255;
+            }
+        }
+        const std::vector<std::uint8_t> hi = mplot::jpeg::encode (img.data(), w, h, 95);
+        const std::vector<std::uint8_t> lo = mplot::jpeg::encode (img.data(), w, h, 10);
+        if (hi.size() < 4u || hi[0] != 0xff || hi[1] != 0xd8 || hi[hi.size() - 2] != 0xff || hi[hi.size() - 1] != 0xd9) {
+            std::cout << "the JPEG does not start with SOI and end with EOI\n";
+            rtn -= 1;
+        }
+        // The frame header holds the height and width
+        bool found_sof = false;
+        for (std::size_t i = 0; i + 9u < hi.size(); ++i) {
+            if (hi[i] == 0xff && hi[i + 1] == 0xc0) {
+                found_sof = ((hi[i + 5] << 8) | hi[i + 6]) == h && ((hi[i + 7] << 8) | hi[i + 8]) == w;
+                break;
+            }
+        }
+        if (!found_sof) { std::cout << "the JPEG's frame header is wrong\n"; rtn -= 1; }
+        if (!(lo.size() < hi.size())) { std::cout << "quality 10 is not smaller than quality 95\n"; rtn -= 1; }
+        if (!mplot::jpeg::encode (nullptr, w, h).empty()) { std::cout << "encoding nothing should give nothing\n"; rtn -= 1; }
+    }
+
+    // The WebSocket handshake (the example of RFC 6455) and framing
+    {
+        if (mplot::stream_detail::websocket_accept ("dGhlIHNhbXBsZSBub25jZQ==") != "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") {
+            std::cout << "wrong Sec-WebSocket-Accept\n";
+            rtn -= 1;
+        }
+        std::string buf = client_frame ("c 10 20");
+        const std::string whole = buf;
+        std::string payload;
+        std::string part = whole.substr (0, 5);
+        if (mplot::stream_detail::websocket_take_frame (part, payload) != -1) { std::cout << "a part frame was taken\n"; rtn -= 1; }
+        buf += client_frame ("s 0 1");
+        if (mplot::stream_detail::websocket_take_frame (buf, payload) != 1 || payload != "c 10 20"
+            || mplot::stream_detail::websocket_take_frame (buf, payload) != 1 || payload != "s 0 1" || !buf.empty()) {
+            std::cout << "the frames were not taken in order\n";
+            rtn -= 1;
+        }
+        std::string unmasked = mplot::stream_detail::websocket_frame (1, "k");
+        if (mplot::stream_detail::websocket_take_frame (unmasked, payload) != -2) { std::cout << "an unmasked frame was taken\n"; rtn -= 1; }
+
+        // A ping of more than 125 bytes is not valid
+        std::string long_ping = client_frame (std::string (120, 'p'));
+        long_ping[0] = static_cast<char>(0x89);
+        std::string ping = long_ping;
+        if (mplot::stream_detail::websocket_take_frame (ping, payload) != 0x9) { std::cout << "a ping was not taken\n"; rtn -= 1; }
+        long_ping = client_frame (std::string (126, 'p'));
+        long_ping[0] = static_cast<char>(0x89);
+        if (mplot::stream_detail::websocket_take_frame (long_ping, payload) != -2) { std::cout << "a 126 byte ping was taken\n"; rtn -= 1; }
+
+        // Frames of 64 KiB and more have a 64 bit length
+        const std::string big = mplot::stream_detail::websocket_frame (2, std::string (70000, 'b'));
+        std::uint64_t big_len = 0;
+        for (std::size_t k = 2; k < 10u && big.size() >= 10u; ++k) { big_len = (big_len << 8) | static_cast<std::uint8_t>(big[k]); }
+        if (big.size() != 70010u || static_cast<std::uint8_t>(big[1]) != 127u || big_len != 70000u) {
+            std::cout << "a 70000 byte frame is not framed with a 64 bit length\n";
+            rtn -= 1;
+        }
+        const std::string mid = mplot::stream_detail::websocket_frame (2, std::string (300, 'm'));
+        if (mid.size() != 304u || static_cast<std::uint8_t>(mid[1]) != 126u || static_cast<std::uint8_t>(mid[2]) != 1u
+            || static_cast<std::uint8_t>(mid[3]) != 44u) {
+            std::cout << "a 300 byte frame is not framed with a 16 bit length\n";
+            rtn -= 1;
+        }
+
+        // Requests must name the server by the address and port it listens on
+        const std::vector<std::string> allowed = { "gpunode.example.org:8080" };
+        if (!mplot::stream_detail::host_allowed ("127.0.0.1:8080", "127.0.0.1", 8080)
+            || !mplot::stream_detail::host_allowed ("LocalHost:8080", "127.0.0.1", 8080)
+            || !mplot::stream_detail::host_allowed ("10.0.0.7:8080", "0.0.0.0", 8080)
+            || !mplot::stream_detail::host_allowed ("127.0.0.1", "127.0.0.1", 80)
+            || !mplot::stream_detail::host_allowed ("gpunode.example.org:8080", "0.0.0.0", 8080, allowed)
+            || mplot::stream_detail::host_allowed ("", "127.0.0.1", 8080)
+            || mplot::stream_detail::host_allowed ("127.0.0.1:8081", "127.0.0.1", 8080)
+            || mplot::stream_detail::host_allowed ("127.0.0.1:x", "127.0.0.1", 8080)
+            || mplot::stream_detail::host_allowed ("evil.example:8080", "127.0.0.1", 8080)
+            || mplot::stream_detail::host_allowed ("evil.example:8080", "0.0.0.0", 8080, allowed)
+            || mplot::stream_detail::host_allowed ("localhost:8080", "10.0.0.7", 8080)) {
+            std::cout << "the Host check is wrong\n";
+            rtn -= 1;
+        }
+
+        // The Origin of a page that opens /input must be the server's own
+        if (mplot::stream_detail::same_origin ("", "localhost:8080")
+            || !mplot::stream_detail::same_origin ("http://LocalHost:8080", "localhost:8080")
+            || mplot::stream_detail::same_origin ("http://evil.example", "localhost:8080")
+            || mplot::stream_detail::same_origin ("http://localhost:8081", "localhost:8080")
+            || mplot::stream_detail::same_origin ("null", "localhost:8080")) {
+            std::cout << "the Origin check is wrong\n";
+            rtn -= 1;
+        }
+
+        mplot::stream_input_event ev;
+        if (!ev.parse ("k 65 0 1 2") || ev.type != mplot::stream_input_event::kind::key || ev.i[0] != 65 || ev.i[3] != 2
+            || !ev.parse ("c 1.5 2") || ev.type != mplot::stream_input_event::kind::cursor_position || ev.d[0] != 1.5
+            || ev.parse ("x 1") || ev.parse ("b 0")) {
+            std::cout << "input events were not parsed\n";
+            rtn -= 1;
+        }
+    }
+
+    // The rate control: frames offered at 100 Hz, limited to 10 Hz, or by the bytes per second
+    {
+        mplot::stream_rate_control rc;
+        rc.max_fps = 10.0;
+        rc.max_bytes_per_second = 1e9;
+        int admitted = 0;
+        for (int i = 0; i < 100; ++i) {
+            if (rc.admit (i * 0.01)) { ++admitted; rc.sent (1000, 1, 0); }
+        }
+        if (admitted != 10) { std::cout << admitted << " frames admitted in 1 s at 10 fps\n"; rtn -= 1; }
+
+        mplot::stream_rate_control bw;
+        bw.max_fps = 100.0;
+        bw.max_bytes_per_second = 50000.0;
+        bw.quality = 80;
+        std::size_t bytes = 0;
+        for (int i = 0; i < 1000; ++i) { // 10 s
+            if (bw.admit (i * 0.01, 2)) { bw.sent (5000, 2, 0); bytes += 10000; }
+        }
+        // At most 10 s of budget plus the half second that the bucket starts with
+        if (bytes > 525000u || bytes < 400000u) { std::cout << bytes << " bytes sent in 10 s with a budget of 50000/s\n"; rtn -= 1; }
+        if (bw.quality != bw.min_quality) { std::cout << "quality " << bw.quality << " should have fallen to the minimum\n"; rtn -= 1; }
+
+        mplot::stream_rate_control up;
+        up.max_fps = 10.0;
+        up.max_bytes_per_second = 1e6;
+        up.quality = 50;
+        up.sent (1000, 1, 1); // a client fell behind
+        if (up.quality != 45) { std::cout << "quality should fall when a client is behind\n"; rtn -= 1; }
+        for (int i = 0; i < 100; ++i) { up.sent (1000, 1, 0); }
+        if (up.quality != up.max_quality) { std::cout << "quality should rise with bandwidth to spare\n"; rtn -= 1; }
+    }
+
+    // A streamer on loopback: the page, the MJPEG stream, a still frame and the input socket
+    try {
+        mplot::streaming_options so;
+        so.port = 0;
+        so.max_fps = 0.0; // unlimited, so that the test frames are all admitted
+        so.forward_input = true;
+        std::atomic<int> woken = 0;
+        mplot::frame_streamer fs (so, [&woken]() { ++woken; });
+        const unsigned short port = fs.port();
+        if (port == 0) { std::cout << "no port\n"; rtn -= 1; }
+
+        std::vector<unsigned char> buf;
+        if (fs.acquire (buf, 16)) { std::cout << "a frame was admitted with no clients\n"; rtn -= 1; }
+
+        // The Host header that a browser sends, and the Origin of the page served at /
+        const std::string host = "127.0.0.1:" + std::to_string (port);
+        const std::string host_hdr = "Host: " + host + "\r\n";
+        const std::string origin_hdr = "Origin: http://" + host + "\r\n";
+        const std::string upgrade_hdrs = "Upgrade: websocket\r\nConnection: Upgrade\r\n"
+                                         "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+
+        std::string got;
+        int fd = connect_and_send (port, "GET / HTTP/1.1\r\n" + host_hdr + "\r\n");
+        if (!read_until (fd, got, "</html>") || got.find ("200 OK") == std::string::npos || got.find ("/stream") == std::string::npos) {
+            std::cout << "the page was not served\n";
+            rtn -= 1;
+        }
+        ::close (fd);
+
+        got.clear();
+        fd = connect_and_send (port, "GET /nothing HTTP/1.1\r\n" + host_hdr + "\r\n");
+        if (!read_until (fd, got, "404")) { std::cout << "no 404\n"; rtn -= 1; }
+        ::close (fd);
+
+        // A request by another name (as from a page of a DNS rebinding), or by none, is refused
+        for (const std::string& req : { "GET / HTTP/1.1\r\nHost: evil.example:" + std::to_string (port) + "\r\n\r\n",
+                                       std::string ("GET /stream HTTP/1.1\r\n\r\n") }) {
+            got.clear();
+            fd = connect_and_send (port, req);
+            if (!read_until (fd, got, "403") || got.find ("</html>") != std::string::npos) {
+                std::cout << "a request with the wrong Host was not refused\n";
+                rtn -= 1;
+            }
+            ::close (fd);
+        }
+
+        const int sfd = connect_and_send (port, "GET /stream HTTP/1.1\r\n" + host_hdr + "\r\n");
+        std::string stream;
+        if (!read_until (sfd, stream, "boundary=mplotframe\r\n")) { std::cout << "no stream header\n"; rtn -= 1; }
+        for (int i = 0; i < 100 && fs.get_stats().stream_clients != 1u; ++i) {
+            std::this_thread::sleep_for (std::chrono::milliseconds (10));
+        }
+        const sm::vec<int, 2> dims = { 20, 10 };
+        if (!fs.acquire (buf, 20 * 10 * 4)) {
+            std::cout << "a frame was not admitted for a stream client\n";
+            rtn -= 1;
+        } else {
+            std::memset (buf.data(), 200, buf.size());
+            fs.push (std::move (buf), dims);
+        }
+        stream.clear();
+        if (!read_until (sfd, stream, "\xff\xd9\r\n") || stream.find ("--mplotframe\r\nContent-Type: image/jpeg") == std::string::npos
+            || stream.find ("\xff\xd8") == std::string::npos) {
+            std::cout << "no JPEG part in the stream\n";
+            rtn -= 1;
+        }
+
+        // /frame.jpg gives the latest frame
+        got.clear();
+        fd = connect_and_send (port, "GET /frame.jpg HTTP/1.1\r\n" + host_hdr + "\r\n");
+        if (!read_until (fd, got, "\xff\xd9") || got.find ("image/jpeg") == std::string::npos) { std::cout << "no still frame\n"; rtn -= 1; }
+        ::close (fd);
+
+        // An input socket opened by another site's page is refused
+        got.clear();
+        fd = connect_and_send (port, "GET /input HTTP/1.1\r\n" + host_hdr + "Origin: http://evil.example\r\n" + upgrade_hdrs);
+        if (!read_until (fd, got, "403")) { std::cout << "a cross-origin input socket was not refused\n"; rtn -= 1; }
+        ::close (fd);
+
+        // And so is one with no Origin
+        got.clear();
+        fd = connect_and_send (port, "GET /input HTTP/1.1\r\n" + host_hdr + upgrade_hdrs);
+        if (!read_until (fd, got, "403")) { std::cout << "an input socket with no Origin was not refused\n"; rtn -= 1; }
+        ::close (fd);
+
+        // The input socket, from the server's own page
+        const int wfd = connect_and_send (port, "GET /input HTTP/1.1\r\n" + host_hdr + origin_hdr + upgrade_hdrs);
+        got.clear();
+        if (!read_until (wfd, got, "\r\n\r\n") || got.find ("101") == std::string::npos
+            || got.find ("s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") == std::string::npos) {
+            std::cout << "the WebSocket handshake failed\n";
+            rtn -= 1;
+        }
+        const int woken_before = woken;
+        const std::string evs = client_frame ("k 65 0 1 2") + client_frame ("b 1 1 0") + client_frame ("nonsense");
+        ::send (wfd, evs.data(), evs.size(), MSG_NOSIGNAL);
+        std::vector<mplot::stream_input_event> events;
+        std::vector<mplot::stream_input_event> all;
+        for (int i = 0; i < 200 && all.size() < 2u; ++i) {
+            fs.take_input (events);
+            all.insert (all.end(), events.begin(), events.end());
+            std::this_thread::sleep_for (std::chrono::milliseconds (10));
+        }
+        if (all.size() != 2u || all[0].type != mplot::stream_input_event::kind::key || all[0].i[0] != 65
+            || all[1].type != mplot::stream_input_event::kind::mouse_button || all[1].i[0] != 1) {
+            std::cout << "the input events did not arrive\n";
+            rtn -= 1;
+        }
+        if (woken == woken_before) { std::cout << "on_input was not called\n"; rtn -= 1; }
+
+        ::close (wfd);
+        ::close (sfd);
+        const mplot::streaming_stats ss = fs.finish();
+        if (ss.encoded != 1u || ss.sent != 1u || ss.input_events != 2u) {
+            std::cout << "stats: encoded " << ss.encoded << " sent " << ss.sent << " input " << ss.input_events << "\n";
+            rtn -= 1;
+        }
+    } catch (const std::exception& e) {
+        std::cout << "Exception: " << e.what() << "\n";
+        rtn -= 1;
+    }
+
+    return rtn;
+}
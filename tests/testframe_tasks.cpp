@@ -0,0 +1,213 @@
+// Test mplot::frame_scheduler, which resumes simulation coroutines at frame ticks, after idle
+// times and once data have been consumed, without a Visual (the loop of runTasks() is mimicked)
+#include <iostream>
+#include <stdexcept>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string>
+#include <mplot/frame_tasks.h>
+#include <mplot/data_slot.h>
+
+using sc = std::chrono::steady_clock;
+
+mplot::frame_task count_frames (mplot::frame_scheduler& s, int& count, const int n)
+{
+    for (int i = 0; i < n; ++i) {
+        ++count;
+        co_await s.next_frame();
+    }
+}
+
+mplot::frame_task idler (mplot::frame_scheduler& s, double& elapsed_ms)
+{
+    const sc::time_point t0 = sc::now();
+    co_await s.idle_for (30.0);
+    elapsed_ms = std::chrono::duration<double, std::milli>(sc::now() - t0).count();
+}
+
+mplot::frame_task producer (mplot::frame_scheduler& s, mplot::data_slot<float>& slot, std::vector<std::string>& log)
+{
+    for (int i = 0; i < 3; ++i) {
+        slot.write().scalars.assign (4, static_cast<float>(i));
+        slot.publish();
+        log.push_back ("publish");
+        co_await s.data_consumed (slot);
+        log.push_back ("consumed");
+    }
+}
+
+struct guard
+{
+    bool& destroyed;
+    ~guard() { this->destroyed = true; }
+};
+
+mplot::frame_task forever (mplot::frame_scheduler& s, bool& destroyed)
+{
+    guard g{ destroyed };
+    while (true) { co_await s.next_frame(); }
+}
+
+mplot::frame_task thrower (mplot::frame_scheduler& s)
+{
+    co_await s.next_frame();
+    throw std::runtime_error ("from the task");
+}
+
+// Awaits a scheduler other than the one that runs it
+mplot::frame_task stray (mplot::frame_scheduler& other)
+{
+    co_await other.next_frame();
+}
+
+mplot::frame_task spawner (mplot::frame_scheduler& s, int& count)
+{
+    s.spawn (count_frames (s, count, 2));
+    co_return;
+}
+
+// One pass of the event loop, as in VisualMX::runTasks(), with a render that takes the slot's data
+void pass (mplot::frame_scheduler& s, mplot::data_slot<float>* slot, int& renders)
+{
+    s.resume_woken();
+    if (s.frame_due()) {
+        if (slot != nullptr) { slot->take(); }
+        ++renders;
+        s.frame_done (true);
+    }
+}
+
+int main()
+{
+    int rtn = 0;
+    int renders = 0;
+
+    // Each of two tasks steps once per frame tick, and they share the ticks
+    {
+        mplot::frame_scheduler s;
+        s.fps = 0.0; // tick on every pass
+        int a = 0, b = 0;
+        s.spawn (count_frames (s, a, 5));
+        s.spawn (count_frames (s, b, 3));
+        if (s.size() != 2u || a != 0) { std::cout << "Tasks should not run before the first pass\n"; --rtn; }
+        int passes = 0;
+        while (!s.empty() && passes < 100) { pass (s, nullptr, renders); ++passes; }
+        if (a != 5 || b != 3) { std::cout << "Task counts " << a << ", " << b << "\n"; --rtn; }
+        if (s.frames() != 5u) { std::cout << "Expected 5 frame ticks, got " << s.frames() << "\n"; --rtn; }
+    }
+
+    // At 50 fps, next_frame resumes one step per 20 ms tick, and the loop would wait between
+    {
+        mplot::frame_scheduler s;
+        s.fps = 50.0;
+        int a = 0;
+        s.spawn (count_frames (s, a, 4));
+        const sc::time_point t0 = sc::now();
+        while (!s.empty()) {
+            pass (s, nullptr, renders);
+            const double w = s.wait_s();
+            if (w > 0.021) { std::cout << "Waited too long: " << w << " s\n"; --rtn; break; }
+            if (w > 0.0) { std::this_thread::sleep_for (std::chrono::duration<double>(w)); }
+        }
+        const double ms = std::chrono::duration<double, std::milli>(sc::now() - t0).count();
+        if (ms < 55.0) { std::cout << "Four steps at 50 fps took only " << ms << " ms\n"; --rtn; }
+    }
+
+    // idle_for resumes after its time, and wait_s says how long the loop may sleep
+    {
+        mplot::frame_scheduler s;
+        double elapsed = -1.0;
+        s.spawn (idler (s, elapsed));
+        pass (s, nullptr, renders);
+        const double w = s.wait_s();
+        if (w <= 0.0 || w > 0.031) { std::cout << "wait_s for an idle task: " << w << "\n"; --rtn; }
+        while (!s.empty()) {
+            const double wi = s.wait_s();
+            if (wi > 0.0) { std::this_thread::sleep_for (std::chrono::duration<double>(wi)); }
+            s.resume_woken();
+        }
+        if (elapsed < 30.0) { std::cout << "idle_for (30) resumed after " << elapsed << " ms\n"; --rtn; }
+        if (s.wait_s() != -1.0) { std::cout << "An empty scheduler should not need waking\n"; --rtn; }
+    }
+
+    // data_consumed waits until the render has taken the slot's frame
+    {
+        mplot::frame_scheduler s;
+        s.fps = 0.0;
+        mplot::data_slot<float> slot;
+        std::vector<std::string> log;
+        s.spawn (producer (s, slot, log));
+        s.resume_woken();
+        s.resume_woken(); // no render, so nothing is consumed
+        if (log.size() != 1u) { std::cout << "Resumed before the data were consumed\n"; --rtn; }
+        int passes = 0;
+        while (!s.empty() && passes < 100) { pass (s, &slot, renders); ++passes; }
+        const std::vector<std::string> expected = { "publish", "consumed", "publish", "consumed", "publish", "consumed" };
+        if (log != expected) { std::cout << "Unexpected order of publish/consume\n"; --rtn; }
+        if (slot.latest().scalars.size() != 4u || slot.latest().scalars[0] != 2.0f) { std::cout << "Wrong data taken\n"; --rtn; }
+    }
+
+    // A task may spawn another, which first runs on the next pass
+    {
+        mplot::frame_scheduler s;
+        s.fps = 0.0;
+        int c = 0;
+        s.spawn (spawner (s, c));
+        s.resume_woken();
+        if (s.size() != 1u || c != 0) { std::cout << "Spawned task count " << s.size() << ", " << c << "\n"; --rtn; }
+        int passes = 0;
+        while (!s.empty() && passes < 100) { pass (s, nullptr, renders); ++passes; }
+        if (c != 2) { std::cout << "The spawned task did not run\n"; --rtn; }
+    }
+
+    // An exception from a task comes out of the scheduler, and the task is removed
+    {
+        mplot::frame_scheduler s;
+        s.fps = 0.0;
+        s.spawn (thrower (s));
+        bool caught = false;
+        try {
+            for (int i = 0; i < 5; ++i) { pass (s, nullptr, renders); }
+        } catch (const std::runtime_error& e) {
+            caught = std::string (e.what()) == "from the task";
+        }
+        if (!caught || !s.empty()) { std::cout << "Exception not propagated\n"; --rtn; }
+    }
+
+    // A task that co_awaits another scheduler is refused, leaving that scheduler's tasks alone
+    {
+        int c = 0;
+        mplot::frame_scheduler s;
+        mplot::frame_scheduler other;
+        s.fps = 0.0;
+        other.fps = 0.0;
+        other.spawn (count_frames (other, c, 3));
+        other.resume_woken();
+        s.spawn (stray (other));
+        bool caught = false;
+        try {
+            s.resume_woken();
+        } catch (const std::runtime_error&) {
+            caught = true;
+        }
+        if (!caught || !s.empty()) { std::cout << "Awaiting another scheduler not refused\n"; --rtn; }
+        int passes = 0;
+        while (!other.empty() && passes < 100) { pass (other, nullptr, renders); ++passes; }
+        if (c != 3) { std::cout << "The other scheduler's task was disturbed: " << c << "\n"; --rtn; }
+    }
+
+    // A suspended task is destroyed, running its destructors, by clear() (or with its scheduler)
+    {
+        bool destroyed = false;
+        mplot::frame_scheduler s;
+        s.fps = 0.0;
+        s.spawn (forever (s, destroyed));
+        for (int i = 0; i < 3; ++i) { pass (s, nullptr, renders); }
+        if (destroyed) { --rtn; }
+        s.clear();
+        if (!destroyed || !s.empty()) { std::cout << "Suspended task not destroyed\n"; --rtn; }
+    }
+
+    return rtn;
+}
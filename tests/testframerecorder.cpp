@@ -0,0 +1,84 @@
+// Test that mplot::frame_recorder writes out each queued frame, in order, to a raw stream
+#include <iostream>
+#include <vector>
+#include <cstdio>
+#include <sm/vec>
+#include "mplot/frame_recorder.h"
+
+int main()
+{
+    int rtn = 0;
+
+    std::FILE* raw = std::tmpfile();
+    if (raw == nullptr) { std::cout << "No tmpfile\n"; return -1; }
+
+    constexpr int n_frames = 5;
+    constexpr sm::vec<int, 2> dims = { 4, 3 };
+    constexpr std::size_t frame_bytes = 4u * 4u * 3u;
+
+    mplot::recording_options ro;
+    ro.raw_stream = raw;
+    ro.queue_capacity = n_frames;
+    mplot::frame_recorder rec (ro);
+    for (int i = 0; i < n_frames; ++i) {
+        std::vector<unsigned char> buf;
+        if (!rec.acquire (buf, frame_bytes)) { --rtn; continue; }
+        if (buf.size() != frame_bytes) { --rtn; }
+        for (auto& b : buf) { b = static_cast<unsigned char>(i); }
+        rec.push (std::move (buf), dims);
+    }
+    mplot::recording_stats rs = rec.finish();
+    if (rs.captured != n_frames || rs.written != n_frames || rs.dropped != 0u || rs.failed != 0u || rs.queued != 0u) {
+        std::cout << "Unexpected stats: captured " << rs.captured << " written " << rs.written
+                  << " dropped " << rs.dropped << " failed " << rs.failed << "\n";
+        --rtn;
+    }
+    if (rs.queue_high_water < 1u || rs.queue_high_water > static_cast<std::size_t>(n_frames)) { --rtn; }
+
+    // The frames were written one after the other, in the order they were pushed
+    std::rewind (raw);
+    std::vector<unsigned char> all (n_frames * frame_bytes);
+    if (std::fread (all.data(), 1, all.size(), raw) != all.size()) { --rtn; }
+    for (std::size_t i = 0; i < all.size(); ++i) {
+        if (all[i] != static_cast<unsigned char>(i / frame_bytes)) { --rtn; break; }
+    }
+    std::fclose (raw);
+
+    // A full queue drops frames rather than waiting for the encoder
+    mplot::recording_options ro2;
+    ro2.raw_stream = std::tmpfile();
+    ro2.queue_capacity = 1;
+    {
+        mplot::frame_recorder rec2 (ro2);
+        std::size_t pushed = 0;
+        for (int i = 0; i < 1000; ++i) {
+            std::vector<unsigned char> buf;
+            if (rec2.acquire (buf, 1u << 16)) { rec2.push (std::move (buf), dims); ++pushed; }
+        }
+        mplot::recording_stats rs2 = rec2.finish();
+        if (rs2.captured != pushed || rs2.captured + rs2.dropped != 1000u || rs2.written != pushed) { --rtn; }
+    }
+    std::fclose (ro2.raw_stream);
+
+    // With wait_when_full, a full queue waits for the encoder, so no frame is dropped
+    mplot::recording_options ro3;
+    ro3.raw_stream = std::tmpfile();
+    ro3.queue_capacity = 1;
+    ro3.wait_when_full = true;
+    {
+        mplot::frame_recorder rec3 (ro3);
+        for (int i = 0; i < 200; ++i) {
+            std::vector<unsigned char> buf;
+            if (rec3.acquire (buf, 1u << 16)) { rec3.push (std::move (buf), dims); } else { --rtn; }
+        }
+        mplot::recording_stats rs3 = rec3.finish();
+        if (rs3.captured != 200u || rs3.written != 200u || rs3.dropped != 0u || rs3.queue_high_water > 1u) {
+            std::cout << "wait_when_full: captured " << rs3.captured << " written " << rs3.written << " dropped " << rs3.dropped << "\n";
+            --rtn;
+        }
+    }
+    std::fclose (ro3.raw_stream);
+
+    std::cout << "testframerecorder " << (rtn == 0 ? "passed" : "failed") << std::endl;
+    return rtn;
+}
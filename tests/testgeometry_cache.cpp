@@ -0,0 +1,86 @@
+// Test mplot::geometry_cache, writing a model's triangles to a cache file and mapping them back
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <mplot/geometry_cache.h>
+
+int main()
+{
+    int rtn = 0;
+
+    const std::string dir = (std::filesystem::temp_directory_path() / "testgeometry_cache").string();
+    std::filesystem::remove_all (dir);
+
+    // The key follows every input, and the lengths of strings and vectors
+    mplot::geometry_key k1;
+    k1.add (std::uint32_t{1}).add (0.5f).add (std::string("hexgrid")).add (std::vector<float>{ 1.0f, 2.0f });
+    mplot::geometry_key k2;
+    k2.add (std::uint32_t{1}).add (0.5f).add (std::string("hexgrid")).add (std::vector<float>{ 1.0f, 2.5f });
+    mplot::geometry_key k3;
+    k3.add (std::string("ab")).add (std::string("c"));
+    mplot::geometry_key k4;
+    k4.add (std::string("a")).add (std::string("bc"));
+    if (k1.value() == k2.value() || k3.value() == k4.value()) {
+        std::cout << "keys collide\n";
+        rtn -= 1;
+    }
+    const std::uint64_t key = k1.value();
+
+    // Nothing cached yet
+    if (!mplot::geometry_cache::load (dir, key).empty()) {
+        std::cout << "load of an absent file is not empty\n";
+        rtn -= 1;
+    }
+
+    // Two triangles
+    const std::vector<float> pos = { 0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0 };
+    const std::vector<float> nrm = { 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1 };
+    const std::vector<float> clr = { 1, 0, 0, 0, 1, 0, 0, 0, 1, 1, 1, 1 };
+    const std::vector<std::uint32_t> ind = { 0, 1, 2, 0, 2, 3 };
+    if (!mplot::geometry_cache::store (dir, key, pos, nrm, clr, ind)) {
+        std::cout << "store failed\n";
+        rtn -= 1;
+    }
+    // Inconsistent data are not stored
+    if (mplot::geometry_cache::store (dir, key + 1, pos, nrm, { 1, 0, 0 }, ind)) {
+        std::cout << "stored colours that don't match the positions\n";
+        rtn -= 1;
+    }
+
+    mplot::mapped_mesh mm = mplot::geometry_cache::load (dir, key);
+    if (mm.empty() || mm.n_vertices != 4u || mm.n_indices != 6u) {
+        std::cout << "load gave " << mm.n_vertices << " vertices and " << mm.n_indices << " indices\n";
+        rtn -= 1;
+    } else {
+        for (std::size_t i = 0; i < 12; ++i) {
+            if (mm.positions[i] != pos[i] || mm.normals[i] != nrm[i] || mm.colours[i] != clr[i]) {
+                std::cout << "vertex data differ at " << i << "\n";
+                rtn -= 1;
+                break;
+            }
+        }
+        for (std::size_t i = 0; i < 6; ++i) {
+            if (mm.indices[i] != ind[i]) { std::cout << "indices differ\n"; rtn -= 1; break; }
+        }
+    }
+
+    // Another key does not find this file, and a truncated file is ignored
+    if (!mplot::geometry_cache::load (dir, key ^ 1u).empty()) {
+        std::cout << "another key found the file\n";
+        rtn -= 1;
+    }
+    mm = {};
+    const std::string p = mplot::geometry_cache::path (dir, key);
+    std::filesystem::resize_file (p, std::filesystem::file_size (p) - 4u);
+    if (!mplot::geometry_cache::load (dir, key).empty()) {
+        std::cout << "a truncated file was loaded\n";
+        rtn -= 1;
+    }
+
+    std::filesystem::remove_all (dir);
+
+    return rtn;
+}
@@ -0,0 +1,111 @@
+// Test mplot::glb_animation, writing the frames of a model to one .glb file
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <nlohmann/json.hpp>
+#include <mplot/glb_animation.h>
+
+int main()
+{
+    int rtn = 0;
+
+    const std::string fn = (std::filesystem::temp_directory_path() / "testglb_animation.glb").string();
+    std::filesystem::remove (fn);
+
+    // Two triangles, whose colours (and one position) change over three frames
+    const std::vector<std::uint32_t> ind = { 0, 1, 2, 0, 2, 3 };
+    std::vector<float> pos = { 0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0 };
+    const std::vector<float> nrm = { 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1 };
+    std::vector<float> col (12, 0.0f);
+    {
+        mplot::glb_animation_options o;
+        o.positions = true;
+        mplot::glb_animation anim (fn, o);
+        for (int f = 0; f < 3; ++f) {
+            for (auto& c : col) { c = 0.25f * f; }
+            pos[2] = 0.5f * f;
+            anim.add_frame (0.1f * f, ind, pos, col, nrm, { 1.0f, 2.0f, 3.0f });
+        }
+        // Times must increase
+        bool threw = false;
+        try { anim.add_frame (0.1f, ind, pos, col, nrm); } catch (const std::exception&) { threw = true; }
+        if (!threw || anim.frames() != 3) {
+            std::cout << "add_frame accepted a frame out of order\n";
+            rtn -= 1;
+        }
+        // The destructor finishes the file
+    }
+    if (std::filesystem::exists (fn + ".part")) {
+        std::cout << "spool file was not removed\n";
+        rtn -= 1;
+    }
+
+    std::ifstream f (fn, std::ios::binary);
+    std::vector<unsigned char> glb ((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    auto get32 = [&glb](std::size_t o) { std::uint32_t u = 0; std::memcpy (&u, glb.data() + o, 4); return u; };
+    if (glb.size() < 28 || get32 (0) != 0x46546c67u || get32 (8) != glb.size()) {
+        std::cout << "bad glb header\n";
+        std::cout << "FAIL" << std::endl;
+        return -1;
+    }
+    const std::uint32_t jlen = get32 (12);
+    const nlohmann::json js = nlohmann::json::parse (std::string (glb.begin() + 20, glb.begin() + 20 + jlen));
+    const std::size_t bin0 = 20 + jlen + 8;
+    const std::uint32_t blen = get32 (20 + jlen);
+    if (bin0 + blen != glb.size() || js["buffers"][0]["byteLength"].get<std::size_t>() != blen) {
+        std::cout << "bin chunk length is wrong\n";
+        rtn -= 1;
+    }
+
+    const auto& targets = js["meshes"][0]["primitives"][0]["targets"];
+    const auto& acc = js["accessors"];
+    const auto& views = js["bufferViews"];
+    if (targets.size() != 3 || acc.size() != 4 + 2 * 3 + 2 || views.size() != acc.size()) {
+        std::cout << "wrong numbers of targets, accessors or views\n";
+        rtn -= 1;
+    }
+    // The views tile the binary chunk
+    std::size_t off = 0;
+    for (const auto& v : views) {
+        if (v["byteOffset"].get<std::size_t>() != off) { rtn -= 1; std::cout << "views do not tile the chunk\n"; break; }
+        off += v["byteLength"].get<std::size_t>();
+    }
+    if (off != blen) { rtn -= 1; std::cout << "views do not fill the chunk\n"; }
+
+    auto floats_of = [&](std::size_t a) {
+        const std::size_t o = bin0 + views[acc[a]["bufferView"].get<std::size_t>()]["byteOffset"].get<std::size_t>();
+        const std::size_t n = acc[a]["count"].get<std::size_t>() * (acc[a]["type"] == "VEC3" ? 3 : 1);
+        std::vector<float> v (n);
+        std::memcpy (v.data(), glb.data() + o, 4 * n);
+        return v;
+    };
+    // Frame 2's colour change is 0.5, and its position change is 1 in z of vertex 0
+    const std::vector<float> dc = floats_of (targets[2]["COLOR_0"].get<std::size_t>());
+    const std::vector<float> dp = floats_of (targets[2]["POSITION"].get<std::size_t>());
+    if (dc[0] != 0.5f || dc[11] != 0.5f || dp[2] != 1.0f || dp[5] != 0.0f
+        || acc[targets[2]["POSITION"].get<std::size_t>()]["max"][2] != 1.0f) {
+        std::cout << "frame 2's morph target is wrong\n";
+        rtn -= 1;
+    }
+    // The animation steps the weights through the targets
+    const auto& smp = js["animations"][0]["samplers"][0];
+    const std::vector<float> t = floats_of (smp["input"].get<std::size_t>());
+    const std::vector<float> w = floats_of (smp["output"].get<std::size_t>());
+    if (smp["interpolation"] != "STEP" || t.size() != 3 || t[1] != 0.1f || w.size() != 9
+        || w[0] != 1.0f || w[4] != 1.0f || w[8] != 1.0f || w[1] != 0.0f || w[3] != 0.0f) {
+        std::cout << "the animation's sampler is wrong\n";
+        rtn -= 1;
+    }
+    if (js["nodes"][0]["translation"][1] != 2.0f) {
+        std::cout << "node translation is wrong\n";
+        rtn -= 1;
+    }
+
+    std::filesystem::remove (fn);
+
+    return rtn;
+}
@@ -0,0 +1,116 @@
+// Test mplot::glb_file, reading meshes from a .glb file laid out as Visual::saveglb writes it
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <mplot/glb_file.h>
+
+// Write a glb file with the JSON json and the binary chunk bin
+void write_glb (const std::string& fn, std::string json, const std::vector<unsigned char>& bin)
+{
+    while (json.size() % 4u != 0u) { json += ' '; }
+    std::ofstream f (fn, std::ios::out | std::ios::trunc | std::ios::binary);
+    auto put32 = [&f](const std::size_t u) {
+        const std::uint32_t u32 = static_cast<std::uint32_t>(u);
+        f.write (reinterpret_cast<const char*>(&u32), sizeof (u32));
+    };
+    put32 (0x46546c67u);
+    put32 (2u);
+    put32 (12u + 8u + json.size() + 8u + bin.size());
+    put32 (json.size());
+    put32 (0x4e4f534au);
+    f.write (json.data(), static_cast<std::streamsize>(json.size()));
+    put32 (bin.size());
+    put32 (0x004e4942u);
+    f.write (reinterpret_cast<const char*>(bin.data()), static_cast<std::streamsize>(bin.size()));
+}
+
+int main()
+{
+    int rtn = 0;
+    const std::string fn = "./testglbfile.glb";
+
+    // One triangle: 3 indices, then 3 vertices of positions, colours and normals
+    const std::vector<std::uint32_t> ind = { 0, 1, 2 };
+    const std::vector<float> posn = { 0, 0, 0,  1, 0, 0,  0, 1, 0 };
+    const std::vector<float> col = { 1, 0, 0,  0, 1, 0,  0, 0, 1 };
+    const std::vector<float> norm = { 0, 0, 1,  0, 0, 1,  0, 0, 1 };
+    std::vector<unsigned char> bin;
+    auto append = [&bin](const void* d, const std::size_t n) {
+        const unsigned char* c = static_cast<const unsigned char*>(d);
+        bin.insert (bin.end(), c, c + n);
+    };
+    append (ind.data(), 12);
+    append (posn.data(), 36);
+    append (col.data(), 36);
+    append (norm.data(), 36);
+
+    auto json = [](const std::string& stride) {
+        return std::string("{ \"scenes\" : [ { \"nodes\" : [ 0 ] } ], ")
+        + "\"nodes\" : [ { \"mesh\" : 0, \"translation\" : [ 1.5, 2, 3 ] } ], "
+        + "\"meshes\" : [ { \"primitives\" : [ { \"attributes\" : { \"POSITION\" : 1, \"COLOR_0\" : 2, \"NORMAL\" : 3 }, \"indices\" : 0 } ] } ], "
+        + "\"buffers\" : [ { \"byteLength\" : 120 } ], "
+        + "\"bufferViews\" : [ { \"buffer\" : 0, \"byteOffset\" : 0, \"byteLength\" : 12 }, "
+        + "{ \"buffer\" : 0, \"byteOffset\" : 12, \"byteLength\" : 36" + stride + " }, "
+        + "{ \"buffer\" : 0, \"byteOffset\" : 48, \"byteLength\" : 36 }, "
+        + "{ \"buffer\" : 0, \"byteOffset\" : 84, \"byteLength\" : 36 } ], "
+        + "\"accessors\" : [ { \"bufferView\" : 0, \"componentType\" : 5125, \"type\" : \"SCALAR\", \"count\" : 3 }, "
+        + "{ \"bufferView\" : 1, \"componentType\" : 5126, \"type\" : \"VEC3\", \"count\" : 3 }, "
+        + "{ \"bufferView\" : 2, \"componentType\" : 5126, \"type\" : \"VEC3\", \"count\" : 3 }, "
+        + "{ \"bufferView\" : 3, \"componentType\" : 5126, \"type\" : \"VEC3\", \"count\" : 3 } ] }";
+    };
+
+    try {
+        write_glb (fn, json (""), bin);
+        mplot::glb_file g (fn);
+        if (g.num_meshes() != 1u) { std::cerr << "Expected 1 mesh\n"; --rtn; }
+        mplot::mapped_mesh m = g.mesh (0);
+        if (m.n_indices != 3u || m.n_vertices != 3u) { std::cerr << "Wrong counts\n"; --rtn; }
+        for (std::size_t i = 0; i < 3u && rtn == 0; ++i) {
+            if (m.indices[i] != ind[i]) { std::cerr << "Wrong index " << i << "\n"; --rtn; }
+        }
+        for (std::size_t i = 0; i < 9u && rtn == 0; ++i) {
+            if (m.positions[i] != posn[i] || m.colours[i] != col[i] || m.normals[i] != norm[i]) {
+                std::cerr << "Wrong vertex data at " << i << "\n";
+                --rtn;
+            }
+        }
+        if (m.translation[0] != 1.5f || m.translation[1] != 2.0f || m.translation[2] != 3.0f) {
+            std::cerr << "Wrong translation\n";
+            --rtn;
+        }
+        // The mapping outlives the glb_file
+    } catch (const std::exception& e) {
+        std::cerr << "Unexpected exception: " << e.what() << std::endl;
+        --rtn;
+    }
+
+    // An interleaved view can't be mapped into a VisualModel buffer
+    try {
+        write_glb (fn, json (", \"byteStride\" : 36"), bin);
+        mplot::glb_file g (fn);
+        mplot::mapped_mesh m = g.mesh (0);
+        std::cerr << "Expected an exception for an interleaved view\n";
+        --rtn;
+    } catch (const std::exception& e) {
+        std::cout << "Expected error: " << e.what() << std::endl;
+    }
+
+    // Too few bytes in the binary chunk
+    try {
+        bin.resize (100);
+        write_glb (fn, json (""), bin);
+        mplot::glb_file g (fn);
+        mplot::mapped_mesh m = g.mesh (0);
+        std::cerr << "Expected an exception for a truncated binary chunk\n";
+        --rtn;
+    } catch (const std::exception& e) {
+        std::cout << "Expected error: " << e.what() << std::endl;
+    }
+
+    std::remove (fn.c_str());
+    std::cout << "return rtn = " << rtn << std::endl;
+    return rtn;
+}
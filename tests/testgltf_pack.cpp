@@ -0,0 +1,142 @@
+// Test mplot::gltf_pack, quantizing and reordering a mesh for a glb export
+#include <iostream>
+#include <vector>
+#include <array>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <mplot/gltf_pack.h>
+
+int main()
+{
+    int rtn = 0;
+
+    // A grid of n by n vertices, with a wavy surface and colours
+    constexpr std::uint32_t n = 64;
+    std::vector<float> pos;
+    std::vector<float> col;
+    std::vector<float> nrm;
+    for (std::uint32_t j = 0; j < n; ++j) {
+        for (std::uint32_t i = 0; i < n; ++i) {
+            pos.insert (pos.end(), { 0.1f * i - 2.0f, 0.05f * j + 1.0f, 0.2f * std::sin (0.3f * i) });
+            col.insert (col.end(), { i / float(n - 1), j / float(n - 1), 0.5f });
+            nrm.insert (nrm.end(), { 0.0f, 0.6f, 0.8f });
+        }
+    }
+    std::vector<std::uint32_t> ind;
+    for (std::uint32_t j = 0; j + 1 < n; ++j) {
+        for (std::uint32_t i = 0; i + 1 < n; ++i) {
+            const std::uint32_t v = j * n + i;
+            ind.insert (ind.end(), { v, v + 1, v + n, v + 1, v + n + 1, v + n });
+        }
+    }
+    // Shuffle the triangles, as a mesh from an unordered source would be
+    std::vector<std::uint32_t> tris (ind.size() / 3);
+    for (std::uint32_t t = 0; t < tris.size(); ++t) { tris[t] = t; }
+    std::mt19937 rng (1);
+    std::shuffle (tris.begin(), tris.end(), rng);
+    std::vector<std::uint32_t> shuffled;
+    for (auto t : tris) { shuffled.insert (shuffled.end(), { ind[3 * t], ind[3 * t + 1], ind[3 * t + 2] }); }
+
+    // Reordering for the vertex cache keeps every triangle and lowers the ACMR
+    std::vector<std::uint32_t> opt = shuffled;
+    mplot::gltf_optimize_vertex_cache (opt, n * n);
+    auto sorted_tris = [](const std::vector<std::uint32_t>& v) {
+        std::vector<std::array<std::uint32_t, 3>> t;
+        for (std::size_t i = 0; i < v.size(); i += 3) {
+            std::array<std::uint32_t, 3> a = { v[i], v[i + 1], v[i + 2] };
+            // Rotate (keeping the winding) so that the smallest index is first
+            std::rotate (a.begin(), std::min_element (a.begin(), a.end()), a.end());
+            t.push_back (a);
+        }
+        std::sort (t.begin(), t.end());
+        return t;
+    };
+    if (sorted_tris (opt) != sorted_tris (shuffled)) {
+        std::cout << "vertex cache reordering changed the triangles\n";
+        rtn -= 1;
+    }
+    const double acmr_before = mplot::gltf_acmr (shuffled, n * n);
+    const double acmr_after = mplot::gltf_acmr (opt, n * n);
+    std::cout << "ACMR " << acmr_before << " -> " << acmr_after << std::endl;
+    if (!(acmr_after < 0.5 * acmr_before) || acmr_after > 1.0) {
+        std::cout << "vertex cache reordering did not lower the ACMR enough\n";
+        rtn -= 1;
+    }
+
+    // Vertex fetch reordering numbers the vertices in the order of first use and drops unused ones
+    std::vector<std::uint32_t> f = { 5, 2, 7, 2, 7, 9 };
+    std::vector<std::uint32_t> order = mplot::gltf_optimize_vertex_fetch (f, 10);
+    if (order != std::vector<std::uint32_t>{ 5, 2, 7, 9 } || f != std::vector<std::uint32_t>{ 0, 1, 2, 1, 2, 3 }) {
+        std::cout << "vertex fetch reordering is wrong\n";
+        rtn -= 1;
+    }
+
+    // Quantized and reordered
+    mplot::gltf_options opts;
+    opts.quantize = true;
+    opts.reorder = true;
+    mplot::gltf_packed_mesh pm = mplot::gltf_pack (pos, col, nrm, shuffled, opts);
+    if (pm.n_vertices != n * n || pm.n_indices != shuffled.size() || pm.index_type != mplot::gltf_component::unsigned_short
+        || pm.index_bytes() % 4 != 0 || pm.position.data.size() != 8u * n * n || pm.normal.data.size() != 4u * n * n
+        || pm.colour.data.size() != 4u * n * n) {
+        std::cout << "quantized sizes are wrong\n";
+        rtn -= 1;
+    }
+    const std::size_t float_bytes = 4 * shuffled.size() + 36 * pos.size() / 3;
+    std::cout << "bytes " << float_bytes << " -> " << pm.bytes() << std::endl;
+    if (pm.bytes() * 2 > float_bytes) {
+        std::cout << "the quantized mesh is not less than half the size\n";
+        rtn -= 1;
+    }
+    // Decode each triangle's vertices and compare them with the originals
+    auto idx = [&pm](std::size_t i) {
+        std::uint16_t u = 0;
+        std::memcpy (&u, pm.indices.data() + 2 * i, 2);
+        return u;
+    };
+    const float tol = pm.scale;
+    float max_err = 0.0f;
+    for (std::size_t i = 0; i < pm.n_indices && rtn == 0; ++i) {
+        const std::uint16_t v = idx (i);
+        std::int16_t q[3];
+        std::memcpy (q, pm.position.data.data() + 8 * v, 6);
+        float p[3];
+        for (int c = 0; c < 3; ++c) {
+            p[c] = pm.offset[c] + pm.scale * q[c];
+            if (q[c] < pm.pos_min[c] || q[c] > pm.pos_max[c]) { rtn -= 1; std::cout << "position outside min/max\n"; }
+        }
+        // The grid position gives the original vertex
+        const std::uint32_t gi = static_cast<std::uint32_t>(std::round ((p[0] + 2.0f) / 0.1f));
+        const std::uint32_t gj = static_cast<std::uint32_t>(std::round ((p[1] - 1.0f) / 0.05f));
+        const std::uint32_t ov = gj * n + gi;
+        for (int c = 0; c < 3; ++c) { max_err = std::max (max_err, std::abs (p[c] - pos[3 * ov + c])); }
+        const std::int8_t* nq = reinterpret_cast<const std::int8_t*>(pm.normal.data.data() + 4 * v);
+        const unsigned char* cq = pm.colour.data.data() + 4 * v;
+        for (int c = 0; c < 3; ++c) {
+            if (std::abs (nq[c] / 127.0f - nrm[3 * ov + c]) > 0.51f / 127.0f
+                || std::abs (cq[c] / 255.0f - col[3 * ov + c]) > 0.51f / 255.0f) {
+                std::cout << "normal or colour quantized wrongly\n";
+                rtn -= 1;
+                break;
+            }
+        }
+    }
+    if (max_err > tol) {
+        std::cout << "position error " << max_err << " exceeds one step " << tol << std::endl;
+        rtn -= 1;
+    }
+
+    // Reordering without quantizing keeps float data
+    opts.quantize = false;
+    pm = mplot::gltf_pack (pos, col, nrm, shuffled, opts);
+    if (pm.quantized || pm.position.component_type != mplot::gltf_component::float_type || pm.position.data.size() != pos.size() * 4
+        || std::abs (pm.pos_min[0] + 2.0f) > 1e-6f || std::abs (pm.pos_max[1] - (1.0f + 0.05f * (n - 1))) > 1e-6f) {
+        std::cout << "float packing is wrong\n";
+        rtn -= 1;
+    }
+
+    return rtn;
+}
@@ -0,0 +1,42 @@
+// Test the feature queries of mplot::gl::version
+
+#include <iostream>
+#include <string>
+#include <mplot/gl/version.h>
+
+namespace v = mplot::gl::version;
+
+// The macOS maximum has none of the faster paths' features
+static_assert (!v::compute (mplot::gl::version_4_1) && !v::buffer_storage (mplot::gl::version_4_1)
+               && !v::multi_draw_indirect (mplot::gl::version_4_1) && !v::debug_output (mplot::gl::version_4_1)
+               && !v::invalidate_framebuffer (mplot::gl::version_4_1));
+static_assert (v::compute (mplot::gl::version_4_3) && v::multi_draw_indirect (mplot::gl::version_4_3_compat)
+               && !v::buffer_storage (mplot::gl::version_4_3) && v::buffer_storage (mplot::gl::version_4_4));
+// ES versions
+static_assert (!v::compute (mplot::gl::version_3_0_es) && v::compute (mplot::gl::version_3_1_es)
+               && !v::multi_draw_indirect (mplot::gl::version_3_2_es) && !v::buffer_storage (mplot::gl::version_3_2_es)
+               && v::invalidate_framebuffer (mplot::gl::version_3_0_es));
+static_assert (!v::debug_output (mplot::gl::version_3_1_es) && v::debug_output (mplot::gl::version_3_2_es));
+static_assert (v::at_least (mplot::gl::version_4_6, 4, 5) && !v::at_least (mplot::gl::version_3_2_es, 3, 0)
+               && v::es_at_least (mplot::gl::version_3_2_es, 3, 1) && !v::es_at_least (mplot::gl::version_4_6, 3, 0));
+
+int main()
+{
+    int rtn = 0;
+
+    // 4.1 lacks all five features, so five lines
+    const std::string f41 = v::features_string (mplot::gl::version_4_1);
+    std::size_t lines = 0;
+    for (char c : f41) { if (c == '\n') { ++lines; } }
+    if (lines != 5u || f41.find ("multi-draw indirect") == std::string::npos) {
+        std::cout << "4.1 features wrong:\n" << f41;
+        rtn -= 1;
+    }
+    const std::string f46 = v::features_string (mplot::gl::version_4_6);
+    if (f46.find ("has all the features") == std::string::npos) {
+        std::cout << "4.6 features wrong:\n" << f46;
+        rtn -= 1;
+    }
+
+    return rtn;
+}
@@ -1,4 +1,6 @@
 #include <iostream>
+#include <string>
+#include <span>
 
 // To test non-format code:
 #ifdef FORCE_NON_FORMAT
@@ -114,6 +116,16 @@ int main()
     std::cout << "gnf ("<<num<<", "<<next<<"): " << str << std::endl;
     if (str != ".0015") { std::cout << "fail\n"; --rtn; }
 
+    // The buffer overload writes the same chars, without allocating
+    char buf[32];
+    std::size_t n = mplot::graphing::number_format (std::span<char>(buf), num, next);
+    std::cout << "gnf to buffer ("<<num<<", "<<next<<"): " << std::string (buf, n) << std::endl;
+    if (std::string (buf, n) != ".0015") { std::cout << "fail\n"; --rtn; }
+
+    // and writes nothing if the buffer is too small
+    n = mplot::graphing::number_format (std::span<char>(buf, 3), num, next);
+    if (n != 0) { std::cout << "fail\n"; --rtn; }
+
     std::cout << (rtn ? "FAIL\n" : "PASS\n");
     return rtn;
 }
@@ -0,0 +1,86 @@
+// Test that GridVisual and CartGridVisual write the same vertices in parallel as in one thread
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <sm/vec>
+#include <sm/grid>
+#include <sm/cartgrid>
+#include "mplot/Visual.h"
+#include "mplot/GridVisual.h"
+#include "mplot/CartGridVisual.h"
+
+// Expose a model's buffers
+template <typename M>
+struct exposed : public M
+{
+    using M::M;
+    using M::vertexPositions;
+    using M::vertexNormals;
+    using M::vertexColors;
+    using M::indices;
+};
+
+template <typename M>
+bool same_buffers (const M& a, const M& b)
+{
+    return !a.vertexPositions.empty() && a.vertexPositions == b.vertexPositions && a.vertexNormals == b.vertexNormals
+    && a.vertexColors == b.vertexColors && a.indices == b.indices;
+}
+
+int main()
+{
+    int rtn = 0;
+
+    sm::vec<float, 2> dx = { 0.01f, 0.01f };
+    sm::vec<float, 2> zero = { 0.0f, 0.0f };
+    sm::grid<unsigned int, float> grid (300, 200, dx, zero);
+    std::vector<float> data (grid.n());
+    for (unsigned int ri = 0; ri < grid.n(); ++ri) {
+        data[ri] = std::sin (20.0f * grid[ri][0]) * std::cos (15.0f * grid[ri][1]);
+    }
+
+    using gvis = exposed<mplot::GridVisual<float>>;
+    for (mplot::GridVisMode mode : { mplot::GridVisMode::RectInterp, mplot::GridVisMode::Columns }) {
+        for (bool interp_sides : { false, true }) {
+            gvis serial (&grid, sm::vec<float>{});
+            gvis parallel (&grid, sm::vec<float>{});
+            for (gvis* g : { &serial, &parallel }) {
+                g->gridVisMode = mode;
+                g->interpolate_colour_sides (interp_sides);
+                if (mode == mplot::GridVisMode::RectInterp) {
+                    g->showselectedpixborder (true);
+                    g->selected_pix[417] = mplot::colour::red;
+                }
+                g->setScalarData (&data);
+            }
+            serial.parallel_build = false;
+            serial.initializeVertices();
+            parallel.initializeVertices();
+            if (!same_buffers (serial, parallel)) {
+                std::cout << "GridVisual buffers differ (mode " << static_cast<int>(mode) << ")\n";
+                --rtn;
+            }
+        }
+    }
+
+    sm::cartgrid cg (0.01, 0.01, 1, 1);
+    cg.setBoundaryOnOuterEdge();
+    std::vector<float> cdata (cg.num());
+    for (unsigned int ri = 0; ri < cg.num(); ++ri) { cdata[ri] = std::sin (20.0f * cg.d_x[ri]) * std::sin (10.0f * cg.d_y[ri]); }
+    using cvis = exposed<mplot::CartGridVisual<float>>;
+    cvis serial (&cg, sm::vec<float>{});
+    cvis parallel (&cg, sm::vec<float>{});
+    for (cvis* c : { &serial, &parallel }) {
+        c->cartVisMode = mplot::CartVisMode::RectInterp;
+        c->setScalarData (&cdata);
+    }
+    serial.parallel_build = false;
+    serial.initializeVertices();
+    parallel.initializeVertices();
+    if (!same_buffers (serial, parallel)) {
+        std::cout << "CartGridVisual buffers differ\n";
+        --rtn;
+    }
+
+    return rtn;
+}
@@ -0,0 +1,66 @@
+// Test the sampling of an image at the centres of a grid's elements in mplot/image_sampling.h
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <sm/vec>
+#include <sm/vvec>
+#include "mplot/image_sampling.h"
+
+int main()
+{
+    int rtn = 0;
+
+    // A 4 by 3 image, in rows from the bottom left, valued 10 * row + column
+    std::vector<float> img (12, 0.0f);
+    for (unsigned int y = 0; y < 3u; ++y) {
+        for (unsigned int x = 0; x < 4u; ++x) { img[y * 4u + x] = 10.0f * y + x; }
+    }
+    mplot::image_placement pl;
+    pl.dims = { 4u, 3u };
+    pl.scale = { 3.0f, 3.0f };
+    pl.offset = { 1.0f, 0.0f };
+
+    // The image is 3 wide and 3 * 3 / 4 high, centred on offset, with a pixel centre at each corner
+    const sm::vec<float, 2> e = pl.extent();
+    const sm::vec<float, 2> sp = pl.spacing();
+    if (std::abs (e[0] - 3.0f) > 1e-6f || std::abs (e[1] - 2.25f) > 1e-6f) { std::cout << "extent " << e << "\n"; --rtn; }
+    if (std::abs (sp[0] - 1.0f) > 1e-6f || std::abs (sp[1] - 1.125f) > 1e-6f) { std::cout << "spacing " << sp << "\n"; --rtn; }
+    const sm::vec<float, 2> q0 = pl.to_pixel ({ -0.5f, -1.125f });
+    const sm::vec<float, 2> q1 = pl.to_pixel ({ 2.5f, 1.125f });
+    if (std::abs (q0[0]) > 1e-6f || std::abs (q0[1]) > 1e-6f || std::abs (q1[0] - 3.0f) > 1e-5f || std::abs (q1[1] - 2.0f) > 1e-5f) {
+        std::cout << "to_pixel " << q0 << " " << q1 << "\n";
+        --rtn;
+    }
+
+    // Bilinear sampling gives the pixels at their centres, and their means between them
+    using is = mplot::image_sampling;
+    if (is::bilinear (img, pl.dims, { 2.0f, 1.0f }) != 12.0f) { std::cout << "bilinear at a centre\n"; --rtn; }
+    if (std::abs (is::bilinear (img, pl.dims, { 1.5f, 0.5f }) - 6.5f) > 1e-5f) { std::cout << "bilinear between\n"; --rtn; }
+    // Beyond the last pixel centre (but on the image), the edge pixels extend outwards
+    if (is::bilinear (img, pl.dims, { 3.4f, 2.4f }) != 23.0f) { std::cout << "bilinear at the edge\n"; --rtn; }
+
+    // The box filter is the mean of the pixels whose centres lie within the footprint
+    if (std::abs (is::box (img, pl.dims, { 1.5f, 0.5f }, { 2.0f, 2.0f }) - 6.5f) > 1e-5f) { std::cout << "box 2x2\n"; --rtn; }
+    if (std::abs (is::box (img, pl.dims, { 1.0f, 1.0f }, { 2.5f, 2.5f }) - 11.0f) > 1e-5f) { std::cout << "box 3x3\n"; --rtn; }
+    // A footprint that holds no pixel centre samples bilinearly
+    if (std::abs (is::box (img, pl.dims, { 1.5f, 0.5f }, { 0.5f, 0.5f }) - 6.5f) > 1e-5f) { std::cout << "box, no centre\n"; --rtn; }
+    // The footprint is clipped by the edges of the image
+    if (std::abs (is::box (img, pl.dims, { 0.0f, 0.0f }, { 2.5f, 2.5f }) - 5.5f) > 1e-5f) { std::cout << "box at a corner\n"; --rtn; }
+
+    // resample places the points on the image, and gives outside to those off it
+    const std::vector<sm::vec<float, 2>> pts = { { 1.5f, 0.0f }, { -0.5f, -1.125f }, { 10.0f, 0.0f }, { 1.0f, -1.7f } };
+    sm::vvec<float> s = is::resample (img, pl, pts, mplot::image_filter::bilinear, { 0.0f, 0.0f }, -1.0f);
+    if (s.size() != 4u || std::abs (s[0] - 12.0f) > 1e-5f || s[1] != 0.0f || s[2] != -1.0f || s[3] != -1.0f) {
+        std::cout << "resample " << s << "\n";
+        --rtn;
+    }
+    // With the box filter and a footprint in the grid's coordinates (one pixel of width and height spacing)
+    s = is::resample (img, pl, pts, mplot::image_filter::box, { 2.0f, 2.25f }, -1.0f);
+    if (std::abs (s[0] - 12.0f) > 1e-5f || std::abs (s[1] - 5.5f) > 1e-5f || s[2] != -1.0f) { std::cout << "resample box " << s << "\n"; --rtn; }
+
+    // An image too small for its dims gives outside everywhere
+    s = is::resample (std::vector<float>(3, 1.0f), pl, pts, mplot::image_filter::bilinear, { 0.0f, 0.0f }, -1.0f);
+    if (s.size() != 4u || s[0] != -1.0f) { std::cout << "short image\n"; --rtn; }
+
+    return rtn;
+}
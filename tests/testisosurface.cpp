@@ -0,0 +1,120 @@
+// Test the extraction of isosurfaces by marching tetrahedra
+#include <iostream>
+#include <vector>
+#include <map>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <sm/vec>
+#include "mplot/isosurface.h"
+
+int main()
+{
+    int rtn = 0;
+    namespace iso = mplot::isosurface;
+
+    // The distance from the centre of a 24 x 20 x 16 grid
+    const std::array<unsigned int, 3> dims = { 24u, 20u, 16u };
+    const sm::vec<float> centre = { 11.5f, 9.5f, 7.5f };
+    std::vector<float> field (std::size_t{dims[0]} * dims[1] * dims[2]);
+    std::size_t i = 0;
+    for (unsigned int z = 0; z < dims[2]; ++z) {
+        for (unsigned int y = 0; y < dims[1]; ++y) {
+            for (unsigned int x = 0; x < dims[0]; ++x) {
+                field[i++] = (sm::vec<float>{ float(x), float(y), float(z) } - centre).length();
+            }
+        }
+    }
+    iso::grid<float> g;
+    g.values = field;
+    g.dims = dims;
+
+    // A sphere of radius 5, from one thread and from four
+    std::vector<float> p1, n1v, p4, n4v;
+    const std::size_t n1 = iso::extract (g, 5.0f, p1, n1v, 1);
+    const std::size_t n4 = iso::extract (g, 5.0f, p4, n4v, 4);
+    if (n1 == 0u || n1 != n4 || p1.size() != 9u * n1 || n1v.size() != 9u * n1
+        || std::memcmp (p1.data(), p4.data(), 9u * n1 * sizeof (float)) != 0
+        || std::memcmp (n1v.data(), n4v.data(), 9u * n1 * sizeof (float)) != 0) {
+        std::cout << "threads gave different meshes (" << n1 << " and " << n4 << " triangles)\n";
+        --rtn;
+    }
+
+    // Every vertex is near the sphere and its normal points into the sphere (down the
+    // gradient, towards the values below the level), and every triangle faces its normals
+    for (std::size_t t = 0; t < n1 && rtn == 0; ++t) {
+        const float* p = p1.data() + 9u * t;
+        const float* n = n1v.data() + 9u * t;
+        for (unsigned int k = 0; k < 3u; ++k) {
+            const sm::vec<float> v = { p[3 * k], p[3 * k + 1], p[3 * k + 2] };
+            const sm::vec<float> nv = { n[3 * k], n[3 * k + 1], n[3 * k + 2] };
+            if (std::abs ((v - centre).length() - 5.0f) > 0.1f || nv.dot (v - centre) >= 0.0f || std::abs (nv.length() - 1.0f) > 1e-4f) {
+                std::cout << "vertex " << v << " (normal " << nv << ") is not on the sphere\n";
+                --rtn;
+                break;
+            }
+        }
+        const sm::vec<float> a = { p[0], p[1], p[2] };
+        const sm::vec<float> b = { p[3], p[4], p[5] };
+        const sm::vec<float> c = { p[6], p[7], p[8] };
+        if ((b - a).cross (c - a).dot (centre - a) < -1e-6f) {
+            std::cout << "triangle " << t << " winds the wrong way\n";
+            --rtn;
+        }
+    }
+
+    // The surface is closed: each edge of a triangle is an edge of one other triangle
+    std::map<std::array<float, 6>, int> edges;
+    for (std::size_t t = 0; t < n1; ++t) {
+        const float* p = p1.data() + 9u * t;
+        for (unsigned int k = 0; k < 3u; ++k) {
+            const float* a = p + 3u * k;
+            const float* b = p + 3u * ((k + 1u) % 3u);
+            std::array<float, 6> e = { a[0], a[1], a[2], b[0], b[1], b[2] };
+            std::array<float, 6> r = { b[0], b[1], b[2], a[0], a[1], a[2] };
+            if (r < e) { std::swap (e, r); }
+            edges[e]++; // degenerate edges (where a vertex is on the level) count too
+        }
+    }
+    std::size_t open = 0;
+    for (const auto& e : edges) {
+        const bool degenerate = e.first[0] == e.first[3] && e.first[1] == e.first[4] && e.first[2] == e.first[5];
+        if (!degenerate && e.second != 2) { ++open; }
+    }
+    if (open != 0u) {
+        std::cout << open << " edges are not shared by two triangles\n";
+        --rtn;
+    }
+
+    // A mesh is reused as an arena: a smaller surface leaves it the size it was
+    const std::size_t n_small = iso::extract (g, 3.0f, p1, n1v, 2);
+    if (n_small == 0u || n_small >= n1 || p1.size() != 9u * n1 || n1v.size() != 9u * n1) {
+        std::cout << "arena reuse failed\n";
+        --rtn;
+    }
+
+    // Spacing and origin place the surface in space
+    g.origin = { 1.0f, 2.0f, 3.0f };
+    g.spacing = { 0.5f, 0.5f, 0.5f };
+    std::vector<float> ps, ns;
+    iso::extract (g, 5.0f, ps, ns);
+    const sm::vec<float> world_centre = g.origin + centre * 0.5f;
+    const sm::vec<float> v0 = { ps[0], ps[1], ps[2] };
+    if (std::abs ((v0 - world_centre).length() - 2.5f) > 0.05f) {
+        std::cout << "spacing and origin failed\n";
+        --rtn;
+    }
+
+    // No surface in a uniform field, and none of a level outside the field
+    std::vector<float> flat (8u * 8u * 8u, 1.0f);
+    iso::grid<float> gf;
+    gf.values = flat;
+    gf.dims = { 8u, 8u, 8u };
+    std::vector<float> pf, nf;
+    if (iso::extract (gf, 1.0f, pf, nf) != 0u || iso::extract (g, 100.0f, pf, nf) != 0u || !pf.empty()) {
+        std::cout << "empty surface failed\n";
+        --rtn;
+    }
+
+    return rtn;
+}
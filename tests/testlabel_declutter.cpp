@@ -0,0 +1,80 @@
+// Test the label declutter: labels off screen are culled and, of overlapping labels, those of
+// higher priority are kept
+
+#include <iostream>
+#include <cstdint>
+#include <vector>
+#include <sm/vec>
+#include <mplot/label_declutter.h>
+
+int main()
+{
+    int rtn = 0;
+
+    const sm::vec<int, 2> dims = { 800, 600 };
+    mplot::label_declutter ld;
+    ld.padding = 0;
+
+    // 0 and 1 overlap, and 1 has the higher priority. 2 overlaps neither. 3 is off screen. 4 is
+    // not known, so it is shown though it overlaps 1. 5 overlaps 0 only, so it is kept once 0 is
+    // suppressed. 6 has the same priority as 2, which comes first, and overlaps it.
+    ld.boxes = {
+        { mplot::screen_rect{ 100, 100, 200, 120 }, 0.0f, true },
+        { mplot::screen_rect{ 150, 110, 250, 130 }, 1.0f, true },
+        { mplot::screen_rect{ 400, 400, 500, 420 }, 0.0f, true },
+        { mplot::screen_rect{}, 5.0f, true },
+        { mplot::screen_rect{}, 0.0f, false },
+        { mplot::screen_rect{ 60, 100, 110, 120 }, 0.0f, true },
+        { mplot::screen_rect{ 490, 410, 560, 430 }, 0.0f, true }
+    };
+    ld.run (dims);
+    const std::vector<std::uint8_t> expect = { 0, 1, 1, 0, 1, 1, 0 };
+    if (ld.shown != expect || ld.n_culled != 1 || ld.n_suppressed != 2 || ld.n_shown() != 4) {
+        std::cout << "declutter chose wrongly:";
+        for (auto s : ld.shown) { std::cout << " " << static_cast<int>(s); }
+        std::cout << " (culled " << ld.n_culled << ", suppressed " << ld.n_suppressed << ")\n";
+        rtn -= 1;
+    }
+
+    // Labels in neighbouring buckets that nearly touch count as overlapping with a padding
+    ld.cell = 64;
+    ld.padding = 2;
+    ld.boxes = {
+        { mplot::screen_rect{ 10, 10, 63, 20 }, 0.0f, true },
+        { mplot::screen_rect{ 64, 10, 100, 20 }, 0.0f, true },
+        { mplot::screen_rect{ 10, 30, 63, 40 }, 0.0f, true },
+        { mplot::screen_rect{ 70, 30, 100, 40 }, 0.0f, true }
+    };
+    ld.run (dims);
+    if (ld.shown != std::vector<std::uint8_t>{ 1, 0, 1, 1 }) {
+        std::cout << "padding across buckets wrong\n";
+        rtn -= 1;
+    }
+
+    // A grid of labels, each overlapping its right hand neighbour: every other one is kept
+    ld.padding = 0;
+    ld.boxes.clear();
+    for (int y = 0; y < 20; ++y) {
+        for (int x = 0; x < 40; ++x) {
+            ld.boxes.push_back ({ mplot::screen_rect{ x * 15, y * 25, x * 15 + 20, y * 25 + 20 }, 0.0f, true });
+        }
+    }
+    ld.run (dims);
+    bool alternate = true;
+    for (std::size_t i = 0; i < ld.boxes.size(); ++i) {
+        if (ld.shown[i] != ((i % 40) % 2 == 0 ? 1 : 0)) { alternate = false; }
+    }
+    if (!alternate || ld.n_shown() != 400) {
+        std::cout << "grid of labels wrong: " << ld.n_shown() << " shown\n";
+        rtn -= 1;
+    }
+
+    // Without a framebuffer size, everything is shown
+    ld.run ({ 0, 0 });
+    if (ld.n_shown() != ld.boxes.size()) {
+        std::cout << "unsized run hid labels\n";
+        rtn -= 1;
+    }
+
+    return rtn;
+}
@@ -1,6 +1,7 @@
 #include <sm/vec>
 #include <sm/vvec>
 #include <mplot/loadpng.h>
+#include <filesystem>
 
 int main()
 {
@@ -19,6 +20,24 @@ int main()
         --rtn;
     }
 
+    // Load the image again by way of the decode cache (twice, to write and then read the cache)
+    mplot::loadpng_cache_dir = "./testloadpng_cache";
+    for (int i = 0; i < 2; ++i) {
+        sm::vvec<float> cached_data;
+        try {
+            mplot::loadpng (fn, cached_data);
+            if (cached_data != image_data) {
+                std::cerr << "Cached load " << i << " differs from uncached load\n";
+                --rtn;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to loadpng via cache\n";
+            --rtn;
+        }
+    }
+    std::filesystem::remove_all (mplot::loadpng_cache_dir);
+    mplot::loadpng_cache_dir = "";
+
     fn = "examples/bad_name.png"; // known bad
     try {
         sm::vec<unsigned int, 2> dims = mplot::loadpng (fn, image_data);
@@ -0,0 +1,53 @@
+// Test the level of detail helpers in mplot/lod.h
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+#include <sm/vec>
+#include "mplot/lod.h"
+
+struct span { std::size_t first = 0; std::size_t count = 0; };
+
+int main()
+{
+    int rtn = 0;
+
+    // Contiguous spans are merged; others are appended
+    std::vector<span> spans;
+    mplot::lod::append_span (spans, 0, 6);
+    mplot::lod::append_span (spans, 6, 3);
+    mplot::lod::append_span (spans, 12, 0);
+    mplot::lod::append_span (spans, 15, 3);
+    if (spans.size() != 2u || spans[0].count != 9u || spans[1].first != 15u || spans[1].count != 3u) {
+        std::cout << "append_span failed\n";
+        --rtn;
+    }
+
+    // nearest agrees with a brute force search
+    std::mt19937 gen (42);
+    std::normal_distribution<float> nd (0.0f, 1.0f);
+    auto random_dirs = [&gen, &nd](std::size_t n) {
+        std::vector<sm::vec<float>> d (n);
+        for (auto& v : d) {
+            v = sm::vec<float>{ nd (gen), nd (gen), nd (gen) };
+            v.renormalize();
+        }
+        return d;
+    };
+    const std::vector<sm::vec<float>> to = random_dirs (500);
+    const std::vector<sm::vec<float>> from = random_dirs (2000);
+    const std::vector<std::uint32_t> near = mplot::lod::nearest (from, to);
+    if (near.size() != from.size()) { --rtn; }
+    for (std::size_t i = 0; i < from.size() && i < near.size(); ++i) {
+        float best_d = (to[0] - from[i]).length_sq();
+        for (std::size_t j = 1; j < to.size(); ++j) { best_d = std::min (best_d, (to[j] - from[i]).length_sq()); }
+        if ((to[near[i]] - from[i]).length_sq() > best_d) {
+            std::cout << "nearest is wrong for vector " << i << "\n";
+            --rtn;
+            break;
+        }
+    }
+
+    return rtn;
+}
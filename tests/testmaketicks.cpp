@@ -1,4 +1,7 @@
 #include <deque>
+#include <array>
+#include <span>
+#include <algorithm>
 #include <iostream>
 #include <sm/range>
 #include <mplot/graphing.h>
@@ -70,6 +73,28 @@ int main()
 
     std::cout << "\n\n";
 
+    for (unsigned int i = 3; i < 30; ++i) {
+        // The buffer overload should make the same ticks as the deque overload
+        sm::range<float> nticks = {static_cast<float>(i-1), static_cast<float>(i+1)};
+        std::deque<float> ticks = mplot::graphing::maketicks (-1.3f, 7.2f, -1.5f, 7.5f, nticks);
+        std::array<float, 64> buf = {};
+        std::size_t n = mplot::graphing::maketicks (-1.3f, 7.2f, -1.5f, 7.5f, nticks, std::span<float>(buf));
+        std::cout << "span i+-1 ";
+        print_ticks (std::span<float>(buf.data(), n));
+        if (n != ticks.size() || !std::equal (ticks.begin(), ticks.end(), buf.begin())) { --rtn; }
+    }
+
+    // A too-small buffer truncates, but still holds ascending ticks
+    {
+        std::array<float, 4> buf = {};
+        std::size_t n = mplot::graphing::maketicks (0.0f, 9.0f, 0.0f, 9.0f, sm::range<float>{8.0f, 10.0f}, std::span<float>(buf));
+        std::cout << "span[4] ";
+        print_ticks (std::span<float>(buf.data(), n));
+        if (n != 4 || !std::is_sorted (buf.begin(), buf.end())) { --rtn; }
+    }
+
+    std::cout << "\n\n";
+
     if (rtn == 0) { std::cout << "Test SUCCESS\n"; } else { std::cout << "Test FAIL\n"; }
 
     return rtn;
@@ -0,0 +1,71 @@
+// Test mplot::memory_report, the totals, JSON and summary of a tree of memory items
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <mplot/memory_report.h>
+
+int main()
+{
+    int rtn = 0;
+
+    // A vector reports its size as used and its capacity as allocated
+    std::vector<float> v (100, 1.0f);
+    v.reserve (400);
+    std::vector<float> unallocated;
+    mplot::memory_report m1;
+    m1.name = "model 0";
+    m1.add_vector ("vertexPositions", v);
+    m1.add_vector ("vertexNormals", unallocated); // no capacity, so not listed
+    if (m1.items.size() != 1u) { std::cout << "Vector with no capacity was reported\n"; --rtn; }
+    if (m1.cpu_used() != 100u * sizeof (float)) { std::cout << "cpu_used " << m1.cpu_used() << "\n"; --rtn; }
+    if (m1.cpu_allocated() != v.capacity() * sizeof (float)) { std::cout << "cpu_allocated " << m1.cpu_allocated() << "\n"; --rtn; }
+    if (m1.cpu_unused() != (v.capacity() - 100u) * sizeof (float)) { std::cout << "cpu_unused " << m1.cpu_unused() << "\n"; --rtn; }
+
+    // GPU memory; a buffer shared by two models (GL name 7) counts once in their parent's total
+    m1.add_gpu ("posnVBO", 1200u, true, 7u);
+    m1.add_gpu ("colVBO", 1200u);
+    m1.add_gpu ("normVBO", 0u); // empty, so not listed
+    mplot::memory_report m2;
+    m2.name = "model 1";
+    m2.add_gpu ("posnVBO", 1200u, true, 7u);
+    m2.add_gpu ("colVBO", 500u);
+    m2.add_cpu ("mesh_source (mapped)", 64u, 64u);
+
+    if (m1.gpu_bytes() != 2400u) { std::cout << "m1 gpu_bytes " << m1.gpu_bytes() << "\n"; --rtn; }
+    if (m1.gpu_shared_bytes() != 1200u) { std::cout << "m1 gpu_shared_bytes " << m1.gpu_shared_bytes() << "\n"; --rtn; }
+
+    mplot::memory_report vis;
+    vis.name = "Visual";
+    vis.children.push_back (m2);
+    vis.children.push_back (m1);
+    if (vis.gpu_bytes() != 1200u + 1200u + 500u) { std::cout << "Visual gpu_bytes " << vis.gpu_bytes() << "\n"; --rtn; }
+    if (vis.gpu_shared_bytes() != 1200u) { std::cout << "Visual gpu_shared_bytes " << vis.gpu_shared_bytes() << "\n"; --rtn; }
+    if (vis.cpu_allocated() != m1.cpu_allocated() + 64u) { std::cout << "Visual cpu_allocated " << vis.cpu_allocated() << "\n"; --rtn; }
+
+    // The summary lists the children with the most memory first
+    const std::string s = vis.summary (1);
+    std::cout << s << std::endl;
+    if (s.find ("model 0") == std::string::npos) { std::cout << "summary lacks the larger model\n"; --rtn; }
+    if (s.find ("model 1") != std::string::npos) { std::cout << "summary lists more than 1 child\n"; --rtn; }
+    if (s.find ("(and 1 more)") == std::string::npos) { std::cout << "summary lacks the count of the rest\n"; --rtn; }
+
+    if (mplot::memory_report::bytes_str (512u) != "512 B") { std::cout << "bytes_str (512) " << mplot::memory_report::bytes_str (512u) << "\n"; --rtn; }
+    if (mplot::memory_report::bytes_str (1536u) != "1.5 kB") { std::cout << "bytes_str (1536) " << mplot::memory_report::bytes_str (1536u) << "\n"; --rtn; }
+    if (mplot::memory_report::bytes_str (3u * 1024u * 1024u) != "3.0 MB") { std::cout << "bytes_str (3 MB)\n"; --rtn; }
+
+    // The JSON holds each level's totals, and round trips through a string
+    const nlohmann::json j = nlohmann::json::parse (vis.json().dump());
+    if (j["gpu"].get<std::size_t>() != vis.gpu_bytes()) { std::cout << "JSON gpu total\n"; --rtn; }
+    if (j["children"].size() != 2u) { std::cout << "JSON children\n"; --rtn; }
+    if (j["children"][1]["name"].get<std::string>() != "model 0") { std::cout << "JSON child name\n"; --rtn; }
+    if (j["children"][1]["items"][0]["cpu_allocated"].get<std::size_t>() != v.capacity() * sizeof (float)) {
+        std::cout << "JSON item cpu_allocated\n"; --rtn;
+    }
+    if (!j["children"][1]["items"][1]["shared"].get<bool>() || j["children"][1]["items"][1]["gl_name"].get<std::uint32_t>() != 7u) {
+        std::cout << "JSON shared item\n"; --rtn;
+    }
+
+    return rtn;
+}
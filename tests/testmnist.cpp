@@ -0,0 +1,63 @@
+// Test that mplot::MnistMapped reads the same images and labels as mplot::Mnist
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "mplot/Mnist.h"
+
+// Write a small IDX image file and label file for n examples under tag
+void write_idx (const std::string& base, const std::string& tag, const std::uint32_t n)
+{
+    auto put32 = [](std::ofstream& f, std::uint32_t v) {
+        const char b[4] = { static_cast<char>(v >> 24), static_cast<char>(v >> 16), static_cast<char>(v >> 8), static_cast<char>(v) };
+        f.write (b, 4);
+    };
+    std::ofstream fi (base + tag + "-images-idx3-ubyte", std::ios::binary);
+    put32 (fi, 2051); put32 (fi, n); put32 (fi, 28); put32 (fi, 28);
+    for (std::uint32_t i = 0; i < n; ++i) {
+        for (int p = 0; p < mplot::mnlen; ++p) { fi.put (static_cast<char>((i * 7 + p * 3) & 0xff)); }
+    }
+    std::ofstream fl (base + tag + "-labels-idx1-ubyte", std::ios::binary);
+    put32 (fl, 2049); put32 (fl, n);
+    for (std::uint32_t i = 0; i < n; ++i) { fl.put (static_cast<char>(i % 10)); }
+}
+
+int main()
+{
+    int rtn = 0;
+
+    const std::string base = "./testmnist_";
+    write_idx (base, "train", 25);
+    write_idx (base, "t10k", 12);
+
+    mplot::Mnist mn (base);
+    mplot::MnistMapped mm (base);
+
+    if (mm.training.size() != 25u || mm.test.size() != 12u) { --rtn; }
+    if (mn.num_training() != 25u || mn.num_test() != 12u) { --rtn; }
+
+    for (int i = 0; i < 25; ++i) {
+        auto [ id, label, data ] = mn.training_example (i);
+        if (mm.training.label (i) != label) { --rtn; }
+        if (mm.training.image_float (i) != data) { std::cout << "Image " << i << " differs\n"; --rtn; }
+        // The raw bytes are top row first, as in the file; the floats are bottom row first
+        if (mm.training.image (i)[0] != static_cast<unsigned char>(i * 7)) { --rtn; }
+        if (data[27 * 28] != static_cast<float>(static_cast<unsigned char>(i * 7)) / 256.0f) { --rtn; }
+    }
+
+    // Each label's index array holds the images with that label, in file order
+    for (unsigned int l = 0; l < 10; ++l) {
+        for (auto i : mm.training.by_label[l]) { if (mm.training.label (i) != l) { --rtn; } }
+    }
+    if (mm.training.by_label[0].size() != 3u || mm.training.by_label[9].size() != 2u) { --rtn; }
+
+    // All of the float images are in one contiguous block
+    const std::vector<float>& all = mm.test.float_images();
+    if (all.size() != 12u * mplot::mnlen) { --rtn; }
+    sm::vvec<float> t5 = mm.test.image_float (5);
+    for (int p = 0; p < mplot::mnlen; ++p) { if (all[5 * mplot::mnlen + p] != t5[p]) { --rtn; break; } }
+
+    std::cout << "testmnist " << (rtn == 0 ? "passed" : "failed") << std::endl;
+    return rtn;
+}
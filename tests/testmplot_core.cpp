@@ -0,0 +1,60 @@
+/*
+ * Test that a program links with the mplot_core library. This translation unit and those of the
+ * library all include the Visual, GraphVisual and ColourMap headers, so a definition in them that
+ * is not inline would be defined more than once, and the link would fail. Provide a cmd line arg
+ * to see the window.
+ */
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <sm/vec>
+#include <sm/vvec>
+
+#include <mplot/Visual.h>
+#include <mplot/GraphVisual.h>
+#include <mplot/ColourMap.h>
+#include <mplot/tools.h>
+#include <mplot/version.h>
+#include <mplot/lodepng.h>
+
+int main (int argc, char** argv)
+{
+    int rtn = 0;
+
+    // Functions defined in the headers, which the library compiled too
+    std::string s = "mplot   ";
+    if (mplot::tools::stripTrailingSpaces (s) != 3 || s != "mplot") { std::cout << "tools\n"; --rtn; }
+    if (mplot::version_string().empty()) { std::cout << "version_string\n"; --rtn; }
+
+    // A PNG round trip through lodepng, which is compiled only into the library
+    std::vector<unsigned char> img (4 * 4 * 4, 100u);
+    std::vector<unsigned char> png;
+    std::vector<unsigned char> back;
+    unsigned int w = 0;
+    unsigned int h = 0;
+    if (lodepng::encode (png, img, 4, 4) != 0u || lodepng::decode (back, w, h, png) != 0u
+        || w != 4u || h != 4u || back != img) {
+        std::cout << "lodepng\n";
+        --rtn;
+    }
+
+    // ColourMap<float>, instantiated in the library
+    mplot::ColourMap<float> cm (mplot::ColourMapType::Viridis);
+    if (cm.convert (0.0f) == cm.convert (1.0f)) { std::cout << "ColourMap\n"; --rtn; }
+
+    // Visual and GraphVisual<float>, instantiated in the library
+    mplot::Visual v (640, 480, "mplot_core client");
+    auto gv = std::make_unique<mplot::GraphVisual<float>> (sm::vec<float>{ 0.0f, 0.0f, 0.0f });
+    v.bindmodel (gv);
+    sm::vvec<float> x;
+    x.linspace (-1.0f, 1.0f, 20);
+    gv->setdata (x, x.pow (2));
+    gv->finalize();
+    v.addVisualModel (gv);
+    v.render();
+    if (argc > 1) { v.keepOpen(); }
+
+    return rtn;
+}
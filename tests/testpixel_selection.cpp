@@ -0,0 +1,64 @@
+// Test mplot::pixel_selection, the set of selected grid elements held by GridVisual
+#include <iostream>
+#include <vector>
+#include <array>
+#include <stdexcept>
+#include "mplot/pixel_selection.h"
+
+int main()
+{
+    int rtn = 0;
+
+    mplot::pixel_selection<int> sel;
+    const std::array<float, 3> red = { 1.0f, 0.0f, 0.0f };
+    const std::array<float, 3> blue = { 0.0f, 0.0f, 1.0f };
+
+    if (!sel.empty() || sel.contains (0) || sel.contains (-1) || sel.begin() != sel.end()) { --rtn; }
+
+    sel[130] = red;
+    sel[3] = blue;
+    sel[63] = red;
+    sel[64] = red;
+    sel[3] = red; // a change of colour, not another element
+    if (sel.size() != 4u || !sel.contains (3) || sel.contains (4) || sel.contains (100000)) {
+        std::cout << "membership failed\n";
+        --rtn;
+    }
+    // Colours are shared through the palette
+    if (sel.get_palette().size() != 2u || sel.at (3) != red) {
+        std::cout << "palette failed\n";
+        --rtn;
+    }
+
+    // Iteration is in order of index
+    std::vector<int> order;
+    for (auto sp : sel) {
+        order.push_back (sp.first);
+        if (sp.second != red) { --rtn; }
+    }
+    if (order != std::vector<int>{ 3, 63, 64, 130 }) {
+        std::cout << "iteration failed\n";
+        --rtn;
+    }
+
+    if (sel.erase (63) != 1u || sel.erase (63) != 0u || sel.contains (63) || sel.size() != 3u) {
+        std::cout << "erase failed\n";
+        --rtn;
+    }
+
+    bool threw = false;
+    try {
+        [[maybe_unused]] std::array<float, 3> c = sel[63];
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    if (!threw) { --rtn; }
+
+    sel.clear();
+    if (!sel.empty() || sel.contains (130) || sel.begin() != sel.end() || !sel.get_palette().empty()) {
+        std::cout << "clear failed\n";
+        --rtn;
+    }
+
+    return rtn;
+}
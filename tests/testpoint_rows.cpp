@@ -0,0 +1,82 @@
+// Test the finding of rows of points and the triangulation of the strips between them
+
+#include <iostream>
+#include <vector>
+#include <cstddef>
+#include <sm/vec>
+#include <mplot/point_rows.h>
+
+namespace pr = mplot::point_rows;
+
+int main()
+{
+    int rtn = 0;
+
+    // Three rows perpendicular to x, of 4, 6 and 1 points, along a curve in y and z
+    std::vector<sm::vec<float, 3>> pts;
+    const std::vector<std::size_t> lengths = { 4, 6, 1 };
+    for (std::size_t r = 0; r < lengths.size(); ++r) {
+        for (std::size_t i = 0; i < lengths[r]; ++i) {
+            const float t = static_cast<float>(i) / static_cast<float>(lengths[r]);
+            pts.push_back ({ static_cast<float>(r), t, t * t });
+        }
+    }
+
+    const std::vector<pr::row> rows = pr::find_rows (pts, 0);
+    if (rows.size() != 3u) {
+        std::cout << "found " << rows.size() << " rows, not 3\n";
+        rtn -= 1;
+    } else {
+        if (rows[0].first != 0u || rows[0].last != 3u || rows[1].first != 4u || rows[1].last != 9u
+            || rows[2].first != 10u || rows[2].last != 10u) {
+            std::cout << "wrong row extents\n";
+            rtn -= 1;
+        }
+
+        // Each triangle of a strip is made by one advance along a row by one point, and the
+        // strip ends with one of its rows at its last point
+        for (std::size_t k = 0; k + 1u < rows.size(); ++k) {
+            const pr::row& a = rows[k];
+            const pr::row& b = rows[k + 1u];
+            std::size_t n_start = 0, n_advance = 0;
+            std::size_t r1 = 0, r2 = 0;
+            bool consecutive = true;
+            auto start = [&](std::size_t s1, std::size_t s2) { ++n_start; r1 = s1; r2 = s2; };
+            auto advance = [&](std::size_t from, std::size_t to) {
+                ++n_advance;
+                if (to != from + 1u || (from != r1 && from != r2)) { consecutive = false; }
+                if (from == r1) { r1 = to; } else { r2 = to; }
+            };
+            auto next = [&](std::size_t s1, std::size_t s2) { if (s1 != r1 || s2 != r2) { consecutive = false; } };
+            pr::walk_pair (pts, a, b, start, advance, next);
+            if (n_start != 1u || !consecutive || n_advance != (r1 - a.first) + (r2 - b.first)) {
+                std::cout << "pair " << k << " was not walked one point at a time\n";
+                rtn -= 1;
+            }
+            if (r1 != a.last && r2 != b.last) {
+                std::cout << "pair " << k << " ended before either row did\n";
+                rtn -= 1;
+            }
+        }
+    }
+
+    // Two straight, parallel rows of 3 points zig-zag from end to end in 4 triangles
+    const std::vector<sm::vec<float, 3>> ladder = { { 0, 0, 0 }, { 0, 1, 0 }, { 0, 2, 0 },
+                                                    { 1, 0, 0 }, { 1, 1, 0 }, { 1, 2, 0 } };
+    const std::vector<pr::row> lr = pr::find_rows (ladder, 0);
+    std::vector<std::size_t> order;
+    auto none = [](std::size_t, std::size_t) {};
+    auto add = [&order](std::size_t, std::size_t to) { order.push_back (to); };
+    if (lr.size() == 2u) { pr::walk_pair (ladder, lr[0], lr[1], none, add, none); }
+    if (order != std::vector<std::size_t>{ 4, 1, 5, 2 } && order != std::vector<std::size_t>{ 1, 4, 2, 5 }) {
+        std::cout << "the ladder was not zig-zagged:";
+        for (auto o : order) { std::cout << " " << o; }
+        std::cout << "\n";
+        rtn -= 1;
+    }
+
+    // No points, no rows
+    if (!pr::find_rows (std::vector<sm::vec<float, 3>>{}, 0).empty()) { std::cout << "rows from no points\n"; rtn -= 1; }
+
+    return rtn;
+}
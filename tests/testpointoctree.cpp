@@ -0,0 +1,104 @@
+// Test the building and reading of the on-disk octree of mplot::PointCloudVisual
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cmath>
+#include <limits>
+#include <sm/vec>
+#include <mplot/point_octree.h>
+
+int main()
+{
+    int rtn = 0;
+    namespace po = mplot::point_octree;
+
+    // 100000 points on a sphere and in a line, with a NaN point that is left out
+    std::vector<sm::vec<float>> pts;
+    std::vector<float> vals;
+    for (int i = 0; i < 100000; ++i) {
+        const float t = static_cast<float>(i);
+        const float z = 1.0f - 2.0f * (t + 0.5f) / 100000.0f;
+        const float r = std::sqrt (1.0f - z * z);
+        pts.push_back ({ r * std::cos (2.39996f * t), r * std::sin (2.39996f * t), z });
+        vals.push_back (z);
+    }
+    for (int i = 0; i < 1000; ++i) { pts.push_back ({ 3.0f, 0.0f, 0.0f }); vals.push_back (5.0f); } // coincident
+    pts.push_back ({ std::numeric_limits<float>::quiet_NaN(), 0.0f, 0.0f });
+    vals.push_back (-9.0f);
+
+    const std::string path = "testpointoctree.oct";
+    po::build_params bp;
+    bp.sample_grid = 16;
+    bp.max_leaf_points = 2000;
+    bp.max_depth = 12;
+    const po::file_header h = po::build (pts, vals, path, bp);
+
+    po::octree_file of (path);
+    const auto nodes = of.nodes();
+    if (of.header().n_points != pts.size() - 1u || of.header().n_nodes != nodes.size() || h.n_nodes != nodes.size()
+        || of.header().value_range[0] != vals[99999] || of.header().value_range[1] != 5.0f) {
+        std::cout << "the header is wrong\n";
+        rtn -= 1;
+    }
+
+    // Every point is in one node, within its node's cube, and the sums of the values match
+    std::uint64_t total = 0, next_first = 0;
+    double vsum = 0.0;
+    std::uint32_t maxn = 0;
+    bool in_cubes = true, ordered = true, children_ok = true, sampled = true;
+    for (std::uint32_t i = 0; i < nodes.size(); ++i) {
+        const po::file_node& nd = nodes[i];
+        if (nd.first_point != next_first) { ordered = false; }
+        next_first += nd.count;
+        total += nd.count;
+        maxn = std::max (maxn, nd.count);
+        for (const po::file_point& fp : of.points (i)) {
+            vsum += fp.value;
+            for (unsigned int j = 0; j < 3u; ++j) {
+                if (std::abs (fp.p[j] - nd.centre[j]) > nd.half * 1.0001f) { in_cubes = false; }
+            }
+        }
+        // An inner node has at most one point per cell of its sample grid
+        if (nd.child_mask != 0 && nd.count > 16u * 16u * 16u) { sampled = false; }
+        // Its children are consecutive, half its size and one deeper, and come after it
+        for (unsigned int c = 0; c < nd.n_children(); ++c) {
+            const po::file_node& ch = nodes[nd.first_child + c];
+            if (nd.first_child <= i || ch.half != 0.5f * nd.half || ch.depth != nd.depth + 1u) { children_ok = false; }
+        }
+    }
+    double expect = 5000.0;
+    for (int i = 0; i < 100000; ++i) { expect += vals[i]; }
+    if (total != pts.size() - 1u || std::abs (vsum - expect) > 1e-3 || maxn != of.header().max_node_points) {
+        std::cout << "the nodes hold " << total << " points, sum " << vsum << " (expected " << expect << ")\n";
+        rtn -= 1;
+    }
+    if (!in_cubes || !ordered || !children_ok || !sampled) {
+        std::cout << "a node is wrong: " << in_cubes << ordered << children_ok << sampled << "\n";
+        rtn -= 1;
+    }
+    // The root takes a subsample, spaced by a cell of its grid
+    if (nodes[0].child_mask == 0 || std::abs (nodes[0].spacing - of.header().size / 16.0f) > 1e-6f || nodes[0].count < 100u) {
+        std::cout << "the root is wrong\n";
+        rtn -= 1;
+    }
+
+    // A file that is not an octree is refused
+    {
+        std::FILE* bad = std::fopen ("testpointoctree.bad", "wb");
+        const char junk[80] = "not an octree";
+        std::fwrite (junk, 1, sizeof (junk), bad);
+        std::fclose (bad);
+        bool threw = false;
+        try { po::octree_file bf ("testpointoctree.bad"); } catch (const std::exception&) { threw = true; }
+        if (!threw) {
+            std::cout << "a bad file was accepted\n";
+            rtn -= 1;
+        }
+    }
+    std::remove (path.c_str());
+    std::remove ("testpointoctree.bad");
+
+    return rtn;
+}
@@ -0,0 +1,70 @@
+#include <iostream>
+#include <vector>
+#include <list>
+#include <cstdio>
+
+#include <sm/bezcoord>
+#include <sm/bezcurvepath>
+
+#include <mplot/ReadCurves.h>
+
+// Return true if the points of a and b are identical
+bool same_points (const sm::bezcurvepath<float>& a, const sm::bezcurvepath<float>& b)
+{
+    std::vector<sm::bezcoord<float>> pa = a.getPoints();
+    std::vector<sm::bezcoord<float>> pb = b.getPoints();
+    if (pa.size() != pb.size() || pa.empty()) { return false; }
+    for (std::size_t i = 0; i < pa.size(); ++i) {
+        if (pa[i].t() != pb[i].t() || pa[i].x() != pb[i].x() || pa[i].y() != pb[i].y()) { return false; }
+    }
+    return true;
+}
+
+int main()
+{
+    int rtn = 0;
+    const std::string svg = "../../tests/whiskerbarrels_withcentres.svg";
+    const std::string sidecar = "./testreadcurves_sample.bezpts";
+    const float step = 0.01f;
+
+    try {
+        // The reference: each path sampled serially with computePoints
+        mplot::ReadCurves r_ref (svg);
+        sm::bezcurvepath<float> cortex_ref = r_ref.getCorticalPath();
+        cortex_ref.computePoints (step);
+        std::list<sm::bezcurvepath<float>> regions_ref = r_ref.getEnclosedRegions();
+        for (auto& er : regions_ref) { er.computePoints (step); }
+
+        // Sample in parallel (with no sidecar), then twice with the sidecar (writing, then reading it)
+        std::remove (sidecar.c_str());
+        for (int pass = 0; pass < 3; ++pass) {
+            mplot::ReadCurves r (svg);
+            r.sample (step, pass == 0 ? std::string("") : sidecar, 4);
+            if (!same_points (r.getCorticalPath(), cortex_ref)) {
+                std::cerr << "Pass " << pass << ": cortical path points differ from computePoints\n";
+                --rtn;
+            }
+            std::list<sm::bezcurvepath<float>> regions = r.getEnclosedRegions();
+            if (regions.size() != regions_ref.size()) {
+                std::cerr << "Pass " << pass << ": wrong number of enclosed regions\n";
+                --rtn;
+                continue;
+            }
+            auto ri = regions_ref.begin();
+            for (const auto& er : regions) {
+                if (!same_points (er, *ri++)) {
+                    std::cerr << "Pass " << pass << ": points of enclosed region " << er.name << " differ\n";
+                    --rtn;
+                }
+            }
+        }
+        std::remove (sidecar.c_str());
+
+    } catch (const std::exception& e) {
+        std::cerr << "Caught exception: " << e.what() << std::endl;
+        rtn = -1;
+    }
+
+    std::cout << "return rtn = " << rtn << std::endl;
+    return rtn;
+}
@@ -0,0 +1,69 @@
+// Test the recycler, and the pool of text model storage that each Visual makes from recyclers
+
+#include <iostream>
+#include <vector>
+#include <mplot/recycler.h>
+#include <mplot/VisualCommon.h>
+
+int main()
+{
+    int rtn = 0;
+
+    // The last thing put is the first taken, and no more than max_items are kept
+    mplot::recycler<unsigned int> r (3);
+    for (unsigned int i = 1; i <= 4; ++i) {
+        unsigned int v = i;
+        if (r.put (std::move (v)) != (i <= 3)) {
+            std::cout << "put " << i << " into a recycler of 3 gave the wrong result\n";
+            rtn -= 1;
+        }
+    }
+    unsigned int v = 0;
+    if (r.size() != 3u || !r.take (v) || v != 3u || !r.take (v) || v != 2u) {
+        std::cout << "take failed\n";
+        rtn -= 1;
+    }
+
+    // drain visits each kept thing, then the recycler is empty
+    std::vector<unsigned int> drained;
+    r.drain ([&drained](unsigned int& n) { drained.push_back (n); });
+    if (drained != std::vector<unsigned int>{ 1u } || !r.empty() || r.take (v) || v != 2u) {
+        std::cout << "drain failed\n";
+        rtn -= 1;
+    }
+
+    // A vector given back to the text model pool passes its capacity to the next one taken
+    mplot::visgl::text_model_pool pool;
+    std::vector<float> a (1000, 1.0f);
+    const float* storage = a.data();
+    pool.give (a);
+    if (!a.empty() || a.capacity() != 0u || pool.floats.size() != 1u) {
+        std::cout << "give did not empty the vector into the pool\n";
+        rtn -= 1;
+    }
+    std::vector<float> b;
+    pool.take (b);
+    if (!b.empty() || b.capacity() < 1000u || b.data() != storage) {
+        std::cout << "take did not reuse the storage\n";
+        rtn -= 1;
+    }
+    // A vector that already has storage keeps its own
+    std::vector<float> c;
+    c.reserve (10);
+    pool.give (b);
+    pool.take (c);
+    if (c.capacity() >= 1000u || pool.floats.size() != 1u) {
+        std::cout << "take replaced a vector's own storage\n";
+        rtn -= 1;
+    }
+
+    // Big vectors are freed, not kept
+    std::vector<unsigned int> big (mplot::visgl::text_model_pool::max_kept_capacity + 1u);
+    pool.give (big);
+    if (big.capacity() != 0u || !pool.indices.empty()) {
+        std::cout << "a big vector was kept\n";
+        rtn -= 1;
+    }
+
+    return rtn;
+}
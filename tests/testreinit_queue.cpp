@@ -0,0 +1,47 @@
+// Test the coalescing of model updates in mplot/reinit_queue.h
+#include <iostream>
+#include "mplot/reinit_queue.h"
+
+struct mock_model
+{
+    int n_reinit = 0;
+    int n_buffers = 0;
+    int n_colours = 0;
+    void reinit() { ++this->n_reinit; }
+    void reinit_buffers() { ++this->n_buffers; }
+    void reinit_colour_buffer() { ++this->n_colours; }
+};
+
+int main()
+{
+    int rtn = 0;
+
+    mock_model a, b, c, d;
+    mplot::reinit_queue<mock_model> q;
+
+    // Repeated requests for one model are coalesced into the largest
+    q.request (&a, mplot::reinit_kind::colours);
+    q.request (&a, mplot::reinit_kind::full);
+    q.request (&a, mplot::reinit_kind::colours);
+    q.request (&b, mplot::reinit_kind::colours);
+    q.request (&b, mplot::reinit_kind::colours);
+    q.request (&c, mplot::reinit_kind::buffers);
+    q.request (&c, mplot::reinit_kind::colours);
+    q.request (&d);
+    q.cancel (&d);
+    q.request (nullptr);
+    if (q.size() != 3u) { std::cout << "queue size " << q.size() << " != 3\n"; --rtn; }
+
+    q.process();
+    if (!q.empty()) { std::cout << "queue not emptied\n"; --rtn; }
+    if (a.n_reinit != 1 || a.n_buffers != 0 || a.n_colours != 0) { std::cout << "a not fully reinitialized once\n"; --rtn; }
+    if (b.n_reinit != 0 || b.n_buffers != 0 || b.n_colours != 1) { std::cout << "b colours not uploaded once\n"; --rtn; }
+    if (c.n_reinit != 0 || c.n_buffers != 1 || c.n_colours != 0) { std::cout << "c buffers not uploaded once\n"; --rtn; }
+    if (d.n_reinit != 0) { std::cout << "cancelled model was reinitialized\n"; --rtn; }
+
+    // A second process does nothing
+    q.process();
+    if (a.n_reinit != 1 || b.n_colours != 1 || c.n_buffers != 1) { std::cout << "process repeated updates\n"; --rtn; }
+
+    return rtn;
+}
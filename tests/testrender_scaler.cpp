@@ -0,0 +1,80 @@
+// Test the render_scaler of Visual::dynamicResolution: when frames are reduced and when they are not
+
+#include <chrono>
+#include <iostream>
+#include <mplot/render_scaler.h>
+
+int main()
+{
+    int rtn = 0;
+    using sc = std::chrono::steady_clock;
+    using ms = std::chrono::milliseconds;
+    const sc::time_point t0 = sc::now();
+
+    // Off by default: interaction does not reduce the frames
+    mplot::render_scaler off;
+    off.interacted (t0);
+    if (off.begin_frame (t0, true) != 1.0f || off.reduced()) {
+        std::cout << "scaling is on by default\n";
+        rtn -= 1;
+    }
+
+    mplot::render_scaler rs;
+    rs.scaling = { 0.5f, 0.0, 150.0 };
+    // A still scene is drawn at full resolution
+    if (rs.begin_frame (t0, true) != 1.0f) {
+        std::cout << "a still scene was reduced\n";
+        rtn -= 1;
+    }
+    rs.end_frame (t0, t0 + ms(40));
+
+    // While the view moves, and until it has settled, frames are reduced
+    rs.interacted (t0 + ms(100));
+    if (rs.begin_frame (t0 + ms(110), true) != 0.5f || !rs.reduced()) {
+        std::cout << "a moving scene was not reduced\n";
+        rtn -= 1;
+    }
+    rs.end_frame (t0 + ms(110), t0 + ms(115));
+    if (rs.begin_frame (t0 + ms(200), false) != 0.5f) {
+        std::cout << "a frame before the view settled was not reduced\n";
+        rtn -= 1;
+    }
+    rs.end_frame (t0 + ms(200), t0 + ms(205));
+    // Once it has settled, one full frame, and then no request for another
+    if (rs.begin_frame (t0 + ms(300), false) != 1.0f || rs.reduced()) {
+        std::cout << "the settled frame was reduced\n";
+        rtn -= 1;
+    }
+    rs.end_frame (t0 + ms(300), t0 + ms(340));
+    if (rs.frames_reduced() != 2u || rs.frames_full() != 2u) {
+        std::cout << "counted " << rs.frames_reduced() << " reduced and " << rs.frames_full() << " full frames\n";
+        rtn -= 1;
+    }
+    // Reduced frames do not change the measured cost of a full frame
+    if (rs.full_frame_ms() < 39.0 || rs.full_frame_ms() > 41.0) {
+        std::cout << "full frame cost " << rs.full_frame_ms() << " ms, not 40 ms\n";
+        rtn -= 1;
+    }
+
+    // With a budget, a changing scene whose full frames are over budget is reduced
+    rs.scaling.budget_ms = 20.0;
+    if (rs.begin_frame (t0 + ms(1000), true) != 0.5f) {
+        std::cout << "an over budget change was not reduced\n";
+        rtn -= 1;
+    }
+    rs.end_frame (t0 + ms(1000), t0 + ms(1010));
+    // The frame that follows a reduced one (and that nothing else asked for) comes once it has settled
+    if (rs.begin_frame (t0 + ms(1200), false) != 1.0f) {
+        std::cout << "the frame after an over budget change was reduced\n";
+        rtn -= 1;
+    }
+    rs.end_frame (t0 + ms(1200), t0 + ms(1210));
+    // Within budget, changes are drawn at full resolution
+    rs.scaling.budget_ms = 100.0;
+    if (rs.begin_frame (t0 + ms(2000), true) != 1.0f) {
+        std::cout << "a change within budget was reduced\n";
+        rtn -= 1;
+    }
+
+    return rtn;
+}
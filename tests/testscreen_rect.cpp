@@ -0,0 +1,70 @@
+// Test the screen rectangles of partial redraws: from_ndc, unite and intersection
+
+#include <iostream>
+#include <sm/vec>
+#include <mplot/screen_rect.h>
+
+int main()
+{
+    int rtn = 0;
+
+    const sm::vec<int, 2> dims = { 800, 600 };
+
+    // The whole of clip space is the whole framebuffer, whatever the margin
+    mplot::screen_rect all = mplot::screen_rect::from_ndc ({ -1.0f, -1.0f }, { 1.0f, 1.0f }, dims, 2);
+    if (all != mplot::screen_rect{ 0, 0, 800, 600 } || all.area() != 480000) {
+        std::cout << "full frame rect wrong: " << all.x0 << "," << all.y0 << " to " << all.x1 << "," << all.y1 << "\n";
+        rtn -= 1;
+    }
+
+    // The top right quarter, with a margin of 2 pixels on the inner edges
+    mplot::screen_rect q = mplot::screen_rect::from_ndc ({ 0.0f, 0.0f }, { 1.0f, 1.0f }, dims, 2);
+    if (q != mplot::screen_rect{ 398, 298, 800, 600 } || q.width() != 402 || q.height() != 302) {
+        std::cout << "quarter rect wrong: " << q.x0 << "," << q.y0 << " to " << q.x1 << "," << q.y1 << "\n";
+        rtn -= 1;
+    }
+
+    // A box that touches part of a pixel covers all of it
+    mplot::screen_rect px = mplot::screen_rect::from_ndc ({ 0.001f, 0.001f }, { 0.002f, 0.002f }, dims, 0);
+    if (px != mplot::screen_rect{ 400, 300, 401, 301 }) {
+        std::cout << "part pixel rect wrong: " << px.x0 << "," << px.y0 << " to " << px.x1 << "," << px.y1 << "\n";
+        rtn -= 1;
+    }
+
+    // A box wholly outside the frame is empty
+    mplot::screen_rect off = mplot::screen_rect::from_ndc ({ 1.5f, -0.5f }, { 2.0f, 0.5f }, dims, 2);
+    if (!off.empty() || off.area() != 0) {
+        std::cout << "off screen rect is not empty\n";
+        rtn -= 1;
+    }
+
+    // So is one whose coordinates are far outside clip space (as for a point close to the camera plane)
+    mplot::screen_rect far = mplot::screen_rect::from_ndc ({ 1.0e20f, 0.0f }, { 3.0e30f, 0.5f }, dims, 2);
+    mplot::screen_rect wide = mplot::screen_rect::from_ndc ({ -1.0e20f, -0.5f }, { 1.0e20f, 0.5f }, dims, 2);
+    if (!far.empty() || wide != mplot::screen_rect{ 0, 148, 800, 452 }) {
+        std::cout << "far rect wrong: " << wide.x0 << "," << wide.y0 << " to " << wide.x1 << "," << wide.y1 << "\n";
+        rtn -= 1;
+    }
+
+    // Unite grows to hold both and ignores empty rectangles
+    mplot::screen_rect u;
+    u.unite (mplot::screen_rect{ 10, 20, 30, 40 });
+    u.unite (off);
+    u.unite (mplot::screen_rect{ 50, 5, 60, 25 });
+    if (u != mplot::screen_rect{ 10, 5, 60, 40 }) {
+        std::cout << "unite wrong: " << u.x0 << "," << u.y0 << " to " << u.x1 << "," << u.y1 << "\n";
+        rtn -= 1;
+    }
+
+    // Intersection
+    if (u.intersection (q) != mplot::screen_rect{} || !u.intersection (mplot::screen_rect{ 100, 100, 200, 200 }).empty()) {
+        std::cout << "disjoint rectangles intersect\n";
+        rtn -= 1;
+    }
+    if (u.intersection (mplot::screen_rect{ 0, 0, 20, 10 }) != mplot::screen_rect{ 10, 5, 20, 10 }) {
+        std::cout << "intersection wrong\n";
+        rtn -= 1;
+    }
+
+    return rtn;
+}
@@ -0,0 +1,191 @@
+// Test the shared memory feed of data from a simulation process to a viewer process
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sm/vec>
+#include <mplot/shm_feed.h>
+
+namespace shm = mplot::shm;
+
+// Stand ins for a VisualDataModel and a GraphVisual
+struct mock_model
+{
+    std::vector<float> data;
+    std::vector<sm::vec<float, 3>> vectors;
+    void updateData (const float* first, const std::size_t n) { this->data.assign (first, first + n); }
+    void updateData (const sm::vec<float, 3>* first, const std::size_t n) { this->vectors.assign (first, first + n); }
+};
+
+struct mock_graph
+{
+    std::vector<shm::graph_point<double>> points;
+    void append (const double& x, const double& y, const unsigned int didx) { this->points.push_back ({ x, y, didx }); }
+};
+
+int main()
+{
+    int rtn = 0;
+    const std::string name = "mplot_testshm_feed_" + std::to_string (::getpid());
+
+    try {
+        shm::shm_feed_writer w (name, { shm::channel<float>("field", 8, 3),
+                                        shm::channel<sm::vec<float, 3>>("quivers", 4),
+                                        shm::channel<shm::graph_point<double>>("trace", 16, 2) });
+        const std::size_t field = w.channel ("field");
+        const std::size_t quivers = w.channel ("quivers");
+        const std::size_t trace = w.channel ("trace");
+
+        // The simulation runs with no viewer: the ring of 3 fills up and later frames are dropped
+        std::vector<float> f = { 1, 2, 3 };
+        for (int i = 0; i < 5; ++i) {
+            f[0] = static_cast<float>(i);
+            const bool ok = w.publish (field, f);
+            if (ok != (i < 3)) { std::cout << "frame " << i << " should " << (i < 3 ? "" : "not ") << "fit\n"; rtn -= 1; }
+        }
+        if (w.dropped (field) != 2u) { std::cout << "dropped " << w.dropped (field) << " not 2\n"; rtn -= 1; }
+
+        // A frame of the wrong type or too many elements is an error
+        bool threw = false;
+        try { w.publish (field, std::vector<double>{ 1.0 }); } catch (const std::runtime_error&) { threw = true; }
+        if (!threw) { std::cout << "publishing doubles to a float channel should throw\n"; rtn -= 1; }
+        threw = false;
+        try { w.publish (field, std::vector<float>(9, 0.0f)); } catch (const std::runtime_error&) { threw = true; }
+        if (!threw) { std::cout << "publishing 9 elements to a channel of 8 should throw\n"; rtn -= 1; }
+
+        shm::shm_feed_reader r (name);
+        if (r.channel ("trace") != trace) { std::cout << "reader's trace channel differs\n"; rtn -= 1; }
+
+        // take_latest skips to the newest frame (the third) and frees the others
+        std::span<const float> got;
+        if (!r.take_latest<float> (field, got) || got.size() != 3u || got[0] != 2.0f || got[2] != 3.0f) {
+            std::cout << "take_latest did not give the newest frame\n";
+            rtn -= 1;
+        }
+        // The taken frame is held, so the writer has room for two more frames, not three
+        if (!w.publish (field, f) || !w.publish (field, f) || w.publish (field, f)) {
+            std::cout << "the writer should have room for exactly two frames\n";
+            rtn -= 1;
+        }
+        r.release (field);
+        if (!w.publish (field, f)) { std::cout << "release should have freed a slot\n"; rtn -= 1; }
+        // Consume all those; then there is nothing new
+        if (!r.take_latest<float> (field, got)) { std::cout << "take_latest found no frame\n"; rtn -= 1; }
+        if (r.take_latest<float> (field, got)) { std::cout << "take_latest gave a frame twice\n"; rtn -= 1; }
+
+        // feed_data passes the frame from the mapped memory to a model
+        mock_model m;
+        w.publish (field, std::vector<float>{ 5, 6, 7, 8 });
+        if (!shm::feed_data<float> (r, field, m) || m.data != std::vector<float>{ 5, 6, 7, 8 }) {
+            std::cout << "feed_data did not update the model's scalars\n";
+            rtn -= 1;
+        }
+        if (shm::feed_data<float> (r, field, m)) { std::cout << "feed_data with no new frame\n"; rtn -= 1; }
+        w.publish (quivers, std::vector<sm::vec<float, 3>>{ { 1, 0, 0 }, { 0, 1, 0 } });
+        if (!shm::feed_data<sm::vec<float, 3>> (r, quivers, m) || m.vectors.size() != 2u || m.vectors[1][1] != 1.0f) {
+            std::cout << "feed_data did not update the model's vectors\n";
+            rtn -= 1;
+        }
+
+        // feed_graph appends every frame of points, oldest first (none are skipped)
+        mock_graph g;
+        w.publish (trace, std::vector<shm::graph_point<double>>{ { 0.0, 1.0, 0 }, { 0.0, 2.0, 1 } });
+        w.publish (trace, std::vector<shm::graph_point<double>>{ { 1.0, 3.0, 0 } });
+        if (w.publish (trace, std::vector<shm::graph_point<double>>{ { 2.0, 4.0, 0 } })) {
+            std::cout << "the trace ring of 2 should be full\n";
+            rtn -= 1;
+        }
+        if (shm::feed_graph<double> (r, trace, g) != 3u || g.points.size() != 3u
+            || g.points[1].dataset != 1u || g.points[2].x != 1.0 || g.points[2].y != 3.0) {
+            std::cout << "feed_graph did not append the points in order\n";
+            rtn -= 1;
+        }
+        if (shm::feed_graph<double> (r, trace, g) != 0u) { std::cout << "feed_graph appended old points\n"; rtn -= 1; }
+        if (!w.publish (trace, std::vector<shm::graph_point<double>>{ { 2.0, 4.0, 0 } })) {
+            std::cout << "feed_graph should have freed the trace ring\n";
+            rtn -= 1;
+        }
+
+        // A second writer of the same name replaces the feed
+        shm::shm_feed_writer w2 (name, { shm::channel<float>("other", 2) });
+        shm::shm_feed_reader r2 (name);
+        threw = false;
+        try { r2.channel ("field"); } catch (const std::runtime_error&) { threw = true; }
+        if (!threw) { std::cout << "the replaced feed should have no field channel\n"; rtn -= 1; }
+
+        // A channel that doesn't fit in its segment, or has no slots, is refused on attach
+        shm::detail::channel_desc d;
+        d.type = shm::element_type::f32;
+        d.n_slots = 2;
+        d.max_elements = 8;
+        d.slot_stride = 64;
+        d.offset = 128;
+        const std::size_t fits = 128 + shm::detail::round_up (sizeof (shm::detail::channel_state)) + 2 * 64;
+        if (!shm::detail::valid_channel (d, fits) || shm::detail::valid_channel (d, fits - 1u)) {
+            std::cout << "valid_channel is wrong about the channel's extent\n";
+            rtn -= 1;
+        }
+        shm::detail::channel_desc bad = d;
+        bad.n_slots = 0;
+        if (shm::detail::valid_channel (bad, fits)) { std::cout << "a channel of no slots is valid\n"; rtn -= 1; }
+        bad = d;
+        bad.slot_stride = 32; // less than the count and 8 floats
+        if (shm::detail::valid_channel (bad, fits)) { std::cout << "a channel of short slots is valid\n"; rtn -= 1; }
+        bad = d;
+        bad.n_slots = 0xffffffffu;
+        bad.slot_stride = 0x8000000000000000ull; // n_slots * slot_stride overflows
+        if (shm::detail::valid_channel (bad, fits)) { std::cout << "a channel of overflowing size is valid\n"; rtn -= 1; }
+
+        const int fd = ::shm_open (("/" + name).c_str(), O_RDWR, 0);
+        void* p = fd < 0 ? MAP_FAILED : ::mmap (nullptr, sizeof (shm::detail::segment_header), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (fd >= 0) { ::close (fd); }
+        if (p == MAP_FAILED) {
+            std::cout << "could not map the segment to corrupt it\n";
+            rtn -= 1;
+        } else {
+            shm::detail::segment_header* sh = static_cast<shm::detail::segment_header*>(p);
+            sh->channels[0].n_slots = 0;
+            threw = false;
+            try { shm::shm_feed_reader r3 (name); } catch (const std::runtime_error&) { threw = true; }
+            if (!threw) { std::cout << "a segment with a channel of no slots was attached\n"; rtn -= 1; }
+            ::munmap (p, sizeof (shm::detail::segment_header));
+        }
+    } catch (const std::exception& e) {
+        std::cout << "Exception: " << e.what() << "\n";
+        rtn -= 1;
+    }
+
+    // A writer that has been replaced by a newer one of the same name leaves the newer feed be
+    try {
+        std::span<const float> got;
+        {
+            auto stale = std::make_unique<shm::shm_feed_writer>(name, std::vector<shm::channel_spec>{ shm::channel<float>("field", 4) });
+            shm::shm_feed_writer fresh (name, { shm::channel<float>("field", 4) });
+            stale.reset();
+            shm::shm_feed_reader r (name);
+            const std::size_t field = fresh.channel ("field");
+            fresh.publish (field, std::vector<float>{ 9.0f });
+            if (!r.take_latest<float> (r.channel ("field"), got) || got.size() != 1u || got[0] != 9.0f) {
+                std::cout << "the stale writer removed the newer writer's feed\n";
+                rtn -= 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cout << "Exception from the replaced writer: " << e.what() << "\n";
+        rtn -= 1;
+    }
+
+    // With the writers gone, there is no feed to attach to
+    bool threw = false;
+    try { shm::shm_feed_reader r (name); } catch (const std::runtime_error&) { threw = true; }
+    if (!threw) { std::cout << "the feed should be gone with its writer\n"; rtn -= 1; }
+
+    return rtn;
+}
@@ -0,0 +1,98 @@
+// Test the slot map in which VisualBase holds its models: handles, order and holes
+
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <mplot/slot_map.h>
+
+// The values of a map of unique_ptrs, in iteration order
+static std::vector<int> values (const mplot::slot_map<std::unique_ptr<int>>& m)
+{
+    std::vector<int> v;
+    for (const auto& p : m) { v.push_back (*p); }
+    return v;
+}
+
+int main()
+{
+    int rtn = 0;
+
+    mplot::slot_map<std::unique_ptr<int>> m;
+    std::vector<mplot::slot_handle> h;
+    for (int i = 0; i < 10; ++i) { h.push_back (m.insert (std::make_unique<int>(i))); }
+    if (m.size() != 10u || values (m) != std::vector<int>{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }) {
+        std::cout << "insert failed\n";
+        rtn -= 1;
+    }
+
+    // Erase leaves the others in order, and their handles still find them
+    m.erase (h[3]);
+    m.erase (h[7]);
+    if (m.size() != 8u || values (m) != std::vector<int>{ 0, 1, 2, 4, 5, 6, 8, 9 }) {
+        std::cout << "erase failed\n";
+        rtn -= 1;
+    }
+    if (m.holes() != 2u) {
+        std::cout << "expected 2 holes, not " << m.holes() << "\n";
+        rtn -= 1;
+    }
+    if (m.contains (h[3]) || m.find (h[7]) != nullptr || m.erase (h[3])) {
+        std::cout << "an erased handle is still valid\n";
+        rtn -= 1;
+    }
+    if (*m[3] != 4 || *m[6] != 8 || m.handle_at (6) != h[8]) {
+        std::cout << "indexing with holes failed\n";
+        rtn -= 1;
+    }
+    // An iterator gives its element's handle, skipping the holes
+    std::vector<mplot::slot_handle> it_handles;
+    for (auto mi = m.begin(); mi != m.end(); ++mi) { it_handles.push_back (mi.handle()); }
+    if (it_handles != std::vector<mplot::slot_handle>{ h[0], h[1], h[2], h[4], h[5], h[6], h[8], h[9] }) {
+        std::cout << "the iterators gave the wrong handles\n";
+        rtn -= 1;
+    }
+    for (int i : { 0, 1, 2, 4, 5, 6, 8, 9 }) {
+        const std::unique_ptr<int>* p = m.find (h[i]);
+        if (p == nullptr || **p != i) {
+            std::cout << "handle " << i << " lost its element\n";
+            rtn -= 1;
+        }
+    }
+
+    // A reused slot has a new generation, so the old handle does not find the new element
+    const mplot::slot_handle h10 = m.insert (std::make_unique<int>(10));
+    if (h10.slot != h[7].slot && h10.slot != h[3].slot) {
+        std::cout << "a free slot was not reused\n";
+        rtn -= 1;
+    }
+    if (m.contains (h[7]) || m.contains (h[3]) || !m.contains (h10) || **m.find (h10) != 10) {
+        std::cout << "slot reuse failed\n";
+        rtn -= 1;
+    }
+
+    // Compaction closes the holes without changing the order or the handles
+    m.compact();
+    if (m.holes() != 0u || values (m) != std::vector<int>{ 0, 1, 2, 4, 5, 6, 8, 9, 10 }) {
+        std::cout << "compact failed\n";
+        rtn -= 1;
+    }
+    if (**m.find (h[9]) != 9 || **m.find (h10) != 10 || *m[8] != 10) {
+        std::cout << "a handle was broken by compact\n";
+        rtn -= 1;
+    }
+
+    // Erasing most elements compacts automatically
+    for (int i : { 0, 1, 2, 4, 5, 6 }) { m.erase (h[i]); }
+    if (m.holes() > m.size() || values (m) != std::vector<int>{ 8, 9, 10 } || **m.find (h[8]) != 8) {
+        std::cout << "automatic compaction failed\n";
+        rtn -= 1;
+    }
+
+    m.clear();
+    if (!m.empty() || m.contains (h10) || m.begin() != m.end()) {
+        std::cout << "clear failed\n";
+        rtn -= 1;
+    }
+
+    return rtn;
+}
@@ -0,0 +1,61 @@
+// Test mplot::startup_profile: exclusive nested phases, marks and the end of the first frame
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <mplot/startup_profile.h>
+
+void sleep_ms (const int ms) { std::this_thread::sleep_for (std::chrono::milliseconds (ms)); }
+
+int main()
+{
+    int rtn = 0;
+
+    mplot::startup_profile p;
+    if (p.complete()) { --rtn; }
+
+    { mplot::startup_profile::scope s (p, "init"); sleep_ms (20); }
+    sleep_ms (20);
+    p.mark ("scene setup");
+    {
+        mplot::startup_profile::scope outer (p, "render");
+        sleep_ms (20);
+        { mplot::startup_profile::scope inner (p, "title"); sleep_ms (40); }
+        { mplot::startup_profile::counter_scope c (mplot::startup_profile::glyph_ns()); sleep_ms (10); }
+    }
+    // A phase that is entered again adds to its time
+    { mplot::startup_profile::scope s (p, "init"); sleep_ms (10); }
+    p.finish();
+
+    if (!p.complete()) { --rtn; }
+    if (p.phases.size() != 4u) { std::cout << "Expected 4 phases\n"; --rtn; }
+    else if (p.phases[0].name != "init" || p.phases[1].name != "scene setup"
+             || p.phases[2].name != "render" || p.phases[3].name != "title") {
+        std::cout << "Phases out of order\n"; --rtn;
+    }
+    // The title's time is not counted in the render that encloses it
+    if (p.ms ("title") < 40.0 || p.ms ("render") < 30.0 || p.ms ("render") > 60.0) {
+        std::cout << "Nested phase not exclusive: render " << p.ms ("render") << ", title " << p.ms ("title") << "\n"; --rtn;
+    }
+    if (p.ms ("init") < 30.0 || p.ms ("scene setup") < 20.0) { std::cout << "Phase time too short\n"; --rtn; }
+    if (p.ms ("no such phase") != 0.0) { --rtn; }
+    if (p.glyph_ms < 10.0) { std::cout << "Glyph counter not counted\n"; --rtn; }
+
+    // The phases add up to the time to the first frame
+    double sum = 0.0;
+    for (const auto& ph : p.phases) { sum += ph.ms; }
+    if (sum > p.first_frame_ms || p.first_frame_ms - sum > 5.0) {
+        std::cout << "Phases sum to " << sum << " of " << p.first_frame_ms << " ms\n"; --rtn;
+    }
+
+    // Nothing more is recorded once the first frame is done
+    const double ff = p.first_frame_ms;
+    { mplot::startup_profile::scope s (p, "late"); sleep_ms (5); }
+    p.mark ("late mark");
+    p.finish();
+    if (p.phases.size() != 4u || p.first_frame_ms != ff) { std::cout << "Recorded after the first frame\n"; --rtn; }
+
+    if (p.json()["phases"].size() != 4u) { --rtn; }
+    std::cout << p.summary() << std::endl;
+
+    return rtn;
+}
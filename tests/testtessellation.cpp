@@ -0,0 +1,81 @@
+// Test the tessellation policy of mplot/tessellation.h: the choice of level, its hysteresis and the screen size
+#include <iostream>
+#include <cmath>
+#include <sm/vec>
+#include <sm/mat44>
+#include <sm/mathconst>
+#include "mplot/tessellation.h"
+
+int main()
+{
+    int rtn = 0;
+
+    mplot::tessellation t;
+    t.levels = { { 4, 8 }, { 8, 16 }, { 16, 32 } };
+    t.pixels_per_segment = 4.0f;
+    t.hysteresis = 0.25f;
+    // The diameter at which a level's segments are pixels_per_segment long
+    auto diameter_for = [&t](const float segments) { return segments * t.pixels_per_segment / sm::mathconst<float>::pi; };
+
+    // With no current level, the coarsest level with enough segments is chosen
+    if (t.choose (0.0f, mplot::tessellation::none) != 0u) { std::cout << "zero size\n"; --rtn; }
+    if (t.choose (diameter_for (8.0f), mplot::tessellation::none) != 0u) { std::cout << "level 0\n"; --rtn; }
+    if (t.choose (diameter_for (9.0f), mplot::tessellation::none) != 1u) { std::cout << "level 1\n"; --rtn; }
+    if (t.choose (diameter_for (1000.0f), mplot::tessellation::none) != 2u) { std::cout << "finest\n"; --rtn; }
+
+    // A level is kept until the ideal segments have passed its range by the hysteresis
+    if (t.choose (diameter_for (19.0f), 1u) != 1u) { std::cout << "kept going up\n"; --rtn; }
+    if (t.choose (diameter_for (21.0f), 1u) != 2u) { std::cout << "no change up\n"; --rtn; }
+    if (t.choose (diameter_for (6.5f), 1u) != 1u) { std::cout << "kept going down\n"; --rtn; }
+    if (t.choose (diameter_for (5.5f), 1u) != 0u) { std::cout << "no change down\n"; --rtn; }
+    // The finest level is never left for a larger size, the coarsest for a smaller
+    if (t.choose (diameter_for (1e6f), 2u) != 2u || t.choose (0.0f, 0u) != 0u) { std::cout << "ends\n"; --rtn; }
+
+    // update does nothing unless adaptive; the fixed values are used until a level is chosen
+    if (t.update (diameter_for (30.0f)) || t.current_level() != mplot::tessellation::none) { std::cout << "not adaptive\n"; --rtn; }
+    t.adaptive = true;
+    if (t.rings (10) != 10 || t.segments (12) != 12) { std::cout << "fixed values\n"; --rtn; }
+    if (!t.update (diameter_for (30.0f)) || t.current_level() != 2u) { std::cout << "first update\n"; --rtn; }
+    if (t.rings (10) != 16 || t.segments (12) != 32) { std::cout << "level values\n"; --rtn; }
+    if (t.update (diameter_for (30.0f))) { std::cout << "unchanged size\n"; --rtn; }
+
+    // A size that wobbles about the boundary between two levels changes the level once
+    t.reset();
+    unsigned int changes = 0;
+    for (int i = 0; i < 100; ++i) {
+        const float wobble = (i % 2 == 0) ? 0.9f : 1.1f;
+        if (t.update (diameter_for (16.0f * wobble))) { ++changes; }
+    }
+    if (changes != 1u || t.current_level() != 1u) { std::cout << "hysteresis: " << changes << " changes\n"; --rtn; }
+    t.reset();
+    if (t.current_level() != mplot::tessellation::none) { std::cout << "reset\n"; --rtn; }
+
+    // max_screen_size is that at the nearest corner of the box, with a perspective projection
+    sm::mat44<float> p;
+    const float n = 0.1f;
+    const float f = 100.0f;
+    const float cot = 1.0f / std::tan (0.125f * sm::mathconst<float>::pi);
+    p.mat = { cot, 0.0f, 0.0f, 0.0f,
+              0.0f, cot, 0.0f, 0.0f,
+              0.0f, 0.0f, (f + n) / (n - f), -1.0f,
+              0.0f, 0.0f, 2.0f * f * n / (n - f), 0.0f };
+    sm::mat44<float> mv; // the identity
+    const sm::vec<float, 3> lo = { -1.0f, -1.0f, -10.0f };
+    const sm::vec<float, 3> hi = { 1.0f, 1.0f, -2.0f };
+    const float sz = mplot::tessellation::max_screen_size (p, mv, lo, hi, 0.1f, 600);
+    const float near_sz = mplot::lod::screen_size (p, sm::vec<float, 4>{ 1.0f, 1.0f, -2.0f, 1.0f }, 0.1f, 600);
+    const float far_sz = mplot::lod::screen_size (p, sm::vec<float, 4>{ 1.0f, 1.0f, -10.0f, 1.0f }, 0.1f, 600);
+    if (std::abs (sz - near_sz) > 1e-4f * near_sz || !(sz > far_sz)) {
+        std::cout << "max_screen_size " << sz << " (nearest " << near_sz << ", farthest " << far_sz << ")\n";
+        --rtn;
+    }
+    // A scale in mv scales the diameter
+    mv.mat[0] = 2.0f;
+    mv.mat[5] = 2.0f;
+    mv.mat[10] = 2.0f;
+    const float sz2 = mplot::tessellation::max_screen_size (p, mv, { 0.0f, 0.0f, -1.0f }, { 0.0f, 0.0f, -1.0f }, 0.1f, 600);
+    const float expect2 = mplot::lod::screen_size (p, sm::vec<float, 4>{ 0.0f, 0.0f, -2.0f, 1.0f }, 0.2f, 600);
+    if (std::abs (sz2 - expect2) > 1e-4f * expect2) { std::cout << "scaled " << sz2 << " != " << expect2 << "\n"; --rtn; }
+
+    return rtn;
+}
@@ -0,0 +1,85 @@
+// Test the layout of glyph quads, the measuring of texts and the parallel loop of mplot/text_layout.h
+#include <iostream>
+#include <vector>
+#include <array>
+#include <map>
+#include <string>
+#include <atomic>
+#include <stdexcept>
+#include <cmath>
+#include <sm/vec>
+#include "mplot/text_layout.h"
+
+// A glyph with the members of mplot::visgl::CharInfo that the layout uses
+struct glyph
+{
+    sm::vec<int, 2> size = { 0, 0 };
+    sm::vec<int, 2> bearing = { 0, 0 };
+    unsigned int advance = 0;
+    sm::vec<float, 4> uv = { 0.0f, 0.0f, 0.0f, 0.0f };
+};
+
+int main()
+{
+    int rtn = 0;
+
+    // An 'a' 8 wide and 10 high, 2 of which are below the baseline; an 'h' 12 high; a 'b' of no size
+    std::map<char32_t, glyph> glyphs;
+    glyphs[U'a'] = { { 8, 10 }, { 1, 8 }, 10u << 6, { 0.0f, 0.0f, 0.5f, 0.5f } };
+    glyphs[U'h'] = { { 8, 12 }, { 1, 12 }, 9u << 6, { 0.5f, 0.0f, 1.0f, 0.5f } };
+    glyphs[U'b'] = { { 0, 0 }, { 0, 0 }, 4u << 6, { 0.0f, 0.5f, 0.0f, 0.5f } };
+    glyphs[U'\n'] = { { 0, 0 }, { 0, 0 }, 0u, {} };
+    auto glyph_of = [&glyphs](const char32_t c) { return glyphs.at (c); };
+
+    const float fs = 0.5f;
+    std::vector<std::array<float, 12>> quads;
+    std::vector<sm::vec<float, 4>> uvs;
+    sm::vec<float, 4> extents = { 1e7, -1e7, 1e7, -1e7 };
+    mplot::text_layout::layout (U"ab\na", sm::vec<float>{ 1.0f, 2.0f, 0.0f }, glyph_of, fs, 1.5f, quads, uvs, extents);
+
+    // One quad for each glyph, but none for the newline
+    if (quads.size() != 3u || uvs.size() != 3u) { std::cout << "quad count " << quads.size() << "\n"; return -1; }
+    // The first 'a': its bottom left is lowered by its drop and moved right by its bearing
+    if (std::abs (quads[0][0] - 1.5f) > 1e-6f || std::abs (quads[0][1] - 1.0f) > 1e-6f
+        || std::abs (quads[0][4] - 6.0f) > 1e-6f || std::abs (quads[0][6] - 5.5f) > 1e-6f) {
+        std::cout << "first quad\n";
+        --rtn;
+    }
+    // The 'b' follows the advance of the 'a'
+    if (std::abs (quads[1][0] - 6.0f) > 1e-6f || uvs[1] != glyphs[U'b'].uv) { std::cout << "second quad\n"; --rtn; }
+    // The last 'a' is back at the left, down 1.5 times the height of the 'h'
+    if (std::abs (quads[2][0] - 1.5f) > 1e-6f || std::abs (quads[2][1] - (1.0f - 1.5f * 12.0f * fs)) > 1e-5f) { std::cout << "new line\n"; --rtn; }
+    // Each quad is a little nearer than the last
+    if (!(quads[1][2] < quads[0][2]) || !(quads[2][2] < quads[1][2])) { std::cout << "epsilon\n"; --rtn; }
+    if (std::abs (extents[0] - 1.5f) > 1e-6f || std::abs (extents[3] - 6.0f) > 1e-6f
+        || std::abs (extents[2] - (1.0f - 9.0f)) > 1e-5f) {
+        std::cout << "extents " << extents << "\n";
+        --rtn;
+    }
+
+    // The geometry, as the face measures it, includes the advances of every glyph
+    mplot::TextGeometry g = mplot::text_layout::measure (U"aab", glyph_of, fs);
+    if (std::abs (g.total_advance - 12.0f) > 1e-6f || std::abs (g.max_bearingy - 4.0f) > 1e-6f || std::abs (g.max_drop - 1.0f) > 1e-6f) {
+        std::cout << "measure\n";
+        --rtn;
+    }
+
+    // The code points of several texts, each once, with an 'h' for the line spacing
+    const std::vector<char32_t> cps = mplot::text_layout::code_points ({ U"ba", U"", U"aab" });
+    if (cps != std::vector<char32_t>{ U'a', U'b', U'h' }) { std::cout << "code_points\n"; --rtn; }
+
+    // for_each runs every job once, on any number of threads
+    for (unsigned int nt : { 1u, 3u, 0u }) {
+        std::vector<std::atomic<int>> done (1001);
+        mplot::text_layout::for_each (done.size(), nt, [&done](const std::size_t i) { ++done[i]; });
+        for (const auto& d : done) { if (d != 1) { std::cout << "for_each " << nt << "\n"; --rtn; break; } }
+    }
+    // and rethrows an exception thrown by a job
+    bool caught = false;
+    try {
+        mplot::text_layout::for_each (100, 4, [](const std::size_t i) { if (i == 57) { throw std::runtime_error ("57"); } });
+    } catch (const std::runtime_error&) { caught = true; }
+    if (!caught) { std::cout << "for_each exception\n"; --rtn; }
+
+    return rtn;
+}
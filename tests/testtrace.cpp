@@ -0,0 +1,83 @@
+// Test mplot::trace, the Chrome trace-event JSON written by the MPLOT_TRACE_SCOPE markers
+#define MPLOT_TRACE 1
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include <set>
+#include <nlohmann/json.hpp>
+#include <mplot/trace.h>
+
+void work (const int n)
+{
+    for (int i = 0; i < n; ++i) {
+        MPLOT_TRACE_SCOPE ("outer");
+        {
+            MPLOT_TRACE_SCOPE ("inner \"quoted\"");
+        }
+    }
+}
+
+int main()
+{
+    int rtn = 0;
+
+    const std::string fn = (std::filesystem::temp_directory_path() / "testtrace.json").string();
+
+    // Before start(), the markers record nothing
+    work (3);
+    if (mplot::trace::enabled()) { rtn -= 1; }
+
+    mplot::trace::start (fn);
+    mplot::trace::name_thread ("main");
+    work (2);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) { threads.emplace_back ([]() { work (10); }); }
+    for (auto& t : threads) { t.join(); }
+    mplot::trace::stop();
+    // After stop(), nothing more is written
+    work (5);
+
+    std::ifstream f (fn);
+    nlohmann::json js;
+    try {
+        js = nlohmann::json::parse (f);
+    } catch (const std::exception& e) {
+        std::cout << "trace is not valid JSON: " << e.what() << std::endl;
+        std::cout << "FAIL" << std::endl;
+        return -1;
+    }
+    const auto& ev = js["traceEvents"];
+    std::size_t n_x = 0;
+    std::size_t n_m = 0;
+    std::set<int> tids;
+    for (const auto& e : ev) {
+        if (e["ph"] == "M") {
+            ++n_m;
+            if (e["args"]["name"] != "main") { rtn -= 1; }
+            continue;
+        }
+        ++n_x;
+        tids.insert (e["tid"].get<int>());
+        if (e["dur"].get<double>() < 0.0 || e["ts"].get<double>() < 0.0) { rtn -= 1; }
+    }
+    // 2 + 4 * 10 iterations, with two events each
+    if (n_x != 2 * (2 + 4 * 10) || n_m != 1) {
+        std::cout << "expected " << 2 * (2 + 4 * 10) << " events, got " << n_x << " (and " << n_m << " thread names)\n";
+        rtn -= 1;
+    }
+    if (tids.size() != 5) {
+        std::cout << "expected events from 5 threads, got " << tids.size() << std::endl;
+        rtn -= 1;
+    }
+    if (ev[1]["name"] != "inner \"quoted\"") {
+        std::cout << "the inner event (which ends first) has the wrong name\n";
+        rtn -= 1;
+    }
+
+    std::filesystem::remove (fn);
+
+    return rtn;
+}
@@ -0,0 +1,45 @@
+// Test that mplot::unit_meshes gives the values that the VisualModel primitives computed directly
+#include <iostream>
+#include <cmath>
+#include <sm/mathconst>
+#include "mplot/unit_meshes.h"
+
+int main()
+{
+    int rtn = 0;
+
+    // The circle for a tessellation is computed once and then returned from the cache
+    const mplot::unit_meshes::circle& c12 = mplot::unit_meshes::get_circle (12);
+    if (&c12 != &mplot::unit_meshes::get_circle (12)) { --rtn; }
+    if (c12.sin_t.size() != 12u || c12.cos_t.size() != 12u) { --rtn; }
+    for (int j = 0; j < 12; j++) {
+        // As in computeTube/computeCone
+        float t = j * sm::mathconst<float>::two_pi/(float)12;
+        if (c12.sin_t[j] != std::sin(t) || c12.cos_t[j] != std::cos(t)) { --rtn; }
+    }
+
+    // The unit sphere matches the vertices computeSphere made (with r = 1 at the origin)
+    constexpr int rings = 10;
+    constexpr int segments = 12;
+    const mplot::unit_meshes::sphere& us = mplot::unit_meshes::get_sphere (rings, segments);
+    const unsigned int nverts = 2 + segments * (rings - 1);
+    if (us.posn.size() != 3u * nverts || us.norm.size() != 3u * nverts) { --rtn; }
+    if (us.indices.size() != 6u * segments * (rings - 1)) { --rtn; }
+    for (int i = 1; i < rings; i++) {
+        float ringang = sm::mathconst<float>::pi * (-0.5f + static_cast<float>(i) / rings);
+        for (int j = 0; j < segments; j++) {
+            float segment = sm::mathconst<float>::two_pi * static_cast<float>(j) / segments;
+            const unsigned int v = 1 + (i - 1) * segments + j;
+            if (us.posn[3 * v] != std::cos(segment) * std::cos(ringang)
+                || us.posn[3 * v + 1] != std::sin(segment) * std::cos(ringang)
+                || us.posn[3 * v + 2] != std::sin(ringang)) {
+                std::cout << "Sphere vertex " << v << " differs\n";
+                --rtn;
+            }
+        }
+    }
+    for (auto i : us.indices) { if (i >= nverts) { --rtn; } }
+
+    std::cout << "testunitmeshes " << (rtn == 0 ? "passed" : "failed") << std::endl;
+    return rtn;
+}
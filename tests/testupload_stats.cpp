@@ -0,0 +1,35 @@
+// Test the sums of mplot::upload_stats
+#include "mplot/upload_stats.h"
+
+int main()
+{
+    int rtn = 0;
+
+    mplot::upload_stats a;
+    a.reinits = 2;
+    a.reinit_buffers = 3;
+    a.bytes[static_cast<std::size_t>(mplot::upload_target::positions)] = 120;
+    a.bytes[static_cast<std::size_t>(mplot::upload_target::colours)] = 60;
+    a.build_ms = 1.5;
+
+    mplot::upload_stats b;
+    b.finalizes = 1;
+    b.full_uploads = 1;
+    b.bytes[static_cast<std::size_t>(mplot::upload_target::positions)] = 12;
+    b.bytes[static_cast<std::size_t>(mplot::upload_target::instances)] = 400;
+    b.upload_ms = 0.25;
+
+    if (a.total_bytes() != 180u || b.total_bytes() != 412u) { --rtn; }
+
+    mplot::upload_stats t;
+    t += a;
+    t += b;
+    if (t.finalizes != 1u || t.reinits != 2u || t.reinit_buffers != 3u || t.full_uploads != 1u) { --rtn; }
+    if (t.bytes_to (mplot::upload_target::positions) != 132u) { --rtn; }
+    if (t.bytes_to (mplot::upload_target::instances) != 400u) { --rtn; }
+    if (t.bytes_to (mplot::upload_target::normals) != 0u) { --rtn; }
+    if (t.total_bytes() != 592u) { --rtn; }
+    if (t.build_ms != 1.5 || t.upload_ms != 0.25) { --rtn; }
+
+    return rtn;
+}
@@ -0,0 +1,68 @@
+// Test the brick maxima with which a volume's ray marching skips empty space
+#include <iostream>
+#include <vector>
+#include <array>
+#include <limits>
+#include <cstdint>
+#include <stdexcept>
+#include "mplot/volume_bricks.h"
+
+int main()
+{
+    int rtn = 0;
+    namespace mv = mplot::volume;
+
+    // A volume of 20 x 9 x 3 voxels is 3 x 2 x 1 bricks of 8
+    const std::array<unsigned int, 3> dims = { 20u, 9u, 3u };
+    const std::array<unsigned int, 3> bd = mv::brick_dims (dims);
+    if (bd[0] != 3u || bd[1] != 2u || bd[2] != 1u || mv::bricks (16u) != 2u || mv::bricks (0u) != 0u) {
+        std::cout << "brick_dims failed\n";
+        --rtn;
+    }
+
+    std::vector<float> v (std::size_t{dims[0]} * dims[1] * dims[2], 0.0f);
+    auto at = [&dims, &v](unsigned int x, unsigned int y, unsigned int z) -> float& { return v[(std::size_t{z} * dims[1] + y) * dims[0] + x]; };
+    auto brick = [&bd](const std::vector<std::uint8_t>& m, unsigned int bx, unsigned int by) { return m[std::size_t{by} * bd[0] + bx]; };
+
+    // An empty volume has empty bricks, and NaN doesn't fill them
+    at (3, 3, 1) = std::numeric_limits<float>::quiet_NaN();
+    std::vector<std::uint8_t> m = mv::brick_max (v, dims);
+    for (auto b : m) { if (b != 0u) { std::cout << "empty volume failed\n"; --rtn; break; } }
+
+    // A voxel inside brick (1,0), away from its faces, is in that brick alone
+    at (11, 3, 1) = 0.5f;
+    m = mv::brick_max (v, dims);
+    if (brick (m, 1, 0) != 128u || brick (m, 0, 0) != 0u || brick (m, 2, 0) != 0u || brick (m, 1, 1) != 0u) {
+        std::cout << "inner voxel failed\n";
+        --rtn;
+    }
+
+    // A voxel on the face of a brick is also in the brick beside it, which a trilinear sample
+    // near that face reads: x = 15 is the last of brick 1 and x = 16 the first of brick 2
+    at (11, 3, 1) = 0.0f;
+    at (15, 7, 0) = 1.0f;
+    at (16, 8, 2) = 0.25f;
+    m = mv::brick_max (v, dims);
+    if (brick (m, 1, 0) != 255u || brick (m, 2, 0) != 255u || brick (m, 1, 1) != 255u || brick (m, 2, 1) != 255u
+        || brick (m, 0, 0) != 0u || brick (m, 0, 1) != 0u) {
+        std::cout << "face voxel failed\n";
+        --rtn;
+    }
+
+    // Maxima are rounded up, so that no datum is above its brick's byte
+    at (15, 7, 0) = 0.0f;
+    m = mv::brick_max (v, dims);
+    if (brick (m, 2, 1) != 64u || brick (m, 1, 0) != 64u || brick (m, 0, 0) != 0u) {
+        std::cout << "rounding failed\n";
+        --rtn;
+    }
+
+    // A volume smaller than its dims is an error
+    try {
+        mv::brick_max (std::vector<float> (10u, 0.0f), dims);
+        std::cout << "size check failed\n";
+        --rtn;
+    } catch (const std::runtime_error&) {}
+
+    return rtn;
+}